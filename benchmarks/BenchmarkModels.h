@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BenchmarkModels.h
+ * @brief Shipped robot models the benchmarks run on.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+namespace benchmarks {
+
+/// A shipped model, and the link its base is fixed at or known.
+struct BenchmarkModel {
+  const char *name;
+  const char *file;  // relative to kUrdfPath, or kSdfPath if sdf
+  bool sdf;
+  const char *base;
+};
+
+static const BenchmarkModel kModels[] = {
+    {"a1", "a1/a1.urdf", false, "trunk"},
+    {"atlas", "atlas.urdf", false, "pelvis"},
+    {"spider", "spider.sdf", true, "body"},
+    {"panda", "panda/panda.urdf", false, "link0"},
+};
+static constexpr int kNumModels = sizeof(kModels) / sizeof(kModels[0]);
+
+/**
+ * Robot of `model`, parsed once per process.
+ * @param model       a shipped model
+ * @param fixed_base  if true, the base link is fixed
+ */
+inline const Robot &GetRobot(const BenchmarkModel &model,
+                             bool fixed_base = true) {
+  static std::map<std::pair<std::string, bool>, Robot> robots;
+  const auto key = std::make_pair(std::string(model.name), fixed_base);
+  auto it = robots.find(key);
+  if (it == robots.end()) {
+    const std::string path =
+        std::string(model.sdf ? kSdfPath : kUrdfPath) + model.file;
+    Robot robot = CreateRobotFromFile(path, model.sdf ? model.name : "");
+    if (fixed_base) robot = robot.fixLink(model.base);
+    it = robots.emplace(key, robot).first;
+  }
+  return it->second;
+}
+
+/// Robot of model `index` in kModels.
+inline const Robot &GetRobot(int64_t index, bool fixed_base = true) {
+  return GetRobot(kModels[index], fixed_base);
+}
+
+/// Joint angles, velocities and accelerations of zero, at time t.
+inline gtsam::Values ZeroJointValues(const Robot &robot, size_t t = 0) {
+  gtsam::Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, t, 0.0);
+    InsertJointVel(&values, j, t, 0.0);
+    InsertJointAccel(&values, j, t, 0.0);
+  }
+  return values;
+}
+
+/// Run the benchmark on every model, labelled with the model name.
+#define BENCHMARK_MODELS(fn) \
+  BENCHMARK(fn)->DenseRange(0, gtdynamics::benchmarks::kNumModels - 1)
+
+}  // namespace benchmarks
+}  // namespace gtdynamics
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchContactFactors.cpp
+ * @brief Benchmark the contact factors added for every foot at every step.
+ */
+
+#include <benchmark/benchmark.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+#include "gtdynamics/factors/ContactDynamicsFrictionConeFactor.h"
+#include "gtdynamics/factors/ContactKinematicsAccelFactor.h"
+#include "gtdynamics/factors/ContactKinematicsTwistFactor.h"
+
+using namespace gtdynamics;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector6;
+
+static const gtsam::Key kPoseKey = gtsam::LabeledSymbol('p', 1, 0),
+                        kWrenchKey = gtsam::LabeledSymbol('C', 1, 0);
+static const Pose3 kPose(gtsam::Rot3::RzRyRx(0.1, 0.2, 0.3),
+                         gtsam::Point3(0, 0, 0.3));
+static const Pose3 kContact(gtsam::Rot3(), gtsam::Point3(0, 0, 0.1));
+
+// Error and Jacobians of a friction cone factor; arg 0 is inside the cone,
+// where the gradient is zero, and arg 1 is outside.
+static void FrictionConeError(benchmark::State &state) {
+  const ContactDynamicsFrictionConeFactor factor(
+      kPoseKey, kWrenchKey, gtsam::noiseModel::Isotropic::Sigma(1, 1e-2), 0.7,
+      gtsam::Vector3(0, 0, -9.8));
+  const Vector6 wrench = state.range(0)
+                             ? (Vector6() << 0, 0, 0, 5, 0, 1).finished()
+                             : (Vector6() << 0, 0, 0, 0, 0, 10).finished();
+  Matrix H_pose, H_wrench;
+  for (auto _ : state) {
+    auto error = factor.evaluateError(kPose, wrench, H_pose, H_wrench);
+    benchmark::DoNotOptimize(error);
+  }
+}
+BENCHMARK(FrictionConeError)->Arg(0)->Arg(1);
+
+// Error and Jacobian of a contact twist or acceleration factor.
+template <typename FACTOR>
+static void ContactKinematicsError(benchmark::State &state) {
+  const FACTOR factor(kPoseKey, gtsam::noiseModel::Isotropic::Sigma(3, 1e-2),
+                      kContact);
+  const Vector6 twist = (Vector6() << 0.1, 0.2, 0.3, 1, 2, 3).finished();
+  Matrix H;
+  for (auto _ : state) {
+    auto error = factor.evaluateError(twist, H);
+    benchmark::DoNotOptimize(error);
+  }
+}
+BENCHMARK_TEMPLATE(ContactKinematicsError, ContactKinematicsTwistFactor);
+BENCHMARK_TEMPLATE(ContactKinematicsError, ContactKinematicsAccelFactor);
+
+// Linearization of the contact factors of four feet, as in a quadruped step.
+static void LinearizeContactFactors(benchmark::State &state) {
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values values;
+  const auto model1 = gtsam::noiseModel::Isotropic::Sigma(1, 1e-2);
+  const auto model3 = gtsam::noiseModel::Isotropic::Sigma(3, 1e-2);
+  for (int foot = 0; foot < 4; foot++) {
+    const gtsam::Key pose = gtsam::LabeledSymbol('p', foot, 0),
+                     twist = gtsam::LabeledSymbol('V', foot, 0),
+                     accel = gtsam::LabeledSymbol('A', foot, 0),
+                     wrench = gtsam::LabeledSymbol('C', foot, 0);
+    graph.emplace_shared<ContactDynamicsFrictionConeFactor>(
+        pose, wrench, model1, 0.7, gtsam::Vector3(0, 0, -9.8));
+    graph.emplace_shared<ContactKinematicsTwistFactor>(twist, model3,
+                                                       kContact);
+    graph.emplace_shared<ContactKinematicsAccelFactor>(accel, model3,
+                                                       kContact);
+    values.insert(pose, kPose);
+    values.insert(twist, Vector6(Vector6::Constant(0.1)));
+    values.insert(accel, Vector6(Vector6::Constant(0.2)));
+    values.insert(wrench, Vector6((Vector6() << 0, 0, 0, 5, 0, 1).finished()));
+  }
+  for (auto _ : state) {
+    auto linear_graph = graph.linearize(values);
+    benchmark::DoNotOptimize(linear_graph);
+  }
+}
+BENCHMARK(LinearizeContactFactors);
@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchDynamics.cpp
+ * @brief Benchmark forward/inverse dynamics and simulation, on fixed bases.
+ */
+
+#include <algorithm>
+
+#include "BenchmarkModels.h"
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/Simulator.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+static const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// Kinematics and zero torques, as known by forward dynamics.
+static gtsam::Values KnownValues(const Robot &robot) {
+  gtsam::Values known = robot.forwardKinematics(ZeroJointValues(robot));
+  for (auto &&joint : robot.joints()) InsertTorque(&known, joint->id(), 0, 0);
+  return known;
+}
+
+static void LinearSolveFD(benchmark::State &state) {
+  const Robot &robot = GetRobot(state.range(0));
+  const gtsam::Values known = KnownValues(robot);
+  DynamicsGraph graph_builder(kGravity);
+  for (auto _ : state) {
+    gtsam::Values result = graph_builder.linearSolveFD(robot, 0, known);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetLabel(kModels[state.range(0)].name);
+}
+BENCHMARK_MODELS(LinearSolveFD);
+
+static void LinearSolveID(benchmark::State &state) {
+  const Robot &robot = GetRobot(state.range(0));
+  const gtsam::Values known = KnownValues(robot);
+  DynamicsGraph graph_builder(kGravity);
+  for (auto _ : state) {
+    gtsam::Values result = graph_builder.linearSolveID(robot, 0, known);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetLabel(kModels[state.range(0)].name);
+}
+BENCHMARK_MODELS(LinearSolveID);
+
+// One simulator step with the forward dynamics method in range(1).
+static void SimulatorStep(benchmark::State &state) {
+  const Robot &robot = GetRobot(state.range(0));
+  const auto method = static_cast<ForwardDynamicsMethod>(state.range(1));
+  Simulator simulator(robot, ZeroJointValues(robot), kGravity, boost::none,
+                      method);
+  int num_slots = 0;
+  for (auto &&joint : robot.joints())
+    num_slots = std::max(num_slots, joint->id() + 1);
+  const gtsam::Vector torques = gtsam::Vector::Zero(num_slots);
+  for (auto _ : state) simulator.step(torques, 1e-3);
+  state.SetLabel(kModels[state.range(0)].name);
+}
+BENCHMARK(SimulatorStep)
+    ->ArgsProduct({benchmark::CreateDenseRange(0, kNumModels - 1, 1),
+                   {LinearGraph, ArticulatedBody}});
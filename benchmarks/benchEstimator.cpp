@@ -0,0 +1,67 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchEstimator.cpp
+ * @brief Benchmark the latency of legged state estimation at IMU rate.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <set>
+#include <string>
+
+#include "BenchmarkModels.h"
+#include "gtdynamics/dynamics/LeggedStateEstimator.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+// Arguments: IMU rate in Hz, lag in milliseconds.
+static void EstimatorArguments(benchmark::internal::Benchmark *b) {
+  for (int rate : {500, 1000})
+    for (int lag : {250, 1000}) b->Args({rate, lag});
+}
+
+// One IMU sample of an a1 trotting in place: diagonal feet swap every 0.2 s.
+// The time per iteration is the mean latency; the worst case, which includes
+// keyframes and marginalization, is reported as max_latency_us.
+static void LeggedEstimatorUpdate(benchmark::State &state) {
+  const Robot &robot = GetRobot(kModels[0], false);
+  const double dt = 1.0 / state.range(0);
+  LeggedEstimatorParameters parameters;
+  parameters.lag = 1e-3 * state.range(1);
+  LeggedStateEstimator estimator(robot, kModels[0].base, parameters);
+
+  LeggedMeasurement measurement;
+  measurement.dt = dt;
+  measurement.acceleration = gtsam::Vector3(0, 0, 9.81);
+  for (auto &&joint : robot.joints())
+    InsertJointAngle(&measurement.joint_angles, joint->id(), 0.0);
+  const std::set<std::string> stances[2] = {{"FR_lower", "RL_lower"},
+                                            {"FL_lower", "RR_lower"}};
+  estimator.initialize(gtsam::NavState(), gtsam::imuBias::ConstantBias(),
+                       measurement.joint_angles, stances[0]);
+
+  const int samples_per_stance = 0.2 / dt;
+  int sample = 0, keyframes = 0;
+  double max_latency = 0;
+  for (auto _ : state) {
+    measurement.contacts = stances[(++sample / samples_per_stance) % 2];
+    const auto start = std::chrono::steady_clock::now();
+    keyframes += estimator.update(measurement);
+    const std::chrono::duration<double, std::micro> latency =
+        std::chrono::steady_clock::now() - start;
+    max_latency = std::max(max_latency, latency.count());
+  }
+  state.counters["max_latency_us"] = max_latency;
+  state.counters["keyframes"] = keyframes;
+  state.counters["window_keyframes"] = estimator.numKeyframes();
+}
+BENCHMARK(LeggedEstimatorUpdate)
+    ->Apply(EstimatorArguments)
+    ->Unit(benchmark::kMicrosecond);
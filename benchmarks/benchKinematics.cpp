@@ -0,0 +1,30 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchKinematics.cpp
+ * @brief Benchmark forward kinematics.
+ */
+
+#include "BenchmarkModels.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+// Forward kinematics from the base link, at zero joint angles.
+static void ForwardKinematics(benchmark::State &state) {
+  const BenchmarkModel &model = kModels[state.range(0)];
+  const Robot &robot = GetRobot(state.range(0), false);
+  const gtsam::Values known = ZeroJointValues(robot);
+  for (auto _ : state) {
+    gtsam::Values values =
+        robot.forwardKinematics(known, 0, std::string(model.base));
+    benchmark::DoNotOptimize(values);
+  }
+  state.SetLabel(model.name);
+}
+BENCHMARK_MODELS(ForwardKinematics);
@@ -0,0 +1,81 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchOptimizer.cpp
+ * @brief Benchmark the penalty and augmented Lagrangian solvers.
+ */
+
+#include <gtsam/nonlinear/ExpressionFactorGraph.h>
+#include <gtsam/nonlinear/expressions.h>
+
+#include <vector>
+
+#include "BenchmarkModels.h"
+#include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
+#include "gtdynamics/optimizer/PenaltyMethodOptimizer.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+using gtsam::Double_;
+
+namespace {
+// x^2, as the * operator of Double_ composes (adds) rather than multiplies.
+double Square(const double &x, gtsam::OptionalJacobian<1, 1> H) {
+  if (H) *H = gtsam::I_1x1 * 2 * x;
+  return x * x;
+}
+
+/**
+ * Joint space problem sized by the robot: stay close to a target angle for
+ * every joint, subject to q_j + q_{j+1}^2 = 0 for consecutive joints.
+ */
+struct JointProblem {
+  gtsam::ExpressionFactorGraph graph;
+  EqualityConstraints constraints;
+  gtsam::Values initial;
+
+  explicit JointProblem(const Robot &robot) {
+    auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+    std::vector<Double_> q;
+    for (auto &&joint : robot.joints()) {
+      const gtsam::Key key = internal::JointAngleKey(joint->id(), 0);
+      q.emplace_back(key);
+      graph.addExpressionFactor(q.back(), 0.5, cost_model);
+      initial.insert(key, 0.1);
+    }
+    for (size_t i = 0; i + 1 < q.size(); i++) {
+      constraints.emplace_shared<DoubleExpressionEquality>(
+          q[i] + Double_(&Square, q[i + 1]), 1e-3);
+    }
+  }
+};
+}  // namespace
+
+static void PenaltySolve(benchmark::State &state) {
+  const JointProblem problem(GetRobot(state.range(0)));
+  PenaltyMethodOptimizer optimizer;
+  for (auto _ : state) {
+    auto result =
+        optimizer.optimize(problem.graph, problem.constraints, problem.initial);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetLabel(kModels[state.range(0)].name);
+}
+BENCHMARK_MODELS(PenaltySolve);
+
+static void AugmentedLagrangianSolve(benchmark::State &state) {
+  const JointProblem problem(GetRobot(state.range(0)));
+  AugmentedLagrangianOptimizer optimizer;
+  for (auto _ : state) {
+    auto result =
+        optimizer.optimize(problem.graph, problem.constraints, problem.initial);
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetLabel(kModels[state.range(0)].name);
+}
+BENCHMARK_MODELS(AugmentedLagrangianSolve);
@@ -0,0 +1,223 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchScaling.cpp
+ * @brief Scaling of trajectory optimization with horizon length, collocation
+ * scheme and robot size.
+ *
+ * Every benchmark takes (model, horizon, collocation, ordering) arguments and
+ * reports, besides the time of the timed part, the counters
+ *   factors, variables:  size of the trajectory graph
+ *   jacobian_nnz:        entries of the dense Jacobian blocks
+ *   bayes_net_nnz:       entries of the eliminated Bayes net (fill-in)
+ *   peak_rss_mb:         peak resident memory of the process so far
+ * Peak RSS is a process high-water mark, so run one configuration per process
+ * with --benchmark_filter to attribute it, e.g.
+ *   gtdynamics_benchmarks \
+ *     --benchmark_filter='TrajectorySolve/single_phase/model:3/horizon:5000/'
+ */
+
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <sys/resource.h>
+
+#include <vector>
+
+#include "BenchmarkModels.h"
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/TimeMajorOrdering.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+namespace {
+
+// Models in increasing number of degrees of freedom, with fixed bases.
+const BenchmarkModel kScalingModels[] = {
+    {"cart_pole", "cart_pole.urdf", false, "l0"},
+    {"panda", "panda/panda.urdf", false, "link0"},
+    {"a1", "a1/a1.urdf", false, "trunk"},
+    {"atlas", "atlas.urdf", false, "pelvis"},
+};
+constexpr int kNumScalingModels =
+    sizeof(kScalingModels) / sizeof(kScalingModels[0]);
+
+const gtsam::Vector3 kGravity(0, 0, -9.8);
+constexpr double kDt = 0.01;
+
+enum OrderingType { Colamd, TimeMajor };
+
+// Sweep model x horizon x collocation x ordering.
+void ScalingArguments(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"model", "horizon", "collocation", "ordering"});
+  for (int i = 0; i < kNumScalingModels; i++)
+    for (int horizon : {10, 50, 250, 1000, 5000})
+      for (int collocation : {Euler, Trapezoidal})
+        for (int ordering : {Colamd, TimeMajor})
+          b->Args({i, horizon, collocation, ordering});
+}
+
+// Peak resident set size of the process, in MB.
+double PeakRssMb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+  return usage.ru_maxrss / 1024.0;  // kilobytes
+#endif
+}
+
+// Entries of the dense blocks of Jacobian factors, including conditionals.
+template <class GRAPH>
+double DenseEntries(const GRAPH &graph) {
+  double nnz = 0;
+  for (auto &&factor : graph) {
+    if (auto jacobian =
+            boost::dynamic_pointer_cast<gtsam::JacobianFactor>(factor))
+      nnz += jacobian->rows() * (jacobian->cols() - 1);
+  }
+  return nnz;
+}
+
+/**
+ * A trajectory problem: the trajectory graph, with priors on the initial
+ * state and the torques so it is well determined, and zero initial values.
+ * Multi-phase problems split the horizon into two phases, whose durations
+ * are variables.
+ */
+struct TrajectoryProblem {
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values values;
+  std::vector<int> phase_steps;
+
+  TrajectoryProblem(const DynamicsGraph &graph_builder, const Robot &robot,
+                    int horizon, CollocationScheme collocation,
+                    bool multi_phase) {
+    if (multi_phase) {
+      phase_steps = {horizon / 2, horizon - horizon / 2};
+      values = ZeroValuesTrajectory(robot, horizon, 2);
+      graph = Build(graph_builder, robot, horizon, collocation);
+      for (int p = 0; p < 2; p++)
+        graph.addPrior<double>(PhaseKey(p), kDt,
+                               graph_builder.opt().time_cost_model);
+    } else {
+      values = ZeroValuesTrajectory(robot, horizon);
+      graph = Build(graph_builder, robot, horizon, collocation);
+    }
+    graph.add(graph_builder.trajectoryFDPriors(robot, horizon, values));
+  }
+
+  // Build the trajectory graph alone, the part timed by TrajectoryConstruction.
+  gtsam::NonlinearFactorGraph Build(const DynamicsGraph &graph_builder,
+                                    const Robot &robot, int horizon,
+                                    CollocationScheme collocation) const {
+    if (phase_steps.empty())
+      return graph_builder.trajectoryFG(robot, horizon, kDt, collocation);
+    const std::vector<gtsam::NonlinearFactorGraph> transition_graphs{
+        graph_builder.dynamicsFactorGraph(robot, phase_steps[0])};
+    return graph_builder.multiPhaseTrajectoryFG(robot, phase_steps,
+                                                transition_graphs, collocation);
+  }
+};
+
+gtsam::Ordering MakeOrdering(const Robot &robot,
+                             const gtsam::NonlinearFactorGraph &graph,
+                             OrderingType type) {
+  if (type == TimeMajor) return TimeMajorOrdering(robot, graph);
+  return gtsam::Ordering::Colamd(graph);
+}
+
+void SetCounters(benchmark::State &state, const TrajectoryProblem &problem,
+                 const gtsam::GaussianFactorGraph &linear_graph,
+                 const gtsam::GaussianBayesNet &bayes_net) {
+  state.counters["factors"] = problem.graph.size();
+  state.counters["variables"] = problem.values.size();
+  state.counters["jacobian_nnz"] = DenseEntries(linear_graph);
+  state.counters["bayes_net_nnz"] = DenseEntries(bayes_net);
+  state.counters["peak_rss_mb"] = PeakRssMb();
+  state.SetLabel(kScalingModels[state.range(0)].name);
+}
+
+// Time to build the trajectory graph.
+void TrajectoryConstruction(benchmark::State &state, bool multi_phase) {
+  const Robot &robot = GetRobot(kScalingModels[state.range(0)]);
+  const int horizon = state.range(1);
+  const auto collocation = static_cast<CollocationScheme>(state.range(2));
+  DynamicsGraph graph_builder(kGravity);
+  const TrajectoryProblem problem(graph_builder, robot, horizon, collocation,
+                                  multi_phase);
+  for (auto _ : state) {
+    auto graph = problem.Build(graph_builder, robot, horizon, collocation);
+    benchmark::DoNotOptimize(graph);
+  }
+  state.counters["factors"] = problem.graph.size();
+  state.counters["peak_rss_mb"] = PeakRssMb();
+  state.SetLabel(kScalingModels[state.range(0)].name);
+}
+
+// Time to linearize the graph.
+void TrajectoryLinearize(benchmark::State &state, bool multi_phase) {
+  const Robot &robot = GetRobot(kScalingModels[state.range(0)]);
+  DynamicsGraph graph_builder(kGravity);
+  const TrajectoryProblem problem(
+      graph_builder, robot, state.range(1),
+      static_cast<CollocationScheme>(state.range(2)), multi_phase);
+  for (auto _ : state) {
+    auto linear_graph = problem.graph.linearize(problem.values);
+    benchmark::DoNotOptimize(linear_graph);
+  }
+  const auto linear_graph = problem.graph.linearize(problem.values);
+  const auto ordering = MakeOrdering(
+      robot, problem.graph, static_cast<OrderingType>(state.range(3)));
+  SetCounters(state, problem, *linear_graph,
+              *linear_graph->eliminateSequential(ordering));
+}
+
+// Time of one Gauss-Newton step: ordering, elimination and back-substitution.
+void TrajectorySolve(benchmark::State &state, bool multi_phase) {
+  const Robot &robot = GetRobot(kScalingModels[state.range(0)]);
+  DynamicsGraph graph_builder(kGravity);
+  const TrajectoryProblem problem(
+      graph_builder, robot, state.range(1),
+      static_cast<CollocationScheme>(state.range(2)), multi_phase);
+  const auto type = static_cast<OrderingType>(state.range(3));
+  const auto linear_graph = problem.graph.linearize(problem.values);
+  gtsam::GaussianBayesNet::shared_ptr bayes_net;
+  for (auto _ : state) {
+    const auto ordering = MakeOrdering(robot, problem.graph, type);
+    bayes_net = linear_graph->eliminateSequential(ordering);
+    auto delta = bayes_net->optimize();
+    benchmark::DoNotOptimize(delta);
+  }
+  SetCounters(state, problem, *linear_graph, *bayes_net);
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(TrajectoryConstruction, single_phase, false)
+    ->Apply(ScalingArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(TrajectoryConstruction, multi_phase, true)
+    ->Apply(ScalingArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(TrajectoryLinearize, single_phase, false)
+    ->Apply(ScalingArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(TrajectoryLinearize, multi_phase, true)
+    ->Apply(ScalingArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(TrajectorySolve, single_phase, false)
+    ->Apply(ScalingArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(TrajectorySolve, multi_phase, true)
+    ->Apply(ScalingArguments)
+    ->Unit(benchmark::kMillisecond);
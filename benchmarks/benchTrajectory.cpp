@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  benchTrajectory.cpp
+ * @brief Benchmark building and linearizing trajectory factor graphs.
+ */
+
+#include "BenchmarkModels.h"
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+
+static const gtsam::Vector3 kGravity(0, 0, -9.8);
+static constexpr double kDt = 0.01;
+
+// Arguments: model index, number of steps.
+static void TrajectoryArguments(benchmark::internal::Benchmark *b) {
+  for (int i = 0; i < kNumModels; i++)
+    for (int num_steps : {10, 50}) b->Args({i, num_steps});
+}
+
+static void TrajectoryFG(benchmark::State &state) {
+  const Robot &robot = GetRobot(state.range(0));
+  const int num_steps = state.range(1);
+  DynamicsGraph graph_builder(kGravity);
+  for (auto _ : state) {
+    auto graph = graph_builder.trajectoryFG(robot, num_steps, kDt);
+    benchmark::DoNotOptimize(graph);
+  }
+  state.SetLabel(kModels[state.range(0)].name);
+}
+BENCHMARK(TrajectoryFG)->Apply(TrajectoryArguments);
+
+static void Linearize(benchmark::State &state) {
+  const Robot &robot = GetRobot(state.range(0));
+  const int num_steps = state.range(1);
+  DynamicsGraph graph_builder(kGravity);
+  const auto graph = graph_builder.trajectoryFG(robot, num_steps, kDt);
+  const gtsam::Values values = ZeroValuesTrajectory(robot, num_steps);
+  for (auto _ : state) {
+    auto linear_graph = graph.linearize(values);
+    benchmark::DoNotOptimize(linear_graph);
+  }
+  state.SetLabel(kModels[state.range(0)].name);
+  state.counters["factors"] = graph.size();
+}
+BENCHMARK(Linearize)->Apply(TrajectoryArguments);
@@ -0,0 +1,58 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  compare_benchmarks.py
+ * @brief Compare two JSON results of gtdynamics_benchmarks, to gate
+ *        performance regressions.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """Map from benchmark name to cpu time, in ns, of a JSON results file."""
+    units = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    with open(path) as f:
+        results = json.load(f)
+    times = {}
+    for b in results["benchmarks"]:
+        # Skip the mean/median/stddev rows of repeated runs.
+        if b.get("run_type", "iteration") != "iteration":
+            continue
+        name = b["name"]
+        if b.get("label"):
+            name += " [{}]".format(b["label"])
+        times[name] = b["cpu_time"] * units[b.get("time_unit", "ns")]
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compare gtdynamics_benchmarks JSON results.")
+    parser.add_argument("baseline", help="JSON results to compare against")
+    parser.add_argument("contender", help="new JSON results")
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="relative slowdown that fails, default 0.1")
+    args = parser.parse_args()
+
+    baseline, contender = load(args.baseline), load(args.contender)
+    regressions = 0
+    for name in sorted(baseline):
+        if name not in contender:
+            print("{:60s} missing".format(name))
+            continue
+        change = contender[name] / baseline[name] - 1.0
+        failed = change > args.threshold
+        regressions += failed
+        print("{:60s} {:+7.1%}{}".format(name, change,
+                                        "  REGRESSION" if failed else ""))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,198 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  constrained_solvers.cpp
+ * @brief Compare constrained optimizers on the inverse kinematics problems of
+ * the walking phases of the spider and the A1.
+ *
+ * Every solver gets the same problem: the constraints of
+ * Kinematics::constraints over an interval of each phase, with the stance
+ * feet held at their nominal positions, joint angle objectives and a prior on
+ * the base pose, from the same noisy initial values. For every solver and
+ * phase the results hold the wall time, the outer and inner iteration counts,
+ * the number of linearizations, the constraint violation after every outer
+ * iteration and the OptimizerProfile of the solve.
+ *
+ * Usage: constrained_solvers [output.json [steps_per_phase]]
+ * The results are written to stdout if no output file is given.
+ */
+
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkModels.h"
+#include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
+#include "gtdynamics/optimizer/ManifoldOptimizer.h"
+#include "gtdynamics/optimizer/PenaltyMethodOptimizer.h"
+#include "gtdynamics/optimizer/SQPOptimizer.h"
+#include "gtdynamics/utils/Interval.h"
+
+using namespace gtdynamics;
+using namespace gtdynamics::benchmarks;
+using gtsam::Point3;
+using gtsam::Values;
+
+namespace {
+
+/// A walking gait: feet, and the feet in stance in every phase.
+struct Gait {
+  BenchmarkModel model;
+  Point3 contact_in_com;  // contact point of every foot
+  std::vector<std::string> feet;
+  std::vector<std::vector<std::string>> stance;
+};
+
+const Gait kGaits[] = {
+    // Trot: diagonal pairs of legs alternate.
+    {{"a1", "a1/a1.urdf", false, "trunk"},
+     Point3(0, 0, -0.1),
+     {"FR_lower", "FL_lower", "RR_lower", "RL_lower"},
+     {{"FR_lower", "RL_lower"}, {"FL_lower", "RR_lower"}}},
+    // Alternating tetrapod: four legs in stance at a time.
+    {{"spider", "spider.sdf", true, "body"},
+     Point3(0, 0.19, 0),
+     {"tarsus_1_L1", "tarsus_2_L2", "tarsus_3_L3", "tarsus_4_L4",
+      "tarsus_5_R4", "tarsus_6_R3", "tarsus_7_R2", "tarsus_8_R1"},
+     {{"tarsus_1_L1", "tarsus_3_L3", "tarsus_6_R3", "tarsus_8_R1"},
+      {"tarsus_2_L2", "tarsus_4_L4", "tarsus_5_R4", "tarsus_7_R2"}}},
+};
+
+/// A constrained optimizer to compare, by name.
+struct Solver {
+  std::string name;
+  boost::shared_ptr<const ConstrainedOptimizer> optimizer;
+  // False if intermediate values miss variables, as for ManifoldOptimizer.
+  bool full_intermediate_values;
+};
+
+std::vector<Solver> Solvers(const Robot &robot) {
+  auto al = boost::make_shared<AugmentedLagrangianOptimizer>();
+  return {{"penalty", boost::make_shared<PenaltyMethodOptimizer>(), true},
+          {"augmented_lagrangian", al, true},
+          {"sqp", boost::make_shared<SQPOptimizer>(), true},
+          {"manifold_augmented_lagrangian",
+           boost::make_shared<ManifoldOptimizer>(robot, al), false}};
+}
+
+/// Nominal foot positions, at zero joint angles with the base at identity.
+ContactGoals NominalGoals(const Robot &robot, const Gait &gait,
+                          const std::vector<std::string> &feet) {
+  Values angles;
+  for (auto &&joint : robot.joints())
+    InsertJointAngle(&angles, joint->id(), 0, 0.0);
+  const Values poses =
+      robot.forwardKinematics(angles, 0, std::string(gait.model.base));
+  ContactGoals goals;
+  for (auto &&foot : feet) {
+    const PointOnLink point_on_link(robot.link(foot), gait.contact_in_com);
+    goals.emplace_back(point_on_link, point_on_link.predict(poses, 0));
+  }
+  return goals;
+}
+
+/// Write a vector of numbers as a JSON list.
+template <typename T>
+void WriteList(std::ostream &os, const std::vector<T> &list) {
+  os << "[";
+  for (size_t i = 0; i < list.size(); i++) os << (i ? ", " : "") << list[i];
+  os << "]";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const size_t steps_per_phase = argc > 2 ? std::stoul(argv[2]) : 3;
+  std::ostringstream json;
+  json << std::setprecision(10) << "[";
+  bool first = true;
+
+  const Kinematics kinematics;
+  for (const Gait &gait : kGaits) {
+    const Robot &robot = GetRobot(gait.model, false);
+    for (size_t p = 0; p < gait.stance.size(); p++) {
+      const Interval interval(p * steps_per_phase,
+                              (p + 1) * steps_per_phase - 1);
+
+      // The problem, shared by all solvers.
+      auto constraints = kinematics.constraints(interval, robot);
+      constraints.add(kinematics.pointGoalConstraints(
+          interval, NominalGoals(robot, gait, gait.stance[p])));
+      auto graph = kinematics.jointAngleObjectives(interval, robot);
+      const int base = robot.link(gait.model.base)->id();
+      for (size_t k = interval.k_start; k <= interval.k_end; k++)
+        graph.addPrior<gtsam::Pose3>(internal::PoseKey(base, k),
+                                     gtsam::Pose3(),
+                                     gtsam::noiseModel::Unit::Create(6));
+      const Values initial_values = kinematics.initialValues(interval, robot);
+
+      for (const Solver &solver : Solvers(robot)) {
+        ConstrainedOptResult intermediate;
+        std::string error;
+        Values result;
+        const ProfileTimer timer;
+        try {
+          result = solver.optimizer->optimize(graph, constraints,
+                                              initial_values, &intermediate);
+        } catch (const std::exception &e) {
+          error = e.what();
+        }
+        const double wall_time = timer.elapsed();
+
+        std::vector<double> violations;
+        if (solver.full_intermediate_values) {
+          for (auto &&values : intermediate.intermediate_values)
+            violations.push_back(std::sqrt(constraints.evaluate(values)));
+        }
+        size_t inner_iterations = 0;
+        for (int n : intermediate.num_iters) inner_iterations += n;
+
+        json << (first ? "\n" : ",\n") << "{\"robot\": \"" << gait.model.name
+             << "\", \"phase\": " << p << ", \"solver\": \"" << solver.name
+             << "\", \"constraints\": " << constraints.size()
+             << ", \"wall_time\": " << wall_time
+             << ", \"outer_iterations\": " << intermediate.num_iters.size()
+             << ", \"inner_iterations\": " << inner_iterations
+             << ", \"linearizations\": "
+             << intermediate.profile.num_linearizations
+             << ", \"violations\": ";
+        WriteList(json, violations);
+        if (error.empty()) {
+          json << ", \"violation\": "
+               << std::sqrt(constraints.evaluate(result))
+               << ", \"cost\": " << graph.error(result);
+        } else {
+          json << ", \"error\": \"" << error << "\"";
+        }
+        json << ", \"profile\": " << intermediate.profile.toJson() << "}";
+        first = false;
+
+        std::cerr << gait.model.name << " phase " << p << " " << solver.name
+                  << ": " << wall_time << " s"
+                  << (error.empty() ? "" : ", failed: " + error) << "\n";
+      }
+    }
+  }
+  json << "\n]\n";
+
+  if (argc > 1) {
+    std::ofstream file(argv[1]);
+    file << json.str();
+  } else {
+    std::cout << json.str();
+  }
+  return 0;
+}
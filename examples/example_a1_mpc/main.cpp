@@ -0,0 +1,207 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  main.cpp
+ * @brief Receding-horizon control of the Unitree A1 legs in a fixed-rate
+ * loop, with a report of the latency of every cycle.
+ *
+ * Every cycle measures the state of the simulated robot, adds it as a prior
+ * on the first step of the window, runs the incremental solver, applies the
+ * torques of the first step to the Simulator, and advances the window, warm
+ * started from the last step. The Simulator has no ground contact, so the
+ * trunk is fixed and the legs track a trotting joint reference in the air.
+ *
+ * Usage: example_a1_mpc [num_cycles] [horizon] [realtime]
+ *   num_cycles  control cycles to run, 500 by default
+ *   horizon     time steps in the window, 10 by default
+ *   realtime    1 (default) to sleep until every period ends, 0 to run the
+ *               cycles back to back
+ */
+
+#include <gtdynamics/config.h>
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/RecedingHorizonPlanner.h>
+#include <gtdynamics/dynamics/Simulator.h>
+#include <gtdynamics/dynamics/SimulatorMetrics.h>
+#include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/LatencyHistogram.h>
+#include <gtdynamics/utils/initialize_solution_utils.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::noiseModel::Isotropic;
+
+using namespace gtdynamics;
+
+// Joint angle reference of a trot: diagonal legs in phase, swinging the upper
+// and lower joints around a crouched stance.
+double Reference(const std::string& name, double t) {
+  const double kFrequency = 2.0, kPi = 3.14159265358979;
+  const bool diagonal = name.rfind("FR", 0) == 0 || name.rfind("RL", 0) == 0;
+  const double phase = 2 * kPi * kFrequency * t + (diagonal ? 0.0 : kPi);
+  if (name.find("upper") != std::string::npos)
+    return 0.7 + 0.2 * std::sin(phase);
+  if (name.find("lower") != std::string::npos)
+    return -1.4 + 0.3 * std::max(0.0, std::sin(phase));
+  return 0.0;
+}
+
+// Tracking and torque objectives of time step k.
+NonlinearFactorGraph Objectives(const Robot& robot, int k, double dt) {
+  static const auto angle_model = Isotropic::Sigma(1, 1e-2),
+                    torque_model = Isotropic::Sigma(1, 1e1);
+  NonlinearFactorGraph objectives;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    objectives.add(JointObjectives(j, k).angle(
+        Reference(joint->name(), k * dt), angle_model));
+    objectives.addPrior(internal::TorqueKey(j, k), 0.0, torque_model);
+  }
+  return objectives;
+}
+
+// The measured state as priors on time step k.
+NonlinearFactorGraph Feedback(const Robot& robot, const Vector& q,
+                              const Vector& v, int k) {
+  static const auto model = Isotropic::Sigma(1, 1e-4);
+  NonlinearFactorGraph feedback;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    feedback.add(JointObjectives(j, k)
+                     .angle(q(j), model)
+                     .velocity(v(j), model));
+  }
+  return feedback;
+}
+
+int main(int argc, char** argv) {
+  const int num_cycles = argc > 1 ? std::atoi(argv[1]) : 500;
+  const int horizon = argc > 2 ? std::atoi(argv[2]) : 10;
+  const bool realtime = argc > 3 ? std::atoi(argv[3]) != 0 : true;
+
+  // Unitree A1 with the trunk fixed in the air.
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"))
+          .fixLink("trunk");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const DynamicsGraph graph_builder(gravity);
+
+  // Control period, also the deadline of a cycle.
+  RecedingHorizonParameters parameters;
+  parameters.horizon = horizon;
+  parameters.dt = 0.01;
+  parameters.isam2.relinearizeThreshold = 0.01;
+  parameters.isam2.relinearizeSkip = 1;
+  const double dt = parameters.dt;
+  RecedingHorizonPlanner planner(robot, graph_builder, parameters);
+
+  // Plant, with the ArticulatedBody method.
+  Values initial_state;
+  for (auto&& joint : robot.joints()) {
+    InsertJointAngle(&initial_state, joint->id(),
+                     Reference(joint->name(), 0.0));
+    InsertJointVel(&initial_state, joint->id(), 0.0);
+  }
+  Simulator simulator(robot, initial_state, gravity, boost::none,
+                      ArticulatedBody);
+
+  // The first window is solved before the loop starts.
+  NonlinearFactorGraph objectives =
+      Feedback(robot, simulator.jointAngles(), simulator.jointVels(), 0);
+  for (int k = 0; k <= horizon; k++) objectives.add(Objectives(robot, k, dt));
+  planner.initialize(objectives, ZeroValuesTrajectory(robot, horizon));
+  planner.iterate(10);
+
+  LatencyHistogram feedback_latency, solve_latency, advance_latency,
+      simulate_latency, cycle_latency;
+  size_t deadline_misses = 0;
+  double tracking_error = 0;
+  Vector tau = Vector::Zero(simulator.jointAngles().size());
+  const auto period =
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(dt));
+  auto next_period = std::chrono::steady_clock::now();
+  for (int cycle = 0; cycle < num_cycles; cycle++) {
+    MetricsTimer cycle_timer(true), timer(true);
+
+    // Measure the state and constrain the first step to it.
+    const int k = planner.firstStep();
+    planner.addObjectives(Feedback(robot, simulator.jointAngles(),
+                                   simulator.jointVels(), k));
+    timer.stop(&feedback_latency);
+
+    // One incremental solve, and the torques of the first step.
+    planner.iterate(1);
+    for (auto&& joint : robot.joints()) {
+      const int j = joint->id();
+      tau(j) = planner.isam().calculateEstimate<double>(
+          internal::TorqueKey(j, k));
+    }
+    timer.stop(&solve_latency);
+
+    // Move the window, warm started from its last step.
+    const int t = planner.lastStep() + 1;
+    planner.advance(Objectives(robot, t, dt));
+    timer.stop(&advance_latency);
+    const double latency = cycle_timer.stop(&cycle_latency);
+    if (latency > dt) deadline_misses++;
+
+    // Simulated feedback for the next cycle.
+    timer.restart();
+    simulator.step(tau, dt);
+    timer.stop(&simulate_latency);
+    for (auto&& joint : robot.joints()) {
+      const double error = simulator.jointAngles()(joint->id()) -
+                           Reference(joint->name(), (k + 1) * dt);
+      tracking_error = std::max(tracking_error, std::abs(error));
+    }
+
+    next_period += period;
+    if (realtime) {
+      if (std::chrono::steady_clock::now() < next_period)
+        std::this_thread::sleep_until(next_period);
+      else
+        next_period = std::chrono::steady_clock::now();
+    }
+  }
+
+  // Latency distribution of every part of the cycle.
+  std::cout << "cycles: " << num_cycles << ", horizon: " << horizon
+            << ", period: " << 1e3 * dt << " ms\n";
+  std::cout << "deadline misses: " << deadline_misses << " ("
+            << 100.0 * deadline_misses / std::max(num_cycles, 1) << "%)\n";
+  std::cout << "largest tracking error: " << tracking_error << " rad\n";
+  std::cout << "cycle latency, ms: p50 " << 1e3 * cycle_latency.percentile(50)
+            << ", p90 " << 1e3 * cycle_latency.percentile(90) << ", p99 "
+            << 1e3 * cycle_latency.percentile(99) << ", max "
+            << 1e3 * cycle_latency.max() << "\n";
+
+  std::ofstream json("a1_mpc_latency.json");
+  json << "{\n  \"deadline\": " << dt
+       << ",\n  \"deadline_misses\": " << deadline_misses
+       << ",\n  \"cycle\": " << cycle_latency.toJson(2)
+       << ",\n  \"feedback\": " << feedback_latency.toJson(2)
+       << ",\n  \"solve\": " << solve_latency.toJson(2)
+       << ",\n  \"advance\": " << advance_latency.toJson(2)
+       << ",\n  \"simulate\": " << simulate_latency.toJson(2) << "\n}\n";
+  std::cout << "latency histograms written to a1_mpc_latency.json\n";
+  return 0;
+}
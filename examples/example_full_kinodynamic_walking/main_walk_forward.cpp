@@ -15,8 +15,10 @@
 #include <gtdynamics/dynamics/OptimizerSetting.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/factors/PointGoalFactor.h>
+#include <gtdynamics/optimizer/OptimizerProfile.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/universal_robot/sdf.h>
+#include <gtdynamics/utils/ThreadPool.h>
 #include <gtdynamics/utils/initialize_solution_utils.h>
 #include <gtsam/linear/NoiseModel.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
@@ -28,6 +30,8 @@
 #include <boost/optional.hpp>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <utility>
 
 #define GROUND_HEIGHT -0.191839
@@ -290,8 +294,21 @@ int main(int argc, char** argv) {
   params.setlambdaInitial(1e0);
   params.setlambdaLowerBound(1e-7);
   params.setlambdaUpperBound(1e10);
-  gtsam::LevenbergMarquardtOptimizer optimizer(graph, init_vals, params);
-  gtsam::Values results = optimizer.optimize();
+
+  // Optional first argument: number of threads for linearization, 0 for all
+  // cores. Compare the reported linearization times to benchmark it.
+  const size_t num_threads = argc > 1 ? std::stoul(argv[1]) : 1;
+  std::unique_ptr<ThreadPool> pool;
+  if (num_threads != 1) pool.reset(new ThreadPool(num_threads));
+  OptimizerProfile profile;
+  const ProfileTimer timer;
+  gtsam::Values results =
+      OptimizeLM(graph, init_vals, params, &profile, nullptr, pool.get());
+  profile.total = timer.elapsed();
+  std::cout << graph.size() << " factors, "
+            << (pool ? pool->numThreads() : 1) << " linearization threads"
+            << std::endl;
+  profile.print(std::cout);
 
   // Log the joint angles, velocities, accels, torques, and current goal pose.
   vector<string> joint_names;
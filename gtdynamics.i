@@ -146,6 +146,32 @@ class ContactHeightFactor : gtsam::NonlinearFactor {
   gtsam::Vector evaluateError(const gtsam::Pose3 &sTl) const;
 };
 
+#include <gtdynamics/factors/ContactComplementarityFactor.h>
+enum ComplementarityScheme { RelaxedComplementarity, SmoothedComplementarity };
+
+class ComplementarityParams {
+  ComplementarityParams();
+  gtdynamics::ComplementarityScheme scheme;
+  double epsilon;
+  double force_scale;
+  double sigma;
+  double ground_height;
+};
+
+class ContactComplementarityFactor : gtsam::NonlinearFactor {
+  ContactComplementarityFactor(gtsam::Key pose_key,
+                               gtsam::Key contact_wrench_key,
+                               const gtsam::Point3 &comPc,
+                               const gtsam::Vector3 &gravity,
+                               const gtdynamics::ComplementarityParams &params);
+
+  void print(const string &s = "", const gtsam::KeyFormatter &keyFormatter =
+                                       gtdynamics::GTDKeyFormatter);
+
+  gtsam::Vector evaluateError(const gtsam::Pose3 &sTl,
+                              const gtsam::Vector6 &contact_wrench) const;
+};
+
 /********************** link **********************/
 #include <gtdynamics/universal_robot/Link.h>
 class Link  {
@@ -258,12 +284,20 @@ class Robot {
 
   gtdynamics::Joint* joint(string name) const;
 
-  gtdynamics::Robot fixLink(const string& name);
+  gtdynamics::Robot fixLink(const string& name) const;
+
+  gtdynamics::Robot unfixLink(const string& name) const;
 
   int numLinks() const;
 
   int numJoints() const;
 
+  void addFrame(const string &name, const string &link_name,
+                const gtsam::Pose3 &comTf);
+  bool hasFrame(const string &name) const;
+  gtsam::Pose3 framePose(const gtsam::Values &values, const string &name,
+                         size_t t = 0) const;
+
   void print(const string &s = "") const;
 
   gtsam::Values forwardKinematics(
@@ -276,8 +310,7 @@ class Robot {
       const gtsam::Values &known_values, size_t t,
       const boost::optional<string> &prior_link_name) const;
 
-  // enabling serialization functionality
-  void serialize() const;
+  // Pickled in binary, see python/specializations/gtdynamics.h.
 };
 
 #include <gtdynamics/universal_robot/sdf.h>
@@ -285,6 +318,55 @@ class Robot {
 gtdynamics::Robot CreateRobotFromFile(const string& urdf_file_path);
 gtdynamics::Robot CreateRobotFromFile(const string& file_path, 
                                     const string& model_name);
+gtdynamics::Robot CreateRobotFromFile(const string& file_path,
+                                      const string& model_name,
+                                      bool use_cache);
+gtdynamics::Robot CreateRobotFromFile(const string& file_path,
+                                      const string& model_name,
+                                      bool use_cache, bool lump_fixed_joints);
+std::map<string, gtdynamics::Robot> CreateRobotsFromFile(
+    const string& file_path, const std::vector<string>& model_names,
+    size_t num_threads);
+
+#include <gtdynamics/universal_robot/BatchForwardKinematics.h>
+class PoseBatch {
+  PoseBatch();
+  gtsam::Matrix data;
+  size_t size() const;
+  gtsam::Pose3 pose(size_t b, int i) const;
+};
+
+class BatchForwardKinematics {
+  BatchForwardKinematics(const gtdynamics::Robot &robot);
+  BatchForwardKinematics(const gtdynamics::Robot &robot, size_t num_threads);
+  size_t numThreads() const;
+  gtdynamics::PoseBatch compute(const gtsam::Matrix &configurations);
+};
+
+#include <gtdynamics/kinematics/ReachabilityMap.h>
+class ReachabilityMapParameters {
+  ReachabilityMapParameters();
+  gtsam::Point3 lower;
+  gtsam::Point3 upper;
+  double resolution;
+  size_t rotation_bins;
+  size_t num_samples;
+  size_t num_threads;
+};
+
+class ReachabilityMap {
+  static gtdynamics::ReachabilityMap Compute(
+      const gtdynamics::Robot &robot, const string &link_name,
+      const gtdynamics::ReachabilityMapParameters &parameters);
+  static gtdynamics::ReachabilityMap MemoryMapped(const string &path);
+  void write(const string &path) const;
+  bool reachable(const gtsam::Pose3 &pose) const;
+  size_t count(const gtsam::Pose3 &pose) const;
+  double reachabilityIndex(const gtsam::Point3 &position) const;
+  size_t numCells() const;
+  size_t numReachable() const;
+  size_t numJointSlots() const;
+};
 
 
 /********************** utilities **********************/
@@ -303,13 +385,30 @@ class PointOnLink {
 
 // PointOnLinks defined in specializations.h
 
+#include <gtdynamics/kinematics/ContactBatch.h>
+gtdynamics::PoseBatch GatherPoses(const gtsam::Values &values,
+                                  const std::vector<int> &link_ids,
+                                  size_t num_steps);
+gtsam::Matrix PredictPoints(const gtdynamics::PointOnLinks &points,
+                            const gtdynamics::PoseBatch &poses);
+
 /********************** Optimizer **********************/
 #include <gtdynamics/optimizer/Optimizer.h>
 class OptimizationParameters {
   gtsam::LevenbergMarquardtParams lm_parameters;
+  size_t num_threads;
+  bool block_tridiagonal;
+  double time_budget;
   OptimizationParameters();
 };
 
+class Optimizer {
+  Optimizer(const gtdynamics::OptimizationParameters &parameters =
+                gtdynamics::OptimizationParameters());
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values) const;
+};
+
 /********************** kinematics **********************/
 #include <gtdynamics/kinematics/Kinematics.h>
 
@@ -382,9 +481,24 @@ class OptimizerSetting {
   gtsam::noiseModel::SharedNoiseModel twist_col_cost_model;      // twist collocation factor
   gtsam::noiseModel::SharedNoiseModel time_cost_model;           // time prior
   gtsam::noiseModel::SharedNoiseModel jl_cost_model;             // joint limit factor
+  size_t collocation_bank_steps;                                 // steps per collocation bank
+  bool arena_allocation;                                         // factors in a FactorArena
+
+  void setCollocationBank(size_t steps);
+  void setArenaAllocation(bool arena);
 };
 
 
+#include <gtdynamics/utils/FactorStatistics.h>
+class FactorTypeStatistics {
+  FactorTypeStatistics();
+  string type;
+  size_t count;
+  size_t dimension;
+  double error;
+  double linearize_time;
+};
+
 #include<gtdynamics/dynamics/DynamicsGraph.h>
 enum CollocationScheme { Euler, RungeKutta, Trapezoidal, HermiteSimpson };
 
@@ -452,6 +566,16 @@ class DynamicsGraph {
       const gtdynamics::Robot &robot, const int num_steps,
       const gtsam::Values &known_values) const;
 
+  static gtsam::Values forwardDynamicsConstants(
+      const gtdynamics::Robot &robot, const int t,
+      const gtsam::Values &known_values);
+  static gtsam::Values inverseDynamicsConstants(
+      const gtdynamics::Robot &robot, const int t,
+      const gtsam::Values &known_values);
+  static gtsam::Values trajectoryFDConstants(
+      const gtdynamics::Robot &robot, const int num_steps,
+      const gtsam::Values &known_values);
+
   gtsam::NonlinearFactorGraph trajectoryFG(
       const gtdynamics::Robot &robot, const int num_steps, const double dt) const;
 
@@ -461,6 +585,11 @@ class DynamicsGraph {
       const boost::optional<gtdynamics::PointOnLinks> &contact_points,
       const boost::optional<double> &mu) const;
 
+  gtsam::NonlinearFactorGraph contactImplicitTrajectoryFG(
+      const gtdynamics::Robot &robot, const int num_steps, const double dt,
+      const gtdynamics::PointOnLinks &candidate_points,
+      const gtdynamics::ComplementarityParams &complementarity) const;
+
   gtsam::NonlinearFactorGraph multiPhaseTrajectoryFG(
       const gtdynamics::Robot &robot,
       const std::vector<int> &phase_steps,
@@ -497,6 +626,10 @@ class DynamicsGraph {
       const gtdynamics::Robot &robot, const int t, const double dt,
       const gtdynamics::CollocationScheme collocation) const;
 
+  gtsam::NonlinearFactorGraph collocationBankFactors(
+      const gtdynamics::Robot &robot, const int t, const int num_steps,
+      const double dt, const gtdynamics::CollocationScheme collocation) const;
+
   gtsam::NonlinearFactorGraph multiPhaseCollocationFactors(
       const gtdynamics::Robot &robot, const int t, const int phase,
       const gtdynamics::CollocationScheme collocation) const;
@@ -527,6 +660,20 @@ class DynamicsGraph {
   static Vector jointTorques(const gtdynamics::Robot &robot,
                                     const gtsam::Values &result, const int t);
 
+  /* joint values of a trajectory, num_steps x #joints. */
+  static gtsam::Matrix jointAnglesTrajectory(const gtdynamics::Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps);
+  static gtsam::Matrix jointVelsTrajectory(const gtdynamics::Robot &robot,
+                                           const gtsam::Values &result,
+                                           size_t num_steps);
+  static gtsam::Matrix jointAccelsTrajectory(const gtdynamics::Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps);
+  static gtsam::Matrix jointTorquesTrajectory(const gtdynamics::Robot &robot,
+                                              const gtsam::Values &result,
+                                              size_t num_steps);
+
   static gtdynamics::JointValueMap jointAccelsMap(const gtdynamics::Robot &robot,
                                            const gtsam::Values &result,
                                            const int t);
@@ -552,6 +699,14 @@ class DynamicsGraph {
   /* print the values */
   static void printValues(const gtsam::Values &values);
 
+  /* total error, count and linearization time by factor type */
+  static std::vector<gtdynamics::FactorTypeStatistics> factorStatistics(
+      const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+      size_t repetitions = 1);
+  static void printFactorStatistics(const gtsam::NonlinearFactorGraph &graph,
+                                    const gtsam::Values &values,
+                                    size_t repetitions = 1);
+
   static void saveGraph(const string &file_path,
                         const gtsam::NonlinearFactorGraph &graph,
                         const gtsam::Values &values, const gtdynamics::Robot &robot,
@@ -563,14 +718,28 @@ class DynamicsGraph {
                                   const gtdynamics::Robot &robot, const int num_steps,
                                   bool radial);
 
+  static void saveGraphTiles(const string &directory,
+                             const gtsam::NonlinearFactorGraph &graph,
+                             const gtsam::Values &values,
+                             const gtdynamics::Robot &robot,
+                             size_t window_steps, bool radial);
+
   static void saveGraphTraj(const string &file_path,
                             const gtsam::NonlinearFactorGraph &graph,
                             const gtsam::Values &values, const int num_steps);
 
+  static void saveTrajectory(const string &file_path,
+                             const gtdynamics::Robot &robot,
+                             const gtsam::Values &values, const int num_steps);
+
   /* return the optimizer setting. */
   const gtdynamics::OptimizerSetting &opt() const;
 };
 
+#include <gtdynamics/factors/FoldedFactor.h>
+gtsam::NonlinearFactorGraph FoldConstants(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &constants);
+
 /********************** Objective Factors **********************/
 #include <gtdynamics/factors/ObjectiveFactors.h>
 class LinkObjectives : gtsam::NonlinearFactorGraph {
@@ -634,12 +803,12 @@ class DynamicsSymbol {
   DynamicsSymbol(const gtdynamics::DynamicsSymbol& key);
 
   static DynamicsSymbol LinkJointSymbol(const string& s,
-                                        uint8_t link_idx,
-                                        uint8_t joint_idx,
+                                        int link_idx,
+                                        int joint_idx,
                                         std::uint64_t t);
   static DynamicsSymbol JointSymbol(const string& s,
-                                    uint8_t joint_idx, std::uint64_t t);
-  static DynamicsSymbol LinkSymbol(const string& s, uint8_t link_idx,
+                                    int joint_idx, std::uint64_t t);
+  static DynamicsSymbol LinkSymbol(const string& s, int link_idx,
                                    std::uint64_t t);
   static DynamicsSymbol SimpleSymbol(const string& s, std::uint64_t t);
 
@@ -731,9 +900,243 @@ gtsam::Vector Wrench(const gtsam::VectorValues &values, int i, int j, int t=0);
 
 gtsam::Vector6 Wrench(const gtsam::Values &values, int i, int j, int t=0);
 
+/********************** DynamicsValues **********************/
+#include <gtdynamics/utils/DynamicsValues.h>
+
+// The dense buffers are exposed as numpy views in the specializations:
+// jointAngles(), jointVels(), jointAccels(), torques(), twists() and
+// twistAccels().
+class DynamicsValues {
+  DynamicsValues(const gtdynamics::Robot &robot, size_t num_steps = 1);
+  static gtdynamics::DynamicsValues FromValues(const gtdynamics::Robot &robot,
+                                               const gtsam::Values &values,
+                                               size_t num_steps = 1);
+
+  size_t numSteps() const;
+  size_t numJointSlots() const;
+  size_t numLinkSlots() const;
+
+  double jointAngle(int j, int t = 0) const;
+  double jointVel(int j, int t = 0) const;
+  double jointAccel(int j, int t = 0) const;
+  double torque(int j, int t = 0) const;
+  const gtsam::Pose3 &pose(int i, int t = 0) const;
+  gtsam::Vector6 twist(int i, int t = 0) const;
+  gtsam::Vector6 twistAccel(int i, int t = 0) const;
+  gtsam::Vector6 wrench(int i, int j, int t = 0) const;
+
+  void clear();
+  void assign(const gtsam::Values &values);
+  gtsam::Values toValues() const;
+};
+
+/********************** RecursiveDynamics **********************/
+#include <gtdynamics/dynamics/RecursiveDynamics.h>
+
+class RecursiveDynamics {
+  RecursiveDynamics(const gtdynamics::Robot &robot);
+  RecursiveDynamics(const gtdynamics::Robot &robot,
+                    const boost::optional<gtsam::Vector3> &gravity);
+
+  gtsam::Values solveForwardDynamics(const gtsam::Values &known_values,
+                                     size_t t = 0) const;
+  gtsam::Values solveInverseDynamics(const gtsam::Values &known_values,
+                                     size_t t = 0) const;
+
+  gtsam::Matrix inverseDynamicsTrajectory(const gtsam::Matrix &Q,
+                                          const gtsam::Matrix &V,
+                                          const gtsam::Matrix &A) const;
+  gtsam::Matrix forwardDynamicsTrajectory(const gtsam::Matrix &Q,
+                                          const gtsam::Matrix &V,
+                                          const gtsam::Matrix &Tau) const;
+};
+
+#include <gtdynamics/dynamics/BatchInverseDynamics.h>
+
+class TrajectoryInverseDynamicsResult {
+  gtsam::Matrix torques;
+  gtsam::Matrix parent_wrenches;
+  gtsam::Matrix child_wrenches;
+  gtsam::Vector6 parentWrench(size_t k, int j) const;
+  gtsam::Vector6 childWrench(size_t k, int j) const;
+};
+
+class BatchInverseDynamics {
+  BatchInverseDynamics(const gtdynamics::Robot &robot);
+  BatchInverseDynamics(const gtdynamics::Robot &robot,
+                       const boost::optional<gtsam::Vector3> &gravity,
+                       size_t num_threads);
+  size_t numThreads() const;
+  size_t numJointSlots() const;
+  gtdynamics::TrajectoryInverseDynamicsResult solve(
+      const gtsam::Matrix &Q, const gtsam::Matrix &V, const gtsam::Matrix &A,
+      bool wrenches = true);
+  gtsam::Matrix torques(const gtsam::Matrix &Q, const gtsam::Matrix &V,
+                        const gtsam::Matrix &A);
+};
+
+#include <gtdynamics/statics/BatchStatics.h>
+
+class StaticsParameters : gtdynamics::KinematicsParameters {
+  StaticsParameters();
+  StaticsParameters(double sigma_dynamics);
+  StaticsParameters(double sigma_dynamics,
+                    const boost::optional<gtsam::Vector3> &gravity);
+};
+
+// feasible is a numpy bool array, see python/specializations/gtdynamics.h.
+class BatchStaticsResult {
+  gtsam::Matrix torques;
+  size_t numFeasible() const;
+};
+
+class BatchStatics {
+  BatchStatics(const gtdynamics::Robot &robot);
+  BatchStatics(const gtdynamics::Robot &robot,
+               const gtdynamics::StaticsParameters &parameters,
+               size_t num_threads);
+  size_t numThreads() const;
+  gtsam::Vector torqueLimits() const;
+  gtdynamics::BatchStaticsResult solve(const gtsam::Matrix &angles);
+  gtdynamics::BatchStaticsResult solve(const gtsam::Matrix &angles,
+                                       int link_id,
+                                       const gtsam::Matrix &loads);
+};
+
+#include <gtdynamics/dynamics/ILQR.h>
+
+class ILQRParameters {
+  ILQRParameters();
+  double dt;
+  gtsam::Vector state_weights;
+  gtsam::Vector terminal_weights;
+  gtsam::Vector control_weights;
+  size_t max_iterations;
+  double tolerance;
+  double regularization;
+  double max_regularization;
+};
+
+class ILQRResult {
+  std::vector<gtsam::Vector> q;
+  std::vector<gtsam::Vector> v;
+  std::vector<gtsam::Vector> tau;
+  std::vector<gtsam::Matrix> K;
+  double cost;
+  size_t iterations;
+  bool converged;
+};
+
+class ILQR {
+  ILQR(const gtdynamics::Robot &robot);
+  ILQR(const gtdynamics::Robot &robot,
+       const boost::optional<gtsam::Vector3> &gravity,
+       const gtdynamics::ILQRParameters &parameters);
+  gtdynamics::ILQRResult optimize(
+      const gtsam::Vector &q0, const gtsam::Vector &v0,
+      const gtsam::Vector &q_goal, const gtsam::Vector &v_goal,
+      const std::vector<gtsam::Vector> &initial_torques) const;
+  size_t jointSlots() const;
+};
+
+#include <gtdynamics/dynamics/DifferentiableRollout.h>
+
+class RolloutStates {
+  size_t num_steps;
+  size_t num_joints;
+  gtsam::Matrix q;
+  gtsam::Matrix v;
+  gtsam::Matrix a;
+  gtsam::Vector angles(size_t rollout, size_t k) const;
+  gtsam::Vector velocities(size_t rollout, size_t k) const;
+};
+
+class DifferentiableRolloutParameters {
+  DifferentiableRolloutParameters();
+  double dt;
+  size_t checkpoint_interval;
+  size_t num_threads;
+};
+
+class RolloutGradients {
+  std::vector<gtsam::Matrix> torques;
+  gtsam::Matrix q0;
+  gtsam::Matrix v0;
+};
+
+class DifferentiableRollout {
+  DifferentiableRollout(const gtdynamics::Robot &robot);
+  DifferentiableRollout(
+      const gtdynamics::Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity,
+      const gtdynamics::DifferentiableRolloutParameters &parameters);
+  size_t numThreads() const;
+  size_t numJoints() const;
+  gtdynamics::RolloutStates simulate(
+      const gtsam::Matrix &q0, const gtsam::Matrix &v0,
+      const std::vector<gtsam::Matrix> &torque_seqs);
+  gtdynamics::RolloutGradients gradients(
+      const gtsam::Matrix &q0, const gtsam::Matrix &v0,
+      const std::vector<gtsam::Matrix> &torque_seqs,
+      const gtsam::Matrix &dL_dq, const gtsam::Matrix &dL_dv);
+  gtdynamics::RolloutGradients gradients(
+      const gtsam::Matrix &q0, const gtsam::Matrix &v0,
+      const std::vector<gtsam::Matrix> &torque_seqs,
+      const gtsam::Matrix &dL_dq, const gtsam::Matrix &dL_dv,
+      const std::vector<gtsam::Matrix> &dL_dtau);
+};
+
+#include <gtdynamics/dynamics/LinearDynamicsSolver.h>
+
+class LinearDynamicsSolver {
+  LinearDynamicsSolver(const gtdynamics::Robot &robot);
+  LinearDynamicsSolver(const gtdynamics::Robot &robot,
+                       const boost::optional<gtsam::Vector3> &gravity,
+                       const boost::optional<gtsam::Vector3> &planar_axis);
+
+  gtsam::Values solveForwardDynamics(const gtsam::Values &known_values,
+                                     size_t t = 0) const;
+};
+
+#include <gtdynamics/dynamics/MultipleShooting.h>
+
+class MultipleShootingParameters {
+  MultipleShootingParameters();
+  size_t num_segments;
+  size_t segment_steps;
+  double dt;
+};
+
+class MultipleShooting {
+  MultipleShooting(const gtdynamics::Robot &robot);
+  MultipleShooting(const gtdynamics::Robot &robot,
+                   const gtdynamics::MultipleShootingParameters &parameters,
+                   const boost::optional<gtsam::Vector3> &gravity,
+                   const gtdynamics::OptimizerSetting &opt);
+  size_t numSegments() const;
+  int nodeStep(size_t k) const;
+  gtsam::NonlinearFactorGraph defectFactors() const;
+  gtsam::Values rollout(const gtsam::Vector &q0, const gtsam::Vector &v0,
+                        const std::vector<gtsam::Vector> &torques) const;
+  gtsam::Values denseTrajectory(const gtsam::Values &nodes) const;
+};
+
 /********************** Simulator **********************/
 #include <gtdynamics/dynamics/Simulator.h>
 
+enum ForwardDynamicsMethod {
+  LinearGraph,
+  ArticulatedBody,
+  CompiledLinearGraph
+};
+
+enum IntegrationScheme {
+  ExplicitEuler,
+  SemiImplicitEuler,
+  RungeKutta4,
+  Verlet
+};
+
 class Simulator {
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values);
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values,
@@ -741,14 +1144,33 @@ class Simulator {
   Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values,
             const gtsam::Vector3 &gravity,
             const gtsam::Vector3 &planar_axis);
+  Simulator(const gtdynamics::Robot &robot, const gtsam::Values &initial_values,
+            const gtsam::Vector3 &gravity,
+            const gtsam::Vector3 &planar_axis,
+            gtdynamics::ForwardDynamicsMethod method);
 
   void reset(const double t);
+  void setIntegrationScheme(gtdynamics::IntegrationScheme scheme);
+  gtdynamics::IntegrationScheme integrationScheme() const;
   void forwardDynamics(const gtsam::Values &torques);
   void integration(const double dt);
   void step(const gtsam::Values &torques, const double dt);
+  void step(const gtsam::Vector &torques, const double dt);
+  void setState(const gtsam::Vector &q, const gtsam::Vector &v);
   gtsam::Values simulate(const std::vector<gtsam::Values> &torques_seq,
                          const double dt);
   const gtsam::Values &getValues() const;
+
+  void linearizeAround(const std::vector<gtsam::Vector> &nominal_torques,
+                       const double dt);
+  void linearizeAround(const std::vector<gtsam::Vector> &nominal_torques,
+                       const double dt, const double refresh_threshold);
+  void surrogateStep(const gtsam::Vector &torques);
+  size_t surrogateSteps() const;
+  size_t surrogateRefreshes() const;
+  const gtsam::Vector &jointAngles() const;
+  const gtsam::Vector &jointVels() const;
+  const gtsam::Vector &jointAccels() const;
 };
 
 /********************** Trajectory et al  **********************/
@@ -848,6 +1270,15 @@ class Trajectory {
       const gtsam::SharedNoiseModel &twist_acceleration_model,
       const gtsam::SharedNoiseModel &joint_velocity_model,
       const gtsam::SharedNoiseModel &joint_acceleration_model) const;
+  void addPeriodicBoundaryConditions(
+      gtsam::NonlinearFactorGraph @graph,
+      const gtdynamics::Robot& robot,
+      const gtsam::SharedNoiseModel &rotation_model,
+      const gtsam::SharedNoiseModel &twist_model,
+      const gtsam::SharedNoiseModel &joint_angle_model,
+      const gtsam::SharedNoiseModel &joint_velocity_model,
+      const gtsam::SharedNoiseModel &joint_acceleration_model) const;
+  gtsam::Values tile(const gtsam::Values &cycle_values, size_t repeat) const;
   void addIntegrationTimeFactors(gtsam::NonlinearFactorGraph @graph,
                                  double desired_dt, double sigma = 0) const;
   void writeToFile(const gtdynamics::Robot &robot, const string &name, const gtsam::Values &results) const;
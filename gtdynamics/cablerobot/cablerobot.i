@@ -28,6 +28,16 @@ class CableTensionFactor : gtsam::NonlinearFactor {
   void print(const string &s, const gtsam::KeyFormatter &keyFormatter);
 };
 
+#include <gtdynamics/cablerobot/factors/CableWrenchFactor.h>
+class CableWrenchFactor : gtsam::NonlinearFactor {
+  CableWrenchFactor(gtsam::Key wTx_key, gtsam::Key wrench_key,
+                    const gtsam::KeyVector &tension_keys,
+                    const gtsam::noiseModel::Base *cost_model,
+                    const gtsam::Matrix &wPa, const gtsam::Matrix &xPb);
+  size_t numCables() const;
+  void print(const string &s, const gtsam::KeyFormatter &keyFormatter);
+};
+
 // need to borrow this from GTSAM since GTSAM doesn't have fixed-size vector versions
 #include <gtdynamics/cablerobot/factors/PriorFactor.h>
 template<T = {double, gtsam::Vector2, gtsam::Vector3, gtsam::Vector4, gtsam::Vector5, gtsam::Vector6}>
@@ -39,4 +49,52 @@ class PriorFactor : gtsam::NonlinearFactor {
              const gtsam::KeyFormatter &keyFormatter);
 };
 
+/**************************************** Simulation ****************************************/
+
+#include <gtdynamics/cablerobot/utils/CdprSimulator.h>
+class CdprSimulatorParameters {
+  CdprSimulatorParameters();
+  double dt;
+  double sigma;
+  gtsam::Vector3 gravity;
+  double tolerance;
+  gtsam::LevenbergMarquardtParams lm;
+};
+
+#include <gtdynamics/cablerobot/utils/CableTensionDistribution.h>
+class TensionDistributionParameters {
+  TensionDistributionParameters();
+  double min_tension;
+  double max_tension;
+  gtsam::Vector6 wrench_weights;
+  double regularization;
+  double reference_tension;
+  int max_iterations;
+  double tolerance;
+};
+
+class CableTensionDistribution4 {
+  CableTensionDistribution4(const gtsam::Matrix &wPa, const gtsam::Matrix &xPb,
+                            const gtdynamics::TensionDistributionParameters &parameters =
+                                gtdynamics::TensionDistributionParameters());
+  void reset();
+  gtsam::Vector solve(const gtsam::Pose3 &wTx, const gtsam::Vector6 &Fx);
+  gtsam::Vector tensions() const;
+  int iterations() const;
+  bool converged() const;
+  bool atBound(int i) const;
+};
+
+class CdprSimulator {
+  CdprSimulator(const gtdynamics::Link *ee, const gtsam::Matrix &wPa,
+                const gtsam::Matrix &xPb, const gtsam::Values &x0,
+                const gtdynamics::CdprSimulatorParameters &parameters =
+                    gtdynamics::CdprSimulatorParameters());
+  const gtsam::Values &step(const gtsam::Values &torques);
+  const gtsam::Values &run(const gtsam::Values &torques, int num_steps);
+  void reset();
+  const gtsam::Values &values() const;
+  int timeStep() const;
+};
+
 }  // namespace gtdynamics
@@ -59,7 +59,7 @@ class CableTensionFactor
 
  private:
   /** Computes the wrench acting on the end-effector due to some cable tension
-   * and at some pose.
+   * and at some pose, with the closed-form CableWrench for a single cable.
    * @param tension the tension on the cable
    * @param wTx the pose of the end effector
    * @return Vector6: calculated wrench
@@ -69,14 +69,6 @@ class CableTensionFactor
       boost::optional<gtsam::Matrix &> H_t = boost::none,
       boost::optional<gtsam::Matrix &> H_wTx = boost::none) const;
 
-  // an alternate version of the above function that uses adjoint; will upgrade
-  // to this version once I figure out how to get the jacobian from an Adjoint
-  // operation
-  Vector6 computeWrenchUsingAdjoint(
-      double tension, const Pose3 &wTx,
-      boost::optional<gtsam::Matrix &> H_t = boost::none,
-      boost::optional<gtsam::Matrix &> H_wTx = boost::none) const;
-
  public:
   /** Cable wrench factor
    * @param t cable tension
@@ -0,0 +1,61 @@
+/**
+ * @file  CableWrenchFactor.cpp
+ * @brief Cable wrench factor: relates the tensions of all cables, the end
+ * effector pose and the total wrench of the cables on the end effector
+ */
+
+#include "CableWrenchFactor.h"
+
+#include <stdexcept>
+
+using namespace gtsam;
+
+namespace gtdynamics {
+
+// Keys of the pose, the wrench and the tensions, in that order.
+static KeyVector CableWrenchKeys(Key wTx_key, Key wrench_key,
+                                 const KeyVector &tension_keys) {
+  KeyVector keys{wTx_key, wrench_key};
+  keys.insert(keys.end(), tension_keys.begin(), tension_keys.end());
+  return keys;
+}
+
+/******************************************************************************/
+CableWrenchFactor::CableWrenchFactor(
+    Key wTx_key, Key wrench_key, const KeyVector &tension_keys,
+    const noiseModel::Base::shared_ptr &cost_model, const Matrix &wPa,
+    const Matrix &xPb)
+    : Base(cost_model, CableWrenchKeys(wTx_key, wrench_key, tension_keys)),
+      wPa_(wPa.transpose()),
+      xPb_(xPb.transpose()) {
+  const Eigen::Index n = tension_keys.size();
+  if (wPa.rows() != n || xPb.rows() != n || wPa.cols() != 3 ||
+      xPb.cols() != 3)
+    throw std::invalid_argument(
+        "CableWrenchFactor: wPa and xPb should have one row of 3 coordinates "
+        "per tension key.");
+}
+
+/******************************************************************************/
+Vector CableWrenchFactor::unwhitenedError(
+    const Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t n = numCables();
+  Vector tensions(n);
+  for (size_t i = 0; i < n; ++i) tensions(i) = x.at<double>(keys_[2 + i]);
+
+  Eigen::Matrix<double, 6, Eigen::Dynamic> H_tensions;
+  Matrix6 H_wTx;
+  const Vector6 F = CableWrench<Eigen::Dynamic>(
+      tensions, x.at<Pose3>(keys_[0]), wPa_, xPb_, H ? &H_tensions : nullptr,
+      H ? &H_wTx : nullptr);
+
+  if (H) {
+    H->resize(size());
+    (*H)[0] = -H_wTx;
+    (*H)[1] = I_6x6;
+    for (size_t i = 0; i < n; ++i) (*H)[2 + i] = -H_tensions.col(i);
+  }
+  return x.at<Vector6>(keys_[1]) - F;
+}
+
+}  // namespace gtdynamics
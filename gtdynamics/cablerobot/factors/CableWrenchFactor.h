@@ -0,0 +1,151 @@
+/**
+ * @file  CableWrenchFactor.h
+ * @brief Cable wrench factor: relates the tensions of all cables, the end
+ * effector pose and the total wrench of the cables on the end effector
+ */
+
+#pragma once
+
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Total wrench of N cables on the end effector, in the end-effector frame, in
+ * closed form. Cable i pulls its mounting point xPb_i toward the anchor wPa_i
+ * with tension t_i. Run in the end-effector frame, where the anchor is
+ * xPa_i = wTx^-1 wPa_i, the force is -t_i u_i with u_i the unit vector from
+ * xPa_i to xPb_i, and no Jacobian of a rotation is needed.
+ *
+ * N may be Eigen::Dynamic; with a fixed N all Jacobians are fixed-size.
+ *
+ * @param tensions   the N cable tensions
+ * @param wTx        the end effector pose
+ * @param wPa        cable mounting points on the frame, one per column, in
+ *                   world coordinates
+ * @param xPb        cable mounting points on the end effector, one per
+ *                   column, in the end-effector frame
+ * @param H_tensions optional 6xN Jacobian with respect to the tensions
+ * @param H_wTx      optional 6x6 Jacobian with respect to the pose
+ * @return the sum of the wrenches of all cables
+ */
+template <int N>
+gtsam::Vector6 CableWrench(const Eigen::Matrix<double, N, 1> &tensions,
+                           const gtsam::Pose3 &wTx,
+                           const Eigen::Matrix<double, 3, N> &wPa,
+                           const Eigen::Matrix<double, 3, N> &xPb,
+                           Eigen::Matrix<double, 6, N> *H_tensions = nullptr,
+                           gtsam::Matrix6 *H_wTx = nullptr) {
+  const Eigen::Index n = tensions.size();
+  const gtsam::Matrix3 xRw = wTx.rotation().transpose();
+  const gtsam::Point3 &wtx = wTx.translation();
+
+  gtsam::Vector6 F = gtsam::Vector6::Zero();
+  if (H_tensions) H_tensions->resize(6, n);
+  if (H_wTx) H_wTx->setZero();
+  for (Eigen::Index i = 0; i < n; ++i) {
+    const gtsam::Point3 xPb_i = xPb.col(i);
+    const gtsam::Point3 xPa = xRw * (wPa.col(i) - wtx);
+    const gtsam::Vector3 cable = xPb_i - xPa;
+    const double length = cable.norm();
+    const gtsam::Vector3 u = cable / length;
+    const gtsam::Vector3 xf = -tensions(i) * u;
+    F.head<3>() += xPb_i.cross(xf);
+    F.tail<3>() += xf;
+
+    if (H_tensions) H_tensions->col(i) << xPb_i.cross(-u), -u;
+    if (H_wTx) {
+      // d(xPa) = [xPa]x w - v for the pose perturbation (w, v).
+      gtsam::Matrix36 cable_H_wTx;
+      cable_H_wTx << -gtsam::skewSymmetric(xPa), gtsam::I_3x3;
+      const gtsam::Matrix3 xf_H_cable =
+          -tensions(i) / length * (gtsam::I_3x3 - u * u.transpose());
+      const gtsam::Matrix36 xf_H_wTx = xf_H_cable * cable_H_wTx;
+      H_wTx->topRows<3>() += gtsam::skewSymmetric(xPb_i) * xf_H_wTx;
+      H_wTx->bottomRows<3>() += xf_H_wTx;
+    }
+  }
+  return F;
+}
+
+/**
+ * CableWrenchFactor is a nonlinear factor which enforces the relation between
+ * the tensions of all N cables of a cable robot, the end effector pose and
+ * the total wrench the cables exert on the end effector. It replaces N
+ * CableTensionFactors and the N per-cable wrench variables, which saves their
+ * evaluation and elimination for robots with many cables.
+ *
+ * Keys are ordered as the pose, the wrench, and the N tensions.
+ */
+class CableWrenchFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = CableWrenchFactor;
+  using Base = gtsam::NoiseModelFactor;
+  using Matrix3X = Eigen::Matrix<double, 3, Eigen::Dynamic>;
+
+  Matrix3X wPa_, xPb_;
+
+ public:
+  /** Cable wrench factor
+   * @param wTx_key -- key for end effector pose
+   * @param wrench_key -- key for the total wrench of the cables on the end
+   * effector (in the end effector's reference frame)
+   * @param tension_keys -- keys for the N cable tensions
+   * @param cost_model -- noise model (6 dimensional)
+   * @param wPa -- cable mounting locations on the fixed frame, one per row,
+   * in world coords
+   * @param xPb -- cable mounting locations on the end effector, one per row,
+   * in the end-effector frame
+   */
+  CableWrenchFactor(gtsam::Key wTx_key, gtsam::Key wrench_key,
+                    const gtsam::KeyVector &tension_keys,
+                    const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                    const gtsam::Matrix &wPa, const gtsam::Matrix &xPb);
+  virtual ~CableWrenchFactor() {}
+
+  /// Number of cables.
+  size_t numCables() const { return wPa_.cols(); }
+
+  /** Cable wrench factor
+   * @return Fx minus the wrench of all cables
+   */
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  // @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /** print contents */
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 GTDKeyFormatter) const override {
+    std::cout << s << "cable wrench factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /** Serialization function */
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+}  // namespace gtdynamics
@@ -57,5 +57,38 @@ class TestCdprPlanar(GtsamTestCase):
             x += xdot * dt
             xdot += xddot * dt
 
+    def testNativeSim(self):
+        """Tests that the C++ simulator runs the same rollout as the Python one in one call."""
+        class OpenLoopController(CdprControllerBase):
+            def __init__(self, torques):
+                self.torques = torques
+            def update(self, values, k):
+                return self.torques
+        N = 10
+        dt = 0.1
+        cdpr = Cdpr()
+        torques = gtsam.Values()
+        for k in range(N):
+            for ji, tau in enumerate([1., 1., 0., 0.]):
+                gtd.InsertTorque(torques, ji, k, tau)
+        xInit = gtsam.Values()
+        gtd.InsertPose(xInit, cdpr.ee_id(), 0, Pose3(Rot3(), (1.5, 0, 1.5)))
+        gtd.InsertTwist(xInit, cdpr.ee_id(), 0, np.zeros(6))
+        # run both simulations
+        expected = CdprSimulator(cdpr, xInit, OpenLoopController(torques), dt=dt).run(N=N)
+        params = gtd.CdprSimulatorParameters()
+        params.dt = dt
+        sim = gtd.CdprSimulator(cdpr.eelink(), cdpr.params.a_locs, cdpr.params.b_locs, xInit,
+                                params)
+        actual = sim.run(torques, N)
+        self.assertEqual(N, sim.timeStep())
+        for k in range(N + 1):
+            self.gtsamAssertEquals(gtd.Pose(expected, cdpr.ee_id(), k),
+                                   gtd.Pose(actual, cdpr.ee_id(), k), tol=1e-12)
+        for k in range(N):
+            for ji in range(4):
+                self.assertAlmostEqual(gtd.JointAngle(expected, ji, k),
+                                       gtd.JointAngle(actual, ji, k), places=9)
+
 if __name__ == "__main__":
     unittest.main()
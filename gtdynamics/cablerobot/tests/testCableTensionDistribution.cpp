@@ -0,0 +1,128 @@
+/**
+ * @file  testCableTensionDistribution.cpp
+ * @brief test real-time cable tension distribution
+ */
+
+#include <gtdynamics/cablerobot/utils/CableTensionDistribution.h>
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+// The planar cable robot of cdpr_planar.py.
+static const double s = 0.15;
+static const Matrix wPa4 =
+    (Matrix(4, 3) << 3, 0, 0, 3, 0, 3, 0, 0, 3, 0, 0, 0).finished();
+static const Matrix xPb4 =
+    (Matrix(4, 3) << s, 0, -s, s, 0, s, -s, 0, s, -s, 0, -s).finished();
+
+// An 8-cable robot with anchors and mounting points on the corners of boxes.
+static Matrix Corners(double x, double y, double z) {
+  Matrix points(8, 3);
+  for (int i = 0; i < 8; ++i)
+    points.row(i) << (i & 1 ? x : -x), (i & 2 ? y : -y), (i & 4 ? z : -z);
+  return points;
+}
+static const Matrix wPa8 = Corners(2, 1.5, 1);
+static const Matrix xPb8 = Corners(0.15, 0.1, 0.05);
+
+// Check the optimality conditions of the box-constrained QP.
+template <int N>
+static bool IsOptimal(const Matrix &wPa, const Matrix &xPb,
+                      const TensionDistributionParameters &p,
+                      const Pose3 &wTx, const Vector6 &Fx,
+                      const Eigen::Matrix<double, N, 1> &t) {
+  Eigen::Matrix<double, 3, N> a = wPa.transpose(), b = xPb.transpose();
+  Eigen::Matrix<double, 6, N> A;
+  CableWrench<N>(t, wTx, a, b, &A);
+  const Vector gradient =
+      A.transpose() * p.wrench_weights.asDiagonal() * (A * t - Fx) +
+      p.regularization * (t.array() - p.reference_tension).matrix();
+  for (int i = 0; i < N; ++i) {
+    if (t(i) < p.min_tension - 1e-12 || t(i) > p.max_tension + 1e-12)
+      return false;
+    const bool lower = t(i) <= p.min_tension + 1e-12,
+               upper = t(i) >= p.max_tension - 1e-12;
+    if (!lower && !upper && std::abs(gradient(i)) > 1e-6) return false;
+    if (lower && gradient(i) < -1e-6) return false;
+    if (upper && gradient(i) > 1e-6) return false;
+  }
+  return true;
+}
+
+/// A feasible wrench is produced exactly, within the bounds.
+TEST(CableTensionDistribution, feasible) {
+  TensionDistributionParameters p;
+  p.min_tension = 1.0;
+  p.reference_tension = 5.0;
+  CableTensionDistribution8 distribution(wPa8, xPb8, p);
+
+  const Pose3 wTx(Rot3::RzRyRx(0.05, -0.1, 0.2), Point3(0.2, -0.1, 0.1));
+  // The wrench of some tensions within the bounds.
+  Eigen::Matrix<double, 8, 1> expected;
+  expected << 3, 4, 5, 6, 7, 8, 9, 10;
+  Eigen::Matrix<double, 3, 8> a = wPa8.transpose(), b = xPb8.transpose();
+  const Vector6 Fx = CableWrench<8>(expected, wTx, a, b);
+
+  const auto &t = distribution.solve(wTx, Fx);
+  EXPECT(distribution.converged());
+  EXPECT(IsOptimal<8>(wPa8, xPb8, p, wTx, Fx, t));
+  EXPECT(assert_equal(Fx, CableWrench<8>(t, wTx, a, b), 1e-4));
+
+  // The warm start is optimal for the same input.
+  distribution.solve(wTx, Fx);
+  EXPECT_LONGS_EQUAL(1, distribution.iterations());
+}
+
+/// Tensions that would go slack or exceed the limit stay at the bounds.
+TEST(CableTensionDistribution, bounds) {
+  TensionDistributionParameters p;
+  p.min_tension = 0.1;
+  p.max_tension = 2.0;
+  CableTensionDistribution4 distribution(wPa4, xPb4, p);
+
+  // Pull hard to the right: the left cables would need negative tension and
+  // the right ones more than the limit.
+  const Pose3 wTx(Rot3(), Point3(1.5, 0, 1.5));
+  const Vector6 Fx = (Vector6() << 0, 0, 0, 10, 0, 0).finished();
+  const auto &t = distribution.solve(wTx, Fx);
+  EXPECT(distribution.converged());
+  EXPECT(IsOptimal<4>(wPa4, xPb4, p, wTx, Fx, t));
+  for (int i = 0; i < 4; ++i) EXPECT(distribution.atBound(i));
+  EXPECT_DOUBLES_EQUAL(2.0, t(0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(2.0, t(1), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.1, t(2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.1, t(3), 1e-12);
+
+  // Following a trajectory, the warm start keeps the work per solve small.
+  for (int k = 0; k < 100; ++k) {
+    const Pose3 pose(Rot3(), Point3(1.0 + 0.01 * k, 0, 1.4));
+    const Vector6 wrench =
+        (Vector6() << 0, 0.01 * k, 0, std::sin(0.1 * k), 0, 1).finished();
+    distribution.solve(pose, wrench);
+    EXPECT(distribution.converged());
+    EXPECT(distribution.iterations() <= 8);
+    EXPECT(IsOptimal<4>(wPa4, xPb4, p, pose, wrench,
+                        distribution.tensions()));
+  }
+}
+
+/// Mounting points need one row of 3 coordinates per cable.
+TEST(CableTensionDistribution, arguments) {
+  THROWS_EXCEPTION(CableTensionDistribution4(wPa8, xPb8));
+  TensionDistributionParameters p;
+  p.min_tension = 3.0;
+  p.max_tension = 2.0;
+  THROWS_EXCEPTION(CableTensionDistribution4(wPa4, xPb4, p));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file  testCableWrenchFactor.cpp
+ * @brief test the multi-cable wrench kernel and factor
+ */
+
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/cablerobot/factors/CableWrenchFactor.h>
+
+#include <gtdynamics/utils/values.h>
+
+#include <gtsam/base/Vector.h>
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+using namespace gtdynamics::internal;
+
+// An 8-cable robot: anchors on the corners of a box, mounting points on the
+// corners of the end effector.
+static const int N = 8;
+static Matrix MountingPoints(double x, double y, double z) {
+  Matrix points(N, 3);
+  for (int i = 0; i < N; ++i)
+    points.row(i) << (i & 1 ? x : -x), (i & 2 ? y : -y), (i & 4 ? z : -z);
+  return points;
+}
+static const Matrix wPa = MountingPoints(2, 1.5, 1);
+static const Matrix xPb = MountingPoints(0.15, 0.1, 0.05);
+static const Pose3 wTx(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0.2, -0.1, 0.3));
+
+/**
+ * The kernel sums the wrenches of the single-cable factors, and agrees
+ * between fixed and dynamic sizes.
+ */
+TEST(CableWrench, sum) {
+  Vector tensions(N);
+  for (int i = 0; i < N; ++i) tensions(i) = 1.0 + 0.5 * i;
+
+  noiseModel::Gaussian::shared_ptr cost_model =
+      noiseModel::Isotropic::Sigma(6, 1.0);
+  Vector6 expected = Vector6::Zero();
+  for (int i = 0; i < N; ++i) {
+    CableTensionFactor factor(TorqueKey(i), PoseKey(0), WrenchKey(0, i),
+                              cost_model, wPa.row(i).transpose(),
+                              xPb.row(i).transpose());
+    expected -= factor.evaluateError(tensions(i), wTx, Vector6::Zero());
+  }
+
+  const Eigen::Matrix<double, 3, Eigen::Dynamic> a = wPa.transpose(),
+                                                 b = xPb.transpose();
+  Eigen::Matrix<double, 6, Eigen::Dynamic> H_t;
+  Matrix6 H_wTx;
+  EXPECT(assert_equal(expected, CableWrench<Eigen::Dynamic>(tensions, wTx, a,
+                                                            b, &H_t, &H_wTx),
+                      1e-12));
+
+  const Eigen::Matrix<double, N, 1> fixed_tensions = tensions;
+  const Eigen::Matrix<double, 3, N> fixed_a = a, fixed_b = b;
+  Eigen::Matrix<double, 6, N> fixed_H_t;
+  Matrix6 fixed_H_wTx;
+  EXPECT(assert_equal(expected,
+                      CableWrench<N>(fixed_tensions, wTx, fixed_a, fixed_b,
+                                     &fixed_H_t, &fixed_H_wTx),
+                      1e-12));
+  EXPECT(assert_equal(Matrix(H_t), Matrix(fixed_H_t), 1e-12));
+  EXPECT(assert_equal(H_wTx, fixed_H_wTx, 1e-12));
+}
+
+/// The aggregated factor has the error and Jacobians of its N cables.
+TEST(CableWrenchFactor, error) {
+  noiseModel::Gaussian::shared_ptr cost_model =
+      noiseModel::Isotropic::Sigma(6, 1.0);
+  KeyVector tension_keys;
+  for (int i = 0; i < N; ++i) tension_keys.push_back(TorqueKey(i, 0));
+  CableWrenchFactor factor(PoseKey(0), WrenchKey(0, 0), tension_keys,
+                           cost_model, wPa, xPb);
+  EXPECT_LONGS_EQUAL(N, factor.numCables());
+  EXPECT_LONGS_EQUAL(N + 2, factor.size());
+
+  Values values;
+  InsertPose(&values, 0, wTx);
+  InsertWrench(&values, 0, 0, (Vector6() << 0.1, 0.2, 0.3, 4, 5, 6).finished());
+  Vector6 expected = Wrench(values, 0, 0);
+  for (int i = 0; i < N; ++i) {
+    InsertTorque(&values, i, 2.0 - 0.1 * i);
+    CableTensionFactor cable(TorqueKey(i), PoseKey(0), WrenchKey(0, i),
+                             cost_model, wPa.row(i).transpose(),
+                             xPb.row(i).transpose());
+    expected += cable.evaluateError(2.0 - 0.1 * i, wTx, Vector6::Zero());
+  }
+  EXPECT(assert_equal(Vector(expected), factor.unwhitenedError(values),
+                      1e-12));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  THROWS_EXCEPTION(CableWrenchFactor(PoseKey(0), WrenchKey(0, 0),
+                                     tension_keys, cost_model,
+                                     wPa.topRows(3), xPb));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
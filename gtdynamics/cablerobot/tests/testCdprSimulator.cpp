@@ -0,0 +1,111 @@
+/**
+ * @file  testCdprSimulator.cpp
+ * @brief test cable robot simulation
+ */
+
+#include <gtdynamics/cablerobot/utils/CdprSimulator.h>
+
+#include <gtdynamics/universal_robot/Link.h>
+#include <gtdynamics/utils/values.h>
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <boost/make_shared.hpp>
+
+#include <cmath>
+
+using namespace std;
+using namespace gtsam;
+using namespace gtdynamics;
+
+// The planar cable robot of cdpr_planar.py.
+static const double s = 0.15;
+static const Matrix wPa =
+    (Matrix(4, 3) << 3, 0, 0, 3, 0, 3, 0, 0, 3, 0, 0, 0).finished();
+static const Matrix xPb =
+    (Matrix(4, 3) << s, 0, -s, s, 0, s, -s, 0, s, -s, 0, -s).finished();
+
+static LinkSharedPtr EndEffector() {
+  return boost::make_shared<Link>(1, "ee", 1.0, I_3x3, Pose3(), Pose3());
+}
+
+static Values InitialState(int ee_id) {
+  Values x0;
+  InsertPose(&x0, ee_id, 0, Pose3(Rot3(), Point3(1.5, 0, 1.5)));
+  InsertTwist(&x0, ee_id, 0, Vector6::Zero());
+  return x0;
+}
+
+// Pull on the two right cables, as in test_cdpr_planar_sim.py.
+static Values Torques(int num_steps) {
+  Values torques;
+  for (int k = 0; k < num_steps; ++k) {
+    InsertTorque(&torques, 0, k, 1.0);
+    InsertTorque(&torques, 1, k, 1.0);
+    InsertTorque(&torques, 2, k, 0.0);
+    InsertTorque(&torques, 3, k, 0.0);
+  }
+  return torques;
+}
+
+/**
+ * Open-loop rollout follows the Euler integration of the horizontal cable
+ * forces.
+ */
+TEST(CdprSimulator, run) {
+  auto ee = EndEffector();
+  CdprSimulatorParameters parameters;
+  parameters.dt = 0.1;
+  CdprSimulator sim(ee, wPa, xPb, InitialState(ee->id()), parameters);
+
+  const int N = 10;
+  const Values result = sim.run(Torques(N), N);
+  EXPECT_LONGS_EQUAL(N, sim.timeStep());
+
+  double x = 1.5, xdot = 0;
+  for (int k = 0; k < N; ++k) {
+    EXPECT(assert_equal(Pose3(Rot3(), Point3(x, 0, 1.5)),
+                        Pose(result, ee->id(), k), 1e-12));
+    const double dx = 3 - x - s, dy = 1.35;  // the cable vector
+    EXPECT_DOUBLES_EQUAL(std::sqrt(dx * dx + dy * dy),
+                         JointAngle(result, 0, k), 1e-9);
+    const double xddot = 2 * dx / std::sqrt(dx * dx + dy * dy);
+    x += xdot * parameters.dt;
+    xdot += xddot * parameters.dt;
+  }
+  EXPECT(result.exists(internal::PoseKey(ee->id(), N)));
+}
+
+/// A controller gives the same rollout, and reset starts over.
+TEST(CdprSimulator, controller) {
+  auto ee = EndEffector();
+  CdprSimulator sim(ee, wPa, xPb, InitialState(ee->id()));
+  const int N = 5;
+  const Values open_loop = sim.run(Torques(N), N);
+
+  sim.reset();
+  EXPECT_LONGS_EQUAL(0, sim.timeStep());
+  int calls = 0;
+  auto controller = [&](const Values &values, int k) {
+    EXPECT(values.exists(internal::JointVelKey(3, k)));
+    ++calls;
+    return Torques(k + 1);
+  };
+  const Values closed_loop = sim.run(controller, N);
+  EXPECT_LONGS_EQUAL(N, calls);
+  EXPECT(assert_equal(open_loop, closed_loop, 1e-12));
+}
+
+/// Mounting points need one row of 3 coordinates per cable.
+TEST(CdprSimulator, mountingPoints) {
+  auto ee = EndEffector();
+  THROWS_EXCEPTION(
+      CdprSimulator(ee, wPa, xPb.topRows(3), InitialState(ee->id())));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
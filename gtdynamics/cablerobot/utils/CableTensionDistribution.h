@@ -0,0 +1,225 @@
+/**
+ * @file  CableTensionDistribution.h
+ * @brief Real-time tension distribution for cable robots: the cable tensions
+ * within bounds that best produce a desired wrench on the end effector
+ */
+
+#pragma once
+
+#include <gtdynamics/cablerobot/factors/CableWrenchFactor.h>
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/// Parameters of CableTensionDistribution.
+struct TensionDistributionParameters {
+  double min_tension = 0.0;     ///< lower bound, keeps the cables taut
+  double max_tension = 1000.0;  ///< upper bound, e.g. the winch torque limit
+  /// Weights of the 6 wrench components in the least-squares objective.
+  gtsam::Vector6 wrench_weights = gtsam::Vector6::Ones();
+  /// Weight of the distance of the tensions to the reference tension, which
+  /// picks one solution among the tensions that produce the same wrench.
+  double regularization = 1e-6;
+  double reference_tension = 0.0;
+  int max_iterations = 50;  ///< active-set iterations per solve, at most
+  double tolerance = 1e-9;  ///< on the bound multipliers
+};
+
+/**
+ * CableTensionDistribution finds the tensions t of the N cables of a cable
+ * robot that produce a desired wrench Fx on the end effector, within bounds,
+ * as the small box-constrained QP
+ *
+ *   min 1/2 |A t - Fx|^2_W + 1/2 r |t - t_ref|^2,  t_min <= t <= t_max,
+ *
+ * where A t is the CableWrench of the cables at the current pose, W the
+ * wrench weights and r the regularization. The QP is solved by a primal
+ * active-set method on fixed-size N x N matrices, so solving allocates no
+ * memory; every iterate is within bounds, and each iteration either fixes a
+ * tension at a bound or frees one. The active set and tensions of the
+ * previous solve are the warm start, which for a controller running at a
+ * high rate usually means a single iteration. The number of iterations is
+ * capped by max_iterations, which bounds the latency; if the cap is hit,
+ * the best tensions so far are returned and converged() is false.
+ *
+ * Mounting points use the geometry of CableTensionFactor: wPa on the frame,
+ * in world coordinates, and xPb on the end effector, in its frame.
+ */
+template <int N>
+class CableTensionDistribution {
+  static_assert(N > 0, "The number of cables should be fixed.");
+
+ public:
+  using VectorN = Eigen::Matrix<double, N, 1>;
+  using MatrixN = Eigen::Matrix<double, N, N>;
+  using Matrix3N = Eigen::Matrix<double, 3, N>;
+  using Matrix6N = Eigen::Matrix<double, 6, N>;
+
+  /**
+   * Constructor
+   * @param wPa         cable mounting points on the frame, one per row, in
+   *                    world coordinates
+   * @param xPb         cable mounting points on the end effector, one per row,
+   *                    in the end-effector frame
+   * @param parameters  bounds, weights and iteration limits
+   */
+  CableTensionDistribution(const gtsam::Matrix &wPa, const gtsam::Matrix &xPb,
+                           const TensionDistributionParameters &parameters =
+                               TensionDistributionParameters())
+      : p_(parameters) {
+    if (wPa.rows() != N || xPb.rows() != N || wPa.cols() != 3 ||
+        xPb.cols() != 3)
+      throw std::invalid_argument(
+          "CableTensionDistribution: wPa and xPb should have one row of 3 "
+          "coordinates per cable.");
+    if (p_.min_tension > p_.max_tension || p_.regularization <= 0)
+      throw std::invalid_argument(
+          "CableTensionDistribution: need min_tension <= max_tension and a "
+          "positive regularization.");
+    wPa_ = wPa.transpose();
+    xPb_ = xPb.transpose();
+    reset();
+  }
+
+  /// Forget the warm start.
+  void reset() {
+    tensions_.setConstant(clamp(p_.reference_tension));
+    active_.fill(kFree);
+    iterations_ = 0;
+    converged_ = false;
+  }
+
+  /**
+   * Tensions that best produce the wrench Fx at pose wTx, warm-started from
+   * the previous solve.
+   * @param wTx  the end effector pose
+   * @param Fx   desired wrench of the cables on the end effector, in the end
+   *             effector frame
+   */
+  const VectorN &solve(const gtsam::Pose3 &wTx, const gtsam::Vector6 &Fx) {
+    // The wrench is linear in the tensions, so A is its tension Jacobian.
+    Matrix6N A;
+    CableWrench<N>(VectorN::Zero(), wTx, wPa_, xPb_, &A);
+    const Matrix6N WA = p_.wrench_weights.asDiagonal() * A;
+    H_ = A.transpose() * WA;
+    H_.diagonal().array() += p_.regularization;
+    g_ = -(WA.transpose() * Fx);
+    g_.array() -= p_.regularization * p_.reference_tension;
+
+    // Start within bounds, with the previous active set.
+    for (int i = 0; i < N; ++i)
+      tensions_(i) = active_[i] == kLower   ? p_.min_tension
+                     : active_[i] == kUpper ? p_.max_tension
+                                            : clamp(tensions_(i));
+
+    converged_ = false;
+    for (iterations_ = 0; iterations_ < p_.max_iterations;) {
+      ++iterations_;
+      const VectorN newton = newtonPoint();
+
+      // Move toward the minimum on the free tensions, up to the first bound.
+      double alpha = 1.0;
+      int blocking = -1;
+      for (int i = 0; i < N; ++i) {
+        if (active_[i] != kFree) continue;
+        const bool below = newton(i) < p_.min_tension;
+        if (!below && newton(i) <= p_.max_tension) continue;
+        const double bound = below ? p_.min_tension : p_.max_tension;
+        const double a = (bound - tensions_(i)) / (newton(i) - tensions_(i));
+        if (a < alpha) {
+          alpha = a;
+          blocking = i;
+        }
+      }
+      tensions_ += alpha * (newton - tensions_);
+      if (blocking >= 0) {
+        const bool lower = newton(blocking) < tensions_(blocking);
+        active_[blocking] = lower ? kLower : kUpper;
+        tensions_(blocking) = lower ? p_.min_tension : p_.max_tension;
+        continue;
+      }
+
+      // Optimal for this active set; free the bound that holds it back most.
+      const VectorN gradient = H_ * tensions_ + g_;
+      int worst = -1;
+      double violation = p_.tolerance;
+      for (int i = 0; i < N; ++i) {
+        const double v = active_[i] == kLower   ? -gradient(i)
+                         : active_[i] == kUpper ? gradient(i)
+                                                : 0.0;
+        if (v > violation) {
+          violation = v;
+          worst = i;
+        }
+      }
+      if (worst < 0) {
+        converged_ = true;
+        break;
+      }
+      active_[worst] = kFree;
+    }
+    return tensions_;
+  }
+
+  /// Tensions of the last solve.
+  const VectorN &tensions() const { return tensions_; }
+
+  /// Number of active-set iterations of the last solve.
+  int iterations() const { return iterations_; }
+
+  /// Whether the last solve reached the optimum within max_iterations.
+  bool converged() const { return converged_; }
+
+  /// Whether cable i is at its lower or upper bound.
+  bool atBound(int i) const { return active_.at(i) != kFree; }
+
+ private:
+  enum Bound : char { kFree, kLower, kUpper };
+
+  double clamp(double t) const {
+    return std::min(std::max(t, p_.min_tension), p_.max_tension);
+  }
+
+  // Minimum of the QP with the tensions at bounds fixed, solved in place in
+  // the full N x N system with identity rows for the fixed tensions.
+  VectorN newtonPoint() const {
+    MatrixN M = H_;
+    VectorN rhs = -g_;
+    for (int i = 0; i < N; ++i)
+      if (active_[i] != kFree) rhs -= H_.col(i) * tensions_(i);
+    for (int i = 0; i < N; ++i) {
+      if (active_[i] == kFree) continue;
+      M.row(i).setZero();
+      M.col(i).setZero();
+      M(i, i) = 1.0;
+      rhs(i) = tensions_(i);
+    }
+    return M.ldlt().solve(rhs);
+  }
+
+  TensionDistributionParameters p_;
+  Matrix3N wPa_, xPb_;
+  MatrixN H_;
+  VectorN g_;
+  VectorN tensions_;
+  std::array<Bound, N> active_;
+  int iterations_ = 0;
+  bool converged_ = false;
+};
+
+/// Tension distribution of the planar 4-cable robot of cdpr_planar.py.
+using CableTensionDistribution4 = CableTensionDistribution<4>;
+
+/// Tension distribution of a spatial 8-cable robot.
+using CableTensionDistribution8 = CableTensionDistribution<8>;
+
+}  // namespace gtdynamics
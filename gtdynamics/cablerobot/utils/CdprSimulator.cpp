@@ -0,0 +1,230 @@
+/**
+ * @file  CdprSimulator.cpp
+ * @brief Simulation for a cable robot, with the factor graphs of one time step
+ * built once and solved again at every step.
+ */
+
+#include "CdprSimulator.h"
+
+#include <gtdynamics/cablerobot/factors/CableLengthFactor.h>
+#include <gtdynamics/cablerobot/factors/CableTensionFactor.h>
+#include <gtdynamics/cablerobot/factors/CableVelocityFactor.h>
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/factors/WrenchFactor.h>
+#include <gtdynamics/utils/values.h>
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using gtsam::Key;
+using gtsam::Pose3;
+using gtsam::PriorFactor;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+using internal::JointAngleKey;
+using internal::JointVelKey;
+using internal::PoseKey;
+using internal::TorqueKey;
+using internal::TwistAccelKey;
+using internal::TwistKey;
+using internal::WrenchKey;
+
+// The time step duration is a variable at key 0, as in the Python simulator.
+static const Key kDtKey = 0;
+
+/* ************************************************************************* */
+CdprSimulator::CdprSimulator(const LinkSharedPtr &ee,
+                             const gtsam::Matrix &wPa,
+                             const gtsam::Matrix &xPb, const Values &x0,
+                             const CdprSimulatorParameters &parameters)
+    : ee_(ee),
+      num_cables_(wPa.rows()),
+      x0_(x0),
+      p_(parameters),
+      model1_(gtsam::noiseModel::Isotropic::Sigma(1, parameters.sigma)),
+      model6_(gtsam::noiseModel::Isotropic::Sigma(6, parameters.sigma)) {
+  if (wPa.cols() != 3 || xPb.cols() != 3 || xPb.rows() != wPa.rows())
+    throw std::invalid_argument(
+        "CdprSimulator: wPa and xPb should have one row of 3 coordinates per "
+        "cable.");
+  const int id = ee_->id();
+
+  // Inverse kinematics: cable lengths and velocities from the Pose/Twist.
+  for (size_t j = 0; j < num_cables_; ++j) {
+    const gtsam::Point3 a = wPa.row(j).transpose(), b = xPb.row(j).transpose();
+    kinematics_.emplace_shared<CableLengthFactor>(
+        JointAngleKey(j, 0), PoseKey(id, 0), model1_, a, b);
+    kinematics_.emplace_shared<CableVelocityFactor>(
+        JointVelKey(j, 0), PoseKey(id, 0), TwistKey(id, 0), model1_, a, b);
+  }
+  kinematics_priors_ = kinematics_.size();
+  kinematics_.emplace_shared<PriorFactor<Pose3>>(PoseKey(id, 0), Pose3(),
+                                                 model6_);
+  kinematics_.emplace_shared<PriorFactor<Vector6>>(
+      TwistKey(id, 0), Vector6::Zero(), model6_);
+
+  // Dynamics: wrenches and TwistAccel from the torques, and collocation to
+  // the next Pose/Twist.
+  std::vector<DynamicsSymbol> wrench_keys;
+  for (size_t j = 0; j < num_cables_; ++j)
+    wrench_keys.push_back(WrenchKey(id, j, 0));
+  dynamics_.push_back(
+      WrenchFactor(model6_, ee_, wrench_keys, 0, p_.gravity));
+  for (size_t j = 0; j < num_cables_; ++j)
+    dynamics_.emplace_shared<CableTensionFactor>(
+        TorqueKey(j, 0), PoseKey(id, 0), WrenchKey(id, j, 0), model6_,
+        wPa.row(j).transpose(), xPb.row(j).transpose());
+  dynamics_.emplace_shared<EulerPoseCollocationFactor>(
+      PoseKey(id, 0), PoseKey(id, 1), TwistKey(id, 0), kDtKey, model6_);
+  dynamics_.emplace_shared<EulerTwistCollocationFactor>(
+      TwistKey(id, 0), TwistKey(id, 1), TwistAccelKey(id, 0), kDtKey,
+      model6_);
+  dynamics_.emplace_shared<PriorFactor<double>>(kDtKey, p_.dt, model1_);
+  dynamics_priors_ = dynamics_.size();
+  dynamics_.emplace_shared<PriorFactor<Pose3>>(PoseKey(id, 0), Pose3(),
+                                               model6_);
+  dynamics_.emplace_shared<PriorFactor<Vector6>>(
+      TwistKey(id, 0), Vector6::Zero(), model6_);
+  for (size_t j = 0; j < num_cables_; ++j)
+    dynamics_.emplace_shared<PriorFactor<double>>(TorqueKey(j, 0), 0.0,
+                                                  model1_);
+
+  // The step graphs keep their structure, so order them once.
+  kinematics_lm_ = p_.lm;
+  kinematics_lm_.setOrdering(gtsam::Ordering::Colamd(kinematics_));
+  dynamics_lm_ = p_.lm;
+  dynamics_lm_.setOrdering(gtsam::Ordering::Colamd(dynamics_));
+
+  reset();
+}
+
+/* ************************************************************************* */
+void CdprSimulator::reset() {
+  const int id = ee_->id();
+  const Pose3 pose = Pose(x0_, id, 0);
+  const Vector6 twist = Twist(x0_, id, 0);
+
+  x_ = x0_;
+  if (!x_.exists(kDtKey)) x_.insert(kDtKey, p_.dt);
+  k_ = 0;
+
+  kinematics_values_.clear();
+  dynamics_values_.clear();
+  for (size_t j = 0; j < num_cables_; ++j) {
+    InsertJointAngle(&kinematics_values_, j, 0, 0.0);
+    InsertJointVel(&kinematics_values_, j, 0, 0.0);
+    InsertTorque(&dynamics_values_, j, 0, 0.0);
+    InsertWrench(&dynamics_values_, id, j, 0, Vector6::Zero());
+  }
+  for (Values *values : {&kinematics_values_, &dynamics_values_}) {
+    InsertPose(values, id, 0, pose);
+    InsertTwist(values, id, 0, twist);
+  }
+  InsertPose(&dynamics_values_, id, 1, pose);
+  InsertTwist(&dynamics_values_, id, 1, twist);
+  InsertTwistAccel(&dynamics_values_, id, 0, Vector6::Zero());
+  dynamics_values_.insert(kDtKey, p_.dt);
+}
+
+/* ************************************************************************* */
+void CdprSimulator::solve(const gtsam::NonlinearFactorGraph &graph,
+                          const gtsam::LevenbergMarquardtParams &lm,
+                          const char *what, Values *local) {
+  *local = gtsam::LevenbergMarquardtOptimizer(graph, *local, lm).optimize();
+  if (graph.error(*local) > p_.tolerance)
+    throw std::runtime_error(std::string("CdprSimulator: ") + what +
+                             " didn't converge at time step " +
+                             std::to_string(k_) + ".");
+
+  // Time indices are the low bits of the keys, so adding k shifts the keys.
+  for (auto &&key_value : *local) {
+    if (key_value.key == kDtKey) continue;
+    const Key key = key_value.key + k_;
+    if (x_.exists(key))
+      x_.update(key, key_value.value);
+    else
+      x_.insert(key, key_value.value);
+  }
+}
+
+/* ************************************************************************* */
+void CdprSimulator::updateKinematics() {
+  const int id = ee_->id();
+  const Pose3 pose = Pose(x_, id, k_);
+  const Vector6 twist = Twist(x_, id, k_);
+  kinematics_.replace(kinematics_priors_,
+                      boost::make_shared<PriorFactor<Pose3>>(PoseKey(id, 0),
+                                                             pose, model6_));
+  kinematics_.replace(kinematics_priors_ + 1,
+                      boost::make_shared<PriorFactor<Vector6>>(
+                          TwistKey(id, 0), twist, model6_));
+  kinematics_values_.update(PoseKey(id, 0), pose);
+  kinematics_values_.update(TwistKey(id, 0), twist);
+  solve(kinematics_, kinematics_lm_, "inverse kinematics",
+        &kinematics_values_);
+}
+
+/* ************************************************************************* */
+void CdprSimulator::updateDynamics(const Values &torques) {
+  const int id = ee_->id();
+  const Pose3 pose = Pose(x_, id, k_);
+  const Vector6 twist = Twist(x_, id, k_);
+  dynamics_.replace(dynamics_priors_,
+                    boost::make_shared<PriorFactor<Pose3>>(PoseKey(id, 0),
+                                                           pose, model6_));
+  dynamics_.replace(dynamics_priors_ + 1,
+                    boost::make_shared<PriorFactor<Vector6>>(
+                        TwistKey(id, 0), twist, model6_));
+  for (size_t j = 0; j < num_cables_; ++j) {
+    const double torque = Torque(torques, j, k_);
+    dynamics_.replace(dynamics_priors_ + 2 + j,
+                      boost::make_shared<PriorFactor<double>>(
+                          TorqueKey(j, 0), torque, model1_));
+    dynamics_values_.update(TorqueKey(j, 0), torque);
+  }
+
+  // The rest of the initial guess is the previous step's solution, which
+  // ended at this state.
+  dynamics_values_.update(PoseKey(id, 0), pose);
+  dynamics_values_.update(TwistKey(id, 0), twist);
+  solve(dynamics_, dynamics_lm_, "dynamics simulation", &dynamics_values_);
+}
+
+/* ************************************************************************* */
+const Values &CdprSimulator::step(const Controller &controller) {
+  updateKinematics();
+  updateDynamics(controller(x_, k_));
+  ++k_;
+  return x_;
+}
+
+/* ************************************************************************* */
+const Values &CdprSimulator::step(const Values &torques) {
+  updateKinematics();
+  updateDynamics(torques);
+  ++k_;
+  return x_;
+}
+
+/* ************************************************************************* */
+const Values &CdprSimulator::run(const Controller &controller,
+                                 int num_steps) {
+  for (int i = 0; i < num_steps; ++i) step(controller);
+  return x_;
+}
+
+/* ************************************************************************* */
+const Values &CdprSimulator::run(const Values &torques, int num_steps) {
+  for (int i = 0; i < num_steps; ++i) step(torques);
+  return x_;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,124 @@
+/**
+ * @file  CdprSimulator.h
+ * @brief Simulation for a cable robot, with the factor graphs of one time step
+ * built once and solved again at every step.
+ */
+
+#pragma once
+
+#include <gtdynamics/universal_robot/Link.h>
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+
+namespace gtdynamics {
+
+/// Parameters of CdprSimulator.
+struct CdprSimulatorParameters {
+  double dt = 0.01;     ///< time step duration
+  double sigma = 1e-3;  ///< standard deviation of all factors
+  gtsam::Vector3 gravity = gtsam::Vector3::Zero();
+  double tolerance = 1e-20;            ///< largest error of a solved step
+  gtsam::LevenbergMarquardtParams lm;  ///< ordering is set by the simulator
+};
+
+/**
+ * CdprSimulator runs a cable robot forward in time, as the Python
+ * CdprSimulator in cdpr_planar_sim.py does:
+ *
+ * Pose/Twist -> l/ldot -> torques -> Wrenches/TwistAccel -> next Pose/Twist
+ *            IK     Controller     ID                  Collocation
+ *
+ * Instead of adding new factors for every time step, the kinematics and the
+ * dynamics graphs of a single step are built once, with the variables at
+ * time 0 (and 1 for the next Pose/Twist). Each step only replaces the priors
+ * on the current state and torques, warm-starts from the previous step and
+ * solves with an elimination ordering computed once. The solution is copied
+ * into the full trajectory with the keys shifted to the current time step.
+ *
+ * Variables are those of the Python simulator: JointAngle/JointVel/Torque of
+ * each cable j, the Pose/Twist/TwistAccel of the end effector, the Wrench of
+ * each cable on the end effector, and dt at key 0. No planar constraints are
+ * added, since the motion follows from the priors and the collocation.
+ */
+class CdprSimulator {
+ public:
+  /// Returns the torques Torque(j, k) at step k, given the values so far.
+  using Controller =
+      std::function<gtsam::Values(const gtsam::Values &values, int k)>;
+
+  /**
+   * Constructor
+   * @param ee          the end-effector link
+   * @param wPa         cable mounting points on the frame, one per row, in
+   *                    world coordinates
+   * @param xPb         cable mounting points on the end effector, one per row,
+   *                    in the end-effector frame
+   * @param x0          initial state, with the Pose and Twist at time 0
+   * @param parameters  time step, noise and optimizer parameters
+   */
+  CdprSimulator(const LinkSharedPtr &ee, const gtsam::Matrix &wPa,
+                const gtsam::Matrix &xPb, const gtsam::Values &x0,
+                const CdprSimulatorParameters &parameters =
+                    CdprSimulatorParameters());
+
+  /// Simulate one time step with torques from the controller.
+  const gtsam::Values &step(const Controller &controller);
+
+  /// Simulate one time step with the torques at the current step in `torques`.
+  const gtsam::Values &step(const gtsam::Values &torques);
+
+  /// Simulate `num_steps` time steps with torques from the controller.
+  const gtsam::Values &run(const Controller &controller, int num_steps);
+
+  /**
+   * Simulate `num_steps` time steps open-loop, with the torques of every step
+   * in `torques`, e.g. the result of an optimal controller.
+   */
+  const gtsam::Values &run(const gtsam::Values &torques, int num_steps);
+
+  /// Go back to the initial state at time step 0.
+  void reset();
+
+  /// All values simulated so far.
+  const gtsam::Values &values() const { return x_; }
+
+  /// Index of the next time step to simulate.
+  int timeStep() const { return k_; }
+
+ private:
+  /// Solve for the cable lengths and velocities at the current step.
+  void updateKinematics();
+
+  /// Solve for the accelerations and the next Pose/Twist, given the torques.
+  void updateDynamics(const gtsam::Values &torques);
+
+  /// Solve a step graph from `local`, and copy the result into x_.
+  void solve(const gtsam::NonlinearFactorGraph &graph,
+             const gtsam::LevenbergMarquardtParams &lm, const char *what,
+             gtsam::Values *local);
+
+  LinkSharedPtr ee_;
+  size_t num_cables_;
+  gtsam::Values x0_;
+  CdprSimulatorParameters p_;
+
+  // Step graphs, with the priors at the end, and their solver parameters.
+  gtsam::NonlinearFactorGraph kinematics_, dynamics_;
+  size_t kinematics_priors_, dynamics_priors_;
+  gtsam::LevenbergMarquardtParams kinematics_lm_, dynamics_lm_;
+  gtsam::SharedNoiseModel model1_, model6_;
+
+  // Solution of the last step, in step-local keys.
+  gtsam::Values kinematics_values_, dynamics_values_;
+
+  gtsam::Values x_;
+  int k_ = 0;
+};
+
+}  // namespace gtdynamics
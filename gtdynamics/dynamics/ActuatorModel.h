@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ActuatorModel.h
+ * @brief Actuator dynamics of one joint, sub-stepped by the Simulator.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/**
+ * Dynamics of the actuator of one joint: a state x, e.g. a motor current or
+ * the air mass of a muscle, driven by a command, e.g. a voltage or a valve
+ * opening, and the torque it exerts on the joint. Actuator dynamics are
+ * often much faster than the rigid-body dynamics, so the Simulator advances
+ * x with several sub-steps per rigid-body step, see Simulator::setActuator.
+ */
+class ActuatorModel {
+ public:
+  using shared_ptr = boost::shared_ptr<const ActuatorModel>;
+
+  virtual ~ActuatorModel() {}
+
+  /// State at the start of a simulation.
+  virtual gtsam::Vector initialState() const = 0;
+
+  /**
+   * Advance the state by one sub-step.
+   * @param h        duration of the sub-step
+   * @param command  command, held constant over the sub-step
+   * @param q        joint angle
+   * @param v        joint velocity
+   * @param x        state, updated in place
+   */
+  virtual void step(double h, double command, double q, double v,
+                    gtsam::Vector *x) const = 0;
+
+  /// Torque on the joint in state x at joint angle q and velocity v.
+  virtual double torque(const gtsam::Vector &x, double q, double v) const = 0;
+};
+
+/// Parameters of DCMotorModel, in SI units.
+struct DCMotorParameters {
+  double resistance = 1.0;        ///< armature resistance (Ohm)
+  double inductance = 1e-3;       ///< armature inductance (H)
+  double torque_constant = 0.05;  ///< also the back-emf constant (Nm/A)
+  double gear_ratio = 1.0;        ///< motor turns per joint turn
+  double max_voltage = std::numeric_limits<double>::infinity();
+};
+
+/**
+ * Brushed DC motor behind a gearbox, with the armature current i as its
+ * state and the voltage as its command:
+ *   L di/dt = u - R i - k N v,  torque = N k i.
+ * With L / R often well below a millisecond, the current is integrated
+ * implicitly, which is stable for any sub-step.
+ */
+class DCMotorModel : public ActuatorModel {
+ public:
+  explicit DCMotorModel(const DCMotorParameters &parameters =
+                            DCMotorParameters())
+      : p_(parameters) {
+    if (p_.resistance < 0 || p_.inductance <= 0 || p_.max_voltage < 0)
+      throw std::invalid_argument(
+          "DCMotorModel: need a positive inductance, and a nonnegative "
+          "resistance and voltage limit.");
+  }
+
+  const DCMotorParameters &parameters() const { return p_; }
+
+  gtsam::Vector initialState() const override {
+    return gtsam::Vector::Zero(1);
+  }
+
+  void step(double h, double command, double q, double v,
+            gtsam::Vector *x) const override {
+    const double u = std::min(std::max(command, -p_.max_voltage),
+                              p_.max_voltage);
+    const double back_emf = p_.torque_constant * p_.gear_ratio * v;
+    (*x)(0) = ((*x)(0) + h / p_.inductance * (u - back_emf)) /
+              (1 + h * p_.resistance / p_.inductance);
+  }
+
+  double torque(const gtsam::Vector &x, double q, double v) const override {
+    return p_.gear_ratio * p_.torque_constant * x(0);
+  }
+
+ private:
+  DCMotorParameters p_;
+};
+
+}  // namespace gtdynamics
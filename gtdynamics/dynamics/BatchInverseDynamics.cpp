@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchInverseDynamics.cpp
+ * @brief Inverse dynamics of whole trajectories, with the steps in parallel.
+ */
+
+#include "gtdynamics/dynamics/BatchInverseDynamics.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::Matrix;
+
+namespace gtdynamics {
+
+namespace {
+// Steps per job: enough to amortize handing out work, few enough to balance.
+constexpr size_t kBlockSize = 256;
+}  // namespace
+
+/* ************************************************************************* */
+BatchInverseDynamics::BatchInverseDynamics(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    size_t num_threads)
+    : pool_(num_threads) {
+  for (size_t w = 0; w < pool_.numThreads(); ++w)
+    workers_.emplace_back(new Worker(robot, gravity));
+  num_joint_slots_ =
+      workers_.front()->dynamics.compiledRobot().numJointSlots();
+}
+
+/* ************************************************************************* */
+TrajectoryInverseDynamicsResult BatchInverseDynamics::solve(
+    const Matrix &Q, const Matrix &V, const Matrix &A, bool wrenches) {
+  const size_t J = num_joint_slots_;
+  if (size_t(Q.cols()) != J || size_t(V.cols()) != J ||
+      size_t(A.cols()) != J || V.rows() != Q.rows() || A.rows() != Q.rows())
+    throw std::invalid_argument(
+        "BatchInverseDynamics: trajectories need one row per step and one "
+        "column per joint slot.");
+
+  const size_t T = Q.rows();
+  TrajectoryInverseDynamicsResult result;
+  result.torques.resize(T, J);
+  if (wrenches) {
+    result.parent_wrenches.resize(T, 6 * J);
+    result.child_wrenches.resize(T, 6 * J);
+  }
+
+  const size_t num_blocks = (T + kBlockSize - 1) / kBlockSize;
+  pool_.parallelFor(num_blocks, [&](size_t b, size_t w) {
+    Worker &worker = *workers_[w];
+    RecursiveDynamicsResult &step = worker.result;
+    const size_t end = std::min(T, (b + 1) * kBlockSize);
+    for (size_t k = b * kBlockSize; k < end; ++k) {
+      worker.q = Q.row(k).transpose();
+      worker.v = V.row(k).transpose();
+      worker.a = A.row(k).transpose();
+      worker.dynamics.inverseDynamics(worker.q, worker.v, worker.a, &step);
+      result.torques.row(k) = step.torques.transpose();
+      if (!wrenches) continue;
+      // Wrench columns are contiguous per joint, so copy them as rows.
+      for (size_t j = 0; j < J; ++j) {
+        result.parent_wrenches.block<1, 6>(k, 6 * j) =
+            step.parent_wrenches.col(j).transpose();
+        result.child_wrenches.block<1, 6>(k, 6 * j) =
+            step.child_wrenches.col(j).transpose();
+      }
+    }
+  });
+  return result;
+}
+
+/* ************************************************************************* */
+Matrix BatchInverseDynamics::torques(const Matrix &Q, const Matrix &V,
+                                     const Matrix &A) {
+  return solve(Q, V, A, false).torques;
+}
+
+}  // namespace gtdynamics
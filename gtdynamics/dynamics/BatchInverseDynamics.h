@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchInverseDynamics.h
+ * @brief Inverse dynamics of whole trajectories, with the steps in parallel.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * Torques and joint wrenches of a trajectory, one row per time step. Column j
+ * of `torques` holds the joint with id j, and columns 6j..6j+5 of the wrench
+ * matrices hold F_{parent,j} and F_{child,j}, in the frames of
+ * RecursiveDynamicsResult. The wrench matrices are empty when not requested.
+ */
+struct TrajectoryInverseDynamicsResult {
+  gtsam::Matrix torques;          ///< #steps x #joint slots
+  gtsam::Matrix parent_wrenches;  ///< #steps x 6 #joint slots
+  gtsam::Matrix child_wrenches;   ///< #steps x 6 #joint slots
+
+  /// Parent wrench of joint j at step k.
+  gtsam::Vector6 parentWrench(size_t k, int j) const {
+    return parent_wrenches.block<1, 6>(k, 6 * j).transpose();
+  }
+
+  /// Child wrench of joint j at step k.
+  gtsam::Vector6 childWrench(size_t k, int j) const {
+    return child_wrenches.block<1, 6>(k, 6 * j).transpose();
+  }
+};
+
+/**
+ * BatchInverseDynamics evaluates the torques of recorded or planned motions,
+ * replacing a DynamicsGraph::linearSolveID per time step. The steps of a
+ * trajectory are independent given q, v and a, so they are split in blocks
+ * of consecutive steps over a ThreadPool, and every thread runs recursive
+ * Newton-Euler on its own RecursiveDynamics and result buffers, allocated
+ * once at construction. Floating roots are at the identity with zero twist,
+ * as in RecursiveDynamics::inverseDynamicsTrajectory.
+ */
+class BatchInverseDynamics {
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot        the robot, needs to have a tree structure
+   * @param gravity      gravity vector
+   * @param num_threads  number of threads, 0 for hardware concurrency
+   */
+  BatchInverseDynamics(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      size_t num_threads = 0);
+
+  /// Number of threads used for the solves.
+  size_t numThreads() const { return pool_.numThreads(); }
+
+  /// Number of joint slots, i.e., of columns of the trajectories.
+  size_t numJointSlots() const { return num_joint_slots_; }
+
+  /**
+   * Inverse dynamics of every step of a trajectory.
+   * @param Q         joint angles, #steps x #joint slots
+   * @param V         joint velocities, same layout
+   * @param A         joint accelerations, same layout
+   * @param wrenches  whether to fill the wrench matrices of the result
+   */
+  TrajectoryInverseDynamicsResult solve(const gtsam::Matrix &Q,
+                                        const gtsam::Matrix &V,
+                                        const gtsam::Matrix &A,
+                                        bool wrenches = true);
+
+  /// Torques of every step only, #steps x #joint slots.
+  gtsam::Matrix torques(const gtsam::Matrix &Q, const gtsam::Matrix &V,
+                        const gtsam::Matrix &A);
+
+ private:
+  struct Worker {
+    RecursiveDynamics dynamics;
+    RecursiveDynamicsResult result;
+    gtsam::Vector q, v, a;
+    Worker(const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+        : dynamics(robot, gravity) {
+      dynamics.allocate(&result);
+    }
+  };
+
+  size_t num_joint_slots_;
+  std::vector<std::unique_ptr<Worker>> workers_;  // per thread
+  ThreadPool pool_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,178 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.cpp
+ * @brief Simulate many torque sequences in parallel, e.g., for sampling MPC.
+ */
+
+#include "gtdynamics/dynamics/BatchSimulator.h"
+
+#include <boost/make_shared.hpp>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+BatchSimulator::BatchSimulator(const Robot &robot,
+                               const gtsam::Values &initial_values,
+                               const boost::optional<gtsam::Vector3> &gravity,
+                               size_t num_threads)
+    : robot_(robot), num_joints_(robot.numJoints()), pool_(num_threads) {
+  for (size_t w = 0; w < pool_.numThreads(); ++w)
+    dynamics_.push_back(boost::make_shared<RecursiveDynamics>(robot, gravity));
+  dynamics_.front()->setRootStates(initial_values, 0, &initial_result_);
+
+  q0_ = gtsam::Vector::Zero(num_joints_);
+  v0_ = gtsam::Vector::Zero(num_joints_);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    if (j >= static_cast<int>(num_joints_))
+      throw std::runtime_error("BatchSimulator: joint ids should be 0.." +
+                               std::to_string(num_joints_ - 1));
+    if (initial_values.exists(internal::JointAngleKey(j)))
+      q0_(j) = JointAngle(initial_values, j);
+    if (initial_values.exists(internal::JointVelKey(j)))
+      v0_(j) = JointVel(initial_values, j);
+  }
+}
+
+/* ************************************************************************* */
+size_t BatchSimulator::checkTorques(
+    const std::vector<gtsam::Matrix> &torque_seqs) const {
+  const size_t J = num_joints_;
+  const size_t K = torque_seqs.empty() ? 0 : torque_seqs.front().rows();
+  for (auto &&torques : torque_seqs) {
+    if (static_cast<size_t>(torques.rows()) != K ||
+        static_cast<size_t>(torques.cols()) != J)
+      throw std::invalid_argument(
+          "BatchSimulator::simulate: all torque sequences should be " +
+          std::to_string(K) + " x " + std::to_string(J));
+  }
+  return K;
+}
+
+/* ************************************************************************* */
+std::vector<BatchSimulator::Workspace> BatchSimulator::workspaces() const {
+  // Initialized with the floating root states.
+  Workspace ws;
+  ws.result = initial_result_;
+  ws.tau = gtsam::Vector::Zero(num_joints_);
+  return std::vector<Workspace>(pool_.numThreads(), ws);
+}
+
+/* ************************************************************************* */
+template <class STEP>
+void BatchSimulator::rollout(const gtsam::Matrix &torques, double dt,
+                             size_t worker, Workspace *ws, STEP &&step) const {
+  const RecursiveDynamics &dynamics = *dynamics_[worker];
+  const double dt2 = dt * dt;
+  SimulatorMetrics &metrics = ws->metrics;
+  MetricsTimer step_timer(collect_metrics_), timer(collect_metrics_);
+  ws->q = q0_;
+  ws->v = v0_;
+  for (size_t k = 0; k < static_cast<size_t>(torques.rows()); ++k) {
+    ws->tau = torques.row(k).transpose();
+    timer.restart();
+    dynamics.forwardDynamics(ws->q, ws->v, ws->tau, &ws->result);
+    timer.stop(&metrics.forward_dynamics);
+    step(k, *ws);
+
+    // Same explicit scheme as Simulator::integration.
+    timer.restart();
+    const auto a = ws->result.joint_accels.head(num_joints_);
+    ws->q += dt * ws->v + 0.5 * dt2 * a;
+    ws->v += dt * a;
+    timer.stop(&metrics.integration);
+    if (collect_metrics_) {
+      metrics.wall_time += step_timer.stop(&metrics.step);
+      metrics.simulated_time += dt;
+    }
+  }
+}
+
+/* ************************************************************************* */
+void BatchSimulator::mergeMetrics(const std::vector<Workspace> &ws) {
+  if (!collect_metrics_) return;
+  for (auto &&w : ws) metrics_.merge(w.metrics);
+}
+
+/* ************************************************************************* */
+RolloutStates BatchSimulator::simulateRows(
+    const std::vector<gtsam::Matrix> &torque_seqs, double dt,
+    const std::vector<size_t> *selected) {
+  const size_t J = num_joints_;
+  const size_t K = checkTorques(torque_seqs);
+  const size_t N = selected ? selected->size() : torque_seqs.size();
+  if (selected)
+    for (size_t r : *selected)
+      if (r >= torque_seqs.size())
+        throw std::invalid_argument(
+            "BatchSimulator::simulate: no rollout " + std::to_string(r));
+
+  RolloutStates states;
+  states.num_steps = K;
+  states.num_joints = J;
+  states.q.resize(N, (K + 1) * J);
+  states.v.resize(N, (K + 1) * J);
+  states.a.resize(N, K * J);
+
+  std::vector<Workspace> ws = workspaces();
+  pool_.parallelFor(N, [&](size_t i, size_t worker) {
+    const size_t r = selected ? (*selected)[i] : i;
+    rollout(torque_seqs[r], dt, worker, &ws[worker],
+            [&](size_t k, const Workspace &w) {
+              states.q.row(i).segment(k * J, J) = w.q.transpose();
+              states.v.row(i).segment(k * J, J) = w.v.transpose();
+              states.a.row(i).segment(k * J, J) =
+                  w.result.joint_accels.head(J).transpose();
+            });
+    states.q.row(i).tail(J) = ws[worker].q.transpose();
+    states.v.row(i).tail(J) = ws[worker].v.transpose();
+  });
+  mergeMetrics(ws);
+  return states;
+}
+
+/* ************************************************************************* */
+RolloutStates BatchSimulator::simulate(
+    const std::vector<gtsam::Matrix> &torque_seqs, double dt) {
+  return simulateRows(torque_seqs, dt, nullptr);
+}
+
+/* ************************************************************************* */
+RolloutStates BatchSimulator::simulate(
+    const std::vector<gtsam::Matrix> &torque_seqs, double dt,
+    const std::vector<size_t> &selected) {
+  return simulateRows(torque_seqs, dt, &selected);
+}
+
+/* ************************************************************************* */
+gtsam::Vector BatchSimulator::simulateCosts(
+    const std::vector<gtsam::Matrix> &torque_seqs, double dt,
+    const RolloutStageCost &stage_cost,
+    const RolloutTerminalCost &terminal_cost) {
+  checkTorques(torque_seqs);
+  gtsam::Vector costs(torque_seqs.size());
+  std::vector<Workspace> ws = workspaces();
+  pool_.parallelFor(torque_seqs.size(), [&](size_t r, size_t worker) {
+    double cost = 0;
+    rollout(torque_seqs[r], dt, worker, &ws[worker],
+            [&](size_t k, const Workspace &w) {
+              cost += stage_cost(k, w.q, w.v, w.tau);
+            });
+    if (terminal_cost) cost += terminal_cost(ws[worker].q, ws[worker].v);
+    costs(r) = cost;
+  });
+  mergeMetrics(ws);
+  return costs;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,184 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchSimulator.h
+ * @brief Simulate many torque sequences in parallel, e.g., for sampling MPC.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <functional>
+#include <vector>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/dynamics/SimulatorMetrics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * States of a batch of rollouts. Each rollout is a row, laid out step-major:
+ * the entry for joint j at step k is in column k * num_joints + j. Angles and
+ * velocities include the initial state (num_steps + 1 steps), accelerations
+ * are those computed at each of the num_steps steps.
+ */
+struct RolloutStates {
+  size_t num_steps, num_joints;
+  gtsam::Matrix q, v, a;
+
+  /// Joint angles of a rollout at step k, indexed by joint id.
+  gtsam::Vector angles(size_t rollout, size_t k) const {
+    return q.row(rollout).segment(k * num_joints, num_joints).transpose();
+  }
+
+  /// Joint velocities of a rollout at step k, indexed by joint id.
+  gtsam::Vector velocities(size_t rollout, size_t k) const {
+    return v.row(rollout).segment(k * num_joints, num_joints).transpose();
+  }
+
+  /// Joint accelerations of a rollout at step k, indexed by joint id.
+  gtsam::Vector accelerations(size_t rollout, size_t k) const {
+    return a.row(rollout).segment(k * num_joints, num_joints).transpose();
+  }
+};
+
+/**
+ * Cost of one step of a rollout: step k, the state (q, v) at its start and the
+ * torques tau applied during it, all indexed by joint id. Called concurrently
+ * from the threads of the simulator, so it should not modify shared state.
+ */
+using RolloutStageCost = std::function<double(
+    size_t k, const gtsam::Vector &q, const gtsam::Vector &v,
+    const gtsam::Vector &tau)>;
+
+/// Cost of the final state (q, v) of a rollout, see RolloutStageCost.
+using RolloutTerminalCost =
+    std::function<double(const gtsam::Vector &q, const gtsam::Vector &v)>;
+
+/**
+ * BatchSimulator integrates many torque sequences from the same initial state
+ * with the same scheme as Simulator, using articulated-body forward dynamics.
+ * All rollouts share one Robot, every thread has its own dynamics workspace,
+ * and rollouts are distributed over a thread pool.
+ *
+ * For large sample counts, as in MPPI, simulateCosts keeps only the state of
+ * the rollouts in flight, one per thread, and returns one cost per rollout;
+ * the states of the few rollouts of interest can then be recomputed with
+ * simulate(torque_seqs, dt, selected).
+ */
+class BatchSimulator {
+ private:
+  Robot robot_;
+  size_t num_joints_;
+  std::vector<boost::shared_ptr<RecursiveDynamics>> dynamics_;  // per thread
+  RecursiveDynamicsResult initial_result_;  // initial floating root states
+  gtsam::Vector q0_, v0_;
+  ThreadPool pool_;
+  bool collect_metrics_ = false;
+  SimulatorMetrics metrics_;
+
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot          robot, needs to have a tree structure
+   * @param initial_values initial joint angles and velocities
+   * @param gravity        gravity vector
+   * @param num_threads    number of threads, 0 for hardware concurrency
+   */
+  BatchSimulator(const Robot &robot, const gtsam::Values &initial_values,
+                 const boost::optional<gtsam::Vector3> &gravity = boost::none,
+                 size_t num_threads = 0);
+
+  /// Number of threads used for the rollouts.
+  size_t numThreads() const { return pool_.numThreads(); }
+
+  /**
+   * Simulate a batch of torque sequences.
+   * @param torque_seqs one num_steps x num_joints matrix per rollout, where
+   * column j holds the torques of the joint with id j.
+   * @param dt duration of each time step
+   */
+  RolloutStates simulate(const std::vector<gtsam::Matrix> &torque_seqs,
+                         double dt);
+
+  /**
+   * Simulate only the selected torque sequences.
+   * @param torque_seqs one num_steps x num_joints matrix per rollout
+   * @param dt duration of each time step
+   * @param selected indices of the rollouts to simulate; row i of the result
+   * is rollout selected[i].
+   */
+  RolloutStates simulate(const std::vector<gtsam::Matrix> &torque_seqs,
+                         double dt, const std::vector<size_t> &selected);
+
+  /**
+   * Simulate a batch of torque sequences and return their costs only, without
+   * storing the trajectories.
+   * @param torque_seqs one num_steps x num_joints matrix per rollout
+   * @param dt duration of each time step
+   * @param stage_cost cost of each step
+   * @param terminal_cost if given, cost of the final state
+   * @return the total cost of each rollout
+   */
+  gtsam::Vector simulateCosts(
+      const std::vector<gtsam::Matrix> &torque_seqs, double dt,
+      const RolloutStageCost &stage_cost,
+      const RolloutTerminalCost &terminal_cost = nullptr);
+
+  /**
+   * Collect per-step latencies of forward dynamics, integration and whole
+   * steps of all rollouts, see SimulatorMetrics. Each thread records its own
+   * and they are merged after each call. The wall time is summed over the
+   * threads, so the real-time factor is that of one thread.
+   */
+  void enableMetrics(bool enable = true) { collect_metrics_ = enable; }
+
+  /// Return the metrics collected so far, see enableMetrics.
+  const SimulatorMetrics &metrics() const { return metrics_; }
+
+  /// Forget the metrics collected so far.
+  void resetMetrics() { metrics_.reset(); }
+
+ private:
+  // State of one rollout in flight, and metrics, one per thread.
+  struct Workspace {
+    RecursiveDynamicsResult result;
+    gtsam::Vector q, v, tau;
+    SimulatorMetrics metrics;
+  };
+
+  // Check that all torque sequences have the same size, return num_steps.
+  size_t checkTorques(const std::vector<gtsam::Matrix> &torque_seqs) const;
+
+  // Integrate torques from the initial state in the given workspace. For
+  // every step k, step(k, ws) is called with the state at the start of the
+  // step in ws.q and ws.v, the torques in ws.tau, and the accelerations in
+  // ws.result.joint_accels, before the state is updated.
+  template <class STEP>
+  void rollout(const gtsam::Matrix &torques, double dt, size_t worker,
+               Workspace *ws, STEP &&step) const;
+
+  // Workspaces for all threads, initialized with the initial state.
+  std::vector<Workspace> workspaces() const;
+
+  // Add the metrics of the workspaces, if enabled.
+  void mergeMetrics(const std::vector<Workspace> &ws);
+
+  // States of rollouts selected[i], or of all when selected is null.
+  RolloutStates simulateRows(const std::vector<gtsam::Matrix> &torque_seqs,
+                             double dt, const std::vector<size_t> *selected);
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,230 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalPlanner.cpp
+ * @brief Centroidal-momentum planning, to seed full kinodynamic planning.
+ */
+
+#include "gtdynamics/dynamics/CentroidalPlanner.h"
+
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+#include "gtdynamics/factors/CentroidalFactors.h"
+#include "gtdynamics/utils/NoiseModels.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix3;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CompositeInertia ComputeCompositeInertia(const Robot &robot,
+                                         const Values &values, size_t t) {
+  CompositeInertia result;
+  for (auto &&link : robot.links()) {
+    result.mass += link->mass();
+    result.com += link->mass() * Pose(values, link->id(), t).translation();
+  }
+  if (result.mass <= 0)
+    throw std::invalid_argument(
+        "ComputeCompositeInertia: the robot has no mass.");
+  result.com /= result.mass;
+
+  for (auto &&link : robot.links()) {
+    const Pose3 pose = Pose(values, link->id(), t);
+    const Matrix3 R = pose.rotation().matrix();
+    const Vector3 r = pose.translation() - result.com;
+    // Rotate the link inertia to the world frame, then shift it to the CoM.
+    result.inertia += R * link->inertia() * R.transpose() +
+                      link->mass() * (r.dot(r) * gtsam::I_3x3 -
+                                      r * r.transpose());
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+CentroidalPlanner::CentroidalPlanner(
+    const Robot &robot, const Values &nominal,
+    const std::vector<int> &phase_steps,
+    const std::vector<PointOnLinks> &phase_contact_points,
+    const Vector3 &gravity, const CentroidalPlannerParameters &parameters)
+    : robot_(robot),
+      gravity_(gravity),
+      p_(parameters),
+      inertia_(ComputeCompositeInertia(robot, nominal)) {
+  if (phase_steps.empty() || phase_steps.size() != phase_contact_points.size())
+    throw std::invalid_argument(
+        "CentroidalPlanner: needs the contact points of every phase.");
+
+  phase_start_.push_back(0);
+  for (size_t p = 0; p < phase_steps.size(); ++p) {
+    if (phase_steps[p] <= 0)
+      throw std::invalid_argument(
+          "CentroidalPlanner: phases need at least one step.");
+    phase_start_.push_back(phase_start_.back() + phase_steps[p]);
+
+    std::vector<int> indices;
+    std::vector<Point3> footholds;
+    for (auto &&cp : phase_contact_points[p]) {
+      auto it = std::find(contacts_.begin(), contacts_.end(), cp);
+      if (it == contacts_.end()) it = contacts_.insert(contacts_.end(), cp);
+      indices.push_back(int(it - contacts_.begin()));
+      footholds.push_back(cp.predict(nominal, 0));
+    }
+    phase_contacts_.push_back(indices);
+    footholds_.push_back(footholds);
+  }
+}
+
+/* ************************************************************************* */
+size_t CentroidalPlanner::phaseOf(int k) const {
+  if (k < 0 || k >= numSteps())
+    throw std::out_of_range("CentroidalPlanner::phaseOf: step out of range.");
+  return std::upper_bound(phase_start_.begin(), phase_start_.end(), k) -
+         phase_start_.begin() - 1;
+}
+
+/* ************************************************************************* */
+void CentroidalPlanner::setFootholds(size_t p,
+                                     const std::vector<Point3> &footholds) {
+  if (footholds.size() != phase_contacts_.at(p).size())
+    throw std::invalid_argument(
+        "CentroidalPlanner::setFootholds: needs one foothold per contact.");
+  footholds_[p] = footholds;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph CentroidalPlanner::graph() const {
+  gtsam::NonlinearFactorGraph graph;
+  const auto dynamics_model = IsotropicSigma(9, p_.dynamics_sigma);
+  const auto force_model = IsotropicSigma(3, p_.force_sigma);
+  const auto friction_model = IsotropicSigma(1, p_.friction_sigma);
+  const Vector3 normal = -gravity_.normalized();
+
+  for (int k = 0; k < numSteps(); ++k) {
+    const size_t p = phaseOf(k);
+    const std::vector<int> &contacts = phase_contacts_[p];
+    gtsam::KeyVector force_keys;
+    for (const int c : contacts) force_keys.push_back(ContactForceKey(c, k));
+    graph.emplace_shared<CentroidalDynamicsFactor>(
+        gtsam::KeyVector{ComKey(k), ComVelKey(k), MomentumKey(k),
+                         ComKey(k + 1), ComVelKey(k + 1), MomentumKey(k + 1)},
+        force_keys, footholds_[p], inertia_.mass, gravity_, p_.dt,
+        dynamics_model);
+
+    // Regularize towards carrying the weight evenly, so that the forces are
+    // determined when the contacts are redundant.
+    const Vector3 even_split = -inertia_.mass * gravity_ / contacts.size();
+    for (const gtsam::Key key : force_keys) {
+      graph.emplace_shared<gtsam::PriorFactor<Vector3>>(key, even_split,
+                                                        force_model);
+      if (p_.mu)
+        graph.emplace_shared<ForceFrictionConeFactor>(key, friction_model,
+                                                      *p_.mu, normal);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+Values CentroidalPlanner::initialValues() const {
+  Values values;
+  for (int k = 0; k <= numSteps(); ++k) {
+    values.insert(ComKey(k), Vector3(inertia_.com));
+    values.insert(ComVelKey(k), Vector3(Vector3::Zero()));
+    values.insert(MomentumKey(k), Vector3(Vector3::Zero()));
+    if (k == numSteps()) break;
+    const std::vector<int> &contacts = phase_contacts_[phaseOf(k)];
+    const Vector3 even_split = -inertia_.mass * gravity_ / contacts.size();
+    for (const int c : contacts)
+      values.insert(ContactForceKey(c, k), even_split);
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values CentroidalPlanner::solve(
+    const gtsam::NonlinearFactorGraph &objectives,
+    const boost::optional<Values> &initial) const {
+  gtsam::NonlinearFactorGraph graph = this->graph();
+  graph.push_back(objectives);
+  gtsam::LevenbergMarquardtOptimizer optimizer(
+      graph, initial ? *initial : initialValues(), p_.lm);
+  return optimizer.optimize();
+}
+
+/* ************************************************************************* */
+Values CentroidalPlanner::fullInitialValues(const Values &plan,
+                                            const Values &nominal) const {
+  // Link of each pose and twist key of step 0.
+  std::map<gtsam::Key, LinkSharedPtr> pose_links, twist_links;
+  for (auto &&link : robot_.links()) {
+    pose_links[internal::PoseKey(link->id(), 0)] = link;
+    twist_links[internal::TwistKey(link->id(), 0)] = link;
+  }
+  const Matrix3 inertia_inverse = inertia_.inertia.inverse();
+
+  Values values;
+  for (int k = 0; k <= numSteps(); ++k) {
+    const Point3 com = plan.at<Vector3>(ComKey(k));
+    const Vector3 com_vel = plan.at<Vector3>(ComVelKey(k));
+    const Vector3 omega = inertia_inverse * plan.at<Vector3>(MomentumKey(k));
+    const Vector3 offset = com - inertia_.com;
+    for (const gtsam::Key key : nominal.keys()) {
+      if (DynamicsSymbol::Time(key) != 0) continue;
+      // The time index occupies the low bits of a DynamicsSymbol.
+      const gtsam::Key key_k = key + k;
+      auto pose_link = pose_links.find(key);
+      auto twist_link = twist_links.find(key);
+      if (pose_link != pose_links.end()) {
+        const Pose3 pose = nominal.at<Pose3>(key);
+        values.insert(key_k,
+                      Pose3(pose.rotation(), pose.translation() + offset));
+      } else if (twist_link != twist_links.end()) {
+        // Rigid motion of the whole robot, in the link CoM frame.
+        const Pose3 pose = Pose(nominal, twist_link->second->id(), 0);
+        const Point3 r = pose.translation() + offset - com;
+        const Matrix3 Rt = pose.rotation().matrix().transpose();
+        gtsam::Vector6 twist;
+        twist << Rt * omega, Rt * (com_vel + omega.cross(r));
+        values.insert(key_k, twist);
+      } else {
+        values.insert(key_k, nominal.at(key));
+      }
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph CentroidalPlanner::comFactors(
+    const Values &plan, const gtsam::SharedNoiseModel &cost_model) const {
+  std::vector<double> masses;
+  for (auto &&link : robot_.links()) masses.push_back(link->mass());
+
+  gtsam::NonlinearFactorGraph graph;
+  for (int k = 0; k <= numSteps(); ++k) {
+    gtsam::KeyVector keys;
+    for (auto &&link : robot_.links())
+      keys.push_back(internal::PoseKey(link->id(), k));
+    graph.emplace_shared<CenterOfMassFactor>(
+        keys, masses, Point3(plan.at<Vector3>(ComKey(k))), cost_model);
+  }
+  return graph;
+}
+
+}  // namespace gtdynamics
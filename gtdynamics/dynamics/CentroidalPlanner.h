@@ -0,0 +1,185 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalPlanner.h
+ * @brief Centroidal-momentum planning, to seed full kinodynamic planning.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/PointOnLink.h"
+
+namespace gtdynamics {
+
+/// Mass properties of a whole robot, in the world frame.
+struct CompositeInertia {
+  double mass = 0;                               ///< total mass
+  gtsam::Point3 com = gtsam::Point3::Zero();     ///< center of mass
+  gtsam::Matrix3 inertia = gtsam::Matrix3::Zero();  ///< about the CoM
+};
+
+/**
+ * Composite rigid-body inertia of the robot at the link poses of time step t,
+ * i.e., the inertia of the robot were it locked in that configuration.
+ * @param robot   the robot
+ * @param values  link CoM poses at step t, e.g. from Robot::forwardKinematics
+ * @param t       time step
+ */
+CompositeInertia ComputeCompositeInertia(const Robot &robot,
+                                          const gtsam::Values &values,
+                                          size_t t = 0);
+
+/// Parameters of CentroidalPlanner.
+struct CentroidalPlannerParameters {
+  double dt = 0.01;            ///< duration of each time step
+  boost::optional<double> mu;  ///< coefficient of static friction, if any
+  double dynamics_sigma = 1e-4;  ///< of the centroidal dynamics defects
+  double friction_sigma = 1e-3;  ///< of the friction cone violations
+  double force_sigma = 100.0;    ///< of forces from an even split of weight
+  gtsam::LevenbergMarquardtParams lm;  ///< parameters of the solve
+};
+
+/**
+ * CentroidalPlanner is the reduced level of two-level legged planning. Its
+ * variables are the center of mass, its velocity and the angular momentum
+ * about it at every time step, and the world-frame force of every contact of
+ * the current phase, at footholds held fixed over the phase. The robot only
+ * enters through its total mass and composite inertia, so the graph has a
+ * dozen variables per step and solves in milliseconds.
+ *
+ * The plan then seeds the full DynamicsGraph::multiPhaseTrajectoryFG solve
+ * with the same phases: fullInitialValues() moves a nominal configuration
+ * along the planned CoM, and comFactors() make the full solve track the
+ * planned CoM.
+ *
+ * Phase p spans the steps from the sum of the preceding phase_steps to the
+ * next such sum; forces at a step push the state to the next step.
+ */
+class CentroidalPlanner {
+ public:
+  /**
+   * Constructor
+   * @param robot                 the robot
+   * @param nominal               link poses at time step 0 of a nominal
+   *                              stance, for the inertia and footholds
+   * @param phase_steps           number of time steps of each phase
+   * @param phase_contact_points  contact points of each phase
+   * @param gravity               gravity vector in the world frame
+   * @param parameters            time step, friction and noise
+   */
+  CentroidalPlanner(const Robot &robot, const gtsam::Values &nominal,
+                    const std::vector<int> &phase_steps,
+                    const std::vector<PointOnLinks> &phase_contact_points,
+                    const gtsam::Vector3 &gravity = gtsam::Vector3(0, 0, -9.8),
+                    const CentroidalPlannerParameters &parameters =
+                        CentroidalPlannerParameters());
+
+  /// Key of the center of mass at step k.
+  static gtsam::Key ComKey(int k) {
+    return DynamicsSymbol::SimpleSymbol(DynamicsLabel('c', 'p'), k);
+  }
+
+  /// Key of the velocity of the center of mass at step k.
+  static gtsam::Key ComVelKey(int k) {
+    return DynamicsSymbol::SimpleSymbol(DynamicsLabel('c', 'v'), k);
+  }
+
+  /// Key of the angular momentum about the center of mass at step k.
+  static gtsam::Key MomentumKey(int k) {
+    return DynamicsSymbol::SimpleSymbol(DynamicsLabel('c', 'h'), k);
+  }
+
+  /// Key of the force of contact c, an index into contacts(), at step k.
+  static gtsam::Key ContactForceKey(int c, int k) {
+    return DynamicsSymbol::LinkSymbol(DynamicsLabel('c', 'f'), c, k);
+  }
+
+  /// Mass properties of the robot in the nominal stance.
+  const CompositeInertia &inertia() const { return inertia_; }
+
+  /// All contact points, over all phases.
+  const PointOnLinks &contacts() const { return contacts_; }
+
+  /// Total number of time steps.
+  int numSteps() const { return phase_start_.back(); }
+
+  /// Index of the phase of step k < numSteps().
+  size_t phaseOf(int k) const;
+
+  /// Indices into contacts() of the contacts of phase p.
+  const std::vector<int> &phaseContacts(size_t p) const {
+    return phase_contacts_[p];
+  }
+
+  /// World positions of the contacts of phase p, nominal ones by default.
+  const std::vector<gtsam::Point3> &footholds(size_t p) const {
+    return footholds_[p];
+  }
+
+  /// Move the footholds of phase p, in the order of phaseContacts(p).
+  void setFootholds(size_t p, const std::vector<gtsam::Point3> &footholds);
+
+  /// Centroidal dynamics, friction cones and force regularization.
+  gtsam::NonlinearFactorGraph graph() const;
+
+  /// Standing still at the nominal CoM, with the weight split evenly.
+  gtsam::Values initialValues() const;
+
+  /**
+   * Solve the centroidal plan.
+   * @param objectives  extra factors, e.g. priors on ComKey(numSteps())
+   * @param initial     initial estimate, initialValues() by default
+   */
+  gtsam::Values solve(
+      const gtsam::NonlinearFactorGraph &objectives,
+      const boost::optional<gtsam::Values> &initial = boost::none) const;
+
+  /**
+   * Initial values of the full trajectory graph: the variables of `nominal`
+   * at step 0 copied to every step, with the link poses moved rigidly along
+   * the planned CoM and the link twists set from the planned CoM velocity
+   * and angular momentum.
+   * @param plan     result of solve()
+   * @param nominal  full-graph values at step 0, e.g. a standing solution
+   */
+  gtsam::Values fullInitialValues(const gtsam::Values &plan,
+                                  const gtsam::Values &nominal) const;
+
+  /**
+   * Factors that make the full trajectory track the planned CoM, one
+   * CenterOfMassFactor on the link poses of every step.
+   * @param plan        result of solve()
+   * @param cost_model  noise model of dimension 3
+   */
+  gtsam::NonlinearFactorGraph comFactors(
+      const gtsam::Values &plan,
+      const gtsam::SharedNoiseModel &cost_model) const;
+
+ private:
+  Robot robot_;
+  gtsam::Vector3 gravity_;
+  CentroidalPlannerParameters p_;
+  CompositeInertia inertia_;
+  PointOnLinks contacts_;
+  std::vector<int> phase_start_;  // first step of each phase, then the end
+  std::vector<std::vector<int>> phase_contacts_;
+  std::vector<std::vector<gtsam::Point3>> footholds_;
+};
+
+}  // namespace gtdynamics
@@ -45,44 +45,70 @@ Chain Chain::compose(std::vector<Chain> &chains) {
   return total_chain;
 }
 
+Chain Chain::composeTree(const std::vector<Chain> &chains, ThreadPool *pool) {
+  if (chains.empty()) return Chain();
+
+  // Compose neighbors pairwise until a single chain is left.
+  std::vector<Chain> level = chains, next;
+  while (level.size() > 1) {
+    next.resize((level.size() + 1) / 2);
+    const auto job = [&](size_t k, size_t) {
+      next[k] = 2 * k + 1 < level.size() ? level[2 * k] * level[2 * k + 1]
+                                         : level[2 * k];
+    };
+    if (pool) {
+      pool->parallelFor(next.size(), job);
+    } else {
+      for (size_t k = 0; k < next.size(); ++k) job(k, 0);
+    }
+    level.swap(next);
+  }
+  return level.front();
+}
+
+// Sweep backwards, T = exp(S_j q_j) ... exp(S_n q_n) fTe, so that the
+// Jacobian column of joint j is the screw axis seen from the end-effector,
+// which is what the monoid compose of the joint chains gives.
+static Pose3 PoeSweep(const Pose3 &sMb, const Matrix &axes, const Vector &q,
+                      const Pose3 &fTe, Matrix *J) {
+  Pose3 T = fTe;
+  if (J) J->resize(6, q.size());
+  for (int j = q.size() - 1; j >= 0; --j) {
+    const gtsam::Vector6 S = axes.col(j);
+    if (J) J->col(j) = T.inverse().AdjointMap() * S;
+    T = Pose3::Expmap(S * q(j)) * T;
+  }
+  return sMb * T;
+}
+
 Pose3 Chain::poe(const Vector &q, boost::optional<Pose3 &> fTe,
-                 gtsam::OptionalJacobian<-1, -1> J) {
+                 gtsam::OptionalJacobian<-1, -1> J) const {
   // Check that input has good size
   if (q.size() != length()) {
     throw std::runtime_error(
         "number of angles in q different from number of cols in axes");
   }
+  return PoeSweep(sMb_, axes_, q, fTe ? *fTe : Pose3(), J ? &(*J) : nullptr);
+}
 
-  // Build vector of exponential maps to use in poe
-  std::vector<Pose3> exp;
-  for (int i = 0; i < q.size(); ++i) {
-    exp.push_back(Pose3::Expmap(axes_.col(i) * q(i)));
-  }
-
-  Pose3 poe;
-  if (!J) {
-    // If J is not given, compute regular poe
-    poe = sMb_;
-    for (auto &expmap : exp) {
-      poe = poe.compose(expmap);
-    }
-    if (fTe) {
-      // compose end-effector pose
-      poe = poe.compose(*fTe);
+void Chain::poe(const std::vector<Vector> &qs, std::vector<Pose3> *poses,
+                std::vector<Matrix> *Js, const Pose3 &fTe,
+                ThreadPool *pool) const {
+  for (auto &&q : qs) {
+    if (q.size() != length()) {
+      throw std::runtime_error(
+          "number of angles in q different from number of cols in axes");
     }
+  }
+  poses->resize(qs.size());
+  if (Js) Js->resize(qs.size());
+  const auto job = [&](size_t k, size_t) {
+    (*poses)[k] = PoeSweep(sMb_, axes_, qs[k], fTe, Js ? &(*Js)[k] : nullptr);
+  };
+  if (pool) {
+    pool->parallelFor(qs.size(), job);
   } else {
-    // Compute FK + Jacobian with monoid compose.
-    Chain chain(sMb_);
-    for (int j = 0; j < q.size(); ++j) {
-      chain = chain * Chain(exp[j], axes_.col(j));
-    }
-    if (fTe) {
-      // compose end-effector pose
-      chain = chain * Chain(*fTe);
-    }
-    poe = chain.sMb();
-    *J = chain.axes();
+    for (size_t k = 0; k < qs.size(); ++k) job(k, 0);
   }
-  return poe;
 }
 }  // namespace gtdynamics
@@ -19,6 +19,10 @@
 #include <gtsam/geometry/Pose3.h>
 
 #include <boost/optional.hpp>
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/utils/ThreadPool.h"
 
 using gtsam::Matrix;
 using gtsam::Pose3;
@@ -69,6 +73,17 @@ class Chain {
    */
   static Chain compose(std::vector<Chain> &chains);
 
+  /**
+   * Same as compose, but as a pairwise tree reduction: a chain of L joints
+   * costs O(L log L) adjoint products instead of O(L^2), and the pairs of
+   * each level are composed in parallel if a pool is given.
+   * @param chains ............. Chains to compose, in order
+   * @param pool ............... Optional thread pool
+   * @return ....................... Composed chain
+   */
+  static Chain composeTree(const std::vector<Chain> &chains,
+                           ThreadPool *pool = nullptr);
+
   // Return sMb.
   inline const Pose3 &sMb() const { return sMb_; }
 
@@ -90,7 +105,99 @@ class Chain {
    * Exponentials
    */
   Pose3 poe(const Vector &q, boost::optional<Pose3 &> fTe = boost::none,
-            gtsam::OptionalJacobian<-1, -1> J = boost::none);
+            gtsam::OptionalJacobian<-1, -1> J = boost::none) const;
+
+  /**
+   * Batch forward kinematics, one pose (and Jacobian) per vector of angles.
+   * @param qs .......... Input angles, one vector per configuration
+   * @param(out) poses .. End-effector poses
+   * @param(out) Js ..... Jacobians (Optional)
+   * @param fTe ......... The end-effector pose with respect to final link
+   * @param pool ........ Thread pool to spread configurations over (Optional)
+   */
+  void poe(const std::vector<Vector> &qs, std::vector<Pose3> *poses,
+           std::vector<Matrix> *Js = nullptr, const Pose3 &fTe = Pose3(),
+           ThreadPool *pool = nullptr) const;
+};
+
+/**
+ * FixedChain is a Chain with a number of joints N known at compile time, e.g.
+ * FixedChain<7> for a 7-DoF arm. Angles, screw axes and Jacobians are fixed
+ * size Eigen types, so poe does not allocate and vectorizes.
+ */
+template <int N>
+class FixedChain {
+ public:
+  using Angles = Eigen::Matrix<double, N, 1>;
+  using Axes = Eigen::Matrix<double, 6, N>;
+  using Jacobians = std::vector<Axes, Eigen::aligned_allocator<Axes>>;
+
+  /// Construct from a chain with N joints.
+  explicit FixedChain(const Chain &chain)
+      : sMb_(chain.sMb()),
+        axes_(chain.length() == N
+                  ? Axes(chain.axes())
+                  : throw std::runtime_error(
+                        "FixedChain: chain length differs from N")) {}
+
+  /// Constructor
+  FixedChain(const Pose3 &sMb, const Axes &axes) : sMb_(sMb), axes_(axes) {}
+
+  // Return sMb.
+  const Pose3 &sMb() const { return sMb_; }
+
+  // Return screw axes.
+  const Axes &axes() const { return axes_; }
+
+  /**
+   * Forward kinematics and, optionally, the Jacobian in the end-effector
+   * frame, as in Chain::poe. A single backward sweep accumulates
+   * T_j = exp(S_j q_j) ... exp(S_N q_N) fTe, with Jacobian columns
+   * Ad(T_{j+1}^-1) S_j and end-effector pose sMb T_1.
+   * @param q ........... Input angles for all joints
+   * @param fTe ......... The end-effector pose with respect to final link
+   * @param(out) J ...... Jacobian (Optional)
+   * @return ............ Pose of the end-effector
+   */
+  Pose3 poe(const Angles &q, const Pose3 &fTe = Pose3(),
+            Axes *J = nullptr) const {
+    Pose3 T = fTe;
+    for (int j = N - 1; j >= 0; --j) {
+      const gtsam::Vector6 S = axes_.col(j);
+      if (J) J->col(j) = T.inverse().AdjointMap() * S;
+      T = Pose3::Expmap(S * q(j)) * T;
+    }
+    return sMb_ * T;
+  }
+
+  /**
+   * Batch forward kinematics, one pose (and Jacobian) per vector of angles.
+   * @param qs .......... Input angles, one vector per configuration
+   * @param(out) poses .. End-effector poses
+   * @param(out) Js ..... Jacobians (Optional)
+   * @param fTe ......... The end-effector pose with respect to final link
+   * @param pool ........ Thread pool to spread configurations over (Optional)
+   */
+  void poe(const std::vector<Angles, Eigen::aligned_allocator<Angles>> &qs,
+           std::vector<Pose3> *poses, Jacobians *Js = nullptr,
+           const Pose3 &fTe = Pose3(), ThreadPool *pool = nullptr) const {
+    poses->resize(qs.size());
+    if (Js) Js->resize(qs.size());
+    const auto job = [&](size_t k, size_t) {
+      (*poses)[k] = poe(qs[k], fTe, Js ? &(*Js)[k] : nullptr);
+    };
+    if (pool) {
+      pool->parallelFor(qs.size(), job);
+    } else {
+      for (size_t k = 0; k < qs.size(); ++k) job(k, 0);
+    }
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+ private:
+  Pose3 sMb_;
+  Axes axes_;
 };
 
 }  // namespace gtdynamics
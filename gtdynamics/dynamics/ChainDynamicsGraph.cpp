@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainDynamicsGraph.cpp
+ * @brief Lean dynamics graphs of fixed-base manipulators, on joint-space
+ * variables only.
+ */
+
+#include "gtdynamics/dynamics/ChainDynamicsGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gtdynamics/factors/ChainPoseFactor.h"
+#include "gtdynamics/factors/JointSpaceDynamicsFactor.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ChainDynamicsGraph::ChainDynamicsGraph(
+    const Robot &robot, const std::string &end_effector_name,
+    const OptimizerSetting &opt,
+    const boost::optional<gtsam::Vector3> &gravity)
+    : robot_(robot), graph_builder_(opt, gravity), gravity_(gravity) {
+  const CompiledRobot compiled(robot);
+  if (compiled.hasFloatingRoot())
+    throw std::invalid_argument(
+        "ChainDynamicsGraph: the roots of the robot should be fixed links.");
+
+  // Walk up the tree from the end-effector, then compose the joint chains
+  // rest_n * Exp(S_n q_n) from the base down.
+  std::vector<int> nodes;
+  const int ee = robot.link(end_effector_name)->id();
+  for (int n = compiled.nodeOfLink()[ee]; n >= 0;
+       n = compiled.parentNodes()[n])
+    nodes.push_back(n);
+  std::reverse(nodes.begin(), nodes.end());
+
+  const int base = compiled.linkIds()[nodes.front()];
+  std::vector<Chain> chains{Chain(compiled.fixedPoses()[base])};
+  for (size_t k = 1; k < nodes.size(); ++k) {
+    const int n = nodes[k];
+    chains.emplace_back(compiled.restPoses()[n],
+                        gtsam::Matrix(compiled.screwAxes().col(n)));
+    chain_joint_ids_.push_back(compiled.jointIds()[n]);
+  }
+  chain_ = Chain::composeTree(chains);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ChainDynamicsGraph::dynamicsFactors(int t) const {
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<JointSpaceDynamicsFactor>(
+      robot_, t, graph_builder_.opt().t_cost_model, gravity_);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ChainDynamicsGraph::trajectoryFG(
+    int num_steps, double dt, const CollocationScheme collocation) const {
+  NonlinearFactorGraph graph;
+  for (int t = 0; t <= num_steps; ++t) {
+    graph.add(dynamicsFactors(t));
+    if (t < num_steps)
+      graph.add(
+          graph_builder_.collocationFactors(robot_, t, dt, collocation));
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph ChainDynamicsGraph::targetPoseFactors(
+    int t, const gtsam::Pose3 &target,
+    const gtsam::SharedNoiseModel &cost_model,
+    const gtsam::Pose3 &fTe) const {
+  std::vector<gtsam::Key> keys;
+  for (const int j : chain_joint_ids_)
+    keys.push_back(internal::JointAngleKey(j, t));
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<ChainPoseFactor>(keys, chain_, target, cost_model,
+                                        fTe);
+  return graph;
+}
+
+/* ************************************************************************* */
+Values ChainDynamicsGraph::initialValues(int num_steps,
+                                         const gtsam::Vector &q) const {
+  Values values;
+  for (int t = 0; t <= num_steps; ++t) {
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, t, q(j));
+      InsertJointVel(&values, j, t, 0.0);
+      InsertJointAccel(&values, j, t, 0.0);
+      InsertTorque(&values, j, t, 0.0);
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
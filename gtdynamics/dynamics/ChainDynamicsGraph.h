@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainDynamicsGraph.h
+ * @brief Lean dynamics graphs of fixed-base manipulators, on joint-space
+ * variables only.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/Chain.h"
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * ChainDynamicsGraph builds trajectory optimization graphs for fixed-base
+ * manipulators in which the only variables are the joint angles,
+ * velocities, accelerations and torques of each time step:
+ *  - the dynamics of a step are a single JointSpaceDynamicsFactor, instead
+ *    of the pose, twist, acceleration and wrench factors of
+ *    DynamicsGraph::dynamicsFactors;
+ *  - end-effector targets are ChainPoseFactors on the joint angles, through
+ *    the Chain from the fixed base to the end-effector link.
+ * For an n-joint arm a step has 4n scalar variables, where the full graph
+ * also has a pose, twist and twist acceleration per link and two wrenches
+ * per joint.
+ */
+class ChainDynamicsGraph {
+ public:
+  /**
+   * Constructor
+   * @param robot              the robot, a tree whose roots are fixed links
+   * @param end_effector_name  name of the end-effector link
+   * @param opt                cost models, t_cost_model for the dynamics and
+   *                           the collocation cost models
+   * @param gravity            gravity in world frame
+   */
+  ChainDynamicsGraph(const Robot &robot, const std::string &end_effector_name,
+                     const OptimizerSetting &opt = OptimizerSetting(),
+                     const boost::optional<gtsam::Vector3> &gravity =
+                         boost::none);
+
+  /// Chain from the world to the end-effector CoM, through the fixed base.
+  const Chain &chain() const { return chain_; }
+
+  /// Ids of the joints of the chain, from the base to the end-effector.
+  const std::vector<int> &chainJointIds() const { return chain_joint_ids_; }
+
+  /// Return the dynamics factor of all joints at time step t.
+  gtsam::NonlinearFactorGraph dynamicsFactors(int t) const;
+
+  /**
+   * Return the dynamics factors of time steps 0..num_steps and the joint
+   * collocation factors between them.
+   * @param num_steps    number of steps
+   * @param dt           duration of each step
+   * @param collocation  collocation scheme
+   */
+  gtsam::NonlinearFactorGraph trajectoryFG(
+      int num_steps, double dt,
+      const CollocationScheme collocation = Trapezoidal) const;
+
+  /**
+   * Return a factor on the end-effector pose at time step t.
+   * @param t           time step
+   * @param target      target pose of the end-effector in the world
+   * @param cost_model  6-dimensional cost model
+   * @param fTe         end-effector frame in the end-effector link CoM frame
+   */
+  gtsam::NonlinearFactorGraph targetPoseFactors(
+      int t, const gtsam::Pose3 &target,
+      const gtsam::SharedNoiseModel &cost_model,
+      const gtsam::Pose3 &fTe = gtsam::Pose3()) const;
+
+  /**
+   * Return Values with the given joint angles at time steps 0..num_steps,
+   * and zero velocities, accelerations and torques.
+   * @param num_steps  number of steps
+   * @param q          joint angles, indexed by joint id
+   */
+  gtsam::Values initialValues(int num_steps, const gtsam::Vector &q) const;
+
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  boost::optional<gtsam::Vector3> gravity_;
+  Chain chain_;
+  std::vector<int> chain_joint_ids_;
+};
+
+}  // namespace gtdynamics
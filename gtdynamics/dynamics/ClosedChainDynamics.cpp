@@ -0,0 +1,280 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ClosedChainDynamics.cpp
+ * @brief Kinematics and dynamics of closed chains, in reduced coordinates.
+ */
+
+#include "gtdynamics/dynamics/ClosedChainDynamics.h"
+
+#include <Eigen/Cholesky>
+#include <Eigen/QR>
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// Joints closing loops in the breadth-first traversal of CompiledRobot: from
+// the fixed links first, then from any other link not reached yet.
+std::vector<JointSharedPtr> LoopJoints(const Robot &robot) {
+  std::set<int> visited;
+  std::vector<LinkSharedPtr> roots;
+  for (auto &&link : robot.links()) {
+    if (!link->isFixed()) continue;
+    visited.insert(link->id());
+    roots.push_back(link);
+  }
+  for (auto &&link : robot.links())
+    if (!link->isFixed()) roots.push_back(link);
+
+  std::set<int> tree_joints;
+  std::vector<JointSharedPtr> loop_joints;
+  for (auto &&root : roots) {
+    if (!root->isFixed() && !visited.insert(root->id()).second) continue;
+    std::vector<LinkSharedPtr> queue{root};
+    for (size_t n = 0; n < queue.size(); ++n) {
+      const LinkSharedPtr link = queue[n];
+      for (auto &&joint : link->joints()) {
+        if (tree_joints.count(joint->id())) continue;
+        if (std::find(loop_joints.begin(), loop_joints.end(), joint) !=
+            loop_joints.end())
+          continue;
+        const LinkSharedPtr other = joint->otherLink(link);
+        if (!visited.insert(other->id()).second) {
+          loop_joints.push_back(joint);
+        } else {
+          tree_joints.insert(joint->id());
+          queue.push_back(other);
+        }
+      }
+    }
+  }
+  return loop_joints;
+}
+
+// The robot without the given joints.
+Robot WithoutJoints(Robot robot, const std::vector<JointSharedPtr> &joints) {
+  for (auto &&joint : joints) robot = robot.withoutJoint(joint->name());
+  return robot;
+}
+}  // namespace
+
+/* ************************************************************************* */
+ClosedChainDynamics::ClosedChainDynamics(
+    const Robot &robot, const std::vector<std::string> &independent_joints,
+    const boost::optional<gtsam::Vector3> &gravity)
+    : loop_joint_ptrs_(LoopJoints(robot)),
+      tree_(WithoutJoints(robot, loop_joint_ptrs_)),
+      compiled_(tree_),
+      dynamics_(tree_, gravity),
+      num_joint_slots_(0) {
+  if (compiled_.hasFloatingRoot())
+    throw std::invalid_argument(
+        "ClosedChainDynamics: the roots of the robot should be fixed links.");
+
+  for (auto &&joint : robot.joints())
+    num_joint_slots_ = std::max<size_t>(num_joint_slots_, joint->id() + 1);
+  for (auto &&joint : loop_joint_ptrs_) loop_joints_.push_back(joint->id());
+
+  for (auto &&name : independent_joints)
+    independent_.push_back(robot.joint(name)->id());
+  for (auto &&joint : robot.joints()) {
+    if (std::find(independent_.begin(), independent_.end(), joint->id()) ==
+        independent_.end())
+      dependent_.push_back(joint->id());
+  }
+  std::sort(dependent_.begin(), dependent_.end());
+}
+
+/* ************************************************************************* */
+Vector ClosedChainDynamics::treeVector(const Vector &x) const {
+  if (size_t(x.size()) != num_joint_slots_)
+    throw std::invalid_argument(
+        "ClosedChainDynamics: joint arrays need one entry per joint slot.");
+  return x.head(compiled_.numJointSlots());
+}
+
+/* ************************************************************************* */
+Matrix ClosedChainDynamics::dependentColumns(const Matrix &K) const {
+  Matrix K_d(K.rows(), dependent_.size());
+  for (size_t k = 0; k < dependent_.size(); ++k)
+    K_d.col(k) = K.col(dependent_[k]);
+  return K_d;
+}
+
+/* ************************************************************************* */
+Vector ClosedChainDynamics::loopClosureError(const Vector &q,
+                                             Matrix *K) const {
+  std::vector<Pose3> poses;
+  compiled_.forwardKinematics(treeVector(q), &poses);
+
+  Vector error(numConstraints());
+  Matrix J_c, J_p;
+  if (K) K->setZero(numConstraints(), num_joint_slots_);
+  const size_t nt = compiled_.numJointSlots();
+  for (size_t l = 0; l < loop_joint_ptrs_.size(); ++l) {
+    const auto &joint = loop_joint_ptrs_[l];
+    const int p = joint->parent()->id(), c = joint->child()->id();
+    const Pose3 pTc = joint->parentTchild(q(joint->id()));
+    error.segment<6>(6 * l) =
+        Pose3::Logmap((poses[p] * pTc).between(poses[c]));
+    if (!K) continue;
+    // Twist of c along the tree minus the one through the cut joint, both in
+    // the frame of c.
+    compiled_.bodyJacobian(poses, c, &J_c);
+    compiled_.bodyJacobian(poses, p, &J_p);
+    K->block(6 * l, 0, 6, nt) = J_c - pTc.inverse().AdjointMap() * J_p;
+    K->block<6, 1>(6 * l, joint->id()) -= joint->cScrewAxis();
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+size_t ClosedChainDynamics::solvePositions(Vector *q, double tol,
+                                           size_t max_iterations) const {
+  Matrix K;
+  for (size_t iteration = 0; iteration <= max_iterations; ++iteration) {
+    const Vector error = loopClosureError(*q, &K);
+    if (error.norm() < tol) return iteration;
+    if (iteration == max_iterations) break;
+    // The error moves with the body twist of c, to first order.
+    const Vector dq = dependentColumns(K).colPivHouseholderQr().solve(error);
+    for (size_t k = 0; k < dependent_.size(); ++k)
+      (*q)(dependent_[k]) -= dq(k);
+  }
+  throw std::runtime_error(
+      "ClosedChainDynamics::solvePositions: the loops do not close.");
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::solveVelocities(const Vector &q, Vector *v) const {
+  Matrix G;
+  Vector g;
+  projection(q, *v, &G, &g);
+  Vector v_y(independent_.size());
+  for (size_t k = 0; k < independent_.size(); ++k)
+    v_y(k) = (*v)(independent_[k]);
+  *v = G * v_y;
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::forwardKinematics(const Vector &q,
+                                            std::vector<Pose3> *poses) const {
+  compiled_.forwardKinematics(treeVector(q), poses);
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::projection(const Vector &q, const Vector &v,
+                                     Matrix *G, Vector *g) const {
+  Matrix K;
+  loopClosureError(q, &K);
+  const Eigen::ColPivHouseholderQR<Matrix> qr(dependentColumns(K));
+  if (size_t(qr.rank()) < dependent_.size())
+    throw std::runtime_error(
+        "ClosedChainDynamics: the independent joints do not determine the "
+        "others, e.g. at a singular configuration.");
+
+  Matrix K_y(K.rows(), independent_.size());
+  for (size_t k = 0; k < independent_.size(); ++k)
+    K_y.col(k) = K.col(independent_[k]);
+
+  // Bias of the acceleration constraint K a + bias = 0: the tree acceleration
+  // of c at a = 0, minus that through the cut joint,
+  //   A_c = Ad(cTp) A_p + S a_j + ad(V_c) S v_j.
+  std::vector<Pose3> poses;
+  Matrix twists, accels;
+  compiled_.biasAccelerations(treeVector(q), treeVector(v), &poses, &twists,
+                              &accels);
+  Vector bias(numConstraints());
+  for (size_t l = 0; l < loop_joint_ptrs_.size(); ++l) {
+    const auto &joint = loop_joint_ptrs_[l];
+    const int p = joint->parent()->id(), c = joint->child()->id();
+    const gtsam::Matrix6 Ad_cTp =
+        joint->parentTchild(q(joint->id())).inverse().AdjointMap();
+    const Vector6 S = joint->cScrewAxis();
+    const Vector6 V = Ad_cTp * twists.col(p) + S * v(joint->id());
+    bias.segment<6>(6 * l) = accels.col(c) - Ad_cTp * accels.col(p) -
+                             Pose3::adjointMap(V) * S * v(joint->id());
+  }
+
+  const Matrix G_d = -qr.solve(K_y);
+  const Vector g_d = -qr.solve(bias);
+  G->setZero(num_joint_slots_, independent_.size());
+  g->setZero(num_joint_slots_);
+  for (size_t k = 0; k < independent_.size(); ++k)
+    (*G)(independent_[k], k) = 1;
+  for (size_t k = 0; k < dependent_.size(); ++k) {
+    G->row(dependent_[k]) = G_d.row(k);
+    (*g)(dependent_[k]) = g_d(k);
+  }
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::treeDynamics(const Vector &q, const Vector &v,
+                                       Matrix *M, Vector *C) const {
+  const size_t nt = compiled_.numJointSlots();
+  Matrix M_tree;
+  Vector C_tree;
+  dynamics_.massMatrix(treeVector(q), &M_tree);
+  dynamics_.nonlinearEffects(treeVector(q), treeVector(v), &C_tree);
+  M->setZero(num_joint_slots_, num_joint_slots_);
+  C->setZero(num_joint_slots_);
+  M->topLeftCorner(nt, nt) = M_tree;
+  C->head(nt) = C_tree;
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::forwardDynamics(const Vector &q, const Vector &v,
+                                          const Vector &tau, Vector *a) const {
+  if (size_t(tau.size()) != num_joint_slots_)
+    throw std::invalid_argument(
+        "ClosedChainDynamics: joint arrays need one entry per joint slot.");
+  Matrix M, G;
+  Vector C, g;
+  treeDynamics(q, v, &M, &C);
+  projection(q, v, &G, &g);
+
+  const Matrix MG = M * G;
+  const Vector a_y =
+      (G.transpose() * MG).ldlt().solve(G.transpose() * (tau - C - M * g));
+  *a = G * a_y + g;
+}
+
+/* ************************************************************************* */
+void ClosedChainDynamics::inverseDynamics(const Vector &q, const Vector &v,
+                                          Vector *a, Vector *tau) const {
+  if (size_t(a->size()) != num_joint_slots_)
+    throw std::invalid_argument(
+        "ClosedChainDynamics: joint arrays need one entry per joint slot.");
+  Matrix M, G;
+  Vector C, g;
+  treeDynamics(q, v, &M, &C);
+  projection(q, v, &G, &g);
+
+  Vector a_y(independent_.size());
+  for (size_t k = 0; k < independent_.size(); ++k)
+    a_y(k) = (*a)(independent_[k]);
+  *a = G * a_y + g;
+
+  // The rows of G of the independent joints are the identity, so these are
+  // the torques at those joints doing the same virtual work.
+  const Vector tau_y = G.transpose() * (M * *a + C);
+  tau->setZero(num_joint_slots_);
+  for (size_t k = 0; k < independent_.size(); ++k)
+    (*tau)(independent_[k]) = tau_y(k);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ClosedChainDynamics.h
+ * @brief Kinematics and dynamics of closed chains, in reduced coordinates.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * ClosedChainDynamics handles mechanisms with closed kinematic loops, e.g.
+ * four-bar linkages and parallel robots, without a factor graph. A spanning
+ * tree is picked by the breadth-first traversal of CompiledRobot, from the
+ * fixed links; every joint that would close a loop is cut, and its loop
+ * closure becomes the constraint that the poses of its two links, computed
+ * along the tree, agree with the joint angle of the cut joint:
+ *
+ *   e(q) = Log((wTp(q) pTc(q_c))^-1 wTc(q)) = 0,
+ *
+ * six rows per cut joint in the frame of its child link c. The velocity
+ * constraint is K(q) v = 0, with K the difference of the body Jacobians of
+ * the two links through the cut joint.
+ *
+ * Joints are split into independent ones, given at construction, and
+ * dependent ones, which include the cut joints. The independent velocities
+ * v_y parametrize all others: v = G v_y and a = G a_y + g, with G and g from
+ * K and the constraint bias. Dynamics are those of the tree, M(q) a + C(q, v)
+ * from RecursiveDynamics, projected on G:
+ *
+ *   G^T M G a_y = G^T (tau - C - M g),    tau_y = G^T (M a + C),
+ *
+ * for forward and inverse dynamics, with the cut joints contributing no
+ * inertia of their own. All arrays are joint-id indexed, as for
+ * RecursiveDynamics. Only robots whose roots are fixed links are supported,
+ * and the dependent joints need to be determined by the independent ones,
+ * i.e., the columns of K of the dependent joints have full rank.
+ */
+class ClosedChainDynamics {
+ public:
+  /**
+   * Constructor
+   * @param robot               the robot, whose roots are fixed links
+   * @param independent_joints  names of the joints that parametrize the
+   *                            mechanism, typically the actuated ones
+   * @param gravity             gravity, if any
+   */
+  ClosedChainDynamics(const Robot &robot,
+                      const std::vector<std::string> &independent_joints,
+                      const boost::optional<gtsam::Vector3> &gravity =
+                          boost::none);
+
+  /// The spanning tree, i.e., the robot without the cut joints.
+  const Robot &tree() const { return tree_; }
+
+  /// Ids of the joints cut to make the spanning tree.
+  const std::vector<int> &loopJointIds() const { return loop_joints_; }
+
+  /// Ids of the independent joints, in the order given at construction.
+  const std::vector<int> &independentJointIds() const { return independent_; }
+
+  /// Ids of all other joints, in increasing order.
+  const std::vector<int> &dependentJointIds() const { return dependent_; }
+
+  /// Number of joint id slots of the full robot.
+  size_t numJointSlots() const { return num_joint_slots_; }
+
+  /// Number of loop-closure constraint rows, 6 per cut joint.
+  size_t numConstraints() const { return 6 * loop_joints_.size(); }
+
+  /**
+   * Loop-closure errors e(q), with the velocity constraint Jacobian K if
+   * asked for, #constraints x #joint slots.
+   */
+  gtsam::Vector loopClosureError(const gtsam::Vector &q,
+                                 gtsam::Matrix *K = nullptr) const;
+
+  /**
+   * Solve the angles of the dependent joints in place by Gauss-Newton, so
+   * that all loops close, starting from the values in q.
+   * @return number of iterations
+   * @throws std::runtime_error if the loops do not close within
+   * max_iterations, e.g. for an assembly that does not exist.
+   */
+  size_t solvePositions(gtsam::Vector *q, double tol = 1e-10,
+                        size_t max_iterations = 50) const;
+
+  /// Overwrite the velocities of the dependent joints so that K v = 0.
+  void solveVelocities(const gtsam::Vector &q, gtsam::Vector *v) const;
+
+  /// CoM poses of all links, indexed by link id, for closed angles q.
+  void forwardKinematics(const gtsam::Vector &q,
+                         std::vector<gtsam::Pose3> *poses) const;
+
+  /**
+   * The projection on the independent joints at a consistent state.
+   * @param[out] G  #joint slots x #independent, v = G v_y
+   * @param[out] g  joint-id indexed, a = G a_y + g
+   */
+  void projection(const gtsam::Vector &q, const gtsam::Vector &v,
+                  gtsam::Matrix *G, gtsam::Vector *g) const;
+
+  /**
+   * Forward dynamics: accelerations of all joints under joint torques tau.
+   * Torques of cut joints act between the two links of the joint as usual.
+   */
+  void forwardDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &tau, gtsam::Vector *a) const;
+
+  /**
+   * Inverse dynamics: torques at the independent joints, zero elsewhere,
+   * that produce the accelerations of the independent joints in a. The
+   * other entries of a are overwritten with the consistent accelerations.
+   */
+  void inverseDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       gtsam::Vector *a, gtsam::Vector *tau) const;
+
+ private:
+  std::vector<JointSharedPtr> loop_joint_ptrs_;  // cut joints of the robot
+  Robot tree_;
+  CompiledRobot compiled_;      // of the tree
+  RecursiveDynamics dynamics_;  // of the tree
+  size_t num_joint_slots_;
+  std::vector<int> loop_joints_, independent_, dependent_;
+
+  // The columns of the dependent joints of K.
+  gtsam::Matrix dependentColumns(const gtsam::Matrix &K) const;
+
+  // Tree arrays from full joint-id indexed ones.
+  gtsam::Vector treeVector(const gtsam::Vector &x) const;
+
+  // Joint-space mass matrix and bias forces of the tree, full size.
+  void treeDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                    gtsam::Matrix *M, gtsam::Vector *C) const;
+};
+
+}  // namespace gtdynamics
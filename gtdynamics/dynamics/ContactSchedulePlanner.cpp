@@ -0,0 +1,346 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSchedulePlanner.cpp
+ * @brief Search over contact sequences and timing, emitting WalkCycles.
+ */
+
+#include "gtdynamics/dynamics/ContactSchedulePlanner.h"
+
+#include <gtsam/linear/NoiseModel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "gtdynamics/utils/FootContactConstraintSpec.h"
+
+using gtsam::Point3;
+using gtsam::Values;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+namespace {
+using Point2 = Eigen::Vector2d;
+
+// Whether c is to the left of the line from a to b, positive if so.
+double Cross(const Point2 &a, const Point2 &b, const Point2 &c) {
+  const Point2 ab = b - a, ac = c - a;
+  return ab.x() * ac.y() - ab.y() * ac.x();
+}
+
+// Distance of c to the segment from a to b.
+double SegmentDistance(const Point2 &a, const Point2 &b, const Point2 &c) {
+  const Point2 ab = b - a;
+  const double length2 = ab.squaredNorm();
+  const double t =
+      length2 > 0 ? std::min(1.0, std::max(0.0, ab.dot(c - a) / length2)) : 0;
+  return (a + t * ab - c).norm();
+}
+
+// Counter-clockwise convex hull, by the monotone chain algorithm.
+std::vector<Point2> ConvexHull(std::vector<Point2> points) {
+  std::sort(points.begin(), points.end(),
+            [](const Point2 &a, const Point2 &b) {
+              return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+            });
+  if (points.size() < 3) return points;
+  std::vector<Point2> hull(2 * points.size());
+  size_t k = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    while (k >= 2 && Cross(hull[k - 2], hull[k - 1], points[i]) <= 0) --k;
+    hull[k++] = points[i];
+  }
+  for (size_t i = points.size() - 1, t = k + 1; i > 0; --i) {
+    while (k >= t && Cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0) --k;
+    hull[k++] = points[i - 1];
+  }
+  hull.resize(k - 1);
+  return hull;
+}
+
+// Signed distance of c to a convex hull, positive inside.
+double SignedDistance(const std::vector<Point2> &hull, const Point2 &c) {
+  if (hull.size() == 1) return -(hull[0] - c).norm();
+  bool inside = hull.size() >= 3;
+  double distance = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < hull.size(); ++i) {
+    const Point2 &a = hull[i], &b = hull[(i + 1) % hull.size()];
+    if (Cross(a, b, c) < 0) inside = false;
+    distance = std::min(distance, SegmentDistance(a, b, c));
+  }
+  return inside ? distance : -distance;
+}
+}  // namespace
+
+/* ************************************************************************* */
+ContactSchedulePlanner::ContactSchedulePlanner(
+    const Robot &robot, const Values &nominal, const PointOnLinks &feet,
+    const Vector3 &gravity,
+    const ContactSchedulePlannerParameters &parameters)
+    : robot_(robot),
+      nominal_(nominal),
+      feet_(feet),
+      gravity_(gravity),
+      p_(parameters),
+      com_(ComputeCompositeInertia(robot, nominal).com) {
+  if (feet.empty())
+    throw std::invalid_argument("ContactSchedulePlanner: needs feet.");
+  for (const auto *steps : {&p_.stance_steps, &p_.swing_steps})
+    if (steps->empty() ||
+        std::find(steps->begin(), steps->end(), 0) != steps->end())
+      throw std::invalid_argument(
+          "ContactSchedulePlanner: needs positive phase lengths.");
+
+  for (auto &&foot : feet_) nominal_feet_.push_back(foot.predict(nominal, 0));
+
+  // Basis of the plane orthogonal to gravity.
+  const Vector3 normal = -gravity.normalized();
+  const Vector3 axis = std::abs(normal.x()) < 0.9 ? Vector3::UnitX()
+                                                  : Vector3::UnitY();
+  u_ = normal.cross(axis).normalized();
+  v_ = normal.cross(u_);
+}
+
+/* ************************************************************************* */
+std::vector<ContactSequence> ContactSchedulePlanner::SwingSequences(
+    size_t num_feet, bool stance_phases) {
+  std::vector<ContactSequence> sequences;
+  if (num_feet < 2) return sequences;
+
+  // Every labeling of the feet with swing groups 0..m-1, m > 1, all used.
+  std::vector<size_t> labels(num_feet, 0);
+  while (true) {
+    const size_t m = *std::max_element(labels.begin(), labels.end()) + 1;
+    std::vector<bool> used(m, false);
+    for (const size_t l : labels) used[l] = true;
+    bool keep = m > 1 && std::find(used.begin(), used.end(), false) ==
+                             used.end();
+
+    // Cycles starting at another group are the same gait: keep the smallest.
+    for (size_t r = 1; keep && r < m; ++r) {
+      std::vector<size_t> rotated(labels);
+      for (size_t &l : rotated) l = (l + m - r) % m;
+      if (rotated < labels) keep = false;
+    }
+
+    if (keep) {
+      ContactSequence sequence;
+      for (size_t g = 0; g < m; ++g) {
+        std::vector<size_t> stance, all;
+        for (size_t f = 0; f < num_feet; ++f) {
+          if (labels[f] != g) stance.push_back(f);
+          all.push_back(f);
+        }
+        sequence.push_back(stance);
+        if (stance_phases) sequence.push_back(all);
+      }
+      sequences.push_back(sequence);
+    }
+
+    // Next labeling, the last foot fastest.
+    size_t f = num_feet;
+    while (f > 0 && labels[f - 1] == num_feet - 1) labels[--f] = 0;
+    if (f == 0) break;
+    ++labels[f - 1];
+  }
+  return sequences;
+}
+
+/* ************************************************************************* */
+void ContactSchedulePlanner::footholds(const ContactSequence &sequence,
+                                       const Point3 &step,
+                                       ContactSchedule *schedule,
+                                       Vector3 *displacement) const {
+  if (sequence.empty())
+    throw std::invalid_argument("ContactSchedulePlanner: needs phases.");
+  std::vector<Point3> positions(nominal_feet_);
+  schedule->footholds.clear();
+  for (auto &&stance : sequence) {
+    std::vector<bool> in_stance(feet_.size(), false);
+    std::vector<Point3> footholds;
+    for (const size_t f : stance) {
+      if (f >= feet_.size())
+        throw std::invalid_argument(
+            "ContactSchedulePlanner: unknown foot in sequence.");
+      in_stance[f] = true;
+      footholds.push_back(positions[f]);
+    }
+    schedule->footholds.push_back(footholds);
+    for (size_t f = 0; f < feet_.size(); ++f)
+      if (!in_stance[f]) positions[f] += step;
+  }
+
+  *displacement = Vector3::Zero();
+  for (size_t f = 0; f < feet_.size(); ++f)
+    *displacement += positions[f] - nominal_feet_[f];
+  *displacement /= double(feet_.size());
+}
+
+/* ************************************************************************* */
+double ContactSchedulePlanner::margin(const ContactSchedule &schedule,
+                                      const Vector3 &displacement) const {
+  int num_steps = 0;
+  for (const int steps : schedule.phase_steps) num_steps += steps;
+  auto project = [this](const Point3 &point) {
+    return Point2(u_.dot(point), v_.dot(point));
+  };
+
+  double margin = std::numeric_limits<double>::infinity();
+  int k = 0;
+  for (size_t p = 0; p < schedule.footholds.size(); ++p) {
+    std::vector<Point2> points;
+    for (auto &&foothold : schedule.footholds[p])
+      points.push_back(project(foothold));
+    const std::vector<Point2> hull = ConvexHull(points);
+
+    // The CoM moves along a line, so the ends of the phase bound its margin
+    // to each edge.
+    for (const int k_com : {k, k + schedule.phase_steps[p]}) {
+      const Point3 com = com_ + displacement * (double(k_com) / num_steps);
+      margin = std::min(margin, SignedDistance(hull, project(com)));
+    }
+    k += schedule.phase_steps[p];
+  }
+  return margin;
+}
+
+/* ************************************************************************* */
+void ContactSchedulePlanner::refine(const Vector3 &displacement,
+                                    ContactSchedule *schedule) const {
+  const CentroidalPlanner planner = centroidalPlanner(*schedule);
+  const int T = planner.numSteps();
+  const Vector3 velocity = displacement / (T * p_.centroidal.dt);
+
+  // Move at constant velocity between the ends of the cycle.
+  gtsam::NonlinearFactorGraph objectives;
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(3, p_.boundary_sigma);
+  for (const int k : {0, T}) {
+    objectives.addPrior<Vector3>(CentroidalPlanner::ComKey(k),
+                                 com_ + displacement * (double(k) / T),
+                                 model);
+    objectives.addPrior<Vector3>(CentroidalPlanner::ComVelKey(k), velocity,
+                                 model);
+    objectives.addPrior<Vector3>(CentroidalPlanner::MomentumKey(k),
+                                 Vector3::Zero(), model);
+  }
+  Values initial = planner.initialValues();
+  for (int k = 0; k <= T; ++k) {
+    initial.update(CentroidalPlanner::ComKey(k),
+                   Vector3(com_ + displacement * (double(k) / T)));
+    initial.update(CentroidalPlanner::ComVelKey(k), velocity);
+  }
+  schedule->centroidal_plan = planner.solve(objectives, initial);
+
+  gtsam::NonlinearFactorGraph graph = planner.graph();
+  graph.push_back(objectives);
+  schedule->cost = graph.error(schedule->centroidal_plan);
+
+  FootContactVector states;
+  std::vector<size_t> phase_lengths;
+  for (size_t p = 0; p < schedule->sequence.size(); ++p) {
+    PointOnLinks stance;
+    for (const size_t f : schedule->sequence[p]) stance.push_back(feet_[f]);
+    states.push_back(boost::make_shared<FootContactConstraintSpec>(stance));
+    phase_lengths.push_back(schedule->phase_steps[p]);
+  }
+  schedule->walk_cycle = WalkCycle(states, phase_lengths);
+}
+
+/* ************************************************************************* */
+std::vector<ContactSchedule> ContactSchedulePlanner::plan(
+    const std::vector<ContactSequence> &candidates, const Point3 &step) const {
+  // Screen every sequence with every timing.
+  std::vector<std::pair<ContactSchedule, Vector3>> screened;
+  for (auto &&sequence : candidates) {
+    ContactSchedule schedule;
+    schedule.sequence = sequence;
+    Vector3 displacement;
+    footholds(sequence, step, &schedule, &displacement);
+
+    // Only vary the lengths of the kinds of phases the sequence has, and
+    // drop flight phases, which the centroidal model cannot carry.
+    bool has_stance = false, has_swing = false, has_flight = false;
+    for (auto &&stance : sequence) {
+      if (stance.empty())
+        has_flight = true;
+      else if (stance.size() == feet_.size())
+        has_stance = true;
+      else
+        has_swing = true;
+    }
+    if (has_flight) continue;
+    const std::vector<size_t> &stance_steps =
+        has_stance ? p_.stance_steps
+                   : std::vector<size_t>{p_.stance_steps.front()};
+    const std::vector<size_t> &swing_steps =
+        has_swing ? p_.swing_steps
+                  : std::vector<size_t>{p_.swing_steps.front()};
+
+    for (const size_t stance_length : stance_steps)
+      for (const size_t swing_length : swing_steps) {
+        schedule.phase_steps.clear();
+        for (auto &&stance : sequence)
+          schedule.phase_steps.push_back(stance.size() == feet_.size()
+                                             ? stance_length
+                                             : swing_length);
+        schedule.margin = margin(schedule, displacement);
+        if (schedule.margin >= p_.min_margin)
+          screened.emplace_back(schedule, displacement);
+      }
+  }
+
+  // Refine the best screened candidates with the centroidal model.
+  std::stable_sort(screened.begin(), screened.end(),
+                   [](const std::pair<ContactSchedule, Vector3> &a,
+                      const std::pair<ContactSchedule, Vector3> &b) {
+                     return a.first.margin > b.first.margin;
+                   });
+  if (screened.size() > p_.num_refined) screened.resize(p_.num_refined);
+  std::vector<ContactSchedule> schedules;
+  for (auto &&candidate : screened) {
+    refine(candidate.second, &candidate.first);
+    schedules.push_back(candidate.first);
+  }
+  std::stable_sort(schedules.begin(), schedules.end(),
+                   [](const ContactSchedule &a, const ContactSchedule &b) {
+                     return a.cost < b.cost;
+                   });
+  return schedules;
+}
+
+/* ************************************************************************* */
+std::vector<ContactSchedule> ContactSchedulePlanner::plan(
+    const Point3 &step) const {
+  std::vector<ContactSequence> candidates =
+      SwingSequences(feet_.size(), false);
+  const std::vector<ContactSequence> with_stance =
+      SwingSequences(feet_.size(), true);
+  candidates.insert(candidates.end(), with_stance.begin(), with_stance.end());
+  return plan(candidates, step);
+}
+
+/* ************************************************************************* */
+CentroidalPlanner ContactSchedulePlanner::centroidalPlanner(
+    const ContactSchedule &schedule) const {
+  std::vector<PointOnLinks> phase_contact_points;
+  for (auto &&stance : schedule.sequence) {
+    PointOnLinks points;
+    for (const size_t f : stance) points.push_back(feet_.at(f));
+    phase_contact_points.push_back(points);
+  }
+  CentroidalPlanner planner(robot_, nominal_, schedule.phase_steps,
+                            phase_contact_points, gravity_, p_.centroidal);
+  for (size_t p = 0; p < schedule.footholds.size(); ++p)
+    planner.setFootholds(p, schedule.footholds[p]);
+  return planner;
+}
+
+}  // namespace gtdynamics
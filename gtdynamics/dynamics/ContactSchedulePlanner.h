@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactSchedulePlanner.h
+ * @brief Search over contact sequences and timing, emitting WalkCycles.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+#include "gtdynamics/dynamics/CentroidalPlanner.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/PointOnLink.h"
+#include "gtdynamics/utils/Trajectory.h"
+#include "gtdynamics/utils/WalkCycle.h"
+
+namespace gtdynamics {
+
+/// A gait cycle: for every phase, the indices of the feet in stance.
+using ContactSequence = std::vector<std::vector<size_t>>;
+
+/// Parameters of ContactSchedulePlanner.
+struct ContactSchedulePlannerParameters {
+  std::vector<size_t> stance_steps = {5, 10};  ///< of phases without swing
+  std::vector<size_t> swing_steps = {5, 10};   ///< of phases with swing feet
+  double min_margin = -0.05;  ///< of the support screen, in meters
+  size_t num_refined = 4;     ///< best screened candidates solved
+  double boundary_sigma = 1e-3;  ///< of the CoM state at the cycle ends
+  CentroidalPlannerParameters centroidal;  ///< of the refining solves
+};
+
+/// A candidate contact schedule, with its screen and centroidal results.
+struct ContactSchedule {
+  ContactSequence sequence;       ///< stance feet of every phase
+  std::vector<int> phase_steps;   ///< number of time steps of every phase
+  std::vector<std::vector<gtsam::Point3>> footholds;  ///< of stance feet
+  double margin = 0;  ///< smallest support margin over the phases
+  double cost = 0;    ///< error of the centroidal solve
+  gtsam::Values centroidal_plan;  ///< result of the centroidal solve
+  WalkCycle walk_cycle;           ///< the phases, ready for the full solve
+
+  /// The walk cycle repeated, as Trajectory(walk_cycle, repeat).
+  Trajectory trajectory(size_t repeat) const {
+    return Trajectory(walk_cycle, repeat);
+  }
+};
+
+/**
+ * ContactSchedulePlanner chooses the contact sequence and phase timing of a
+ * gait cycle before any full kinodynamic solve. A cycle is a sequence of
+ * phases, each with its stance feet and a number of time steps; feet
+ * advance by `step` at the end of every phase they swing in, as in
+ * WalkCycle::contactPointObjectives, and the CoM moves at constant velocity
+ * by the mean displacement of the feet over the cycle.
+ *
+ * Candidates, the given sequences with every combination of the stance and
+ * swing phase lengths, are first screened in closed form: the margin of a
+ * phase is the signed horizontal distance of the CoM, at the start and end
+ * of the phase, to the convex hull of its stance footholds, negative
+ * outside, and candidates whose smallest margin is below min_margin, or
+ * with a phase without stance feet, are dropped. Only the num_refined best
+ * by margin are then solved with the CentroidalPlanner, between boundary
+ * priors at the constant CoM velocity, and ranked by the error of the
+ * solve. The best schedule is a ready
+ * WalkCycle, and centroidalPlanner() rebuilds its planner to seed and guide
+ * the full solve with fullInitialValues and comFactors.
+ *
+ * The ground is the plane orthogonal to gravity, through the footholds.
+ */
+class ContactSchedulePlanner {
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot
+   * @param nominal     link poses at time step 0 of a nominal stance
+   * @param feet        all contact points, which sequences index
+   * @param gravity     gravity vector in the world frame
+   * @param parameters  timing, screen threshold and centroidal solves
+   */
+  ContactSchedulePlanner(
+      const Robot &robot, const gtsam::Values &nominal,
+      const PointOnLinks &feet,
+      const gtsam::Vector3 &gravity = gtsam::Vector3(0, 0, -9.8),
+      const ContactSchedulePlannerParameters &parameters =
+          ContactSchedulePlannerParameters());
+
+  /**
+   * All gait cycles in which every foot swings once and some foot is always
+   * in stance, one per ordering of swing groups up to where the cycle
+   * starts: 25 for four feet, and growing as the ordered Bell numbers.
+   * @param num_feet       number of feet
+   * @param stance_phases  whether every swing phase is followed by a phase
+   *                       with all feet in stance
+   */
+  static std::vector<ContactSequence> SwingSequences(size_t num_feet,
+                                                     bool stance_phases);
+
+  /// The feet, indexed by sequences.
+  const PointOnLinks &feet() const { return feet_; }
+
+  /**
+   * Screen and refine candidate sequences.
+   * @param candidates  gait cycles to choose from
+   * @param step        displacement of a foot in one swing phase
+   * @return the refined schedules, best first, empty if none passes
+   * @throws std::invalid_argument for sequences with unknown feet
+   */
+  std::vector<ContactSchedule> plan(
+      const std::vector<ContactSequence> &candidates,
+      const gtsam::Point3 &step) const;
+
+  /// Same as plan, over all SwingSequences with and without stance phases.
+  std::vector<ContactSchedule> plan(const gtsam::Point3 &step) const;
+
+  /// The CentroidalPlanner of a schedule, with its footholds.
+  CentroidalPlanner centroidalPlanner(const ContactSchedule &schedule) const;
+
+ private:
+  // Footholds of a sequence, and the CoM displacement over the cycle.
+  void footholds(const ContactSequence &sequence, const gtsam::Point3 &step,
+                 ContactSchedule *schedule,
+                 gtsam::Vector3 *displacement) const;
+
+  // Screen margin of a schedule with footholds and phase steps.
+  double margin(const ContactSchedule &schedule,
+                const gtsam::Vector3 &displacement) const;
+
+  // Centroidal solve, WalkCycle and cost of a screened schedule.
+  void refine(const gtsam::Vector3 &displacement,
+              ContactSchedule *schedule) const;
+
+  Robot robot_;
+  gtsam::Values nominal_;
+  PointOnLinks feet_;
+  gtsam::Vector3 gravity_;
+  ContactSchedulePlannerParameters p_;
+  gtsam::Point3 com_;                        // nominal center of mass
+  std::vector<gtsam::Point3> nominal_feet_;  // world positions of the feet
+  gtsam::Vector3 u_, v_;                     // basis of the ground plane
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,207 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactWrenchEstimator.cpp
+ * @brief Contact forces from joint torques and the base IMU, at control rate.
+ */
+
+#include "gtdynamics/dynamics/ContactWrenchEstimator.h"
+
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ContactWrenchEstimator::ContactWrenchEstimator(
+    const Robot &robot, const FootContactConstraintSpec &contacts,
+    const ContactWrenchEstimatorParameters &parameters)
+    : robot_(robot), p_(parameters) {
+  if (p_.torque_sigma <= 0 || p_.base_wrench_sigma <= 0 ||
+      p_.regularization <= 0)
+    throw std::invalid_argument(
+        "ContactWrenchEstimator: sigmas and regularization should be "
+        "positive.");
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  for (size_t n = 0; n < robot_.numNodes(); ++n) {
+    if (parents[n] >= 0 || robot_.isFixed()[link_ids[n]]) continue;
+    if (base_ >= 0)
+      throw std::invalid_argument(
+          "ContactWrenchEstimator: at most one floating base is supported.");
+    base_ = link_ids[n];
+  }
+  num_base_rows_ = base_ >= 0 ? 6 : 0;
+
+  const size_t L = robot_.numLinkSlots(), J = robot_.numJointSlots();
+  poses_.resize(L);
+  twists_.setZero(6, L);
+  accels_.setZero(6, L);
+  wrenches_.setZero(6, L);
+  torques_.setZero(J);
+  b_.setZero(num_base_rows_ + J);
+  X_.resize(robot_.numNodes());
+  setContacts(contacts);
+}
+
+/* ************************************************************************* */
+void ContactWrenchEstimator::setContacts(
+    const FootContactConstraintSpec &contacts) {
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  contact_links_.clear();
+  contact_points_.clear();
+  on_base_.clear();
+  for (auto &&contact : contacts.contactPoints()) {
+    const int i = contact.link->id();
+    if (i < 0 || size_t(i) >= robot_.numLinkSlots() ||
+        robot_.nodeOfLink()[i] < 0)
+      throw std::invalid_argument("ContactWrenchEstimator: contact link " +
+                                  contact.link->name() +
+                                  " is not in the robot.");
+    int n = robot_.nodeOfLink()[i];
+    while (parents[n] >= 0) n = parents[n];
+    contact_links_.push_back(i);
+    contact_points_.push_back(contact.point);
+    on_base_.push_back(link_ids[n] == base_);
+  }
+
+  const size_t C = numContacts();
+  A_.setZero(num_base_rows_ + robot_.numJointSlots(), 3 * C);
+  B_.setZero(6, 3 * C);
+  H_.setZero(3 * C, 3 * C);
+  g_.setZero(3 * C);
+  f_.setZero(3 * C);
+}
+
+/* ************************************************************************* */
+void ContactWrenchEstimator::linearize(const ContactWrenchMeasurement &m) {
+  const size_t N = robot_.numNodes(), J = robot_.numJointSlots();
+  if (size_t(m.q.size()) != J || size_t(m.v.size()) != J ||
+      size_t(m.tau.size()) != J || (m.a.size() && size_t(m.a.size()) != J))
+    throw std::invalid_argument(
+        "ContactWrenchEstimator: measurements need one entry per joint slot.");
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  const Matrix &screw_axes = robot_.screwAxes();
+
+  // Poses and twists, the base at the origin: its position does not matter.
+  if (base_ >= 0) {
+    poses_[base_] = Pose3(m.base_orientation, gtsam::Point3(0, 0, 0));
+    twists_.col(base_) << m.angular_velocity, m.base_velocity;
+  }
+  robot_.forwardKinematics(m.q, m.v, &poses_, &twists_);
+
+  // Twist accelerations minus gravity, which acts like an acceleration of
+  // the frame. The accelerometer measures the base one, up to omega x v.
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    if (parents[n] < 0) {
+      if (i == base_) {
+        accels_.col(i) << m.angular_acceleration,
+            m.specific_force - m.angular_velocity.cross(m.base_velocity);
+      } else {
+        accels_.col(i).setZero();
+        if (p_.gravity)
+          accels_.col(i).tail<3>() =
+              -poses_[i].rotation().unrotate(*p_.gravity);
+      }
+      continue;
+    }
+    const int p = link_ids[parents[n]];
+    const int j = joint_ids[n];
+    const Vector6 S = screw_axes.col(n);
+    const Vector6 V = twists_.col(i);
+    X_[n] = poses_[i].between(poses_[p]).AdjointMap();
+    accels_.col(i) = X_[n] * accels_.col(p) +
+                     Pose3::adjointMap(V) * S * m.v(j);
+    if (m.a.size()) accels_.col(i) += S * m.a(j);
+  }
+
+  // Newton-Euler wrenches, summed from the leaves to the roots.
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    const gtsam::Matrix6 &G = robot_.inertias()[i];
+    const Vector6 V = twists_.col(i);
+    wrenches_.col(i) =
+        G * accels_.col(i) - Pose3::adjointMap(V).transpose() * (G * V);
+  }
+  for (size_t n = N; n-- > 0;) {
+    if (parents[n] < 0) continue;
+    const int i = link_ids[n];
+    torques_(joint_ids[n]) = screw_axes.col(n).dot(wrenches_.col(i));
+    wrenches_.col(link_ids[parents[n]]) += X_[n].transpose() * wrenches_.col(i);
+  }
+  if (base_ >= 0) b_.head<6>() = wrenches_.col(base_);
+  b_.tail(J) = torques_ - m.tau;
+
+  // Base wrench and joint torques of unit world forces at the contacts.
+  for (size_t c = 0; c < numContacts(); ++c) {
+    const int i = contact_links_[c];
+    const gtsam::Matrix3 iRw = poses_[i].rotation().transpose();
+    auto B = B_.middleCols<3>(3 * c);
+    B.topRows<3>() = gtsam::skewSymmetric(contact_points_[c]) * iRw;
+    B.bottomRows<3>() = iRw;
+    robot_.bodyJacobian(poses_, i, &J_);
+    A_.block(num_base_rows_, 3 * c, J, 3).noalias() = J_.transpose() * B;
+    if (num_base_rows_) {
+      if (on_base_[c])
+        A_.block<6, 3>(0, 3 * c).noalias() =
+            poses_[i].between(poses_[base_]).AdjointMap().transpose() * B;
+      else
+        A_.block<6, 3>(0, 3 * c).setZero();
+    }
+  }
+}
+
+/* ************************************************************************* */
+void ContactWrenchEstimator::estimate(const ContactWrenchMeasurement &m,
+                                      ContactWrenchEstimate *estimate) {
+  linearize(m);
+  const size_t C = numContacts(), J = robot_.numJointSlots();
+  const size_t nb = num_base_rows_;
+
+  // Weighted, damped normal equations on the stacked forces.
+  const double wt = 1 / (p_.torque_sigma * p_.torque_sigma);
+  H_.noalias() = wt * A_.bottomRows(J).transpose() * A_.bottomRows(J);
+  g_.noalias() = wt * A_.bottomRows(J).transpose() * b_.tail(J);
+  if (nb) {
+    const double wb = 1 / (p_.base_wrench_sigma * p_.base_wrench_sigma);
+    H_.noalias() += wb * A_.topRows(nb).transpose() * A_.topRows(nb);
+    g_.noalias() += wb * A_.topRows(nb).transpose() * b_.head(nb);
+  }
+  H_.diagonal().array() += p_.regularization;
+  ldlt_.compute(H_);
+  f_ = ldlt_.solve(g_);
+
+  estimate->forces.resize(3, C);
+  estimate->wrenches.resize(6, C);
+  for (size_t c = 0; c < C; ++c) {
+    const Vector3 f = f_.segment<3>(3 * c);
+    estimate->forces.col(c) = f;
+    estimate->wrenches.col(c).noalias() = B_.middleCols<3>(3 * c) * f;
+  }
+  estimate->residual = b_;
+  estimate->residual.noalias() -= A_ * f_;
+}
+
+/* ************************************************************************* */
+ContactWrenchEstimate ContactWrenchEstimator::estimate(
+    const ContactWrenchMeasurement &measurement) {
+  ContactWrenchEstimate result;
+  estimate(measurement, &result);
+  return result;
+}
+
+}  // namespace gtdynamics
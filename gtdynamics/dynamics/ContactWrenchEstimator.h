@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactWrenchEstimator.h
+ * @brief Contact forces from joint torques and the base IMU, at control rate.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/FootContactConstraintSpec.h"
+
+namespace gtdynamics {
+
+/// Parameters of ContactWrenchEstimator.
+struct ContactWrenchEstimatorParameters {
+  /// Gravity, used for fixed roots only: the IMU measures it on the base.
+  boost::optional<gtsam::Vector3> gravity = gtsam::Vector3(0, 0, -9.8);
+
+  double torque_sigma = 0.1;       ///< noise of the joint torques
+  double base_wrench_sigma = 1.0;  ///< model error of the base wrench
+  double regularization = 1e-6;    ///< damping of the forces, > 0
+};
+
+/// Sensor readings of one control tick, arrays indexed by joint id.
+struct ContactWrenchMeasurement {
+  gtsam::Vector q, v;  ///< joint angles and velocities
+  gtsam::Vector a;     ///< joint accelerations, zero if empty
+  gtsam::Vector tau;   ///< measured joint torques
+
+  /// State of the floating base, in its CoM frame, where the IMU is.
+  gtsam::Rot3 base_orientation;  ///< wRb
+  gtsam::Vector3 angular_velocity = gtsam::Vector3::Zero();  ///< gyroscope
+  gtsam::Vector3 specific_force = gtsam::Vector3::Zero();  ///< accelerometer
+  gtsam::Vector3 angular_acceleration = gtsam::Vector3::Zero();
+  gtsam::Vector3 base_velocity = gtsam::Vector3::Zero();  ///< linear, body
+};
+
+/// Estimated contact forces, one column per contact point of the spec.
+struct ContactWrenchEstimate {
+  gtsam::Matrix forces;    ///< 3 x #contacts, in the world frame
+  gtsam::Matrix wrenches;  ///< 6 x #contacts, on the link, in its CoM frame
+  gtsam::Vector residual;  ///< unexplained base wrench and joint torques
+};
+
+/**
+ * ContactWrenchEstimator estimates the forces at the contact points of a
+ * FootContactConstraintSpec from the joint torques and the base IMU, in
+ * microseconds rather than by solving a dynamics factor graph per tick.
+ *
+ * One Newton-Euler pass on the CompiledRobot, starting from the base motion
+ * measured by the IMU, gives the base wrench and joint torques the motion
+ * needs without contacts. The contact forces f explain the difference,
+ *
+ *   sum_c Ad(bTc)' B_c f_c = W_base,  sum_c J_c' B_c f_c = tau_ID - tau,
+ *
+ * with J_c the body Jacobian of the contact link and B_c the wrench of a
+ * unit world force at the contact point. The forces are the weighted,
+ * damped least-squares solution, and only the matrices of a few contacts
+ * are factored. On fixed-base robots only the torque equations remain.
+ *
+ * The estimator reuses its buffers, so it is not thread-safe: use one per
+ * thread.
+ */
+class ContactWrenchEstimator {
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot       the robot, with at most one floating base
+   * @param contacts    contact points, e.g. of the current stance
+   * @param parameters  gravity, noise and damping
+   */
+  ContactWrenchEstimator(const Robot &robot,
+                         const FootContactConstraintSpec &contacts,
+                         const ContactWrenchEstimatorParameters &parameters =
+                             ContactWrenchEstimatorParameters());
+
+  /// Switch to the contact points of another stance.
+  void setContacts(const FootContactConstraintSpec &contacts);
+
+  /// Number of contact points.
+  size_t numContacts() const { return contact_links_.size(); }
+
+  /// Id of the floating base link, -1 for fixed-base robots.
+  int baseLink() const { return base_; }
+
+  /// Estimate the contact forces of one tick into `estimate`, reusing it.
+  void estimate(const ContactWrenchMeasurement &measurement,
+                ContactWrenchEstimate *estimate);
+
+  /// Estimate the contact forces of one tick.
+  ContactWrenchEstimate estimate(const ContactWrenchMeasurement &measurement);
+
+  /// Joint torques of the last estimate's motion without contacts.
+  const gtsam::Vector &inverseDynamicsTorques() const { return torques_; }
+
+ private:
+  // Base wrench and torques without contacts into b_, contact map into A_.
+  void linearize(const ContactWrenchMeasurement &measurement);
+
+  CompiledRobot robot_;
+  ContactWrenchEstimatorParameters p_;
+  int base_ = -1;
+  size_t num_base_rows_ = 0;
+
+  std::vector<int> contact_links_;
+  std::vector<gtsam::Point3> contact_points_;
+  std::vector<bool> on_base_;  // contact link is in the floating base tree
+
+  std::vector<gtsam::Pose3> poses_;
+  gtsam::Matrix twists_, accels_, wrenches_, J_, A_, B_, H_;
+  gtsam::Vector torques_, b_, g_, f_;
+  CompiledRobot::Matrix6s X_;  // Ad(T_cp) of each node
+  Eigen::LDLT<gtsam::Matrix> ldlt_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,188 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DifferentiableRollout.cpp
+ * @brief Reverse-mode gradients of rollouts, with checkpointing.
+ */
+
+#include "gtdynamics/dynamics/DifferentiableRollout.h"
+
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+DifferentiableRollout::DifferentiableRollout(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const DifferentiableRolloutParameters &parameters)
+    : robot_(robot), p_(parameters), pool_(parameters.num_threads) {
+  workspaces_.resize(pool_.numThreads());
+  for (auto &&ws : workspaces_) {
+    ws.dynamics = boost::make_shared<RecursiveDynamics>(robot, gravity);
+    ws.dynamics->allocate(&ws.result);
+  }
+  const CompiledRobot &compiled = workspaces_.front().dynamics->compiledRobot();
+  if (compiled.hasFloatingRoot())
+    throw std::invalid_argument(
+        "DifferentiableRollout: only robots without floating roots are "
+        "supported.");
+  n_ = compiled.numJointSlots();
+}
+
+/* ************************************************************************* */
+size_t DifferentiableRollout::checkBatch(
+    const Matrix &q0, const Matrix &v0,
+    const std::vector<Matrix> &torque_seqs) const {
+  const size_t B = torque_seqs.size();
+  if (size_t(q0.rows()) != B || size_t(v0.rows()) != B ||
+      size_t(q0.cols()) != n_ || size_t(v0.cols()) != n_)
+    throw std::invalid_argument(
+        "DifferentiableRollout: initial states should be " +
+        std::to_string(B) + " x " + std::to_string(n_) + ".");
+  const size_t K = B ? torque_seqs.front().rows() : 0;
+  for (auto &&torques : torque_seqs)
+    if (size_t(torques.rows()) != K || size_t(torques.cols()) != n_)
+      throw std::invalid_argument(
+          "DifferentiableRollout: all torque sequences should be " +
+          std::to_string(K) + " x " + std::to_string(n_) + ".");
+  return K;
+}
+
+/* ************************************************************************* */
+void DifferentiableRollout::step(const Vector &tau, Workspace *ws, Matrix *fx,
+                                 Matrix *fu) const {
+  const double dt = p_.dt, dt2 = dt * dt;
+  if (fx) {
+    ws->dynamics->forwardDynamicsDerivatives(ws->q, ws->v, tau, &ws->result,
+                                             &ws->a_q, &ws->a_v, &ws->a_u);
+    const auto I = Matrix::Identity(n_, n_);
+    fx->resize(2 * n_, 2 * n_);
+    fx->topLeftCorner(n_, n_) = I + 0.5 * dt2 * ws->a_q;
+    fx->topRightCorner(n_, n_) = dt * I + 0.5 * dt2 * ws->a_v;
+    fx->bottomLeftCorner(n_, n_) = dt * ws->a_q;
+    fx->bottomRightCorner(n_, n_) = I + dt * ws->a_v;
+    fu->resize(2 * n_, n_);
+    fu->topRows(n_) = 0.5 * dt2 * ws->a_u;
+    fu->bottomRows(n_) = dt * ws->a_u;
+  } else {
+    ws->dynamics->forwardDynamics(ws->q, ws->v, tau, &ws->result);
+  }
+  const auto a = ws->result.joint_accels.head(n_);
+  ws->q += dt * ws->v + 0.5 * dt2 * a;
+  ws->v += dt * a;
+}
+
+/* ************************************************************************* */
+RolloutStates DifferentiableRollout::simulate(
+    const Matrix &q0, const Matrix &v0,
+    const std::vector<Matrix> &torque_seqs) {
+  const size_t K = checkBatch(q0, v0, torque_seqs);
+  const size_t B = torque_seqs.size();
+  RolloutStates states;
+  states.num_steps = K;
+  states.num_joints = n_;
+  states.q.resize(B, (K + 1) * n_);
+  states.v.resize(B, (K + 1) * n_);
+  states.a.resize(B, K * n_);
+  pool_.parallelFor(B, [&](size_t r, size_t worker) {
+    Workspace &ws = workspaces_[worker];
+    ws.q = q0.row(r).transpose();
+    ws.v = v0.row(r).transpose();
+    states.q.row(r).head(n_) = ws.q.transpose();
+    states.v.row(r).head(n_) = ws.v.transpose();
+    for (size_t k = 0; k < K; ++k) {
+      step(torque_seqs[r].row(k).transpose(), &ws, nullptr, nullptr);
+      states.a.row(r).segment(k * n_, n_) =
+          ws.result.joint_accels.head(n_).transpose();
+      states.q.row(r).segment((k + 1) * n_, n_) = ws.q.transpose();
+      states.v.row(r).segment((k + 1) * n_, n_) = ws.v.transpose();
+    }
+  });
+  return states;
+}
+
+/* ************************************************************************* */
+RolloutGradients DifferentiableRollout::gradients(
+    const Matrix &q0, const Matrix &v0, const std::vector<Matrix> &torque_seqs,
+    const Matrix &dL_dq, const Matrix &dL_dv,
+    const std::vector<Matrix> &dL_dtau) {
+  const size_t K = checkBatch(q0, v0, torque_seqs);
+  const size_t B = torque_seqs.size();
+  if (size_t(dL_dq.rows()) != B || size_t(dL_dv.rows()) != B ||
+      size_t(dL_dq.cols()) != (K + 1) * n_ ||
+      size_t(dL_dv.cols()) != (K + 1) * n_)
+    throw std::invalid_argument(
+        "DifferentiableRollout::gradients: state gradients should be laid "
+        "out as RolloutStates.");
+  if (!dL_dtau.empty()) checkBatch(q0, v0, dL_dtau);
+
+  // Segments of c steps, the last one possibly shorter.
+  const size_t c = (p_.checkpoint_interval == 0 || p_.checkpoint_interval > K)
+                       ? std::max<size_t>(K, 1)
+                       : p_.checkpoint_interval;
+  const size_t num_segments = (K + c - 1) / c;
+
+  RolloutGradients result;
+  result.torques.resize(B);
+  result.q0.resize(B, n_);
+  result.v0.resize(B, n_);
+  pool_.parallelFor(B, [&](size_t r, size_t worker) {
+    Workspace &ws = workspaces_[worker];
+    const Matrix &torques = torque_seqs[r];
+
+    // Forward: keep the state at the start of every segment.
+    ws.checkpoints.resize(std::max<size_t>(num_segments, 1));
+    ws.q = q0.row(r).transpose();
+    ws.v = v0.row(r).transpose();
+    for (size_t s = 0;; ++s) {
+      ws.checkpoints[s].resize(2 * n_);
+      ws.checkpoints[s] << ws.q, ws.v;
+      if (s + 1 >= num_segments) break;
+      for (size_t k = s * c; k < (s + 1) * c; ++k)
+        step(torques.row(k).transpose(), &ws, nullptr, nullptr);
+    }
+
+    // Backward, segment by segment from the last.
+    const auto dq = dL_dq.row(r), dv = dL_dv.row(r);
+    ws.lambda.resize(2 * n_);
+    ws.lambda << dq.segment(K * n_, n_).transpose(),
+        dv.segment(K * n_, n_).transpose();
+    Matrix &g_tau = result.torques[r];
+    if (dL_dtau.empty())
+      g_tau.setZero(K, n_);
+    else
+      g_tau = dL_dtau[r];
+    ws.fx.resize(c);
+    ws.fu.resize(c);
+    for (size_t s = num_segments; s-- > 0;) {
+      const size_t begin = s * c, end = std::min(K, begin + c);
+      ws.q = ws.checkpoints[s].head(n_);
+      ws.v = ws.checkpoints[s].tail(n_);
+      for (size_t k = begin; k < end; ++k)
+        step(torques.row(k).transpose(), &ws, &ws.fx[k - begin],
+             &ws.fu[k - begin]);
+      for (size_t k = end; k-- > begin;) {
+        g_tau.row(k) += (ws.fu[k - begin].transpose() * ws.lambda).transpose();
+        ws.lambda = ws.fx[k - begin].transpose() * ws.lambda;
+        ws.lambda.head(n_) += dq.segment(k * n_, n_).transpose();
+        ws.lambda.tail(n_) += dv.segment(k * n_, n_).transpose();
+      }
+    }
+    result.q0.row(r) = ws.lambda.head(n_).transpose();
+    result.v0.row(r) = ws.lambda.tail(n_).transpose();
+  });
+  return result;
+}
+
+}  // namespace gtdynamics
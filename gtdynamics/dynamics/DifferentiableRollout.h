@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DifferentiableRollout.h
+ * @brief Reverse-mode gradients of rollouts, with checkpointing.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "gtdynamics/dynamics/BatchSimulator.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/// Parameters of DifferentiableRollout.
+struct DifferentiableRolloutParameters {
+  double dt = 0.01;  ///< duration of each time step
+
+  /// Steps between checkpointed states, 0 to keep the step Jacobians of the
+  /// whole rollout. With c steps, a rollout of K steps keeps K / c states
+  /// and c step Jacobians per thread, and its forward dynamics are solved
+  /// twice instead of once.
+  size_t checkpoint_interval = 0;
+
+  size_t num_threads = 0;  ///< 0 for hardware concurrency
+};
+
+/// Gradients of a rollout cost, see DifferentiableRollout::gradients.
+struct RolloutGradients {
+  std::vector<gtsam::Matrix> torques;  ///< dL/dtau, like the torques
+  gtsam::Matrix q0, v0;  ///< dL/dq0 and dL/dv0, one row per rollout
+};
+
+/**
+ * DifferentiableRollout integrates torque sequences of a fixed-base robot
+ * with the scheme of Simulator and BatchSimulator, v' = v + a dt,
+ * q' = q + v dt + a dt^2 / 2, and back-propagates the gradient of a cost L
+ * of the states and torques to the torques and the initial state.
+ *
+ * The backward pass is the adjoint recursion
+ *
+ *   dL/dtau_k += f_u,k' lambda_k+1,  lambda_k = dL/dx_k + f_x,k' lambda_k+1,
+ *
+ * with x = (q, v), lambda_K = dL/dx_K, and the step Jacobians f_x, f_u from
+ * the analytic derivatives of RecursiveDynamics::forwardDynamicsDerivatives.
+ * Only joint-id indexed arrays are kept, never Values. With checkpointing,
+ * a first pass keeps every checkpoint_interval-th state, and the backward
+ * pass recomputes the states and Jacobians of one segment at a time from
+ * its checkpoint.
+ *
+ * Rollouts are distributed over a thread pool, each thread with its own
+ * dynamics workspace. Layouts are those of BatchSimulator: torques are one
+ * #steps x #joints matrix per rollout, column j for joint id j, and states
+ * are rows of RolloutStates.
+ */
+class DifferentiableRollout {
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot, a tree whose roots are fixed links
+   * @param gravity     gravity vector
+   * @param parameters  time step, checkpointing and threads
+   */
+  DifferentiableRollout(const Robot &robot,
+                        const boost::optional<gtsam::Vector3> &gravity =
+                            boost::none,
+                        const DifferentiableRolloutParameters &parameters =
+                            DifferentiableRolloutParameters());
+
+  /// Number of threads used for the rollouts.
+  size_t numThreads() const { return pool_.numThreads(); }
+
+  /// Number of entries of joint-id indexed vectors.
+  size_t numJoints() const { return n_; }
+
+  /**
+   * Simulate a batch of rollouts.
+   * @param q0           initial joint angles, one row per rollout
+   * @param v0           initial joint velocities, one row per rollout
+   * @param torque_seqs  one #steps x #joints matrix per rollout
+   */
+  RolloutStates simulate(const gtsam::Matrix &q0, const gtsam::Matrix &v0,
+                         const std::vector<gtsam::Matrix> &torque_seqs);
+
+  /**
+   * Gradients of a cost L of a batch of rollouts, given its partial
+   * derivatives in the states and torques, e.g. computed from the result of
+   * simulate. The forward pass is repeated, so nothing is kept between the
+   * calls.
+   * @param q0, v0, torque_seqs  as in simulate
+   * @param dL_dq    dL/dq of every step, with the layout of RolloutStates::q
+   * @param dL_dv    dL/dv of every step, with the layout of RolloutStates::v
+   * @param dL_dtau  dL/dtau, like torque_seqs, or empty if L does not depend
+   *                 explicitly on the torques
+   */
+  RolloutGradients gradients(const gtsam::Matrix &q0, const gtsam::Matrix &v0,
+                             const std::vector<gtsam::Matrix> &torque_seqs,
+                             const gtsam::Matrix &dL_dq,
+                             const gtsam::Matrix &dL_dv,
+                             const std::vector<gtsam::Matrix> &dL_dtau =
+                                 std::vector<gtsam::Matrix>());
+
+ private:
+  // Dynamics and buffers of one thread.
+  struct Workspace {
+    boost::shared_ptr<RecursiveDynamics> dynamics;
+    RecursiveDynamicsResult result;
+    gtsam::Vector q, v, lambda;
+    gtsam::Matrix a_q, a_v, a_u;
+    std::vector<gtsam::Vector> checkpoints;  // (q, v) stacked
+    std::vector<gtsam::Matrix> fx, fu;       // of the steps of a segment
+  };
+
+  // Check the sizes of a batch, return the number of steps.
+  size_t checkBatch(const gtsam::Matrix &q0, const gtsam::Matrix &v0,
+                    const std::vector<gtsam::Matrix> &torque_seqs) const;
+
+  // One step from ws->q, ws->v, with its Jacobians if fx is given.
+  void step(const gtsam::Vector &tau, Workspace *ws, gtsam::Matrix *fx,
+            gtsam::Matrix *fu) const;
+
+  Robot robot_;
+  DifferentiableRolloutParameters p_;
+  size_t n_;
+  ThreadPool pool_;
+  std::vector<Workspace> workspaces_;  // per thread
+};
+
+}  // namespace gtdynamics
@@ -16,22 +16,37 @@
 #include <gtsam/linear/GaussianFactorGraph.h>
 #include <gtsam/nonlinear/ExpressionFactor.h>
 #include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/expressions.h>
 #include <gtsam/slam/PriorFactor.h>
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <set>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include "gtdynamics/factors/CollocationBankFactor.h"
+#include "gtdynamics/factors/CollocationFactors.h"
 #include "gtdynamics/factors/ContactDynamicsFrictionConeFactor.h"
 #include "gtdynamics/factors/ContactDynamicsMomentFactor.h"
 #include "gtdynamics/factors/ContactKinematicsAccelFactor.h"
 #include "gtdynamics/factors/ContactHeightFactor.h"
 #include "gtdynamics/factors/ContactKinematicsTwistFactor.h"
+#include "gtdynamics/factors/LinkDynamicsFactor.h"
+#include "gtdynamics/factors/SDFCollisionFactor.h"
+#include "gtdynamics/factors/SelfCollisionFactor.h"
+#include "gtdynamics/factors/TorqueFactor.h"
 #include "gtdynamics/universal_robot/Joint.h"
+#include "gtdynamics/utils/GraphTiles.h"
+#include "gtdynamics/utils/GraphWriter.h"
 #include "gtdynamics/utils/JsonSaver.h"
+#include "gtdynamics/utils/NoiseModels.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/Trace.h"
+#include "gtdynamics/utils/TrajectoryFile.h"
 #include "gtdynamics/utils/utils.h"
 #include "gtdynamics/utils/values.h"
 
@@ -53,8 +68,9 @@ namespace gtdynamics {
 
 GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
     const Robot &robot, const int t, const gtsam::Values &known_values) {
+  GTD_TRACE_SCOPE("DynamicsGraph::linearDynamicsGraph");
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(6);
+  auto all_constrained = ConstrainedAll(6);
   for (auto &&link : robot.links()) {
     int i = link->id();
     if (link->isFixed()) {
@@ -66,18 +82,11 @@ GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
       // G_i * A_i - F_i_j1 - .. - F_i_jn  = ad(V_i)^T * G_i * V*i + m_i * R_i^T
       // * g
       const auto &connected_joints = link->joints();
-      const gtsam::Matrix6 G_i = link->inertiaMatrix();
-      const double m_i = link->mass();
+      const gtsam::Matrix6 &G_i = link->inertiaMatrix();
       const Pose3 T_wi = Pose(known_values, i, t);
       const Vector6 V_i = Twist(known_values, i, t);
       Vector6 rhs = Pose3::adjointMap(V_i).transpose() * G_i * V_i;
-      if (gravity_) {
-        Vector gravitational_force =
-            T_wi.rotation().transpose() * (*gravity_) * m_i;
-        for (int i = 3; i < 6; ++i) {
-          rhs[i] += gravitational_force[i - 3];
-        }
-      }
+      if (gravity_) rhs += link->gravityWrench(*gravity_, T_wi.rotation());
       auto accel_key = internal::TwistAccelKey(i, t);
       if (connected_joints.size() == 0) {
         graph.add(accel_key, G_i, rhs, all_constrained);
@@ -94,7 +103,6 @@ GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
     }
   }
 
-  OptimizerSetting opt_;
   for (auto &&joint : robot.joints()) {
     graph += joint->linearAFactors(t, known_values, opt_, planar_axis_);
     graph += joint->linearDynamicsFactors(t, known_values, opt_, planar_axis_);
@@ -105,16 +113,18 @@ GaussianFactorGraph DynamicsGraph::linearDynamicsGraph(
 
 GaussianFactorGraph DynamicsGraph::linearFDPriors(
     const Robot &robot, const int t, const gtsam::Values &torques) {
-  OptimizerSetting opt_ = OptimizerSetting();
+  // The priors are constrained, the settings are not used.
+  static const OptimizerSetting opt;
   GaussianFactorGraph graph;
-  for (auto &&joint : robot.joints()) graph += joint->linearFDPriors(t, torques, opt_);
+  for (auto &&joint : robot.joints())
+    graph += joint->linearFDPriors(t, torques, opt);
   return graph;
 }
 
 GaussianFactorGraph DynamicsGraph::linearIDPriors(
     const Robot &robot, const int t, const gtsam::Values &joint_accels) {
   GaussianFactorGraph graph;
-  auto all_constrained = gtsam::noiseModel::Constrained::All(1);
+  auto all_constrained = ConstrainedAll(1);
   for (auto &&joint : robot.joints()) {
     int j = joint->id();
     double accel = JointAccel(joint_accels, j, t);
@@ -126,6 +136,7 @@ GaussianFactorGraph DynamicsGraph::linearIDPriors(
 
 Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
                                     const gtsam::Values &known_values) {
+  GTD_TRACE_SCOPE("DynamicsGraph::linearSolveFD");
   // construct and solve linear graph
   GaussianFactorGraph graph = linearDynamicsGraph(robot, t, known_values);
   GaussianFactorGraph priors = linearFDPriors(robot, t, known_values);
@@ -159,6 +170,7 @@ Values DynamicsGraph::linearSolveFD(const Robot &robot, const int t,
 
 Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
                                     const gtsam::Values &known_values) {
+  GTD_TRACE_SCOPE("DynamicsGraph::linearSolveID");
   // construct and solve linear graph
   GaussianFactorGraph graph = linearDynamicsGraph(robot, t, known_values);
   GaussianFactorGraph priors = linearIDPriors(robot, t, known_values);
@@ -193,187 +205,359 @@ Values DynamicsGraph::linearSolveID(const Robot &robot, const int t,
   return values;
 }
 
-gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
-    const Robot &robot, const int k,
-    const boost::optional<PointOnLinks> &contact_points) const {
-  NonlinearFactorGraph graph;
+void DynamicsGraph::addQFactors(
+    const Robot &robot, const boost::optional<PointOnLinks> &contact_points,
+    DynamicsSlice *slice) const {
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior(internal::PoseKey(link->id(), k), link->getFixedPose(),
-                     opt_.bp_cost_model);
+      slice->addShifted(boost::make_shared<PriorFactor<Pose3>>(
+          internal::PoseKey(link->id(), 0), link->getFixedPose(),
+          opt_.bp_cost_model));
 
   // TODO(frank): call Kinematics::graph<Slice> instead
-  for (auto &&joint : robot.joints()) {
-    graph.add(PoseFactor(
-        internal::PoseKey(joint->parent()->id(), k),
-        internal::PoseKey(joint->child()->id(), k),
-        internal::JointAngleKey(joint->id(), k), opt_.p_cost_model, joint));
-  }
-
-  // TODO(frank): whoever write this should clean up this mess.
-  gtsam::Vector3 gravity;
-  if (gravity_)
-    gravity = *gravity_;
-  else
-    gravity = gtsam::Vector3(0, 0, -9.8);
+  for (auto &&joint : robot.joints())
+    slice->addShifted(PoseFactor(opt_.p_cost_model, joint, 0));
 
   // Add contact factors.
   if (contact_points) {
     for (auto &&cp : *contact_points) {
-      ContactHeightFactor contact_pose_factor(
-          internal::PoseKey(cp.link->id(), k), opt_.cp_cost_model, cp.point,
-          gravity);
-      graph.add(contact_pose_factor);
+      const gtsam::Key pose_key = internal::PoseKey(cp.link->id(), 0);
+      if (opt_.terrain) {
+        slice->addShifted(boost::make_shared<ContactHeightFactor>(
+            pose_key, opt_.cp_cost_model, cp.point, opt_.terrain));
+      } else {
+        slice->addShifted(boost::make_shared<ContactHeightFactor>(
+            pose_key, opt_.cp_cost_model, cp.point, gravity()));
+      }
     }
   }
-
-  return graph;
 }
 
-gtsam::NonlinearFactorGraph DynamicsGraph::vFactors(
-    const Robot &robot, const int t,
-    const boost::optional<PointOnLinks> &contact_points) const {
-  NonlinearFactorGraph graph;
+void DynamicsGraph::addVFactors(
+    const Robot &robot, const boost::optional<PointOnLinks> &contact_points,
+    DynamicsSlice *slice) const {
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(internal::TwistKey(link->id(), t),
-                                     gtsam::Z_6x1, opt_.bv_cost_model);
+      slice->addShifted(boost::make_shared<PriorFactor<Vector6>>(
+          internal::TwistKey(link->id(), 0), gtsam::Z_6x1,
+          opt_.bv_cost_model));
 
   for (auto &&joint : robot.joints())
-    graph.add(TwistFactor(opt_.v_cost_model, joint, t));
+    slice->addShifted(TwistFactor(opt_.v_cost_model, joint, 0));
 
   // Add contact factors.
   if (contact_points) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsTwistFactor contact_twist_factor(
-          internal::TwistKey(cp.link->id(), t), opt_.cv_cost_model,
-          gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_twist_factor);
+      slice->addShifted(boost::make_shared<ContactKinematicsTwistFactor>(
+          internal::TwistKey(cp.link->id(), 0), opt_.cv_cost_model,
+          gtsam::Pose3(gtsam::Rot3(), -cp.point)));
     }
   }
-
-  return graph;
 }
 
-gtsam::NonlinearFactorGraph DynamicsGraph::aFactors(
-    const Robot &robot, const int t,
-    const boost::optional<PointOnLinks> &contact_points) const {
-  NonlinearFactorGraph graph;
+void DynamicsGraph::addAFactors(
+    const Robot &robot, const boost::optional<PointOnLinks> &contact_points,
+    DynamicsSlice *slice) const {
   for (auto &&link : robot.links())
     if (link->isFixed())
-      graph.addPrior<gtsam::Vector6>(internal::TwistAccelKey(link->id(), t),
-                                     gtsam::Z_6x1, opt_.ba_cost_model);
+      slice->addShifted(boost::make_shared<PriorFactor<Vector6>>(
+          internal::TwistAccelKey(link->id(), 0), gtsam::Z_6x1,
+          opt_.ba_cost_model));
+
   for (auto &&joint : robot.joints())
-    graph.add(TwistAccelFactor(opt_.a_cost_model, joint, t));
+    slice->addShifted(TwistAccelFactor(opt_.a_cost_model, joint, 0));
 
   // Add contact factors.
   if (contact_points) {
     for (auto &&cp : *contact_points) {
-      ContactKinematicsAccelFactor contact_accel_factor(
-          internal::TwistAccelKey(cp.link->id(), t), opt_.ca_cost_model,
-          gtsam::Pose3(gtsam::Rot3(), -cp.point));
-      graph.add(contact_accel_factor);
+      slice->addShifted(boost::make_shared<ContactKinematicsAccelFactor>(
+          internal::TwistAccelKey(cp.link->id(), 0), opt_.ca_cost_model,
+          gtsam::Pose3(gtsam::Rot3(), -cp.point)));
     }
   }
-
-  return graph;
 }
 
-// TODO(frank): migrate to Dynamics::graph<Slice>
-gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
-    const Robot &robot, const int k,
-    const boost::optional<PointOnLinks> &contact_points,
-    const boost::optional<double> &mu) const {
-  NonlinearFactorGraph graph;
+void DynamicsGraph::addFusedLinkDynamicsFactor(
+    const LinkSharedPtr &link,
+    const boost::optional<PointOnLinks> &contact_points, double mu,
+    const gtsam::Vector3 &gravity, DynamicsSlice *slice) const {
+  const int i = link->id();
+  bool is_child = false;
+  std::vector<Key> wrench_keys;  // at time step 0
+  for (auto &&joint : link->joints()) {
+    wrench_keys.push_back(internal::WrenchKey(i, joint->id(), 0));
+    if (joint->child() == link) is_child = true;
+  }
+  if (link->isFixed() && !is_child) return;
 
-  // TODO(frank): whoever write this should clean up this mess.
-  gtsam::Vector3 gravity;
-  if (gravity_)
-    gravity = *gravity_;
-  else
-    gravity = gtsam::Vector3(0, 0, -9.8);
+  if (contact_points && !link->isFixed()) {
+    for (auto &&cp : *contact_points) {
+      if (cp.link->id() != i) continue;
+      const Key wrench_key = ContactWrenchKey(i, 0, 0);
+      wrench_keys.push_back(wrench_key);
+      slice->addShifted(boost::make_shared<ContactDynamicsFrictionConeFactor>(
+          internal::PoseKey(i, 0), wrench_key, opt_.cfriction_cost_model, mu,
+          gravity));
+      slice->addShifted(boost::make_shared<ContactDynamicsMomentFactor>(
+          wrench_key, opt_.cm_cost_model,
+          gtsam::Pose3(gtsam::Rot3(), -cp.point)));
+    }
+  }
 
-  double mu_;  // Static friction coefficient.
-  if (mu)
-    mu_ = *mu;
-  else
-    mu_ = 1.0;
+  slice->addShifted(boost::make_shared<LinkDynamicsFactor>(
+      link, wrench_keys, 0, opt_, gravity, planar_axis_));
+}
+
+// TODO(frank): migrate to Dynamics::graph<Slice>
+void DynamicsGraph::addDynamicsFactors(
+    const Robot &robot, const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu, DynamicsSlice *slice) const {
+  const gtsam::Vector3 gravity = this->gravity();
+  const double mu_ = mu ? *mu : 1.0;  // Static friction coefficient.
 
+  const auto fa_cost_model = opt_.fa_cost_model;
   for (auto &&link : robot.links()) {
     int i = link->id();
+    if (opt_.fuse_link_dynamics) {
+      addFusedLinkDynamicsFactor(link, contact_points, mu_, gravity, slice);
+      continue;
+    }
     if (!link->isFixed()) {
       const auto &connected_joints = link->joints();
-      std::vector<DynamicsSymbol> wrench_keys;
+      std::vector<Key> wrench_keys;  // at time step 0
 
       // Add wrench keys for joints.
       for (auto &&joint : connected_joints)
-        wrench_keys.push_back(internal::WrenchKey(i, joint->id(), k));
+        wrench_keys.push_back(internal::WrenchKey(i, joint->id(), 0));
 
       // Add wrench keys for contact points.
       if (contact_points) {
         for (auto &&cp : *contact_points) {
           if (cp.link->id() != i) continue;
           // TODO(frank): allow multiple contact points on one link, id = 0,1,..
-          auto wrench_key = ContactWrenchKey(i, 0, k);
+          const Key wrench_key = ContactWrenchKey(i, 0, 0);
           wrench_keys.push_back(wrench_key);
 
           // Add contact dynamics constraints.
-          graph.emplace_shared<ContactDynamicsFrictionConeFactor>(
-              internal::PoseKey(i, k), wrench_key, opt_.cfriction_cost_model,
-              mu_, gravity);
+          slice->addShifted(
+              boost::make_shared<ContactDynamicsFrictionConeFactor>(
+                  internal::PoseKey(i, 0), wrench_key,
+                  opt_.cfriction_cost_model, mu_, gravity));
 
-          graph.emplace_shared<ContactDynamicsMomentFactor>(
+          slice->addShifted(boost::make_shared<ContactDynamicsMomentFactor>(
               wrench_key, opt_.cm_cost_model,
-              gtsam::Pose3(gtsam::Rot3(), -cp.point));
+              gtsam::Pose3(gtsam::Rot3(), -cp.point)));
         }
       }
 
       // add wrench factor for link
-      graph.add(WrenchFactor(
-        opt_.fa_cost_model, link, wrench_keys, k, gravity));
+      LinkConstSharedPtr const_link = link;
+      slice->addMaker([=](int t) {
+        std::vector<DynamicsSymbol> keys;
+        keys.reserve(wrench_keys.size());
+        for (const Key key : wrench_keys) keys.emplace_back(key + t);
+        return WrenchFactor(fa_cost_model, const_link, keys, t, gravity);
+      });
     }
   }
 
+  // Joint constraints are part of the fused link factors.
+  if (opt_.fuse_link_dynamics) {
+    if (opt_.passive_joint_forces)
+      throw std::invalid_argument(
+          "DynamicsGraph: passive_joint_forces needs separate torque "
+          "factors, not fuse_link_dynamics.");
+    return;
+  }
+
   // TODO(frank): use Statics<Slice> calls
-  // TODO(frank): sort out const shared ptr mess
+  const auto planar_cost_model = opt_.planar_cost_model;
   for (auto &&joint : robot.joints()) {
-    auto j = joint->id(), child_id = joint->child()->id();
-    auto const_joint = joint;
-    graph.add(WrenchEquivalenceFactor(opt_.f_cost_model,
-                                                  const_joint, k));
-    graph.add(TorqueFactor(opt_.t_cost_model, const_joint, k));
-    if (planar_axis_)
-      graph.add(WrenchPlanarFactor(opt_.planar_cost_model, *planar_axis_,
-                                   const_joint, k));
+    JointConstSharedPtr const_joint = joint;
+    slice->addShifted(
+        WrenchEquivalenceFactor(opt_.f_cost_model, const_joint, 0));
+    if (opt_.passive_joint_forces && joint->hasPassiveTorque())
+      slice->addShifted(PassiveTorqueFactor(opt_.t_cost_model, const_joint, 0));
+    else
+      slice->addShifted(TorqueFactor(opt_.t_cost_model, const_joint, 0));
+    if (planar_axis_) {
+      const gtsam::Vector3 planar_axis = *planar_axis_;
+      slice->addMaker([=](int t) {
+        return WrenchPlanarFactor(planar_cost_model, planar_axis, const_joint,
+                                  t);
+      });
+    }
   }
-  return graph;
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::qFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::qFactors");
+  DynamicsSlice slice;
+  addQFactors(robot, contact_points, &slice);
+  return slice.instantiate(k);
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::vFactors(
+    const Robot &robot, const int t,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::vFactors");
+  DynamicsSlice slice;
+  addVFactors(robot, contact_points, &slice);
+  return slice.instantiate(t);
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::aFactors(
+    const Robot &robot, const int t,
+    const boost::optional<PointOnLinks> &contact_points) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::aFactors");
+  DynamicsSlice slice;
+  addAFactors(robot, contact_points, &slice);
+  return slice.instantiate(t);
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactors(
+    const Robot &robot, const int k,
+    const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::dynamicsFactors");
+  DynamicsSlice slice;
+  addDynamicsFactors(robot, contact_points, mu, &slice);
+  return slice.instantiate(k);
+}
+
+DynamicsSlice DynamicsGraph::dynamicsSlice(
+    const Robot &robot, const boost::optional<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu) const {
+  DynamicsSlice slice;
+  addQFactors(robot, contact_points, &slice);
+  addVFactors(robot, contact_points, &slice);
+  addAFactors(robot, contact_points, &slice);
+  addDynamicsFactors(robot, contact_points, mu, &slice);
+  return slice;
+}
+
+DynamicsSlice DynamicsGraph::contactImplicitSlice(
+    const Robot &robot, const PointOnLinks &candidate_points,
+    const ComplementarityParams &complementarity,
+    const boost::optional<double> &mu) const {
+  DynamicsSlice slice;
+  addQFactors(robot, boost::none, &slice);
+  addVFactors(robot, boost::none, &slice);
+  addAFactors(robot, boost::none, &slice);
+  addDynamicsFactors(robot, candidate_points, mu, &slice);
+  for (auto &&cp : candidate_points) {
+    const int i = cp.link->id();
+    slice.addShifted(boost::make_shared<ContactComplementarityFactor>(
+        internal::PoseKey(i, 0), ContactWrenchKey(i, 0, 0), cp.point,
+        gravity(), complementarity));
+  }
+  return slice;
+}
+
+std::vector<DynamicsSlice> DynamicsGraph::dynamicsSlices(
+    const Robot &robot, const std::vector<PointOnLinks> &contact_points,
+    const boost::optional<double> &mu, std::vector<size_t> *indices) const {
+  std::vector<DynamicsSlice> slices;
+  std::vector<const PointOnLinks *> patterns;  // contact points of each slice
+  if (indices) indices->clear();
+  for (auto &&cps : contact_points) {
+    size_t index = 0;
+    while (index < patterns.size() && *patterns[index] != cps) index++;
+    if (index == patterns.size()) {
+      patterns.push_back(&cps);
+      slices.push_back(dynamicsSlice(robot, cps, mu));
+    }
+    if (indices) indices->push_back(index);
+  }
+  return slices;
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::dynamicsFactorGraph(
     const Robot &robot, const int t,
     const boost::optional<PointOnLinks> &contact_points,
     const boost::optional<double> &mu) const {
-  NonlinearFactorGraph graph;
-  graph.add(qFactors(robot, t, contact_points));
-  graph.add(vFactors(robot, t, contact_points));
-  graph.add(aFactors(robot, t, contact_points));
-  graph.add(dynamicsFactors(robot, t, contact_points, mu));
-  return graph;
+  GTD_TRACE_SCOPE("DynamicsGraph::dynamicsFactorGraph");
+  return dynamicsSlice(robot, contact_points, mu).instantiate(t);
+}
+
+// Append build(0), ..., build(n - 1) to graph, in that order. With a pool,
+// contiguous ranges of steps are built concurrently into separate graphs,
+// which are then concatenated, so the result does not depend on scheduling.
+static void BuildSteps(
+    size_t n, const std::function<void(size_t, NonlinearFactorGraph *)> &build,
+    ThreadPool *pool, NonlinearFactorGraph *graph) {
+  if (!pool || pool->numThreads() == 1 || n < 2) {
+    for (size_t k = 0; k < n; k++) build(k, graph);
+    return;
+  }
+
+  // A few ranges per thread, so that uneven steps still balance out.
+  const size_t num_ranges = std::min(n, 4 * pool->numThreads());
+  std::vector<NonlinearFactorGraph> parts(num_ranges);
+  pool->parallelFor(num_ranges, [&](size_t r, size_t /*worker*/) {
+    for (size_t k = r * n / num_ranges; k < (r + 1) * n / num_ranges; k++)
+      build(k, &parts[r]);
+  });
+
+  size_t size = graph->size();
+  for (auto &&part : parts) size += part.size();
+  graph->reserve(size);
+  for (auto &&part : parts) graph->push_back(part.begin(), part.end());
+}
+
+std::shared_ptr<FactorArena> DynamicsGraph::factorArena() const {
+  if (!opt_.arena_allocation) return nullptr;
+  return std::make_shared<FactorArena>();
 }
 
 gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFG(
     const Robot &robot, const int num_steps, const double dt,
     const CollocationScheme collocation,
     const boost::optional<PointOnLinks> &contact_points,
-    const boost::optional<double> &mu) const {
+    const boost::optional<double> &mu, ThreadPool *pool) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::trajectoryFG");
+  const DynamicsSlice slice = dynamicsSlice(robot, contact_points, mu);
+  const auto arena = factorArena();
   NonlinearFactorGraph graph;
-  for (int t = 0; t < num_steps + 1; t++) {
-    graph.add(dynamicsFactorGraph(robot, t,
-                                  contact_points, mu));
-    if (t < num_steps) {
-      graph.add(collocationFactors(robot, t, dt, collocation));
-    }
-  }
+  BuildSteps(
+      num_steps + 1,
+      [&](size_t t, NonlinearFactorGraph *part) {
+        slice.instantiate(t, part, arena);
+        if (int(t) >= num_steps) return;
+        const int bank_steps = opt_.collocation_bank_steps;
+        if (bank_steps == 0) {
+          part->add(collocationFactors(robot, t, dt, collocation));
+        } else if (int(t) % bank_steps == 0) {
+          part->add(collocationBankFactors(
+              robot, t, std::min(bank_steps, num_steps - int(t)), dt,
+              collocation));
+        }
+      },
+      pool, &graph);
+  return graph;
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::contactImplicitTrajectoryFG(
+    const Robot &robot, const int num_steps, const double dt,
+    const PointOnLinks &candidate_points,
+    const ComplementarityParams &complementarity,
+    const CollocationScheme collocation, const boost::optional<double> &mu,
+    ThreadPool *pool) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::contactImplicitTrajectoryFG");
+  const DynamicsSlice slice =
+      contactImplicitSlice(robot, candidate_points, complementarity, mu);
+  const auto arena = factorArena();
+  NonlinearFactorGraph graph;
+  BuildSteps(
+      num_steps + 1,
+      [&](size_t t, NonlinearFactorGraph *part) {
+        slice.instantiate(t, part, arena);
+        if (int(t) < num_steps)
+          part->add(collocationFactors(robot, t, dt, collocation));
+      },
+      pool, &graph);
   return graph;
 }
 
@@ -382,44 +566,53 @@ gtsam::NonlinearFactorGraph DynamicsGraph::multiPhaseTrajectoryFG(
     const std::vector<gtsam::NonlinearFactorGraph> &transition_graphs,
     const CollocationScheme collocation,
     const boost::optional<std::vector<PointOnLinks>> &phase_contact_points,
-    const boost::optional<double> &mu) const {
+    const boost::optional<double> &mu, ThreadPool *pool) const {
+  GTD_TRACE_SCOPE("DynamicsGraph::multiPhaseTrajectoryFG");
   NonlinearFactorGraph graph;
   int num_phases = phase_steps.size();
 
-  // Return either PointOnLinks or None if none specified for phase p
-  auto contact_points =
-      [&phase_contact_points](int p) -> boost::optional<PointOnLinks> {
-    if (phase_contact_points) return (*phase_contact_points)[p];
-    return boost::none;
-  };
-
-  // First slice, k==0
-  graph.add(dynamicsFactorGraph(robot, 0, contact_points(0), mu));
-
-  int k = 0;
-  for (int p = 0; p < num_phases; p++) {
-    // in-phase
-    // add dynamics for each step
-    for (int step = 0; step < phase_steps[p] - 1; step++) {
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
-    }
-    if (p == num_phases - 1) {
-      // Last slice, k==K-1
-      graph.add(dynamicsFactorGraph(robot, ++k, contact_points(p), mu));
-    } else {
-      // transition
-      graph.add(transition_graphs[p]);
-      k++;
-    }
-  }
+  // One slice per contact pattern, shared by the phases that have it.
+  std::vector<DynamicsSlice> slices;
+  std::vector<size_t> slice_of_phase(num_phases, 0);
+  if (phase_contact_points)
+    slices = dynamicsSlices(robot, *phase_contact_points, mu, &slice_of_phase);
+  else
+    slices.push_back(dynamicsSlice(robot, boost::none, mu));
 
-  // add collocation factors
-  k = 0;
+  // Phase of each time step k: the first step and the in-phase steps use the
+  // dynamics slice of their phase, and the last step of every phase but the
+  // last one is replaced by the transition graph into the next phase.
+  std::vector<int> phase_of_step(1, 0);
+  std::vector<bool> is_transition(1, false);
   for (int p = 0; p < num_phases; p++) {
     for (int step = 0; step < phase_steps[p]; step++) {
-      graph.add(multiPhaseCollocationFactors(robot, k++, p, collocation));
+      phase_of_step.push_back(p);
+      is_transition.push_back(step == phase_steps[p] - 1 &&
+                              p != num_phases - 1);
     }
   }
+
+  // add dynamics for each step
+  const auto arena = factorArena();
+  BuildSteps(
+      phase_of_step.size(),
+      [&](size_t k, NonlinearFactorGraph *part) {
+        if (is_transition[k])
+          part->add(transition_graphs[phase_of_step[k]]);
+        else
+          slices[slice_of_phase[phase_of_step[k]]].instantiate(k, part,
+                                                               arena);
+      },
+      pool, &graph);
+
+  // add collocation factors, step k is in the phase of step k + 1
+  BuildSteps(
+      phase_of_step.size() - 1,
+      [&](size_t k, NonlinearFactorGraph *part) {
+        part->add(multiPhaseCollocationFactors(robot, k, phase_of_step[k + 1],
+                                               collocation));
+      },
+      pool, &graph);
   return graph;
 }
 
@@ -441,45 +634,55 @@ void DynamicsGraph::addCollocationFactorDouble(
         x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr - x1_expr));
   } else {
     throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+        "runge-kutta not implemented yet, and hermite-simpson needs second "
+        "derivatives");
   }
 }
 
-// the * operator for doubles in expression factor does not work well yet
-double multDouble(const double &d1, const double &d2,
-                  gtsam::OptionalJacobian<1, 1> H1,
-                  gtsam::OptionalJacobian<1, 1> H2) {
-  if (H1)
-    *H1 = gtsam::I_1x1 * d2;
-  if (H2)
-    *H2 = gtsam::I_1x1 * d1;
-  return d1 * d2;
-}
-
 void DynamicsGraph::addMultiPhaseCollocationFactorDouble(
     NonlinearFactorGraph* graph, const Key x0_key, const Key x1_key,
     const Key v0_key, const Key v1_key, const Key phase_key,
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     const CollocationScheme collocation) {
-  Double_ phase_expr(phase_key);
-  Double_ x0_expr(x0_key);
-  Double_ x1_expr(x1_key);
-  Double_ v0_expr(v0_key);
-  Double_ v1_expr(v1_key);
-  Double_ v0dt(multDouble, phase_expr, v0_expr);
-
   if (collocation == CollocationScheme::Euler) {
-    graph->add(ExpressionFactor(cost_model, 0.0, x0_expr + v0dt - x1_expr));
+    graph->emplace_shared<EulerDoubleCollocationFactor>(x0_key, x1_key, v0_key,
+                                                        phase_key, cost_model);
   } else if (collocation == CollocationScheme::Trapezoidal) {
-    Double_ v1dt(multDouble, phase_expr, v1_expr);
-    graph->add(ExpressionFactor(cost_model, 0.0,
-                               x0_expr + 0.5 * v0dt + 0.5 * v1dt - x1_expr));
+    graph->emplace_shared<TrapezoidalDoubleCollocationFactor>(
+        x0_key, x1_key, v0_key, v1_key, phase_key, cost_model);
   } else {
     throw std::runtime_error(
-        "runge-kutta and hermite-simpson not implemented yet");
+        "runge-kutta not implemented yet, and hermite-simpson needs second "
+        "derivatives");
   }
 }
 
+void DynamicsGraph::addHermiteSimpsonCollocationFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const double dt, const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  Double_ x0_expr(x0_key);
+  Double_ x1_expr(x1_key);
+  Double_ v0_expr(v0_key);
+  Double_ v1_expr(v1_key);
+  Double_ a0_expr(a0_key);
+  Double_ a1_expr(a1_key);
+  const double dt2 = dt * dt / 12;
+  graph->add(ExpressionFactor(
+      cost_model, 0.0,
+      x0_expr + 0.5 * dt * v0_expr + 0.5 * dt * v1_expr + dt2 * a0_expr -
+          dt2 * a1_expr - x1_expr));
+}
+
+void DynamicsGraph::addMultiPhaseHermiteSimpsonCollocationFactorDouble(
+    NonlinearFactorGraph *graph, const Key x0_key, const Key x1_key,
+    const Key v0_key, const Key v1_key, const Key a0_key, const Key a1_key,
+    const Key phase_key,
+    const gtsam::noiseModel::Base::shared_ptr &cost_model) {
+  graph->emplace_shared<HermiteSimpsonDoubleCollocationFactor>(
+      x0_key, x1_key, v0_key, v1_key, a0_key, a1_key, phase_key, cost_model);
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
     const int j, const int t, const double dt,
     const CollocationScheme collocation) const {
@@ -490,6 +693,15 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointCollocationFactors(
       v1_key = internal::JointVelKey(j, t + 1),
       a0_key = internal::JointAccelKey(j, t),
       a1_key = internal::JointAccelKey(j, t + 1);
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    addHermiteSimpsonCollocationFactorDouble(&graph, q0_key, q1_key, v0_key,
+                                             v1_key, a0_key, a1_key, dt,
+                                             opt_.q_col_cost_model);
+    addCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key, dt,
+                               opt_.v_col_cost_model,
+                               CollocationScheme::Trapezoidal);
+    return graph;
+  }
   addCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key, dt,
                              opt_.q_col_cost_model, collocation);
   addCollocationFactorDouble(&graph, v0_key, v1_key, a0_key, a1_key, dt,
@@ -509,6 +721,18 @@ DynamicsGraph::collocationFactors(const Robot &robot, const int t,
   return graph;
 }
 
+gtsam::NonlinearFactorGraph DynamicsGraph::collocationBankFactors(
+    const Robot &robot, const int t, const int num_steps, const double dt,
+    const CollocationScheme collocation) const {
+  NonlinearFactorGraph graph;
+  for (auto &&joint : robot.joints()) {
+    graph.emplace_shared<CollocationBankFactor>(
+        std::vector<int>{joint->id()}, t, num_steps, dt, opt_.q_col_cost_model,
+        opt_.v_col_cost_model, collocation);
+  }
+  return graph;
+}
+
 gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
     const int j, const int t, const int phase,
     const CollocationScheme collocation) const {
@@ -520,6 +744,16 @@ gtsam::NonlinearFactorGraph DynamicsGraph::jointMultiPhaseCollocationFactors(
       a1_key = internal::JointAccelKey(j, t + 1);
 
   gtsam::NonlinearFactorGraph graph;
+  if (collocation == CollocationScheme::HermiteSimpson) {
+    addMultiPhaseHermiteSimpsonCollocationFactorDouble(
+        &graph, q0_key, q1_key, v0_key, v1_key, a0_key, a1_key, phase_key,
+        opt_.q_col_cost_model);
+    addMultiPhaseCollocationFactorDouble(&graph, v0_key, v1_key, a0_key,
+                                         a1_key, phase_key,
+                                         opt_.v_col_cost_model,
+                                         CollocationScheme::Trapezoidal);
+    return graph;
+  }
   addMultiPhaseCollocationFactorDouble(&graph, q0_key, q1_key, v0_key, v1_key,
                                        phase_key, opt_.q_col_cost_model,
                                        collocation);
@@ -589,6 +823,44 @@ gtsam::NonlinearFactorGraph DynamicsGraph::trajectoryFDPriors(
   return graph;
 }
 
+gtsam::Values DynamicsGraph::forwardDynamicsConstants(
+    const Robot &robot, const int t, const gtsam::Values &known_values) {
+  gtsam::Values constants;
+  for (auto &&joint : robot.joints()) {
+    int j = joint->id();
+    InsertJointAngle(&constants, j, t, JointAngle(known_values, j, t));
+    InsertJointVel(&constants, j, t, JointVel(known_values, j, t));
+    InsertTorque(&constants, j, t, Torque(known_values, j, t));
+  }
+  return constants;
+}
+
+gtsam::Values DynamicsGraph::inverseDynamicsConstants(
+    const Robot &robot, const int t, const gtsam::Values &known_values) {
+  gtsam::Values constants;
+  for (auto &&joint : robot.joints()) {
+    int j = joint->id();
+    InsertJointAngle(&constants, j, t, JointAngle(known_values, j, t));
+    InsertJointVel(&constants, j, t, JointVel(known_values, j, t));
+    InsertJointAccel(&constants, j, t, JointAccel(known_values, j, t));
+  }
+  return constants;
+}
+
+gtsam::Values DynamicsGraph::trajectoryFDConstants(
+    const Robot &robot, const int num_steps,
+    const gtsam::Values &known_values) {
+  gtsam::Values constants;
+  for (auto &&joint : robot.joints()) {
+    int j = joint->id();
+    InsertJointAngle(&constants, j, 0, JointAngle(known_values, j, 0));
+    InsertJointVel(&constants, j, 0, JointVel(known_values, j, 0));
+    for (int t = 0; t <= num_steps; t++)
+      InsertTorque(&constants, j, t, Torque(known_values, j, t));
+  }
+  return constants;
+}
+
 gtsam::NonlinearFactorGraph
 DynamicsGraph::jointLimitFactors(const Robot &robot, const int t) const {
   NonlinearFactorGraph graph;
@@ -597,6 +869,142 @@ DynamicsGraph::jointLimitFactors(const Robot &robot, const int t) const {
   return graph;
 }
 
+gtsam::NonlinearFactorGraph DynamicsGraph::jointLimitFactors(
+    const Robot &robot, const int t,
+    const JointParameterBlocks &blocks) const {
+  NonlinearFactorGraph graph;
+  for (auto &&joint : robot.joints())
+    graph.add(joint->jointLimitFactors(t, opt_, blocks.block(joint->id())));
+  return graph;
+}
+
+InequalityConstraints DynamicsGraph::jointLimitConstraints(
+    const Robot &robot, const int t, double tolerance) const {
+  InequalityConstraints constraints;
+  const auto add_limits = [&](const Key key, double lower, double upper) {
+    const Double_ value(key);
+    constraints.emplace_shared<DoubleExpressionInequality>(
+        value - Double_(lower), tolerance);
+    constraints.emplace_shared<DoubleExpressionInequality>(
+        Double_(upper) - value, tolerance);
+  };
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const auto &p = joint->parameters();
+    add_limits(internal::JointAngleKey(j, t),
+               p.scalar_limits.value_lower_limit +
+                   p.scalar_limits.value_limit_threshold,
+               p.scalar_limits.value_upper_limit -
+                   p.scalar_limits.value_limit_threshold);
+    add_limits(internal::JointVelKey(j, t),
+               -p.velocity_limit + p.velocity_limit_threshold,
+               p.velocity_limit - p.velocity_limit_threshold);
+    add_limits(internal::JointAccelKey(j, t),
+               -p.acceleration_limit + p.acceleration_limit_threshold,
+               p.acceleration_limit - p.acceleration_limit_threshold);
+    add_limits(internal::TorqueKey(j, t),
+               -p.torque_limit + p.torque_limit_threshold,
+               p.torque_limit - p.torque_limit_threshold);
+  }
+  return constraints;
+}
+
+BoxBounds DynamicsGraph::jointLimitBounds(const Robot &robot,
+                                          const int t) const {
+  BoxBounds bounds;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const auto &p = joint->parameters();
+    bounds.add(internal::JointAngleKey(j, t),
+               p.scalar_limits.value_lower_limit +
+                   p.scalar_limits.value_limit_threshold,
+               p.scalar_limits.value_upper_limit -
+                   p.scalar_limits.value_limit_threshold);
+    bounds.add(internal::JointVelKey(j, t),
+               -p.velocity_limit + p.velocity_limit_threshold,
+               p.velocity_limit - p.velocity_limit_threshold);
+    bounds.add(internal::JointAccelKey(j, t),
+               -p.acceleration_limit + p.acceleration_limit_threshold,
+               p.acceleration_limit - p.acceleration_limit_threshold);
+    bounds.add(internal::TorqueKey(j, t),
+               -p.torque_limit + p.torque_limit_threshold,
+               p.torque_limit - p.torque_limit_threshold);
+  }
+  return bounds;
+}
+
+NonlinearFactorGraph DynamicsGraph::collisionFactors(
+    const Robot &robot, const int t,
+    const boost::shared_ptr<const SignedDistanceField> &sdf,
+    const std::map<std::string, CollisionSpheres> &link_spheres) const {
+  NonlinearFactorGraph graph;
+  for (auto &&entry : link_spheres) {
+    if (entry.second.empty()) continue;
+    const LinkSharedPtr link = robot.link(entry.first);
+    graph.emplace_shared<SDFCollisionFactor>(
+        internal::PoseKey(link->id(), t),
+        IsotropicSigma(entry.second.size(), opt_.obsSigma),
+        sdf, entry.second, opt_.epsilon);
+  }
+  return graph;
+}
+
+NonlinearFactorGraph DynamicsGraph::selfCollisionFactors(
+    const boost::shared_ptr<const SelfCollisionModel> &model,
+    const int t) const {
+  NonlinearFactorGraph graph;
+  if (!model->pairs().empty())
+    graph.emplace_shared<SelfCollisionFactor>(model, t, opt_.epsilon,
+                                              opt_.obsSigma);
+  return graph;
+}
+
+// mu^2 f_up^2 - |f_tangent|^2 of the linear contact force in the spatial
+// frame, non-negative inside the friction cone.
+static double FrictionConeMargin(const Pose3 &pose, const Vector6 &wrench,
+                                 double mu_prime, int up_axis,
+                                 gtsam::OptionalJacobian<1, 6> H_pose,
+                                 gtsam::OptionalJacobian<1, 6> H_wrench) {
+  gtsam::Matrix36 H_rotation;
+  const gtsam::Rot3 rotation = pose.rotation(H_pose ? &H_rotation : 0);
+  gtsam::Matrix3 H_R, H_f;
+  const gtsam::Vector3 f_s = rotation.rotate(
+      wrench.tail<3>(), H_pose ? &H_R : 0, H_wrench ? &H_f : 0);
+  gtsam::Vector3 weights(-1, -1, -1);
+  weights(up_axis) = mu_prime;
+  const gtsam::RowVector3 H_f_s = 2 * weights.cwiseProduct(f_s).transpose();
+  if (H_pose) *H_pose = H_f_s * H_R * H_rotation;
+  if (H_wrench) {
+    H_wrench->setZero();
+    H_wrench->rightCols<3>() = H_f_s * H_f;
+  }
+  return f_s.dot(weights.cwiseProduct(f_s));
+}
+
+InequalityConstraints DynamicsGraph::frictionConeConstraints(
+    const Robot &robot, const int t, const PointOnLinks &contact_points,
+    double mu, double tolerance) const {
+  const gtsam::Vector3 gravity = this->gravity();
+  const int up_axis = gravity[0] != 0 ? 0 : gravity[1] != 0 ? 1 : 2;
+  const double mu_prime = mu * mu;
+  InequalityConstraints constraints;
+  for (auto &&cp : contact_points) {
+    const int i = cp.link->id();
+    const gtsam::Pose3_ pose(internal::PoseKey(i, t));
+    const gtsam::Expression<Vector6> wrench(ContactWrenchKey(i, 0, t));
+    const Double_ margin(
+        [=](const Pose3 &pose, const Vector6 &wrench,
+            gtsam::OptionalJacobian<1, 6> H_pose,
+            gtsam::OptionalJacobian<1, 6> H_wrench) {
+          return FrictionConeMargin(pose, wrench, mu_prime, up_axis, H_pose,
+                                    H_wrench);
+        },
+        pose, wrench);
+    constraints.emplace_shared<DoubleExpressionInequality>(margin, tolerance);
+  }
+  return constraints;
+}
+
 gtsam::NonlinearFactorGraph
 DynamicsGraph::targetAngleFactors(const Robot &robot, const int t,
                                   const std::string &joint_name,
@@ -618,6 +1026,26 @@ DynamicsGraph::targetPoseFactors(const Robot &robot, const int t,
   return graph;
 }
 
+gtsam::NonlinearFactorGraph DynamicsGraph::targetAngleFactors(
+    const Robot &robot, const int t, const std::string &joint_name,
+    const TargetHandle<double> &target_angle) const {
+  NonlinearFactorGraph graph;
+  int j = robot.jointId(joint_name);
+  graph.emplace_shared<TrackingPriorFactor<double>>(
+      internal::JointAngleKey(j, t), target_angle, opt_.prior_q_cost_model);
+  return graph;
+}
+
+gtsam::NonlinearFactorGraph DynamicsGraph::targetPoseFactors(
+    const Robot &robot, const int t, const std::string &link_name,
+    const TargetHandle<gtsam::Pose3> &target_pose) const {
+  NonlinearFactorGraph graph;
+  int i = robot.linkId(link_name);
+  graph.emplace_shared<TrackingPriorFactor<gtsam::Pose3>>(
+      internal::PoseKey(i, t), target_pose, opt_.bp_cost_model);
+  return graph;
+}
+
 gtsam::Vector DynamicsGraph::jointAccels(const Robot &robot,
                                          const gtsam::Values &result,
                                          const int t) {
@@ -670,6 +1098,140 @@ gtsam::Vector DynamicsGraph::jointTorques(const Robot &robot,
   return joint_torques;
 }
 
+// Read joint quantity q of all joints at time t, in robot.joints() order.
+static gtsam::Vector JointQuantities(const Robot &robot,
+                                     const DynamicsValues &result,
+                                     DynamicsQuantity q, const int t) {
+  const auto joints = robot.joints();
+  gtsam::Vector values(joints.size());
+  for (size_t idx = 0; idx < joints.size(); idx++)
+    values[idx] = result.joint(q, joints[idx]->id(), t);
+  return values;
+}
+
+gtsam::Vector DynamicsGraph::jointAccels(const Robot &robot,
+                                         const DynamicsValues &result,
+                                         const int t) {
+  return JointQuantities(robot, result, DynamicsQuantity::JointAccel, t);
+}
+
+gtsam::Vector DynamicsGraph::jointVels(const Robot &robot,
+                                       const DynamicsValues &result,
+                                       const int t) {
+  return JointQuantities(robot, result, DynamicsQuantity::JointVel, t);
+}
+
+gtsam::Vector DynamicsGraph::jointAngles(const Robot &robot,
+                                         const DynamicsValues &result,
+                                         const int t) {
+  return JointQuantities(robot, result, DynamicsQuantity::JointAngle, t);
+}
+
+gtsam::Vector DynamicsGraph::jointTorques(const Robot &robot,
+                                          const DynamicsValues &result,
+                                          const int t) {
+  return JointQuantities(robot, result, DynamicsQuantity::Torque, t);
+}
+
+// Fill a num_steps x #joints matrix with the values at key_fn(j, t).
+static void JointTrajectory(const Robot &robot, const gtsam::Values &result,
+                            size_t num_steps,
+                            DynamicsSymbol (*key_fn)(int, int),
+                            gtsam::Matrix *out, ThreadPool *pool) {
+  const auto joints = robot.joints();
+  out->resize(num_steps, joints.size());
+
+  // Keys (j, t), (j, t + 1), ... are adjacent in result, so a block of time
+  // steps costs one lookup and a walk over the following entries.
+  const size_t kBlock = 256;
+  const size_t num_blocks = (num_steps + kBlock - 1) / kBlock;
+  const auto fill = [&](size_t task, size_t /*worker*/) {
+    const size_t idx = task / num_blocks;
+    const size_t t_begin = (task % num_blocks) * kBlock;
+    const size_t t_end = std::min(num_steps, t_begin + kBlock);
+    const int j = joints[idx]->id();
+    auto it = result.lower_bound(key_fn(j, t_begin));
+    for (size_t t = t_begin; t < t_end; ++t, ++it) {
+      const gtsam::Key key = key_fn(j, t);
+      if (it == result.end() || (*it).key != key)
+        throw KeyDoesNotExist("jointTrajectory", key);
+      (*out)(t, idx) = (*it).value.cast<double>();
+    }
+  };
+
+  const size_t num_tasks = joints.size() * num_blocks;
+  if (pool) {
+    pool->parallelFor(num_tasks, fill);
+  } else {
+    for (size_t task = 0; task < num_tasks; ++task) fill(task, 0);
+  }
+}
+
+void DynamicsGraph::jointAnglesTrajectory(const Robot &robot,
+                                          const gtsam::Values &result,
+                                          size_t num_steps,
+                                          gtsam::Matrix *angles,
+                                          ThreadPool *pool) {
+  JointTrajectory(robot, result, num_steps, internal::JointAngleKey, angles,
+                  pool);
+}
+
+void DynamicsGraph::jointVelsTrajectory(const Robot &robot,
+                                        const gtsam::Values &result,
+                                        size_t num_steps, gtsam::Matrix *vels,
+                                        ThreadPool *pool) {
+  JointTrajectory(robot, result, num_steps, internal::JointVelKey, vels, pool);
+}
+
+void DynamicsGraph::jointAccelsTrajectory(const Robot &robot,
+                                          const gtsam::Values &result,
+                                          size_t num_steps,
+                                          gtsam::Matrix *accels,
+                                          ThreadPool *pool) {
+  JointTrajectory(robot, result, num_steps, internal::JointAccelKey, accels,
+                  pool);
+}
+
+void DynamicsGraph::jointTorquesTrajectory(const Robot &robot,
+                                           const gtsam::Values &result,
+                                           size_t num_steps,
+                                           gtsam::Matrix *torques,
+                                           ThreadPool *pool) {
+  JointTrajectory(robot, result, num_steps, internal::TorqueKey, torques,
+                  pool);
+}
+
+gtsam::Matrix DynamicsGraph::jointAnglesTrajectory(const Robot &robot,
+                                                   const gtsam::Values &result,
+                                                   size_t num_steps) {
+  gtsam::Matrix angles;
+  jointAnglesTrajectory(robot, result, num_steps, &angles);
+  return angles;
+}
+
+gtsam::Matrix DynamicsGraph::jointVelsTrajectory(const Robot &robot,
+                                                 const gtsam::Values &result,
+                                                 size_t num_steps) {
+  gtsam::Matrix vels;
+  jointVelsTrajectory(robot, result, num_steps, &vels);
+  return vels;
+}
+
+gtsam::Matrix DynamicsGraph::jointAccelsTrajectory(const Robot &robot,
+                                                   const gtsam::Values &result,
+                                                   size_t num_steps) {
+  gtsam::Matrix accels;
+  jointAccelsTrajectory(robot, result, num_steps, &accels);
+  return accels;
+}
+
+gtsam::Matrix DynamicsGraph::jointTorquesTrajectory(
+    const Robot &robot, const gtsam::Values &result, size_t num_steps) {
+  gtsam::Matrix torques;
+  jointTorquesTrajectory(robot, result, num_steps, &torques);
+  return torques;
+}
+
 JointValueMap DynamicsGraph::jointAccelsMap(const Robot &robot,
                                           const gtsam::Values &result,
                                           const int t) {
@@ -718,17 +1280,40 @@ JointValueMap DynamicsGraph::jointTorquesMap(const Robot &robot,
   return joint_torques;
 }
 
-void printKey(const gtsam::Key &key) {
-  auto symb = DynamicsSymbol(key);
-  std::cout << (std::string)(symb) << "\t";
-}
+namespace {
+// Text buffered in chunks, written to std::cout when full and at the end.
+class BufferedOutput {
+ public:
+  BufferedOutput() { buffer_.reserve(kSize + 256); }
+  ~BufferedOutput() { flush(); }
+
+  void append(const char *begin, const char *end) {
+    buffer_.append(begin, end);
+    if (buffer_.size() >= kSize) flush();
+  }
+  void append(char c) { append(&c, &c + 1); }
+  void appendKey(gtsam::Key key) {
+    char text[DynamicsSymbol::kMaxFormatLength];
+    append(text, DynamicsSymbol::Format(key, text));
+  }
+  void flush() {
+    std::cout.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+ private:
+  static constexpr size_t kSize = 1 << 16;
+  std::string buffer_;
+};
+}  // namespace
 
 // print the factors of the factor graph
 void DynamicsGraph::printValues(const gtsam::Values &values) {
   std::cout << "values:\n";
   for (auto &key : values.keys()) {
-    printKey(key);
-    std::cout << "\n";
+    char text[DynamicsSymbol::kMaxFormatLength];
+    std::cout.write(text, DynamicsSymbol::Format(key, text) - text);
+    std::cout << "\t\n";
     values.at(key).print();
     std::cout << "\n";
   }
@@ -737,14 +1322,34 @@ void DynamicsGraph::printValues(const gtsam::Values &values) {
 // print the factors of the factor graph
 void DynamicsGraph::printGraph(const gtsam::NonlinearFactorGraph &graph) {
   std::cout << "graph:\n";
+  BufferedOutput out;
   for (auto &factor : graph) {
     for (auto &key : factor->keys()) {
-      printKey(key);
+      out.appendKey(key);
+      out.append('\t');
     }
-    std::cout << "\n";
+    out.append('\n');
   }
 }
 
+void DynamicsGraph::printGraphSummary(
+    const gtsam::NonlinearFactorGraph &graph) {
+  PrintGraphSummary(SummarizeGraph(graph), std::cout);
+}
+
+std::vector<FactorTypeStatistics> DynamicsGraph::factorStatistics(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    size_t repetitions) {
+  return FactorStatistics(graph, values, repetitions);
+}
+
+void DynamicsGraph::printFactorStatistics(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    size_t repetitions) {
+  PrintFactorStatistics(FactorStatistics(graph, values, repetitions),
+                        std::cout);
+}
+
 // using radial location to locate the variables
 gtsam::Vector3 radial_location(double r, double i, int n) {
   double theta = M_PI * 2 / n * i;
@@ -817,20 +1422,18 @@ JsonSaver::LocationType get_locations(const Robot &robot, const int t,
 void DynamicsGraph::saveGraph(const std::string &file_path,
                               const gtsam::NonlinearFactorGraph &graph,
                               const gtsam::Values &values, const Robot &robot,
-                              const int t, bool radial) {
-  std::ofstream json_file;
-  json_file.open(file_path);
+                              const int t, bool radial, GraphFormat format) {
+  std::ofstream json_file(file_path, std::ios::binary);
   JsonSaver::LocationType locations = get_locations(robot, t, radial);
-  JsonSaver::SaveFactorGraph(graph, json_file, values, locations);
+  GraphWriter::Save(graph, json_file, values, locations, format);
   json_file.close();
 }
 
 void DynamicsGraph::saveGraphMultiSteps(
     const std::string &file_path, const gtsam::NonlinearFactorGraph &graph,
     const gtsam::Values &values, const Robot &robot, const int num_steps,
-    bool radial) {
-  std::ofstream json_file;
-  json_file.open(file_path);
+    bool radial, GraphFormat format) {
+  std::ofstream json_file(file_path, std::ios::binary);
   JsonSaver::LocationType locations;
 
   for (int t = 0; t <= num_steps; t++) {
@@ -843,10 +1446,23 @@ void DynamicsGraph::saveGraphMultiSteps(
     locations.insert(locations_t.begin(), locations_t.end());
   }
 
-  JsonSaver::SaveFactorGraph(graph, json_file, values, locations);
+  GraphWriter::Save(graph, json_file, values, locations, format);
   json_file.close();
 }
 
+void DynamicsGraph::saveGraphTiles(const std::string &directory,
+                                   const gtsam::NonlinearFactorGraph &graph,
+                                   const gtsam::Values &values,
+                                   const Robot &robot, size_t window_steps,
+                                   bool radial, GraphFormat format) {
+  GraphTileParameters parameters;
+  parameters.window_steps = window_steps;
+  const GraphTiles tiles(
+      graph, values,
+      [&](size_t t) { return get_locations(robot, t, radial); }, parameters);
+  tiles.save(directory, format);
+}
+
 /* classify the variables into different clusters */
 typedef std::pair<std::string, int> ClusterInfo;
 
@@ -876,11 +1492,14 @@ void DynamicsGraph::saveGraphTraj(const std::string &file_path,
                                   const gtsam::NonlinearFactorGraph &graph,
                                   const gtsam::Values &values,
                                   const int num_steps) {
-  std::map<std::string, gtsam::Values> clustered_values;
+  // Clusters hold keys only: copying the values per cluster dominated the
+  // memory used for long trajectories.
+  std::map<std::string, gtsam::KeyVector> clustered_keys;
   std::map<std::string, gtsam::NonlinearFactorGraph> clustered_graphs;
 
   // cluster the values
-  for (const auto &key : values.keys()) {
+  for (const auto &key_value : values) {
+    const gtsam::Key key = key_value.key;
     ClusterInfo cluster_info = getCluster(key);
     int t = cluster_info.second;
     std::string category = cluster_info.first;
@@ -888,10 +1507,7 @@ void DynamicsGraph::saveGraphTraj(const std::string &file_path,
     if (category == "s") {
       cluster_name = "control";
     }
-    if (clustered_values.find(cluster_name) == clustered_values.end()) {
-      clustered_values[cluster_name] = gtsam::Values();
-    }
-    clustered_values[cluster_name].insert(key, values.at(key));
+    clustered_keys[cluster_name].push_back(key);
   }
 
   // cluster the factors
@@ -961,9 +1577,16 @@ void DynamicsGraph::saveGraphTraj(const std::string &file_path,
   // save to file
   std::ofstream json_file;
   json_file.open(file_path);
-  JsonSaver::SaveClusteredGraph(json_file, clustered_graphs, clustered_values,
+  JsonSaver::SaveClusteredGraph(json_file, clustered_graphs, clustered_keys,
                                 values, locations);
   json_file.close();
 }
 
+void DynamicsGraph::saveTrajectory(const std::string &file_path,
+                                   const Robot &robot,
+                                   const gtsam::Values &values,
+                                   const int num_steps) {
+  TrajectoryFile::Write(file_path, robot, values, num_steps);
+}
+
 }  // namespace gtdynamics
@@ -20,30 +20,45 @@
 #include <boost/optional.hpp>
 #include <cmath>
 #include <iosfwd>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "gtdynamics/dynamics/DynamicsSlice.h"
 #include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/factors/ContactComplementarityFactor.h"
+#include "gtdynamics/factors/TrackingFactors.h"
+#include "gtdynamics/optimizer/BoxBounds.h"
+#include "gtdynamics/optimizer/InequalityConstraint.h"
+#include "gtdynamics/universal_robot/JointParameterBlock.h"
 #include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/universal_robot/SelfCollision.h"
+#include "gtdynamics/utils/DynamicsValues.h"
+#include "gtdynamics/utils/FactorStatistics.h"
+#include "gtdynamics/utils/GraphWriter.h"
 #include "gtdynamics/utils/PointOnLink.h"
+#include "gtdynamics/utils/SignedDistanceField.h"
 
 namespace gtdynamics {
 
+class ThreadPool;
+
 using JointValueMap = std::map<std::string, double>;
 
 /// Shorthand for C_i_c_k, for contact wrench c on i-th link at time step k.
-inline DynamicsSymbol ContactWrenchKey(int i, int c, int k = 0) {
-  return DynamicsSymbol::LinkJointSymbol("C", i, c, k);
+constexpr DynamicsSymbol ContactWrenchKey(int i, int c, int k = 0) {
+  return DynamicsSymbol::LinkJointSymbol('C', i, c, k);
 }
 
 /* Shorthand for dt_k, for duration for timestep dt_k during phase k. */
-inline DynamicsSymbol PhaseKey(int k) {
-  return DynamicsSymbol::SimpleSymbol("dt", k);
+constexpr DynamicsSymbol PhaseKey(int k) {
+  return DynamicsSymbol::SimpleSymbol(DynamicsLabel('d', 't'), k);
 }
 
 /* Shorthand for t_k, time at time step k. */
-inline DynamicsSymbol TimeKey(int k) {
-  return DynamicsSymbol::SimpleSymbol("t", k);
+constexpr DynamicsSymbol TimeKey(int k) {
+  return DynamicsSymbol::SimpleSymbol('t', k);
 }
 
 /** Collocation methods. */
@@ -52,11 +67,47 @@ enum CollocationScheme { Euler, RungeKutta, Trapezoidal, HermiteSimpson };
 /**
  * DynamicsGraph is a class which builds a factor graph to do kinodynamic
  * motion planning
+ *
+ * The settings are fixed at construction and every builder is const without
+ * hidden state: noise models are interned by NoiseModels.h and factor arenas
+ * belong to the graph they were made for. One builder can hence serve many
+ * threads at once, e.g. all the workers of a pool building graphs for
+ * different robots or horizons. A pool passed to a builder is used for its
+ * own loop, so it must not be the pool whose job is calling the builder.
  */
 class DynamicsGraph {
  private:
-  OptimizerSetting opt_;
-  boost::optional<gtsam::Vector3> gravity_, planar_axis_;
+  const OptimizerSetting opt_;
+  const boost::optional<gtsam::Vector3> gravity_, planar_axis_;
+
+  /// Gravity, defaulting to -9.8 along z.
+  gtsam::Vector3 gravity() const {
+    return gravity_ ? *gravity_ : gtsam::Vector3(0, 0, -9.8);
+  }
+
+  /// Arena for the factors of one trajectory graph, null unless enabled.
+  std::shared_ptr<FactorArena> factorArena() const;
+
+  /// @name Factors of one time step, added to a slice at time step 0.
+  /// @{
+  void addQFactors(const Robot &robot,
+                   const boost::optional<PointOnLinks> &contact_points,
+                   DynamicsSlice *slice) const;
+  void addVFactors(const Robot &robot,
+                   const boost::optional<PointOnLinks> &contact_points,
+                   DynamicsSlice *slice) const;
+  void addAFactors(const Robot &robot,
+                   const boost::optional<PointOnLinks> &contact_points,
+                   DynamicsSlice *slice) const;
+  void addDynamicsFactors(const Robot &robot,
+                          const boost::optional<PointOnLinks> &contact_points,
+                          const boost::optional<double> &mu,
+                          DynamicsSlice *slice) const;
+  void addFusedLinkDynamicsFactor(
+      const LinkSharedPtr &link,
+      const boost::optional<PointOnLinks> &contact_points, double mu,
+      const gtsam::Vector3 &gravity, DynamicsSlice *slice) const;
+  /// @}
 
  public:
   /**
@@ -160,6 +211,71 @@ class DynamicsGraph {
       const boost::optional<PointOnLinks> &contact_points = boost::none,
       const boost::optional<double> &mu = boost::none) const;
 
+  /**
+   * Return the factors of dynamicsFactorGraph as a slice, which walks the
+   * robot once and can then be instantiated at any time step.
+   * @param robot          the robot
+   * @param contact_points optional vector of contact points.
+   * @param mu             optional coefficient of static friction.
+   */
+  DynamicsSlice dynamicsSlice(
+      const Robot &robot,
+      const boost::optional<PointOnLinks> &contact_points = boost::none,
+      const boost::optional<double> &mu = boost::none) const;
+
+  /**
+   * Return one slice per distinct set of contact points, in order of first
+   * appearance, so that phases with the same contact pattern, e.g. the
+   * repeated phases of a walk cycle, share one slice.
+   * @param robot          the robot
+   * @param contact_points contact points of each phase
+   * @param mu             optional coefficient of static friction.
+   * @param indices        if given, set to the index of the slice of each
+   *                       entry of contact_points
+   */
+  std::vector<DynamicsSlice> dynamicsSlices(
+      const Robot &robot, const std::vector<PointOnLinks> &contact_points,
+      const boost::optional<double> &mu = boost::none,
+      std::vector<size_t> *indices = nullptr) const;
+
+  /**
+   * Return a contact-implicit dynamics slice: every candidate contact point
+   * gets a contact wrench with friction cone and zero moment factors, as in
+   * dynamicsSlice, but instead of the contact height, twist and acceleration
+   * constraints a ContactComplementarityFactor decides whether it touches the
+   * ground, so one solve finds the contact timing of all steps.
+   * @param robot            the robot
+   * @param candidate_points points that may come into contact
+   * @param complementarity  scheme, relaxation and noise of the
+   *                         complementarity factors
+   * @param mu               optional coefficient of static friction.
+   */
+  DynamicsSlice contactImplicitSlice(
+      const Robot &robot, const PointOnLinks &candidate_points,
+      const ComplementarityParams &complementarity = ComplementarityParams(),
+      const boost::optional<double> &mu = boost::none) const;
+
+  /**
+   * Return nonlinear factor graph of a contact-implicit trajectory, see
+   * contactImplicitSlice. Anneal by solving again with a smaller epsilon,
+   * starting from the previous solution.
+   * @param robot            the robot
+   * @param num_steps        total time steps
+   * @param dt               duration of each time step
+   * @param candidate_points points that may come into contact
+   * @param complementarity  parameters of the complementarity factors
+   * @param collocation      the collocation scheme
+   * @param mu               optional coefficient of static friction
+   * @param pool             optional thread pool
+   */
+  gtsam::NonlinearFactorGraph contactImplicitTrajectoryFG(
+      const Robot &robot, const int num_steps, const double dt,
+      const PointOnLinks &candidate_points,
+      const ComplementarityParams &complementarity = ComplementarityParams(),
+      const CollocationScheme collocation = Trapezoidal,
+      const boost::optional<double> &mu = boost::none,
+      ThreadPool *pool = nullptr) const;
+
   /**
    * Return prior factors of torque, angle, velocity
    * @param robot        the robot
@@ -188,18 +304,40 @@ class DynamicsGraph {
       const Robot &robot, const int num_steps,
       const gtsam::Values &known_values) const;
 
+  /**
+   * @name Known values to fold into a graph
+   * The values forwardDynamicsPriors, inverseDynamicsPriors and
+   * trajectoryFDPriors put priors on, for FoldConstants of FoldedFactor.h:
+   * folding them removes those variables from the optimization instead of
+   * pinning them with tight priors. The arguments are as for the priors.
+   * @{
+   */
+  static gtsam::Values forwardDynamicsConstants(
+      const Robot &robot, const int t, const gtsam::Values &known_values);
+
+  static gtsam::Values inverseDynamicsConstants(
+      const Robot &robot, const int t, const gtsam::Values &known_values);
+
+  static gtsam::Values trajectoryFDConstants(
+      const Robot &robot, const int num_steps,
+      const gtsam::Values &known_values);
+  /// @}
+
   /**
    * Return nonlinear factor graph of the entire trajectory
    * @param robot       the robot
    * @param num_steps   total time steps
    * @param dt          duration of each time step
    * @param collocation the collocation scheme
+   * @param pool        optional thread pool, time steps are then built
+   *                    concurrently (the graph is the same)
    */
   gtsam::NonlinearFactorGraph trajectoryFG(
       const Robot &robot, const int num_steps, const double dt,
       const CollocationScheme collocation = Trapezoidal,
       const boost::optional<PointOnLinks> &contact_points = boost::none,
-      const boost::optional<double> &mu = boost::none) const;
+      const boost::optional<double> &mu = boost::none,
+      ThreadPool *pool = nullptr) const;
 
   /**
    * Return nonlinear factor graph of the entire trajectory for multi-phase
@@ -209,6 +347,8 @@ class DynamicsGraph {
    * @param collocation          the collocation scheme
    * @param phase_contact_points contact points at each phase
    * @param mu                   optional coefficient of static friction
+   * @param pool                 optional thread pool, time steps are then
+   *                             built concurrently (the graph is the same)
    */
   gtsam::NonlinearFactorGraph multiPhaseTrajectoryFG(
       const Robot &robot, const std::vector<int> &phase_steps,
@@ -216,7 +356,8 @@ class DynamicsGraph {
       const CollocationScheme collocation = Trapezoidal,
       const boost::optional<std::vector<PointOnLinks>> &phase_contact_points =
           boost::none,
-      const boost::optional<double> &mu = boost::none) const;
+      const boost::optional<double> &mu = boost::none,
+      ThreadPool *pool = nullptr) const;
 
   /** Add collocation factor for doubles. */
   static void addCollocationFactorDouble(
@@ -234,7 +375,28 @@ class DynamicsGraph {
       const CollocationScheme collocation = Trapezoidal);
 
   /**
-   * Return collocation factors for the specified joint.
+   * Add Hermite-Simpson collocation factor for doubles x with first and
+   * second derivatives v and a. The midpoint of v is eliminated, so it needs
+   * no extra variables, and it is exact for x cubic in time.
+   */
+  static void addHermiteSimpsonCollocationFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key, const double dt,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
+  /** Add Hermite-Simpson collocation factor for doubles, dt as a variable. */
+  static void addMultiPhaseHermiteSimpsonCollocationFactorDouble(
+      gtsam::NonlinearFactorGraph *graph, const gtsam::Key x0_key,
+      const gtsam::Key x1_key, const gtsam::Key v0_key, const gtsam::Key v1_key,
+      const gtsam::Key a0_key, const gtsam::Key a1_key,
+      const gtsam::Key phase_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model);
+
+  /**
+   * Return collocation factors for the specified joint. With HermiteSimpson,
+   * angles use Hermite-Simpson and velocities trapezoidal collocation, which
+   * is consistent with piecewise linear accelerations.
    * @param j           joint index
    * @param t           time step
    * @param dt          time delta
@@ -246,6 +408,7 @@ class DynamicsGraph {
 
   /**
    * Return collocation factors for the specified joint, with dt as a variable.
+   * HermiteSimpson is as in jointCollocationFactors.
    * @param j           joint index
    * @param t           time step
    * @param phase       the phase of the timestamp
@@ -266,6 +429,19 @@ class DynamicsGraph {
       const Robot &robot, const int t, const double dt,
       const CollocationScheme collocation = Trapezoidal) const;
 
+  /**
+   * Return one CollocationBankFactor per joint, with the collocation factors
+   * on angles and velocities from time step t to t + num_steps.
+   * @param robot       the robot
+   * @param t           first time step
+   * @param num_steps   number of steps
+   * @param dt          duration of each timestep
+   * @param collocation collocation scheme chosen
+   */
+  gtsam::NonlinearFactorGraph collocationBankFactors(
+      const Robot &robot, const int t, const int num_steps, const double dt,
+      const CollocationScheme collocation = Trapezoidal) const;
+
   /**
    * Return collocation factors on angles and velocities from time step t to
    * t+1, with dt as a varaible
@@ -286,6 +462,79 @@ class DynamicsGraph {
   gtsam::NonlinearFactorGraph jointLimitFactors(const Robot &robot,
                                                 const int t) const;
 
+  /**
+   * Return joint limit factors that read the limits from shared parameter
+   * blocks, so that JointParameterBlocks::set changes the limits of the
+   * graph without rebuilding it.
+   * @param robot the robot
+   * @param t time step
+   * @param blocks parameters of the joints of `robot`
+   */
+  gtsam::NonlinearFactorGraph jointLimitFactors(
+      const Robot &robot, const int t,
+      const JointParameterBlocks &blocks) const;
+
+  /**
+   * Return the limits of jointLimitFactors as inequality constraints, for
+   * constrained optimizers: value - (lower + threshold) >= 0 and
+   * (upper - threshold) - value >= 0 for angle, velocity, acceleration and
+   * torque of each joint.
+   * @param robot the robot
+   * @param t time step
+   * @param tolerance tolerance of each constraint
+   */
+  InequalityConstraints jointLimitConstraints(const Robot &robot, const int t,
+                                              double tolerance = 1e-3) const;
+
+  /**
+   * Return the limits of jointLimitFactors as box bounds on the angle,
+   * velocity, acceleration and torque of each joint, within the limit
+   * thresholds, for OptimizationParameters::bounds. The bounds replace the
+   * four JointLimitFactors per joint and time step.
+   * @param robot the robot
+   * @param t time step
+   */
+  BoxBounds jointLimitBounds(const Robot &robot, const int t) const;
+
+  /**
+   * Return SDFCollisionFactors keeping the links clear of the environment
+   * by the epsilon of the OptimizerSetting, with cost model sigma obsSigma.
+   * @param robot the robot
+   * @param t time step
+   * @param sdf signed distance field of the environment
+   * @param link_spheres collision spheres of each link, by link name, in the
+   * link's COM frame; see BoundingSpheres and TransformSpheres
+   */
+  gtsam::NonlinearFactorGraph collisionFactors(
+      const Robot &robot, const int t,
+      const boost::shared_ptr<const SignedDistanceField> &sdf,
+      const std::map<std::string, CollisionSpheres> &link_spheres) const;
+
+  /**
+   * Return a SelfCollisionFactor keeping the filtered link pairs of the model
+   * apart by the epsilon of the OptimizerSetting, with cost model sigma
+   * obsSigma; empty if the model has no pairs.
+   * @param model collision spheres and link pairs of the robot
+   * @param t time step
+   */
+  gtsam::NonlinearFactorGraph selfCollisionFactors(
+      const boost::shared_ptr<const SelfCollisionModel> &model,
+      const int t) const;
+
+  /**
+   * Return the friction cones of ContactDynamicsFrictionConeFactor as
+   * inequality constraints mu^2 f_up^2 - |f_tangent|^2 >= 0, with the contact
+   * force rotated into the spatial frame and the up axis taken from gravity.
+   * @param robot the robot
+   * @param t time step
+   * @param contact_points contact points, one per link
+   * @param mu coefficient of static friction
+   * @param tolerance tolerance of each constraint
+   */
+  InequalityConstraints frictionConeConstraints(
+      const Robot &robot, const int t, const PointOnLinks &contact_points,
+      double mu, double tolerance = 1e-3) const;
+
   /**
    * Return goal factors of joint angle
    * @param robot        the robot
@@ -308,6 +557,22 @@ class DynamicsGraph {
       const Robot &robot, const int t, const std::string &link_name,
       const gtsam::Pose3 &target_pose) const;
 
+  /**
+   * Same as targetAngleFactors, but tracking a target that can be changed in
+   * place through the handle, without rebuilding the graph.
+   */
+  gtsam::NonlinearFactorGraph targetAngleFactors(
+      const Robot &robot, const int t, const std::string &joint_name,
+      const TargetHandle<double> &target_angle) const;
+
+  /**
+   * Same as targetPoseFactors, but tracking a target that can be changed in
+   * place through the handle, without rebuilding the graph.
+   */
+  gtsam::NonlinearFactorGraph targetPoseFactors(
+      const Robot &robot, const int t, const std::string &link_name,
+      const TargetHandle<gtsam::Pose3> &target_pose) const;
+
   /**
    * Return the joint accelerations
    * @param robot the robot
@@ -328,6 +593,74 @@ class DynamicsGraph {
   static gtsam::Vector jointTorques(const Robot &robot,
                                     const gtsam::Values &result, const int t);
 
+  /// Return joint accelerations, read from dense storage.
+  static gtsam::Vector jointAccels(const Robot &robot,
+                                   const DynamicsValues &result, const int t);
+
+  /// Return joint velocities, read from dense storage.
+  static gtsam::Vector jointVels(const Robot &robot,
+                                 const DynamicsValues &result, const int t);
+
+  /// Return joint angles, read from dense storage.
+  static gtsam::Vector jointAngles(const Robot &robot,
+                                   const DynamicsValues &result, const int t);
+
+  /// Return joint torques, read from dense storage.
+  static gtsam::Vector jointTorques(const Robot &robot,
+                                    const DynamicsValues &result, const int t);
+
+  /**
+   * Extract the joint angles of a whole trajectory into a num_steps x #joints
+   * matrix, with columns in robot.joints() order. Keys of one joint at
+   * consecutive time steps are adjacent in `result`, so every column is read
+   * with a single lookup followed by a sequential walk. If `pool` is given,
+   * columns and blocks of time steps are filled in parallel.
+   *
+   * @param robot      the robot
+   * @param result     values with joint angles at time steps 0..num_steps-1
+   * @param num_steps  number of time steps
+   * @param angles     output, resized if needed
+   * @param pool       optional thread pool
+   */
+  static void jointAnglesTrajectory(const Robot &robot,
+                                    const gtsam::Values &result,
+                                    size_t num_steps, gtsam::Matrix *angles,
+                                    ThreadPool *pool = nullptr);
+
+  /// Extract the joint velocities of a whole trajectory, as above.
+  static void jointVelsTrajectory(const Robot &robot,
+                                  const gtsam::Values &result,
+                                  size_t num_steps, gtsam::Matrix *vels,
+                                  ThreadPool *pool = nullptr);
+
+  /// Extract the joint accelerations of a whole trajectory, as above.
+  static void jointAccelsTrajectory(const Robot &robot,
+                                    const gtsam::Values &result,
+                                    size_t num_steps, gtsam::Matrix *accels,
+                                    ThreadPool *pool = nullptr);
+
+  /// Extract the joint torques of a whole trajectory, as above.
+  static void jointTorquesTrajectory(const Robot &robot,
+                                     const gtsam::Values &result,
+                                     size_t num_steps, gtsam::Matrix *torques,
+                                     ThreadPool *pool = nullptr);
+
+  /// @name Trajectories returned by value, e.g. as numpy arrays in Python.
+  /// @{
+  static gtsam::Matrix jointAnglesTrajectory(const Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps);
+  static gtsam::Matrix jointVelsTrajectory(const Robot &robot,
+                                           const gtsam::Values &result,
+                                           size_t num_steps);
+  static gtsam::Matrix jointAccelsTrajectory(const Robot &robot,
+                                             const gtsam::Values &result,
+                                             size_t num_steps);
+  static gtsam::Matrix jointTorquesTrajectory(const Robot &robot,
+                                              const gtsam::Values &result,
+                                              size_t num_steps);
+  /// @}
+
   /**
    * Return the joint accelerations as std::map<name, acceleration>
    * @param robot the robot
@@ -349,12 +682,31 @@ class DynamicsGraph {
                                        const gtsam::Values &result,
                                        const int t);
 
-  /// Print the factors of the factor graph
+  /// Print the keys of each factor of the factor graph
   static void printGraph(const gtsam::NonlinearFactorGraph &graph);
 
+  /**
+   * Print counts of the factors per type and of the keys per family, which
+   * scales to graphs of any size. See SummarizeGraph.
+   */
+  static void printGraphSummary(const gtsam::NonlinearFactorGraph &graph);
+
   /// Print the values
   static void printValues(const gtsam::Values &values);
 
+  /**
+   * Total error, count and linearization time of the factors in `graph`, by
+   * factor type, evaluated at `values`. See FactorStatistics.
+   */
+  static std::vector<FactorTypeStatistics> factorStatistics(
+      const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+      size_t repetitions = 1);
+
+  /// Print the factorStatistics of the graph as a table.
+  static void printFactorStatistics(const gtsam::NonlinearFactorGraph &graph,
+                                    const gtsam::Values &values,
+                                    size_t repetitions = 1);
+
   /**
    * Save factor graph in json format for visualization
    * @param file_path path of the json file to store the graph
@@ -363,11 +715,13 @@ class DynamicsGraph {
    * @param robot     the robot
    * @param t         time step
    * @param radial    option to display in radial format
+   * @param format    JSON, or the binary format of GraphWriter
    */
   static void saveGraph(const std::string &file_path,
                         const gtsam::NonlinearFactorGraph &graph,
                         const gtsam::Values &values, const Robot &robot,
-                        const int t, bool radial = false);
+                        const int t, bool radial = false,
+                        GraphFormat format = GraphFormat::Json);
 
   /**
    * Save factor graph of multiple time steps in json format
@@ -377,12 +731,32 @@ class DynamicsGraph {
    * @param robot     the robot
    * @param num_steps number of time steps
    * @param radial    option to display in radial format
+   * @param format    JSON, or the binary format of GraphWriter
    */
   static void saveGraphMultiSteps(const std::string &file_path,
                                   const gtsam::NonlinearFactorGraph &graph,
                                   const gtsam::Values &values,
                                   const Robot &robot, const int num_steps,
-                                  bool radial = false);
+                                  bool radial = false,
+                                  GraphFormat format = GraphFormat::Json);
+
+  /**
+   * Save factor graph of multiple time steps into `directory` as windows of
+   * `window_steps` steps and a manifest, see GraphTiles, laid out as in
+   * saveGraphMultiSteps, so the visualizer can load only some windows.
+   * @param directory     existing directory to store the files
+   * @param graph         factor graph
+   * @param values        values of variables in factor graph
+   * @param robot         the robot
+   * @param window_steps  number of time steps per window
+   * @param radial        option to display in radial format
+   * @param format        JSON, or the binary format of GraphWriter
+   */
+  static void saveGraphTiles(const std::string &directory,
+                             const gtsam::NonlinearFactorGraph &graph,
+                             const gtsam::Values &values, const Robot &robot,
+                             size_t window_steps = 10, bool radial = false,
+                             GraphFormat format = GraphFormat::Json);
 
   /**
    * Save factor graph of trajectory in json format
@@ -397,6 +771,18 @@ class DynamicsGraph {
                             const gtsam::NonlinearFactorGraph &graph,
                             const gtsam::Values &values, const int num_steps);
 
+  /**
+   * Save the joint and link values of a trajectory in the memory-mapped
+   * columnar format of TrajectoryFile, for large datasets.
+   * @param file_path path of the file to store the trajectory
+   * @param robot     the robot
+   * @param values    values of the trajectory
+   * @param num_steps number of time steps
+   */
+  static void saveTrajectory(const std::string &file_path, const Robot &robot,
+                             const gtsam::Values &values,
+                             const int num_steps);
+
   /// Return the optimizer setting.
   const OptimizerSetting &opt() const { return opt_; }
 };
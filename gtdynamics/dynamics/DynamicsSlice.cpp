@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsSlice.cpp
+ * @brief Factors of one time step, built once and instantiated at any step.
+ */
+
+#include "gtdynamics/dynamics/DynamicsSlice.h"
+
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+void DynamicsSlice::addShifted(
+    const gtsam::NonlinearFactor::shared_ptr &factor) {
+  factors_.push_back(factor);
+  makers_.emplace_back();
+  copiers_.push_back(nullptr);
+}
+
+/* ************************************************************************* */
+void DynamicsSlice::addMaker(const Maker &maker) {
+  factors_.emplace_back();
+  makers_.push_back(maker);
+  copiers_.push_back(nullptr);
+}
+
+/* ************************************************************************* */
+void DynamicsSlice::instantiate(
+    int t, NonlinearFactorGraph *graph,
+    const std::shared_ptr<FactorArena> &arena) const {
+  graph->reserve(graph->size() + factors_.size());
+  KeyVector keys;
+  for (size_t f = 0; f < factors_.size(); ++f) {
+    const auto &factor = factors_[f];
+    if (!factor) {
+      graph->push_back(makers_[f](t));
+    } else if (t == 0) {
+      // Factors are immutable once in a graph, so step 0 can share them.
+      graph->push_back(factor);
+    } else {
+      keys = factor->keys();
+      for (auto &key : keys) key += t;
+      if (arena && copiers_[f]) {
+        auto copy = copiers_[f](*factor, arena);
+        copy->keys() = keys;
+        graph->push_back(copy);
+      } else {
+        graph->push_back(factor->rekey(keys));
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph DynamicsSlice::instantiate(int t) const {
+  NonlinearFactorGraph graph;
+  instantiate(t, &graph);
+  return graph;
+}
+
+}  // namespace gtdynamics
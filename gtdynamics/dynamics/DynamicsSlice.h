@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsSlice.h
+ * @brief Factors of one time step, built once and instantiated at any step.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "gtdynamics/utils/FactorArena.h"
+
+namespace gtdynamics {
+
+/**
+ * DynamicsSlice holds the factors of one time step of a dynamics graph, so
+ * that a trajectory graph walks the robot once and then stamps out a copy of
+ * the slice for every time step.
+ *
+ * Factors whose keys are plain DynamicsSymbols are stored at time step 0 and
+ * copied with their keys shifted, since the time index occupies the low bits
+ * of a DynamicsSymbol. Expression factors keep their keys in the leaves of the
+ * expression tree and cannot be re-keyed; those are stored as makers, which
+ * build the factor for a given time step from whatever was gathered when the
+ * slice was built.
+ *
+ * Re-keyed copies can be made in a FactorArena instead of on the heap, for
+ * factors added with their concrete type, see addShifted.
+ */
+class DynamicsSlice {
+ public:
+  /// Function returning the factor at time step t.
+  using Maker = std::function<gtsam::NonlinearFactor::shared_ptr(int t)>;
+
+  /**
+   * Add a factor at time step 0, to be re-keyed for other steps. All its keys
+   * must carry time index 0, and the factor must implement clone().
+   */
+  void addShifted(const gtsam::NonlinearFactor::shared_ptr &factor);
+
+  /**
+   * Add a factor of concrete type FACTOR at time step 0, as above. The copies
+   * for other steps are made in the arena passed to instantiate, if any, so
+   * FACTOR must be the dynamic type of the factor.
+   */
+  template <class FACTOR>
+  typename std::enable_if<!std::is_abstract<FACTOR>::value>::type addShifted(
+      const boost::shared_ptr<FACTOR> &factor) {
+    factors_.push_back(factor);
+    makers_.emplace_back();
+    copiers_.push_back(&Copy<FACTOR>);
+  }
+
+  /// Add a factor that is made anew for every time step.
+  void addMaker(const Maker &maker);
+
+  /// Number of factors in one time step.
+  size_t size() const { return factors_.size(); }
+
+  /**
+   * Add the factors at time step t to `graph`, in the order they were added.
+   * With an arena, the re-keyed copies of factors added with their concrete
+   * type are allocated in it.
+   */
+  void instantiate(
+      int t, gtsam::NonlinearFactorGraph *graph,
+      const std::shared_ptr<FactorArena> &arena = nullptr) const;
+
+  /// Return the factors at time step t.
+  gtsam::NonlinearFactorGraph instantiate(int t) const;
+
+ private:
+  // One entry per factor: a step-0 factor to re-key, or null and a maker.
+  std::vector<gtsam::NonlinearFactor::shared_ptr> factors_;
+  std::vector<Maker> makers_;
+
+  // Copy in an arena, or null to use clone().
+  using Copier = gtsam::NonlinearFactor::shared_ptr (*)(
+      const gtsam::NonlinearFactor &, const std::shared_ptr<FactorArena> &);
+  std::vector<Copier> copiers_;
+
+  template <class FACTOR>
+  static gtsam::NonlinearFactor::shared_ptr Copy(
+      const gtsam::NonlinearFactor &factor,
+      const std::shared_ptr<FactorArena> &arena) {
+    return MakeShared<FACTOR>(arena, static_cast<const FACTOR &>(factor));
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,211 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ILQR.cpp
+ * @brief Iterative LQR trajectory optimization on the recursive dynamics.
+ */
+
+#include "gtdynamics/dynamics/ILQR.h"
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+// Diagonal weights of size n, all ones if not given.
+static Vector Weights(const Vector &weights, size_t n, const char *name) {
+  if (weights.size() == 0) return Vector::Ones(n);
+  if (size_t(weights.size()) != n)
+    throw std::invalid_argument(std::string("ILQR: ") + name +
+                                " should have one entry per joint id, for "
+                                "the angles and then the velocities in the "
+                                "state weights.");
+  return weights;
+}
+
+/* ************************************************************************* */
+ILQR::ILQR(const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+           const ILQRParameters &parameters)
+    : dynamics_(robot, gravity), p_(parameters) {
+  const CompiledRobot &compiled = dynamics_.compiledRobot();
+  if (compiled.hasFloatingRoot())
+    throw std::invalid_argument(
+        "ILQR: the roots of the robot should be fixed links.");
+  n_ = compiled.numJointSlots();
+  Q_ = Weights(p_.state_weights, 2 * n_, "state_weights");
+  Qf_ = Weights(p_.terminal_weights, 2 * n_, "terminal_weights");
+  R_ = Weights(p_.control_weights, n_, "control_weights");
+  dynamics_.allocate(&result_);
+}
+
+/* ************************************************************************* */
+Vector ILQR::step(const Vector &x, const Vector &u, Matrix *fx,
+                  Matrix *fu) const {
+  const double dt = p_.dt;
+  const Vector q = x.head(n_), v = x.tail(n_);
+  Vector x_next(2 * n_);
+  if (fx) {
+    Matrix a_q, a_v, a_u;
+    dynamics_.forwardDynamicsDerivatives(q, v, u, &result_, &a_q, &a_v, &a_u);
+    const Matrix I = Matrix::Identity(n_, n_);
+    fx->resize(2 * n_, 2 * n_);
+    fx->topLeftCorner(n_, n_) = I + 0.5 * dt * dt * a_q;
+    fx->topRightCorner(n_, n_) = dt * I + 0.5 * dt * dt * a_v;
+    fx->bottomLeftCorner(n_, n_) = dt * a_q;
+    fx->bottomRightCorner(n_, n_) = I + dt * a_v;
+    fu->resize(2 * n_, n_);
+    fu->topRows(n_) = 0.5 * dt * dt * a_u;
+    fu->bottomRows(n_) = dt * a_u;
+  } else {
+    dynamics_.forwardDynamics(q, v, u, &result_);
+  }
+  const Vector &a = result_.joint_accels;
+  x_next << q + dt * v + 0.5 * dt * dt * a, v + dt * a;
+  return x_next;
+}
+
+/* ************************************************************************* */
+double ILQR::rollout(const Vector &x0, const Vector &x_goal,
+                     std::vector<Vector> *u, std::vector<Vector> *x,
+                     const Trajectory *feedback) const {
+  x->resize(u->size() + 1);
+  (*x)[0] = x0;
+  double cost = 0;
+  for (size_t t = 0; t < u->size(); ++t) {
+    Vector &u_t = (*u)[t];
+    if (feedback)
+      u_t = feedback->u[t] + feedback->alpha * feedback->k[t] +
+            feedback->K[t] * ((*x)[t] - feedback->x[t]);
+    const Vector e = (*x)[t] - x_goal;
+    cost += 0.5 * (e.dot(Q_.cwiseProduct(e)) + u_t.dot(R_.cwiseProduct(u_t)));
+    (*x)[t + 1] = step((*x)[t], u_t);
+  }
+  const Vector e = x->back() - x_goal;
+  return cost + 0.5 * e.dot(Qf_.cwiseProduct(e));
+}
+
+/* ************************************************************************* */
+ILQRResult ILQR::optimize(const Vector &q0, const Vector &v0,
+                          const Vector &q_goal, const Vector &v_goal,
+                          const std::vector<Vector> &initial_torques) const {
+  for (auto &&x : {&q0, &v0, &q_goal, &v_goal})
+    if (size_t(x->size()) != n_)
+      throw std::invalid_argument(
+          "ILQR: states should have one entry per joint id.");
+  for (auto &&u : initial_torques)
+    if (size_t(u.size()) != n_)
+      throw std::invalid_argument(
+          "ILQR: torques should have one entry per joint id.");
+
+  const size_t T = initial_torques.size();
+  Vector x0(2 * n_), x_goal(2 * n_);
+  x0 << q0, v0;
+  x_goal << q_goal, v_goal;
+
+  std::vector<Vector> u = initial_torques, x, x_new, u_new(T);
+  std::vector<Vector> k(T);
+  std::vector<Matrix> K(T), fx(T), fu(T);
+  double cost = rollout(x0, x_goal, &u, &x);
+  double mu = p_.regularization;
+
+  ILQRResult result;
+  for (result.iterations = 0; result.iterations < p_.max_iterations;) {
+    ++result.iterations;
+    for (size_t t = 0; t < T; ++t) step(x[t], u[t], &fx[t], &fu[t]);
+
+    // Backward pass, with more regularization until Q_uu is positive.
+    double expected_decrease = 0;
+    bool success = false;
+    while (!success && mu <= p_.max_regularization) {
+      Vector Vx = Qf_.cwiseProduct(x[T] - x_goal);
+      Matrix Vxx = Qf_.asDiagonal();
+      expected_decrease = 0;
+      success = true;
+      for (size_t t = T; t-- > 0;) {
+        const Matrix VxxA = Vxx * fx[t], VxxB = Vxx * fu[t];
+        const Vector Qx = Q_.cwiseProduct(x[t] - x_goal) +
+                          fx[t].transpose() * Vx;
+        const Vector Qu = R_.cwiseProduct(u[t]) + fu[t].transpose() * Vx;
+        Matrix Qxx = fx[t].transpose() * VxxA;
+        Qxx.diagonal() += Q_;
+        Matrix Quu = fu[t].transpose() * VxxB;
+        Quu.diagonal() += R_;
+        const Matrix Qux = fu[t].transpose() * VxxA;
+
+        Matrix Quu_reg = Quu;
+        Quu_reg.diagonal().array() += mu;
+        const Eigen::LLT<Matrix> llt(Quu_reg);
+        if (llt.info() != Eigen::Success) {
+          success = false;
+          mu *= 10;
+          break;
+        }
+        k[t] = -llt.solve(Qu);
+        K[t] = -llt.solve(Qux);
+        expected_decrease -= k[t].dot(Qu) + 0.5 * k[t].dot(Quu * k[t]);
+
+        Vx = Qx + K[t].transpose() * (Quu * k[t] + Qu) +
+             Qux.transpose() * k[t];
+        Vxx = Qxx + K[t].transpose() * (Quu * K[t] + Qux) +
+              Qux.transpose() * K[t];
+        Vxx = 0.5 * (Vxx + Vxx.transpose()).eval();
+      }
+    }
+    if (!success) break;
+    if (expected_decrease <= p_.tolerance * cost) {
+      result.converged = true;
+      break;
+    }
+
+    // Forward pass, backtracking on the feedforward torques.
+    bool accepted = false;
+    double new_cost = cost;
+    for (double alpha = 1.0; alpha > 1e-4; alpha *= 0.5) {
+      const Trajectory feedback{x, u, k, K, alpha};
+      new_cost = rollout(x0, x_goal, &u_new, &x_new, &feedback);
+      const double decrease = cost - new_cost;
+      if (decrease > 0 &&
+          decrease >= 1e-4 * alpha * std::max(expected_decrease, 0.0)) {
+        accepted = true;
+        break;
+      }
+    }
+
+    if (!accepted) {
+      mu *= 10;
+      if (mu > p_.max_regularization) break;
+      continue;
+    }
+    const double decrease = cost - new_cost;
+    u.swap(u_new);
+    x.swap(x_new);
+    cost = new_cost;
+    mu = std::max(mu / 10, p_.regularization);
+    if (decrease <= p_.tolerance * cost) {
+      result.converged = true;
+      break;
+    }
+  }
+
+  result.tau = u;
+  result.K = K;
+  result.cost = cost;
+  for (auto &&state : x) {
+    result.q.push_back(state.head(n_));
+    result.v.push_back(state.tail(n_));
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
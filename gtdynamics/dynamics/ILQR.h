@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ILQR.h
+ * @brief Iterative LQR trajectory optimization on the recursive dynamics.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * Parameters of ILQR. Weights are the diagonals of the cost matrices, on
+ * joint-id indexed vectors: angles then velocities for the state weights.
+ * Empty weights are all ones.
+ */
+struct ILQRParameters {
+  double dt = 0.01;                 ///< duration of each time step
+  gtsam::Vector state_weights;      ///< Q, on the distance to the goal
+  gtsam::Vector terminal_weights;   ///< Q_f, on the final distance
+  gtsam::Vector control_weights;    ///< R, on the torques
+  size_t max_iterations = 100;
+  double tolerance = 1e-6;          ///< relative decrease of the cost
+  double regularization = 1e-6;     ///< initial, added to the diagonal of Q_uu
+  double max_regularization = 1e10;  ///< give up above this
+};
+
+/// Trajectory found by ILQR, with joint-id indexed vectors.
+struct ILQRResult {
+  std::vector<gtsam::Vector> q, v;  ///< angles and velocities, T + 1 steps
+  std::vector<gtsam::Vector> tau;   ///< torques, T steps
+  /// Feedback gains of the last backward pass, for the torques
+  /// tau_t + K_t ((q, v) - (q_t, v_t)) near the trajectory.
+  std::vector<gtsam::Matrix> K;
+  double cost = 0;
+  size_t iterations = 0;
+  bool converged = false;
+};
+
+/**
+ * ILQR optimizes the torques of a fixed-base robot to reach a goal state,
+ * minimizing
+ *
+ *   sum_t 1/2 |x_t - x_g|^2_Q + 1/2 |tau_t|^2_R + 1/2 |x_T - x_g|^2_Qf,
+ *
+ * with x = (q, v) and the dynamics of RecursiveDynamics integrated as the
+ * Simulator does by default: v' = v + a dt, q' = q + v dt + a dt^2 / 2. The
+ * dynamics are linearized with the analytic derivatives of
+ * RecursiveDynamics::forwardDynamicsDerivatives; the backward pass is
+ * regularized Levenberg-Marquardt style, and the forward pass is a
+ * backtracking line search on the feedforward torques.
+ */
+class ILQR {
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot, a tree whose roots are fixed links
+   * @param gravity     gravity vector
+   * @param parameters  time step, cost weights and stopping criteria
+   */
+  ILQR(const Robot &robot,
+       const boost::optional<gtsam::Vector3> &gravity = boost::none,
+       const ILQRParameters &parameters = ILQRParameters());
+
+  /**
+   * Optimize a trajectory.
+   * @param q0, v0           initial joint angles and velocities
+   * @param q_goal, v_goal   goal joint angles and velocities
+   * @param initial_torques  initial guess, one vector per time step
+   */
+  ILQRResult optimize(const gtsam::Vector &q0, const gtsam::Vector &v0,
+                      const gtsam::Vector &q_goal,
+                      const gtsam::Vector &v_goal,
+                      const std::vector<gtsam::Vector> &initial_torques) const;
+
+  /// Number of entries in joint-id indexed vectors.
+  size_t jointSlots() const { return n_; }
+
+ private:
+  // A trajectory and the step of a backward pass, for the forward pass
+  // u_t + alpha k_t + K_t (x - x_t).
+  struct Trajectory {
+    const std::vector<gtsam::Vector> &x, &u, &k;
+    const std::vector<gtsam::Matrix> &K;
+    double alpha;
+  };
+
+  // Roll out torques u from x0 into states x, return the cost. With
+  // feedback, the torques are computed from it along the way.
+  double rollout(const gtsam::Vector &x0, const gtsam::Vector &x_goal,
+                 std::vector<gtsam::Vector> *u, std::vector<gtsam::Vector> *x,
+                 const Trajectory *feedback = nullptr) const;
+
+  // Next state and, if fx is given, the Jacobians of one step.
+  gtsam::Vector step(const gtsam::Vector &x, const gtsam::Vector &u,
+                     gtsam::Matrix *fx = nullptr,
+                     gtsam::Matrix *fu = nullptr) const;
+
+  RecursiveDynamics dynamics_;
+  ILQRParameters p_;
+  size_t n_;
+  gtsam::Vector Q_, Qf_, R_;
+  mutable RecursiveDynamicsResult result_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,244 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialRegressor.cpp
+ * @brief Joint torques as linear functions of the inertial parameters.
+ */
+
+#include "gtdynamics/dynamics/InertialRegressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// Samples per job, as in BatchInverseDynamics.
+constexpr size_t kBlockSize = 256;
+
+using LinkRegressor = Eigen::Matrix<double, 6, 10>;
+
+// Phi(x) with G x = Phi(x) pi_i, for twists x = (w, v) and the spatial
+// inertia G = [I, m [c]; m [c]', m I] of parameters pi_i.
+LinkRegressor InertiaRegressor(const Vector6 &x) {
+  const double wx = x(0), wy = x(1), wz = x(2);
+  const double vx = x(3), vy = x(4), vz = x(5);
+  LinkRegressor phi;
+  // Angular part I w + (m c) x v, linear part m v + w x (m c).
+  phi << 0, 0, vz, -vy, wx, wy, wz, 0, 0, 0,   //
+      0, -vz, 0, vx, 0, wx, 0, wy, wz, 0,      //
+      0, vy, -vx, 0, 0, 0, wx, 0, wy, wz,      //
+      vx, 0, -wz, wy, 0, 0, 0, 0, 0, 0,        //
+      vy, wz, 0, -wx, 0, 0, 0, 0, 0, 0,        //
+      vz, -wy, wx, 0, 0, 0, 0, 0, 0, 0;
+  return phi;
+}
+}  // namespace
+
+/* ************************************************************************* */
+InertialRegressor::InertialRegressor(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : dynamics_(robot, gravity), gravity_(gravity) {
+  if (this->robot().hasFloatingRoot())
+    throw std::invalid_argument(
+        "InertialRegressor: all roots need to be fixed links.");
+  dynamics_.allocate(&result_);
+  X_.resize(this->robot().numNodes());
+}
+
+/* ************************************************************************* */
+Vector InertialRegressor::parameters() const {
+  Vector pi = Vector::Zero(numParameters());
+  for (const int i : robot().linkIds()) {
+    const gtsam::Matrix3 I = robot().inertias()[i].topLeftCorner<3, 3>();
+    auto pi_i = pi.segment<kParametersPerLink>(kParametersPerLink * i);
+    pi_i(0) = robot().masses()(i);
+    pi_i.tail<6>() << I(0, 0), I(0, 1), I(0, 2), I(1, 1), I(1, 2), I(2, 2);
+  }
+  return pi;
+}
+
+/* ************************************************************************* */
+void InertialRegressor::compute(const Vector &q, const Vector &v,
+                                const Vector &a, Matrix *Y) const {
+  const CompiledRobot &robot = this->robot();
+  const size_t N = robot.numNodes();
+  const auto &link_ids = robot.linkIds();
+  const auto &parents = robot.parentNodes();
+  const auto &joint_ids = robot.jointIds();
+  const Matrix &screw_axes = robot.screwAxes();
+
+  // Poses, twists and twist accelerations of all links.
+  dynamics_.inverseDynamics(q, v, a, &result_);
+  for (size_t n = 0; n < N; ++n) {
+    if (parents[n] < 0) continue;
+    const Pose3 &wTi = result_.poses[link_ids[n]];
+    const Pose3 &wTp = result_.poses[link_ids[parents[n]]];
+    X_[n] = wTi.between(wTp).AdjointMap();
+  }
+
+  if (size_t(Y->rows()) != numJointSlots() ||
+      size_t(Y->cols()) != numParameters())
+    Y->resize(numJointSlots(), numParameters());
+  Y->setZero();
+  for (size_t n = 0; n < N; ++n) {
+    if (parents[n] < 0) continue;  // fixed roots carry no joint
+    const int i = link_ids[n];
+
+    // Wrench of the link, F_i = G (A_i - g_i) - ad(V_i)' G V_i, which is
+    // Z pi_i. Gravity acts like an acceleration of the frame.
+    const Vector6 V = result_.twists.col(i);
+    Vector6 A = result_.twist_accels.col(i);
+    if (gravity_)
+      A.tail<3>() -= result_.poses[i].rotation().transpose() * (*gravity_);
+    LinkRegressor Z = InertiaRegressor(A) -
+                      Pose3::adjointMap(V).transpose() * InertiaRegressor(V);
+
+    // Its contribution to the torques of the joints of all ancestors.
+    for (size_t m = n;;) {
+      const int j = joint_ids[m];
+      Y->block<1, kParametersPerLink>(j, kParametersPerLink * i) =
+          screw_axes.col(m).transpose() * Z;
+      if (parents[parents[m]] < 0) break;
+      Z = X_[m].transpose() * Z;
+      m = parents[m];
+    }
+  }
+}
+
+/* ************************************************************************* */
+void InertialIdentification::Worker::add() {
+  regressor.compute(q, v, a, &Y);
+  normal_matrix.selfadjointView<Eigen::Lower>().rankUpdate(Y.transpose());
+  normal_vector.noalias() += Y.transpose() * tau;
+  torque_squares += tau.squaredNorm();
+}
+
+/* ************************************************************************* */
+InertialIdentification::InertialIdentification(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    size_t num_threads)
+    : pool_(num_threads) {
+  for (size_t w = 0; w < pool_.numThreads(); ++w)
+    workers_.emplace_back(new Worker(robot, gravity));
+  const InertialRegressor &regressor = workers_.front()->regressor;
+  num_joint_slots_ = regressor.numJointSlots();
+  const size_t P = regressor.numParameters();
+  normal_matrix_.setZero(P, P);
+  normal_vector_.setZero(P);
+  for (auto &&worker : workers_) {
+    worker->normal_matrix.setZero(P, P);
+    worker->normal_vector.setZero(P);
+  }
+}
+
+/* ************************************************************************* */
+void InertialIdentification::collect() {
+  for (auto &&worker : workers_) {
+    normal_matrix_ +=
+        Matrix(worker->normal_matrix.selfadjointView<Eigen::Lower>());
+    normal_vector_ += worker->normal_vector;
+    torque_squares_ += worker->torque_squares;
+    worker->normal_matrix.setZero();
+    worker->normal_vector.setZero();
+    worker->torque_squares = 0;
+  }
+}
+
+/* ************************************************************************* */
+void InertialIdentification::add(const Vector &q, const Vector &v,
+                                 const Vector &a, const Vector &tau) {
+  const size_t J = num_joint_slots_;
+  if (size_t(q.size()) != J || size_t(v.size()) != J ||
+      size_t(a.size()) != J || size_t(tau.size()) != J)
+    throw std::invalid_argument(
+        "InertialIdentification: samples need one entry per joint slot.");
+  Worker &worker = *workers_.front();
+  worker.q = q;
+  worker.v = v;
+  worker.a = a;
+  worker.tau = tau;
+  worker.add();
+  collect();
+  ++num_samples_;
+}
+
+/* ************************************************************************* */
+void InertialIdentification::addTrajectory(const Matrix &Q, const Matrix &V,
+                                           const Matrix &A,
+                                           const Matrix &Tau) {
+  const size_t J = num_joint_slots_;
+  if (size_t(Q.cols()) != J || size_t(V.cols()) != J ||
+      size_t(A.cols()) != J || size_t(Tau.cols()) != J ||
+      V.rows() != Q.rows() || A.rows() != Q.rows() || Tau.rows() != Q.rows())
+    throw std::invalid_argument(
+        "InertialIdentification: trajectories need one row per sample and "
+        "one column per joint slot.");
+
+  const size_t T = Q.rows();
+  const size_t num_blocks = (T + kBlockSize - 1) / kBlockSize;
+  pool_.parallelFor(num_blocks, [&](size_t b, size_t w) {
+    Worker &worker = *workers_[w];
+    const size_t end = std::min(T, (b + 1) * kBlockSize);
+    for (size_t k = b * kBlockSize; k < end; ++k) {
+      worker.q = Q.row(k).transpose();
+      worker.v = V.row(k).transpose();
+      worker.a = A.row(k).transpose();
+      worker.tau = Tau.row(k).transpose();
+      worker.add();
+    }
+  });
+  collect();
+  num_samples_ += T;
+}
+
+/* ************************************************************************* */
+void InertialIdentification::merge(const InertialIdentification &other) {
+  if (other.numParameters() != numParameters())
+    throw std::invalid_argument(
+        "InertialIdentification::merge: different robots.");
+  normal_matrix_ += other.normal_matrix_;
+  normal_vector_ += other.normal_vector_;
+  torque_squares_ += other.torque_squares_;
+  num_samples_ += other.num_samples_;
+}
+
+/* ************************************************************************* */
+Vector InertialIdentification::solve(
+    double damping, const boost::optional<Vector> &prior) const {
+  if (damping <= 0)
+    throw std::invalid_argument(
+        "InertialIdentification::solve: damping should be positive.");
+  const size_t P = numParameters();
+  if (prior && size_t(prior->size()) != P)
+    throw std::invalid_argument(
+        "InertialIdentification::solve: the prior needs one entry per "
+        "parameter.");
+  Matrix H = normal_matrix_;
+  H.diagonal().array() += damping;
+  Vector b = normal_vector_;
+  if (prior) b += damping * (*prior);
+  return H.ldlt().solve(b);
+}
+
+/* ************************************************************************* */
+double InertialIdentification::rmsResidual(const Vector &parameters) const {
+  if (num_samples_ == 0) return 0.0;
+  // |Y pi - tau|^2 = pi'Y'Y pi - 2 pi'Y'tau + tau'tau.
+  const double squares = parameters.dot(normal_matrix_ * parameters) -
+                         2 * parameters.dot(normal_vector_) + torque_squares_;
+  return std::sqrt(std::max(squares, 0.0) / (num_samples_ * num_joint_slots_));
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,200 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InertialRegressor.h
+ * @brief Joint torques as linear functions of the inertial parameters.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * InertialRegressor computes the regressor Y(q, v, a) of a robot, the matrix
+ * with tau = Y pi for the inverse dynamics torques tau and the inertial
+ * parameters pi of all links, in which the dynamics are linear.
+ *
+ * Every link has 10 parameters, in its CoM frame of the Robot:
+ *
+ *     pi_i = [m, m c_x, m c_y, m c_z, I_xx, I_xy, I_xz, I_yy, I_yz, I_zz]
+ *
+ * with m the mass, c the center of mass and I the rotational inertia about
+ * the frame origin, so the parameters of the Robot itself have c = 0, see
+ * parameters(). Columns 10 i .. 10 i + 9 of Y belong to the link with id i
+ * and row j to the joint with id j.
+ *
+ * Y is found recursively, as recursive Newton-Euler finds tau: the wrench of
+ * each link is linear in its parameters, and is moved inward to the joints
+ * of all its ancestors, in O(n d) for n links at depth d. Only robots whose
+ * roots are all fixed links are supported. An instance keeps scratch space,
+ * so it should not be shared between threads.
+ */
+class InertialRegressor {
+ public:
+  /// Number of inertial parameters of each link.
+  static constexpr size_t kParametersPerLink = 10;
+
+  /**
+   * Constructor
+   *
+   * @param robot    the robot, needs to have a tree structure and fixed roots
+   * @param gravity  gravity vector
+   */
+  explicit InertialRegressor(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Number of joint slots, i.e., rows of the regressor.
+  size_t numJointSlots() const { return robot().numJointSlots(); }
+
+  /// Number of parameters, 10 per link slot, i.e., columns of the regressor.
+  size_t numParameters() const {
+    return kParametersPerLink * robot().numLinkSlots();
+  }
+
+  /// Inertial parameters of the links of the robot, see above.
+  gtsam::Vector parameters() const;
+
+  /**
+   * Regressor at a state, on joint-id indexed arrays; `Y` is resized only if
+   * its size differs.
+   * @param q  joint angles
+   * @param v  joint velocities
+   * @param a  joint accelerations
+   * @param Y  #joint slots x numParameters() regressor
+   */
+  void compute(const gtsam::Vector &q, const gtsam::Vector &v,
+               const gtsam::Vector &a, gtsam::Matrix *Y) const;
+
+  /// Regressor at a state, see compute.
+  gtsam::Matrix regressor(const gtsam::Vector &q, const gtsam::Vector &v,
+                          const gtsam::Vector &a) const {
+    gtsam::Matrix Y;
+    compute(q, v, a, &Y);
+    return Y;
+  }
+
+ private:
+  using LinkRegressor = Eigen::Matrix<double, 6, 10>;
+
+  const CompiledRobot &robot() const { return dynamics_.compiledRobot(); }
+
+  RecursiveDynamics dynamics_;
+  boost::optional<gtsam::Vector3> gravity_;
+  mutable RecursiveDynamicsResult result_;
+  mutable CompiledRobot::Matrix6s X_;  // Ad(T_cp) of each node
+};
+
+/**
+ * Least-squares identification of inertial parameters from logged motions,
+ * min |Y pi - tau|^2 over all samples, in streaming fashion: only the normal
+ * equations Y'Y pi = Y'tau are kept, so memory does not grow with the number
+ * of samples, and logs of millions of samples can be added a chunk at a
+ * time. Trajectories are split in blocks of consecutive samples over a
+ * ThreadPool, every thread accumulating its own normal equations with its own
+ * InertialRegressor, which are summed after each call.
+ */
+class InertialIdentification {
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot        the robot, needs to have a tree structure and fixed
+   *                     roots
+   * @param gravity      gravity vector
+   * @param num_threads  number of threads, 0 for hardware concurrency
+   */
+  InertialIdentification(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      size_t num_threads = 0);
+
+  /// Number of parameters, see InertialRegressor.
+  size_t numParameters() const { return normal_vector_.size(); }
+
+  /// Number of samples added so far.
+  size_t numSamples() const { return num_samples_; }
+
+  /// Add one sample, on joint-id indexed arrays, using the calling thread.
+  void add(const gtsam::Vector &q, const gtsam::Vector &v,
+           const gtsam::Vector &a, const gtsam::Vector &tau);
+
+  /**
+   * Add every row of a trajectory as a sample.
+   * @param Q    joint angles, #samples x #joint slots
+   * @param V    joint velocities, same layout
+   * @param A    joint accelerations, same layout
+   * @param Tau  measured joint torques, same layout
+   */
+  void addTrajectory(const gtsam::Matrix &Q, const gtsam::Matrix &V,
+                     const gtsam::Matrix &A, const gtsam::Matrix &Tau);
+
+  /// Add the samples of another identification of the same robot, e.g. of
+  /// another log processed concurrently.
+  void merge(const InertialIdentification &other);
+
+  /// Normal matrix Y'Y summed over the samples.
+  const gtsam::Matrix &normalMatrix() const { return normal_matrix_; }
+
+  /// Normal vector Y'tau summed over the samples.
+  const gtsam::Vector &normalVector() const { return normal_vector_; }
+
+  /**
+   * Solve the normal equations, regularized towards a prior:
+   * (Y'Y + damping I) pi = Y'tau + damping prior. Some parameters never
+   * affect the torques, e.g. those of fixed roots, and others only in
+   * combinations, so Y'Y is singular and the damping picks the solution
+   * closest to the prior, e.g. InertialRegressor::parameters() of the CAD
+   * model.
+   * @param damping  weight of the prior, > 0
+   * @param prior    parameters to regularize towards, zero if not given
+   */
+  gtsam::Vector solve(
+      double damping = 1e-6,
+      const boost::optional<gtsam::Vector> &prior = boost::none) const;
+
+  /// Root mean square torque residual of `parameters` over all samples and
+  /// joint slots, from the normal equations.
+  double rmsResidual(const gtsam::Vector &parameters) const;
+
+ private:
+  // Regressor and normal equations of one thread.
+  struct Worker {
+    InertialRegressor regressor;
+    gtsam::Matrix Y, normal_matrix;  // lower triangle of Y'Y only
+    gtsam::Vector q, v, a, tau, normal_vector;
+    double torque_squares = 0;
+    Worker(const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+        : regressor(robot, gravity) {}
+    void add();  // the sample in q, v, a and tau
+  };
+
+  // Sum the normal equations of the workers into the totals, and clear them.
+  void collect();
+
+  std::vector<std::unique_ptr<Worker>> workers_;  // per thread
+  ThreadPool pool_;
+  size_t num_joint_slots_;
+  gtsam::Matrix normal_matrix_;
+  gtsam::Vector normal_vector_;
+  double torque_squares_ = 0;  // sum of tau'tau
+  size_t num_samples_ = 0;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedStateEstimator.cpp
+ * @brief Fixed-lag legged state estimation from IMU, encoders and contacts.
+ */
+
+#include "gtdynamics/dynamics/LeggedStateEstimator.h"
+
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "gtdynamics/factors/ForwardKinematicsFactor.h"
+#include "gtdynamics/utils/FixedLag.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::imuBias::ConstantBias;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+LeggedStateEstimator::LeggedStateEstimator(
+    const Robot &robot, const std::string &base_name,
+    const LeggedEstimatorParameters &parameters)
+    : robot_(robot),
+      base_name_(base_name),
+      base_id_(robot.link(base_name)->id()),
+      p_(parameters),
+      isam_(parameters.isam2),
+      imu_(parameters.imu) {
+  if (p_.lag <= 0 || p_.max_keyframe_interval <= 0)
+    throw std::invalid_argument(
+        "LeggedStateEstimator: lag and max_keyframe_interval should be "
+        "positive.");
+}
+
+/* ************************************************************************* */
+Values LeggedStateEstimator::jointAngles(const Values &joint_angles,
+                                         int k) const {
+  Values angles;
+  for (auto &&joint : robot_.joints())
+    InsertJointAngle(&angles, joint->id(), k,
+                     JointAngle(joint_angles, joint->id()));
+  return angles;
+}
+
+/* ************************************************************************* */
+void LeggedStateEstimator::addFeet(int k, const Values &joint_angles,
+                                   const std::set<std::string> &contacts,
+                                   const Pose3 &wTb,
+                                   NonlinearFactorGraph *graph,
+                                   Values *values) const {
+  const Values angles = jointAngles(joint_angles, k);
+  for (const std::string &foot : contacts) {
+    auto factor = boost::make_shared<ForwardKinematicsFactor>(
+        robot_, base_name_, foot, angles, p_.kinematics_model, k);
+    graph->push_back(factor);
+    values->insert(internal::PoseKey(robot_.link(foot)->id(), k),
+                   wTb * factor->measured());
+  }
+}
+
+/* ************************************************************************* */
+void LeggedStateEstimator::initialize(const gtsam::NavState &state,
+                                      const ConstantBias &bias,
+                                      const Values &joint_angles,
+                                      const std::set<std::string> &contacts) {
+  isam_ = gtsam::ISAM2(p_.isam2);
+  keyframe_ = 0;
+  time_ = 0;
+  keyframe_times_ = {{0, 0.0}};
+  keyframe_keys_.clear();
+  contacts_ = contacts;
+  keyframe_state_ = state;
+  bias_ = bias;
+  imu_.resetIntegrationAndSetBias(bias);
+
+  NonlinearFactorGraph graph;
+  Values values;
+  const Key x = internal::PoseKey(base_id_, 0);
+  graph.addPrior(x, state.pose(), p_.prior_pose_model);
+  graph.addPrior(VelocityKey(0), state.velocity(), p_.prior_velocity_model);
+  graph.addPrior(BiasKey(0), bias, p_.prior_bias_model);
+  values.insert(x, state.pose());
+  values.insert(VelocityKey(0), state.velocity());
+  values.insert(BiasKey(0), bias);
+  addFeet(0, joint_angles, contacts, state.pose(), &graph, &values);
+
+  keyframe_keys_[0] = values.keys();
+  FixedLagUpdate(&isam_, graph, values, &keyframe_keys_, -1);
+}
+
+/* ************************************************************************* */
+bool LeggedStateEstimator::update(const LeggedMeasurement &measurement) {
+  if (keyframe_ < 0)
+    throw std::runtime_error(
+        "LeggedStateEstimator::update: call initialize first.");
+  imu_.integrateMeasurement(measurement.acceleration,
+                            measurement.angular_velocity, measurement.dt);
+  time_ += measurement.dt;
+
+  // Allow for rounding in the sum of the sample intervals.
+  const double interval = time_ - keyframe_times_.at(keyframe_);
+  if (measurement.contacts == contacts_ &&
+      interval < p_.max_keyframe_interval - 1e-9)
+    return false;
+  addKeyframe(measurement);
+  return true;
+}
+
+/* ************************************************************************* */
+void LeggedStateEstimator::addKeyframe(const LeggedMeasurement &measurement) {
+  const int i = keyframe_, j = keyframe_ + 1;
+  const double interval = time_ - keyframe_times_.at(i);
+  const Key xi = internal::PoseKey(base_id_, i),
+            xj = internal::PoseKey(base_id_, j);
+
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::ImuFactor>(xi, VelocityKey(i), xj,
+                                         VelocityKey(j), BiasKey(i), imu_);
+  gtsam::Vector6 bias_sigmas;
+  bias_sigmas << gtsam::Vector3::Constant(p_.accel_bias_sigma),
+      gtsam::Vector3::Constant(p_.gyro_bias_sigma);
+  graph.emplace_shared<gtsam::BetweenFactor<ConstantBias>>(
+      BiasKey(i), BiasKey(j), ConstantBias(),
+      gtsam::noiseModel::Diagonal::Sigmas(bias_sigmas * std::sqrt(interval)));
+
+  // Feet that lifted off at this sample get no contact factor, since they
+  // were in contact for only part of the interval.
+  for (const std::string &foot : contacts_) {
+    if (!measurement.contacts.count(foot)) continue;
+    PreintegratedRigidContactMeasurements pcm(p_.contact_angular_cov,
+                                              p_.contact_linear_cov);
+    pcm.integrateMeasurement(interval);
+    const int id = robot_.link(foot)->id();
+    graph.emplace_shared<PreintegratedRigidContactFactor>(
+        internal::PoseKey(id, i), internal::PoseKey(id, j), pcm);
+  }
+
+  const gtsam::NavState predicted = imu_.predict(keyframe_state_, bias_);
+  Values values;
+  values.insert(xj, predicted.pose());
+  values.insert(VelocityKey(j), predicted.velocity());
+  values.insert(BiasKey(j), bias_);
+  addFeet(j, measurement.joint_angles, measurement.contacts, predicted.pose(),
+          &graph, &values);
+  keyframe_keys_[j] = values.keys();
+  keyframe_times_[j] = time_;
+
+  // Marginalize the keyframes that fell out of the window, one per update.
+  for (;;) {
+    const int first = keyframe_keys_.begin()->first;
+    const bool old = first < i && time_ - keyframe_times_.at(first) > p_.lag;
+    FixedLagUpdate(&isam_, graph, values, &keyframe_keys_, old ? first : -1);
+    if (!old) break;
+    keyframe_times_.erase(first);
+    graph = NonlinearFactorGraph();
+    values.clear();
+  }
+
+  keyframe_ = j;
+  contacts_ = measurement.contacts;
+  keyframe_state_ = gtsam::NavState(isam_.calculateEstimate<Pose3>(xj),
+                                    isam_.calculateEstimate<gtsam::Vector3>(
+                                        VelocityKey(j)));
+  bias_ = isam_.calculateEstimate<ConstantBias>(BiasKey(j));
+  imu_.resetIntegrationAndSetBias(bias_);
+}
+
+/* ************************************************************************* */
+gtsam::NavState LeggedStateEstimator::state() const {
+  return imu_.predict(keyframe_state_, bias_);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,173 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LeggedStateEstimator.h
+ * @brief Fixed-lag legged state estimation from IMU, encoders and contacts.
+ */
+
+#pragma once
+
+#include <gtsam/navigation/ImuBias.h>
+#include <gtsam/navigation/ImuFactor.h>
+#include <gtsam/navigation/NavState.h>
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "gtdynamics/factors/PreintegratedContactFactors.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+namespace gtdynamics {
+
+/// Parameters of LeggedStateEstimator.
+struct LeggedEstimatorParameters {
+  /// IMU noise and gravity, the IMU is at the base link frame by default.
+  boost::shared_ptr<gtsam::PreintegrationParams> imu =
+      gtsam::PreintegrationParams::MakeSharedU(9.81);
+  double accel_bias_sigma = 1e-3;  ///< bias random walk, per sqrt(second)
+  double gyro_bias_sigma = 1e-4;   ///< bias random walk, per sqrt(second)
+
+  /// Noise of the foot pose in the base frame from the encoders.
+  gtsam::SharedNoiseModel kinematics_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+  /// Discrete angular and linear velocity covariances of a foot in contact.
+  gtsam::Matrix3 contact_angular_cov = gtsam::I_3x3 * 1e-4;
+  gtsam::Matrix3 contact_linear_cov = gtsam::I_3x3 * 1e-4;
+
+  /// Priors of the first keyframe.
+  gtsam::SharedNoiseModel prior_pose_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+  gtsam::SharedNoiseModel prior_velocity_model =
+      gtsam::noiseModel::Isotropic::Sigma(3, 1e-2);
+  gtsam::SharedNoiseModel prior_bias_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-2);
+
+  double lag = 1.0;  ///< seconds of keyframes kept in the smoother
+  double max_keyframe_interval = 0.1;  ///< seconds without a keyframe at most
+  gtsam::ISAM2Params isam2;            ///< parameters of the underlying iSAM2
+};
+
+/// Sensor readings at one IMU sample.
+struct LeggedMeasurement {
+  double dt = 0;  ///< time since the previous sample
+  gtsam::Vector3 acceleration = gtsam::Vector3::Zero();  ///< in the IMU frame
+  gtsam::Vector3 angular_velocity = gtsam::Vector3::Zero();
+  gtsam::Values joint_angles;      ///< encoder readings at time 0
+  std::set<std::string> contacts;  ///< names of the feet in contact
+};
+
+/**
+ * LeggedStateEstimator estimates the base pose, velocity and IMU bias of a
+ * legged robot at IMU rate, as in Hartley18icra. Between keyframes, IMU
+ * samples and foot contacts are only preintegrated, and the current state is
+ * predicted from the last keyframe. A keyframe is added at every contact event
+ * and at least every max_keyframe_interval seconds, with
+ *  - an ImuFactor and a bias random walk from the previous keyframe,
+ *  - a ForwardKinematicsFactor from the base to each foot in contact, using
+ *    the encoders,
+ *  - a PreintegratedRigidContactFactor for each foot in contact since the
+ *    previous keyframe.
+ *
+ * Keyframes are kept in iSAM2 for `lag` seconds and then marginalized, so the
+ * work per IMU sample is bounded by the size of the window.
+ *
+ * Variables of keyframe k are the base and foot poses at time k, and
+ * VelocityKey(k) and BiasKey(k).
+ */
+class LeggedStateEstimator {
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot, with a floating base
+   * @param base_name   name of the base link
+   * @param parameters  noise models, window and iSAM2 parameters
+   */
+  LeggedStateEstimator(const Robot &robot, const std::string &base_name,
+                       const LeggedEstimatorParameters &parameters =
+                           LeggedEstimatorParameters());
+
+  /// Key of the base velocity in the world frame at keyframe k.
+  static gtsam::Key VelocityKey(int k) {
+    return DynamicsSymbol::SimpleSymbol(DynamicsLabel('v', 'b'), k);
+  }
+
+  /// Key of the IMU bias at keyframe k.
+  static gtsam::Key BiasKey(int k) {
+    return DynamicsSymbol::SimpleSymbol(DynamicsLabel('i', 'b'), k);
+  }
+
+  /**
+   * Start estimation with a prior on the first keyframe.
+   * @param state         base pose and velocity in the world frame
+   * @param bias          IMU bias
+   * @param joint_angles  encoder readings at time 0
+   * @param contacts      names of the feet in contact
+   */
+  void initialize(const gtsam::NavState &state,
+                  const gtsam::imuBias::ConstantBias &bias,
+                  const gtsam::Values &joint_angles,
+                  const std::set<std::string> &contacts);
+
+  /**
+   * Add one IMU sample with the encoders and contacts at the same time.
+   * @return true if a keyframe was added and the smoother updated.
+   */
+  bool update(const LeggedMeasurement &measurement);
+
+  /// Estimated base pose and velocity at the last sample.
+  gtsam::NavState state() const;
+
+  /// Estimated IMU bias at the last keyframe.
+  const gtsam::imuBias::ConstantBias &bias() const { return bias_; }
+
+  /// Current estimate of all variables in the window.
+  gtsam::Values estimate() const { return isam_.calculateEstimate(); }
+
+  /// Index of the last keyframe.
+  int lastKeyframe() const { return keyframe_; }
+
+  /// Number of keyframes in the window.
+  size_t numKeyframes() const { return keyframe_keys_.size(); }
+
+  /// The underlying iSAM2 instance.
+  const gtsam::ISAM2 &isam() const { return isam_; }
+
+ private:
+  /// Encoder readings at time 0, re-keyed to keyframe k.
+  gtsam::Values jointAngles(const gtsam::Values &joint_angles, int k) const;
+
+  /// Add the feet in contact at keyframe k, given the base pose estimate.
+  void addFeet(int k, const gtsam::Values &joint_angles,
+               const std::set<std::string> &contacts, const gtsam::Pose3 &wTb,
+               gtsam::NonlinearFactorGraph *graph, gtsam::Values *values) const;
+
+  /// Add a keyframe at the current sample.
+  void addKeyframe(const LeggedMeasurement &measurement);
+
+  const Robot robot_;
+  const std::string base_name_;
+  const int base_id_;
+  LeggedEstimatorParameters p_;
+  gtsam::ISAM2 isam_;
+
+  int keyframe_ = -1;
+  double time_ = 0;  // time of the last sample
+  std::map<int, double> keyframe_times_;
+  std::map<int, gtsam::KeyVector> keyframe_keys_;  // variables of keyframes
+  std::set<std::string> contacts_;                 // at the last keyframe
+  gtsam::NavState keyframe_state_;
+  gtsam::imuBias::ConstantBias bias_;
+
+  gtsam::PreintegratedImuMeasurements imu_;  // since the last keyframe
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,192 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearDynamicsSolver.cpp
+ * @brief Forward dynamics with a pre-compiled linear dynamics factor graph.
+ */
+
+#include "gtdynamics/dynamics/LinearDynamicsSolver.h"
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/inference/VariableIndex.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianEliminationTree.h>
+#include <gtsam/linear/HessianFactor.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/NoiseModels.h"
+#include "gtdynamics/utils/utils.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::I_1x1;
+using gtsam::I_6x6;
+using gtsam::JacobianFactor;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+LinearDynamicsSolver::LinearDynamicsSolver(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis)
+    : gravity_(gravity) {
+  using internal::JointAccelKey;
+  using internal::TorqueKey;
+  using internal::TwistAccelKey;
+  using internal::WrenchKey;
+  auto all_constrained_1 = ConstrainedAll(1);
+  auto all_constrained_3 = ConstrainedAll(3);
+  auto all_constrained_6 = ConstrainedAll(6);
+
+  // Same factors as DynamicsGraph::linearDynamicsGraph + linearFDPriors, at
+  // t = 0 and with placeholder numbers where they depend on the state.
+  const int t = 0;
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    LinkEntry entry{link, nullptr};
+    if (link->isFixed()) {
+      // A_i = 0
+      graph_.add(TwistAccelKey(i, t), I_6x6, gtsam::Z_6x1, all_constrained_6);
+    } else {
+      std::vector<std::pair<gtsam::Key, Matrix>> terms;
+      terms.emplace_back(TwistAccelKey(i, t), link->inertiaMatrix());
+      for (auto &&joint : link->joints())
+        terms.emplace_back(WrenchKey(i, joint->id(), t), -I_6x6);
+      entry.wrench_factor = boost::make_shared<JacobianFactor>(
+          terms, gtsam::Z_6x1, all_constrained_6);
+      graph_.push_back(entry.wrench_factor);
+    }
+    links_.push_back(entry);
+  }
+
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const int i1 = joint->parent()->id();
+    const int i2 = joint->child()->id();
+    const Vector6 S_i2_j = joint->screwAxis(joint->child());
+    JointEntry entry;
+    entry.joint = joint;
+
+    // twist acceleration factor
+    entry.accel_factor = boost::make_shared<JacobianFactor>(
+        TwistAccelKey(i2, t), I_6x6, TwistAccelKey(i1, t), -I_6x6,
+        JointAccelKey(j, t), -S_i2_j, gtsam::Z_6x1, all_constrained_6);
+    graph_.push_back(entry.accel_factor);
+
+    // torque factor
+    graph_.add(WrenchKey(i2, j, t), S_i2_j.transpose(), TorqueKey(j, t),
+               -I_1x1, gtsam::Vector1::Zero(), all_constrained_1);
+
+    // wrench equivalence factor
+    entry.equivalence_factor = boost::make_shared<JacobianFactor>(
+        WrenchKey(i1, j, t), I_6x6, WrenchKey(i2, j, t), I_6x6, gtsam::Z_6x1,
+        all_constrained_6);
+    graph_.push_back(entry.equivalence_factor);
+
+    // wrench planar factor
+    if (planar_axis) {
+      graph_.add(WrenchKey(i2, j, t), getPlanarJacobian(*planar_axis),
+                 gtsam::Vector3::Zero(), all_constrained_3);
+    }
+
+    // torque prior
+    entry.torque_prior = boost::make_shared<JacobianFactor>(
+        TorqueKey(j, t), I_1x1, gtsam::Vector1::Zero(), all_constrained_1);
+    graph_.push_back(entry.torque_prior);
+
+    joints_.push_back(entry);
+  }
+
+  // Symbolic work, done once: ordering, elimination tree and junction tree.
+  // The clusters share the factors in graph_, so refilling them in place is
+  // all that is needed before each numeric elimination.
+  const gtsam::VariableIndex variable_index(graph_);
+  const gtsam::Ordering ordering = gtsam::Ordering::Colamd(variable_index);
+  const gtsam::GaussianEliminationTree elimination_tree(graph_, variable_index,
+                                                        ordering);
+  junction_tree_ =
+      boost::make_shared<gtsam::GaussianJunctionTree>(elimination_tree);
+}
+
+/* ************************************************************************* */
+void LinearDynamicsSolver::refill(const Values &known_values, size_t t) const {
+  for (auto &&entry : links_) {
+    if (!entry.wrench_factor) continue;
+    const auto &link = entry.link;
+    const int i = link->id();
+    const gtsam::Matrix6 &G_i = link->inertiaMatrix();
+    const Pose3 T_wi = Pose(known_values, i, t);
+    const Vector6 V_i = Twist(known_values, i, t);
+    auto rhs = entry.wrench_factor->getb();
+    rhs = Pose3::adjointMap(V_i).transpose() * G_i * V_i;
+    if (gravity_) rhs += link->gravityWrench(*gravity_, T_wi.rotation());
+  }
+
+  for (auto &&entry : joints_) {
+    const auto &joint = entry.joint;
+    const int j = joint->id();
+    const Pose3 T_wi1 = Pose(known_values, joint->parent()->id(), t);
+    const Pose3 T_wi2 = Pose(known_values, joint->child()->id(), t);
+    const gtsam::Matrix6 Ad_21 = (T_wi2.inverse() * T_wi1).AdjointMap();
+    const Vector6 V_i2 = Twist(known_values, joint->child()->id(), t);
+    const Vector6 S_i2_j = joint->screwAxis(joint->child());
+    const double v_j = JointVel(known_values, j, t);
+
+    auto &accel = *entry.accel_factor;
+    accel.getA(accel.begin() + 1) = -Ad_21;
+    accel.getb() = Pose3::adjointMap(V_i2) * S_i2_j * v_j;
+
+    auto &equivalence = *entry.equivalence_factor;
+    equivalence.getA(equivalence.begin() + 1) = Ad_21.transpose();
+
+    entry.torque_prior->getb()(0) = Torque(known_values, j, t);
+  }
+}
+
+/* ************************************************************************* */
+Values LinearDynamicsSolver::solveForwardDynamics(const Values &known_values,
+                                                  size_t t) const {
+  refill(known_values, t);
+  const auto eliminated =
+      junction_tree_->eliminate(gtsam::EliminatePreferCholesky);
+  const gtsam::VectorValues results = eliminated.first->optimize();
+
+  // arrange values
+  Values values = known_values;
+  try {
+    // Copy accelerations and wrenches to result.
+    for (auto &&entry : joints_) {
+      const auto &joint = entry.joint;
+      int j = joint->id();
+      int i1 = joint->parent()->id();
+      int i2 = joint->child()->id();
+      InsertJointAccel(&values, j, t, JointAccel(results, j, 0)[0]);
+      InsertWrench(&values, i1, j, t, Wrench(results, i1, j, 0));
+      InsertWrench(&values, i2, j, t, Wrench(results, i2, j, 0));
+    }
+    for (auto &&entry : links_) {
+      int i = entry.link->id();
+      InsertTwistAccel(&values, i, t, TwistAccel(results, i, 0));
+    }
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "solveForwardDynamics: known_values should contain no accelerations "
+        "or wrenches");
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
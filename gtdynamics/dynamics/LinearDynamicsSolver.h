@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearDynamicsSolver.h
+ * @brief Forward dynamics with a pre-compiled linear dynamics factor graph.
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/GaussianJunctionTree.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * LinearDynamicsSolver solves the same problem as
+ * DynamicsGraph::linearSolveFD, but the structure of the linear dynamics graph
+ * (factors, ordering, and junction tree) is computed once at construction. A
+ * solve only refills the numeric blocks of the cached factors in place and
+ * runs the numeric elimination.
+ *
+ * Internally the graph uses keys at time 0, results are returned at the time
+ * index that is asked for.
+ */
+class LinearDynamicsSolver {
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot        the robot
+   * @param gravity      gravity in world frame
+   * @param planar_axis  axis of the plane, used only for planar robot
+   */
+  explicit LinearDynamicsSolver(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const boost::optional<gtsam::Vector3> &planar_axis = boost::none);
+
+  /**
+   * Solve forward dynamics, same semantics as DynamicsGraph::linearSolveFD.
+   *
+   * @param known_values Values with poses, twists, joint velocities and
+   * torques at time t.
+   * @param t            time index
+   * @return known_values with joint accelerations, wrenches and twist
+   * accelerations added.
+   */
+  gtsam::Values solveForwardDynamics(const gtsam::Values &known_values,
+                                     size_t t = 0) const;
+
+  /// Return the cached graph, with the numbers of the last solve.
+  const gtsam::GaussianFactorGraph &graph() const { return graph_; }
+
+ private:
+  using JacobianPtr = boost::shared_ptr<gtsam::JacobianFactor>;
+
+  /// Per link factor: G_i A_i - sum F_i_j = ad(V_i)^T G_i V_i + m_i R_i^T g.
+  struct LinkEntry {
+    LinkSharedPtr link;
+    JacobianPtr wrench_factor;  // null for fixed links
+  };
+
+  /// Per joint factors with numbers that depend on the state.
+  struct JointEntry {
+    JointSharedPtr joint;
+    JacobianPtr accel_factor;        // A_c - Ad(T_cp) A_p - S a = ad(V_c) S v
+    JacobianPtr equivalence_factor;  // F_p + Ad(T_cp)^T F_c = 0
+    JacobianPtr torque_prior;        // tau = known torque
+  };
+
+  /// Refill all state-dependent numbers from known_values at time t.
+  void refill(const gtsam::Values &known_values, size_t t) const;
+
+  boost::optional<gtsam::Vector3> gravity_;
+  std::vector<LinkEntry> links_;
+  std::vector<JointEntry> joints_;
+  gtsam::GaussianFactorGraph graph_;
+  boost::shared_ptr<gtsam::GaussianJunctionTree> junction_tree_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShooting.cpp
+ * @brief Multiple-shooting trajectory optimization by forward simulation.
+ */
+
+#include "gtdynamics/dynamics/MultipleShooting.h"
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <stdexcept>
+
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+MultipleShooting::MultipleShooting(
+    const Robot &robot, const MultipleShootingParameters &parameters,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const OptimizerSetting &opt)
+    : parameters_(parameters),
+      segment_(boost::make_shared<ShootingDefectFactor>(
+          robot, 0, parameters.segment_steps, parameters.dt,
+          opt.q_col_cost_model, opt.v_col_cost_model, gravity)) {
+  if (parameters.num_segments == 0)
+    throw std::invalid_argument(
+        "MultipleShooting: needs at least one segment.");
+  num_slots_ = 0;
+  for (const int j : segment_->jointIds())
+    num_slots_ = std::max(num_slots_, size_t(j + 1));
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactor::shared_ptr MultipleShooting::segmentFactor(
+    size_t k) const {
+  if (k == 0) return segment_;
+  // The time index occupies the low bits of a DynamicsSymbol.
+  gtsam::KeyVector keys = segment_->keys();
+  for (auto &key : keys) key += nodeStep(k);
+  return segment_->rekey(keys);
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph MultipleShooting::defectFactors() const {
+  gtsam::NonlinearFactorGraph graph;
+  graph.reserve(numSegments());
+  for (size_t k = 0; k < numSegments(); ++k) graph.push_back(segmentFactor(k));
+  return graph;
+}
+
+/* ************************************************************************* */
+gtsam::Values MultipleShooting::rollout(
+    const Vector &q0, const Vector &v0,
+    const std::vector<Vector> &torques) const {
+  if (torques.size() != numSegments())
+    throw std::invalid_argument(
+        "MultipleShooting::rollout: needs the torques of every segment.");
+  if (size_t(q0.size()) != num_slots_ || size_t(v0.size()) != num_slots_)
+    throw std::invalid_argument(
+        "MultipleShooting::rollout: the state needs one entry per joint "
+        "slot.");
+
+  gtsam::Values values;
+  Vector q = q0, v = v0;
+  for (size_t k = 0; k <= numSegments(); ++k) {
+    const int t = nodeStep(k);
+    for (const int j : jointIds()) {
+      InsertJointAngle(&values, j, t, q(j));
+      InsertJointVel(&values, j, t, v(j));
+    }
+    if (k == numSegments()) break;
+    const Vector &tau = torques[k];
+    if (size_t(tau.size()) != num_slots_)
+      throw std::invalid_argument(
+          "MultipleShooting::rollout: the torques need one entry per joint "
+          "slot.");
+    for (const int j : jointIds()) InsertTorque(&values, j, t, tau(j));
+    segment_->integrate(&q, &v, tau);
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+gtsam::Values MultipleShooting::denseTrajectory(const gtsam::Values &nodes,
+                                                ThreadPool *pool) const {
+  const size_t steps = parameters_.segment_steps;
+  std::vector<gtsam::Values> segments(numSegments());
+
+  auto simulate = [&](size_t k, size_t /*worker*/) {
+    // A copy per segment, since the factor integrates in scratch space.
+    const ShootingDefectFactor segment(*segment_);
+    const int t0 = nodeStep(k);
+    Vector q = Vector::Zero(num_slots_), v = q, tau = q;
+    for (const int j : jointIds()) {
+      q(j) = JointAngle(nodes, j, t0);
+      v(j) = JointVel(nodes, j, t0);
+      tau(j) = Torque(nodes, j, t0);
+    }
+    gtsam::Values &values = segments[k];
+    for (size_t s = 0; s < steps; ++s) {
+      const int t = t0 + int(s);
+      for (const int j : jointIds()) {
+        InsertJointAngle(&values, j, t, q(j));
+        InsertJointVel(&values, j, t, v(j));
+        InsertTorque(&values, j, t, tau(j));
+      }
+      segment.step(&q, &v, tau);
+    }
+  };
+  if (pool) {
+    pool->parallelFor(numSegments(), simulate);
+  } else {
+    for (size_t k = 0; k < numSegments(); ++k) simulate(k, 0);
+  }
+
+  gtsam::Values values;
+  for (auto &&segment : segments) values.insert(segment);
+  const int t = nodeStep(numSegments());
+  for (const int j : jointIds()) {
+    InsertJointAngle(&values, j, t, JointAngle(nodes, j, t));
+    InsertJointVel(&values, j, t, JointVel(nodes, j, t));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
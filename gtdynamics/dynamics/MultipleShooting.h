@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultipleShooting.h
+ * @brief Multiple-shooting trajectory optimization by forward simulation.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/factors/ShootingDefectFactor.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+class ThreadPool;
+
+/// Parameters of MultipleShooting.
+struct MultipleShootingParameters {
+  size_t num_segments = 10;  ///< number of shooting segments
+  size_t segment_steps = 10;  ///< integrator steps in each segment
+  double dt = 0.01;           ///< duration of each integrator step
+};
+
+/**
+ * MultipleShooting is a trajectory planner for fixed-base robots whose
+ * decision variables are the joint angles and velocities at the shooting
+ * nodes, steps nodeStep(k) for k = 0..numSegments(), and the torques at all
+ * nodes but the last, held over the segment that follows. The dynamics are
+ * imposed by one ShootingDefectFactor per segment, which simulates the
+ * segment with RecursiveDynamics instead of adding the link variables and
+ * dynamics factors of every step, as DynamicsGraph does.
+ *
+ * The node variables use the usual joint keys at their time step, so the
+ * objective factors, e.g. JointObjectives(j, nodeStep(k)), apply to them
+ * unchanged. The segments are independent factors, so they are linearized in
+ * parallel by an Optimizer with OptimizationParameters::num_threads set.
+ */
+class MultipleShooting {
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot, a tree whose roots are fixed links
+   * @param parameters  segments and step duration
+   * @param gravity     gravity, if any
+   * @param opt         cost models; q_col_cost_model and v_col_cost_model
+   *                    weigh the angle and velocity defects
+   */
+  MultipleShooting(const Robot &robot,
+                   const MultipleShootingParameters &parameters =
+                       MultipleShootingParameters(),
+                   const boost::optional<gtsam::Vector3> &gravity = boost::none,
+                   const OptimizerSetting &opt = OptimizerSetting());
+
+  /// Number of segments.
+  size_t numSegments() const { return parameters_.num_segments; }
+
+  /// Time step of shooting node k.
+  int nodeStep(size_t k) const {
+    return static_cast<int>(k * parameters_.segment_steps);
+  }
+
+  /// Ids of the joints, in increasing order.
+  const std::vector<int> &jointIds() const { return segment_->jointIds(); }
+
+  /// Return the defect factors of all segments.
+  gtsam::NonlinearFactorGraph defectFactors() const;
+
+  /**
+   * Simulate the trajectory from an initial state, to initialize the nodes.
+   * @param q0, v0   joint-id indexed initial angles and velocities
+   * @param torques  joint-id indexed torques of each segment
+   * @return angles and velocities at all nodes and torques at all but the
+   *         last, for which all defects are zero
+   */
+  gtsam::Values rollout(const gtsam::Vector &q0, const gtsam::Vector &v0,
+                        const std::vector<gtsam::Vector> &torques) const;
+
+  /**
+   * Re-simulate every segment from its node values, e.g. of a solution, to
+   * get the angles, velocities and torques at every integrator step. The
+   * values at the nodes are kept, so the states at the starts of the next
+   * segments show any remaining defects.
+   * @param nodes  values at the nodes, as for defectFactors()
+   * @param pool   if given, segments are simulated in parallel on it
+   */
+  gtsam::Values denseTrajectory(const gtsam::Values &nodes,
+                                ThreadPool *pool = nullptr) const;
+
+ private:
+  MultipleShootingParameters parameters_;
+  size_t num_slots_;
+  boost::shared_ptr<ShootingDefectFactor> segment_;  // at step 0
+
+  // The segment starting at node k.
+  gtsam::NonlinearFactor::shared_ptr segmentFactor(size_t k) const;
+};
+
+}  // namespace gtdynamics
@@ -15,6 +15,11 @@
 
 #include <gtsam/linear/NoiseModel.h>
 
+#include <boost/shared_ptr.hpp>
+
+#include "gtdynamics/utils/NoiseModels.h"
+#include "gtdynamics/utils/Terrain.h"
+
 namespace gtdynamics {
 
 /// OptimizerSetting is a class used to set parameters for motion planner
@@ -62,9 +67,33 @@ class OptimizerSetting {
                       // optimization
   int max_iter;       // max iteration for stopping optimization
 
-  /// collision checking setting
-  double epsilon;   // obstacle clearance
-  double obsSigma;  // obstacle cost model covariance
+  /// Add one LinkDynamicsFactor per link instead of separate wrench,
+  /// wrench equivalence, torque and planar factors. Needs diagonal fa, f, t
+  /// and planar cost models.
+  bool fuse_link_dynamics = false;
+
+  /// Add one CollocationBankFactor per joint for every window of this many
+  /// time steps instead of two collocation factors per joint and step; 0
+  /// keeps the separate factors. Needs diagonal q_col and v_col cost models.
+  size_t collocation_bank_steps = 0;
+
+  /// Allocate the re-keyed dynamics factors of a trajectory graph in one
+  /// FactorArena per graph instead of one heap allocation per factor.
+  bool arena_allocation = false;
+
+  /// Include the passive spring, damper and friction torques of the joints,
+  /// see Joint::passiveTorque, in the torque factors: the joint wrench on
+  /// the child projects to the torque plus the passive torque. Not with
+  /// fuse_link_dynamics.
+  bool passive_joint_forces = false;
+
+  /// Terrain the contact points are held on, z up; null for flat ground at
+  /// height 0. See HeightMap for terrain scans.
+  boost::shared_ptr<const TerrainModel> terrain;
+
+  /// collision checking setting, see DynamicsGraph::collisionFactors
+  double epsilon = 0.05;    // obstacle clearance
+  double obsSigma = 0.001;  // obstacle cost model sigma
 
   /// default constructor
   OptimizerSetting();
@@ -83,43 +112,33 @@ class OptimizerSetting {
   OptimizerSetting(double sigma_dynamics, double sigma_linear = 0.001,
                    double sigma_contact = 0.001, double sigma_joint = 0.001,
                    double sigma_collocation = 0.001, double sigma_time = 0.001)
-      : bp_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        bv_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        ba_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        p_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        v_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        a_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        linear_a_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(6, sigma_linear)),
-        f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        linear_f_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(6, sigma_linear)),
-        fa_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_dynamics)),
-        linear_t_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_linear)),
-        cp_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_contact)),
-        cfriction_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_contact)),
-        cv_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        ca_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        cm_cost_model(gtsam::noiseModel::Isotropic::Sigma(3, sigma_contact)),
-        planar_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(3, sigma_dynamics)),
-        linear_planar_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(3, sigma_linear)),
-        prior_q_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_qv_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_qa_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        prior_t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
-        q_col_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_collocation)),
-        v_col_cost_model(
-            gtsam::noiseModel::Isotropic::Sigma(1, sigma_collocation)),
-        time_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_time)),
-        jl_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_joint)),
+      : bp_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        bv_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        ba_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        p_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        v_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        a_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        linear_a_cost_model(IsotropicSigma(6, sigma_linear)),
+        f_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        linear_f_cost_model(IsotropicSigma(6, sigma_linear)),
+        fa_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        t_cost_model(IsotropicSigma(1, sigma_dynamics)),
+        linear_t_cost_model(IsotropicSigma(1, sigma_linear)),
+        cp_cost_model(IsotropicSigma(1, sigma_contact)),
+        cfriction_cost_model(IsotropicSigma(1, sigma_contact)),
+        cv_cost_model(IsotropicSigma(3, sigma_contact)),
+        ca_cost_model(IsotropicSigma(3, sigma_contact)),
+        cm_cost_model(IsotropicSigma(3, sigma_contact)),
+        planar_cost_model(IsotropicSigma(3, sigma_dynamics)),
+        linear_planar_cost_model(IsotropicSigma(3, sigma_linear)),
+        prior_q_cost_model(IsotropicSigma(1, sigma_joint)),
+        prior_qv_cost_model(IsotropicSigma(1, sigma_joint)),
+        prior_qa_cost_model(IsotropicSigma(1, sigma_joint)),
+        prior_t_cost_model(IsotropicSigma(1, sigma_joint)),
+        q_col_cost_model(IsotropicSigma(1, sigma_collocation)),
+        v_col_cost_model(IsotropicSigma(1, sigma_collocation)),
+        time_cost_model(IsotropicSigma(1, sigma_time)),
+        jl_cost_model(IsotropicSigma(1, sigma_joint)),
         rel_thresh(1e-2),
         max_iter(50) {}
 
@@ -140,6 +159,21 @@ class OptimizerSetting {
 
   // set maximum iteration number
   void setMaxIteration(size_t iter) { max_iter = iter; }
+
+  // fuse the dynamics factors of each link into one LinkDynamicsFactor
+  void setFusedLinkDynamics(bool fuse = true) { fuse_link_dynamics = fuse; }
+
+  // bank the joint collocation factors of trajectories, per `steps` steps
+  void setCollocationBank(size_t steps) { collocation_bank_steps = steps; }
+
+  // allocate the dynamics factors of trajectory graphs in an arena
+  void setArenaAllocation(bool arena = true) { arena_allocation = arena; }
+
+  // set the obstacle clearance and its cost model sigma
+  void setCollisionSetting(double clearance, double sigma) {
+    epsilon = clearance;
+    obsSigma = sigma;
+  }
 };
 
 }  // namespace gtdynamics
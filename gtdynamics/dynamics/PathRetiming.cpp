@@ -0,0 +1,237 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PathRetiming.cpp
+ * @brief Time-optimal retiming of geometric paths under joint limits.
+ */
+
+#include "gtdynamics/dynamics/PathRetiming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+
+// Bound on x = ds/dt^2, for paths that no limit slows down.
+constexpr double kMaxSquaredSpeed = 1e12;
+
+// Coefficients below this are taken as zero, so no bound on u.
+constexpr double kZero = 1e-12;
+
+// Slack on interval bounds, relative to their magnitude.
+double Tolerance(double value) { return 1e-9 * (1 + std::abs(value)); }
+
+// Limits by joint slot: `overrides` if not empty, else from the robot.
+Vector Limits(const Robot &robot, size_t J, const Vector &overrides,
+              double (*limit)(const JointParams &), const char *name) {
+  if (overrides.size()) {
+    if (size_t(overrides.size()) != J)
+      throw std::invalid_argument(std::string("PathRetiming: ") + name +
+                                  " need one entry per joint slot.");
+    return overrides;
+  }
+  Vector limits = Vector::Constant(J, kInfinity);
+  for (auto &&joint : robot.joints())
+    limits(joint->id()) = limit(joint->parameters());
+  return limits;
+}
+
+// Interval [lo, hi] of x such that some u satisfies all half-planes, by
+// eliminating u: every lower bound on u must be below every upper bound.
+template <typename HalfPlane>
+bool FeasibleX(const std::vector<HalfPlane> &planes, double *lo, double *hi) {
+  *lo = -kInfinity;
+  *hi = kInfinity;
+  auto bound = [&](double beta, double gamma) {  // beta x <= gamma
+    if (beta > kZero)
+      *hi = std::min(*hi, gamma / beta);
+    else if (beta < -kZero)
+      *lo = std::max(*lo, gamma / beta);
+    else if (gamma < -Tolerance(0))
+      *hi = -kInfinity;
+  };
+  for (size_t k = 0; k < planes.size(); ++k) {
+    const HalfPlane &l = planes[k];
+    if (std::abs(l.alpha) <= kZero) {
+      bound(l.beta, l.gamma);
+      continue;
+    }
+    if (l.alpha > 0) continue;
+    // u >= (gamma_l - beta_l x) / alpha_l, against every upper bound.
+    for (auto &&h : planes) {
+      if (h.alpha <= kZero) continue;
+      bound(h.beta / h.alpha - l.beta / l.alpha,
+            h.gamma / h.alpha - l.gamma / l.alpha);
+    }
+  }
+  return *lo <= *hi + Tolerance(*hi);
+}
+
+// Largest u satisfying all half-planes at a given x.
+template <typename HalfPlane>
+double MaxU(const std::vector<HalfPlane> &planes, double x) {
+  double lo = -kInfinity, hi = kInfinity;
+  for (auto &&plane : planes) {
+    const double gamma = plane.gamma - plane.beta * x;
+    if (plane.alpha > kZero)
+      hi = std::min(hi, gamma / plane.alpha);
+    else if (plane.alpha < -kZero)
+      lo = std::max(lo, gamma / plane.alpha);
+  }
+  // x is feasible, so lo > hi only by round-off.
+  return std::max(lo, hi);
+}
+}  // namespace
+
+/* ************************************************************************* */
+PathRetiming::PathRetiming(const Robot &robot,
+                           const PathRetimingParameters &parameters)
+    : p_(parameters), dynamics_(robot, parameters.gravity,
+                                parameters.num_threads) {
+  const size_t J = dynamics_.numJointSlots();
+  torque_limits_ = Limits(
+      robot, J, p_.torque_limits,
+      [](const JointParams &p) { return p.torque_limit; }, "torque limits");
+  velocity_limits_ = Limits(
+      robot, J, p_.velocity_limits,
+      [](const JointParams &p) { return p.velocity_limit; },
+      "velocity limits");
+  acceleration_limits_ = Limits(
+      robot, J, p_.acceleration_limits,
+      [](const JointParams &p) { return p.acceleration_limit; },
+      "acceleration limits");
+  if (p_.start_speed < 0 || p_.end_speed < 0)
+    throw std::invalid_argument(
+        "PathRetiming: start and end speeds should be non-negative.");
+}
+
+/* ************************************************************************* */
+void PathRetiming::addConstraints(size_t i, double ds) {
+  constraints_.clear();
+  constraints_.push_back({0, -1, 0});
+  constraints_.push_back({0, 1, kMaxSquaredSpeed});
+  for (size_t j = 0; j < numJointSlots(); ++j) {
+    const double tau = torque_limits_(j);
+    if (std::isfinite(tau)) {
+      constraints_.push_back({a_(i, j), b_(i, j), tau - c_(i, j)});
+      constraints_.push_back({-a_(i, j), -b_(i, j), tau + c_(i, j)});
+    }
+    const double acceleration = acceleration_limits_(j);
+    if (std::isfinite(acceleration)) {
+      constraints_.push_back({dQ_(i, j), ddQ_(i, j), acceleration});
+      constraints_.push_back({-dQ_(i, j), -ddQ_(i, j), acceleration});
+    }
+    const double velocity = velocity_limits_(j);
+    if (std::isfinite(velocity))
+      constraints_.push_back(
+          {0, dQ_(i, j) * dQ_(i, j), velocity * velocity});
+  }
+}
+
+/* ************************************************************************* */
+PathRetimingResult PathRetiming::retime(const Matrix &Q) {
+  const size_t N = Q.rows(), J = numJointSlots();
+  if (N < 2 || size_t(Q.cols()) != J)
+    throw std::invalid_argument(
+        "PathRetiming: paths need at least two waypoints and one column per "
+        "joint slot.");
+  const double ds = 1.0 / (N - 1);
+
+  // Path derivatives by finite differences.
+  dQ_.resize(N, J);
+  ddQ_.setZero(N, J);
+  dQ_.row(0) = (Q.row(1) - Q.row(0)) / ds;
+  dQ_.row(N - 1) = (Q.row(N - 1) - Q.row(N - 2)) / ds;
+  for (size_t i = 1; i + 1 < N; ++i) {
+    dQ_.row(i) = (Q.row(i + 1) - Q.row(i - 1)) / (2 * ds);
+    ddQ_.row(i) = (Q.row(i + 1) - 2 * Q.row(i) + Q.row(i - 1)) / (ds * ds);
+  }
+  if (N > 2) {
+    ddQ_.row(0) = ddQ_.row(1);
+    ddQ_.row(N - 1) = ddQ_.row(N - 2);
+  }
+
+  // Torque coefficients tau = a u + b x + c, from batch inverse dynamics.
+  zero_.setZero(N, J);
+  c_ = dynamics_.torques(Q, zero_, zero_);
+  a_ = dynamics_.torques(Q, zero_, dQ_) - c_;
+  b_ = dynamics_.torques(Q, dQ_, ddQ_) - c_;
+
+  // Backward pass: intervals of x from which the end is reachable.
+  std::vector<double> lo(N), hi(N);
+  addConstraints(N - 1, ds);
+  const double x_end = p_.end_speed * p_.end_speed;
+  if (!FeasibleX(constraints_, &lo[N - 1], &hi[N - 1]) ||
+      x_end < lo[N - 1] - Tolerance(x_end) ||
+      x_end > hi[N - 1] + Tolerance(x_end))
+    throw std::runtime_error(
+        "PathRetiming: the end speed is beyond the limits.");
+  lo[N - 1] = hi[N - 1] = x_end;
+  for (size_t i = N - 1; i-- > 0;) {
+    addConstraints(i, ds);
+    constraints_.push_back({2 * ds, 1, hi[i + 1]});
+    constraints_.push_back({-2 * ds, -1, -lo[i + 1]});
+    if (!FeasibleX(constraints_, &lo[i], &hi[i]))
+      throw std::runtime_error(
+          "PathRetiming: no timing respects the limits at waypoint " +
+          std::to_string(i) + ".");
+    lo[i] = std::max(lo[i], 0.0);
+  }
+  double x = p_.start_speed * p_.start_speed;
+  if (x < lo[0] - Tolerance(x) || x > hi[0] + Tolerance(x))
+    throw std::runtime_error(
+        "PathRetiming: the start speed is beyond the limits.");
+
+  // Forward pass: accelerate as much as the next interval allows.
+  std::vector<double> xs(N), us(N);
+  xs[0] = std::min(std::max(x, lo[0]), hi[0]);
+  for (size_t i = 0; i + 1 < N; ++i) {
+    addConstraints(i, ds);
+    constraints_.push_back({2 * ds, 1, hi[i + 1]});
+    constraints_.push_back({-2 * ds, -1, -lo[i + 1]});
+    const double u = MaxU(constraints_, xs[i]);
+    xs[i + 1] = std::min(std::max(xs[i] + 2 * ds * u, lo[i + 1]), hi[i + 1]);
+    us[i] = (xs[i + 1] - xs[i]) / (2 * ds);
+  }
+  us[N - 1] = us[N - 2];
+
+  PathRetimingResult result;
+  result.times.resize(N);
+  result.speeds.resize(N);
+  result.V.resize(N, J);
+  result.A.resize(N, J);
+  result.torques.resize(N, J);
+  result.times(0) = 0;
+  for (size_t i = 0; i < N; ++i) {
+    const double speed = std::sqrt(xs[i]);
+    result.speeds(i) = speed;
+    if (i > 0) {
+      const double sum = result.speeds(i - 1) + speed;
+      if (sum <= 0)
+        throw std::runtime_error(
+            "PathRetiming: the path stops between waypoints " +
+            std::to_string(i - 1) + " and " + std::to_string(i) + ".");
+      result.times(i) = result.times(i - 1) + 2 * ds / sum;
+    }
+    result.V.row(i) = dQ_.row(i) * speed;
+    result.A.row(i) = dQ_.row(i) * us[i] + ddQ_.row(i) * xs[i];
+    result.torques.row(i) = a_.row(i) * us[i] + b_.row(i) * xs[i] + c_.row(i);
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
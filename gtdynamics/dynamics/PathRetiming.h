@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PathRetiming.h
+ * @brief Time-optimal retiming of geometric paths under joint limits.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "gtdynamics/dynamics/BatchInverseDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/// Parameters of PathRetiming.
+struct PathRetimingParameters {
+  boost::optional<gtsam::Vector3> gravity = gtsam::Vector3(0, 0, -9.8);
+
+  /// Limits by joint id, overriding the JointParams of the robot if not
+  /// empty. Infinite entries disable a limit.
+  gtsam::Vector torque_limits, velocity_limits, acceleration_limits;
+
+  double start_speed = 0;  ///< path speed ds/dt at the first waypoint
+  double end_speed = 0;    ///< path speed ds/dt at the last waypoint
+  size_t num_threads = 0;  ///< for the inverse dynamics, 0 for all cores
+};
+
+/**
+ * Timing of a retimed path, one row or entry per waypoint. The limits hold
+ * on the accelerations of each segment, which the last waypoint shares with
+ * the one before it.
+ */
+struct PathRetimingResult {
+  gtsam::Vector times;    ///< seconds, from 0
+  gtsam::Vector speeds;   ///< path speed ds/dt, with s in [0, 1]
+  gtsam::Matrix V;        ///< joint velocities, #waypoints x #joint slots
+  gtsam::Matrix A;        ///< joint accelerations
+  gtsam::Matrix torques;  ///< joint torques of the retimed motion
+
+  /// Duration of the retimed path.
+  double duration() const { return times.size() ? times(times.size() - 1) : 0; }
+};
+
+/**
+ * PathRetiming finds the fastest timing s(t) of a fixed geometric path q(s),
+ * with torque, velocity and acceleration limits on every joint, in the
+ * reachability analysis formulation of time-optimal path parameterization
+ * (TOPP-RA, Pham and Pham 2018).
+ *
+ * Along the path, with x = ds/dt^2 and u = d^2s/dt^2, the torques are
+ * tau = a(s) u + b(s) x + c(s), whose coefficients come from three batch
+ * inverse dynamics solves over all waypoints: c with zero velocity and
+ * acceleration, a with acceleration q'(s), b with velocity q'(s) and
+ * acceleration q''(s). Accelerations q' u + q'' x and squared velocities
+ * q'^2 x are linear in (u, x) too, so each waypoint gives a few half-planes
+ * in (u, x), and x_{i+1} = x_i + 2 ds u_i links consecutive waypoints.
+ *
+ * A backward pass computes the interval of x at every waypoint from which
+ * the end is reachable, each a two-variable LP solved exactly by
+ * eliminating u; a forward pass then picks the largest u that stays in the
+ * next interval. Both passes are linear in the number of waypoints.
+ *
+ * Waypoints are taken as evenly spaced in s, in [0, 1], with derivatives
+ * by finite differences; floating roots are at rest at the identity, as in
+ * BatchInverseDynamics, so the limits are for fixed-base robots.
+ */
+class PathRetiming {
+ public:
+  explicit PathRetiming(
+      const Robot &robot,
+      const PathRetimingParameters &parameters = PathRetimingParameters());
+
+  /// Number of joint slots, i.e., of columns of the paths.
+  size_t numJointSlots() const { return dynamics_.numJointSlots(); }
+
+  /**
+   * Retime a path.
+   * @param Q waypoints, #waypoints x #joint slots, at least two
+   * Throws std::runtime_error if no timing respects the limits, e.g. when
+   * the static torques of some waypoint are beyond the limits.
+   */
+  PathRetimingResult retime(const gtsam::Matrix &Q);
+
+ private:
+  // Half-plane alpha u + beta x <= gamma.
+  struct HalfPlane {
+    double alpha, beta, gamma;
+  };
+
+  // Constraints of waypoint i, in constraints_.
+  void addConstraints(size_t i, double ds);
+
+  PathRetimingParameters p_;
+  BatchInverseDynamics dynamics_;
+  gtsam::Vector torque_limits_, velocity_limits_, acceleration_limits_;
+
+  gtsam::Matrix dQ_, ddQ_, a_, b_, c_, zero_;  // per waypoint
+  std::vector<HalfPlane> constraints_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,231 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsGraph.cpp
+ * @brief Dynamics factor graphs of planar robots with SE(2) variables.
+ */
+
+#include "gtdynamics/dynamics/PlanarDynamicsGraph.h"
+
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose2;
+using gtsam::Pose3;
+using gtsam::SharedNoiseModel;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// Tolerance on out-of-plane components of the robot description.
+constexpr double kPlanarTolerance = 1e-6;
+
+// The in-plane sigmas of a 6-d diagonal cost model, in Pose2 order.
+SharedNoiseModel InPlane(const SharedNoiseModel &model,
+                         const std::string &name) {
+  if (model && model->dim() == 3) return model;
+  const auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  if (!diagonal || diagonal->dim() != 6)
+    throw std::invalid_argument("PlanarDynamicsGraph: " + name +
+                                " needs to be a diagonal noise model of "
+                                "dimension 3 or 6.");
+  const gtsam::Vector sigmas = diagonal->sigmas();
+  return gtsam::noiseModel::Diagonal::Sigmas(
+      Vector3(sigmas(3), sigmas(4), sigmas(2)), true);
+}
+}  // namespace
+
+/* ************************************************************************* */
+PlanarDynamicsGraph::PlanarDynamicsGraph(
+    const Robot &robot, const Vector3 &planar_axis,
+    const boost::optional<Vector3> &gravity, const OptimizerSetting &opt)
+    : bp_model_(InPlane(opt.bp_cost_model, "bp_cost_model")),
+      bv_model_(InPlane(opt.bv_cost_model, "bv_cost_model")),
+      ba_model_(InPlane(opt.ba_cost_model, "ba_cost_model")),
+      p_model_(InPlane(opt.p_cost_model, "p_cost_model")),
+      v_model_(InPlane(opt.v_cost_model, "v_cost_model")),
+      a_model_(InPlane(opt.a_cost_model, "a_cost_model")),
+      fa_model_(InPlane(opt.fa_cost_model, "fa_cost_model")),
+      t_model_(opt.t_cost_model) {
+  const double norm = planar_axis.norm();
+  if (norm < kPlanarTolerance)
+    throw std::invalid_argument("PlanarDynamicsGraph: zero planar axis.");
+  axis_ = planar_axis / norm;
+  const Vector3 first =
+      std::abs(axis_.x()) < 0.9 ? Vector3::UnitX() : Vector3::UnitY();
+  e1_ = (first - first.dot(axis_) * axis_).normalized();
+  e2_ = axis_.cross(e1_);
+  if (gravity) gravity_ = gtsam::Vector2(gravity->dot(e1_), gravity->dot(e2_));
+
+  for (auto &&link : robot.links()) {
+    const Pose3 &pose = link->isFixed() ? link->getFixedPose() : link->bMcom();
+    const gtsam::Matrix3 &I = link->inertia();
+    links_.push_back({link->id(), link->mass(), axis_.dot(I * axis_),
+                      project(pose), link->isFixed()});
+  }
+  for (auto &&joint : robot.joints()) {
+    const Vector6 &S = joint->cScrewAxis();
+    const Vector3 w = S.head<3>(), v = S.tail<3>();
+    if ((w - w.dot(axis_) * axis_).norm() > kPlanarTolerance ||
+        std::abs(v.dot(axis_)) > kPlanarTolerance)
+      throw std::invalid_argument("PlanarDynamicsGraph: joint " +
+                                  joint->name() +
+                                  " does not move in the plane.");
+    PlanarJoint planar;
+    planar.id = joint->id();
+    planar.parent = joint->parent()->id();
+    planar.child = joint->child()->id();
+    planar.model.pMc = project(joint->pMc());
+    planar.model.screw_axis = project(S);
+    if (size_t(planar.id) >= joint_index_.size())
+      joint_index_.resize(planar.id + 1, -1);
+    joint_index_[planar.id] = joints_.size();
+    joints_.push_back(planar);
+  }
+}
+
+/* ************************************************************************* */
+Pose2 PlanarDynamicsGraph::project(const Pose3 &pose) const {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  if ((R * axis_ - axis_).norm() > kPlanarTolerance)
+    throw std::invalid_argument(
+        "PlanarDynamicsGraph: pose does not rotate about the planar axis.");
+  const Vector3 x = R * e1_;
+  const Vector3 &t = pose.translation();
+  return Pose2(t.dot(e1_), t.dot(e2_), std::atan2(x.dot(e2_), x.dot(e1_)));
+}
+
+/* ************************************************************************* */
+Vector3 PlanarDynamicsGraph::project(const Vector6 &twist) const {
+  const Vector3 w = twist.head<3>(), v = twist.tail<3>();
+  return Vector3(v.dot(e1_), v.dot(e2_), w.dot(axis_));
+}
+
+/* ************************************************************************* */
+const PlanarJointModel &PlanarDynamicsGraph::joint(int j) const {
+  if (j < 0 || size_t(j) >= joint_index_.size() || joint_index_[j] < 0)
+    throw std::out_of_range("PlanarDynamicsGraph: no joint with id " +
+                            std::to_string(j) + ".");
+  return joints_[joint_index_[j]].model;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::qFactors(size_t t) const {
+  NonlinearFactorGraph graph;
+  for (auto &&link : links_)
+    if (link.fixed)
+      graph.emplace_shared<gtsam::PriorFactor<Pose2>>(
+          internal::PoseKey(link.id, t), link.rest, bp_model_);
+  for (auto &&joint : joints_)
+    graph.emplace_shared<PlanarPoseFactor>(
+        internal::PoseKey(joint.parent, t), internal::PoseKey(joint.child, t),
+        internal::JointAngleKey(joint.id, t), p_model_, joint.model);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::vFactors(size_t t) const {
+  NonlinearFactorGraph graph;
+  for (auto &&link : links_)
+    if (link.fixed)
+      graph.emplace_shared<gtsam::PriorFactor<Vector3>>(
+          internal::TwistKey(link.id, t), Vector3::Zero(), bv_model_);
+  for (auto &&joint : joints_)
+    graph.emplace_shared<PlanarTwistFactor>(
+        internal::TwistKey(joint.parent, t), internal::TwistKey(joint.child, t),
+        internal::JointAngleKey(joint.id, t),
+        internal::JointVelKey(joint.id, t), v_model_, joint.model);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::aFactors(size_t t) const {
+  NonlinearFactorGraph graph;
+  for (auto &&link : links_)
+    if (link.fixed)
+      graph.emplace_shared<gtsam::PriorFactor<Vector3>>(
+          internal::TwistAccelKey(link.id, t), Vector3::Zero(), ba_model_);
+  for (auto &&joint : joints_)
+    graph.emplace_shared<PlanarTwistAccelFactor>(
+        internal::TwistAccelKey(joint.parent, t),
+        internal::TwistAccelKey(joint.child, t),
+        internal::TwistKey(joint.child, t),
+        internal::JointAngleKey(joint.id, t),
+        internal::JointVelKey(joint.id, t),
+        internal::JointAccelKey(joint.id, t), a_model_, joint.model);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::dynamicsFactors(size_t t) const {
+  NonlinearFactorGraph graph;
+  for (auto &&link : links_) {
+    if (link.fixed) continue;
+    std::vector<PlanarWrenchFactor::JointWrench> wrenches;
+    for (auto &&joint : joints_) {
+      if (joint.child != link.id && joint.parent != link.id) continue;
+      PlanarWrenchFactor::JointWrench wrench;
+      wrench.wrench_key = internal::WrenchKey(joint.child, joint.id, t);
+      wrench.q_key = internal::JointAngleKey(joint.id, t);
+      wrench.is_parent = joint.parent == link.id;
+      wrench.joint = joint.model;
+      wrenches.push_back(wrench);
+    }
+    graph.emplace_shared<PlanarWrenchFactor>(
+        internal::PoseKey(link.id, t), internal::TwistKey(link.id, t),
+        internal::TwistAccelKey(link.id, t), wrenches, fa_model_, link.mass,
+        link.inertia, gravity_);
+  }
+  for (auto &&joint : joints_)
+    graph.emplace_shared<PlanarTorqueFactor>(
+        internal::WrenchKey(joint.child, joint.id, t),
+        internal::TorqueKey(joint.id, t), t_model_, joint.model);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph PlanarDynamicsGraph::dynamicsFactorGraph(
+    size_t t) const {
+  NonlinearFactorGraph graph;
+  graph.add(qFactors(t));
+  graph.add(vFactors(t));
+  graph.add(aFactors(t));
+  graph.add(dynamicsFactors(t));
+  return graph;
+}
+
+/* ************************************************************************* */
+gtsam::Values PlanarDynamicsGraph::zeroValues(size_t t) const {
+  gtsam::Values values;
+  for (auto &&link : links_) {
+    values.insert(internal::PoseKey(link.id, t), link.rest);
+    values.insert(internal::TwistKey(link.id, t), Vector3::Zero().eval());
+    values.insert(internal::TwistAccelKey(link.id, t), Vector3::Zero().eval());
+  }
+  for (auto &&joint : joints_) {
+    const int j = joint.id;
+    values.insert(internal::WrenchKey(joint.child, j, t),
+                  Vector3::Zero().eval());
+    InsertJointAngle(&values, j, t, 0.0);
+    InsertJointVel(&values, j, t, 0.0);
+    InsertJointAccel(&values, j, t, 0.0);
+    InsertTorque(&values, j, t, 0.0);
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsGraph.h
+ * @brief Dynamics factor graphs of planar robots with SE(2) variables.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/factors/PlanarDynamicsFactors.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * PlanarDynamicsGraph builds the kinematics and dynamics graphs of a robot
+ * moving in a plane natively on SE(2), instead of DynamicsGraph with a
+ * planar axis, which keeps Pose3 and 6-vector variables and pins their
+ * out-of-plane components with WrenchPlanarFactors and planar priors.
+ *
+ * Link poses are Pose2 and twists, twist accelerations and wrenches are
+ * 3-vectors, in the Pose2 tangent order (linear x, linear y, angular, see
+ * PlanarJointModel), under the same keys as DynamicsGraph: the values of
+ * the two graphs cannot be mixed. Only the wrench of each joint on its child
+ * link is a variable. Compared to the SE(3) graph, that halves the dimension
+ * of every link variable and removes two wrenches of 6 per joint, as well
+ * as the wrench equivalence and planar factors.
+ *
+ * The plane is spanned by (e1, e2), orthonormal with e1 x e2 the planar
+ * axis: e1 is the world x axis projected into the plane, or the y axis if
+ * x is nearly the planar axis. All link CoM frames need to rotate about the
+ * planar axis, and joints to be revolute about it or prismatic in the
+ * plane; gravity out of the plane is ignored. Contacts are not supported.
+ */
+class PlanarDynamicsGraph {
+ public:
+  /**
+   * Constructor
+   * @param robot        the robot
+   * @param planar_axis  normal of the plane of motion
+   * @param gravity      gravity in the world frame, if any
+   * @param opt          the cost models; 6-d models are restricted to their
+   *                     in-plane sigmas
+   */
+  PlanarDynamicsGraph(const Robot &robot, const gtsam::Vector3 &planar_axis,
+                      const boost::optional<gtsam::Vector3> &gravity =
+                          boost::none,
+                      const OptimizerSetting &opt = OptimizerSetting());
+
+  /// Planar pose of a Pose3 that rotates about the planar axis.
+  gtsam::Pose2 project(const gtsam::Pose3 &pose) const;
+
+  /// Planar components of a twist or wrench in a link frame.
+  gtsam::Vector3 project(const gtsam::Vector6 &twist) const;
+
+  /// The joint of the robot with id j.
+  const PlanarJointModel &joint(int j) const;
+
+  /// Pose factors of all joints, and priors on fixed link poses.
+  gtsam::NonlinearFactorGraph qFactors(size_t t) const;
+
+  /// Twist factors of all joints, and priors on fixed link twists.
+  gtsam::NonlinearFactorGraph vFactors(size_t t) const;
+
+  /// Twist acceleration factors, and priors on fixed link accelerations.
+  gtsam::NonlinearFactorGraph aFactors(size_t t) const;
+
+  /// Wrench balance of every moving link, and torque factors.
+  gtsam::NonlinearFactorGraph dynamicsFactors(size_t t) const;
+
+  /// All of the above.
+  gtsam::NonlinearFactorGraph dynamicsFactorGraph(size_t t) const;
+
+  /// Rest poses and zeros for all variables of dynamicsFactorGraph(t).
+  gtsam::Values zeroValues(size_t t) const;
+
+ private:
+  struct PlanarLink {
+    int id;
+    double mass, inertia;
+    gtsam::Pose2 rest;  // pose at rest, or fixed pose
+    bool fixed;
+  };
+  struct PlanarJoint {
+    int id, parent, child;
+    PlanarJointModel model;
+  };
+
+  gtsam::Vector3 e1_, e2_, axis_;
+  boost::optional<gtsam::Vector2> gravity_;
+  gtsam::SharedNoiseModel bp_model_, bv_model_, ba_model_, p_model_, v_model_,
+      a_model_, fa_model_, t_model_;
+  std::vector<PlanarLink> links_;
+  std::vector<PlanarJoint> joints_;
+  std::vector<int> joint_index_;  // by joint id, -1 if none
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,333 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanningService.cpp
+ * @brief Long-running planner that batches requests onto a worker pool.
+ */
+
+#include "gtdynamics/dynamics/PlanningService.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+#include "gtdynamics/statics/Statics.h"
+#include "gtdynamics/utils/Slice.h"
+
+namespace gtdynamics {
+
+namespace {
+double Seconds(std::chrono::steady_clock::duration d) {
+  return std::chrono::duration<double>(d).count();
+}
+
+PlanningResult Failure(PlanningResult::Status status,
+                       const std::string &message) {
+  PlanningResult result;
+  result.status = status;
+  result.message = message;
+  return result;
+}
+}  // namespace
+
+/* ************************************************************************* */
+PlanningService::PlanningService(const PlanningServiceParameters &parameters)
+    : p_(parameters),
+      pool_(parameters.num_threads),
+      warm_starts_(parameters.warm_start_capacity),
+      dispatcher_(&PlanningService::dispatchLoop, this) {}
+
+/* ************************************************************************* */
+PlanningService::~PlanningService() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  dispatcher_.join();
+}
+
+/* ************************************************************************* */
+void PlanningService::addRobot(const std::string &name, const Robot &robot) {
+  auto shared = std::make_shared<const Robot>(robot);
+  std::lock_guard<std::mutex> lock(robots_mutex_);
+  robots_[name] = shared;
+}
+
+/* ************************************************************************* */
+std::future<PlanningResult> PlanningService::inverseKinematics(
+    const std::string &robot, const std::vector<PointGoal> &goals) {
+  std::unique_ptr<Request> request(new Request);
+  request->kind = Kind::InverseKinematics;
+  request->robot = robot;
+  request->goals = goals;
+  return submit(std::move(request));
+}
+
+/* ************************************************************************* */
+std::future<PlanningResult> PlanningService::statics(
+    const std::string &robot, const gtsam::Values &configuration) {
+  std::unique_ptr<Request> request(new Request);
+  request->kind = Kind::Statics;
+  request->robot = robot;
+  request->configuration = configuration;
+  return submit(std::move(request));
+}
+
+/* ************************************************************************* */
+std::future<PlanningResult> PlanningService::trajectory(
+    const GaitProblem &problem) {
+  std::unique_ptr<Request> request(new Request);
+  request->kind = Kind::Trajectory;
+  request->problem = problem;
+  return submit(std::move(request));
+}
+
+/* ************************************************************************* */
+std::future<PlanningResult> PlanningService::submit(
+    std::unique_ptr<Request> request) {
+  std::future<PlanningResult> future = request->promise.get_future();
+  request->submitted = Clock::now();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (queue_.size() < p_.max_pending && !stop_) {
+      queue_.push_back(std::move(request));
+    }
+  }
+  if (request) {
+    {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      ++stats_.rejected;
+    }
+    request->promise.set_value(Failure(PlanningResult::Status::Rejected,
+                                       "too many pending requests"));
+    return future;
+  }
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    ++stats_.accepted;
+  }
+  queue_cv_.notify_one();
+  return future;
+}
+
+/* ************************************************************************* */
+size_t PlanningService::numPending() const {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queue_.size();
+}
+
+/* ************************************************************************* */
+PlanningServiceStats PlanningService::stats() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return stats_;
+}
+
+/* ************************************************************************* */
+void PlanningService::dispatchLoop() {
+  while (true) {
+    std::vector<std::unique_ptr<Request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) return;  // stopped, and all requests are done
+      const size_t n =
+          std::min(queue_.size(), std::max<size_t>(p_.max_batch, 1));
+      for (size_t i = 0; i < n; ++i) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+    }
+    process(&batch);
+  }
+}
+
+/* ************************************************************************* */
+void PlanningService::process(std::vector<std::unique_ptr<Request>> *batch) {
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    ++stats_.batches;
+  }
+  const Clock::time_point now = Clock::now();
+  std::map<std::string, std::vector<Request *>> inverse_kinematics;
+  std::vector<Request *> others;
+  for (auto &&request : *batch) {
+    request->dispatched = now;
+    if (request->kind == Kind::InverseKinematics)
+      inverse_kinematics[request->robot].push_back(request.get());
+    else
+      others.push_back(request.get());
+  }
+
+  // Each group of inverse kinematics requests is one batch, over as many
+  // threads as the pool has.
+  for (auto &&group : inverse_kinematics) solveInverseKinematics(group.second);
+
+  pool_.parallelFor(others.size(), [&](size_t i, size_t /*worker*/) {
+    PlanningResult result;
+    try {
+      result = solve(*others[i]);
+    } catch (const std::exception &e) {
+      result = Failure(PlanningResult::Status::Failed, e.what());
+    }
+    finish(others[i], std::move(result));
+  });
+}
+
+/* ************************************************************************* */
+void PlanningService::solveInverseKinematics(
+    const std::vector<Request *> &requests) {
+  std::shared_ptr<const Robot> robot;
+  try {
+    robot = this->robot(requests.front()->robot);
+  } catch (const std::exception &e) {
+    for (auto &&request : requests)
+      finish(request, Failure(PlanningResult::Status::Failed, e.what()));
+    return;
+  }
+
+  // Requests with unknown links fail by themselves.
+  std::vector<Request *> valid;
+  std::vector<ContactGoals> queries;
+  for (auto &&request : requests) {
+    try {
+      ContactGoals goals;
+      for (auto &&goal : request->goals)
+        goals.emplace_back(
+            PointOnLink(robot->link(goal.link), goal.point_in_com),
+            goal.goal_point);
+      queries.push_back(goals);
+      valid.push_back(request);
+    } catch (const std::exception &e) {
+      finish(request, Failure(PlanningResult::Status::Failed, e.what()));
+    }
+  }
+  if (valid.empty()) return;
+
+  std::vector<InverseKinematicsResult> results;
+  try {
+    const Kinematics kinematics(p_.kinematics_parameters);
+    results = kinematics.inverseBatch(Slice(0), *robot, queries,
+                                      pool_.numThreads());
+  } catch (const std::exception &e) {
+    for (auto &&request : valid)
+      finish(request, Failure(PlanningResult::Status::Failed, e.what()));
+    return;
+  }
+  for (size_t q = 0; q < valid.size(); ++q) {
+    PlanningResult result;
+    result.values = std::move(results[q].values);
+    result.converged = results[q].converged;
+    result.error = results[q].error;
+    finish(valid[q], std::move(result));
+  }
+}
+
+/* ************************************************************************* */
+PlanningResult PlanningService::solve(const Request &request) {
+  PlanningResult result;
+  if (request.kind == Kind::Statics) {
+    const std::shared_ptr<const Robot> robot = this->robot(request.robot);
+    const Statics statics(StaticsParameters(1e-5, p_.gravity));
+    const Slice slice(0);
+    result.values = statics.solve(slice, *robot, request.configuration);
+    result.error = statics.graph(slice, *robot).error(result.values);
+    return result;
+  }
+
+  const std::shared_ptr<const GraphTemplate> t =
+      graphTemplate(request.problem);
+  const boost::optional<gtsam::Values> warm_start =
+      warm_starts_.nearest(t->signature, t->features);
+  result.warm_started = static_cast<bool>(warm_start);
+  const Optimizer optimizer(p_.trajectory_parameters);
+  result.values = optimizer.optimize(
+      t->graph, warm_start ? *warm_start : t->initial_values);
+  result.error = t->graph.error(result.values);
+  warm_starts_.insert(t->signature, t->features, result.values);
+  return result;
+}
+
+/* ************************************************************************* */
+void PlanningService::finish(Request *request, PlanningResult result) {
+  const Clock::time_point done = Clock::now();
+  result.queue_seconds = Seconds(request->dispatched - request->submitted);
+  result.solve_seconds = Seconds(done - request->dispatched);
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (result.status == PlanningResult::Status::Solved)
+      ++stats_.solved;
+    else
+      ++stats_.failed;
+    const double latency = result.queue_seconds + result.solve_seconds;
+    total_latency_ += latency;
+    stats_.mean_latency = total_latency_ / (stats_.solved + stats_.failed);
+    stats_.max_latency = std::max(stats_.max_latency, latency);
+  }
+  request->promise.set_value(std::move(result));
+}
+
+/* ************************************************************************* */
+std::shared_ptr<const Robot> PlanningService::robot(
+    const std::string &name) const {
+  std::lock_guard<std::mutex> lock(robots_mutex_);
+  auto it = robots_.find(name);
+  if (it == robots_.end())
+    throw std::invalid_argument("PlanningService: no robot " + name);
+  return it->second;
+}
+
+/* ************************************************************************* */
+std::shared_ptr<const Robot> PlanningService::loadRobot(
+    const GaitProblem &problem) {
+  const std::string name = problem.model_file + "#" + problem.model_name;
+  {
+    std::lock_guard<std::mutex> lock(robots_mutex_);
+    auto it = robots_.find(name);
+    if (it != robots_.end()) return it->second;
+  }
+  // Load outside the lock; concurrent first requests may both load.
+  auto robot = std::make_shared<const Robot>(problem.robot());
+  std::lock_guard<std::mutex> lock(robots_mutex_);
+  return robots_.emplace(name, robot).first->second;
+}
+
+/* ************************************************************************* */
+std::shared_ptr<const PlanningService::GraphTemplate>
+PlanningService::graphTemplate(const GaitProblem &problem) {
+  const std::string key = problem.encode();
+  {
+    std::lock_guard<std::mutex> lock(templates_mutex_);
+    auto it = templates_.find(key);
+    if (it != templates_.end()) return it->second;
+  }
+
+  auto t = std::make_shared<GraphTemplate>();
+  t->robot = loadRobot(problem);
+  const Trajectory trajectory = problem.trajectory(*t->robot);
+  t->graph = problem.graph(*t->robot);
+  t->initial_values =
+      trajectory.multiPhaseInitialValues(*t->robot, 1e-5, problem.dt);
+  t->signature =
+      WarmStartCache::Signature(*t->robot, trajectory.phaseDurations());
+  t->features = WarmStartCache::GoalFeatures(t->graph);
+
+  std::lock_guard<std::mutex> lock(templates_mutex_);
+  auto inserted = templates_.emplace(key, t);
+  if (!inserted.second) return inserted.first->second;
+  template_order_.push_back(key);
+  while (p_.max_graph_templates > 0 &&
+         templates_.size() > p_.max_graph_templates) {
+    templates_.erase(template_order_.front());
+    template_order_.pop_front();
+  }
+  return t;
+}
+
+}  // namespace gtdynamics
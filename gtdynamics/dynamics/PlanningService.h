@@ -0,0 +1,209 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanningService.h
+ * @brief Long-running planner that batches requests onto a worker pool.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/WarmStartCache.h"
+#include "gtdynamics/utils/WireFormat.h"
+
+namespace gtdynamics {
+
+/// Parameters of PlanningService.
+struct PlanningServiceParameters {
+  /// Threads solving requests, including the dispatcher, 0 for all cores.
+  size_t num_threads = 0;
+
+  /// Requests waiting beyond this number are rejected on submission.
+  size_t max_pending = 256;
+
+  /// Requests taken from the queue and dispatched together.
+  size_t max_batch = 32;
+
+  /// Trajectory graphs kept for reuse, oldest first out.
+  size_t max_graph_templates = 64;
+
+  /// Solutions kept per problem signature for warm starts.
+  size_t warm_start_capacity = 100;
+
+  /// Gravity of statics requests.
+  boost::optional<gtsam::Vector3> gravity = gtsam::Vector3(0, 0, -9.8);
+
+  /// Parameters of inverse kinematics requests.
+  KinematicsParameters kinematics_parameters;
+
+  /// Optimizer parameters of trajectory requests.
+  OptimizationParameters trajectory_parameters;
+};
+
+/// A point on a named link and its goal in the world frame.
+struct PointGoal {
+  std::string link;
+  gtsam::Point3 point_in_com, goal_point;
+};
+
+/// Outcome of one request.
+struct PlanningResult {
+  enum class Status { Solved, Rejected, Failed };
+
+  Status status = Status::Solved;
+  gtsam::Values values;       ///< solution
+  bool converged = false;     ///< inverse kinematics constraints are met
+  double error = 0;           ///< objective error of the solution
+  bool warm_started = false;  ///< started from a cached solution
+  std::string message;        ///< reason of a rejection or failure
+  double queue_seconds = 0;   ///< from submission to dispatch
+  double solve_seconds = 0;   ///< from dispatch to completion
+};
+
+/// Counters and latencies of a PlanningService since construction.
+struct PlanningServiceStats {
+  size_t accepted = 0, rejected = 0, solved = 0, failed = 0, batches = 0;
+  double mean_latency = 0;  ///< mean queue + solve seconds, of completions
+  double max_latency = 0;   ///< max queue + solve seconds, of completions
+};
+
+/**
+ * PlanningService answers inverse kinematics, statics and trajectory
+ * requests from many client threads, as behind an RPC planner, keeping
+ * everything that does not depend on the request resident between requests:
+ * the robots, the trajectory factor graphs and initial values of each gait
+ * problem, and the solutions of past trajectory requests as warm starts.
+ *
+ * Requests are queued and a dispatcher thread takes them in batches. Inverse
+ * kinematics requests of the same robot in a batch are solved together by
+ * Kinematics::inverseBatch, which shares their joint constraints and initial
+ * values, and the other requests are spread over a ThreadPool. When more than
+ * max_pending requests wait, new ones are rejected right away rather than
+ * queued, so clients can back off. Every result records its queue and solve
+ * time.
+ *
+ * All public methods can be called concurrently. The destructor finishes the
+ * requests already queued.
+ */
+class PlanningService {
+ public:
+  explicit PlanningService(const PlanningServiceParameters &parameters =
+                               PlanningServiceParameters());
+
+  ~PlanningService();
+
+  PlanningService(const PlanningService &) = delete;
+  PlanningService &operator=(const PlanningService &) = delete;
+
+  /// Make `robot` available to requests under `name`, replacing any robot of
+  /// that name.
+  void addRobot(const std::string &name, const Robot &robot);
+
+  /**
+   * Inverse kinematics of robot `robot`, at time step 0, with the goals as
+   * hard constraints.
+   */
+  std::future<PlanningResult> inverseKinematics(
+      const std::string &robot, const std::vector<PointGoal> &goals);
+
+  /// Wrenches and torques of robot `robot` at rest in `configuration`, which
+  /// holds the link poses and joint angles at time step 0.
+  std::future<PlanningResult> statics(const std::string &robot,
+                                      const gtsam::Values &configuration);
+
+  /**
+   * Trajectory optimization of a gait problem. The robot is loaded from the
+   * model file of the problem on first use, and kept.
+   */
+  std::future<PlanningResult> trajectory(const GaitProblem &problem);
+
+  /// Number of requests waiting for dispatch.
+  size_t numPending() const;
+
+  /// Counters and latencies so far.
+  PlanningServiceStats stats() const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  enum class Kind { InverseKinematics, Statics, Trajectory };
+
+  struct Request {
+    Kind kind;
+    std::string robot;
+    std::vector<PointGoal> goals;
+    gtsam::Values configuration;
+    GaitProblem problem;
+    Clock::time_point submitted, dispatched;
+    std::promise<PlanningResult> promise;
+  };
+
+  // Graph and initial values of a gait problem, built once.
+  struct GraphTemplate {
+    std::shared_ptr<const Robot> robot;
+    gtsam::NonlinearFactorGraph graph;
+    gtsam::Values initial_values;
+    std::string signature;
+    gtsam::Vector features;
+  };
+
+  std::future<PlanningResult> submit(std::unique_ptr<Request> request);
+  void dispatchLoop();
+  void process(std::vector<std::unique_ptr<Request>> *batch);
+  void solveInverseKinematics(const std::vector<Request *> &requests);
+  PlanningResult solve(const Request &request);
+  void finish(Request *request, PlanningResult result);
+
+  std::shared_ptr<const Robot> robot(const std::string &name) const;
+  std::shared_ptr<const Robot> loadRobot(const GaitProblem &problem);
+  std::shared_ptr<const GraphTemplate> graphTemplate(
+      const GaitProblem &problem);
+
+  const PlanningServiceParameters p_;
+  ThreadPool pool_;
+  WarmStartCache warm_starts_;
+
+  mutable std::mutex robots_mutex_;
+  std::map<std::string, std::shared_ptr<const Robot>> robots_;
+
+  std::mutex templates_mutex_;
+  std::map<std::string, std::shared_ptr<const GraphTemplate>> templates_;
+  std::deque<std::string> template_order_;
+
+  mutable std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<std::unique_ptr<Request>> queue_;
+  bool stop_ = false;
+
+  mutable std::mutex stats_mutex_;
+  PlanningServiceStats stats_;
+  double total_latency_ = 0;
+
+  std::thread dispatcher_;  // last, so it starts after everything above
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,189 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RealTimeRobot.cpp
+ * @brief Kinematics, dynamics and simulation for real-time control threads.
+ */
+
+#include "gtdynamics/dynamics/RealTimeRobot.h"
+
+#include <cmath>
+
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RealTimeRobot::RealTimeRobot(const Robot &robot,
+                             const boost::optional<gtsam::Vector3> &gravity)
+    : robot_(robot), dynamics_solver_(robot, gravity) {
+  const size_t L = numLinkSlots(), J = numJointSlots();
+  poses_.assign(L, Pose3());
+  twists_.setZero(6, L);
+  dynamics_solver_.allocate(&dynamics_);
+  dynamics_solver_.allocate(&stage_);
+  for (Vector *x : {&q_, &v_, &tau_, &q2_, &v2_, &a2_, &q3_, &v3_, &a3_,
+                    &q4_, &v4_})
+    x->setZero(J);
+}
+
+/* ************************************************************************* */
+void RealTimeRobot::enableContactEstimation(
+    const FootContactConstraintSpec &contacts,
+    const ContactWrenchEstimatorParameters &parameters) {
+  contact_estimator_ = ContactWrenchEstimator(robot_, contacts, parameters);
+
+  // Size the estimate and the factorization, which the first call allocates.
+  ContactWrenchMeasurement measurement;
+  measurement.q = measurement.v = measurement.tau = Vector::Zero(
+      numJointSlots());
+  contact_estimator_->estimate(measurement, &contact_wrenches_);
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::isLink(int link_id) const {
+  const CompiledRobot &robot = compiledRobot();
+  return link_id >= 0 && size_t(link_id) < robot.numLinkSlots() &&
+         robot.nodeOfLink()[link_id] >= 0;
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::setRootState(int link_id, const Pose3 &wTi,
+                                 const gtsam::Vector6 &twist) noexcept {
+  const CompiledRobot &robot = compiledRobot();
+  if (!isLink(link_id) || robot.isFixed()[link_id] ||
+      robot.parentNodes()[robot.nodeOfLink()[link_id]] >= 0)
+    return false;
+  for (RecursiveDynamicsResult *result : {&dynamics_, &stage_}) {
+    result->poses[link_id] = wTi;
+    result->twists.col(link_id) = twist;
+  }
+  poses_[link_id] = wTi;
+  twists_.col(link_id) = twist;
+  return true;
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::forwardKinematics(const Vector &q) noexcept {
+  if (!isJointArray(q)) return false;
+  compiledRobot().forwardKinematics(q, &poses_);
+  return true;
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::forwardKinematics(const Vector &q,
+                                      const Vector &v) noexcept {
+  if (!isJointArray(q) || !isJointArray(v)) return false;
+  compiledRobot().forwardKinematics(q, v, &poses_, &twists_);
+  return true;
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::bodyJacobian(int link_id,
+                                 gtsam::Matrix *J) const noexcept {
+  if (!isLink(link_id) || J->rows() != 6 ||
+      size_t(J->cols()) != numJointSlots())
+    return false;
+  compiledRobot().bodyJacobian(poses_, link_id, J);
+  return true;
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::spatialJacobian(int link_id,
+                                    gtsam::Matrix *J) const noexcept {
+  if (!isLink(link_id) || J->rows() != 6 ||
+      size_t(J->cols()) != numJointSlots())
+    return false;
+  compiledRobot().spatialJacobian(poses_, link_id, J);
+  return true;
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::inverseDynamics(const Vector &q, const Vector &v,
+                                    const Vector &a) noexcept {
+  if (!isJointArray(q) || !isJointArray(v) || !isJointArray(a)) return false;
+  dynamics_solver_.inverseDynamics(q, v, a, &dynamics_);
+  return dynamics_.torques.allFinite();
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::forwardDynamics(const Vector &q, const Vector &v,
+                                    const Vector &tau) noexcept {
+  if (!isJointArray(q) || !isJointArray(v) || !isJointArray(tau))
+    return false;
+  dynamics_solver_.forwardDynamics(q, v, tau, &dynamics_);
+  return dynamics_.joint_accels.allFinite();
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::estimateContactWrenches(
+    const ContactWrenchMeasurement &m) noexcept {
+  // The estimator throws for these, so they are checked first.
+  if (!contact_estimator_ || !isJointArray(m.q) || !isJointArray(m.v) ||
+      !isJointArray(m.tau) || (m.a.size() && !isJointArray(m.a)))
+    return false;
+  contact_estimator_->estimate(m, &contact_wrenches_);
+  return contact_wrenches_.forces.allFinite();
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::setState(const Vector &q, const Vector &v) noexcept {
+  if (!isJointArray(q) || !isJointArray(v)) return false;
+  q_ = q;
+  v_ = v;
+  return true;
+}
+
+/* ************************************************************************* */
+const Vector &RealTimeRobot::stageAccels(const Vector &q, const Vector &v) {
+  dynamics_solver_.forwardDynamics(q, v, tau_, &stage_);
+  return stage_.joint_accels;
+}
+
+/* ************************************************************************* */
+bool RealTimeRobot::step(const Vector &tau, double dt) noexcept {
+  if (!isJointArray(tau) || !(dt > 0) || !std::isfinite(dt)) return false;
+  tau_ = tau;
+  if (!forwardDynamics(q_, v_, tau_)) return false;
+
+  // The schemes of Simulator::integrate, on preallocated stages.
+  const Vector &a = dynamics_.joint_accels;
+  switch (scheme_) {
+    case ExplicitEuler:
+      q_ += dt * v_ + 0.5 * dt * dt * a;
+      v_ += dt * a;
+      break;
+    case SemiImplicitEuler:
+      v_ += dt * a;
+      q_ += dt * v_;
+      break;
+    case RungeKutta4: {
+      q2_ = q_ + 0.5 * dt * v_;
+      v2_ = v_ + 0.5 * dt * a;
+      a2_ = stageAccels(q2_, v2_);
+      q3_ = q_ + 0.5 * dt * v2_;
+      v3_ = v_ + 0.5 * dt * a2_;
+      a3_ = stageAccels(q3_, v3_);
+      q4_ = q_ + dt * v3_;
+      v4_ = v_ + dt * a3_;
+      const Vector &a4 = stageAccels(q4_, v4_);
+      q_ += dt / 6 * (v_ + 2 * v2_ + 2 * v3_ + v4_);
+      v_ += dt / 6 * (a + 2 * a2_ + 2 * a3_ + a4);
+      break;
+    }
+    case Verlet:
+      v2_ = v_ + 0.5 * dt * a;
+      q_ += dt * v2_;
+      v_ = v2_ + 0.5 * dt * stageAccels(q_, v2_);
+      break;
+  }
+  return q_.allFinite() && v_.allFinite();
+}
+
+}  // namespace gtdynamics
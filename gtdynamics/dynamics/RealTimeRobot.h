@@ -0,0 +1,193 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RealTimeRobot.h
+ * @brief Kinematics, dynamics and simulation for real-time control threads.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "gtdynamics/dynamics/ContactWrenchEstimator.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/dynamics/Simulator.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/FootContactConstraintSpec.h"
+
+namespace gtdynamics {
+
+/**
+ * RealTimeRobot is the subset of CompiledRobot, RecursiveDynamics,
+ * ContactWrenchEstimator and Simulator that a 1 kHz control thread can call:
+ * after construction and enableContactEstimation, which allocate all
+ * workspaces and may throw, every call below is noexcept, does not allocate
+ * and runs in time linear in the number of links, with no iteration or
+ * search. Inputs are joint-id indexed arrays of numJointSlots() entries;
+ * calls return false, and leave the outputs unspecified, for inputs of the
+ * wrong size, unknown links, non-finite results or a missing setup, rather
+ * than throwing.
+ *
+ * Outputs are written into buffers owned by this object and returned by
+ * reference, so an instance should only be used by one thread. Caller-owned
+ * outputs, such as Jacobians, must already have their final size.
+ *
+ * Floating roots are at the identity with zero twist unless set with
+ * setRootState; the dynamics read them, as in RecursiveDynamics, and step()
+ * integrates the joints only, as Simulator does.
+ */
+class RealTimeRobot {
+ public:
+  /**
+   * Constructor, which allocates all workspaces.
+   * @param robot    the robot, needs to have a tree structure
+   * @param gravity  gravity vector
+   * @throws std::runtime_error for closed kinematic loops
+   */
+  explicit RealTimeRobot(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /**
+   * Set up estimateContactWrenches for a stance, allocating its workspace.
+   * Not real-time safe: call it at initialization or between stances.
+   * @throws std::invalid_argument as ContactWrenchEstimator
+   */
+  void enableContactEstimation(
+      const FootContactConstraintSpec &contacts,
+      const ContactWrenchEstimatorParameters &parameters =
+          ContactWrenchEstimatorParameters());
+
+  /// Number of joint slots, the size of all joint arrays.
+  size_t numJointSlots() const { return compiledRobot().numJointSlots(); }
+
+  /// Number of link slots, the size of poses().
+  size_t numLinkSlots() const { return compiledRobot().numLinkSlots(); }
+
+  /// The flattened robot.
+  const CompiledRobot &compiledRobot() const {
+    return dynamics_solver_.compiledRobot();
+  }
+
+  /// @name Kinematics
+  /// @{
+
+  /// Set the pose and twist of a floating root, false if it is not one.
+  bool setRootState(int link_id, const gtsam::Pose3 &wTi,
+                    const gtsam::Vector6 &twist) noexcept;
+
+  /// Link poses of joint angles q, into poses().
+  bool forwardKinematics(const gtsam::Vector &q) noexcept;
+
+  /// Link poses and twists of joint angles q and velocities v.
+  bool forwardKinematics(const gtsam::Vector &q,
+                         const gtsam::Vector &v) noexcept;
+
+  /// Body Jacobian of a link at the poses of the last forwardKinematics,
+  /// into a 6 x numJointSlots() matrix.
+  bool bodyJacobian(int link_id, gtsam::Matrix *J) const noexcept;
+
+  /// Spatial Jacobian of a link, as bodyJacobian.
+  bool spatialJacobian(int link_id, gtsam::Matrix *J) const noexcept;
+
+  /// Link poses wTi of the last forwardKinematics, indexed by link id.
+  const std::vector<gtsam::Pose3> &poses() const { return poses_; }
+
+  /// 6 x #link slots, link twists of the last forwardKinematics with v.
+  const gtsam::Matrix &twists() const { return twists_; }
+
+  /// @}
+  /// @name Dynamics
+  /// @{
+
+  /// Joint torques, wrenches and accelerations of a motion, into dynamics().
+  bool inverseDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &a) noexcept;
+
+  /// Joint accelerations of torques tau, into dynamics().
+  bool forwardDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &tau) noexcept;
+
+  /// Output of the last inverseDynamics or forwardDynamics.
+  const RecursiveDynamicsResult &dynamics() const { return dynamics_; }
+
+  /// Contact forces of one tick, into contactWrenches(); false unless
+  /// enableContactEstimation was called.
+  bool estimateContactWrenches(
+      const ContactWrenchMeasurement &measurement) noexcept;
+
+  /// Output of the last estimateContactWrenches.
+  const ContactWrenchEstimate &contactWrenches() const {
+    return contact_wrenches_;
+  }
+
+  /// @}
+  /// @name Simulation
+  /// @{
+
+  /// Set the integration scheme of step, semi-implicit Euler by default.
+  void setIntegrationScheme(IntegrationScheme scheme) noexcept {
+    scheme_ = scheme;
+  }
+
+  /// Set the joint angles and velocities step starts from.
+  bool setState(const gtsam::Vector &q, const gtsam::Vector &v) noexcept;
+
+  /**
+   * Simulate one time step with torques tau, as Simulator::step with the
+   * ArticulatedBody method: forward dynamics at the current state, then the
+   * integration scheme, with one more forward dynamics solve for Verlet and
+   * three for RungeKutta4.
+   */
+  bool step(const gtsam::Vector &tau, double dt) noexcept;
+
+  /// Joint angles after the last step.
+  const gtsam::Vector &jointAngles() const { return q_; }
+
+  /// Joint velocities after the last step.
+  const gtsam::Vector &jointVels() const { return v_; }
+
+  /// Joint accelerations of the last step, at its start.
+  const gtsam::Vector &jointAccels() const { return dynamics_.joint_accels; }
+
+  /// @}
+
+ private:
+  // Whether x has one entry per joint slot.
+  bool isJointArray(const gtsam::Vector &x) const {
+    return size_t(x.size()) == numJointSlots();
+  }
+
+  // Whether link_id is a link of the tree.
+  bool isLink(int link_id) const;
+
+  // Joint accelerations at (q, v) with the torques of the step, in stage_.
+  const gtsam::Vector &stageAccels(const gtsam::Vector &q,
+                                   const gtsam::Vector &v);
+
+  Robot robot_;  // for the contact estimator
+  RecursiveDynamics dynamics_solver_;
+  boost::optional<ContactWrenchEstimator> contact_estimator_;
+  IntegrationScheme scheme_ = SemiImplicitEuler;
+
+  std::vector<gtsam::Pose3> poses_;
+  gtsam::Matrix twists_;
+  RecursiveDynamicsResult dynamics_, stage_;
+  ContactWrenchEstimate contact_wrenches_;
+
+  // State, and the scratch space of the integration schemes.
+  gtsam::Vector q_, v_, tau_, q2_, v2_, a2_, q3_, v3_, a3_, q4_, v4_;
+};
+
+}  // namespace gtdynamics
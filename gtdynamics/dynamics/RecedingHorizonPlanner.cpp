@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecedingHorizonPlanner.cpp
+ * @brief Incremental receding-horizon trajectory optimization with iSAM2.
+ */
+
+#include "gtdynamics/dynamics/RecedingHorizonPlanner.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/FixedLag.h"
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RecedingHorizonPlanner::RecedingHorizonPlanner(
+    const Robot &robot, const DynamicsGraph &graph_builder,
+    const RecedingHorizonParameters &parameters)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      p_(parameters),
+      slice_(graph_builder.dynamicsSlice(robot, parameters.contact_points,
+                                         parameters.mu)),
+      isam_(parameters.isam2) {
+  if (p_.horizon < 1)
+    throw std::invalid_argument(
+        "RecedingHorizonPlanner: horizon should be at least 1.");
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::setContactPoints(
+    const boost::optional<PointOnLinks> &contact_points) {
+  p_.contact_points = contact_points;
+  slice_ = graph_builder_.dynamicsSlice(robot_, contact_points, p_.mu);
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::initialize(const NonlinearFactorGraph &objectives,
+                                        const Values &initial_values) {
+  isam_ = gtsam::ISAM2(p_.isam2);
+  first_step_ = 0;
+  step_keys_.clear();
+  for (const Key key : initial_values.keys()) {
+    const uint64_t t = DynamicsSymbol::Time(key);
+    if (t > uint64_t(p_.horizon))
+      throw std::invalid_argument(
+          "RecedingHorizonPlanner::initialize: variable " +
+          _GTDKeyFormatter(key) + " is outside of the window.");
+    step_keys_[t].push_back(key);
+  }
+
+  NonlinearFactorGraph graph;
+  for (int t = 0; t <= p_.horizon; t++) {
+    slice_.instantiate(t, &graph);
+    if (t < p_.horizon)
+      graph.add(graph_builder_.collocationFactors(robot_, t, p_.dt,
+                                                  p_.collocation));
+  }
+  graph.add(objectives);
+  update(graph, initial_values, -1);
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::advance(const NonlinearFactorGraph &objectives,
+                                     const Values &new_values) {
+  const int t = lastStep() + 1;
+
+  // Initialize the new step with the last one where no values are given.
+  Values values = new_values;
+  for (const Key key : step_keys_.at(t - 1))
+    if (!values.exists(key + 1))
+      values.insert(key + 1, isam_.calculateEstimate(key));
+  for (const Key key : values.keys()) {
+    if (DynamicsSymbol::Time(key) != uint64_t(t))
+      throw std::invalid_argument(
+          "RecedingHorizonPlanner::advance: variable " +
+          _GTDKeyFormatter(key) + " is not in time step " +
+          std::to_string(t) + ".");
+  }
+  step_keys_[t] = values.keys();
+
+  NonlinearFactorGraph graph;
+  slice_.instantiate(t, &graph);
+  graph.add(graph_builder_.collocationFactors(robot_, t - 1, p_.dt,
+                                              p_.collocation));
+  graph.add(objectives);
+  update(graph, values, first_step_);
+  first_step_++;
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::addObjectives(
+    const NonlinearFactorGraph &objectives) {
+  update(objectives, Values(), -1);
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::iterate(size_t num_iterations) {
+  for (size_t i = 0; i < num_iterations; i++) isam_.update();
+}
+
+/* ************************************************************************* */
+void RecedingHorizonPlanner::update(const NonlinearFactorGraph &factors,
+                                    const Values &values, int marginalized) {
+  FixedLagUpdate(&isam_, factors, values, &step_keys_, marginalized);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,120 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecedingHorizonPlanner.h
+ * @brief Incremental receding-horizon trajectory optimization with iSAM2.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <map>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/DynamicsSlice.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/PointOnLink.h"
+
+namespace gtdynamics {
+
+/// Parameters of RecedingHorizonPlanner.
+struct RecedingHorizonParameters {
+  int horizon = 20;  ///< number of time intervals in the window
+  double dt = 0.01;  ///< duration of each time step
+  CollocationScheme collocation = Trapezoidal;
+  boost::optional<PointOnLinks> contact_points;  ///< contacts of new steps
+  boost::optional<double> mu;  ///< coefficient of static friction
+  gtsam::ISAM2Params isam2;    ///< parameters of the underlying iSAM2
+};
+
+/**
+ * RecedingHorizonPlanner keeps the trajectory factor graph of a sliding window
+ * of time steps [firstStep(), lastStep()] in iSAM2. Advancing the window adds
+ * one dynamics slice and its collocation factors at the end, and marginalizes
+ * the variables of the first step: they are eliminated first, so that they
+ * end up in leaves of the Bayes tree and can be removed without touching the
+ * rest, as in gtsam's incremental fixed-lag smoother. Each update relinearizes
+ * and re-solves only the part of the Bayes tree the new factors affect.
+ *
+ * All variables must be DynamicsSymbols; they are assigned to the window step
+ * of their time index.
+ */
+class RecedingHorizonPlanner {
+ public:
+  /**
+   * Constructor
+   * @param robot          the robot
+   * @param graph_builder  builds the dynamics slice and collocation factors
+   * @param parameters     window and iSAM2 parameters
+   */
+  RecedingHorizonPlanner(const Robot &robot, const DynamicsGraph &graph_builder,
+                         const RecedingHorizonParameters &parameters =
+                             RecedingHorizonParameters());
+
+  /**
+   * Start the window at time steps [0, horizon].
+   * @param objectives      extra factors on the window, e.g. boundary
+   *                        conditions and goals
+   * @param initial_values  initial estimate for all variables in the window
+   */
+  void initialize(const gtsam::NonlinearFactorGraph &objectives,
+                  const gtsam::Values &initial_values);
+
+  /**
+   * Move the window one time step forward: add step lastStep() + 1 and
+   * marginalize step firstStep().
+   * @param objectives  extra factors, on variables in the new window
+   * @param new_values  initial estimate for the new step; missing variables
+   *                    are initialized with the estimate of the current last
+   *                    step
+   */
+  void advance(
+      const gtsam::NonlinearFactorGraph &objectives =
+          gtsam::NonlinearFactorGraph(),
+      const gtsam::Values &new_values = gtsam::Values());
+
+  /// Add factors on variables in the window, without advancing it.
+  void addObjectives(const gtsam::NonlinearFactorGraph &objectives);
+
+  /// Run additional iSAM2 iterations, relinearizing where needed.
+  void iterate(size_t num_iterations = 1);
+
+  /// Use these contact points for steps added from now on.
+  void setContactPoints(const boost::optional<PointOnLinks> &contact_points);
+
+  /// Current estimate of all variables in the window.
+  gtsam::Values estimate() const { return isam_.calculateEstimate(); }
+
+  /// First time step in the window.
+  int firstStep() const { return first_step_; }
+
+  /// Last time step in the window.
+  int lastStep() const { return first_step_ + p_.horizon; }
+
+  /// The underlying iSAM2 instance.
+  const gtsam::ISAM2 &isam() const { return isam_; }
+
+ private:
+  /// Update iSAM2, marginalizing the variables of step `marginalized` if >= 0.
+  void update(const gtsam::NonlinearFactorGraph &factors,
+              const gtsam::Values &values, int marginalized);
+
+  const Robot robot_;
+  const DynamicsGraph graph_builder_;
+  RecedingHorizonParameters p_;
+  DynamicsSlice slice_;
+  gtsam::ISAM2 isam_;
+  int first_step_ = 0;
+  std::map<int, gtsam::KeyVector> step_keys_;  // variables of each step
+};
+
+}  // namespace gtdynamics
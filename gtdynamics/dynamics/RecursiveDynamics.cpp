@@ -0,0 +1,645 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecursiveDynamics.cpp
+ * @brief Recursive O(n) dynamics algorithms operating on the Robot tree.
+ */
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix6;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+// Return value at key if it exists, or default_value otherwise.
+static double AtOr(const Values &values, gtsam::Key key, double default_value) {
+  return values.exists(key) ? values.at<double>(key) : default_value;
+}
+
+// Throw unless the matrices of a trajectory have the same number of rows and
+// one column per joint slot.
+static void CheckTrajectory(const gtsam::Matrix &Q, const gtsam::Matrix &V,
+                            const gtsam::Matrix &X, size_t num_joints) {
+  if (size_t(Q.cols()) != num_joints || size_t(V.cols()) != num_joints ||
+      size_t(X.cols()) != num_joints || V.rows() != Q.rows() ||
+      X.rows() != Q.rows())
+    throw std::invalid_argument(
+        "RecursiveDynamics: trajectories need one row per step and one "
+        "column per joint slot.");
+}
+
+/* ************************************************************************* */
+RecursiveDynamics::RecursiveDynamics(
+    const Robot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : robot_(robot), gravity_(gravity) {
+  const size_t N = robot_.numNodes();
+  X_.resize(N);
+  IA_.resize(N);
+  pA_.resize(6, N);
+  c_.resize(6, N);
+  U_.resize(6, N);
+  dA_.resize(6, N);
+  D_.resize(N);
+  u_.resize(N);
+  dV_.resize(6, N);
+  dA_tangent_.resize(6, N);
+  dxi_.resize(6, N);
+  dF_.resize(6, N);
+  du_.resize(N);
+  zero_.setZero(robot_.numJointSlots());
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::allocate(RecursiveDynamicsResult *result) const {
+  const size_t num_links = robot_.numLinkSlots();
+  const size_t num_joints = robot_.numJointSlots();
+  result->poses.resize(num_links);
+  result->twists.setZero(6, num_links);
+  result->twist_accels.setZero(6, num_links);
+  result->joint_accels.setZero(num_joints);
+  result->torques.setZero(num_joints);
+  result->parent_wrenches.setZero(6, num_joints);
+  result->child_wrenches.setZero(6, num_joints);
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::setRootStates(const Values &known_values, size_t t,
+                                      RecursiveDynamicsResult *result) const {
+  if (result->poses.size() != robot_.numLinkSlots() ||
+      size_t(result->joint_accels.size()) != robot_.numJointSlots()) {
+    allocate(result);
+  }
+  for (size_t n = 0; n < robot_.numNodes(); ++n) {
+    const int i = robot_.linkIds()[n];
+    if (robot_.parentNodes()[n] >= 0 || robot_.isFixed()[i]) continue;
+    const auto pose_key = internal::PoseKey(i, t);
+    const auto twist_key = internal::TwistKey(i, t);
+    result->poses[i] = known_values.exists(pose_key)
+                           ? known_values.at<Pose3>(pose_key)
+                           : Pose3();
+    result->twists.col(i) = known_values.exists(twist_key)
+                                ? known_values.at<Vector6>(twist_key)
+                                : Vector6(Vector6::Zero());
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::readValues(const Values &known_values, size_t t,
+                                   KeyFunction x_key,
+                                   RecursiveDynamicsResult *result,
+                                   gtsam::Vector *q, gtsam::Vector *v,
+                                   gtsam::Vector *x) const {
+  setRootStates(known_values, t, result);
+  q->setZero(robot_.numJointSlots());
+  v->setZero(robot_.numJointSlots());
+  x->setZero(robot_.numJointSlots());
+  for (const int j : robot_.jointIds()) {
+    if (j < 0) continue;
+    (*q)(j) = AtOr(known_values, internal::JointAngleKey(j, t), 0.0);
+    (*v)(j) = AtOr(known_values, internal::JointVelKey(j, t), 0.0);
+    (*x)(j) = AtOr(known_values, x_key(j, t), 0.0);
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::kinematicsPass(const gtsam::Vector &q,
+                                       const gtsam::Vector &v,
+                                       RecursiveDynamicsResult *result) const {
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  const auto &rest_poses = robot_.restPoses();
+  const auto &inertias = robot_.inertias();
+  for (size_t n = 0; n < robot_.numNodes(); ++n) {
+    const int i = link_ids[n];
+    Pose3 &wTi = result->poses[i];
+    auto V_i = result->twists.col(i);
+    if (parents[n] < 0) {
+      if (robot_.isFixed()[i]) {
+        wTi = robot_.fixedPoses()[i];
+        V_i.setZero();
+      }
+      c_.col(n).setZero();
+    } else {
+      const int j = joint_ids[n];
+      const int p = link_ids[parents[n]];
+      const Vector6 S = robot_.screwAxes().col(n);
+
+      // Twist of this link: V_i = Ad(T_ip) V_p + S_i v.
+      const Pose3 pTi = rest_poses[n] * Pose3::Expmap(S * q(j));
+      wTi = result->poses[p] * pTi;
+      X_[n] = pTi.inverse().AdjointMap();
+      V_i = X_[n] * result->twists.col(p) + S * v(j);
+      c_.col(n) = Pose3::adjointMap(V_i) * S * v(j);
+    }
+
+    // Bias wrench, with the same sign convention as the wrench factor:
+    // G_i A_i - sum F = ad(V_i)^T G_i V_i + m_i R_i^T g.
+    const Vector6 Vi = V_i;
+    IA_[n] = inertias[i];
+    pA_.col(n) = -Pose3::adjointMap(Vi).transpose() * inertias[i] * Vi;
+    if (gravity_) {
+      pA_.col(n).tail<3>() -=
+          wTi.rotation().transpose() * (*gravity_) * robot_.masses()(i);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::storeWrench(size_t n, const Vector6 &F_i,
+                                    RecursiveDynamicsResult *result) const {
+  // Wrench on this link by the joint, and its equivalent on the tree parent.
+  const int j = robot_.jointIds()[n];
+  const Vector6 F_p = -X_[n].transpose() * F_i;
+  const bool along = robot_.alongJoint()[n];
+  result->child_wrenches.col(j) = along ? F_i : F_p;
+  result->parent_wrenches.col(j) = along ? F_p : F_i;
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::forwardDynamics(const gtsam::Vector &q,
+                                        const gtsam::Vector &v,
+                                        const gtsam::Vector &tau,
+                                        RecursiveDynamicsResult *result) const {
+  const size_t N = robot_.numNodes();
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  const gtsam::Matrix &screw_axes = robot_.screwAxes();
+
+  // Pass 1, outward: poses, twists, velocity-product accelerations and
+  // bias wrenches.
+  kinematicsPass(q, v, result);
+
+  // Pass 2, inward: articulated inertias and bias wrenches.
+  for (size_t n = N; n-- > 0;) {
+    const int parent = parents[n];
+    if (parent < 0) continue;
+    const Vector6 S = screw_axes.col(n);
+    const Vector6 U = IA_[n] * S;
+    U_.col(n) = U;
+    D_(n) = S.dot(U);
+    u_(n) = tau(joint_ids[n]) - U.dot(c_.col(n)) - S.dot(pA_.col(n));
+    const Matrix6 Ia = IA_[n] - U * U.transpose() / D_(n);
+    const Vector6 pa = pA_.col(n) + Ia * c_.col(n) + U * (u_(n) / D_(n));
+    IA_[parent] += X_[n].transpose() * Ia * X_[n];
+    pA_.col(parent) += X_[n].transpose() * pa;
+  }
+
+  // Pass 3, outward: accelerations and joint wrenches.
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    auto A_i = result->twist_accels.col(i);
+    if (parents[n] < 0) {
+      // A floating root has no joint wrench: IA A + pA = 0.
+      if (robot_.isFixed()[i])
+        A_i.setZero();
+      else
+        A_i = -IA_[n].ldlt().solve(pA_.col(n));
+      continue;
+    }
+    const int j = joint_ids[n];
+    const int p = link_ids[parents[n]];
+    const Vector6 XA_p = X_[n] * result->twist_accels.col(p);
+    const double a = (u_(n) - U_.col(n).dot(XA_p)) / D_(n);
+    A_i = XA_p + screw_axes.col(n) * a + c_.col(n);
+    storeWrench(n, IA_[n] * A_i + pA_.col(n), result);
+    result->joint_accels(j) = a;
+    result->torques(j) = tau(j);
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::forwardDynamics(const Values &known_values, size_t t,
+                                        RecursiveDynamicsResult *result) const {
+  gtsam::Vector q, v, tau;
+  readValues(known_values, t, internal::TorqueKey, result, &q, &v, &tau);
+  forwardDynamics(q, v, tau, result);
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::inverseDynamics(const gtsam::Vector &q,
+                                        const gtsam::Vector &v,
+                                        const gtsam::Vector &a,
+                                        RecursiveDynamicsResult *result) const {
+  const size_t N = robot_.numNodes();
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  const gtsam::Matrix &screw_axes = robot_.screwAxes();
+  const bool has_floating_root = robot_.hasFloatingRoot();
+
+  // Pass 1, outward: kinematics, then accelerations and the wrenches needed to
+  // produce them, assuming floating roots do not accelerate. pA_ then holds
+  // G_i A_i - bias_i, and IA_ the composite rigid-body inertia after pass 2.
+  kinematicsPass(q, v, result);
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    auto A_i = result->twist_accels.col(i);
+    if (parents[n] < 0) {
+      A_i.setZero();
+    } else {
+      const int j = joint_ids[n];
+      const int p = link_ids[parents[n]];
+      A_i = X_[n] * result->twist_accels.col(p) + screw_axes.col(n) * a(j) +
+            c_.col(n);
+      result->joint_accels(j) = a(j);
+    }
+    pA_.col(n) += robot_.inertias()[i] * A_i;
+  }
+
+  // Pass 2, inward: accumulate wrenches (and inertias) of the subtrees.
+  for (size_t n = N; n-- > 0;) {
+    const int parent = parents[n];
+    if (parent < 0) continue;
+    pA_.col(parent) += X_[n].transpose() * pA_.col(n);
+    if (has_floating_root)
+      IA_[parent] += X_[n].transpose() * IA_[n] * X_[n];
+  }
+
+  // Pass 3, outward: a floating root accelerates such that it carries no joint
+  // wrench, which changes accelerations and wrenches in its whole subtree.
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    auto A_i = result->twist_accels.col(i);
+    if (parents[n] < 0) {
+      if (robot_.isFixed()[i]) {
+        dA_.col(n).setZero();
+      } else {
+        dA_.col(n) = -IA_[n].ldlt().solve(pA_.col(n));
+        A_i += dA_.col(n);
+      }
+      continue;
+    }
+    const int j = joint_ids[n];
+    Vector6 F_i = pA_.col(n);
+    if (has_floating_root) {
+      dA_.col(n) = X_[n] * dA_.col(parents[n]);
+      A_i += dA_.col(n);
+      F_i += IA_[n] * dA_.col(n);
+    }
+    storeWrench(n, F_i, result);
+    result->torques(j) = screw_axes.col(n).dot(F_i);
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::inverseDynamics(const Values &known_values, size_t t,
+                                        RecursiveDynamicsResult *result) const {
+  gtsam::Vector q, v, a;
+  readValues(known_values, t, internal::JointAccelKey, result, &q, &v, &a);
+  inverseDynamics(q, v, a, result);
+}
+
+/* ************************************************************************* */
+gtsam::Matrix RecursiveDynamics::inverseDynamicsTrajectory(
+    const gtsam::Matrix &Q, const gtsam::Matrix &V,
+    const gtsam::Matrix &A) const {
+  CheckTrajectory(Q, V, A, robot_.numJointSlots());
+  RecursiveDynamicsResult result;
+  allocate(&result);
+  gtsam::Matrix torques(Q.rows(), Q.cols());
+  gtsam::Vector q, v, a;
+  for (int k = 0; k < Q.rows(); ++k) {
+    q = Q.row(k).transpose();
+    v = V.row(k).transpose();
+    a = A.row(k).transpose();
+    inverseDynamics(q, v, a, &result);
+    torques.row(k) = result.torques.transpose();
+  }
+  return torques;
+}
+
+/* ************************************************************************* */
+gtsam::Matrix RecursiveDynamics::forwardDynamicsTrajectory(
+    const gtsam::Matrix &Q, const gtsam::Matrix &V,
+    const gtsam::Matrix &Tau) const {
+  CheckTrajectory(Q, V, Tau, robot_.numJointSlots());
+  RecursiveDynamicsResult result;
+  allocate(&result);
+  gtsam::Matrix accels(Q.rows(), Q.cols());
+  gtsam::Vector q, v, tau;
+  for (int k = 0; k < Q.rows(); ++k) {
+    q = Q.row(k).transpose();
+    v = V.row(k).transpose();
+    tau = Tau.row(k).transpose();
+    forwardDynamics(q, v, tau, &result);
+    accels.row(k) = result.joint_accels.transpose();
+  }
+  return accels;
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::forwardDynamicsDerivatives(
+    const gtsam::Vector &q, const gtsam::Vector &v, const gtsam::Vector &tau,
+    RecursiveDynamicsResult *result, gtsam::Matrix *da_dq,
+    gtsam::Matrix *da_dv, gtsam::Matrix *da_dtau) const {
+  checkFixedBase("forward dynamics derivatives");
+  const size_t nj = robot_.numJointSlots();
+  const auto &joint_ids = robot_.jointIds();
+
+  // The inverse dynamics at the solution leaves X_, U_ and D_ of the
+  // articulated-body pass intact, and its total wrenches in pA_.
+  forwardDynamics(q, v, tau, result);
+  if (id_result_.poses.size() != robot_.numLinkSlots()) allocate(&id_result_);
+  inverseDynamics(q, v, result->joint_accels, &id_result_);
+
+  da_dq->setZero(nj, nj);
+  da_dv->setZero(nj, nj);
+  da_dtau->setZero(nj, nj);
+  gtsam::Vector dtau(nj), da(nj);
+  for (size_t m = 0; m < robot_.numNodes(); ++m) {
+    const int k = joint_ids[m];
+    if (k < 0) continue;
+    inverseDynamicsTangent(m, true, v, id_result_, &dtau);
+    inverseMassTangent(-dtau, &da);
+    da_dq->col(k) = da;
+    inverseDynamicsTangent(m, false, v, id_result_, &dtau);
+    inverseMassTangent(-dtau, &da);
+    da_dv->col(k) = da;
+    dtau.setZero();
+    dtau(k) = 1;
+    inverseMassTangent(dtau, &da);
+    da_dtau->col(k) = da;
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::inverseDynamicsDerivatives(
+    const gtsam::Vector &q, const gtsam::Vector &v, const gtsam::Vector &a,
+    RecursiveDynamicsResult *result, gtsam::Matrix *dtau_dq,
+    gtsam::Matrix *dtau_dv) const {
+  checkFixedBase("inverse dynamics derivatives");
+  const size_t nj = robot_.numJointSlots();
+  const auto &joint_ids = robot_.jointIds();
+
+  inverseDynamics(q, v, a, result);
+  dtau_dq->setZero(nj, nj);
+  dtau_dv->setZero(nj, nj);
+  gtsam::Vector dtau(nj);
+  for (size_t m = 0; m < robot_.numNodes(); ++m) {
+    const int k = joint_ids[m];
+    if (k < 0) continue;
+    inverseDynamicsTangent(m, true, v, *result, &dtau);
+    dtau_dq->col(k) = dtau;
+    inverseDynamicsTangent(m, false, v, *result, &dtau);
+    dtau_dv->col(k) = dtau;
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::inverseDynamicsTangent(
+    size_t m, bool angle, const gtsam::Vector &v,
+    const RecursiveDynamicsResult &id, gtsam::Vector *dtau) const {
+  const size_t N = robot_.numNodes();
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  const gtsam::Matrix &screw_axes = robot_.screwAxes();
+  const auto &inertias = robot_.inertias();
+
+  // Pass 1, outward: derivatives of twists, accelerations and of the link
+  // poses, as the right perturbations xi with wTi(x + dx) = wTi Exp(xi dx).
+  // Moving joint m by dq changes X_m by -ad(S_m) X_m dq.
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    const int parent = parents[n];
+    if (parent < 0) {
+      dV_.col(n).setZero();
+      dA_tangent_.col(n).setZero();
+      dxi_.col(n).setZero();
+    } else {
+      const int j = joint_ids[n];
+      const Vector6 S = screw_axes.col(n);
+      const Vector6 V_i = id.twists.col(i);
+      Vector6 dV = X_[n] * dV_.col(parent);
+      Vector6 dA = X_[n] * dA_tangent_.col(parent);
+      Vector6 xi = X_[n] * dxi_.col(parent);
+      Vector6 dc = Vector6::Zero();
+      if (n == m && angle) {
+        const Matrix6 ad_S = Pose3::adjointMap(S);
+        const int p = link_ids[parent];
+        dV -= ad_S * X_[n] * id.twists.col(p);
+        dA -= ad_S * X_[n] * id.twist_accels.col(p);
+        xi += S;
+      } else if (n == m) {
+        dV += S;
+        dc = Pose3::adjointMap(V_i) * S;
+      }
+      // Derivative of the velocity-product term ad(V_i) S v.
+      dc = dc + Pose3::adjointMap(dV) * S * v(j);
+      dV_.col(n) = dV;
+      dA_tangent_.col(n) = dA + dc;
+      dxi_.col(n) = xi;
+    }
+
+    // Derivative of G A - ad(V)^T G V - m R^T g, with
+    // d(R^T g) = -omega x R^T g.
+    const Vector6 V_i = id.twists.col(i);
+    const Vector6 dV = dV_.col(n);
+    dF_.col(n) = inertias[i] * dA_tangent_.col(n) -
+                 Pose3::adjointMap(dV).transpose() * inertias[i] * V_i -
+                 Pose3::adjointMap(V_i).transpose() * inertias[i] * dV;
+    if (gravity_) {
+      const gtsam::Vector3 g_i =
+          id.poses[i].rotation().transpose() * (*gravity_);
+      const gtsam::Vector3 omega = dxi_.col(n).head<3>();
+      dF_.col(n).tail<3>() += robot_.masses()(i) * omega.cross(g_i);
+    }
+  }
+
+  // Pass 2, inward: subtree wrenches, where X_m^T F_m changes by
+  // -X_m^T ad(S_m)^T F_m dq, with F_m the total wrench of inverseDynamics.
+  dtau->setZero(robot_.numJointSlots());
+  for (size_t n = N; n-- > 0;) {
+    const int parent = parents[n];
+    if (parent < 0) continue;
+    const Vector6 S = screw_axes.col(n);
+    Vector6 dF = dF_.col(n);
+    (*dtau)(joint_ids[n]) = S.dot(dF);
+    if (n == m && angle)
+      dF -= Pose3::adjointMap(S).transpose() * pA_.col(n);
+    dF_.col(parent) += X_[n].transpose() * dF;
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::inverseMassTangent(const gtsam::Vector &dtau,
+                                           gtsam::Vector *da) const {
+  // The articulated-body algorithm with zero velocities and no gravity,
+  // which is linear in the torques, on the U_, D_ of the last pass.
+  const size_t N = robot_.numNodes();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  const gtsam::Matrix &screw_axes = robot_.screwAxes();
+
+  dF_.setZero();
+  for (size_t n = N; n-- > 0;) {
+    const int parent = parents[n];
+    if (parent < 0) continue;
+    du_(n) = dtau(joint_ids[n]) - screw_axes.col(n).dot(dF_.col(n));
+    const Vector6 pa = dF_.col(n) + U_.col(n) * (du_(n) / D_(n));
+    dF_.col(parent) += X_[n].transpose() * pa;
+  }
+
+  da->setZero(robot_.numJointSlots());
+  for (size_t n = 0; n < N; ++n) {
+    const int parent = parents[n];
+    if (parent < 0) {
+      dA_tangent_.col(n).setZero();
+      continue;
+    }
+    const Vector6 XA_p = X_[n] * dA_tangent_.col(parent);
+    const double a = (du_(n) - U_.col(n).dot(XA_p)) / D_(n);
+    dA_tangent_.col(n) = XA_p + screw_axes.col(n) * a;
+    (*da)(joint_ids[n]) = a;
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::checkFixedBase(const char *what) const {
+  if (robot_.hasFloatingRoot())
+    throw std::runtime_error(std::string("RecursiveDynamics: ") + what +
+                             " need all roots to be fixed links.");
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::massMatrix(const gtsam::Vector &q,
+                                   gtsam::Matrix *M) const {
+  checkFixedBase("mass matrices");
+  const size_t N = robot_.numNodes(), nj = robot_.numJointSlots();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  const gtsam::Matrix &screw_axes = robot_.screwAxes();
+  if (id_result_.poses.size() != robot_.numLinkSlots()) allocate(&id_result_);
+
+  // Composite inertias of the subtrees, in IA_.
+  kinematicsPass(q, zero_, &id_result_);
+  for (size_t n = N; n-- > 0;) {
+    const int parent = parents[n];
+    if (parent >= 0) IA_[parent] += X_[n].transpose() * IA_[n] * X_[n];
+  }
+
+  // Column of joint j: the wrench I_c S_j moved up to each ancestor joint.
+  if (M->rows() != int(nj) || M->cols() != int(nj)) M->resize(nj, nj);
+  M->setZero();
+  for (size_t n = 0; n < N; ++n) {
+    const int j = joint_ids[n];
+    if (j < 0) continue;
+    Vector6 F = IA_[n] * screw_axes.col(n);
+    (*M)(j, j) = screw_axes.col(n).dot(F);
+    for (size_t m = n; parents[m] >= 0;) {
+      F = X_[m].transpose() * F;
+      m = parents[m];
+      const int k = joint_ids[m];
+      if (k < 0) break;
+      (*M)(k, j) = (*M)(j, k) = screw_axes.col(m).dot(F);
+    }
+  }
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::nonlinearEffects(const gtsam::Vector &q,
+                                         const gtsam::Vector &v,
+                                         gtsam::Vector *h) const {
+  checkFixedBase("nonlinear effects");
+  if (id_result_.poses.size() != robot_.numLinkSlots()) allocate(&id_result_);
+  inverseDynamics(q, v, zero_, &id_result_);
+  *h = id_result_.torques;
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::coriolisTorques(const gtsam::Vector &q,
+                                        const gtsam::Vector &v,
+                                        gtsam::Vector *c) const {
+  nonlinearEffects(q, v, c);
+  inverseDynamics(q, zero_, zero_, &id_result_);
+  *c -= id_result_.torques;
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::gravityTorques(const gtsam::Vector &q,
+                                       gtsam::Vector *g) const {
+  nonlinearEffects(q, zero_, g);
+}
+
+/* ************************************************************************* */
+void RecursiveDynamics::insert(const RecursiveDynamicsResult &result, size_t t,
+                               bool forward, Values *values) const {
+  for (size_t n = 0; n < robot_.numNodes(); ++n) {
+    const int i = robot_.linkIds()[n];
+    if (!values->exists(internal::PoseKey(i, t))) {
+      InsertPose(values, i, t, result.poses[i]);
+      InsertTwist(values, i, t, Vector6(result.twists.col(i)));
+    }
+    InsertTwistAccel(values, i, t, Vector6(result.twist_accels.col(i)));
+    const int j = robot_.jointIds()[n];
+    if (j < 0) continue;
+    if (forward)
+      InsertJointAccel(values, j, t, result.joint_accels(j));
+    else
+      InsertTorque(values, j, t, result.torques(j));
+    InsertWrench(values, robot_.jointParentLinks()[j], j, t,
+                 Vector6(result.parent_wrenches.col(j)));
+    InsertWrench(values, robot_.jointChildLinks()[j], j, t,
+                 Vector6(result.child_wrenches.col(j)));
+  }
+}
+
+/* ************************************************************************* */
+Values RecursiveDynamics::solveForwardDynamics(const Values &known_values,
+                                               size_t t) const {
+  RecursiveDynamicsResult result;
+  forwardDynamics(known_values, t, &result);
+
+  Values values = known_values;
+  try {
+    insert(result, t, true, &values);
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "solveForwardDynamics: known_values should contain no accelerations "
+        "or wrenches");
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values RecursiveDynamics::solveInverseDynamics(const Values &known_values,
+                                               size_t t) const {
+  RecursiveDynamicsResult result;
+  inverseDynamics(known_values, t, &result);
+
+  Values values = known_values;
+  try {
+    insert(result, t, false, &values);
+  } catch (const gtsam::ValuesKeyAlreadyExists &e) {
+    std::cerr << "key already exists:" << _GTDKeyFormatter(e.key()) << '\n';
+    throw std::invalid_argument(
+        "solveInverseDynamics: known_values should contain no torques, "
+        "wrenches, or twist accelerations.");
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+std::vector<LinkSharedPtr> RecursiveDynamics::traversalOrder() const {
+  return robot_.links();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,300 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RecursiveDynamics.h
+ * @brief Recursive O(n) dynamics algorithms operating on the Robot tree.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+namespace gtdynamics {
+
+/**
+ * Output of a recursive dynamics pass. Per-link quantities are stored as
+ * columns indexed by link id, per-joint quantities are indexed by joint id,
+ * mirroring the keys used in the dynamics factor graph. The buffers are sized
+ * once by RecursiveDynamics::allocate and reused across calls.
+ */
+struct RecursiveDynamicsResult {
+  std::vector<gtsam::Pose3> poses;  ///< CoM poses wTi
+  gtsam::Matrix twists;             ///< 6 x #links, twists V_i
+  gtsam::Matrix twist_accels;       ///< 6 x #links, twist accelerations A_i
+  gtsam::Vector joint_accels;       ///< joint accelerations a_j
+  gtsam::Vector torques;            ///< joint torques tau_j
+  gtsam::Matrix parent_wrenches;    ///< 6 x #joints, F_{parent,j}
+  gtsam::Matrix child_wrenches;     ///< 6 x #joints, F_{child,j}
+};
+
+/**
+ * RecursiveDynamics solves the same problems as DynamicsGraph::linearSolveFD
+ * and linearSolveID, but with the articulated-body algorithm and recursive
+ * Newton-Euler respectively, i.e., in time linear in the number of links and
+ * without building or eliminating a factor graph.
+ *
+ * The spanning tree is that of CompiledRobot, computed once at construction:
+ * fixed links are roots with zero twist acceleration, and every remaining
+ * connected component is treated as a floating base rooted at its first link.
+ * Closed kinematic loops are not supported and throw at construction.
+ */
+class RecursiveDynamics {
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot    the robot, needs to have a tree structure
+   * @param gravity  gravity vector
+   */
+  explicit RecursiveDynamics(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Size the buffers in `result` for this robot.
+  void allocate(RecursiveDynamicsResult *result) const;
+
+  /**
+   * Copy the poses and twists of floating roots from `known_values` into
+   * `result`, as needed by the array versions of forward/inverse dynamics.
+   * Missing values default to identity and zero. Allocates `result` if needed.
+   */
+  void setRootStates(const gtsam::Values &known_values, size_t t,
+                     RecursiveDynamicsResult *result) const;
+
+  /**
+   * Articulated-body forward dynamics, on joint-id indexed arrays.
+   *
+   * Fixed roots use their fixed pose and zero twist, floating roots read their
+   * pose and twist from `result->poses` and `result->twists`, which should
+   * hence be set before the call.
+   *
+   * @param q       joint angles
+   * @param v       joint velocities
+   * @param tau     joint torques
+   * @param result  preallocated output, see `allocate`
+   */
+  void forwardDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &tau,
+                       RecursiveDynamicsResult *result) const;
+
+  /**
+   * Articulated-body forward dynamics, Values version.
+   *
+   * Joint angles, velocities and torques are read from `known_values`, and
+   * default to zero if absent. Floating roots read their pose and twist from
+   * `known_values` as well, defaulting to identity and zero respectively.
+   *
+   * @param known_values Values with joint angles, velocities and torques.
+   * @param t            time index
+   * @param result       output, allocated if needed
+   */
+  void forwardDynamics(const gtsam::Values &known_values, size_t t,
+                       RecursiveDynamicsResult *result) const;
+
+  /**
+   * Recursive Newton-Euler inverse dynamics, on joint-id indexed arrays.
+   *
+   * Floating roots are handled as in `forwardDynamics`; their twist
+   * acceleration is solved for such that they carry no joint wrench.
+   *
+   * @param q       joint angles
+   * @param v       joint velocities
+   * @param a       joint accelerations
+   * @param result  preallocated output, see `allocate`
+   */
+  void inverseDynamics(const gtsam::Vector &q, const gtsam::Vector &v,
+                       const gtsam::Vector &a,
+                       RecursiveDynamicsResult *result) const;
+
+  /**
+   * Forward dynamics and the derivatives of the joint accelerations, e.g.
+   * for iLQR or DDP, found analytically rather than by finite differences.
+   *
+   * With M the mass matrix and ID the inverse dynamics, the accelerations
+   * solve ID(q, v, a) = tau, so da/dtau = M^-1 and da/dx = -M^-1 dID/dx for
+   * x = q, v at fixed a. The derivatives of ID are found by a tangent pass
+   * of recursive Newton-Euler per joint angle and velocity, and M^-1 is
+   * applied with a tangent pass of the articulated-body algorithm, reusing
+   * its factorization; each pass takes O(n) time, so all derivatives take
+   * O(n^2). Only robots without floating roots are supported.
+   *
+   * Matrices are square, with rows and columns indexed by joint id.
+   *
+   * @param q        joint angles
+   * @param v        joint velocities
+   * @param tau      joint torques
+   * @param result   preallocated output of forwardDynamics, see `allocate`
+   * @param da_dq    derivatives of the accelerations in the angles
+   * @param da_dv    derivatives of the accelerations in the velocities
+   * @param da_dtau  derivatives of the accelerations in the torques
+   */
+  void forwardDynamicsDerivatives(const gtsam::Vector &q,
+                                  const gtsam::Vector &v,
+                                  const gtsam::Vector &tau,
+                                  RecursiveDynamicsResult *result,
+                                  gtsam::Matrix *da_dq, gtsam::Matrix *da_dv,
+                                  gtsam::Matrix *da_dtau) const;
+
+  /**
+   * Inverse dynamics and the derivatives of the torques in the angles and
+   * velocities at fixed joint accelerations, with the same tangent passes
+   * as forwardDynamicsDerivatives. The derivative in the accelerations is
+   * the mass matrix, see massMatrix. Only robots without floating roots are
+   * supported.
+   *
+   * @param q        joint angles
+   * @param v        joint velocities
+   * @param a        joint accelerations
+   * @param result   preallocated output of inverseDynamics, see `allocate`
+   * @param dtau_dq  derivatives of the torques in the angles
+   * @param dtau_dv  derivatives of the torques in the velocities
+   */
+  void inverseDynamicsDerivatives(const gtsam::Vector &q,
+                                  const gtsam::Vector &v,
+                                  const gtsam::Vector &a,
+                                  RecursiveDynamicsResult *result,
+                                  gtsam::Matrix *dtau_dq,
+                                  gtsam::Matrix *dtau_dv) const;
+
+  /**
+   * @name Equations of motion M(q) a + C(q, v) v + g(q) = tau
+   *
+   * For controllers and whole-body QPs, on robots without floating roots.
+   * Outputs are joint-id indexed and resized only if their size differs.
+   * @{
+   */
+
+  /// Joint-space mass matrix M(q), by the composite rigid-body algorithm.
+  void massMatrix(const gtsam::Vector &q, gtsam::Matrix *M) const;
+
+  /// Coriolis, centrifugal and gravity torques C(q, v) v + g(q).
+  void nonlinearEffects(const gtsam::Vector &q, const gtsam::Vector &v,
+                        gtsam::Vector *h) const;
+
+  /// Coriolis and centrifugal torques C(q, v) v.
+  void coriolisTorques(const gtsam::Vector &q, const gtsam::Vector &v,
+                       gtsam::Vector *c) const;
+
+  /// Gravity torques g(q).
+  void gravityTorques(const gtsam::Vector &q, gtsam::Vector *g) const;
+
+  /// @}
+
+  /// @name Trajectories
+  /// Joint quantities of a trajectory in #steps x #joint slots matrices, one
+  /// time step per row, column j holding joint id j as in
+  /// BatchForwardKinematics. Floating roots are at the identity with zero
+  /// twist at every step. One call covers the whole trajectory, e.g. from
+  /// Python, where a call per step and joint would dominate.
+  /// BatchInverseDynamics spreads long trajectories over threads.
+  /// @{
+
+  /// Joint torques of every step, by recursive Newton-Euler.
+  gtsam::Matrix inverseDynamicsTrajectory(const gtsam::Matrix &Q,
+                                          const gtsam::Matrix &V,
+                                          const gtsam::Matrix &A) const;
+
+  /// Joint accelerations of every step, by the articulated-body algorithm.
+  gtsam::Matrix forwardDynamicsTrajectory(const gtsam::Matrix &Q,
+                                          const gtsam::Matrix &V,
+                                          const gtsam::Matrix &Tau) const;
+
+  /// @}
+
+  /// Recursive Newton-Euler inverse dynamics, Values version.
+  void inverseDynamics(const gtsam::Values &known_values, size_t t,
+                       RecursiveDynamicsResult *result) const;
+
+  /**
+   * Drop-in replacement for DynamicsGraph::linearSolveFD: returns
+   * `known_values` with joint accelerations, twist accelerations and wrenches
+   * added. Poses and twists are added if not already present.
+   */
+  gtsam::Values solveForwardDynamics(const gtsam::Values &known_values,
+                                     size_t t = 0) const;
+
+  /**
+   * Drop-in replacement for DynamicsGraph::linearSolveID: returns
+   * `known_values` with torques, twist accelerations and wrenches added.
+   */
+  gtsam::Values solveInverseDynamics(const gtsam::Values &known_values,
+                                     size_t t = 0) const;
+
+  /**
+   * Insert the contents of `result` into `values` at time t: twist
+   * accelerations, wrenches, and joint accelerations if `forward` is true or
+   * torques otherwise. Poses and twists are inserted if not already present.
+   */
+  void insert(const RecursiveDynamicsResult &result, size_t t, bool forward,
+              gtsam::Values *values) const;
+
+  /// Return the links in traversal (breadth-first) order.
+  std::vector<LinkSharedPtr> traversalOrder() const;
+
+  /// Return the flattened robot the passes run on.
+  const CompiledRobot &compiledRobot() const { return robot_; }
+
+ private:
+  using KeyFunction = DynamicsSymbol (*)(int, int);
+
+  /// Read joint-indexed arrays and floating root states from values.
+  void readValues(const gtsam::Values &known_values, size_t t,
+                  KeyFunction x_key, RecursiveDynamicsResult *result,
+                  gtsam::Vector *q, gtsam::Vector *v, gtsam::Vector *x) const;
+
+  /// Outward pass shared by FD and ID: poses, twists, and bias terms.
+  void kinematicsPass(const gtsam::Vector &q, const gtsam::Vector &v,
+                      RecursiveDynamicsResult *result) const;
+
+  /**
+   * Derivative of the torques of the last inverseDynamics, at fixed joint
+   * accelerations, in the angle or the velocity of the joint of node m.
+   */
+  void inverseDynamicsTangent(size_t m, bool angle, const gtsam::Vector &v,
+                              const RecursiveDynamicsResult &id,
+                              gtsam::Vector *dtau) const;
+
+  /// da = M^-1 dtau, with the factorization of the last forwardDynamics.
+  void inverseMassTangent(const gtsam::Vector &dtau, gtsam::Vector *da) const;
+
+  /// Throw if a root is not a fixed link, for the APIs that need it.
+  void checkFixedBase(const char *what) const;
+
+  /// Store wrench F_i on node n, and its equivalent on the tree parent.
+  void storeWrench(size_t n, const gtsam::Vector6 &F_i,
+                   RecursiveDynamicsResult *result) const;
+
+  using Matrix6s = CompiledRobot::Matrix6s;
+
+  CompiledRobot robot_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+  // Scratch space for the three passes, indexed by node. Because of this, a
+  // single instance should not be shared between threads.
+  mutable Matrix6s X_;   // Ad(T_cp), transforms parent twists to this link
+  mutable Matrix6s IA_;  // articulated inertia
+  mutable gtsam::Matrix pA_, c_, U_, dA_;
+  mutable gtsam::Vector D_, u_;
+
+  // Scratch space of the tangent passes, indexed by node.
+  mutable gtsam::Matrix dV_, dA_tangent_, dxi_, dF_;
+  mutable gtsam::Vector du_, zero_;
+  mutable RecursiveDynamicsResult id_result_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SimulationHistory.cpp
+ * @brief Columnar storage of a simulated trajectory.
+ */
+
+#include "gtdynamics/dynamics/SimulationHistory.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+SimulationHistory::SimulationHistory(size_t num_joints, size_t num_links,
+                                     size_t capacity)
+    : num_joints_(num_joints), num_links_(num_links), size_(0) {
+  q_.resize(num_joints_, 0);
+  v_.resize(num_joints_, 0);
+  a_.resize(num_joints_, 0);
+  tau_.resize(num_joints_, 0);
+  reserve(capacity);
+}
+
+/* ************************************************************************* */
+void SimulationHistory::reserve(size_t capacity) {
+  if (capacity <= this->capacity()) return;
+  q_.conservativeResize(Eigen::NoChange, capacity);
+  v_.conservativeResize(Eigen::NoChange, capacity);
+  a_.conservativeResize(Eigen::NoChange, capacity);
+  tau_.conservativeResize(Eigen::NoChange, capacity);
+  poses_.reserve(capacity * num_links_);
+}
+
+/* ************************************************************************* */
+void SimulationHistory::record(const gtsam::Vector &q, const gtsam::Vector &v,
+                               const gtsam::Vector &a,
+                               const gtsam::Vector &tau,
+                               const std::vector<gtsam::Pose3> &poses) {
+  if (static_cast<size_t>(q.size()) != num_joints_ ||
+      poses.size() != num_links_) {
+    throw std::invalid_argument("SimulationHistory::record: wrong sizes");
+  }
+  if (size_ == capacity()) reserve(std::max<size_t>(16, 2 * capacity()));
+  q_.col(size_) = q;
+  v_.col(size_) = v;
+  a_.col(size_) = a;
+  tau_.col(size_) = tau;
+  poses_.resize(size_ * num_links_);
+  poses_.insert(poses_.end(), poses.begin(), poses.end());
+  ++size_;
+}
+
+/* ************************************************************************* */
+gtsam::Values SimulationHistory::toValues(
+    const std::vector<int> &joint_ids, const std::vector<int> &link_ids) const {
+  gtsam::Values values;
+  for (size_t k = 0; k < size_; ++k) {
+    for (int j : joint_ids) {
+      InsertJointAngle(&values, j, k, q_(j, k));
+      InsertJointVel(&values, j, k, v_(j, k));
+      InsertJointAccel(&values, j, k, a_(j, k));
+      InsertTorque(&values, j, k, tau_(j, k));
+    }
+    for (int i : link_ids) InsertPose(&values, i, k, pose(k, i));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SimulationHistory.h
+ * @brief Columnar storage of a simulated trajectory.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * SimulationHistory stores one contiguous array per quantity, with a column
+ * (or block of poses) per time step: joint angles, velocities, accelerations
+ * and torques are num_joints x size() matrices indexed by joint id, and link
+ * poses are stored time-major, num_links per step, indexed by link id.
+ *
+ * Storage is preallocated with `reserve` and grows geometrically if a
+ * simulation runs longer.
+ */
+class SimulationHistory {
+ private:
+  size_t num_joints_, num_links_, size_;
+  gtsam::Matrix q_, v_, a_, tau_;
+  std::vector<gtsam::Pose3> poses_;
+
+ public:
+  /**
+   * Constructor
+   * @param num_joints number of joint-id slots, i.e., max joint id + 1
+   * @param num_links  number of link-id slots, i.e., max link id + 1
+   * @param capacity   number of time steps to preallocate
+   */
+  SimulationHistory(size_t num_joints = 0, size_t num_links = 0,
+                    size_t capacity = 0);
+
+  /// Preallocate storage for `capacity` time steps.
+  void reserve(size_t capacity);
+
+  /// Remove all recorded steps, keeping the storage.
+  void clear() { size_ = 0; }
+
+  /// Number of recorded time steps.
+  size_t size() const { return size_; }
+
+  /// Number of time steps that can be recorded without reallocation.
+  size_t capacity() const { return q_.cols(); }
+
+  /**
+   * Append a time step.
+   * @param q     joint angles
+   * @param v     joint velocities
+   * @param a     joint accelerations
+   * @param tau   joint torques
+   * @param poses link poses, indexed by link id
+   */
+  void record(const gtsam::Vector &q, const gtsam::Vector &v,
+              const gtsam::Vector &a, const gtsam::Vector &tau,
+              const std::vector<gtsam::Pose3> &poses);
+
+  /// Joint angles, one column per time step.
+  Eigen::Block<const gtsam::Matrix> jointAngles() const {
+    return q_.leftCols(size_);
+  }
+
+  /// Joint velocities, one column per time step.
+  Eigen::Block<const gtsam::Matrix> jointVels() const {
+    return v_.leftCols(size_);
+  }
+
+  /// Joint accelerations, one column per time step.
+  Eigen::Block<const gtsam::Matrix> jointAccels() const {
+    return a_.leftCols(size_);
+  }
+
+  /// Joint torques, one column per time step.
+  Eigen::Block<const gtsam::Matrix> torques() const {
+    return tau_.leftCols(size_);
+  }
+
+  /// Pose of link with id i at time step k.
+  const gtsam::Pose3 &pose(size_t k, size_t i) const {
+    return poses_[k * num_links_ + i];
+  }
+
+  /// All poses, time-major with num_links entries per step.
+  const std::vector<gtsam::Pose3> &poses() const { return poses_; }
+
+  /**
+   * Convert to time-keyed values, e.g., to initialize a trajectory
+   * optimization: joint angles, velocities, accelerations, torques and link
+   * poses for every recorded step k, inserted at time index k.
+   * @param joint_ids ids of joints to insert
+   * @param link_ids  ids of links to insert
+   */
+  gtsam::Values toValues(const std::vector<int> &joint_ids,
+                         const std::vector<int> &link_ids) const;
+};
+
+}  // namespace gtdynamics
@@ -15,15 +15,51 @@
 
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <boost/make_shared.hpp>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "gtdynamics/dynamics/ActuatorModel.h"
 #include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/LinearDynamicsSolver.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/dynamics/SimulationHistory.h"
+#include "gtdynamics/dynamics/SimulatorMetrics.h"
 #include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/Trace.h"
 #include "gtdynamics/utils/values.h"
 
 namespace gtdynamics {
+
+/// Method used by the Simulator to calculate forward dynamics.
+enum ForwardDynamicsMethod {
+  LinearGraph,
+  ArticulatedBody,
+  CompiledLinearGraph
+};
+
+/**
+ * Scheme used by the Simulator to integrate joint angles and velocities.
+ *  - ExplicitEuler: v' = v + a dt, q' = q + v dt + a dt^2 / 2 (default)
+ *  - SemiImplicitEuler: v' = v + a dt, q' = q + v' dt (symplectic)
+ *  - RungeKutta4: classic fourth order, four dynamics solves per step
+ *  - Verlet: kick-drift-kick leapfrog, symplectic and second order, with
+ *    accelerations at mid-step velocities; two dynamics solves per step
+ * Torques are held constant during a step.
+ */
+enum IntegrationScheme {
+  ExplicitEuler,
+  SemiImplicitEuler,
+  RungeKutta4,
+  Verlet
+};
+
 /**
  * Simulator is a class which simulate robot arm motion using forward
  * dynamics.
@@ -33,12 +69,60 @@ private:
   Robot robot_;
   int t_;
   DynamicsGraph graph_builder_;
+  ForwardDynamicsMethod method_;
+  IntegrationScheme scheme_ = ExplicitEuler;
+  boost::shared_ptr<RecursiveDynamics> recursive_dynamics_;
+  boost::shared_ptr<LinearDynamicsSolver> linear_solver_;
   gtsam::Values initial_values_;
   boost::optional<gtsam::Vector3> gravity_;
   boost::optional<gtsam::Vector3> planar_axis_;
-  gtsam::Values current_values_;
+  mutable gtsam::Values current_values_;
   gtsam::Values new_kinematics_;
 
+  // Joint-id indexed state used by the ArticulatedBody method, which only
+  // materializes current_values_ when asked for.
+  gtsam::Vector q_, v_, tau_;          // state for the next step
+  gtsam::Vector q_last_, v_last_;      // state used in the last forwardDynamics
+  gtsam::Vector a_last_;               // graph methods: accelerations found
+  RecursiveDynamicsResult result_;     // output of the last forwardDynamics
+  RecursiveDynamicsResult scratch_;    // for intermediate integrator stages
+  mutable bool values_stale_ = false;  // current_values_ out of date
+
+  // Optional record of all steps, and scratch space to fill it.
+  bool record_history_ = false;
+  SimulationHistory history_;
+  gtsam::Vector hq_, hv_, ha_, htau_;
+  std::vector<gtsam::Pose3> hposes_;
+
+  // Optional passive joint torques, see enablePassiveForces.
+  bool passive_ = false;
+  bool passive_implicit_ = true;
+
+  // Actuators sub-stepped within each step, see setActuator.
+  struct Actuator {
+    int j;
+    ActuatorModel::shared_ptr model;
+    gtsam::Vector state;
+  };
+  std::vector<Actuator> actuators_;
+  size_t actuator_substeps_ = 10;
+
+  // Optional per-step latencies.
+  bool collect_metrics_ = false;
+  SimulatorMetrics metrics_;
+
+  // One step of the surrogate dynamics, linearized at state x = (q, v) and
+  // torques u: x' = x_next + A (x' - x) + B (u' - u).
+  struct SurrogateStep {
+    gtsam::Vector x, u, x_next;
+    gtsam::Matrix A, B;
+  };
+  std::vector<SurrogateStep> surrogate_;
+  double surrogate_dt_ = 0;
+  double surrogate_threshold_ = 0;
+  int surrogate_start_ = 0;  // t_ at the first linearized step
+  size_t surrogate_refreshes_ = 0;
+
 public:
   /**
    * Constructor
@@ -48,13 +132,29 @@ public:
    * @param initial_values initial joint angles and velocities
    * @param gravity        gravity vector
    * @param planar_axis    planar axis vector
+   * @param method         forward dynamics method, ArticulatedBody uses the
+   *                       O(n) articulated-body algorithm and requires a tree,
+   *                       CompiledLinearGraph caches the symbolic structure
+   *                       of the linear dynamics graph.
+   *
+   * With ArticulatedBody, the state is kept in joint-id indexed vectors and
+   * stepping does not touch gtsam::Values, which are only created by
+   * getValues().
    */
   Simulator(const Robot &robot, const gtsam::Values &initial_values,
             const boost::optional<gtsam::Vector3> &gravity = boost::none,
-            const boost::optional<gtsam::Vector3> &planar_axis = boost::none)
+            const boost::optional<gtsam::Vector3> &planar_axis = boost::none,
+            ForwardDynamicsMethod method = LinearGraph)
       : robot_(robot), t_(0),
         graph_builder_(DynamicsGraph(gravity, planar_axis)),
+        method_(method),
         initial_values_(initial_values) {
+    if (method == ArticulatedBody)
+      recursive_dynamics_ =
+          boost::make_shared<RecursiveDynamics>(robot, gravity);
+    else if (method == CompiledLinearGraph)
+      linear_solver_ = boost::make_shared<LinearDynamicsSolver>(robot, gravity,
+                                                                planar_axis);
     reset();
   }
   ~Simulator() {}
@@ -63,15 +163,73 @@ public:
   void reset(const double t = 0) {
     t_ = t;
     new_kinematics_ = initial_values_;
+    history_.clear();
+    const size_t num_slots = jointSlots();
+    q_ = gtsam::Vector::Zero(num_slots);
+    v_ = gtsam::Vector::Zero(num_slots);
+    tau_ = gtsam::Vector::Zero(num_slots);
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      if (initial_values_.exists(internal::JointAngleKey(j)))
+        q_(j) = JointAngle(initial_values_, j);
+      if (initial_values_.exists(internal::JointVelKey(j)))
+        v_(j) = JointVel(initial_values_, j);
+    }
+    q_last_ = q_;
+    v_last_ = v_;
+    a_last_ = gtsam::Vector::Zero(num_slots);
+    for (auto &&actuator : actuators_)
+      actuator.state = actuator.model->initialState();
+    if (method_ == ArticulatedBody) {
+      recursive_dynamics_->setRootStates(initial_values_, 0, &result_);
+      scratch_ = result_;
+      values_stale_ = false;
+    }
   }
 
+  /**
+   * Overwrite the state for the next step, e.g. with the state of another
+   * simulator run in lockstep, without resetting time or history.
+   * @param q joint-id indexed joint angles
+   * @param v joint-id indexed joint velocities
+   */
+  void setState(const gtsam::Vector &q, const gtsam::Vector &v) {
+    if (static_cast<size_t>(q.size()) != jointSlots() ||
+        static_cast<size_t>(v.size()) != jointSlots())
+      throw std::invalid_argument(
+          "Simulator: the state should have one entry per joint id");
+    q_ = q;
+    v_ = v;
+    if (method_ == ArticulatedBody) return;
+    new_kinematics_ = gtsam::Values();
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      InsertJointVel(&new_kinematics_, j, v_(j));
+      InsertJointAngle(&new_kinematics_, j, q_(j));
+    }
+  }
+
+  /// Set the integration scheme, see IntegrationScheme.
+  void setIntegrationScheme(IntegrationScheme scheme) { scheme_ = scheme; }
+
+  /// Return the integration scheme.
+  IntegrationScheme integrationScheme() const { return scheme_; }
+
   /**
    * Perform forward dynamics to calculate accelerations.
    * @param torques torques for the time step
    */
   void forwardDynamics(const gtsam::Values &torques) {
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      tau_(j) = Torque(torques, j);
+    }
+    if (method_ == ArticulatedBody) return forwardDynamics(tau_);
+
     // Do FK to add poses
+    MetricsTimer timer(collect_metrics_);
     auto values = robot_.forwardKinematics(new_kinematics_);
+    timer.stop(&metrics_.forward_kinematics);
 
     // Add torques
     for (auto &&joint : robot_.joints()) {
@@ -80,7 +238,29 @@ public:
     }
 
     // Now compute accelerations with forward dynamics
-    current_values_ = graph_builder_.linearSolveFD(robot_, 0, values);
+    if (method_ == CompiledLinearGraph)
+      current_values_ = linear_solver_->solveForwardDynamics(values, 0);
+    else
+      current_values_ = graph_builder_.linearSolveFD(robot_, 0, values);
+    timer.stop(&metrics_.forward_dynamics);
+  }
+
+  /**
+   * Perform forward dynamics with joint-id indexed torques, only available
+   * with the ArticulatedBody method.
+   * @param torques torques for the time step
+   */
+  void forwardDynamics(const gtsam::Vector &torques) {
+    if (method_ != ArticulatedBody)
+      throw std::runtime_error(
+          "Simulator: array interface requires the ArticulatedBody method");
+    q_last_ = q_;
+    v_last_ = v_;
+    tau_ = torques;
+    MetricsTimer timer(collect_metrics_);
+    recursive_dynamics_->forwardDynamics(q_last_, v_last_, tau_, &result_);
+    timer.stop(&metrics_.forward_dynamics);
+    values_stale_ = true;
   }
 
   /**
@@ -89,44 +269,553 @@ public:
    * @param dt duration for the time step
    */
   void integration(const double dt) {
-    new_kinematics_ = gtsam::Values();
+    MetricsTimer timer(collect_metrics_);
+    integrateState(dt);
+    timer.stop(&metrics_.integration);
+  }
+
+  /**
+   * Simulate for one time step.
+   * @param torques torques for the
+   * @param dt duration for the time step
+   */
+  void step(const gtsam::Values &torques, const double dt) {
+    GTD_TRACE_SCOPE("Simulator::step");
+    MetricsTimer timer(collect_metrics_);
+    if (passive_ || !actuators_.empty()) {
+      gtsam::Vector u = gtsam::Vector::Zero(jointSlots());
+      for (auto &&joint : robot_.joints())
+        u(joint->id()) = Torque(torques, joint->id());
+      syncState();
+      u = stepTorques(u, dt);
+      if (method_ == ArticulatedBody) {
+        forwardDynamics(u);
+      } else {
+        gtsam::Values total;
+        for (auto &&joint : robot_.joints())
+          InsertTorque(&total, joint->id(), u(joint->id()));
+        forwardDynamics(total);
+      }
+    } else {
+      forwardDynamics(torques);
+    }
+    if (record_history_) recordStep();
+    integration(dt);
+    recordStepMetrics(&timer, dt);
+    t_++;
+  }
+
+  /// Simulate for one time step with joint-id indexed torques.
+  void step(const gtsam::Vector &torques, const double dt) {
+    GTD_TRACE_SCOPE("Simulator::step");
+    MetricsTimer timer(collect_metrics_);
+    if (passive_ || !actuators_.empty()) {
+      checkTorques(torques);
+      forwardDynamics(stepTorques(torques, dt));
+    } else {
+      forwardDynamics(torques);
+    }
+    if (record_history_) recordStep();
+    integration(dt);
+    recordStepMetrics(&timer, dt);
+    t_++;
+  }
+
+  /**
+   * Add the passive spring, damper and friction torques of the joints, see
+   * Joint::passiveTorque, to the torques of step() and of the exact steps
+   * of linearizeAround and surrogateStep; forwardDynamics() alone does not.
+   * Torques in getValues() and the history are then the total joint torques.
+   *
+   * Explicitly, the passive torques are those at the start of each step,
+   * which needs time steps well below the period of the stiffest spring.
+   * Implicitly, they are those at the end of the step, linearized: with
+   * stiffness K and damping D of the passive joints, the accelerations solve
+   * (M + dt D + dt^2 K) a = tau + passive - dt K v - bias, which is stable
+   * for any time step, at the cost of one more forward dynamics solve per
+   * passive joint and step. Within a step the passive torques are held
+   * constant, as are the other torques.
+   * @param enable    whether to add the passive torques
+   * @param implicit  whether to integrate them implicitly
+   */
+  void enablePassiveForces(bool enable = true, bool implicit = true) {
+    passive_ = enable;
+    passive_implicit_ = implicit;
+  }
+
+  /**
+   * Drive joint j with an actuator, e.g. a DCMotorModel, in a multi-rate
+   * simulation: the input of step() for joint j is then the command of the
+   * actuator, not a torque. Within each step the actuator state is advanced
+   * with setActuatorSubsteps() sub-steps, at the joint velocity of the start
+   * of the step and joint angles extrapolated with it, and the mean of its
+   * torques after each sub-step drives the single forward dynamics solve of
+   * the step. Torques in getValues() and the history are those torques. The
+   * states restart from ActuatorModel::initialState() at reset(); steps of
+   * linearizeAround and surrogateStep take torques and skip the actuators.
+   * @param j      id of the actuated joint
+   * @param model  the actuator dynamics, or null to remove the actuator
+   */
+  void setActuator(int j, const ActuatorModel::shared_ptr &model) {
+    if (j < 0 || static_cast<size_t>(j) >= jointSlots())
+      throw std::invalid_argument("Simulator: no joint with id " +
+                                  std::to_string(j));
+    actuators_.erase(
+        std::remove_if(actuators_.begin(), actuators_.end(),
+                       [j](const Actuator &a) { return a.j == j; }),
+        actuators_.end());
+    if (model) actuators_.push_back({j, model, model->initialState()});
+  }
+
+  /// Set the number of actuator sub-steps per step, 10 by default.
+  void setActuatorSubsteps(size_t num_substeps) {
+    if (num_substeps == 0)
+      throw std::invalid_argument(
+          "Simulator: need at least one actuator sub-step");
+    actuator_substeps_ = num_substeps;
+  }
+
+  /// Current state of the actuator of joint j, see setActuator.
+  const gtsam::Vector &actuatorState(int j) const {
+    for (auto &&actuator : actuators_)
+      if (actuator.j == j) return actuator.state;
+    throw std::invalid_argument("Simulator: no actuator on joint " +
+                                std::to_string(j));
+  }
+
+  /**
+   * Collect the latencies of forward kinematics, forward dynamics,
+   * integration and whole steps, and the real-time factor, see
+   * SimulatorMetrics. Disabled, the cost is one branch per phase. The metrics
+   * are kept by reset(), so they can cover many rollouts.
+   */
+  void enableMetrics(bool enable = true) { collect_metrics_ = enable; }
+
+  /// Return the metrics collected so far, see enableMetrics.
+  const SimulatorMetrics &metrics() const { return metrics_; }
+
+  /// Forget the metrics collected so far.
+  void resetMetrics() { metrics_.reset(); }
+
+ private:
+  // Body of integration().
+  void integrateState(const double dt) {
     const double dt2 = std::pow(dt, 2);
+    if (method_ == ArticulatedBody) {
+      integrate(q_last_, v_last_, result_.joint_accels, dt, &q_, &v_);
+      return;
+    }
+
+    if (scheme_ != ExplicitEuler) {
+      for (auto &&joint : robot_.joints()) {
+        auto j = joint->id();
+        q_last_(j) = JointAngle(current_values_, j);
+        v_last_(j) = JointVel(current_values_, j);
+        a_last_(j) = JointAccel(current_values_, j);
+      }
+      integrate(q_last_, v_last_, a_last_, dt, &q_, &v_);
+      new_kinematics_ = gtsam::Values();
+      for (auto &&joint : robot_.joints()) {
+        auto j = joint->id();
+        InsertJointVel(&new_kinematics_, j, v_(j));
+        InsertJointAngle(&new_kinematics_, j, q_(j));
+      }
+      return;
+    }
+
+    new_kinematics_ = gtsam::Values();
     for (auto &&joint : robot_.joints()) {
       auto j = joint->id();
       const double q = JointAngle(current_values_, j);
       const double v = JointVel(current_values_, j);
       const double a = JointAccel(current_values_, j);
 
-      // TODO(frank): one could use t values and save entire simulation.
       const double v_new = v + dt * a;
       InsertJointVel(&new_kinematics_, j, v_new);
-      // TODO(frank): consider using v_new for symplectic integration.
       InsertJointAngle(&new_kinematics_, j, q + dt * v + 0.5 * a * dt2);
     }
   }
 
+  // Count a step of duration dt timed by `timer`.
+  void recordStepMetrics(MetricsTimer *timer, double dt) {
+    if (!collect_metrics_) return;
+    metrics_.wall_time += timer->stop(&metrics_.step);
+    metrics_.simulated_time += dt;
+  }
+
+ public:
+
   /**
-   * Simulate for one time step.
-   * @param torques torques for the
-   * @param dt duration for the time step
+   * Record q, v, a, tau and link poses of every subsequent step into a
+   * columnar history, see SimulationHistory.
+   * @param capacity number of steps to preallocate
    */
-  void step(const gtsam::Values &torques, const double dt) {
-    forwardDynamics(torques);
-    integration(dt);
-    t_++;
+  void recordHistory(size_t capacity = 0) {
+    record_history_ = true;
+    history_ = SimulationHistory(jointSlots(), linkSlots(), capacity);
+    hq_ = gtsam::Vector::Zero(jointSlots());
+    hv_ = hq_;
+    ha_ = hq_;
+    htau_ = hq_;
+    hposes_.resize(linkSlots());
   }
 
+  /// Return the recorded history, see recordHistory.
+  const SimulationHistory &history() const { return history_; }
+
   /// Simulation for the specified sequence of torques.
   gtsam::Values simulate(const std::vector<gtsam::Values> &torques_seq,
                          const double dt) {
     for (const auto &torques : torques_seq) {
       step(torques, dt);
     }
-    return current_values_;
+    return getValues();
+  }
+
+  /**
+   * Linearize the dynamics around a nominal trajectory, for surrogateStep.
+   * The trajectory starts at the current state and applies the nominal
+   * torques, with exact steps of the current method and scheme; the
+   * Jacobians A_t, B_t of each step in the state (q, v) and the torques are
+   * found by central differences. The simulator state is not changed, and
+   * the linear models are kept by reset(), so that many rollouts from the
+   * same state reuse them.
+   * @param nominal_torques    joint-id indexed torques of each step
+   * @param dt                 duration of each step
+   * @param refresh_threshold  largest deviation, in the max norm, of the
+   *                           state from the nominal state of a step before
+   *                           that step is linearized again at the state
+   */
+  void linearizeAround(
+      const std::vector<gtsam::Vector> &nominal_torques, const double dt,
+      const double refresh_threshold =
+          std::numeric_limits<double>::infinity()) {
+    GTD_TRACE_SCOPE("Simulator::linearizeAround");
+    syncState();
+    surrogate_.clear();
+    surrogate_dt_ = dt;
+    surrogate_threshold_ = refresh_threshold;
+    surrogate_start_ = t_;
+    surrogate_refreshes_ = 0;
+    gtsam::Vector x(2 * q_.size());
+    x << q_, v_;
+    for (auto &&u : nominal_torques) {
+      checkTorques(u);
+      surrogate_.push_back(linearizeStep(x, u));
+      x = surrogate_.back().x_next;
+    }
   }
 
+  /**
+   * Simulate for one time step with the linear models of linearizeAround,
+   * which costs two matrix-vector products instead of a dynamics solve.
+   * Steps before or after the linearized trajectory are exact. Only the
+   * state, jointAngles() and jointVels(), is updated, not getValues().
+   * Surrogate and exact steps may be mixed, e.g. a rollout from reset().
+   * @param torques joint-id indexed torques for the time step
+   */
+  void surrogateStep(const gtsam::Vector &torques) {
+    GTD_TRACE_SCOPE("Simulator::surrogateStep");
+    checkTorques(torques);
+    syncState();
+    const size_t n = q_.size();
+    gtsam::Vector x(2 * n);
+    x << q_, v_;
+    const int k = t_ - surrogate_start_;
+    if (k >= 0 && k < static_cast<int>(surrogate_.size())) {
+      SurrogateStep &s = surrogate_[k];
+      if ((x - s.x).lpNorm<Eigen::Infinity>() > surrogate_threshold_) {
+        s = linearizeStep(x, torques);
+        ++surrogate_refreshes_;
+      }
+      x = s.x_next + s.A * (x - s.x) + s.B * (torques - s.u);
+    } else {
+      x = exactStep(x, torques, surrogate_dt_);
+    }
+    q_ = x.head(n);
+    v_ = x.tail(n);
+    tau_ = torques;
+    if (method_ != ArticulatedBody) {
+      new_kinematics_ = gtsam::Values();
+      for (auto &&joint : robot_.joints()) {
+        auto j = joint->id();
+        InsertJointVel(&new_kinematics_, j, v_(j));
+        InsertJointAngle(&new_kinematics_, j, q_(j));
+      }
+    }
+    t_++;
+  }
+
+  /// Number of linearized steps, see linearizeAround.
+  size_t surrogateSteps() const { return surrogate_.size(); }
+
+  /// Number of steps linearized again by surrogateStep.
+  size_t surrogateRefreshes() const { return surrogate_refreshes_; }
+
+  /// Joint angles for the next step, ArticulatedBody method or surrogateStep.
+  const gtsam::Vector &jointAngles() const { return q_; }
+
+  /// Joint velocities for the next step, ArticulatedBody method or
+  /// surrogateStep.
+  const gtsam::Vector &jointVels() const { return v_; }
+
+  /// Joint accelerations of the last step, ArticulatedBody method only.
+  const gtsam::Vector &jointAccels() const { return result_.joint_accels; }
+
   /// Return all values during simulation.
-  const gtsam::Values &getValues() const { return current_values_; }
+  const gtsam::Values &getValues() const {
+    if (values_stale_) {
+      // Materialize the array state of the last forward dynamics step.
+      current_values_ = gtsam::Values();
+      for (auto &&joint : robot_.joints()) {
+        auto j = joint->id();
+        InsertJointAngle(&current_values_, j, q_last_(j));
+        InsertJointVel(&current_values_, j, v_last_(j));
+        InsertTorque(&current_values_, j, tau_(j));
+      }
+      recursive_dynamics_->insert(result_, 0, true, &current_values_);
+      values_stale_ = false;
+    }
+    return current_values_;
+  }
+
+ private:
+  /**
+   * Integrate one step with the current scheme and torques.
+   * @param q joint angles at the start of the step
+   * @param v joint velocities at the start of the step
+   * @param a joint accelerations at (q, v)
+   * @param dt duration of the step
+   * @param q_new joint angles at the end of the step (output)
+   * @param v_new joint velocities at the end of the step (output)
+   */
+  void integrate(const gtsam::Vector &q, const gtsam::Vector &v,
+                 const gtsam::Vector &a, double dt, gtsam::Vector *q_new,
+                 gtsam::Vector *v_new) {
+    switch (scheme_) {
+      case ExplicitEuler:
+        *q_new = q + dt * v + 0.5 * dt * dt * a;
+        *v_new = v + dt * a;
+        break;
+      case SemiImplicitEuler:
+        *v_new = v + dt * a;
+        *q_new = q + dt * (*v_new);
+        break;
+      case RungeKutta4: {
+        // Stages of (q, v)' = (v, a(q, v)), k1 = (v, a).
+        const gtsam::Vector q2 = q + 0.5 * dt * v, v2 = v + 0.5 * dt * a;
+        const gtsam::Vector a2 = accelerations(q2, v2);
+        const gtsam::Vector q3 = q + 0.5 * dt * v2, v3 = v + 0.5 * dt * a2;
+        const gtsam::Vector a3 = accelerations(q3, v3);
+        const gtsam::Vector q4 = q + dt * v3, v4 = v + dt * a3;
+        const gtsam::Vector a4 = accelerations(q4, v4);
+        *q_new = q + dt / 6 * (v + 2 * v2 + 2 * v3 + v4);
+        *v_new = v + dt / 6 * (a + 2 * a2 + 2 * a3 + a4);
+        break;
+      }
+      case Verlet: {
+        const gtsam::Vector v_half = v + 0.5 * dt * a;
+        *q_new = q + dt * v_half;
+        *v_new = v_half + 0.5 * dt * accelerations(*q_new, v_half);
+        break;
+      }
+    }
+  }
+
+  /// Joint accelerations for state (q, v) under the current torques.
+  gtsam::Vector accelerations(const gtsam::Vector &q, const gtsam::Vector &v) {
+    if (method_ == ArticulatedBody) {
+      recursive_dynamics_->forwardDynamics(q, v, tau_, &scratch_);
+      return scratch_.joint_accels;
+    }
+    gtsam::Values known;
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      InsertJointAngle(&known, j, q(j));
+      InsertJointVel(&known, j, v(j));
+    }
+    auto values = robot_.forwardKinematics(known);
+    for (auto &&joint : robot_.joints())
+      InsertTorque(&values, joint->id(), tau_(joint->id()));
+    const gtsam::Values result =
+        method_ == CompiledLinearGraph
+            ? linear_solver_->solveForwardDynamics(values, 0)
+            : graph_builder_.linearSolveFD(robot_, 0, values);
+    gtsam::Vector a = gtsam::Vector::Zero(q.size());
+    for (auto &&joint : robot_.joints())
+      a(joint->id()) = JointAccel(result, joint->id());
+    return a;
+  }
+
+  /**
+   * Torques u plus the passive torques at state (q, v), see
+   * enablePassiveForces. Implicitly, with P the passive joints, W the block
+   * of the inverse mass matrix on P, found from unit torques, and a0 the
+   * accelerations under the explicit torques, the change of the passive
+   * torques over the step, linearized, is
+   *   delta = -dt K v - C (a0 + W delta),  C = dt D + dt^2 K.
+   */
+  gtsam::Vector totalTorques(const gtsam::Vector &q, const gtsam::Vector &v,
+                             const gtsam::Vector &u, double dt) {
+    gtsam::Vector total = u;
+    std::vector<int> passive;
+    std::vector<double> stiffness, compliance;
+    for (auto &&joint : robot_.joints()) {
+      if (!joint->hasPassiveTorque()) continue;
+      const int j = joint->id();
+      double dq, dv;
+      total(j) += joint->passiveTorque(q(j), v(j), &dq, &dv);
+      const double c = -dv * dt - dq * dt * dt;
+      if (!passive_implicit_ || dt <= 0 || c == 0) continue;
+      passive.push_back(j);
+      stiffness.push_back(-dq);
+      compliance.push_back(c);
+    }
+    if (passive.empty()) return total;
+
+    const gtsam::Vector tau = tau_;
+    const size_t p = passive.size();
+    tau_ = total;
+    const gtsam::Vector a0 = accelerations(q, v);
+    gtsam::Matrix lhs = gtsam::Matrix::Identity(p, p);
+    gtsam::Vector rhs(p);
+    for (size_t c = 0; c < p; ++c) {
+      tau_(passive[c]) += 1.0;
+      const gtsam::Vector column = accelerations(q, v) - a0;
+      tau_(passive[c]) -= 1.0;
+      for (size_t r = 0; r < p; ++r)
+        lhs(r, c) += compliance[r] * column(passive[r]);
+      rhs(c) = -dt * stiffness[c] * v(passive[c]) -
+               compliance[c] * a0(passive[c]);
+    }
+    tau_ = tau;
+    const gtsam::Vector delta = lhs.partialPivLu().solve(rhs);
+    for (size_t c = 0; c < p; ++c) total(passive[c]) += delta(c);
+    return total;
+  }
+
+  /**
+   * Joint torques of a step from its inputs u: the commands of actuated
+   * joints are replaced by the mean actuator torques over the sub-steps,
+   * then the passive torques are added, see enablePassiveForces.
+   */
+  gtsam::Vector stepTorques(const gtsam::Vector &u, double dt) {
+    gtsam::Vector tau = u;
+    const double h = dt / actuator_substeps_;
+    for (auto &&actuator : actuators_) {
+      const int j = actuator.j;
+      double sum = 0;
+      for (size_t s = 1; s <= actuator_substeps_; ++s) {
+        actuator.model->step(h, u(j), q_(j) + (s - 0.5) * h * v_(j), v_(j),
+                             &actuator.state);
+        sum += actuator.model->torque(actuator.state, q_(j) + s * h * v_(j),
+                                      v_(j));
+      }
+      tau(j) = sum / actuator_substeps_;
+    }
+    return passive_ ? totalTorques(q_, v_, tau, dt) : tau;
+  }
+
+  /// Throw if torques are not joint-id indexed.
+  void checkTorques(const gtsam::Vector &torques) const {
+    if (static_cast<size_t>(torques.size()) != jointSlots())
+      throw std::invalid_argument(
+          "Simulator: torques should have one entry per joint id");
+  }
+
+  /// State from new_kinematics_ for the graph methods.
+  void syncState() {
+    if (method_ == ArticulatedBody) return;
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      q_(j) = new_kinematics_.exists(internal::JointAngleKey(j))
+                  ? JointAngle(new_kinematics_, j)
+                  : 0.0;
+      v_(j) = new_kinematics_.exists(internal::JointVelKey(j))
+                  ? JointVel(new_kinematics_, j)
+                  : 0.0;
+    }
+  }
+
+  /// Exact step from state x = (q, v) with torques u.
+  gtsam::Vector exactStep(const gtsam::Vector &x, const gtsam::Vector &u,
+                          double dt) {
+    const size_t n = x.size() / 2;
+    const gtsam::Vector tau = tau_;
+    const gtsam::Vector q = x.head(n), v = x.tail(n);
+    tau_ = passive_ ? totalTorques(q, v, u, dt) : u;
+    gtsam::Vector q_new, v_new;
+    integrate(q, v, accelerations(q, v), dt, &q_new, &v_new);
+    tau_ = tau;
+    gtsam::Vector x_new(2 * n);
+    x_new << q_new, v_new;
+    return x_new;
+  }
+
+  /// Linear model of the step from state x with torques u.
+  SurrogateStep linearizeStep(const gtsam::Vector &x, const gtsam::Vector &u) {
+    const size_t n = u.size();
+    const double h = 1e-6;
+    SurrogateStep s;
+    s.x = x;
+    s.u = u;
+    s.x_next = exactStep(x, u, surrogate_dt_);
+    s.A = gtsam::Matrix::Zero(2 * n, 2 * n);
+    s.B = gtsam::Matrix::Zero(2 * n, n);
+    for (auto &&joint : robot_.joints()) {
+      const size_t j = joint->id();
+      for (size_t i : {j, n + j}) {
+        gtsam::Vector plus = x, minus = x;
+        plus(i) += h;
+        minus(i) -= h;
+        s.A.col(i) = (exactStep(plus, u, surrogate_dt_) -
+                      exactStep(minus, u, surrogate_dt_)) /
+                     (2 * h);
+      }
+      gtsam::Vector plus = u, minus = u;
+      plus(j) += h;
+      minus(j) -= h;
+      s.B.col(j) = (exactStep(x, plus, surrogate_dt_) -
+                    exactStep(x, minus, surrogate_dt_)) /
+                   (2 * h);
+    }
+    return s;
+  }
+
+  /// Append the last forward dynamics step to the history.
+  void recordStep() {
+    if (method_ == ArticulatedBody) {
+      history_.record(q_last_, v_last_, result_.joint_accels, tau_,
+                      result_.poses);
+      return;
+    }
+    for (auto &&joint : robot_.joints()) {
+      auto j = joint->id();
+      hq_(j) = JointAngle(current_values_, j);
+      hv_(j) = JointVel(current_values_, j);
+      ha_(j) = JointAccel(current_values_, j);
+      htau_(j) = Torque(current_values_, j);
+    }
+    for (auto &&link : robot_.links())
+      hposes_[link->id()] = Pose(current_values_, link->id());
+    history_.record(hq_, hv_, ha_, htau_, hposes_);
+  }
+
+  /// Number of entries in link-id indexed vectors.
+  size_t linkSlots() const {
+    size_t num_slots = 0;
+    for (auto &&link : robot_.links())
+      num_slots = std::max<size_t>(num_slots, link->id() + 1);
+    return num_slots;
+  }
+
+  /// Number of entries in joint-id indexed vectors.
+  size_t jointSlots() const {
+    size_t num_slots = 0;
+    for (auto &&joint : robot_.joints())
+      num_slots = std::max<size_t>(num_slots, joint->id() + 1);
+    return num_slots;
+  }
 };
 
 } // namespace gtdynamics
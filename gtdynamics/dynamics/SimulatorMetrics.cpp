@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SimulatorMetrics.cpp
+ * @brief Per-step latencies and real-time factor of simulators.
+ */
+
+#include "gtdynamics/dynamics/SimulatorMetrics.h"
+
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+void SimulatorMetrics::merge(const SimulatorMetrics &other) {
+  forward_kinematics.merge(other.forward_kinematics);
+  forward_dynamics.merge(other.forward_dynamics);
+  integration.merge(other.integration);
+  step.merge(other.step);
+  simulated_time += other.simulated_time;
+  wall_time += other.wall_time;
+}
+
+/* ************************************************************************* */
+void SimulatorMetrics::reset() {
+  forward_kinematics.reset();
+  forward_dynamics.reset();
+  integration.reset();
+  step.reset();
+  simulated_time = wall_time = 0;
+}
+
+/* ************************************************************************* */
+std::string SimulatorMetrics::toJson() const {
+  std::ostringstream os;
+  os << std::setprecision(10);
+  os << "{\n"
+     << "  \"simulated_time\": " << simulated_time << ",\n"
+     << "  \"wall_time\": " << wall_time << ",\n"
+     << "  \"real_time_factor\": " << realTimeFactor() << ",\n"
+     << "  \"forward_kinematics\": " << forward_kinematics.toJson(2) << ",\n"
+     << "  \"forward_dynamics\": " << forward_dynamics.toJson(2) << ",\n"
+     << "  \"integration\": " << integration.toJson(2) << ",\n"
+     << "  \"step\": " << step.toJson(2) << "\n"
+     << "}\n";
+  return os.str();
+}
+
+/* ************************************************************************* */
+void SimulatorMetrics::saveJson(const std::string &file_path) const {
+  std::ofstream file(file_path);
+  if (!file)
+    throw std::runtime_error("SimulatorMetrics::saveJson: cannot open " +
+                             file_path + ".");
+  file << toJson();
+}
+
+/* ************************************************************************* */
+void SimulatorMetrics::print(std::ostream &os) const {
+  os << step.count() << " steps, real-time factor " << realTimeFactor()
+     << "\n";
+  const std::pair<const char *, const LatencyHistogram *> phases[] = {
+      {"forward kinematics", &forward_kinematics},
+      {"forward dynamics", &forward_dynamics},
+      {"integration", &integration},
+      {"step", &step}};
+  for (auto &&phase : phases) {
+    if (!phase.second->count()) continue;
+    os << "  " << phase.first << ": p50 " << 1e6 * phase.second->percentile(50)
+       << " us, p99 " << 1e6 * phase.second->percentile(99) << " us, max "
+       << 1e6 * phase.second->max() << " us\n";
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SimulatorMetrics.h
+ * @brief Per-step latencies and real-time factor of simulators.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+
+#include "gtdynamics/utils/LatencyHistogram.h"
+
+namespace gtdynamics {
+
+/**
+ * Latencies of the phases of simulation steps, collected by Simulator and
+ * BatchSimulator when enabled. Each histogram holds one duration per step:
+ * forward kinematics, forward dynamics, integration (with the extra dynamics
+ * solves of RungeKutta4 and Verlet), and the whole step. The articulated-body
+ * algorithm computes kinematics and dynamics in the same sweeps, so with it
+ * forward_kinematics stays empty and forward_dynamics includes both.
+ */
+struct SimulatorMetrics {
+  LatencyHistogram forward_kinematics, forward_dynamics, integration, step;
+  double simulated_time = 0;  ///< sum of the step durations dt, in seconds
+  double wall_time = 0;       ///< time spent stepping, in seconds
+
+  /// Simulated seconds per wall-clock second, 0 before the first step.
+  double realTimeFactor() const {
+    return wall_time > 0 ? simulated_time / wall_time : 0.0;
+  }
+
+  /// Add the steps of `other`.
+  void merge(const SimulatorMetrics &other);
+
+  /// Forget all steps.
+  void reset();
+
+  /// JSON object with the real-time factor and all histograms.
+  std::string toJson() const;
+
+  /// Write toJson() to a file, throws std::runtime_error if it fails.
+  void saveJson(const std::string &file_path) const;
+
+  /// Print p50, p99 and max of each phase and the real-time factor.
+  void print(std::ostream &os) const;
+};
+
+/// Wall-clock time of a phase, recorded into a histogram only if enabled.
+class MetricsTimer {
+ public:
+  explicit MetricsTimer(bool enabled)
+      : enabled_(enabled),
+        start_(enabled ? std::chrono::steady_clock::now()
+                       : std::chrono::steady_clock::time_point()) {}
+
+  /// Start timing again from now.
+  void restart() {
+    if (enabled_) start_ = std::chrono::steady_clock::now();
+  }
+
+  /// Record the seconds since construction, or the last stop or restart,
+  /// into `histogram` and return them; does nothing and returns 0 if
+  /// disabled.
+  double stop(LatencyHistogram *histogram) {
+    if (!enabled_) return 0.0;
+    const auto now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - start_).count();
+    histogram->record(seconds);
+    start_ = now;
+    return seconds;
+  }
+
+ private:
+  bool enabled_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,195 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFeasibilityChecker.cpp
+ * @brief Per-step feasibility of dense trajectories, without a factor graph.
+ */
+
+#include "gtdynamics/dynamics/TrajectoryFeasibilityChecker.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using gtsam::Matrix;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+bool FeasibilityReport::feasible() const {
+  return firstViolation() == flags.size();
+}
+
+/* ************************************************************************* */
+size_t FeasibilityReport::firstViolation() const {
+  return std::find_if(flags.begin(), flags.end(),
+                      [](uint8_t f) { return f != 0; }) -
+         flags.begin();
+}
+
+/* ************************************************************************* */
+size_t FeasibilityReport::count(uint8_t violations) const {
+  return std::count_if(flags.begin(), flags.end(), [&](uint8_t f) {
+    return (f & violations) != 0;
+  });
+}
+
+/* ************************************************************************* */
+TrajectoryFeasibilityChecker::TrajectoryFeasibilityChecker(
+    const Robot &robot, const PointOnLinks &contact_points,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const FeasibilityParameters &parameters)
+    : contact_points_(contact_points),
+      p_(parameters),
+      inverse_dynamics_(robot, gravity, parameters.num_threads),
+      forward_kinematics_(robot, parameters.num_threads) {
+  if (contact_points.size() > 64)
+    throw std::invalid_argument(
+        "TrajectoryFeasibilityChecker: at most 64 contact points.");
+
+  // Up axis as in ContactDynamicsFrictionConeFactor.
+  up_axis_ = 2;
+  if (gravity && (*gravity)[0] != 0)
+    up_axis_ = 0;
+  else if (gravity && (*gravity)[1] != 0)
+    up_axis_ = 1;
+
+  num_joint_slots_ = inverse_dynamics_.numJointSlots();
+  const double inf = std::numeric_limits<double>::infinity();
+  lower_.setConstant(num_joint_slots_, -inf);
+  upper_.setConstant(num_joint_slots_, inf);
+  max_velocity_.setConstant(num_joint_slots_, inf);
+  max_torque_.setConstant(num_joint_slots_, inf);
+  for (auto &&joint : robot.joints()) {
+    const JointParams &params = joint->parameters();
+    const int j = joint->id();
+    const JointScalarLimit &limits = params.scalar_limits;
+    lower_(j) = limits.value_lower_limit - limits.value_limit_threshold;
+    upper_(j) = limits.value_upper_limit + limits.value_limit_threshold;
+    max_velocity_(j) = params.velocity_limit + params.velocity_limit_threshold;
+    max_torque_(j) = params.torque_limit + params.torque_limit_threshold;
+  }
+}
+
+/* ************************************************************************* */
+void TrajectoryFeasibilityChecker::checkSizes(
+    const Matrix &Q, const Matrix &V, const Matrix &Tau,
+    const Matrix &contact_wrenches,
+    const std::vector<uint64_t> &in_contact) const {
+  const size_t J = num_joint_slots_;
+  if (size_t(Q.cols()) != J || size_t(V.cols()) != J ||
+      size_t(Tau.cols()) != J || V.rows() != Q.rows() ||
+      Tau.rows() != Q.rows())
+    throw std::invalid_argument(
+        "TrajectoryFeasibilityChecker: trajectories need one row per step "
+        "and one column per joint slot.");
+  if (contact_wrenches.size() > 0 &&
+      (contact_wrenches.rows() != Q.rows() ||
+       size_t(contact_wrenches.cols()) != 6 * contact_points_.size()))
+    throw std::invalid_argument(
+        "TrajectoryFeasibilityChecker: contact wrenches need one row per "
+        "step and six columns per contact point.");
+  if (!in_contact.empty() && in_contact.size() != size_t(Q.rows()))
+    throw std::invalid_argument(
+        "TrajectoryFeasibilityChecker: need one contact mask per step.");
+}
+
+/* ************************************************************************* */
+FeasibilityReport TrajectoryFeasibilityChecker::check(
+    const Matrix &Q, const Matrix &V, const Matrix &A,
+    const Matrix &contact_wrenches, const std::vector<uint64_t> &in_contact) {
+  checkSizes(Q, V, A, contact_wrenches, in_contact);
+  FeasibilityReport report;
+  report.torques = inverse_dynamics_.torques(Q, V, A);
+  checkAll(Q, V, contact_wrenches, in_contact, &report);
+  return report;
+}
+
+/* ************************************************************************* */
+FeasibilityReport TrajectoryFeasibilityChecker::checkTorques(
+    const Matrix &Q, const Matrix &V, const Matrix &Tau,
+    const Matrix &contact_wrenches, const std::vector<uint64_t> &in_contact) {
+  checkSizes(Q, V, Tau, contact_wrenches, in_contact);
+  FeasibilityReport report;
+  report.torques = Tau;
+  checkAll(Q, V, contact_wrenches, in_contact, &report);
+  return report;
+}
+
+/* ************************************************************************* */
+void TrajectoryFeasibilityChecker::checkAll(
+    const Matrix &Q, const Matrix &V, const Matrix &contact_wrenches,
+    const std::vector<uint64_t> &in_contact, FeasibilityReport *report) {
+  using Flags = Eigen::Array<uint8_t, Eigen::Dynamic, 1>;
+  using Violation = FeasibilityReport::Violation;
+  const Eigen::Index T = Q.rows();
+  Flags flags = Flags::Zero(T);
+
+  auto mark = [&](const Eigen::Array<bool, Eigen::Dynamic, 1> &violated,
+                  uint8_t bit) {
+    for (Eigen::Index k = 0; k < T; ++k)
+      if (violated(k)) flags(k) |= bit;
+  };
+
+  // Limits: one comparison per entry, reduced over each row.
+  const auto q = Q.array();
+  mark(((q.rowwise() - lower_.array()) < 0 ||
+        (q.rowwise() - upper_.array()) > 0)
+           .rowwise()
+           .any(),
+       Violation::kJointLimit);
+  mark(((V.array().abs().rowwise() - max_velocity_.array()) > 0)
+           .rowwise()
+           .any(),
+       Violation::kVelocityLimit);
+  mark(((report->torques.array().abs().rowwise() - max_torque_.array()) > 0)
+           .rowwise()
+           .any(),
+       Violation::kTorqueLimit);
+
+  // Contacts, with the link poses of all steps.
+  if (!contact_points_.empty()) {
+    forward_kinematics_.compute(Q, &poses_);
+    const double mu2 = p_.mu * p_.mu;
+    Eigen::ArrayXd height(T), f_s[3];
+    Eigen::Array<bool, Eigen::Dynamic, 1> stance(T);
+    for (size_t c = 0; c < contact_points_.size(); ++c) {
+      const int i = contact_points_[c].link->id();
+      const gtsam::Point3 &p = contact_points_[c].point;
+      for (Eigen::Index k = 0; k < T; ++k)
+        stance(k) = in_contact.empty() || ((in_contact[k] >> c) & 1);
+
+      // Up coordinate of t + R p.
+      const int u = up_axis_;
+      height = poses_.translation(i, u).array() +
+               p.x() * poses_.rotation(i, u, 0).array() +
+               p.y() * poses_.rotation(i, u, 1).array() +
+               p.z() * poses_.rotation(i, u, 2).array();
+      mark(stance && (height - p_.ground_height).abs() > p_.contact_height_tol,
+           Violation::kContactHeight);
+
+      if (contact_wrenches.size() == 0) continue;
+      // Linear force R f_c in the world frame, and the cone residual.
+      for (int r = 0; r < 3; ++r) {
+        f_s[r].setZero(T);
+        for (int cc = 0; cc < 3; ++cc)
+          f_s[r] += poses_.rotation(i, r, cc).array() *
+                    contact_wrenches.col(6 * c + 3 + cc).array();
+      }
+      Eigen::ArrayXd residual = -mu2 * f_s[u].square();
+      for (int r = 0; r < 3; ++r)
+        if (r != u) residual += f_s[r].square();
+      mark(stance && residual > p_.friction_cone_tol,
+           Violation::kFrictionCone);
+    }
+  }
+
+  report->flags.assign(flags.data(), flags.data() + T);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFeasibilityChecker.h
+ * @brief Per-step feasibility of dense trajectories, without a factor graph.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "gtdynamics/dynamics/BatchInverseDynamics.h"
+#include "gtdynamics/universal_robot/BatchForwardKinematics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/PointOnLink.h"
+
+namespace gtdynamics {
+
+/// Parameters of TrajectoryFeasibilityChecker.
+struct FeasibilityParameters {
+  double mu = 1.0;                   ///< friction coefficient of contacts
+  double ground_height = 0.0;        ///< height of the ground plane
+  double contact_height_tol = 1e-3;  ///< allowed |height - ground_height|
+  double friction_cone_tol = 0.0;    ///< allowed friction cone residual
+  size_t num_threads = 0;            ///< 0 for hardware concurrency
+};
+
+/**
+ * Per-step result of TrajectoryFeasibilityChecker: flags[k] is a bitmask of
+ * the Violation bits of step k, zero if step k is feasible.
+ */
+struct FeasibilityReport {
+  /// Violation bits.
+  enum Violation : uint8_t {
+    kJointLimit = 1,
+    kVelocityLimit = 2,
+    kTorqueLimit = 4,
+    kFrictionCone = 8,
+    kContactHeight = 16
+  };
+
+  std::vector<uint8_t> flags;  ///< one bitmask per step
+  gtsam::Matrix torques;       ///< #steps x #joint slots, as checked
+
+  /// Whether no step violates any constraint.
+  bool feasible() const;
+
+  /// Index of the first infeasible step, or flags.size() if there is none.
+  size_t firstViolation() const;
+
+  /// Number of steps with the given violation bits set.
+  size_t count(uint8_t violations) const;
+};
+
+/**
+ * TrajectoryFeasibilityChecker screens candidate plans and cached solutions
+ * before they are accepted or handed to a solver, replacing the evaluation
+ * of the error of a whole NonlinearFactorGraph.
+ *
+ * Torques come from BatchInverseDynamics, or are given, and are checked
+ * against the torque limits of the joints, and angles and velocities
+ * against the joint and velocity limits, each with its threshold, as
+ * JointLimitFactor does. For contacts in stance, the contact point is held
+ * within contact_height_tol of the ground as by ContactHeightFactor, and the
+ * contact wrench, in the link CoM frame, is checked with the squared cone
+ * residual of ContactDynamicsFrictionConeFactor, |f_t|^2 - mu^2 f_up^2. The
+ * up axis is that of gravity, z by default.
+ *
+ * Every check is a column-wise comparison over all steps, on the joint-id
+ * indexed trajectories and on a PoseBatch from BatchForwardKinematics, so
+ * the cost per step is that of the inverse and forward kinematics passes.
+ * Buffers are reused, so an instance is not thread-safe: use one per thread.
+ */
+class TrajectoryFeasibilityChecker {
+ public:
+  /**
+   * Constructor
+   * @param robot           the robot, needs to have a tree structure
+   * @param contact_points  points on links that may touch the ground, at
+   *                        most 64
+   * @param gravity         gravity vector, also defines the up axis
+   * @param parameters      friction, ground plane, tolerances, and threads
+   */
+  TrajectoryFeasibilityChecker(
+      const Robot &robot, const PointOnLinks &contact_points = PointOnLinks(),
+      const boost::optional<gtsam::Vector3> &gravity = boost::none,
+      const FeasibilityParameters &parameters = FeasibilityParameters());
+
+  /// Number of joint slots, i.e., of columns of the trajectories.
+  size_t numJointSlots() const { return num_joint_slots_; }
+
+  /**
+   * Check a trajectory, with torques from inverse dynamics. Floating roots
+   * are at the identity with zero twist, as in BatchInverseDynamics, and
+   * contact wrenches are not applied, so for legged robots the torques of
+   * checkTorques should be preferred.
+   * @param Q                 joint angles, #steps x #joint slots
+   * @param V                 joint velocities, same layout
+   * @param A                 joint accelerations, same layout
+   * @param contact_wrenches  #steps x 6 #contacts, the wrench of contact c
+   *                          in columns 6 c to 6 c + 5, or empty to skip the
+   *                          friction cones
+   * @param in_contact        bitmask of the contacts in stance at every step,
+   *                          or empty if all are in stance at every step
+   */
+  FeasibilityReport check(
+      const gtsam::Matrix &Q, const gtsam::Matrix &V, const gtsam::Matrix &A,
+      const gtsam::Matrix &contact_wrenches = gtsam::Matrix(),
+      const std::vector<uint64_t> &in_contact = std::vector<uint64_t>());
+
+  /// Check a trajectory with given torques Tau, as `check` otherwise.
+  FeasibilityReport checkTorques(
+      const gtsam::Matrix &Q, const gtsam::Matrix &V, const gtsam::Matrix &Tau,
+      const gtsam::Matrix &contact_wrenches = gtsam::Matrix(),
+      const std::vector<uint64_t> &in_contact = std::vector<uint64_t>());
+
+ private:
+  // Check the sizes of the inputs.
+  void checkSizes(const gtsam::Matrix &Q, const gtsam::Matrix &V,
+                  const gtsam::Matrix &Tau,
+                  const gtsam::Matrix &contact_wrenches,
+                  const std::vector<uint64_t> &in_contact) const;
+
+  // Run all checks, report->torques already set.
+  void checkAll(const gtsam::Matrix &Q, const gtsam::Matrix &V,
+                const gtsam::Matrix &contact_wrenches,
+                const std::vector<uint64_t> &in_contact,
+                FeasibilityReport *report);
+
+  size_t num_joint_slots_;
+  PointOnLinks contact_points_;
+  FeasibilityParameters p_;
+  int up_axis_;
+
+  // Joint-id indexed limits, thresholds included; unused slots unbounded.
+  Eigen::RowVectorXd lower_, upper_, max_velocity_, max_torque_;
+
+  BatchInverseDynamics inverse_dynamics_;
+  BatchForwardKinematics forward_kinematics_;
+  PoseBatch poses_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CalibratedJointMeasurementFactor.h
+ * @brief Joint measurement with an unknown angle offset and link transform.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Joint.h"
+#include "gtdynamics/universal_robot/Link.h"
+
+namespace gtdynamics {
+
+/**
+ * CalibratedJointMeasurementFactor is a JointMeasurementFactor whose joint
+ * model is corrected by calibration variables: an offset d added to the
+ * measured joint angle and, optionally, a twist xi that corrects the
+ * transform of the child link,
+ *
+ *   error = Logmap(wTc^-1 * wTp * pTc(q + d) * Exp(xi)).
+ *
+ * With d = 0 and xi = 0 it is a JointMeasurementFactor.
+ */
+class CalibratedJointMeasurementFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = CalibratedJointMeasurementFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  JointConstSharedPtr joint_;
+  double measured_joint_coordinate_;
+
+  static gtsam::KeyVector Keys(gtsam::Key wTp_key, gtsam::Key wTc_key,
+                               gtsam::Key offset_key,
+                               const boost::optional<gtsam::Key> &xi_key) {
+    gtsam::KeyVector keys{wTp_key, wTc_key, offset_key};
+    if (xi_key) keys.push_back(*xi_key);
+    return keys;
+  }
+
+ public:
+  /**
+   * Constructor
+   *
+   * @param wTp_key Key to the parent link pose.
+   * @param wTc_key Key to the child link pose.
+   * @param offset_key Key to the joint angle offset, a double.
+   * @param correction_key Key to the child transform correction, a Vector6,
+   *                       or none to leave the transform as modeled.
+   * @param model The noise model for this factor.
+   * @param joint The joint connecting the links.
+   * @param joint_coordinate The measured joint coordinate.
+   */
+  CalibratedJointMeasurementFactor(
+      gtsam::Key wTp_key, gtsam::Key wTc_key, gtsam::Key offset_key,
+      const boost::optional<gtsam::Key> &correction_key,
+      const gtsam::SharedNoiseModel &model, const JointConstSharedPtr &joint,
+      double joint_coordinate)
+      : Base(model, Keys(wTp_key, wTc_key, offset_key, correction_key)),
+        joint_(joint),
+        measured_joint_coordinate_(joint_coordinate) {}
+
+  /// Whether the child transform is corrected.
+  bool correctsTransform() const { return size() == 4; }
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    const gtsam::Pose3 &wTp = x.at<gtsam::Pose3>(keys_[0]);
+    const gtsam::Pose3 &wTc = x.at<gtsam::Pose3>(keys_[1]);
+    const double q = measured_joint_coordinate_ + x.at<double>(keys_[2]);
+
+    gtsam::Matrix61 T_H_q;
+    gtsam::Matrix6 wTj_H_wTp, wTj_H_T, hat_H_wTj, hat_H_E, E_H_xi;
+    const gtsam::Pose3 pTc = joint_->parentTchild(q, H ? &T_H_q : nullptr);
+    gtsam::Pose3 wTc_hat =
+        wTp.compose(pTc, H ? &wTj_H_wTp : nullptr, H ? &wTj_H_T : nullptr);
+    if (correctsTransform()) {
+      const gtsam::Vector6 xi = x.at<gtsam::Vector6>(keys_[3]);
+      const gtsam::Pose3 E =
+          gtsam::Pose3::Expmap(xi, H ? &E_H_xi : nullptr);
+      wTc_hat = wTc_hat.compose(E, H ? &hat_H_wTj : nullptr,
+                                H ? &hat_H_E : nullptr);
+    } else {
+      hat_H_wTj.setIdentity();
+    }
+
+    gtsam::Matrix6 H_wTc, H_hat;
+    const gtsam::Vector6 error = wTc.logmap(wTc_hat, H ? &H_wTc : nullptr,
+                                            H ? &H_hat : nullptr);
+    if (H) {
+      H->resize(size());
+      const gtsam::Matrix6 H_wTj = H_hat * hat_H_wTj;
+      (*H)[0] = H_wTj * wTj_H_wTp;
+      (*H)[1] = H_wTc;
+      (*H)[2] = H_wTj * wTj_H_T * T_H_q;
+      if (correctsTransform()) (*H)[3] = H_hat * hat_H_E * E_H_xi;
+    }
+    return error;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "CalibratedJointMeasurementFactor("
+              << keyFormatter(keys_[0]) << "," << keyFormatter(keys_[1])
+              << ")\n";
+    gtsam::traits<double>::Print(measured_joint_coordinate_, "  measured: ");
+    this->noiseModel_->print("  noise model: ");
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalFactors.cpp
+ * @brief Factors of centroidal-momentum planning.
+ */
+
+#include "gtdynamics/factors/CentroidalFactors.h"
+
+#include <gtsam/geometry/Pose3.h>
+
+#include <iostream>
+#include <stdexcept>
+
+using gtsam::I_3x3;
+using gtsam::Matrix;
+using gtsam::Matrix3;
+using gtsam::Point3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CentroidalDynamicsFactor::CentroidalDynamicsFactor(
+    const gtsam::KeyVector &state_keys, const gtsam::KeyVector &force_keys,
+    const std::vector<Point3> &footholds, double mass, const Vector3 &gravity,
+    double dt, const gtsam::SharedNoiseModel &cost_model)
+    : Base(cost_model, state_keys),
+      footholds_(footholds),
+      mass_(mass),
+      gravity_(gravity),
+      dt_(dt) {
+  if (state_keys.size() != 6)
+    throw std::invalid_argument(
+        "CentroidalDynamicsFactor: needs the keys of c, v, h at two steps.");
+  if (force_keys.size() != footholds.size())
+    throw std::invalid_argument(
+        "CentroidalDynamicsFactor: needs one foothold per force.");
+  if (mass <= 0)
+    throw std::invalid_argument(
+        "CentroidalDynamicsFactor: the mass should be positive.");
+  keys_.insert(keys_.end(), force_keys.begin(), force_keys.end());
+}
+
+/* ************************************************************************* */
+Vector CentroidalDynamicsFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const Vector3 c0 = x.at<Vector3>(keys_[0]), v0 = x.at<Vector3>(keys_[1]),
+                h0 = x.at<Vector3>(keys_[2]), c1 = x.at<Vector3>(keys_[3]),
+                v1 = x.at<Vector3>(keys_[4]), h1 = x.at<Vector3>(keys_[5]);
+
+  const size_t m = footholds_.size();
+  Vector3 force = Vector3::Zero(), moment = Vector3::Zero();
+  Matrix3 force_cross = Matrix3::Zero();  // sum of [f_i]x
+  std::vector<Vector3> forces(m);
+  for (size_t i = 0; i < m; ++i) {
+    forces[i] = x.at<Vector3>(keys_[6 + i]);
+    force += forces[i];
+    moment += (footholds_[i] - c0).cross(forces[i]);
+    if (H) force_cross += gtsam::skewSymmetric(forces[i]);
+  }
+
+  Vector error(9);
+  error << c1 - c0 - dt_ * v1,                  //
+      v1 - v0 - dt_ * (force / mass_ + gravity_),  //
+      h1 - h0 - dt_ * moment;
+
+  if (H) {
+    H->resize(size());
+    for (auto &&Hi : *H) Hi = Matrix::Zero(9, 3);
+    (*H)[0].topRows<3>() = -I_3x3;
+    (*H)[0].bottomRows<3>() = -dt_ * force_cross;
+    (*H)[1].middleRows<3>(3) = -I_3x3;
+    (*H)[2].bottomRows<3>() = -I_3x3;
+    (*H)[3].topRows<3>() = I_3x3;
+    (*H)[4].topRows<3>() = -dt_ * I_3x3;
+    (*H)[4].middleRows<3>(3) = I_3x3;
+    (*H)[5].bottomRows<3>() = I_3x3;
+    for (size_t i = 0; i < m; ++i) {
+      (*H)[6 + i].middleRows<3>(3) = (-dt_ / mass_) * I_3x3;
+      (*H)[6 + i].bottomRows<3>() =
+          -dt_ * gtsam::skewSymmetric(footholds_[i] - c0);
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void CentroidalDynamicsFactor::print(
+    const std::string &s, const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Centroidal Dynamics Factor ("
+            << footholds_.size() << " contacts)" << std::endl;
+  Base::print("", keyFormatter);
+}
+
+/* ************************************************************************* */
+Vector ForceFrictionConeFactor::evaluateError(
+    const Vector3 &f, boost::optional<Matrix &> H) const {
+  const double normal_force = f.dot(normal_);
+  const Vector3 tangent = f - normal_force * normal_;
+  const double tangent_force = tangent.norm();
+  const double violation = tangent_force - mu_ * normal_force;
+  if (violation <= 0) {
+    if (H) *H = Matrix::Zero(1, 3);
+    return gtsam::Vector1(0);
+  }
+  if (H) {
+    *H = -mu_ * normal_.transpose();
+    // The tangent part is perpendicular to the normal.
+    if (tangent_force > 1e-12) *H += tangent.transpose() / tangent_force;
+  }
+  return gtsam::Vector1(violation);
+}
+
+/* ************************************************************************* */
+CenterOfMassFactor::CenterOfMassFactor(
+    const gtsam::KeyVector &pose_keys, const std::vector<double> &masses,
+    const Point3 &com, const gtsam::SharedNoiseModel &cost_model)
+    : Base(cost_model, pose_keys), com_(com) {
+  if (pose_keys.size() != masses.size())
+    throw std::invalid_argument(
+        "CenterOfMassFactor: needs one mass per pose.");
+  double total = 0;
+  for (const double mass : masses) total += mass;
+  if (total <= 0)
+    throw std::invalid_argument(
+        "CenterOfMassFactor: the total mass should be positive.");
+  for (const double mass : masses) weights_.push_back(mass / total);
+}
+
+/* ************************************************************************* */
+Vector CenterOfMassFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  Vector3 error = -com_;
+  if (H) H->resize(size());
+  for (size_t i = 0; i < size(); ++i) {
+    const gtsam::Pose3 &pose = x.at<gtsam::Pose3>(keys_[i]);
+    error += weights_[i] * pose.translation();
+    if (H) {
+      // The translation moves by R dt in the tangent space of Pose3.
+      (*H)[i] = Matrix::Zero(3, 6);
+      (*H)[i].rightCols<3>() = weights_[i] * pose.rotation().matrix();
+    }
+  }
+  return error;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CentroidalFactors.h
+ * @brief Factors of centroidal-momentum planning.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * CentroidalDynamicsFactor is one semi-implicit Euler step of the centroidal
+ * dynamics of a robot of mass m, pushed by point contact forces f_i at
+ * footholds p_i:
+ *
+ *   v' = v + dt * (sum_i f_i / m + g),                  c' = c + dt * v',
+ *   h' = h + dt * sum_i (p_i - c) x f_i,
+ *
+ * with c the center of mass, v its velocity and h the angular momentum about
+ * it, all in the world frame and stored as Vector3.
+ *
+ * Keys are c, v, h at step k, then c', v', h' at step k + 1, then the forces
+ * at step k. The error is the position, velocity and momentum defects.
+ */
+class CentroidalDynamicsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = CentroidalDynamicsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor
+   * @param state_keys  keys of c, v, h at step k and at step k + 1
+   * @param force_keys  keys of the contact forces at step k
+   * @param footholds   world position of each contact, in the same order
+   * @param mass        total mass of the robot
+   * @param gravity     gravity vector in the world frame
+   * @param dt          duration of the step
+   * @param cost_model  noise model of dimension 9
+   */
+  CentroidalDynamicsFactor(const gtsam::KeyVector &state_keys,
+                           const gtsam::KeyVector &force_keys,
+                           const std::vector<gtsam::Point3> &footholds,
+                           double mass, const gtsam::Vector3 &gravity,
+                           double dt,
+                           const gtsam::SharedNoiseModel &cost_model);
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  std::vector<gtsam::Point3> footholds_;
+  double mass_;
+  gtsam::Vector3 gravity_;
+  double dt_;
+};
+
+/**
+ * ForceFrictionConeFactor keeps a contact force, stored as a Vector3 in the
+ * world frame, in the friction cone about the normal n:
+ *
+ *   error = max(0, |f - (f.n) n| - mu (f.n)),
+ *
+ * which also penalizes pulling on the ground.
+ */
+class ForceFrictionConeFactor
+    : public gtsam::NoiseModelFactor1<gtsam::Vector3> {
+ private:
+  using This = ForceFrictionConeFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Vector3>;
+
+  double mu_;
+  gtsam::Vector3 normal_;
+
+ public:
+  /**
+   * Constructor
+   * @param force_key   key of the contact force
+   * @param cost_model  noise model of dimension 1
+   * @param mu          coefficient of static friction
+   * @param normal      contact normal, normalized here
+   */
+  ForceFrictionConeFactor(
+      gtsam::Key force_key, const gtsam::SharedNoiseModel &cost_model,
+      double mu, const gtsam::Vector3 &normal = gtsam::Vector3::UnitZ())
+      : Base(cost_model, force_key), mu_(mu), normal_(normal.normalized()) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &f,
+      boost::optional<gtsam::Matrix &> H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+/**
+ * CenterOfMassFactor ties the link poses of one time step to a center of
+ * mass: error = sum_i m_i t_i / M - c, with t_i the translation of the CoM
+ * pose of link i and M the sum of the masses.
+ */
+class CenterOfMassFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = CenterOfMassFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  std::vector<double> weights_;  // m_i / M
+  gtsam::Point3 com_;
+
+ public:
+  /**
+   * Constructor
+   * @param pose_keys   keys of the link CoM poses
+   * @param masses      masses of the links, in the same order
+   * @param com         the center of mass to track
+   * @param cost_model  noise model of dimension 3
+   */
+  CenterOfMassFactor(const gtsam::KeyVector &pose_keys,
+                     const std::vector<double> &masses,
+                     const gtsam::Point3 &com,
+                     const gtsam::SharedNoiseModel &cost_model);
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+};
+
+}  // namespace gtdynamics
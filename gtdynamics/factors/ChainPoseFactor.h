@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ChainPoseFactor.h
+ * @brief End-effector pose of a serial chain, on joint angles only.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/Chain.h"
+
+namespace gtdynamics {
+
+/**
+ * ChainPoseFactor constrains the end-effector pose of a chain, computed by
+ * product of exponentials from the joint angles, to a target pose:
+ *
+ *   error = Local(wTe_target, chain.poe(q) * fTe).
+ *
+ * The Jacobian is the end-effector Jacobian of Chain::poe, so no link pose
+ * variables are needed.
+ */
+class ChainPoseFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = ChainPoseFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  Chain chain_;
+  gtsam::Pose3 target_, fTe_;
+
+ public:
+  /**
+   * Constructor
+   * @param joint_angle_keys  angle keys of the chain joints, in chain order
+   * @param chain             the chain, with one screw axis per key
+   * @param target            target end-effector pose
+   * @param cost_model        6-dimensional cost model
+   * @param fTe               end-effector pose with respect to the last link
+   */
+  ChainPoseFactor(const std::vector<gtsam::Key> &joint_angle_keys,
+                  const Chain &chain, const gtsam::Pose3 &target,
+                  const gtsam::SharedNoiseModel &cost_model,
+                  const gtsam::Pose3 &fTe = gtsam::Pose3())
+      : Base(cost_model, joint_angle_keys),
+        chain_(chain),
+        target_(target),
+        fTe_(fTe) {
+    if (joint_angle_keys.size() != chain.length())
+      throw std::invalid_argument(
+          "ChainPoseFactor: needs one joint angle key per chain joint.");
+  }
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    gtsam::Vector q(size());
+    for (size_t k = 0; k < size(); ++k) q(k) = x.at<double>(keys_[k]);
+    gtsam::Pose3 fTe = fTe_;
+    gtsam::Matrix J;
+    gtsam::Matrix6 H_pose;
+    const gtsam::Pose3 wTe =
+        H ? chain_.poe(q, fTe, J) : chain_.poe(q, fTe);
+    const gtsam::Vector6 error =
+        target_.localCoordinates(wTe, boost::none, H ? &H_pose : nullptr);
+    if (H) {
+      H->resize(size());
+      for (size_t k = 0; k < size(); ++k) (*H)[k] = H_pose * J.col(k);
+    }
+    return error;
+  }
+
+  /// Target end-effector pose.
+  const gtsam::Pose3 &target() const { return target_; }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Chain Pose Factor ("
+              << size() << " joints)" << std::endl;
+    target_.print("  target: ");
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,144 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollocationBankFactor.cpp
+ * @brief Joint angle and velocity collocation of several joints over several
+ * time steps, in one factor.
+ */
+
+#include "gtdynamics/factors/CollocationBankFactor.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+// Sigma of a diagonal cost model of dimension 1.
+static double ScalarSigma(const gtsam::SharedNoiseModel &model,
+                          const std::string &name) {
+  const auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  if (!diagonal || diagonal->dim() != 1)
+    throw std::invalid_argument("CollocationBankFactor: " + name +
+                                " needs to be a diagonal noise model of "
+                                "dimension 1.");
+  return diagonal->sigma(0);
+}
+
+/* ************************************************************************* */
+CollocationBankFactor::CollocationBankFactor(
+    const std::vector<int> &joint_ids, int t, size_t num_steps, double dt,
+    const gtsam::SharedNoiseModel &q_cost_model,
+    const gtsam::SharedNoiseModel &v_cost_model,
+    CollocationScheme collocation)
+    : num_joints_(joint_ids.size()),
+      num_steps_(num_steps),
+      dt_(dt),
+      collocation_(collocation) {
+  if (collocation == CollocationScheme::RungeKutta)
+    throw std::runtime_error("runge-kutta not implemented yet");
+  if (joint_ids.empty() || num_steps == 0)
+    throw std::invalid_argument(
+        "CollocationBankFactor: needs at least one joint and one step.");
+
+  const size_t n = num_steps + 1;
+  keys_.reserve(3 * n * num_joints_);
+  for (const int j : joint_ids) {
+    for (size_t k = 0; k < n; k++)
+      keys_.push_back(internal::JointAngleKey(j, t + k));
+    for (size_t k = 0; k < n; k++)
+      keys_.push_back(internal::JointVelKey(j, t + k));
+    for (size_t k = 0; k < n; k++)
+      keys_.push_back(internal::JointAccelKey(j, t + k));
+  }
+
+  // Per joint, num_steps angle rows followed by num_steps velocity rows.
+  const double q_sigma = ScalarSigma(q_cost_model, "q_cost_model"),
+               v_sigma = ScalarSigma(v_cost_model, "v_cost_model");
+  Vector sigmas(2 * num_steps * num_joints_);
+  for (size_t b = 0; b < num_joints_; b++) {
+    sigmas.segment(2 * num_steps * b, num_steps).setConstant(q_sigma);
+    sigmas.segment(2 * num_steps * b + num_steps, num_steps)
+        .setConstant(v_sigma);
+  }
+  noiseModel_ = gtsam::noiseModel::Diagonal::Sigmas(sigmas, true);
+}
+
+/* ************************************************************************* */
+Vector CollocationBankFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t m = dim();
+  if (!this->active(x)) return Vector::Zero(m);
+
+  const size_t S = num_steps_, n = S + 1;
+  const bool euler = collocation_ == CollocationScheme::Euler;
+
+  // Coefficients of the derivative d and second derivative s of x in the
+  // residuals x_k + c0 * d_k + c1 * d_{k+1} + c2 * (s_k - s_{k+1}) - x_{k+1}.
+  // Hermite-Simpson has c2 != 0 for angles, and is trapezoidal otherwise.
+  const double c0 = euler ? dt_ : 0.5 * dt_, c1 = euler ? 0.0 : 0.5 * dt_;
+  const double c2 = collocation_ == CollocationScheme::HermiteSimpson
+                        ? dt_ * dt_ / 12
+                        : 0.0;
+
+  Vector error(m);
+  Vector q(n), v(n), a(n);
+  for (size_t b = 0; b < num_joints_; b++) {
+    const size_t key = 3 * n * b, row = 2 * S * b;
+    for (size_t k = 0; k < n; k++) {
+      q(k) = x.at<double>(keys_[key + k]);
+      v(k) = x.at<double>(keys_[key + n + k]);
+      a(k) = x.at<double>(keys_[key + 2 * n + k]);
+    }
+    error.segment(row, S) = q.head(S) + c0 * v.head(S) + c1 * v.tail(S) +
+                            c2 * (a.head(S) - a.tail(S)) - q.tail(S);
+    error.segment(row + S, S) =
+        v.head(S) + c0 * a.head(S) + c1 * a.tail(S) - v.tail(S);
+  }
+
+  if (H) {
+    H->resize(size());
+    for (auto &&Hk : *H) Hk = Matrix::Zero(m, 1);
+
+    // Variable k enters residual k with `head` and residual k - 1 with
+    // `tail`, in the block of S rows starting at `row`.
+    const auto fill = [S](Matrix *Hk, size_t row, size_t k, double head,
+                          double tail) {
+      if (k < S) (*Hk)(row + k, 0) += head;
+      if (k > 0) (*Hk)(row + k - 1, 0) += tail;
+    };
+    for (size_t b = 0; b < num_joints_; b++) {
+      const size_t key = 3 * n * b, row = 2 * S * b;
+      for (size_t k = 0; k < n; k++) {
+        fill(&(*H)[key + k], row, k, 1.0, -1.0);
+        fill(&(*H)[key + n + k], row, k, c0, c1);
+        fill(&(*H)[key + n + k], row + S, k, 1.0, -1.0);
+        fill(&(*H)[key + 2 * n + k], row + S, k, c0, c1);
+        if (c2 != 0) fill(&(*H)[key + 2 * n + k], row, k, c2, -c2);
+      }
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void CollocationBankFactor::print(
+    const std::string &s, const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Collocation Bank Factor ("
+            << num_joints_ << " joints, " << num_steps_ << " steps)"
+            << std::endl;
+  Base::print("", keyFormatter);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollocationBankFactor.h
+ * @brief Joint angle and velocity collocation of several joints over several
+ * time steps, in one factor.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+
+namespace gtdynamics {
+
+/**
+ * CollocationBankFactor stacks the residuals that
+ * DynamicsGraph::jointCollocationFactors adds as two factors per joint and
+ * time step, for the given joints and the steps t, ..., t + num_steps - 1:
+ *  - angle collocation, q_{k+1} = q_k + dt * v_k (Euler) or
+ *    q_{k+1} = q_k + dt/2 * (v_k + v_{k+1}) (Trapezoidal);
+ *  - velocity collocation, the same with v and a.
+ * HermiteSimpson is as in DynamicsGraph::jointCollocationFactors.
+ * The residuals are computed in one loop over contiguous vectors of the
+ * angles, velocities and accelerations, and the noise model is diagonal in
+ * the angle and velocity collocation sigmas, so the error equals the sum of
+ * the errors of the separate factors.
+ *
+ * All variables of a bank are eliminated together, so banks should be kept
+ * short in time: a joint over a handful of steps removes most of the
+ * per-factor overhead without densifying the elimination.
+ */
+class CollocationBankFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = CollocationBankFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor
+   * @param joint_ids    ids of the joints
+   * @param t            first time step
+   * @param num_steps    number of collocation steps, at least one
+   * @param dt           duration of each time step
+   * @param q_cost_model angle collocation cost model, diagonal of dimension 1
+   * @param v_cost_model velocity collocation cost model, the same
+   * @param collocation  Euler, Trapezoidal or HermiteSimpson
+   */
+  CollocationBankFactor(const std::vector<int> &joint_ids, int t,
+                        size_t num_steps, double dt,
+                        const gtsam::SharedNoiseModel &q_cost_model,
+                        const gtsam::SharedNoiseModel &v_cost_model,
+                        CollocationScheme collocation = Trapezoidal);
+
+  /// Number of joints.
+  size_t numJoints() const { return num_joints_; }
+
+  /// Number of collocation steps.
+  size_t numSteps() const { return num_steps_; }
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  // Keys are ordered by joint, then q, v and a, then time step, so the keys
+  // of joint b start at b * 3 * (num_steps_ + 1).
+  size_t num_joints_, num_steps_;
+  double dt_;
+  CollocationScheme collocation_;
+};
+
+}  // namespace gtdynamics
@@ -7,7 +7,7 @@
 
 /**
  * @file  CollocationFactors.h
- * @brief collocation factor on link poses and twists.
+ * @brief collocation factor on link poses, twists and scalars.
  * @author Yetong Zhang
  */
 
@@ -18,8 +18,10 @@
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
 
 #include <string>
+#include <vector>
 
 namespace gtdynamics {
 
@@ -30,7 +32,7 @@ namespace gtdynamics {
  *
  * @return pose_t1 link pose at next time step
  */
-gtsam::Pose3 predictPose(
+inline gtsam::Pose3 predictPose(
     const gtsam::Pose3 &pose_t0, const gtsam::Vector6 &twistdt,
     gtsam::OptionalJacobian<6, 6> H_pose_t0 = boost::none,
     gtsam::OptionalJacobian<6, 6> H_twistdt = boost::none) {
@@ -362,4 +364,202 @@ class TrapezoidalTwistCollocationFactor
   }
 };
 
+/**
+ * EulerDoubleCollocationFactor is a four-way nonlinear factor x1 = x0 + dt * v0
+ * on scalars, e.g. joint angles and velocities, with the time step dt a
+ * variable, as in multi-phase trajectories.
+ */
+class EulerDoubleCollocationFactor
+    : public gtsam::NoiseModelFactor4<double, double, double, double> {
+ private:
+  using This = EulerDoubleCollocationFactor;
+  using Base = gtsam::NoiseModelFactor4<double, double, double, double>;
+
+ public:
+  EulerDoubleCollocationFactor(
+      gtsam::Key x0_key, gtsam::Key x1_key, gtsam::Key v0_key,
+      gtsam::Key dt_key, const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model, x0_key, x1_key, v0_key, dt_key) {}
+
+  virtual ~EulerDoubleCollocationFactor() {}
+
+  /**
+   * Evaluate collocation error
+   *
+   * @param x0 value of current step
+   * @param x1 value of next step
+   * @param v0 derivative of current step
+   * @param dt duration of time step
+   */
+  gtsam::Vector evaluateError(
+      const double &x0, const double &x1, const double &v0, const double &dt,
+      boost::optional<gtsam::Matrix &> H_x0 = boost::none,
+      boost::optional<gtsam::Matrix &> H_x1 = boost::none,
+      boost::optional<gtsam::Matrix &> H_v0 = boost::none,
+      boost::optional<gtsam::Matrix &> H_dt = boost::none) const override {
+    if (H_x0) *H_x0 = gtsam::I_1x1;
+    if (H_x1) *H_x1 = -gtsam::I_1x1;
+    if (H_v0) *H_v0 = gtsam::I_1x1 * dt;
+    if (H_dt) *H_dt = gtsam::I_1x1 * v0;
+    return gtsam::Vector1(x0 + dt * v0 - x1);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Euler double collocation factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE const &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor4", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+/**
+ * TrapezoidalDoubleCollocationFactor is a five-way nonlinear factor
+ * x1 = x0 + dt / 2 * (v0 + v1) on scalars, with the time step dt a variable.
+ */
+class TrapezoidalDoubleCollocationFactor
+    : public gtsam::NoiseModelFactor5<double, double, double, double, double> {
+ private:
+  using This = TrapezoidalDoubleCollocationFactor;
+  using Base =
+      gtsam::NoiseModelFactor5<double, double, double, double, double>;
+
+ public:
+  TrapezoidalDoubleCollocationFactor(
+      gtsam::Key x0_key, gtsam::Key x1_key, gtsam::Key v0_key,
+      gtsam::Key v1_key, gtsam::Key dt_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model, x0_key, x1_key, v0_key, v1_key, dt_key) {}
+
+  virtual ~TrapezoidalDoubleCollocationFactor() {}
+
+  /**
+   * Evaluate collocation error
+   *
+   * @param x0 value of current step
+   * @param x1 value of next step
+   * @param v0 derivative of current step
+   * @param v1 derivative of next step
+   * @param dt duration of time step
+   */
+  gtsam::Vector evaluateError(
+      const double &x0, const double &x1, const double &v0, const double &v1,
+      const double &dt, boost::optional<gtsam::Matrix &> H_x0 = boost::none,
+      boost::optional<gtsam::Matrix &> H_x1 = boost::none,
+      boost::optional<gtsam::Matrix &> H_v0 = boost::none,
+      boost::optional<gtsam::Matrix &> H_v1 = boost::none,
+      boost::optional<gtsam::Matrix &> H_dt = boost::none) const override {
+    if (H_x0) *H_x0 = gtsam::I_1x1;
+    if (H_x1) *H_x1 = -gtsam::I_1x1;
+    if (H_v0) *H_v0 = gtsam::I_1x1 * (0.5 * dt);
+    if (H_v1) *H_v1 = gtsam::I_1x1 * (0.5 * dt);
+    if (H_dt) *H_dt = gtsam::I_1x1 * (0.5 * (v0 + v1));
+    return gtsam::Vector1(x0 + 0.5 * dt * (v0 + v1) - x1);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "trapezoidal double collocation factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE const &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor5", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+/**
+ * HermiteSimpsonDoubleCollocationFactor is a seven-way nonlinear factor
+ * x1 = x0 + dt / 2 * (v0 + v1) + dt^2 / 12 * (a0 - a1) on scalars with first
+ * and second derivatives v and a, and the time step dt a variable. It is
+ * Hermite-Simpson collocation of x with the midpoint of v eliminated, and
+ * exact for x cubic in time.
+ */
+class HermiteSimpsonDoubleCollocationFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = HermiteSimpsonDoubleCollocationFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  HermiteSimpsonDoubleCollocationFactor(
+      gtsam::Key x0_key, gtsam::Key x1_key, gtsam::Key v0_key,
+      gtsam::Key v1_key, gtsam::Key a0_key, gtsam::Key a1_key,
+      gtsam::Key dt_key, const gtsam::noiseModel::Base::shared_ptr &cost_model)
+      : Base(cost_model, gtsam::KeyVector{x0_key, x1_key, v0_key, v1_key,
+                                          a0_key, a1_key, dt_key}) {}
+
+  virtual ~HermiteSimpsonDoubleCollocationFactor() {}
+
+  /// Evaluate collocation error, for keys x0, x1, v0, v1, a0, a1 and dt.
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    double value[7];
+    for (size_t k = 0; k < 7; k++) value[k] = x.at<double>(keys_[k]);
+    const double x0 = value[0], x1 = value[1], v0 = value[2], v1 = value[3],
+                 a0 = value[4], a1 = value[5], dt = value[6];
+    if (H) {
+      const double derivatives[7] = {
+          1, -1, 0.5 * dt, 0.5 * dt, dt * dt / 12, -dt * dt / 12,
+          0.5 * (v0 + v1) + dt / 6 * (a0 - a1)};
+      H->resize(7);
+      for (size_t k = 0; k < 7; k++) (*H)[k] = gtsam::I_1x1 * derivatives[k];
+    }
+    return gtsam::Vector1(x0 + 0.5 * dt * (v0 + v1) +
+                          dt * dt / 12 * (a0 - a1) - x1);
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Hermite-Simpson double collocation factor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE const &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+};
+
 }  // namespace gtdynamics
@@ -0,0 +1,184 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactComplementarityFactor.h
+ * @brief Complementarity between contact height and normal contact force.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Ways to turn the complementarity 0 <= phi _|_ lambda >= 0 of contact height
+ * phi and normal force lambda into a smooth error.
+ */
+enum ComplementarityScheme {
+  /// Hinges on phi >= 0, lambda >= 0 and phi lambda <= eps, a 3-vector error.
+  RelaxedComplementarity,
+  /// Smoothed Fischer-Burmeister phi + lambda - sqrt(phi^2 + lambda^2 + 2 eps).
+  SmoothedComplementarity
+};
+
+/// Parameters of the contact complementarity of contact-implicit dynamics.
+struct ComplementarityParams {
+  ComplementarityScheme scheme = SmoothedComplementarity;
+  double epsilon = 1e-4;       ///< relaxation, 0 for exact complementarity
+  double force_scale = 100.0;  ///< force in N that weighs like 1 m of height
+  double sigma = 1e-3;         ///< standard deviation of the error
+  double ground_height = 0.0;  ///< height of the ground plane
+
+  /// Noise model of ContactComplementarityFactor for this scheme.
+  gtsam::SharedNoiseModel model() const {
+    return gtsam::noiseModel::Isotropic::Sigma(
+        scheme == RelaxedComplementarity ? 3 : 1, sigma);
+  }
+};
+
+/**
+ * ContactComplementarityFactor lets the optimizer choose whether a contact
+ * point touches the ground: either the height phi of the contact point above a
+ * flat ground is zero, or the normal contact force lambda is, and both are
+ * non-negative. With eps > 0 the condition phi lambda = 0 is relaxed to
+ * phi lambda <= eps or smoothed to phi lambda = eps, so that solving with
+ * decreasing eps finds the contact timing from a smooth problem.
+ *
+ * lambda is the linear part of the contact wrench, in the link CoM frame,
+ * rotated into the spatial frame and projected on the up direction -gravity,
+ * divided by force_scale.
+ */
+class ContactComplementarityFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6> {
+ private:
+  using This = ContactComplementarityFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Vector6>;
+
+  gtsam::Point3 comPc_;  // The contact point in the link's COM frame.
+  gtsam::Vector3 up_;    // Unit up vector in the spatial frame.
+  ComplementarityParams params_;
+
+ public:
+  /**
+   * Constructor
+   *
+   * @param pose_key Key of the link's CoM pose.
+   * @param contact_wrench_key Key of the contact wrench on the link.
+   * @param comPc The contact point in the link's CoM frame.
+   * @param gravity Gravity vector in the spatial frame.
+   * @param params Scheme, relaxation, scaling and noise.
+   */
+  ContactComplementarityFactor(gtsam::Key pose_key,
+                               gtsam::Key contact_wrench_key,
+                               const gtsam::Point3 &comPc,
+                               const gtsam::Vector3 &gravity,
+                               const ComplementarityParams &params =
+                                   ComplementarityParams())
+      : Base(params.model(), pose_key, contact_wrench_key),
+        comPc_(comPc),
+        up_(-gravity.normalized()),
+        params_(params) {
+    if (params.epsilon < 0 || params.force_scale <= 0)
+      throw std::invalid_argument(
+          "ContactComplementarityFactor: epsilon should be non-negative and "
+          "force_scale positive.");
+  }
+
+  virtual ~ContactComplementarityFactor() {}
+
+  /**
+   * Evaluate the complementarity error.
+   * @param sTl This link's COM pose in the spatial frame.
+   * @param contact_wrench Contact wrench on this link.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &sTl, const gtsam::Vector6 &contact_wrench,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none,
+      boost::optional<gtsam::Matrix &> H_contact_wrench =
+          boost::none) const override {
+    // Height of the contact point.
+    gtsam::Matrix36 H_sTl;
+    const gtsam::Point3 sPc = sTl.transformFrom(comPc_, H_sTl);
+    const double phi = up_.dot(sPc) - params_.ground_height;
+    const gtsam::Matrix16 phi_H_pose = up_.transpose() * H_sTl;
+
+    // Scaled normal force, with the rotation of the force into the spatial
+    // frame acting on the rotation part of the pose.
+    const gtsam::Vector3 f_c = contact_wrench.tail<3>();
+    const gtsam::Rot3 &R = sTl.rotation();
+    const double lambda = up_.dot(R * f_c) / params_.force_scale;
+    gtsam::Matrix16 lambda_H_pose = gtsam::Matrix16::Zero(),
+                    lambda_H_wrench = gtsam::Matrix16::Zero();
+    lambda_H_pose.head<3>() =
+        -up_.transpose() * R.matrix() * gtsam::skewSymmetric(f_c) /
+        params_.force_scale;
+    lambda_H_wrench.tail<3>() =
+        up_.transpose() * R.matrix() / params_.force_scale;
+
+    // Error and its derivatives with respect to phi and lambda.
+    gtsam::Vector error;
+    gtsam::Matrix d_phi, d_lambda;
+    if (params_.scheme == RelaxedComplementarity) {
+      const double product = phi * lambda - params_.epsilon;
+      error = gtsam::Vector3(std::min(phi, 0.0), std::min(lambda, 0.0),
+                             std::max(product, 0.0));
+      d_phi = gtsam::Vector3(phi < 0 ? 1.0 : 0.0, 0.0,
+                             product > 0 ? lambda : 0.0);
+      d_lambda = gtsam::Vector3(0.0, lambda < 0 ? 1.0 : 0.0,
+                                product > 0 ? phi : 0.0);
+    } else {
+      const double s =
+          std::sqrt(phi * phi + lambda * lambda + 2 * params_.epsilon);
+      error = gtsam::Vector1(phi + lambda - s);
+      // s is only zero at phi = lambda = epsilon = 0, where the error has a
+      // kink; any subgradient will do.
+      d_phi = gtsam::Vector1(s > 0 ? 1 - phi / s : 0);
+      d_lambda = gtsam::Vector1(s > 0 ? 1 - lambda / s : 0);
+    }
+
+    if (H_pose) *H_pose = d_phi * phi_H_pose + d_lambda * lambda_H_pose;
+    if (H_contact_wrench) *H_contact_wrench = d_lambda * lambda_H_wrench;
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "ContactComplementarityFactor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor2", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+}  // namespace gtdynamics
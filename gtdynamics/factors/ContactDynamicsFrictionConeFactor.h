@@ -39,15 +39,6 @@ class ContactDynamicsFrictionConeFactor
 
   int up_axis_;  // Which axis is up (assuming flat ground)? {0: x, 1: y, 2: z}.
   double mu_prime_;  // static friction coefficient squared.
-  const gtsam::Matrix36 H_wrench_ = (gtsam::Matrix(3, 6) << 0, 0, 0, 1, 0, 0, 0,
-                                     0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1)
-                                        .finished();
-  const gtsam::Matrix33 H_x_ =
-      (gtsam::Matrix(3, 3) << 1, 0, 0, 0, 0, 0, 0, 0, 0).finished();
-  const gtsam::Matrix33 H_y_ =
-      (gtsam::Matrix(3, 3) << 0, 0, 0, 0, 1, 0, 0, 0, 0).finished();
-  const gtsam::Matrix33 H_z_ =
-      (gtsam::Matrix(3, 3) << 0, 0, 0, 0, 0, 0, 0, 0, 1).finished();
 
  public:
   /**
@@ -82,64 +73,33 @@ class ContactDynamicsFrictionConeFactor
       boost::optional<gtsam::Matrix &> H_pose = boost::none,
       boost::optional<gtsam::Matrix &> H_contact_wrench =
           boost::none) const override {
-    // Linear component of the contact wrench.
-    gtsam::Vector3 f_c = H_wrench_ * contact_wrench;
-
-    // Rotate linear contact wrench force into the spatial frame.
-    gtsam::Matrix36 H_p;
-    gtsam::Vector3 f_s = pose.rotation(H_p) * f_c;
-
-    // Compute the squared force values.
-    gtsam::Matrix A = f_s.transpose() * H_x_;
-    gtsam::Matrix B = f_s.transpose() * H_y_;
-    gtsam::Matrix C = f_s.transpose() * H_z_;
-
-    if (up_axis_ == 0)
-      A *= -mu_prime_;
-    else if (up_axis_ == 1)
-      B *= -mu_prime_;
-    else
-      C *= -mu_prime_;
-
-    // a = f_x^2, b = f_z^2, c = f_z^2.
-    gtsam::Matrix a = A * f_s;
-    gtsam::Matrix b = B * f_s;
-    gtsam::Matrix c = C * f_s;
-
-    gtsam::Matrix resultant = a + b + c;
-    gtsam::Vector error;
-
-    // Ramp function.
-    if (resultant(0, 0) > 0)
-      error = resultant;
-    else
-      error = (gtsam::Vector(1) << 0).finished();
-
-    // Compute the gradients based on whether or not the inequality constraint
-    // is active.
-    gtsam::Matrix H_f_s = (2 * A + 2 * B + 2 * C);
+    // Linear contact force, rotated into the spatial frame.
+    const gtsam::Vector3 f_c = contact_wrench.tail<3>();
+    const gtsam::Matrix3 R = pose.rotation().matrix();
+    const gtsam::Vector3 f_s = R * f_c;
+
+    // r = |f_tangent|^2 - mu^2 f_up^2, positive outside the cone.
+    gtsam::Vector3 weights(1, 1, 1);
+    weights(up_axis_) = -mu_prime_;
+    const gtsam::Vector3 w_f_s = weights.cwiseProduct(f_s);
+    const double resultant = f_s.dot(w_f_s);
+
+    // Ramp function, with zero gradients when the constraint is inactive.
+    const bool active = resultant > 0;
     if (H_contact_wrench) {
-      if (resultant(0, 0) > 0) {  // Active.
-        gtsam::Matrix H_f_c = H_f_s * pose.rotation().matrix();
-        *H_contact_wrench = H_f_c * H_wrench_;
-      } else {  // Inactive.
-        *H_contact_wrench =
-            (gtsam::Matrix(1, 6) << 0, 0, 0, 0, 0, 0).finished();
-      }
+      gtsam::Matrix16 H = gtsam::Matrix16::Zero();
+      if (active) H.rightCols<3>() = 2 * w_f_s.transpose() * R;
+      *H_contact_wrench = H;
     }
-
     if (H_pose) {
-      if (resultant(0, 0) > 0) {  // Active.
-        gtsam::Matrix33 H_r = pose.rotation().matrix() *
-                              gtsam::skewSymmetric(-f_c(0), -f_c(1), -f_c(2));
-        gtsam::Matrix H_rot = gtsam::Matrix(H_f_s * H_r);
-        *H_pose = H_rot * H_p;
-      } else {  // Inactive.
-        *H_pose = (gtsam::Matrix(1, 6) << 0, 0, 0, 0, 0, 0).finished();
-      }
+      // d(R f_c) / d(rotation) = -R [f_c]x, and no dependence on position.
+      gtsam::Matrix16 H = gtsam::Matrix16::Zero();
+      if (active)
+        H.leftCols<3>() =
+            -2 * w_f_s.transpose() * R * gtsam::skewSymmetric(f_c);
+      *H_pose = H;
     }
-
-    return error;
+    return gtsam::Vector1(active ? resultant : 0.0);
   }
 
   //// @return a deep copy of this factor
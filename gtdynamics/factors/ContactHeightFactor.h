@@ -18,14 +18,20 @@
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
+#include <boost/shared_ptr.hpp>
 #include <string>
 
+#include "gtdynamics/utils/Terrain.h"
+
 namespace gtdynamics {
 
 /**
  * ContactHeightFactor is a one-way nonlinear factor which enforces a
  * known ground plane height for the contact point. This factor assumes that the
- * ground is flat and level.
+ * ground is flat and level, unless it is given a TerrainModel: then the
+ * contact point is held on the terrain height at its x-y position, with the
+ * terrain's gradient in the Jacobian, so one factor per contact covers
+ * arbitrary terrain.
  */
 class ContactHeightFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
  private:
@@ -37,6 +43,8 @@ class ContactHeightFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
 
   gtsam::Matrix13 gravity_s_unit_;  // Gravity unit vector in the spatial frame.
 
+  boost::shared_ptr<const TerrainModel> terrain_;  // Null for flat ground.
+
  public:
   /**
    * Factor for link end to remain in contact with the
@@ -59,6 +67,24 @@ class ContactHeightFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
     h_ = gtsam::Vector1(ground_plane_height);
   }
 
+  /**
+   * Factor for link end to remain in contact with terrain, z up.
+   *
+   * @param pose_key The key corresponding to the link's CoM pose.
+   * @param cost_model Noise model associated with this factor.
+   * @param comPc Static transform from point of contact to link CoM.
+   * @param terrain Height of the terrain at each x-y position.
+   */
+  ContactHeightFactor(gtsam::Key pose_key,
+                      const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                      const gtsam::Point3 &comPc,
+                      const boost::shared_ptr<const TerrainModel> &terrain)
+      : Base(cost_model, pose_key),
+        comPc_(comPc),
+        h_(gtsam::Vector1::Zero()),
+        gravity_s_unit_(0, 0, 1),
+        terrain_(terrain) {}
+
   virtual ~ContactHeightFactor() {}
 
   /**
@@ -72,6 +98,17 @@ class ContactHeightFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
     gtsam::Matrix36 H_sTl;
     gtsam::Point3 sPc = sTl.transformFrom(comPc_, H_sTl);
 
+    // Height above the terrain.
+    if (terrain_) {
+      gtsam::Matrix12 H_xy;
+      const double h = terrain_->height(sPc.x(), sPc.y(), H_xy);
+      if (H_pose) {
+        const gtsam::Matrix13 H_sPc(-H_xy(0), -H_xy(1), 1);
+        *H_pose = H_sPc * H_sTl;
+      }
+      return gtsam::Vector1(sPc.z() - h);
+    }
+
     // Compute the error.
     gtsam::Vector sPc_h = gtsam::Vector1(gravity_s_unit_.dot(sPc));
     gtsam::Vector error = sPc_h - h_;
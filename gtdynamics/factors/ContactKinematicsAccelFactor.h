@@ -38,6 +38,7 @@ class ContactKinematicsAccelFactor
   using Base = gtsam::NoiseModelFactor1<gtsam::Vector6>;
 
   gtsam::Pose3 cTcom_;
+  gtsam::Matrix36 H_;  // Linear rows of the adjoint map of cTcom.
 
  public:
   /**
@@ -50,7 +51,9 @@ class ContactKinematicsAccelFactor
       gtsam::Key accel_key,
       const gtsam::noiseModel::Base::shared_ptr &cost_model,
       const gtsam::Pose3 &cTcom)
-      : Base(cost_model, accel_key), cTcom_(cTcom) {}
+      : Base(cost_model, accel_key),
+        cTcom_(cTcom),
+        H_(cTcom.AdjointMap().bottomRows<3>()) {}
   virtual ~ContactKinematicsAccelFactor() {}
 
  public:
@@ -60,15 +63,9 @@ class ContactKinematicsAccelFactor
   gtsam::Vector evaluateError(
       const gtsam::Vector6 &accel,
       boost::optional<gtsam::Matrix &> H_accel = boost::none) const override {
-    gtsam::Matrix36 H_acc;
-    H_acc << 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1;
-
-    // Transform the twist from the link COM frame to the contact frame.
-    gtsam::Vector3 error = H_acc * cTcom_.AdjointMap() * accel;
-
-    if (H_accel) *H_accel = H_acc * cTcom_.AdjointMap();
-
-    return error;
+    // Transform the acceleration from the link COM frame to the contact frame.
+    if (H_accel) *H_accel = H_;
+    return gtsam::Vector3(H_ * accel);
   }
 
   //// @return a deep copy of this factor
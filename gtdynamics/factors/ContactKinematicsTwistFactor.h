@@ -38,6 +38,7 @@ class ContactKinematicsTwistFactor
   using Base = gtsam::NoiseModelFactor1<gtsam::Vector6>;
 
   gtsam::Pose3 cTcom_;
+  gtsam::Matrix36 H_;  // Linear rows of the adjoint map of cTcom.
 
  public:
   /**
@@ -50,7 +51,9 @@ class ContactKinematicsTwistFactor
       gtsam::Key twist_key,
       const gtsam::noiseModel::Base::shared_ptr &cost_model,
       const gtsam::Pose3 &cTcom)
-      : Base(cost_model, twist_key), cTcom_(cTcom) {}
+      : Base(cost_model, twist_key),
+        cTcom_(cTcom),
+        H_(cTcom.AdjointMap().bottomRows<3>()) {}
   virtual ~ContactKinematicsTwistFactor() {}
 
  public:
@@ -61,15 +64,9 @@ class ContactKinematicsTwistFactor
   gtsam::Vector evaluateError(
       const gtsam::Vector6 &twist,
       boost::optional<gtsam::Matrix &> H_twist = boost::none) const override {
-    gtsam::Matrix36 H_vel;
-    H_vel << 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1;
-
     // Transform the twist from the link COM frame to the contact frame.
-    gtsam::Vector3 error = H_vel * cTcom_.AdjointMap() * twist;
-
-    if (H_twist) *H_twist = H_vel * cTcom_.AdjointMap();
-
-    return error;
+    if (H_twist) *H_twist = H_;
+    return gtsam::Vector3(H_ * twist);
   }
 
   //// @return a deep copy of this factor
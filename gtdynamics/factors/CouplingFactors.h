@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CouplingFactors.h
+ * @brief Factors coupling the links of different robot instances in one graph.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <boost/make_shared.hpp>
+#include <iostream>
+#include <string>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/PointOnLink.h"
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+/// Pose key of link i of robot instance `robot` at step t.
+inline gtsam::Key RobotPoseKey(size_t robot, int i, uint64_t t) {
+  return internal::PoseKey(i, int(DynamicsSymbol::RobotTime(robot, t)));
+}
+
+/**
+ * PointCouplingFactor ties a point on a link of one robot to a point on a link
+ * of another, e.g. the two grippers of a bimanual grasp or the anchor of a
+ * cable shared by two robots: the error is the difference of the two points
+ * in the world frame.
+ */
+class PointCouplingFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3> {
+ private:
+  using This = PointCouplingFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Pose3, gtsam::Pose3>;
+
+  gtsam::Point3 point_a_, point_b_;
+
+ public:
+  /**
+   * Constructor from keys.
+   * @param pose_key_a  COM pose of the first link
+   * @param point_a     point on the first link, in its COM frame
+   * @param pose_key_b  COM pose of the second link
+   * @param point_b     point on the second link, in its COM frame
+   * @param model       noise model, of dimension 3
+   */
+  PointCouplingFactor(gtsam::Key pose_key_a, const gtsam::Point3 &point_a,
+                      gtsam::Key pose_key_b, const gtsam::Point3 &point_b,
+                      const gtsam::SharedNoiseModel &model)
+      : Base(model, pose_key_a, pose_key_b),
+        point_a_(point_a),
+        point_b_(point_b) {}
+
+  /**
+   * Constructor from points on the links of two robot instances.
+   * @param robot_a  instance of the first robot
+   * @param a        point on a link of the first robot
+   * @param robot_b  instance of the second robot
+   * @param b        point on a link of the second robot
+   * @param model    noise model, of dimension 3
+   * @param t        time step
+   */
+  PointCouplingFactor(size_t robot_a, const PointOnLink &a, size_t robot_b,
+                      const PointOnLink &b,
+                      const gtsam::SharedNoiseModel &model, uint64_t t = 0)
+      : PointCouplingFactor(RobotPoseKey(robot_a, a.link->id(), t), a.point,
+                            RobotPoseKey(robot_b, b.link->id(), t), b.point,
+                            model) {}
+
+  virtual ~PointCouplingFactor() {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTa, const gtsam::Pose3 &wTb,
+      boost::optional<gtsam::Matrix &> H_a = boost::none,
+      boost::optional<gtsam::Matrix &> H_b = boost::none) const override {
+    gtsam::Matrix36 H_point_a, H_point_b;
+    const gtsam::Point3 p_a = wTa.transformFrom(point_a_, H_point_a);
+    const gtsam::Point3 p_b = wTb.transformFrom(point_b_, H_point_b);
+    if (H_a) *H_a = H_point_a;
+    if (H_b) *H_b = -H_point_b;
+    return p_a - p_b;
+  }
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "PointCouplingFactor("
+              << keyFormatter(this->key1()) << ","
+              << keyFormatter(this->key2()) << ")\n";
+    this->noiseModel_->print("  noise model: ");
+  }
+};
+
+/**
+ * Factor holding the pose of link i_b of robot instance robot_b fixed in the
+ * frame of link i_a of robot instance robot_a, e.g. for a rigid grasp.
+ * @param robot_a, i_a  robot instance and id of the first link
+ * @param robot_b, i_b  robot instance and id of the second link
+ * @param aTb    pose of the second link's COM in the first's
+ * @param model  noise model, of dimension 6
+ * @param t      time step
+ */
+inline gtsam::NonlinearFactor::shared_ptr PoseCouplingFactor(
+    size_t robot_a, int i_a, size_t robot_b, int i_b, const gtsam::Pose3 &aTb,
+    const gtsam::SharedNoiseModel &model, uint64_t t = 0) {
+  return boost::make_shared<gtsam::BetweenFactor<gtsam::Pose3>>(
+      RobotPoseKey(robot_a, i_a, t), RobotPoseKey(robot_b, i_b, t), aTb,
+      model);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FoldedFactor.cpp
+ * @brief Factors with some of their variables folded in as constants.
+ */
+
+#include "gtdynamics/factors/FoldedFactor.h"
+
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+FoldedFactor::FoldedFactor(const gtsam::NonlinearFactor::shared_ptr &factor,
+                           const gtsam::Values &constants)
+    : factor_(factor) {
+  for (const gtsam::Key key : factor->keys()) {
+    if (constants.exists(key))
+      constants_.insert(key, constants.at(key));
+    else
+      keys_.push_back(key);
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Values FoldedFactor::merged(const gtsam::Values &x) const {
+  gtsam::Values values = constants_;
+  for (const gtsam::Key key : keys_) values.insert(key, x.at(key));
+  return values;
+}
+
+/* ************************************************************************* */
+double FoldedFactor::error(const gtsam::Values &x) const {
+  return factor_->error(merged(x));
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> FoldedFactor::linearize(
+    const gtsam::Values &x) const {
+  const auto linear = factor_->linearize(merged(x));
+  if (!linear) return linear;
+  auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(linear);
+  if (!jacobian) {
+    const auto hessian =
+        boost::dynamic_pointer_cast<gtsam::HessianFactor>(linear);
+    if (!hessian)
+      throw std::runtime_error(
+          "FoldedFactor: only Jacobian and Hessian linearizations are "
+          "supported.");
+    jacobian = boost::make_shared<gtsam::JacobianFactor>(*hessian);
+  }
+
+  // The constants do not move, so their columns drop out.
+  std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms;
+  terms.reserve(keys_.size());
+  for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+    if (!constants_.exists(*it))
+      terms.emplace_back(*it, gtsam::Matrix(jacobian->getA(it)));
+  }
+  return boost::make_shared<gtsam::JacobianFactor>(
+      terms, gtsam::Vector(jacobian->getb()), jacobian->get_model());
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph FoldConstants(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &constants) {
+  gtsam::NonlinearFactorGraph folded;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    size_t num_known = 0;
+    for (const gtsam::Key key : factor->keys())
+      num_known += constants.exists(key);
+    if (num_known == 0)
+      folded.push_back(factor);
+    else if (num_known < factor->size())
+      folded.emplace_shared<FoldedFactor>(factor, constants);
+  }
+  return folded;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FoldedFactor.h
+ * @brief Factors with some of their variables folded in as constants.
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+namespace gtdynamics {
+
+/**
+ * FoldedFactor evaluates a factor with the values of some of its variables
+ * fixed, and depends on the remaining variables only. Its linearization is
+ * that of the wrapped factor without the columns of the constants, so the
+ * constants never enter elimination. This replaces a tight prior on a known
+ * variable, which keeps the variable in the linear system and makes it badly
+ * conditioned.
+ */
+class FoldedFactor : public gtsam::NonlinearFactor {
+ public:
+  using shared_ptr = boost::shared_ptr<FoldedFactor>;
+
+  /**
+   * Constructor
+   * @param factor     the factor to wrap
+   * @param constants  values of some of the keys of the factor; others are
+   *                   ignored
+   */
+  FoldedFactor(const gtsam::NonlinearFactor::shared_ptr &factor,
+               const gtsam::Values &constants);
+
+  /// The wrapped factor.
+  const gtsam::NonlinearFactor::shared_ptr &factor() const { return factor_; }
+
+  /// The values of the folded keys.
+  const gtsam::Values &constants() const { return constants_; }
+
+  size_t dim() const override { return factor_->dim(); }
+
+  double error(const gtsam::Values &x) const override;
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<FoldedFactor>(*this);
+  }
+
+ private:
+  gtsam::NonlinearFactor::shared_ptr factor_;
+  gtsam::Values constants_;
+
+  // The free values of x together with the constants, for factor_.
+  gtsam::Values merged(const gtsam::Values &x) const;
+};
+
+/**
+ * Fold known values into a graph: factors without known keys are kept as
+ * they are, factors with only known keys are dropped, since their error is
+ * constant, and the others are wrapped in a FoldedFactor. The known keys are
+ * hence no variables of the result; insert them into its solution if needed.
+ * @param graph      the graph, e.g. DynamicsGraph::dynamicsFactorGraph
+ * @param constants  the known values, e.g. from
+ *                   DynamicsGraph::forwardDynamicsConstants
+ */
+gtsam::NonlinearFactorGraph FoldConstants(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &constants);
+
+}  // namespace gtdynamics
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GaussianProcessPriorFactor.h
+ * @brief Gaussian process prior between the states of a joint at two knots.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/utils/utils.h"
+
+namespace gtdynamics {
+
+/**
+ * GaussianProcessPriorFactor is the prior of a white-noise-on-jerk Gaussian
+ * process, i.e. a constant acceleration model, on the angle, velocity and
+ * acceleration of a joint at two knots dt apart: the state at the second knot
+ * is the state at the first propagated by calcPhi(dt), with covariance
+ * calcQ(Qc, dt) for the power spectral density Qc of the jerk.
+ */
+class GaussianProcessPriorFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = GaussianProcessPriorFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+  double dt_;
+
+ public:
+  /**
+   * Constructor
+   * @param q0_key, v0_key, a0_key  joint state at the first knot
+   * @param q1_key, v1_key, a1_key  joint state at the second knot
+   * @param dt                      time between the knots
+   * @param Qc_model                one-dimensional noise model of the jerk,
+   *                                of covariance Qc, see getQc
+   */
+  GaussianProcessPriorFactor(gtsam::Key q0_key, gtsam::Key v0_key,
+                             gtsam::Key a0_key, gtsam::Key q1_key,
+                             gtsam::Key v1_key, gtsam::Key a1_key, double dt,
+                             const gtsam::SharedNoiseModel &Qc_model)
+      : Base(gtsam::noiseModel::Gaussian::Covariance(
+                 calcQ(getQc(Qc_model), dt)),
+             gtsam::KeyVector{q0_key, v0_key, a0_key, q1_key, v1_key,
+                              a1_key}),
+        dt_(dt) {}
+
+  virtual ~GaussianProcessPriorFactor() {}
+
+  /// Time between the knots.
+  double dt() const { return dt_; }
+
+  /// Evaluate the prior error, for keys q0, v0, a0, q1, v1 and a1.
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    gtsam::Vector3 x0, x1;
+    for (size_t k = 0; k < 3; k++) {
+      x0(k) = x.at<double>(keys_[k]);
+      x1(k) = x.at<double>(keys_[k + 3]);
+    }
+    const gtsam::Matrix3 Phi = calcPhi(dt_);
+    if (H) {
+      H->resize(6);
+      for (size_t k = 0; k < 3; k++) {
+        (*H)[k] = -Phi.col(k);
+        (*H)[k + 3] = gtsam::Matrix3::Identity().col(k);
+      }
+    }
+    return x1 - Phi * x0;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "Gaussian process prior factor, dt " << dt_
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE const &ar, const unsigned int version) {
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+    ar &BOOST_SERIALIZATION_NVP(dt_);
+  }
+};
+
+}  // namespace gtdynamics
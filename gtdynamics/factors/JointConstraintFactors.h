@@ -0,0 +1,387 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointConstraintFactors.h
+ * @brief Joint pose, twist, twist acceleration, wrench and torque factors
+ * with hand-written, fixed-size Jacobians.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/optional.hpp>
+#include <iostream>
+#include <string>
+
+#include "gtdynamics/universal_robot/Joint.h"
+#include "gtdynamics/universal_robot/Link.h"
+#include "gtdynamics/utils/utils.h"
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+/*
+ * The factors below have the same errors as the expressions returned by
+ * Joint::poseConstraint, twistConstraint, twistAccelConstraint,
+ * wrenchEquivalenceConstraint and torqueConstraint, but evaluate their
+ * Jacobians directly in fixed-size matrices instead of walking an expression
+ * tree. They only depend on the joint's screw axis, so they apply to
+ * revolute, prismatic and helical joints alike. As they hold no time index,
+ * they can be moved to other time steps with rekey. The joint transforms and
+ * adjoint maps at q come from Joint::childKinematics, so the factors of one
+ * joint and time step compute them once per linearization.
+ */
+
+/// Pose constraint log(wTc^{-1} wTp pTc(q)) = 0 of a joint.
+class JointPoseFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, double> {
+ private:
+  using This = JointPoseFactor;
+  using Base = gtsam::NoiseModelFactor3<gtsam::Pose3, gtsam::Pose3, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /**
+   * Constructor
+   * @param wTp_key     key of the parent link's CoM pose
+   * @param wTc_key     key of the child link's CoM pose
+   * @param q_key       key of the joint angle
+   * @param cost_model  noise model
+   * @param joint       the joint
+   */
+  JointPoseFactor(gtsam::Key wTp_key, gtsam::Key wTc_key, gtsam::Key q_key,
+                  const gtsam::SharedNoiseModel &cost_model,
+                  const JointConstSharedPtr &joint)
+      : Base(cost_model, wTp_key, wTc_key, q_key), joint_(joint) {}
+
+  /// Constructor for time step `t`.
+  JointPoseFactor(const gtsam::SharedNoiseModel &cost_model,
+                  const JointConstSharedPtr &joint, int t)
+      : JointPoseFactor(internal::PoseKey(joint->parent()->id(), t),
+                        internal::PoseKey(joint->child()->id(), t),
+                        internal::JointAngleKey(joint->id(), t), cost_model,
+                        joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTp, const gtsam::Pose3 &wTc, const double &q,
+      boost::optional<gtsam::Matrix &> H_wTp = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTc = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Matrix6 wTc_hat_H_wTp, E_H_wTc, E_H_wTc_hat, error_H_E;
+    const gtsam::Pose3 &pTc = joint_->childKinematics(q, false).pTc;
+    const gtsam::Pose3 wTc_hat = wTp.compose(pTc, H_wTp ? &wTc_hat_H_wTp : 0);
+    const gtsam::Pose3 E = wTc.between(wTc_hat, H_wTc ? &E_H_wTc : 0,
+                                       (H_wTp || H_q) ? &E_H_wTc_hat : 0);
+    const bool any = H_wTp || H_wTc || H_q;
+    const gtsam::Vector6 error = gtsam::Pose3::Logmap(E, any ? &error_H_E : 0);
+    if (H_wTp || H_q) {
+      const gtsam::Matrix6 error_H_wTc_hat = error_H_E * E_H_wTc_hat;
+      if (H_wTp) *H_wTp = error_H_wTc_hat * wTc_hat_H_wTp;
+      // The derivative of compose in pTc is identity, and that of pTc in q
+      // is the child screw axis.
+      if (H_q) *H_q = error_H_wTc_hat * joint_->cScrewAxis();
+    }
+    if (H_wTc) *H_wTc = error_H_E * E_H_wTc;
+    return error;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Joint Pose Factor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/// Twist constraint Ad(cTp(q)) Vp + S q_dot - Vc = 0 of a joint.
+class JointTwistFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Vector6, gtsam::Vector6, double,
+                                      double> {
+ private:
+  using This = JointTwistFactor;
+  using Base = gtsam::NoiseModelFactor4<gtsam::Vector6, gtsam::Vector6, double,
+                                        double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /// Constructor for time step `t`.
+  JointTwistFactor(const gtsam::SharedNoiseModel &cost_model,
+                   const JointConstSharedPtr &joint, int t)
+      : Base(cost_model, internal::TwistKey(joint->parent()->id(), t),
+             internal::TwistKey(joint->child()->id(), t),
+             internal::JointAngleKey(joint->id(), t),
+             internal::JointVelKey(joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_p, const gtsam::Vector6 &twist_c,
+      const double &q, const double &q_dot,
+      boost::optional<gtsam::Matrix &> H_twist_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none) const override {
+    gtsam::Vector6 H_q_, H_q_dot_;
+    gtsam::Matrix6 H_twist_p_;
+    const gtsam::Vector6 twist_c_hat = joint_->transformTwistTo(
+        joint_->child(), q, q_dot, twist_p, H_q ? &H_q_ : 0,
+        H_q_dot ? &H_q_dot_ : 0, H_twist_p ? &H_twist_p_ : 0);
+    if (H_twist_p) *H_twist_p = H_twist_p_;
+    if (H_twist_c) *H_twist_c = -gtsam::I_6x6;
+    if (H_q) *H_q = H_q_;
+    if (H_q_dot) *H_q_dot = H_q_dot_;
+    return twist_c_hat - twist_c;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Joint Twist Factor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * Twist acceleration constraint of a joint,
+ * Ad(cTp(q)) Ap + ad(Vc) S q_dot + S q_ddot - Ac = 0.
+ */
+class JointTwistAccelFactor
+    : public gtsam::NoiseModelFactor6<gtsam::Vector6, gtsam::Vector6,
+                                      gtsam::Vector6, double, double, double> {
+ private:
+  using This = JointTwistAccelFactor;
+  using Base = gtsam::NoiseModelFactor6<gtsam::Vector6, gtsam::Vector6,
+                                        gtsam::Vector6, double, double,
+                                        double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /// Constructor for time step `t`.
+  JointTwistAccelFactor(const gtsam::SharedNoiseModel &cost_model,
+                        const JointConstSharedPtr &joint, int t)
+      : Base(cost_model, internal::TwistKey(joint->child()->id(), t),
+             internal::TwistAccelKey(joint->parent()->id(), t),
+             internal::TwistAccelKey(joint->child()->id(), t),
+             internal::JointAngleKey(joint->id(), t),
+             internal::JointVelKey(joint->id(), t),
+             internal::JointAccelKey(joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &twist_c, const gtsam::Vector6 &accel_p,
+      const gtsam::Vector6 &accel_c, const double &q, const double &q_dot,
+      const double &q_ddot,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_dot = boost::none,
+      boost::optional<gtsam::Matrix &> H_q_ddot = boost::none) const override {
+    const gtsam::Vector6 &S = joint_->cScrewAxis();
+    const JointKinematics &k = joint_->childKinematics(q, bool(H_q));
+    const gtsam::Matrix6 &Ad_cTp = k.Ad_cTp;
+    gtsam::Matrix6 H_twist_c_;
+    const gtsam::Vector6 accel_c_hat =
+        Ad_cTp * accel_p +
+        gtsam::Pose3::adjoint(twist_c, S * q_dot, H_twist_c ? &H_twist_c_ : 0) +
+        S * q_ddot;
+
+    if (H_twist_c) *H_twist_c = H_twist_c_;
+    if (H_accel_p) *H_accel_p = Ad_cTp;
+    if (H_accel_c) *H_accel_c = -gtsam::I_6x6;
+    if (H_q) {
+      const gtsam::Vector6 H_q_ = k.Ad_cTp_H_q * accel_p;
+      *H_q = H_q_;
+    }
+    if (H_q_dot) {
+      const gtsam::Vector6 H_q_dot_ = gtsam::Pose3::adjointMap(twist_c) * S;
+      *H_q_dot = H_q_dot_;
+    }
+    if (H_q_ddot) *H_q_ddot = S;
+    return accel_c_hat - accel_c;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Joint Twist Accel Factor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/// Wrench equivalence constraint Fp + Ad(pTc(q))^T Fc = 0 of a joint.
+class JointWrenchEquivalenceFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Vector6, gtsam::Vector6, double> {
+ private:
+  using This = JointWrenchEquivalenceFactor;
+  using Base = gtsam::NoiseModelFactor3<gtsam::Vector6, gtsam::Vector6, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /// Constructor for time step `t`.
+  JointWrenchEquivalenceFactor(const gtsam::SharedNoiseModel &cost_model,
+                               const JointConstSharedPtr &joint, int t)
+      : Base(cost_model,
+             internal::WrenchKey(joint->parent()->id(), joint->id(), t),
+             internal::WrenchKey(joint->child()->id(), joint->id(), t),
+             internal::JointAngleKey(joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &wrench_p, const gtsam::Vector6 &wrench_c,
+      const double &q, boost::optional<gtsam::Matrix &> H_wrench_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_wrench_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Vector6 H_q_;
+    gtsam::Matrix6 H_wrench_c_;
+    const gtsam::Vector6 wrench_c_hat = joint_->transformWrenchCoordinate(
+        joint_->child(), q, wrench_c, H_q ? &H_q_ : 0,
+        H_wrench_c ? &H_wrench_c_ : 0);
+    if (H_wrench_p) *H_wrench_p = gtsam::I_6x6;
+    if (H_wrench_c) *H_wrench_c = H_wrench_c_;
+    if (H_q) *H_q = H_q_;
+    return wrench_p + wrench_c_hat;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ")
+              << "Joint Wrench Equivalence Factor" << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/// Torque constraint S^T Fc - tau = 0 of a joint.
+class JointWrenchTorqueFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Vector6, double> {
+ private:
+  using This = JointWrenchTorqueFactor;
+  using Base = gtsam::NoiseModelFactor2<gtsam::Vector6, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /// Constructor for time step `t`.
+  JointWrenchTorqueFactor(const gtsam::SharedNoiseModel &cost_model,
+                          const JointConstSharedPtr &joint, int t)
+      : Base(cost_model,
+             internal::WrenchKey(joint->child()->id(), joint->id(), t),
+             internal::TorqueKey(joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &wrench, const double &torque,
+      boost::optional<gtsam::Matrix &> H_wrench = boost::none,
+      boost::optional<gtsam::Matrix &> H_torque = boost::none) const override {
+    const gtsam::Vector6 &S = joint_->cScrewAxis();
+    if (H_wrench) *H_wrench = S.transpose();
+    if (H_torque) *H_torque = -gtsam::I_1x1;
+    return gtsam::Vector1(S.dot(wrench) - torque);
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Joint Torque Factor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * JointWrenchTorqueFactor with the passive torque of the joint, see
+ * Joint::passiveTorque: S^T F - torque - passiveTorque(q, v) = 0.
+ */
+class PassiveJointWrenchTorqueFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Vector6, double, double,
+                                      double> {
+ private:
+  using This = PassiveJointWrenchTorqueFactor;
+  using Base =
+      gtsam::NoiseModelFactor4<gtsam::Vector6, double, double, double>;
+
+  JointConstSharedPtr joint_;
+
+ public:
+  /// Constructor for time step `t`.
+  PassiveJointWrenchTorqueFactor(const gtsam::SharedNoiseModel &cost_model,
+                                 const JointConstSharedPtr &joint, int t)
+      : Base(cost_model,
+             internal::WrenchKey(joint->child()->id(), joint->id(), t),
+             internal::TorqueKey(joint->id(), t),
+             internal::JointAngleKey(joint->id(), t),
+             internal::JointVelKey(joint->id(), t)),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector6 &wrench, const double &torque, const double &q,
+      const double &v, boost::optional<gtsam::Matrix &> H_wrench = boost::none,
+      boost::optional<gtsam::Matrix &> H_torque = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_v = boost::none) const override {
+    const gtsam::Vector6 &S = joint_->cScrewAxis();
+    double dq, dv;
+    const double passive = joint_->passiveTorque(q, v, &dq, &dv);
+    if (H_wrench) *H_wrench = S.transpose();
+    if (H_torque) *H_torque = -gtsam::I_1x1;
+    if (H_q) *H_q = gtsam::Vector1(-dq);
+    if (H_v) *H_v = gtsam::Vector1(-dv);
+    return gtsam::Vector1(S.dot(wrench) - torque - passive);
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Passive Joint Torque Factor"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
@@ -25,12 +25,17 @@
 #include <vector>
 
 #include "gtdynamics/universal_robot/Joint.h"
+#include "gtdynamics/universal_robot/JointParameterBlock.h"
 
 namespace gtdynamics {
 
 /**
  * JointLimitFactor is a class which enforces joint angle, velocity,
  * acceleration and torque value to be within limi
+ *
+ * The limits are either fixed at construction, or read from a shared
+ * JointParameterBlock at every evaluation, so that changing the block
+ * changes the factor without rebuilding the graph.
  */
 class JointLimitFactor : public gtsam::NoiseModelFactor1<double> {
  private:
@@ -38,6 +43,14 @@ class JointLimitFactor : public gtsam::NoiseModelFactor1<double> {
   using Base = gtsam::NoiseModelFactor1<double>;
   double low_, high_;
 
+ public:
+  /// Limited quantity, to pick the limits in a JointParameterBlock.
+  enum class Quantity : char { Angle, Velocity, Acceleration, Torque };
+
+ private:
+  JointParameterBlock::shared_ptr block_;  // null if low_, high_ are fixed
+  Quantity quantity_ = Quantity::Angle;
+
  public:
   /**
    * Construct from joint limits
@@ -55,9 +68,58 @@ class JointLimitFactor : public gtsam::NoiseModelFactor1<double> {
         low_(lower_limit + limit_threshold),
         high_(upper_limit - limit_threshold) {}
 
+  /**
+   * Construct with the limits of a shared parameter block
+   * @param q_key joint value key
+   * @param cost_model noise model
+   * @param block parameters of the joint
+   * @param quantity which limits of the parameters apply to q
+   */
+  JointLimitFactor(gtsam::Key q_key,
+                   const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                   const JointParameterBlock::shared_ptr &block,
+                   Quantity quantity)
+      : Base(cost_model, q_key), block_(block), quantity_(quantity) {
+    limits(&low_, &high_);
+  }
+
   virtual ~JointLimitFactor() {}
 
  public:
+  /// The parameter block, null if the limits are fixed.
+  const JointParameterBlock::shared_ptr &block() const { return block_; }
+
+  /// Current lower and upper limits, within the thresholds.
+  void limits(double *low, double *high) const {
+    if (!block_) {
+      *low = low_;
+      *high = high_;
+      return;
+    }
+    const auto parameters = block_->parameters();
+    const JointParams &p = *parameters;
+    switch (quantity_) {
+      case Quantity::Angle:
+        *low = p.scalar_limits.value_lower_limit +
+               p.scalar_limits.value_limit_threshold;
+        *high = p.scalar_limits.value_upper_limit -
+                p.scalar_limits.value_limit_threshold;
+        break;
+      case Quantity::Velocity:
+        *low = -p.velocity_limit + p.velocity_limit_threshold;
+        *high = p.velocity_limit - p.velocity_limit_threshold;
+        break;
+      case Quantity::Acceleration:
+        *low = -p.acceleration_limit + p.acceleration_limit_threshold;
+        *high = p.acceleration_limit - p.acceleration_limit_threshold;
+        break;
+      case Quantity::Torque:
+        *low = -p.torque_limit + p.torque_limit_threshold;
+        *high = p.torque_limit - p.torque_limit_threshold;
+        break;
+    }
+  }
+
   /**
    * Evaluate joint limit errors
    *
@@ -71,15 +133,17 @@ class JointLimitFactor : public gtsam::NoiseModelFactor1<double> {
   gtsam::Vector evaluateError(
       const double &q,
       boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
-    if (q < low_) {
+    double low, high;
+    limits(&low, &high);
+    if (q < low) {
       if (H_q) *H_q = -gtsam::I_1x1;
-      return gtsam::Vector1(low_ - q);
-    } else if (q <= high_) {
+      return gtsam::Vector1(low - q);
+    } else if (q <= high) {
       if (H_q) *H_q = gtsam::Z_1x1;
       return gtsam::Vector1(0.0);
     } else {
       if (H_q) *H_q = gtsam::I_1x1;
-      return gtsam::Vector1(q - high_);
+      return gtsam::Vector1(q - high);
     }
   }
 
@@ -98,7 +162,8 @@ class JointLimitFactor : public gtsam::NoiseModelFactor1<double> {
   }
 
  private:
-  /// Serialization function
+  /// Serialization function, which saves the limits at construction; the
+  /// parameter block is not serialized.
   friend class boost::serialization::access;
   template <class ARCHIVE>
   void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
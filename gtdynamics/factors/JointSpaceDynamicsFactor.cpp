@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointSpaceDynamicsFactor.cpp
+ * @brief Equations of motion of a fixed-base robot on joint-space variables.
+ */
+
+#include "gtdynamics/factors/JointSpaceDynamicsFactor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+JointSpaceDynamicsFactor::JointSpaceDynamicsFactor(
+    const Robot &robot, int t, const gtsam::SharedNoiseModel &cost_model,
+    const boost::optional<gtsam::Vector3> &gravity)
+    : dynamics_(robot, gravity) {
+  if (dynamics_.compiledRobot().hasFloatingRoot())
+    throw std::invalid_argument(
+        "JointSpaceDynamicsFactor: the roots of the robot should be fixed "
+        "links.");
+  const auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(cost_model);
+  if (!diagonal || diagonal->dim() != 1)
+    throw std::invalid_argument(
+        "JointSpaceDynamicsFactor: cost_model needs to be a diagonal noise "
+        "model of dimension 1.");
+
+  for (auto &&joint : robot.joints()) joint_ids_.push_back(joint->id());
+  std::sort(joint_ids_.begin(), joint_ids_.end());
+  const size_t n = joint_ids_.size();
+  for (auto key : {internal::JointAngleKey, internal::JointVelKey,
+                   internal::JointAccelKey, internal::TorqueKey})
+    for (const int j : joint_ids_) keys_.push_back(key(j, t));
+  noiseModel_ = gtsam::noiseModel::Diagonal::Sigmas(
+      Vector::Constant(n, diagonal->sigma(0)), true);
+
+  dynamics_.allocate(&result_);
+  const size_t slots = dynamics_.compiledRobot().numJointSlots();
+  q_.setZero(slots);
+  v_.setZero(slots);
+  a_.setZero(slots);
+}
+
+/* ************************************************************************* */
+Vector JointSpaceDynamicsFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t n = joint_ids_.size();
+  if (!this->active(x)) return Vector::Zero(n);
+
+  Vector tau(n);
+  for (size_t k = 0; k < n; ++k) {
+    const int j = joint_ids_[k];
+    q_(j) = x.at<double>(keys_[k]);
+    v_(j) = x.at<double>(keys_[n + k]);
+    a_(j) = x.at<double>(keys_[2 * n + k]);
+    tau(k) = x.at<double>(keys_[3 * n + k]);
+  }
+
+  if (H) {
+    dynamics_.inverseDynamicsDerivatives(q_, v_, a_, &result_, &dtau_dq_,
+                                         &dtau_dv_);
+    dynamics_.massMatrix(q_, &M_);
+    H->resize(size());
+    for (size_t c = 0; c < n; ++c) {
+      const int jc = joint_ids_[c];
+      Matrix &Hq = (*H)[c], &Hv = (*H)[n + c], &Ha = (*H)[2 * n + c];
+      Hq.resize(n, 1);
+      Hv.resize(n, 1);
+      Ha.resize(n, 1);
+      for (size_t r = 0; r < n; ++r) {
+        const int jr = joint_ids_[r];
+        Hq(r, 0) = dtau_dq_(jr, jc);
+        Hv(r, 0) = dtau_dv_(jr, jc);
+        Ha(r, 0) = M_(jr, jc);
+      }
+      (*H)[3 * n + c] = Matrix::Zero(n, 1);
+      (*H)[3 * n + c](c, 0) = -1;
+    }
+  } else {
+    dynamics_.inverseDynamics(q_, v_, a_, &result_);
+  }
+
+  Vector error(n);
+  for (size_t k = 0; k < n; ++k)
+    error(k) = result_.torques(joint_ids_[k]) - tau(k);
+  return error;
+}
+
+/* ************************************************************************* */
+void JointSpaceDynamicsFactor::print(
+    const std::string &s, const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Joint Space Dynamics Factor ("
+            << joint_ids_.size() << " joints)" << std::endl;
+  Base::print("", keyFormatter);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointSpaceDynamicsFactor.h
+ * @brief Equations of motion of a fixed-base robot on joint-space variables.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * JointSpaceDynamicsFactor constrains the joint angles, velocities,
+ * accelerations and torques of all joints at one time step to satisfy
+ *
+ *   ID(q, v, a) - tau = M(q) a + C(q, v) v + g(q) - tau = 0,
+ *
+ * with ID the recursive Newton-Euler inverse dynamics. It replaces the link
+ * poses, twists, twist accelerations and wrenches of
+ * DynamicsGraph::dynamicsFactors by their joint-space consequence, so a
+ * fixed-base robot needs only q, v, a and tau per step. The Jacobians are
+ * analytic: the angle and velocity derivatives come from
+ * RecursiveDynamics::inverseDynamicsDerivatives, the acceleration derivative
+ * is the mass matrix.
+ *
+ * Keys are the angles of all joints in increasing id order, then the
+ * velocities, accelerations and torques in the same order.
+ */
+class JointSpaceDynamicsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = JointSpaceDynamicsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot, a tree whose roots are fixed links
+   * @param t           time step
+   * @param cost_model  torque cost model, diagonal of dimension 1, applied
+   *                    to each joint
+   * @param gravity     gravity, if any
+   */
+  JointSpaceDynamicsFactor(const Robot &robot, int t,
+                           const gtsam::SharedNoiseModel &cost_model,
+                           const boost::optional<gtsam::Vector3> &gravity =
+                               boost::none);
+
+  /// Ids of the joints, in the order of the keys.
+  const std::vector<int> &jointIds() const { return joint_ids_; }
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  std::vector<int> joint_ids_;
+  RecursiveDynamics dynamics_;  // each factor has its own scratch space
+  mutable RecursiveDynamicsResult result_;
+  mutable gtsam::Vector q_, v_, a_;  // joint-id indexed
+  mutable gtsam::Matrix dtau_dq_, dtau_dv_, M_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,195 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinkDynamicsFactor.cpp
+ * @brief Wrench balance of a link fused with the wrench and torque
+ * constraints of the joints it is the child of.
+ */
+
+#include "gtdynamics/factors/LinkDynamicsFactor.h"
+
+#include <gtsam/linear/NoiseModel.h>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/dynamics/Dynamics.h"
+#include "gtdynamics/statics/Statics.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/utils.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+// Sigmas of a diagonal cost model, of dimension `dim`.
+static Vector DiagonalSigmas(const gtsam::SharedNoiseModel &model,
+                             size_t dim, const std::string &name) {
+  const auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  if (!diagonal || diagonal->dim() != dim)
+    throw std::invalid_argument("LinkDynamicsFactor: " + name +
+                                " needs to be a diagonal noise model of "
+                                "dimension " +
+                                std::to_string(dim) + ".");
+  return diagonal->sigmas();
+}
+
+/* ************************************************************************* */
+LinkDynamicsFactor::LinkDynamicsFactor(
+    const LinkConstSharedPtr &link, const std::vector<gtsam::Key> &wrench_keys,
+    int t, const OptimizerSetting &opt,
+    const boost::optional<gtsam::Vector3> &gravity,
+    const boost::optional<gtsam::Vector3> &planar_axis)
+    : link_(link), balance_(!link->isFixed()), gravity_(gravity) {
+  if (planar_axis) planar_H_ = getPlanarJacobian(*planar_axis);
+  const int i = link->id();
+  std::vector<Vector> sigmas;
+
+  if (balance_) {
+    if (gravity_) pose_ = index(internal::PoseKey(i, t), 6);
+    twist_ = index(internal::TwistKey(i, t), 6);
+    accel_ = index(internal::TwistAccelKey(i, t), 6);
+    for (const gtsam::Key key : wrench_keys) wrenches_.push_back(index(key, 6));
+    sigmas.push_back(DiagonalSigmas(opt.fa_cost_model, 6, "fa_cost_model"));
+  }
+
+  for (auto &&joint : link->joints()) {
+    if (joint->child() != link) continue;
+    const int j = joint->id();
+    JointIndices indices;
+    indices.joint = joint;
+    indices.wrench_p =
+        index(internal::WrenchKey(joint->parent()->id(), j, t), 6);
+    indices.wrench_c = index(internal::WrenchKey(i, j, t), 6);
+    indices.q = index(internal::JointAngleKey(j, t), 1);
+    indices.torque = index(internal::TorqueKey(j, t), 1);
+    joints_.push_back(indices);
+    sigmas.push_back(DiagonalSigmas(opt.f_cost_model, 6, "f_cost_model"));
+    sigmas.push_back(DiagonalSigmas(opt.t_cost_model, 1, "t_cost_model"));
+    if (planar_axis)
+      sigmas.push_back(
+          DiagonalSigmas(opt.planar_cost_model, 3, "planar_cost_model"));
+  }
+
+  size_t dim = 0;
+  for (auto &&s : sigmas) dim += s.size();
+  if (dim == 0)
+    throw std::invalid_argument("LinkDynamicsFactor: link " + link->name() +
+                                " is fixed and not the child of any joint.");
+  Vector all_sigmas(dim);
+  size_t row = 0;
+  for (auto &&s : sigmas) {
+    all_sigmas.segment(row, s.size()) = s;
+    row += s.size();
+  }
+  noiseModel_ = gtsam::noiseModel::Diagonal::Sigmas(all_sigmas, true);
+}
+
+/* ************************************************************************* */
+size_t LinkDynamicsFactor::index(gtsam::Key key, size_t dim) {
+  const auto it = std::find(keys_.begin(), keys_.end(), key);
+  if (it != keys_.end()) return it - keys_.begin();
+  keys_.push_back(key);
+  dims_.push_back(dim);
+  return keys_.size() - 1;
+}
+
+/* ************************************************************************* */
+Vector LinkDynamicsFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t m = dim();
+  if (!this->active(x)) return Vector::Zero(m);
+
+  Vector error(m);
+  if (H) {
+    H->resize(size());
+    for (size_t k = 0; k < size(); k++) (*H)[k] = Matrix::Zero(m, dims_[k]);
+  }
+
+  size_t row = 0;
+  if (balance_) {
+    // Coriolis - inertia * twist acceleration + external and gravity wrenches.
+    const gtsam::Matrix6 &inertia = link_->inertiaMatrix();
+    const Vector6 twist = x.at<Vector6>(keys_[twist_]);
+    const Vector6 accel = x.at<Vector6>(keys_[accel_]);
+    gtsam::Matrix6 H_twist;
+    Vector6 balance =
+        Coriolis(inertia, twist, H ? &H_twist : 0) - inertia * accel;
+    for (const size_t k : wrenches_) balance += x.at<Vector6>(keys_[k]);
+    gtsam::Matrix6 H_pose;
+    if (gravity_)
+      balance += GravityWrench(*gravity_, link_->mass(),
+                               x.at<gtsam::Pose3>(keys_[pose_]),
+                               H ? &H_pose : 0);
+    error.head<6>() = balance;
+    if (H) {
+      (*H)[twist_].block<6, 6>(0, 0) += H_twist;
+      (*H)[accel_].block<6, 6>(0, 0) -= inertia;
+      for (const size_t k : wrenches_)
+        (*H)[k].block<6, 6>(0, 0) += gtsam::I_6x6;
+      if (gravity_) (*H)[pose_].block<6, 6>(0, 0) += H_pose;
+    }
+    row = 6;
+  }
+
+  for (auto &&indices : joints_) {
+    const Joint &joint = *indices.joint;
+    const double q = x.at<double>(keys_[indices.q]);
+    const Vector6 wrench_p = x.at<Vector6>(keys_[indices.wrench_p]);
+    const Vector6 wrench_c = x.at<Vector6>(keys_[indices.wrench_c]);
+    const double torque = x.at<double>(keys_[indices.torque]);
+
+    // Wrench equivalence: Fp + Ad(pTc)^T Fc = 0.
+    Vector6 H_q;
+    gtsam::Matrix6 H_wrench_c;
+    error.segment<6>(row) =
+        wrench_p + joint.transformWrenchCoordinate(
+                       joint.child(), q, wrench_c, H ? &H_q : 0,
+                       H ? &H_wrench_c : 0);
+    if (H) {
+      (*H)[indices.wrench_p].block<6, 6>(row, 0) += gtsam::I_6x6;
+      (*H)[indices.wrench_c].block<6, 6>(row, 0) += H_wrench_c;
+      (*H)[indices.q].block<6, 1>(row, 0) += H_q;
+    }
+    row += 6;
+
+    // Torque: S^T Fc - tau = 0.
+    const Vector6 &S = joint.cScrewAxis();
+    error(row) = S.dot(wrench_c) - torque;
+    if (H) {
+      (*H)[indices.wrench_c].block<1, 6>(row, 0) += S.transpose();
+      (*H)[indices.torque](row, 0) -= 1.0;
+    }
+    row += 1;
+
+    // Planar: P Fc = 0.
+    if (planar_H_.size()) {
+      error.segment<3>(row) = planar_H_ * wrench_c;
+      if (H) (*H)[indices.wrench_c].block<3, 6>(row, 0) += planar_H_;
+      row += 3;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void LinkDynamicsFactor::print(const std::string &s,
+                               const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Link Dynamics Factor ("
+            << link_->name() << ", " << joints_.size() << " joints)"
+            << std::endl;
+  Base::print("", keyFormatter);
+}
+
+}  // namespace gtdynamics
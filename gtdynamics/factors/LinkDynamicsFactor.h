@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinkDynamicsFactor.h
+ * @brief Wrench balance of a link fused with the wrench and torque
+ * constraints of the joints it is the child of.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/universal_robot/Joint.h"
+#include "gtdynamics/universal_robot/Link.h"
+
+namespace gtdynamics {
+
+/**
+ * LinkDynamicsFactor stacks, in one factor, the dynamics residuals that
+ * DynamicsGraph::dynamicsFactors otherwise adds as separate factors for a
+ * link i at one time step:
+ *  - the wrench balance of link i, as WrenchFactor, unless i is fixed;
+ *  - for each joint j with child link i: wrench equivalence, as
+ *    WrenchEquivalenceFactor, torque, as TorqueFactor, and, if a planar axis
+ *    is given, planarity, as WrenchPlanarFactor.
+ * The noise model is block-diagonal in the individual cost models, so the
+ * error equals the sum of the errors of those factors. One factor with one
+ * block Jacobian per variable saves the per-factor overhead of linearization
+ * and elimination.
+ */
+class LinkDynamicsFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = LinkDynamicsFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor
+   * @param link         the link
+   * @param wrench_keys  keys of all wrenches acting on the link, including
+   *                     contact wrenches; ignored for a fixed link
+   * @param t            time step
+   * @param opt          provides fa, f, t and planar cost models, which
+   *                     need to be diagonal
+   * @param gravity      gravity, if any
+   * @param planar_axis  planar axis, if any
+   */
+  LinkDynamicsFactor(const LinkConstSharedPtr &link,
+                     const std::vector<gtsam::Key> &wrench_keys, int t,
+                     const OptimizerSetting &opt,
+                     const boost::optional<gtsam::Vector3> &gravity =
+                         boost::none,
+                     const boost::optional<gtsam::Vector3> &planar_axis =
+                         boost::none);
+
+  /// Number of joints whose constraints are included.
+  size_t numJoints() const { return joints_.size(); }
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  // Return the index of `key` in keys_, adding it if needed.
+  size_t index(gtsam::Key key, size_t dim);
+
+  // Variables of one joint, as indices into keys_.
+  struct JointIndices {
+    JointConstSharedPtr joint;
+    size_t wrench_p, wrench_c, q, torque;
+  };
+
+  LinkConstSharedPtr link_;
+  bool balance_;  // include the wrench balance of the link
+  boost::optional<gtsam::Vector3> gravity_;
+  gtsam::Matrix planar_H_;  // 3x6 planar selection, empty if not planar
+  size_t pose_ = 0, twist_ = 0, accel_ = 0;
+  std::vector<size_t> wrenches_;
+  std::vector<JointIndices> joints_;
+  std::vector<size_t> dims_;  // dimension of each variable
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MeasurementFactorBuilder.cpp
+ * @brief Measurement factors of time windows, from sensor ring buffers.
+ */
+
+#include "gtdynamics/factors/MeasurementFactorBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "gtdynamics/factors/ContactHeightFactor.h"
+#include "gtdynamics/factors/JointMeasurementFactor.h"
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+MeasurementFactorBuilder::MeasurementFactorBuilder(
+    const Robot &robot, const MeasurementFactorBuilderParameters &parameters)
+    : p_(parameters),
+      joint_buffer_(parameters.joint_capacity),
+      contact_buffer_(parameters.contact_capacity) {
+  if (p_.window <= 0)
+    throw std::invalid_argument(
+        "MeasurementFactorBuilder: window should be positive.");
+  for (auto &&joint : robot.joints()) {
+    const size_t j = joint->id();
+    if (j >= joints_.size()) joints_.resize(j + 1);
+    joints_[j] = joint;
+  }
+  for (auto &&link : robot.links())
+    num_link_slots_ = std::max<size_t>(num_link_slots_, link->id() + 1);
+}
+
+/* ************************************************************************* */
+int64_t MeasurementFactorBuilder::windowOf(double time) const {
+  if (time < p_.start_time) return -1;
+  return static_cast<int64_t>(std::floor((time - p_.start_time) / p_.window));
+}
+
+/* ************************************************************************* */
+MeasurementFactorBuilder::Accumulator &MeasurementFactorBuilder::accumulator(
+    int64_t k) {
+  auto it = accumulators_.find(k);
+  if (it != accumulators_.end()) return it->second;
+  Accumulator accumulator;
+  if (!free_accumulators_.empty()) {
+    accumulator = std::move(free_accumulators_.back());
+    free_accumulators_.pop_back();
+  } else {
+    accumulator.angle_sums.assign(joints_.size(), 0.0);
+    accumulator.angle_counts.assign(joints_.size(), 0);
+  }
+  return accumulators_.emplace(k, std::move(accumulator)).first->second;
+}
+
+/* ************************************************************************* */
+MeasurementWindow MeasurementFactorBuilder::build(
+    int64_t k, const Accumulator &accumulator,
+    const std::shared_ptr<FactorArena> &arena) const {
+  MeasurementWindow window;
+  window.k = k;
+  window.start_time = p_.start_time + k * p_.window;
+  window.num_readings = accumulator.num_readings;
+  for (size_t j = 0; j < joints_.size(); ++j) {
+    if (!accumulator.angle_counts[j]) continue;
+    window.factors.push_back(MakeShared<JointMeasurementFactor>(
+        arena, p_.joint_model, joints_[j],
+        accumulator.angle_sums[j] / accumulator.angle_counts[j], size_t(k)));
+  }
+  for (auto &&contact : accumulator.contacts) {
+    if (!contact.second.in_contact) continue;
+    window.factors.push_back(MakeShared<ContactHeightFactor>(
+        arena, internal::PoseKey(contact.first, k), p_.contact_model,
+        contact.second.contact_in_com, p_.gravity, p_.ground_height));
+  }
+  return window;
+}
+
+/* ************************************************************************* */
+std::vector<MeasurementWindow> MeasurementFactorBuilder::take(bool all) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  joint_scratch_.clear();
+  joint_buffer_.popBatch(&joint_scratch_);
+  for (auto &&reading : joint_scratch_) {
+    ++stats_.readings;
+    const int64_t k = windowOf(reading.time);
+    if (k < 0 || reading.joint < 0 || size_t(reading.joint) >= joints_.size() ||
+        !joints_[reading.joint]) {
+      ++stats_.rejected;
+      continue;
+    }
+    if (k < next_) {
+      ++stats_.late;
+      continue;
+    }
+    Accumulator &window = accumulator(k);
+    window.angle_sums[reading.joint] += reading.angle;
+    ++window.angle_counts[reading.joint];
+    ++window.num_readings;
+    newest_ = std::max(newest_, k);
+  }
+
+  contact_scratch_.clear();
+  contact_buffer_.popBatch(&contact_scratch_);
+  for (auto &&reading : contact_scratch_) {
+    ++stats_.readings;
+    const int64_t k = windowOf(reading.time);
+    if (k < 0 || reading.link < 0 || size_t(reading.link) >= num_link_slots_) {
+      ++stats_.rejected;
+      continue;
+    }
+    if (k < next_) {
+      ++stats_.late;
+      continue;
+    }
+    Accumulator &window = accumulator(k);
+    auto it = window.contacts.find(reading.link);
+    if (it == window.contacts.end())
+      window.contacts.emplace(reading.link, reading);
+    else if (reading.time >= it->second.time)
+      it->second = reading;
+    ++window.num_readings;
+    newest_ = std::max(newest_, k);
+  }
+
+  // Windows before the newest are complete; their factors share an arena.
+  const int64_t last = all ? newest_ : newest_ - 1;
+  std::vector<MeasurementWindow> windows;
+  std::shared_ptr<FactorArena> arena;
+  while (!accumulators_.empty() && accumulators_.begin()->first <= last) {
+    if (!arena) arena = std::make_shared<FactorArena>();
+    auto it = accumulators_.begin();
+    windows.push_back(build(it->first, it->second, arena));
+    Accumulator &done = it->second;
+    std::fill(done.angle_sums.begin(), done.angle_sums.end(), 0.0);
+    std::fill(done.angle_counts.begin(), done.angle_counts.end(), 0);
+    done.contacts.clear();
+    done.num_readings = 0;
+    free_accumulators_.push_back(std::move(done));
+    accumulators_.erase(it);
+  }
+  next_ = std::max(next_, last + 1);
+  stats_.windows += windows.size();
+  return windows;
+}
+
+/* ************************************************************************* */
+std::vector<MeasurementWindow> MeasurementFactorBuilder::drain() {
+  return take(false);
+}
+
+/* ************************************************************************* */
+std::vector<MeasurementWindow> MeasurementFactorBuilder::flush() {
+  return take(true);
+}
+
+/* ************************************************************************* */
+MeasurementFactorBuilderStats MeasurementFactorBuilder::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  MeasurementFactorBuilderStats stats = stats_;
+  stats.dropped = joint_buffer_.dropped() + contact_buffer_.dropped();
+  return stats;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,167 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MeasurementFactorBuilder.h
+ * @brief Measurement factors of time windows, from sensor ring buffers.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/FactorArena.h"
+#include "gtdynamics/utils/SensorRingBuffer.h"
+
+namespace gtdynamics {
+
+/// Timestamped encoder reading of one joint.
+struct JointReading {
+  double time = 0;  ///< seconds
+  int joint = -1;   ///< joint id
+  double angle = 0;
+};
+
+/// Timestamped contact state of one link.
+struct ContactReading {
+  double time = 0;  ///< seconds
+  int link = -1;    ///< link id
+  bool in_contact = false;
+  gtsam::Point3 contact_in_com = gtsam::Point3(0, 0, 0);
+};
+
+/// Parameters of MeasurementFactorBuilder.
+struct MeasurementFactorBuilderParameters {
+  double window = 0.01;            ///< seconds per time index
+  double start_time = 0;           ///< time of the start of window 0
+  size_t joint_capacity = 4096;    ///< cells of the joint reading buffer
+  size_t contact_capacity = 1024;  ///< cells of the contact reading buffer
+
+  /// Noise model of the JointMeasurementFactors, 6-dimensional.
+  gtsam::SharedNoiseModel joint_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+
+  /// Noise model of the ContactHeightFactors, 1-dimensional.
+  gtsam::SharedNoiseModel contact_model =
+      gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+
+  gtsam::Vector3 gravity = gtsam::Vector3(0, 0, -9.8);
+  double ground_height = 0;
+};
+
+/// Measurement factors of one time window.
+struct MeasurementWindow {
+  size_t k = 0;             ///< time index of the window
+  double start_time = 0;    ///< seconds
+  size_t num_readings = 0;  ///< readings summarized by the factors
+  gtsam::NonlinearFactorGraph factors;
+};
+
+/// Counters of a MeasurementFactorBuilder since construction.
+struct MeasurementFactorBuilderStats {
+  uint64_t readings = 0;  ///< readings drained from the buffers
+  uint64_t dropped = 0;   ///< readings refused by full buffers
+  uint64_t rejected = 0;  ///< bad ids, or earlier than window start_time
+  uint64_t late = 0;      ///< for windows already built
+  uint64_t windows = 0;   ///< windows built
+};
+
+/**
+ * MeasurementFactorBuilder decouples sensor threads from the smoother: the
+ * encoder thread pushes JointReadings and the contact thread ContactReadings
+ * into lock-free SensorRingBuffers, never waiting, and the smoother drains
+ * them at its own rate into factors grouped by time window, with time index
+ * k = floor((time - start_time) / window):
+ *  - one JointMeasurementFactor per joint read in the window, on the mean of
+ *    its readings,
+ *  - one ContactHeightFactor per link whose last reading in the window is in
+ *    contact.
+ *
+ * A window is complete once a reading of a later window has been drained;
+ * complete windows are returned by drain(), and readings that arrive after
+ * their window was returned are counted as late and ignored. The factors of
+ * one drain() are allocated from one FactorArena, rather than one heap
+ * allocation each.
+ *
+ * Each buffer needs a single producer thread. drain() and flush() can be
+ * called from any thread and are serialized.
+ */
+class MeasurementFactorBuilder {
+ public:
+  explicit MeasurementFactorBuilder(
+      const Robot &robot, const MeasurementFactorBuilderParameters &parameters =
+                              MeasurementFactorBuilderParameters());
+
+  /// Buffer of the encoder thread.
+  SensorRingBuffer<JointReading> &jointReadings() { return joint_buffer_; }
+
+  /// Buffer of the contact thread.
+  SensorRingBuffer<ContactReading> &contactReadings() {
+    return contact_buffer_;
+  }
+
+  /// Take all waiting readings and return the factors of the windows they
+  /// complete, oldest first.
+  std::vector<MeasurementWindow> drain();
+
+  /// As drain(), but return the incomplete windows too, e.g. at shutdown.
+  std::vector<MeasurementWindow> flush();
+
+  /// Counters so far.
+  MeasurementFactorBuilderStats stats() const;
+
+ private:
+  // Readings of one window so far.
+  struct Accumulator {
+    std::vector<double> angle_sums;
+    std::vector<size_t> angle_counts;
+    std::map<int, ContactReading> contacts;  // last reading per link
+    size_t num_readings = 0;
+  };
+
+  // Window index of `time`, or -1 if before start_time.
+  int64_t windowOf(double time) const;
+
+  // Pop both buffers into the accumulators and build the complete windows,
+  // or all windows if `all`.
+  std::vector<MeasurementWindow> take(bool all);
+
+  // Accumulator of window k, reusing a free one if possible.
+  Accumulator &accumulator(int64_t k);
+
+  // Factors of window k.
+  MeasurementWindow build(int64_t k, const Accumulator &accumulator,
+                          const std::shared_ptr<FactorArena> &arena) const;
+
+  MeasurementFactorBuilderParameters p_;
+  std::vector<JointConstSharedPtr> joints_;  // by joint id
+  size_t num_link_slots_ = 0;
+
+  SensorRingBuffer<JointReading> joint_buffer_;
+  SensorRingBuffer<ContactReading> contact_buffer_;
+
+  mutable std::mutex mutex_;  // guards everything below
+  std::map<int64_t, Accumulator> accumulators_;
+  std::vector<Accumulator> free_accumulators_;  // reused, not reallocated
+  int64_t newest_ = -1;  // latest window with a reading
+  int64_t next_ = 0;     // first window not returned yet
+  std::vector<JointReading> joint_scratch_;
+  std::vector<ContactReading> contact_scratch_;
+  MeasurementFactorBuilderStats stats_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsFactors.cpp
+ * @brief Kinematics and dynamics factors of planar robots, on SE(2).
+ */
+
+#include "gtdynamics/factors/PlanarDynamicsFactors.h"
+
+#include <algorithm>
+#include <iostream>
+
+using gtsam::Matrix;
+using gtsam::Matrix3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+PlanarWrenchFactor::PlanarWrenchFactor(
+    gtsam::Key pose_key, gtsam::Key twist_key, gtsam::Key accel_key,
+    const std::vector<JointWrench> &joints,
+    const gtsam::SharedNoiseModel &model, double mass, double inertia,
+    const boost::optional<gtsam::Vector2> &gravity)
+    : mass_(mass), inertia_(inertia), gravity_(gravity) {
+  noiseModel_ = model;
+  if (gravity_) {
+    keys_.push_back(pose_key);
+  } else {
+    twist_ = 0;
+    accel_ = 1;
+  }
+  keys_.push_back(twist_key);
+  keys_.push_back(accel_key);
+  for (auto &&joint : joints) {
+    JointIndices indices;
+    indices.wrench = keys_.size();
+    keys_.push_back(joint.wrench_key);
+    indices.is_parent = joint.is_parent;
+    indices.joint = joint.joint;
+    indices.q = 0;
+    if (joint.is_parent) {
+      indices.q = keys_.size();
+      keys_.push_back(joint.q_key);
+    }
+    joints_.push_back(indices);
+  }
+}
+
+/* ************************************************************************* */
+Vector PlanarWrenchFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  if (!this->active(x)) return Vector::Zero(3);
+  if (H) {
+    H->resize(size());
+    for (size_t k = 0; k < size(); ++k) {
+      const bool scalar = std::any_of(
+          joints_.begin(), joints_.end(),
+          [k](const JointIndices &j) { return j.is_parent && j.q == k; });
+      (*H)[k] = Matrix::Zero(3, scalar ? 1 : 3);
+    }
+  }
+
+  // Inertia times acceleration, minus the Coriolis term ad(V)^T G V.
+  const Vector3 V = x.at<Vector3>(keys_[twist_]);
+  const Vector3 A = x.at<Vector3>(keys_[accel_]);
+  const double m = mass_, w = V(2);
+  Vector3 error(m * (A(0) - w * V(1)), m * (A(1) + w * V(0)), inertia_ * A(2));
+  if (H) {
+    (*H)[accel_].diagonal() << m, m, inertia_;
+    (*H)[twist_] << 0, -m * w, -m * V(1),  //
+        m * w, 0, m * V(0),                  //
+        0, 0, 0;
+  }
+
+  // Gravity acts at the CoM, as a force in the link frame.
+  if (gravity_) {
+    const gtsam::Pose2 wTi = x.at<gtsam::Pose2>(keys_[pose_]);
+    gtsam::Matrix21 H_rotation;
+    const gtsam::Vector2 g =
+        wTi.rotation().unrotate(*gravity_, H ? &H_rotation : nullptr);
+    error.head<2>() -= m * g;
+    if (H) (*H)[pose_].block<2, 1>(0, 2) = -m * H_rotation;
+  }
+
+  // Joint wrenches on the link: on children directly, on parents their
+  // reaction, transported to the parent frame.
+  for (auto &&j : joints_) {
+    const Vector3 F = x.at<Vector3>(keys_[j.wrench]);
+    if (!j.is_parent) {
+      error -= F;
+      if (H) (*H)[j.wrench] = -gtsam::I_3x3;
+      continue;
+    }
+    const double q = x.at<double>(keys_[j.q]);
+    const Matrix3 AdT = j.joint.childAdjoint(q).transpose();
+    error += AdT * F;
+    if (H) {
+      (*H)[j.wrench] = AdT;
+      (*H)[j.q] = -AdT *
+                  gtsam::Pose2::adjointMap(j.joint.screw_axis).transpose() * F;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void PlanarWrenchFactor::print(const std::string &s,
+                               const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << s << "PlanarWrenchFactor, mass " << mass_ << ", inertia "
+            << inertia_ << "\n";
+  Base::print("", keyFormatter);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,275 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PlanarDynamicsFactors.h
+ * @brief Kinematics and dynamics factors of planar robots, on SE(2).
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose2.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * A joint of a planar robot. Twists and wrenches are 3-vectors in the order
+ * of the tangent space of gtsam::Pose2, linear before angular: twists are
+ * (vx, vy, omega) and wrenches (fx, fy, torque), in link CoM frames.
+ */
+struct PlanarJointModel {
+  gtsam::Pose2 pMc;          ///< rest pose of the child in the parent
+  gtsam::Vector3 screw_axis;  ///< in the child frame
+
+  /// Pose of the child in the parent at angle q: pMc * exp(S q).
+  gtsam::Pose2 parentTchild(double q) const {
+    return pMc * gtsam::Pose2::Expmap(screw_axis * q);
+  }
+
+  /// Adjoint map from parent to child twists at angle q.
+  gtsam::Matrix3 childAdjoint(double q) const {
+    return parentTchild(q).inverse().AdjointMap();
+  }
+};
+
+/**
+ * PlanarPoseFactor: wTc = wTp * pTc(q), the error in the tangent space of
+ * the child pose.
+ */
+class PlanarPoseFactor
+    : public gtsam::NoiseModelFactor3<gtsam::Pose2, gtsam::Pose2, double> {
+  using Base = gtsam::NoiseModelFactor3<gtsam::Pose2, gtsam::Pose2, double>;
+  PlanarJointModel joint_;
+
+ public:
+  PlanarPoseFactor(gtsam::Key wTp_key, gtsam::Key wTc_key, gtsam::Key q_key,
+                   const gtsam::SharedNoiseModel &model,
+                   const PlanarJointModel &joint)
+      : Base(model, wTp_key, wTc_key, q_key), joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose2 &wTp, const gtsam::Pose2 &wTc, const double &q,
+      boost::optional<gtsam::Matrix &> H_wTp = boost::none,
+      boost::optional<gtsam::Matrix &> H_wTc = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none) const override {
+    gtsam::Matrix3 H_compose_p, H_compose_c, H_between_hat, H_between_c,
+        H_log;
+    const gtsam::Pose2 wTc_hat =
+        wTp.compose(joint_.parentTchild(q), H_compose_p, H_compose_c);
+    const gtsam::Pose2 delta =
+        wTc_hat.between(wTc, H_between_hat, H_between_c);
+    const gtsam::Vector3 error = gtsam::Pose2::Logmap(delta, H_log);
+    // The exponential map has the identity derivative along its direction.
+    if (H_wTp) *H_wTp = H_log * H_between_hat * H_compose_p;
+    if (H_wTc) *H_wTc = H_log * H_between_c;
+    if (H_q) *H_q = H_log * H_between_hat * H_compose_c * joint_.screw_axis;
+    return error;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new PlanarPoseFactor(*this)));
+  }
+};
+
+/**
+ * PlanarTwistFactor: Vc = Ad_{cTp(q)} Vp + S qdot.
+ */
+class PlanarTwistFactor
+    : public gtsam::NoiseModelFactor4<gtsam::Vector3, gtsam::Vector3, double,
+                                      double> {
+  using Base = gtsam::NoiseModelFactor4<gtsam::Vector3, gtsam::Vector3,
+                                        double, double>;
+  PlanarJointModel joint_;
+
+ public:
+  PlanarTwistFactor(gtsam::Key twist_p_key, gtsam::Key twist_c_key,
+                    gtsam::Key q_key, gtsam::Key qdot_key,
+                    const gtsam::SharedNoiseModel &model,
+                    const PlanarJointModel &joint)
+      : Base(model, twist_p_key, twist_c_key, q_key, qdot_key),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &twist_p, const gtsam::Vector3 &twist_c,
+      const double &q, const double &qdot,
+      boost::optional<gtsam::Matrix &> H_twist_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_qdot = boost::none) const override {
+    const gtsam::Matrix3 Ad = joint_.childAdjoint(q);
+    const gtsam::Vector3 transported = Ad * twist_p;
+    const gtsam::Vector3 &S = joint_.screw_axis;
+    if (H_twist_p) *H_twist_p = Ad;
+    if (H_twist_c) *H_twist_c = -gtsam::I_3x3;
+    if (H_q) *H_q = -gtsam::Pose2::adjointMap(S) * transported;
+    if (H_qdot) *H_qdot = S;
+    return transported + S * qdot - twist_c;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new PlanarTwistFactor(*this)));
+  }
+};
+
+/**
+ * PlanarTwistAccelFactor: Ac = Ad_{cTp(q)} Ap + ad(Vc) S qdot + S qddot.
+ */
+class PlanarTwistAccelFactor
+    : public gtsam::NoiseModelFactor6<gtsam::Vector3, gtsam::Vector3,
+                                      gtsam::Vector3, double, double, double> {
+  using Base = gtsam::NoiseModelFactor6<gtsam::Vector3, gtsam::Vector3,
+                                        gtsam::Vector3, double, double,
+                                        double>;
+  PlanarJointModel joint_;
+
+ public:
+  PlanarTwistAccelFactor(gtsam::Key accel_p_key, gtsam::Key accel_c_key,
+                         gtsam::Key twist_c_key, gtsam::Key q_key,
+                         gtsam::Key qdot_key, gtsam::Key qddot_key,
+                         const gtsam::SharedNoiseModel &model,
+                         const PlanarJointModel &joint)
+      : Base(model, accel_p_key, accel_c_key, twist_c_key, q_key, qdot_key,
+             qddot_key),
+        joint_(joint) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &accel_p, const gtsam::Vector3 &accel_c,
+      const gtsam::Vector3 &twist_c, const double &q, const double &qdot,
+      const double &qddot,
+      boost::optional<gtsam::Matrix &> H_accel_p = boost::none,
+      boost::optional<gtsam::Matrix &> H_accel_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_twist_c = boost::none,
+      boost::optional<gtsam::Matrix &> H_q = boost::none,
+      boost::optional<gtsam::Matrix &> H_qdot = boost::none,
+      boost::optional<gtsam::Matrix &> H_qddot = boost::none) const override {
+    const gtsam::Matrix3 Ad = joint_.childAdjoint(q);
+    const gtsam::Vector3 transported = Ad * accel_p;
+    const gtsam::Vector3 &S = joint_.screw_axis;
+    const gtsam::Matrix3 ad_S = gtsam::Pose2::adjointMap(S);
+    if (H_accel_p) *H_accel_p = Ad;
+    if (H_accel_c) *H_accel_c = -gtsam::I_3x3;
+    if (H_twist_c) *H_twist_c = -ad_S * qdot;  // ad(V) S = -ad(S) V
+    if (H_q) *H_q = -ad_S * transported;
+    if (H_qdot) *H_qdot = gtsam::Pose2::adjointMap(twist_c) * S;
+    if (H_qddot) *H_qddot = S;
+    return transported + gtsam::Pose2::adjointMap(twist_c) * S * qdot +
+           S * qddot - accel_c;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new PlanarTwistAccelFactor(*this)));
+  }
+};
+
+/**
+ * PlanarTorqueFactor: torque = S . F, with F the wrench of the joint on its
+ * child link.
+ */
+class PlanarTorqueFactor
+    : public gtsam::NoiseModelFactor2<gtsam::Vector3, double> {
+  using Base = gtsam::NoiseModelFactor2<gtsam::Vector3, double>;
+  gtsam::Vector3 screw_axis_;
+
+ public:
+  PlanarTorqueFactor(gtsam::Key wrench_key, gtsam::Key torque_key,
+                     const gtsam::SharedNoiseModel &model,
+                     const PlanarJointModel &joint)
+      : Base(model, wrench_key, torque_key), screw_axis_(joint.screw_axis) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Vector3 &wrench, const double &torque,
+      boost::optional<gtsam::Matrix &> H_wrench = boost::none,
+      boost::optional<gtsam::Matrix &> H_torque = boost::none) const override {
+    if (H_wrench) *H_wrench = screw_axis_.transpose();
+    if (H_torque) *H_torque = -gtsam::I_1x1;
+    return gtsam::Vector1(screw_axis_.dot(wrench) - torque);
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new PlanarTorqueFactor(*this)));
+  }
+};
+
+/**
+ * PlanarWrenchFactor: Newton-Euler wrench balance of one planar link,
+ *   G A - ad(V)^T G V = m gravity + sum_j F_j - sum_j Ad_{cTp(q_j)}^T F_j,
+ * with G = diag(m, m, I), the first sum over the joints whose child is the
+ * link and the second over those whose parent it is. Only the wrench of
+ * each joint on its child is a variable: its reaction on the parent is
+ * substituted, which halves the wrench variables of the SE(3) graph and
+ * needs no wrench equivalence factors.
+ */
+class PlanarWrenchFactor : public gtsam::NoiseModelFactor {
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /// A joint acting on the link.
+  struct JointWrench {
+    gtsam::Key wrench_key;    ///< wrench of the joint on its child
+    gtsam::Key q_key;         ///< joint angle, used if is_parent
+    bool is_parent = false;   ///< the link is the parent of the joint
+    PlanarJointModel joint;   ///< used if is_parent
+  };
+
+  /**
+   * Constructor
+   * @param pose_key   pose of the link, used for gravity only
+   * @param twist_key  twist of the link
+   * @param accel_key  twist acceleration of the link
+   * @param joints     joints acting on the link
+   * @param model      3-dimensional noise model
+   * @param mass       mass of the link
+   * @param inertia    rotational inertia about the planar axis, at the CoM
+   * @param gravity    in-plane gravity in the world frame, if any
+   */
+  PlanarWrenchFactor(gtsam::Key pose_key, gtsam::Key twist_key,
+                     gtsam::Key accel_key,
+                     const std::vector<JointWrench> &joints,
+                     const gtsam::SharedNoiseModel &model, double mass,
+                     double inertia,
+                     const boost::optional<gtsam::Vector2> &gravity);
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new PlanarWrenchFactor(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  // Variables of each joint, as indices into keys_.
+  struct JointIndices {
+    size_t wrench, q;
+    bool is_parent;
+    PlanarJointModel joint;
+  };
+
+  size_t pose_ = 0, twist_ = 1, accel_ = 2;  // indices into keys_
+  std::vector<JointIndices> joints_;
+  double mass_, inertia_;
+  boost::optional<gtsam::Vector2> gravity_;
+};
+
+}  // namespace gtdynamics
@@ -24,6 +24,7 @@
 #include <memory>
 #include <string>
 
+#include "gtdynamics/factors/JointConstraintFactors.h"
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/universal_robot/Link.h"
 
@@ -165,8 +166,7 @@ class TempPoseFactor : public gtsam::NoiseModelFactor {
 inline gtsam::NoiseModelFactor::shared_ptr PoseFactor(
     const gtsam::SharedNoiseModel &cost_model, const JointConstSharedPtr &joint,
     int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
-      cost_model, gtsam::Vector6::Zero(), joint->poseConstraint(time));
+  return boost::make_shared<JointPoseFactor>(cost_model, joint, time);
 }
 
   /**
@@ -184,9 +184,8 @@ inline gtsam::NoiseModelFactor::shared_ptr PoseFactor(
     DynamicsSymbol wTp_key, DynamicsSymbol wTc_key, DynamicsSymbol q_key,
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     JointConstSharedPtr joint) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
-      cost_model, gtsam::Vector6::Zero(),
-      joint->poseConstraint(wTp_key.time()));
+  return boost::make_shared<JointPoseFactor>(wTp_key, wTc_key, q_key,
+                                            cost_model, joint);
 }
 
 }  // namespace gtdynamics
@@ -0,0 +1,147 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PreintegratedContactFactors.cpp
+ * @brief Batched and sliding-window contact preintegration.
+ */
+
+#include "gtdynamics/factors/PreintegratedContactFactors.h"
+
+#include <stdexcept>
+
+#include "gtdynamics/utils/ThreadPool.h"
+
+using gtsam::Matrix3;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+namespace {
+
+// Is the covariance σ²I, for which the rotations drop out?
+bool IsIsotropic(const Matrix3 &cov) {
+  return cov.isApprox(cov(0, 0) * gtsam::I_3x3, 1e-12);
+}
+
+// Covariance increment of one step in the world frame, dt² wRc Σ wRcᵀ.
+Matrix3 WorldIncrement(const Pose3 &wTc, double dt, const Matrix3 &cov) {
+  const Matrix3 wRc = wTc.rotation().matrix();
+  return (dt * dt) * (wRc * cov * wRc.transpose());
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+PreintegratedPointContactMeasurements::PreintegratedPointContactMeasurements(
+    const std::vector<Pose3> &base_poses,
+    const std::vector<Pose3> &contact_poses, const std::vector<double> &dts,
+    const Matrix3 &discreteVelocityCovariance)
+    : vdCov_(discreteVelocityCovariance) {
+  const size_t n = base_poses.size();
+  if (n == 0 || contact_poses.size() != n || dts.size() != n)
+    throw std::invalid_argument(
+        "PreintegratedPointContactMeasurements: need one base pose, contact "
+        "pose and dt per step.");
+
+  if (IsIsotropic(vdCov_)) {
+    double sum_dt2 = 0;
+    for (const double dt : dts) sum_dt2 += dt * dt;
+    preintMeasCov_ = sum_dt2 * vdCov_;
+    return;
+  }
+
+  Matrix3 sum = gtsam::Z_3x3;
+  for (size_t k = 0; k < n; k++)
+    sum += WorldIncrement(contact_poses[k], dts[k], vdCov_);
+  const Matrix3 bRw = base_poses[0].rotation().transpose();
+  preintMeasCov_ = bRw * sum * bRw.transpose();
+}
+
+/* ************************************************************************* */
+void PreintegratedRigidContactMeasurements::integrateMeasurements(
+    const std::vector<Matrix3> &angularVelocityCovariances,
+    const std::vector<Matrix3> &linearVelocityCovariances,
+    const std::vector<double> &dts) {
+  const size_t n = dts.size();
+  if (angularVelocityCovariances.size() != n ||
+      linearVelocityCovariances.size() != n)
+    throw std::invalid_argument(
+        "PreintegratedRigidContactMeasurements: need one pair of covariances "
+        "per dt.");
+  Matrix3 w_sum = gtsam::Z_3x3, v_sum = gtsam::Z_3x3;
+  for (size_t k = 0; k < n; k++) {
+    const double dt2 = dts[k] * dts[k];
+    w_sum += dt2 * angularVelocityCovariances[k];
+    v_sum += dt2 * linearVelocityCovariances[k];
+  }
+  preintMeasCov_.topLeftCorner<3, 3>() += w_sum;
+  preintMeasCov_.bottomRightCorner<3, 3>() += v_sum;
+}
+
+/* ************************************************************************* */
+std::vector<PreintegratedPointContactMeasurements> PreintegratePointContacts(
+    const std::vector<Pose3> &base_poses,
+    const std::vector<std::vector<Pose3>> &contact_poses,
+    const std::vector<double> &dts, const Matrix3 &discreteVelocityCovariance,
+    ThreadPool *pool) {
+  std::vector<PreintegratedPointContactMeasurements> measurements(
+      contact_poses.size());
+  const auto integrate = [&](size_t foot) {
+    measurements[foot] = PreintegratedPointContactMeasurements(
+        base_poses, contact_poses[foot], dts, discreteVelocityCovariance);
+  };
+  if (!pool || contact_poses.size() < 2) {
+    for (size_t foot = 0; foot < contact_poses.size(); foot++) integrate(foot);
+  } else {
+    pool->parallelFor(contact_poses.size(),
+                      [&](size_t foot, size_t) { integrate(foot); });
+  }
+  return measurements;
+}
+
+/* ************************************************************************* */
+PointContactWindow::PointContactWindow(
+    size_t window_size, const Matrix3 &discreteVelocityCovariance)
+    : window_size_(window_size), vdCov_(discreteVelocityCovariance) {
+  if (window_size_ == 0)
+    throw std::invalid_argument("PointContactWindow: window_size must be > 0");
+}
+
+/* ************************************************************************* */
+void PointContactWindow::push(const Pose3 &base_pose,
+                              const Pose3 &contact_pose, double dt) {
+  base_rotations_.push_back(base_pose.rotation());
+  increments_.push_back(WorldIncrement(contact_pose, dt, vdCov_));
+  sum_ += increments_.back();
+  if (increments_.size() <= window_size_) return;
+
+  base_rotations_.pop_front();
+  sum_ -= increments_.front();
+  increments_.pop_front();
+
+  // Subtracting leaves rounding errors behind, so start over once per window.
+  if (++pops_ == window_size_) {
+    pops_ = 0;
+    sum_.setZero();
+    for (auto &&increment : increments_) sum_ += increment;
+  }
+}
+
+/* ************************************************************************* */
+PreintegratedPointContactMeasurements PointContactWindow::measurements()
+    const {
+  if (increments_.empty())
+    throw std::runtime_error("PointContactWindow: the window is empty.");
+  PreintegratedPointContactMeasurements pcm;
+  const Matrix3 bRw = base_rotations_.front().transpose();
+  pcm.preintMeasCov_ = bRw * sum_ * bRw.transpose();
+  pcm.vdCov_ = vdCov_;
+  return pcm;
+}
+
+}  // namespace gtdynamics
@@ -21,19 +21,25 @@
 #include <gtsam/nonlinear/NonlinearFactor.h>
 #include <gtsam/slam/BetweenFactor.h>
 
+#include <deque>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/universal_robot/Link.h"
 
 namespace gtdynamics {
 
+class ThreadPool;
+
 /**
  * Class to perform preintegration of contact measurements for a point foot
  * model.
  */
 class PreintegratedPointContactMeasurements {
+  friend class PointContactWindow;
+
   /// The preintegrated measurement covariance
   gtsam::Matrix3 preintMeasCov_;
 
@@ -64,6 +70,27 @@ class PreintegratedPointContactMeasurements {
     preintMeasCov_ = B * vdCov_ * B.transpose();
   }
 
+  /**
+   * @brief Preintegrate a whole contact phase at once. The result is the same
+   * as the constructor at the first step followed by integrateMeasurement for
+   * every other step, with the rotations computed from world poses.
+   *
+   * The covariance is accumulated in the world frame and rotated into the
+   * initial base frame once, and an isotropic discrete velocity covariance
+   * needs no rotations at all.
+   *
+   * @param base_poses The poses of the base frame in the world, one per step.
+   * @param contact_poses The poses of the contact frame in the world.
+   * @param dts The time between the previous and current step, per step.
+   * @param discreteVelocityCovariance The covariance matrix for the discrete
+   * velocity of the contact frame.
+   */
+  PreintegratedPointContactMeasurements(
+      const std::vector<gtsam::Pose3> &base_poses,
+      const std::vector<gtsam::Pose3> &contact_poses,
+      const std::vector<double> &dts,
+      const gtsam::Matrix3 &discreteVelocityCovariance);
+
   /// Virtual destructor for serialization
   ~PreintegratedPointContactMeasurements() {}
 
@@ -254,6 +281,19 @@ class PreintegratedRigidContactMeasurements {
     preintMeasCov_ *= deltaT;
   }
 
+  /**
+   * @brief Integrate many measurements with time varying contact noise, the
+   * same as integrateMeasurement for each step, without forming 6x6 blocks.
+   *
+   * @param angularVelocityCovariances The angular velocity covariances.
+   * @param linearVelocityCovariances The linear velocity covariances.
+   * @param dts The time intervals, one per measurement.
+   */
+  void integrateMeasurements(
+      const std::vector<gtsam::Matrix3> &angularVelocityCovariances,
+      const std::vector<gtsam::Matrix3> &linearVelocityCovariances,
+      const std::vector<double> &dts);
+
   gtsam::Matrix6 preintMeasCov() const { return preintMeasCov_; }
 };
 
@@ -312,4 +352,60 @@ class PreintegratedRigidContactFactor
   }
 };
 
+/**
+ * Preintegrate the point contact measurements of several feet over the same
+ * steps, see the batch constructor of PreintegratedPointContactMeasurements.
+ * With a pool, the feet are integrated in parallel.
+ *
+ * @param base_poses The poses of the base frame in the world, one per step.
+ * @param contact_poses The contact frame poses in the world, per foot and step.
+ * @param dts The time between the previous and current step, per step.
+ * @param discreteVelocityCovariance The discrete velocity covariance.
+ * @param pool Optional thread pool.
+ */
+std::vector<PreintegratedPointContactMeasurements> PreintegratePointContacts(
+    const std::vector<gtsam::Pose3> &base_poses,
+    const std::vector<std::vector<gtsam::Pose3>> &contact_poses,
+    const std::vector<double> &dts,
+    const gtsam::Matrix3 &discreteVelocityCovariance,
+    ThreadPool *pool = nullptr);
+
+/**
+ * Fixed-lag preintegration of point contact measurements over the last
+ * `window_size` steps, for factors over a sliding estimation horizon.
+ *
+ * Every step's covariance increment is kept in the world frame, so sliding
+ * the window adds the newest and subtracts the oldest increment, and the
+ * measurements are rotated into the base frame of the oldest step only when
+ * requested. The sum is recomputed once per window to bound rounding drift.
+ */
+class PointContactWindow {
+ public:
+  /**
+   * Constructor
+   * @param window_size Number of steps in the window, at least one.
+   * @param discreteVelocityCovariance The discrete velocity covariance.
+   */
+  PointContactWindow(size_t window_size,
+                     const gtsam::Matrix3 &discreteVelocityCovariance);
+
+  /// Add a step, dropping the oldest one if the window is full.
+  void push(const gtsam::Pose3 &base_pose, const gtsam::Pose3 &contact_pose,
+            double dt);
+
+  /// Number of steps in the window.
+  size_t size() const { return increments_.size(); }
+
+  /// Measurements over the steps in the window.
+  PreintegratedPointContactMeasurements measurements() const;
+
+ private:
+  size_t window_size_;
+  gtsam::Matrix3 vdCov_;
+  std::deque<gtsam::Rot3> base_rotations_;
+  std::deque<gtsam::Matrix3> increments_;  // in the world frame
+  gtsam::Matrix3 sum_ = gtsam::Z_3x3;
+  size_t pops_ = 0;
+};
+
 }  // namespace gtdynamics
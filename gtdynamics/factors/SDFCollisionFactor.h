@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SDFCollisionFactor.h
+ * @brief Factor keeping a link clear of the environment.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/shared_ptr.hpp>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/SignedDistanceField.h"
+
+namespace gtdynamics {
+
+/**
+ * SDFCollisionFactor keeps the collision spheres of a link at least epsilon
+ * away from the obstacles of a signed distance field. There is one error per
+ * sphere, the hinge max(0, epsilon - (d - r)) of its clearance d - r, where
+ * d is the distance of its center, so the factor is zero while the link is
+ * clear.
+ */
+class SDFCollisionFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
+ private:
+  using This = SDFCollisionFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Pose3>;
+
+  boost::shared_ptr<const SignedDistanceField> sdf_;
+  CollisionSpheres spheres_;  // In the link's COM frame.
+  double epsilon_;            // Clearance to keep.
+
+ public:
+  /**
+   * @param pose_key The key corresponding to the link's CoM pose.
+   * @param cost_model Noise model, of dimension spheres.size().
+   * @param sdf Signed distance field of the environment.
+   * @param spheres Collision spheres of the link, in its COM frame.
+   * @param epsilon Clearance to keep.
+   */
+  SDFCollisionFactor(gtsam::Key pose_key,
+                     const gtsam::noiseModel::Base::shared_ptr &cost_model,
+                     const boost::shared_ptr<const SignedDistanceField> &sdf,
+                     const CollisionSpheres &spheres, double epsilon)
+      : Base(cost_model, pose_key),
+        sdf_(sdf),
+        spheres_(spheres),
+        epsilon_(epsilon) {
+    if (cost_model->dim() != spheres.size())
+      throw std::invalid_argument(
+          "SDFCollisionFactor: the noise model needs one row per sphere.");
+  }
+
+  virtual ~SDFCollisionFactor() {}
+
+  /**
+   * Evaluate collision errors.
+   * @param sTl This link's COM pose in the spatial frame.
+   */
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &sTl,
+      boost::optional<gtsam::Matrix &> H_pose = boost::none) const override {
+    gtsam::Vector error = gtsam::Vector::Zero(spheres_.size());
+    if (H_pose) *H_pose = gtsam::Matrix::Zero(spheres_.size(), 6);
+    for (size_t i = 0; i < spheres_.size(); i++) {
+      gtsam::Matrix36 H_sTl;
+      const gtsam::Point3 sPc = sTl.transformFrom(spheres_[i].center, H_sTl);
+      gtsam::Matrix13 H_sPc;
+      const double clearance = sdf_->distance(sPc, H_sPc) - spheres_[i].radius;
+      if (clearance >= epsilon_) continue;
+      error(i) = epsilon_ - clearance;
+      if (H_pose) H_pose->row(i) = -H_sPc * H_sTl;
+    }
+    return error;
+  }
+
+  //// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? "" : s + " ") << "SDFCollisionFactor, "
+              << spheres_.size() << " spheres, epsilon " << epsilon_
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor1", boost::serialization::base_object<Base>(*this));
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelfCollisionFactor.cpp
+ * @brief Self-collision avoidance of all link pairs of a robot at one time
+ * step, in one factor.
+ */
+
+#include "gtdynamics/factors/SelfCollisionFactor.h"
+
+#include <iostream>
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Matrix36;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+SelfCollisionFactor::SelfCollisionFactor(
+    const boost::shared_ptr<const SelfCollisionModel> &model, int t,
+    double epsilon, double sigma)
+    : model_(model), epsilon_(epsilon) {
+  if (model->pairs().empty())
+    throw std::invalid_argument("SelfCollisionFactor: no link pairs.");
+
+  key_of_link_.assign(model->compiledRobot().numLinkSlots(), -1);
+  size_t rows = 0;
+  for (const auto &pair : model->pairs()) {
+    for (const int i : {pair.link_a, pair.link_b}) {
+      if (key_of_link_[i] >= 0) continue;
+      key_of_link_[i] = keys_.size();
+      keys_.push_back(internal::PoseKey(i, t));
+    }
+    first_rows_.push_back(rows);
+    rows += model->spheres(pair.link_a).size() *
+            model->spheres(pair.link_b).size();
+  }
+  noiseModel_ = gtsam::noiseModel::Isotropic::Sigma(rows, sigma);
+}
+
+/* ************************************************************************* */
+Vector SelfCollisionFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t m = dim();
+  if (!this->active(x)) return Vector::Zero(m);
+
+  std::vector<Pose3> poses(key_of_link_.size());
+  for (size_t i = 0; i < key_of_link_.size(); i++)
+    if (key_of_link_[i] >= 0) poses[i] = x.at<Pose3>(keys_[key_of_link_[i]]);
+
+  Vector error = Vector::Zero(m);
+  if (H) {
+    H->resize(size());
+    for (auto &&Hk : *H) Hk = Matrix::Zero(m, 6);
+  }
+  const auto &pairs = model_->pairs();
+  for (const size_t p : model_->candidatePairs(poses, epsilon_)) {
+    const int a = pairs[p].link_a, b = pairs[p].link_b;
+    const CollisionSpheres &spheres_a = model_->spheres(a),
+                           &spheres_b = model_->spheres(b);
+    size_t row = first_rows_[p];
+    for (const CollisionSphere &sphere_a : spheres_a) {
+      Matrix36 H_a;
+      const Point3 wPa = poses[a].transformFrom(sphere_a.center, H_a);
+      for (const CollisionSphere &sphere_b : spheres_b) {
+        Matrix36 H_b;
+        const Point3 wPb = poses[b].transformFrom(sphere_b.center, H_b);
+        const Point3 d = wPa - wPb;
+        const double distance = d.norm();
+        const double clearance = distance - sphere_a.radius - sphere_b.radius;
+        if (clearance < epsilon_) {
+          error(row) = epsilon_ - clearance;
+          // Concentric spheres have no direction to separate along.
+          if (H && distance > 0) {
+            const gtsam::Matrix13 u = d.transpose() / distance;
+            (*H)[key_of_link_[a]].row(row) = -u * H_a;
+            (*H)[key_of_link_[b]].row(row) = u * H_b;
+          }
+        }
+        row++;
+      }
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void SelfCollisionFactor::print(const std::string &s,
+                                const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Self Collision Factor ("
+            << model_->pairs().size() << " link pairs, epsilon " << epsilon_
+            << ")" << std::endl;
+  Base::print("", keyFormatter);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelfCollisionFactor.h
+ * @brief Self-collision avoidance of all link pairs of a robot at one time
+ * step, in one factor.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/SelfCollision.h"
+
+namespace gtdynamics {
+
+/**
+ * SelfCollisionFactor keeps the collision spheres of every filtered link pair
+ * of a SelfCollisionModel at least epsilon apart, at time step t. There is
+ * one error per pair of spheres, the hinge max(0, epsilon - (d - r_a - r_b))
+ * of their clearance, on the COM poses of the links of the pairs. The
+ * broadphase of the model skips the pairs whose bounding spheres are clear,
+ * whose errors and Jacobians are zero, so the cost of the factor grows with
+ * the pairs that are close rather than with all pairs.
+ */
+class SelfCollisionFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = SelfCollisionFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor
+   * @param model       collision spheres and link pairs of the robot
+   * @param t           time step
+   * @param epsilon     clearance to keep
+   * @param sigma       sigma of the isotropic cost model
+   */
+  SelfCollisionFactor(const boost::shared_ptr<const SelfCollisionModel> &model,
+                      int t, double epsilon, double sigma);
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  boost::shared_ptr<const SelfCollisionModel> model_;
+  double epsilon_;
+  std::vector<size_t> first_rows_;  // first error row of each pair
+  std::vector<int> key_of_link_;    // index into keys_ by link id, or -1
+};
+
+}  // namespace gtdynamics
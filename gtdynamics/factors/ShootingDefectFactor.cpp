@@ -0,0 +1,172 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ShootingDefectFactor.cpp
+ * @brief Continuity of a multiple-shooting segment, by forward simulation.
+ */
+
+#include "gtdynamics/factors/ShootingDefectFactor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+// Sigma of a diagonal noise model of dimension 1.
+double ScalarSigma(const gtsam::SharedNoiseModel &model, const char *name) {
+  const auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  if (!diagonal || diagonal->dim() != 1)
+    throw std::invalid_argument(
+        std::string("ShootingDefectFactor: ") + name +
+        " needs to be a diagonal noise model of dimension 1.");
+  return diagonal->sigma(0);
+}
+}  // namespace
+
+/* ************************************************************************* */
+ShootingDefectFactor::ShootingDefectFactor(
+    const Robot &robot, int t, size_t num_steps, double dt,
+    const gtsam::SharedNoiseModel &q_cost_model,
+    const gtsam::SharedNoiseModel &v_cost_model,
+    const boost::optional<gtsam::Vector3> &gravity)
+    : num_steps_(num_steps), dt_(dt), dynamics_(robot, gravity) {
+  if (dynamics_.compiledRobot().hasFloatingRoot())
+    throw std::invalid_argument(
+        "ShootingDefectFactor: the roots of the robot should be fixed "
+        "links.");
+  if (num_steps == 0)
+    throw std::invalid_argument(
+        "ShootingDefectFactor: needs at least one step.");
+
+  for (auto &&joint : robot.joints()) joint_ids_.push_back(joint->id());
+  std::sort(joint_ids_.begin(), joint_ids_.end());
+  const size_t n = joint_ids_.size();
+  const int t1 = t + int(num_steps);
+  for (auto key : {internal::JointAngleKey, internal::JointVelKey,
+                   internal::TorqueKey})
+    for (const int j : joint_ids_) keys_.push_back(key(j, t));
+  for (auto key : {internal::JointAngleKey, internal::JointVelKey})
+    for (const int j : joint_ids_) keys_.push_back(key(j, t1));
+
+  Vector sigmas(2 * n);
+  sigmas.head(n).setConstant(ScalarSigma(q_cost_model, "q_cost_model"));
+  sigmas.tail(n).setConstant(ScalarSigma(v_cost_model, "v_cost_model"));
+  noiseModel_ = gtsam::noiseModel::Diagonal::Sigmas(sigmas, true);
+
+  dynamics_.allocate(&result_);
+  const size_t slots = dynamics_.compiledRobot().numJointSlots();
+  q_.setZero(slots);
+  v_.setZero(slots);
+  tau_.setZero(slots);
+}
+
+/* ************************************************************************* */
+void ShootingDefectFactor::step(Vector *q, Vector *v, const Vector &tau) const {
+  dynamics_.forwardDynamics(*q, *v, tau, &result_);
+  *v += dt_ * result_.joint_accels;
+  *q += dt_ * *v;
+}
+
+/* ************************************************************************* */
+void ShootingDefectFactor::integrate(Vector *q, Vector *v, const Vector &tau,
+                                     Matrix *S, Matrix *U) const {
+  if (!S) {
+    for (size_t k = 0; k < num_steps_; ++k) step(q, v, tau);
+    return;
+  }
+
+  const size_t n = joint_ids_.size();
+  const double dt = dt_;
+  S->setIdentity(2 * n, 2 * n);
+  if (U) U->setZero(2 * n, n);
+
+  Matrix Aq(n, n), Av(n, n), Au(n, n), Phi(2 * n, 2 * n), Gamma(2 * n, n);
+  const Matrix I = Matrix::Identity(n, n);
+  for (size_t k = 0; k < num_steps_; ++k) {
+    dynamics_.forwardDynamicsDerivatives(*q, *v, tau, &result_, &da_dq_,
+                                         &da_dv_, &da_dtau_);
+    for (size_t r = 0; r < n; ++r) {
+      for (size_t c = 0; c < n; ++c) {
+        const int jr = joint_ids_[r], jc = joint_ids_[c];
+        Aq(r, c) = da_dq_(jr, jc);
+        Av(r, c) = da_dv_(jr, jc);
+        Au(r, c) = da_dtau_(jr, jc);
+      }
+    }
+    // Linearized step: dv' = dt Aq dq + (I + dt Av) dv + dt Au du, and
+    // dq' = dq + dt dv'.
+    Phi.bottomLeftCorner(n, n) = dt * Aq;
+    Phi.bottomRightCorner(n, n) = I + dt * Av;
+    Phi.topLeftCorner(n, n) = I + dt * Phi.bottomLeftCorner(n, n);
+    Phi.topRightCorner(n, n) = dt * Phi.bottomRightCorner(n, n);
+    Gamma.bottomRows(n) = dt * Au;
+    Gamma.topRows(n) = dt * Gamma.bottomRows(n);
+    *S = Phi * *S;
+    if (U) *U = Phi * *U + Gamma;
+
+    *v += dt * result_.joint_accels;
+    *q += dt * *v;
+  }
+}
+
+/* ************************************************************************* */
+Vector ShootingDefectFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t n = joint_ids_.size();
+  if (!this->active(x)) return Vector::Zero(2 * n);
+
+  for (size_t k = 0; k < n; ++k) {
+    const int j = joint_ids_[k];
+    q_(j) = x.at<double>(keys_[k]);
+    v_(j) = x.at<double>(keys_[n + k]);
+    tau_(j) = x.at<double>(keys_[2 * n + k]);
+  }
+
+  Matrix S, U;
+  integrate(&q_, &v_, tau_, H ? &S : nullptr, H ? &U : nullptr);
+
+  Vector error(2 * n);
+  for (size_t k = 0; k < n; ++k) {
+    const int j = joint_ids_[k];
+    error(k) = x.at<double>(keys_[3 * n + k]) - q_(j);
+    error(n + k) = x.at<double>(keys_[4 * n + k]) - v_(j);
+  }
+
+  if (H) {
+    H->resize(size());
+    for (size_t c = 0; c < n; ++c) {
+      (*H)[c] = -S.col(c);
+      (*H)[n + c] = -S.col(n + c);
+      (*H)[2 * n + c] = -U.col(c);
+      (*H)[3 * n + c] = Matrix::Zero(2 * n, 1);
+      (*H)[3 * n + c](c, 0) = 1;
+      (*H)[4 * n + c] = Matrix::Zero(2 * n, 1);
+      (*H)[4 * n + c](n + c, 0) = 1;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void ShootingDefectFactor::print(
+    const std::string &s, const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Shooting Defect Factor ("
+            << joint_ids_.size() << " joints, " << num_steps_ << " steps)"
+            << std::endl;
+  Base::print("", keyFormatter);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ShootingDefectFactor.h
+ * @brief Continuity of a multiple-shooting segment, by forward simulation.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * ShootingDefectFactor is the defect of one multiple-shooting segment: the
+ * state (q, v) of all joints at step t is integrated over num_steps steps of
+ * semi-implicit Euler,
+ *
+ *   v' = v + dt * FD(q, v, tau),  q' = q + dt * v',
+ *
+ * with the torques tau at step t held over the segment, and the result is
+ * compared to the state at step t + num_steps. FD is the articulated-body
+ * forward dynamics of RecursiveDynamics, so no link variables are needed.
+ * The Jacobians are analytic: the derivatives of FD from
+ * RecursiveDynamics::forwardDynamicsDerivatives are chained through the
+ * integrator steps.
+ *
+ * Keys are the angles of all joints at t in increasing id order, then the
+ * velocities and torques at t, then the angles and velocities at
+ * t + num_steps. The error is the angle defects followed by the velocity
+ * defects.
+ */
+class ShootingDefectFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = ShootingDefectFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor
+   * @param robot         the robot, a tree whose roots are fixed links
+   * @param t             time step of the start of the segment
+   * @param num_steps     integrator steps in the segment, at least one
+   * @param dt            duration of each step
+   * @param q_cost_model  angle defect cost model, diagonal of dimension 1,
+   *                      applied to each joint
+   * @param v_cost_model  velocity defect cost model, the same
+   * @param gravity       gravity, if any
+   */
+  ShootingDefectFactor(const Robot &robot, int t, size_t num_steps, double dt,
+                       const gtsam::SharedNoiseModel &q_cost_model,
+                       const gtsam::SharedNoiseModel &v_cost_model,
+                       const boost::optional<gtsam::Vector3> &gravity =
+                           boost::none);
+
+  /// Ids of the joints, in the order of the keys.
+  const std::vector<int> &jointIds() const { return joint_ids_; }
+
+  /// Number of integrator steps.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Take one integrator step from joint-id indexed q, v and tau, in place.
+  void step(gtsam::Vector *q, gtsam::Vector *v, const gtsam::Vector &tau) const;
+
+  /**
+   * Integrate the segment from joint-id indexed q, v and tau.
+   * @param q, v  initial state, overwritten by the final one
+   * @param S     if given, derivative of the final state (q, v) in the
+   *              initial one, both in key order, 2n x 2n for n joints
+   * @param U     if given with S, derivative of the final state in the
+   *              torques, 2n x n
+   */
+  void integrate(gtsam::Vector *q, gtsam::Vector *v, const gtsam::Vector &tau,
+                 gtsam::Matrix *S = nullptr, gtsam::Matrix *U = nullptr) const;
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  std::vector<int> joint_ids_;
+  size_t num_steps_;
+  double dt_;
+  RecursiveDynamics dynamics_;  // each factor has its own scratch space
+  mutable RecursiveDynamicsResult result_;
+  mutable gtsam::Vector q_, v_, tau_;  // joint-id indexed
+  mutable gtsam::Matrix da_dq_, da_dv_, da_dtau_;
+};
+
+}  // namespace gtdynamics
@@ -22,6 +22,7 @@
 #include <memory>
 #include <string>
 
+#include "gtdynamics/factors/JointConstraintFactors.h"
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/universal_robot/Link.h"
 #include "gtdynamics/utils/values.h"
@@ -45,8 +46,21 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr TorqueFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     const JointConstSharedPtr &joint, size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<double>>(
-      cost_model, 0.0, joint->torqueConstraint(k));
+  return boost::make_shared<JointWrenchTorqueFactor>(cost_model, joint, k);
+}
+
+/**
+ * Torque factor with the passive spring, damper and friction torque of the
+ * joint, see Joint::passiveTorque:
+ *  screw_axis.transpose() * F.transpose() == torque + passive(q, v)
+ *
+ * @param joint JointConstSharedPtr to the joint
+ */
+inline gtsam::NoiseModelFactor::shared_ptr PassiveTorqueFactor(
+    const gtsam::noiseModel::Base::shared_ptr &cost_model,
+    const JointConstSharedPtr &joint, size_t k = 0) {
+  return boost::make_shared<PassiveJointWrenchTorqueFactor>(cost_model, joint,
+                                                            k);
 }
 
 }  // namespace gtdynamics
@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrackingFactors.h
+ * @brief Objective factors with targets that can be changed in place, e.g.
+ * by a model predictive controller between solves.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/make_shared.hpp>
+#include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
+#include <iostream>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * TargetHandle shares a target value between the caller and the factors
+ * tracking it: copies refer to the same value, so `set` changes the target of
+ * every factor built with the handle, and of their clones, without touching
+ * the graph. Factors read the target when they are evaluated, so a target
+ * should not be set while an optimizer is running; optimizers that cache
+ * linearizations, e.g. ISAM2, need to relinearize the factors whose targets
+ * changed.
+ */
+template <typename T>
+class TargetHandle {
+ public:
+  /// Constructor, with the initial target.
+  explicit TargetHandle(const T &target)
+      : target_(boost::make_shared<T>(target)) {}
+
+  /// Change the target.
+  void set(const T &target) { *target_ = target; }
+
+  /// Current target.
+  const T &get() const { return *target_; }
+
+ private:
+  boost::shared_ptr<T> target_;
+};
+
+/**
+ * TrackingPriorFactor is a PriorFactor whose prior is the current value of a
+ * TargetHandle: error = Local(target, x).
+ */
+template <typename T>
+class TrackingPriorFactor : public gtsam::NoiseModelFactor1<T> {
+ private:
+  using This = TrackingPriorFactor<T>;
+  using Base = gtsam::NoiseModelFactor1<T>;
+
+  TargetHandle<T> target_;
+
+ public:
+  /**
+   * Constructor
+   * @param key         key of the variable
+   * @param target      handle to the prior
+   * @param cost_model  noise model of the dimension of T
+   */
+  TrackingPriorFactor(gtsam::Key key, const TargetHandle<T> &target,
+                      const gtsam::SharedNoiseModel &cost_model)
+      : Base(cost_model, key), target_(target) {}
+
+  gtsam::Vector evaluateError(
+      const T &x, boost::optional<gtsam::Matrix &> H = boost::none) const
+      override {
+    if (H)
+      *H = gtsam::Matrix::Identity(gtsam::traits<T>::GetDimension(x),
+                                   gtsam::traits<T>::GetDimension(x));
+    return gtsam::traits<T>::Local(target_.get(), x);
+  }
+
+  /// Handle to the prior.
+  const TargetHandle<T> &target() const { return target_; }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Tracking Prior Factor"
+              << std::endl;
+    gtsam::traits<T>::Print(target_.get(), "  target: ");
+    Base::print("", keyFormatter);
+  }
+};
+
+/**
+ * TrackingPointGoalFactor is a PointGoalFactor whose goal is the current
+ * value of a TargetHandle: error = wTcom * point_com - goal.
+ */
+class TrackingPointGoalFactor : public gtsam::NoiseModelFactor1<gtsam::Pose3> {
+ private:
+  using This = TrackingPointGoalFactor;
+  using Base = gtsam::NoiseModelFactor1<gtsam::Pose3>;
+
+  gtsam::Point3 point_com_;
+  TargetHandle<gtsam::Point3> goal_;
+
+ public:
+  /**
+   * Constructor
+   * @param pose_key    key for COM pose of the link
+   * @param cost_model  3-dimensional noise model
+   * @param point_com   point on link, in COM coordinate frame
+   * @param goal        handle to the goal point, in world coordinates
+   */
+  TrackingPointGoalFactor(gtsam::Key pose_key,
+                          const gtsam::SharedNoiseModel &cost_model,
+                          const gtsam::Point3 &point_com,
+                          const TargetHandle<gtsam::Point3> &goal)
+      : Base(cost_model, pose_key), point_com_(point_com), goal_(goal) {}
+
+  gtsam::Vector evaluateError(
+      const gtsam::Pose3 &wTcom,
+      boost::optional<gtsam::Matrix &> H = boost::none) const override {
+    gtsam::Matrix36 H_pose;
+    const gtsam::Point3 point =
+        wTcom.transformFrom(point_com_, H ? &H_pose : nullptr);
+    if (H) *H = H_pose;
+    return point - goal_.get();
+  }
+
+  /// Handle to the goal point.
+  const TargetHandle<gtsam::Point3> &goal() const { return goal_; }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << (s.empty() ? s : s + " ") << "Tracking Point Goal Factor"
+              << std::endl;
+    std::cout << "  goal: " << goal_.get().transpose() << std::endl;
+    Base::print("", keyFormatter);
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,171 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryObjectiveFactors.cpp
+ * @brief Objectives over whole trajectories, one factor per reference path.
+ */
+
+#include "gtdynamics/factors/TrajectoryObjectiveFactors.h"
+
+#include <gtsam/geometry/Pose3.h>
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+// Diagonal noise model repeating the sigmas of a diagonal model of dimension
+// dim, num times.
+static gtsam::SharedNoiseModel Repeated(const gtsam::SharedNoiseModel &model,
+                                        size_t dim, size_t num,
+                                        const std::string &factor) {
+  const auto diagonal =
+      boost::dynamic_pointer_cast<gtsam::noiseModel::Diagonal>(model);
+  if (!diagonal || diagonal->dim() != dim)
+    throw std::invalid_argument(factor +
+                                ": cost_model needs to be a diagonal noise "
+                                "model of dimension " +
+                                std::to_string(dim) + ".");
+  return gtsam::noiseModel::Diagonal::Sigmas(
+      diagonal->sigmas().replicate(num, 1), true);
+}
+
+/* ************************************************************************* */
+PointGoalTrajectoryFactor::PointGoalTrajectoryFactor(
+    const gtsam::SharedNoiseModel &cost_model, const Point3 &point_com,
+    const Matrix &goals, DynamicsIndex i, size_t k)
+    : point_com_(point_com), goals_(goals) {
+  if (goals.rows() != 3 || goals.cols() == 0)
+    throw std::invalid_argument(
+        "PointGoalTrajectoryFactor: goals should be 3 x num_steps, with at "
+        "least one step.");
+  const size_t T = goals.cols();
+  keys_.reserve(T);
+  for (size_t t = 0; t < T; t++) keys_.push_back(internal::PoseKey(i, k + t));
+  noiseModel_ = Repeated(cost_model, 3, T, "PointGoalTrajectoryFactor");
+}
+
+/* ************************************************************************* */
+Vector PointGoalTrajectoryFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t T = goals_.cols();
+  if (!this->active(x)) return Vector::Zero(3 * T);
+
+  Vector error(3 * T);
+  if (H) H->resize(T);
+  gtsam::Matrix36 H_pose;
+  for (size_t t = 0; t < T; t++) {
+    const gtsam::Pose3 &wTcom = x.at<gtsam::Pose3>(keys_[t]);
+    error.segment<3>(3 * t) =
+        wTcom.transformFrom(point_com_, H ? &H_pose : nullptr) -
+        goals_.col(t);
+    if (H) {
+      (*H)[t] = Matrix::Zero(3 * T, 6);
+      (*H)[t].middleRows<3>(3 * t) = H_pose;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void PointGoalTrajectoryFactor::print(
+    const std::string &s, const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Point Goal Trajectory Factor ("
+            << numSteps() << " steps)" << std::endl;
+  Base::print("", keyFormatter);
+}
+
+/* ************************************************************************* */
+JointTrajectoryFactor::JointTrajectoryFactor(
+    const std::vector<int> &joint_ids, KeyFunction key,
+    const Matrix &reference, const gtsam::SharedNoiseModel &cost_model,
+    size_t k)
+    : reference_(reference) {
+  if (joint_ids.empty() || size_t(reference.rows()) != joint_ids.size() ||
+      reference.cols() == 0)
+    throw std::invalid_argument(
+        "JointTrajectoryFactor: reference should have one row per joint and "
+        "at least one step.");
+  const size_t T = reference.cols();
+  keys_.reserve(joint_ids.size() * T);
+  for (const int j : joint_ids)
+    for (size_t t = 0; t < T; t++) keys_.push_back(key(j, k + t));
+  noiseModel_ =
+      Repeated(cost_model, 1, keys_.size(), "JointTrajectoryFactor");
+}
+
+/* ************************************************************************* */
+Vector JointTrajectoryFactor::unwhitenedError(
+    const gtsam::Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  const size_t m = keys_.size(), T = reference_.cols();
+  if (!this->active(x)) return Vector::Zero(m);
+
+  Vector error(m);
+  for (size_t r = 0; r < m; r++)
+    error(r) = x.at<double>(keys_[r]) - reference_(r / T, r % T);
+  if (H) {
+    H->resize(m);
+    for (size_t r = 0; r < m; r++) {
+      (*H)[r] = Matrix::Zero(m, 1);
+      (*H)[r](r, 0) = 1.0;
+    }
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+void JointTrajectoryFactor::print(
+    const std::string &s, const gtsam::KeyFormatter &keyFormatter) const {
+  std::cout << (s.empty() ? s : s + " ") << "Joint Trajectory Factor ("
+            << reference_.rows() << " joints, " << reference_.cols()
+            << " steps)" << std::endl;
+  Base::print("", keyFormatter);
+}
+
+/* ************************************************************************* */
+Matrix StanceGoals(const Point3 &stance_point, size_t num_steps) {
+  return stance_point.replicate(1, num_steps);
+}
+
+/* ************************************************************************* */
+Matrix SimpleSwingGoals(const Point3 &start, const Point3 &step,
+                        size_t num_steps) {
+  Matrix goals(3, num_steps);
+  const double dt = 1.0 / (num_steps + 1);
+  for (size_t k = 0; k < num_steps; k++) {
+    const double t = dt * (k + 1);
+    const double h = 0.2 * pow(t, 1.1) * pow(1 - t, 0.7);
+    goals.col(k) = start + t * step + Point3(0, 0, h);
+  }
+  return goals;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph JointsAtRestTrajectoryObjectives(
+    const Robot &robot, const gtsam::SharedNoiseModel &joint_velocity_model,
+    const gtsam::SharedNoiseModel &joint_acceleration_model, size_t num_steps,
+    size_t k) {
+  std::vector<int> joint_ids;
+  for (auto &&joint : robot.joints()) joint_ids.push_back(joint->id());
+  const Matrix zeros = Matrix::Zero(joint_ids.size(), num_steps);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<JointTrajectoryFactor>(
+      joint_ids, &internal::JointVelKey, zeros, joint_velocity_model, k);
+  graph.emplace_shared<JointTrajectoryFactor>(
+      joint_ids, &internal::JointAccelKey, zeros, joint_acceleration_model, k);
+  return graph;
+}
+
+}  // namespace gtdynamics
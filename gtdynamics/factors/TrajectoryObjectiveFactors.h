@@ -0,0 +1,167 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryObjectiveFactors.h
+ * @brief Objectives over whole trajectories, one factor per reference path.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+namespace gtdynamics {
+
+/**
+ * PointGoalTrajectoryFactor stacks the PointGoalFactors of PointGoalFactors
+ * for a point on link i over the steps k, ..., k + T - 1: the error of step t
+ * is wTcom_{k+t} * point_com - goal_t, with the goals stored as the columns
+ * of a 3 x T matrix. The noise model repeats the diagonal cost model of a
+ * single step, so the error equals the sum of the errors of the T factors.
+ *
+ * All poses of the factor are eliminated together, so long horizons should
+ * be split in a few factors of moderate length, as for CollocationBankFactor.
+ */
+class PointGoalTrajectoryFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = PointGoalTrajectoryFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /**
+   * Constructor
+   * @param cost_model diagonal noise model of dimension 3, for each step
+   * @param point_com  point on link, in COM coordinate frame
+   * @param goals      goal points in world coordinates, one column per step
+   * @param i          the link id
+   * @param k          first time index
+   */
+  PointGoalTrajectoryFactor(const gtsam::SharedNoiseModel &cost_model,
+                            const gtsam::Point3 &point_com,
+                            const gtsam::Matrix &goals, DynamicsIndex i,
+                            size_t k = 0);
+
+  /// Goal points, one column per step.
+  const gtsam::Matrix &goals() const { return goals_; }
+
+  /// Number of time steps.
+  size_t numSteps() const { return goals_.cols(); }
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  gtsam::Point3 point_com_;
+  gtsam::Matrix goals_;
+};
+
+/**
+ * JointTrajectoryFactor stacks priors on one joint quantity (angles,
+ * velocities or accelerations, chosen by the key function) of several joints
+ * over the steps k, ..., k + T - 1, against a reference with one row per
+ * joint and one column per step. The noise model repeats the diagonal cost
+ * model of dimension 1 of a single prior.
+ */
+class JointTrajectoryFactor : public gtsam::NoiseModelFactor {
+ private:
+  using This = JointTrajectoryFactor;
+  using Base = gtsam::NoiseModelFactor;
+
+ public:
+  /// Key of a joint quantity at a time step, e.g. internal::JointVelKey.
+  using KeyFunction = DynamicsSymbol (*)(int j, int t);
+
+  /**
+   * Constructor
+   * @param joint_ids   ids of the joints
+   * @param key         key function of the joint quantity
+   * @param reference   reference values, one row per joint, one column per
+   * step
+   * @param cost_model  diagonal noise model of dimension 1, for each prior
+   * @param k           first time index
+   */
+  JointTrajectoryFactor(const std::vector<int> &joint_ids, KeyFunction key,
+                        const gtsam::Matrix &reference,
+                        const gtsam::SharedNoiseModel &cost_model,
+                        size_t k = 0);
+
+  /// Reference values, one row per joint and one column per step.
+  const gtsam::Matrix &reference() const { return reference_; }
+
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override;
+
+ private:
+  // Keys are ordered by joint, then time step, as the rows of the error.
+  gtsam::Matrix reference_;
+};
+
+/**
+ * Stance foot goals, as StanceTrajectory, in one 3 x num_steps matrix.
+ * @param stance_point end effector goal, in world coordinates
+ * @param num_steps number of time steps
+ */
+gtsam::Matrix StanceGoals(const gtsam::Point3 &stance_point, size_t num_steps);
+
+/**
+ * Swing foot goals, as SimpleSwingTrajectory, in one 3 x num_steps matrix.
+ * @param start initial end effector goal, in world coordinates
+ * @param step 3D vector to move by
+ * @param num_steps number of time steps
+ */
+gtsam::Matrix SimpleSwingGoals(const gtsam::Point3 &start,
+                               const gtsam::Point3 &step, size_t num_steps);
+
+/**
+ * Objectives of JointsAtRestObjectives at the steps k, ..., k + num_steps - 1,
+ * as two JointTrajectoryFactors on the velocities and accelerations.
+ * @param robot The robot
+ * @param joint_velocity_model The noise model for the 0 velocity objective
+ * @param joint_acceleration_model The noise model for the 0 acceleration
+ * objective
+ * @param num_steps number of time steps
+ * @param k starting time index (default 0).
+ */
+gtsam::NonlinearFactorGraph JointsAtRestTrajectoryObjectives(
+    const Robot &robot, const gtsam::SharedNoiseModel &joint_velocity_model,
+    const gtsam::SharedNoiseModel &joint_acceleration_model, size_t num_steps,
+    size_t k = 0);
+
+}  // namespace gtdynamics
@@ -24,6 +24,7 @@
 #include <memory>
 #include <string>
 
+#include "gtdynamics/factors/JointConstraintFactors.h"
 #include "gtdynamics/universal_robot/Joint.h"
 
 namespace gtdynamics {
@@ -45,8 +46,7 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr TwistAccelFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     JointConstSharedPtr joint, int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
-      cost_model, gtsam::Vector6::Zero(), joint->twistAccelConstraint(time));
+  return boost::make_shared<JointTwistAccelFactor>(cost_model, joint, time);
 }
 
 }  // namespace gtdynamics
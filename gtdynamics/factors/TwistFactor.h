@@ -22,6 +22,7 @@
 #include <boost/optional.hpp>
 #include <string>
 
+#include "gtdynamics/factors/JointConstraintFactors.h"
 #include "gtdynamics/universal_robot/Joint.h"
 
 namespace gtdynamics {
@@ -41,8 +42,7 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr TwistFactor(
     const gtsam::noiseModel::Base::shared_ptr &cost_model,
     JointConstSharedPtr joint, int time) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
-      cost_model, gtsam::Vector6::Zero(), joint->twistConstraint(time));
+  return boost::make_shared<JointTwistFactor>(cost_model, joint, time);
 }
 
 }  // namespace gtdynamics
@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 
+#include "gtdynamics/factors/JointConstraintFactors.h"
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/universal_robot/Link.h"
 #include "gtdynamics/utils/values.h"
@@ -41,9 +42,8 @@ namespace gtdynamics {
 inline gtsam::NoiseModelFactor::shared_ptr
 WrenchEquivalenceFactor(const gtsam::noiseModel::Base::shared_ptr &cost_model,
                         const JointConstSharedPtr &joint, size_t k = 0) {
-  return boost::make_shared<gtsam::ExpressionFactor<gtsam::Vector6>>(
-      cost_model, gtsam::Vector6::Zero(),
-      joint->wrenchEquivalenceConstraint(k));
+  return boost::make_shared<JointWrenchEquivalenceFactor>(cost_model, joint,
+                                                         k);
 }
 
 }  // namespace gtdynamics
@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  HermiteTable.h
+ * @brief Lookup table of a smooth positive-axis function, interpolated with
+ * cubic Hermite splines.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * HermiteTable tabulates a function f(x) and its derivative on
+ * [2^min_exponent, 2^max_exponent), with nodes spaced uniformly within each
+ * octave [2^e, 2^(e+1)). The interval of x is found from its binary
+ * exponent, with std::frexp, so a lookup costs a cubic polynomial and no
+ * transcendental function. Between nodes f is the cubic Hermite spline of
+ * the node values and derivatives, and the derivative returned is that of
+ * the spline, so Jacobians of factors using the table are exact for the
+ * function they evaluate.
+ */
+class HermiteTable {
+ public:
+  using Function = std::function<double(double)>;
+
+  /**
+   * Constructor
+   * @param f               the tabulated function
+   * @param df              its derivative
+   * @param min_exponent    the table starts at 2^min_exponent
+   * @param max_exponent    the table ends at 2^max_exponent
+   * @param num_intervals   number of intervals in each octave
+   */
+  HermiteTable(const Function &f, const Function &df, int min_exponent,
+               int max_exponent, int num_intervals)
+      : min_exponent_(min_exponent),
+        max_exponent_(max_exponent),
+        n_(num_intervals) {
+    if (max_exponent <= min_exponent || num_intervals < 1)
+      throw std::invalid_argument(
+          "HermiteTable: need min_exponent < max_exponent and at least one "
+          "interval per octave.");
+    const int num_nodes = (max_exponent - min_exponent) * n_ + 1;
+    f_.reserve(num_nodes);
+    df_.reserve(num_nodes);
+    for (int i = 0; i < num_nodes; ++i) {
+      const int octave = i / n_, sub = i % n_;
+      const double x = std::ldexp(1.0 + double(sub) / n_,
+                                  min_exponent + octave);
+      f_.push_back(f(x));
+      df_.push_back(df(x));
+    }
+  }
+
+  /// Whether x is in the table.
+  bool contains(double x) const {
+    return x >= std::ldexp(1.0, min_exponent_) &&
+           x < std::ldexp(1.0, max_exponent_);
+  }
+
+  /**
+   * Interpolated value at x, which should be in the table.
+   * @param x           where to evaluate
+   * @param derivative  if given, set to the derivative at x
+   */
+  double operator()(double x, double *derivative = nullptr) const {
+    // x = m * 2^e with m in [0.5, 1), i.e. x in octave e - 1.
+    int e;
+    const double m = std::frexp(x, &e);
+    const double s = (2 * m - 1) * n_;
+    const int sub = static_cast<int>(s);
+    const double t = s - sub;
+    const int i = (e - 1 - min_exponent_) * n_ + sub;
+    const double h = std::ldexp(1.0 / n_, e - 1);
+
+    const double f0 = f_[i], f1 = f_[i + 1];
+    const double d0 = h * df_[i], d1 = h * df_[i + 1];
+    const double t2 = t * t, t3 = t2 * t;
+    if (derivative) {
+      *derivative = ((6 * t2 - 6 * t) * (f0 - f1) +
+                     (3 * t2 - 4 * t + 1) * d0 + (3 * t2 - 2 * t) * d1) /
+                    h;
+    }
+    return (2 * t3 - 3 * t2 + 1) * f0 + (t3 - 2 * t2 + t) * d0 +
+           (3 * t2 - 2 * t3) * f1 + (t3 - t2) * d1;
+  }
+
+ private:
+  int min_exponent_, max_exponent_, n_;
+  std::vector<double> f_, df_;  // at the nodes
+};
+
+}  // namespace gtdynamics
@@ -27,16 +27,16 @@
 namespace gtdynamics {
 
 /** Function for creating expressions. */
-double multDouble1(const double& d1, const double& d2,
-                   gtsam::OptionalJacobian<1, 1> H1,
-                   gtsam::OptionalJacobian<1, 1> H2) {
+inline double multDouble1(const double& d1, const double& d2,
+                          gtsam::OptionalJacobian<1, 1> H1,
+                          gtsam::OptionalJacobian<1, 1> H2) {
   if (H1) *H1 = gtsam::I_1x1 * d2;
   if (H2) *H2 = gtsam::I_1x1 * d1;
   return d1 * d2;
 }
 
 /** Add mass collocation factors for source tank. */
-void AddSourceMassCollocationFactor(
+inline void AddSourceMassCollocationFactor(
     gtsam::NonlinearFactorGraph* graph, const gtsam::KeyVector& mdot_prev_keys,
     const gtsam::KeyVector& mdot_curr_keys, gtsam::Key source_mass_key_prev,
     gtsam::Key source_mass_key_curr, gtsam::Key dt_key, bool isEuler,
@@ -73,7 +73,7 @@ void AddSourceMassCollocationFactor(
 /** Add collocation factors for time.
  * t_curr = t_prev + dt
  */
-void AddTimeCollocationFactor(
+inline void AddTimeCollocationFactor(
     gtsam::NonlinearFactorGraph* graph, gtsam::Key t_prev_key,
     gtsam::Key t_curr_key, gtsam::Key dt_key,
     const gtsam::noiseModel::Base::shared_ptr& cost_model) {
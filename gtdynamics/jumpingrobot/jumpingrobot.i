@@ -16,6 +16,10 @@ class MassFlowRateFactor: gtsam::NonlinearFactor{
   MassFlowRateFactor(gtsam::Key pm_key, gtsam::Key ps_key, gtsam::Key mdot_key,
                  const gtsam::noiseModel::Base* cost_model,
                  const double D, const double L, const double mu, const double epsilon, const double k);
+  MassFlowRateFactor(gtsam::Key pm_key, gtsam::Key ps_key, gtsam::Key mdot_key,
+                 const gtsam::noiseModel::Base* cost_model,
+                 const double D, const double L, const double mu, const double epsilon, const double k,
+                 bool tabulated);
   
   double computeExpectedMassFlow(
       const double &pm, const double &ps, const double &mdot);
@@ -87,4 +91,99 @@ void AddTimeCollocationFactor(
   gtsam::Key t_prev_key, gtsam::Key t_curr_key, gtsam::Key dt_key,
   const gtsam::noiseModel::Base *cost_model);
 
+/****************************************** Simulator ******************************************/
+
+#include <gtdynamics/jumpingrobot/utils/JRSimulator.h>
+class JRActuatorParameters {
+  JRActuatorParameters();
+  int j;
+  double k_tendon;
+  double k_anta;
+  double q_anta_limit;
+  double b;
+  double radius;
+  double q_rest;
+  bool positive;
+};
+
+class JRPneumaticParameters {
+  JRPneumaticParameters();
+  double gas_constant;
+  double d_tube;
+  double l_tube;
+  double mu_tube;
+  double eps_tube;
+  double time_constant_valve;
+  double v_source;
+  double init_mass;
+};
+
+class JRControls {
+  JRControls();
+  gtsam::Vector Tos;
+  gtsam::Vector Tcs;
+  double P_s_0;
+};
+
+class JRAdaptiveStepParameters {
+  JRAdaptiveStepParameters();
+  double dt_initial;
+  double dt_min;
+  double dt_max;
+  double error_tolerance;
+  double event_tolerance;
+};
+
+class JRSimulatorParameters {
+  JRSimulatorParameters();
+  gtdynamics::JRPneumaticParameters pneumatic;
+  gtdynamics::JRAdaptiveStepParameters adaptive;
+  gtsam::Vector3 gravity;
+  gtsam::Vector3 planar_axis;
+  double tolerance;
+  bool tabulated_mass_flow;
+  gtsam::LevenbergMarquardtParams lm;
+};
+
+class JRSimulator {
+  JRSimulator(const std::vector<gtdynamics::Robot> &robots,
+              const std::vector<gtdynamics::JRActuatorParameters> &actuators,
+              const gtsam::Values &initial_state,
+              const gtdynamics::JRSimulatorParameters &parameters =
+                  gtdynamics::JRSimulatorParameters());
+  gtsam::Values simulate(size_t num_steps, double dt,
+                         const gtdynamics::JRControls &controls);
+  gtsam::Values simulateAdaptive(double duration,
+                                 const gtdynamics::JRControls &controls);
+  std::vector<double> eventTimes() const;
+  std::vector<int> phases() const;
+  const gtdynamics::Robot &robot(int phase) const;
+};
+
+gtdynamics::OptimizerSetting JROptimizerSetting();
+
+#include <gtdynamics/jumpingrobot/utils/JumpingRobotGraphBuilder.h>
+class JumpingRobotGraphBuilder {
+  JumpingRobotGraphBuilder(
+      const std::vector<gtdynamics::Robot> &robots,
+      const std::vector<gtdynamics::JRActuatorParameters> &actuators,
+      const gtdynamics::JRPneumaticParameters &pneumatic =
+          gtdynamics::JRPneumaticParameters());
+  JumpingRobotGraphBuilder(
+      const std::vector<gtdynamics::Robot> &robots,
+      const std::vector<gtdynamics::JRActuatorParameters> &actuators,
+      const gtdynamics::JRPneumaticParameters &pneumatic,
+      const gtsam::Vector3 &gravity, const gtsam::Vector3 &planar_axis);
+  gtsam::NonlinearFactorGraph actuationGraph(int k) const;
+  gtsam::NonlinearFactorGraph massFlowGraph(int k) const;
+  gtsam::NonlinearFactorGraph robotGraph(int phase, int k) const;
+  gtsam::NonlinearFactorGraph dynamicsGraph(int phase, int k) const;
+  gtsam::NonlinearFactorGraph collocationGraph(
+      const std::vector<int> &step_phases) const;
+  gtsam::NonlinearFactorGraph trajectoryGraph(
+      const std::vector<int> &step_phases) const;
+  const gtdynamics::Robot &robot(int phase) const;
+  const gtdynamics::DynamicsGraph &graphBuilder() const;
+};
+
 }  // namespace gtdynamics
@@ -336,6 +336,67 @@ class JRSimulator:
 
         return values, step_phases
 
+    def native_simulator(self):
+        """ Create the C++ simulator of the jumping robot, which builds the
+            graphs of a time step once and reuses them for all steps and
+            simulations. """
+        jr = JumpingRobot(self.yaml_file_path, self.init_config)
+        robots = [JumpingRobot(self.yaml_file_path, self.init_config,
+                               phase).robot for phase in range(4)]
+
+        actuators = []
+        for actuator in jr.actuators:
+            params = gtd.JRActuatorParameters()
+            params.j = actuator.j
+            params.k_tendon = actuator.config["k_tendon"]
+            params.k_anta = actuator.config["k_anta"]
+            params.q_anta_limit = actuator.config["q_anta_limit"]
+            params.b = actuator.config["b"]
+            params.radius = actuator.config["rad0"]
+            params.q_rest = self.init_config["qs_rest"][actuator.name]
+            params.positive = actuator.positive
+            actuators.append(params)
+
+        pneumatic_config = jr.params["pneumatic"]
+        pneumatic = gtd.JRPneumaticParameters()
+        pneumatic.gas_constant = jr.gas_constant
+        pneumatic.d_tube = pneumatic_config["d_tube_valve_musc"] * 0.0254
+        pneumatic.l_tube = pneumatic_config["l_tube_valve_musc"] * 0.0254
+        pneumatic.mu_tube = pneumatic_config["mu_tube"]
+        pneumatic.eps_tube = pneumatic_config["eps_tube"]
+        pneumatic.time_constant_valve = pneumatic_config["time_constant_valve"]
+        pneumatic.v_source = pneumatic_config["v_source"]
+        pneumatic.init_mass = pneumatic_config["init_mass"]
+        params = gtd.JRSimulatorParameters()
+        params.pneumatic = pneumatic
+
+        initial_state = gtsam.Values()
+        for joint in jr.robot.joints():
+            j = joint.id()
+            gtd.InsertJointAngle(initial_state, j, 0,
+                                 float(self.init_config["qs"][joint.name()]))
+            gtd.InsertJointVel(initial_state, j, 0,
+                               float(self.init_config["vs"][joint.name()]))
+        torso_i = jr.robot.link("torso").id()
+        gtd.InsertPose(initial_state, torso_i, 0, self.init_config["torso_pose"])
+        gtd.InsertTwist(initial_state, torso_i, 0,
+                        self.init_config["torso_twist"])
+        return gtd.JRSimulator(robots, actuators, initial_state, params)
+
+    def simulate_native(self, num_steps: int, dt: float, controls):
+        """ Same as `simulate`, in a single call to the C++ simulator. """
+        if not hasattr(self, "native"):
+            self.native = self.native_simulator()
+        native_controls = gtd.JRControls()
+        names = [actuator.name for actuator in self.jr.actuators]
+        native_controls.Tos = np.array([controls["Tos"][name] for name in names],
+                                       dtype=float)
+        native_controls.Tcs = np.array([controls["Tcs"][name] for name in names],
+                                       dtype=float)
+        native_controls.P_s_0 = controls["P_s_0"]
+        values = self.native.simulate(num_steps, dt, native_controls)
+        return values, list(self.native.phases())
+
     def simulate_with_torque_seq(self, num_steps, dt, torques_seq):
         """ Run simulation with specified torque sequence. """
         controls = JumpingRobot.create_controls()
@@ -118,12 +118,17 @@ def make_plot(values, jr, num_steps):
     masses_dict["source"] = []
     time_list = []
 
+    # Joint angles, velocities and torques in a single pass over values.
+    dense = gtd.DynamicsValues.FromValues(jr.robot, values, num_steps)
+    for name in joint_names:
+        j = jr.robot.joint(name).id()
+        qs_dict[name] = dense.jointAngles()[j]
+        vs_dict[name] = dense.jointVels()[j]
+        torques_dict[name] = dense.torques()[j]
+
     for k in range(num_steps):
         for name in joint_names:
             j = jr.robot.joint(name).id()
-            qs_dict[name].append(gtd.JointAngle(values, j, k))
-            vs_dict[name].append(gtd.JointVel(values, j, k))
-            torques_dict[name].append(gtd.Torque(values, j, k))
             pressures_dict[name].append(values.atDouble(Actuator.PressureKey(j, k)))
             masses_dict[name].append(values.atDouble(Actuator.MassKey(j, k)))
             mdots_dict[name].append(values.atDouble(Actuator.MassRateActualKey(j, k)))
@@ -121,6 +121,32 @@ class TestJRSimulator(unittest.TestCase):
             self.assertAlmostEqual(torque, 0, places=7)
         # TODO(yetong): check torques, pressures, etc
 
+    def test_simulate_native(self):
+        """ Test the C++ simulator: air flows from the source tank into the
+            actuators, and the total mass is conserved. """
+        Tos = [0, 0, 0, 0]
+        Tcs = [1, 1, 1, 1]
+        P_s_0 = 65 * 6894.76 / 1e3
+        controls = JumpingRobot.create_controls(Tos, Tcs, P_s_0)
+        num_steps = 5
+        dt = 0.005
+        values, step_phases = self.jr_simulator.simulate_native(
+            num_steps, dt, controls)
+
+        self.assertEqual(len(step_phases), num_steps + 1)
+        k = num_steps - 1
+        self.assertAlmostEqual(values.atDouble(gtd.TimeKey(k).key()), k * dt)
+
+        def total_mass(k):
+            mass = values.atDouble(Actuator.SourceMassKey(k))
+            for actuator in self.jr_simulator.jr.actuators:
+                mass += values.atDouble(Actuator.MassKey(actuator.j, k))
+            return mass
+        self.assertAlmostEqual(total_mass(0), total_mass(k), places=12)
+        for actuator in self.jr_simulator.jr.actuators:
+            self.assertGreater(values.atDouble(Actuator.MassKey(actuator.j, k)),
+                               values.atDouble(Actuator.MassKey(actuator.j, 0)))
+
 
 if __name__ == "__main__":
     unittest.main()
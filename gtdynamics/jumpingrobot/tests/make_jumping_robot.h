@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  make_jumping_robot.h
+ * @brief The jumping robot and its actuators, used in the tests.
+ */
+
+#pragma once
+
+#include <boost/make_shared.hpp>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/jumpingrobot/utils/JRSimulator.h"
+#include "gtdynamics/universal_robot/RevoluteJoint.h"
+
+namespace gtdynamics {
+namespace jumping_robot_example {
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector3;
+
+// The robot of robot_config.yaml, standing with straight legs, as built by
+// JumpingRobot in jumping_robot.py.
+const double l = 0.55, r = 0.02;
+
+LinkSharedPtr MakeLink(int id, const std::string &name, double m,
+                       const Pose3 &pose) {
+  const double I = m * (3 * r * r + l * l) / 12;
+  const gtsam::Matrix3 inertia = Vector3(I, m * r * r / 2, I).asDiagonal();
+  const Pose3 bMcom = pose.compose(Pose3(Rot3(), Point3(0, l / 2, 0)));
+  return boost::make_shared<Link>(id, name, m, inertia, bMcom, pose);
+}
+
+Robot JumpingRobot(int phase) {
+  const double y = l / 2;
+  const Rot3 up = Rot3::Rx(M_PI / 2);
+  auto ground = boost::make_shared<Link>(0, "ground", 1, gtsam::I_3x3, Pose3(),
+                                         Pose3(), true);
+  auto shank_r = MakeLink(1, "shank_r", 0.285, Pose3(up, Point3(0, y, 0)));
+  auto thigh_r = MakeLink(2, "thigh_r", 0.428, Pose3(up, Point3(0, y, l)));
+  auto torso = MakeLink(3, "torso", 0.883, Pose3(Rot3(), Point3(0, -y, 2 * l)));
+  auto thigh_l = MakeLink(4, "thigh_l", 0.428, Pose3(up, Point3(0, -y, l)));
+  auto shank_l = MakeLink(5, "shank_l", 0.285, Pose3(up, Point3(0, -y, 0)));
+
+  const Vector3 axis_r(1, 0, 0), axis_l(-1, 0, 0);
+  auto joint = [](int id, const std::string &name, const Point3 &p,
+                  const LinkSharedPtr &parent, const LinkSharedPtr &child,
+                  const Vector3 &axis) -> JointSharedPtr {
+    return boost::make_shared<RevoluteJoint>(id, name, Pose3(Rot3(), p),
+                                             parent, child, axis);
+  };
+  auto foot_r = joint(0, "foot_r", Point3(0, y, 0), ground, shank_r, axis_r);
+  auto knee_r = joint(1, "knee_r", Point3(0, y, l), shank_r, thigh_r, axis_r);
+  auto hip_r = joint(2, "hip_r", Point3(0, y, 2 * l), thigh_r, torso, axis_r);
+  auto hip_l = joint(3, "hip_l", Point3(0, -y, 2 * l), thigh_l, torso, axis_l);
+  auto knee_l = joint(4, "knee_l", Point3(0, -y, l), shank_l, thigh_l, axis_l);
+  auto foot_l = joint(5, "foot_l", Point3(0, -y, 0), ground, shank_l, axis_l);
+
+  std::vector<LinkSharedPtr> links{shank_r, thigh_r, torso, thigh_l, shank_l};
+  std::vector<JointSharedPtr> joints{knee_r, hip_r, hip_l, knee_l};
+  if (phase != 3) links.push_back(ground);
+  if (phase == 0 || phase == 2) joints.push_back(foot_r);
+  if (phase == 0 || phase == 1) joints.push_back(foot_l);
+
+  LinkMap link_map;
+  JointMap joint_map;
+  for (auto &&link : links) link_map[link->name()] = link;
+  for (auto &&j : joints) {
+    j->parent()->addJoint(j);
+    j->child()->addJoint(j);
+    joint_map[j->name()] = j;
+  }
+  return Robot(link_map, joint_map);
+}
+
+std::vector<Robot> Robots() {
+  return {JumpingRobot(0), JumpingRobot(1), JumpingRobot(2), JumpingRobot(3)};
+}
+
+// The knee and hip actuators of robot_config.yaml.
+std::vector<JRActuatorParameters> Actuators() {
+  std::vector<JRActuatorParameters> actuators;
+  for (int j : {1, 2, 3, 4}) {
+    JRActuatorParameters actuator;
+    actuator.j = j;
+    const bool knee = j == 1 || j == 4;
+    actuator.k_anta = knee ? 2.1 : 2.5;
+    actuator.positive = !knee;
+    actuators.push_back(actuator);
+  }
+  return actuators;
+}
+}  // namespace jumping_robot_example
+}  // namespace gtdynamics
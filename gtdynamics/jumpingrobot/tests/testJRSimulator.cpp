@@ -0,0 +1,186 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testJRSimulator.cpp
+ *  @brief Tests for the jumping robot simulator.
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <boost/make_shared.hpp>
+#include <cmath>
+
+#include "gtdynamics/jumpingrobot/utils/JRSimulator.h"
+#include "gtdynamics/utils/values.h"
+#include "make_jumping_robot.h"
+
+using namespace gtdynamics;
+using gtsam::Point3, gtsam::Pose3, gtsam::Rot3, gtsam::Values,
+    gtsam::Vector3, gtsam::Vector6;
+
+namespace example {
+using namespace jumping_robot_example;
+
+Values InitialState() {
+  Values values;
+  for (int j = 0; j < 6; ++j) {
+    InsertJointAngle(&values, j, 0, 0.0);
+    InsertJointVel(&values, j, 0, 0.0);
+  }
+  InsertPose(&values, 3, 0, Pose3(Rot3(), Point3(0, 0, 2 * l)));
+  InsertTwist(&values, 3, 0, Vector6::Zero());
+  return values;
+}
+
+JRControls Controls(double To, double Tc) {
+  JRControls controls;
+  controls.Tos = gtsam::Vector4::Constant(To);
+  controls.Tcs = gtsam::Vector4::Constant(Tc);
+  controls.P_s_0 = 65 * 6894.76 / 1e3;
+  return controls;
+}
+}  // namespace example
+
+/// With the valves open, the source tank fills the actuators; air is
+/// neither lost nor created.
+TEST(JRSimulator, simulate) {
+  JRSimulator simulator(example::Robots(), example::Actuators(),
+                        example::InitialState());
+  const size_t num_steps = 10;
+  const double dt = 0.005;
+  const Values values =
+      simulator.simulate(num_steps, dt, example::Controls(0, 1));
+
+  EXPECT_LONGS_EQUAL(num_steps + 1, simulator.phases().size());
+  EXPECT_LONGS_EQUAL(0, simulator.phases().front());
+
+  auto total_mass = [&](int k) {
+    double m = values.at<double>(SourceMassKey(k));
+    for (int j : {1, 2, 3, 4}) m += values.at<double>(ActuatorMassKey(j, k));
+    return m;
+  };
+  const int last = num_steps - 1;
+  EXPECT_DOUBLES_EQUAL(last * dt, values.at<double>(TimeKey(last)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(total_mass(0), total_mass(last), 1e-12);
+  for (int j : {1, 2, 3, 4}) {
+    EXPECT(values.at<double>(ActuatorMassKey(j, last)) >
+           values.at<double>(ActuatorMassKey(j, 0)));
+    EXPECT(values.at<double>(MassRateActualKey(j, 0)) > 0);
+  }
+  EXPECT(values.at<double>(ActuatorPressureKey(1, last)) > 101.325);
+
+  // The simulator starts over for every simulation.
+  const Values again =
+      simulator.simulate(num_steps, dt, example::Controls(0, 1));
+  EXPECT(gtsam::assert_equal(values, again, 1e-9));
+}
+
+/// With the valves closed, no air flows.
+TEST(JRSimulator, closedValves) {
+  JRSimulator simulator(example::Robots(), example::Actuators(),
+                        example::InitialState());
+  const Values values = simulator.simulate(5, 0.005, example::Controls(1, 1));
+  for (int j : {1, 2, 3, 4})
+    EXPECT_DOUBLES_EQUAL(values.at<double>(ActuatorMassKey(j, 0)),
+                         values.at<double>(ActuatorMassKey(j, 4)), 1e-12);
+}
+
+/// Adaptive steps end at the duration, start each valve switch, and are
+/// small during it; the trajectory is close to one with small fixed steps.
+TEST(JRSimulator, simulateAdaptive) {
+  JRSimulatorParameters parameters;
+  parameters.adaptive.dt_max = 0.01;
+  JRSimulator simulator(example::Robots(), example::Actuators(),
+                        example::InitialState(), parameters);
+  const double duration = 0.05, To = 0.02;
+  const JRControls controls = example::Controls(To, 1);
+  const Values values = simulator.simulateAdaptive(duration, controls);
+
+  const int num_steps = simulator.phases().size() - 1;
+  const int last = num_steps - 1;
+  EXPECT_DOUBLES_EQUAL(duration, values.at<double>(TimeKey(last)), 1e-12);
+  EXPECT(num_steps < 50);
+
+  const double tau = parameters.pneumatic.time_constant_valve;
+  bool switch_start = false;
+  for (int k = 1; k <= last; ++k) {
+    const double t0 = values.at<double>(TimeKey(k - 1)),
+                 t1 = values.at<double>(TimeKey(k));
+    EXPECT(t1 > t0);
+    EXPECT(t1 - t0 <= parameters.adaptive.dt_max + 1e-12);
+    if (t0 >= To - 5 * tau - 1e-12 && t0 < To + 5 * tau - 1e-12)
+      EXPECT(t1 - t0 <= tau + 1e-12);
+    if (std::abs(t1 - (To - 5 * tau)) < 1e-12) switch_start = true;
+  }
+  EXPECT(switch_start);
+
+  // Air is conserved, as with fixed steps.
+  auto total_mass = [&](int k) {
+    double m = values.at<double>(SourceMassKey(k));
+    for (int j : {1, 2, 3, 4}) m += values.at<double>(ActuatorMassKey(j, k));
+    return m;
+  };
+  EXPECT_DOUBLES_EQUAL(total_mass(0), total_mass(last), 1e-12);
+
+  // Compare with 1 ms steps.
+  const double dt = 1e-3;
+  const int fixed_last = 50;
+  JRSimulator fixed(example::Robots(), example::Actuators(),
+                    example::InitialState());
+  const Values expected = fixed.simulate(fixed_last + 1, dt, controls);
+  for (int j : {1, 2, 3, 4})
+    EXPECT_DOUBLES_EQUAL(JointAngle(expected, j, fixed_last),
+                         JointAngle(values, j, last), 1e-3);
+}
+
+/// With the valves open the robot takes off, and the phase changes are
+/// recorded at the step where they are located.
+TEST(JRSimulator, events) {
+  JRSimulatorParameters parameters;
+  parameters.adaptive.event_tolerance = 1e-5;
+  JRSimulator simulator(example::Robots(), example::Actuators(),
+                        example::InitialState(), parameters);
+  const Values values =
+      simulator.simulateAdaptive(0.3, example::Controls(0, 1));
+  const std::vector<int> &phases = simulator.phases();
+  EXPECT(simulator.eventTimes().size() > 0);
+
+  size_t e = 0;
+  for (size_t k = 0; k + 1 < phases.size(); ++k) {
+    if (phases[k + 1] == phases[k]) continue;
+    if (e == simulator.eventTimes().size()) break;
+    EXPECT_DOUBLES_EQUAL(simulator.eventTimes()[e++],
+                         values.at<double>(TimeKey(k)), 1e-12);
+  }
+  EXPECT_LONGS_EQUAL(simulator.eventTimes().size(), e);
+}
+
+/// The robot is needed in each phase, and the valve times for each actuator.
+TEST(JRSimulator, arguments) {
+  THROWS_EXCEPTION(JRSimulator({example::JumpingRobot(0)},
+                               example::Actuators(), example::InitialState()));
+  JRSimulator simulator(example::Robots(), example::Actuators(),
+                        example::InitialState());
+  JRControls controls = example::Controls(0, 1);
+  controls.Tcs = gtsam::Vector2(1, 1);
+  THROWS_EXCEPTION(simulator.simulate(5, 0.005, controls));
+
+  JRSimulatorParameters parameters;
+  parameters.adaptive.dt_min = 0.1;
+  parameters.adaptive.dt_max = 0.01;
+  JRSimulator adaptive(example::Robots(), example::Actuators(),
+                       example::InitialState(), parameters);
+  THROWS_EXCEPTION(adaptive.simulateAdaptive(0.1, example::Controls(0, 1)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
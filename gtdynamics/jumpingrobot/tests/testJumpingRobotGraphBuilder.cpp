@@ -0,0 +1,168 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testJumpingRobotGraphBuilder.cpp
+ *  @brief Tests for the jumping robot trajectory graph builder.
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <cmath>
+
+#include "gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h"
+#include "gtdynamics/jumpingrobot/utils/JumpingRobotGraphBuilder.h"
+#include "gtdynamics/utils/values.h"
+#include "make_jumping_robot.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3, gtsam::Pose3, gtsam::Rot3, gtsam::Values,
+    gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+namespace example {
+using namespace jumping_robot_example;
+
+const JumpingRobotGraphBuilder builder(Robots(), Actuators());
+
+// Distinct values for all keys of a graph, by the type of the variable.
+Values SomeValues(const NonlinearFactorGraph &graph) {
+  Values values;
+  double x = 0.1;
+  for (gtsam::Key key : graph.keys()) {
+    x += 0.01;
+    const std::string label = DynamicsSymbol(key).label();
+    if (label == "p")
+      values.insert(key, Pose3(Rot3::Rx(x), Point3(0, x, 1 - x)));
+    else if (label == "V" || label == "A" || label == "F")
+      values.insert<Vector6>(key, x * Vector6::LinSpaced(6, -1, 1));
+    else
+      values.insert(key, label == "Pa" ? 100 + x : x);
+  }
+  return values;
+}
+
+// Same factors, in the same order: same keys, and the same errors.
+bool SameFactors(const NonlinearFactorGraph &expected,
+                 const NonlinearFactorGraph &actual) {
+  if (expected.size() != actual.size()) return false;
+  const Values values = SomeValues(expected);
+  for (size_t f = 0; f < expected.size(); ++f) {
+    if (expected.at(f)->keys() != actual.at(f)->keys()) return false;
+    const double error = expected.at(f)->error(values);
+    if (std::abs(error - actual.at(f)->error(values)) > 1e-9 * (1 + error))
+      return false;
+  }
+  return true;
+}
+}  // namespace example
+
+/// The re-keyed step graphs are those built one factor at a time, as in
+/// ActuationGraphBuilder and RobotGraphBuilder.
+TEST(JumpingRobotGraphBuilder, dynamicsGraph) {
+  using namespace example;
+  const int k = 5, phase = 1;
+  const JRPneumaticParameters pn;
+  auto gas_law_model = Isotropic::Sigma(1, 0.0001);
+
+  NonlinearFactorGraph expected;
+  expected.emplace_shared<GasLawFactor>(SourcePressureKey(k), SourceVolumeKey(),
+                                        SourceMassKey(k), gas_law_model,
+                                        pn.gas_constant);
+  for (auto &&a : Actuators()) {
+    const int j = a.j;
+    const gtsam::Key q_key = internal::JointAngleKey(j, k);
+    expected.emplace_shared<GasLawFactor>(
+        ActuatorPressureKey(j, k), ActuatorVolumeKey(j, k),
+        ActuatorMassKey(j, k), gas_law_model, pn.gas_constant);
+    expected.emplace_shared<ActuatorVolumeFactor>(
+        ActuatorVolumeKey(j, k), ContractionKey(j, k),
+        Isotropic::Sigma(1, 1e-7), pn.d_tube, pn.l_tube);
+    expected.emplace_shared<SmoothActuatorFactor>(
+        ContractionKey(j, k), ActuatorPressureKey(j, k),
+        ActuatorForceKey(j, k), Isotropic::Sigma(1, 0.01));
+    expected.emplace_shared<ForceBalanceFactor>(
+        ContractionKey(j, k), q_key, ActuatorForceKey(j, k),
+        Isotropic::Sigma(1, 0.001), a.k_tendon, a.radius, a.q_rest,
+        a.positive);
+    expected.emplace_shared<JointTorqueFactor>(
+        q_key, internal::JointVelKey(j, k), ActuatorForceKey(j, k),
+        internal::TorqueKey(j, k), Isotropic::Sigma(1, 0.01), a.q_anta_limit,
+        a.k_anta, a.radius, a.b, a.positive);
+  }
+  EXPECT(SameFactors(expected, builder.actuationGraph(k)));
+
+  // Phase 1 stands on the left foot.
+  const Robot &robot = builder.robot(phase);
+  const DynamicsGraph &graph_builder = builder.graphBuilder();
+  NonlinearFactorGraph expected_robot =
+      graph_builder.dynamicsFactorGraph(robot, k);
+  expected_robot.addPrior<double>(
+      internal::TorqueKey(robot.joint("foot_l")->id(), k), 0.0,
+      graph_builder.opt().t_cost_model);
+  EXPECT(SameFactors(expected_robot, builder.robotGraph(phase, k)));
+
+  expected.push_back(expected_robot);
+  EXPECT(SameFactors(expected, builder.dynamicsGraph(phase, k)));
+}
+
+/// Mass flow factors of all actuators, with the valve times of the jump.
+TEST(JumpingRobotGraphBuilder, massFlowGraph) {
+  const NonlinearFactorGraph graph = example::builder.massFlowGraph(4);
+  EXPECT_LONGS_EQUAL(8, graph.size());
+  const gtsam::KeySet keys = graph.keys();
+  for (int j : {1, 2, 3, 4}) {
+    EXPECT(keys.count(ValveOpenTimeKey(j)));
+    EXPECT(keys.count(ValveCloseTimeKey(j)));
+    EXPECT(keys.count(MassRateActualKey(j, 4)));
+  }
+  EXPECT(keys.count(SourcePressureKey(4)));
+  EXPECT(keys.count(TimeKey(4)));
+}
+
+/// Joints are collocated only in the air, the torso, mass and time always.
+TEST(JumpingRobotGraphBuilder, collocationGraph) {
+  const NonlinearFactorGraph graph =
+      example::builder.collocationGraph({0, 0, 3, 3});
+  // Per interval: 4 actuator masses, source mass, torso pose and twist, time;
+  // in the air, angles and velocities of 4 joints.
+  EXPECT_LONGS_EQUAL(4 * 8 + 2 * 8, graph.size());
+  const gtsam::KeySet keys = graph.keys();
+  EXPECT(keys.count(PhaseKey(0)));
+  EXPECT(keys.count(PhaseKey(3)));
+  EXPECT(!keys.count(PhaseKey(1)));
+  const int hip_r = example::builder.robot(3).joint("hip_r")->id();
+  EXPECT(!keys.count(internal::JointAngleKey(hip_r, 1)));
+  EXPECT(keys.count(internal::JointAngleKey(hip_r, 2)));
+  EXPECT(keys.count(internal::JointAccelKey(hip_r, 4)));
+  EXPECT(keys.count(SourceMassKey(4)));
+  EXPECT(keys.count(TimeKey(4)));
+}
+
+/// A trajectory is the dynamics of every step in its phase, and the
+/// collocation factors between steps.
+TEST(JumpingRobotGraphBuilder, trajectoryGraph) {
+  using namespace example;
+  const std::vector<int> step_phases{0, 3};
+  NonlinearFactorGraph expected = builder.dynamicsGraph(0, 0);
+  expected.push_back(builder.dynamicsGraph(0, 1));
+  expected.push_back(builder.dynamicsGraph(3, 2));
+  expected.push_back(builder.collocationGraph(step_phases));
+  EXPECT(SameFactors(expected, builder.trajectoryGraph(step_phases)));
+
+  THROWS_EXCEPTION(builder.trajectoryGraph({}));
+  THROWS_EXCEPTION(JumpingRobotGraphBuilder({JumpingRobot(0)}, Actuators()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ *  @file testPneumaticActuatorModel.cpp
+ *  @brief Tests for the pneumatic muscle as an actuator model.
+ **/
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "gtdynamics/jumpingrobot/utils/PneumaticActuatorModel.h"
+
+using namespace gtdynamics;
+using gtsam::noiseModel::Unit;
+
+namespace example {
+const JRActuatorParameters actuator;
+const JRPneumaticParameters pneumatic;
+const double source_pressure = 400;  // kPa
+}  // namespace example
+
+// At rest the muscle holds air at 1 atm, is not contracted and pulls not.
+TEST(PneumaticActuatorModel, rest) {
+  using namespace example;
+  const PneumaticActuatorModel model(actuator, pneumatic, source_pressure);
+  const gtsam::Vector x = model.initialState();
+  EXPECT_DOUBLES_EQUAL(pneumatic.init_mass, x(0), 1e-15);
+  EXPECT_DOUBLES_EQUAL(0, x(1), 1e-6);
+  EXPECT_DOUBLES_EQUAL(101.325, model.pressure(x(0), x(1)), 1e-2);
+  EXPECT_DOUBLES_EQUAL(0, model.torque(x, actuator.q_rest, 0), 1e-6);
+
+  // With the valve closed, the air mass does not change.
+  gtsam::Vector closed = x;
+  model.step(1e-3, 0, actuator.q_rest, 0, &closed);
+  EXPECT(gtsam::assert_equal(x, closed, 1e-12));
+}
+
+// With the valve open, air flows in and the muscle pulls on the tendon.
+TEST(PneumaticActuatorModel, inflate) {
+  using namespace example;
+  const PneumaticActuatorModel model(actuator, pneumatic, source_pressure);
+  EXPECT(model.massFlow(101.325) > 0);
+  EXPECT(model.massFlow(500) < 0);
+  EXPECT_DOUBLES_EQUAL(0, model.massFlow(source_pressure), 1e-15);
+
+  gtsam::Vector x = model.initialState();
+  const double q = actuator.q_rest;
+  for (size_t s = 0; s < 10; ++s) model.step(1e-4, 1, q, 0, &x);
+  EXPECT(x(0) > pneumatic.init_mass);
+  const double p = model.pressure(x(0), x(1));
+  EXPECT(p > 101.325 && p < source_pressure);
+
+  // The contraction balances the muscle and tendon forces.
+  const SmoothActuatorFactor force(0, 1, 2, Unit::Create(1));
+  const ForceBalanceFactor balance(0, 1, 2, Unit::Create(1),
+                                   actuator.k_tendon, actuator.radius,
+                                   actuator.q_rest, actuator.positive);
+  const double f = force.evaluateError(x(1), p, 0.0)(0);
+  EXPECT(f > 0);
+  EXPECT_DOUBLES_EQUAL(f, balance.evaluateError(x(1), q, 0.0)(0), 1e-6);
+
+  // Contraction pulls the joint in the negative direction.
+  EXPECT_DOUBLES_EQUAL(-actuator.radius * f, model.torque(x, q, 0), 1e-6);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
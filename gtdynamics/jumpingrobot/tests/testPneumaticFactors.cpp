@@ -22,6 +22,7 @@
 #include <gtsam/nonlinear/factorTesting.h>
 #include <gtsam/slam/PriorFactor.h>
 
+#include <cmath>
 #include <iostream>
 
 #include "gtdynamics/jumpingrobot/factors/PneumaticFactors.h"
@@ -122,6 +123,40 @@ TEST(MassFlowRateFactor, Negative) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
 }
 
+/// The tabulated friction factor gives the mass flow within 1e-6 relative
+/// error, with Jacobians of the interpolant, and is exact off the table.
+TEST(MassFlowRateFactor, Tabulated) {
+  double D = 0.1575 * 0.0254;
+  double L = 74 * 0.0254;
+  double mu = 1.8377e-5;
+  double epsilon = 1e-5;
+  double k = 1. / (287.0550 * 296.15);
+  MassFlowRateFactor exact(example::pa_key, example::ps_key,
+                           example::mdot_key, Isotropic::Sigma(1, 0.001), D,
+                           L, mu, epsilon, k);
+  MassFlowRateFactor tabulated(example::pa_key, example::ps_key,
+                               example::mdot_key, Isotropic::Sigma(1, 0.001),
+                               D, L, mu, epsilon, k, true);
+
+  double pa = 100, ps = 65.0 * 6.89476;
+  for (double mdot : {2e-6, -3.7e-5, 1.234e-4, 5e-4, -2e-3, 1e-2, 0.3}) {
+    double expected = exact.computeExpectedMassFlow(pa, ps, mdot);
+    double actual = tabulated.computeExpectedMassFlow(pa, ps, mdot);
+    EXPECT_DOUBLES_EQUAL(expected, actual, 1e-6 * std::abs(expected));
+
+    Values values;
+    values.insert(example::pa_key, pa);
+    values.insert(example::ps_key, ps);
+    values.insert(example::mdot_key, mdot);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(tabulated, values,
+                                    1e-4 * std::abs(mdot), 1e-3);
+  }
+
+  // Below the table, the exact formula is used.
+  EXPECT_DOUBLES_EQUAL(exact.computeExpectedMassFlow(pa, ps, 1e-7),
+                       tabulated.computeExpectedMassFlow(pa, ps, 1e-7), 1e-15);
+}
+
 TEST(ValveControlFactor, Factor) {
   double t = 0.8;
   double to = 0.7;
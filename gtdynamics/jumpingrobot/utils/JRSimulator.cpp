@@ -0,0 +1,566 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JRSimulator.cpp
+ * @brief Simulation of the jumping robot, with the actuation and robot
+ * dynamics graphs of one time step built once and solved at every step.
+ */
+
+#include "JRSimulator.h"
+
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/utils/values.h>
+
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+using gtsam::noiseModel::Isotropic;
+
+namespace gtdynamics {
+
+using internal::JointAngleKey;
+using internal::JointVelKey;
+using internal::PoseKey;
+using internal::TorqueKey;
+using internal::TwistKey;
+
+/* ************************************************************************* */
+OptimizerSetting JROptimizerSetting() {
+  OptimizerSetting opt(0.001, 0.001, 0.001, 0.001, 0.001, 0.0001);
+  opt.f_cost_model = Isotropic::Sigma(6, 0.01);
+  opt.fa_cost_model = Isotropic::Sigma(6, 0.01);
+  opt.t_cost_model = Isotropic::Sigma(1, 0.01);
+  opt.pose_col_cost_model = Isotropic::Sigma(6, 0.001);
+  opt.twist_col_cost_model = Isotropic::Sigma(6, 0.001);
+  return opt;
+}
+
+static bool Contains(const KeyVector &keys, Key key) {
+  return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+/* ************************************************************************* */
+JRSimulator::JRSimulator(const std::vector<Robot> &robots,
+                         const std::vector<JRActuatorParameters> &actuators,
+                         const Values &initial_state,
+                         const JRSimulatorParameters &parameters)
+    : robots_(robots),
+      actuators_(actuators),
+      initial_state_(initial_state),
+      p_(parameters),
+      graph_builder_(JROptimizerSetting(), p_.gravity, p_.planar_axis),
+      prior_q_model_(Isotropic::Sigma(1, 0.001)),
+      prior_v_model_(Isotropic::Sigma(1, 0.001)),
+      prior_m_model_(Isotropic::Sigma(1, 1e-7)),
+      flow_prior_model_(Isotropic::Sigma(1, 0.1)) {
+  if (robots_.size() != 4)
+    throw std::invalid_argument(
+        "JRSimulator: need the robot in each of the 4 phases.");
+  torso_ = robots_[0].link("torso")->id();
+
+  // Actuator and mass flow graphs, with the models of ActuationGraphBuilder.
+  const JRPneumaticParameters &pn = p_.pneumatic;
+  auto gas_law_model = Isotropic::Sigma(1, 0.0001),
+       volume_model = Isotropic::Sigma(1, 1e-7),
+       force_model = Isotropic::Sigma(1, 0.01),
+       balance_model = Isotropic::Sigma(1, 0.001),
+       torque_model = Isotropic::Sigma(1, 0.01),
+       mass_rate_model = Isotropic::Sigma(1, 1e-5);
+  for (auto &&a : actuators_) {
+    const int j = a.j;
+    // Factor 1 is the ActuatorVolumeFactor, used for the initial volume.
+    NonlinearFactorGraph dynamics;
+    dynamics.emplace_shared<GasLawFactor>(
+        ActuatorPressureKey(j), ActuatorVolumeKey(j), ActuatorMassKey(j),
+        gas_law_model, pn.gas_constant);
+    dynamics.emplace_shared<ActuatorVolumeFactor>(
+        ActuatorVolumeKey(j), ContractionKey(j), volume_model, pn.d_tube,
+        pn.l_tube);
+    dynamics.emplace_shared<SmoothActuatorFactor>(
+        ContractionKey(j), ActuatorPressureKey(j), ActuatorForceKey(j),
+        force_model);
+    dynamics.emplace_shared<ForceBalanceFactor>(
+        ContractionKey(j), JointAngleKey(j), ActuatorForceKey(j),
+        balance_model, a.k_tendon, a.radius, a.q_rest, a.positive);
+    dynamics.emplace_shared<JointTorqueFactor>(
+        JointAngleKey(j), JointVelKey(j), ActuatorForceKey(j), TorqueKey(j),
+        torque_model, a.q_anta_limit, a.k_anta, a.radius, a.b, a.positive);
+
+    NonlinearFactorGraph flow;
+    flow.emplace_shared<MassFlowRateFactor>(
+        ActuatorPressureKey(j), SourcePressureKey(), MassRateOpenKey(j),
+        mass_rate_model, pn.d_tube, pn.l_tube, pn.mu_tube, pn.eps_tube,
+        1.0 / pn.gas_constant, p_.tabulated_mass_flow);
+
+    ValveControlFactor valve(TimeKey(0), ValveOpenTimeKey(j),
+                             ValveCloseTimeKey(j), MassRateOpenKey(j),
+                             MassRateActualKey(j), mass_rate_model,
+                             pn.time_constant_valve);
+    actuator_graphs_.push_back({makeLayer(dynamics), makeLayer(flow), valve});
+  }
+
+  // Robot graphs by layer, for each phase.
+  for (auto &&robot : robots_) {
+    PhaseGraphs graphs;
+    graphs.q = makeLayer(graph_builder_.qFactors(robot, 0));
+    graphs.v = makeLayer(graph_builder_.vFactors(robot, 0));
+    NonlinearFactorGraph dynamics = graph_builder_.aFactors(robot, 0);
+    dynamics.push_back(graph_builder_.dynamicsFactors(robot, 0));
+    graphs.dynamics = makeLayer(dynamics);
+
+    gtsam::KeySet keys;
+    for (const Layer *layer : {&graphs.q, &graphs.v, &graphs.dynamics})
+      keys.insert(layer->keys.begin(), layer->keys.end());
+    graphs.keys.assign(keys.begin(), keys.end());
+
+    graphs.grounded = false;
+    for (auto &&link : robot.links())
+      if (link->name() == "ground") graphs.grounded = true;
+    phase_graphs_.push_back(graphs);
+  }
+}
+
+/* ************************************************************************* */
+JRSimulator::Layer JRSimulator::makeLayer(
+    const NonlinearFactorGraph &graph) const {
+  // The priors of each step are on variables of the graph, and do not change
+  // its structure, so order it once.
+  Layer layer;
+  layer.graph = graph;
+  layer.num_factors = graph.size();
+  const gtsam::KeySet keys = graph.keys();
+  layer.keys.assign(keys.begin(), keys.end());
+  layer.ordering = gtsam::Ordering::Colamd(graph);
+  return layer;
+}
+
+/* ************************************************************************* */
+Values JRSimulator::solve(const Layer &layer, const Values &init,
+                          const char *what, int k) const {
+  Values values;
+  for (Key key : layer.keys) values.insert(key, init.at(key));
+  gtsam::LevenbergMarquardtParams lm = p_.lm;
+  lm.setOrdering(layer.ordering);
+  const Values result =
+      gtsam::LevenbergMarquardtOptimizer(layer.graph, values, lm).optimize();
+  if (layer.graph.error(result) > p_.tolerance)
+    throw std::runtime_error(std::string("JRSimulator: ") + what +
+                             " didn't converge at time step " +
+                             std::to_string(k) + ".");
+  return result;
+}
+
+/* ************************************************************************* */
+Values JRSimulator::stepValues(const KeyVector &keys, int k,
+                               const Values &defaults) const {
+  // Time indices are the low bits of the keys, so adding k shifts the keys.
+  Values values;
+  for (Key key : keys) {
+    if (x_.exists(key + k))
+      values.insert(key, x_.at(key + k));
+    else if (k > 0)
+      values.insert(key, x_.at(key + k - 1));
+    else
+      values.insert(key, defaults.at(key));
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+void JRSimulator::reset(const JRControls &controls) {
+  const size_t n = actuators_.size();
+  if (size_t(controls.Tos.size()) != n || size_t(controls.Tcs.size()) != n)
+    throw std::invalid_argument(
+        "JRSimulator: need a valve open and close time per actuator.");
+
+  // Initial values, as JRValues.init_config_values.
+  const JRPneumaticParameters &pn = p_.pneumatic;
+  x_ = initial_state_;
+  x_.insert(SourceVolumeKey(), pn.v_source);
+  x_.insert(SourceMassKey(0),
+            pn.v_source * controls.P_s_0 * 1e3 / pn.gas_constant);
+  x_.insert(SourcePressureKey(0), controls.P_s_0);
+  for (size_t i = 0; i < n; ++i) {
+    const int j = actuators_[i].j;
+    x_.insert(ActuatorMassKey(j, 0), pn.init_mass);
+    x_.insert(ValveOpenTimeKey(j), controls.Tos(i));
+    x_.insert(ValveCloseTimeKey(j), controls.Tcs(i));
+  }
+  x_.insert(TimeKey(0), 0.0);
+
+  phase_ = 0;
+  phases_ = {phase_};
+  event_times_.clear();
+}
+
+/* ************************************************************************* */
+Values JRSimulator::simulate(size_t num_steps, double dt,
+                             const JRControls &controls) {
+  reset(controls);
+  for (size_t k = 0; k < num_steps; ++k) {
+    if (k > 0) integrate(k, dt);
+    stepActuation(k);
+    stepRobotDynamics(k);
+    const int phase = stepPhaseChange(k);
+    if (phase != phase_) event_times_.push_back(x_.at<double>(TimeKey(k)));
+    phase_ = phase;
+    phases_.push_back(phase_);
+  }
+  return x_;
+}
+
+/* ************************************************************************* */
+Values JRSimulator::simulateAdaptive(double duration,
+                                     const JRControls &controls) {
+  const JRAdaptiveStepParameters &s = p_.adaptive;
+  if (s.dt_min <= 0 || s.dt_min > s.dt_max || s.error_tolerance <= 0 ||
+      s.event_tolerance <= 0)
+    throw std::invalid_argument(
+        "JRSimulator: need 0 < dt_min <= dt_max and positive tolerances.");
+  reset(controls);
+  stepActuation(0);
+  stepRobotDynamics(0);
+  phase_ = stepPhaseChange(0);
+  if (phase_ != 0) event_times_.push_back(0.0);
+  phases_.push_back(phase_);
+
+  double dt = std::min(std::max(s.dt_initial, s.dt_min), s.dt_max);
+  for (int k = 1;; ++k) {
+    const double t = x_.at<double>(TimeKey(k - 1));
+    if (t >= duration - 1e-12) break;
+    double h = std::min(valveStep(t, dt), duration - t);
+
+    // Error estimates and event locations compare with the previous step,
+    // which needs the same phase.
+    const bool smooth = phases_[k - 1] == phase_;
+    step(k, h);
+    double error = smooth ? integrationError(k, h) : 0;
+    while (error > s.error_tolerance && h > s.dt_min) {
+      h = std::max(s.dt_min,
+                   h * std::max(0.2, 0.9 * std::cbrt(s.error_tolerance /
+                                                     error)));
+      step(k, h);
+      error = integrationError(k, h);
+    }
+    const double growth =
+        error > 0 ? std::min(2.0, 0.9 * std::cbrt(s.error_tolerance / error))
+                  : 2.0;
+    dt = std::min(std::max(h * growth, s.dt_min), s.dt_max);
+
+    if (smooth) {
+      const double force = contactForce(k);
+      if (force < 0) {
+        const double force_0 = contactForce(k - 1);
+        if (force_0 >= 0) locateEvent(k, h, force_0, force);
+      }
+    }
+
+    const int phase = stepPhaseChange(k);
+    if (phase != phase_) event_times_.push_back(x_.at<double>(TimeKey(k)));
+    phase_ = phase;
+    phases_.push_back(phase_);
+  }
+  return x_;
+}
+
+/* ************************************************************************* */
+void JRSimulator::step(int k, double dt) {
+  for (Key key : x_.keys())
+    if (DynamicsSymbol(key).time() == uint64_t(k)) x_.erase(key);
+  integrate(k, dt);
+  stepActuation(k);
+  stepRobotDynamics(k);
+}
+
+/* ************************************************************************* */
+double JRSimulator::valveStep(double t, double dt) const {
+  // The valve opens or closes over about 5 time constants on either side of
+  // the switch time, as the sigmoid of ValveControlFactor.
+  const JRAdaptiveStepParameters &s = p_.adaptive;
+  const double tau = p_.pneumatic.time_constant_valve, window = 5 * tau;
+  for (auto &&a : actuators_) {
+    for (Key key : {Key(ValveOpenTimeKey(a.j)), Key(ValveCloseTimeKey(a.j))}) {
+      const double start = x_.at<double>(key) - window,
+                   end = x_.at<double>(key) + window;
+      if (t < start - 1e-12)
+        dt = std::min(dt, start - t);
+      else if (t < end - 1e-12)
+        dt = std::min(dt, std::max(tau, s.dt_min));
+    }
+  }
+  return dt;
+}
+
+/* ************************************************************************* */
+double JRSimulator::integrationError(int k, double dt) const {
+  // integrate keeps the accelerations constant over a step, which misses the
+  // third-order term jerk * dt^3 / 6, with the jerk from the change of the
+  // accelerations over the step.
+  double change = 0;
+  for (auto &&joint : robots_[phase_].joints()) {
+    const int j = joint->id();
+    change = std::max(change, std::abs(JointAccel(x_, j, k) -
+                                       JointAccel(x_, j, k - 1)));
+  }
+  const Vector6 accel_change =
+      TwistAccel(x_, torso_, k) - TwistAccel(x_, torso_, k - 1);
+  change = std::max(change, accel_change.cwiseAbs().maxCoeff());
+  return change * dt * dt / 6;
+}
+
+/* ************************************************************************* */
+double JRSimulator::locateEvent(int k, double dt, double h_0, double h) {
+  // Safeguarded secant on the step size: the bracket [lo, hi] shrinks by at
+  // least a tenth at every iteration, with the force negative at hi.
+  double lo = 0, hi = dt, h_lo = h_0, h_hi = h, last = dt;
+  while (hi - lo > p_.adaptive.event_tolerance) {
+    const double margin = 0.1 * (hi - lo);
+    const double secant = hi - h_hi * (hi - lo) / (h_hi - h_lo);
+    last = std::min(std::max(secant, lo + margin), hi - margin);
+    step(k, last);
+    const double force = contactForce(k);
+    if (force < 0) {
+      hi = last;
+      h_hi = force;
+    } else {
+      lo = last;
+      h_lo = force;
+    }
+  }
+  if (last != hi) step(k, hi);
+  return hi;
+}
+
+/* ************************************************************************* */
+double JRSimulator::contactForce(int k) const {
+  double force = std::numeric_limits<double>::infinity();
+  if (phase_ == 0 || phase_ == 1) force = std::min(force, groundForceZ("l", k));
+  if (phase_ == 0 || phase_ == 2) force = std::min(force, groundForceZ("r", k));
+  return force;
+}
+
+/* ************************************************************************* */
+void JRSimulator::integrate(int k, double dt) {
+  for (auto &&joint : robots_[phase_].joints()) {
+    const int j = joint->id();
+    const double q = JointAngle(x_, j, k - 1), v = JointVel(x_, j, k - 1),
+                 a = JointAccel(x_, j, k - 1);
+    InsertJointAngle(&x_, j, k, q + v * dt + 0.5 * a * dt * dt);
+    InsertJointVel(&x_, j, k, v + a * dt);
+  }
+
+  const Pose3 pose = Pose(x_, torso_, k - 1);
+  const Vector6 twist = Twist(x_, torso_, k - 1),
+                accel = TwistAccel(x_, torso_, k - 1);
+  InsertPose(&x_, torso_, k,
+             pose.compose(Pose3::Expmap(dt * twist + 0.5 * dt * dt * accel)));
+  InsertTwist(&x_, torso_, k, twist + dt * accel);
+
+  double m_out = 0;
+  for (auto &&a : actuators_) {
+    const double mdot = x_.at<double>(MassRateActualKey(a.j, k - 1));
+    x_.insert(ActuatorMassKey(a.j, k),
+              x_.at<double>(ActuatorMassKey(a.j, k - 1)) + mdot * dt);
+    m_out += mdot * dt;
+  }
+  x_.insert(SourceMassKey(k), x_.at<double>(SourceMassKey(k - 1)) - m_out);
+  x_.insert(TimeKey(k), x_.at<double>(TimeKey(k - 1)) + dt);
+}
+
+/* ************************************************************************* */
+void JRSimulator::stepActuation(int k) {
+  // The source pressure follows directly from the gas law.
+  const JRPneumaticParameters &pn = p_.pneumatic;
+  if (!x_.exists(SourcePressureKey(k)))
+    x_.insert(SourcePressureKey(k), x_.at<double>(SourceMassKey(k)) *
+                                        pn.gas_constant /
+                                        x_.at<double>(SourceVolumeKey()) /
+                                        1e3);
+  const double P_s = x_.at<double>(SourcePressureKey(k));
+  const double t = x_.at<double>(TimeKey(k));
+
+  for (size_t i = 0; i < actuators_.size(); ++i) {
+    const int j = actuators_[i].j;
+    ActuatorGraphs &graphs = actuator_graphs_[i];
+
+    // Actuator dynamics, from the air mass and the joint state.
+    Layer &dynamics = graphs.dynamics;
+    dynamics.graph.resize(dynamics.num_factors);
+    dynamics.graph.addPrior<double>(
+        ActuatorMassKey(j), x_.at<double>(ActuatorMassKey(j, k)),
+        prior_m_model_);
+    dynamics.graph.addPrior<double>(JointAngleKey(j), JointAngle(x_, j, k),
+                                    prior_q_model_);
+    dynamics.graph.addPrior<double>(JointVelKey(j), JointVel(x_, j, k),
+                                    prior_v_model_);
+    Values defaults;
+    if (k == 0) {
+      // The initial configuration of the muscle: at rest, at 1 atm.
+      defaults.insert(ActuatorPressureKey(j), 101.325);
+      defaults.insert(ContractionKey(j), 0.0);
+      defaults.insert(ActuatorForceKey(j), 0.0);
+      defaults.insert(TorqueKey(j), 0.0);
+      const auto volume = boost::static_pointer_cast<ActuatorVolumeFactor>(
+          dynamics.graph.at(1));
+      defaults.insert(ActuatorVolumeKey(j), volume->computeVolume(0.0));
+    }
+    const Values result = solve(
+        dynamics, stepValues(dynamics.keys, k, defaults), "actuator dynamics",
+        k);
+    for (auto &&key_value : result)
+      if (!x_.exists(key_value.key + k))
+        x_.insert(key_value.key + k, key_value.value);
+
+    // Mass flow into the actuator, then through the valve.
+    const double P_a = x_.at<double>(ActuatorPressureKey(j, k));
+    Layer &flow = graphs.flow;
+    flow.graph.resize(flow.num_factors);
+    flow.graph.addPrior<double>(ActuatorPressureKey(j), P_a,
+                                flow_prior_model_);
+    flow.graph.addPrior<double>(SourcePressureKey(), P_s, flow_prior_model_);
+    Values init;
+    init.insert(ActuatorPressureKey(j), P_a);
+    init.insert(SourcePressureKey(), P_s);
+    init.insert(MassRateOpenKey(j), 0.007);
+    const double mdot =
+        solve(flow, init, "mass flow", k).at<double>(MassRateOpenKey(j));
+    const double mdot_sigma = graphs.valve.computeExpectedTrueMassFlow(
+        t, x_.at<double>(ValveOpenTimeKey(j)),
+        x_.at<double>(ValveCloseTimeKey(j)), mdot);
+    x_.insert(MassRateOpenKey(j, k), mdot);
+    x_.insert(MassRateActualKey(j, k), mdot_sigma);
+  }
+}
+
+/* ************************************************************************* */
+void JRSimulator::stepRobotDynamics(int k) {
+  const Robot &robot = robots_[phase_];
+  PhaseGraphs &graphs = phase_graphs_[phase_];
+  const OptimizerSetting &opt = graph_builder_.opt();
+
+  // At the first step, start from forward kinematics with zero unknowns.
+  Values defaults;
+  if (k == 0) {
+    const Values fk =
+        graphs.grounded ? robot.forwardKinematics(x_, 0)
+                        : robot.forwardKinematics(x_, 0, std::string("torso"));
+    for (auto &&link : robot.links()) {
+      const int i = link->id();
+      InsertPose(&defaults, i, 0, Pose(fk, i, 0));
+      InsertTwist(&defaults, i, 0, Twist(fk, i, 0));
+      InsertTwistAccel(&defaults, i, 0, Vector6::Zero());
+    }
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&defaults, j, 0, 0.0);
+      InsertJointVel(&defaults, j, 0, 0.0);
+      InsertJointAccel(&defaults, j, 0, 0.0);
+      InsertTorque(&defaults, j, 0, 0.0);
+      InsertWrench(&defaults, joint->parent()->id(), j, 0, Vector6::Zero());
+      InsertWrench(&defaults, joint->child()->id(), j, 0, Vector6::Zero());
+    }
+  }
+  Values init = stepValues(graphs.keys, k, defaults);
+
+  // q level, from the torso pose, and the joint angles when in the air.
+  Layer &q = graphs.q;
+  q.graph.resize(q.num_factors);
+  q.graph.addPrior(PoseKey(torso_), Pose(x_, torso_, k), opt.p_cost_model);
+  if (!graphs.grounded)
+    for (auto &&joint : robot.joints())
+      q.graph.addPrior<double>(JointAngleKey(joint->id()),
+                               JointAngle(x_, joint->id(), k),
+                               opt.prior_q_cost_model);
+  init.update(solve(q, init, "robot q level", k));
+
+  // v level, from the torso twist, and the joint velocities when in the air.
+  Layer &v = graphs.v;
+  v.graph.resize(v.num_factors);
+  v.graph.addPrior(TwistKey(torso_), Twist(x_, torso_, k), opt.v_cost_model);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    v.graph.addPrior<double>(JointAngleKey(j), JointAngle(init, j),
+                             opt.prior_q_cost_model);
+    if (!graphs.grounded)
+      v.graph.addPrior<double>(JointVelKey(j), JointVel(x_, j, k),
+                               opt.prior_qv_cost_model);
+  }
+  init.update(solve(v, init, "robot v level", k));
+
+  // Accelerations and wrenches, from the state and the torques.
+  Layer &dynamics = graphs.dynamics;
+  dynamics.graph.resize(dynamics.num_factors);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    dynamics.graph.addPrior<double>(JointAngleKey(j), JointAngle(init, j),
+                                    opt.prior_q_cost_model);
+    dynamics.graph.addPrior<double>(JointVelKey(j), JointVel(init, j),
+                                    opt.prior_qv_cost_model);
+    dynamics.graph.addPrior<double>(TorqueKey(j), Torque(init, j),
+                                    opt.prior_t_cost_model);
+  }
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    if (Contains(dynamics.keys, PoseKey(i)))
+      dynamics.graph.addPrior(PoseKey(i), Pose(init, i), opt.p_cost_model);
+    if (Contains(dynamics.keys, TwistKey(i)))
+      dynamics.graph.addPrior(TwistKey(i), Twist(init, i), opt.v_cost_model);
+  }
+  init.update(solve(dynamics, init, "robot dynamics", k));
+
+  for (auto &&key_value : init) {
+    const Key key = key_value.key + k;
+    if (x_.exists(key))
+      x_.update(key, key_value.value);
+    else
+      x_.insert(key, key_value.value);
+  }
+}
+
+/* ************************************************************************* */
+double JRSimulator::groundForceZ(const std::string &side, int k) const {
+  const Robot &robot = robots_[phase_];
+  const int i = robot.link("shank_" + side)->id();
+  const int j = robot.joint("foot_" + side)->id();
+  const Pose3 wTb = Pose(x_, i, k);
+  const Vector6 wrench_w =
+      wTb.inverse().AdjointMap().transpose() * Wrench(x_, i, j, k);
+  return wrench_w(5);
+}
+
+/* ************************************************************************* */
+int JRSimulator::stepPhaseChange(int k) const {
+  // Event-driven, as in Brogliato02amr_simulating_non_smooth: a foot leaves
+  // the ground when its contact force would pull.
+  const double threshold = 0;
+  if (phase_ == 0) {
+    const bool left = groundForceZ("l", k) < threshold,
+               right = groundForceZ("r", k) < threshold;
+    if (left && right) return 3;
+    if (left) return 2;
+    if (right) return 1;
+  } else if (phase_ == 1) {
+    if (groundForceZ("l", k) < threshold) return 3;
+  } else if (phase_ == 2) {
+    if (groundForceZ("r", k) < threshold) return 3;
+  }
+  return phase_;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,302 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JRSimulator.h
+ * @brief Simulation of the jumping robot, with the actuation and robot
+ * dynamics graphs of one time step built once and solved at every step.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+#include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/DynamicsSymbol.h>
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/* Shorthand for Pa_j_k, for the air pressure in actuator j at time step k. */
+constexpr DynamicsSymbol ActuatorPressureKey(int j, int k = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('P', 'a'), j, k);
+}
+
+/* Shorthand for Ps_k, for the air pressure in the source tank at step k. */
+constexpr DynamicsSymbol SourcePressureKey(int k = 0) {
+  return DynamicsSymbol::SimpleSymbol(DynamicsLabel('P', 's'), k);
+}
+
+/* Shorthand for dx_j_k, for the contraction of actuator j at step k. */
+constexpr DynamicsSymbol ContractionKey(int j, int k = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('d', 'x'), j, k);
+}
+
+/* Shorthand for fa_j_k, for the force of actuator j at time step k. */
+constexpr DynamicsSymbol ActuatorForceKey(int j, int k = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('f', 'a'), j, k);
+}
+
+/* Shorthand for ma_j_k, for the air mass in actuator j at time step k. */
+constexpr DynamicsSymbol ActuatorMassKey(int j, int k = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('m', 'a'), j, k);
+}
+
+/* Shorthand for ms_k, for the air mass in the source tank at time step k. */
+constexpr DynamicsSymbol SourceMassKey(int k = 0) {
+  return DynamicsSymbol::SimpleSymbol(DynamicsLabel('m', 's'), k);
+}
+
+/* Shorthand for mo_j_k, for the mass flow into actuator j at step k if its
+ * valve were open. */
+constexpr DynamicsSymbol MassRateOpenKey(int j, int k = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('m', 'o'), j, k);
+}
+
+/* Shorthand for md_j_k, for the actual mass flow into actuator j at step k. */
+constexpr DynamicsSymbol MassRateActualKey(int j, int k = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('m', 'd'), j, k);
+}
+
+/* Shorthand for Va_j_k, for the volume of actuator j at time step k. */
+constexpr DynamicsSymbol ActuatorVolumeKey(int j, int k = 0) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('V', 'a'), j, k);
+}
+
+/* Shorthand for Vs, for the volume of the source tank. */
+constexpr DynamicsSymbol SourceVolumeKey() {
+  return DynamicsSymbol::SimpleSymbol(DynamicsLabel('V', 's'), 0);
+}
+
+/* Shorthand for To_j, for the valve open time of actuator j. */
+constexpr DynamicsSymbol ValveOpenTimeKey(int j) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('T', 'o'), j, 0);
+}
+
+/* Shorthand for Tc_j, for the valve close time of actuator j. */
+constexpr DynamicsSymbol ValveCloseTimeKey(int j) {
+  return DynamicsSymbol::JointSymbol(DynamicsLabel('T', 'c'), j, 0);
+}
+
+/// Parameters of one pneumatic actuator, as in the knee/hip entries of
+/// robot_config.yaml.
+struct JRActuatorParameters {
+  int j = 0;                 ///< id of the actuated joint
+  double k_tendon = 8200;    ///< tendon stiffness (N/m)
+  double k_anta = 2.5;       ///< antagonistic spring stiffness (Nm/rad)
+  double q_anta_limit = 0;   ///< antagonistic spring engagement angle (rad)
+  double b = 0.03;           ///< joint damping (Nm s/rad)
+  double radius = 0.04;      ///< pulley radius (m)
+  double q_rest = 0;         ///< joint angle at rest (rad)
+  bool positive = false;     ///< whether contraction increases the angle
+};
+
+/// Parameters of the pneumatic system, in SI units, as in the pneumatic
+/// entries of robot_config.yaml.
+struct JRPneumaticParameters {
+  double gas_constant = 287.0550 * 296.15;  ///< Rs * T
+  double d_tube = 0.1575 * 0.0254;  ///< diameter of the valve-muscle tube
+  double l_tube = 74 * 0.0254;      ///< length of the valve-muscle tube
+  double mu_tube = 1.8377e-5;       ///< air viscosity
+  double eps_tube = 1e-5;           ///< tube roughness
+  double time_constant_valve = 1e-3;
+  double v_source = 1.475e-3;       ///< volume of the source tank
+  double init_mass = 7.873172488131229e-05;  ///< initial air per actuator
+};
+
+/// Controls of one jump: valve open and close times of each actuator, and
+/// the initial source tank pressure (kPa).
+struct JRControls {
+  gtsam::Vector Tos, Tcs;
+  double P_s_0 = 0;
+};
+
+/// Step size control of JRSimulator::simulateAdaptive.
+struct JRAdaptiveStepParameters {
+  double dt_initial = 1e-3;
+  double dt_min = 1e-5;
+  double dt_max = 1e-2;
+  /// Largest local error of the integrated joint angles and torso pose,
+  /// estimated from the change of the accelerations over a step.
+  double error_tolerance = 1e-6;
+  /// Time within which phase changes are located.
+  double event_tolerance = 1e-5;
+};
+
+/// Noise models of the robot dynamics graphs, as in RobotGraphBuilder in
+/// robot_graph_builder.py.
+OptimizerSetting JROptimizerSetting();
+
+/// Parameters of JRSimulator.
+struct JRSimulatorParameters {
+  JRPneumaticParameters pneumatic;
+  JRAdaptiveStepParameters adaptive;
+  gtsam::Vector3 gravity = gtsam::Vector3(0, 0, -9.8);
+  gtsam::Vector3 planar_axis = gtsam::Vector3(1, 0, 0);
+  double tolerance = 1e-5;             ///< largest error of a solved graph
+  bool tabulated_mass_flow = false;    ///< see MassFlowRateFactor
+  gtsam::LevenbergMarquardtParams lm;  ///< ordering is set by the simulator
+};
+
+/**
+ * JRSimulator simulates the jumping robot as JRSimulator in jr_simulator.py
+ * does: at every step it integrates the previous step, solves the dynamics
+ * of each actuator and its mass flow, solves the robot dynamics by layers
+ * (q, v, then accelerations and wrenches), and checks the ground forces for
+ * a phase change.
+ *
+ * Instead of building new factors for every step, the actuator, mass flow
+ * and robot graphs of a single step are built once, with the variables at
+ * time 0, and the robot graphs once per phase. Each step only replaces the
+ * priors, warm-starts from the current or previous step, and solves with an
+ * elimination ordering computed once. Solutions are copied into the full
+ * trajectory with the keys shifted to the current step.
+ *
+ * Phases are those of JumpingRobot: 0 on the ground, 1 left foot on the
+ * ground, 2 right foot on the ground and 3 in the air.
+ *
+ * simulateAdaptive varies the step size instead: steps grow while the local
+ * integration error is small, e.g. in flight, shrink at the valve switches,
+ * and a take-off is located between steps by root-finding on the contact
+ * forces, so that the phase changes within event_tolerance of the time at
+ * which a foot would pull on the ground.
+ */
+class JRSimulator {
+ public:
+  /**
+   * Constructor
+   * @param robots         the robot in each of the 4 phases, with links
+   *                       "torso", "shank_r", "shank_l", and joints
+   *                       "foot_r", "foot_l" when the foot is on the ground
+   * @param actuators      the actuators, one per actuated joint
+   * @param initial_state  JointAngle and JointVel of all joints, and Pose
+   *                       and Twist of the torso, at time step 0
+   * @param parameters     pneumatics, gravity and optimizer parameters
+   */
+  JRSimulator(const std::vector<Robot> &robots,
+              const std::vector<JRActuatorParameters> &actuators,
+              const gtsam::Values &initial_state,
+              const JRSimulatorParameters &parameters =
+                  JRSimulatorParameters());
+
+  /**
+   * Simulate a jump.
+   * @param num_steps  number of time steps
+   * @param dt         duration of each step
+   * @param controls   valve times and initial tank pressure
+   * @return the values of all steps
+   */
+  gtsam::Values simulate(size_t num_steps, double dt,
+                         const JRControls &controls);
+
+  /**
+   * Simulate a jump with adaptive steps and located phase changes.
+   * @param duration  simulated time
+   * @param controls  valve times and initial tank pressure
+   * @return the values of all steps, with the time of step k at TimeKey(k)
+   */
+  gtsam::Values simulateAdaptive(double duration,
+                                 const JRControls &controls);
+
+  /// Times at which the phase changed in the last simulation.
+  const std::vector<double> &eventTimes() const { return event_times_; }
+
+  /// Phase before each step of the last simulation, and after the last.
+  const std::vector<int> &phases() const { return phases_; }
+
+  /// The robot in a phase.
+  const Robot &robot(int phase) const { return robots_.at(phase); }
+
+ private:
+  // A graph of one step, solved with a fixed ordering. Priors are replaced
+  // at every step: they are the factors from index num_factors on.
+  struct Layer {
+    gtsam::NonlinearFactorGraph graph;
+    size_t num_factors = 0;
+    gtsam::KeyVector keys;
+    gtsam::Ordering ordering;
+  };
+
+  struct ActuatorGraphs {
+    Layer dynamics, flow;
+    ValveControlFactor valve;
+  };
+
+  struct PhaseGraphs {
+    Layer q, v, dynamics;
+    gtsam::KeyVector keys;  // of all layers
+    bool grounded;
+  };
+
+  Layer makeLayer(const gtsam::NonlinearFactorGraph &graph) const;
+
+  // Solve a layer from step-local values, throw if it does not converge.
+  gtsam::Values solve(const Layer &layer, const gtsam::Values &init,
+                      const char *what, int k) const;
+
+  // Step-local values of keys at step k: from step k if known, else from
+  // step k - 1, or from the defaults at step 0.
+  gtsam::Values stepValues(const gtsam::KeyVector &keys, int k,
+                           const gtsam::Values &defaults) const;
+
+  // Values of step 0, before solving it.
+  void reset(const JRControls &controls);
+
+  // (Re)do step k >= 1 with the previous step and step size dt.
+  void step(int k, double dt);
+
+  // Largest step size from time t, at most dt, that does not skip over the
+  // start of a valve switch, or within a switch at most its time constant.
+  double valveStep(double t, double dt) const;
+
+  // Local integration error of step k, of size dt.
+  double integrationError(int k, double dt) const;
+
+  // Step k, of size dt, with a negative contact force, is redone with the
+  // smallest size after which the force is negative, within the event
+  // tolerance, given the force h_0 at step k - 1 and h at step k.
+  double locateEvent(int k, double dt, double h_0, double h);
+
+  // The smallest vertical ground force on the feet on the ground.
+  double contactForce(int k) const;
+
+  void integrate(int k, double dt);
+  void stepActuation(int k);
+  void stepRobotDynamics(int k);
+  int stepPhaseChange(int k) const;
+
+  // Vertical ground reaction force on a foot, "r" or "l".
+  double groundForceZ(const std::string &side, int k) const;
+
+  std::vector<Robot> robots_;
+  std::vector<JRActuatorParameters> actuators_;
+  gtsam::Values initial_state_;
+  JRSimulatorParameters p_;
+  DynamicsGraph graph_builder_;
+  std::vector<ActuatorGraphs> actuator_graphs_;
+  std::vector<PhaseGraphs> phase_graphs_;
+  int torso_;
+
+  gtsam::noiseModel::Base::shared_ptr prior_q_model_, prior_v_model_,
+      prior_m_model_, flow_prior_model_;
+
+  gtsam::Values x_;
+  int phase_ = 0;
+  std::vector<int> phases_;
+  std::vector<double> event_times_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,206 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotGraphBuilder.cpp
+ * @brief Factor graphs of jumping robot trajectories, with the factors of
+ * one time step built once and instantiated at every step.
+ */
+
+#include "JumpingRobotGraphBuilder.h"
+
+#include <gtdynamics/factors/CollocationFactors.h>
+#include <gtdynamics/jumpingrobot/factors/JRCollocationFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/utils/values.h>
+
+#include <gtsam/slam/PriorFactor.h>
+
+#include <boost/make_shared.hpp>
+#include <stdexcept>
+
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+using gtsam::noiseModel::Isotropic;
+
+namespace gtdynamics {
+
+using internal::JointAngleKey;
+using internal::JointVelKey;
+using internal::PoseKey;
+using internal::TorqueKey;
+using internal::TwistAccelKey;
+using internal::TwistKey;
+
+/* ************************************************************************* */
+JumpingRobotGraphBuilder::JumpingRobotGraphBuilder(
+    const std::vector<Robot> &robots,
+    const std::vector<JRActuatorParameters> &actuators,
+    const JRPneumaticParameters &pneumatic, const gtsam::Vector3 &gravity,
+    const gtsam::Vector3 &planar_axis)
+    : robots_(robots),
+      actuators_(actuators),
+      graph_builder_(JROptimizerSetting(), gravity, planar_axis) {
+  if (robots_.size() != 4)
+    throw std::invalid_argument(
+        "JumpingRobotGraphBuilder: need the robot in each of the 4 phases.");
+  // AddSourceMassCollocationFactor sums the flow of exactly 4 actuators.
+  if (actuators_.size() != 4)
+    throw std::invalid_argument(
+        "JumpingRobotGraphBuilder: need the 4 actuators of the hips and "
+        "knees.");
+  torso_ = robots_[0].link("torso")->id();
+  for (auto &&name : {"hip_r", "hip_l", "knee_r", "knee_l"})
+    air_joints_.push_back(robots_[3].joint(name)->id());
+
+  // Actuation factors, with the models of ActuationGraphBuilder. Factors on
+  // the source volume or the valve times, which do not depend on the time
+  // step, are made anew at every step, the others are re-keyed.
+  auto gas_law_model = Isotropic::Sigma(1, 0.0001),
+       volume_model = Isotropic::Sigma(1, 1e-7),
+       force_model = Isotropic::Sigma(1, 0.01),
+       balance_model = Isotropic::Sigma(1, 0.001),
+       torque_model = Isotropic::Sigma(1, 0.01),
+       mass_rate_model = Isotropic::Sigma(1, 1e-5);
+  const JRPneumaticParameters pn = pneumatic;
+  actuation_.addMaker([=](int k) {
+    return boost::make_shared<GasLawFactor>(
+        SourcePressureKey(k), SourceVolumeKey(), SourceMassKey(k),
+        gas_law_model, pn.gas_constant);
+  });
+  for (auto &&a : actuators_) {
+    const int j = a.j;
+    actuation_.addShifted(boost::make_shared<GasLawFactor>(
+        ActuatorPressureKey(j), ActuatorVolumeKey(j), ActuatorMassKey(j),
+        gas_law_model, pn.gas_constant));
+    actuation_.addShifted(boost::make_shared<ActuatorVolumeFactor>(
+        ActuatorVolumeKey(j), ContractionKey(j), volume_model, pn.d_tube,
+        pn.l_tube));
+    actuation_.addShifted(boost::make_shared<SmoothActuatorFactor>(
+        ContractionKey(j), ActuatorPressureKey(j), ActuatorForceKey(j),
+        force_model));
+    actuation_.addShifted(boost::make_shared<ForceBalanceFactor>(
+        ContractionKey(j), JointAngleKey(j), ActuatorForceKey(j),
+        balance_model, a.k_tendon, a.radius, a.q_rest, a.positive));
+    actuation_.addShifted(boost::make_shared<JointTorqueFactor>(
+        JointAngleKey(j), JointVelKey(j), ActuatorForceKey(j), TorqueKey(j),
+        torque_model, a.q_anta_limit, a.k_anta, a.radius, a.b, a.positive));
+
+    mass_flow_.addShifted(boost::make_shared<MassFlowRateFactor>(
+        ActuatorPressureKey(j), SourcePressureKey(), MassRateOpenKey(j),
+        mass_rate_model, pn.d_tube, pn.l_tube, pn.mu_tube, pn.eps_tube,
+        1.0 / pn.gas_constant));
+    mass_flow_.addMaker([=](int k) {
+      return boost::make_shared<ValveControlFactor>(
+          TimeKey(k), ValveOpenTimeKey(j), ValveCloseTimeKey(j),
+          MassRateOpenKey(j, k), MassRateActualKey(j, k), mass_rate_model,
+          pn.time_constant_valve);
+    });
+  }
+
+  // Robot dynamics factors of each phase, and no torque at the feet.
+  const OptimizerSetting &opt = graph_builder_.opt();
+  for (auto &&robot : robots_) {
+    DynamicsSlice slice = graph_builder_.dynamicsSlice(robot);
+    for (auto &&joint : robot.joints())
+      if (joint->name() == "foot_l" || joint->name() == "foot_r")
+        slice.addShifted(boost::make_shared<gtsam::PriorFactor<double>>(
+            TorqueKey(joint->id()), 0.0, opt.t_cost_model));
+    robot_slices_.push_back(slice);
+  }
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::actuationGraph(int k) const {
+  return actuation_.instantiate(k);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::massFlowGraph(int k) const {
+  return mass_flow_.instantiate(k);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::robotGraph(int phase,
+                                                          int k) const {
+  return robot_slices_.at(phase).instantiate(k);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::dynamicsGraph(int phase,
+                                                             int k) const {
+  NonlinearFactorGraph graph;
+  actuation_.instantiate(k, &graph);
+  robot_slices_.at(phase).instantiate(k, &graph);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::collocationGraph(
+    const std::vector<int> &step_phases) const {
+  const OptimizerSetting &opt = graph_builder_.opt();
+  const auto m_col_model = Isotropic::Sigma(1, 1e-7);
+  const int num_steps = step_phases.size();
+  NonlinearFactorGraph graph;
+
+  // Air mass of the actuators and the source tank.
+  for (int k = 0; k < num_steps; ++k) {
+    const gtsam::Key dt_key = PhaseKey(step_phases[k]);
+    KeyVector mdot_prev_keys, mdot_curr_keys;
+    for (auto &&a : actuators_) {
+      mdot_prev_keys.push_back(MassRateActualKey(a.j, k));
+      mdot_curr_keys.push_back(MassRateActualKey(a.j, k + 1));
+      DynamicsGraph::addMultiPhaseCollocationFactorDouble(
+          &graph, ActuatorMassKey(a.j, k), ActuatorMassKey(a.j, k + 1),
+          mdot_prev_keys.back(), mdot_curr_keys.back(), dt_key, m_col_model,
+          Trapezoidal);
+    }
+    AddSourceMassCollocationFactor(&graph, mdot_prev_keys, mdot_curr_keys,
+                                   SourceMassKey(k), SourceMassKey(k + 1),
+                                   dt_key, false, m_col_model);
+  }
+
+  // Joints in the air, and the torso.
+  for (int k = 0; k < num_steps; ++k) {
+    const int phase = step_phases[k];
+    const gtsam::Key dt_key = PhaseKey(phase);
+    if (phase == 3)
+      for (int j : air_joints_)
+        graph.push_back(graph_builder_.jointMultiPhaseCollocationFactors(
+            j, k, phase, Trapezoidal));
+    graph.emplace_shared<TrapezoidalPoseCollocationFactor>(
+        PoseKey(torso_, k), PoseKey(torso_, k + 1), TwistKey(torso_, k),
+        TwistKey(torso_, k + 1), dt_key, opt.pose_col_cost_model);
+    graph.emplace_shared<TrapezoidalTwistCollocationFactor>(
+        TwistKey(torso_, k), TwistKey(torso_, k + 1), TwistAccelKey(torso_, k),
+        TwistAccelKey(torso_, k + 1), dt_key, opt.twist_col_cost_model);
+  }
+
+  // Time.
+  for (int k = 0; k < num_steps; ++k)
+    AddTimeCollocationFactor(&graph, TimeKey(k), TimeKey(k + 1),
+                             PhaseKey(step_phases[k]), opt.time_cost_model);
+  return graph;
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph JumpingRobotGraphBuilder::trajectoryGraph(
+    const std::vector<int> &step_phases) const {
+  if (step_phases.empty())
+    throw std::invalid_argument(
+        "JumpingRobotGraphBuilder: need the phase of at least one step.");
+  NonlinearFactorGraph graph;
+  for (size_t k = 0; k <= step_phases.size(); ++k) {
+    const int phase = step_phases[k == 0 ? 0 : k - 1];
+    actuation_.instantiate(k, &graph);
+    robot_slices_.at(phase).instantiate(k, &graph);
+  }
+  graph.push_back(collocationGraph(step_phases));
+  return graph;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JumpingRobotGraphBuilder.h
+ * @brief Factor graphs of jumping robot trajectories, with the factors of
+ * one time step built once and instantiated at every step.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/DynamicsGraph.h>
+#include <gtdynamics/dynamics/DynamicsSlice.h>
+#include <gtdynamics/jumpingrobot/utils/JRSimulator.h>
+#include <gtdynamics/universal_robot/Robot.h>
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * JumpingRobotGraphBuilder builds the factor graphs of JRGraphBuilder in
+ * jr_graph_builder.py, with the factors and noise models of
+ * ActuationGraphBuilder and RobotGraphBuilder.
+ *
+ * The actuation and mass flow factors of one time step, and the robot
+ * dynamics factors of one time step in each phase, are gathered once at
+ * construction in DynamicsSlices, which walk the robot once and are then
+ * instantiated at any time step with their keys shifted. A trajectory graph
+ * only stamps out the slice of the phase of each step, and adds the
+ * collocation factors, which connect two steps and the duration of a phase.
+ *
+ * Phases are those of JumpingRobot: 0 on the ground, 1 left foot on the
+ * ground, 2 right foot on the ground and 3 in the air.
+ */
+class JumpingRobotGraphBuilder {
+ public:
+  /**
+   * Constructor
+   * @param robots       the robot in each of the 4 phases, with link "torso",
+   *                     joints "hip_r", "hip_l", "knee_r", "knee_l", and
+   *                     "foot_r", "foot_l" when the foot is on the ground
+   * @param actuators    the 4 actuators, one per actuated joint
+   * @param pneumatic    parameters of the pneumatic system
+   * @param gravity      gravity vector
+   * @param planar_axis  normal of the plane of motion
+   */
+  JumpingRobotGraphBuilder(
+      const std::vector<Robot> &robots,
+      const std::vector<JRActuatorParameters> &actuators,
+      const JRPneumaticParameters &pneumatic = JRPneumaticParameters(),
+      const gtsam::Vector3 &gravity = gtsam::Vector3(0, 0, -9.8),
+      const gtsam::Vector3 &planar_axis = gtsam::Vector3(1, 0, 0));
+
+  /// Source tank and actuator dynamics factors at step k.
+  gtsam::NonlinearFactorGraph actuationGraph(int k) const;
+
+  /// Mass flow and valve factors of the actuators at step k.
+  gtsam::NonlinearFactorGraph massFlowGraph(int k) const;
+
+  /// Robot dynamics factors at step k in a phase.
+  gtsam::NonlinearFactorGraph robotGraph(int phase, int k) const;
+
+  /**
+   * Actuation and robot dynamics factors at step k in a phase, as
+   * JRGraphBuilder.dynamics_graph with the robot of that phase.
+   */
+  gtsam::NonlinearFactorGraph dynamicsGraph(int phase, int k) const;
+
+  /**
+   * Collocation factors of a trajectory, as JRGraphBuilder.collocation_graph:
+   * on the air mass, the torso pose and twist, the time, and in the air on
+   * the hip and knee joints, from step k to k + 1 in phase step_phases[k].
+   */
+  gtsam::NonlinearFactorGraph collocationGraph(
+      const std::vector<int> &step_phases) const;
+
+  /**
+   * Dynamics factors of steps 0 to step_phases.size() and the collocation
+   * factors between them. Step 0 is in phase step_phases[0], and step k > 0
+   * in the phase of the interval before it.
+   */
+  gtsam::NonlinearFactorGraph trajectoryGraph(
+      const std::vector<int> &step_phases) const;
+
+  /// The robot in a phase.
+  const Robot &robot(int phase) const { return robots_.at(phase); }
+
+  /// Builder of the robot dynamics factors, with their noise models.
+  const DynamicsGraph &graphBuilder() const { return graph_builder_; }
+
+ private:
+  std::vector<Robot> robots_;
+  std::vector<JRActuatorParameters> actuators_;
+  DynamicsGraph graph_builder_;
+  int torso_;
+  std::vector<int> air_joints_;  // hip and knee joints, collocated in air
+
+  DynamicsSlice actuation_, mass_flow_;
+  std::vector<DynamicsSlice> robot_slices_;  // one per phase
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PneumaticActuatorModel.cpp
+ * @brief Pneumatic muscle of the jumping robot as an ActuatorModel.
+ */
+
+#include "PneumaticActuatorModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+using gtsam::Matrix;
+using gtsam::Vector;
+using gtsam::noiseModel::Unit;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+PneumaticActuatorModel::PneumaticActuatorModel(
+    const JRActuatorParameters &actuator,
+    const JRPneumaticParameters &pneumatic, double source_pressure)
+    : a_(actuator),
+      pn_(pneumatic),
+      source_pressure_(source_pressure),
+      volume_(0, 1, Unit::Create(1), pneumatic.d_tube, pneumatic.l_tube),
+      force_(0, 1, 2, Unit::Create(1)),
+      balance_(0, 1, 2, Unit::Create(1), actuator.k_tendon, actuator.radius,
+               actuator.q_rest, actuator.positive),
+      joint_(0, 1, 2, 3, Unit::Create(1), actuator.q_anta_limit,
+             actuator.k_anta, actuator.radius, actuator.b, actuator.positive),
+      flow_(0, 1, 2, Unit::Create(1), pneumatic.d_tube, pneumatic.l_tube,
+            pneumatic.mu_tube, pneumatic.eps_tube,
+            1.0 / pneumatic.gas_constant) {}
+
+/* ************************************************************************* */
+Vector PneumaticActuatorModel::initialState() const {
+  return gtsam::Vector2(pn_.init_mass,
+                        contraction(pn_.init_mass, a_.q_rest));
+}
+
+/* ************************************************************************* */
+double PneumaticActuatorModel::pressure(double m, double dx) const {
+  return m * pn_.gas_constant / volume_.computeVolume(dx) / 1e3;
+}
+
+/* ************************************************************************* */
+double PneumaticActuatorModel::contraction(double m, double q,
+                                           double dx) const {
+  // Newton on the muscle force minus the tendon force, in dx, with the
+  // pressure from the gas law at the volume of the contraction.
+  for (int i = 0; i < 50; ++i) {
+    Matrix H_v, H_dx, H_p, H_balance;
+    const double volume = volume_.computeVolume(dx, H_v);
+    const double p = m * pn_.gas_constant / volume / 1e3;
+    const double f = force_.evaluateError(dx, p, 0.0, H_dx, H_p)(0);
+    const double tendon = balance_.evaluateError(dx, q, 0.0, H_balance)(0);
+    const double slope =
+        H_dx(0, 0) - H_p(0, 0) * p / volume * H_v(0, 0) - H_balance(0, 0);
+    if (slope == 0) break;
+    const double delta = (f - tendon) / slope;
+    dx -= delta;
+    if (std::abs(delta) < 1e-10) break;
+  }
+  return dx;
+}
+
+/* ************************************************************************* */
+double PneumaticActuatorModel::massFlow(double p) const {
+  // The friction factor depends only weakly, through a log, on the flow,
+  // so fixed-point iteration from the guess of JRSimulator converges fast.
+  if (p == source_pressure_) return 0;
+  double mdot = p < source_pressure_ ? 0.007 : -0.007;
+  for (int i = 0; i < 50; ++i) {
+    const double next =
+        flow_.computeExpectedMassFlow(p, source_pressure_, mdot);
+    const bool converged = std::abs(next - mdot) <= 1e-12 * std::abs(next);
+    mdot = next;
+    if (converged) break;
+  }
+  return mdot;
+}
+
+/* ************************************************************************* */
+void PneumaticActuatorModel::step(double h, double command, double q,
+                                  double v, Vector *x) const {
+  const double opening = std::min(std::max(command, 0.0), 1.0);
+  Vector &state = *x;
+  if (opening > 0) {
+    const double p = pressure(state(0), contraction(state(0), q, state(1)));
+    state(0) += h * opening * massFlow(p);
+  }
+  state(1) = contraction(state(0), q, state(1));
+}
+
+/* ************************************************************************* */
+double PneumaticActuatorModel::torque(const Vector &x, double q,
+                                      double v) const {
+  const double dx = contraction(x(0), q, x(1));
+  const double f = force_.evaluateError(dx, pressure(x(0), dx), 0.0)(0);
+  return joint_.evaluateError(q, v, f, 0.0)(0);
+}
+
+}  // namespace gtdynamics
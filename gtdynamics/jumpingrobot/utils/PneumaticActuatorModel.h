@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PneumaticActuatorModel.h
+ * @brief Pneumatic muscle of the jumping robot as an ActuatorModel, for
+ * multi-rate simulation with the Simulator.
+ */
+
+#pragma once
+
+#include <gtdynamics/dynamics/ActuatorModel.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticActuatorFactors.h>
+#include <gtdynamics/jumpingrobot/factors/PneumaticFactors.h>
+#include <gtdynamics/jumpingrobot/utils/JRSimulator.h>
+
+namespace gtdynamics {
+
+/**
+ * A pneumatic muscle of the jumping robot, with the models of the factors
+ * JRSimulator solves at every step: GasLawFactor, ActuatorVolumeFactor,
+ * SmoothActuatorFactor, ForceBalanceFactor and JointTorqueFactor for the
+ * torque, MassFlowRateFactor for the flow through the valve.
+ *
+ * The state is (m, dx): the air mass in the muscle (kg), and its
+ * contraction (cm), found from m and the joint angle by balancing the
+ * muscle and tendon forces. The command is the valve opening, clipped to
+ * [0, 1], which scales the mass flow from the source tank. Unlike in
+ * JRSimulator, the source pressure is held constant, as behind a regulator
+ * or with a tank much larger than the muscles.
+ */
+class PneumaticActuatorModel : public ActuatorModel {
+ public:
+  /**
+   * Constructor
+   * @param actuator         the muscle, its id j is not used
+   * @param pneumatic        tube and gas parameters, and the initial mass
+   * @param source_pressure  pressure of the source tank (kPa)
+   */
+  PneumaticActuatorModel(const JRActuatorParameters &actuator,
+                         const JRPneumaticParameters &pneumatic,
+                         double source_pressure);
+
+  gtsam::Vector initialState() const override;
+
+  void step(double h, double command, double q, double v,
+            gtsam::Vector *x) const override;
+
+  double torque(const gtsam::Vector &x, double q, double v) const override;
+
+  /// Contraction (cm) at which the forces balance, from a guess dx.
+  double contraction(double m, double q, double dx = 0) const;
+
+  /// Pressure (kPa) at air mass m and contraction dx.
+  double pressure(double m, double dx) const;
+
+  /// Mass flow (kg/s) into the muscle at pressure p with the valve open.
+  double massFlow(double p) const;
+
+ private:
+  JRActuatorParameters a_;
+  JRPneumaticParameters pn_;
+  double source_pressure_;
+  ActuatorVolumeFactor volume_;
+  SmoothActuatorFactor force_;
+  ForceBalanceFactor balance_;
+  JointTorqueFactor joint_;
+  MassFlowRateFactor flow_;
+};
+
+}  // namespace gtdynamics
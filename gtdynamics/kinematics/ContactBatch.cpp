@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactBatch.cpp
+ * @brief Contact points and contact goals evaluated over many time steps at
+ * once.
+ */
+
+#include "gtdynamics/kinematics/ContactBatch.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Point3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+PoseBatch GatherPoses(const gtsam::Values &values,
+                      const std::vector<int> &link_ids, size_t num_steps) {
+  int max_id = -1;
+  for (const int i : link_ids) max_id = std::max(max_id, i);
+  PoseBatch poses;
+  poses.data.setZero(num_steps, 12 * (max_id + 1));
+  for (size_t k = 0; k < num_steps; k++)
+    for (const int i : link_ids) poses.setPose(k, i, Pose(values, i, k));
+  return poses;
+}
+
+/* ************************************************************************* */
+Matrix PredictPoints(const PointOnLinks &points, const PoseBatch &poses) {
+  Matrix predicted(poses.size(), 3 * points.size());
+  for (size_t p = 0; p < points.size(); p++) {
+    const int i = points[p].link->id();
+    const Point3 &c = points[p].point;
+    for (int r = 0; r < 3; r++)
+      predicted.col(3 * p + r) = poses.rotation(i, r, 0) * c.x() +
+                                 poses.rotation(i, r, 1) * c.y() +
+                                 poses.rotation(i, r, 2) * c.z() +
+                                 poses.translation(i, r);
+  }
+  return predicted;
+}
+
+/* ************************************************************************* */
+std::vector<uint64_t> SatisfiedGoals(const ContactGoals &goals,
+                                     const PoseBatch &poses, double tol) {
+  if (goals.size() > 64)
+    throw std::invalid_argument("SatisfiedGoals: at most 64 goals.");
+  PointOnLinks points;
+  for (const ContactGoal &goal : goals) points.push_back(goal.point_on_link);
+  const Matrix predicted = PredictPoints(points, poses);
+
+  std::vector<uint64_t> masks(poses.size(), 0);
+  for (size_t g = 0; g < goals.size(); g++) {
+    const Point3 &goal = goals[g].goal_point;
+    const gtsam::Vector squared =
+        (predicted.col(3 * g).array() - goal.x()).square() +
+        (predicted.col(3 * g + 1).array() - goal.y()).square() +
+        (predicted.col(3 * g + 2).array() - goal.z()).square();
+    for (size_t b = 0; b < poses.size(); b++)
+      if (squared(b) < tol * tol) masks[b] |= uint64_t(1) << g;
+  }
+  return masks;
+}
+
+}  // namespace gtdynamics
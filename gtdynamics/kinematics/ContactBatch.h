@@ -0,0 +1,63 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ContactBatch.h
+ * @brief Contact points and contact goals evaluated over many time steps at
+ * once.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/universal_robot/BatchForwardKinematics.h"
+#include "gtdynamics/utils/PointOnLink.h"
+
+namespace gtdynamics {
+
+/**
+ * Gather the poses of the given links at time steps 0 to num_steps - 1 from
+ * values into a PoseBatch, one configuration per time step. Columns of other
+ * links are left zero.
+ * @param values     values with the link poses
+ * @param link_ids   links to gather
+ * @param num_steps  number of time steps
+ */
+PoseBatch GatherPoses(const gtsam::Values &values,
+                      const std::vector<int> &link_ids, size_t num_steps);
+
+/**
+ * Predict where the points on links are in the world frame, for every
+ * configuration of a PoseBatch, in one pass per point over contiguous
+ * columns, as PointOnLink::predict does one point and step at a time.
+ * @param points  points on links
+ * @param poses   link poses, e.g. from BatchForwardKinematics or GatherPoses
+ * @return #configurations x 3 #points, the x, y and z of point p in columns
+ * 3 p to 3 p + 2
+ */
+gtsam::Matrix PredictPoints(const PointOnLinks &points,
+                            const PoseBatch &poses);
+
+/**
+ * Check contact goals for every configuration of a PoseBatch, as
+ * ContactGoal::satisfied does one goal and step at a time.
+ * @param goals  at most 64 contact goals
+ * @param poses  link poses
+ * @param tol    tolerance in 3D
+ * @return one bitmask per configuration, bit g set iff goal g is satisfied
+ */
+std::vector<uint64_t> SatisfiedGoals(const ContactGoals &goals,
+                                     const PoseBatch &poses,
+                                     double tol = 1e-9);
+
+}  // namespace gtdynamics
@@ -0,0 +1,332 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicCalibration.cpp
+ * @brief Streaming calibration of joint offsets and link transforms.
+ */
+
+#include "gtdynamics/kinematics/KinematicCalibration.h"
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <algorithm>
+#include <deque>
+#include <stdexcept>
+
+#include "gtdynamics/factors/CalibratedJointMeasurementFactor.h"
+#include "gtdynamics/utils/NoiseModels.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+namespace {
+// Samples per job, fewer than in BatchInverseDynamics since every sample
+// is a small graph elimination.
+constexpr size_t kBlockSize = 16;
+}  // namespace
+
+/* ************************************************************************* */
+KinematicCalibration::KinematicCalibration(
+    const Robot &robot, const KinematicCalibrationParameters &parameters)
+    : robot_(robot), p_(parameters), pool_(parameters.num_threads) {
+  for (auto &&link : robot_.links()) {
+    link_ids_[link->name()] = link->id();
+    num_link_slots_ = std::max<size_t>(num_link_slots_, link->id() + 1);
+    if (link->isFixed()) fixed_links_.push_back(link);
+  }
+  for (auto &&joint : robot_.joints())
+    num_joint_slots_ = std::max<size_t>(num_joint_slots_, joint->id() + 1);
+  if (fixed_links_.empty())
+    throw std::invalid_argument(
+        "KinematicCalibration: the robot needs a fixed link.");
+
+  // Order the joints from the fixed links to the leaves.
+  std::vector<bool> placed(num_link_slots_, false);
+  std::deque<LinkSharedPtr> queue(fixed_links_.begin(), fixed_links_.end());
+  for (auto &&link : fixed_links_) placed[link->id()] = true;
+  size_t num_placed = fixed_links_.size();
+  while (!queue.empty()) {
+    const LinkSharedPtr link = queue.front();
+    queue.pop_front();
+    for (auto &&joint : link->joints()) {
+      if (joint->child() == link) {
+        if (!placed[joint->parent()->id()])
+          throw std::invalid_argument(
+              "KinematicCalibration: joints need to point away from the "
+              "fixed links.");
+        continue;
+      }
+      const LinkSharedPtr child = joint->child();
+      if (placed[child->id()])
+        throw std::invalid_argument(
+            "KinematicCalibration: the robot needs a tree structure.");
+      placed[child->id()] = true;
+      ++num_placed;
+      joints_.push_back(joint);
+      queue.push_back(child);
+    }
+  }
+  if (num_placed != link_ids_.size())
+    throw std::invalid_argument(
+        "KinematicCalibration: every link needs to be connected to a fixed "
+        "link.");
+
+  const size_t J = num_joint_slots_;
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    calibration_.insert(OffsetKey(j), 0.0);
+    columns_[OffsetKey(j)] = j;
+    if (p_.calibrate_link_transforms) {
+      calibration_.insert(CorrectionKey(j), Vector6(Vector6::Zero()));
+      columns_[CorrectionKey(j)] = J + 6 * j;
+    }
+  }
+
+  const size_t P = p_.calibrate_link_transforms ? 7 * J : J;
+  information_.setZero(P, P);
+  gradient_.setZero(P);
+  for (size_t w = 0; w < pool_.numThreads(); ++w) {
+    workers_.emplace_back(new Worker);
+    workers_.back()->information.setZero(P, P);
+    workers_.back()->gradient.setZero(P);
+  }
+}
+
+/* ************************************************************************* */
+Vector KinematicCalibration::parameters() const {
+  Vector parameters = Vector::Zero(numParameters());
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    parameters(columns_.at(OffsetKey(j))) =
+        calibration_.at<double>(OffsetKey(j));
+    if (p_.calibrate_link_transforms)
+      parameters.segment<6>(columns_.at(CorrectionKey(j))) =
+          calibration_.at<Vector6>(CorrectionKey(j));
+  }
+  return parameters;
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::setParameters(const Vector &parameters) {
+  if (size_t(parameters.size()) != numParameters())
+    throw std::invalid_argument(
+        "KinematicCalibration::setParameters: wrong number of parameters.");
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    calibration_.update(OffsetKey(j), parameters(columns_.at(OffsetKey(j))));
+    if (p_.calibrate_link_transforms)
+      calibration_.update(
+          CorrectionKey(j),
+          Vector6(parameters.segment<6>(columns_.at(CorrectionKey(j)))));
+  }
+}
+
+/* ************************************************************************* */
+Vector KinematicCalibration::offsets() const {
+  Vector offsets = Vector::Zero(num_joint_slots_);
+  for (auto &&joint : joints_)
+    offsets(joint->id()) = calibration_.at<double>(OffsetKey(joint->id()));
+  return offsets;
+}
+
+/* ************************************************************************* */
+Vector6 KinematicCalibration::correction(int j) const {
+  const gtsam::Key key = CorrectionKey(j);
+  return calibration_.exists(key) ? calibration_.at<Vector6>(key)
+                                  : Vector6(Vector6::Zero());
+}
+
+/* ************************************************************************* */
+std::vector<Pose3> KinematicCalibration::linkPoses(
+    const Vector &joint_angles) const {
+  if (size_t(joint_angles.size()) != num_joint_slots_)
+    throw std::invalid_argument(
+        "KinematicCalibration: samples need one joint angle per joint slot.");
+  std::vector<Pose3> poses(num_link_slots_);
+  for (auto &&link : fixed_links_) poses[link->id()] = link->getFixedPose();
+  for (auto &&joint : joints_) {
+    const int j = joint->id();
+    Pose3 pTc = joint->parentTchild(
+        joint_angles(j) + calibration_.at<double>(OffsetKey(j)));
+    if (p_.calibrate_link_transforms)
+      pTc = pTc * Pose3::Expmap(calibration_.at<Vector6>(CorrectionKey(j)));
+    poses[joint->child()->id()] = poses[joint->parent()->id()] * pTc;
+  }
+  return poses;
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::check(const CalibrationSample &sample) const {
+  if (size_t(sample.joint_angles.size()) != num_joint_slots_)
+    throw std::invalid_argument(
+        "KinematicCalibration: samples need one joint angle per joint slot.");
+  for (auto &&measurement : sample.poses)
+    if (!link_ids_.count(measurement.start_link) ||
+        !link_ids_.count(measurement.end_link))
+      throw std::invalid_argument(
+          "KinematicCalibration: no link named " +
+          (link_ids_.count(measurement.start_link) ? measurement.end_link
+                                                   : measurement.start_link) +
+          ".");
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::Worker::add(const KinematicCalibration &c,
+                                       const CalibrationSample &sample) {
+  using internal::PoseKey;
+
+  // Graph and values of the sample, link poses from forward kinematics.
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::Values values = c.calibration_;
+  const std::vector<Pose3> poses = c.linkPoses(sample.joint_angles);
+  for (auto &&link : c.link_ids_)
+    values.insert(PoseKey(link.second), poses[link.second]);
+  for (auto &&link : c.fixed_links_)
+    graph.emplace_shared<gtsam::PriorFactor<Pose3>>(
+        PoseKey(link->id()), link->getFixedPose(), ConstrainedAll(6));
+  for (auto &&joint : c.joints_) {
+    const int j = joint->id();
+    boost::optional<gtsam::Key> correction_key;
+    if (c.p_.calibrate_link_transforms) correction_key = CorrectionKey(j);
+    graph.emplace_shared<CalibratedJointMeasurementFactor>(
+        PoseKey(joint->parent()->id()), PoseKey(joint->child()->id()),
+        OffsetKey(j), correction_key, c.p_.joint_model, joint,
+        sample.joint_angles(j));
+  }
+  for (auto &&measurement : sample.poses)
+    graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(
+        PoseKey(c.link_ids_.at(measurement.start_link)),
+        PoseKey(c.link_ids_.at(measurement.end_link)), measurement.measured,
+        c.p_.pose_model);
+
+  // Link poses are eliminated from the leaves to the fixed links.
+  gtsam::Ordering ordering;
+  for (auto joint = c.joints_.rbegin(); joint != c.joints_.rend(); ++joint)
+    ordering.push_back(PoseKey((*joint)->child()->id()));
+  for (auto &&link : c.fixed_links_) ordering.push_back(PoseKey(link->id()));
+
+  // Gauss-Newton on the link poses with the calibration fixed, i.e. with a
+  // zero calibration step, then the Schur complement on the calibration.
+  for (size_t i = 0;; ++i) {
+    const auto linear = graph.linearize(values);
+    const auto eliminated = linear->eliminatePartialSequential(ordering);
+    if (i == c.p_.sample_iterations) {
+      for (auto &&factor : *eliminated.second) {
+        if (!factor) continue;
+        const Matrix Ab = factor->augmentedInformation();
+        const size_t n = Ab.rows() - 1;
+        std::vector<size_t> starts, columns, dims;
+        size_t start = 0;
+        for (auto key = factor->begin(); key != factor->end(); ++key) {
+          starts.push_back(start);
+          columns.push_back(c.columns_.at(*key));
+          dims.push_back(factor->getDim(key));
+          start += dims.back();
+        }
+        for (size_t a = 0; a < dims.size(); ++a) {
+          gradient.segment(columns[a], dims[a]) +=
+              Ab.block(starts[a], n, dims[a], 1);
+          for (size_t b = 0; b < dims.size(); ++b)
+            information.block(columns[a], columns[b], dims[a], dims[b]) +=
+                Ab.block(starts[a], starts[b], dims[a], dims[b]);
+        }
+      }
+      break;
+    }
+    gtsam::VectorValues delta = c.calibration_.zeroVectors();
+    const gtsam::GaussianBayesNet &bayes_net = *eliminated.first;
+    for (size_t k = bayes_net.size(); k-- > 0;)
+      delta.insert(bayes_net.at(k)->solve(delta));
+    values = values.retract(delta);
+  }
+  error += graph.error(values);
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::collect() {
+  for (auto &&worker : workers_) {
+    information_ += worker->information;
+    gradient_ += worker->gradient;
+    error_ += worker->error;
+    worker->information.setZero();
+    worker->gradient.setZero();
+    worker->error = 0;
+  }
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::add(const CalibrationSample &sample) {
+  check(sample);
+  workers_.front()->add(*this, sample);
+  collect();
+  ++num_samples_;
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::addSamples(
+    const std::vector<CalibrationSample> &samples) {
+  for (auto &&sample : samples) check(sample);
+  const size_t T = samples.size();
+  const size_t num_blocks = (T + kBlockSize - 1) / kBlockSize;
+  pool_.parallelFor(num_blocks, [&](size_t b, size_t w) {
+    const size_t end = std::min(T, (b + 1) * kBlockSize);
+    for (size_t k = b * kBlockSize; k < end; ++k)
+      workers_[w]->add(*this, samples[k]);
+  });
+  collect();
+  num_samples_ += T;
+}
+
+/* ************************************************************************* */
+void KinematicCalibration::clear() {
+  information_.setZero();
+  gradient_.setZero();
+  error_ = 0;
+  num_samples_ = 0;
+}
+
+/* ************************************************************************* */
+Vector KinematicCalibration::update(double damping) {
+  if (damping <= 0)
+    throw std::invalid_argument(
+        "KinematicCalibration::update: damping should be positive.");
+  Matrix H = information_;
+  H.diagonal().array() += damping;
+  const Vector step = H.ldlt().solve(gradient_);
+  setParameters(parameters() + step);
+  clear();
+  return step;
+}
+
+/* ************************************************************************* */
+size_t KinematicCalibration::calibrate(
+    const std::function<void(KinematicCalibration &)> &replay,
+    size_t max_iterations, double tolerance) {
+  for (size_t i = 1; i <= max_iterations; ++i) {
+    clear();
+    replay(*this);
+    if (num_samples_ == 0)
+      throw std::runtime_error(
+          "KinematicCalibration::calibrate: the replay added no samples.");
+    if (update().norm() < tolerance) return i;
+  }
+  return max_iterations;
+}
+
+}  // namespace gtdynamics
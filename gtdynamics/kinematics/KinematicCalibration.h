@@ -0,0 +1,203 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  KinematicCalibration.h
+ * @brief Streaming calibration of joint offsets and link transforms.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/// Parameters of KinematicCalibration.
+struct KinematicCalibrationParameters {
+  /// Also calibrate a transform correction of every child link, besides the
+  /// joint angle offsets.
+  bool calibrate_link_transforms = true;
+
+  /// Noise model of the joint measurements, 6-dimensional.
+  gtsam::SharedNoiseModel joint_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-4);
+
+  /// Noise model of the link pose measurements, 6-dimensional.
+  gtsam::SharedNoiseModel pose_model =
+      gtsam::noiseModel::Isotropic::Sigma(6, 1e-3);
+
+  /// Gauss-Newton iterations on the link poses of each sample, with the
+  /// calibration fixed, before the calibration is linearized.
+  size_t sample_iterations = 2;
+
+  /// Threads processing samples, 0 for hardware concurrency.
+  size_t num_threads = 0;
+};
+
+/// Measured pose of a link in the frame of another, as in
+/// ForwardKinematicsFactor, e.g. from motion capture.
+struct LinkPoseMeasurement {
+  std::string start_link, end_link;
+  gtsam::Pose3 measured;  ///< pose of end_link in the frame of start_link
+};
+
+/// One logged sample: joint encoder readings and link pose measurements.
+struct CalibrationSample {
+  gtsam::Vector joint_angles;  ///< measured angle of each joint, by joint id
+  std::vector<LinkPoseMeasurement> poses;
+};
+
+/**
+ * Kinematic calibration of a fixed-base robot from long logs. Each sample is
+ * the graph of one time step: a CalibratedJointMeasurementFactor per joint
+ * and a BetweenFactor per link pose measurement, on the link poses of the
+ * sample and the shared calibration variables, the joint angle offsets and
+ * link transform corrections.
+ *
+ * Rather than building one graph over all samples, samples are added one at
+ * a time or in chunks: the link poses of each sample are optimized with the
+ * calibration fixed, then eliminated, and the Schur complement left on the
+ * calibration variables is summed into a dense information matrix whose size
+ * only depends on the robot. Memory is bounded regardless of the log length,
+ * and chunks are split over a ThreadPool, every thread accumulating its own
+ * information. update() takes a Gauss-Newton step on the calibration from
+ * the accumulated information and starts a new pass over the log.
+ */
+class KinematicCalibration {
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot       the robot, needs a tree structure and fixed roots
+   * @param parameters  noise models, calibrated variables and threads
+   */
+  explicit KinematicCalibration(const Robot &robot,
+                                const KinematicCalibrationParameters
+                                    &parameters =
+                                        KinematicCalibrationParameters());
+
+  /// Key of the angle offset of joint j, a double.
+  static gtsam::Key OffsetKey(int j) {
+    return DynamicsSymbol::JointSymbol(DynamicsLabel('d', 'q'), j, 0);
+  }
+
+  /// Key of the child transform correction of joint j, a Vector6.
+  static gtsam::Key CorrectionKey(int j) {
+    return DynamicsSymbol::JointSymbol(DynamicsLabel('d', 'T'), j, 0);
+  }
+
+  /// Number of calibrated scalars: one offset per joint, and six per joint
+  /// if link transforms are calibrated.
+  size_t numParameters() const { return gradient_.size(); }
+
+  /// Calibrated scalars, the offsets by joint id, then the corrections.
+  gtsam::Vector parameters() const;
+
+  /// Set the calibration from a vector laid out as parameters().
+  void setParameters(const gtsam::Vector &parameters);
+
+  /// Joint angle offsets, by joint id.
+  gtsam::Vector offsets() const;
+
+  /// Correction of the child transform of joint j, zero if not calibrated:
+  /// the calibrated pTc(q) is pTc(q + offset) * Expmap(correction).
+  gtsam::Vector6 correction(int j) const;
+
+  /// Calibration variables keyed by OffsetKey and CorrectionKey.
+  const gtsam::Values &values() const { return calibration_; }
+
+  /// Link CoM poses, by link id, from `joint_angles` and the calibration.
+  std::vector<gtsam::Pose3> linkPoses(const gtsam::Vector &joint_angles) const;
+
+  /// Add one sample to the current pass, using the calling thread.
+  void add(const CalibrationSample &sample);
+
+  /// Add a chunk of samples to the current pass, using all threads.
+  void addSamples(const std::vector<CalibrationSample> &samples);
+
+  /// Samples added in the current pass.
+  size_t numSamples() const { return num_samples_; }
+
+  /// Information matrix on the calibration, summed over the samples.
+  const gtsam::Matrix &information() const { return information_; }
+
+  /// Gauss-Newton right-hand side, information times the step.
+  const gtsam::Vector &gradient() const { return gradient_; }
+
+  /// Factor graph error of the samples of the current pass, at the
+  /// optimized link poses.
+  double error() const { return error_; }
+
+  /**
+   * Solve (information + damping I) step = gradient, apply the step to the
+   * calibration, and clear the pass. Parameters the samples do not observe
+   * stay where they are.
+   * @param damping  Levenberg-Marquardt damping, > 0
+   * @return the step
+   */
+  gtsam::Vector update(double damping = 1e-9);
+
+  /// Forget the samples of the current pass.
+  void clear();
+
+  /**
+   * Calibrate by passes over a log: `replay` is called to add all samples,
+   * e.g. reading the log chunk by chunk, and update() follows, until the
+   * step is below `tolerance` or after `max_iterations` passes.
+   * @return number of passes
+   */
+  size_t calibrate(const std::function<void(KinematicCalibration &)> &replay,
+                   size_t max_iterations = 10, double tolerance = 1e-9);
+
+ private:
+  // Per-sample graph builder and accumulated information of one thread.
+  struct Worker {
+    gtsam::Matrix information;
+    gtsam::Vector gradient;
+    double error = 0;
+    void add(const KinematicCalibration &calibration,
+             const CalibrationSample &sample);
+  };
+
+  // Throw std::invalid_argument if `sample` does not fit the robot.
+  void check(const CalibrationSample &sample) const;
+
+  // Sum the information of the workers into the totals, and clear them.
+  void collect();
+
+  Robot robot_;
+  KinematicCalibrationParameters p_;
+  std::vector<JointSharedPtr> joints_;  // from the roots to the leaves
+  std::vector<LinkSharedPtr> fixed_links_;
+  std::map<std::string, int> link_ids_;
+  size_t num_joint_slots_ = 0, num_link_slots_ = 0;
+  std::map<gtsam::Key, size_t> columns_;  // of the calibration variables
+  gtsam::Values calibration_;
+
+  std::vector<std::unique_ptr<Worker>> workers_;  // per thread
+  ThreadPool pool_;
+  gtsam::Matrix information_;
+  gtsam::Vector gradient_;
+  double error_ = 0;
+  size_t num_samples_ = 0;
+};
+
+}  // namespace gtdynamics
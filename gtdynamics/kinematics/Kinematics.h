@@ -16,11 +16,16 @@
 #include <gtdynamics/optimizer/Optimizer.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtdynamics/utils/Interval.h>
+#include <gtdynamics/utils/NoiseModels.h>
 #include <gtdynamics/utils/PointOnLink.h>
+#include <gtdynamics/utils/Slice.h>
 #include <gtsam/geometry/Point3.h>
 #include <gtsam/geometry/Pose3.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 
+#include <functional>
+#include <vector>
+
 namespace gtdynamics {
 
 /**
@@ -65,6 +70,33 @@ struct ContactGoal {
 ///< Map of link name to ContactGoal
 using ContactGoals = std::vector<ContactGoal>;
 
+/// Outcome of one inverse kinematics query.
+struct InverseKinematicsResult {
+  gtsam::Values values;    ///< solution
+  bool converged = false;  ///< all constraints are within tolerance
+  double error = 0;        ///< objective error of the solution
+};
+
+/**
+ * Interface for seeding inverse kinematics with initial values, e.g. from an
+ * analytic solver, which Kinematics::inverse then polishes iteratively.
+ */
+class InverseKinematicsSeeder {
+ public:
+  virtual ~InverseKinematicsSeeder() {}
+
+  /**
+   * @fn Return initial values for the given goals in a slice.
+   * @param slice Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param contact_goals goals for contact points
+   * @returns joint angles and link poses; empty if no seed was found, or
+   * partial, in which case missing variables are initialized as usual.
+   */
+  virtual gtsam::Values seed(const Slice& slice, const Robot& robot,
+                             const ContactGoals& contact_goals) const = 0;
+};
+
 /// Noise models etc specific to Kinematics class
 struct KinematicsParameters : public OptimizationParameters {
   using Isotropic = gtsam::noiseModel::Isotropic;
@@ -72,11 +104,28 @@ struct KinematicsParameters : public OptimizationParameters {
       g_cost_model,                            // goal point
       prior_q_cost_model;                      // joint angle prior factor
 
+  /// Threads solving the slices of an interval, 0 for all cores. The
+  /// slices are split into contiguous blocks, one per thread.
+  size_t num_slice_threads = 1;
+
+  /// Start each slice of an interval from the solution of the previous slice
+  /// in its block, rather than from initialValues.
+  bool warm_start_slices = false;
+
+  /// In interpolate, solve only the end slices of the interval and
+  /// interpolate the joint angles in between, solving a slice only where the
+  /// interpolated contact goals are off by more than
+  /// interpolation_tolerance. Needs a robot with a tree structure.
+  bool interpolate_joint_space = false;
+  double interpolation_tolerance = 1e-3;
+
   // TODO(yetong): replace noise model with tolerance.
   KinematicsParameters()
-      : p_cost_model(Isotropic::Sigma(6, 1e-4)),
-        g_cost_model(Isotropic::Sigma(3, 0.01)),
-        prior_q_cost_model(Isotropic::Sigma(1, 0.5)) {}
+      : p_cost_model(IsotropicSigma(6, 1e-4)),
+        g_cost_model(IsotropicSigma(3, 0.01)),
+        prior_q_cost_model(IsotropicSigma(1, 0.5)) {
+    linear_solver = RecommendedLinearSolver(ProblemClass::KINEMATICS);
+  }
 };
 
 /// All things kinematics, zero velocities/twists, and no forces.
@@ -84,6 +133,23 @@ class Kinematics : public Optimizer {
  protected:
   const KinematicsParameters p_;  // overrides Base::p_
 
+  /// Solves one slice, starting from `warm_start` unless it is empty.
+  using SliceSolver =
+      std::function<gtsam::Values(size_t k, const gtsam::Values& warm_start)>;
+
+  /**
+   * Solve every slice of `interval` independently, in parallel and with warm
+   * starts as set in the parameters, and merge the results.
+   */
+  gtsam::Values solveSlices(const Interval& interval,
+                            const SliceSolver& solve) const;
+
+  /// The interpolate_joint_space mode of interpolate.
+  gtsam::Values interpolateJointSpace(const Interval& interval,
+                                      const Robot& robot,
+                                      const ContactGoals& contact_goals1,
+                                      const ContactGoals& contact_goals2) const;
+
  public:
   /**
    * @fn Constructor.
@@ -169,8 +235,44 @@ class Kinematics : public Optimizer {
                         const ContactGoals& contact_goals,
                         bool contact_goals_as_constraints = true) const;
 
+  /**
+   * @fn Inverse kinematics starting from the values of a seeder.
+   * @param context Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param contact_goals goals for contact points
+   * @param seeder provides the initial values
+   * @param contact_goals_as_constraints treat contact goal as hard constraints
+   * @returns values with poses and joint angles.
+   */
+  template <class CONTEXT>
+  gtsam::Values inverse(const CONTEXT& context, const Robot& robot,
+                        const ContactGoals& contact_goals,
+                        const InverseKinematicsSeeder& seeder,
+                        bool contact_goals_as_constraints = true) const;
+
+  /**
+   * @fn Inverse kinematics for many sets of contact goals, in parallel.
+   *
+   * The joint constraints, joint angle objectives and initial values are
+   * built once and shared by all queries; only the point goal constraints
+   * differ between queries. Each query is solved by a single-threaded
+   * optimizer, and the queries are spread over a thread pool.
+   * @param context Slice instance.
+   * @param robot Robot specification from URDF/SDF.
+   * @param queries contact goals of each query, as hard constraints
+   * @param num_threads number of threads, 0 for all cores
+   * @returns one result per query, in order.
+   */
+  template <class CONTEXT>
+  std::vector<InverseKinematicsResult> inverseBatch(
+      const CONTEXT& context, const Robot& robot,
+      const std::vector<ContactGoals>& queries,
+      size_t num_threads = 0) const;
+
   /**
    * Interpolate using inverse kinematics: the goals are linearly interpolated.
+   * With interpolate_joint_space, only the slices the joint-space
+   * interpolation misses the goals at are solved.
    * @param context Interval instance
    * @param robot Robot specification from URDF/SDF.
    * @param contact_goals1 goals for contact points for context.k_start
@@ -12,14 +12,22 @@
  */
 
 #include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/universal_robot/CompiledRobot.h>
 #include <gtdynamics/utils/Interval.h>
 #include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/ThreadPool.h>
+#include <gtdynamics/utils/values.h>
+#include <gtsam/base/Lie.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <algorithm>
+#include <iterator>
+
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
+using gtsam::Pose3;
 using gtsam::Values;
 using std::string;
 using std::vector;
@@ -85,17 +93,140 @@ Values Kinematics::initialValues<Interval>(const Interval& interval,
   return values;
 }
 
+namespace {
+/// Seeds a slice with the solution of another slice, shifted in time.
+class WarmStartSeeder : public InverseKinematicsSeeder {
+ public:
+  WarmStartSeeder(const Values& values, size_t k) : values_(values), k_(k) {}
+
+  Values seed(const Slice& slice, const Robot& /*robot*/,
+              const ContactGoals& /*contact_goals*/) const override {
+    // The time index occupies the low bits of the keys.
+    Values values;
+    for (const auto& key_value : values_)
+      values.insert(key_value.key - k_ + slice.k, key_value.value);
+    return values;
+  }
+
+ private:
+  const Values& values_;
+  size_t k_;
+};
+
+/// Contact goals a fraction t of the way from goals1 to goals2.
+ContactGoals InterpolateGoals(const ContactGoals& goals1,
+                              const ContactGoals& goals2, double t) {
+  ContactGoals goals;
+  std::transform(goals1.begin(), goals1.end(), goals2.begin(),
+                 std::back_inserter(goals),
+                 [t](const ContactGoal& goal1, const ContactGoal& goal2) {
+                   return ContactGoal{
+                       goal1.point_on_link,
+                       (1.0 - t) * goal1.goal_point + t * goal2.goal_point};
+                 });
+  return goals;
+}
+}  // namespace
+
+Values Kinematics::solveSlices(const Interval& interval,
+                               const SliceSolver& solve) const {
+  const size_t num_slices = interval.k_end - interval.k_start + 1;
+  std::vector<Values> results(num_slices);
+
+  // Contiguous blocks of slices, solved in order within each block.
+  ThreadPool pool(p_.num_slice_threads);
+  const size_t num_blocks = std::min(num_slices, pool.numThreads());
+  const Values cold_start;
+  pool.parallelFor(num_blocks, [&](size_t b, size_t /*worker*/) {
+    const size_t begin = b * num_slices / num_blocks;
+    const size_t end = (b + 1) * num_slices / num_blocks;
+    for (size_t s = begin; s < end; s++) {
+      const bool warm = p_.warm_start_slices && s > begin;
+      results[s] =
+          solve(interval.k_start + s, warm ? results[s - 1] : cold_start);
+    }
+  });
+
+  Values merged;
+  for (const Values& result : results) merged.insert(result);
+  return merged;
+}
+
 template <>
 Values Kinematics::inverse<Interval>(const Interval& interval,
                                      const Robot& robot,
                                      const ContactGoals& contact_goals,
                                      bool contact_goals_as_constraints) const {
-  Values results;
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
-    results.insert(
-        inverse(Slice(k), robot, contact_goals, contact_goals_as_constraints));
+  return solveSlices(interval, [&](size_t k, const Values& warm_start)
+                                   -> Values {
+    if (warm_start.empty())
+      return inverse(Slice(k), robot, contact_goals,
+                     contact_goals_as_constraints);
+    return inverse(Slice(k), robot, contact_goals,
+                   WarmStartSeeder(warm_start, k - 1),
+                   contact_goals_as_constraints);
+  });
+}
+
+Values Kinematics::interpolateJointSpace(
+    const Interval& interval, const Robot& robot,
+    const ContactGoals& contact_goals1,
+    const ContactGoals& contact_goals2) const {
+  const size_t k0 = interval.k_start, k1 = interval.k_end;
+  Values result = inverse(Slice(k0), robot, contact_goals1);
+  if (k1 == k0) return result;
+  const Values end = inverse(Slice(k1), robot, contact_goals2);
+  result.insert(end);
+  if (k1 == k0 + 1) return result;
+
+  // Joint angles at the ends, and the floating roots to interpolate.
+  const CompiledRobot compiled(robot);
+  gtsam::Vector q0 = gtsam::Vector::Zero(compiled.numJointSlots()),
+                q1 = q0;
+  for (auto&& joint : robot.joints()) {
+    q0(joint->id()) = JointAngle(result, joint->id(), k0);
+    q1(joint->id()) = JointAngle(end, joint->id(), k1);
+  }
+  std::vector<int> floating_roots;
+  for (size_t n = 0; n < compiled.numNodes(); n++) {
+    const int i = compiled.linkIds()[n];
+    if (compiled.parentNodes()[n] < 0 && !compiled.isFixed()[i])
+      floating_roots.push_back(i);
   }
-  return results;
+
+  // Interpolate every inner slice, checking its goals, and solve the slices
+  // that miss them, starting from the interpolation.
+  const size_t num_inner = k1 - k0 - 1;
+  std::vector<Values> inner(num_inner);
+  ThreadPool pool(p_.num_slice_threads);
+  pool.parallelFor(num_inner, [&](size_t s, size_t /*worker*/) {
+    const size_t k = k0 + 1 + s;
+    const double t = double(k - k0) / (k1 - k0);
+    const gtsam::Vector q = (1.0 - t) * q0 + t * q1;
+    std::vector<Pose3> poses(compiled.numLinkSlots());
+    for (const int i : floating_roots)
+      poses[i] = gtsam::interpolate<Pose3>(Pose(result, i, k0),
+                                           Pose(end, i, k1), t);
+    compiled.forwardKinematics(q, &poses);
+
+    Values interpolated;
+    for (auto&& joint : robot.joints())
+      InsertJointAngle(&interpolated, joint->id(), k, q(joint->id()));
+    for (auto&& link : robot.links())
+      InsertPose(&interpolated, link->id(), k, poses[link->id()]);
+
+    const ContactGoals goals = InterpolateGoals(contact_goals1,
+                                                contact_goals2, t);
+    const bool satisfied = std::all_of(
+        goals.begin(), goals.end(), [&](const ContactGoal& goal) {
+          return goal.satisfied(interpolated, k, p_.interpolation_tolerance);
+        });
+    inner[s] = satisfied ? interpolated
+                         : inverse(Slice(k), robot, goals,
+                                   WarmStartSeeder(interpolated, k));
+  });
+  for (const Values& values : inner) result.insert(values);
+  return result;
 }
 
 template <>
@@ -103,21 +234,18 @@ Values Kinematics::interpolate<Interval>(
     const Interval& interval, const Robot& robot,
     const ContactGoals& contact_goals1,
     const ContactGoals& contact_goals2) const {
-  Values result;
+  if (p_.interpolate_joint_space)
+    return interpolateJointSpace(interval, robot, contact_goals1,
+                                 contact_goals2);
   const double dt = 1.0 / (interval.k_start - interval.k_end);  // 5 6 7 8 9 [10
-  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
+  return solveSlices(interval, [&](size_t k, const Values& warm_start)
+                                   -> Values {
     const double t = dt * (k - interval.k_start);
-    ContactGoals goals;
-    transform(contact_goals1.begin(), contact_goals1.end(),
-              contact_goals2.begin(), std::back_inserter(goals),
-              [t](const ContactGoal& goal1, const ContactGoal& goal2) {
-                return ContactGoal{
-                    goal1.point_on_link,
-                    (1.0 - t) * goal1.goal_point + t * goal2.goal_point};
-              });
-    result.insert(inverse(Slice(k), robot, goals));
-  }
-  return result;
+    const ContactGoals goals =
+        InterpolateGoals(contact_goals1, contact_goals2, t);
+    if (warm_start.empty()) return inverse(Slice(k), robot, goals);
+    return inverse(Slice(k), robot, goals, WarmStartSeeder(warm_start, k - 1));
+  });
 }
 
 }  // namespace gtdynamics
@@ -23,6 +23,21 @@ using gtsam::Values;
 using std::string;
 using std::vector;
 
+// A phase is solved as its interval; the contacts are in the goals.
+template <>
+Values Kinematics::inverse<Phase>(const Phase& phase, const Robot& robot,
+                                  const ContactGoals& contact_goals,
+                                  bool contact_goals_as_constraints) const {
+  return inverse(static_cast<const Interval&>(phase), robot, contact_goals,
+                 contact_goals_as_constraints);
+}
 
+template <>
+Values Kinematics::interpolate<Phase>(
+    const Phase& phase, const Robot& robot, const ContactGoals& contact_goals1,
+    const ContactGoals& contact_goals2) const {
+  return interpolate(static_cast<const Interval&>(phase), robot,
+                     contact_goals1, contact_goals2);
+}
 
 }  // namespace gtdynamics
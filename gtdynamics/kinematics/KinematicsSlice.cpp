@@ -15,10 +15,13 @@
 #include <gtdynamics/factors/PoseFactor.h>
 #include <gtdynamics/kinematics/Kinematics.h>
 #include <gtdynamics/utils/Slice.h>
+#include <gtdynamics/utils/ThreadPool.h>
 #include <gtsam/linear/Sampler.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 
+#include <algorithm>
+
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
@@ -136,30 +139,84 @@ Values Kinematics::initialValues<Slice>(const Slice& slice, const Robot& robot,
   return values;
 }
 
-template <>
-Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
-                                  const ContactGoals& contact_goals,
-                                  bool contact_goals_as_constraints) const {
+// Inverse kinematics in a slice from the given initial values.
+static Values InverseFrom(const Kinematics& kinematics, const Slice& slice,
+                          const Robot& robot, const ContactGoals& contact_goals,
+                          bool contact_goals_as_constraints,
+                          const Values& initial_values) {
   // Robot kinematics constraints
-  auto constraints = this->constraints(slice, robot);
+  auto constraints = kinematics.constraints(slice, robot);
   NonlinearFactorGraph graph;
 
   // Contact goals
   if (contact_goals_as_constraints) {
-    constraints.add(this->pointGoalConstraints(slice, contact_goals));
+    constraints.add(kinematics.pointGoalConstraints(slice, contact_goals));
   } else {
-    graph.add(pointGoalObjectives(slice, contact_goals));
+    graph.add(kinematics.pointGoalObjectives(slice, contact_goals));
   }
 
   // Traget joint angles.
-  graph.add(jointAngleObjectives(slice, robot));
+  graph.add(kinematics.jointAngleObjectives(slice, robot));
 
   // TODO(frank): allo pose prior as well.
   // graph.addPrior<gtsam::Pose3>(internal::PoseKey(0, slice.k),
   // gtsam::Pose3(), nullptr);
 
-  auto initial_values = initialValues(slice, robot);
+  return kinematics.optimize(graph, constraints, initial_values);
+}
+
+template <>
+Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
+                                  const ContactGoals& contact_goals,
+                                  bool contact_goals_as_constraints) const {
+  return InverseFrom(*this, slice, robot, contact_goals,
+                     contact_goals_as_constraints,
+                     initialValues(slice, robot));
+}
+
+template <>
+Values Kinematics::inverse<Slice>(const Slice& slice, const Robot& robot,
+                                  const ContactGoals& contact_goals,
+                                  const InverseKinematicsSeeder& seeder,
+                                  bool contact_goals_as_constraints) const {
+  // Seeded values, with any missing variables initialized as usual.
+  Values initial_values = seeder.seed(slice, robot, contact_goals);
+  for (const auto& key_value : initialValues(slice, robot)) {
+    if (!initial_values.exists(key_value.key))
+      initial_values.insert(key_value.key, key_value.value);
+  }
+  return InverseFrom(*this, slice, robot, contact_goals,
+                     contact_goals_as_constraints, initial_values);
+}
 
-  return optimize(graph, constraints, initial_values);
+template <>
+std::vector<InverseKinematicsResult> Kinematics::inverseBatch<Slice>(
+    const Slice& slice, const Robot& robot,
+    const std::vector<ContactGoals>& queries, size_t num_threads) const {
+  // Shared between all queries.
+  const auto joint_constraints = this->constraints(slice, robot);
+  const auto graph = jointAngleObjectives(slice, robot);
+  const auto initial_values = initialValues(slice, robot);
+
+  // The pool parallelizes over queries, not within a solve.
+  OptimizationParameters parameters = p_;
+  parameters.num_threads = 1;
+  const Optimizer optimizer(parameters);
+
+  std::vector<InverseKinematicsResult> results(queries.size());
+  ThreadPool pool(num_threads);
+  pool.parallelFor(queries.size(), [&](size_t q, size_t /*worker*/) {
+    auto constraints = joint_constraints;
+    constraints.add(pointGoalConstraints(slice, queries[q]));
+    InverseKinematicsResult& result = results[q];
+    result.values = optimizer.optimize(graph, constraints, initial_values);
+    result.error = graph.error(result.values);
+    result.converged = std::all_of(
+        constraints.begin(), constraints.end(),
+        [&](const EqualityConstraint::shared_ptr& constraint) {
+          return constraint->feasible(result.values);
+        });
+  });
+  return results;
 }
 }  // namespace gtdynamics
@@ -0,0 +1,187 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PrioritizedKinematics.cpp
+ * @brief Strict-priority inverse kinematics on the robot Jacobians.
+ */
+
+#include "gtdynamics/kinematics/PrioritizedKinematics.h"
+
+#include <Eigen/SVD>
+
+#include <stdexcept>
+#include <string>
+
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+PrioritizedLeastSquares::PrioritizedLeastSquares(size_t num_variables,
+                                                 double damping,
+                                                 double rank_tolerance)
+    : damping_(damping), rank_tolerance_(rank_tolerance) {
+  if (damping < 0 || rank_tolerance < 0)
+    throw std::invalid_argument(
+        "PrioritizedLeastSquares: damping and rank tolerance should not be "
+        "negative.");
+  x_.setZero(num_variables);
+  N_.setIdentity(num_variables, num_variables);
+}
+
+/* ************************************************************************* */
+const Vector &PrioritizedLeastSquares::solve(const std::vector<Matrix> &A,
+                                             const std::vector<Vector> &b) {
+  if (A.size() != b.size())
+    throw std::invalid_argument(
+        "PrioritizedLeastSquares: need a right-hand side per level.");
+  const Eigen::Index n = x_.size();
+  x_.setZero();
+  N_.setIdentity();
+  for (size_t l = 0; l < A.size(); ++l) {
+    if (A[l].cols() != n || A[l].rows() != b[l].size())
+      throw std::invalid_argument("PrioritizedLeastSquares: level " +
+                                  std::to_string(l) +
+                                  " has the wrong dimensions.");
+    if (A[l].rows() == 0) continue;
+    AN_.noalias() = A[l] * N_;
+    r_ = b[l];
+    r_.noalias() -= A[l] * x_;
+    const Eigen::JacobiSVD<Matrix> svd(
+        AN_, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    const Vector &sigma = svd.singularValues();
+    Eigen::Index rank = 0;
+    while (rank < sigma.size() && sigma(rank) > rank_tolerance_) ++rank;
+    if (rank == 0) continue;
+
+    // Damped pseudo-inverse along the directions left by the levels above.
+    const auto U = svd.matrixU().leftCols(rank);
+    const auto V = svd.matrixV().leftCols(rank);
+    s_ = U.transpose() * r_;
+    for (Eigen::Index i = 0; i < rank; ++i)
+      s_(i) *= sigma(i) / (sigma(i) * sigma(i) + damping_ * damping_);
+    x_.noalias() += V * s_;
+    N_.noalias() -= V * V.transpose();
+  }
+  return x_;
+}
+
+/* ************************************************************************* */
+PrioritizedInverseKinematics::PrioritizedInverseKinematics(
+    const Robot &robot, const std::vector<PriorityLevel> &levels,
+    const PrioritizedInverseKinematicsParameters &parameters)
+    : robot_(robot),
+      p_(parameters),
+      solver_(robot_.numJointSlots(), parameters.damping,
+              parameters.rank_tolerance) {
+  if (p_.max_step <= 0)
+    throw std::invalid_argument(
+        "PrioritizedInverseKinematics: max_step should be positive.");
+  J_.setZero(6, robot_.numJointSlots());
+  setLevels(levels);
+}
+
+/* ************************************************************************* */
+void PrioritizedInverseKinematics::setLevels(
+    const std::vector<PriorityLevel> &levels) {
+  levels_.clear();
+  for (auto &&level : levels) {
+    Level compiled;
+    for (auto &&goal : level.point_goals) {
+      const int i = goal.link()->id();
+      if (i < 0 || size_t(i) >= robot_.numLinkSlots() ||
+          robot_.nodeOfLink()[i] < 0)
+        throw std::invalid_argument("PrioritizedInverseKinematics: link " +
+                                    goal.link()->name() +
+                                    " is not in the robot.");
+      compiled.points.push_back({i, goal.contactInCoM(), goal.goal_point});
+    }
+    for (auto &&goal : level.joint_goals) {
+      if (goal.joint_id < 0 ||
+          size_t(goal.joint_id) >= robot_.numJointSlots() ||
+          robot_.jointChildLinks()[goal.joint_id] < 0)
+        throw std::invalid_argument(
+            "PrioritizedInverseKinematics: no joint with id " +
+            std::to_string(goal.joint_id) + ".");
+      compiled.joints.push_back(goal);
+    }
+    levels_.push_back(compiled);
+  }
+
+  A_.resize(levels_.size());
+  b_.resize(levels_.size());
+  for (size_t l = 0; l < levels_.size(); ++l) {
+    const size_t rows =
+        3 * levels_[l].points.size() + levels_[l].joints.size();
+    A_[l].setZero(rows, robot_.numJointSlots());
+    b_[l].setZero(rows);
+  }
+}
+
+/* ************************************************************************* */
+void PrioritizedInverseKinematics::linearize(const Vector &q,
+                                             const std::vector<Pose3> &poses) {
+  for (size_t l = 0; l < levels_.size(); ++l) {
+    const Level &level = levels_[l];
+    Matrix &A = A_[l];
+    Vector &b = b_[l];
+    Eigen::Index row = 0;
+    for (const PointTask &task : level.points) {
+      // A point p moves with v + w x p for the spatial twist (w, v).
+      const Point3 wP = poses[task.link_id].transformFrom(task.point);
+      robot_.spatialJacobian(poses, task.link_id, &J_);
+      A.middleRows<3>(row).noalias() =
+          J_.bottomRows<3>() - gtsam::skewSymmetric(wP) * J_.topRows<3>();
+      b.segment<3>(row) = task.goal - wP;
+      row += 3;
+    }
+    for (const JointAngleGoal &goal : level.joints) {
+      A.row(row).setZero();
+      A(row, goal.joint_id) = 1;
+      b(row) = goal.angle - q(goal.joint_id);
+      row += 1;
+    }
+  }
+}
+
+/* ************************************************************************* */
+PrioritizedInverseKinematicsResult PrioritizedInverseKinematics::solve(
+    Vector *q, std::vector<Pose3> *poses) {
+  if (size_t(q->size()) != robot_.numJointSlots())
+    throw std::invalid_argument(
+        "PrioritizedInverseKinematics: q should have one entry per joint "
+        "slot.");
+  PrioritizedInverseKinematicsResult result;
+  for (; result.iterations < p_.max_iterations; ++result.iterations) {
+    robot_.forwardKinematics(*q, poses);
+    linearize(*q, *poses);
+    const Vector &dq = solver_.solve(A_, b_);
+    const double largest = dq.size() ? dq.cwiseAbs().maxCoeff() : 0.0;
+    if (largest > p_.max_step)
+      *q += dq * (p_.max_step / largest);
+    else
+      *q += dq;
+    if (dq.norm() < p_.tolerance) {
+      result.converged = true;
+      ++result.iterations;
+      break;
+    }
+  }
+
+  robot_.forwardKinematics(*q, poses);
+  linearize(*q, *poses);
+  result.level_errors.resize(levels_.size());
+  for (size_t l = 0; l < levels_.size(); ++l)
+    result.level_errors(l) = b_[l].norm();
+  return result;
+}
+
+}  // namespace gtdynamics
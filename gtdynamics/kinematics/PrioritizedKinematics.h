@@ -0,0 +1,173 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PrioritizedKinematics.h
+ * @brief Strict-priority inverse kinematics on the robot Jacobians.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+#include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * PrioritizedLeastSquares solves a hierarchy of linear least-squares tasks
+ * A_l x = b_l with strict priorities: x minimizes the residual of level 0,
+ * then that of level 1 among the minimizers of level 0, and so on, and is
+ * the smallest such x. Levels are solved in order by nullspace projection:
+ * with N the projector onto the nullspace of the levels above,
+ *
+ *   x += (A_l N)^+ (b_l - A_l x),  N -= V_l V_l',
+ *
+ * with V_l the right singular vectors of A_l N. Each level costs one SVD of
+ * its #rows x #variables matrix, whatever the values, so the cost per level
+ * is deterministic. Damping trades accuracy for bounded steps near
+ * singularities; the priorities are kept with any damping.
+ *
+ * The tasks are, e.g., the velocity-level Jacobians of
+ * PrioritizedInverseKinematics, or acceleration-level tasks with the bias
+ * accelerations of CompiledRobot::biasAccelerations in b_l.
+ */
+class PrioritizedLeastSquares {
+ public:
+  /**
+   * Constructor
+   * @param num_variables   columns of every A_l
+   * @param damping         of the pseudo-inverse of every level, >= 0
+   * @param rank_tolerance  singular values below it span no direction
+   */
+  explicit PrioritizedLeastSquares(size_t num_variables, double damping = 0,
+                                   double rank_tolerance = 1e-9);
+
+  /// Number of variables.
+  size_t numVariables() const { return x_.size(); }
+
+  /**
+   * Solve the hierarchy, highest priority first.
+   * @param A  #rows x numVariables() matrix of every level
+   * @param b  right-hand side of every level
+   * @return the solution, valid until the next call
+   */
+  const gtsam::Vector &solve(const std::vector<gtsam::Matrix> &A,
+                             const std::vector<gtsam::Vector> &b);
+
+ private:
+  double damping_, rank_tolerance_;
+  gtsam::Vector x_, r_, s_;
+  gtsam::Matrix N_, AN_;
+};
+
+/// A joint angle to track, the analog of jointAngleObjectives.
+struct JointAngleGoal {
+  int joint_id;  ///< id of the joint
+  double angle;  ///< desired angle
+};
+
+/// The tasks of one priority level of PrioritizedInverseKinematics.
+struct PriorityLevel {
+  ContactGoals point_goals;                 ///< 3 rows each
+  std::vector<JointAngleGoal> joint_goals;  ///< 1 row each
+};
+
+/// Parameters of PrioritizedInverseKinematics.
+struct PrioritizedInverseKinematicsParameters {
+  size_t max_iterations = 20;  ///< Newton steps at most, the cost bound
+  double tolerance = 1e-10;    ///< stop once a step is shorter than this
+  double damping = 1e-6;       ///< of every level, see PrioritizedLeastSquares
+  double rank_tolerance = 1e-9;
+  double max_step = 0.5;  ///< largest joint angle change per step, in rad
+};
+
+/// Outcome of PrioritizedInverseKinematics::solve.
+struct PrioritizedInverseKinematicsResult {
+  size_t iterations = 0;       ///< Newton steps taken
+  bool converged = false;      ///< the last step was within tolerance
+  gtsam::Vector level_errors;  ///< task residual norm of every level
+};
+
+/**
+ * PrioritizedInverseKinematics solves inverse kinematics with strictly
+ * prioritized tasks, point goals and joint angles, for whole-body control
+ * at control rate, where Kinematics::inverse weights all objectives in one
+ * factor graph and priorities need weight ratios that hurt conditioning.
+ *
+ * Every Newton step runs the forward kinematics of the CompiledRobot, stacks
+ * the task errors and spatial Jacobians of each level, and solves for the
+ * joint angle step with PrioritizedLeastSquares. A lower level only moves
+ * the joints in the nullspace of the levels above, so its error never
+ * degrades them. Floating roots are held at the poses passed in.
+ *
+ * The solver reuses its buffers, so it is not thread-safe: use one per
+ * thread.
+ */
+class PrioritizedInverseKinematics {
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot, with a tree structure
+   * @param levels      tasks, highest priority first
+   * @param parameters  iterations, tolerance and damping
+   */
+  PrioritizedInverseKinematics(
+      const Robot &robot, const std::vector<PriorityLevel> &levels,
+      const PrioritizedInverseKinematicsParameters &parameters =
+          PrioritizedInverseKinematicsParameters());
+
+  /// Replace the tasks, e.g. with the goals of the next control tick.
+  void setLevels(const std::vector<PriorityLevel> &levels);
+
+  /// Number of priority levels.
+  size_t numLevels() const { return levels_.size(); }
+
+  /// The compiled robot the solver runs on.
+  const CompiledRobot &compiledRobot() const { return robot_; }
+
+  /**
+   * Solve from the joint angles in `q`.
+   * @param[in,out] q      joint angles, indexed by joint id
+   * @param[in,out] poses  link poses wTi, indexed by link id; floating roots
+   *                       keep theirs, see CompiledRobot::forwardKinematics
+   */
+  PrioritizedInverseKinematicsResult solve(
+      gtsam::Vector *q, std::vector<gtsam::Pose3> *poses);
+
+ private:
+  // A point goal, resolved to link ids.
+  struct PointTask {
+    int link_id;
+    gtsam::Point3 point, goal;
+  };
+
+  struct Level {
+    std::vector<PointTask> points;
+    std::vector<JointAngleGoal> joints;
+  };
+
+  // Errors and Jacobians of all levels at `poses` and `q` into b_ and A_.
+  void linearize(const gtsam::Vector &q,
+                 const std::vector<gtsam::Pose3> &poses);
+
+  CompiledRobot robot_;
+  PrioritizedInverseKinematicsParameters p_;
+  PrioritizedLeastSquares solver_;
+  std::vector<Level> levels_;
+  std::vector<gtsam::Matrix> A_;
+  std::vector<gtsam::Vector> b_;
+  gtsam::Matrix J_;
+};
+
+}  // namespace gtdynamics
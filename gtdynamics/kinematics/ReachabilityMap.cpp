@@ -0,0 +1,257 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ReachabilityMap.cpp
+ * @brief Precomputed reachability of end-effector poses, with IK seeds.
+ */
+
+#include "gtdynamics/kinematics/ReachabilityMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/universal_robot/BatchForwardKinematics.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/utils/MappedFile.h"
+
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+constexpr size_t ReachabilityMap::kHeaderSize;
+constexpr uint32_t ReachabilityMap::kVersion;
+
+namespace {
+const char kMagic[8] = {'G', 'T', 'D', 'R', 'E', 'A', 'C', 'H'};
+
+// Number of voxels of edge `resolution` covering [lower, upper].
+size_t NumVoxels(double lower, double upper, double resolution) {
+  return std::max<size_t>(1, std::ceil((upper - lower) / resolution));
+}
+
+// Bin of u in [0, n), with u in voxels from the lower corner, -1 outside.
+int64_t Bin(double u, size_t n) {
+  if (!(u >= 0) || u >= n) return -1;
+  return int64_t(u);
+}
+}  // namespace
+
+/* ************************************************************************* */
+ReachabilityMap::ReachabilityMap(const std::shared_ptr<const double> &data)
+    : data_(data) {
+  const double *h = data.get();
+  nx_ = h[2];
+  ny_ = h[3];
+  nz_ = h[4];
+  bins_ = h[5];
+  num_joint_slots_ = h[6];
+  num_seeds_ = h[7];
+  lower_ = Point3(h[8], h[9], h[10]);
+  resolution_ = h[11];
+  num_voxels_ = nx_ * ny_ * nz_;
+  num_rotations_ = bins_ * bins_ * bins_;
+  seeds_offset_ = kHeaderSize + numCells();
+}
+
+/* ************************************************************************* */
+int64_t ReachabilityMap::voxel(const Point3 &position) const {
+  const Point3 u = (position - lower_) / resolution_;
+  const int64_t i = Bin(u.x(), nx_), j = Bin(u.y(), ny_), k = Bin(u.z(), nz_);
+  if (i < 0 || j < 0 || k < 0) return -1;
+  return (k * ny_ + j) * nx_ + i;
+}
+
+/* ************************************************************************* */
+size_t ReachabilityMap::rotationBin(const gtsam::Vector3 &omega) const {
+  size_t bin = 0;
+  for (int r = 2; r >= 0; --r) {
+    const double u = (omega(r) + M_PI) / (2 * M_PI) * bins_;
+    bin = bin * bins_ + std::min<size_t>(std::max(u, 0.0), bins_ - 1);
+  }
+  return bin;
+}
+
+/* ************************************************************************* */
+int64_t ReachabilityMap::cell(const Pose3 &pose) const {
+  const int64_t v = voxel(pose.translation());
+  if (v < 0) return -1;
+  return v * num_rotations_ + rotationBin(gtsam::Rot3::Logmap(pose.rotation()));
+}
+
+/* ************************************************************************* */
+int64_t ReachabilityMap::seedIndex(const Pose3 &pose) const {
+  const int64_t c = cell(pose);
+  return c < 0 ? -1 : int64_t(data_.get()[kHeaderSize + c]);
+}
+
+/* ************************************************************************* */
+size_t ReachabilityMap::count(const Pose3 &pose) const {
+  const int64_t s = seedIndex(pose);
+  if (s < 0) return 0;
+  return data_.get()[seeds_offset_ + s * (1 + num_joint_slots_)];
+}
+
+/* ************************************************************************* */
+boost::optional<gtsam::Vector> ReachabilityMap::seed(const Pose3 &pose) const {
+  const int64_t s = seedIndex(pose);
+  if (s < 0) return boost::none;
+  const double *q = data_.get() + seeds_offset_ + s * (1 + num_joint_slots_);
+  return gtsam::Vector(
+      Eigen::Map<const gtsam::Vector>(q + 1, num_joint_slots_));
+}
+
+/* ************************************************************************* */
+double ReachabilityMap::reachabilityIndex(const Point3 &position) const {
+  const int64_t v = voxel(position);
+  if (v < 0) return 0;
+  const double *cells = data_.get() + kHeaderSize + v * num_rotations_;
+  const size_t reached = std::count_if(cells, cells + num_rotations_,
+                                       [](double s) { return s >= 0; });
+  return double(reached) / num_rotations_;
+}
+
+/* ************************************************************************* */
+ReachabilityMap ReachabilityMap::Compute(
+    const Robot &robot, const std::string &link_name,
+    const ReachabilityMapParameters &parameters, const Pose3 &comTee) {
+  const ReachabilityMapParameters &p = parameters;
+  if (!(p.resolution > 0) || p.rotation_bins == 0)
+    throw std::invalid_argument(
+        "ReachabilityMap: resolution and rotation bins must be positive.");
+  const int ee = robot.link(link_name)->id();
+  BatchForwardKinematics forward_kinematics(robot, p.num_threads);
+  const size_t J = CompiledRobot(robot).numJointSlots();
+
+  // Header, and the grid geometry from it.
+  auto header = std::make_shared<std::vector<double>>(kHeaderSize, 0.0);
+  double *h = header->data();
+  std::memcpy(h, kMagic, sizeof(kMagic));
+  h[1] = kVersion;
+  for (int k = 0; k < 3; ++k)
+    h[2 + k] = NumVoxels(p.lower(k), p.upper(k), p.resolution);
+  h[5] = p.rotation_bins;
+  h[6] = J;
+  for (int k = 0; k < 3; ++k) h[8 + k] = p.lower(k);
+  h[11] = p.resolution;
+  const ReachabilityMap grid(
+      std::shared_ptr<const double>(header, header->data()));
+
+  // Uniform samples within the joint limits. SDF joints without limits get
+  // +-1e16, a revolute joint covers all angles within one turn.
+  gtsam::Vector lower = gtsam::Vector::Zero(J), upper = lower;
+  for (auto &&joint : robot.joints()) {
+    const JointScalarLimit &limits = joint->parameters().scalar_limits;
+    double lo = limits.value_lower_limit, hi = limits.value_upper_limit;
+    if (joint->type() == Joint::Type::Revolute && hi - lo > 2 * M_PI) {
+      lo = -M_PI;
+      hi = M_PI;
+    }
+    if (!(hi - lo < 1e6))
+      throw std::invalid_argument("ReachabilityMap: joint " + joint->name() +
+                                  " has no limits to sample within.");
+    lower(joint->id()) = lo;
+    upper(joint->id()) = hi;
+  }
+  std::mt19937_64 rng(p.seed);
+  std::uniform_real_distribution<double> uniform(0, 1);
+
+  // Per cell the seed index, per seed its distance to the cell center in
+  // voxels and rotation bins, its count and configuration.
+  std::vector<int64_t> cell_seed(grid.numCells(), -1);
+  std::vector<double> best_distance, seeds;
+  const double bin_width = 2 * M_PI / p.rotation_bins;
+  const size_t batch_size = 64 * BatchForwardKinematics::kLanes;
+  gtsam::Matrix Q(batch_size, J);
+  PoseBatch poses;
+  for (size_t begin = 0; begin < p.num_samples; begin += batch_size) {
+    const size_t B = std::min(batch_size, p.num_samples - begin);
+    Q.resize(B, J);
+    for (size_t b = 0; b < B; ++b)
+      for (size_t j = 0; j < J; ++j)
+        Q(b, j) = lower(j) + (upper(j) - lower(j)) * uniform(rng);
+    forward_kinematics.compute(Q, &poses);
+
+    for (size_t b = 0; b < B; ++b) {
+      const Pose3 pose = poses.pose(b, ee) * comTee;
+      const int64_t v = grid.voxel(pose.translation());
+      if (v < 0) continue;
+      const gtsam::Vector3 omega = gtsam::Rot3::Logmap(pose.rotation());
+      const size_t r = grid.rotationBin(omega);
+      const size_t c = v * grid.num_rotations_ + r;
+
+      // Offset from the center of the voxel and of the rotation bin.
+      const Point3 u = (pose.translation() - grid.lower_) / p.resolution;
+      double distance2 = 0;
+      size_t rest = r;
+      for (int k = 0; k < 3; ++k) {
+        const double du = u(k) - std::floor(u(k)) - 0.5;
+        const double dw =
+            (omega(k) + M_PI) / bin_width - (rest % p.rotation_bins) - 0.5;
+        rest /= p.rotation_bins;
+        distance2 += du * du + dw * dw;
+      }
+
+      int64_t &s = cell_seed[c];
+      if (s < 0) {
+        s = best_distance.size();
+        best_distance.push_back(distance2);
+        seeds.push_back(0);
+        for (size_t j = 0; j < J; ++j) seeds.push_back(Q(b, j));
+      }
+      double *seed = seeds.data() + s * (1 + J);
+      seed[0] += 1;
+      if (distance2 < best_distance[s]) {
+        best_distance[s] = distance2;
+        for (size_t j = 0; j < J; ++j) seed[1 + j] = Q(b, j);
+      }
+    }
+  }
+
+  // The tables follow the header.
+  h[7] = best_distance.size();
+  auto data = header;
+  data->reserve(kHeaderSize + cell_seed.size() + seeds.size());
+  data->insert(data->end(), cell_seed.begin(), cell_seed.end());
+  data->insert(data->end(), seeds.begin(), seeds.end());
+  return ReachabilityMap(std::shared_ptr<const double>(data, data->data()));
+}
+
+/* ************************************************************************* */
+void ReachabilityMap::write(const std::string &path) const {
+  std::ofstream file(path, std::ios::binary);
+  const size_t count = seeds_offset_ + num_seeds_ * (1 + num_joint_slots_);
+  file.write(reinterpret_cast<const char *>(data_.get()),
+             count * sizeof(double));
+  if (!file)
+    throw std::runtime_error("ReachabilityMap: cannot write " + path + ".");
+}
+
+/* ************************************************************************* */
+ReachabilityMap ReachabilityMap::MemoryMapped(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("ReachabilityMap: cannot open " + path + ".");
+  double h[kHeaderSize];
+  file.read(reinterpret_cast<char *>(h), sizeof(h));
+  if (!file || std::memcmp(h, kMagic, sizeof(kMagic)) != 0 ||
+      h[1] != kVersion)
+    throw std::invalid_argument("ReachabilityMap: " + path +
+                                " is not a reachability map.");
+  const size_t cells = h[2] * h[3] * h[4] * h[5] * h[5] * h[5];
+  const size_t count = kHeaderSize + cells + h[7] * (1 + h[6]);
+  return ReachabilityMap(MapDoubles(path, count));
+}
+
+}  // namespace gtdynamics
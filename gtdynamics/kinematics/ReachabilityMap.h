@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ReachabilityMap.h
+ * @brief Precomputed reachability of end-effector poses, with IK seeds.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <boost/optional.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/// Workspace, discretization and sampling of ReachabilityMap::Compute.
+struct ReachabilityMapParameters {
+  gtsam::Point3 lower = gtsam::Point3(-1, -1, -1);  ///< workspace corner
+  gtsam::Point3 upper = gtsam::Point3(1, 1, 1);     ///< opposite corner
+  double resolution = 0.05;  ///< edge of the position voxels
+  size_t rotation_bins = 8;  ///< bins per axis of the rotation vector
+  size_t num_samples = 1 << 20;  ///< joint configurations sampled
+  size_t num_threads = 1;        ///< of forward kinematics, 0 for all cores
+  uint64_t seed = 0;             ///< of the joint configuration sampler
+};
+
+/**
+ * ReachabilityMap discretizes the end-effector poses of a robot into cells,
+ * position voxels of the workspace box times bins of the rotation vector
+ * Logmap(R) in [-pi, pi]^3, and records for every cell whether a sampled
+ * joint configuration reaches it, how many did, and the configuration whose
+ * pose is closest to the center of the cell, as a seed for inverse
+ * kinematics. Queries compute the cell of a pose and index the tables, so
+ * they take constant time and no kinematics.
+ *
+ * Configurations are drawn uniformly within the joint limits and their poses
+ * are computed with BatchForwardKinematics, so poses are in the frame of
+ * the robot base, fixed roots at their fixed pose and floating roots at the
+ * identity. A pose is only reported reachable if a sample reached its cell:
+ * with too few samples, reachable cells at the border of the workspace are
+ * missed. Rotation vectors near pi and -pi are the same rotation and fall
+ * into different cells.
+ *
+ * Maps are written to a file of doubles and read back by memory-mapping it,
+ * see write and MemoryMapped, so that large maps are paged in on demand and
+ * shared between processes. Copies share the tables.
+ */
+class ReachabilityMap {
+ public:
+  /**
+   * Sample the reachable end-effector poses of a robot. Revolute joints
+   * with a range over one turn are sampled within [-pi, pi].
+   * @param robot       the robot, needs to have a tree structure
+   * @param link_name   the end-effector link
+   * @param parameters  workspace, discretization and sampling
+   * @param comTee      end-effector frame in the link CoM frame
+   * @throws std::invalid_argument for a non-positive resolution or no
+   * rotation bins, and for unbounded prismatic joints
+   */
+  static ReachabilityMap Compute(
+      const Robot &robot, const std::string &link_name,
+      const ReachabilityMapParameters &parameters =
+          ReachabilityMapParameters(),
+      const gtsam::Pose3 &comTee = gtsam::Pose3());
+
+  /**
+   * Map a file written by write into memory.
+   * @throws std::runtime_error if the file cannot be read, and
+   * std::invalid_argument if it is not a reachability map
+   */
+  static ReachabilityMap MemoryMapped(const std::string &path);
+
+  /**
+   * Write the map: a header of 16 doubles, char[8] "GTDREACH" then version,
+   * nx, ny, nz, rotation bins, #joint slots, #seeds, lower corner and
+   * resolution; the seed index of every cell, -1 if unreachable, with the
+   * rotation bins fastest and then x, y and z; and for every seed the number
+   * of samples in its cell and the joint configuration. All numbers are
+   * doubles in host byte order.
+   * @throws std::runtime_error if the file cannot be written
+   */
+  void write(const std::string &path) const;
+
+  /// Index of the cell of an end-effector pose, -1 outside the workspace.
+  int64_t cell(const gtsam::Pose3 &pose) const;
+
+  /// Whether a sample reached the cell of an end-effector pose.
+  bool reachable(const gtsam::Pose3 &pose) const {
+    return seedIndex(pose) >= 0;
+  }
+
+  /// Number of samples in the cell of an end-effector pose.
+  size_t count(const gtsam::Pose3 &pose) const;
+
+  /**
+   * Joint configuration whose pose is closest to the center of the cell of
+   * an end-effector pose, entry j for the joint with id j, if reachable.
+   */
+  boost::optional<gtsam::Vector> seed(const gtsam::Pose3 &pose) const;
+
+  /**
+   * Fraction of the rotation bins reached at the voxel of a position, the
+   * reachability index used to rank base placements.
+   */
+  double reachabilityIndex(const gtsam::Point3 &position) const;
+
+  /// Number of cells.
+  size_t numCells() const { return num_voxels_ * num_rotations_; }
+
+  /// Number of reachable cells.
+  size_t numReachable() const { return num_seeds_; }
+
+  /// Number of entries of a seed.
+  size_t numJointSlots() const { return num_joint_slots_; }
+
+ private:
+  static constexpr size_t kHeaderSize = 16;
+  static constexpr uint32_t kVersion = 1;
+
+  // From a header followed by the tables, or only the header of a map
+  // being computed.
+  explicit ReachabilityMap(const std::shared_ptr<const double> &data);
+
+  // Index of the voxel of a position, -1 outside the workspace.
+  int64_t voxel(const gtsam::Point3 &position) const;
+
+  // Index of the rotation bin of a rotation vector.
+  size_t rotationBin(const gtsam::Vector3 &omega) const;
+
+  int64_t seedIndex(const gtsam::Pose3 &pose) const;
+
+  size_t nx_, ny_, nz_, bins_, num_joint_slots_, num_seeds_;
+  size_t num_voxels_, num_rotations_;
+  gtsam::Point3 lower_;
+  double resolution_;
+  size_t seeds_offset_;  // of the seeds in data_
+  std::shared_ptr<const double> data_;
+};
+
+}  // namespace gtdynamics
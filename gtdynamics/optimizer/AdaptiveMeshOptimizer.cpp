@@ -0,0 +1,179 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AdaptiveMeshOptimizer.cpp
+ * @brief Mesh refinement of multi-phase trajectories from collocation error.
+ */
+
+#include "gtdynamics/optimizer/AdaptiveMeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/optimizer/MultiResolutionOptimizer.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Key;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+namespace {
+// Order in dt of the local position error of a collocation scheme.
+double Order(CollocationScheme collocation) {
+  return collocation == CollocationScheme::Euler ? 2.0 : 3.0;
+}
+
+// First time step of phase p.
+int PhaseStart(const Trajectory &trajectory, size_t p) {
+  return p == 0 ? 0 : trajectory.getEndTimeStep(p - 1);
+}
+}  // namespace
+
+/* ************************************************************************* */
+AdaptiveMeshOptimizer::AdaptiveMeshOptimizer(
+    const Robot &robot, const DynamicsGraph &graph_builder,
+    const Trajectory &trajectory, const Objectives &objectives,
+    const AdaptiveMeshParameters &parameters)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      trajectory_(trajectory),
+      objectives_(objectives),
+      p_(parameters) {
+  if (p_.tolerance <= 0 || p_.max_growth < 1 || p_.max_shrink < 1 ||
+      p_.min_steps > p_.max_steps)
+    throw std::invalid_argument(
+        "AdaptiveMeshOptimizer: need a positive tolerance, growth and shrink "
+        "ratios of at least one, and min_steps <= max_steps.");
+}
+
+/* ************************************************************************* */
+std::vector<double> AdaptiveMeshOptimizer::IntervalErrors(
+    const Robot &robot, const Trajectory &trajectory, const Values &values,
+    CollocationScheme collocation) {
+  if (!trajectory.numPhases()) return {};
+  std::vector<double> errors(
+      trajectory.getEndTimeStep(trajectory.numPhases() - 1), 0.0);
+  for (size_t p = 0; p < trajectory.numPhases(); ++p) {
+    if (!values.exists(PhaseKey(p)))
+      throw std::invalid_argument("AdaptiveMeshOptimizer: no duration for " +
+                                  _GTDKeyFormatter(PhaseKey(p)) + ".");
+    const double dt = values.at<double>(PhaseKey(p));
+    for (int k = PhaseStart(trajectory, p); k < trajectory.getEndTimeStep(p);
+         ++k) {
+      for (auto &&joint : robot.joints()) {
+        const int j = joint->id();
+        const Key a0 = JointAccelKey(j, k), a1 = JointAccelKey(j, k + 1);
+        if (!values.exists(a0) || !values.exists(a1)) continue;
+        const double error =
+            collocation == CollocationScheme::Euler
+                ? dt * dt / 2 * std::abs(values.at<double>(a0))
+                : dt * dt / 12 *
+                      std::abs(values.at<double>(a1) - values.at<double>(a0));
+        errors[k] = std::max(errors[k], error);
+      }
+    }
+  }
+  return errors;
+}
+
+/* ************************************************************************* */
+std::vector<double> AdaptiveMeshOptimizer::PhaseErrors(
+    const Trajectory &trajectory, const std::vector<double> &errors) {
+  std::vector<double> phase_errors(trajectory.numPhases(), 0.0);
+  for (size_t p = 0; p < trajectory.numPhases(); ++p)
+    for (int k = PhaseStart(trajectory, p); k < trajectory.getEndTimeStep(p);
+         ++k)
+      phase_errors[p] = std::max(phase_errors[p], errors.at(k));
+  return phase_errors;
+}
+
+/* ************************************************************************* */
+Trajectory AdaptiveMeshOptimizer::Refine(
+    const Trajectory &trajectory, const std::vector<double> &phase_errors,
+    const AdaptiveMeshParameters &parameters) {
+  if (phase_errors.size() != trajectory.numPhases())
+    throw std::invalid_argument(
+        "AdaptiveMeshOptimizer: need one error per phase.");
+  const double order = Order(parameters.collocation),
+               tolerance = parameters.tolerance;
+  std::vector<Phase> phases;
+  size_t k = 0;
+  for (size_t p = 0; p < trajectory.numPhases(); ++p) {
+    const Phase &phase = trajectory.phase(p);
+    const size_t n = phase.numTimeSteps();
+    size_t n_new = n;
+    // Refine above tolerance, coarsen well below it, both towards half of
+    // it; in between, keep the steps so the mesh settles.
+    if (phase_errors[p] > tolerance || phase_errors[p] < tolerance / 4) {
+      const double ratio = std::min(
+          parameters.max_growth,
+          std::max(1 / parameters.max_shrink,
+                   std::pow(2 * phase_errors[p] / tolerance, 1 / order)));
+      n_new = std::ceil(n * ratio);
+    }
+    n_new = std::max<size_t>(
+        1, std::min(parameters.max_steps,
+                    std::max(parameters.min_steps, n_new)));
+    phases.push_back(phase.resampled(k, n_new));
+    k += n_new;
+  }
+  return Trajectory(phases);
+}
+
+/* ************************************************************************* */
+Values AdaptiveMeshOptimizer::optimize(
+    const boost::optional<Values> &initial, Trajectory *trajectory,
+    std::vector<AdaptiveMeshIteration> *report) const {
+  const Optimizer optimizer(p_.optimization);
+  Trajectory current = trajectory_;
+  Values values = initial ? *initial
+                          : current.multiPhaseInitialValues(
+                                robot_, p_.gaussian_noise, p_.dt);
+  for (size_t r = 0;; ++r) {
+    gtsam::NonlinearFactorGraph graph = current.multiPhaseFactorGraph(
+        robot_, graph_builder_, p_.collocation, p_.mu);
+    graph.add(objectives_(current));
+
+    // Only the variables of this solve's graph, all of which need a value.
+    Values solve_values;
+    for (Key key : graph.keys()) {
+      if (!values.exists(key))
+        throw std::runtime_error(
+            "AdaptiveMeshOptimizer: no initial value for " +
+            _GTDKeyFormatter(key) + " at refinement " + std::to_string(r) +
+            ".");
+      solve_values.insert(key, values.at(key));
+    }
+
+    OptimizerProfile profile;
+    values = optimizer.optimize(graph, solve_values, &profile);
+    const std::vector<double> phase_errors = PhaseErrors(
+        current, IntervalErrors(robot_, current, values, p_.collocation));
+    if (report) {
+      AdaptiveMeshIteration iteration;
+      iteration.phase_steps = current.phaseDurations();
+      iteration.phase_errors = phase_errors;
+      iteration.num_iterations = profile.iterations.size();
+      iteration.error = graph.error(values);
+      report->push_back(iteration);
+    }
+    if (r == p_.max_refinements) break;
+
+    const Trajectory refined = Refine(current, phase_errors, p_);
+    if (refined.phaseDurations() == current.phaseDurations()) break;
+    values = MultiResolutionOptimizer::Upsample(current, values, refined);
+    current = refined;
+  }
+  if (trajectory) *trajectory = current;
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AdaptiveMeshOptimizer.h
+ * @brief Mesh refinement of multi-phase trajectories from collocation error.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/Trajectory.h"
+
+namespace gtdynamics {
+
+/// Parameters of AdaptiveMeshOptimizer.
+struct AdaptiveMeshParameters {
+  double tolerance = 1e-4;     ///< collocation error to reach, in rad or m
+  size_t max_refinements = 4;  ///< re-solves after the first solve
+  size_t min_steps = 1;        ///< time steps of a phase, at least
+  size_t max_steps = 400;      ///< time steps of a phase, at most
+  double max_growth = 4.0;     ///< ratio of new to old steps of a phase
+  double max_shrink = 2.0;     ///< ratio of old to new steps of a phase
+  OptimizationParameters optimization;  ///< for every solve
+  CollocationScheme collocation = CollocationScheme::Trapezoidal;
+  double mu = 1.0;  ///< coefficient of static friction
+
+  /// Time step and noise of the initial values of the first solve, see
+  /// Trajectory::multiPhaseInitialValues.
+  double dt = 1. / 240;
+  double gaussian_noise = 0.0;
+};
+
+/// Summary of one solve of AdaptiveMeshOptimizer.
+struct AdaptiveMeshIteration {
+  std::vector<int> phase_steps;      ///< time steps of every phase
+  std::vector<double> phase_errors;  ///< largest interval error per phase
+  size_t num_iterations = 0;         ///< LM iterations
+  double error = 0;                  ///< error of the graph at the solution
+};
+
+/**
+ * AdaptiveMeshOptimizer solves a multi-phase trajectory problem, estimates
+ * the collocation error of every interval of the solution, and re-solves
+ * with more time steps in the phases whose error is above tolerance and
+ * fewer in those below a quarter of it, until the steps no longer change or
+ * max_refinements is reached.
+ *
+ * Steps stay uniform within a phase, since a phase has one duration
+ * variable PhaseKey(p); phase boundaries are where contacts change, e.g.
+ * at impacts and take-offs, so the steps are concentrated in the phases
+ * where the dynamics change quickly. The number of steps of a phase is
+ * scaled by (2 error / tolerance)^(1 / order), to reach half the tolerance
+ * given the order of the local error of the collocation scheme, within
+ * [1 / max_shrink, max_growth] and [min_steps, max_steps]. Each re-solve
+ * is warm started from the previous solution with
+ * MultiResolutionOptimizer::Upsample, which keeps the duration of every
+ * phase.
+ *
+ * The objectives depend on the time steps, so they are given as a function
+ * building them for the Trajectory of a solve.
+ */
+class AdaptiveMeshOptimizer {
+ public:
+  /// Objectives of a trajectory, added to its multiPhaseFactorGraph.
+  using Objectives =
+      std::function<gtsam::NonlinearFactorGraph(const Trajectory &)>;
+
+  AdaptiveMeshOptimizer(
+      const Robot &robot, const DynamicsGraph &graph_builder,
+      const Trajectory &trajectory, const Objectives &objectives,
+      const AdaptiveMeshParameters &parameters = AdaptiveMeshParameters());
+
+  /**
+   * Solve and refine, and return the values of the final trajectory.
+   * @param initial     optional initial values of the first solve
+   * @param trajectory  optional, set to the final trajectory
+   * @param report      optional, a summary of every solve is appended to it
+   */
+  gtsam::Values optimize(
+      const boost::optional<gtsam::Values> &initial = boost::none,
+      Trajectory *trajectory = nullptr,
+      std::vector<AdaptiveMeshIteration> *report = nullptr) const;
+
+  /**
+   * Collocation error estimate of every interval [k, k + 1] of a solution,
+   * the largest over the joints of the position error of the scheme:
+   * dt^2 / 2 |a_k| for Euler, and dt^2 / 12 |a_k+1 - a_k| for the other
+   * schemes, which integrate the position with trapezoidal accuracy, with dt
+   * the PhaseKey of the interval's phase.
+   */
+  static std::vector<double> IntervalErrors(const Robot &robot,
+                                            const Trajectory &trajectory,
+                                            const gtsam::Values &values,
+                                            CollocationScheme collocation);
+
+  /// Largest interval error of every phase.
+  static std::vector<double> PhaseErrors(
+      const Trajectory &trajectory, const std::vector<double> &errors);
+
+  /// The trajectory with the same phases, each with its number of steps
+  /// scaled for its error, as described above.
+  static Trajectory Refine(const Trajectory &trajectory,
+                           const std::vector<double> &phase_errors,
+                           const AdaptiveMeshParameters &parameters);
+
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  Trajectory trajectory_;
+  Objectives objectives_;
+  AdaptiveMeshParameters p_;
+};
+
+}  // namespace gtdynamics
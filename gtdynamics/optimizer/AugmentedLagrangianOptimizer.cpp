@@ -13,34 +13,34 @@
 
 #include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
 
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/Trace.h"
+
 namespace gtdynamics {
 
-/** Update penalty parameter and Lagrangian multipliers from unconstrained
- * optimization result. */
-void update_parameters(const EqualityConstraints& constraints,
-                       const gtsam::Values& previous_values,
-                       const gtsam::Values& current_values, double& mu,
+/** Update penalty parameter and Lagrangian multipliers from the violations
+ * of the unconstrained optimization result, and the sums of squared
+ * tolerance-scaled violations before and after it. The penalty parameter is
+ * multiplied by `rate` unless the violation norm dropped by `ratio`. */
+void update_parameters(const ConstraintViolations& violations,
+                       double previous_error, double current_error,
+                       double ratio, double rate, double& mu,
                        std::vector<gtsam::Vector>& z) {
-  double previous_error = 0;
-  double current_error = 0;
-  for (size_t constraint_index = 0; constraint_index < constraints.size();
+  // Update Lagrangian multipliers.
+  for (size_t constraint_index = 0; constraint_index < violations.size();
        constraint_index++) {
-    auto constraint = constraints.at(constraint_index);
-
-    // Update Lagrangian multipliers.
-    auto violation = (*constraint)(current_values);
-    z[constraint_index] += mu * violation;
-
-    // Sum errors for updating penalty parameter.
-    previous_error +=
-        pow(constraint->toleranceScaledViolation(previous_values).norm(), 2);
-    current_error +=
-        pow(constraint->toleranceScaledViolation(current_values).norm(), 2);
+    z[constraint_index] += mu * violations.at(constraint_index);
   }
 
   // Update penalty parameter.
-  if (sqrt(current_error) >= 0.25 * sqrt(previous_error)) {
-    mu *= 2;
+  if (sqrt(current_error) >= ratio * sqrt(previous_error)) {
+    mu *= rate;
   }
 }
 
@@ -48,36 +48,137 @@ gtsam::Values AugmentedLagrangianOptimizer::optimize(
     const gtsam::NonlinearFactorGraph& graph,
     const EqualityConstraints& constraints, const gtsam::Values& initial_values,
     ConstrainedOptResult* intermediate_result) const {
+  AugmentedLagrangianState state;
+  return optimize(graph, constraints, initial_values, &state,
+                  intermediate_result);
+}
+
+gtsam::Values AugmentedLagrangianOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequalities,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  AugmentedLagrangianState state;
+  return optimize(graph, constraints, inequalities, initial_values, &state,
+                  intermediate_result);
+}
+
+gtsam::Values AugmentedLagrangianOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    AugmentedLagrangianState* state,
+    ConstrainedOptResult* intermediate_result) const {
+  return optimize(graph, constraints, InequalityConstraints(), initial_values,
+                  state, intermediate_result);
+}
+
+gtsam::Values AugmentedLagrangianOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequalities,
+    const gtsam::Values& initial_values, AugmentedLagrangianState* state,
+    ConstrainedOptResult* intermediate_result) const {
+  GTD_TRACE_SCOPE("AugmentedLagrangianOptimizer::optimize");
   gtsam::Values values = initial_values;
 
-  // Set initial values for penalty parameter and Lagrangian multipliers.
-  double mu = 1.0;               // penalty parameter
-  std::vector<gtsam::Vector> z;  // Lagrangian multiplier
-  for (const auto& constraint : constraints) {
-    z.push_back(gtsam::Vector::Zero(constraint->dim()));
+  // Penalty parameter and Lagrangian multipliers, zero unless given.
+  double& mu = state->mu;
+  std::vector<gtsam::Vector>& z = state->z;
+  if (z.empty()) {
+    for (const auto& constraint : constraints) {
+      z.push_back(gtsam::Vector::Zero(constraint->dim()));
+    }
+  } else if (z.size() != constraints.size()) {
+    throw std::invalid_argument(
+        "AugmentedLagrangianOptimizer: state has multipliers for " +
+        std::to_string(z.size()) + " constraints, expected " +
+        std::to_string(constraints.size()) + ".");
   }
+  std::vector<gtsam::Vector>& w = state->w;
+  if (w.empty()) {
+    for (const auto& inequality : inequalities) {
+      w.push_back(gtsam::Vector::Zero(inequality->dim()));
+    }
+  } else if (w.size() != inequalities.size()) {
+    throw std::invalid_argument(
+        "AugmentedLagrangianOptimizer: state has multipliers for " +
+        std::to_string(w.size()) + " inequality constraints, expected " +
+        std::to_string(inequalities.size()) + ".");
+  }
+
+  const ProfileTimer total_timer;
+  const Deadline deadline(p_.time_budget);
+  OptimizerProfile* profile =
+      intermediate_result ? &intermediate_result->profile : nullptr;
+
+  // Construct merit function once; only its penalty terms change.
+  const ProfileTimer construction_timer;
+  std::vector<PenaltyFactor::shared_ptr> penalties, inequality_penalties;
+  const gtsam::NonlinearFactorGraph merit_graph = MeritGraph(
+      graph, constraints, inequalities, &penalties, &inequality_penalties);
+  const gtsam::LevenbergMarquardtParams lm_parameters =
+      WithOrdering(p_.lm_parameters, merit_graph);
+  if (profile) profile->graph_construction += construction_timer.elapsed();
+
+  // Each outer iteration evaluates the constraints once, at its result.
+  std::unique_ptr<ThreadPool> pool;
+  if (p_.num_threads != 1) pool.reset(new ThreadPool(p_.num_threads));
+  ConstraintViolations violations;
+  std::vector<gtsam::Vector> inequality_values;
+  ProfileTimer evaluation_timer;
+  double previous_error =
+      constraints.evaluateInto(values, &violations, pool.get()) +
+      inequalities.evaluate(values);
+  if (profile) profile->constraint_evaluation += evaluation_timer.elapsed();
+
+  // With a time budget, the best iterate is returned, not the last one.
+  BestIterate best(p_.feasibility_tolerance);
+  if (deadline.active())
+    best.consider(values, sqrt(previous_error), graph.error(values));
 
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
+  bool timed_out = false;
   for (int i = 0; i < p_.num_iterations; i++) {
-    // Construct merit function.
-    gtsam::NonlinearFactorGraph merit_graph = graph;
-
-    // Create factors corresponding to penalty terms of constraints.
+    if (deadline.passed()) {
+      timed_out = true;
+      break;
+    }
+    GTD_TRACE_SCOPE("AugmentedLagrangianOptimizer::outer_iteration");
+    // Update penalty terms of constraints.
     for (size_t constraint_index = 0; constraint_index < constraints.size();
          constraint_index++) {
-      auto constraint = constraints.at(constraint_index);
-      gtsam::Vector bias = z[constraint_index] / mu;
-      merit_graph.add(constraint->createFactor(mu, bias));
+      penalties[constraint_index]->setMu(mu);
+      penalties[constraint_index]->setBias(z[constraint_index] / mu);
+    }
+    for (size_t k = 0; k < inequalities.size(); k++) {
+      inequality_penalties[k]->setMu(mu);
+      inequality_penalties[k]->setBias(-w[k] / mu);
     }
 
     // Run LM optimization.
-    gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
-    auto result = optimizer.optimize();
+    size_t inner_iterations;
+    auto result = OptimizeLM(
+        merit_graph, values,
+        InnerParameters(lm_parameters, p_.inner_tolerance_factor,
+                        sqrt(previous_error)),
+        profile, &inner_iterations, pool.get(), p_.block_tridiagonal,
+        &deadline, nullptr, p_.pcg.get_ptr());
 
     // Update parameters.
-    update_parameters(constraints, values, result, mu, z);
+    evaluation_timer = ProfileTimer();
+    const double current_error =
+        constraints.evaluateInto(result, &violations, pool.get()) +
+        inequalities.evaluate(result, &inequality_values);
+    if (profile) profile->constraint_evaluation += evaluation_timer.elapsed();
+    if (deadline.active())
+      best.consider(result, sqrt(current_error), graph.error(result));
+    for (size_t k = 0; k < inequalities.size(); k++)
+      w[k] = (w[k] - mu * inequality_values[k]).cwiseMax(0.0);
+    update_parameters(violations, previous_error, current_error,
+                      p_.progress_ratio, p_.mu_increase_rate, mu, z);
+    previous_error = current_error;
 
     // Update values.
     values = result;
@@ -85,11 +186,73 @@ gtsam::Values AugmentedLagrangianOptimizer::optimize(
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
       intermediate_result->intermediate_values.push_back(values);
-      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
+      intermediate_result->num_iters.push_back(inner_iterations);
       intermediate_result->mu_values.push_back(mu);
     }
+
+    // Stop once feasible, if asked to.
+    if (p_.feasibility_tolerance > 0 &&
+        sqrt(current_error) <= p_.feasibility_tolerance)
+      break;
+  }
+  timed_out = timed_out || deadline.passed();
+  if (deadline.active()) values = best.values();
+
+  if (intermediate_result) {
+    intermediate_result->timed_out = timed_out;
+    intermediate_result->violation =
+        Violation(constraints, inequalities, values, pool.get());
+    intermediate_result->cost = graph.error(values);
   }
+  if (profile) profile->total += total_timer.elapsed();
   return values;
 }
 
+AugmentedLagrangianState AugmentedLagrangianState::shifted(
+    const EqualityConstraints& old_constraints,
+    const EqualityConstraints& new_constraints, const KeyMap& key_map) const {
+  if (z.size() != old_constraints.size())
+    throw std::invalid_argument(
+        "AugmentedLagrangianState::shifted: multipliers do not match the old "
+        "constraints.");
+
+  // Index the old constraints by their keys in the new problem.
+  std::map<gtsam::KeyVector, size_t> old_index;
+  for (size_t i = 0; i < old_constraints.size(); i++) {
+    gtsam::KeyVector keys;
+    bool mapped = true;
+    for (const gtsam::Key key : old_constraints[i]->createFactor(1.0)->keys()) {
+      const boost::optional<gtsam::Key> new_key = key_map(key);
+      if (!new_key) {
+        mapped = false;
+        break;
+      }
+      keys.push_back(*new_key);
+    }
+    if (mapped) old_index.emplace(keys, i);
+  }
+
+  AugmentedLagrangianState state;
+  state.mu = mu;
+  for (const auto& constraint : new_constraints) {
+    const auto it = old_index.find(constraint->createFactor(1.0)->keys());
+    if (it != old_index.end() &&
+        size_t(z[it->second].size()) == constraint->dim()) {
+      state.z.push_back(z[it->second]);
+    } else {
+      state.z.push_back(gtsam::Vector::Zero(constraint->dim()));
+    }
+  }
+  return state;
+}
+
+AugmentedLagrangianState::KeyMap AugmentedLagrangianState::TimeShift(
+    int steps) {
+  return [steps](gtsam::Key key) -> boost::optional<gtsam::Key> {
+    if (steps > 0 && DynamicsSymbol::Time(key) < uint64_t(steps))
+      return boost::none;
+    return key - steps;
+  };
+}
+
 }  // namespace gtdynamics
@@ -13,6 +13,12 @@
 
 #pragma once
 
+#include <gtsam/inference/Key.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <vector>
+
 #include "gtdynamics/optimizer/ConstrainedOptimizer.h"
 
 namespace gtdynamics {
@@ -23,6 +29,11 @@ struct AugmentedLagrangianParameters
   using Base = ConstrainedOptimizationParameters;
   size_t num_iterations;
 
+  /// The penalty parameter is multiplied by mu_increase_rate unless the norm
+  /// of the scaled violations dropped below progress_ratio times the last.
+  double progress_ratio = 0.25;
+  double mu_increase_rate = 2.0;
+
   AugmentedLagrangianParameters()
       : Base(gtsam::LevenbergMarquardtParams()), num_iterations(12) {}
 
@@ -32,7 +43,44 @@ struct AugmentedLagrangianParameters
       : Base(_lm_parameters), num_iterations(_num_iterations) {}
 };
 
-/// Augmented Lagrangian method only considering equality constraints.
+/**
+ * Dual state of the Augmented Lagrangian method: the penalty parameter and
+ * the Lagrange multipliers of each constraint. Passing the state of one solve
+ * into the next warm-starts it, which pays off when consecutive problems are
+ * nearly the same, as in model-predictive control.
+ */
+struct AugmentedLagrangianState {
+  /// Maps a key of the previous problem to the same variable in the next,
+  /// or none if the variable is no longer there.
+  using KeyMap = std::function<boost::optional<gtsam::Key>(gtsam::Key)>;
+
+  double mu = 1.0;               ///< penalty parameter
+  std::vector<gtsam::Vector> z;  ///< multipliers, one per constraint
+  std::vector<gtsam::Vector> w;  ///< non-negative inequality multipliers
+
+  /**
+   * Return the state for the constraints of a new problem. The multipliers of
+   * a new constraint are those of the old constraint on the same variables,
+   * after mapping them with `key_map`, or zero if there is none. The penalty
+   * parameter is kept; inequality multipliers restart from zero.
+   */
+  AugmentedLagrangianState shifted(const EqualityConstraints& old_constraints,
+                                   const EqualityConstraints& new_constraints,
+                                   const KeyMap& key_map) const;
+
+  /**
+   * KeyMap for a receding horizon on DynamicsSymbol keys: time step t of the
+   * previous problem is step t - steps in the next, and steps before `steps`
+   * drop out.
+   */
+  static KeyMap TimeShift(int steps);
+};
+
+/**
+ * Augmented Lagrangian method for equality constraints and inequality
+ * constraints g(x) >= 0. Inequalities get the one-sided penalty
+ * 1/2 mu ||min(0, g(x) - w/mu)||^2 and multipliers w <- max(0, w - mu g(x)).
+ */
 class AugmentedLagrangianOptimizer : public ConstrainedOptimizer {
  protected:
   const AugmentedLagrangianParameters p_;
@@ -51,6 +99,33 @@ class AugmentedLagrangianOptimizer : public ConstrainedOptimizer {
       const EqualityConstraints& constraints,
       const gtsam::Values& initial_values,
       ConstrainedOptResult* intermediate_result = nullptr) const override;
+
+  /**
+   * Run optimization starting from the dual state in `state`, which is
+   * updated to the final state. An empty state->z starts from zero
+   * multipliers.
+   */
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values, AugmentedLagrangianState* state,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
+
+  /// Run optimization with inequality constraints.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequalities,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
+
+  /// Run optimization with inequality constraints from the dual `state`.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequalities,
+      const gtsam::Values& initial_values, AugmentedLagrangianState* state,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
 };
 
 }  // namespace gtdynamics
@@ -0,0 +1,146 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BlockTridiagonalSolver.cpp
+ * @brief Solve trajectory least-squares problems time step by time step.
+ */
+
+#include "gtdynamics/optimizer/BlockTridiagonalSolver.h"
+
+#include <gtsam/linear/linearExceptions.h>
+
+#include <Eigen/Cholesky>
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+// Variables of one time step and their blocks of the normal equations.
+struct Step {
+  std::map<Key, std::pair<size_t, size_t>> blocks;  // offset and dimension
+  size_t dim = 0;
+  Matrix D;  // diagonal block
+  Matrix B;  // coupling with the next step
+  Vector g;  // right-hand side
+};
+}  // namespace
+
+/* ************************************************************************* */
+gtsam::VectorValues BlockTridiagonalSolve(
+    const gtsam::GaussianFactorGraph &graph) {
+  // Assign variables to time steps and offsets.
+  std::map<uint64_t, size_t> step_index;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    for (const Key key : factor->keys())
+      step_index.emplace(DynamicsSymbol::Time(key), 0);
+  }
+  size_t n = 0;
+  for (auto &&time_index : step_index) time_index.second = n++;
+  std::vector<Step> steps(n);
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      Step &step = steps[step_index[DynamicsSymbol::Time(*it)]];
+      const size_t dim = factor->getDim(it);
+      if (step.blocks.emplace(*it, std::make_pair(step.dim, dim)).second)
+        step.dim += dim;
+    }
+  }
+  for (size_t k = 0; k < n; k++) {
+    steps[k].D = Matrix::Zero(steps[k].dim, steps[k].dim);
+    steps[k].g = Vector::Zero(steps[k].dim);
+    if (k + 1 < n) steps[k].B = Matrix::Zero(steps[k].dim, steps[k + 1].dim);
+  }
+
+  // Accumulate the information of each factor into the blocks.
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    const Matrix information = factor->augmentedInformation();
+    const size_t b = information.cols() - 1;
+    std::vector<size_t> k(factor->size()), offset(factor->size()),
+        column(factor->size());
+    size_t first = n, col = 0;
+    for (size_t i = 0; i < factor->size(); i++) {
+      const Key key = factor->keys()[i];
+      k[i] = step_index[DynamicsSymbol::Time(key)];
+      offset[i] = steps[k[i]].blocks[key].first;
+      column[i] = col;
+      col += factor->getDim(factor->begin() + i);
+      first = std::min(first, k[i]);
+    }
+    for (size_t i = 0; i < factor->size(); i++) {
+      if (k[i] > first + 1)
+        throw std::invalid_argument(
+            "BlockTridiagonalSolve: a factor on " +
+            gtsam::DefaultKeyFormatter(factor->keys()[i]) +
+            " couples non-consecutive time steps.");
+    }
+    for (size_t i = 0; i < factor->size(); i++) {
+      const size_t di = factor->getDim(factor->begin() + i);
+      Step &step_i = steps[k[i]];
+      step_i.g.segment(offset[i], di) += information.block(column[i], b, di, 1);
+      for (size_t j = 0; j < factor->size(); j++) {
+        const size_t dj = factor->getDim(factor->begin() + j);
+        const auto block = information.block(column[i], column[j], di, dj);
+        if (k[i] == k[j])
+          step_i.D.block(offset[i], offset[j], di, dj) += block;
+        else if (k[j] == k[i] + 1)
+          step_i.B.block(offset[i], offset[j], di, dj) += block;
+      }
+    }
+  }
+
+  // Forward sweep: S_k = D_k - B_{k-1}^T S_{k-1}^{-1} B_{k-1}.
+  std::vector<Eigen::LLT<Matrix>> cholesky(n);
+  std::vector<Vector> y(n);
+  for (size_t k = 0; k < n; k++) {
+    Matrix S = steps[k].D;
+    y[k] = steps[k].g;
+    if (k > 0) {
+      const Matrix &B = steps[k - 1].B;
+      S -= B.transpose() * cholesky[k - 1].solve(B);
+      y[k] -= B.transpose() * cholesky[k - 1].solve(y[k - 1]);
+    }
+    cholesky[k].compute(S);
+    if (cholesky[k].info() != Eigen::Success)
+      throw gtsam::IndeterminantLinearSystemException(
+          steps[k].blocks.begin()->first);
+  }
+
+  // Back substitution.
+  std::vector<Vector> x(n);
+  for (size_t k = n; k-- > 0;) {
+    Vector rhs = y[k];
+    if (k + 1 < n) rhs -= steps[k].B * x[k + 1];
+    x[k] = cholesky[k].solve(rhs);
+  }
+
+  gtsam::VectorValues solution;
+  for (size_t k = 0; k < n; k++) {
+    for (auto &&key_block : steps[k].blocks) {
+      const auto &block = key_block.second;
+      solution.insert(key_block.first,
+                      x[k].segment(block.first, block.second));
+    }
+  }
+  return solution;
+}
+
+}  // namespace gtdynamics
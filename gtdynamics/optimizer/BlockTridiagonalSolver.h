@@ -0,0 +1,38 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BlockTridiagonalSolver.h
+ * @brief Solve trajectory least-squares problems time step by time step.
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+
+namespace gtdynamics {
+
+/**
+ * Solve the linear least-squares problem `graph`, whose keys are
+ * DynamicsSymbols, as a block-tridiagonal system in time.
+ *
+ * Variables are grouped by time step. When every factor only involves
+ * variables of one time step or of two consecutive ones, as in graphs from
+ * DynamicsGraph::trajectoryFG, the normal equations are block-tridiagonal,
+ * with one dense diagonal block per step. They are then solved by a forward
+ * sweep of block Cholesky factorizations and a back substitution, a Riccati
+ * recursion, in time linear in the number of steps.
+ *
+ * Throws std::invalid_argument if a factor couples non-consecutive time
+ * steps, and gtsam::IndeterminantLinearSystemException if a diagonal block
+ * is not positive definite, as the GTSAM solvers do.
+ */
+gtsam::VectorValues BlockTridiagonalSolve(
+    const gtsam::GaussianFactorGraph &graph);
+
+}  // namespace gtdynamics
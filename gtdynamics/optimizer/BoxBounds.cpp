@@ -0,0 +1,82 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BoxBounds.cpp
+ * @brief Lower and upper bounds on scalar variables, enforced by projection.
+ */
+
+#include "gtdynamics/optimizer/BoxBounds.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+void BoxBounds::add(gtsam::Key key, double lower, double upper) {
+  if (!(lower <= upper))
+    throw std::invalid_argument("BoxBounds: lower bound above upper bound.");
+  bounds_[key] = std::make_pair(lower, upper);
+}
+
+/* ************************************************************************* */
+void BoxBounds::add(const BoxBounds &other) {
+  for (auto &&entry : other.bounds_) bounds_[entry.first] = entry.second;
+}
+
+/* ************************************************************************* */
+void BoxBounds::project(gtsam::Values *values) const {
+  for (auto &&entry : bounds_) {
+    if (!values->exists(entry.first)) continue;
+    const double x = values->at<double>(entry.first);
+    const double projected =
+        std::min(std::max(x, entry.second.first), entry.second.second);
+    if (projected != x) values->update(entry.first, projected);
+  }
+}
+
+/* ************************************************************************* */
+void BoxBounds::clip(const gtsam::Values &values,
+                     gtsam::VectorValues *delta) const {
+  for (auto &&entry : bounds_) {
+    if (!delta->exists(entry.first) || !values.exists(entry.first)) continue;
+    const double x = values.at<double>(entry.first);
+    double &d = delta->at(entry.first)(0);
+    d = std::min(std::max(d, entry.second.first - x),
+                 entry.second.second - x);
+  }
+}
+
+/* ************************************************************************* */
+gtsam::KeyVector BoxBounds::blocking(const gtsam::Values &values,
+                                     const gtsam::VectorValues &delta) const {
+  gtsam::KeyVector blocked;
+  for (auto &&entry : bounds_) {
+    if (!delta.exists(entry.first) || !values.exists(entry.first)) continue;
+    const double x = values.at<double>(entry.first);
+    const double d = delta.at(entry.first)(0);
+    if ((x <= entry.second.first && d < 0) ||
+        (x >= entry.second.second && d > 0))
+      blocked.push_back(entry.first);
+  }
+  return blocked;
+}
+
+/* ************************************************************************* */
+double BoxBounds::violation(const gtsam::Values &values) const {
+  double violation = 0;
+  for (auto &&entry : bounds_) {
+    if (!values.exists(entry.first)) continue;
+    const double x = values.at<double>(entry.first);
+    violation = std::max({violation, entry.second.first - x,
+                          x - entry.second.second});
+  }
+  return violation;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BoxBounds.h
+ * @brief Lower and upper bounds on scalar variables, enforced by projection.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <utility>
+
+namespace gtdynamics {
+
+/**
+ * BoxBounds are bounds lower <= x <= upper on scalar (double) variables, such
+ * as the joint angles, velocities, accelerations and torques limited by
+ * DynamicsGraph::jointLimitBounds. Optimizers enforce them by projection: the
+ * initial values are projected into the box and every step is clipped so
+ * that it stays inside, instead of adding a penalty factor per bound.
+ */
+class BoxBounds {
+ public:
+  /// Bounds of each variable, by key.
+  using Map = std::map<gtsam::Key, std::pair<double, double>>;
+
+  /// Bound a variable, replacing any previous bounds of it.
+  void add(gtsam::Key key, double lower, double upper);
+
+  /// Add all bounds of another set, replacing those of the same keys.
+  void add(const BoxBounds &other);
+
+  /// Number of bounded variables.
+  size_t size() const { return bounds_.size(); }
+
+  /// Whether there are no bounds.
+  bool empty() const { return bounds_.empty(); }
+
+  /// The bounds, by key.
+  const Map &bounds() const { return bounds_; }
+
+  /// Move the bounded variables in `values` into their box.
+  void project(gtsam::Values *values) const;
+
+  /**
+   * Clip a step from `values` so that values.retract(*delta) stays inside the
+   * box. Keys missing from either are left alone.
+   */
+  void clip(const gtsam::Values &values, gtsam::VectorValues *delta) const;
+
+  /**
+   * Variables of `values` at a bound that `delta` pushes further out. An
+   * optimizer holds these fixed and solves for the rest, as in projected
+   * Newton methods, since clipping a coupled step would stall the others.
+   */
+  gtsam::KeyVector blocking(const gtsam::Values &values,
+                            const gtsam::VectorValues &delta) const;
+
+  /// Largest distance of a bounded variable in `values` from its box.
+  double violation(const gtsam::Values &values) const;
+
+ private:
+  Map bounds_;
+};
+
+}  // namespace gtdynamics
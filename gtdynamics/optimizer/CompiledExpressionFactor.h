@@ -0,0 +1,136 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompiledExpressionFactor.h
+ * @brief Expression factor that evaluates Jacobians into a preallocated tape.
+ */
+
+#pragma once
+
+#include <gtsam/base/VerticalBlockMatrix.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/internal/ExecutionTrace.h>
+#include <gtsam/nonlinear/internal/JacobianMap.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * ExpressionFactor compiled once, at construction: the keys and dimensions of
+ * its expression, the execution trace (gtsam's flat tape of one record per
+ * function node) and the Jacobian blocks are allocated there and reused by
+ * every evaluation. ExpressionFactor instead allocates the derivatives on
+ * every unwhitenedError with Jacobians, and puts the trace on the stack of
+ * every linearize. Values alone are evaluated by the expression tree, which
+ * does not trace.
+ *
+ * The storage is guarded by a mutex: a concurrent evaluation of the same
+ * factor, e.g. by two optimizers sharing a graph, falls back to
+ * ExpressionFactor rather than wait.
+ */
+template <typename T>
+class CompiledExpressionFactor : public gtsam::ExpressionFactor<T> {
+ private:
+  using This = CompiledExpressionFactor<T>;
+  using Base = gtsam::ExpressionFactor<T>;
+  using Storage = gtsam::internal::ExecutionTraceStorage;
+  static const int Dim = gtsam::traits<T>::dimension;
+
+  std::unique_ptr<char[]> buffer_;  // trace, with room to align it
+  Storage *trace_ = nullptr;
+  mutable gtsam::VerticalBlockMatrix jacobians_;
+  mutable std::mutex mutex_;
+
+  // Allocate the aligned trace of the expression.
+  void compile() {
+    const size_t bytes = this->expression_.traceSize() * sizeof(Storage);
+    size_t space = bytes + alignof(Storage);
+    buffer_.reset(new char[space]);
+    void *ptr = buffer_.get();
+    trace_ = static_cast<Storage *>(
+        std::align(alignof(Storage), bytes, ptr, space));
+  }
+
+  // Value at x, with its Jacobians written into the blocks of Ab, which need
+  // not be zero. The caller holds mutex_.
+  T evaluate(const gtsam::Values &x, gtsam::VerticalBlockMatrix &Ab) const {
+    Ab.matrix().setZero();
+    gtsam::internal::JacobianMap jacobians(this->keys_, Ab);
+    gtsam::internal::ExecutionTrace<T> trace;
+    const T value = this->expression_.root()->traceExecution(x, trace, trace_);
+    trace.startReverseAD1(jacobians);
+    return value;
+  }
+
+ public:
+  /**
+   * Constructor, same as ExpressionFactor.
+   * @param noise_model  noise model of the error
+   * @param measurement  measurement the expression is compared to
+   * @param expression   expression of a fixed-size type
+   */
+  CompiledExpressionFactor(const gtsam::SharedNoiseModel &noise_model,
+                           const T &measurement,
+                           const gtsam::Expression<T> &expression)
+      : Base(noise_model, measurement, expression),
+        jacobians_(this->dims_, Dim) {
+    compile();
+  }
+
+  /// Copy, with a trace of its own.
+  CompiledExpressionFactor(const This &other)
+      : Base(other), jacobians_(other.jacobians_) {
+    compile();
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return gtsam::NonlinearFactor::shared_ptr(new This(*this));
+  }
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override {
+    if (!H) return Base::unwhitenedError(x);
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) return Base::unwhitenedError(x, H);
+    const T value = evaluate(x, jacobians_);
+    H->resize(this->size());
+    for (size_t i = 0; i < this->size(); i++) (*H)[i] = jacobians_(i);
+    return gtsam::traits<T>::Local(this->measured_, value);
+  }
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || !this->active(x)) return Base::linearize(x);
+
+    // Constrained noise models keep their unit model, as in ExpressionFactor.
+    gtsam::SharedDiagonal model;
+    if (this->noiseModel_ && this->noiseModel_->isConstrained())
+      model = boost::static_pointer_cast<gtsam::noiseModel::Constrained>(
+                  this->noiseModel_)
+                  ->unit();
+    boost::shared_ptr<gtsam::JacobianFactor> factor(
+        new gtsam::JacobianFactor(this->keys_, this->dims_, Dim, model));
+    gtsam::VerticalBlockMatrix &Ab = factor->matrixObject();
+    const T value = evaluate(x, Ab);
+    Ab(this->size()).col(0) = gtsam::traits<T>::Local(value, this->measured_);
+    if (this->noiseModel_) {
+      gtsam::Vector b = Ab(this->size()).col(0);
+      this->noiseModel_->WhitenSystem(Ab.matrix(), b);
+    }
+    return factor;
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ConstrainedOptimizer.cpp
+ * @brief Helpers shared between constrained optimizers.
+ */
+
+#include "gtdynamics/optimizer/ConstrainedOptimizer.h"
+
+#include <gtsam/inference/Ordering.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph ConstrainedOptimizer::MeritGraph(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    std::vector<PenaltyFactor::shared_ptr>* penalties) {
+  gtsam::NonlinearFactorGraph merit_graph = graph;
+  merit_graph.reserve(graph.size() + constraints.size());
+  penalties->clear();
+  for (const auto& constraint : constraints) {
+    penalties->push_back(boost::make_shared<PenaltyFactor>(*constraint));
+    merit_graph.push_back(penalties->back());
+  }
+  return merit_graph;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph ConstrainedOptimizer::MeritGraph(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequalities,
+    std::vector<PenaltyFactor::shared_ptr>* penalties,
+    std::vector<PenaltyFactor::shared_ptr>* inequality_penalties) {
+  gtsam::NonlinearFactorGraph merit_graph =
+      MeritGraph(graph, constraints, penalties);
+  merit_graph.reserve(merit_graph.size() + inequalities.size());
+  inequality_penalties->clear();
+  for (const auto& inequality : inequalities) {
+    inequality_penalties->push_back(
+        boost::make_shared<PenaltyFactor>(*inequality));
+    merit_graph.push_back(inequality_penalties->back());
+  }
+  return merit_graph;
+}
+
+/* ************************************************************************* */
+gtsam::Values ConstrainedOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequalities,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  if (!inequalities.empty())
+    throw std::invalid_argument(
+        "ConstrainedOptimizer: this optimizer does not support inequality "
+        "constraints.");
+  return optimize(graph, constraints, initial_values, intermediate_result);
+}
+
+/* ************************************************************************* */
+gtsam::LevenbergMarquardtParams ConstrainedOptimizer::WithOrdering(
+    const gtsam::LevenbergMarquardtParams& parameters,
+    const gtsam::NonlinearFactorGraph& merit_graph) {
+  gtsam::LevenbergMarquardtParams result = parameters;
+  if (!result.ordering) {
+    result.setOrdering(
+        gtsam::Ordering::Create(result.orderingType, merit_graph));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+gtsam::LevenbergMarquardtParams ConstrainedOptimizer::InnerParameters(
+    const gtsam::LevenbergMarquardtParams& parameters, double factor,
+    double violation) {
+  gtsam::LevenbergMarquardtParams result = parameters;
+  if (factor > 0) {
+    const double tightest = parameters.relativeErrorTol;
+    result.relativeErrorTol =
+        std::max(tightest, std::min(0.1, factor * violation));
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+double ConstrainedOptimizer::Violation(
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequalities, const gtsam::Values& values,
+    ThreadPool* pool) {
+  return std::sqrt(constraints.evaluate(values, nullptr, pool) +
+                   inequalities.evaluate(values));
+}
+
+/* ************************************************************************* */
+void ConstrainedOptimizer::BestIterate::consider(const gtsam::Values& values,
+                                                 double violation,
+                                                 double cost) {
+  const bool better =
+      empty_ ||
+      (violation <= tolerance_ && violation_ <= tolerance_
+           ? cost < cost_
+           : violation < violation_ ||
+                 (violation == violation_ && cost < cost_));
+  if (!better) return;
+  empty_ = false;
+  values_ = values;
+  violation_ = violation;
+  cost_ = cost;
+}
+
+}  // namespace gtdynamics
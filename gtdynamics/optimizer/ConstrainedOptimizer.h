@@ -18,7 +18,13 @@
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 #include <gtsam/nonlinear/Values.h>
 
+#include <boost/optional.hpp>
+#include <vector>
+
 #include "gtdynamics/optimizer/EqualityConstraint.h"
+#include "gtdynamics/optimizer/InequalityConstraint.h"
+#include "gtdynamics/optimizer/OptimizerProfile.h"
+#include "gtdynamics/optimizer/PenaltyFactor.h"
 
 namespace gtdynamics {
 
@@ -26,6 +32,34 @@ namespace gtdynamics {
 struct ConstrainedOptimizationParameters {
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
 
+  /// Threads for linearizing the merit graph and evaluating constraint
+  /// violations, 0 for all cores.
+  size_t num_threads = 1;
+
+  /// Solve the linear systems by time step, see BlockTridiagonalSolve.
+  bool block_tridiagonal = false;
+
+  /// If set, solve the linear systems by PCGSolve instead.
+  boost::optional<PCGParameters> pcg;
+
+  /// Wall-clock budget of a solve in seconds, 0 for none. Once it runs out
+  /// no (inner) iteration is started, and the best iterate is returned: the
+  /// feasible one of least cost if there is one, else the least violating.
+  double time_budget = 0.0;
+
+  /// Iterates whose norm of tolerance-scaled violations is at most this
+  /// count as feasible. The penalty and augmented Lagrangian methods also
+  /// stop once feasible, unless this is zero.
+  double feasibility_tolerance = 0.0;
+
+  /// If positive, the inner LM solves of the penalty and augmented
+  /// Lagrangian methods stop at a relative error decrease of this times the
+  /// norm of the scaled violations, clamped to [lm_parameters'
+  /// relativeErrorTol, 0.1]: far from feasible, where the merit graph is
+  /// about to change, inner solves are loose, and they tighten as the
+  /// violations shrink. Zero always uses lm_parameters.
+  double inner_tolerance_factor = 0.0;
+
   /// Constructor.
   ConstrainedOptimizationParameters() {}
 
@@ -40,10 +74,87 @@ struct ConstrainedOptResult {
   std::vector<gtsam::Values> intermediate_values;  // values after each inner loop
   std::vector<int> num_iters;   // number of LM iterations for each inner loop
   std::vector<double> mu_values;  // penalty parameter for each inner loop
+  OptimizerProfile profile;       // timings of the whole solve
+  bool timed_out = false;         // the time budget ran out
+  double violation = 0.0;  // norm of the scaled violations of the result
+  double cost = 0.0;       // error of the cost graph at the result
 };
 
 /// Base class for constrained optimizer.
 class ConstrainedOptimizer {
+ protected:
+  /**
+   * Return the merit graph: `graph` plus a penalty factor per constraint.
+   * The penalty factors are also returned in `penalties`, so that their mu
+   * and bias can be updated in place between outer iterations.
+   */
+  static gtsam::NonlinearFactorGraph MeritGraph(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      std::vector<PenaltyFactor::shared_ptr>* penalties);
+
+  /**
+   * Merit graph with equality and inequality constraints: the penalty
+   * factors of `inequalities` are one-sided, and returned in
+   * `inequality_penalties`.
+   */
+  static gtsam::NonlinearFactorGraph MeritGraph(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequalities,
+      std::vector<PenaltyFactor::shared_ptr>* penalties,
+      std::vector<PenaltyFactor::shared_ptr>* inequality_penalties);
+
+  /**
+   * Return LM parameters with a fixed ordering for `merit_graph`, so that
+   * the ordering is computed once rather than in every outer iteration. A
+   * custom ordering in `parameters` is kept.
+   */
+  static gtsam::LevenbergMarquardtParams WithOrdering(
+      const gtsam::LevenbergMarquardtParams& parameters,
+      const gtsam::NonlinearFactorGraph& merit_graph);
+
+  /**
+   * LM parameters of an inner solve at a norm `violation` of the scaled
+   * violations, see ConstrainedOptimizationParameters::inner_tolerance_factor.
+   */
+  static gtsam::LevenbergMarquardtParams InnerParameters(
+      const gtsam::LevenbergMarquardtParams& parameters, double factor,
+      double violation);
+
+  /// Norm of the tolerance-scaled violations of all constraints at `values`.
+  static double Violation(const EqualityConstraints& constraints,
+                          const InequalityConstraints& inequalities,
+                          const gtsam::Values& values,
+                          ThreadPool* pool = nullptr);
+
+  /**
+   * Best iterate of a solve: of the iterates whose violation is at most the
+   * feasibility tolerance the one of least cost, and the least violating
+   * one while there are none.
+   */
+  class BestIterate {
+   public:
+    /// Constructor from the feasibility tolerance.
+    explicit BestIterate(double feasibility_tolerance)
+        : tolerance_(feasibility_tolerance) {}
+
+    /// Keep `values` if it is better than the best iterate so far.
+    void consider(const gtsam::Values& values, double violation, double cost);
+
+    /// Whether any iterate was considered.
+    bool empty() const { return empty_; }
+
+    const gtsam::Values& values() const { return values_; }
+    double violation() const { return violation_; }
+    double cost() const { return cost_; }
+
+   private:
+    double tolerance_;
+    bool empty_ = true;
+    gtsam::Values values_;
+    double violation_ = 0.0, cost_ = 0.0;
+  };
 
  public:
   /**
@@ -65,5 +176,24 @@ class ConstrainedOptimizer {
       const EqualityConstraints& constraints,
       const gtsam::Values& initial_values,
       ConstrainedOptResult* intermediate_result = nullptr) const = 0;
+
+  /**
+   * @brief Solve with equality constraints and inequality constraints
+   * g(x) >= 0. Optimizers that do not support inequalities throw if any are
+   * given.
+   *
+   * @param graph A Nonlinear factor graph representing cost.
+   * @param constraints The equality constraints.
+   * @param inequalities The inequality constraints.
+   * @param initial_values Initial values for all variables.
+   * @param intermediate_result (optional) intermediate results.
+   * @return Values The result of the constrained optimization.
+   */
+  virtual gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequalities,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const;
 };
 }  // namespace gtdynamics
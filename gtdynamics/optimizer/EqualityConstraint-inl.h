@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "gtdynamics/optimizer/CompiledExpressionFactor.h"
 #include "gtdynamics/optimizer/EqualityConstraint.h"
 
 namespace gtdynamics {
@@ -26,7 +27,7 @@ gtsam::NoiseModelFactor::shared_ptr VectorExpressionEquality<P>::createFactor(
     measure = -*bias;
   }
   return gtsam::NoiseModelFactor::shared_ptr(
-      new gtsam::ExpressionFactor<VectorP>(noise, measure, expression_));
+      new CompiledExpressionFactor<VectorP>(noise, measure, expression_));
 }
 
 template <int P>
@@ -63,4 +64,21 @@ size_t VectorExpressionEquality<P>::dim() const {
   return P;
 }
 
+template <int P>
+gtsam::Vector VectorExpressionEquality<P>::evaluate(
+    const gtsam::Values& x, double* scaled_squared_norm) const {
+  const VectorP violation = expression_.value(x);
+  *scaled_squared_norm = violation.cwiseQuotient(tolerance_).squaredNorm();
+  return violation;
+}
+
+template <int P>
+void VectorExpressionEquality<P>::evaluateInto(
+    const gtsam::Values& x, Eigen::Ref<gtsam::Vector> violation,
+    Eigen::Ref<gtsam::Vector> scaled_violation) const {
+  const VectorP result = expression_.value(x);
+  violation = result;
+  scaled_violation = result.cwiseQuotient(tolerance_);
+}
+
 }  // namespace gtdynamics
@@ -13,6 +13,11 @@
 
 #include "gtdynamics/optimizer/EqualityConstraint.h"
 
+#include <algorithm>
+
+#include "gtdynamics/optimizer/CompiledExpressionFactor.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
 namespace gtdynamics {
 
 gtsam::NoiseModelFactor::shared_ptr DoubleExpressionEquality::createFactor(
@@ -23,7 +28,7 @@ gtsam::NoiseModelFactor::shared_ptr DoubleExpressionEquality::createFactor(
     measure = -(*bias)(0);
   }
   return gtsam::NoiseModelFactor::shared_ptr(
-      new gtsam::ExpressionFactor<double>(noise, measure, expression_));
+      new CompiledExpressionFactor<double>(noise, measure, expression_));
 }
 
 bool DoubleExpressionEquality::feasible(const gtsam::Values& x) const {
@@ -43,4 +48,85 @@ gtsam::Vector DoubleExpressionEquality::toleranceScaledViolation(
   return (gtsam::Vector(1) << result / tolerance_).finished();
 }
 
+gtsam::Vector DoubleExpressionEquality::evaluate(
+    const gtsam::Values& x, double* scaled_squared_norm) const {
+  double result = expression_.value(x);
+  *scaled_squared_norm = pow(result / tolerance_, 2);
+  return (gtsam::Vector(1) << result).finished();
+}
+
+void DoubleExpressionEquality::evaluateInto(
+    const gtsam::Values& x, Eigen::Ref<gtsam::Vector> violation,
+    Eigen::Ref<gtsam::Vector> scaled_violation) const {
+  const double result = expression_.value(x);
+  violation(0) = result;
+  scaled_violation(0) = result / tolerance_;
+}
+
+double EqualityConstraints::evaluate(const gtsam::Values& x,
+                                     std::vector<gtsam::Vector>* violations,
+                                     ThreadPool* pool) const {
+  if (violations) violations->resize(size());
+
+  // Partial sums per block of constraints, added up in order below.
+  const size_t kBlock = 256;
+  const size_t num_blocks = (size() + kBlock - 1) / kBlock;
+  std::vector<double> sums(num_blocks, 0.0);
+  const auto evaluate_block = [&](size_t block, size_t /*worker*/) {
+    const size_t end = std::min(size(), (block + 1) * kBlock);
+    double sum = 0, scaled_squared_norm;
+    for (size_t i = block * kBlock; i < end; i++) {
+      gtsam::Vector violation = at(i)->evaluate(x, &scaled_squared_norm);
+      sum += scaled_squared_norm;
+      if (violations) (*violations)[i].swap(violation);
+    }
+    sums[block] = sum;
+  };
+  if (pool) {
+    pool->parallelFor(num_blocks, evaluate_block);
+  } else {
+    for (size_t block = 0; block < num_blocks; block++)
+      evaluate_block(block, 0);
+  }
+
+  double total = 0;
+  for (const double sum : sums) total += sum;
+  return total;
+}
+
+double EqualityConstraints::evaluateInto(const gtsam::Values& x,
+                                         ConstraintViolations* violations,
+                                         ThreadPool* pool) const {
+  std::vector<size_t>& offsets = violations->offsets;
+  offsets.resize(size() + 1);
+  offsets[0] = 0;
+  for (size_t i = 0; i < size(); i++)
+    offsets[i + 1] = offsets[i] + at(i)->dim();
+  const size_t total = offsets.back();
+  if (size_t(violations->violation.size()) != total) {
+    violations->violation.resize(total);
+    violations->scaled_violation.resize(total);
+  }
+
+  const size_t kBlock = 256;
+  const size_t num_blocks = (size() + kBlock - 1) / kBlock;
+  gtsam::Vector& violation = violations->violation;
+  gtsam::Vector& scaled_violation = violations->scaled_violation;
+  const auto evaluate_block = [&](size_t block, size_t /*worker*/) {
+    const size_t end = std::min(size(), (block + 1) * kBlock);
+    for (size_t i = block * kBlock; i < end; i++) {
+      const size_t dim = offsets[i + 1] - offsets[i];
+      at(i)->evaluateInto(x, violation.segment(offsets[i], dim),
+                          scaled_violation.segment(offsets[i], dim));
+    }
+  };
+  if (pool) {
+    pool->parallelFor(num_blocks, evaluate_block);
+  } else {
+    for (size_t block = 0; block < num_blocks; block++)
+      evaluate_block(block, 0);
+  }
+  return violations->squaredNorm();
+}
+
 }  // namespace gtdynamics
@@ -16,8 +16,12 @@
 #include <gtsam/nonlinear/ExpressionFactor.h>
 #include <gtsam/nonlinear/NonlinearFactor.h>
 
+#include <vector>
+
 namespace gtdynamics {
 
+class ThreadPool;
+
 /**
  * Equality constraint base class.
  */
@@ -65,6 +69,35 @@ class EqualityConstraint {
 
   /** @brief return the dimension of the constraint. */
   virtual size_t dim() const = 0;
+
+  /**
+   * @brief Evaluate g(x) and ||g(x)/tolerance||^2 together, evaluating the
+   * constraint once.
+   *
+   * @param x values to evalute constraint at.
+   * @param scaled_squared_norm set to the squared tolerance-scaled violation.
+   * @return the constraint violation g(x).
+   */
+  virtual gtsam::Vector evaluate(const gtsam::Values& x,
+                                 double* scaled_squared_norm) const {
+    *scaled_squared_norm = toleranceScaledViolation(x).squaredNorm();
+    return (*this)(x);
+  }
+
+  /**
+   * @brief Write g(x) and g(x)/tolerance into preallocated segments of
+   * dimension dim(), for evaluation into flat buffers.
+   *
+   * @param x values to evalute constraint at.
+   * @param violation set to g(x).
+   * @param scaled_violation set to the tolerance-scaled violation.
+   */
+  virtual void evaluateInto(const gtsam::Values& x,
+                            Eigen::Ref<gtsam::Vector> violation,
+                            Eigen::Ref<gtsam::Vector> scaled_violation) const {
+    violation = (*this)(x);
+    scaled_violation = toleranceScaledViolation(x);
+  }
 };
 
 /** Equality constraint that force g(x) = 0, where g(x) is a scalar-valued
@@ -86,6 +119,7 @@ class DoubleExpressionEquality : public EqualityConstraint {
                            const double& tolerance)
       : expression_(expression), tolerance_(tolerance) {}
 
+  /// Merit factor, a CompiledExpressionFactor of the expression.
   gtsam::NoiseModelFactor::shared_ptr createFactor(
       const double mu,
       boost::optional<gtsam::Vector&> bias = boost::none) const override;
@@ -97,6 +131,13 @@ class DoubleExpressionEquality : public EqualityConstraint {
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
   size_t dim() const override { return 1; }
+
+  gtsam::Vector evaluate(const gtsam::Values& x,
+                         double* scaled_squared_norm) const override;
+
+  void evaluateInto(const gtsam::Values& x,
+                    Eigen::Ref<gtsam::Vector> violation,
+                    Eigen::Ref<gtsam::Vector> scaled_violation) const override;
 };
 
 /** Equality constraint that force g(x) = 0, where g(x) is a vector-valued
@@ -121,6 +162,7 @@ class VectorExpressionEquality : public EqualityConstraint {
                            const VectorP& tolerance)
       : expression_(expression), tolerance_(tolerance) {}
 
+  /// Merit factor, a CompiledExpressionFactor of the expression.
   gtsam::NoiseModelFactor::shared_ptr createFactor(
       const double mu,
       boost::optional<gtsam::Vector&> bias = boost::none) const override;
@@ -132,6 +174,51 @@ class VectorExpressionEquality : public EqualityConstraint {
   gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
 
   size_t dim() const override;
+
+  gtsam::Vector evaluate(const gtsam::Values& x,
+                         double* scaled_squared_norm) const override;
+
+  void evaluateInto(const gtsam::Values& x,
+                    Eigen::Ref<gtsam::Vector> violation,
+                    Eigen::Ref<gtsam::Vector> scaled_violation) const override;
+};
+
+/**
+ * Violations of a set of constraints in flat buffers: the violation of
+ * constraint i is the segment of dimension dim(i) at offsets[i]. Buffers are
+ * reused when evaluated again for constraints of the same total dimension.
+ */
+struct ConstraintViolations {
+  std::vector<size_t> offsets;     // offset of each constraint, then the total
+  gtsam::Vector violation;         // g(x) of all constraints
+  gtsam::Vector scaled_violation;  // g(x)/tolerance of all constraints
+
+  /// Number of constraints.
+  size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+  /// Dimension of constraint i.
+  size_t dim(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+  /// Violation g(x) of constraint i.
+  gtsam::Vector::ConstSegmentReturnType at(size_t i) const {
+    return violation.segment(offsets[i], dim(i));
+  }
+
+  /// Sum of squared tolerance-scaled violations.
+  double squaredNorm() const { return scaled_violation.squaredNorm(); }
+
+  /// True if constraint i is within tolerance.
+  bool feasible(size_t i) const {
+    return dim(i) == 0 ||
+           scaled_violation.segment(offsets[i], dim(i))
+                   .lpNorm<Eigen::Infinity>() <= 1.0;
+  }
+
+  /// True if all constraints are within tolerance.
+  bool feasible() const {
+    return scaled_violation.size() == 0 ||
+           scaled_violation.lpNorm<Eigen::Infinity>() <= 1.0;
+  }
 };
 
 /// Container of EqualityConstraint.
@@ -151,6 +238,31 @@ class EqualityConstraints : public std::vector<EqualityConstraint::shared_ptr> {
     insert(end(), other.begin(), other.end());
   }
 
+  /**
+   * Evaluate all constraints at x, each constraint once.
+   * @param x           values to evaluate the constraints at
+   * @param violations  if given, set to g(x) of each constraint
+   * @param pool        if given, constraints are evaluated in parallel
+   * @return the sum of squared tolerance-scaled violations; the sum is taken
+   * over fixed blocks of constraints in order, so it does not depend on
+   * scheduling.
+   */
+  double evaluate(const gtsam::Values& x,
+                  std::vector<gtsam::Vector>* violations = nullptr,
+                  ThreadPool* pool = nullptr) const;
+
+  /**
+   * Evaluate all constraints at x into the flat buffers of `violations`,
+   * without allocating per constraint. Buffers are only reallocated if the
+   * total dimension changed.
+   * @param x           values to evaluate the constraints at
+   * @param violations  buffers to write g(x) and g(x)/tolerance into
+   * @param pool        if given, constraints are evaluated in parallel
+   * @return the sum of squared tolerance-scaled violations
+   */
+  double evaluateInto(const gtsam::Values& x, ConstraintViolations* violations,
+                      ThreadPool* pool = nullptr) const;
+
   /// Emplace a shared pointer to constraint of given type.
   template <class DERIVEDCONSTRAINT, class... Args>
   IsDerived<DERIVEDCONSTRAINT> emplace_shared(Args&&... args) {
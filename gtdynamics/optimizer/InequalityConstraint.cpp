@@ -0,0 +1,60 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InequalityConstraint.cpp
+ * @brief Inequality constraints in constrained optimization.
+ */
+
+#include "gtdynamics/optimizer/InequalityConstraint.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "gtdynamics/optimizer/CompiledExpressionFactor.h"
+
+namespace gtdynamics {
+
+gtsam::NoiseModelFactor::shared_ptr DoubleExpressionInequality::createFactor(
+    const double mu, boost::optional<gtsam::Vector&> bias) const {
+  auto noise = gtsam::noiseModel::Isotropic::Sigma(1, tolerance_ / sqrt(mu));
+  double measure = 0.0;
+  if (bias) {
+    measure = -(*bias)(0);
+  }
+  return gtsam::NoiseModelFactor::shared_ptr(
+      new CompiledExpressionFactor<double>(noise, measure, expression_));
+}
+
+bool DoubleExpressionInequality::feasible(const gtsam::Values& x) const {
+  return expression_.value(x) >= -tolerance_;
+}
+
+gtsam::Vector DoubleExpressionInequality::operator()(
+    const gtsam::Values& x) const {
+  return (gtsam::Vector(1) << expression_.value(x)).finished();
+}
+
+gtsam::Vector DoubleExpressionInequality::toleranceScaledViolation(
+    const gtsam::Values& x) const {
+  const double result = expression_.value(x);
+  return (gtsam::Vector(1) << std::min(result, 0.0) / tolerance_).finished();
+}
+
+double InequalityConstraints::evaluate(
+    const gtsam::Values& x, std::vector<gtsam::Vector>* values) const {
+  if (values) values->resize(size());
+  double sum = 0;
+  for (size_t i = 0; i < size(); i++) {
+    const gtsam::Vector g = (*at(i))(x);
+    sum += at(i)->toleranceScaledViolation(x).squaredNorm();
+    if (values) (*values)[i] = g;
+  }
+  return sum;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,140 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  InequalityConstraint.h
+ * @brief Inequality constraints in constrained optimization.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Inequality constraint base class, for constraints g(x) >= 0.
+ */
+class InequalityConstraint {
+ public:
+  typedef InequalityConstraint This;
+  typedef boost::shared_ptr<This> shared_ptr;
+
+  /** Default constructor. */
+  InequalityConstraint() {}
+
+  /** Destructor. */
+  virtual ~InequalityConstraint() {}
+
+  /**
+   * @brief Create a factor on g(x) + bias, weighted as in
+   * EqualityConstraint::createFactor. Only the negative part of its error is
+   * a violation; PenaltyFactor builds the one-sided penalty from it.
+   *
+   * @param mu penalty parameter.
+   * @param bias additional bias.
+   * @return a factor representing 1/2 mu||g(x)+bias||_Diag(tolerance^2)^2.
+   */
+  virtual gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const = 0;
+
+  /**
+   * @brief Check if g(x) >= -tolerance.
+   *
+   * @param x values to evalute constraint at.
+   * @return bool representing if is feasible.
+   */
+  virtual bool feasible(const gtsam::Values& x) const = 0;
+
+  /**
+   * @brief Evaluate g(x).
+   *
+   * @param x values to evalute constraint at.
+   * @return g(x), which is feasible where non-negative.
+   */
+  virtual gtsam::Vector operator()(const gtsam::Values& x) const = 0;
+
+  /** @brief Violation min(0, g(x)) scaled by tolerance. */
+  virtual gtsam::Vector toleranceScaledViolation(
+      const gtsam::Values& x) const = 0;
+
+  /** @brief return the dimension of the constraint. */
+  virtual size_t dim() const = 0;
+};
+
+/** Inequality constraint that forces g(x) >= 0, where g(x) is a scalar-valued
+ * function. */
+class DoubleExpressionInequality : public InequalityConstraint {
+ protected:
+  gtsam::Expression<double> expression_;
+  double tolerance_;
+
+ public:
+  /**
+   * @brief Constructor.
+   *
+   * @param expression  expression representing g(x).
+   * @param tolerance   scalar representing tolerance.
+   */
+  DoubleExpressionInequality(const gtsam::Expression<double>& expression,
+                             const double& tolerance)
+      : expression_(expression), tolerance_(tolerance) {}
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<gtsam::Vector&> bias = boost::none) const override;
+
+  bool feasible(const gtsam::Values& x) const override;
+
+  gtsam::Vector operator()(const gtsam::Values& x) const override;
+
+  gtsam::Vector toleranceScaledViolation(const gtsam::Values& x) const override;
+
+  size_t dim() const override { return 1; }
+};
+
+/// Container of InequalityConstraint.
+class InequalityConstraints
+    : public std::vector<InequalityConstraint::shared_ptr> {
+ private:
+  using Base = std::vector<InequalityConstraint::shared_ptr>;
+
+  template <typename DERIVEDCONSTRAINT>
+  using IsDerived = typename std::enable_if<
+      std::is_base_of<InequalityConstraint, DERIVEDCONSTRAINT>::value>::type;
+
+ public:
+  InequalityConstraints() : Base() {}
+
+  /// Add a set of inequality constraints.
+  void add(const InequalityConstraints& other) {
+    insert(end(), other.begin(), other.end());
+  }
+
+  /**
+   * Evaluate all constraints at x.
+   * @param x       values to evaluate the constraints at
+   * @param values  if given, set to g(x) of each constraint
+   * @return the sum of squared tolerance-scaled violations
+   */
+  double evaluate(const gtsam::Values& x,
+                  std::vector<gtsam::Vector>* values = nullptr) const;
+
+  /// Emplace a shared pointer to constraint of given type.
+  template <class DERIVEDCONSTRAINT, class... Args>
+  IsDerived<DERIVEDCONSTRAINT> emplace_shared(Args&&... args) {
+    push_back(boost::allocate_shared<DERIVEDCONSTRAINT>(
+        Eigen::aligned_allocator<DERIVEDCONSTRAINT>(),
+        std::forward<Args>(args)...));
+  }
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearSolverBackend.cpp
+ * @brief Choice of the solver of the linear systems of LM steps.
+ */
+
+#include "gtdynamics/optimizer/LinearSolverBackend.h"
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+std::string LinearSolverBackendName(LinearSolverBackend backend) {
+  switch (backend) {
+    case LinearSolverBackend::AUTOMATIC:
+      return "AUTOMATIC";
+    case LinearSolverBackend::MULTIFRONTAL_CHOLESKY:
+      return "MULTIFRONTAL_CHOLESKY";
+    case LinearSolverBackend::MULTIFRONTAL_QR:
+      return "MULTIFRONTAL_QR";
+    case LinearSolverBackend::CHOLMOD:
+      return "CHOLMOD";
+    case LinearSolverBackend::BLOCK_TRIDIAGONAL:
+      return "BLOCK_TRIDIAGONAL";
+    case LinearSolverBackend::ITERATIVE:
+      return "ITERATIVE";
+  }
+  throw std::invalid_argument("LinearSolverBackendName: unknown backend.");
+}
+
+/* ************************************************************************* */
+LinearSolverBackend RecommendedLinearSolver(ProblemClass problem) {
+  switch (problem) {
+    case ProblemClass::KINEMATICS:
+    case ProblemClass::STATICS:
+    case ProblemClass::MULTI_PHASE_TRAJECTORY:
+      return LinearSolverBackend::MULTIFRONTAL_CHOLESKY;
+    case ProblemClass::TRAJECTORY:
+      return LinearSolverBackend::BLOCK_TRIDIAGONAL;
+  }
+  throw std::invalid_argument("RecommendedLinearSolver: unknown problem.");
+}
+
+/* ************************************************************************* */
+LinearSolverBackend ActiveLinearSolver(
+    const gtsam::LevenbergMarquardtParams &parameters, bool block_tridiagonal,
+    const PCGParameters *pcg) {
+  using Params = gtsam::NonlinearOptimizerParams;
+  if (pcg) return LinearSolverBackend::ITERATIVE;
+  if (block_tridiagonal) return LinearSolverBackend::BLOCK_TRIDIAGONAL;
+  switch (parameters.linearSolverType) {
+    case Params::MULTIFRONTAL_QR:
+    case Params::SEQUENTIAL_QR:
+      return LinearSolverBackend::MULTIFRONTAL_QR;
+    case Params::CHOLMOD:
+      return LinearSolverBackend::CHOLMOD;
+    case Params::Iterative:
+      return LinearSolverBackend::ITERATIVE;
+    default:
+      return LinearSolverBackend::MULTIFRONTAL_CHOLESKY;
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LinearSolverBackend.h
+ * @brief Choice of the solver of the linear systems of LM steps.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+
+#include <string>
+
+#include "gtdynamics/optimizer/PCGSolver.h"
+
+namespace gtdynamics {
+
+/**
+ * How the linear system of every Levenberg-Marquardt step is solved.
+ *  - MULTIFRONTAL_CHOLESKY and MULTIFRONTAL_QR eliminate the graph into a
+ *    Bayes tree, GTSAM's default and its more robust, slower variant.
+ *  - CHOLMOD is GTSAM's supernodal sparse Cholesky, only available when
+ *    GTSAM is built with SuiteSparse; GTSAM throws otherwise.
+ *  - BLOCK_TRIDIAGONAL is BlockTridiagonalSolve, linear in the number of
+ *    time steps, for trajectories whose factors only couple consecutive
+ *    steps.
+ *  - ITERATIVE is PCGSolve, for horizons too long to factorize.
+ * AUTOMATIC leaves the choice to the older parameters: pcg, then
+ * block_tridiagonal, then the linearSolverType of the LM parameters.
+ */
+enum class LinearSolverBackend {
+  AUTOMATIC = 0,
+  MULTIFRONTAL_CHOLESKY = 1,
+  MULTIFRONTAL_QR = 2,
+  CHOLMOD = 3,
+  BLOCK_TRIDIAGONAL = 4,
+  ITERATIVE = 5
+};
+
+/// Kinds of problems solved by the optimizers, see RecommendedLinearSolver.
+enum class ProblemClass {
+  KINEMATICS = 0,              ///< inverse kinematics, one or a few slices
+  STATICS = 1,                 ///< statics, one or a few slices
+  TRAJECTORY = 2,              ///< fixed time step trajectories
+  MULTI_PHASE_TRAJECTORY = 3   ///< trajectories with phase durations
+};
+
+/// Name of a backend, e.g. "MULTIFRONTAL_CHOLESKY".
+std::string LinearSolverBackendName(LinearSolverBackend backend);
+
+/**
+ * Backend that is usually fastest for a class of problems. Kinematics and
+ * statics graphs are small and eliminate quickly by multifrontal Cholesky.
+ * Fixed time step trajectories are block-tridiagonal in time. Phase
+ * durations couple all time steps of a phase, so multi-phase trajectories
+ * are eliminated by multifrontal Cholesky, ideally in TimeMajorOrdering.
+ */
+LinearSolverBackend RecommendedLinearSolver(ProblemClass problem);
+
+/**
+ * Backend used by OptimizeLM for these settings, never AUTOMATIC: pcg, if
+ * given, takes precedence over block_tridiagonal, itself over
+ * parameters.linearSolverType. Sequential GTSAM solvers are reported as
+ * their multifrontal counterparts.
+ */
+LinearSolverBackend ActiveLinearSolver(
+    const gtsam::LevenbergMarquardtParams &parameters, bool block_tridiagonal,
+    const PCGParameters *pcg);
+
+}  // namespace gtdynamics
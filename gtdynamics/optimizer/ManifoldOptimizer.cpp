@@ -0,0 +1,324 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ManifoldOptimizer.cpp
+ * @brief Constrained optimization on the kinematic constraint manifold.
+ */
+
+#include "gtdynamics/optimizer/ManifoldOptimizer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Joint pose constraints vanish on the manifold up to round-off.
+static constexpr double kImpliedTolerance = 1e-9;
+
+/* ************************************************************************* */
+KinematicManifold::KinematicManifold(const Robot &robot) : robot_(robot) {
+  nodes_.assign(robot_.numLinkSlots(), -1);
+  chains_.resize(robot_.numNodes());
+  for (size_t n = 0; n < robot_.numNodes(); ++n) {
+    nodes_[robot_.linkIds()[n]] = n;
+    for (int m = n; m >= 0; m = robot_.parentNodes()[m])
+      chains_[n].push_back(m);
+    std::reverse(chains_[n].begin(), chains_[n].end());
+  }
+}
+
+/* ************************************************************************* */
+bool KinematicManifold::isEliminated(Key key) const {
+  const auto i = DynamicsSymbol::LinkIdx(key);
+  if (i >= nodes_.size() || nodes_[i] < 0) return false;
+  if (key != internal::PoseKey(i, DynamicsSymbol::Time(key))) return false;
+  return robot_.parentNodes()[nodes_[i]] >= 0 || robot_.isFixed()[i];
+}
+
+/* ************************************************************************* */
+KeyVector KinematicManifold::basis(Key pose_key) const {
+  const int i = DynamicsSymbol::LinkIdx(pose_key);
+  const int t = DynamicsSymbol::Time(pose_key);
+  const std::vector<int> &chain = chains_[nodes_[i]];
+  KeyVector keys;
+  const int root = robot_.linkIds()[chain.front()];
+  if (!robot_.isFixed()[root]) keys.push_back(internal::PoseKey(root, t));
+  for (size_t k = 1; k < chain.size(); ++k)
+    keys.push_back(internal::JointAngleKey(robot_.jointIds()[chain[k]], t));
+  return keys;
+}
+
+/* ************************************************************************* */
+Pose3 KinematicManifold::pose(Key pose_key, const Values &x,
+                              std::vector<Matrix> *H) const {
+  const int i = DynamicsSymbol::LinkIdx(pose_key);
+  const int t = DynamicsSymbol::Time(pose_key);
+  const std::vector<int> &chain = chains_[nodes_[i]];
+  const int root = robot_.linkIds()[chain.front()];
+  const bool floating = !robot_.isFixed()[root];
+
+  // wTm for every node m on the chain, as in CompiledRobot.
+  std::vector<Pose3> wT(chain.size());
+  wT[0] = floating ? x.at<Pose3>(internal::PoseKey(root, t))
+                   : robot_.fixedPoses()[root];
+  for (size_t k = 1; k < chain.size(); ++k) {
+    const int m = chain[k];
+    const double q =
+        x.at<double>(internal::JointAngleKey(robot_.jointIds()[m], t));
+    wT[k] = wT[k - 1] * robot_.restPoses()[m] *
+            Pose3::Expmap(robot_.screwAxes().col(m) * q);
+  }
+
+  // In the link frame, a root perturbation moves the link by Ad(iTr), and a
+  // joint angle by Ad(iTm) S_m.
+  if (H) {
+    H->clear();
+    const Pose3 iTw = wT.back().inverse();
+    if (floating) H->push_back((iTw * wT[0]).AdjointMap());
+    for (size_t k = 1; k < chain.size(); ++k) {
+      H->push_back((iTw * wT[k]).AdjointMap() *
+                   robot_.screwAxes().col(chain[k]));
+    }
+  }
+  return wT.back();
+}
+
+/* ************************************************************************* */
+Values KinematicManifold::reduce(const Values &values) const {
+  Values reduced;
+  for (const auto &key_value : values) {
+    if (!isEliminated(key_value.key))
+      reduced.insert(key_value.key, key_value.value);
+  }
+  return reduced;
+}
+
+/* ************************************************************************* */
+Values KinematicManifold::complete(const Values &reduced,
+                                   const KeyVector &keys) const {
+  Values values;
+  for (const Key key : keys) {
+    if (isEliminated(key))
+      values.insert(key, pose(key, reduced));
+    else
+      values.insert(key, reduced.at(key));
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+// Keys of the factor on the manifold: its own keys that are not eliminated,
+// then the bases of the eliminated ones.
+static KeyVector ManifoldKeys(const KinematicManifold &manifold,
+                              const gtsam::NoiseModelFactor &factor) {
+  KeyVector keys;
+  const auto add = [&keys](Key key) {
+    if (std::find(keys.begin(), keys.end(), key) == keys.end())
+      keys.push_back(key);
+  };
+  for (const Key key : factor.keys())
+    if (!manifold.isEliminated(key)) add(key);
+  for (const Key key : factor.keys())
+    if (manifold.isEliminated(key))
+      for (const Key basis_key : manifold.basis(key)) add(basis_key);
+  return keys;
+}
+
+/* ************************************************************************* */
+ManifoldFactor::ManifoldFactor(
+    const KinematicManifold::shared_ptr &manifold,
+    const gtsam::NoiseModelFactor::shared_ptr &factor)
+    : gtsam::NoiseModelFactor(factor->noiseModel(),
+                              ManifoldKeys(*manifold, *factor)),
+      manifold_(manifold),
+      factor_(factor) {
+  const auto position = [this](Key key) {
+    return std::find(keys_.begin(), keys_.end(), key) - keys_.begin();
+  };
+  positions_.resize(factor->size());
+  for (size_t k = 0; k < factor->size(); ++k) {
+    const Key key = factor->keys()[k];
+    if (!manifold->isEliminated(key)) {
+      positions_[k].push_back(position(key));
+      continue;
+    }
+    for (const Key basis_key : manifold->basis(key))
+      positions_[k].push_back(position(basis_key));
+  }
+}
+
+/* ************************************************************************* */
+Vector ManifoldFactor::unwhitenedError(
+    const Values &x, boost::optional<std::vector<Matrix> &> H) const {
+  Values values;
+  std::vector<std::vector<Matrix>> H_poses(factor_->size());
+  for (size_t k = 0; k < factor_->size(); ++k) {
+    const Key key = factor_->keys()[k];
+    if (manifold_->isEliminated(key))
+      values.insert(key, manifold_->pose(key, x, H ? &H_poses[k] : nullptr));
+    else
+      values.insert(key, x.at(key));
+  }
+  if (!H) return factor_->unwhitenedError(values);
+
+  std::vector<Matrix> H_factor(factor_->size());
+  const Vector error = factor_->unwhitenedError(values, H_factor);
+  H->resize(size());
+  for (size_t p = 0; p < size(); ++p)
+    (*H)[p] = Matrix::Zero(error.size(), x.at(keys_[p]).dim());
+  for (size_t k = 0; k < factor_->size(); ++k) {
+    if (!manifold_->isEliminated(factor_->keys()[k])) {
+      (*H)[positions_[k].front()] += H_factor[k];
+      continue;
+    }
+    for (size_t b = 0; b < positions_[k].size(); ++b)
+      (*H)[positions_[k][b]] += H_factor[k] * H_poses[k][b];
+  }
+  return error;
+}
+
+/* ************************************************************************* */
+namespace {
+/// An equality constraint on eliminated poses, evaluated on the manifold.
+class ManifoldConstraint : public EqualityConstraint {
+ public:
+  ManifoldConstraint(const KinematicManifold::shared_ptr &manifold,
+                     const EqualityConstraint::shared_ptr &constraint,
+                     const KeyVector &keys)
+      : manifold_(manifold), constraint_(constraint), keys_(keys) {}
+
+  gtsam::NoiseModelFactor::shared_ptr createFactor(
+      const double mu,
+      boost::optional<Vector &> bias = boost::none) const override {
+    return boost::make_shared<ManifoldFactor>(
+        manifold_, constraint_->createFactor(mu, bias));
+  }
+
+  bool feasible(const Values &x) const override {
+    return constraint_->feasible(manifold_->complete(x, keys_));
+  }
+
+  Vector operator()(const Values &x) const override {
+    return (*constraint_)(manifold_->complete(x, keys_));
+  }
+
+  Vector toleranceScaledViolation(const Values &x) const override {
+    return constraint_->toleranceScaledViolation(manifold_->complete(x, keys_));
+  }
+
+  size_t dim() const override { return constraint_->dim(); }
+
+ private:
+  KinematicManifold::shared_ptr manifold_;
+  EqualityConstraint::shared_ptr constraint_;
+  KeyVector keys_;  // keys of the original constraint
+};
+}  // namespace
+
+/* ************************************************************************* */
+ManifoldOptimizer::ManifoldOptimizer(
+    const Robot &robot,
+    const boost::shared_ptr<const ConstrainedOptimizer> &optimizer)
+    : manifold_(boost::make_shared<KinematicManifold>(robot)),
+      optimizer_(optimizer) {}
+
+/* ************************************************************************* */
+bool ManifoldOptimizer::isImplied(const gtsam::NoiseModelFactor &factor,
+                                  const Values &values) const {
+  if (factor.size() != 3) return false;
+  const CompiledRobot &robot = manifold_->compiledRobot();
+  for (const Key q_key : factor.keys()) {
+    const auto j = DynamicsSymbol::JointIdx(q_key);
+    if (j >= robot.numJointSlots() || robot.jointParentLinks()[j] < 0)
+      continue;
+    const int t = DynamicsSymbol::Time(q_key);
+    if (q_key != internal::JointAngleKey(j, t)) continue;
+    const Key parent = internal::PoseKey(robot.jointParentLinks()[j], t);
+    const Key child = internal::PoseKey(robot.jointChildLinks()[j], t);
+    const auto has = [&factor](Key key) {
+      return std::find(factor.begin(), factor.end(), key) != factor.end();
+    };
+    if (!has(parent) || !has(child)) continue;
+    if (!manifold_->isEliminated(parent) && !manifold_->isEliminated(child))
+      return false;
+    return factor.unwhitenedError(manifold_->complete(values, factor.keys()))
+               .norm() < kImpliedTolerance;
+  }
+  return false;
+}
+
+/* ************************************************************************* */
+gtsam::Values ManifoldOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph &graph,
+    const EqualityConstraints &constraints, const gtsam::Values &initial_values,
+    ConstrainedOptResult *intermediate_result) const {
+  const ProfileTimer timer;
+  const Values reduced_values = manifold_->reduce(initial_values);
+  const auto eliminates = [this](const gtsam::NonlinearFactor &factor) {
+    return std::any_of(factor.begin(), factor.end(), [this](Key key) {
+      return manifold_->isEliminated(key);
+    });
+  };
+
+  // Factors on eliminated poses are moved onto the manifold.
+  gtsam::NonlinearFactorGraph reduced_graph;
+  for (const auto &factor : graph) {
+    if (!factor) continue;
+    if (!eliminates(*factor)) {
+      reduced_graph.push_back(factor);
+      continue;
+    }
+    auto noise_model_factor =
+        boost::dynamic_pointer_cast<gtsam::NoiseModelFactor>(factor);
+    if (!noise_model_factor)
+      throw std::invalid_argument(
+          "ManifoldOptimizer: factors on link poses need to be "
+          "NoiseModelFactors.");
+    if (isImplied(*noise_model_factor, reduced_values)) continue;
+    auto manifold_factor =
+        boost::make_shared<ManifoldFactor>(manifold_, noise_model_factor);
+    if (!manifold_factor->empty()) reduced_graph.push_back(manifold_factor);
+  }
+
+  EqualityConstraints reduced_constraints;
+  for (const auto &constraint : constraints) {
+    const auto factor = constraint->createFactor(1.0);
+    if (!eliminates(*factor)) {
+      reduced_constraints.push_back(constraint);
+      continue;
+    }
+    if (isImplied(*factor, reduced_values)) continue;
+    if (ManifoldKeys(*manifold_, *factor).empty()) continue;
+    reduced_constraints.emplace_shared<ManifoldConstraint>(
+        manifold_, constraint, factor->keys());
+  }
+  if (intermediate_result)
+    intermediate_result->profile.graph_construction += timer.elapsed();
+
+  Values result = optimizer_->optimize(reduced_graph, reduced_constraints,
+                                       reduced_values, intermediate_result);
+
+  // Recover the eliminated poses.
+  KeyVector eliminated;
+  for (const Key key : initial_values.keys())
+    if (manifold_->isEliminated(key)) eliminated.push_back(key);
+  result.insert(manifold_->complete(result, eliminated));
+  return result;
+}
+
+}  // namespace gtdynamics
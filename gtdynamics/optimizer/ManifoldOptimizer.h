@@ -0,0 +1,162 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ManifoldOptimizer.h
+ * @brief Constrained optimization on the kinematic constraint manifold, with
+ * link poses eliminated in favor of joint angles.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <vector>
+
+#include "gtdynamics/optimizer/ConstrainedOptimizer.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+
+namespace gtdynamics {
+
+/**
+ * The manifold of link poses that satisfy the joint pose constraints of a
+ * tree-structured robot, parameterized by the joint angles and the poses of
+ * floating roots, at every time step.
+ *
+ * A pose key PoseKey(i, t) is eliminated if link i is not a floating root:
+ * its pose is then the forward kinematics of CompiledRobot along the chain
+ * from the root to link i, using JointAngleKey(j, t) of the joints on it.
+ */
+class KinematicManifold {
+ public:
+  using shared_ptr = boost::shared_ptr<const KinematicManifold>;
+
+  /// Constructor; the robot needs to have a tree structure.
+  explicit KinematicManifold(const Robot &robot);
+
+  const CompiledRobot &compiledRobot() const { return robot_; }
+
+  /// True if `key` is the pose of a link that is not a floating root.
+  bool isEliminated(gtsam::Key key) const;
+
+  /**
+   * Keys the eliminated pose `pose_key` depends on: the pose of its floating
+   * root, if any, then the joint angles from the root down to the link.
+   */
+  gtsam::KeyVector basis(gtsam::Key pose_key) const;
+
+  /**
+   * Pose of the link of the eliminated `pose_key`.
+   * @param pose_key  an eliminated pose key
+   * @param x         values with the keys in basis(pose_key)
+   * @param H         if given, set to the Jacobians of the pose with respect
+   *                  to the keys in basis(pose_key), in that order
+   */
+  gtsam::Pose3 pose(gtsam::Key pose_key, const gtsam::Values &x,
+                    std::vector<gtsam::Matrix> *H = nullptr) const;
+
+  /// Return `values` without the eliminated poses.
+  gtsam::Values reduce(const gtsam::Values &values) const;
+
+  /**
+   * Return values for `keys`: eliminated poses are computed from `reduced`,
+   * the other keys are copied from it.
+   */
+  gtsam::Values complete(const gtsam::Values &reduced,
+                         const gtsam::KeyVector &keys) const;
+
+ private:
+  CompiledRobot robot_;
+  std::vector<int> nodes_;                // node of each link id, -1 if none
+  std::vector<std::vector<int>> chains_;  // nodes from the root, per node
+};
+
+/**
+ * A factor on eliminated link poses, expressed on the manifold coordinates:
+ * the poses are computed by KinematicManifold::pose, and the Jacobians with
+ * respect to them are chained onto the joint angles and root poses.
+ */
+class ManifoldFactor : public gtsam::NoiseModelFactor {
+ public:
+  /**
+   * Constructor
+   * @param manifold  the kinematic manifold
+   * @param factor    factor on eliminated and other keys
+   */
+  ManifoldFactor(const KinematicManifold::shared_ptr &manifold,
+                 const gtsam::NoiseModelFactor::shared_ptr &factor);
+
+  gtsam::Vector unwhitenedError(
+      const gtsam::Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H =
+          boost::none) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<ManifoldFactor>(*this);
+  }
+
+  /// The original factor.
+  const gtsam::NoiseModelFactor::shared_ptr &factor() const {
+    return factor_;
+  }
+
+ private:
+  KinematicManifold::shared_ptr manifold_;
+  gtsam::NoiseModelFactor::shared_ptr factor_;
+
+  // For each key of factor_, the positions in keys() it depends on: the key
+  // itself, or the basis of an eliminated pose.
+  std::vector<std::vector<size_t>> positions_;
+};
+
+/**
+ * ManifoldOptimizer eliminates the link poses of a robot from a constrained
+ * problem, and solves the reduced problem with another constrained
+ * optimizer. Joint pose constraints and factors, i.e. those on exactly the
+ * parent pose, child pose and angle of a joint that vanish on the manifold,
+ * are satisfied by construction and dropped; all other factors and
+ * constraints on eliminated poses are wrapped in a ManifoldFactor. Factors
+ * that only involve fixed links are constant and dropped as well.
+ *
+ * Twists and other dynamics variables are not eliminated. Intermediate
+ * results hold the reduced values; the returned values also contain the
+ * eliminated poses of `initial_values`, recovered by forward kinematics.
+ */
+class ManifoldOptimizer : public ConstrainedOptimizer {
+ public:
+  /**
+   * Constructor
+   * @param robot      the robot whose link poses to eliminate
+   * @param optimizer  optimizer for the reduced problem
+   */
+  ManifoldOptimizer(
+      const Robot &robot,
+      const boost::shared_ptr<const ConstrainedOptimizer> &optimizer);
+
+  /// Inequalities are not supported; the base version throws.
+  using ConstrainedOptimizer::optimize;
+
+  /// Run optimization on the manifold.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph &graph,
+      const EqualityConstraints &constraints,
+      const gtsam::Values &initial_values,
+      ConstrainedOptResult *intermediate_result = nullptr) const override;
+
+  const KinematicManifold &manifold() const { return *manifold_; }
+
+ private:
+  KinematicManifold::shared_ptr manifold_;
+  boost::shared_ptr<const ConstrainedOptimizer> optimizer_;
+
+  /// True if `factor` is a joint pose constraint, zero at `values`.
+  bool isImplied(const gtsam::NoiseModelFactor &factor,
+                 const gtsam::Values &values) const;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,144 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryFootprint.cpp
+ * @brief Memory estimate of solving a factor graph, before solving it.
+ */
+
+#include "gtdynamics/optimizer/MemoryFootprint.h"
+
+#include <gtsam/symbolic/SymbolicBayesTree.h>
+#include <gtsam/symbolic/SymbolicFactorGraph.h>
+
+#include <boost/make_shared.hpp>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace gtdynamics {
+
+namespace {
+// Tangent dimension of every variable.
+using Dimensions = std::map<gtsam::Key, size_t>;
+
+// Nonzeros of the R factors of all cliques at or below `clique`, as in
+// OptimizerProfile, with the dimensions of the variables.
+size_t FactorNonzeros(const gtsam::SymbolicBayesTreeClique &clique,
+                      const Dimensions &dims) {
+  const auto &conditional = *clique.conditional();
+  size_t r = 0, s = 0;
+  for (auto it = conditional.beginFrontals(); it != conditional.endFrontals();
+       ++it)
+    r += dims.at(*it);
+  for (auto it = conditional.beginParents(); it != conditional.endParents();
+       ++it)
+    s += dims.at(*it);
+  size_t nonzeros = r * (r + 1) / 2 + r * s;
+  for (auto &&child : clique.children) nonzeros += FactorNonzeros(*child, dims);
+  return nonzeros;
+}
+}  // namespace
+
+/* ************************************************************************* */
+MemoryFootprint EstimateMemoryFootprint(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    const boost::optional<gtsam::Ordering> &ordering) {
+  MemoryFootprint footprint;
+  Dimensions dims;
+  gtsam::SymbolicFactorGraph symbolic;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    ++footprint.num_factors;
+    size_t cols = 0;
+    for (gtsam::Key key : factor->keys()) {
+      auto it = dims.find(key);
+      if (it == dims.end()) {
+        if (!values.exists(key))
+          throw std::invalid_argument(
+              "EstimateMemoryFootprint: no value for a key of the graph");
+        it = dims.emplace(key, values.at(key).dim()).first;
+      }
+      cols += it->second;
+    }
+    footprint.num_rows += factor->dim();
+    footprint.jacobian_nonzeros += factor->dim() * cols;
+    symbolic.push_back(boost::make_shared<gtsam::SymbolicFactor>(
+        gtsam::SymbolicFactor::FromKeys(factor->keys())));
+  }
+  footprint.num_variables = dims.size();
+  for (auto &&dim : dims) footprint.num_columns += dim.second;
+  if (symbolic.empty()) return footprint;
+
+  const auto bayes_tree = symbolic.eliminateMultifrontal(
+      ordering ? *ordering
+               : gtsam::Ordering::Create(gtsam::Ordering::COLAMD, symbolic));
+  for (auto &&root : bayes_tree->roots())
+    footprint.factor_nonzeros += FactorNonzeros(*root, dims);
+  return footprint;
+}
+
+/* ************************************************************************* */
+MemoryFootprint MeasureMemoryFootprint(
+    const std::function<gtsam::NonlinearFactorGraph()> &build,
+    const gtsam::Values &values,
+    const boost::optional<gtsam::Ordering> &ordering,
+    gtsam::NonlinearFactorGraph *graph) {
+  gtsam::NonlinearFactorGraph built;
+  AllocationStats construction;
+  {
+    AllocationScope scope;
+    built = build();
+    construction = scope.stats();
+  }
+  MemoryFootprint footprint = EstimateMemoryFootprint(built, values, ordering);
+  footprint.construction = construction;
+  if (graph) *graph = std::move(built);
+  return footprint;
+}
+
+/* ************************************************************************* */
+std::string MemoryFootprint::toJson() const {
+  std::ostringstream os;
+  os << std::setprecision(10);
+  os << "{\n"
+     << "  \"num_factors\": " << num_factors << ",\n"
+     << "  \"num_variables\": " << num_variables << ",\n"
+     << "  \"num_rows\": " << num_rows << ",\n"
+     << "  \"num_columns\": " << num_columns << ",\n"
+     << "  \"jacobian_nonzeros\": " << jacobian_nonzeros << ",\n"
+     << "  \"factor_nonzeros\": " << factor_nonzeros << ",\n"
+     << "  \"fill_in\": " << fillIn() << ",\n"
+     << "  \"construction_allocations\": " << construction.allocations
+     << ",\n"
+     << "  \"construction_bytes\": " << construction.bytes_allocated << ",\n"
+     << "  \"construction_peak_bytes\": " << construction.peak_bytes << ",\n"
+     << "  \"retained_bytes\": " << construction.retainedBytes() << ",\n"
+     << "  \"linear_system_bytes\": " << linearSystemBytes() << ",\n"
+     << "  \"total_bytes\": " << totalBytes() << "\n"
+     << "}\n";
+  return os.str();
+}
+
+/* ************************************************************************* */
+void MemoryFootprint::print(std::ostream &os) const {
+  os << num_factors << " factors, " << num_variables << " variables ("
+     << num_rows << " x " << num_columns << ")\n"
+     << "  " << jacobian_nonzeros << " Jacobian nonzeros, " << factor_nonzeros
+     << " R nonzeros (fill-in " << fillIn() << ")\n"
+     << "  linear systems: " << linearSystemBytes() / 1e6 << " MB\n";
+  if (AllocationScope::kCompiled)
+    os << "  construction: " << construction.allocations << " allocations, "
+       << construction.bytes_allocated / 1e6 << " MB, peak "
+       << construction.peak_bytes / 1e6 << " MB, retained "
+       << construction.retainedBytes() / 1e6 << " MB\n";
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MemoryFootprint.h
+ * @brief Memory estimate of solving a factor graph, before solving it.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+#include "gtdynamics/utils/AllocationTracker.h"
+
+namespace gtdynamics {
+
+/**
+ * Size of a factor graph and of the linear systems of solving it, found from
+ * its structure alone: nothing is linearized or eliminated numerically, so
+ * it is cheap enough to decide whether a solve fits before starting it.
+ */
+struct MemoryFootprint {
+  size_t num_factors = 0;        ///< non-null factors
+  size_t num_variables = 0;      ///< distinct keys of the factors
+  size_t num_rows = 0;           ///< residual dimension
+  size_t num_columns = 0;        ///< tangent dimension of the variables
+  size_t jacobian_nonzeros = 0;  ///< entries in the dense Jacobian blocks
+  size_t factor_nonzeros = 0;    ///< entries in R after elimination
+
+  /// Heap use while building the graph, see MeasureMemoryFootprint; all 0
+  /// unless allocation tracking is compiled in.
+  AllocationStats construction;
+
+  /// Fill-in: nonzeros of R relative to those of the Jacobian.
+  double fillIn() const {
+    return jacobian_nonzeros ? double(factor_nonzeros) / jacobian_nonzeros
+                             : 0.0;
+  }
+
+  /// Bytes of the doubles of one linearization and elimination: Jacobian,
+  /// right-hand side, R and solution. Index structures come on top.
+  size_t linearSystemBytes() const {
+    return sizeof(double) *
+           (jacobian_nonzeros + num_rows + factor_nonzeros + num_columns);
+  }
+
+  /// Bytes held by the graph, if measured, plus linearSystemBytes().
+  size_t totalBytes() const {
+    return construction.retainedBytes() + linearSystemBytes();
+  }
+
+  /// Return the footprint as a JSON object.
+  std::string toJson() const;
+
+  /// Print a human-readable summary.
+  void print(std::ostream &os) const;
+};
+
+/**
+ * Estimate the footprint of solving `graph`. The Jacobian nonzeros are the
+ * factor dimensions times the dimensions of their variables, and those of R
+ * come from symbolic multifrontal elimination, so they are exact for the
+ * Gaussian factor graphs Levenberg-Marquardt solves with the same ordering.
+ * @param graph    the graph
+ * @param values   values of all keys of the graph, only for their dimensions
+ * @param ordering elimination ordering, COLAMD if not given
+ */
+MemoryFootprint EstimateMemoryFootprint(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    const boost::optional<gtsam::Ordering> &ordering = boost::none);
+
+/**
+ * Build a graph with `build`, e.g. a DynamicsGraph, Kinematics or Trajectory
+ * builder, counting its heap allocations in an AllocationScope, and estimate
+ * its footprint. Allocations of threads started by `build` are not counted.
+ * @param build    returns the graph
+ * @param values   values of all keys of the graph, only for their dimensions
+ * @param ordering elimination ordering, COLAMD if not given
+ * @param graph    if given, set to the built graph
+ */
+MemoryFootprint MeasureMemoryFootprint(
+    const std::function<gtsam::NonlinearFactorGraph()> &build,
+    const gtsam::Values &values,
+    const boost::optional<gtsam::Ordering> &ordering = boost::none,
+    gtsam::NonlinearFactorGraph *graph = nullptr);
+
+}  // namespace gtdynamics
@@ -0,0 +1,225 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiResolutionOptimizer.cpp
+ * @brief Coarse-to-fine optimization of multi-phase trajectories.
+ */
+
+#include "gtdynamics/optimizer/MultiResolutionOptimizer.h"
+
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/base/Lie.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Key;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Value;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+template <typename T>
+T Lerp(const T &a, const T &b, double w) {
+  return (1 - w) * a + w * b;
+}
+
+template <typename T>
+T Slerp(const T &a, const T &b, double w) {
+  return gtsam::interpolate<T>(a, b, w);
+}
+
+// Insert f(a, b, w) at `key` if both values are of type T.
+template <typename T>
+bool InterpolateAs(const Value &a, const Value &b, double w, Key key,
+                   T (*f)(const T &, const T &, double), Values *values) {
+  auto A = dynamic_cast<const gtsam::GenericValue<T> *>(&a);
+  auto B = dynamic_cast<const gtsam::GenericValue<T> *>(&b);
+  if (!A || !B) return false;
+  values->insert(key, f(A->value(), B->value(), w));
+  return true;
+}
+
+// Insert the interpolation of a and b at `key`, or the nearest one.
+void Interpolate(const Value &a, const Value &b, double w, Key key,
+                 Values *values) {
+  if (InterpolateAs<double>(a, b, w, key, &Lerp<double>, values) ||
+      InterpolateAs<Vector>(a, b, w, key, &Lerp<Vector>, values) ||
+      InterpolateAs<gtsam::Vector6>(a, b, w, key, &Lerp<gtsam::Vector6>,
+                                    values) ||
+      InterpolateAs<gtsam::Vector3>(a, b, w, key, &Lerp<gtsam::Vector3>,
+                                    values) ||
+      InterpolateAs<Pose3>(a, b, w, key, &Slerp<Pose3>, values) ||
+      InterpolateAs<Rot3>(a, b, w, key, &Slerp<Rot3>, values))
+    return;
+  values->insert(key, w < 0.5 ? a : b);
+}
+
+// Key of the same quantity as `key`, at time step k.
+Key AtStep(Key key, uint64_t k) {
+  return DynamicsSymbol::Prefix(key) |
+         DynamicsSymbol::RobotTime(DynamicsSymbol::RobotInstance(key), k);
+}
+
+// Position of each time step of `fine` in the time steps of `coarse`.
+std::vector<double> CoarsePositions(const Trajectory &coarse,
+                                    const Trajectory &fine) {
+  if (coarse.numPhases() != fine.numPhases() || !fine.numPhases())
+    throw std::invalid_argument(
+        "MultiResolutionOptimizer: trajectories need the same phases.");
+  std::vector<double> positions{0.0};
+  int coarse_start = 0;
+  for (size_t p = 0; p < fine.numPhases(); ++p) {
+    const double n_c = coarse.phase(p).numTimeSteps();
+    const size_t n_f = fine.phase(p).numTimeSteps();
+    for (size_t i = 1; i <= n_f; ++i)
+      positions.push_back(coarse_start + n_c * i / n_f);
+    coarse_start = coarse.getEndTimeStep(p);
+  }
+  return positions;
+}
+}  // namespace
+
+/* ************************************************************************* */
+MultiResolutionOptimizer::MultiResolutionOptimizer(
+    const Robot &robot, const DynamicsGraph &graph_builder,
+    const Trajectory &trajectory, const Objectives &objectives,
+    const MultiResolutionParameters &parameters)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      objectives_(objectives),
+      p_(parameters) {
+  if (p_.num_levels == 0 || p_.refinement < 1)
+    throw std::invalid_argument(
+        "MultiResolutionOptimizer: need at least one level and a positive "
+        "refinement.");
+  size_t divisor = 1;
+  for (size_t l = 1; l < p_.num_levels; ++l) divisor *= p_.refinement;
+  for (size_t l = 0; l < p_.num_levels; ++l) {
+    levels_.push_back(Coarsen(trajectory, divisor));
+    divisor /= p_.refinement;
+  }
+}
+
+/* ************************************************************************* */
+Trajectory MultiResolutionOptimizer::Coarsen(const Trajectory &trajectory,
+                                             size_t divisor) {
+  if (divisor == 0)
+    throw std::invalid_argument(
+        "MultiResolutionOptimizer: divisor should be positive.");
+  std::vector<Phase> phases;
+  size_t k = 0;
+  for (auto &&phase : trajectory.phases()) {
+    const size_t n = std::max<size_t>(
+        1, (phase.numTimeSteps() + divisor - 1) / divisor);
+    phases.push_back(phase.resampled(k, n));
+    k += n;
+  }
+  return Trajectory(phases);
+}
+
+/* ************************************************************************* */
+Values MultiResolutionOptimizer::Upsample(const Trajectory &coarse,
+                                          const Values &coarse_values,
+                                          const Trajectory &fine) {
+  const std::vector<double> positions = CoarsePositions(coarse, fine);
+  const uint64_t K = coarse.getEndTimeStep(coarse.numPhases() - 1);
+  const Key phase_prefix = DynamicsSymbol::Prefix(PhaseKey(0));
+
+  // Keys of every coarse time step; phase durations and others apart.
+  Values values;
+  std::vector<std::vector<Key>> keys_at(K + 1);
+  for (auto &&key_value : coarse_values) {
+    const Key key = key_value.key;
+    const uint64_t k = DynamicsSymbol::Step(key);
+    if (DynamicsSymbol::Prefix(key) == phase_prefix &&
+        k < fine.numPhases()) {
+      const double ratio = double(coarse.phase(k).numTimeSteps()) /
+                           fine.phase(k).numTimeSteps();
+      values.insert(key, coarse_values.at<double>(key) * ratio);
+    } else if (k <= K) {
+      keys_at[k].push_back(key);
+    } else {
+      values.insert(key, key_value.value);
+    }
+  }
+
+  for (size_t k = 0; k < positions.size(); ++k) {
+    const uint64_t k0 = std::min<uint64_t>(std::floor(positions[k]), K);
+    const uint64_t k1 = std::min<uint64_t>(k0 + 1, K);
+    const double w = positions[k] - k0;
+    for (Key key0 : keys_at[k0]) {
+      const Key key1 = AtStep(key0, k1);
+      const Value &value0 = coarse_values.at(key0);
+      if (coarse_values.exists(key1))
+        Interpolate(value0, coarse_values.at(key1), w, AtStep(key0, k),
+                    &values);
+      else
+        values.insert(AtStep(key0, k), value0);
+    }
+    // Variables that only exist at the later step, e.g. new contacts.
+    if (k1 == k0) continue;
+    for (Key key1 : keys_at[k1]) {
+      const Key key = AtStep(key1, k);
+      if (!values.exists(key)) values.insert(key, coarse_values.at(key1));
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values MultiResolutionOptimizer::optimize(
+    const boost::optional<Values> &initial,
+    std::vector<MultiResolutionLevel> *report) const {
+  const Optimizer optimizer(p_.optimization);
+  const double coarse_dt =
+      p_.dt * std::pow(double(p_.refinement), double(p_.num_levels - 1));
+  Values values = initial ? *initial
+                          : levels_.front().multiPhaseInitialValues(
+                                robot_, p_.gaussian_noise, coarse_dt);
+  for (size_t l = 0; l < levels_.size(); ++l) {
+    const Trajectory &trajectory = levels_[l];
+    if (l > 0) values = Upsample(levels_[l - 1], values, trajectory);
+
+    gtsam::NonlinearFactorGraph graph = trajectory.multiPhaseFactorGraph(
+        robot_, graph_builder_, p_.collocation, p_.mu);
+    graph.add(objectives_(trajectory));
+
+    // Only the variables of this level's graph, all of which need a value.
+    Values level_values;
+    for (Key key : graph.keys()) {
+      if (!values.exists(key))
+        throw std::runtime_error(
+            "MultiResolutionOptimizer: no initial value for " +
+            _GTDKeyFormatter(key) + " at level " + std::to_string(l) + ".");
+      level_values.insert(key, values.at(key));
+    }
+
+    OptimizerProfile profile;
+    values = optimizer.optimize(graph, level_values, &profile);
+    if (report) {
+      MultiResolutionLevel level;
+      level.num_steps = trajectory.getEndTimeStep(trajectory.numPhases() - 1);
+      level.num_factors = graph.size();
+      level.num_iterations = profile.iterations.size();
+      level.error = graph.error(values);
+      report->push_back(level);
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiResolutionOptimizer.h
+ * @brief Coarse-to-fine optimization of multi-phase trajectories.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/Trajectory.h"
+
+namespace gtdynamics {
+
+/// Parameters of MultiResolutionOptimizer.
+struct MultiResolutionParameters {
+  size_t num_levels = 3;  ///< resolutions, the target one included
+  size_t refinement = 2;  ///< ratio of the time steps of consecutive levels
+  OptimizationParameters optimization;  ///< for the solve of every level
+  CollocationScheme collocation = CollocationScheme::Trapezoidal;
+  double mu = 1.0;  ///< coefficient of static friction
+
+  /// Time step of the target resolution, and noise of the initial values of
+  /// the coarsest level, see Trajectory::multiPhaseInitialValues.
+  double dt = 1. / 240;
+  double gaussian_noise = 0.0;
+};
+
+/// Summary of the solve of one level.
+struct MultiResolutionLevel {
+  size_t num_steps = 0;       ///< time steps of the trajectory
+  size_t num_factors = 0;     ///< factors of the graph
+  size_t num_iterations = 0;  ///< LM iterations
+  double error = 0;           ///< error of the graph at the solution
+};
+
+/**
+ * MultiResolutionOptimizer solves a multi-phase trajectory problem at a few
+ * resolutions, coarsest first: the phases of the target Trajectory are
+ * shortened to ceil(n / refinement^l) steps at level l, the graph of the
+ * coarsest level is solved from Trajectory::multiPhaseInitialValues, and the
+ * solution of every level is upsampled by interpolation into the initial
+ * values of the next, finer, level. Far from the solution, most LM
+ * iterations then run on graphs refinement^l times smaller, and the fine
+ * solve starts close to its solution.
+ *
+ * The objectives depend on the time steps, so they are given as a function
+ * building them for the Trajectory of a level.
+ */
+class MultiResolutionOptimizer {
+ public:
+  /// Objectives of the trajectory of a level, added to its
+  /// multiPhaseFactorGraph.
+  using Objectives =
+      std::function<gtsam::NonlinearFactorGraph(const Trajectory &)>;
+
+  MultiResolutionOptimizer(
+      const Robot &robot, const DynamicsGraph &graph_builder,
+      const Trajectory &trajectory, const Objectives &objectives,
+      const MultiResolutionParameters &parameters =
+          MultiResolutionParameters());
+
+  /// Trajectories of the levels, coarsest first, the target one last.
+  const std::vector<Trajectory> &levels() const { return levels_; }
+
+  /**
+   * Solve all levels and return the values of the target resolution.
+   * @param initial  optional initial values of the coarsest level
+   * @param report   optional, a summary of every level is appended to it
+   */
+  gtsam::Values optimize(
+      const boost::optional<gtsam::Values> &initial = boost::none,
+      std::vector<MultiResolutionLevel> *report = nullptr) const;
+
+  /// The trajectory with the same phases, each ceil(n / divisor) steps long.
+  static Trajectory Coarsen(const Trajectory &trajectory, size_t divisor);
+
+  /**
+   * Values of `fine` interpolated from values of `coarse`, two trajectories
+   * with the same phases. Every time step of a phase is mapped to the same
+   * fraction of that phase in `coarse`, and the time-indexed variables are
+   * interpolated between the two nearest coarse steps: linearly for scalars
+   * and vectors, on the manifold for poses and rotations, and by copying
+   * the nearest value for other types. Phase durations are scaled by the
+   * ratio of steps, so the duration of every phase is kept. Keys need to be
+   * DynamicsSymbols; keys with a time index beyond the coarse trajectory
+   * are copied as is.
+   */
+  static gtsam::Values Upsample(const Trajectory &coarse,
+                                const gtsam::Values &coarse_values,
+                                const Trajectory &fine);
+
+ private:
+  Robot robot_;
+  DynamicsGraph graph_builder_;
+  Objectives objectives_;
+  MultiResolutionParameters p_;
+  std::vector<Trajectory> levels_;
+};
+
+}  // namespace gtdynamics
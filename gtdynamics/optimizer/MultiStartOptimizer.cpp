@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiStartOptimizer.cpp
+ * @brief Solve one problem from several initial estimates in parallel.
+ */
+
+#include "gtdynamics/optimizer/MultiStartOptimizer.h"
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+#include "gtdynamics/optimizer/OptimizerProfile.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/Trace.h"
+
+namespace gtdynamics {
+
+using gtsam::LevenbergMarquardtOptimizer;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+Values MultiStartOptimizer::optimize(const NonlinearFactorGraph &graph,
+                                     const EqualityConstraints &constraints,
+                                     const Initializer &initializer,
+                                     size_t num_starts,
+                                     MultiStartResult *result) const {
+  GTD_TRACE_SCOPE("MultiStartOptimizer::optimize");
+  if (num_starts == 0)
+    throw std::invalid_argument("MultiStartOptimizer: no starts.");
+  const ProfileTimer timer;
+
+  // One merit graph and ordering, shared by all starts.
+  NonlinearFactorGraph merit_graph = graph;
+  for (const auto &constraint : constraints)
+    merit_graph.add(constraint->createFactor(1.0));
+  gtsam::LevenbergMarquardtParams parameters = p_.lm_parameters;
+  if (!parameters.ordering)
+    parameters.setOrdering(
+        gtsam::Ordering::Create(parameters.orderingType, merit_graph));
+
+  ThreadPool pool(p_.num_threads);
+  std::vector<std::unique_ptr<LevenbergMarquardtOptimizer>> solvers(
+      num_starts);
+  std::vector<double> errors(num_starts);
+  // char rather than bool, as the starts are updated concurrently.
+  std::vector<char> running(num_starts), cancelled(num_starts, 0);
+  pool.parallelFor(num_starts, [&](size_t i, size_t /*worker*/) {
+    solvers[i].reset(new LevenbergMarquardtOptimizer(
+        merit_graph, initializer(i), parameters));
+    errors[i] = solvers[i]->error();
+    running[i] = errors[i] > parameters.errorTol;
+  });
+
+  // Rounds of LM iterations, the loop of defaultOptimize in slices.
+  for (size_t round = 0;; round++) {
+    std::vector<size_t> active;
+    for (size_t i = 0; i < num_starts; i++)
+      if (running[i]) active.push_back(i);
+    if (active.empty()) break;
+
+    pool.parallelFor(active.size(), [&](size_t j, size_t /*worker*/) {
+      const size_t i = active[j];
+      LevenbergMarquardtOptimizer &solver = *solvers[i];
+      for (size_t n = 0; n < p_.round_iterations && running[i]; n++) {
+        if (solver.iterations() >= parameters.maxIterations) {
+          running[i] = 0;
+          break;
+        }
+        const double previous_error = solver.error();
+        solver.iterate();
+        errors[i] = solver.error();
+        if (!std::isfinite(errors[i]) ||
+            gtsam::checkConvergence(parameters.relativeErrorTol,
+                                    parameters.absoluteErrorTol,
+                                    parameters.errorTol, previous_error,
+                                    errors[i]))
+          running[i] = 0;
+      }
+    });
+
+    // Cancel the starts that fell too far behind the best one.
+    if (round + 1 < p_.min_rounds) continue;
+    const double smallest = *std::min_element(errors.begin(), errors.end());
+    for (const size_t i : active) {
+      if (running[i] && errors[i] > p_.cancel_ratio * smallest) {
+        running[i] = 0;
+        cancelled[i] = 1;
+      }
+    }
+  }
+
+  // Pick the feasible start of least cost, or else the least violating.
+  MultiStartResult outcome;
+  outcome.costs.resize(num_starts);
+  outcome.violations.resize(num_starts);
+  pool.parallelFor(num_starts, [&](size_t i, size_t /*worker*/) {
+    const Values &values = solvers[i]->values();
+    outcome.costs[i] = graph.error(values);
+    outcome.violations[i] = std::sqrt(constraints.evaluate(values));
+  });
+  for (size_t i = 0; i < num_starts; i++) {
+    outcome.iterations.push_back(solvers[i]->iterations());
+    outcome.cancelled.push_back(cancelled[i]);
+    const size_t b = outcome.best;
+    const bool feasible = outcome.violations[i] <= p_.feasibility_tolerance;
+    const bool best_feasible =
+        outcome.violations[b] <= p_.feasibility_tolerance;
+    if (feasible && best_feasible ? outcome.costs[i] < outcome.costs[b]
+                                  : outcome.violations[i] <
+                                        outcome.violations[b])
+      outcome.best = i;
+  }
+  outcome.time = timer.elapsed();
+  const Values best = solvers[outcome.best]->values();
+  if (result) *result = outcome;
+  return best;
+}
+
+/* ************************************************************************* */
+Values MultiStartOptimizer::optimize(
+    const NonlinearFactorGraph &graph, const EqualityConstraints &constraints,
+    const std::vector<Values> &initial_values,
+    MultiStartResult *result) const {
+  return optimize(
+      graph, constraints, [&](size_t i) { return initial_values[i]; },
+      initial_values.size(), result);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MultiStartOptimizer.h
+ * @brief Solve one problem from several initial estimates in parallel.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <vector>
+
+#include "gtdynamics/optimizer/EqualityConstraint.h"
+
+namespace gtdynamics {
+
+/// Parameters of MultiStartOptimizer.
+struct MultiStartParameters {
+  gtsam::LevenbergMarquardtParams lm_parameters;  // for every start
+  size_t num_threads = 0;      // threads for the starts, 0 for all cores
+  size_t round_iterations = 5;  // LM iterations between comparisons
+  size_t min_rounds = 1;       // rounds before any start is cancelled
+  double cancel_ratio = 10.0;  // cancel starts whose error exceeds this
+                               // times the smallest one
+  double feasibility_tolerance = 1e-3;  // see MultiStartResult::best
+};
+
+/// Outcome of every start of a MultiStartOptimizer solve.
+struct MultiStartResult {
+  size_t best = 0;                 // index of the returned start
+  std::vector<double> costs;       // error of the cost graph at each result
+  std::vector<double> violations;  // norm of the scaled violations
+  std::vector<size_t> iterations;  // LM iterations run by each start
+  std::vector<bool> cancelled;     // whether each start was cancelled
+  double time = 0;                 // wall-clock seconds of the solve
+};
+
+/**
+ * MultiStartOptimizer runs Levenberg-Marquardt on the graph of costs plus the
+ * constraints as soft factors, as Optimizer does for SOFT_CONSTRAINTS, from
+ * several initial estimates at once, e.g. InitializePosesAndJoints with
+ * different noise, on a thread pool. All starts share the graph. The starts
+ * advance in rounds of round_iterations LM iterations; after each round, the
+ * starts whose error is more than cancel_ratio times the smallest one are
+ * cancelled, so that their threads go to the promising ones.
+ *
+ * The best start is the feasible one (norm of scaled violations at most
+ * feasibility_tolerance) of least cost, or the least violating one if none
+ * is feasible; cancelled starts compete with their last iterate.
+ */
+class MultiStartOptimizer {
+ public:
+  /// Initial estimate of start i.
+  using Initializer = std::function<gtsam::Values(size_t i)>;
+
+  /// Construct from parameters.
+  explicit MultiStartOptimizer(
+      const MultiStartParameters &parameters = MultiStartParameters())
+      : p_(parameters) {}
+
+  /**
+   * Optimize from num_starts initial estimates.
+   * @param graph        the costs
+   * @param constraints  the constraints, added as soft factors
+   * @param initializer  initial estimate of each start, called in parallel
+   * @param num_starts   number of starts
+   * @param result       if given, set to the outcome of every start
+   * @return the result of the best start
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const EqualityConstraints &constraints,
+                         const Initializer &initializer, size_t num_starts,
+                         MultiStartResult *result = nullptr) const;
+
+  /// Optimize from the given initial estimates.
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const EqualityConstraints &constraints,
+                         const std::vector<gtsam::Values> &initial_values,
+                         MultiStartResult *result = nullptr) const;
+
+ private:
+  const MultiStartParameters p_;
+};
+
+}  // namespace gtdynamics
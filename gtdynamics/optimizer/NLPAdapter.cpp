@@ -0,0 +1,220 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NLPAdapter.cpp
+ * @brief Costs and equality constraints as a nonlinear program.
+ */
+
+#include "gtdynamics/optimizer/NLPAdapter.h"
+
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/optimizer/ParallelLinearization.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+std::vector<int> SparsityPattern::rowIndices() const {
+  std::vector<int> rows_of_nonzeros(nonzeros());
+  for (size_t r = 0; r < rows(); r++)
+    std::fill(rows_of_nonzeros.begin() + row_offsets[r],
+              rows_of_nonzeros.begin() + row_offsets[r + 1], int(r));
+  return rows_of_nonzeros;
+}
+
+/* ************************************************************************* */
+NLPAdapter::NLPAdapter(const gtsam::NonlinearFactorGraph &costs,
+                       const EqualityConstraints &constraints,
+                       const gtsam::Values &base,
+                       const gtsam::Ordering &ordering, ThreadPool *pool)
+    : base_(base),
+      ordering_(ordering.empty() ? gtsam::Ordering(base.keys()) : ordering),
+      constraint_set_(constraints),
+      pool_(pool) {
+  for (const gtsam::Key key : ordering_) {
+    offsets_[key] = num_variables_;
+    num_variables_ += base_.at(key).dim();
+  }
+
+  // Constraints are whitened by their tolerances, as in the merit functions.
+  costs_.graph = costs;
+  constraints_.graph.reserve(constraints.size());
+  for (const auto &constraint : constraints)
+    constraints_.graph.push_back(constraint->createFactor(1.0));
+  buildPattern(&costs_, &cost_pattern_);
+  buildPattern(&constraints_, &constraint_pattern_);
+}
+
+/* ************************************************************************* */
+void NLPAdapter::buildPattern(Part *part, SparsityPattern *pattern) const {
+  pattern->num_columns = num_variables_;
+  part->layouts.resize(part->graph.size());
+  size_t row = 0, nonzeros = 0;
+  for (size_t k = 0; k < part->graph.size(); k++) {
+    const auto &factor = part->graph[k];
+    FactorLayout &layout = part->layouts[k];
+    layout.first_row = row;
+    layout.rows = factor ? factor->dim() : 0;
+    if (!factor) continue;
+
+    // Blocks of the keys, laid out in a row by increasing column.
+    const size_t num_keys = factor->size();
+    std::vector<size_t> columns(num_keys), dims(num_keys), order(num_keys);
+    for (size_t j = 0; j < num_keys; j++) {
+      const gtsam::Key key = factor->keys()[j];
+      columns[j] = offset(key);
+      dims[j] = base_.at(key).dim();
+    }
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return columns[a] < columns[b]; });
+    layout.block_positions.resize(num_keys);
+    size_t row_length = 0;
+    for (const size_t j : order) {
+      layout.block_positions[j] = row_length;
+      row_length += dims[j];
+    }
+
+    for (size_t i = 0; i < layout.rows; i++, row++) {
+      pattern->row_offsets.push_back(nonzeros);
+      for (const size_t j : order)
+        for (size_t c = 0; c < dims[j]; c++)
+          pattern->columns.push_back(columns[j] + c);
+      nonzeros += row_length;
+    }
+  }
+  pattern->row_offsets.push_back(nonzeros);
+}
+
+/* ************************************************************************* */
+size_t NLPAdapter::offset(gtsam::Key key) const {
+  auto it = offsets_.find(key);
+  if (it == offsets_.end())
+    throw std::invalid_argument("NLPAdapter: key " + std::to_string(key) +
+                                " is not in the ordering.");
+  return it->second;
+}
+
+/* ************************************************************************* */
+gtsam::Values NLPAdapter::values(const double *z) const {
+  gtsam::VectorValues delta;
+  for (const gtsam::Key key : ordering_)
+    delta.insert(key, Eigen::Map<const gtsam::Vector>(
+                          z + offsets_.at(key), base_.at(key).dim()));
+  return base_.retract(delta);
+}
+
+/* ************************************************************************* */
+void NLPAdapter::rebase(const double *z) {
+  base_ = values(z);
+  has_values_ = false;
+}
+
+/* ************************************************************************* */
+void NLPAdapter::update(const double *z) {
+  const Eigen::Map<const gtsam::Vector> point(z, num_variables_);
+  if (has_values_ && z_ == point) return;
+  z_ = point;
+  values_ = values(z);
+  costs_.linear.reset();
+  constraints_.linear.reset();
+  has_values_ = true;
+  has_violations_ = false;
+}
+
+/* ************************************************************************* */
+void NLPAdapter::linearize(Part *part) {
+  if (!part->linear)
+    part->linear = ParallelLinearize(part->graph, values_, pool_);
+}
+
+/* ************************************************************************* */
+void NLPAdapter::fill(const Part &part, const SparsityPattern &pattern,
+                      double *values, double *residuals) const {
+  for (size_t k = 0; k < part.graph.size(); k++) {
+    const FactorLayout &layout = part.layouts[k];
+    if (layout.rows == 0) continue;
+    const auto jacobian =
+        boost::dynamic_pointer_cast<gtsam::JacobianFactor>(part.linear->at(k));
+    for (size_t i = 0; i < layout.rows; i++) {
+      const size_t r = layout.first_row + i;
+      double *row = values + pattern.row_offsets[r];
+      if (!jacobian) {
+        // Inactive factors, e.g. limits away from the bounds, have no error.
+        std::fill(row, values + pattern.row_offsets[r + 1], 0.0);
+        if (residuals) residuals[r] = 0;
+        continue;
+      }
+      for (size_t j = 0; j < layout.block_positions.size(); j++) {
+        const auto A = jacobian->getA(jacobian->begin() + j);
+        for (size_t c = 0; c < size_t(A.cols()); c++)
+          row[layout.block_positions[j] + c] = A(i, c);
+      }
+      if (residuals) residuals[r] = -jacobian->getb()(i);
+    }
+  }
+}
+
+/* ************************************************************************* */
+double NLPAdapter::objective(const double *z) {
+  update(z);
+  return costs_.graph.error(values_);
+}
+
+/* ************************************************************************* */
+void NLPAdapter::gradient(const double *z, double *gradient) {
+  update(z);
+  linearize(&costs_);
+  // The gradient of 1/2 ||r||^2 is A^T r, with r = -b the whitened error.
+  Eigen::Map<gtsam::Vector> g(gradient, num_variables_);
+  g.setZero();
+  for (const auto &factor : *costs_.linear) {
+    const auto jacobian =
+        boost::dynamic_pointer_cast<gtsam::JacobianFactor>(factor);
+    if (!jacobian) continue;
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+      const auto A = jacobian->getA(it);
+      g.segment(offsets_.at(*it), A.cols()) -=
+          A.transpose() * jacobian->getb();
+    }
+  }
+}
+
+/* ************************************************************************* */
+void NLPAdapter::constraints(const double *z, double *violations) {
+  update(z);
+  if (!has_violations_) {
+    constraint_set_.evaluateInto(values_, &violations_, pool_);
+    has_violations_ = true;
+  }
+  Eigen::Map<gtsam::Vector>(violations, numConstraints()) =
+      violations_.scaled_violation;
+}
+
+/* ************************************************************************* */
+void NLPAdapter::constraintJacobian(const double *z, double *values) {
+  update(z);
+  linearize(&constraints_);
+  fill(constraints_, constraint_pattern_, values, nullptr);
+}
+
+/* ************************************************************************* */
+void NLPAdapter::costJacobian(const double *z, double *values,
+                              double *residuals) {
+  update(z);
+  linearize(&costs_);
+  fill(costs_, cost_pattern_, values, residuals);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,176 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NLPAdapter.h
+ * @brief Expose costs and equality constraints as a nonlinear program with a
+ * fixed sparsity pattern, for external NLP solvers such as IPOPT or SNOPT.
+ */
+
+#pragma once
+
+#include <gtsam/base/FastMap.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+#include "gtdynamics/optimizer/EqualityConstraint.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * Sparsity pattern of a matrix in compressed sparse row (CSR) format: the
+ * nonzeros of row r are at positions row_offsets[r] to row_offsets[r + 1] of
+ * the value buffer, in columns `columns`, sorted within each row. Indices are
+ * ints, as the C interfaces of NLP solvers expect.
+ */
+struct SparsityPattern {
+  std::vector<int> row_offsets;  // one per row, then the number of nonzeros
+  std::vector<int> columns;      // column of each nonzero
+  size_t num_columns = 0;
+
+  /// Number of rows.
+  size_t rows() const {
+    return row_offsets.empty() ? 0 : row_offsets.size() - 1;
+  }
+
+  /// Number of structural nonzeros.
+  size_t nonzeros() const { return columns.size(); }
+
+  /// Row of each nonzero, for solvers that take triplets.
+  std::vector<int> rowIndices() const;
+};
+
+/**
+ * NLPAdapter presents the problem
+ *
+ *   min_z f(z) = 1/2 sum_i ||r_i(x)||^2   s.t.   c(x) / tolerance = 0,
+ *
+ * with x = base.retract(z), r_i the whitened errors of the cost factors and
+ * c the equality constraints, scaled by their tolerances, to an NLP solver.
+ * The variables z are the stacked tangent-space coordinates of the keys, in
+ * the given ordering.
+ *
+ * The sparsity patterns of the constraint Jacobian and of the cost Jacobian
+ * (the stacked Jacobians of the r_i) are computed once in the constructor.
+ * The callbacks then write into preallocated buffers laid out as in those
+ * patterns: each factor owns fixed rows and each of its keys a fixed range
+ * of nonzeros in them, so filling a Jacobian is copying the blocks of the
+ * linearization. Linearizations are cached for the last z, as solvers
+ * usually ask for values and derivatives at the same point.
+ *
+ * Jacobians are those of the factors, with respect to the tangent space at
+ * x. They are the derivatives with respect to z for vector-valued variables,
+ * and at z = 0 for all of them. For problems on manifolds (poses, rotations),
+ * call rebase between solves, or when the solver accepts a step, to keep z
+ * small.
+ */
+class NLPAdapter {
+ public:
+  /**
+   * Constructor.
+   * @param costs        cost factors
+   * @param constraints  equality constraints
+   * @param base         values at z = 0, with all keys of the problem
+   * @param ordering     order of the keys in z, the keys of base if empty
+   * @param pool         if given, costs and constraints are linearized on it
+   */
+  NLPAdapter(const gtsam::NonlinearFactorGraph &costs,
+             const EqualityConstraints &constraints, const gtsam::Values &base,
+             const gtsam::Ordering &ordering = gtsam::Ordering(),
+             ThreadPool *pool = nullptr);
+
+  /// Number of variables, the dimension of z.
+  size_t numVariables() const { return num_variables_; }
+
+  /// Number of scalar equality constraints.
+  size_t numConstraints() const { return constraint_pattern_.rows(); }
+
+  /// Sparsity pattern of the constraint Jacobian, numConstraints() rows.
+  const SparsityPattern &constraintJacobianPattern() const {
+    return constraint_pattern_;
+  }
+
+  /// Sparsity pattern of the cost Jacobian, one row per residual.
+  const SparsityPattern &costJacobianPattern() const { return cost_pattern_; }
+
+  /// Offset of the coordinates of `key` in z.
+  size_t offset(gtsam::Key key) const;
+
+  /// Values at z = 0.
+  const gtsam::Values &base() const { return base_; }
+
+  /// Values x = base.retract(z).
+  gtsam::Values values(const double *z) const;
+
+  /// Move the base to base.retract(z); z = 0 is then that point.
+  void rebase(const double *z);
+
+  /// Objective f(z).
+  double objective(const double *z);
+
+  /// Gradient of f, numVariables() entries.
+  void gradient(const double *z, double *gradient);
+
+  /// Scaled constraint violations c(x) / tolerance, numConstraints() entries.
+  void constraints(const double *z, double *violations);
+
+  /// Nonzeros of the constraint Jacobian, as in constraintJacobianPattern().
+  void constraintJacobian(const double *z, double *values);
+
+  /**
+   * Nonzeros of the cost Jacobian, as in costJacobianPattern(), and if given
+   * the residuals, one per row; e.g. for a Gauss-Newton Hessian.
+   */
+  void costJacobian(const double *z, double *values,
+                    double *residuals = nullptr);
+
+ private:
+  // Rows and nonzero ranges of one factor in a pattern.
+  struct FactorLayout {
+    size_t first_row, rows;
+    std::vector<size_t> block_positions;  // of each key, within a row
+  };
+
+  // A graph with its layout and the cache of its linearization.
+  struct Part {
+    gtsam::NonlinearFactorGraph graph;
+    std::vector<FactorLayout> layouts;
+    gtsam::GaussianFactorGraph::shared_ptr linear;
+  };
+
+  // Build the pattern of part, with its factors in consecutive rows.
+  void buildPattern(Part *part, SparsityPattern *pattern) const;
+
+  // Update the cached values if z changed, dropping the linearizations.
+  void update(const double *z);
+
+  // Linearize part at the cached values, unless it already is.
+  void linearize(Part *part);
+
+  // Write the Jacobian nonzeros and -b of the linearization of part.
+  void fill(const Part &part, const SparsityPattern &pattern, double *values,
+            double *residuals) const;
+
+  gtsam::Values base_, values_;
+  gtsam::Ordering ordering_;
+  gtsam::FastMap<gtsam::Key, size_t> offsets_;  // of each key in z
+  size_t num_variables_ = 0;
+  EqualityConstraints constraint_set_;
+  Part costs_, constraints_;
+  SparsityPattern cost_pattern_, constraint_pattern_;
+  ConstraintViolations violations_;
+  gtsam::Vector z_;  // point of values_
+  bool has_values_ = false, has_violations_ = false;
+  ThreadPool *pool_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NestedDissectionOrdering.cpp
+ * @brief Per time step elimination ordering by dissection of the robot tree.
+ */
+
+#include "gtdynamics/optimizer/NestedDissectionOrdering.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+namespace gtdynamics {
+
+namespace {
+// Elimination rank of every link and joint: the graph of links and joints
+// is split at its centroid, the parts are ranked recursively, and the
+// centroid gets the next rank after them.
+class Dissection {
+ public:
+  std::map<DynamicsIndex, size_t> links, joints;
+
+  explicit Dissection(const Robot &robot) {
+    std::map<DynamicsIndex, size_t> link_nodes;
+    for (auto &&link : robot.links()) {
+      link_nodes[link->id()] = ids_.size();
+      ids_.emplace_back(true, link->id());
+    }
+    neighbors_.resize(ids_.size());
+    for (auto &&joint : robot.joints()) {
+      const size_t node = ids_.size();
+      ids_.emplace_back(false, joint->id());
+      neighbors_.emplace_back();
+      for (auto &&link : {joint->parent(), joint->child()}) {
+        const auto it = link_nodes.find(link->id());
+        if (it == link_nodes.end()) continue;
+        neighbors_[node].push_back(it->second);
+        neighbors_[it->second].push_back(node);
+      }
+    }
+
+    alive_.assign(ids_.size(), true);
+    rank_.assign(ids_.size(), 0);
+    size_t rank = 0;
+    for (size_t node = 0; node < ids_.size(); node++)
+      if (alive_[node]) dissect(node, &rank);
+    for (size_t node = 0; node < ids_.size(); node++)
+      (ids_[node].first ? links : joints)[ids_[node].second] = rank_[node];
+  }
+
+ private:
+  // Alive nodes connected to `start`, in breadth-first order, and their
+  // parents in the search.
+  std::vector<size_t> component(size_t start,
+                                std::vector<size_t> *parents) const {
+    std::vector<size_t> nodes{start};
+    std::map<size_t, size_t> parent{{start, start}};
+    for (size_t k = 0; k < nodes.size(); k++)
+      for (const size_t next : neighbors_[nodes[k]])
+        if (alive_[next] && parent.emplace(next, nodes[k]).second)
+          nodes.push_back(next);
+    for (const size_t node : nodes) parents->push_back(parent[node]);
+    return nodes;
+  }
+
+  // Node of `nodes` whose removal leaves the smallest largest part, from
+  // subtree sizes of the breadth-first spanning tree.
+  size_t centroid(const std::vector<size_t> &nodes,
+                  const std::vector<size_t> &parents) const {
+    const size_t n = nodes.size();
+    std::map<size_t, size_t> size, largest_child;
+    for (size_t k = n; k-- > 0;) {
+      size[nodes[k]] += 1;
+      if (k == 0) break;
+      size[parents[k]] += size[nodes[k]];
+      largest_child[parents[k]] =
+          std::max(largest_child[parents[k]], size[nodes[k]]);
+    }
+    size_t best = nodes.front(), best_part = n;
+    for (const size_t node : nodes) {
+      const size_t part = std::max(largest_child[node], n - size[node]);
+      if (part < best_part) {
+        best = node;
+        best_part = part;
+      }
+    }
+    return best;
+  }
+
+  // Rank the component of `start`.
+  void dissect(size_t start, size_t *rank) {
+    std::vector<size_t> parents;
+    const std::vector<size_t> nodes = component(start, &parents);
+    const size_t separator = centroid(nodes, parents);
+    alive_[separator] = false;
+    for (const size_t next : neighbors_[separator])
+      if (alive_[next]) dissect(next, rank);
+    rank_[separator] = (*rank)++;
+  }
+
+  std::vector<std::pair<bool, DynamicsIndex>> ids_;  // is link, and id
+  std::vector<std::vector<size_t>> neighbors_;
+  std::vector<bool> alive_;
+  std::vector<size_t> rank_;
+};
+}  // namespace
+
+/* ************************************************************************* */
+gtsam::Ordering NestedDissectionOrdering(const Robot &robot,
+                                         const gtsam::KeySet &keys) {
+  const Dissection dissection(robot);
+  const size_t none = dissection.links.size() + dissection.joints.size();
+
+  // Sort on (global, time, dissection rank, key).
+  using Entry = std::tuple<bool, uint64_t, size_t, gtsam::Key>;
+  std::vector<Entry> entries;
+  entries.reserve(keys.size());
+  for (const gtsam::Key key : keys) {
+    const DynamicsIndex j = DynamicsSymbol::JointIdx(key);
+    const DynamicsIndex i = DynamicsSymbol::LinkIdx(key);
+    size_t rank = none;
+    const auto joint = dissection.joints.find(j);
+    const auto link = dissection.links.find(i);
+    if (j != DynamicsSymbol::kNoIndex && joint != dissection.joints.end())
+      rank = joint->second;
+    else if (i != DynamicsSymbol::kNoIndex && link != dissection.links.end())
+      rank = link->second;
+    const bool global = rank == none;
+    entries.emplace_back(global, global ? 0 : DynamicsSymbol::Time(key), rank,
+                         key);
+  }
+  std::sort(entries.begin(), entries.end());
+
+  gtsam::Ordering ordering;
+  for (auto &&entry : entries) ordering.push_back(std::get<3>(entry));
+  return ordering;
+}
+
+/* ************************************************************************* */
+gtsam::Ordering NestedDissectionOrdering(
+    const Robot &robot, const gtsam::NonlinearFactorGraph &graph) {
+  return NestedDissectionOrdering(robot, graph.keys());
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NestedDissectionOrdering.h
+ * @brief Per time step elimination ordering by dissection of the robot tree.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * Return an elimination ordering of `keys`, time step by time step, and
+ * within a step by nested dissection of the kinematic tree of `robot`, a
+ * graph of links and joints: the link or joint whose removal leaves the
+ * smallest largest part, e.g. the body of a spider, is the separator and
+ * comes last, after the parts it separates, e.g. the legs, which are
+ * ordered the same way in turn. Each part is contiguous in the ordering, so
+ * in the Bayes tree of a step the parts are independent subtrees below the
+ * clique of their separator, with small fronts, and GTSAM can eliminate them
+ * in parallel. Unlike TimeMajorOrdering, the result does not depend on which
+ * link is the root of the robot description.
+ *
+ * As in TimeMajorOrdering, variables of a joint, including its wrenches,
+ * belong to the joint, and keys without a link or joint, such as phase
+ * durations, come last. The cost is a sort of the keys, the dissection is
+ * computed once from the robot.
+ */
+gtsam::Ordering NestedDissectionOrdering(const Robot &robot,
+                                         const gtsam::KeySet &keys);
+
+/// Nested-dissection ordering of the variables of `graph`, see above.
+gtsam::Ordering NestedDissectionOrdering(
+    const Robot &robot, const gtsam::NonlinearFactorGraph &graph);
+
+}  // namespace gtdynamics
@@ -12,47 +12,135 @@
  */
 
 #include <gtdynamics/optimizer/AugmentedLagrangianOptimizer.h>
+#include <gtdynamics/optimizer/ManifoldOptimizer.h>
+#include <gtdynamics/optimizer/NestedDissectionOrdering.h>
 #include <gtdynamics/optimizer/Optimizer.h>
 #include <gtdynamics/optimizer/PenaltyMethodOptimizer.h>
-#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtdynamics/optimizer/TimeMajorOrdering.h>
+#include <gtdynamics/utils/ThreadPool.h>
+#include <gtdynamics/utils/Trace.h>
+
+#include <memory>
+#include <stdexcept>
 
 namespace gtdynamics {
 
 using gtsam::NonlinearFactorGraph;
 using gtsam::Values;
 
+OptimizationParameters ResolveLinearSolver(
+    const OptimizationParameters& parameters) {
+  using Params = gtsam::NonlinearOptimizerParams;
+  OptimizationParameters resolved = parameters;
+  const LinearSolverBackend backend = parameters.linear_solver;
+  resolved.linear_solver = LinearSolverBackend::AUTOMATIC;
+  if (backend == LinearSolverBackend::AUTOMATIC) return resolved;
+
+  resolved.block_tridiagonal =
+      backend == LinearSolverBackend::BLOCK_TRIDIAGONAL;
+  if (backend != LinearSolverBackend::ITERATIVE) {
+    resolved.pcg = boost::none;
+  } else if (!resolved.pcg) {
+    resolved.pcg = PCGParameters();
+  }
+  if (backend == LinearSolverBackend::MULTIFRONTAL_QR) {
+    resolved.lm_parameters.linearSolverType = Params::MULTIFRONTAL_QR;
+  } else if (backend == LinearSolverBackend::CHOLMOD) {
+    resolved.lm_parameters.linearSolverType = Params::CHOLMOD;
+  } else {
+    resolved.lm_parameters.linearSolverType = Params::MULTIFRONTAL_CHOLESKY;
+  }
+  return resolved;
+}
+
+gtsam::LevenbergMarquardtParams Optimizer::lmParameters(
+    const NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints) const {
+  gtsam::LevenbergMarquardtParams parameters = p_.lm_parameters;
+  if (!p_.ordering_robot || parameters.ordering) return parameters;
+  gtsam::KeySet keys = graph.keys();
+  for (const auto& constraint : constraints) {
+    for (const gtsam::Key key : constraint->createFactor(1.0)->keys())
+      keys.insert(key);
+  }
+  parameters.ordering =
+      p_.nested_dissection ? NestedDissectionOrdering(*p_.ordering_robot, keys)
+                           : TimeMajorOrdering(*p_.ordering_robot, keys);
+  return parameters;
+}
+
 Values Optimizer::optimize(const NonlinearFactorGraph& graph,
-                           const Values& initial_values) const {
-  gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial_values,
-                                               p_.lm_parameters);
-  const Values result = optimizer.optimize();
+                           const Values& initial_values,
+                           OptimizerProfile* profile) const {
+  GTD_TRACE_SCOPE("Optimizer::optimize");
+  const ProfileTimer timer;
+  const Deadline deadline(p_.time_budget);
+  std::unique_ptr<ThreadPool> pool;
+  if (p_.num_threads != 1) pool.reset(new ThreadPool(p_.num_threads));
+  const Values result =
+      OptimizeLM(graph, initial_values, lmParameters(graph), profile,
+                 nullptr, pool.get(), p_.block_tridiagonal, &deadline,
+                 &p_.bounds, p_.pcg.get_ptr());
+  if (profile) profile->total += timer.elapsed();
   return result;
 }
 
 Values Optimizer::optimize(const gtsam::NonlinearFactorGraph& graph,
                            const EqualityConstraints& constraints,
-                           const gtsam::Values& initial_values) const {
+                           const gtsam::Values& initial_values,
+                           OptimizerProfile* profile) const {
+  GTD_TRACE_SCOPE("Optimizer::optimize");
   if (p_.method == OptimizationParameters::Method::SOFT_CONSTRAINTS) {
+    const ProfileTimer timer;
     auto merit_graph = graph;
     for (const auto& constraint : constraints) {
       merit_graph.add(constraint->createFactor(1.0));
     }
-    return optimize(merit_graph, initial_values);
+    if (profile) {
+      profile->graph_construction += timer.elapsed();
+      profile->total += timer.elapsed();
+    }
+    return optimize(merit_graph, initial_values, profile);
+  }
 
-  } else if (p_.method == OptimizationParameters::Method::PENALTY) {
-    PenaltyMethodParameters params = p_.lm_parameters;
-    PenaltyMethodOptimizer optimizer(params);
-    return optimizer.optimize(graph, constraints, initial_values);
+  if (!p_.bounds.empty())
+    throw std::invalid_argument(
+        "Optimizer: bounds need the SOFT_CONSTRAINTS method.");
+  boost::shared_ptr<const ConstrainedOptimizer> optimizer;
+  const gtsam::LevenbergMarquardtParams lm_parameters =
+      p_.manifold_robot ? p_.lm_parameters : lmParameters(graph, constraints);
+  if (p_.method == OptimizationParameters::Method::PENALTY) {
+    PenaltyMethodParameters params = lm_parameters;
+    params.num_threads = p_.num_threads;
+    params.block_tridiagonal = p_.block_tridiagonal;
+    params.pcg = p_.pcg;
+    params.time_budget = p_.time_budget;
+    optimizer = boost::make_shared<PenaltyMethodOptimizer>(params);
 
   } else if (p_.method ==
              OptimizationParameters::Method::AUGMENTED_LAGRANGIAN) {
-    AugmentedLagrangianParameters params = p_.lm_parameters;
-    AugmentedLagrangianOptimizer optimizer(params);
-    return optimizer.optimize(graph, constraints, initial_values);
+    AugmentedLagrangianParameters params = lm_parameters;
+    params.num_threads = p_.num_threads;
+    params.block_tridiagonal = p_.block_tridiagonal;
+    params.pcg = p_.pcg;
+    params.time_budget = p_.time_budget;
+    optimizer = boost::make_shared<AugmentedLagrangianOptimizer>(params);
 
   } else {
     throw std::runtime_error("optimization method not recognized.");
   }
+  if (p_.manifold_robot) {
+    optimizer =
+        boost::make_shared<ManifoldOptimizer>(*p_.manifold_robot, optimizer);
+  }
+
+  if (!profile) return optimizer->optimize(graph, constraints, initial_values);
+  ConstrainedOptResult result;
+  result.profile = *profile;
+  const Values values =
+      optimizer->optimize(graph, constraints, initial_values, &result);
+  *profile = result.profile;
+  return values;
 }
 
 }  // namespace gtdynamics
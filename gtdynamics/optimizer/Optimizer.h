@@ -13,10 +13,16 @@
 
 #pragma once
 
+#include <gtdynamics/optimizer/BoxBounds.h>
 #include <gtdynamics/optimizer/EqualityConstraint.h>
+#include <gtdynamics/optimizer/LinearSolverBackend.h>
+#include <gtdynamics/optimizer/OptimizerProfile.h>
+#include <gtdynamics/optimizer/PCGSolver.h>
 #include <gtdynamics/universal_robot/Robot.h>
 #include <gtsam/nonlinear/LevenbergMarquardtParams.h>
 
+#include <boost/optional.hpp>
+
 // Forward declarations.
 namespace gtsam {
 class NonlinearFactorGraph;
@@ -31,44 +37,97 @@ struct OptimizationParameters {
 
   Method method = Method::SOFT_CONSTRAINTS;       // optimization method
   gtsam::LevenbergMarquardtParams lm_parameters;  // LM parameters
+  size_t num_threads = 1;  // threads for linearization, 0 for all shared ones
+  bool block_tridiagonal = false;  // solve per time step, for trajectories
+
+  /// If set, solve the linear systems of LM by matrix-free conjugate
+  /// gradient, see PCGSolve, e.g. for horizons too long to factorize.
+  boost::optional<PCGParameters> pcg;
+
+  /// Solver of the linear systems; anything but AUTOMATIC overrides pcg,
+  /// block_tridiagonal and lm_parameters.linearSolverType, see
+  /// ResolveLinearSolver. ITERATIVE uses pcg if set, else PCGParameters().
+  /// KinematicsParameters and StaticsParameters default to the
+  /// RecommendedLinearSolver of their problem class.
+  LinearSolverBackend linear_solver = LinearSolverBackend::AUTOMATIC;
+
+  /// Wall-clock budget of a solve in seconds, 0 for none; see
+  /// ConstrainedOptimizationParameters::time_budget.
+  double time_budget = 0.0;
+
+  /// Bounds on scalar variables, e.g. DynamicsGraph::jointLimitBounds in
+  /// place of jointLimitFactors. Enforced by projected LM steps; only the
+  /// SOFT_CONSTRAINTS method supports them.
+  BoxBounds bounds;
+
+  /// If set, and lm_parameters has no ordering, variables are eliminated in
+  /// TimeMajorOrdering for this robot.
+  boost::optional<Robot> ordering_robot;
+
+  /// With ordering_robot, use NestedDissectionOrdering rather than
+  /// TimeMajorOrdering, e.g. for robots with many limbs.
+  bool nested_dissection = false;
+
+  /// If set, the PENALTY and AUGMENTED_LAGRANGIAN methods eliminate the link
+  /// poses of this robot and optimize over joint angles, see
+  /// ManifoldOptimizer. Takes precedence over ordering_robot.
+  boost::optional<Robot> manifold_robot;
+
   OptimizationParameters() {
     lm_parameters.setlambdaInitial(1e7);
     lm_parameters.setAbsoluteErrorTol(1e-3);
   }
 };
 
+/**
+ * Return `parameters` with linear_solver applied to pcg, block_tridiagonal
+ * and lm_parameters.linearSolverType, and reset to AUTOMATIC.
+ */
+OptimizationParameters ResolveLinearSolver(
+    const OptimizationParameters& parameters);
+
 /// Base class for GTDynamics optimizer hierarchy.
 class Optimizer {
  protected:
   const OptimizationParameters p_;
 
+  /// LM parameters, with a time-major ordering of the variables of `graph`
+  /// and `constraints` if asked for.
+  gtsam::LevenbergMarquardtParams lmParameters(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints = EqualityConstraints()) const;
+
  public:
   /**
    * @fn Constructor.
    */
   Optimizer(const OptimizationParameters& parameters = OptimizationParameters())
-      : p_(parameters) {}
+      : p_(ResolveLinearSolver(parameters)) {}
 
   /**
    * @brief optimize graph using optimizer settings.
    *
    * @param graph a Nonlinear factor graph built by derived class
    * @param initial_values Initial values for all variables.
+   * @param profile (optional) timings of the solve are added to it.
    * @return Values The result of the optimization.
    */
   // TODO(yetong): remove after discussing with team
   gtsam::Values optimize(const gtsam::NonlinearFactorGraph& graph,
-                         const gtsam::Values& initial_values) const;
+                         const gtsam::Values& initial_values,
+                         OptimizerProfile* profile = nullptr) const;
 
   /**
    * @brief optimize with constraints using optimizer settings.
    *
    * @param graph a Nonlinear factor graph built by derived class
    * @param initial_values Initial values for all variables.
+   * @param profile (optional) timings of the solve are added to it.
    * @return Values The result of the optimization.
    */
   gtsam::Values optimize(const gtsam::NonlinearFactorGraph& graph,
                          const EqualityConstraints& constraints,
-                         const gtsam::Values& initial_values) const;
+                         const gtsam::Values& initial_values,
+                         OptimizerProfile* profile = nullptr) const;
 };
 }  // namespace gtdynamics
@@ -0,0 +1,271 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizerProfile.cpp
+ * @brief Timing and sparsity profile of a solve.
+ */
+
+#include "gtdynamics/optimizer/OptimizerProfile.h"
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "gtdynamics/optimizer/BlockTridiagonalSolver.h"
+#include "gtdynamics/optimizer/LinearSolverBackend.h"
+#include "gtdynamics/optimizer/ParallelLinearization.h"
+#include "gtdynamics/utils/Trace.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+std::string OptimizerProfile::toJson() const {
+  std::ostringstream os;
+  os << std::setprecision(10);
+  os << "{\n"
+     << "  \"total\": " << total << ",\n"
+     << "  \"graph_construction\": " << graph_construction << ",\n"
+     << "  \"constraint_evaluation\": " << constraint_evaluation << ",\n"
+     << "  \"linearization\": " << linearization << ",\n"
+     << "  \"elimination\": " << elimination << ",\n"
+     << "  \"num_linearizations\": " << num_linearizations << ",\n"
+     << "  \"num_eliminations\": " << num_eliminations << ",\n"
+     << "  \"linear_solver\": \"" << linear_solver << "\",\n"
+     << "  \"num_factors\": " << num_factors << ",\n"
+     << "  \"num_variables\": " << num_variables << ",\n"
+     << "  \"jacobian_nonzeros\": " << jacobian_nonzeros << ",\n"
+     << "  \"factor_nonzeros\": " << factor_nonzeros << ",\n"
+     << "  \"fill_in\": " << fillIn() << ",\n"
+     << "  \"iterations\": [";
+  for (size_t i = 0; i < iterations.size(); i++) {
+    os << (i ? ",\n" : "\n") << "    {\"time\": " << iterations[i].time
+       << ", \"error_before\": " << iterations[i].error_before
+       << ", \"error_after\": " << iterations[i].error_after << "}";
+  }
+  os << (iterations.empty() ? "]\n" : "\n  ]\n") << "}\n";
+  return os.str();
+}
+
+/* ************************************************************************* */
+void OptimizerProfile::saveJson(const std::string &file_path) const {
+  std::ofstream file(file_path);
+  if (!file)
+    throw std::runtime_error("OptimizerProfile::saveJson: cannot open " +
+                             file_path + ".");
+  file << toJson();
+}
+
+/* ************************************************************************* */
+void OptimizerProfile::print(std::ostream &os) const {
+  os << "total: " << total << " s over " << iterations.size()
+     << " LM iterations\n"
+     << "  graph construction: " << graph_construction << " s\n"
+     << "  constraint evaluation: " << constraint_evaluation << " s\n"
+     << "  linearization: " << linearization << " s ("
+     << num_linearizations << " calls)\n"
+     << "  elimination: " << elimination << " s (" << num_eliminations
+     << " calls)\n";
+  if (!linear_solver.empty())
+    os << "  linear solver: " << linear_solver << "\n";
+  if (compute_sparsity)
+    os << "  " << num_factors << " factors, " << num_variables
+       << " variables, " << jacobian_nonzeros << " Jacobian nonzeros, "
+       << factor_nonzeros << " R nonzeros (fill-in " << fillIn() << ")\n";
+}
+
+// LM optimizer that linearizes on a thread pool, if given, can solve by time
+// step or by conjugate gradient, clips its steps to box bounds, if given, and
+// times its linearizations, linear solves and iterations, if given a profile.
+class ProfiledLevenbergMarquardtOptimizer
+    : public gtsam::LevenbergMarquardtOptimizer {
+ public:
+  ProfiledLevenbergMarquardtOptimizer(
+      const gtsam::NonlinearFactorGraph &graph,
+      const gtsam::Values &initial_values,
+      const gtsam::LevenbergMarquardtParams &parameters,
+      OptimizerProfile *profile, ThreadPool *pool, bool block_tridiagonal,
+      const BoxBounds *bounds, const PCGParameters *pcg)
+      : gtsam::LevenbergMarquardtOptimizer(graph, initial_values, parameters),
+        profile_(profile),
+        pool_(pool),
+        block_tridiagonal_(block_tridiagonal),
+        bounds_(bounds),
+        pcg_(pcg) {}
+
+  gtsam::GaussianFactorGraph::shared_ptr linearize() const override {
+    const ProfileTimer timer;
+    auto linear = pool_ ? ParallelLinearize(graph_, values(), pool_)
+                        : gtsam::LevenbergMarquardtOptimizer::linearize();
+    if (profile_) {
+      profile_->linearization += timer.elapsed();
+      profile_->num_linearizations++;
+    }
+    return linear;
+  }
+
+  gtsam::VectorValues solve(
+      const gtsam::GaussianFactorGraph &gfg,
+      const gtsam::NonlinearOptimizerParams &params) const override {
+    const ProfileTimer timer;
+    auto delta = solveOnce(gfg, params);
+    if (bounds_) {
+      // Hold the variables that the step pushes out of the box at their
+      // bound and solve for the others, then clip what is left. Steps are
+      // taken from values(), so the clipped step stays in the box.
+      const gtsam::KeyVector blocked = bounds_->blocking(values(), delta);
+      if (!blocked.empty()) {
+        gtsam::GaussianFactorGraph held = gfg;
+        for (const gtsam::Key key : blocked)
+          held.emplace_shared<gtsam::JacobianFactor>(
+              key, gtsam::I_1x1 * 1e6, gtsam::Vector1::Zero());
+        delta = solveOnce(held, params);
+      }
+      bounds_->clip(values(), &delta);
+    }
+    if (!profile_) return delta;
+    profile_->elimination += timer.elapsed();
+    profile_->num_eliminations++;
+    return delta;
+  }
+
+  gtsam::GaussianFactorGraph::shared_ptr iterate() override {
+    if (!profile_) return gtsam::LevenbergMarquardtOptimizer::iterate();
+    const double error_before = error();
+    const ProfileTimer timer;
+    auto linear = gtsam::LevenbergMarquardtOptimizer::iterate();
+    profile_->iterations.push_back({timer.elapsed(), error_before, error()});
+    return linear;
+  }
+
+ private:
+  gtsam::VectorValues solveOnce(
+      const gtsam::GaussianFactorGraph &gfg,
+      const gtsam::NonlinearOptimizerParams &params) const {
+    if (pcg_) return PCGSolve(gfg, *pcg_, pool_);
+    return block_tridiagonal_
+               ? BlockTridiagonalSolve(gfg)
+               : gtsam::LevenbergMarquardtOptimizer::solve(gfg, params);
+  }
+
+  OptimizerProfile *profile_;
+  ThreadPool *pool_;
+  bool block_tridiagonal_;
+  const BoxBounds *bounds_;
+  const PCGParameters *pcg_;
+};
+
+// Nonzeros of the R factors of all cliques at or below `clique`.
+static size_t FactorNonzeros(const gtsam::GaussianBayesTreeClique &clique) {
+  const auto &conditional = *clique.conditional();
+  const size_t r = conditional.get_R().rows();
+  const size_t s = conditional.get_S().cols();
+  size_t nonzeros = r * (r + 1) / 2 + r * s;
+  for (auto &&child : clique.children) nonzeros += FactorNonzeros(*child);
+  return nonzeros;
+}
+
+// Fill in the sparsity statistics of `graph` at `values`.
+static void ComputeSparsity(const gtsam::NonlinearFactorGraph &graph,
+                            const gtsam::Values &values,
+                            const gtsam::LevenbergMarquardtParams &parameters,
+                            OptimizerProfile *profile) {
+  profile->num_factors = graph.size();
+  profile->num_variables = graph.keys().size();
+
+  const auto linear = graph.linearize(values);
+  profile->jacobian_nonzeros = 0;
+  for (auto &&factor : *linear) {
+    const auto jacobian =
+        boost::dynamic_pointer_cast<gtsam::JacobianFactor>(factor);
+    if (!jacobian) continue;
+    profile->jacobian_nonzeros += jacobian->rows() * (jacobian->cols() - 1);
+  }
+
+  const gtsam::Ordering ordering =
+      parameters.ordering
+          ? *parameters.ordering
+          : gtsam::Ordering::Create(parameters.orderingType, graph);
+  const auto bayes_tree = linear->eliminateMultifrontal(ordering);
+  profile->factor_nonzeros = 0;
+  for (auto &&root : bayes_tree->roots())
+    profile->factor_nonzeros += FactorNonzeros(*root);
+}
+
+// The loop of NonlinearOptimizer::defaultOptimize, which also stops at the
+// deadline between iterations.
+static void OptimizeUntil(gtsam::LevenbergMarquardtOptimizer *optimizer,
+                          const gtsam::LevenbergMarquardtParams &parameters,
+                          const Deadline &deadline) {
+  double current_error = optimizer->error();
+  if (current_error <= parameters.errorTol) return;
+  while (!deadline.passed() &&
+         optimizer->iterations() < parameters.maxIterations) {
+    const double previous_error = current_error;
+    optimizer->iterate();
+    current_error = optimizer->error();
+    if (!std::isfinite(current_error) ||
+        gtsam::checkConvergence(parameters.relativeErrorTol,
+                                parameters.absoluteErrorTol,
+                                parameters.errorTol, previous_error,
+                                current_error))
+      break;
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Values OptimizeLM(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values,
+                         const gtsam::LevenbergMarquardtParams &parameters,
+                         OptimizerProfile *profile,
+                         size_t *inner_iterations, ThreadPool *pool,
+                         bool block_tridiagonal, const Deadline *deadline,
+                         const BoxBounds *bounds, const PCGParameters *pcg) {
+  GTD_TRACE_SCOPE("OptimizeLM");
+  if (deadline && !deadline->active()) deadline = nullptr;
+  if (bounds && bounds->empty()) bounds = nullptr;
+  if (!profile && !pool && !block_tridiagonal && !deadline && !bounds &&
+      !pcg) {
+    gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial_values,
+                                                 parameters);
+    const gtsam::Values result = optimizer.optimize();
+    if (inner_iterations) *inner_iterations = optimizer.getInnerIterations();
+    return result;
+  }
+
+  if (profile)
+    profile->linear_solver = LinearSolverBackendName(
+        ActiveLinearSolver(parameters, block_tridiagonal, pcg));
+  if (profile && profile->compute_sparsity && profile->num_factors == 0)
+    ComputeSparsity(graph, initial_values, parameters, profile);
+  gtsam::Values projected_values;
+  if (bounds) {
+    projected_values = initial_values;
+    bounds->project(&projected_values);
+  }
+  ProfiledLevenbergMarquardtOptimizer optimizer(
+      graph, bounds ? projected_values : initial_values, parameters, profile,
+      pool, block_tridiagonal, bounds, pcg);
+  if (deadline) {
+    OptimizeUntil(&optimizer, parameters, *deadline);
+  } else {
+    optimizer.optimize();
+  }
+  if (inner_iterations) *inner_iterations = optimizer.getInnerIterations();
+  return optimizer.values();
+}
+
+}  // namespace gtdynamics
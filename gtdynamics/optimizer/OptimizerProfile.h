@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  OptimizerProfile.h
+ * @brief Timing and sparsity profile of a solve.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/optimizer/BoxBounds.h"
+#include "gtdynamics/optimizer/PCGSolver.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * Where the time of a solve goes, and how sparse its linear systems are. All
+ * times are wall-clock seconds, accumulated over the whole solve, including
+ * all outer iterations of constrained optimizers.
+ */
+struct OptimizerProfile {
+  /// One Levenberg-Marquardt iteration.
+  struct Iteration {
+    double time;          ///< duration, including all lambda trials
+    double error_before;  ///< error before the iteration
+    double error_after;   ///< error after the iteration
+  };
+
+  double total = 0;                  ///< whole solve
+  double graph_construction = 0;     ///< building merit graphs
+  double constraint_evaluation = 0;  ///< evaluating constraint violations
+  double linearization = 0;          ///< linearizing the nonlinear graph
+  double elimination = 0;            ///< eliminating and solving linear graphs
+  size_t num_linearizations = 0;
+  size_t num_eliminations = 0;
+  std::vector<Iteration> iterations;  ///< all LM iterations, in order
+
+  /// LinearSolverBackendName of the backend of the last LM solve.
+  std::string linear_solver;
+
+  /// Compute the sparsity statistics below, at the cost of one extra
+  /// elimination at the initial values of the first inner solve.
+  bool compute_sparsity = false;
+  size_t num_factors = 0;        ///< factors in the (merit) graph
+  size_t num_variables = 0;      ///< variables in the (merit) graph
+  size_t jacobian_nonzeros = 0;  ///< entries in the dense Jacobian blocks
+  size_t factor_nonzeros = 0;    ///< entries in the R factor after elimination
+
+  /// Fill-in: nonzeros of R relative to those of the Jacobian.
+  double fillIn() const {
+    return jacobian_nonzeros ? double(factor_nonzeros) / jacobian_nonzeros
+                             : 0.0;
+  }
+
+  /// Return the profile as a JSON object.
+  std::string toJson() const;
+
+  /// Write the profile as JSON to a file.
+  void saveJson(const std::string &file_path) const;
+
+  /// Print a human-readable summary.
+  void print(std::ostream &os) const;
+};
+
+/// Wall-clock stopwatch used for profiling, in seconds.
+class ProfileTimer {
+ public:
+  ProfileTimer() : start_(std::chrono::steady_clock::now()) {}
+
+  /// Seconds since construction.
+  double elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start_)
+        .count();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+};
+
+/// Wall-clock deadline of a time-budgeted solve.
+class Deadline {
+ public:
+  /// Deadline `budget` seconds from now; a budget <= 0 never passes.
+  explicit Deadline(double budget = 0)
+      : active_(budget > 0),
+        end_(std::chrono::steady_clock::now() +
+             std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                 std::chrono::duration<double>(active_ ? budget : 0.0))) {}
+
+  /// Whether there is a budget at all.
+  bool active() const { return active_; }
+
+  /// Whether the budget has run out.
+  bool passed() const {
+    return active_ && std::chrono::steady_clock::now() >= end_;
+  }
+
+ private:
+  bool active_;
+  std::chrono::steady_clock::time_point end_;
+};
+
+/**
+ * Optimize with Levenberg-Marquardt, adding linearization, elimination and
+ * per-iteration timings to `profile` if it is not null. Sparsity statistics
+ * are computed here if asked for and not computed yet; `total` is left to
+ * the caller.
+ * @param graph             the graph to optimize
+ * @param initial_values    initial estimate
+ * @param parameters        LM parameters
+ * @param profile           profile to add to, may be null
+ * @param inner_iterations  if given, set to the number of inner iterations
+ * @param pool              if given, factors are linearized on its threads
+ * @param block_tridiagonal solve linear systems with BlockTridiagonalSolve
+ * @param deadline          if given, no LM iteration is started after it; LM
+ *                          only accepts steps that decrease the error, so the
+ *                          result is still the best iterate so far
+ * @param bounds            if given, the initial values are projected into
+ *                          these bounds and every LM step is clipped to them
+ * @param pcg               if given, solve linear systems with PCGSolve on
+ *                          `pool`; takes precedence over block_tridiagonal
+ */
+gtsam::Values OptimizeLM(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values,
+                         const gtsam::LevenbergMarquardtParams &parameters,
+                         OptimizerProfile *profile,
+                         size_t *inner_iterations = nullptr,
+                         ThreadPool *pool = nullptr,
+                         bool block_tridiagonal = false,
+                         const Deadline *deadline = nullptr,
+                         const BoxBounds *bounds = nullptr,
+                         const PCGParameters *pcg = nullptr);
+
+}  // namespace gtdynamics
@@ -0,0 +1,237 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PCGSolver.cpp
+ * @brief Matrix-free preconditioned conjugate gradient for trajectory graphs.
+ */
+
+#include "gtdynamics/optimizer/PCGSolver.h"
+
+#include <gtsam/linear/linearExceptions.h>
+
+#include <Eigen/Cholesky>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace gtdynamics {
+
+namespace {
+// Whitened Jacobian of one factor, with the variable of each block.
+struct Block {
+  size_t variable, column;
+};
+struct Factor {
+  Matrix A;
+  Vector b;
+  std::vector<Block> blocks;
+};
+
+// A variable, its place in the stacked vector and the factors it is in.
+struct Variable {
+  Key key;
+  size_t offset, dim;
+  std::vector<std::pair<size_t, size_t>> uses;  // factor and block
+};
+
+// One diagonal block of the preconditioner.
+struct Group {
+  std::vector<size_t> variables;
+  std::map<size_t, size_t> local;  // variable -> offset in the block
+  size_t dim = 0;
+  Eigen::LLT<Matrix> cholesky;
+};
+
+// Group of a variable, as a tuple that orders groups deterministically.
+using GroupId = std::tuple<int, uint64_t, uint64_t>;
+GroupId GroupOf(Key key, PCGParameters::Preconditioner preconditioner) {
+  const uint64_t t = DynamicsSymbol::Time(key);
+  switch (preconditioner) {
+    case PCGParameters::TIME_SLICE:
+      return GroupId(0, t, 0);
+    case PCGParameters::LINK:
+      if (DynamicsSymbol::LinkIdx(key) != DynamicsSymbol::kNoIndex)
+        return GroupId(0, t, DynamicsSymbol::LinkIdx(key));
+      if (DynamicsSymbol::JointIdx(key) != DynamicsSymbol::kNoIndex)
+        return GroupId(1, t, DynamicsSymbol::JointIdx(key));
+      return GroupId(2, key, 0);
+    default:
+      return GroupId(2, key, 0);
+  }
+}
+
+// Run job(i) for i in [0, n), on the pool if any.
+void ForEach(size_t n, ThreadPool *pool,
+             const std::function<void(size_t)> &job) {
+  if (pool) {
+    pool->parallelFor(n, [&job](size_t i, size_t) { job(i); });
+  } else {
+    for (size_t i = 0; i < n; ++i) job(i);
+  }
+}
+}  // namespace
+
+/* ************************************************************************* */
+gtsam::VectorValues PCGSolve(const gtsam::GaussianFactorGraph &graph,
+                             const PCGParameters &parameters,
+                             ThreadPool *pool, size_t *iterations) {
+  // Whitened Jacobians, and the variables in order of their keys.
+  std::vector<Factor> factors;
+  std::map<Key, size_t> variable_index;
+  for (auto &&factor : graph) {
+    if (!factor || factor->empty()) continue;
+    for (auto it = factor->begin(); it != factor->end(); ++it)
+      variable_index.emplace(*it, 0);
+  }
+  std::vector<Variable> variables;
+  for (auto &&kv : variable_index) {
+    kv.second = variables.size();
+    variables.push_back(Variable{kv.first, 0, 0, {}});
+  }
+  for (auto &&factor : graph) {
+    if (!factor || factor->empty()) continue;
+    Factor f;
+    std::tie(f.A, f.b) = factor->jacobian();
+    size_t column = 0;
+    for (auto it = factor->begin(); it != factor->end(); ++it) {
+      const size_t v = variable_index.at(*it);
+      variables[v].dim = factor->getDim(it);
+      variables[v].uses.emplace_back(factors.size(), f.blocks.size());
+      f.blocks.push_back(Block{v, column});
+      column += factor->getDim(it);
+    }
+    factors.push_back(std::move(f));
+  }
+  size_t n = 0;
+  for (auto &&variable : variables) {
+    variable.offset = n;
+    n += variable.dim;
+  }
+
+  // Diagonal blocks of A^T A, factored once.
+  std::map<GroupId, size_t> group_index;
+  std::vector<size_t> group_of(variables.size());
+  std::vector<Group> groups;
+  for (size_t v = 0; v < variables.size(); ++v) {
+    auto it = group_index
+                  .emplace(GroupOf(variables[v].key, parameters.preconditioner),
+                           groups.size())
+                  .first;
+    if (it->second == groups.size()) groups.emplace_back();
+    Group &group = groups[it->second];
+    group_of[v] = it->second;
+    group.variables.push_back(v);
+    group.local[v] = group.dim;
+    group.dim += variables[v].dim;
+  }
+  std::vector<Matrix> diagonal(groups.size());
+  for (size_t g = 0; g < groups.size(); ++g)
+    diagonal[g].setZero(groups[g].dim, groups[g].dim);
+  for (auto &&f : factors) {
+    for (auto &&bi : f.blocks) {
+      const Variable &vi = variables[bi.variable];
+      Group &group = groups[group_of[bi.variable]];
+      for (auto &&bj : f.blocks) {
+        if (group_of[bj.variable] != group_of[bi.variable]) continue;
+        const Variable &vj = variables[bj.variable];
+        diagonal[group_of[bi.variable]].block(group.local[bi.variable],
+                                              group.local[bj.variable],
+                                              vi.dim, vj.dim) +=
+            f.A.middleCols(bi.column, vi.dim).transpose() *
+            f.A.middleCols(bj.column, vj.dim);
+      }
+    }
+  }
+  for (size_t g = 0; g < groups.size(); ++g) {
+    groups[g].cholesky.compute(diagonal[g]);
+    if (groups[g].cholesky.info() != Eigen::Success)
+      throw gtsam::IndeterminantLinearSystemException(
+          variables[groups[g].variables.front()].key);
+  }
+
+  // Products with A per factor and with A^T per variable, so that each
+  // parallel job writes only its own entries.
+  std::vector<Vector> y(factors.size());
+  const auto multiply_A = [&](const Vector &p) {
+    ForEach(factors.size(), pool, [&](size_t i) {
+      const Factor &f = factors[i];
+      y[i].setZero(f.A.rows());
+      for (auto &&block : f.blocks) {
+        const Variable &v = variables[block.variable];
+        y[i] += f.A.middleCols(block.column, v.dim) *
+                p.segment(v.offset, v.dim);
+      }
+    });
+  };
+  const auto multiply_At = [&](const std::vector<Vector> &r, Vector *q) {
+    q->resize(n);
+    ForEach(variables.size(), pool, [&](size_t k) {
+      const Variable &v = variables[k];
+      auto segment = q->segment(v.offset, v.dim);
+      segment.setZero();
+      for (auto &&use : v.uses) {
+        const Factor &f = factors[use.first];
+        segment += f.A.middleCols(f.blocks[use.second].column, v.dim)
+                       .transpose() *
+                   r[use.first];
+      }
+    });
+  };
+  const auto precondition = [&](const Vector &r, Vector *z) {
+    z->resize(n);
+    ForEach(groups.size(), pool, [&](size_t g) {
+      const Group &group = groups[g];
+      Vector rg(group.dim);
+      for (const size_t v : group.variables)
+        rg.segment(group.local.at(v), variables[v].dim) =
+            r.segment(variables[v].offset, variables[v].dim);
+      const Vector zg = group.cholesky.solve(rg);
+      for (const size_t v : group.variables)
+        z->segment(variables[v].offset, variables[v].dim) =
+            zg.segment(group.local.at(v), variables[v].dim);
+    });
+  };
+
+  // Conjugate gradient on A^T A x = A^T b, from x = 0.
+  std::vector<Vector> b(factors.size());
+  for (size_t i = 0; i < factors.size(); ++i) b[i] = factors[i].b;
+  Vector x = Vector::Zero(n), r, z, q;
+  multiply_At(b, &r);
+  const double tolerance = parameters.relative_tolerance * r.norm();
+  precondition(r, &z);
+  Vector p = z;
+  double rz = r.dot(z);
+  size_t k = 0;
+  for (; k < parameters.max_iterations && r.norm() > tolerance; ++k) {
+    multiply_A(p);
+    multiply_At(y, &q);
+    const double alpha = rz / p.dot(q);
+    x += alpha * p;
+    r -= alpha * q;
+    precondition(r, &z);
+    const double rz_next = r.dot(z);
+    p = z + (rz_next / rz) * p;
+    rz = rz_next;
+  }
+  if (iterations) *iterations = k;
+
+  gtsam::VectorValues solution;
+  for (auto &&v : variables)
+    solution.insert(v.key, x.segment(v.offset, v.dim));
+  return solution;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,62 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PCGSolver.h
+ * @brief Matrix-free preconditioned conjugate gradient for trajectory graphs.
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/// Parameters of PCGSolve.
+struct PCGParameters {
+  /**
+   * Blocks of the block-Jacobi preconditioner, by DynamicsSymbol. VARIABLE
+   * uses one block per variable; TIME_SLICE one per time step, with all
+   * variables of the step; LINK one per link and time step, with its pose,
+   * twist, twist acceleration and wrenches, and one per joint and time step
+   * with its angle, velocity, acceleration and torque.
+   */
+  enum Preconditioner { VARIABLE = 0, TIME_SLICE = 1, LINK = 2 };
+
+  Preconditioner preconditioner = TIME_SLICE;
+  size_t max_iterations = 1000;
+  /// Stop when the residual of the normal equations has shrunk by this.
+  double relative_tolerance = 1e-10;
+};
+
+/**
+ * Solve the linear least-squares problem `graph` by conjugate gradient on
+ * its normal equations A^T A x = A^T b, without forming A^T A: products with
+ * it go factor by factor, first A p per factor and then A^T y per variable,
+ * both in parallel on `pool` if given. Only the whitened Jacobian of every
+ * factor and the blocks of the preconditioner are stored, so memory scales
+ * with the nonzeros of the graph rather than with the fill-in of an
+ * elimination, e.g. for very long horizons.
+ *
+ * Throws gtsam::IndeterminantLinearSystemException if a block of the
+ * preconditioner is not positive definite. Within LM the damping keeps them
+ * positive definite.
+ *
+ * @param graph       the linear system, keys are typically DynamicsSymbols
+ * @param parameters  preconditioner and stopping criteria
+ * @param pool        optional thread pool for the products
+ * @param iterations  if given, set to the number of CG iterations
+ */
+gtsam::VectorValues PCGSolve(const gtsam::GaussianFactorGraph &graph,
+                             const PCGParameters &parameters = PCGParameters(),
+                             ThreadPool *pool = nullptr,
+                             size_t *iterations = nullptr);
+
+}  // namespace gtdynamics
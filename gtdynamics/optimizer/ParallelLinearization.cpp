@@ -0,0 +1,46 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParallelLinearization.cpp
+ * @brief Linearize a nonlinear factor graph on a thread pool.
+ */
+
+#include "gtdynamics/optimizer/ParallelLinearization.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace gtdynamics {
+
+// Factors per job: large enough that the shared counter and the job call are
+// amortized over tiny factors, small enough to balance uneven ones.
+static const size_t kChunkSize = 64;
+
+/* ************************************************************************* */
+gtsam::GaussianFactorGraph::shared_ptr ParallelLinearize(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    ThreadPool *pool) {
+  const size_t n = graph.size();
+  if (!pool || pool->numThreads() == 1 || n <= kChunkSize)
+    return graph.linearize(values);
+
+  std::vector<gtsam::GaussianFactor::shared_ptr> factors(n);
+  const size_t num_chunks = (n + kChunkSize - 1) / kChunkSize;
+  pool->parallelFor(num_chunks, [&](size_t chunk, size_t) {
+    const size_t end = std::min(n, (chunk + 1) * kChunkSize);
+    for (size_t k = chunk * kChunkSize; k < end; k++)
+      if (graph[k]) factors[k] = graph[k]->linearize(values);
+  });
+
+  auto linear = boost::make_shared<gtsam::GaussianFactorGraph>();
+  linear->reserve(n);
+  for (auto &&factor : factors) linear->push_back(factor);
+  return linear;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,37 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ParallelLinearization.h
+ * @brief Linearize a nonlinear factor graph on a thread pool.
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * Linearize `graph` at `values`, as NonlinearFactorGraph::linearize, with the
+ * factors split over the threads of `pool`. Factors are handed out in
+ * contiguous chunks and each linear factor is written to its own slot, so the
+ * result has the same factors in the same order as the serial version, and
+ * null factors stay null.
+ * @param graph   the graph to linearize
+ * @param values  linearization point
+ * @param pool    threads to use, or null to linearize serially
+ */
+gtsam::GaussianFactorGraph::shared_ptr ParallelLinearize(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    ThreadPool *pool);
+
+}  // namespace gtdynamics
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PenaltyFactor.cpp
+ * @brief Penalty term of an equality constraint with adjustable weight.
+ */
+
+#include "gtdynamics/optimizer/PenaltyFactor.h"
+
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+PenaltyFactor::PenaltyFactor(const EqualityConstraint &constraint, double mu)
+    : factor_(constraint.createFactor(1.0)),
+      mu_(mu),
+      bias_(gtsam::Vector::Zero(constraint.dim())),
+      inequality_(false) {
+  keys_ = factor_->keys();
+}
+
+/* ************************************************************************* */
+PenaltyFactor::PenaltyFactor(const InequalityConstraint &constraint, double mu)
+    : factor_(constraint.createFactor(1.0)),
+      mu_(mu),
+      bias_(gtsam::Vector::Zero(constraint.dim())),
+      inequality_(true) {
+  keys_ = factor_->keys();
+}
+
+/* ************************************************************************* */
+double PenaltyFactor::error(const gtsam::Values &x) const {
+  if (!active(x)) return 0.0;
+  gtsam::Vector e = factor_->unwhitenedError(x) + bias_;
+  if (inequality_) e = e.cwiseMin(0.0);
+  return 0.5 * mu_ * factor_->noiseModel()->whiten(e).squaredNorm();
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> PenaltyFactor::linearize(
+    const gtsam::Values &x) const {
+  if (!active(x)) return boost::shared_ptr<gtsam::JacobianFactor>();
+
+  std::vector<gtsam::Matrix> A(size());
+  gtsam::Vector b = -(factor_->unwhitenedError(x, A) + bias_);
+  if (inequality_) {
+    // Satisfied components are dropped from the linearization.
+    for (int i = 0; i < b.size(); i++) {
+      if (b(i) >= 0) continue;
+      b(i) = 0;
+      for (auto &&Aj : A) Aj.row(i).setZero();
+    }
+  }
+  factor_->noiseModel()->WhitenSystem(A, b);
+
+  const double scale = std::sqrt(mu_);
+  std::vector<std::pair<gtsam::Key, gtsam::Matrix>> terms(size());
+  for (size_t j = 0; j < size(); ++j) {
+    terms[j].first = keys()[j];
+    terms[j].second.swap(A[j]);
+    terms[j].second *= scale;
+  }
+  return boost::make_shared<gtsam::JacobianFactor>(terms, scale * b);
+}
+
+}  // namespace gtdynamics
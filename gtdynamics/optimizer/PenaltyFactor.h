@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PenaltyFactor.h
+ * @brief Penalty term of a constraint with adjustable weight.
+ */
+
+#pragma once
+
+#include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include "gtdynamics/optimizer/EqualityConstraint.h"
+#include "gtdynamics/optimizer/InequalityConstraint.h"
+
+namespace gtdynamics {
+
+/**
+ * PenaltyFactor is the term 1/2 mu ||g(x) + bias||^2_Diag(tolerance^2) of an
+ * equality constraint in a merit function, the same as
+ * EqualityConstraint::createFactor(mu, bias), except that mu and the bias can
+ * be changed in place. Penalty-type optimizers can then build the merit graph
+ * once and only update its penalty terms between outer iterations.
+ *
+ * For an inequality constraint g(x) >= 0 the penalty is one-sided,
+ * 1/2 mu ||min(0, g(x) + bias)||^2_Diag(tolerance^2): components with
+ * g(x) + bias > 0 contribute neither error nor Jacobian rows.
+ *
+ * Note that graphs share factors through pointers, so changing mu or the
+ * bias changes every graph holding this factor.
+ */
+class PenaltyFactor : public gtsam::NonlinearFactor {
+ public:
+  using shared_ptr = boost::shared_ptr<PenaltyFactor>;
+
+  /**
+   * Constructor
+   * @param constraint  the equality constraint g(x) = 0
+   * @param mu          penalty parameter
+   */
+  explicit PenaltyFactor(const EqualityConstraint &constraint,
+                         double mu = 1.0);
+
+  /**
+   * Constructor for the one-sided penalty of an inequality constraint.
+   * @param constraint  the inequality constraint g(x) >= 0
+   * @param mu          penalty parameter
+   */
+  explicit PenaltyFactor(const InequalityConstraint &constraint,
+                         double mu = 1.0);
+
+  /// Set the penalty parameter.
+  void setMu(double mu) { mu_ = mu; }
+
+  /// Set the bias, of the constraint dimension.
+  void setBias(const gtsam::Vector &bias) { bias_ = bias; }
+
+  double mu() const { return mu_; }
+  bool isInequality() const { return inequality_; }
+  const gtsam::Vector &bias() const { return bias_; }
+
+  size_t dim() const override { return factor_->dim(); }
+
+  double error(const gtsam::Values &x) const override;
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<PenaltyFactor>(*this);
+  }
+
+ private:
+  gtsam::NoiseModelFactor::shared_ptr factor_;  // g(x), weighted by tolerance
+  double mu_;
+  gtsam::Vector bias_;
+  bool inequality_;  // penalize only negative components of g(x) + bias
+};
+
+}  // namespace gtdynamics
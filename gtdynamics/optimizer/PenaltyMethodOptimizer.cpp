@@ -13,41 +13,114 @@
 
 #include "gtdynamics/optimizer/PenaltyMethodOptimizer.h"
 
+#include <memory>
+
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/Trace.h"
+
 namespace gtdynamics {
 
 gtsam::Values PenaltyMethodOptimizer::optimize(
     const gtsam::NonlinearFactorGraph& graph,
     const EqualityConstraints& constraints, const gtsam::Values& initial_values,
     ConstrainedOptResult* intermediate_result) const {
+  return optimize(graph, constraints, InequalityConstraints(), initial_values,
+                  intermediate_result);
+}
+
+gtsam::Values PenaltyMethodOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints,
+    const InequalityConstraints& inequalities,
+    const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  GTD_TRACE_SCOPE("PenaltyMethodOptimizer::optimize");
   gtsam::Values values = initial_values;
   double mu = p_.initial_mu;
+  const ProfileTimer total_timer;
+  const Deadline deadline(p_.time_budget);
+  OptimizerProfile* profile =
+      intermediate_result ? &intermediate_result->profile : nullptr;
+
+  // Construct merit function once; only its penalty parameter changes.
+  const ProfileTimer construction_timer;
+  std::vector<PenaltyFactor::shared_ptr> penalties, inequality_penalties;
+  const gtsam::NonlinearFactorGraph merit_graph = MeritGraph(
+      graph, constraints, inequalities, &penalties, &inequality_penalties);
+  const gtsam::LevenbergMarquardtParams lm_parameters =
+      WithOrdering(p_.lm_parameters, merit_graph);
+  if (profile) profile->graph_construction += construction_timer.elapsed();
+
+  std::unique_ptr<ThreadPool> pool;
+  if (p_.num_threads != 1) pool.reset(new ThreadPool(p_.num_threads));
+
+  // Violations are only evaluated if the schedule or the result needs them.
+  const bool track = deadline.active() || p_.feasibility_tolerance > 0 ||
+                     p_.progress_ratio > 0 || p_.inner_tolerance_factor > 0;
+  const auto violation_at = [&](const gtsam::Values& x) {
+    const ProfileTimer timer;
+    const double violation =
+        Violation(constraints, inequalities, x, pool.get());
+    if (profile) profile->constraint_evaluation += timer.elapsed();
+    return violation;
+  };
+  double violation = track ? violation_at(values) : 0.0;
+
+  // With a time budget, the best iterate is returned, not the last one.
+  BestIterate best(p_.feasibility_tolerance);
+  if (deadline.active()) best.consider(values, violation, graph.error(values));
 
   // Solve the constrained optimization problem by solving a sequence of
   // unconstrained optimization problems.
+  bool timed_out = false;
   for (int i = 0; i < p_.num_iterations; i++) {
-    gtsam::NonlinearFactorGraph merit_graph = graph;
-
-    // Create factors corresponding to penalty terms of constraints.
-    for (auto& constraint : constraints) {
-      merit_graph.add(constraint->createFactor(mu));
+    if (deadline.passed()) {
+      timed_out = true;
+      break;
     }
+    GTD_TRACE_SCOPE("PenaltyMethodOptimizer::outer_iteration");
+    for (auto& penalty : penalties) penalty->setMu(mu);
+    for (auto& penalty : inequality_penalties) penalty->setMu(mu);
 
     // Run optimization.
-    gtsam::LevenbergMarquardtOptimizer optimizer(merit_graph, values,
-                                                 p_.lm_parameters);
-    auto result = optimizer.optimize();
+    size_t inner_iterations;
+    auto result = OptimizeLM(
+        merit_graph, values,
+        InnerParameters(lm_parameters, p_.inner_tolerance_factor, violation),
+        profile, &inner_iterations, pool.get(), p_.block_tridiagonal,
+        &deadline, nullptr, p_.pcg.get_ptr());
 
-    // Save results and update parameters.
+    // Save results and update parameters: mu grows unless the violations
+    // dropped enough.
     values = result;
-    mu *= p_.mu_increase_rate;
+    const double previous_violation = violation;
+    if (track) violation = violation_at(values);
+    if (violation >= p_.progress_ratio * previous_violation)
+      mu *= p_.mu_increase_rate;
+    if (deadline.active())
+      best.consider(values, violation, graph.error(values));
 
     /// Store intermediate results.
     if (intermediate_result != nullptr) {
       intermediate_result->intermediate_values.push_back(values);
-      intermediate_result->num_iters.push_back(optimizer.getInnerIterations());
+      intermediate_result->num_iters.push_back(inner_iterations);
       intermediate_result->mu_values.push_back(mu);
     }
+
+    // Stop once feasible, if asked to.
+    if (p_.feasibility_tolerance > 0 && violation <= p_.feasibility_tolerance)
+      break;
+  }
+  timed_out = timed_out || deadline.passed();
+  if (deadline.active()) values = best.values();
+
+  if (intermediate_result) {
+    intermediate_result->timed_out = timed_out;
+    intermediate_result->violation =
+        Violation(constraints, inequalities, values, pool.get());
+    intermediate_result->cost = graph.error(values);
   }
+  if (profile) profile->total += total_timer.elapsed();
   return values;
 }
 
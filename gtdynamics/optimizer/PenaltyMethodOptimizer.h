@@ -24,6 +24,12 @@ struct PenaltyMethodParameters : public ConstrainedOptimizationParameters {
   double initial_mu;        // initial penalty parameter
   double mu_increase_rate;  // increase rate of penalty parameter
 
+  /// If positive, mu is only increased when the norm of the scaled
+  /// violations did not drop below progress_ratio times the last one, so
+  /// outer iterations that still make progress keep the conditioning of the
+  /// merit graph; zero increases mu every outer iteration.
+  double progress_ratio = 0.0;
+
   /** Constructor. */
   PenaltyMethodParameters()
       : Base(gtsam::LevenbergMarquardtParams()),
@@ -41,7 +47,7 @@ struct PenaltyMethodParameters : public ConstrainedOptimizationParameters {
         mu_increase_rate(_mu_increase_rate) {}
 };
 
-/// Penalty method only considering equality constraints.
+/// Penalty method for equality and inequality constraints.
 class PenaltyMethodOptimizer : public ConstrainedOptimizer {
  protected:
   const PenaltyMethodParameters p_;
@@ -62,6 +68,14 @@ class PenaltyMethodOptimizer : public ConstrainedOptimizer {
       const EqualityConstraints& constraints,
       const gtsam::Values& initial_values,
       ConstrainedOptResult* intermediate_result = nullptr) const override;
+
+  /// Run optimization with one-sided penalties for the inequalities.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const InequalityConstraints& inequalities,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
 };
 
 }  // namespace gtdynamics
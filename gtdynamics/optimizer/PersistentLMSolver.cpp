@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PersistentLMSolver.cpp
+ * @brief Levenberg-Marquardt solver that keeps its setup across solves of
+ * graphs with the same structure.
+ */
+
+#include "gtdynamics/optimizer/PersistentLMSolver.h"
+
+#include "gtdynamics/optimizer/NestedDissectionOrdering.h"
+#include "gtdynamics/optimizer/TimeMajorOrdering.h"
+#include "gtdynamics/utils/Trace.h"
+
+namespace gtdynamics {
+
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+/* ************************************************************************* */
+PersistentLMSolver::PersistentLMSolver(
+    const OptimizationParameters &parameters)
+    : p_(ResolveLinearSolver(parameters)) {
+  if (p_.num_threads != 1) pool_.reset(new ThreadPool(p_.num_threads));
+}
+
+/* ************************************************************************* */
+bool PersistentLMSolver::sameStructure(
+    const NonlinearFactorGraph &graph) const {
+  if (structure_.empty() || graph.size() != structure_.size()) return false;
+  for (size_t i = 0; i < graph.size(); i++) {
+    const gtsam::KeyVector empty;
+    const gtsam::KeyVector &keys = graph[i] ? graph[i]->keys() : empty;
+    if (keys != structure_[i]) return false;
+  }
+  return true;
+}
+
+/* ************************************************************************* */
+Values PersistentLMSolver::optimize(const NonlinearFactorGraph &graph,
+                                    const Values &initial_values,
+                                    OptimizerProfile *profile) {
+  GTD_TRACE_SCOPE("PersistentLMSolver::optimize");
+  const ProfileTimer timer;
+  gtsam::LevenbergMarquardtParams parameters = p_.lm_parameters;
+  if (!parameters.ordering) {
+    if (!sameStructure(graph)) {
+      GTD_TRACE_SCOPE("PersistentLMSolver::rebuild");
+      structure_.clear();
+      for (const auto &factor : graph)
+        structure_.push_back(factor ? factor->keys() : gtsam::KeyVector());
+      if (!p_.ordering_robot)
+        ordering_ = gtsam::Ordering::Create(parameters.orderingType, graph);
+      else if (p_.nested_dissection)
+        ordering_ = NestedDissectionOrdering(*p_.ordering_robot, graph.keys());
+      else
+        ordering_ = TimeMajorOrdering(*p_.ordering_robot, graph.keys());
+      num_rebuilds_++;
+    }
+    parameters.ordering = ordering_;
+  }
+  const Values result =
+      OptimizeLM(graph, initial_values, parameters, profile, nullptr,
+                 pool_.get(), p_.block_tridiagonal, nullptr, nullptr,
+                 p_.pcg.get_ptr());
+  if (profile) profile->total += timer.elapsed();
+  return result;
+}
+
+}  // namespace gtdynamics
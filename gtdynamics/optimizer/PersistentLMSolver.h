@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PersistentLMSolver.h
+ * @brief Levenberg-Marquardt solver that keeps its setup across solves of
+ * graphs with the same structure.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <memory>
+#include <vector>
+
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/optimizer/OptimizerProfile.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * PersistentLMSolver solves graphs with Levenberg-Marquardt as
+ * Optimizer::optimize does, but keeps what only depends on the structure of
+ * the graph, the keys of its factors, between calls: the elimination
+ * ordering, including a TimeMajorOrdering if asked for, and the threads that
+ * linearize the factors. Each solve compares the structure of its graph with
+ * the last one and only recomputes them when it changed, so repeated solves
+ * of graphs with the same structure skip the COLAMD ordering and the thread
+ * start-up, e.g. in model-predictive control or parameter sweeps.
+ */
+class PersistentLMSolver {
+ public:
+  /// Constructor; the method of `parameters` is ignored.
+  explicit PersistentLMSolver(
+      const OptimizationParameters &parameters = OptimizationParameters());
+
+  /**
+   * Optimize `graph` from `initial_values`.
+   * @param graph           the graph to optimize
+   * @param initial_values  initial estimate for all variables
+   * @param profile         (optional) timings of the solve are added to it
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial_values,
+                         OptimizerProfile *profile = nullptr);
+
+  /// Number of times the structure was (re)built.
+  size_t numRebuilds() const { return num_rebuilds_; }
+
+  /// The elimination ordering of the current structure.
+  const gtsam::Ordering &ordering() const { return ordering_; }
+
+  /// Forget the structure, so the next solve rebuilds it.
+  void reset() { structure_.clear(); }
+
+ private:
+  const OptimizationParameters p_;
+  std::unique_ptr<ThreadPool> pool_;
+
+  std::vector<gtsam::KeyVector> structure_;  // keys of each factor
+  gtsam::Ordering ordering_;
+  size_t num_rebuilds_ = 0;
+
+  // Whether `graph` has the keys of structure_, factor by factor.
+  bool sameStructure(const gtsam::NonlinearFactorGraph &graph) const;
+};
+
+}  // namespace gtdynamics
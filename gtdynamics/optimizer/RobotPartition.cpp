@@ -0,0 +1,46 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotPartition.cpp
+ * @brief Split a multi-robot graph by the robot instances of its keys.
+ */
+
+#include "gtdynamics/optimizer/RobotPartition.h"
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+RobotPartition PartitionByRobot(const gtsam::NonlinearFactorGraph &graph) {
+  RobotPartition partition;
+  for (const auto &factor : graph) {
+    if (!factor || factor->empty()) continue;
+    const size_t robot = DynamicsSymbol::RobotInstance(factor->front());
+    bool single = true;
+    for (const gtsam::Key key : factor->keys())
+      single = single && DynamicsSymbol::RobotInstance(key) == robot;
+    if (single) {
+      partition.robots[robot].push_back(factor);
+    } else {
+      partition.coupling.push_back(factor);
+      partition.coupling_keys.insert(factor->begin(), factor->end());
+    }
+  }
+  return partition;
+}
+
+/* ************************************************************************* */
+gtsam::Ordering MultiRobotOrdering(const gtsam::NonlinearFactorGraph &graph) {
+  const RobotPartition partition = PartitionByRobot(graph);
+  const gtsam::KeyVector last(partition.coupling_keys.begin(),
+                              partition.coupling_keys.end());
+  return gtsam::Ordering::ColamdConstrainedLast(graph, last);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,49 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotPartition.h
+ * @brief Split a multi-robot graph by the robot instances of its keys.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <map>
+
+namespace gtdynamics {
+
+/**
+ * Factors of a multi-robot graph grouped by robot instance, see
+ * DynamicsSymbol::RobotTime: the factors all of whose keys belong to one
+ * robot, and the coupling factors between robots.
+ */
+struct RobotPartition {
+  std::map<size_t, gtsam::NonlinearFactorGraph> robots;  // by robot instance
+  gtsam::NonlinearFactorGraph coupling;  // factors on several robots
+  gtsam::KeySet coupling_keys;           // keys of the coupling factors
+};
+
+/**
+ * Partition the factors of `graph` by robot instance. Keys should be
+ * DynamicsSymbols; factors keep their order within each part.
+ */
+RobotPartition PartitionByRobot(const gtsam::NonlinearFactorGraph &graph);
+
+/**
+ * Elimination ordering that eliminates the variables of every robot before
+ * the keys of the coupling factors, with COLAMD. The robots are then
+ * independent subtrees of the elimination tree, which multifrontal
+ * elimination processes in parallel, and are only joined at the separator of
+ * the coupling keys.
+ */
+gtsam::Ordering MultiRobotOrdering(const gtsam::NonlinearFactorGraph &graph);
+
+}  // namespace gtdynamics
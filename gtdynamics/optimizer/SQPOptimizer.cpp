@@ -0,0 +1,156 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.cpp
+ * @brief Gauss-Newton SQP optimization routines.
+ */
+
+#include "gtdynamics/optimizer/SQPOptimizer.h"
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <cmath>
+#include <memory>
+
+#include "gtdynamics/optimizer/ParallelLinearization.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/Trace.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+gtsam::Values SQPOptimizer::optimize(
+    const gtsam::NonlinearFactorGraph& graph,
+    const EqualityConstraints& constraints, const gtsam::Values& initial_values,
+    ConstrainedOptResult* intermediate_result) const {
+  GTD_TRACE_SCOPE("SQPOptimizer::optimize");
+  const ProfileTimer total_timer;
+  const Deadline deadline(p_.time_budget);
+  OptimizerProfile* profile =
+      intermediate_result ? &intermediate_result->profile : nullptr;
+
+  // Costs followed by the constraints, whitened by their tolerances.
+  const ProfileTimer construction_timer;
+  gtsam::NonlinearFactorGraph kkt_graph = graph;
+  kkt_graph.reserve(graph.size() + constraints.size());
+  for (const auto& constraint : constraints)
+    kkt_graph.push_back(constraint->createFactor(1.0));
+  const gtsam::Ordering ordering =
+      p_.lm_parameters.ordering
+          ? *p_.lm_parameters.ordering
+          : gtsam::Ordering::Create(p_.lm_parameters.orderingType, kkt_graph);
+  const gtsam::KeySet keys = kkt_graph.keys();
+  if (profile) profile->graph_construction += construction_timer.elapsed();
+
+  std::unique_ptr<ThreadPool> pool;
+  if (p_.num_threads != 1) pool.reset(new ThreadPool(p_.num_threads));
+
+  ConstraintViolations violations;
+  const auto merit = [&](const gtsam::Values& x) {
+    const ProfileTimer timer;
+    constraints.evaluateInto(x, &violations, pool.get());
+    if (profile) profile->constraint_evaluation += timer.elapsed();
+    return graph.error(x) +
+           p_.merit_weight * violations.scaled_violation.lpNorm<1>();
+  };
+
+  gtsam::Values values = initial_values;
+  double current_merit = merit(values);
+
+  // With a time budget, the best iterate is returned, not the last one.
+  BestIterate best(p_.feasibility_tolerance);
+  const auto consider = [&](const gtsam::Values& x) {
+    best.consider(x, violations.scaled_violation.norm(), graph.error(x));
+  };
+  if (deadline.active()) consider(values);
+
+  bool timed_out = false;
+  for (size_t i = 0; i < p_.max_iterations; i++) {
+    if (deadline.passed()) {
+      timed_out = true;
+      break;
+    }
+    GTD_TRACE_SCOPE("SQPOptimizer::iteration");
+    const ProfileTimer iteration_timer;
+
+    // Linearize costs and constraints at once; constraint rows become hard.
+    ProfileTimer timer;
+    gtsam::GaussianFactorGraph::shared_ptr linear =
+        ParallelLinearize(kkt_graph, values, pool.get());
+    for (size_t k = graph.size(); k < kkt_graph.size(); k++) {
+      auto jacobian =
+          boost::dynamic_pointer_cast<gtsam::JacobianFactor>(linear->at(k));
+      if (!jacobian) continue;
+      auto hard = boost::make_shared<gtsam::JacobianFactor>(*jacobian);
+      hard->setModel(true, gtsam::Vector::Zero(hard->rows()));
+      (*linear)[k] = hard;
+    }
+    if (p_.damping > 0) {
+      const double sigma = 1.0 / std::sqrt(p_.damping);
+      for (const gtsam::Key key : keys) {
+        const size_t dim = values.at(key).dim();
+        linear->add(key, gtsam::Matrix::Identity(dim, dim),
+                    gtsam::Vector::Zero(dim),
+                    gtsam::noiseModel::Isotropic::Sigma(dim, sigma));
+      }
+    }
+    if (profile) {
+      profile->linearization += timer.elapsed();
+      profile->num_linearizations++;
+    }
+
+    // Equality-constrained least-squares step.
+    timer = ProfileTimer();
+    const gtsam::VectorValues delta =
+        linear->optimize(ordering, gtsam::EliminateQR);
+    if (profile) {
+      profile->elimination += timer.elapsed();
+      profile->num_eliminations++;
+    }
+
+    // Backtracking line search on the l1 merit function.
+    double step = 1.0, new_merit = current_merit;
+    gtsam::Values new_values;
+    for (; step >= p_.min_step; step *= p_.line_search_factor) {
+      new_values = values.retract(step * delta);
+      new_merit = merit(new_values);
+      if (new_merit < current_merit) break;
+    }
+    const bool accepted = step >= p_.min_step;
+    if (profile) {
+      profile->iterations.push_back({iteration_timer.elapsed(), current_merit,
+                                     accepted ? new_merit : current_merit});
+    }
+    if (!accepted) break;
+
+    values = new_values;
+    current_merit = new_merit;
+    if (deadline.active()) consider(values);
+    if (intermediate_result) {
+      intermediate_result->intermediate_values.push_back(values);
+      intermediate_result->num_iters.push_back(1);
+      intermediate_result->mu_values.push_back(p_.merit_weight);
+    }
+    if (step * delta.norm() < p_.step_tolerance) break;
+  }
+  if (deadline.active()) values = best.values();
+
+  if (intermediate_result) {
+    intermediate_result->timed_out = timed_out;
+    intermediate_result->violation =
+        std::sqrt(constraints.evaluate(values, nullptr, pool.get()));
+    intermediate_result->cost = graph.error(values);
+  }
+  if (profile) profile->total += total_timer.elapsed();
+  return values;
+}
+
+}  // namespace gtdynamics
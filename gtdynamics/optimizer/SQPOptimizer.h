@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SQPOptimizer.h
+ * @brief Gauss-Newton SQP optimizer, solving the KKT system of the linearized
+ * costs and constraints in every iteration.
+ */
+
+#pragma once
+
+#include "gtdynamics/optimizer/ConstrainedOptimizer.h"
+
+namespace gtdynamics {
+
+/// Parameters for the SQP optimizer.
+struct SQPParameters : public ConstrainedOptimizationParameters {
+  using Base = ConstrainedOptimizationParameters;
+  size_t max_iterations = 50;  // maximum number of SQP iterations
+  double merit_weight = 1e2;   // weight of the l1 violation in the merit
+  double line_search_factor = 0.5;  // step shrinking in the line search
+  double min_step = 1e-4;           // smallest step length tried
+  double damping = 1e-6;  // Tikhonov damping of the steps, 0 for none
+  double step_tolerance = 1e-8;  // converged if the step is smaller
+
+  /** Constructor. */
+  SQPParameters() {}
+
+  /** Constructor with LM parameters, of which only the ordering is used. */
+  SQPParameters(const gtsam::LevenbergMarquardtParams& _lm_parameters)
+      : Base(_lm_parameters) {}
+};
+
+/**
+ * Sequential quadratic programming with a Gauss-Newton Hessian: every
+ * iteration linearizes the costs and the equality constraints together and
+ * solves the equality-constrained least-squares step
+ *   min_dx 1/2 ||A dx - b||^2  s.t.  C dx = -c(x),
+ * by eliminating the constraint rows as hard (zero-sigma) rows with QR, which
+ * solves the KKT system in the constraint nullspace. The step is then scaled
+ * back until the l1 merit f(x) + merit_weight ||c(x)/tolerance||_1 decreases.
+ *
+ * Unlike the penalty and augmented Lagrangian methods, there is one
+ * linearization per iteration rather than a full LM solve per outer
+ * iteration; near a solution of a problem with small residuals the steps
+ * converge superlinearly.
+ */
+class SQPOptimizer : public ConstrainedOptimizer {
+ protected:
+  const SQPParameters p_;
+
+ public:
+  /** Default constructor. */
+  SQPOptimizer() : p_(SQPParameters()) {}
+
+  /**
+   * Construct from parameters.
+   */
+  SQPOptimizer(const SQPParameters& parameters) : p_(parameters) {}
+
+  /// Inequalities are not supported; the base version throws.
+  using ConstrainedOptimizer::optimize;
+
+  /// Run optimization; one intermediate result per SQP iteration.
+  gtsam::Values optimize(
+      const gtsam::NonlinearFactorGraph& graph,
+      const EqualityConstraints& constraints,
+      const gtsam::Values& initial_values,
+      ConstrainedOptResult* intermediate_result = nullptr) const override;
+};
+
+}  // namespace gtdynamics
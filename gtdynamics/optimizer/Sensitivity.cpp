@@ -0,0 +1,179 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Sensitivity.cpp
+ * @brief Derivatives of optimized trajectories with respect to parameters.
+ */
+
+#include "gtdynamics/optimizer/Sensitivity.h"
+
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+namespace {
+// Whitened residual of `factor` at `values`, as linearized by LM.
+gtsam::Vector Residual(const gtsam::NonlinearFactor &factor,
+                       const gtsam::Values &values) {
+  if (auto noise_model_factor =
+          dynamic_cast<const gtsam::NoiseModelFactor *>(&factor))
+    return noise_model_factor->whitenedError(values);
+  const auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+      factor.linearize(values));
+  if (!jacobian)
+    throw std::invalid_argument(
+        "Sensitivity: factors should linearize to Jacobian factors");
+  return -jacobian->getb();
+}
+
+// Stacked whitened residuals of `graph` at `values`, with the layout of
+// `offsets`.
+gtsam::Vector Residuals(const gtsam::NonlinearFactorGraph &graph,
+                        const gtsam::Values &values,
+                        const std::vector<size_t> &offsets) {
+  if (graph.size() + 1 != offsets.size())
+    throw std::runtime_error(
+        "Sensitivity: the graph changed size with the parameters");
+  gtsam::Vector residuals(offsets.back());
+  for (size_t i = 0; i < graph.size(); ++i) {
+    const size_t rows = offsets[i + 1] - offsets[i];
+    if (!graph[i]) {
+      if (rows) throw std::runtime_error("Sensitivity: factor " +
+                                         std::to_string(i) + " disappeared");
+      continue;
+    }
+    const gtsam::Vector r = Residual(*graph[i], values);
+    if (static_cast<size_t>(r.size()) != rows)
+      throw std::runtime_error("Sensitivity: factor " + std::to_string(i) +
+                               " changed dimension with the parameters");
+    residuals.segment(offsets[i], rows) = r;
+  }
+  return residuals;
+}
+}  // namespace
+
+/* ************************************************************************* */
+Sensitivity::Sensitivity(const ParametricGraph &build,
+                         const gtsam::Vector &parameters,
+                         const gtsam::Values &solution, double step,
+                         const boost::optional<gtsam::Ordering> &ordering) {
+  if (step <= 0)
+    throw std::invalid_argument("Sensitivity: step should be positive");
+
+  // Whitened Jacobian at the solution, one Gaussian factor per factor.
+  const gtsam::NonlinearFactorGraph graph = build(parameters);
+  size_t rows = 0;
+  for (auto &&factor : graph) {
+    offsets_.push_back(rows);
+    if (!factor) {
+      linear_.push_back(gtsam::GaussianFactor::shared_ptr());
+      continue;
+    }
+    const auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+        factor->linearize(solution));
+    if (!jacobian)
+      throw std::invalid_argument(
+          "Sensitivity: factors should linearize to Jacobian factors");
+    if (jacobian->isConstrained())
+      throw std::invalid_argument(
+          "Sensitivity: constrained noise models are not supported");
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it)
+      if (!zero_.exists(*it))
+        zero_.insert(*it, gtsam::Vector::Zero(jacobian->getDim(it)));
+    rows += jacobian->rows();
+    linear_.push_back(jacobian);
+  }
+  offsets_.push_back(rows);
+  bayes_net_ = linear_.eliminateSequential(
+      ordering ? *ordering : gtsam::Ordering::Colamd(linear_));
+
+  // Central differences of the residuals at the fixed solution.
+  residual_jacobian_.resize(rows, parameters.size());
+  cost_gradient_.resize(parameters.size());
+  for (int k = 0; k < parameters.size(); ++k) {
+    gtsam::Vector plus = parameters, minus = parameters;
+    plus(k) += step;
+    minus(k) -= step;
+    const gtsam::Vector r_plus = Residuals(build(plus), solution, offsets_);
+    const gtsam::Vector r_minus = Residuals(build(minus), solution, offsets_);
+    residual_jacobian_.col(k) = (r_plus - r_minus) / (2 * step);
+    cost_gradient_(k) =
+        0.5 * (r_plus.squaredNorm() - r_minus.squaredNorm()) / (2 * step);
+  }
+}
+
+/* ************************************************************************* */
+gtsam::Vector Sensitivity::costGradient() const { return cost_gradient_; }
+
+/* ************************************************************************* */
+gtsam::VectorValues Sensitivity::solutionDerivative(size_t k) const {
+  if (k >= numParameters())
+    throw std::invalid_argument("Sensitivity: no parameter " +
+                                std::to_string(k));
+  const gtsam::VectorValues g = transposeMultiply(residual_jacobian_.col(k));
+  return solveNormal(g).scale(-1.0);
+}
+
+/* ************************************************************************* */
+std::vector<gtsam::VectorValues> Sensitivity::solutionJacobian() const {
+  std::vector<gtsam::VectorValues> derivatives;
+  for (size_t k = 0; k < numParameters(); ++k)
+    derivatives.push_back(solutionDerivative(k));
+  return derivatives;
+}
+
+/* ************************************************************************* */
+gtsam::Vector Sensitivity::objectiveGradient(
+    const gtsam::VectorValues &objective_gradient) const {
+  const gtsam::VectorValues lambda = solveNormal(objective_gradient);
+  return -residual_jacobian_.transpose() * multiply(lambda);
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues Sensitivity::solveNormal(
+    const gtsam::VectorValues &g) const {
+  // J'J = R'R: solve R'y = g, then R x = y.
+  gtsam::VectorValues full = zero_;
+  full.update(g);
+  return bayes_net_->backSubstitute(bayes_net_->backSubstituteTranspose(full));
+}
+
+/* ************************************************************************* */
+gtsam::VectorValues Sensitivity::transposeMultiply(
+    const gtsam::Vector &v) const {
+  gtsam::VectorValues result = zero_;
+  for (size_t i = 0; i < linear_.size(); ++i) {
+    const auto jacobian =
+        boost::static_pointer_cast<gtsam::JacobianFactor>(linear_[i]);
+    if (!jacobian) continue;
+    const auto segment = v.segment(offsets_[i], jacobian->rows());
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it)
+      result.at(*it) += jacobian->getA(it).transpose() * segment;
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+gtsam::Vector Sensitivity::multiply(const gtsam::VectorValues &x) const {
+  gtsam::Vector result = gtsam::Vector::Zero(numResiduals());
+  for (size_t i = 0; i < linear_.size(); ++i) {
+    const auto jacobian =
+        boost::static_pointer_cast<gtsam::JacobianFactor>(linear_[i]);
+    if (!jacobian) continue;
+    auto segment = result.segment(offsets_[i], jacobian->rows());
+    for (auto it = jacobian->begin(); it != jacobian->end(); ++it)
+      segment += jacobian->getA(it) * x.at(*it);
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Sensitivity.h
+ * @brief Derivatives of optimized trajectories with respect to parameters.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/linear/GaussianBayesNet.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <functional>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Factor graph of model parameters, e.g. link lengths, masses or actuator
+ * sizes, as in trajectoryFG of a robot made from them. The graph has to have
+ * the same factors, on the same keys and of the same dimensions, for all
+ * parameters; only their residuals may change.
+ */
+using ParametricGraph =
+    std::function<gtsam::NonlinearFactorGraph(const gtsam::Vector &)>;
+
+/**
+ * Sensitivities of a converged least-squares solution x*(p) to the
+ * parameters p of its graph, by implicit differentiation: at a minimum of
+ * 0.5 |r(x, p)|^2 the Gauss-Newton optimality condition J' r = 0 gives
+ *
+ *     dx/dp = -(J'J)^-1 J' dr/dp,
+ *
+ * with J the whitened Jacobian at x*. The graph is linearized and factored
+ * once, at construction, and all derivatives reuse that factorization:
+ * solutionDerivative costs one forward and one back substitution per
+ * parameter, and objectiveGradient one adjoint solve for all parameters.
+ * dr/dp is found by central differences of the residuals at x*, which only
+ * rebuilds the graph, 2 dim(p) times, without optimizing.
+ *
+ * The solution should be converged and its graph have soft constraints only,
+ * with J'J positive definite, as with trajectoryFG and finite sigmas.
+ */
+class Sensitivity {
+ public:
+  /**
+   * Constructor, linearizes and factors the graph at the solution.
+   * @param build      graph of the parameters
+   * @param parameters the parameters p of the solution
+   * @param solution   converged solution x* of build(parameters)
+   * @param step       step of the central differences in p
+   * @param ordering   elimination ordering, COLAMD if not given
+   */
+  Sensitivity(const ParametricGraph &build, const gtsam::Vector &parameters,
+              const gtsam::Values &solution, double step = 1e-6,
+              const boost::optional<gtsam::Ordering> &ordering = boost::none);
+
+  /// Number of parameters.
+  size_t numParameters() const { return residual_jacobian_.cols(); }
+
+  /// Dimension of the stacked whitened residuals.
+  size_t numResiduals() const { return residual_jacobian_.rows(); }
+
+  /// Whitened dr/dp at the solution, factors stacked in graph order.
+  const gtsam::Matrix &residualJacobian() const { return residual_jacobian_; }
+
+  /// d(cost)/dp, where the cost is the graph error; by the envelope theorem
+  /// this is the partial derivative at the fixed solution, no solve needed.
+  gtsam::Vector costGradient() const;
+
+  /**
+   * dx/dp_k, the change of the solution, as a tangent vector at x*, per
+   * unit change of parameter k; x* + dp_k dx/dp_k is the first order
+   * prediction of the solution at p + dp_k e_k, retracted.
+   */
+  gtsam::VectorValues solutionDerivative(size_t k) const;
+
+  /// dx/dp for all parameters, see solutionDerivative.
+  std::vector<gtsam::VectorValues> solutionJacobian() const;
+
+  /**
+   * Gradient of an objective f(x*(p)) with respect to p, with one adjoint
+   * solve: lambda = (J'J)^-1 df/dx, then df/dp = -(J lambda)' dr/dp.
+   * @param objective_gradient df/dx at x*, in the tangent space as for
+   *                           solutionDerivative; keys absent are 0
+   */
+  gtsam::Vector objectiveGradient(
+      const gtsam::VectorValues &objective_gradient) const;
+
+ private:
+  // (J'J)^-1 g with the factorization.
+  gtsam::VectorValues solveNormal(const gtsam::VectorValues &g) const;
+
+  // J' v and J x, for stacked residual vectors v.
+  gtsam::VectorValues transposeMultiply(const gtsam::Vector &v) const;
+  gtsam::Vector multiply(const gtsam::VectorValues &x) const;
+
+  gtsam::GaussianFactorGraph linear_;   // whitened, at the solution
+  gtsam::GaussianBayesNet::shared_ptr bayes_net_;
+  gtsam::VectorValues zero_;            // all keys of the graph, zero
+  std::vector<size_t> offsets_;         // first row of each factor of linear_
+  gtsam::Matrix residual_jacobian_;     // whitened dr/dp
+  gtsam::Vector cost_gradient_;
+};
+
+}  // namespace gtdynamics
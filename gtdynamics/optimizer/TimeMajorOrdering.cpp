@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeMajorOrdering.cpp
+ * @brief Elimination ordering from the time steps of DynamicsSymbol keys and
+ * the kinematic tree of a robot.
+ */
+
+#include "gtdynamics/optimizer/TimeMajorOrdering.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+namespace gtdynamics {
+
+namespace {
+// Position of each link and joint in a depth-first traversal of the robot
+// from its roots, each joint right before its child link.
+struct TreeRanks {
+  std::map<DynamicsIndex, size_t> links, joints;
+
+  explicit TreeRanks(const Robot &robot) {
+    std::set<DynamicsIndex> children;
+    for (auto &&joint : robot.joints()) children.insert(joint->child()->id());
+    size_t rank = 0;
+    for (auto &&root : robot.links())
+      if (!children.count(root->id())) visit(root, &rank);
+    // Links only reachable through loops.
+    for (auto &&link : robot.links()) visit(link, &rank);
+  }
+
+  void visit(const LinkSharedPtr &link, size_t *rank) {
+    if (!links.emplace(link->id(), 0).second) return;
+    links[link->id()] = (*rank)++;
+    for (auto &&joint : link->joints()) {
+      if (joint->parent() != link || joints.count(joint->id())) continue;
+      joints[joint->id()] = (*rank)++;
+      visit(joint->child(), rank);
+    }
+  }
+};
+}  // namespace
+
+/* ************************************************************************* */
+gtsam::Ordering TimeMajorOrdering(const Robot &robot,
+                                  const gtsam::KeySet &keys) {
+  const TreeRanks ranks(robot);
+  const size_t none = ranks.links.size() + ranks.joints.size();
+
+  // Sort on (global, time, reversed tree rank, key).
+  using Entry = std::tuple<bool, uint64_t, size_t, gtsam::Key>;
+  std::vector<Entry> entries;
+  entries.reserve(keys.size());
+  for (const gtsam::Key key : keys) {
+    const DynamicsIndex j = DynamicsSymbol::JointIdx(key);
+    const DynamicsIndex i = DynamicsSymbol::LinkIdx(key);
+    size_t rank = none;
+    const auto joint = ranks.joints.find(j);
+    const auto link = ranks.links.find(i);
+    if (j != DynamicsSymbol::kNoIndex && joint != ranks.joints.end())
+      rank = joint->second;
+    else if (i != DynamicsSymbol::kNoIndex && link != ranks.links.end())
+      rank = link->second;
+    const bool global = rank == none;
+    entries.emplace_back(global, global ? 0 : DynamicsSymbol::Time(key),
+                         none - rank, key);
+  }
+  std::sort(entries.begin(), entries.end());
+
+  gtsam::Ordering ordering;
+  for (auto &&entry : entries) ordering.push_back(std::get<3>(entry));
+  return ordering;
+}
+
+/* ************************************************************************* */
+gtsam::Ordering TimeMajorOrdering(const Robot &robot,
+                                  const gtsam::NonlinearFactorGraph &graph) {
+  return TimeMajorOrdering(robot, graph.keys());
+}
+
+}  // namespace gtdynamics
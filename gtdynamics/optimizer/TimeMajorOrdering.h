@@ -0,0 +1,41 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeMajorOrdering.h
+ * @brief Elimination ordering from the time steps of DynamicsSymbol keys and
+ * the kinematic tree of a robot.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * Return an elimination ordering of `keys` computed from the keys alone:
+ * time step by time step, and within a step from the leaves of the kinematic
+ * tree of `robot` to its roots, so that a link's variables are eliminated
+ * after those of its child joints and links. Variables of a joint, including
+ * the wrenches it applies, come between its child and parent links. Keys
+ * without a link or joint, such as phase durations, couple many steps and
+ * come last.
+ * The cost is a sort of the keys, with no graph traversal.
+ */
+gtsam::Ordering TimeMajorOrdering(const Robot &robot,
+                                  const gtsam::KeySet &keys);
+
+/// Time-major ordering of the variables of `graph`, see above.
+gtsam::Ordering TimeMajorOrdering(const Robot &robot,
+                                  const gtsam::NonlinearFactorGraph &graph);
+
+}  // namespace gtdynamics
@@ -0,0 +1,211 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeWindowOptimizer.cpp
+ * @brief Solve long trajectory graphs as time windows reconciled with
+ * consensus ADMM.
+ */
+
+#include "gtdynamics/optimizer/TimeWindowOptimizer.h"
+
+#include <gtsam/linear/VectorValues.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+
+#include <boost/make_shared.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+using gtsam::Key;
+using gtsam::KeyVector;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::VectorValues;
+
+namespace gtdynamics {
+
+namespace {
+// Consensus term 1/2 rho ||Local(target, x)||^2 on a key of any type, with
+// the identity as the Jacobian of Local, exact at the target.
+class ConsensusFactor : public gtsam::NoiseModelFactor {
+  boost::shared_ptr<const Values> targets_;
+
+ public:
+  ConsensusFactor(Key key, const boost::shared_ptr<const Values> &targets,
+                  double rho)
+      : gtsam::NoiseModelFactor(
+            gtsam::noiseModel::Isotropic::Sigma(targets->at(key).dim(),
+                                                1.0 / std::sqrt(rho)),
+            KeyVector{key}),
+        targets_(targets) {}
+
+  Vector unwhitenedError(
+      const Values &x,
+      boost::optional<std::vector<gtsam::Matrix> &> H = boost::none)
+      const override {
+    const Vector e =
+        targets_->at(keys_[0]).localCoordinates_(x.at(keys_[0]));
+    if (H) (*H)[0] = gtsam::Matrix::Identity(e.size(), e.size());
+    return e;
+  }
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new ConsensusFactor(*this)));
+  }
+};
+
+// Earliest time index of the keys of a factor.
+uint64_t FirstStep(const gtsam::NonlinearFactor &factor) {
+  uint64_t first = std::numeric_limits<uint64_t>::max();
+  for (const Key key : factor.keys())
+    first = std::min(first, DynamicsSymbol::Time(key));
+  return first;
+}
+}  // namespace
+
+/* ************************************************************************* */
+std::vector<TimeWindow> TimeWindowOptimizer::split(
+    const NonlinearFactorGraph &graph) const {
+  uint64_t t_lo = std::numeric_limits<uint64_t>::max(), t_hi = 0;
+  for (const auto &factor : graph) {
+    if (!factor || factor->empty()) continue;
+    for (const Key key : factor->keys()) {
+      t_lo = std::min(t_lo, DynamicsSymbol::Time(key));
+      t_hi = std::max(t_hi, DynamicsSymbol::Time(key));
+    }
+  }
+  std::vector<TimeWindow> windows;
+  if (t_lo > t_hi) return windows;
+
+  // Windows of (nearly) equal numbers of steps.
+  const uint64_t span = t_hi - t_lo + 1;
+  const uint64_t num_windows =
+      std::max<uint64_t>(1, std::min<uint64_t>(p_.num_windows, span));
+  std::vector<uint64_t> starts;
+  for (uint64_t w = 0; w < num_windows; w++)
+    starts.push_back(t_lo + w * span / num_windows);
+  for (uint64_t w = 0; w < num_windows; w++) {
+    const uint64_t end = w + 1 < num_windows ? starts[w + 1] : t_hi + 1;
+    windows.push_back({starts[w], end - 1, NonlinearFactorGraph(), {}});
+  }
+
+  // Each factor goes to the window of its first step, and to the windows
+  // whose steps extended by the overlap contain it.
+  for (const auto &factor : graph) {
+    if (!factor || factor->empty()) continue;
+    const uint64_t first = FirstStep(*factor);
+    for (auto &&window : windows) {
+      if (first + p_.overlap < window.first_step ||
+          first > window.last_step + p_.overlap)
+        continue;
+      window.graph.push_back(factor);
+      window.keys.insert(factor->begin(), factor->end());
+    }
+  }
+  return windows;
+}
+
+/* ************************************************************************* */
+Values TimeWindowOptimizer::optimize(const NonlinearFactorGraph &graph,
+                                     const Values &initial,
+                                     TimeWindowResult *result) const {
+  const std::vector<TimeWindow> windows = split(graph);
+  const size_t W = windows.size();
+
+  // Keys shared by several windows, and the shared keys of each window.
+  std::map<Key, size_t> counts;
+  for (auto &&window : windows)
+    for (const Key key : window.keys) counts[key]++;
+  std::vector<KeyVector> shared(W);
+  Values z;
+  for (size_t i = 0; i < W; i++)
+    for (const Key key : windows[i].keys)
+      if (counts[key] > 1) {
+        shared[i].push_back(key);
+        if (!z.exists(key)) z.insert(key, initial.at(key));
+      }
+
+  std::vector<Values> x(W);
+  std::vector<VectorValues> u(W);
+  for (size_t i = 0; i < W; i++) {
+    for (const Key key : windows[i].keys) x[i].insert(key, initial.at(key));
+    for (const Key key : shared[i])
+      u[i].insert(key, Vector::Zero(initial.at(key).dim()));
+  }
+
+  ThreadPool pool(p_.num_threads);
+  TimeWindowResult status;
+  while (status.iterations < p_.max_iterations) {
+    status.iterations++;
+
+    // Window solves, each pulled towards z - u_i on its shared keys.
+    pool.parallelFor(W, [&](size_t i, size_t) {
+      Values z_i;
+      for (const Key key : shared[i]) z_i.insert(key, z.at(key));
+      const auto targets = boost::make_shared<const Values>(
+          z_i.retract(-1.0 * u[i]));
+      NonlinearFactorGraph window_graph = windows[i].graph;
+      for (const Key key : shared[i])
+        window_graph.emplace_shared<ConsensusFactor>(key, targets, p_.rho);
+      x[i] = gtsam::LevenbergMarquardtOptimizer(window_graph, x[i],
+                                                p_.lm_parameters)
+                 .optimize();
+    });
+    if (z.empty()) {
+      status.converged = true;
+      break;
+    }
+
+    // Consensus update: z moves to the mean of x_i + u_i.
+    VectorValues dz;
+    for (const Key key : z.keys())
+      dz.insert(key, Vector::Zero(z.at(key).dim()));
+    for (size_t i = 0; i < W; i++)
+      for (const Key key : shared[i])
+        dz.at(key) += (z.at(key).localCoordinates_(x[i].at(key)) +
+                       u[i].at(key)) /
+                      double(counts[key]);
+    const Values z_new = z.retract(dz);
+
+    status.primal_residual = 0;
+    status.dual_residual = 0;
+    for (size_t i = 0; i < W; i++)
+      for (const Key key : shared[i]) {
+        const Vector r = z_new.at(key).localCoordinates_(x[i].at(key));
+        u[i].at(key) += r;
+        status.primal_residual = std::max(status.primal_residual, r.norm());
+      }
+    for (const Key key : z.keys())
+      status.dual_residual =
+          std::max(status.dual_residual, p_.rho * dz.at(key).norm());
+    z = z_new;
+    if (status.primal_residual < p_.tolerance &&
+        status.dual_residual < p_.tolerance) {
+      status.converged = true;
+      break;
+    }
+  }
+  if (result) *result = status;
+
+  // Shared keys take the consensus, others their window's solution.
+  Values values = initial;
+  for (size_t i = 0; i < W; i++)
+    for (const Key key : windows[i].keys)
+      if (!z.exists(key)) values.update(key, x[i].at(key));
+  for (const Key key : z.keys()) values.update(key, z.at(key));
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TimeWindowOptimizer.h
+ * @brief Solve long trajectory graphs as time windows reconciled with
+ * consensus ADMM.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of TimeWindowOptimizer.
+struct TimeWindowParameters {
+  gtsam::LevenbergMarquardtParams lm_parameters;  // for every window solve
+  size_t num_windows = 4;      // number of time windows
+  size_t overlap = 0;          // steps each window extends into its neighbors
+  double rho = 100;            // weight of the consensus terms
+  size_t max_iterations = 50;  // ADMM iterations
+  double tolerance = 1e-5;     // on the primal and dual residuals
+  size_t num_threads = 0;      // threads for the windows, 0 for all cores
+};
+
+/// Convergence of a TimeWindowOptimizer solve.
+struct TimeWindowResult {
+  size_t iterations = 0;
+  double primal_residual = 0;  // largest distance of a window to consensus
+  double dual_residual = 0;    // rho times the largest consensus update
+  bool converged = false;
+};
+
+/// The factors of one time window and the keys they involve.
+struct TimeWindow {
+  uint64_t first_step, last_step;  // owned steps, inclusive
+  gtsam::NonlinearFactorGraph graph;
+  gtsam::KeySet keys;
+};
+
+/**
+ * TimeWindowOptimizer splits a graph along the time indices of its
+ * DynamicsSymbol keys, as from Trajectory::multiPhaseFactorGraph, into
+ * windows of consecutive steps and solves them independently, in parallel.
+ * Windows share the keys of factors across their boundaries, e.g. the states
+ * of collocation factors; these are reconciled with consensus ADMM:
+ *
+ *   x_i = argmin f_i(x) + rho/2 ||Local(z - u_i, x)||^2   for all windows i,
+ *   z   = mean_i (x_i + u_i),   u_i += Local(z, x_i),
+ *
+ * on the shared keys, with each window warm-started from its last solution.
+ * Each factor belongs to the window of the earliest step of its keys, so
+ * without overlap the windows sum to the original objective. With overlap,
+ * windows also hold the factors of `overlap` steps on either side, which
+ * speeds up consensus for constraint-like factors at the cost of weighting
+ * those factors more.
+ *
+ * The windows returned by split are self-contained, so they can also be
+ * solved by other processes or nodes with the same iterations.
+ */
+class TimeWindowOptimizer {
+ protected:
+  const TimeWindowParameters p_;
+
+ public:
+  /// Construct from parameters.
+  explicit TimeWindowOptimizer(
+      const TimeWindowParameters &parameters = TimeWindowParameters())
+      : p_(parameters) {}
+
+  /// Split `graph` into time windows, see the class documentation.
+  std::vector<TimeWindow> split(const gtsam::NonlinearFactorGraph &graph) const;
+
+  /**
+   * Optimize `graph` window by window.
+   * @param graph    the trajectory graph
+   * @param initial  initial values of all its keys
+   * @param result   if given, set to the convergence of the ADMM iterations
+   */
+  gtsam::Values optimize(const gtsam::NonlinearFactorGraph &graph,
+                         const gtsam::Values &initial,
+                         TimeWindowResult *result = nullptr) const;
+};
+
+}  // namespace gtdynamics
@@ -23,9 +23,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <cassert>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 
+#include "gtdynamics/utils/ThreadPool.h"
+
 namespace gtdynamics {
 
 using gtsam::Matrix3;
@@ -50,7 +54,11 @@ Pose3 PandaIKFast::forward(const Vector7& joint_values) {
   return Pose3(bRe, bte);
 }
 
-std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
+// Solutions are written into the columns of `out`, which must have room for
+// kMaxSolutions; returns the number of non-singular solutions, or -1 if
+// IKFast failed.
+static int SolveIk(const Pose3& bTe, double theta7,
+                     Eigen::Ref<gtsam::Matrix> out) {
   // default eigen matrix storage is column major, while the ikfast uses a
   // rowmajor one, rotation matrix needs to be transposed before getting the
   // data pointer
@@ -62,31 +70,74 @@ std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
   // The inputs (except "solutions") have to be arrays
   bool success = panda_internal::ComputeIk(bTe.translation().data(), bRe.data(),
                                            &theta7, solutions);
+  if (!success) return -1;
+
+  int num_sols = 0;
+  for (size_t i = 0; i < solutions.GetNumSolutions(); ++i) {
+    const ikfast::IkSolutionBase<panda_internal::IkReal>& sol =
+        solutions.GetSolution(i);
 
-  if (!success) {
+    // Just save solution if there is no extra degree of freedom, i.e.,if the
+    // resulting joint configurations are not in a singularity
+    if (sol.GetFree().size() != 0) continue;
+    if (num_sols == int(PandaIKFast::kMaxSolutions)) break;
+    sol.GetSolution(out.col(num_sols++).data(), NULL);
+  }
+  return num_sols;
+}
+
+std::vector<Vector7> PandaIKFast::inverse(const Pose3& bTe, double theta7) {
+  gtsam::Matrix buffer(kNumJoints, kMaxSolutions);
+  const int num_sols = SolveIk(bTe, theta7, buffer);
+  if (num_sols < 0) {
     fprintf(stderr, "Error: (inverse PandaIKFast) failed to get ik solution\n");
     return std::vector<Vector7>();
   }
 
-  unsigned int num_sols = (unsigned int)solutions.GetNumSolutions();
-
-  std::vector<Vector7> joint_values(num_sols, Vector7());
-  for (size_t i = 0, j = 0; i < num_sols; ++i) {
-    const ikfast::IkSolutionBase<panda_internal::IkReal>& sol =
-        solutions.GetSolution(i);
+  std::vector<Vector7> joint_values(num_sols);
+  for (int i = 0; i < num_sols; ++i) joint_values[i] = buffer.col(i);
+  return joint_values;
+}
 
-    if (sol.GetFree().size() == 0) {
-      // Just save solution if there is no extra degree of freedom, i.e.,if the
-      // resulting joint configurations are not in a singularity
-      sol.GetSolution(joint_values[j++].data(), NULL);
-    } else {
-      // If it is a singularity, do not save it and erase one of the solution
-      // "containers", so there are no empty solutions returned
-      joint_values.pop_back();
-    }
+void PandaIKFast::forward(const gtsam::Matrix& joint_values,
+                          std::vector<Pose3>* poses, ThreadPool* pool) {
+  assert(joint_values.rows() == int(kNumJoints));
+  const size_t n = joint_values.cols();
+  if (poses->size() != n) poses->resize(n);
+  const auto job = [&](size_t i, size_t /*worker*/) {
+    (*poses)[i] = forward(joint_values.col(i));
+  };
+  if (pool) {
+    pool->parallelFor(n, job);
+  } else {
+    for (size_t i = 0; i < n; ++i) job(i, 0);
   }
+}
 
-  return joint_values;
+void PandaIKFast::inverse(const std::vector<Pose3>& bTe,
+                          const gtsam::Vector& theta7,
+                          gtsam::Matrix* solutions,
+                          std::vector<size_t>* num_solutions,
+                          ThreadPool* pool) {
+  const size_t n = bTe.size();
+  if (size_t(theta7.size()) != n)
+    throw std::invalid_argument(
+        "PandaIKFast::inverse: need one theta7 per pose.");
+  if (size_t(solutions->rows()) != kNumJoints ||
+      size_t(solutions->cols()) != n * kMaxSolutions)
+    solutions->resize(kNumJoints, n * kMaxSolutions);
+  num_solutions->resize(n);
+  const auto job = [&](size_t i, size_t /*worker*/) {
+    const int num_sols =
+        SolveIk(bTe[i], theta7(i),
+                  solutions->middleCols(i * kMaxSolutions, kMaxSolutions));
+    (*num_solutions)[i] = num_sols < 0 ? 0 : num_sols;
+  };
+  if (pool) {
+    pool->parallelFor(n, job);
+  } else {
+    for (size_t i = 0; i < n; ++i) job(i, 0);
+  }
 }
 
 }  // namespace gtdynamics
@@ -18,6 +18,8 @@
 
 namespace gtdynamics {
 
+class ThreadPool;
+
 // Wrapper of IKFast functions for panda robot.
 class PandaIKFast {
  public:
@@ -46,6 +48,39 @@ class PandaIKFast {
    */
   static std::vector<gtsam::Vector7> inverse(const gtsam::Pose3& bRe,
                                              double theta7);
+
+  /// Most non-singular solutions one pose and theta7 can have, for an
+  /// analytic 6-DOF subchain.
+  static constexpr size_t kMaxSolutions = 16;
+
+  /**
+   * @brief Forward kinematics for many configurations, into a preallocated
+   * buffer.
+   *
+   * @param joint_values -- 7 x N, one configuration per column
+   * @param poses -- set to the N end-effector poses, resized only if needed
+   * @param pool -- if given, configurations are split over its threads
+   */
+  static void forward(const gtsam::Matrix& joint_values,
+                      std::vector<gtsam::Pose3>* poses,
+                      ThreadPool* pool = nullptr);
+
+  /**
+   * @brief Inverse kinematics for many poses, into preallocated buffers.
+   * Query i writes its solutions into columns [i * kMaxSolutions,
+   * i * kMaxSolutions + num_solutions[i]) of `solutions`; queries without
+   * solutions get zero, and nothing is printed.
+   *
+   * @param bTe -- N desired end-effector poses wrt the base frame
+   * @param theta7 -- N values of the 7th joint angle, one per pose
+   * @param solutions -- 7 x (N * kMaxSolutions), resized only if needed
+   * @param num_solutions -- number of solutions of each query, resized to N
+   * @param pool -- if given, queries are split over its threads
+   */
+  static void inverse(const std::vector<gtsam::Pose3>& bTe,
+                      const gtsam::Vector& theta7, gtsam::Matrix* solutions,
+                      std::vector<size_t>* num_solutions,
+                      ThreadPool* pool = nullptr);
 };
 
 }  // namespace gtdynamics
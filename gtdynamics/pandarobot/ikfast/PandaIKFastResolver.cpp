@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PandaIKFastResolver.cpp
+ * @brief Redundancy resolution of the Panda with PandaIKFast.
+ */
+
+#include "PandaIKFastResolver.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Vector7;
+
+/* ************************************************************************* */
+Vector7 PandaIKFastResolver::DefaultLowerLimits() {
+  return (Vector7() << -2.9671, -1.8326, -2.9671, -3.1416, -2.9671, -0.0873,
+          -2.9671)
+      .finished();
+}
+
+/* ************************************************************************* */
+Vector7 PandaIKFastResolver::DefaultUpperLimits() {
+  return (Vector7() << 2.9671, 1.8326, 2.9671, -0.4, 2.9671, 3.8223, 2.9671)
+      .finished();
+}
+
+/* ************************************************************************* */
+PandaIKFastResolver::PandaIKFastResolver(size_t num_samples,
+                                         const Vector7 &lower,
+                                         const Vector7 &upper)
+    : lower_(lower), upper_(upper) {
+  if (num_samples == 0)
+    throw std::invalid_argument(
+        "PandaIKFastResolver: needs at least one sample.");
+  if ((lower_.array() > upper_.array()).any())
+    throw std::invalid_argument(
+        "PandaIKFastResolver: lower limits should not exceed upper limits.");
+  const double lo = lower_(6), hi = upper_(6);
+  if (num_samples == 1)
+    samples_ = gtsam::Vector::Constant(1, 0.5 * (lo + hi));
+  else
+    samples_ = gtsam::Vector::LinSpaced(num_samples, lo, hi);
+  theta7_.resize(num_samples + 1);
+  theta7_.head(num_samples) = samples_;
+}
+
+/* ************************************************************************* */
+size_t PandaIKFastResolver::solve(const Pose3 &bTe, const Vector7 &current,
+                                  ThreadPool *pool) {
+  const size_t n = theta7_.size();
+  theta7_(n - 1) = current(6);
+  poses_.assign(n, bTe);
+  PandaIKFast::inverse(poses_, theta7_, &solutions_, &num_solutions_, pool);
+
+  // Distances of all columns at once, infinite outside the joint limits.
+  const Eigen::Index m = solutions_.cols();
+  const auto Q = solutions_.array();
+  const auto within = ((Q >= lower_.array().replicate(1, m)) &&
+                       (Q <= upper_.array().replicate(1, m)))
+                          .colwise()
+                          .all();
+  const double inf = std::numeric_limits<double>::infinity();
+  const auto squared =
+      (solutions_.colwise() - current).colwise().squaredNorm();
+  distances_ = within.transpose().select(squared.transpose().array(), inf);
+
+  // Columns past the solutions of a query hold no solution.
+  const size_t s = PandaIKFast::kMaxSolutions;
+  for (size_t i = 0; i < n; ++i)
+    distances_.segment(i * s + num_solutions_[i], s - num_solutions_[i])
+        .setConstant(inf);
+
+  order_.clear();
+  for (Eigen::Index j = 0; j < m; ++j)
+    if (distances_(j) < inf) order_.push_back(j);
+  return order_.size();
+}
+
+/* ************************************************************************* */
+std::vector<Vector7> PandaIKFastResolver::closest(const Pose3 &bTe,
+                                                  const Vector7 &current,
+                                                  size_t k, ThreadPool *pool) {
+  const size_t count = std::min(k, solve(bTe, current, pool));
+  std::partial_sort(order_.begin(), order_.begin() + count, order_.end(),
+                    [this](Eigen::Index a, Eigen::Index b) {
+                      return distances_(a) < distances_(b);
+                    });
+  std::vector<Vector7> solutions(count);
+  for (size_t i = 0; i < count; ++i) solutions[i] = solutions_.col(order_[i]);
+  return solutions;
+}
+
+/* ************************************************************************* */
+bool PandaIKFastResolver::closest(const Pose3 &bTe, const Vector7 &current,
+                                  Vector7 *q, ThreadPool *pool) {
+  if (solve(bTe, current, pool) == 0) return false;
+  const Eigen::Index best = *std::min_element(
+      order_.begin(), order_.end(), [this](Eigen::Index a, Eigen::Index b) {
+        return distances_(a) < distances_(b);
+      });
+  *q = solutions_.col(best);
+  return true;
+}
+
+}  // namespace gtdynamics
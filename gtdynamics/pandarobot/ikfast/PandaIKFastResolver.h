@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PandaIKFastResolver.h
+ * @brief Redundancy resolution of the Panda with PandaIKFast.
+ */
+
+#pragma once
+
+#include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+namespace gtdynamics {
+
+class ThreadPool;
+
+/**
+ * PandaIKFastResolver resolves the redundancy of the Panda: of the solutions
+ * of PandaIKFast over a sweep of the free 7th joint angle, it returns those
+ * within the joint limits closest to a current configuration.
+ *
+ * The sweep is discretized once, at construction, uniformly within the
+ * limits of the 7th joint; every query also solves for the 7th joint angle of
+ * the current configuration, so small motions are tracked exactly. All
+ * solutions of a query go into one 7 x (#samples * kMaxSolutions) buffer,
+ * and the limit checks and distances are computed on all of its columns at
+ * once.
+ *
+ * The resolver reuses its buffers, so it is not thread-safe: use one per
+ * thread.
+ */
+class PandaIKFastResolver {
+ public:
+  /// Joint limits of panda.urdf.
+  static gtsam::Vector7 DefaultLowerLimits();
+  static gtsam::Vector7 DefaultUpperLimits();
+
+  /**
+   * Constructor
+   * @param num_samples  values of the 7th joint angle in the sweep, >= 1
+   * @param lower        lower joint limits, in IKFast order
+   * @param upper        upper joint limits, in IKFast order
+   */
+  explicit PandaIKFastResolver(
+      size_t num_samples = 64,
+      const gtsam::Vector7 &lower = DefaultLowerLimits(),
+      const gtsam::Vector7 &upper = DefaultUpperLimits());
+
+  /// The cached values of the 7th joint angle, without that of the query.
+  const gtsam::Vector &freeJointSamples() const { return samples_; }
+
+  /**
+   * Solutions within the joint limits closest to `current`, in squared
+   * joint-space distance, closest first.
+   * @param bTe      the desired end-effector pose wrt the base frame
+   * @param current  the current joint angles, in IKFast order
+   * @param k        number of solutions to return at most
+   * @param pool     if given, the sweep is split over its threads
+   */
+  std::vector<gtsam::Vector7> closest(const gtsam::Pose3 &bTe,
+                                      const gtsam::Vector7 &current, size_t k,
+                                      ThreadPool *pool = nullptr);
+
+  /**
+   * The solution within the joint limits closest to `current`.
+   * @return false, leaving `q` alone, if there is none
+   */
+  bool closest(const gtsam::Pose3 &bTe, const gtsam::Vector7 &current,
+               gtsam::Vector7 *q, ThreadPool *pool = nullptr);
+
+ private:
+  // Solve the sweep and rank its columns into distances_ and order_; returns
+  // the number of solutions within the limits.
+  size_t solve(const gtsam::Pose3 &bTe, const gtsam::Vector7 &current,
+               ThreadPool *pool);
+
+  gtsam::Vector7 lower_, upper_;
+  gtsam::Vector samples_, theta7_;
+  std::vector<gtsam::Pose3> poses_;
+  gtsam::Matrix solutions_;
+  std::vector<size_t> num_solutions_;
+  Eigen::ArrayXd distances_;
+  std::vector<Eigen::Index> order_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,113 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PandaIKFastSeeder.cpp
+ * @brief Seed iterative inverse kinematics with PandaIKFast solutions.
+ */
+
+#include "PandaIKFastSeeder.h"
+
+#include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtdynamics/utils/values.h>
+
+#include <limits>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector7;
+
+/* ************************************************************************* */
+PandaIKFastSeeder::PandaIKFastSeeder(
+    const gtsam::Rot3 &wRe, double theta7, const Vector7 &nominal,
+    const Pose3 &wTb, const std::string &base_link_name,
+    const std::vector<std::string> &joint_names)
+    : wRe_(wRe),
+      theta7_(theta7),
+      nominal_(nominal),
+      wTb_(wTb),
+      base_link_name_(base_link_name),
+      joint_names_(joint_names) {
+  if (joint_names_.size() != PandaIKFast::kNumJoints)
+    throw std::invalid_argument("PandaIKFastSeeder: needs 7 joint names.");
+}
+
+/* ************************************************************************* */
+Values PandaIKFastSeeder::seed(const Slice &slice, const Robot &robot,
+                               const ContactGoals &contact_goals) const {
+  if (contact_goals.size() != 1)
+    throw std::invalid_argument(
+        "PandaIKFastSeeder: expects a single contact goal.");
+  const ContactGoal &goal = contact_goals.front();
+
+  // Goal link CoM in the IKFast end-effector frame, from the rest poses.
+  const LinkSharedPtr base = robot.link(base_link_name_);
+  const Pose3 bTe0 = PandaIKFast::forward(Vector7::Zero());
+  const Pose3 eTcom =
+      bTe0.between(base->bMlink().between(goal.link()->bMcom()));
+
+  // End-effector pose that puts the contact point at the goal.
+  const Point3 e_point = eTcom.transformFrom(goal.contactInCoM());
+  const Pose3 wTe(wRe_, goal.goal_point - wRe_.rotate(e_point));
+  const std::vector<Vector7> solutions =
+      PandaIKFast::inverse(wTb_.between(wTe), theta7_);
+
+  // Closest solution within the joint limits.
+  const Vector7 *best = nullptr;
+  double best_distance = std::numeric_limits<double>::infinity();
+  for (const Vector7 &q : solutions) {
+    bool within_limits = true;
+    for (size_t j = 0; j < PandaIKFast::kNumJoints; ++j) {
+      const auto &limits =
+          robot.joint(joint_names_[j])->parameters().scalar_limits;
+      within_limits &= q(j) >= limits.value_lower_limit &&
+                       q(j) <= limits.value_upper_limit;
+    }
+    const double distance = (q - nominal_).squaredNorm();
+    if (within_limits && distance < best_distance) {
+      best = &q;
+      best_distance = distance;
+    }
+  }
+  if (!best) return Values();
+
+  // Link poses by forward kinematics from the base.
+  const size_t k = slice.k;
+  Values known;
+  for (size_t j = 0; j < PandaIKFast::kNumJoints; ++j) {
+    const int id = robot.joint(joint_names_[j])->id();
+    InsertJointAngle(&known, id, k, (*best)(j));
+    InsertJointVel(&known, id, k, 0.0);
+  }
+  for (auto &&joint : robot.joints()) {
+    if (!known.exists(internal::JointAngleKey(joint->id(), k))) {
+      InsertJointAngle(&known, joint->id(), k, 0.0);
+      InsertJointVel(&known, joint->id(), k, 0.0);
+    }
+  }
+  InsertPose(&known, base->id(), k,
+             wTb_ * base->bMlink().between(base->bMcom()));
+  InsertTwist(&known, base->id(), k, gtsam::Z_6x1);
+  const Values fk = robot.forwardKinematics(known, k, base_link_name_);
+
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int id = joint->id();
+    InsertJointAngle(&values, id, k, JointAngle(known, id, k));
+  }
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    InsertPose(&values, i, k, Pose(fk, i, k));
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,72 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  PandaIKFastSeeder.h
+ * @brief Seed iterative inverse kinematics with PandaIKFast solutions.
+ */
+
+#pragma once
+
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/geometry/Rot3.h>
+
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Inverse kinematics seeder for the Panda, using the closed-form solutions of
+ * PandaIKFast. The single contact goal fixes the position of a point on a
+ * link rigidly attached to the end effector; the end-effector orientation and
+ * the redundant 7th joint angle are parameters. Of the solutions within the
+ * joint limits, the one closest to the nominal joint angles is returned.
+ */
+class PandaIKFastSeeder : public InverseKinematicsSeeder {
+ public:
+  /**
+   * Constructor
+   * @param wRe      desired end-effector orientation in the world frame;
+   *                 the default is that of the zero configuration
+   * @param theta7   value of the 7th joint angle
+   * @param nominal  joint angles to choose the closest solution to
+   * @param wTb      pose of the base link frame in the world frame
+   * @param base_link_name  name of the base link
+   * @param joint_names     names of the 7 joints, in IKFast order
+   */
+  explicit PandaIKFastSeeder(
+      const gtsam::Rot3 &wRe = gtsam::Rot3(gtsam::Point3(1, 0, 0),
+                                           gtsam::Point3(0, -1, 0),
+                                           gtsam::Point3(0, 0, -1)),
+      double theta7 = 0.0,
+      const gtsam::Vector7 &nominal = gtsam::Vector7::Zero(),
+      const gtsam::Pose3 &wTb = gtsam::Pose3(),
+      const std::string &base_link_name = "link0",
+      const std::vector<std::string> &joint_names = {
+          "joint1", "joint2", "joint3", "joint4", "joint5", "joint6",
+          "joint7"});
+
+  /**
+   * Seed for exactly one contact goal, or empty if PandaIKFast finds no
+   * solution within the joint limits.
+   */
+  gtsam::Values seed(const Slice &slice, const Robot &robot,
+                     const ContactGoals &contact_goals) const override;
+
+ private:
+  gtsam::Rot3 wRe_;
+  double theta7_;
+  gtsam::Vector nominal_;
+  gtsam::Pose3 wTb_;
+  std::string base_link_name_;
+  std::vector<std::string> joint_names_;
+};
+
+}  // namespace gtdynamics
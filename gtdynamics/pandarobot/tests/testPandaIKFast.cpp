@@ -7,6 +7,7 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/pandarobot/ikfast/PandaIKFast.h>
+#include <gtdynamics/utils/ThreadPool.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 #include <gtsam/geometry/Pose3.h>
@@ -90,6 +91,42 @@ TEST(PandaIKFast, Inverse) {
   }
 }
 
+// Batched calls agree with single queries, in parallel too.
+TEST(PandaIKFast, Batch) {
+  std::vector<Pose3> poses;
+  const Rot3 bRe((Matrix3() << 1, 0, 0, 0, -1, 0, 0, 0, -1).finished());
+  for (double x : {0.3, 0.4, 0.5}) poses.emplace_back(bRe, Point3(x, 0.1, 0.5));
+  poses.emplace_back(bRe, Point3(5, 0, 0));  // unreachable
+  const Vector theta7 = (Vector(4) << 0.3, 0.0, -0.3, 0.0).finished();
+
+  ThreadPool pool(2);
+  Matrix solutions;
+  std::vector<size_t> num_solutions;
+  PandaIKFast::inverse(poses, theta7, &solutions, &num_solutions, &pool);
+  EXPECT_LONGS_EQUAL(poses.size(), num_solutions.size());
+  for (size_t i = 0; i < poses.size(); ++i) {
+    const std::vector<Vector7> expected =
+        PandaIKFast::inverse(poses[i], theta7(i));
+    EXPECT_LONGS_EQUAL(expected.size(), num_solutions[i]);
+    for (size_t s = 0; s < num_solutions[i]; ++s) {
+      const Vector7 actual =
+          solutions.col(i * PandaIKFast::kMaxSolutions + s);
+      EXPECT(assert_equal(expected[s], actual, 1e-12));
+    }
+  }
+  for (size_t i = 0; i < 3; ++i) EXPECT(num_solutions[i] > 0);
+  EXPECT_LONGS_EQUAL(0, num_solutions.back());
+
+  // Forward kinematics of the first solutions returns the poses.
+  Matrix q(7, 3);
+  for (size_t i = 0; i < 3; ++i)
+    q.col(i) = solutions.col(i * PandaIKFast::kMaxSolutions);
+  std::vector<Pose3> fk;
+  PandaIKFast::forward(q, &fk, &pool);
+  EXPECT_LONGS_EQUAL(3, fk.size());
+  for (size_t i = 0; i < 3; ++i) EXPECT(assert_equal(poses[i], fk[i], 1e-5));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
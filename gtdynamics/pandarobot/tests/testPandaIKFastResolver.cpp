@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPandaIKFastResolver.cpp
+ * @brief Test redundancy resolution of the Panda with PandaIKFast.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFastResolver.h>
+#include <gtdynamics/utils/ThreadPool.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector7;
+
+TEST(PandaIKFastResolver, Samples) {
+  const PandaIKFastResolver resolver(5);
+  const gtsam::Vector &samples = resolver.freeJointSamples();
+  EXPECT_LONGS_EQUAL(5, samples.size());
+  EXPECT_DOUBLES_EQUAL(-2.9671, samples(0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0, samples(2), 1e-12);
+  EXPECT_DOUBLES_EQUAL(2.9671, samples(4), 1e-12);
+
+  CHECK_EXCEPTION(PandaIKFastResolver(0), std::invalid_argument);
+}
+
+// The closest solution to a configuration reaching a pose is itself.
+TEST(PandaIKFastResolver, Closest) {
+  const Vector7 current =
+      (Vector7() << 0.2, 0.3, -0.1, -1.8, 0.1, 2.0, 0.5).finished();
+  const Pose3 bTe = PandaIKFast::forward(current);
+  PandaIKFastResolver resolver(16);
+
+  Vector7 q;
+  EXPECT(resolver.closest(bTe, current, &q));
+  EXPECT(assert_equal(current, q, 1e-6));
+
+  // Top-k are sorted, within the limits, and all reach the pose.
+  ThreadPool pool(2);
+  const std::vector<Vector7> solutions = resolver.closest(bTe, current, 5,
+                                                          &pool);
+  EXPECT_LONGS_EQUAL(5, solutions.size());
+  EXPECT(assert_equal(current, solutions.front(), 1e-6));
+  for (size_t i = 0; i < solutions.size(); ++i) {
+    EXPECT(assert_equal(bTe, PandaIKFast::forward(solutions[i]), 1e-5));
+    EXPECT((solutions[i].array() >=
+            PandaIKFastResolver::DefaultLowerLimits().array())
+               .all());
+    EXPECT((solutions[i].array() <=
+            PandaIKFastResolver::DefaultUpperLimits().array())
+               .all());
+    if (i > 0)
+      EXPECT((solutions[i - 1] - current).squaredNorm() <=
+             (solutions[i] - current).squaredNorm());
+  }
+
+  // Nothing for an unreachable pose.
+  const Pose3 far(bTe.rotation(), Point3(5, 0, 0));
+  EXPECT(!resolver.closest(far, current, &q));
+  EXPECT(resolver.closest(far, current, 3).empty());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,62 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPandaIKFastSeeder.cpp
+ * @brief Test seeding inverse kinematics with PandaIKFast.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtdynamics/config.h>
+#include <gtdynamics/kinematics/Kinematics.h>
+#include <gtdynamics/pandarobot/ikfast/PandaIKFastSeeder.h>
+#include <gtdynamics/universal_robot/sdf.h>
+#include <gtsam/base/TestableAssertions.h>
+
+using namespace gtdynamics;
+using gtsam::Point3;
+
+namespace example {
+const Robot robot =
+    CreateRobotFromFile(kUrdfPath + std::string("panda/panda.urdf"))
+        .fixLink("link0");
+const ContactGoals goals = {
+    {{robot.link("link7"), Point3(0, 0, 0)}, Point3(0.4, 0.1, 0.5)}};
+}  // namespace example
+
+// The seed already reaches the goal, and satisfies the joint constraints.
+TEST(PandaIKFastSeeder, Seed) {
+  using namespace example;
+  const Slice slice(2);
+  const PandaIKFastSeeder seeder;
+  const gtsam::Values seed = seeder.seed(slice, robot, goals);
+  EXPECT(!seed.empty());
+  for (const ContactGoal& goal : goals)
+    EXPECT(goal.satisfied(seed, slice.k, 1e-4));
+
+  const Kinematics kinematics;
+  for (auto&& constraint : kinematics.constraints(slice, robot))
+    EXPECT(constraint->feasible(seed));
+}
+
+// Seeded inverse kinematics reaches the goal.
+TEST(PandaIKFastSeeder, Inverse) {
+  using namespace example;
+  const Slice slice(0);
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  const Kinematics kinematics(parameters);
+  const gtsam::Values result =
+      kinematics.inverse(slice, robot, goals, PandaIKFastSeeder());
+  for (const ContactGoal& goal : goals)
+    EXPECT(goal.satisfied(result, slice.k, 1e-5));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchStatics.cpp
+ * @brief Static torques over large batches of configurations, in parallel.
+ */
+
+#include "gtdynamics/statics/BatchStatics.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+BatchStatics::BatchStatics(const Robot &robot,
+                           const StaticsParameters &parameters,
+                           size_t num_threads)
+    : robot_(robot), num_joints_(robot.numJoints()), pool_(num_threads) {
+  torque_limits_.setZero(num_joints_);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    if (j >= static_cast<int>(num_joints_))
+      throw std::runtime_error("BatchStatics: joint ids should be 0.." +
+                               std::to_string(num_joints_ - 1));
+    torque_limits_(j) = joint->parameters().torque_limit;
+  }
+  for (size_t w = 0; w < pool_.numThreads(); ++w)
+    engines_.emplace_back(new StaticsEngine(robot, parameters));
+  if (engines_.front()->isRecursive())
+    compiled_.reset(new CompiledRobot(robot));
+}
+
+/* ************************************************************************* */
+BatchStaticsResult BatchStatics::solve(const gtsam::Matrix &angles) {
+  return solveBatch(angles, -1, nullptr);
+}
+
+/* ************************************************************************* */
+BatchStaticsResult BatchStatics::solve(const gtsam::Matrix &angles,
+                                       int link_id,
+                                       const gtsam::Matrix &loads) {
+  if (!compiled_)
+    throw std::runtime_error(
+        "BatchStatics::solve: loads need a tree with fixed roots");
+  if (link_id < 0 || size_t(link_id) >= compiled_->numLinkSlots() ||
+      compiled_->nodeOfLink()[link_id] < 0)
+    throw std::invalid_argument("BatchStatics::solve: unknown link " +
+                                std::to_string(link_id));
+  if (loads.rows() != angles.rows() || loads.cols() != 6)
+    throw std::invalid_argument(
+        "BatchStatics::solve: loads should have one row of 6 per "
+        "configuration");
+  return solveBatch(angles, link_id, &loads);
+}
+
+/* ************************************************************************* */
+BatchStaticsResult BatchStatics::solveBatch(const gtsam::Matrix &angles,
+                                            int link_id,
+                                            const gtsam::Matrix *loads) {
+  const size_t N = angles.rows();
+  const size_t J = num_joints_;
+  if (static_cast<size_t>(angles.cols()) != J)
+    throw std::invalid_argument(
+        "BatchStatics::solve: angles should have " + std::to_string(J) +
+        " columns, one per joint id");
+
+  BatchStaticsResult result;
+  result.torques.resize(N, J);
+  result.feasible.resize(N);
+
+  std::vector<gtsam::Vector> torques(pool_.numThreads());
+  std::vector<std::vector<gtsam::Pose3>> poses(pool_.numThreads());
+  std::vector<gtsam::Matrix> jacobians(pool_.numThreads());
+  pool_.parallelFor(N, [&](size_t r, size_t worker) {
+    StaticsEngine &engine = *engines_[worker];
+    gtsam::Vector &tau = torques[worker];
+    const gtsam::Vector q = angles.row(r).transpose();
+    if (engine.isRecursive()) {
+      engine.gravityTorques(q, &tau);
+    } else {
+      gtsam::Values known;
+      for (size_t j = 0; j < J; ++j) InsertJointAngle(&known, j, q(j));
+      const gtsam::Values solution =
+          engine.solve(robot_.forwardKinematics(known));
+      tau.resize(J);
+      for (size_t j = 0; j < J; ++j) tau(j) = Torque(solution, j);
+    }
+    if (loads) {
+      gtsam::Matrix &Jb = jacobians[worker];
+      compiled_->forwardKinematics(q, &poses[worker]);
+      compiled_->bodyJacobian(poses[worker], link_id, &Jb);
+      tau.head(J) -= Jb.leftCols(J).transpose() * loads->row(r).transpose();
+    }
+    result.torques.row(r) = tau.head(J).transpose();
+    result.feasible(r) =
+        (tau.head(J).cwiseAbs().array() <= torque_limits_.array()).all();
+  });
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchStatics.h
+ * @brief Static torques over large batches of configurations, in parallel.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+
+#include <memory>
+#include <vector>
+
+#include "gtdynamics/statics/StaticsEngine.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * Static torques of a batch of configurations, one row per configuration and
+ * one column per joint id, and whether each configuration is torque-feasible:
+ * |tau_j| <= torque_limit of joint j, for all joints.
+ */
+struct BatchStaticsResult {
+  gtsam::Matrix torques;
+  Eigen::Array<bool, Eigen::Dynamic, 1> feasible;
+
+  /// Number of torque-feasible configurations.
+  size_t numFeasible() const { return feasible.count(); }
+};
+
+/**
+ * BatchStatics solves statics for many configurations of the same robot, as
+ * in a workspace analysis over a grid of joint angles. Every thread has its
+ * own StaticsEngine, so the recursive pass (trees with fixed roots) or the
+ * graph of Statics::graph and its ordering are set up once per thread and
+ * reused across the configurations that thread solves.
+ *
+ * An instance holds the engines of its threads, so calls should not overlap.
+ */
+class BatchStatics {
+ private:
+  Robot robot_;
+  size_t num_joints_;
+  gtsam::Vector torque_limits_;
+  std::vector<std::unique_ptr<StaticsEngine>> engines_;  // per thread
+  std::unique_ptr<CompiledRobot> compiled_;  // for loads, on recursive engines
+  ThreadPool pool_;
+
+  // Solve, with the torques resisting the loads on link_id if given.
+  BatchStaticsResult solveBatch(const gtsam::Matrix &angles, int link_id,
+                                const gtsam::Matrix *loads);
+
+ public:
+  /**
+   * Constructor
+   *
+   * @param robot        robot, with joint ids 0..n-1
+   * @param parameters   statics parameters, gravity in particular
+   * @param num_threads  number of threads, 0 for hardware concurrency
+   */
+  BatchStatics(const Robot &robot,
+               const StaticsParameters &parameters = StaticsParameters(),
+               size_t num_threads = 0);
+
+  /// Number of threads used for the solves.
+  size_t numThreads() const { return pool_.numThreads(); }
+
+  /// Torque limits, indexed by joint id.
+  const gtsam::Vector &torqueLimits() const { return torque_limits_; }
+
+  /**
+   * Solve statics for a batch of configurations.
+   * @param angles one row of joint angles per configuration, where column j
+   * holds the angle of the joint with id j. Robots that are not trees with
+   * fixed roots need a fixed link, for forward kinematics.
+   */
+  BatchStaticsResult solve(const gtsam::Matrix &angles);
+
+  /**
+   * Solve statics for a batch of configurations holding external loads,
+   * e.g. a payload swept over the workspace: the torques are those of
+   * `solve` minus J_b^T F for the body Jacobian J_b of the link and its load
+   * F. Only for trees with fixed roots.
+   * @param angles   as in solve
+   * @param link_id  id of the link carrying the loads
+   * @param loads    one row per configuration, the wrench on the link in its
+   *                 CoM frame, moment first, as the wrenches of Values
+   * @throws std::invalid_argument for unknown links or loads of the wrong
+   * size, std::runtime_error for robots with floating roots or loops
+   */
+  BatchStaticsResult solve(const gtsam::Matrix &angles, int link_id,
+                           const gtsam::Matrix &loads);
+};
+
+}  // namespace gtdynamics
@@ -20,10 +20,13 @@
 #include <gtsam/nonlinear/Values.h>
 
 #include <boost/optional.hpp>
+#include <array>
 #include <boost/serialization/base_object.hpp>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
+#include "gtdynamics/statics/Statics.h"
 #include "gtdynamics/utils/DynamicsSymbol.h"
 #include "gtdynamics/utils/utils.h"
 
@@ -88,4 +91,84 @@ class StaticWrenchFactor : public gtsam::NoiseModelFactor {
   }
 };
 
+/**
+ * FixedStaticWrenchFactor is the StaticWrenchFactor of a link with exactly N
+ * incident wrenches, for which the error and its Jacobians are computed with
+ * fixed-size matrices only.
+ */
+template <size_t N>
+class FixedStaticWrenchFactor : public gtsam::NoiseModelFactor {
+  using This = FixedStaticWrenchFactor<N>;
+  using Base = gtsam::NoiseModelFactor;
+  double mass_;
+  boost::optional<gtsam::Vector3> gravity_;
+
+ public:
+  /**
+   * Static wrench balance factor.
+   * @param wrench_keys Keys for unknown external wrenches, N of them.
+   * @param pose_key Key for link CoM pose.
+   * @param cost_model Cost model to regulate constraint.
+   * @param mass Mass for this link.
+   * @param gravity (optional) Gravity vector in world frame.
+   */
+  FixedStaticWrenchFactor(
+      const std::vector<DynamicsSymbol> &wrench_keys, gtsam::Key pose_key,
+      const gtsam::noiseModel::Base::shared_ptr &cost_model, double mass,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none)
+      : Base(cost_model, wrench_keys), mass_(mass), gravity_(gravity) {
+    if (wrench_keys.size() != N)
+      throw std::invalid_argument(
+          "FixedStaticWrenchFactor: expected " + std::to_string(N) +
+          " wrench keys, got " + std::to_string(wrench_keys.size()));
+    keys_.push_back(pose_key);
+  }
+
+  /**
+   * Evaluate ResultantWrench, which should be zero and is factor error.
+   * @param values contains the pose and wrenches acting on the link.
+   * @param H Jacobians, in the order: *wrenches, pose
+   */
+  gtsam::Vector unwhitenedError(const gtsam::Values &x,
+                                boost::optional<std::vector<gtsam::Matrix> &>
+                                    H = boost::none) const override {
+    if (!this->active(x)) return gtsam::Vector::Zero(this->dim());
+    std::array<gtsam::Vector6, N> wrenches;
+    for (size_t k = 0; k < N; ++k) wrenches[k] = x.at<gtsam::Vector6>(keys_[k]);
+    gtsam::Matrix6 H_pose;
+    const gtsam::Vector6 error =
+        ResultantWrench<N>(wrenches, mass_, x.at<gtsam::Pose3>(keys_[N]),
+                           gravity_, H ? &H_pose : nullptr);
+    if (H) {
+      for (size_t k = 0; k < N; ++k) (*H)[k] = gtsam::I_6x6;
+      (*H)[N] = H_pose;
+    }
+    return error;
+  }
+
+  /// @return a deep copy of this factor
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::static_pointer_cast<gtsam::NonlinearFactor>(
+        gtsam::NonlinearFactor::shared_ptr(new This(*this)));
+  }
+
+  /// print contents
+  void print(const std::string &s = "",
+             const gtsam::KeyFormatter &keyFormatter =
+                 gtsam::DefaultKeyFormatter) const override {
+    std::cout << s << "static wrench factor of " << N << " wrenches"
+              << std::endl;
+    Base::print("", keyFormatter);
+  }
+
+ private:
+  /// Serialization function
+  friend class boost::serialization::access;
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int version) {  // NOLINT
+    ar &boost::serialization::make_nvp(
+        "NoiseModelFactor", boost::serialization::base_object<Base>(*this));
+  }
+};
+
 }  // namespace gtdynamics
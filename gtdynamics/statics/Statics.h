@@ -17,7 +17,10 @@
 #include <gtsam/base/Vector.h>
 #include <gtsam/geometry/Pose3.h>
 
+#include <array>
+
 #include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/utils/NoiseModels.h"
 #include "gtdynamics/utils/Slice.h"
 
 namespace gtdynamics {
@@ -57,6 +60,31 @@ gtsam::Vector6 ResultantWrench(const std::vector<gtsam::Vector6>& wrenches,
                                boost::optional<gtsam::Vector3> gravity,
                                boost::optional<std::vector<gtsam::Matrix>&> H);
 
+/**
+ * @fn Calculate sum of a fixed number of external wrenches and the gravity
+ * wrench on a body, without allocating. The Jacobians with respect to the
+ * wrenches are all identity.
+ * @param wrenches external wrenches
+ * @param mass mass of the body
+ * @param wTcom pose of body center of mass frame
+ * @param gravity optional gravity vector
+ * @param H_wTcom optional 6x6 Jacobian of the sum wrt COM pose
+ */
+template <size_t N>
+gtsam::Vector6 ResultantWrench(
+    const std::array<gtsam::Vector6, N>& wrenches, double mass,
+    const gtsam::Pose3& wTcom, const boost::optional<gtsam::Vector3>& gravity,
+    gtsam::OptionalJacobian<6, 6> H_wTcom = boost::none) {
+  gtsam::Vector6 sum = gtsam::Z_6x1;
+  for (const gtsam::Vector6& wrench : wrenches) sum += wrench;
+  if (gravity) {
+    sum += GravityWrench(*gravity, mass, wTcom, H_wTcom);
+  } else if (H_wTcom) {
+    H_wTcom->setZero();
+  }
+  return sum;
+}
+
 /// Noise models etc specific to Statics class
 struct StaticsParameters : public KinematicsParameters {
   boost::optional<gtsam::Vector3> gravity, planar_axis;
@@ -74,9 +102,11 @@ struct StaticsParameters : public KinematicsParameters {
       const boost::optional<gtsam::Vector3>& planar_axis = boost::none)
       : gravity(gravity),
         planar_axis(planar_axis),
-        fs_cost_model(Isotropic::Sigma(6, 1e-4)),
-        f_cost_model(gtsam::noiseModel::Isotropic::Sigma(6, sigma_dynamics)),
-        t_cost_model(gtsam::noiseModel::Isotropic::Sigma(1, sigma_dynamics)) {}
+        fs_cost_model(IsotropicSigma(6, 1e-4)),
+        f_cost_model(IsotropicSigma(6, sigma_dynamics)),
+        t_cost_model(IsotropicSigma(1, sigma_dynamics)) {
+    linear_solver = RecommendedLinearSolver(ProblemClass::STATICS);
+  }
 };
 
 /// Algorithms for Statics, i.e. kinematics + wrenches at rest
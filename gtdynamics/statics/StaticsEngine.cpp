@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticsEngine.cpp
+ * @brief Repeated statics queries for one robot, e.g. gravity compensation.
+ */
+
+#include "gtdynamics/statics/StaticsEngine.h"
+
+#include <gtsam/inference/Ordering.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearEquality.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/utils/values.h"
+
+namespace gtdynamics {
+
+using gtsam::Pose3;
+using gtsam::Values;
+
+/* ************************************************************************* */
+StaticsEngine::StaticsEngine(const Robot &robot,
+                             const StaticsParameters &parameters, size_t k)
+    : robot_(robot),
+      statics_(parameters),
+      k_(k),
+      graph_(statics_.graph(Slice(k), robot)),
+      lm_parameters_(parameters.lm_parameters) {
+  // Closed loops throw in CompiledRobot; those robots use the graph only.
+  try {
+    recursive_.reset(new RecursiveDynamics(robot, parameters.gravity));
+  } catch (const std::runtime_error &) {
+    recursive_.reset();
+  }
+  if (recursive_ && recursive_->compiledRobot().hasFloatingRoot())
+    recursive_.reset();
+
+  if (recursive_) {
+    recursive_->allocate(&result_);
+    q_.setZero(result_.torques.size());
+    zeros_.setZero(result_.torques.size());
+  }
+}
+
+/* ************************************************************************* */
+void StaticsEngine::gravityTorques(const gtsam::Vector &q,
+                                   gtsam::Vector *torques) {
+  if (!recursive_) {
+    throw std::runtime_error(
+        "StaticsEngine::gravityTorques: robot is not a tree with fixed roots");
+  }
+  recursive_->inverseDynamics(q, zeros_, zeros_, &result_);
+  *torques = result_.torques;
+}
+
+/* ************************************************************************* */
+Values StaticsEngine::solve(const Values &configuration) {
+  Values result;
+  if (recursive_) {
+    for (auto &&joint : robot_.joints())
+      q_(joint->id()) = JointAngle(configuration, joint->id(), k_);
+    recursive_->inverseDynamics(q_, zeros_, zeros_, &result_);
+
+    for (auto &&link : robot_.links()) {
+      const auto key = internal::PoseKey(link->id(), k_);
+      result.insert(key, configuration.at<Pose3>(key));
+    }
+    for (auto &&joint : robot_.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&result, j, k_, q_(j));
+      InsertWrench(&result, joint->parent()->id(), j, k_,
+                   gtsam::Vector6(result_.parent_wrenches.col(j)));
+      InsertWrench(&result, joint->child()->id(), j, k_,
+                   gtsam::Vector6(result_.child_wrenches.col(j)));
+      InsertTorque(&result, j, k_, result_.torques(j));
+    }
+    return result;
+  }
+
+  // Fix the configuration, as in Statics::solve, on a copy of the factor
+  // pointers of the cached graph.
+  gtsam::NonlinearFactorGraph graph = graph_;
+  Values initial_values = previous_.empty()
+                              ? statics_.initialValues(Slice(k_), robot_)
+                              : previous_;
+  for (auto &&link : robot_.links()) {
+    const auto key = internal::PoseKey(link->id(), k_);
+    const Pose3 pose = configuration.at<Pose3>(key);
+    graph.emplace_shared<gtsam::NonlinearEquality1<Pose3>>(pose, key);
+    initial_values.insert(key, pose);
+  }
+  for (auto &&joint : robot_.joints()) {
+    const auto key = internal::JointAngleKey(joint->id(), k_);
+    const double q = configuration.at<double>(key);
+    graph.emplace_shared<gtsam::NonlinearEquality1<double>>(q, key);
+    initial_values.insert(key, q);
+  }
+
+  // The graph structure does not change between queries, nor its ordering.
+  if (!lm_parameters_.ordering)
+    lm_parameters_.setOrdering(gtsam::Ordering::Colamd(graph));
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, initial_values,
+                                               lm_parameters_);
+  result = optimizer.optimize();
+
+  previous_.clear();
+  for (auto &&joint : robot_.joints()) {
+    const int j = joint->id();
+    for (auto &&link : {joint->parent(), joint->child()}) {
+      const auto key = internal::WrenchKey(link->id(), j, k_);
+      previous_.insert(key, result.at(key));
+    }
+    const auto key = internal::TorqueKey(j, k_);
+    previous_.insert(key, result.at(key));
+  }
+  return result;
+}
+
+}  // namespace gtdynamics
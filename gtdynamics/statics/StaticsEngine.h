@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  StaticsEngine.h
+ * @brief Repeated statics queries for one robot, e.g. gravity compensation.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/LevenbergMarquardtParams.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <memory>
+
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/statics/Statics.h"
+
+namespace gtdynamics {
+
+/**
+ * StaticsEngine answers many statics queries for the same robot at nearby
+ * configurations, as a gravity compensation controller does.
+ *
+ * If the robot is a tree whose roots are all fixed, the static torques are
+ * computed by a recursive inward pass over link weights (RecursiveDynamics
+ * with zero velocities and accelerations) into preallocated buffers, without
+ * building a graph or allocating. Otherwise, `solve` falls back to the graph
+ * of Statics::graph, built once along with its elimination ordering, and
+ * started from the wrenches and torques of the previous query.
+ *
+ * The engine holds scratch space and the previous solution, so a single
+ * instance should not be shared between threads.
+ */
+class StaticsEngine {
+ public:
+  /**
+   * Constructor
+   * @param robot       the robot
+   * @param parameters  statics parameters, gravity in particular
+   * @param k           time index of the keys in queries and results
+   */
+  explicit StaticsEngine(
+      const Robot &robot,
+      const StaticsParameters &parameters = StaticsParameters(), size_t k = 0);
+
+  /// True if torques are computed by the recursive pass.
+  bool isRecursive() const { return static_cast<bool>(recursive_); }
+
+  /**
+   * Static joint torques holding the robot at joint angles `q`, by the
+   * recursive pass. Throws if the robot is not a tree with fixed roots.
+   * @param q        joint angles, indexed by joint id
+   * @param torques  output torques, indexed by joint id; resized if needed
+   */
+  void gravityTorques(const gtsam::Vector &q, gtsam::Vector *torques);
+
+  /**
+   * Same result as Statics::solve(Slice(k), robot, configuration): the
+   * configuration with the joint wrenches and torques at rest added.
+   * @param configuration  link poses and joint angles at time k
+   */
+  gtsam::Values solve(const gtsam::Values &configuration);
+
+ private:
+  Robot robot_;
+  Statics statics_;
+  size_t k_;
+
+  // Recursive pass, for trees with fixed roots only.
+  std::unique_ptr<RecursiveDynamics> recursive_;
+  RecursiveDynamicsResult result_;
+  gtsam::Vector q_, zeros_;
+
+  // Graph fallback: static factors, LM parameters with the ordering of the
+  // constrained graph once known, and the wrenches and torques last solved.
+  gtsam::NonlinearFactorGraph graph_;
+  gtsam::LevenbergMarquardtParams lm_parameters_;
+  gtsam::Values previous_;
+};
+
+}  // namespace gtdynamics
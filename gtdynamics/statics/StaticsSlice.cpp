@@ -29,6 +29,29 @@ using gtsam::Pose3;
 using std::map;
 using std::string;
 
+// Fixed-size static wrench factor for links with up to N joints, the dynamic
+// one otherwise.
+template <size_t N>
+static gtsam::NonlinearFactor::shared_ptr MakeStaticWrenchFactor(
+    const std::vector<DynamicsSymbol>& wrench_keys, gtsam::Key pose_key,
+    const gtsam::SharedNoiseModel& cost_model, double mass,
+    const boost::optional<gtsam::Vector3>& gravity) {
+  if (wrench_keys.size() == N)
+    return boost::make_shared<FixedStaticWrenchFactor<N>>(
+        wrench_keys, pose_key, cost_model, mass, gravity);
+  return MakeStaticWrenchFactor<N - 1>(wrench_keys, pose_key, cost_model, mass,
+                                       gravity);
+}
+
+template <>
+gtsam::NonlinearFactor::shared_ptr MakeStaticWrenchFactor<0>(
+    const std::vector<DynamicsSymbol>& wrench_keys, gtsam::Key pose_key,
+    const gtsam::SharedNoiseModel& cost_model, double mass,
+    const boost::optional<gtsam::Vector3>& gravity) {
+  return boost::make_shared<StaticWrenchFactor>(wrench_keys, pose_key,
+                                                cost_model, mass, gravity);
+}
+
 gtsam::NonlinearFactorGraph Statics::wrenchEquivalenceFactors(
     const Slice& slice, const Robot& robot) const {
   gtsam::NonlinearFactorGraph graph;
@@ -75,9 +98,9 @@ gtsam::NonlinearFactorGraph Statics::graph(const Slice& slice,
       wrench_keys.push_back(internal::WrenchKey(i, joint->id(), k));
 
     // Add static wrench factor for link.
-    graph.emplace_shared<StaticWrenchFactor>(
+    graph.push_back(MakeStaticWrenchFactor<8>(
         wrench_keys, internal::PoseKey(link->id(), k), p_.fs_cost_model,
-        link->mass(), p_.gravity);
+        link->mass(), p_.gravity));
   }
 
   /// Add a WrenchEquivalenceFactor for each joint.
@@ -148,7 +171,8 @@ gtsam::Values Statics::minimizeTorques(const Slice& slice,
   values.insert(initialValues(slice, robot));
 
   // TODO(frank): make IPOPT optimizer base class.
-  gtsam::LevenbergMarquardtOptimizer optimizer(graph, values, p_.lm_parameters);
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, values,
+                                               Optimizer::p_.lm_parameters);
   return optimizer.optimize();
 }
 }  // namespace gtdynamics
\ No newline at end of file
@@ -0,0 +1,197 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchForwardKinematics.cpp
+ * @brief Forward kinematics for many configurations at once.
+ */
+
+#include "gtdynamics/universal_robot/BatchForwardKinematics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+constexpr size_t BatchForwardKinematics::kLanes;
+
+/* ************************************************************************* */
+Pose3 PoseBatch::pose(size_t b, int i) const {
+  const auto row = data.row(b);
+  const int c = 12 * i;
+  return Pose3(gtsam::Rot3(row(c + 0), row(c + 1), row(c + 2), row(c + 3),
+                           row(c + 4), row(c + 5), row(c + 6), row(c + 7),
+                           row(c + 8)),
+               gtsam::Point3(row(c + 9), row(c + 10), row(c + 11)));
+}
+
+/* ************************************************************************* */
+void PoseBatch::setPose(size_t b, int i, const Pose3 &pose) {
+  const gtsam::Matrix3 R = pose.rotation().matrix();
+  const int c = 12 * i;
+  for (int r = 0; r < 3; ++r) {
+    for (int k = 0; k < 3; ++k) data(b, c + 3 * r + k) = R(r, k);
+  }
+  for (int k = 0; k < 3; ++k) data(b, c + 9 + k) = pose.translation()(k);
+}
+
+// Store R (row-major) and t of a pose.
+static void Unroll(const Pose3 &T, double *R, double *t) {
+  const gtsam::Matrix3 M = T.rotation().matrix();
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 3; ++c) R[3 * r + c] = M(r, c);
+    t[r] = T.translation()(r);
+  }
+}
+
+/* ************************************************************************* */
+BatchForwardKinematics::BatchForwardKinematics(const Robot &robot,
+                                               size_t num_threads)
+    : robot_(robot), pool_(num_threads) {
+  for (size_t n = 0; n < robot_.numNodes(); ++n) {
+    Node node{};
+    node.link = robot_.linkIds()[n];
+    const int parent = robot_.parentNodes()[n];
+    node.parent_link = parent < 0 ? -1 : robot_.linkIds()[parent];
+    node.joint = robot_.jointIds()[n];
+    node.scale = 1.0;
+    if (parent < 0) {
+      Unroll(robot_.fixedPoses()[node.link], node.R0, node.t0);
+      nodes_.push_back(node);
+      continue;
+    }
+    Unroll(robot_.restPoses()[n], node.R0, node.t0);
+
+    // Exp([S] q) with S = (w, v) and |w| = 1 is R = I + s [w] + (1 - c) [w]^2,
+    // t = q v + (1 - c) [w] v + (q - s) [w]^2 v. A general screw axis is
+    // scaled to unit rotation; a prismatic axis has [w] = 0.
+    const gtsam::Vector6 S = robot_.screwAxes().col(n);
+    gtsam::Vector3 w = S.head<3>(), v = S.tail<3>();
+    const double norm = w.norm();
+    if (norm > 1e-9) {
+      node.scale = norm;
+      w /= norm;
+      v /= norm;
+      const gtsam::Matrix3 K = gtsam::skewSymmetric(w);
+      const gtsam::Matrix3 K2 = K * K;
+      const gtsam::Vector3 a = K * v, b = K2 * v;
+      for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+          node.K[3 * r + c] = K(r, c);
+          node.K2[3 * r + c] = K2(r, c);
+        }
+        node.a[r] = a(r);
+        node.b[r] = b(r);
+      }
+    }
+    for (int r = 0; r < 3; ++r) node.v[r] = v(r);
+    nodes_.push_back(node);
+  }
+}
+
+/* ************************************************************************* */
+void BatchForwardKinematics::computeLanes(const Matrix &configurations,
+                                          size_t begin, size_t end,
+                                          Matrix *data) const {
+  const size_t n = end - begin;
+  const size_t stride = data->rows();
+  double theta[kLanes], s[kLanes], one_minus_c[kLanes];
+  double Re[9][kLanes], te[3][kLanes], Rl[9][kLanes], tl[3][kLanes];
+
+  for (const Node &node : nodes_) {
+    double *out = data->data() + 12 * node.link * stride + begin;
+    if (node.parent_link < 0) {
+      for (int k = 0; k < 9; ++k) std::fill_n(out + k * stride, n, node.R0[k]);
+      for (int k = 0; k < 3; ++k)
+        std::fill_n(out + (9 + k) * stride, n, node.t0[k]);
+      continue;
+    }
+
+    // Joint transform Exp([S] q), lane by lane.
+    const double *q = configurations.col(node.joint).data() + begin;
+    for (size_t l = 0; l < n; ++l) {
+      theta[l] = node.scale * q[l];
+      s[l] = std::sin(theta[l]);
+      one_minus_c[l] = 1.0 - std::cos(theta[l]);
+    }
+    for (int k = 0; k < 9; ++k) {
+      const double identity = (k % 4 == 0) ? 1.0 : 0.0;
+      for (size_t l = 0; l < n; ++l)
+        Re[k][l] = identity + s[l] * node.K[k] + one_minus_c[l] * node.K2[k];
+    }
+    for (int r = 0; r < 3; ++r) {
+      for (size_t l = 0; l < n; ++l)
+        te[r][l] = theta[l] * node.v[r] + one_minus_c[l] * node.a[r] +
+                   (theta[l] - s[l]) * node.b[r];
+    }
+
+    // Relative pose pTi = rest * Exp([S] q).
+    for (int r = 0; r < 3; ++r) {
+      const double *R0 = node.R0 + 3 * r;
+      for (int c = 0; c < 3; ++c) {
+        for (size_t l = 0; l < n; ++l)
+          Rl[3 * r + c][l] = R0[0] * Re[c][l] + R0[1] * Re[3 + c][l] +
+                             R0[2] * Re[6 + c][l];
+      }
+      for (size_t l = 0; l < n; ++l)
+        tl[r][l] = R0[0] * te[0][l] + R0[1] * te[1][l] + R0[2] * te[2][l] +
+                   node.t0[r];
+    }
+
+    // World pose wTi = wTp * pTi, reading the parent from the output.
+    const double *in = data->data() + 12 * node.parent_link * stride + begin;
+    const double *Rp[9], *tp[3];
+    for (int k = 0; k < 9; ++k) Rp[k] = in + k * stride;
+    for (int k = 0; k < 3; ++k) tp[k] = in + (9 + k) * stride;
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) {
+        double *R = out + (3 * r + c) * stride;
+        for (size_t l = 0; l < n; ++l)
+          R[l] = Rp[3 * r][l] * Rl[c][l] + Rp[3 * r + 1][l] * Rl[3 + c][l] +
+                 Rp[3 * r + 2][l] * Rl[6 + c][l];
+      }
+      double *t = out + (9 + r) * stride;
+      for (size_t l = 0; l < n; ++l)
+        t[l] = Rp[3 * r][l] * tl[0][l] + Rp[3 * r + 1][l] * tl[1][l] +
+               Rp[3 * r + 2][l] * tl[2][l] + tp[r][l];
+    }
+  }
+}
+
+/* ************************************************************************* */
+void BatchForwardKinematics::compute(const Matrix &configurations,
+                                     PoseBatch *poses) {
+  if (size_t(configurations.cols()) != robot_.numJointSlots()) {
+    throw std::invalid_argument(
+        "BatchForwardKinematics: configurations need one column per joint "
+        "id.");
+  }
+  const size_t B = configurations.rows();
+  const size_t cols = 12 * robot_.numLinkSlots();
+  if (size_t(poses->data.rows()) != B || size_t(poses->data.cols()) != cols)
+    poses->data.setZero(B, cols);
+
+  const size_t num_blocks = (B + kLanes - 1) / kLanes;
+  pool_.parallelFor(num_blocks, [&](size_t block, size_t /*worker*/) {
+    const size_t begin = block * kLanes;
+    computeLanes(configurations, begin, std::min(B, begin + kLanes),
+                 &poses->data);
+  });
+}
+
+/* ************************************************************************* */
+PoseBatch BatchForwardKinematics::compute(const Matrix &configurations) {
+  PoseBatch poses;
+  compute(configurations, &poses);
+  return poses;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  BatchForwardKinematics.h
+ * @brief Forward kinematics for many configurations at once.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/**
+ * Link poses for a batch of configurations, in structure-of-arrays layout:
+ * every pose component of every link is a contiguous column over the batch.
+ * Link i uses columns 12 i to 12 i + 11, holding the rotation matrix in
+ * row-major order followed by the translation.
+ */
+struct PoseBatch {
+  gtsam::Matrix data;  ///< #configurations x 12 #link slots
+
+  /// Number of configurations.
+  size_t size() const { return data.rows(); }
+
+  /// Entry (r, c) of the rotation of link i, for all configurations.
+  gtsam::Matrix::ConstColXpr rotation(int i, int r, int c) const {
+    return data.col(12 * i + 3 * r + c);
+  }
+
+  /// Entry k of the translation of link i, for all configurations.
+  gtsam::Matrix::ConstColXpr translation(int i, int k) const {
+    return data.col(12 * i + 9 + k);
+  }
+
+  /// Pose of link i in configuration b.
+  gtsam::Pose3 pose(size_t b, int i) const;
+
+  /// Set the pose of link i in configuration b.
+  void setPose(size_t b, int i, const gtsam::Pose3 &pose);
+};
+
+/**
+ * BatchForwardKinematics computes CoM poses for many joint configurations of
+ * the same robot. Configurations are processed in lanes of kLanes at a time:
+ * each joint transform is evaluated with closed-form exponential coordinates
+ * on contiguous arrays, so the inner loops vectorize. Lanes are spread over a
+ * thread pool.
+ *
+ * The traversal is that of CompiledRobot. Fixed roots are at their fixed pose
+ * and floating roots are at the identity.
+ */
+class BatchForwardKinematics {
+ public:
+  /// Number of configurations processed together.
+  static constexpr size_t kLanes = 64;
+
+  /**
+   * Constructor
+   * @param robot        the robot, needs to have a tree structure
+   * @param num_threads  number of threads, 0 for hardware concurrency
+   */
+  explicit BatchForwardKinematics(const Robot &robot, size_t num_threads = 1);
+
+  /// Number of threads used.
+  size_t numThreads() const { return pool_.numThreads(); }
+
+  /**
+   * Compute link poses for a batch of configurations.
+   * @param[in] configurations #configurations x #joint slots, one joint
+   * configuration per row, column j holding the angle of the joint with id j.
+   * @param[out] poses resized if needed, reuse it to avoid allocations.
+   */
+  void compute(const gtsam::Matrix &configurations, PoseBatch *poses);
+
+  /// Compute link poses for a batch of configurations.
+  PoseBatch compute(const gtsam::Matrix &configurations);
+
+ private:
+  /// Constants of a node in the traversal, unrolled for the lane loops.
+  struct Node {
+    int link, parent_link, joint;  // parent_link and joint are -1 for roots
+    double scale;                  // |w| of the screw axis, 1 for prismatic
+    double v[3];                   // translational part, divided by scale
+    double a[3], b[3];             // w x v and w x (w x v), w of unit norm
+    double K[9], K2[9];            // [w] and [w]^2, row-major
+    double R0[9], t0[3];           // rest pose, or root pose for roots
+  };
+
+  /// Compute configurations [begin, end).
+  void computeLanes(const gtsam::Matrix &configurations, size_t begin,
+                    size_t end, gtsam::Matrix *data) const;
+
+  CompiledRobot robot_;
+  std::vector<Node> nodes_;
+  ThreadPool pool_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionSphereModel.cpp
+ * @brief Collision spheres of all links of a robot, in flat arrays.
+ */
+
+#include "gtdynamics/universal_robot/CollisionSphereModel.h"
+
+#include <stdexcept>
+
+#include "gtdynamics/utils/utils.h"
+
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CollisionSphereModel::CollisionSphereModel(
+    const Robot &robot,
+    const std::map<std::string, CollisionSpheres> &link_spheres)
+    : compiled_(std::make_shared<const CompiledRobot>(robot)) {
+  const size_t num_links = compiled_->numLinkSlots();
+  std::vector<const CollisionSpheres *> by_link(num_links, nullptr);
+  size_t num_spheres = 0;
+  for (auto &&entry : link_spheres) {
+    if (entry.second.empty()) continue;
+    const int i = robot.link(entry.first)->id();
+    by_link[i] = &entry.second;
+    num_spheres += entry.second.size();
+  }
+
+  centers_.resize(3, num_spheres);
+  radii_.resize(num_spheres);
+  links_.reserve(num_spheres);
+  offsets_.assign(num_links + 1, 0);
+  size_t s = 0;
+  for (size_t i = 0; i < num_links; i++) {
+    offsets_[i] = s;
+    if (!by_link[i]) continue;
+    link_ids_.push_back(i);
+    for (const CollisionSphere &sphere : *by_link[i]) {
+      centers_.col(s) = sphere.center;
+      radii_(s) = sphere.radius;
+      links_.push_back(i);
+      s++;
+    }
+  }
+  offsets_[num_links] = s;
+}
+
+/* ************************************************************************* */
+CollisionSphereModel CollisionSphereModel::FromMeshes(
+    const Robot &robot, const std::map<std::string, std::string> &link_meshes,
+    size_t max_spheres) {
+  std::map<std::string, CollisionSpheres> link_spheres;
+  for (auto &&entry : link_meshes) {
+    const LinkSharedPtr link = robot.link(entry.first);
+    const Pose3 comTmesh = link->bMcom().inverse() * link->bMlink();
+    link_spheres[entry.first] = TransformSpheres(
+        comTmesh, BoundingSpheres(ReadMeshVertices(entry.second), max_spheres));
+  }
+  return CollisionSphereModel(robot, link_spheres);
+}
+
+/* ************************************************************************* */
+CollisionSphereModel CollisionSphereModel::FromLinkLengths(
+    const Robot &robot, const std::vector<std::string> &link_names,
+    const std::vector<double> &lengths, const std::vector<double> &radii) {
+  if (link_names.size() != lengths.size() || lengths.size() != radii.size())
+    throw std::invalid_argument(
+        "CollisionSphereModel: need one length and radius per link.");
+  const std::vector<std::vector<Point3>> centers =
+      sphereCenters(lengths, radii);
+  std::map<std::string, CollisionSpheres> link_spheres;
+  for (size_t j = 0; j < link_names.size(); j++) {
+    CollisionSpheres &spheres = link_spheres[link_names[j]];
+    for (const Point3 &center : centers[j])
+      spheres.push_back({center, radii[j]});
+  }
+  return CollisionSphereModel(robot, link_spheres);
+}
+
+/* ************************************************************************* */
+CollisionSpheres CollisionSphereModel::spheres(int link_id) const {
+  CollisionSpheres spheres;
+  if (link_id < 0 || static_cast<size_t>(link_id) + 1 >= offsets_.size())
+    return spheres;
+  for (size_t s = begin(link_id); s < end(link_id); s++)
+    spheres.push_back({centers_.col(s), radii_(s)});
+  return spheres;
+}
+
+/* ************************************************************************* */
+void CollisionSphereModel::worldCenters(const std::vector<Pose3> &poses,
+                                        gtsam::Matrix *centers) const {
+  if (centers->rows() != 3 || centers->cols() != centers_.cols())
+    centers->resize(3, centers_.cols());
+  for (const int i : link_ids_) {
+    const size_t first = begin(i), n = numSpheres(i);
+    const gtsam::Matrix3 R = poses[i].rotation().matrix();
+    centers->middleCols(first, n).noalias() = R * centers_.middleCols(first, n);
+    centers->middleCols(first, n).colwise() += poses[i].translation();
+  }
+}
+
+/* ************************************************************************* */
+void CollisionSphereModel::worldCenters(const gtsam::Vector &q,
+                                        std::vector<Pose3> *poses,
+                                        gtsam::Matrix *centers) const {
+  compiled_->forwardKinematics(q, poses);
+  worldCenters(*poses, centers);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CollisionSphereModel.h
+ * @brief Collision spheres of all links of a robot, in flat arrays.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/SignedDistanceField.h"
+
+namespace gtdynamics {
+
+/**
+ * CollisionSphereModel holds the collision spheres of a robot, built once per
+ * robot: the centers of all spheres, in the COM frames of their links, are
+ * the columns of one 3 x #spheres matrix, with the radii and the link id of
+ * every sphere alongside. The spheres of a link are contiguous, in
+ * [begin(i), end(i)), so worldCenters transforms each link's block with one
+ * matrix product, after the forward kinematics of the CompiledRobot. Copies
+ * share the compiled robot.
+ */
+class CollisionSphereModel {
+ public:
+  /**
+   * Construct from the collision spheres of each link.
+   * @param robot         the robot, with a tree structure
+   * @param link_spheres  collision spheres by link name, in the link's COM
+   *                      frame
+   */
+  CollisionSphereModel(
+      const Robot &robot,
+      const std::map<std::string, CollisionSpheres> &link_spheres);
+
+  /**
+   * Spheres covering link meshes, e.g. those in models/sdfs/meshes, with
+   * BoundingSpheres.
+   * @param robot        the robot, with a tree structure
+   * @param link_meshes  mesh file by link name, in the link frame
+   * @param max_spheres  at most this many spheres per link
+   */
+  static CollisionSphereModel FromMeshes(
+      const Robot &robot, const std::map<std::string, std::string> &link_meshes,
+      size_t max_spheres);
+
+  /**
+   * Spheres along the x-axis of links of the given lengths, through their
+   * COMs, as placed by sphereCenters.
+   * @param robot       the robot, with a tree structure
+   * @param link_names  names of the links
+   * @param lengths     length of each link
+   * @param radii       radius of the spheres of each link
+   */
+  static CollisionSphereModel FromLinkLengths(
+      const Robot &robot, const std::vector<std::string> &link_names,
+      const std::vector<double> &lengths, const std::vector<double> &radii);
+
+  /// The compiled robot worldCenters runs forward kinematics on.
+  const CompiledRobot &compiledRobot() const { return *compiled_; }
+
+  /// Number of spheres of all links.
+  size_t numSpheres() const { return radii_.size(); }
+
+  /// Number of spheres of a link.
+  size_t numSpheres(int link_id) const { return end(link_id) - begin(link_id); }
+
+  /// Index of the first sphere of a link.
+  size_t begin(int link_id) const { return offsets_[link_id]; }
+
+  /// Index past the last sphere of a link.
+  size_t end(int link_id) const { return offsets_[link_id + 1]; }
+
+  /// Sphere centers, 3 x #spheres, in the COM frames of their links.
+  const gtsam::Matrix &centers() const { return centers_; }
+
+  /// Sphere radii.
+  const gtsam::Vector &radii() const { return radii_; }
+
+  /// Link id of every sphere.
+  const std::vector<int> &links() const { return links_; }
+
+  /// Ids of the links with spheres, in increasing order.
+  const std::vector<int> &linkIds() const { return link_ids_; }
+
+  /// The spheres of a link, copied, empty for links without any.
+  CollisionSpheres spheres(int link_id) const;
+
+  /**
+   * World sphere centers, 3 x #spheres, in one pass over the links.
+   * @param poses    link COM poses, indexed by link id
+   * @param centers  resized if needed
+   */
+  void worldCenters(const std::vector<gtsam::Pose3> &poses,
+                    gtsam::Matrix *centers) const;
+
+  /**
+   * World sphere centers at a configuration, with the forward kinematics of
+   * compiledRobot(); floating roots keep the poses already in `poses`.
+   * @param q        joint angles, indexed by joint id
+   * @param poses    link poses wTi, indexed by link id
+   * @param centers  resized if needed
+   */
+  void worldCenters(const gtsam::Vector &q, std::vector<gtsam::Pose3> *poses,
+                    gtsam::Matrix *centers) const;
+
+ private:
+  std::shared_ptr<const CompiledRobot> compiled_;
+  gtsam::Matrix centers_;        // 3 x #spheres
+  gtsam::Vector radii_;          // #spheres
+  std::vector<int> links_;       // link id of each sphere
+  std::vector<size_t> offsets_;  // #link slots + 1, first sphere of a link
+  std::vector<int> link_ids_;    // links with spheres
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,252 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompiledRobot.cpp
+ * @brief Immutable, flattened view of a Robot for use in hot loops.
+ */
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+using gtsam::Pose3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+// Ad(T) xi, without forming the 6x6 adjoint matrix.
+static Vector6 AdjointTimes(const Pose3 &T, const Vector6 &xi) {
+  const gtsam::Matrix3 R = T.rotation().matrix();
+  const gtsam::Vector3 w = R * xi.head<3>();
+  Vector6 result;
+  result << w, T.translation().cross(w) + R * xi.tail<3>();
+  return result;
+}
+
+/* ************************************************************************* */
+CompiledRobot::CompiledRobot(const Robot &robot)
+    : num_link_slots_(0), num_joint_slots_(0), has_floating_root_(false) {
+  const auto links = robot.links();
+  const auto joints = robot.joints();
+  for (auto &&link : links)
+    num_link_slots_ = std::max<size_t>(num_link_slots_, link->id() + 1);
+  for (auto &&joint : joints)
+    num_joint_slots_ = std::max<size_t>(num_joint_slots_, joint->id() + 1);
+
+  // Link-id indexed constants.
+  node_of_link_.assign(num_link_slots_, -1);
+  parent_links_.assign(num_link_slots_, -1);
+  inertias_.assign(num_link_slots_, gtsam::Matrix6::Zero());
+  masses_.setZero(num_link_slots_);
+  is_fixed_.assign(num_link_slots_, false);
+  fixed_poses_.assign(num_link_slots_, Pose3());
+  for (auto &&link : links) {
+    const int i = link->id();
+    inertias_[i] = link->inertiaMatrix();
+    masses_(i) = link->mass();
+    is_fixed_[i] = link->isFixed();
+    if (link->isFixed()) fixed_poses_[i] = link->getFixedPose();
+  }
+
+  // Joint-id indexed constants.
+  joint_parent_links_.assign(num_joint_slots_, -1);
+  joint_child_links_.assign(num_joint_slots_, -1);
+  jMp_.assign(num_joint_slots_, Pose3());
+  jMc_.assign(num_joint_slots_, Pose3());
+  child_screw_axes_.setZero(6, num_joint_slots_);
+  parent_screw_axes_.setZero(6, num_joint_slots_);
+  for (auto &&joint : joints) {
+    const int j = joint->id();
+    joint_parent_links_[j] = joint->parent()->id();
+    joint_child_links_[j] = joint->child()->id();
+    jMp_[j] = joint->jMp();
+    jMc_[j] = joint->jMc();
+    child_screw_axes_.col(j) = joint->cScrewAxis();
+    parent_screw_axes_.col(j) = joint->pScrewAxis();
+  }
+
+  // Fixed links are roots, so mark them visited first: reaching one from
+  // another root means a loop is closed through the ground.
+  std::vector<bool> visited(num_link_slots_, false);
+  std::vector<LinkSharedPtr> roots;
+  for (auto &&link : links) {
+    if (link->isFixed()) {
+      visited[link->id()] = true;
+      roots.push_back(link);
+    }
+  }
+  for (auto &&link : links)
+    if (!link->isFixed()) roots.push_back(link);
+
+  // Breadth-first traversal from each root, floating roots only if they were
+  // not reached from an earlier root.
+  std::vector<JointSharedPtr> tree_joints;
+  const auto add_node = [&](const LinkSharedPtr &link,
+                            const JointSharedPtr &joint, int parent) {
+    node_of_link_[link->id()] = links_.size();
+    links_.push_back(link);
+    tree_joints.push_back(joint);
+    link_ids_.push_back(link->id());
+    parent_nodes_.push_back(parent);
+    joint_ids_.push_back(joint ? joint->id() : -1);
+    along_joint_.push_back(joint ? joint->child() == link : false);
+    if (parent >= 0) parent_links_[link->id()] = link_ids_[parent];
+  };
+  for (auto &&root : roots) {
+    if (!root->isFixed()) {
+      if (visited[root->id()]) continue;
+      visited[root->id()] = true;
+      has_floating_root_ = true;
+    }
+    add_node(root, nullptr, -1);
+    for (size_t n = links_.size() - 1; n < links_.size(); ++n) {
+      const LinkSharedPtr link = links_[n];
+      const JointSharedPtr parent_joint = tree_joints[n];
+      for (auto &&joint : link->joints()) {
+        if (joint == parent_joint) continue;
+        const LinkSharedPtr other = joint->otherLink(link);
+        if (visited[other->id()]) {
+          throw std::runtime_error(
+              "CompiledRobot: closed kinematic loop through joint " +
+              joint->name());
+        }
+        visited[other->id()] = true;
+        add_node(other, joint, n);
+      }
+    }
+  }
+
+  // Node-indexed screw axes and rest poses.
+  const size_t N = links_.size();
+  screw_axes_.setZero(6, N);
+  rest_poses_.assign(N, Pose3());
+  for (size_t n = 0; n < N; ++n) {
+    const auto &joint = tree_joints[n];
+    if (!joint) continue;
+    screw_axes_.col(n) = joint->screwAxis(links_[n]);
+    rest_poses_[n] = joint->relativePoseOf(links_[n], 0.0);
+  }
+}
+
+/* ************************************************************************* */
+void CompiledRobot::forwardKinematics(const gtsam::Vector &q,
+                                      std::vector<Pose3> *poses) const {
+  if (poses->size() != num_link_slots_) poses->assign(num_link_slots_, Pose3());
+  for (size_t n = 0; n < link_ids_.size(); ++n) {
+    const int i = link_ids_[n];
+    const int parent = parent_nodes_[n];
+    if (parent < 0) {
+      if (is_fixed_[i]) (*poses)[i] = fixed_poses_[i];
+      continue;
+    }
+    const Vector6 S = screw_axes_.col(n);
+    (*poses)[i] = (*poses)[link_ids_[parent]] * rest_poses_[n] *
+                  Pose3::Expmap(S * q(joint_ids_[n]));
+  }
+}
+
+/* ************************************************************************* */
+void CompiledRobot::forwardKinematics(const gtsam::Vector &q,
+                                      const gtsam::Vector &v,
+                                      std::vector<Pose3> *poses,
+                                      gtsam::Matrix *twists) const {
+  if (poses->size() != num_link_slots_) poses->assign(num_link_slots_, Pose3());
+  if (size_t(twists->cols()) != num_link_slots_ || twists->rows() != 6)
+    twists->setZero(6, num_link_slots_);
+  for (size_t n = 0; n < link_ids_.size(); ++n) {
+    const int i = link_ids_[n];
+    const int parent = parent_nodes_[n];
+    if (parent < 0) {
+      if (is_fixed_[i]) {
+        (*poses)[i] = fixed_poses_[i];
+        twists->col(i).setZero();
+      }
+      continue;
+    }
+    // T_wi = T_wp T_pi(q), V_i = Ad(T_ip) V_p + S_i v.
+    const int p = link_ids_[parent];
+    const int j = joint_ids_[n];
+    const Vector6 S = screw_axes_.col(n);
+    const Pose3 pTi = rest_poses_[n] * Pose3::Expmap(S * q(j));
+    (*poses)[i] = (*poses)[p] * pTi;
+    twists->col(i) = AdjointTimes(pTi.inverse(), twists->col(p)) + S * v(j);
+  }
+}
+
+/* ************************************************************************* */
+int CompiledRobot::checkedNode(int link_id) const {
+  if (link_id < 0 || size_t(link_id) >= num_link_slots_ ||
+      node_of_link_[link_id] < 0)
+    throw std::invalid_argument("CompiledRobot: no link with id " +
+                                std::to_string(link_id));
+  return node_of_link_[link_id];
+}
+
+/* ************************************************************************* */
+void CompiledRobot::bodyJacobian(const std::vector<Pose3> &poses, int link_id,
+                                 gtsam::Matrix *J) const {
+  const int node = checkedNode(link_id);
+  J->setZero(6, num_joint_slots_);
+  const Pose3 iTw = poses[link_id].inverse();
+  for (int n = node; parent_nodes_[n] >= 0; n = parent_nodes_[n])
+    J->col(joint_ids_[n]) =
+        AdjointTimes(iTw * poses[link_ids_[n]], screw_axes_.col(n));
+}
+
+/* ************************************************************************* */
+void CompiledRobot::spatialJacobian(const std::vector<Pose3> &poses,
+                                    int link_id, gtsam::Matrix *J) const {
+  const int node = checkedNode(link_id);
+  J->setZero(6, num_joint_slots_);
+  for (int n = node; parent_nodes_[n] >= 0; n = parent_nodes_[n])
+    J->col(joint_ids_[n]) =
+        AdjointTimes(poses[link_ids_[n]], screw_axes_.col(n));
+}
+
+/* ************************************************************************* */
+void CompiledRobot::bodyJacobians(const std::vector<Pose3> &poses,
+                                  const std::vector<int> &link_ids,
+                                  std::vector<gtsam::Matrix> *Js) const {
+  Js->resize(link_ids.size());
+  for (size_t k = 0; k < link_ids.size(); ++k)
+    bodyJacobian(poses, link_ids[k], &(*Js)[k]);
+}
+
+/* ************************************************************************* */
+void CompiledRobot::spatialJacobians(const std::vector<Pose3> &poses,
+                                     const std::vector<int> &link_ids,
+                                     std::vector<gtsam::Matrix> *Js) const {
+  Js->resize(link_ids.size());
+  for (size_t k = 0; k < link_ids.size(); ++k)
+    spatialJacobian(poses, link_ids[k], &(*Js)[k]);
+}
+
+/* ************************************************************************* */
+void CompiledRobot::biasAccelerations(const gtsam::Vector &q,
+                                      const gtsam::Vector &v,
+                                      std::vector<Pose3> *poses,
+                                      gtsam::Matrix *twists,
+                                      gtsam::Matrix *accels) const {
+  forwardKinematics(q, v, poses, twists);
+  accels->setZero(6, num_link_slots_);
+  for (size_t n = 0; n < link_ids_.size(); ++n) {
+    const int parent = parent_nodes_[n];
+    if (parent < 0) continue;
+    const int i = link_ids_[n];
+    const int p = link_ids_[parent];
+    const Vector6 V_i = twists->col(i);
+    const Pose3 iTp = (*poses)[i].between((*poses)[p]);
+    accels->col(i) = AdjointTimes(iTp, accels->col(p)) +
+                     Pose3::adjointMap(V_i) * screw_axes_.col(n) *
+                         v(joint_ids_[n]);
+  }
+}
+
+}  // namespace gtdynamics
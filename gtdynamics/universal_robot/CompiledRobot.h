@@ -0,0 +1,259 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompiledRobot.h
+ * @brief Immutable, flattened view of a Robot for use in hot loops.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * CompiledRobot flattens the topology and the constant parameters of a Robot
+ * into contiguous arrays, so kinematics and dynamics kernels can loop over
+ * them without map lookups, shared pointers, or building vectors per call.
+ *
+ * Two kinds of arrays are provided:
+ *  - id-indexed arrays, with one slot per link id or joint id, mirroring the
+ *    keys used in the factor graphs. Slots of ids that are not used by the
+ *    robot hold -1 or zeros.
+ *  - node-indexed arrays, in a precomputed breadth-first traversal order of a
+ *    spanning tree: parents always come before their children.
+ *
+ * The spanning tree has the fixed links as roots, and every remaining
+ * connected component rooted at its first link (a floating base). Joints may
+ * point "against" the tree, in which case the parent-side screw axis is used.
+ * Closed kinematic loops are not supported and throw at construction.
+ *
+ * The relative pose of node n with respect to its tree parent is
+ * restPoses()[n] * Expmap(screwAxes().col(n) * q), with q the joint angle.
+ */
+class CompiledRobot {
+ public:
+  using Matrix6s =
+      std::vector<gtsam::Matrix6, Eigen::aligned_allocator<gtsam::Matrix6>>;
+
+  /// Compile the given robot, which needs to have a tree structure.
+  explicit CompiledRobot(const Robot &robot);
+
+  /// @name Sizes
+  /// @{
+
+  /// Number of link id slots, i.e., largest link id + 1.
+  size_t numLinkSlots() const { return num_link_slots_; }
+
+  /// Number of joint id slots, i.e., largest joint id + 1.
+  size_t numJointSlots() const { return num_joint_slots_; }
+
+  /// Number of nodes in the traversal, i.e., number of links.
+  size_t numNodes() const { return link_ids_.size(); }
+
+  /// Return true if at least one root is not a fixed link.
+  bool hasFloatingRoot() const { return has_floating_root_; }
+
+  /// @}
+  /// @name Node-indexed arrays, in traversal order
+  /// @{
+
+  /// Link id of each node.
+  const std::vector<int> &linkIds() const { return link_ids_; }
+
+  /// Index of the tree parent of each node, -1 for roots.
+  const std::vector<int> &parentNodes() const { return parent_nodes_; }
+
+  /// Id of the joint connecting each node to its tree parent, -1 for roots.
+  const std::vector<int> &jointIds() const { return joint_ids_; }
+
+  /// For each node, true if the node link is the child of its joint.
+  const std::vector<bool> &alongJoint() const { return along_joint_; }
+
+  /// 6 x #nodes, screw axis of each node's joint, in the node link's CoM
+  /// frame. Zero for roots.
+  const gtsam::Matrix &screwAxes() const { return screw_axes_; }
+
+  /// Pose of each node link in its tree parent at zero joint angle. Identity
+  /// for roots.
+  const std::vector<gtsam::Pose3> &restPoses() const { return rest_poses_; }
+
+  /// Links in traversal order, to map results back to the Robot.
+  const std::vector<LinkSharedPtr> &links() const { return links_; }
+
+  /// @}
+  /// @name Link-id indexed arrays
+  /// @{
+
+  /// Node of each link in the traversal, -1 for unused slots.
+  const std::vector<int> &nodeOfLink() const { return node_of_link_; }
+
+  /// Id of the tree parent link, -1 for roots and unused slots.
+  const std::vector<int> &parentLinks() const { return parent_links_; }
+
+  /// Spatial inertia matrix of each link.
+  const Matrix6s &inertias() const { return inertias_; }
+
+  /// Mass of each link.
+  const gtsam::Vector &masses() const { return masses_; }
+
+  /// True for fixed links.
+  const std::vector<bool> &isFixed() const { return is_fixed_; }
+
+  /// Fixed pose of each fixed link, identity otherwise.
+  const std::vector<gtsam::Pose3> &fixedPoses() const { return fixed_poses_; }
+
+  /// @}
+  /// @name Joint-id indexed arrays
+  /// @{
+
+  /// Id of the parent link of each joint, -1 for unused slots.
+  const std::vector<int> &jointParentLinks() const {
+    return joint_parent_links_;
+  }
+
+  /// Id of the child link of each joint, -1 for unused slots.
+  const std::vector<int> &jointChildLinks() const {
+    return joint_child_links_;
+  }
+
+  /// Joint frame expressed in the parent link CoM frame.
+  const std::vector<gtsam::Pose3> &jMp() const { return jMp_; }
+
+  /// Joint frame expressed in the child link CoM frame.
+  const std::vector<gtsam::Pose3> &jMc() const { return jMc_; }
+
+  /// 6 x #joints, screw axis of each joint in the child link CoM frame.
+  const gtsam::Matrix &childScrewAxes() const { return child_screw_axes_; }
+
+  /// 6 x #joints, screw axis of each joint in the parent link CoM frame.
+  const gtsam::Matrix &parentScrewAxes() const { return parent_screw_axes_; }
+
+  /// @}
+  /// @name Forward kinematics
+  /// @{
+
+  /**
+   * Forward kinematics on joint-id indexed arrays, without Values.
+   *
+   * CoM poses are written into `poses`, indexed by link id. Fixed roots are
+   * set to their fixed pose; floating roots keep the pose already in the
+   * buffer and are the identity if the buffer had to be resized. Reuse the
+   * same buffer across calls to avoid any allocation.
+   *
+   * @param[in] q          joint angles, indexed by joint id
+   * @param[in,out] poses  link poses wTi, indexed by link id
+   */
+  void forwardKinematics(const gtsam::Vector &q,
+                         std::vector<gtsam::Pose3> *poses) const;
+
+  /**
+   * Forward kinematics with twists, on joint-id indexed arrays.
+   *
+   * As above, and twists are written into the columns of `twists`. Floating
+   * roots keep the twist already in the buffer, zero if it was resized.
+   *
+   * @param[in] q           joint angles, indexed by joint id
+   * @param[in] v           joint velocities, indexed by joint id
+   * @param[in,out] poses   link poses wTi, indexed by link id
+   * @param[in,out] twists  6 x #link slots, link twists V_i
+   */
+  void forwardKinematics(const gtsam::Vector &q, const gtsam::Vector &v,
+                         std::vector<gtsam::Pose3> *poses,
+                         gtsam::Matrix *twists) const;
+
+  /// @}
+  /// @name Jacobians
+  /// @{
+
+  /**
+   * Body Jacobian of a link, on joint-id indexed arrays.
+   *
+   * Column j of `J` is the twist of the link, in its CoM frame, per unit
+   * velocity of joint j. Columns of joints that are not on the tree path
+   * from the link to its root are zero. Under a floating root, the root
+   * twist is not included: it adds Ad(iT_root) V_root.
+   *
+   * @param[in] poses    link poses wTi, from forwardKinematics
+   * @param[in] link_id  id of the link
+   * @param[out] J       6 x #joint slots body Jacobian
+   */
+  void bodyJacobian(const std::vector<gtsam::Pose3> &poses, int link_id,
+                    gtsam::Matrix *J) const;
+
+  /// Spatial Jacobian of a link, J_s = Ad(wTi) J_b, giving the link twist in
+  /// the world frame. Arguments as in bodyJacobian.
+  void spatialJacobian(const std::vector<gtsam::Pose3> &poses, int link_id,
+                       gtsam::Matrix *J) const;
+
+  /// Body Jacobians of several links, e.g. all feet, from the same poses.
+  void bodyJacobians(const std::vector<gtsam::Pose3> &poses,
+                     const std::vector<int> &link_ids,
+                     std::vector<gtsam::Matrix> *Js) const;
+
+  /// Spatial Jacobians of several links, from the same poses.
+  void spatialJacobians(const std::vector<gtsam::Pose3> &poses,
+                        const std::vector<int> &link_ids,
+                        std::vector<gtsam::Matrix> *Js) const;
+
+  /**
+   * Jdot * v of all links, i.e., the derivative of the body twists at zero
+   * joint accelerations, with the recursion A_i = Ad(iTp) A_p + ad(V_i) S v.
+   * Roots are not accelerating. The link accelerations are then
+   * A_i = J_b a + accels.col(i); in the world frame, Jdot_s v is
+   * Ad(wTi) accels.col(i), since ad(V) V = 0.
+   *
+   * Poses and twists are computed first, as in forwardKinematics, so the
+   * Jacobians can be taken from the same poses.
+   *
+   * @param[in] q           joint angles, indexed by joint id
+   * @param[in] v           joint velocities, indexed by joint id
+   * @param[in,out] poses   link poses wTi, indexed by link id
+   * @param[in,out] twists  6 x #link slots, link twists V_i
+   * @param[out] accels     6 x #link slots, Jdot * v of each link
+   */
+  void biasAccelerations(const gtsam::Vector &q, const gtsam::Vector &v,
+                         std::vector<gtsam::Pose3> *poses,
+                         gtsam::Matrix *twists, gtsam::Matrix *accels) const;
+
+  /// @}
+
+ private:
+  size_t num_link_slots_, num_joint_slots_;
+  bool has_floating_root_;
+
+  // Node-indexed.
+  std::vector<int> link_ids_, parent_nodes_, joint_ids_;
+  std::vector<bool> along_joint_;
+  gtsam::Matrix screw_axes_;
+  std::vector<gtsam::Pose3> rest_poses_;
+  std::vector<LinkSharedPtr> links_;
+
+  // Link-id indexed.
+  std::vector<int> node_of_link_, parent_links_;
+  Matrix6s inertias_;
+  gtsam::Vector masses_;
+  std::vector<bool> is_fixed_;
+  std::vector<gtsam::Pose3> fixed_poses_;
+
+  // Joint-id indexed.
+  std::vector<int> joint_parent_links_, joint_child_links_;
+  std::vector<gtsam::Pose3> jMp_, jMc_;
+  gtsam::Matrix child_screw_axes_, parent_screw_axes_;
+
+  // Node of a link, throwing std::invalid_argument for unused ids.
+  int checkedNode(int link_id) const;
+};
+
+}  // namespace gtdynamics
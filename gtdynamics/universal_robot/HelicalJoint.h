@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <boost/make_shared.hpp>
+
 #include "gtdynamics/universal_robot/Joint.h"
 
 namespace gtdynamics {
@@ -55,7 +57,8 @@ class HelicalJoint : public Joint {
    * @param[in] thread_pitch  joint's thread pitch in dist per rev
    * @param[in] parameters    JointParams struct.
    */
-  HelicalJoint(uint8_t id, const std::string &name, const gtsam::Pose3 &bTj,
+  HelicalJoint(DynamicsIndex id, const std::string &name,
+               const gtsam::Pose3 &bTj,
                const LinkSharedPtr &parent_link,
                const LinkSharedPtr &child_link, const gtsam::Vector3 &axis,
                double thread_pitch,
@@ -69,6 +72,11 @@ class HelicalJoint : public Joint {
   /// Return joint type for use in reconstructing robot from JointParams.
   Type type() const final override { return Type::Screw; }
 
+  /// Return a copy of this joint, still connected to the same links.
+  JointSharedPtr clone() const final override {
+    return boost::make_shared<HelicalJoint>(*this);
+  }
+
  private:
   /// @name Advanced Interface
   /// @{
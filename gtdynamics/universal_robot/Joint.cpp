@@ -18,10 +18,12 @@
 
 #include <gtsam/slam/expressions.h>
 
+#include <cmath>
 #include <iostream>
 
 #include "gtdynamics/factors/JointLimitFactor.h"
 #include "gtdynamics/universal_robot/Link.h"
+#include "gtdynamics/utils/NoiseModels.h"
 
 using gtsam::Pose3;
 using gtsam::Vector6;
@@ -29,7 +31,7 @@ using gtsam::Vector6;
 namespace gtdynamics {
 
 /* ************************************************************************* */
-Joint::Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
+Joint::Joint(DynamicsIndex id, const std::string &name, const Pose3 &bTj,
              const LinkSharedPtr &parent_link, const LinkSharedPtr &child_link,
              const Vector6 &jScrewAxis, const JointParams &parameters)
     : id_(id),
@@ -40,7 +42,18 @@ Joint::Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
       jMc_(bTj.inverse() * child_link->bMcom()),
       pScrewAxis_(-jMp_.inverse().AdjointMap() * jScrewAxis),
       cScrewAxis_(jMc_.inverse().AdjointMap() * jScrewAxis),
-      parameters_(parameters) {}
+      parameters_(parameters),
+      motion_(MotionOf(jScrewAxis)),
+      jScrewAxis_(jScrewAxis),
+      pMj_(jMp_.inverse()),
+      cMj_(jMc_.inverse()) {}
+
+/* ************************************************************************* */
+Joint::Motion Joint::MotionOf(const Vector6 &jScrewAxis) {
+  if (jScrewAxis.tail<3>().isZero()) return Motion::Rotation;
+  if (jScrewAxis.head<3>().isZero()) return Motion::Translation;
+  return Motion::Screw;
+}
 
 /* ************************************************************************* */
 bool Joint::isChildLink(const LinkSharedPtr &link) const {
@@ -50,34 +63,52 @@ bool Joint::isChildLink(const LinkSharedPtr &link) const {
   return link == child_link_;
 }
 
+/* ************************************************************************* */
+Pose3 Joint::jointMotion(double q) const {
+  switch (motion_) {
+    case Motion::Rotation:
+      return Pose3(gtsam::Rot3::Expmap(jScrewAxis_.head<3>() * q),
+                   gtsam::Point3(0, 0, 0));
+    case Motion::Translation:
+      return Pose3(gtsam::Rot3(), jScrewAxis_.tail<3>() * q);
+    default:
+      return Pose3::Expmap(jScrewAxis_ * q);
+  }
+}
+
 /* ************************************************************************* */
 Pose3 Joint::parentTchild(double q,
                           gtsam::OptionalJacobian<6, 1> pTc_H_q) const {
-  // Multiply screw axis with joint angle to get a finite 6D screw.
-  const Vector6 screw = cScrewAxis_ * q;
-
-  // Calculate the actual relative pose taking into account the joint angle.
-  // TODO(dellaert): use formula `pMj_ * screw_around_Z * jMc_`.
-  gtsam::Matrix6 exp_H_screw;
-  const Pose3 exp = Pose3::Expmap(screw, pTc_H_q ? &exp_H_screw : 0);
-  if (pTc_H_q) {
-    *pTc_H_q = exp_H_screw * cScrewAxis_;
-  }
-  return pMc() * exp;  // Note: derivative of compose in exp is identity.
+  // pTc(q) = pMj * exp([jS] q) * jMc = pMc * exp([cS] q). The derivative of
+  // the exponential map along its own direction is identity, so in the child
+  // frame the derivative is the child screw axis.
+  if (pTc_H_q) *pTc_H_q = cScrewAxis_;
+  return pMj_ * jointMotion(q) * jMc_;
 }
 
 /* ************************************************************************* */
 Pose3 Joint::childTparent(double q,
                           gtsam::OptionalJacobian<6, 1> cTp_H_q) const {
-  // TODO(frank): don't go via inverse, specialize in base class
-  Vector6 pTc_H_q;
-  Pose3 pTc = parentTchild(q, cTp_H_q ? &pTc_H_q : 0);  // pTc(q) ->  pTc_H_q
-  gtsam::Matrix6 cTp_H_pTc;
-  Pose3 cTp = pTc.inverse(cTp_H_q ? &cTp_H_pTc : 0);  // cTp(pTc) ->  cTp_H_pTc
-  if (cTp_H_q) {
-    *cTp_H_q = cTp_H_pTc * pTc_H_q;
+  // cTp(q) = cMj * exp(-[jS] q) * jMp = exp(-[cS] q) * cMp, whose derivative
+  // in the parent frame is -Ad(pTc(q)) cS, which is the parent screw axis.
+  if (cTp_H_q) *cTp_H_q = pScrewAxis_;
+  return cMj_ * jointMotion(-q) * jMp_;
+}
+
+/* ************************************************************************* */
+const JointKinematics &Joint::childKinematics(double q, bool jacobian) const {
+  bool found;
+  JointKinematics *k = JointKinematicsCache::Find(kinematics_key_, q, &found);
+  if (!found) {
+    k->pTc = parentTchild(q);
+    k->cTp = childTparent(q);
+    k->Ad_cTp = k->cTp.AdjointMap();
   }
-  return cTp;
+  if (jacobian && !k->has_jacobian) {
+    k->Ad_cTp_H_q = AdjointMapJacobianQ(q, childTparent(0.0), cScrewAxis_);
+    k->has_jacobian = true;
+  }
+  return *k;
 }
 
 /* ************************************************************************* */
@@ -90,12 +121,19 @@ Vector6 Joint::transformTwistTo(
   Vector6 other_twist_ = other_twist ? *other_twist : Vector6::Zero();
 
   auto other = otherLink(link);
-  auto this_ad_other = relativePoseOf(other, q).AdjointMap();
-
-  if (H_q) {
-    // TODO(frank): really, zero below? Check derivatives
-    *H_q = AdjointMapJacobianQ(q, relativePoseOf(other, 0.0), screwAxis(link)) *
-           other_twist_;
+  gtsam::Matrix6 this_ad_other;
+  if (link == child_link_) {
+    const JointKinematics &k = childKinematics(q, bool(H_q));
+    this_ad_other = k.Ad_cTp;
+    if (H_q) *H_q = k.Ad_cTp_H_q * other_twist_;
+  } else {
+    this_ad_other = relativePoseOf(other, q).AdjointMap();
+    if (H_q) {
+      // TODO(frank): really, zero below? Check derivatives
+      *H_q = AdjointMapJacobianQ(q, relativePoseOf(other, 0.0),
+                                 screwAxis(link)) *
+             other_twist_;
+    }
   }
   if (H_q_dot) {
     *H_q_dot = screwAxis(link);
@@ -114,6 +152,13 @@ Vector6 Joint::transformWrenchCoordinate(
       gtsam::OptionalJacobian<6, 6> H_wrench) const {
 
     auto other = otherLink(link);
+    if (link == child_link_) {
+      const JointKinematics &k = childKinematics(q, bool(H_q));
+      if (H_wrench) *H_wrench = k.Ad_cTp.transpose();
+      if (H_q) *H_q = k.Ad_cTp_H_q.transpose() * wrench;
+      return k.Ad_cTp.transpose() * wrench;
+    }
+
     gtsam::Pose3 T_21 = relativePoseOf(other, q);
     gtsam::Matrix6 Ad_21_T = T_21.AdjointMap().transpose();
     gtsam::Vector6 transformed_wrench = Ad_21_T * wrench;
@@ -129,6 +174,18 @@ Vector6 Joint::transformWrenchCoordinate(
     return transformed_wrench;
 }
 
+/* ************************************************************************* */
+double Joint::passiveTorque(double q, double v, double *dq, double *dv) const {
+  const JointParams &p = parameters_;
+  const double s = std::tanh(v / p.friction_velocity);
+  if (dq) *dq = -p.spring_coefficient;
+  if (dv)
+    *dv = -p.damping_coefficient -
+          p.coulomb_friction * (1 - s * s) / p.friction_velocity;
+  return -p.spring_coefficient * (q - p.spring_reference) -
+         p.damping_coefficient * v - p.coulomb_friction * s;
+}
+
 /* ************************************************************************* */
 double Joint::transformWrenchToTorque(
     const LinkSharedPtr &link, boost::optional<Vector6> wrench,
@@ -148,7 +205,7 @@ gtsam::GaussianFactorGraph Joint::linearFDPriors(
   gtsam::Vector1 rhs(Torque(known_values, id(), t));
   // TODO(alej`andro): use optimizer settings
   priors.add(internal::TorqueKey(id(), t), gtsam::I_1x1, rhs,
-             gtsam::noiseModel::Constrained::All(1));
+             ConstrainedAll(1));
   return priors;
 }
 
@@ -171,7 +228,7 @@ gtsam::GaussianFactorGraph Joint::linearAFactors(
   graph.add(internal::TwistAccelKey(child()->id(), t), gtsam::I_6x6,
             internal::TwistAccelKey(parent()->id(), t), -T_i2i1.AdjointMap(),
             internal::JointAccelKey(id(), t), -S_i2_j, rhs_tw,
-            gtsam::noiseModel::Constrained::All(6));
+            ConstrainedAll(6));
 
   return graph;
 }
@@ -188,11 +245,14 @@ gtsam::GaussianFactorGraph Joint::linearDynamicsFactors(
   const Vector6 S_i2_j = screwAxis(child_link_);
 
   // torque factor
-  // S_i_j^T * F_i_j - tau = 0
+  // S_i_j^T * F_i_j - tau = tau_passive(q, v), zero unless asked for
   gtsam::Vector1 rhs_torque = gtsam::Vector1::Zero();
+  if (opt.passive_joint_forces)
+    rhs_torque(0) = passiveTorque(JointAngle(known_values, id(), t),
+                                  JointVel(known_values, id(), t));
   graph.add(internal::WrenchKey(child()->id(), id(), t), S_i2_j.transpose(),
             internal::TorqueKey(id(), t), -gtsam::I_1x1, rhs_torque,
-            gtsam::noiseModel::Constrained::All(1));
+            ConstrainedAll(1));
 
   // wrench equivalence factor
   // F_i1_j + Ad(T_i2i1)^T F_i2_j = 0
@@ -200,13 +260,13 @@ gtsam::GaussianFactorGraph Joint::linearDynamicsFactors(
   graph.add(internal::WrenchKey(parent()->id(), id(), t), gtsam::I_6x6,
             internal::WrenchKey(child()->id(), id(), t),
             T_i2i1.AdjointMap().transpose(), rhs_weq,
-            gtsam::noiseModel::Constrained::All(6));
+            ConstrainedAll(6));
 
   // wrench planar factor
   if (planar_axis) {
     gtsam::Matrix36 J_wrench = getPlanarJacobian(*planar_axis);
     graph.add(internal::WrenchKey(child()->id(), id(), t), J_wrench,
-              gtsam::Vector3::Zero(), gtsam::noiseModel::Constrained::All(3));
+              gtsam::Vector3::Zero(), ConstrainedAll(3));
   }
 
   return graph;
@@ -249,6 +309,28 @@ gtsam::NonlinearFactorGraph Joint::jointLimitFactors(
   return graph;
 }
 
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph Joint::jointLimitFactors(
+    size_t t, const OptimizerSetting &opt,
+    const JointParameterBlock::shared_ptr &block) const {
+  using Quantity = JointLimitFactor::Quantity;
+  gtsam::NonlinearFactorGraph graph;
+  auto id = this->id();
+  graph.emplace_shared<JointLimitFactor>(internal::JointAngleKey(id, t),
+                                         opt.jl_cost_model, block,
+                                         Quantity::Angle);
+  graph.emplace_shared<JointLimitFactor>(internal::JointVelKey(id, t),
+                                         opt.jl_cost_model, block,
+                                         Quantity::Velocity);
+  graph.emplace_shared<JointLimitFactor>(internal::JointAccelKey(id, t),
+                                         opt.jl_cost_model, block,
+                                         Quantity::Acceleration);
+  graph.emplace_shared<JointLimitFactor>(internal::TorqueKey(id, t),
+                                         opt.jl_cost_model, block,
+                                         Quantity::Torque);
+  return graph;
+}
+
 /* ************************************************************************* */
 std::ostream &Joint::to_stream(std::ostream &os) const {
   os << name_ << "\n\tid=" << size_t(id_)
@@ -330,18 +412,14 @@ gtsam::Vector6_ Joint::twistAccelConstraint(uint64_t t) const {
       [this](double q, const Vector6 &other_twist_accel,
              gtsam::OptionalJacobian<6, 1> H_q,
              gtsam::OptionalJacobian<6, 6> H_other_twist_accel) {
-        Pose3 jTi = relativePoseOf(parent(), q);
-        Vector6 this_twist_accel = jTi.AdjointMap() * other_twist_accel;
+        const JointKinematics &k = childKinematics(q, bool(H_q));
+        Vector6 this_twist_accel = k.Ad_cTp * other_twist_accel;
 
         if (H_other_twist_accel) {
-          *H_other_twist_accel = jTi.AdjointMap();
+          *H_other_twist_accel = k.Ad_cTp;
         }
         if (H_q) {
-          // TODO(frank): really, zero below? Check derivatives. Also,
-          // copy/pasta from above?
-          *H_q = AdjointMapJacobianQ(q, relativePoseOf(parent(), 0.0),
-                                     cScrewAxis_) *
-                 other_twist_accel;
+          *H_q = k.Ad_cTp_H_q * other_twist_accel;
         }
         return this_twist_accel;
       };
@@ -32,13 +32,15 @@
 #include <vector>
 
 #include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/universal_robot/JointKinematicsCache.h"
 #include "gtdynamics/universal_robot/RobotTypes.h"
 #include "gtdynamics/utils/DynamicsSymbol.h"
 
 namespace gtdynamics {
 
-class Joint;  // forward declaration
-class Link;   // forward declaration
+class Joint;                // forward declaration
+class JointParameterBlock;  // forward declaration
+class Link;                 // forward declaration
 
 LINK_TYPEDEF_CLASS_POINTER(Link);
 LINK_TYPEDEF_CLASS_POINTER(Joint);
@@ -88,6 +90,10 @@ struct JointParams {
   double torque_limit_threshold = 0.0;
   double damping_coefficient = 0.0;
   double spring_coefficient = 0.0;
+  double spring_reference = 0.0;  ///< angle at which the spring is relaxed
+  double coulomb_friction = 0.0;  ///< magnitude of the Coulomb friction
+  /// Velocity scale of the tanh that smooths the sign of Coulomb friction.
+  double friction_velocity = 1e-3;
 
   /// Constructor
   JointParams() {}
@@ -106,6 +112,9 @@ struct JointParams {
     ar &BOOST_SERIALIZATION_NVP(torque_limit_threshold);
     ar &BOOST_SERIALIZATION_NVP(damping_coefficient);
     ar &BOOST_SERIALIZATION_NVP(spring_coefficient);
+    ar &BOOST_SERIALIZATION_NVP(spring_reference);
+    ar &BOOST_SERIALIZATION_NVP(coulomb_friction);
+    ar &BOOST_SERIALIZATION_NVP(friction_velocity);
   }
 };
 
@@ -131,7 +140,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   std::string name_;
 
   /// ID reference to DynamicsSymbol.
-  uint8_t id_;
+  DynamicsIndex id_;
 
   /// Rest transform to parent link CoM frame from joint frame.
   Pose3 jMp_;
@@ -149,6 +158,24 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   /// Joint parameters struct.
   JointParams parameters_;
 
+  /// Kind of motion the screw axis describes, to pick a closed form for the
+  /// joint transform.
+  enum class Motion : char { Rotation, Translation, Screw };
+  Motion motion_ = Motion::Screw;
+  static Motion MotionOf(const Vector6 &jScrewAxis);
+
+  /// Screw axis in the joint frame, and rest transforms to the joint frame.
+  Vector6 jScrewAxis_;
+  Pose3 pMj_, cMj_;
+
+  /// Key of this joint in the JointKinematicsCache.
+  uint64_t kinematics_key_ = JointKinematicsCache::NewJointKey();
+
+  /// Transform of the joint frame moved by q, relative to the joint frame at
+  /// rest: exp([jScrewAxis] q), in closed form for rotations and
+  /// translations.
+  Pose3 jointMotion(double q) const;
+
   /// Check if the link is a child link, throw an error if link is not
   /// connected to this joint.
   bool isChildLink(const LinkSharedPtr &link) const;
@@ -169,7 +196,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
    * @param[in] jScrewAxis   Screw axis in the joint frame
    * @param[in] parameters   The joint parameters.
    */
-  Joint(uint8_t id, const std::string &name, const Pose3 &bTj,
+  Joint(DynamicsIndex id, const std::string &name, const Pose3 &bTj,
         const LinkSharedPtr &parent_link, const LinkSharedPtr &child_link,
         const Vector6 &jScrewAxis,
         const JointParams &parameters = JointParams());
@@ -186,7 +213,7 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   JointConstSharedPtr shared() const { return shared_from_this(); }
 
   /// Get the joint's ID.
-  uint8_t id() const { return id_; }
+  DynamicsIndex id() const { return id_; }
 
   /// Return (unchanging) pose of the parent link's COM in the joint frame.
   const Pose3 &jMp() const { return jMp_; }
@@ -233,6 +260,26 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   /// Return joint parameters.
   const JointParams &parameters() const { return parameters_; }
 
+  /**
+   * Passive torque of the spring, damper and friction of the joint on its
+   * child link at angle q and velocity v:
+   *   -k (q - q_0) - d v - f tanh(v / v_f),
+   * with k, q_0, d, f and v_f the spring_coefficient, spring_reference,
+   * damping_coefficient, coulomb_friction and friction_velocity of the
+   * parameters. The smooth sign keeps the torque differentiable at rest.
+   * @param dq  if given, set to the derivative in q
+   * @param dv  if given, set to the derivative in v
+   */
+  double passiveTorque(double q, double v, double *dq = nullptr,
+                       double *dv = nullptr) const;
+
+  /// Whether the joint has a spring, damper or friction.
+  bool hasPassiveTorque() const {
+    return parameters_.spring_coefficient != 0 ||
+           parameters_.damping_coefficient != 0 ||
+           parameters_.coulomb_friction != 0;
+  }
+
   bool operator==(const Joint &other) const {
     return (this->name_ == other.name_ && this->id_ == other.id_ &&
             this->jMp_.equals(other.jMp_) && this->jMc_.equals(other.jMc_));
@@ -268,6 +315,12 @@ class Joint : public boost::enable_shared_from_this<Joint> {
    */
   virtual Type type() const = 0;
 
+  /**
+   * Abstract method: Return a copy of this joint, still connected to the
+   * links of this joint.
+   */
+  virtual JointSharedPtr clone() const = 0;
+
   /**@}*/
 
   /**
@@ -282,6 +335,14 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   Pose3 childTparent(double q,
                      gtsam::OptionalJacobian<6, 1> cMp_H_q = boost::none) const;
 
+  /**
+   * Return the transforms between the parent and child CoM frames at angle
+   * q, and the derivative in q of the adjoint map of cTp if `jacobian` is
+   * true, memoized per thread in JointKinematicsCache. The reference is
+   * valid until the next call of childKinematics on the same thread.
+   */
+  const JointKinematics &childKinematics(double q, bool jacobian) const;
+
   /**
    * Return the relative pose of the specified link [link2] in the other link's
    * [link1] reference frame.
@@ -372,6 +433,19 @@ class Joint : public boost::enable_shared_from_this<Joint> {
   gtsam::NonlinearFactorGraph jointLimitFactors(
       size_t t, const OptimizerSetting &opt) const;
 
+  /**
+   * Return joint limit factors reading their limits from `block` at every
+   * evaluation, so that they follow changes of the block.
+   *
+   * @param[in] t     The timestep for which to generate joint limit factors.
+   * @param[in] opt   OptimizerSetting object containing NoiseModels.
+   * @param[in] block Parameters of this joint, shared by the factors.
+   * @return joint limit factors.
+   */
+  gtsam::NonlinearFactorGraph jointLimitFactors(
+      size_t t, const OptimizerSetting &opt,
+      const boost::shared_ptr<JointParameterBlock> &block) const;
+
   /// Joint-induced twist in child frame
   Vector6 childTwist(double q_dot) const;
 
@@ -449,6 +523,11 @@ class Joint : public boost::enable_shared_from_this<Joint> {
     ar &BOOST_SERIALIZATION_NVP(pScrewAxis_);
     ar &BOOST_SERIALIZATION_NVP(cScrewAxis_);
     ar &BOOST_SERIALIZATION_NVP(parameters_);
+    ar &BOOST_SERIALIZATION_NVP(jScrewAxis_);
+    ar &BOOST_SERIALIZATION_NVP(pMj_);
+    ar &BOOST_SERIALIZATION_NVP(cMj_);
+    motion_ = MotionOf(jScrewAxis_);
+    kinematics_key_ = JointKinematicsCache::NewJointKey();
   }
 
   /// @}
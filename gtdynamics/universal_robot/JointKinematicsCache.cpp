@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointKinematicsCache.cpp
+ * @brief Per-thread memo of joint transforms, shared by the joint factors.
+ */
+
+#include "gtdynamics/universal_robot/JointKinematicsCache.h"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace gtdynamics {
+
+namespace {
+std::atomic<uint64_t> next_joint_key{1};
+std::atomic<bool> enabled{true};
+
+struct Entry {
+  uint64_t joint_key = 0;  // 0 for empty entries
+  uint64_t q_bits = 0;
+  JointKinematics kinematics;
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+// Table and statistics of one thread, allocated at its first lookup.
+struct Table {
+  std::vector<Entry, Eigen::aligned_allocator<Entry>> entries;
+  Entry scratch;  // handed out when the cache is disabled
+  JointKinematicsCacheStats stats;
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+Table &LocalTable() {
+  thread_local Table table;
+  if (table.entries.empty()) table.entries.resize(JointKinematicsCache::kSize);
+  return table;
+}
+
+uint64_t Bits(double q) {
+  uint64_t bits;
+  std::memcpy(&bits, &q, sizeof(bits));
+  return bits;
+}
+}  // namespace
+
+/* ************************************************************************* */
+uint64_t JointKinematicsCache::NewJointKey() { return next_joint_key++; }
+
+/* ************************************************************************* */
+JointKinematics *JointKinematicsCache::Find(uint64_t joint_key, double q,
+                                            bool *found) {
+  Table &table = LocalTable();
+  if (!Enabled()) {
+    ++table.stats.misses;
+    *found = false;
+    table.scratch.kinematics.has_jacobian = false;
+    return &table.scratch.kinematics;
+  }
+
+  // Multiplicative hashing of the key and angle, high bits index the table.
+  const uint64_t q_bits = Bits(q);
+  const uint64_t hash =
+      (joint_key * 0x9E3779B97F4A7C15ull) ^ (q_bits * 0xC2B2AE3D27D4EB4Full);
+  Entry &entry = table.entries[(hash >> 32) % kSize];
+  *found = entry.joint_key == joint_key && entry.q_bits == q_bits;
+  if (*found) {
+    ++table.stats.hits;
+  } else {
+    ++table.stats.misses;
+    entry.joint_key = joint_key;
+    entry.q_bits = q_bits;
+    entry.kinematics.has_jacobian = false;
+  }
+  return &entry.kinematics;
+}
+
+/* ************************************************************************* */
+bool JointKinematicsCache::Enabled() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+/* ************************************************************************* */
+void JointKinematicsCache::SetEnabled(bool value) {
+  enabled.store(value, std::memory_order_relaxed);
+}
+
+/* ************************************************************************* */
+JointKinematicsCacheStats JointKinematicsCache::Stats() {
+  return LocalTable().stats;
+}
+
+/* ************************************************************************* */
+void JointKinematicsCache::Clear() {
+  Table &table = LocalTable();
+  for (auto &&entry : table.entries) entry.joint_key = 0;
+  table.stats = JointKinematicsCacheStats();
+}
+
+}  // namespace gtdynamics
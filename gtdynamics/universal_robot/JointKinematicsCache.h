@@ -0,0 +1,82 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointKinematicsCache.h
+ * @brief Per-thread memo of joint transforms, shared by the joint factors.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gtdynamics {
+
+/// Transforms of a joint at one angle q, see Joint::childKinematics.
+struct JointKinematics {
+  gtsam::Pose3 pTc;           ///< child CoM pose in the parent CoM frame
+  gtsam::Pose3 cTp;           ///< parent CoM pose in the child CoM frame
+  gtsam::Matrix6 Ad_cTp;      ///< adjoint map of cTp
+  gtsam::Matrix6 Ad_cTp_H_q;  ///< derivative of Ad_cTp in q
+  bool has_jacobian;          ///< whether Ad_cTp_H_q is set
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/// Lookups of the calling thread since the last JointKinematicsCache::Clear.
+struct JointKinematicsCacheStats {
+  size_t hits = 0;    ///< lookups answered from the cache
+  size_t misses = 0;  ///< lookups that had to be computed
+};
+
+/**
+ * JointKinematicsCache memoizes the transform Exp(S q) of a joint, its
+ * adjoint map and the derivative of the adjoint map in q, which the twist,
+ * twist acceleration and wrench equivalence factors of the same joint and
+ * time step would each recompute when a graph is linearized. Entries are
+ * keyed on the joint and the bits of q, so a time step of a joint is
+ * computed once per linearization, and entries of earlier linearizations
+ * are found again only if q did not change, in which case they are exact.
+ *
+ * The cache is a direct-mapped table per thread, so parallel linearization
+ * needs no locks and threads never see each other's entries; a collision
+ * evicts the older entry. Joints draw their key from NewJointKey at
+ * construction, never reused, and copies of a joint share the key of the
+ * original, which has the same transforms.
+ */
+class JointKinematicsCache {
+ public:
+  /// Number of entries of the table of each thread.
+  static constexpr size_t kSize = 256;
+
+  /// A key for a new joint.
+  static uint64_t NewJointKey();
+
+  /**
+   * Entry of the calling thread for a joint at angle q. If `*found` is set
+   * to false, the entry is to be filled by the caller, with has_jacobian
+   * cleared. The entry is valid until the next call on the same thread.
+   */
+  static JointKinematics *Find(uint64_t joint_key, double q, bool *found);
+
+  /// Whether lookups hit the cache, true by default, for all threads.
+  static bool Enabled();
+
+  /// Enable or disable the cache, e.g. to measure its effect.
+  static void SetEnabled(bool enabled);
+
+  /// Lookups of the calling thread.
+  static JointKinematicsCacheStats Stats();
+
+  /// Drop the entries and reset the statistics of the calling thread.
+  static void Clear();
+};
+
+}  // namespace gtdynamics
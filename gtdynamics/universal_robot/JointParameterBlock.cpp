@@ -0,0 +1,49 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointParameterBlock.cpp
+ * @brief Shared, versioned joint parameters that factors refer to.
+ */
+
+#include "gtdynamics/universal_robot/JointParameterBlock.h"
+
+#include <boost/make_shared.hpp>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+JointParameterBlocks::JointParameterBlocks(const Robot &robot) {
+  for (auto &&joint : robot.joints()) {
+    const size_t j = joint->id();
+    if (j >= blocks_.size()) blocks_.resize(j + 1);
+    blocks_[j] = boost::make_shared<JointParameterBlock>(joint->parameters());
+  }
+}
+
+/* ************************************************************************* */
+const JointParameterBlock::shared_ptr &JointParameterBlocks::block(
+    int j) const {
+  if (j < 0 || size_t(j) >= blocks_.size() || !blocks_[j])
+    throw std::out_of_range("JointParameterBlocks: no joint with id " +
+                            std::to_string(j) + ".");
+  return blocks_[j];
+}
+
+/* ************************************************************************* */
+uint64_t JointParameterBlocks::version() const {
+  uint64_t version = 0;
+  for (auto &&block : blocks_)
+    if (block) version += block->version();
+  return version;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,93 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  JointParameterBlock.h
+ * @brief Shared, versioned joint parameters that factors refer to.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "gtdynamics/universal_robot/Joint.h"
+
+namespace gtdynamics {
+
+class Robot;
+
+/**
+ * JointParameterBlock holds the JointParams of one joint for factors that
+ * read them at every evaluation instead of copying them at construction,
+ * e.g. JointLimitFactor. Setting new parameters, for gain scheduling or
+ * online adaptation, changes every factor referring to the block without
+ * rebuilding the graph, and bumps version(), so code caching linearizations
+ * can tell they are stale.
+ *
+ * The parameters are kept as an immutable snapshot swapped atomically:
+ * readers on other threads see either the old or the new parameters, never
+ * a mix.
+ */
+class JointParameterBlock {
+ public:
+  using shared_ptr = boost::shared_ptr<JointParameterBlock>;
+
+  explicit JointParameterBlock(const JointParams &parameters = JointParams())
+      : parameters_(std::make_shared<const JointParams>(parameters)) {}
+
+  JointParameterBlock(const JointParameterBlock &) = delete;
+  JointParameterBlock &operator=(const JointParameterBlock &) = delete;
+
+  /// Snapshot of the current parameters.
+  std::shared_ptr<const JointParams> parameters() const {
+    return std::atomic_load(&parameters_);
+  }
+
+  /// Replace the parameters, and increment the version.
+  void set(const JointParams &parameters) {
+    std::atomic_store(&parameters_,
+                      std::make_shared<const JointParams>(parameters));
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  /// Number of calls to set() so far.
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+ private:
+  std::shared_ptr<const JointParams> parameters_;
+  std::atomic<uint64_t> version_{0};
+};
+
+/**
+ * Parameter blocks of all joints of a robot, indexed by joint id and
+ * initialized with the parameters of the joints.
+ */
+class JointParameterBlocks {
+ public:
+  explicit JointParameterBlocks(const Robot &robot);
+
+  /// Block of the joint with id `j`, throws std::out_of_range if none.
+  const JointParameterBlock::shared_ptr &block(int j) const;
+
+  /// Set the parameters of the joint with id `j`.
+  void set(int j, const JointParams &parameters) {
+    block(j)->set(parameters);
+  }
+
+  /// Sum of the versions of all blocks, which changes on every set().
+  uint64_t version() const;
+
+ private:
+  std::vector<JointParameterBlock::shared_ptr> blocks_;  // by joint id
+};
+
+}  // namespace gtdynamics
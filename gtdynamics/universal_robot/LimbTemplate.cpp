@@ -0,0 +1,206 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LimbTemplate.cpp
+ * @brief Identical limbs of a robot, e.g. legs, evaluated together.
+ */
+
+#include "gtdynamics/universal_robot/LimbTemplate.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+namespace {
+// True if the limbs have the same parameters at every depth.
+bool Congruent(const CompiledRobot &robot, const Limb &a, const Limb &b,
+               double tol) {
+  if (a.link_ids.size() != b.link_ids.size()) return false;
+  for (size_t d = 0; d < a.link_ids.size(); ++d) {
+    const int na = robot.nodeOfLink()[a.link_ids[d]];
+    const int nb = robot.nodeOfLink()[b.link_ids[d]];
+    if (!gtsam::equal_with_abs_tol(robot.screwAxes().col(na),
+                                   robot.screwAxes().col(nb), tol) ||
+        !gtsam::equal_with_abs_tol(robot.inertias()[a.link_ids[d]],
+                                   robot.inertias()[b.link_ids[d]], tol) ||
+        std::abs(robot.masses()(a.link_ids[d]) -
+                 robot.masses()(b.link_ids[d])) > tol)
+      return false;
+    if (d > 0 && !robot.restPoses()[na].equals(robot.restPoses()[nb], tol))
+      return false;
+  }
+  return true;
+}
+}  // namespace
+
+/* ************************************************************************* */
+void LimbTemplate::PoseLanes::resize(size_t n) {
+  for (auto &lanes : R) lanes.resize(n);
+  for (auto &lanes : t) lanes.resize(n);
+}
+
+/* ************************************************************************* */
+LimbTemplate::LimbTemplate(const CompiledRobot &robot, int base_link_id,
+                           const std::vector<Limb> &limbs)
+    : base_link_id_(base_link_id), limbs_(limbs) {
+  if (limbs_.empty())
+    throw std::invalid_argument("LimbTemplate: needs at least one limb.");
+  const Limb &limb = limbs_.front();
+  const size_t depth = limb.link_ids.size();
+  rest_poses_.resize(depth);
+  screw_axes_.resize(6, depth);
+  inertias_.resize(depth);
+  masses_.resize(depth);
+  for (size_t d = 0; d < depth; ++d) {
+    const int i = limb.link_ids[d];
+    const int n = robot.nodeOfLink()[i];
+    if (d > 0) rest_poses_[d] = robot.restPoses()[n];
+    screw_axes_.col(d) = robot.screwAxes().col(n);
+    inertias_[d] = robot.inertias()[i];
+    masses_(d) = robot.masses()(i);
+    const double w = screw_axes_.col(d).head<3>().norm();
+    if (w > 1e-9 && std::abs(w - 1) > 1e-9)
+      throw std::invalid_argument(
+          "LimbTemplate: screw axes need a unit or zero rotation.");
+  }
+  const size_t L = limbs_.size();
+  T_.resize(L);
+  E_.resize(L);
+  theta_.resize(L);
+  cos_.resize(L);
+  sin_.resize(L);
+}
+
+/* ************************************************************************* */
+void LimbTemplate::forwardKinematics(const gtsam::Vector &q,
+                                     std::vector<Pose3> *poses) const {
+  const size_t L = limbs_.size();
+  const Pose3 &wTb = (*poses)[base_link_id_];
+  for (size_t l = 0; l < L; ++l) {
+    const Pose3 wTm = wTb * limbs_[l].mount;
+    const gtsam::Matrix3 R = wTm.rotation().matrix();
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 3; ++c) T_.R[3 * r + c](l) = R(r, c);
+      T_.t[r](l) = wTm.translation()(r);
+    }
+  }
+
+  Lanes R[9], t[3];
+  for (size_t d = 0; d < depth(); ++d) {
+    // T = T * rest, with the same rest pose in all lanes.
+    if (d > 0) {
+      const gtsam::Matrix3 C = rest_poses_[d].rotation().matrix();
+      const gtsam::Point3 &c_t = rest_poses_[d].translation();
+      for (int r = 0; r < 3; ++r) {
+        const Lanes &a0 = T_.R[3 * r], &a1 = T_.R[3 * r + 1],
+                    &a2 = T_.R[3 * r + 2];
+        t[r] = a0 * c_t(0) + a1 * c_t(1) + a2 * c_t(2) + T_.t[r];
+        for (int c = 0; c < 3; ++c)
+          R[3 * r + c] = a0 * C(0, c) + a1 * C(1, c) + a2 * C(2, c);
+      }
+      for (int k = 0; k < 9; ++k) T_.R[k].swap(R[k]);
+      for (int r = 0; r < 3; ++r) T_.t[r].swap(t[r]);
+    }
+
+    // E = Expmap(S * theta) per lane: Rodrigues' formula for unit w, with
+    // translation (I - R)(w x v) + w (w . v) theta, or a pure translation.
+    for (size_t l = 0; l < L; ++l) theta_(l) = q(limbs_[l].joint_ids[d]);
+    const gtsam::Vector3 w = screw_axes_.col(d).head<3>();
+    const gtsam::Vector3 v = screw_axes_.col(d).tail<3>();
+    if (w.norm() < 1e-9) {
+      for (int k = 0; k < 9; ++k) E_.R[k].setConstant(k % 4 == 0 ? 1 : 0);
+      for (int r = 0; r < 3; ++r) E_.t[r] = theta_ * v(r);
+    } else {
+      cos_ = theta_.cos();
+      sin_ = theta_.sin();
+      const gtsam::Matrix3 W = gtsam::skewSymmetric(w), W2 = W * W;
+      const gtsam::Vector3 u = w.cross(v);
+      const double h = w.dot(v);
+      for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+          E_.R[3 * r + c] = (r == c ? 1.0 : 0.0) + sin_ * W(r, c) +
+                            (1.0 - cos_) * W2(r, c);
+      for (int r = 0; r < 3; ++r)
+        E_.t[r] = u(r) - E_.R[3 * r] * u(0) - E_.R[3 * r + 1] * u(1) -
+                  E_.R[3 * r + 2] * u(2) + theta_ * (w(r) * h);
+    }
+
+    // T = T * E, lane by lane.
+    for (int r = 0; r < 3; ++r) {
+      const Lanes &a0 = T_.R[3 * r], &a1 = T_.R[3 * r + 1],
+                  &a2 = T_.R[3 * r + 2];
+      t[r] = a0 * E_.t[0] + a1 * E_.t[1] + a2 * E_.t[2] + T_.t[r];
+      for (int c = 0; c < 3; ++c)
+        R[3 * r + c] = a0 * E_.R[c] + a1 * E_.R[3 + c] + a2 * E_.R[6 + c];
+    }
+    for (int k = 0; k < 9; ++k) T_.R[k].swap(R[k]);
+    for (int r = 0; r < 3; ++r) T_.t[r].swap(t[r]);
+
+    for (size_t l = 0; l < L; ++l) {
+      (*poses)[limbs_[l].link_ids[d]] = Pose3(
+          gtsam::Rot3(T_.R[0](l), T_.R[1](l), T_.R[2](l), T_.R[3](l),
+                      T_.R[4](l), T_.R[5](l), T_.R[6](l), T_.R[7](l),
+                      T_.R[8](l)),
+          gtsam::Point3(T_.t[0](l), T_.t[1](l), T_.t[2](l)));
+    }
+  }
+}
+
+/* ************************************************************************* */
+std::vector<LimbTemplate> FindLimbTemplates(const Robot &robot,
+                                            const std::string &base_link,
+                                            double tol) {
+  const CompiledRobot tree(robot);
+  const int base =
+      base_link.empty() ? 0 : tree.nodeOfLink()[robot.link(base_link)->id()];
+  const size_t N = tree.numNodes();
+  std::vector<std::vector<int>> children(N);
+  for (size_t n = 0; n < N; ++n)
+    if (tree.parentNodes()[n] >= 0)
+      children[tree.parentNodes()[n]].push_back(n);
+
+  // Serial chains from the children of the base.
+  std::vector<Limb> limbs;
+  for (const int first : children[base]) {
+    Limb limb;
+    limb.mount = tree.restPoses()[first];
+    int n = first;
+    while (true) {
+      limb.link_ids.push_back(tree.linkIds()[n]);
+      limb.joint_ids.push_back(tree.jointIds()[n]);
+      if (children[n].size() != 1) break;
+      n = children[n].front();
+    }
+    if (children[n].empty()) limbs.push_back(limb);
+  }
+  std::sort(limbs.begin(), limbs.end(), [](const Limb &a, const Limb &b) {
+    return a.link_ids.front() < b.link_ids.front();
+  });
+
+  // Group copies, in order of their first limb.
+  std::vector<std::vector<Limb>> groups;
+  for (auto &&limb : limbs) {
+    auto group = std::find_if(
+        groups.begin(), groups.end(), [&](const std::vector<Limb> &g) {
+          return Congruent(tree, g.front(), limb, tol);
+        });
+    if (group == groups.end())
+      groups.push_back({limb});
+    else
+      group->push_back(limb);
+  }
+  std::vector<LimbTemplate> templates;
+  for (auto &&group : groups)
+    templates.emplace_back(tree, tree.linkIds()[base], group);
+  return templates;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LimbTemplate.h
+ * @brief Identical limbs of a robot, e.g. legs, evaluated together.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/// A serial chain of links hanging off a base link, e.g. a leg.
+struct Limb {
+  std::vector<int> link_ids;   ///< links from the base outward
+  std::vector<int> joint_ids;  ///< joint of each link to the one before it
+  gtsam::Pose3 mount;  ///< pose of the first link in the base at zero angle
+};
+
+/**
+ * Limbs that are copies of each other: at every depth along the chain the
+ * links have the same inertia and mass, and the joints the same screw axis
+ * and the same rest pose relative to the link before, so they only differ in
+ * where they are mounted on the base. Their kernels, and the structure of
+ * their factors, can hence be shared, and they can be evaluated in lockstep:
+ * forwardKinematics runs all limbs of the template in one pass, with every
+ * operation on arrays over the limbs, i.e. with the limbs in SIMD lanes.
+ *
+ * Mirrored limbs, e.g. left and right legs with mirrored offsets, are not
+ * copies and end up in different templates.
+ */
+class LimbTemplate {
+ public:
+  /// Limbs as found by FindLimbTemplates; the first one sets the parameters.
+  LimbTemplate(const CompiledRobot &robot, int base_link_id,
+               const std::vector<Limb> &limbs);
+
+  /// Id of the base link the limbs are mounted on.
+  int baseLinkId() const { return base_link_id_; }
+
+  /// The limbs, in order of their first link id.
+  const std::vector<Limb> &limbs() const { return limbs_; }
+
+  /// Number of limbs.
+  size_t numLimbs() const { return limbs_.size(); }
+
+  /// Number of links in every limb.
+  size_t depth() const { return masses_.size(); }
+
+  /// Rest pose of the link at each depth in the link before, identity for
+  /// depth 0, which is at the mount of each limb.
+  const std::vector<gtsam::Pose3> &restPoses() const { return rest_poses_; }
+
+  /// 6 x depth, screw axis of the joint at each depth, in its link's frame.
+  const gtsam::Matrix &screwAxes() const { return screw_axes_; }
+
+  /// Spatial inertia of the link at each depth.
+  const CompiledRobot::Matrix6s &inertias() const { return inertias_; }
+
+  /// Mass of the link at each depth.
+  const gtsam::Vector &masses() const { return masses_; }
+
+  /**
+   * Forward kinematics of all limbs at once. Reads the pose of the base from
+   * `poses`, e.g. as set by CompiledRobot::forwardKinematics for the rest of
+   * the robot, and writes the poses of the limb links; the result is the same
+   * as that of CompiledRobot::forwardKinematics. Not thread-safe, as it uses
+   * buffers of the template.
+   *
+   * @param[in] q          joint angles, indexed by joint id
+   * @param[in,out] poses  link poses wTi, indexed by link id
+   */
+  void forwardKinematics(const gtsam::Vector &q,
+                         std::vector<gtsam::Pose3> *poses) const;
+
+ private:
+  // One value per limb, the SIMD lanes.
+  using Lanes = Eigen::Array<double, 1, Eigen::Dynamic>;
+
+  // Poses of all limbs, rotation entries R[3 * r + c] and translations t[r].
+  struct PoseLanes {
+    Lanes R[9], t[3];
+    void resize(size_t n);
+  };
+
+  int base_link_id_;
+  std::vector<Limb> limbs_;
+  std::vector<gtsam::Pose3> rest_poses_;
+  gtsam::Matrix screw_axes_;
+  CompiledRobot::Matrix6s inertias_;
+  gtsam::Vector masses_;
+
+  mutable PoseLanes T_, E_;  // poses so far, and of the joint motion
+  mutable Lanes theta_, cos_, sin_;
+};
+
+/**
+ * Find the limbs of a robot, as the serial chains that hang off a base link
+ * in the tree of CompiledRobot, and group the copies into templates. Every
+ * limb is in exactly one template, possibly by itself. Branches that are not
+ * serial chains, e.g. hands with fingers, are not limbs.
+ *
+ * @param robot      the robot, needs to have a tree structure
+ * @param base_link  name of the base link, the first root of the tree if
+ *                   empty
+ * @param tol        tolerance on the parameters of copies
+ * @return templates in order of their first link id
+ */
+std::vector<LimbTemplate> FindLimbTemplates(const Robot &robot,
+                                            const std::string &base_link = "",
+                                            double tol = 1e-9);
+
+}  // namespace gtdynamics
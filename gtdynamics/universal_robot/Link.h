@@ -49,7 +49,7 @@ LINK_TYPEDEF_CLASS_POINTER(Joint);
  */
 class Link : public boost::enable_shared_from_this<Link> {
  private:
-  uint8_t id_;
+  DynamicsIndex id_;
   std::string name_;
 
   /// Inertial elements.
@@ -57,6 +57,9 @@ class Link : public boost::enable_shared_from_this<Link> {
   gtsam::Pose3 centerOfMass_;
   gtsam::Matrix3 inertia_;
 
+  /// Spatial inertia, cached from the inertia and the mass.
+  gtsam::Matrix6 inertia_matrix_ = gtsam::Matrix6::Zero();
+
   /// SDF Elements.
   gtsam::Pose3 bMcom_;   // CoM frame defined in the base frame at rest.
   gtsam::Pose3 bMlink_;  // link frame defined in the base frame at rest.
@@ -87,7 +90,7 @@ class Link : public boost::enable_shared_from_this<Link> {
    * @param bMlink The pose of the link frame relative to the base frame.
    * @param is_fixed Flag indicating if the link is fixed.
    */
-  Link(uint8_t id, const std::string &name, const double mass,
+  Link(DynamicsIndex id, const std::string &name, const double mass,
        const gtsam::Matrix3 &inertia, const gtsam::Pose3 &bMcom,
        const gtsam::Pose3 &bMlink, bool is_fixed = false)
       : id_(id),
@@ -96,7 +99,9 @@ class Link : public boost::enable_shared_from_this<Link> {
         inertia_(inertia),
         bMcom_(bMcom),
         bMlink_(bMlink),
-        is_fixed_(is_fixed) {}
+        is_fixed_(is_fixed) {
+    updateInertiaMatrix();
+  }
 
   /** destructor */
   virtual ~Link() = default;
@@ -127,7 +132,7 @@ class Link : public boost::enable_shared_from_this<Link> {
   }
 
   /// return ID of the link
-  uint8_t id() const { return id_; }
+  DynamicsIndex id() const { return id_; }
 
   /// add joint to the link
   void addJoint(const JointSharedPtr &joint) { joints_.push_back(joint); }
@@ -164,11 +169,18 @@ class Link : public boost::enable_shared_from_this<Link> {
   const gtsam::Matrix3 &inertia() const { return inertia_; }
 
   /// Return general mass gtsam::Matrix
-  gtsam::Matrix6 inertiaMatrix() const {
-    std::vector<gtsam::Matrix> gmm;
-    gmm.push_back(inertia_);
-    gmm.push_back(gtsam::I_3x3 * mass_);
-    return gtsam::diag(gmm);
+  const gtsam::Matrix6 &inertiaMatrix() const { return inertia_matrix_; }
+
+  /**
+   * Return the gravity wrench in the CoM frame, m * (0, wRcom^T * gravity).
+   * @param gravity gravity vector in the world frame
+   * @param wRcom   rotation of the CoM frame
+   */
+  gtsam::Vector6 gravityWrench(const gtsam::Vector3 &gravity,
+                               const gtsam::Rot3 &wRcom) const {
+    gtsam::Vector6 wrench;
+    wrench << gtsam::Z_3x1, mass_ * wRcom.unrotate(gravity);
+    return wrench;
   }
 
   /// Functional way to fix a link
@@ -223,6 +235,13 @@ class Link : public boost::enable_shared_from_this<Link> {
   /// Unfix the link
   void unfix() { is_fixed_ = false; }
 
+  /// Recompute the spatial inertia from the inertia and the mass.
+  void updateInertiaMatrix() {
+    inertia_matrix_.setZero();
+    inertia_matrix_.topLeftCorner<3, 3>() = inertia_;
+    inertia_matrix_.bottomRightCorner<3, 3>() = mass_ * gtsam::I_3x3;
+  }
+
   /// @name Advanced Interface
   /// @{
 
@@ -239,6 +258,7 @@ class Link : public boost::enable_shared_from_this<Link> {
     ar &BOOST_SERIALIZATION_NVP(bMlink_);
     ar &BOOST_SERIALIZATION_NVP(is_fixed_);
     ar &BOOST_SERIALIZATION_NVP(fixed_pose_);
+    if (ARCHIVE::is_loading::value) updateInertiaMatrix();
   }
 
   /// @}
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <boost/make_shared.hpp>
+
 #include "gtdynamics/universal_robot/Joint.h"
 
 namespace gtdynamics {
@@ -52,7 +54,8 @@ class PrismaticJoint : public Joint {
    * @param[in] axis          joint axis expressed in joint frame
    * @param[in] parameters    JointParams struct
    */
-  PrismaticJoint(uint8_t id, const std::string &name, const gtsam::Pose3 &bTj,
+  PrismaticJoint(DynamicsIndex id, const std::string &name,
+                 const gtsam::Pose3 &bTj,
                  const LinkSharedPtr &parent_link,
                  const LinkSharedPtr &child_link, const gtsam::Vector3 &axis,
                  const JointParams &parameters = JointParams())
@@ -62,6 +65,11 @@ class PrismaticJoint : public Joint {
   /// Return joint type for use in reconstructing robot from JointParams.
   Type type() const final override { return Type::Prismatic; }
 
+  /// Return a copy of this joint, still connected to the same links.
+  JointSharedPtr clone() const final override {
+    return boost::make_shared<PrismaticJoint>(*this);
+  }
+
  private:
   /// @name Advanced Interface
   /// @{
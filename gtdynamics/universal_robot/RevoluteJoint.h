@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <boost/make_shared.hpp>
+
 #include "gtdynamics/universal_robot/Joint.h"
 
 namespace gtdynamics {
@@ -51,7 +53,8 @@ class RevoluteJoint : public Joint {
    * @param[in] axis          joint axis expressed in joint frame
    * @param[in] parameters    JointParams struct
    */
-  RevoluteJoint(uint8_t id, const std::string &name, const gtsam::Pose3 &bTj,
+  RevoluteJoint(DynamicsIndex id, const std::string &name,
+                const gtsam::Pose3 &bTj,
                 const LinkSharedPtr &parent_link,
                 const LinkSharedPtr &child_link, const gtsam::Vector3 &axis,
                 const JointParams &parameters = JointParams())
@@ -61,6 +64,11 @@ class RevoluteJoint : public Joint {
   /// Return joint type for use in reconstructing robot from JointParams.
   Type type() const final override { return Type::Revolute; }
 
+  /// Return a copy of this joint, still connected to the same links.
+  JointSharedPtr clone() const final override {
+    return boost::make_shared<RevoluteJoint>(*this);
+  }
+
  private:
   /// @name Advanced Interface
   /// @{
@@ -13,14 +13,18 @@
 
 #include "gtdynamics/universal_robot/Robot.h"
 
+#include <boost/make_shared.hpp>
+
 #include <algorithm>
 #include <memory>
 #include <queue>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 
 #include "gtdynamics/universal_robot/Joint.h"
 #include "gtdynamics/universal_robot/RobotTypes.h"
+#include "gtdynamics/utils/Trace.h"
 #include "gtdynamics/utils/utils.h"
 #include "gtdynamics/utils/values.h"
 
@@ -40,7 +44,30 @@ std::vector<V> getValues(std::map<K, V> m) {
 }
 
 Robot::Robot(const LinkMap &links, const JointMap &joints)
-    : name_to_link_(links), name_to_joint_(joints) {}
+    : name_to_link_(links), name_to_joint_(joints) {
+  buildIndex();
+}
+
+// Fill a dense id-indexed array and a name to id hash from a map.
+template <typename T>
+static void IndexById(const std::map<std::string, boost::shared_ptr<T>> &m,
+                      std::vector<boost::shared_ptr<T>> *by_id,
+                      std::unordered_map<std::string, DynamicsIndex> *ids) {
+  by_id->clear();
+  ids->clear();
+  ids->reserve(m.size());
+  for (auto &&kv : m) {
+    const DynamicsIndex id = kv.second->id();
+    if (by_id->size() <= id) by_id->resize(id + 1);
+    (*by_id)[id] = kv.second;
+    ids->emplace(kv.first, id);
+  }
+}
+
+void Robot::buildIndex() {
+  IndexById(name_to_link_, &id_to_link_, &link_ids_);
+  IndexById(name_to_joint_, &id_to_joint_, &joint_ids_);
+}
 
 std::vector<LinkSharedPtr> Robot::links() const {
   return getValues<std::string, LinkSharedPtr>(name_to_link_);
@@ -59,6 +86,15 @@ void Robot::removeLink(const LinkSharedPtr &link) {
 
   // remove link from name_to_link_
   name_to_link_.erase(link->name());
+
+  // and the frames attached to it
+  for (auto it = frames_.begin(); it != frames_.end();) {
+    if (it->second.link == link->name())
+      it = frames_.erase(it);
+    else
+      ++it;
+  }
+  buildIndex();
 }
 
 void Robot::removeJoint(const JointSharedPtr &joint) {
@@ -68,40 +104,139 @@ void Robot::removeJoint(const JointSharedPtr &joint) {
   }
   // Remove the joint from name_to_joint_
   name_to_joint_.erase(joint->name());
+  buildIndex();
 }
 
 LinkSharedPtr Robot::link(const std::string &name) const {
-  if (name_to_link_.find(name) == name_to_link_.end()) {
+  return id_to_link_[linkId(name)];
+}
+
+LinkSharedPtr Robot::link(DynamicsIndex id) const {
+  if (id >= id_to_link_.size() || !id_to_link_[id]) {
+    throw std::runtime_error("no link with id " + std::to_string(id));
+  }
+  return id_to_link_[id];
+}
+
+DynamicsIndex Robot::linkId(const std::string &name) const {
+  auto it = link_ids_.find(name);
+  if (it == link_ids_.end()) {
     throw std::runtime_error("no link named " + name);
   }
-  return name_to_link_.at(name);
+  return it->second;
 }
 
-Robot Robot::fixLink(const std::string &name) {
+Robot Robot::deepCopy() const {
+  // Links and joints point to each other, so copy them all and rewire the
+  // copies through maps from the originals.
+  std::map<const Link *, LinkSharedPtr> new_links;
+  std::map<const Joint *, JointSharedPtr> new_joints;
+  Robot copy;
+  for (auto &&kv : name_to_link_) {
+    auto link = boost::make_shared<Link>(*kv.second);
+    link->joints_.clear();
+    new_links[kv.second.get()] = link;
+    copy.name_to_link_.emplace(kv.first, link);
+  }
+  for (auto &&kv : name_to_joint_) {
+    JointSharedPtr joint = kv.second->clone();
+    joint->parent_link_ = new_links.at(kv.second->parent_link_.get());
+    joint->child_link_ = new_links.at(kv.second->child_link_.get());
+    new_joints[kv.second.get()] = joint;
+    copy.name_to_joint_.emplace(kv.first, joint);
+  }
+  // Keep the order of the joints of each link, which sets the traversal
+  // order of forward kinematics.
+  for (auto &&kv : name_to_link_) {
+    auto &joints = copy.name_to_link_.at(kv.first)->joints_;
+    for (auto &&joint : kv.second->joints_)
+      joints.push_back(new_joints.at(joint.get()));
+  }
+  copy.frames_ = frames_;
+  copy.buildIndex();
+  return copy;
+}
+
+Robot Robot::fixLink(const std::string &name) const {
   if (name_to_link_.find(name) == name_to_link_.end()) {
     throw std::runtime_error("no link named " + name);
   }
 
-  Robot fixed_robot = Robot(*this);
+  Robot fixed_robot = deepCopy();
   fixed_robot.name_to_link_.at(name)->fix();
   return fixed_robot;
 }
 
-Robot Robot::unfixLink(const std::string &name) {
+Robot Robot::unfixLink(const std::string &name) const {
   if (name_to_link_.find(name) == name_to_link_.end()) {
     throw std::runtime_error("no link named " + name);
   }
 
-  Robot unfixed_robot = Robot(*this);
+  Robot unfixed_robot = deepCopy();
   unfixed_robot.name_to_link_.at(name)->unfix();
   return unfixed_robot;
 }
 
-JointSharedPtr Robot::joint(const std::string &name) const {
+Robot Robot::withJointParameters(const std::string &name,
+                                 const JointParams &parameters) const {
+  if (name_to_joint_.find(name) == name_to_joint_.end()) {
+    throw std::runtime_error("no joint named " + name);
+  }
+
+  Robot robot = deepCopy();
+  robot.name_to_joint_.at(name)->parameters_ = parameters;
+  return robot;
+}
+
+Robot Robot::withoutJoint(const std::string &name) const {
   if (name_to_joint_.find(name) == name_to_joint_.end()) {
     throw std::runtime_error("no joint named " + name);
   }
-  return name_to_joint_.at(name);
+
+  Robot robot = deepCopy();
+  robot.removeJoint(robot.name_to_joint_.at(name));
+  return robot;
+}
+
+JointSharedPtr Robot::joint(const std::string &name) const {
+  return id_to_joint_[jointId(name)];
+}
+
+JointSharedPtr Robot::joint(DynamicsIndex id) const {
+  if (id >= id_to_joint_.size() || !id_to_joint_[id]) {
+    throw std::runtime_error("no joint with id " + std::to_string(id));
+  }
+  return id_to_joint_[id];
+}
+
+DynamicsIndex Robot::jointId(const std::string &name) const {
+  auto it = joint_ids_.find(name);
+  if (it == joint_ids_.end()) {
+    throw std::runtime_error("no joint named " + name);
+  }
+  return it->second;
+}
+
+void Robot::addFrame(const std::string &name, const std::string &link_name,
+                     const gtsam::Pose3 &comTf) {
+  if (name_to_link_.find(link_name) == name_to_link_.end()) {
+    throw std::runtime_error("no link named " + link_name);
+  }
+  frames_[name] = RobotFrame{link_name, comTf};
+}
+
+const RobotFrame &Robot::frame(const std::string &name) const {
+  auto it = frames_.find(name);
+  if (it == frames_.end()) {
+    throw std::runtime_error("no frame named " + name);
+  }
+  return it->second;
+}
+
+gtsam::Pose3 Robot::framePose(const gtsam::Values &values,
+                              const std::string &name, size_t t) const {
+  const RobotFrame &f = frame(name);
+  return Pose(values, linkId(f.link), t) * f.comTf;
 }
 
 int Robot::numLinks() const { return name_to_link_.size(); }
@@ -228,6 +363,7 @@ static bool InsertWithCheck(size_t i, size_t t,
 gtsam::Values Robot::forwardKinematics(
     const gtsam::Values &known_values, size_t t,
     const boost::optional<std::string> &prior_link_name) const {
+  GTD_TRACE_SCOPE("Robot::forwardKinematics");
   gtsam::Values values = known_values;
 
   // Set root link.
@@ -16,6 +16,7 @@
 #include <boost/optional.hpp>
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -42,6 +43,29 @@ using LinkTwists = std::map<std::string, gtsam::Vector6>;
 // type for storing forward kinematics results
 using FKResults = std::pair<LinkPoses, LinkTwists>;
 
+/**
+ * A named frame rigidly attached to a link, e.g. a sensor frame or a link
+ * merged into its parent by a fixed joint: the name of the link and the pose
+ * of the frame in the CoM frame of that link.
+ */
+struct RobotFrame {
+  std::string link;
+  gtsam::Pose3 comTf;
+
+  bool operator==(const RobotFrame &other) const {
+    return link == other.link && comTf.equals(other.comTf);
+  }
+
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &BOOST_SERIALIZATION_NVP(link);
+    ar &BOOST_SERIALIZATION_NVP(comTf);
+  }
+};
+
+/// Map from frame name to frame
+using FrameMap = std::map<std::string, RobotFrame>;
+
 /**
  * Robot is used to create a representation of a robot's
  * inertial/dynamic properties from a URDF/SDF file. The resulting object
@@ -54,6 +78,15 @@ class Robot {
   LinkMap name_to_link_;
   JointMap name_to_joint_;
 
+  // Links and joints indexed by id, null for unused ids, and hashes from
+  // names to ids, rebuilt whenever the maps above change.
+  std::vector<LinkSharedPtr> id_to_link_;
+  std::vector<JointSharedPtr> id_to_joint_;
+  std::unordered_map<std::string, DynamicsIndex> link_ids_, joint_ids_;
+
+  // Named frames attached to links, by frame name.
+  FrameMap frames_;
+
  public:
   /** Default Constructor */
   Robot() {}
@@ -82,27 +115,85 @@ class Robot {
   /// Return the link corresponding to the input string.
   LinkSharedPtr link(const std::string &name) const;
 
+  /// Return the link with the given id, in constant time.
+  LinkSharedPtr link(DynamicsIndex id) const;
+
+  /// Return the id of the link corresponding to the input string.
+  DynamicsIndex linkId(const std::string &name) const;
+
   /**
    * @brief Return a copy of this robot with the link corresponding to the input
-   * string as a fixed link.
+   * string as a fixed link. This robot is left unchanged.
    *
    * @param name The name of the link to fix.
    * @return Robot
    */
-  Robot fixLink(const std::string &name);
+  Robot fixLink(const std::string &name) const;
 
   /**
    * @brief Return a copy of this robot after unfixing the link corresponding to
-   * the input string.
+   * the input string. This robot is left unchanged.
    *
    * @param name The name of the link to unfix.
    * @return Robot
    */
-  Robot unfixLink(const std::string &name);
+  Robot unfixLink(const std::string &name) const;
+
+  /**
+   * @brief Return a copy of this robot in which the joint corresponding to the
+   * input string has other parameters, e.g. joint limits. This robot is left
+   * unchanged.
+   *
+   * @param name The name of the joint.
+   * @param parameters The new parameters of the joint.
+   * @return Robot
+   */
+  Robot withJointParameters(const std::string &name,
+                            const JointParams &parameters) const;
+
+  /**
+   * @brief Return a copy of this robot without the joint corresponding to the
+   * input string, e.g. to cut a closed kinematic loop. This robot is left
+   * unchanged.
+   *
+   * @param name The name of the joint to remove.
+   * @return Robot
+   */
+  Robot withoutJoint(const std::string &name) const;
 
   /// Return the joint corresponding to the input string.
   JointSharedPtr joint(const std::string &name) const;
 
+  /**
+   * Attach a named frame to a link, replacing any frame with that name.
+   * @param name       name of the frame
+   * @param link_name  name of the link the frame moves with
+   * @param comTf      pose of the frame in the CoM frame of the link
+   */
+  void addFrame(const std::string &name, const std::string &link_name,
+                const gtsam::Pose3 &comTf);
+
+  /// Whether a frame with the given name is attached to a link.
+  bool hasFrame(const std::string &name) const {
+    return frames_.count(name) > 0;
+  }
+
+  /// Return the frame corresponding to the input string.
+  const RobotFrame &frame(const std::string &name) const;
+
+  /// Return all named frames.
+  const FrameMap &frames() const { return frames_; }
+
+  /// Pose of a named frame in the world, from the link poses in `values`.
+  gtsam::Pose3 framePose(const gtsam::Values &values, const std::string &name,
+                         size_t t = 0) const;
+
+  /// Return the joint with the given id, in constant time.
+  JointSharedPtr joint(DynamicsIndex id) const;
+
+  /// Return the id of the joint corresponding to the input string.
+  DynamicsIndex jointId(const std::string &name) const;
+
   /// Return number of *moving* links.
   int numLinks() const;
 
@@ -132,7 +223,8 @@ class Robot {
                        other.name_to_link_.begin(), link_comparator) &&
             this->name_to_joint_.size() == other.name_to_joint_.size() &&
             std::equal(this->name_to_joint_.begin(), this->name_to_joint_.end(),
-                       other.name_to_joint_.begin(), joint_comparator));
+                       other.name_to_joint_.begin(), joint_comparator) &&
+            this->frames_ == other.frames_);
   }
 
   bool equals(const Robot &other, double tol = 0) const {
@@ -159,6 +251,13 @@ class Robot {
       const boost::optional<std::string> &prior_link_name = boost::none) const;
 
  private:
+  /// Copy of the robot with its own links and joints, connected as in this
+  /// robot, so that variants of the robot never share mutable state.
+  Robot deepCopy() const;
+
+  /// Rebuild the id-indexed arrays and the name hashes from the maps.
+  void buildIndex();
+
   /// Find root link for forward kinematics
   LinkSharedPtr findRootLink(
       const gtsam::Values &values,
@@ -173,6 +272,8 @@ class Robot {
   void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
     ar &BOOST_SERIALIZATION_NVP(name_to_link_);
     ar &BOOST_SERIALIZATION_NVP(name_to_joint_);
+    ar &BOOST_SERIALIZATION_NVP(frames_);
+    if (ARCHIVE::is_loading::value) buildIndex();
   }
 
   /// @}
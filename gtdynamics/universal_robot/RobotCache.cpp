@@ -0,0 +1,161 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotCache.cpp
+ * @brief Binary cache of robots parsed from URDF/SDF files.
+ */
+
+#include "gtdynamics/universal_robot/RobotCache.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/vector.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/universal_robot/HelicalJoint.h"
+#include "gtdynamics/universal_robot/Link.h"
+#include "gtdynamics/universal_robot/PrismaticJoint.h"
+#include "gtdynamics/universal_robot/RevoluteJoint.h"
+
+namespace gtdynamics {
+
+namespace fs = boost::filesystem;
+
+// Bump when the serialized layout of Robot, Link or Joint changes, so that
+// stale cache files are not read.
+static constexpr int kRobotCacheFormat = 2;
+
+// Register the joint types with the archive, in the same order for saving and
+// loading, rather than relying on BOOST_CLASS_EXPORT in client code.
+template <class ARCHIVE>
+static void RegisterJointTypes(ARCHIVE &ar) {
+  ar.template register_type<RevoluteJoint>();
+  ar.template register_type<PrismaticJoint>();
+  ar.template register_type<HelicalJoint>();
+}
+
+// Write the archive of `robot` to a stream.
+static void WriteRobot(const Robot &robot, std::ostream &os) {
+  // Links do not serialize their joints, so store the joint names of each
+  // link, in order, to restore them on loading.
+  std::vector<std::vector<std::string>> link_joints;
+  for (auto &&link : robot.links()) {
+    std::vector<std::string> names;
+    for (auto &&joint : link->joints()) names.push_back(joint->name());
+    link_joints.push_back(names);
+  }
+  boost::archive::binary_oarchive ar(os);
+  RegisterJointTypes(ar);
+  ar << robot << link_joints;
+}
+
+// Read an archive written by WriteRobot, throwing `corrupt` if it is.
+static Robot ReadRobot(std::istream &is, const std::string &corrupt) {
+  boost::archive::binary_iarchive ar(is);
+  RegisterJointTypes(ar);
+  Robot robot;
+  std::vector<std::vector<std::string>> link_joints;
+  ar >> robot >> link_joints;
+
+  const auto links = robot.links();
+  if (links.size() != link_joints.size())
+    throw std::runtime_error(corrupt);
+  for (size_t i = 0; i < links.size(); i++) {
+    for (auto &&name : link_joints[i]) links[i]->addJoint(robot.joint(name));
+  }
+  return robot;
+}
+
+/* ************************************************************************* */
+void SaveRobotBinary(const Robot &robot, const std::string &path) {
+  const std::string tmp_path =
+      fs::unique_path(path + ".%%%%-%%%%-%%%%").string();
+  {
+    std::ofstream os(tmp_path, std::ios::binary);
+    if (!os.good())
+      throw std::runtime_error("SaveRobotBinary: cannot write " + tmp_path);
+    WriteRobot(robot, os);
+  }
+  fs::rename(tmp_path, path);
+}
+
+/* ************************************************************************* */
+Robot LoadRobotBinary(const std::string &path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.good())
+    throw std::runtime_error("LoadRobotBinary: no file found at " + path);
+  return ReadRobot(is, "LoadRobotBinary: corrupt file " + path);
+}
+
+/* ************************************************************************* */
+std::string EncodeRobot(const Robot &robot) {
+  std::ostringstream os(std::ios::binary);
+  WriteRobot(robot, os);
+  return os.str();
+}
+
+/* ************************************************************************* */
+Robot DecodeRobot(const std::string &buffer) {
+  std::istringstream is(buffer, std::ios::binary);
+  try {
+    return ReadRobot(is, "DecodeRobot: corrupt buffer");
+  } catch (const boost::archive::archive_exception &e) {
+    throw std::runtime_error(std::string("DecodeRobot: ") + e.what());
+  }
+}
+
+/* ************************************************************************* */
+std::string RobotCacheDirectory() {
+  if (const char *dir = std::getenv("GTDYNAMICS_ROBOT_CACHE"))
+    return std::string(dir);
+  return (fs::temp_directory_path() / "gtdynamics_robot_cache").string();
+}
+
+/* ************************************************************************* */
+std::string RobotCachePath(const std::string &file_path,
+                           const std::string &model_name) {
+  const std::string directory = RobotCacheDirectory();
+  if (directory.empty()) return "";
+
+  std::ifstream is(file_path, std::ios::binary);
+  if (!is.good()) return "";
+  const std::string contents((std::istreambuf_iterator<char>(is)),
+                             std::istreambuf_iterator<char>());
+
+  // 64-bit FNV-1a over the contents, the model name and the format.
+  uint64_t hash = 14695981039346656037ULL;
+  const auto update = [&hash](const std::string &bytes) {
+    for (unsigned char c : bytes) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+    }
+  };
+  update(contents);
+  update('\0' + model_name);
+  update(std::to_string(kRobotCacheFormat));
+
+  boost::system::error_code error;
+  fs::create_directories(directory, error);
+  if (error) return "";
+
+  std::ostringstream name;
+  name << std::hex << hash << ".bin";
+  return (fs::path(directory) / name.str()).string();
+}
+
+}  // namespace gtdynamics
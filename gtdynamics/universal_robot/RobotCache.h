@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotCache.h
+ * @brief Binary cache of robots parsed from URDF/SDF files.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * Save `robot` to `path` as a Boost binary archive. The file is written next
+ * to `path` first and then renamed, so concurrent readers never see a partial
+ * file. Binary archives are not portable between platforms or Boost versions,
+ * which is fine for a local cache.
+ */
+void SaveRobotBinary(const Robot &robot, const std::string &path);
+
+/// Load a robot saved by SaveRobotBinary; throws if the file is unreadable.
+Robot LoadRobotBinary(const std::string &path);
+
+/**
+ * Encode `robot` in memory, as the binary archive of SaveRobotBinary, e.g.
+ * to pickle it for worker processes on the same machine.
+ */
+std::string EncodeRobot(const Robot &robot);
+
+/// Decode a buffer written by EncodeRobot, throws std::runtime_error if bad.
+Robot DecodeRobot(const std::string &buffer);
+
+/**
+ * Directory of the robot cache used by CreateRobotFromFile: the value of the
+ * environment variable GTDYNAMICS_ROBOT_CACHE if set, else
+ * "gtdynamics_robot_cache" in the system temporary directory. Setting the
+ * variable to an empty string disables the cache, and an empty string is
+ * returned.
+ */
+std::string RobotCacheDirectory();
+
+/**
+ * Cache file for a model, keyed by a hash of the contents of `file_path`, the
+ * model name and the cache format. Files included by `file_path` are not part
+ * of the key. Returns an empty string if the cache is disabled or the file
+ * cannot be read.
+ */
+std::string RobotCachePath(const std::string &file_path,
+                           const std::string &model_name);
+
+}  // namespace gtdynamics
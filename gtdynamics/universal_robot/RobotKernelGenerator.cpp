@@ -0,0 +1,332 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotKernelGenerator.cpp
+ * @brief Generate C++ kinematics and dynamics kernels specialized to a robot.
+ */
+
+#include "gtdynamics/universal_robot/RobotKernelGenerator.h"
+
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+namespace {
+// Literals that round-trip the doubles exactly.
+std::string Literal(double x) {
+  std::ostringstream os;
+  os << std::setprecision(17) << x;
+  std::string s = os.str();
+  if (s.find_first_of(".eEn") == std::string::npos) s += ".0";
+  return s;
+}
+
+template <typename MATRIX>
+std::string Entries(const MATRIX &M) {
+  std::string s;
+  for (int r = 0; r < M.rows(); ++r) {
+    for (int c = 0; c < M.cols(); ++c) {
+      if (!s.empty()) s += ", ";
+      s += Literal(M(r, c));
+    }
+  }
+  return s;
+}
+
+std::string Vector6Literal(const gtsam::Vector6 &v) {
+  return "(gtsam::Vector6() << " + Entries(v) + ").finished()";
+}
+
+std::string Matrix6Literal(const gtsam::Matrix6 &M) {
+  return "(gtsam::Matrix6() << " + Entries(M) + ").finished()";
+}
+
+std::string PoseLiteral(const Pose3 &T) {
+  return "gtsam::Pose3(gtsam::Rot3(" + Entries(T.rotation().matrix()) +
+         "), gtsam::Point3(" + Entries(T.translation()) + "))";
+}
+
+bool IsIdentifier(const std::string &name) {
+  if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+    return false;
+  for (const char c : name)
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') return false;
+  return true;
+}
+
+// Writes the unrolled kernels of one robot; node n's variables end in n.
+class Writer {
+ public:
+  Writer(const Robot &robot, const CompiledRobot &tree,
+         const boost::optional<gtsam::Vector3> &gravity)
+      : robot_(robot), tree_(tree), gravity_(gravity) {}
+
+  void header(const std::string &name) {
+    os_ << "// Kernels of robot " << name
+        << ", written by GenerateRobotKernels; do not edit.\n"
+        << "#pragma once\n\n"
+        << "#include <gtsam/base/Matrix.h>\n"
+        << "#include <gtsam/base/Vector.h>\n"
+        << "#include <gtsam/geometry/Pose3.h>\n\n"
+        << "#include <stdexcept>\n#include <vector>\n\n"
+        << "namespace gtdynamics {\nnamespace generated {\nnamespace " << name
+        << " {\n\n"
+        << "constexpr int kNumLinkSlots = " << tree_.numLinkSlots() << ";\n"
+        << "constexpr int kNumJointSlots = " << tree_.numJointSlots()
+        << ";\n\n";
+  }
+
+  void forwardKinematics() {
+    os_ << "/// Link poses wTi, indexed by link id, from joint angles q.\n"
+        << "inline void ForwardKinematics(const gtsam::Vector &q,\n"
+        << "                              std::vector<gtsam::Pose3> *poses) "
+           "{\n"
+        << "  poses->resize(kNumLinkSlots);\n"
+        << "  std::vector<gtsam::Pose3> &T = *poses;\n";
+    for (size_t n = 0; n < tree_.numNodes(); ++n) {
+      const int i = tree_.linkIds()[n];
+      comment(n);
+      if (isRoot(n)) {
+        os_ << "  T[" << i << "] = " << PoseLiteral(tree_.fixedPoses()[i])
+            << ";\n";
+      } else {
+        os_ << "  T[" << i << "] = T[" << parentLink(n) << "] * "
+            << relativePose(n) << ";\n";
+      }
+    }
+    os_ << "}\n\n";
+  }
+
+  void bodyJacobian() {
+    os_ << "/// Body Jacobian of a link, 6 x kNumJointSlots, from the poses "
+           "of\n/// ForwardKinematics.\n"
+        << "inline void BodyJacobian(const std::vector<gtsam::Pose3> &poses, "
+           "int link_id,\n"
+        << "                         gtsam::Matrix *J) {\n"
+        << "  J->setZero(6, kNumJointSlots);\n"
+        << "  switch (link_id) {\n";
+    for (size_t n = 0; n < tree_.numNodes(); ++n) {
+      const int i = tree_.linkIds()[n];
+      os_ << "    case " << i << ": {  // " << tree_.links()[n]->name()
+          << "\n";
+      if (!isRoot(n))
+        os_ << "      const gtsam::Pose3 iTw = poses[" << i
+            << "].inverse();\n";
+      for (int k = n; !isRoot(k); k = tree_.parentNodes()[k]) {
+        os_ << "      J->col(" << tree_.jointIds()[k] << ") = ";
+        if (k == int(n)) {
+          os_ << screw(k) << ";\n";
+        } else {
+          os_ << "(iTw * poses[" << tree_.linkIds()[k]
+              << "]).AdjointMap() *\n          " << screw(k) << ";\n";
+        }
+      }
+      os_ << "      return;\n    }\n";
+    }
+    os_ << "    default:\n"
+        << "      throw std::invalid_argument(\"BodyJacobian: no such "
+           "link.\");\n"
+        << "  }\n}\n\n";
+  }
+
+  void inverseDynamics() {
+    os_ << "/// Joint torques for joint angles q, velocities v and "
+           "accelerations a, by\n/// recursive Newton-Euler.\n"
+        << "inline void InverseDynamics(const gtsam::Vector &q, "
+           "const gtsam::Vector &v,\n"
+        << "                            const gtsam::Vector &a, "
+           "gtsam::Vector *tau) {\n"
+        << "  tau->setZero(kNumJointSlots);\n";
+    for (size_t n = 0; n < tree_.numNodes(); ++n) {
+      comment(n);
+      kinematics(n);
+      if (isRoot(n)) {
+        os_ << "  const gtsam::Vector6 A" << n << " = gtsam::Z_6x1;\n";
+        continue;
+      }
+      const int j = tree_.jointIds()[n];
+      os_ << "  const gtsam::Vector6 A" << n << " = X" << n << " * A"
+          << tree_.parentNodes()[n] << " + S" << n << " * a(" << j
+          << ") +\n      gtsam::Pose3::adjointMap(V" << n << ") * S" << n
+          << " * v(" << j << ");\n";
+      os_ << "  gtsam::Vector6 F" << n << " = " << inertia(n) << " * A" << n
+          << " + p" << n << ";\n";
+    }
+    os_ << "  // Inward pass.\n";
+    for (size_t n = tree_.numNodes(); n-- > 0;) {
+      if (isRoot(n)) continue;
+      os_ << "  (*tau)(" << tree_.jointIds()[n] << ") = S" << n << ".dot(F"
+          << n << ");\n";
+      const int parent = tree_.parentNodes()[n];
+      if (!isRoot(parent))
+        os_ << "  F" << parent << " += X" << n << ".transpose() * F" << n
+            << ";\n";
+    }
+    os_ << "}\n\n";
+  }
+
+  void forwardDynamics() {
+    os_ << "/// Joint accelerations for joint angles q, velocities v and "
+           "torques tau, by\n/// the articulated-body algorithm.\n"
+        << "inline void ForwardDynamics(const gtsam::Vector &q, "
+           "const gtsam::Vector &v,\n"
+        << "                            const gtsam::Vector &tau, "
+           "gtsam::Vector *a) {\n"
+        << "  a->setZero(kNumJointSlots);\n";
+    for (size_t n = 0; n < tree_.numNodes(); ++n) {
+      comment(n);
+      kinematics(n);
+      if (isRoot(n)) continue;
+      os_ << "  const gtsam::Vector6 c" << n << " = gtsam::Pose3::adjointMap(V"
+          << n << ") * S" << n << " * v(" << tree_.jointIds()[n] << ");\n";
+      os_ << "  gtsam::Matrix6 I" << n << " = " << inertia(n) << ";\n";
+    }
+    os_ << "  // Inward pass: articulated inertias and bias wrenches.\n";
+    for (size_t n = tree_.numNodes(); n-- > 0;) {
+      if (isRoot(n)) continue;
+      const int j = tree_.jointIds()[n];
+      os_ << "  const gtsam::Vector6 U" << n << " = I" << n << " * S" << n
+          << ";\n"
+          << "  const double D" << n << " = S" << n << ".dot(U" << n << ");\n"
+          << "  const double u" << n << " = tau(" << j << ") - U" << n
+          << ".dot(c" << n << ") - S" << n << ".dot(p" << n << ");\n";
+      const int parent = tree_.parentNodes()[n];
+      if (isRoot(parent)) continue;
+      os_ << "  {\n"
+          << "    const gtsam::Matrix6 Ia = I" << n << " - U" << n << " * U"
+          << n << ".transpose() / D" << n << ";\n"
+          << "    I" << parent << " += X" << n << ".transpose() * Ia * X" << n
+          << ";\n"
+          << "    p" << parent << " += X" << n << ".transpose() * (p" << n
+          << " + Ia * c" << n << " + U" << n << " * (u" << n << " / D" << n
+          << "));\n"
+          << "  }\n";
+    }
+    os_ << "  // Outward pass: accelerations.\n";
+    for (size_t n = 0; n < tree_.numNodes(); ++n) {
+      if (isRoot(n)) {
+        os_ << "  const gtsam::Vector6 A" << n << " = gtsam::Z_6x1;\n";
+        continue;
+      }
+      const int j = tree_.jointIds()[n];
+      os_ << "  const gtsam::Vector6 XA" << n << " = X" << n << " * A"
+          << tree_.parentNodes()[n] << ";\n"
+          << "  (*a)(" << j << ") = (u" << n << " - U" << n << ".dot(XA" << n
+          << ")) / D" << n << ";\n"
+          << "  const gtsam::Vector6 A" << n << " = XA" << n << " + S" << n
+          << " * (*a)(" << j << ") + c" << n << ";\n";
+    }
+    os_ << "}\n\n";
+  }
+
+  void footer(const std::string &name) {
+    os_ << "}  // namespace " << name
+        << "\n}  // namespace generated\n}  // namespace gtdynamics\n";
+  }
+
+  std::string str() const { return os_.str(); }
+
+ private:
+  const Robot &robot_;
+  const CompiledRobot &tree_;
+  const boost::optional<gtsam::Vector3> &gravity_;
+  std::ostringstream os_;
+
+  bool isRoot(int n) const { return tree_.parentNodes()[n] < 0; }
+  int parentLink(int n) const {
+    return tree_.linkIds()[tree_.parentNodes()[n]];
+  }
+  std::string screw(int n) const {
+    return Vector6Literal(tree_.screwAxes().col(n));
+  }
+  std::string inertia(int n) const {
+    return Matrix6Literal(tree_.inertias()[tree_.linkIds()[n]]);
+  }
+  std::string relativePose(int n) const {
+    return "(" + PoseLiteral(tree_.restPoses()[n]) +
+           " *\n      gtsam::Pose3::Expmap(" +
+           screw(n) + " * q(" +
+           std::to_string(tree_.jointIds()[n]) + ")))";
+  }
+
+  void comment(int n) {
+    const int i = tree_.linkIds()[n];
+    os_ << "  // Link " << tree_.links()[n]->name();
+    if (!isRoot(n))
+      os_ << ", joint " << robot_.joint(tree_.jointIds()[n])->name();
+    os_ << ".\n";
+  }
+
+  // Twist V and bias wrench p of node n, its pose wT if there is gravity,
+  // and for non-roots the screw axis S and the adjoint X of the pose in the
+  // parent.
+  void kinematics(int n) {
+    const int i = tree_.linkIds()[n];
+    if (isRoot(n)) {
+      if (gravity_)
+        os_ << "  const gtsam::Pose3 wT" << n << " = "
+            << PoseLiteral(tree_.fixedPoses()[i]) << ";\n";
+      os_ << "  const gtsam::Vector6 V" << n << " = gtsam::Z_6x1;\n";
+      return;
+    }
+    const int parent = tree_.parentNodes()[n];
+    const int j = tree_.jointIds()[n];
+    os_ << "  const gtsam::Vector6 S" << n << " = " << screw(n) << ";\n"
+        << "  const gtsam::Pose3 pT" << n << " = "
+        << PoseLiteral(tree_.restPoses()[n])
+        << " *\n      gtsam::Pose3::Expmap(S" << n << " * q(" << j << "));\n";
+    if (gravity_)
+      os_ << "  const gtsam::Pose3 wT" << n << " = wT" << parent << " * pT"
+          << n << ";\n";
+    os_ << "  const gtsam::Matrix6 X" << n << " = pT" << n
+        << ".inverse().AdjointMap();\n"
+        << "  const gtsam::Vector6 V" << n << " = X" << n << " * V" << parent
+        << " + S" << n << " * v(" << j << ");\n";
+    // Bias wrench, as in RecursiveDynamics: -ad(V)^T G V - m R^T g.
+    os_ << "  gtsam::Vector6 p" << n << " = -gtsam::Pose3::adjointMap(V" << n
+        << ").transpose() *\n      (" << inertia(n) << " * V" << n << ");\n";
+    if (gravity_) {
+      const gtsam::Vector3 mg = (*gravity_) * tree_.masses()(i);
+      os_ << "  p" << n << ".tail<3>() -= wT" << n
+          << ".rotation().transpose() * gtsam::Vector3(" << Entries(mg)
+          << ");\n";
+    }
+  }
+};
+}  // namespace
+
+/* ************************************************************************* */
+std::string GenerateRobotKernels(
+    const Robot &robot, const std::string &name,
+    const boost::optional<gtsam::Vector3> &gravity) {
+  if (!IsIdentifier(name))
+    throw std::invalid_argument("GenerateRobotKernels: \"" + name +
+                                "\" is not a C++ identifier.");
+  const CompiledRobot tree(robot);
+  if (tree.hasFloatingRoot())
+    throw std::invalid_argument(
+        "GenerateRobotKernels: only robots with a fixed base are supported.");
+
+  Writer writer(robot, tree, gravity);
+  writer.header(name);
+  writer.forwardKinematics();
+  writer.bodyJacobian();
+  writer.inverseDynamics();
+  writer.forwardDynamics();
+  writer.footer(name);
+  return writer.str();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  RobotKernelGenerator.h
+ * @brief Generate C++ kinematics and dynamics kernels specialized to a robot.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+
+#include <boost/optional.hpp>
+#include <string>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * Generate a self-contained C++ header with kernels specialized to `robot`,
+ * for robots whose structure is fixed at build time. The traversal of
+ * CompiledRobot is unrolled: every link and joint becomes straight-line code
+ * with its rest pose, screw axis, inertia and mass written as literals, so
+ * there are no loops over the tree, no lookups and no virtual calls.
+ *
+ * The header defines, in namespace gtdynamics::generated::<name>, the sizes
+ * kNumLinkSlots and kNumJointSlots and inline functions with the array
+ * conventions of CompiledRobot and RecursiveDynamics, indexed by link id and
+ * joint id:
+ *  - ForwardKinematics(q, &poses), as CompiledRobot::forwardKinematics;
+ *  - BodyJacobian(poses, link_id, &J), as CompiledRobot::bodyJacobian;
+ *  - InverseDynamics(q, v, a, &tau), recursive Newton-Euler;
+ *  - ForwardDynamics(q, v, tau, &a), the articulated-body algorithm.
+ *
+ * Gravity is a constant of the generated code. Only fixed-base trees are
+ * supported: robots with floating roots or closed loops throw
+ * std::invalid_argument. The generator tool scripts/generate_robot_kernels
+ * writes the header for a model file.
+ *
+ * @param robot    the robot, with its base link fixed
+ * @param name     namespace of the kernels, a C++ identifier
+ * @param gravity  gravity vector, if any
+ * @return the source of the header
+ */
+std::string GenerateRobotKernels(
+    const Robot &robot, const std::string &name,
+    const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+}  // namespace gtdynamics
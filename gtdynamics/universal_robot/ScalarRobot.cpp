@@ -0,0 +1,310 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ScalarRobot.cpp
+ * @brief Kinematics and dynamics kernels of a CompiledRobot in any scalar.
+ */
+
+#include "gtdynamics/universal_robot/ScalarRobot.h"
+
+#include <Eigen/Cholesky>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace gtdynamics {
+
+namespace {
+
+template <typename S>
+Eigen::Matrix<S, 3, 3> Skew(const Eigen::Matrix<S, 3, 1> &w) {
+  Eigen::Matrix<S, 3, 3> K;
+  K << S(0), -w(2), w(1), w(2), S(0), -w(0), -w(1), w(0), S(0);
+  return K;
+}
+
+// Ad(T) = [R 0; [t] R R], in the (w, v) twist convention of gtsam.
+template <typename S>
+Eigen::Matrix<S, 6, 6> AdjointMap(const Eigen::Matrix<S, 3, 3> &R,
+                                  const Eigen::Matrix<S, 3, 1> &t) {
+  Eigen::Matrix<S, 6, 6> Ad;
+  Ad << R, Eigen::Matrix<S, 3, 3>::Zero(), Skew(t) * R, R;
+  return Ad;
+}
+
+// ad(V) = [[w] 0; [v] [w]].
+template <typename S>
+Eigen::Matrix<S, 6, 6> adjointMap(const Eigen::Matrix<S, 6, 1> &V) {
+  const Eigen::Matrix<S, 3, 3> W = Skew<S>(V.template head<3>());
+  Eigen::Matrix<S, 6, 6> ad;
+  ad << W, Eigen::Matrix<S, 3, 3>::Zero(), Skew<S>(V.template tail<3>()), W;
+  return ad;
+}
+
+// Ad(T) S = (R w, t x R w + R v) for a single screw axis.
+template <typename S>
+Eigen::Matrix<S, 6, 1> AdjointTimes(const Eigen::Matrix<S, 3, 3> &R,
+                                    const Eigen::Matrix<S, 3, 1> &t,
+                                    const Eigen::Matrix<S, 6, 1> &xi) {
+  Eigen::Matrix<S, 6, 1> result;
+  const Eigen::Matrix<S, 3, 1> w = R * xi.template head<3>();
+  result << w, t.cross(w) + R * xi.template tail<3>();
+  return result;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+template <typename Scalar>
+typename ScalarRobot<Scalar>::Pose ScalarRobot<Scalar>::Cast(
+    const gtsam::Pose3 &pose) {
+  return Pose{pose.rotation().matrix().cast<Scalar>(),
+              pose.translation().cast<Scalar>()};
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+gtsam::Pose3 ScalarRobot<Scalar>::ToPose3(const Pose &pose) {
+  return gtsam::Pose3(gtsam::Rot3(pose.R.template cast<double>()),
+                      gtsam::Point3(pose.t.template cast<double>()));
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+ScalarRobot<Scalar>::ScalarRobot(
+    const CompiledRobot &robot, const boost::optional<gtsam::Vector3> &gravity)
+    : robot_(robot) {
+  if (gravity) gravity_ = Vector3(gravity->cast<Scalar>());
+  const size_t N = robot_.numNodes();
+  screw_axes_ = robot_.screwAxes().cast<Scalar>();
+  nodes_.resize(N);
+  for (size_t n = 0; n < N; ++n) {
+    Node &node = nodes_[n];
+    node.rest = Cast(robot_.restPoses()[n]);
+
+    // Exp([S] q) with S = (w, v) and |w| = 1 is R = I + s [w] + (1 - c) [w]^2,
+    // t = q v + (1 - c) [w] v + (q - s) [w]^2 v. A general screw axis is
+    // scaled to unit rotation; a prismatic axis has [w] = 0.
+    const gtsam::Vector6 S = robot_.screwAxes().col(n);
+    gtsam::Vector3 w = S.head<3>(), v = S.tail<3>();
+    const double norm = w.norm();
+    node.scale = Scalar(1);
+    if (norm > 1e-9) {
+      node.scale = Scalar(norm);
+      w /= norm;
+      v /= norm;
+    } else {
+      w.setZero();
+    }
+    const gtsam::Matrix3 K = gtsam::skewSymmetric(w);
+    node.K = K.cast<Scalar>();
+    node.K2 = (K * K).cast<Scalar>();
+    node.v = v.cast<Scalar>();
+    node.a = (K * v).cast<Scalar>();
+    node.b = (K * K * v).cast<Scalar>();
+  }
+
+  const size_t num_links = robot_.numLinkSlots();
+  fixed_poses_.resize(num_links);
+  inertias_.resize(num_links);
+  for (size_t i = 0; i < num_links; ++i) {
+    fixed_poses_[i] = Cast(robot_.fixedPoses()[i]);
+    inertias_[i] = robot_.inertias()[i].cast<Scalar>();
+  }
+  masses_ = robot_.masses().cast<Scalar>();
+
+  X_.resize(N);
+  IA_.resize(N);
+  pA_.resize(6, N);
+  c_.resize(6, N);
+  U_.resize(6, N);
+  D_.resize(N);
+  u_.resize(N);
+  accels_.resize(6, num_links);
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+typename ScalarRobot<Scalar>::Pose ScalarRobot<Scalar>::relativePose(
+    size_t n, Scalar q) const {
+  const Node &node = nodes_[n];
+  const Scalar theta = node.scale * q;
+  const Scalar s = std::sin(theta), one_minus_c = Scalar(1) - std::cos(theta);
+  const Matrix3 Re =
+      Matrix3::Identity() + s * node.K + one_minus_c * node.K2;
+  const Vector3 te =
+      theta * node.v + one_minus_c * node.a + (theta - s) * node.b;
+  return Pose{node.rest.R * Re, node.rest.R * te + node.rest.t};
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void ScalarRobot<Scalar>::forwardKinematics(const Vector &q,
+                                            Poses *poses) const {
+  const size_t num_links = robot_.numLinkSlots();
+  if (poses->size() != num_links) poses->resize(num_links);
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  for (size_t n = 0; n < link_ids.size(); ++n) {
+    const int i = link_ids[n];
+    Pose &wTi = (*poses)[i];
+    if (parents[n] < 0) {
+      wTi = fixed_poses_[i];
+      continue;
+    }
+    const Pose &wTp = (*poses)[link_ids[parents[n]]];
+    const Pose pTi = relativePose(n, q(robot_.jointIds()[n]));
+    wTi.t = wTp.R * pTi.t + wTp.t;
+    wTi.R = wTp.R * pTi.R;
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void ScalarRobot<Scalar>::forwardKinematics(const Vector &q, const Vector &v,
+                                            Poses *poses,
+                                            Matrix *twists) const {
+  const size_t num_links = robot_.numLinkSlots();
+  if (poses->size() != num_links) poses->resize(num_links);
+  if (size_t(twists->cols()) != num_links || twists->rows() != 6)
+    twists->resize(6, num_links);
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  for (size_t n = 0; n < link_ids.size(); ++n) {
+    const int i = link_ids[n];
+    Pose &wTi = (*poses)[i];
+    if (parents[n] < 0) {
+      wTi = fixed_poses_[i];
+      twists->col(i).setZero();
+      continue;
+    }
+    // T_wi = T_wp T_pi(q), V_i = Ad(T_ip) V_p + S_i v.
+    const int p = link_ids[parents[n]];
+    const int j = robot_.jointIds()[n];
+    const Pose &wTp = (*poses)[p];
+    const Pose pTi = relativePose(n, q(j));
+    wTi.t = wTp.R * pTi.t + wTp.t;
+    wTi.R = wTp.R * pTi.R;
+    const Matrix3 iRp = pTi.R.transpose();
+    const Vector6 V_p = twists->col(p);
+    Vector6 V_i;
+    V_i << iRp * V_p.template head<3>(),
+        iRp * (V_p.template tail<3>() - pTi.t.cross(V_p.template head<3>()));
+    twists->col(i) = V_i + screw_axes_.col(n) * v(j);
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void ScalarRobot<Scalar>::bodyJacobian(const Poses &poses, int link_id,
+                                       Matrix *J) const {
+  if (link_id < 0 || size_t(link_id) >= robot_.numLinkSlots() ||
+      robot_.nodeOfLink()[link_id] < 0)
+    throw std::invalid_argument("ScalarRobot: no link with id " +
+                                std::to_string(link_id));
+  J->setZero(6, robot_.numJointSlots());
+  const Matrix3 iRw = poses[link_id].R.transpose();
+  const Vector3 iPw = -(iRw * poses[link_id].t);
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  for (int n = robot_.nodeOfLink()[link_id]; parents[n] >= 0; n = parents[n]) {
+    const Pose &wTk = poses[link_ids[n]];
+    J->col(robot_.jointIds()[n]) = AdjointTimes<Scalar>(
+        iRw * wTk.R, iRw * wTk.t + iPw, screw_axes_.col(n));
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void ScalarRobot<Scalar>::spatialJacobian(const Poses &poses, int link_id,
+                                          Matrix *J) const {
+  if (link_id < 0 || size_t(link_id) >= robot_.numLinkSlots() ||
+      robot_.nodeOfLink()[link_id] < 0)
+    throw std::invalid_argument("ScalarRobot: no link with id " +
+                                std::to_string(link_id));
+  J->setZero(6, robot_.numJointSlots());
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  for (int n = robot_.nodeOfLink()[link_id]; parents[n] >= 0; n = parents[n]) {
+    const Pose &wTk = poses[link_ids[n]];
+    J->col(robot_.jointIds()[n]) =
+        AdjointTimes<Scalar>(wTk.R, wTk.t, screw_axes_.col(n));
+  }
+}
+
+/* ************************************************************************* */
+template <typename Scalar>
+void ScalarRobot<Scalar>::forwardDynamics(const Vector &q, const Vector &v,
+                                          const Vector &tau, Vector *a) const {
+  const size_t N = robot_.numNodes();
+  const auto &link_ids = robot_.linkIds();
+  const auto &parents = robot_.parentNodes();
+  const auto &joint_ids = robot_.jointIds();
+  if (size_t(a->size()) != robot_.numJointSlots())
+    a->setZero(robot_.numJointSlots());
+
+  // Pass 1, outward: poses, twists, velocity-product accelerations and
+  // bias wrenches G_i A_i - sum F = ad(V_i)^T G_i V_i + m_i R_i^T g.
+  forwardKinematics(q, v, &poses_, &twists_);
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    const Vector6 V_i = twists_.col(i);
+    if (parents[n] < 0) {
+      c_.col(n).setZero();
+    } else {
+      const int p = link_ids[parents[n]];
+      const Pose &wTi = poses_[i], &wTp = poses_[p];
+      const Matrix3 iRp = wTi.R.transpose() * wTp.R;
+      X_[n] = AdjointMap<Scalar>(iRp, wTi.R.transpose() * (wTp.t - wTi.t));
+      c_.col(n) = adjointMap<Scalar>(V_i) * screw_axes_.col(n) *
+                  v(joint_ids[n]);
+    }
+    IA_[n] = inertias_[i];
+    pA_.col(n) = -adjointMap<Scalar>(V_i).transpose() * inertias_[i] * V_i;
+    if (gravity_)
+      pA_.col(n).template tail<3>() -=
+          poses_[i].R.transpose() * (*gravity_) * masses_(i);
+  }
+
+  // Pass 2, inward: articulated inertias and bias wrenches.
+  for (size_t n = N; n-- > 0;) {
+    const int parent = parents[n];
+    if (parent < 0) continue;
+    const Vector6 S = screw_axes_.col(n);
+    const Vector6 U = IA_[n] * S;
+    U_.col(n) = U;
+    D_(n) = S.dot(U);
+    u_(n) = tau(joint_ids[n]) - U.dot(c_.col(n)) - S.dot(pA_.col(n));
+    const Matrix6 Ia = IA_[n] - U * U.transpose() / D_(n);
+    const Vector6 pa = pA_.col(n) + Ia * c_.col(n) + U * (u_(n) / D_(n));
+    IA_[parent] += X_[n].transpose() * Ia * X_[n];
+    pA_.col(parent) += X_[n].transpose() * pa;
+  }
+
+  // Pass 3, outward: accelerations; a floating root has no joint wrench.
+  for (size_t n = 0; n < N; ++n) {
+    const int i = link_ids[n];
+    auto A_i = accels_.col(i);
+    if (parents[n] < 0) {
+      if (robot_.isFixed()[i])
+        A_i.setZero();
+      else
+        A_i = -IA_[n].ldlt().solve(pA_.col(n));
+      continue;
+    }
+    const int j = joint_ids[n];
+    const Vector6 XA_p = X_[n] * accels_.col(link_ids[parents[n]]);
+    (*a)(j) = (u_(n) - U_.col(n).dot(XA_p)) / D_(n);
+    A_i = XA_p + screw_axes_.col(n) * (*a)(j) + c_.col(n);
+  }
+}
+
+template class ScalarRobot<float>;
+template class ScalarRobot<double>;
+
+}  // namespace gtdynamics
@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ScalarRobot.h
+ * @brief Kinematics and dynamics kernels of a CompiledRobot in any scalar.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <Eigen/Core>
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * ScalarRobot runs the forward kinematics and Jacobians of CompiledRobot and
+ * the articulated-body forward dynamics of RecursiveDynamics with the
+ * constants of the robot cast to `Scalar`, on plain Eigen types instead of
+ * gtsam::Pose3 and Vector6, which are double only.
+ *
+ * With Scalar = float, e.g. for sampling-based planners and rollouts that do
+ * not need double precision, the vectorized loops do twice the work per
+ * instruction and the buffers take half the memory bandwidth. Results can be
+ * refined in double by the CompiledRobot or RecursiveDynamics of the same
+ * robot, which share the traversal and the joint-id and link-id indexing.
+ * Instantiated for float and double.
+ *
+ * Floating roots are at the identity with zero twist, as in the trajectory
+ * methods of RecursiveDynamics.
+ *
+ * forwardDynamics reuses scratch space, so an instance should not be shared
+ * between threads: use one per thread.
+ */
+template <typename Scalar>
+class ScalarRobot {
+ public:
+  using Vector = Eigen::Matrix<Scalar, Eigen::Dynamic, 1>;
+  using Matrix = Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>;
+  using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+  using Vector6 = Eigen::Matrix<Scalar, 6, 1>;
+  using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+  using Matrix6 = Eigen::Matrix<Scalar, 6, 6>;
+  using Matrix6s = std::vector<Matrix6, Eigen::aligned_allocator<Matrix6>>;
+
+  /// A rigid transform, x -> R x + t.
+  struct Pose {
+    Matrix3 R;
+    Vector3 t;
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+  using Poses = std::vector<Pose, Eigen::aligned_allocator<Pose>>;
+
+  /// Cast a pose to Scalar.
+  static Pose Cast(const gtsam::Pose3 &pose);
+
+  /// The pose in double, e.g. to refine it.
+  static gtsam::Pose3 ToPose3(const Pose &pose);
+
+  /**
+   * Constructor
+   * @param robot    the robot, needs to have a tree structure
+   * @param gravity  gravity vector, for forwardDynamics
+   */
+  explicit ScalarRobot(
+      const CompiledRobot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none);
+
+  /// Compile the robot, and cast its constants.
+  explicit ScalarRobot(
+      const Robot &robot,
+      const boost::optional<gtsam::Vector3> &gravity = boost::none)
+      : ScalarRobot(CompiledRobot(robot), gravity) {}
+
+  /// The robot in double precision, for the topology and refinement.
+  const CompiledRobot &compiledRobot() const { return robot_; }
+
+  /// @name Kinematics
+  /// As in CompiledRobot, on joint-id indexed arrays and link-id indexed
+  /// poses and twists; buffers are resized only if needed.
+  /// @{
+
+  /// CoM poses wTi of all links.
+  void forwardKinematics(const Vector &q, Poses *poses) const;
+
+  /// CoM poses and 6 x #link slots twists of all links.
+  void forwardKinematics(const Vector &q, const Vector &v, Poses *poses,
+                         Matrix *twists) const;
+
+  /// 6 x #joint slots body Jacobian of a link, see CompiledRobot.
+  void bodyJacobian(const Poses &poses, int link_id, Matrix *J) const;
+
+  /// 6 x #joint slots spatial Jacobian of a link, see CompiledRobot.
+  void spatialJacobian(const Poses &poses, int link_id, Matrix *J) const;
+
+  /// @}
+  /// @name Dynamics
+  /// @{
+
+  /**
+   * Articulated-body forward dynamics, as in RecursiveDynamics.
+   * @param q    joint angles
+   * @param v    joint velocities
+   * @param tau  joint torques
+   * @param a    joint accelerations, indexed by joint id
+   */
+  void forwardDynamics(const Vector &q, const Vector &v, const Vector &tau,
+                       Vector *a) const;
+
+  /// @}
+
+ private:
+  // Node constants of the joint transform Exp(S q), as in
+  // BatchForwardKinematics: S scaled to a unit rotation axis w, with
+  // K = [w], a = K v and b = K^2 v.
+  struct Node {
+    Scalar scale;
+    Matrix3 K, K2;
+    Vector3 v, a, b;
+    Pose rest;
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  // Pose of node n relative to its tree parent at joint angle q.
+  Pose relativePose(size_t n, Scalar q) const;
+
+  CompiledRobot robot_;
+  boost::optional<Vector3> gravity_;
+  std::vector<Node, Eigen::aligned_allocator<Node>> nodes_;
+  Matrix screw_axes_;  // 6 x #nodes
+  Poses fixed_poses_;  // link-id indexed
+  Matrix6s inertias_;  // link-id indexed
+  Vector masses_;      // link-id indexed
+
+  // Scratch space of forwardDynamics, indexed by node but for the poses and
+  // twists.
+  mutable Poses poses_;
+  mutable Matrix twists_, accels_;
+  mutable Matrix6s X_, IA_;
+  mutable Matrix pA_, c_, U_;
+  mutable Vector D_, u_;
+};
+
+extern template class ScalarRobot<float>;
+extern template class ScalarRobot<double>;
+
+}  // namespace gtdynamics
@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelfCollision.cpp
+ * @brief Link pairs of a robot to check for self-collision, and their
+ * broadphase.
+ */
+
+#include "gtdynamics/universal_robot/SelfCollision.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace gtdynamics {
+
+namespace {
+// Sphere around all the given spheres.
+CollisionSphere Bound(const CollisionSpheres &spheres) {
+  Point3 center = Point3::Zero();
+  for (const CollisionSphere &sphere : spheres) center += sphere.center;
+  center /= spheres.size();
+  double radius = 0;
+  for (const CollisionSphere &sphere : spheres)
+    radius =
+        std::max(radius, (sphere.center - center).norm() + sphere.radius);
+  return {center, radius};
+}
+
+// Number of joints between link `from` and every link, by link id, counting
+// only up to max_hops; farther links are marked max_hops + 1.
+std::vector<size_t> Hops(const CompiledRobot &robot, int from,
+                         size_t max_hops) {
+  std::vector<size_t> hops(robot.numLinkSlots(), max_hops + 1);
+  hops[from] = 0;
+  std::queue<int> queue;
+  queue.push(from);
+  while (!queue.empty()) {
+    const int i = queue.front();
+    queue.pop();
+    if (hops[i] >= max_hops) continue;
+    for (size_t j = 0; j < robot.numJointSlots(); j++) {
+      const int parent = robot.jointParentLinks()[j],
+                child = robot.jointChildLinks()[j];
+      const int other = parent == i ? child : child == i ? parent : -1;
+      if (other < 0 || hops[other] <= hops[i] + 1) continue;
+      hops[other] = hops[i] + 1;
+      queue.push(other);
+    }
+  }
+  return hops;
+}
+}  // namespace
+
+/* ************************************************************************* */
+SelfCollisionModel::SelfCollisionModel(
+    const Robot &robot,
+    const std::map<std::string, CollisionSpheres> &link_spheres,
+    const SelfCollisionParameters &parameters)
+    : compiled_(robot) {
+  const size_t num_links = compiled_.numLinkSlots();
+  spheres_.resize(num_links);
+  bounds_.assign(num_links, {Point3::Zero(), 0.0});
+  std::vector<int> ids;
+  for (auto &&entry : link_spheres) {
+    if (entry.second.empty()) continue;
+    const int i = robot.link(entry.first)->id();
+    spheres_[i] = entry.second;
+    bounds_[i] = Bound(entry.second);
+    ids.push_back(i);
+  }
+  std::sort(ids.begin(), ids.end());
+
+  // Pairs not filtered by the joint graph.
+  for (const int a : ids) {
+    const std::vector<size_t> hops =
+        Hops(compiled_, a, parameters.adjacency);
+    for (const int b : ids) {
+      if (b <= a || hops[b] <= parameters.adjacency) continue;
+      if (compiled_.isFixed()[a] && compiled_.isFixed()[b]) continue;
+      pairs_.push_back({a, b});
+    }
+  }
+  if (parameters.num_samples == 0 || pairs_.empty()) return;
+
+  // Keep the pairs that come close in some random configuration.
+  std::mt19937 generator(parameters.seed);
+  std::vector<std::uniform_real_distribution<double>> angles(
+      compiled_.numJointSlots());
+  for (auto &&joint : robot.joints()) {
+    const JointScalarLimit &limits = joint->parameters().scalar_limits;
+    const double lower = std::max(limits.value_lower_limit, -M_PI),
+                 upper = std::min(limits.value_upper_limit, M_PI);
+    angles[joint->id()] = std::uniform_real_distribution<double>(
+        std::min(lower, upper), std::max(lower, upper));
+  }
+  gtsam::Vector q = gtsam::Vector::Zero(compiled_.numJointSlots());
+  std::vector<Pose3> poses;
+  std::vector<bool> close(pairs_.size(), false);
+  for (size_t s = 0; s < parameters.num_samples; s++) {
+    for (size_t j = 0; j < angles.size(); j++) q(j) = angles[j](generator);
+    compiled_.forwardKinematics(q, &poses);
+    for (size_t p : candidatePairs(poses, parameters.sample_margin))
+      if (!close[p] && clearance(pairs_[p], poses) < parameters.sample_margin)
+        close[p] = true;
+  }
+  std::vector<LinkPair> kept;
+  for (size_t p = 0; p < pairs_.size(); p++)
+    if (close[p]) kept.push_back(pairs_[p]);
+  pairs_.swap(kept);
+}
+
+/* ************************************************************************* */
+std::vector<size_t> SelfCollisionModel::candidatePairs(
+    const std::vector<Pose3> &poses, double margin) const {
+  std::vector<size_t> candidates;
+  for (size_t p = 0; p < pairs_.size(); p++) {
+    const CollisionSphere &a = bounds_[pairs_[p].link_a],
+                          &b = bounds_[pairs_[p].link_b];
+    const Point3 wPa = poses[pairs_[p].link_a].transformFrom(a.center),
+                 wPb = poses[pairs_[p].link_b].transformFrom(b.center);
+    if ((wPa - wPb).norm() - a.radius - b.radius < margin)
+      candidates.push_back(p);
+  }
+  return candidates;
+}
+
+/* ************************************************************************* */
+double SelfCollisionModel::clearance(const LinkPair &pair,
+                                     const std::vector<Pose3> &poses) const {
+  double smallest = std::numeric_limits<double>::infinity();
+  for (const CollisionSphere &a : spheres_[pair.link_a]) {
+    const Point3 wPa = poses[pair.link_a].transformFrom(a.center);
+    for (const CollisionSphere &b : spheres_[pair.link_b]) {
+      const Point3 wPb = poses[pair.link_b].transformFrom(b.center);
+      smallest = std::min(smallest, (wPa - wPb).norm() - a.radius - b.radius);
+    }
+  }
+  return smallest;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,108 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SelfCollision.h
+ * @brief Link pairs of a robot to check for self-collision, and their
+ * broadphase.
+ */
+
+#pragma once
+
+#include <gtsam/geometry/Pose3.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/SignedDistanceField.h"
+
+namespace gtdynamics {
+
+/// Parameters of the pair filter of SelfCollisionModel.
+struct SelfCollisionParameters {
+  size_t adjacency = 1;         // ignore pairs this many joints apart or less
+  size_t num_samples = 1000;    // random configurations to find pairs that
+                                // never come close, 0 to keep all pairs
+  double sample_margin = 0.05;  // keep pairs closer than this in a sample
+  unsigned seed = 0;            // of the random configurations
+};
+
+/**
+ * SelfCollisionModel holds the collision spheres of the links of a robot and
+ * the link pairs worth checking for self-collision, filtered once per robot
+ * from all pairs of links with spheres:
+ *  - pairs at most `adjacency` joints apart in the joint graph, which touch
+ *    at their joints by design;
+ *  - pairs of fixed links, which cannot be moved apart;
+ *  - pairs that never come within sample_margin of each other in
+ *    num_samples random configurations, drawn uniformly within the joint
+ *    limits clamped to [-pi, pi], as e.g. MoveIt's setup assistant does.
+ *    This is a sampled, not a guaranteed, bound: use a margin that covers
+ *    the clearance the planner keeps.
+ *
+ * At each configuration, candidatePairs is the broadphase over the filtered
+ * pairs: it compares one bounding sphere per link before any collision
+ * spheres are, with the forward kinematics of the CompiledRobot.
+ */
+class SelfCollisionModel {
+ public:
+  /// Two links, by id, with link_a < link_b.
+  struct LinkPair {
+    int link_a, link_b;
+  };
+
+  /**
+   * Construct from the collision spheres of each link.
+   * @param robot         the robot, with a tree structure
+   * @param link_spheres  collision spheres by link name, in the link's COM
+   *                      frame; see BoundingSpheres and TransformSpheres
+   * @param parameters    pair filter parameters
+   */
+  SelfCollisionModel(
+      const Robot &robot,
+      const std::map<std::string, CollisionSpheres> &link_spheres,
+      const SelfCollisionParameters &parameters = SelfCollisionParameters());
+
+  /// The compiled robot the broadphase runs on.
+  const CompiledRobot &compiledRobot() const { return compiled_; }
+
+  /// The filtered link pairs.
+  const std::vector<LinkPair> &pairs() const { return pairs_; }
+
+  /// Collision spheres of a link, empty for links without any.
+  const CollisionSpheres &spheres(int link_id) const {
+    return spheres_[link_id];
+  }
+
+  /// Sphere around all collision spheres of a link, in its COM frame.
+  const CollisionSphere &bound(int link_id) const { return bounds_[link_id]; }
+
+  /**
+   * Broadphase: indices into pairs() of the pairs whose bounding spheres are
+   * closer than margin.
+   * @param poses   link COM poses, indexed by link id, e.g. from
+   *                CompiledRobot::forwardKinematics
+   * @param margin  clearance below which pairs are candidates
+   */
+  std::vector<size_t> candidatePairs(const std::vector<gtsam::Pose3> &poses,
+                                     double margin) const;
+
+  /// Smallest clearance between the collision spheres of a link pair.
+  double clearance(const LinkPair &pair,
+                   const std::vector<gtsam::Pose3> &poses) const;
+
+ private:
+  CompiledRobot compiled_;
+  std::vector<CollisionSpheres> spheres_;  // by link id
+  std::vector<CollisionSphere> bounds_;    // by link id
+  std::vector<LinkPair> pairs_;
+};
+
+}  // namespace gtdynamics
@@ -13,6 +13,8 @@
 
 #include "gtdynamics/universal_robot/sdf.h"
 
+#include <algorithm>
+#include <boost/filesystem.hpp>
 #include <fstream>
 #include <sdf/parser.hh>
 #include <sdf/sdf.hh>
@@ -21,17 +23,43 @@
 #include "gtdynamics/universal_robot/PrismaticJoint.h"
 #include "gtdynamics/universal_robot/RevoluteJoint.h"
 #include "gtdynamics/universal_robot/HelicalJoint.h"
+#include "gtdynamics/universal_robot/RobotCache.h"
 #include "gtdynamics/universal_robot/sdf_internal.h"
+#include "gtdynamics/utils/ThreadPool.h"
 
 namespace gtdynamics {
 
 using gtsam::Pose3;
 
-sdf::Model GetSdf(const std::string &sdf_file_path,
-                  const std::string &model_name) {
+// Remove the visual and collision elements of all links below `element`, so
+// that loading the model skips their geometry, materials and meshes.
+static void RemoveGeometry(const sdf::ElementPtr &element) {
+  std::vector<sdf::ElementPtr> geometry;
+  for (sdf::ElementPtr child = element->GetFirstElement(); child;
+       child = child->GetNextElement()) {
+    const std::string &name = child->GetName();
+    if (element->GetName() == "link" &&
+        (name == "visual" || name == "collision"))
+      geometry.push_back(child);
+    else
+      RemoveGeometry(child);
+  }
+  for (auto &&child : geometry) element->RemoveChild(child);
+}
+
+// Parse a file into sdf elements, without geometry if dynamics_only.
+static sdf::SDFPtr ReadSdf(const std::string &sdf_file_path,
+                           bool dynamics_only) {
   sdf::SDFPtr sdf = sdf::readFile(sdf_file_path);
   if (sdf==nullptr)
     throw std::runtime_error("SDF library could not parse " + sdf_file_path);
+  if (dynamics_only) RemoveGeometry(sdf->Root());
+  return sdf;
+}
+
+sdf::Model GetSdf(const std::string &sdf_file_path,
+                  const std::string &model_name, bool dynamics_only) {
+  sdf::SDFPtr sdf = ReadSdf(sdf_file_path, dynamics_only);
 
   sdf::Model model = sdf::Model();
   model.Load(sdf->Root()->GetElement("model"));
@@ -53,6 +81,22 @@ sdf::Model GetSdf(const std::string &sdf_file_path,
   throw std::runtime_error("Model not found in: " + sdf_file_path);
 }
 
+std::vector<sdf::Model> GetSdfModels(const std::string &sdf_file_path,
+                                     bool dynamics_only) {
+  sdf::SDFPtr sdf = ReadSdf(sdf_file_path, dynamics_only);
+
+  sdf::Model model = sdf::Model();
+  model.Load(sdf->Root()->GetElement("model"));
+  if (model.Name() != "__default__") return {model};
+
+  sdf::World world = sdf::World();
+  world.Load(sdf->Root()->GetElement("world"));
+  std::vector<sdf::Model> models;
+  for (uint i = 0; i < world.ModelCount(); i++)
+    models.push_back(*world.ModelByIndex(i));
+  return models;
+}
+
 gtsam::Pose3 Pose3FromIgnition(const ignition::math::Pose3d &ignition_pose) {
   const auto &rot = ignition_pose.Rot();
   const auto &pos = ignition_pose.Pos();
@@ -69,6 +113,9 @@ JointParams ParametersFromSdfJoint(const sdf::Joint &sdf_joint) {
   parameters.velocity_limit = sdf_joint.Axis()->MaxVelocity();
   parameters.torque_limit = sdf_joint.Axis()->Effort();
   parameters.damping_coefficient = sdf_joint.Axis()->Damping();
+  parameters.spring_coefficient = sdf_joint.Axis()->SpringStiffness();
+  parameters.spring_reference = sdf_joint.Axis()->SpringReference();
+  parameters.coulomb_friction = sdf_joint.Axis()->Friction();
 
   return parameters;
 }
@@ -141,7 +188,7 @@ gtsam::Vector3 GetSdfAxis(const sdf::Joint &sdf_joint) {
   return gtsam::Vector3(axis[0], axis[1], axis[2]);
 }
 
-LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
+LinkSharedPtr LinkFromSdf(DynamicsIndex id, const sdf::Link &sdf_link) {
   gtsam::Matrix3 inertia;
   const auto &I = sdf_link.Inertial().Moi();
   inertia << I(0, 0), I(0, 1), I(0, 2), I(1, 0), I(1, 1), I(1, 2), I(2, 0),
@@ -158,14 +205,14 @@ LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link) {
                                   inertia, bMcom, bMl);
 }
 
-LinkSharedPtr LinkFromSdf(uint8_t id, const std::string &link_name,
+LinkSharedPtr LinkFromSdf(DynamicsIndex id, const std::string &link_name,
                           const std::string &sdf_file_path,
                           const std::string &model_name) {
-  auto model = GetSdf(sdf_file_path, model_name);
+  auto model = GetSdf(sdf_file_path, model_name, true);
   return LinkFromSdf(id, *model.LinkByName(link_name));
 }
 
-JointSharedPtr JointFromSdf(uint8_t id, const LinkSharedPtr &parent_link,
+JointSharedPtr JointFromSdf(DynamicsIndex id, const LinkSharedPtr &parent_link,
                             const sdf::Link *parent_sdf_link,
                             const LinkSharedPtr &child_link,
                             const sdf::Link *child_sdf_link,
@@ -200,22 +247,98 @@ JointSharedPtr JointFromSdf(uint8_t id, const LinkSharedPtr &parent_link,
   return joint;
 }
 
+namespace {
+// Links merged into one rigid body by fixed joints. Each group is named after
+// its root, the link whose frame and name the composite keeps.
+struct FixedGroups {
+  std::map<std::string, std::string> root;  // link name -> group root
+  std::map<std::string, std::vector<const sdf::Link *>> members;
+};
+
+FixedGroups GroupFixedLinks(const sdf::Model &sdf, bool lump_fixed_joints) {
+  std::map<std::string, std::string> parent;
+  for (uint j = 0; lump_fixed_joints && j < sdf.JointCount(); j++) {
+    const sdf::Joint &sdf_joint = *sdf.JointByIndex(j);
+    if (sdf_joint.Type() == sdf::JointType::FIXED &&
+        sdf_joint.ParentLinkName() != "world")
+      parent[sdf_joint.ChildLinkName()] = sdf_joint.ParentLinkName();
+  }
+
+  FixedGroups groups;
+  for (uint i = 0; i < sdf.LinkCount(); i++) {
+    const sdf::Link *sdf_link = sdf.LinkByIndex(i);
+    std::string root = sdf_link->Name();
+    for (size_t n = 0; parent.count(root); n++) {
+      if (n > parent.size())
+        throw std::runtime_error("Fixed joints form a loop at link " + root);
+      root = parent.at(root);
+    }
+    groups.root[sdf_link->Name()] = root;
+    groups.members[root].push_back(sdf_link);
+  }
+  return groups;
+}
+
+// The composite rigid body of a group of links: total mass, CoM, and inertia
+// about the CoM, with the orientation of the CoM frame of the root link.
+LinkSharedPtr CompositeLinkFromSdf(
+    DynamicsIndex id, const sdf::Link &root,
+    const std::vector<const sdf::Link *> &members) {
+  const LinkSharedPtr root_link = LinkFromSdf(id, root);
+  if (members.size() == 1) return root_link;
+
+  std::vector<LinkSharedPtr> links;
+  double mass = 0;
+  gtsam::Point3 com(0, 0, 0);
+  for (auto &&member : members) {
+    links.push_back(LinkFromSdf(id, *member));
+    mass += links.back()->mass();
+    com += links.back()->mass() * links.back()->bMcom().translation();
+  }
+  com = mass > 0 ? gtsam::Point3(com / mass)
+                 : root_link->bMcom().translation();
+
+  const gtsam::Rot3 bRcom = root_link->bMcom().rotation();
+  gtsam::Matrix3 inertia = gtsam::Matrix3::Zero();
+  for (auto &&link : links) {
+    // Rotate each inertia to the composite CoM frame and shift it there.
+    const gtsam::Matrix3 R =
+        (bRcom.inverse() * link->bMcom().rotation()).matrix();
+    const gtsam::Vector3 r =
+        bRcom.unrotate(link->bMcom().translation() - com);
+    inertia += R * link->inertia() * R.transpose() +
+               link->mass() * (r.dot(r) * gtsam::I_3x3 - r * r.transpose());
+  }
+  return boost::make_shared<Link>(id, root.Name(), mass, inertia,
+                                  Pose3(bRcom, com), root_link->bMlink());
+}
+}  // namespace
+
 /**
- * @fn Construct all Link and Joint objects from an input sdf::ElementPtr.
- * @param sdf_ptr a shared pointer to a sdf::ElementPtr containing the model.
- * @return LinkMap and JointMap as a pair
+ * @fn Construct a Robot from an sdf::Model.
+ * @param sdf the model.
+ * @param lump_fixed_joints whether to merge links connected by fixed joints,
+ * see CreateRobotFromFile.
+ * @return the robot, with the frames of the model and of merged links.
  */
-static LinkJointPair ExtractRobotFromSdf(const sdf::Model &sdf) {
+static Robot RobotFromSdf(const sdf::Model &sdf, bool lump_fixed_joints) {
+  const FixedGroups groups = GroupFixedLinks(sdf, lump_fixed_joints);
+
   // Loop through all links in the sdf interface and construct Link
-  // objects without parents or children.
+  // objects without parents or children. Merged links are one composite.
   LinkMap name_to_link;
+  DynamicsIndex num_links = 0;
   for (uint i = 0; i < sdf.LinkCount(); i++) {
-    LinkSharedPtr link = LinkFromSdf(i, *sdf.LinkByIndex(i));
+    const sdf::Link &sdf_link = *sdf.LinkByIndex(i);
+    if (groups.root.at(sdf_link.Name()) != sdf_link.Name()) continue;
+    LinkSharedPtr link = CompositeLinkFromSdf(
+        num_links++, sdf_link, groups.members.at(sdf_link.Name()));
     name_to_link.emplace(link->name(), link);
   }
 
   // Create Joint objects and update list of parent and child links/joints.
   JointMap name_to_joint;
+  DynamicsIndex num_joints = 0;
   for (uint j = 0; j < sdf.JointCount(); j++) {
     sdf::Joint sdf_joint = *sdf.JointByIndex(j);
 
@@ -224,18 +347,25 @@ static LinkJointPair ExtractRobotFromSdf(const sdf::Model &sdf) {
     std::string child_link_name = sdf_joint.ChildLinkName();
     if (parent_link_name == "world") {
       // This joint fixes the child link in the world frame.
-      LinkSharedPtr child_link = name_to_link[child_link_name];
+      LinkSharedPtr child_link =
+          name_to_link[groups.root.at(child_link_name)];
       Pose3 fixed_pose = child_link->bMcom();
       child_link = boost::make_shared<Link>(Link::fix(*child_link, fixed_pose));
       continue;
     }
-    LinkSharedPtr parent_link = name_to_link[parent_link_name];
-    LinkSharedPtr child_link = name_to_link[child_link_name];
+    // Merged into a composite link.
+    if (groups.root.at(parent_link_name) == groups.root.at(child_link_name))
+      continue;
+    LinkSharedPtr parent_link = name_to_link[groups.root.at(parent_link_name)];
+    LinkSharedPtr child_link = name_to_link[groups.root.at(child_link_name)];
     const sdf::Link *parent_sdf_link = sdf.LinkByName(parent_link_name);
     const sdf::Link *child_sdf_link = sdf.LinkByName(child_link_name);
 
-    // Construct Joint and insert into name_to_joint.
-    JointSharedPtr joint = JointFromSdf(j, parent_link, parent_sdf_link, child_link, child_sdf_link, sdf_joint);
+    // Construct Joint and insert into name_to_joint. Ids stay dense when
+    // fixed joints are dropped.
+    const DynamicsIndex id = lump_fixed_joints ? num_joints++ : j;
+    JointSharedPtr joint = JointFromSdf(id, parent_link, parent_sdf_link,
+                                        child_link, child_sdf_link, sdf_joint);
     name_to_joint.emplace(joint->name(), joint);
 
     // Update list of parent and child links/joints for each Link.
@@ -243,19 +373,44 @@ static LinkJointPair ExtractRobotFromSdf(const sdf::Model &sdf) {
     child_link->addJoint(joint);
   }
 
-  return std::make_pair(name_to_link, name_to_joint);
+  Robot robot(name_to_link, name_to_joint);
+
+  // Merged links remain as frames of their composite, at their link frame.
+  for (auto &&kv : groups.root) {
+    if (kv.first == kv.second) continue;
+    const Pose3 bMl = GetSdfLinkFrame(sdf.LinkByName(kv.first));
+    const Pose3 &bMcom = robot.link(kv.second)->bMcom();
+    robot.addFrame(kv.first, kv.second, bMcom.inverse() * bMl);
+  }
+
+  // Explicit frames of the model, e.g. of links merged by the URDF parser.
+  for (uint f = 0; f < sdf.FrameCount(); f++) {
+    const sdf::Frame *sdf_frame = sdf.FrameByIndex(f);
+    std::string body;
+    auto raw_pose = sdf_frame->RawPose();
+    if (!sdf_frame->ResolveAttachedToBody(body).empty() ||
+        !groups.root.count(body) ||
+        !sdf_frame->SemanticPose().Resolve(raw_pose, "").empty())
+      continue;
+    const Pose3 &bMcom = robot.link(groups.root.at(body))->bMcom();
+    robot.addFrame(sdf_frame->Name(), groups.root.at(body),
+                   bMcom.inverse() * Pose3FromIgnition(raw_pose));
+  }
+  return robot;
 }
 
 /**
- * @fn Construct all Link and Joint objects from an input urdf or sdf file.
+ * @fn Construct a Robot from an input urdf or sdf file.
  * @param[in] file_path absolute path to the urdf or sdf file containing the
  * robot description.
  * @param[in] model_name name of the robot we care about. Must be specified in
  * case sdf_file_path points to a world file.
- * @return LinkMap and JointMap as a pair
+ * @param[in] lump_fixed_joints see CreateRobotFromFile.
+ * @return the robot
  */
-static LinkJointPair ExtractRobotFromFile(const std::string &file_path,
-                                          const std::string &model_name) {
+static Robot RobotFromFile(const std::string &file_path,
+                           const std::string &model_name,
+                           bool lump_fixed_joints) {
   std::ifstream is(file_path);
   if (!is.good())
     throw std::runtime_error("ExtractRobotFromFile: no file found at " +
@@ -266,17 +421,108 @@ static LinkJointPair ExtractRobotFromFile(const std::string &file_path,
   std::transform(file_ext.begin(), file_ext.end(), file_ext.begin(), ::tolower);
 
   if (file_ext == "urdf")
-    return ExtractRobotFromSdf(GetSdf(file_path));
+    return RobotFromSdf(GetSdf(file_path, "", true), lump_fixed_joints);
   else if (file_ext == "sdf")
-    return ExtractRobotFromSdf(GetSdf(file_path, model_name));
+    return RobotFromSdf(GetSdf(file_path, model_name, true),
+                        lump_fixed_joints);
 
   throw std::runtime_error("Invalid file extension.");
 }
 
+// Cache file of a model, distinct for the lumped variant.
+static std::string CachePath(const std::string &file_path,
+                             const std::string &model_name,
+                             bool lump_fixed_joints) {
+  return RobotCachePath(file_path, lump_fixed_joints
+                                       ? model_name + "\n(lumped)"
+                                       : model_name);
+}
+
+// Load `robot` from the cache file, if any. A stale or unreadable entry is
+// not an error: the file is parsed instead.
+static bool LoadCachedRobot(const std::string &cache_path, Robot *robot) {
+  if (cache_path.empty() || !boost::filesystem::exists(cache_path))
+    return false;
+  try {
+    *robot = LoadRobotBinary(cache_path);
+    return true;
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+// Save `robot` to the cache file, if any; failing to do so is not an error.
+static void SaveCachedRobot(const std::string &cache_path,
+                            const Robot &robot) {
+  if (cache_path.empty()) return;
+  try {
+    SaveRobotBinary(robot, cache_path);
+  } catch (const std::exception &) {
+  }
+}
+
 Robot CreateRobotFromFile(const std::string &file_path,
-                          const std::string &model_name) {
-  auto links_joints_pair = ExtractRobotFromFile(file_path, model_name);
-  return Robot(links_joints_pair.first, links_joints_pair.second);
+                          const std::string &model_name, bool use_cache,
+                          bool lump_fixed_joints) {
+  const std::string cache_path =
+      use_cache ? CachePath(file_path, model_name, lump_fixed_joints) : "";
+  Robot robot;
+  if (LoadCachedRobot(cache_path, &robot)) return robot;
+
+  robot = RobotFromFile(file_path, model_name, lump_fixed_joints);
+  SaveCachedRobot(cache_path, robot);
+  return robot;
+}
+
+std::map<std::string, Robot> CreateRobotsFromFile(
+    const std::string &file_path, const std::vector<std::string> &model_names,
+    size_t num_threads, bool use_cache, bool lump_fixed_joints) {
+  std::map<std::string, Robot> robots;
+
+  // Named models may all be in the cache, in which case nothing is parsed.
+  std::vector<std::string> missing;
+  for (auto &&name : model_names) {
+    Robot robot;
+    if (use_cache &&
+        LoadCachedRobot(CachePath(file_path, name, lump_fixed_joints), &robot))
+      robots.emplace(name, robot);
+    else
+      missing.push_back(name);
+  }
+  if (!model_names.empty() && missing.empty()) return robots;
+
+  // Parse the file once, and select the models to build.
+  const std::vector<sdf::Model> models = GetSdfModels(file_path, true);
+  std::vector<const sdf::Model *> selected;
+  if (model_names.empty()) {
+    for (auto &&model : models) selected.push_back(&model);
+  } else {
+    for (auto &&name : missing) {
+      auto it = std::find_if(
+          models.begin(), models.end(),
+          [&name](const sdf::Model &model) { return model.Name() == name; });
+      if (it == models.end())
+        throw std::runtime_error("Model " + name + " not found in: " +
+                                 file_path);
+      selected.push_back(&*it);
+    }
+  }
+
+  // Robots are independent, so they can be built in parallel.
+  std::vector<Robot> built(selected.size());
+  ThreadPool pool(num_threads);
+  pool.parallelFor(selected.size(), [&](size_t i, size_t /*worker*/) {
+    built[i] = RobotFromSdf(*selected[i], lump_fixed_joints);
+  });
+
+  for (size_t i = 0; i < selected.size(); i++) {
+    const std::string &name = selected[i]->Name();
+    if (use_cache)
+      SaveCachedRobot(CachePath(file_path, name, lump_fixed_joints),
+                      built[i]);
+    robots.emplace(name, built[i]);
+  }
+  return robots;
 }
 
 }  // namespace gtdynamics
@@ -13,7 +13,9 @@
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "gtdynamics/universal_robot/Robot.h"
 
@@ -24,8 +26,38 @@ namespace gtdynamics {
  * @param[in] file_path path to the file.
  * @param[in] model_name name of the robot we care about. Must be specified in
  *    case sdf_file_path points to a world file.
+ * @param[in] use_cache if true, load the robot from the binary cache of
+ *    RobotCache.h when the file was parsed before, and save it otherwise.
+ * @param[in] lump_fixed_joints if true, merge links connected by fixed joints
+ *    into one link with their combined inertia, named after the link closest
+ *    to the root. Merged links remain as frames of the robot, see
+ *    Robot::frame, and joint ids are renumbered densely. Otherwise fixed
+ *    joints other than to the world are not supported.
+ *
+ * Named frames of the model, such as those the URDF parser of sdformat
+ * creates for the links it merges itself, are added as Robot frames. Visual
+ * and collision elements are dropped before the model is loaded, as only
+ * inertial and frame data make up a Robot.
  */
 Robot CreateRobotFromFile(const std::string &file_path,
-                          const std::string &model_name = "");
+                          const std::string &model_name = "",
+                          bool use_cache = true,
+                          bool lump_fixed_joints = false);
+
+/**
+ * @fn Construct several robots from one urdf or sdf file, parsing it once.
+ * @param[in] file_path path to the file, typically an sdf world file.
+ * @param[in] model_names names of the models to construct; all models in the
+ *    file if empty.
+ * @param[in] num_threads threads constructing robots, 0 for all cores.
+ * @param[in] use_cache as in CreateRobotFromFile; if all named models are
+ *    in the cache, the file is not parsed at all.
+ * @param[in] lump_fixed_joints as in CreateRobotFromFile.
+ * @return robots by model name.
+ */
+std::map<std::string, Robot> CreateRobotsFromFile(
+    const std::string &file_path,
+    const std::vector<std::string> &model_names = {}, size_t num_threads = 1,
+    bool use_cache = true, bool lump_fixed_joints = false);
 
 }  // namespace gtdynamics
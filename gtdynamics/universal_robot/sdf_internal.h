@@ -16,6 +16,7 @@
 #include <ignition/math/Pose3.hh>
 #include <sdf/sdf.hh>
 #include <string>
+#include <vector>
 
 #include "gtdynamics/universal_robot/Robot.h"
 
@@ -27,17 +28,32 @@ namespace gtdynamics {
  * @param sdf_file_path a string containing the absolute to the sdf file.
  * @param model_name name of the robot we care about. Must be specified in case
  * sdf_file_path points to a world file.
+ * @param dynamics_only if true, load the links without their visual and
+ * collision elements, which Robot does not use, skipping their geometry
+ * and meshes. Load the full model when geometry is needed.
  * @return SDF Model
  */
 sdf::Model GetSdf(const std::string &sdf_file_path,
-                  const std::string &model_name = "");
+                  const std::string &model_name = "",
+                  bool dynamics_only = false);
+
+/**
+ * Parse an SDF or URDF file once and return all its models: the models of the
+ * world in a world file, or the single model otherwise.
+ *
+ * @param sdf_file_path a string containing the absolute to the sdf file.
+ * @param dynamics_only as in GetSdf.
+ * @return SDF Models, in file order
+ */
+std::vector<sdf::Model> GetSdfModels(const std::string &sdf_file_path,
+                                     bool dynamics_only = false);
 
 /**
  * @fn Construct a Link class from sdf::Link
  * @param[in] sdf_link
  * @return LinkSharedPtr
  */
-LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link);
+LinkSharedPtr LinkFromSdf(DynamicsIndex id, const sdf::Link &sdf_link);
 
 /**
  * @fn Construct a Link from sdf file
@@ -47,7 +63,7 @@ LinkSharedPtr LinkFromSdf(uint8_t id, const sdf::Link &sdf_link);
  * @param[in] model_name    name of the robot
  * @return LinkSharedPtr
  */
-LinkSharedPtr LinkFromSdf(uint8_t id, const std::string &name,
+LinkSharedPtr LinkFromSdf(DynamicsIndex id, const std::string &name,
                           const std::string &sdf_file_path,
                           const std::string &model_name = "");
 
@@ -58,7 +74,7 @@ LinkSharedPtr LinkFromSdf(uint8_t id, const std::string &name,
  * @param[in] sdf_joint
  * @return LinkSharedPtr
  */
-JointSharedPtr JointFromSdf(uint8_t id, const LinkSharedPtr &parent_link,
+JointSharedPtr JointFromSdf(DynamicsIndex id, const LinkSharedPtr &parent_link,
                             const LinkSharedPtr &child_link,
                             const sdf::Joint &sdf_joint);
 
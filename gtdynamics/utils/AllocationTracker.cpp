@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AllocationTracker.cpp
+ * @brief Counting of the heap allocations of a scope.
+ */
+
+#include "gtdynamics/utils/AllocationTracker.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace gtdynamics {
+
+namespace {
+// Running totals of this thread; trivially constructible, so they can be
+// used from operator new before any other initialization. Blocks freed on
+// another thread than the one that allocated them can make in_use negative.
+struct Counters {
+  size_t allocations, bytes_allocated, bytes_freed;
+  int64_t in_use, peak;
+};
+thread_local Counters counters = {0, 0, 0, 0, 0};
+
+#ifdef GTDYNAMICS_ENABLE_ALLOCATION_TRACKING
+// Size of the header in front of each block, which keeps the default
+// alignment of operator new.
+constexpr size_t kHeader = 16;
+static_assert(kHeader >= alignof(std::max_align_t) &&
+                  kHeader >= sizeof(size_t),
+              "the header has to hold the size and keep blocks aligned");
+
+void *Allocate(size_t size) noexcept {
+  if (size == 0) size = 1;  // unique pointers even for empty blocks
+  char *block = static_cast<char *>(std::malloc(size + kHeader));
+  if (!block) return nullptr;
+  *reinterpret_cast<size_t *>(block) = size;
+  Counters &c = counters;
+  ++c.allocations;
+  c.bytes_allocated += size;
+  c.in_use += size;
+  c.peak = std::max(c.peak, c.in_use);
+  return block + kHeader;
+}
+
+void *AllocateOrThrow(size_t size) {
+  while (true) {
+    if (void *p = Allocate(size)) return p;
+    const std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+}
+
+void Free(void *p) noexcept {
+  if (!p) return;
+  char *block = static_cast<char *>(p) - kHeader;
+  const size_t size = *reinterpret_cast<size_t *>(block);
+  counters.bytes_freed += size;
+  counters.in_use -= size;
+  std::free(block);
+}
+#endif  // GTDYNAMICS_ENABLE_ALLOCATION_TRACKING
+}  // namespace
+
+/* ************************************************************************* */
+AllocationScope::AllocationScope() {
+  start_.allocations = counters.allocations;
+  start_.bytes_allocated = counters.bytes_allocated;
+  start_.bytes_freed = counters.bytes_freed;
+  start_in_use_ = counters.in_use;
+  outer_peak_ = counters.peak;
+  counters.peak = counters.in_use;
+}
+
+/* ************************************************************************* */
+AllocationScope::~AllocationScope() {
+  counters.peak = std::max(counters.peak, outer_peak_);
+}
+
+/* ************************************************************************* */
+AllocationStats AllocationScope::stats() const {
+  AllocationStats stats;
+  stats.allocations = counters.allocations - start_.allocations;
+  stats.bytes_allocated = counters.bytes_allocated - start_.bytes_allocated;
+  stats.bytes_freed = counters.bytes_freed - start_.bytes_freed;
+  stats.peak_bytes = static_cast<size_t>(
+      std::max<int64_t>(counters.peak - start_in_use_, 0));
+  return stats;
+}
+
+}  // namespace gtdynamics
+
+#ifdef GTDYNAMICS_ENABLE_ALLOCATION_TRACKING
+
+void *operator new(size_t size) {
+  return gtdynamics::AllocateOrThrow(size);
+}
+
+void *operator new[](size_t size) {
+  return gtdynamics::AllocateOrThrow(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return gtdynamics::Allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return gtdynamics::Allocate(size);
+}
+
+void operator delete(void *p) noexcept { gtdynamics::Free(p); }
+
+void operator delete[](void *p) noexcept { gtdynamics::Free(p); }
+
+void operator delete(void *p, const std::nothrow_t &) noexcept {
+  gtdynamics::Free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept {
+  gtdynamics::Free(p);
+}
+
+void operator delete(void *p, size_t) noexcept { gtdynamics::Free(p); }
+
+void operator delete[](void *p, size_t) noexcept { gtdynamics::Free(p); }
+
+#endif  // GTDYNAMICS_ENABLE_ALLOCATION_TRACKING
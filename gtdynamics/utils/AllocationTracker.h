@@ -0,0 +1,75 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  AllocationTracker.h
+ * @brief Counting of the heap allocations of a scope.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gtdynamics/config.h"
+
+namespace gtdynamics {
+
+/// Heap use of the calling thread within an AllocationScope.
+struct AllocationStats {
+  size_t allocations = 0;      ///< calls to operator new
+  size_t bytes_allocated = 0;  ///< bytes requested from operator new
+  size_t bytes_freed = 0;      ///< bytes returned to operator delete
+  size_t peak_bytes = 0;       ///< largest allocated minus freed bytes
+
+  /// Bytes allocated and not freed, e.g. those held by a built graph.
+  size_t retainedBytes() const {
+    return bytes_allocated > bytes_freed ? bytes_allocated - bytes_freed : 0;
+  }
+};
+
+/**
+ * AllocationScope counts the heap allocations of the calling thread from its
+ * construction on, e.g. to measure the bytes a factor graph takes:
+ *
+ *     AllocationScope scope;
+ *     const auto graph = graph_builder.dynamicsFactorGraph(robot, k);
+ *     const size_t bytes = scope.stats().retainedBytes();
+ *
+ * Counting replaces the global operator new and delete, which then keep the
+ * size of every block in a 16 byte header, so it is only compiled in when
+ * configured with GTDYNAMICS_ENABLE_ALLOCATION_TRACKING. Otherwise all
+ * statistics stay 0. Compiled in, every allocation of the process pays a few
+ * thread-local additions. Allocations of other threads, e.g. of a
+ * ThreadPool, are not counted. Scopes can be nested.
+ */
+class AllocationScope {
+ public:
+  /// Whether counting is compiled in.
+  static constexpr bool kCompiled =
+#ifdef GTDYNAMICS_ENABLE_ALLOCATION_TRACKING
+      true;
+#else
+      false;
+#endif
+
+  AllocationScope();
+  ~AllocationScope();
+
+  AllocationScope(const AllocationScope &) = delete;
+  AllocationScope &operator=(const AllocationScope &) = delete;
+
+  /// Heap use of this thread since construction.
+  AllocationStats stats() const;
+
+ private:
+  AllocationStats start_;
+  int64_t start_in_use_;
+  int64_t outer_peak_;  // peak of the enclosing scopes, restored on exit
+};
+
+}  // namespace gtdynamics
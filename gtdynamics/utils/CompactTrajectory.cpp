@@ -0,0 +1,222 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompactTrajectory.cpp
+ * @brief Trajectory stored in joint space, with link states derived lazily.
+ */
+
+#include "gtdynamics/utils/CompactTrajectory.h"
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/TrajectoryFile.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+CompactTrajectory::CompactTrajectory(const Robot &robot)
+    : compiled_(std::make_shared<CompiledRobot>(robot)) {
+  for (auto &&joint : robot.joints()) joint_ids_.push_back(joint->id());
+  for (auto &&link : robot.links()) link_ids_.push_back(link->id());
+  for (size_t n = 0; n < compiled_->numNodes(); ++n) {
+    const int i = compiled_->linkIds()[n];
+    if (compiled_->parentNodes()[n] < 0 && !compiled_->isFixed()[i])
+      root_ids_.push_back(i);
+  }
+}
+
+/* ************************************************************************* */
+CompactTrajectory::CompactTrajectory(const Robot &robot, const Values &values,
+                                     int num_steps)
+    : CompactTrajectory(robot) {
+  const size_t T = num_steps + 1, J = compiled_->numJointSlots(),
+               R = root_ids_.size();
+  q_.setZero(J, T);
+  v_.setZero(J, T);
+  a_.setZero(J, T);
+  tau_.setZero(J, T);
+  root_poses_.resize(T * R);
+  root_twists_.setZero(6, T * R);
+  for (size_t t = 0; t < T; ++t) {
+    for (const int j : joint_ids_) {
+      if (values.exists(internal::JointAngleKey(j, t)))
+        q_(j, t) = JointAngle(values, j, t);
+      if (values.exists(internal::JointVelKey(j, t)))
+        v_(j, t) = JointVel(values, j, t);
+      if (values.exists(internal::JointAccelKey(j, t)))
+        a_(j, t) = JointAccel(values, j, t);
+      if (values.exists(internal::TorqueKey(j, t)))
+        tau_(j, t) = Torque(values, j, t);
+    }
+    for (size_t r = 0; r < R; ++r) {
+      const int i = root_ids_[r];
+      if (!values.exists(internal::PoseKey(i, t)))
+        throw std::invalid_argument(
+            "CompactTrajectory: missing pose of floating root " +
+            std::to_string(i) + " at step " + std::to_string(t));
+      root_poses_[t * R + r] = Pose(values, i, t);
+      if (values.exists(internal::TwistKey(i, t)))
+        root_twists_.col(t * R + r) = Twist(values, i, t);
+    }
+  }
+
+  // Contact wrenches, the 'C' keys.
+  std::map<std::pair<int, int>, Matrix> contacts;
+  for (auto &&key : values.keys()) {
+    const DynamicsSymbol symbol(key);
+    if (symbol.label() != "C" || symbol.time() >= T) continue;
+    Matrix &wrenches = contacts[{symbol.linkIdx(), symbol.jointIdx()}];
+    if (wrenches.size() == 0) wrenches.setZero(6, T);
+    wrenches.col(symbol.time()) = values.at<gtsam::Vector6>(key);
+  }
+  for (auto &&kv : contacts)
+    contacts_.push_back({kv.first.first, kv.first.second, kv.second});
+}
+
+/* ************************************************************************* */
+CompactTrajectory CompactTrajectory::Load(const Robot &robot,
+                                          const std::string &path) {
+  std::ifstream is(path, std::ios::binary);
+  if (!is.good())
+    throw std::runtime_error("CompactTrajectory: no file found at " + path);
+  CompactTrajectory trajectory(robot);
+  const std::vector<int> root_ids = trajectory.root_ids_;
+  boost::archive::binary_iarchive ar(is);
+  ar >> trajectory;
+  if (trajectory.root_ids_ != root_ids ||
+      static_cast<size_t>(trajectory.q_.rows()) !=
+          trajectory.compiled_->numJointSlots())
+    throw std::runtime_error("CompactTrajectory: " + path +
+                             " was saved for a different robot");
+  return trajectory;
+}
+
+/* ************************************************************************* */
+void CompactTrajectory::save(const std::string &path) const {
+  std::ofstream os(path, std::ios::binary);
+  if (!os.good())
+    throw std::runtime_error("CompactTrajectory: cannot write " + path);
+  boost::archive::binary_oarchive ar(os);
+  ar << *this;
+}
+
+/* ************************************************************************* */
+void CompactTrajectory::saveColumnar(const std::string &path) const {
+  // The #slots x #steps column-major matrices are the #steps x #slots
+  // row-major arrays of the file. When every slot is a joint they are
+  // written in place, otherwise the joint rows are gathered first.
+  std::vector<int> ids = joint_ids_;
+  std::sort(ids.begin(), ids.end());
+  const size_t J = q_.rows(), T = numSteps();
+  bool dense = ids.size() == J;
+  for (size_t e = 0; dense && e < J; ++e) dense = ids[e] == static_cast<int>(e);
+
+  const std::vector<std::pair<std::string, const Matrix *>> matrices = {
+      {"q", &q_}, {"v", &v_}, {"a", &a_}, {"tau", &tau_}};
+  std::vector<Matrix> gathered;
+  gathered.reserve(matrices.size());  // keeps the data pointers valid
+  std::vector<TrajectoryFile::Array> arrays;
+  for (auto &&kv : matrices) {
+    const double *data = kv.second->data();
+    if (!dense) {
+      gathered.emplace_back(ids.size(), T);
+      for (size_t e = 0; e < ids.size(); ++e)
+        gathered.back().row(e) = kv.second->row(ids[e]);
+      data = gathered.back().data();
+    }
+    arrays.push_back({kv.first, ids, 1, data});
+  }
+  TrajectoryFile::Write(path, T, arrays);
+}
+
+/* ************************************************************************* */
+void CompactTrajectory::derive(int t) const {
+  if (t < 0 || static_cast<size_t>(t) >= numSteps())
+    throw std::out_of_range("CompactTrajectory: no step " + std::to_string(t));
+  if (cached_.size() != numSteps()) {
+    cached_.assign(numSteps(), false);
+    pose_cache_.resize(numSteps());
+    twist_cache_.resize(numSteps());
+  }
+  if (cached_[t]) return;
+
+  std::vector<Pose3> &poses = pose_cache_[t];
+  Matrix &twists = twist_cache_[t];
+  poses.assign(compiled_->numLinkSlots(), Pose3());
+  twists.setZero(6, compiled_->numLinkSlots());
+  const size_t R = root_ids_.size();
+  for (size_t r = 0; r < R; ++r) {
+    poses[root_ids_[r]] = root_poses_[t * R + r];
+    twists.col(root_ids_[r]) = root_twists_.col(t * R + r);
+  }
+  compiled_->forwardKinematics(q_.col(t), v_.col(t), &poses, &twists);
+  cached_[t] = true;
+}
+
+/* ************************************************************************* */
+const std::vector<Pose3> &CompactTrajectory::poses(int t) const {
+  derive(t);
+  return pose_cache_[t];
+}
+
+/* ************************************************************************* */
+const Matrix &CompactTrajectory::twists(int t) const {
+  derive(t);
+  return twist_cache_[t];
+}
+
+/* ************************************************************************* */
+void CompactTrajectory::clearCache() const {
+  cached_.clear();
+  pose_cache_.clear();
+  twist_cache_.clear();
+}
+
+/* ************************************************************************* */
+Values CompactTrajectory::toValues() const {
+  Values values;
+  for (size_t t = 0; t < numSteps(); ++t) {
+    for (const int j : joint_ids_) {
+      InsertJointAngle(&values, j, t, q_(j, t));
+      InsertJointVel(&values, j, t, v_(j, t));
+      InsertJointAccel(&values, j, t, a_(j, t));
+      InsertTorque(&values, j, t, tau_(j, t));
+    }
+    for (const int i : link_ids_) {
+      InsertPose(&values, i, t, pose(i, t));
+      InsertTwist(&values, i, t, twist(i, t));
+    }
+    for (auto &&contact : contacts_)
+      values.insert(ContactWrenchKey(contact.link_id, contact.contact_id, t),
+                    gtsam::Vector6(contact.wrenches.col(t)));
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+size_t CompactTrajectory::storageBytes() const {
+  size_t doubles = q_.size() + v_.size() + a_.size() + tau_.size() +
+                   12 * root_poses_.size() + root_twists_.size();
+  for (auto &&contact : contacts_) doubles += contact.wrenches.size();
+  return sizeof(double) * doubles;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  CompactTrajectory.h
+ * @brief Trajectory stored in joint space, with link states derived lazily.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/vector.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * CompactTrajectory keeps only what determines the state of a tree robot
+ * over a trajectory: the joint angles, velocities, accelerations and torques,
+ * the pose and twist of every floating root, and the contact wrenches. Link
+ * poses and twists are reconstructed on demand by CompiledRobot forward
+ * kinematics, one time step at a time, and cached until clearCache(). The
+ * joint wrenches and twist accelerations of a trajectoryFG solution are not
+ * kept.
+ *
+ * The cache makes the const accessors not thread-safe.
+ */
+class CompactTrajectory {
+ public:
+  /// Wrenches of contact `contact_id` on link `link_id`, 6 x #steps.
+  struct ContactWrenches {
+    int link_id, contact_id;
+    gtsam::Matrix wrenches;
+
+    template <class ARCHIVE>
+    void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+      ar &link_id &contact_id &wrenches;
+    }
+  };
+
+  /**
+   * Extract the trajectory from `values`, e.g. a trajectoryFG solution.
+   * Joint quantities that are missing are zero.
+   * @param robot      the robot, which needs to have a tree structure
+   * @param values     values of the trajectory
+   * @param num_steps  index of the last time step, steps 0..num_steps are kept
+   */
+  CompactTrajectory(const Robot &robot, const gtsam::Values &values,
+                    int num_steps);
+
+  /**
+   * Load a trajectory saved with save(), for the same robot.
+   * Throws std::runtime_error if the file cannot be read or does not match.
+   */
+  static CompactTrajectory Load(const Robot &robot, const std::string &path);
+
+  /// Save as a Boost binary archive, without the robot.
+  void save(const std::string &path) const;
+
+  /**
+   * Save the joint angles, velocities, accelerations and torques as a
+   * TrajectoryFile, written straight from the joint matrices, for replay
+   * and for analysis tools that read the file without the robot.
+   */
+  void saveColumnar(const std::string &path) const;
+
+  /// Number of time steps kept.
+  size_t numSteps() const { return q_.cols(); }
+
+  /// @name Joint space, #joint slots x #steps
+  /// @{
+  const gtsam::Matrix &jointAngles() const { return q_; }
+  const gtsam::Matrix &jointVels() const { return v_; }
+  const gtsam::Matrix &jointAccels() const { return a_; }
+  const gtsam::Matrix &torques() const { return tau_; }
+  /// @}
+
+  /// Contact wrenches, in order of link and contact id.
+  const std::vector<ContactWrenches> &contactWrenches() const {
+    return contacts_;
+  }
+
+  /// @name Derived link states
+  /// @{
+
+  /// CoM poses of all links at step t, indexed by link id.
+  const std::vector<gtsam::Pose3> &poses(int t) const;
+
+  /// Twists of all links at step t, 6 x #link slots.
+  const gtsam::Matrix &twists(int t) const;
+
+  /// CoM pose of link i at step t.
+  const gtsam::Pose3 &pose(int i, int t) const { return poses(t)[i]; }
+
+  /// Twist of link i at step t.
+  gtsam::Vector6 twist(int i, int t) const { return twists(t).col(i); }
+
+  /// Drop the cached link states.
+  void clearCache() const;
+
+  /// @}
+
+  /**
+   * All kept and derived quantities as Values, with the keys of
+   * utils/values.h and ContactWrenchKey: joint angles, velocities,
+   * accelerations and torques, link poses and twists, and contact wrenches.
+   */
+  gtsam::Values toValues() const;
+
+  /// Number of bytes of the kept arrays, excluding the cache.
+  size_t storageBytes() const;
+
+ private:
+  friend class boost::serialization::access;
+
+  explicit CompactTrajectory(const Robot &robot);
+
+  // Compute the link states at step t, if not cached.
+  void derive(int t) const;
+
+  template <class ARCHIVE>
+  void serialize(ARCHIVE &ar, const unsigned int /*version*/) {
+    ar &q_ &v_ &a_ &tau_ &root_ids_ &root_poses_ &root_twists_ &contacts_;
+  }
+
+  std::shared_ptr<const CompiledRobot> compiled_;
+  std::vector<int> joint_ids_, link_ids_;
+
+  gtsam::Matrix q_, v_, a_, tau_;
+  std::vector<int> root_ids_;             // floating roots
+  std::vector<gtsam::Pose3> root_poses_;  // step t * #roots + r
+  gtsam::Matrix root_twists_;             // 6 x (#steps * #roots)
+  std::vector<ContactWrenches> contacts_;
+
+  mutable std::vector<bool> cached_;
+  mutable std::vector<std::vector<gtsam::Pose3>> pose_cache_;
+  mutable std::vector<gtsam::Matrix> twist_cache_;
+};
+
+}  // namespace gtdynamics
@@ -16,26 +16,47 @@
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include <iostream>
+#include <stdexcept>
 
 using gtsam::Key;
 namespace gtdynamics {
 
-/* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol()
-    : c1_(0), c2_(0), link_idx_(0), joint_idx_(0), t_(0) {}
-
-/* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol(const DynamicsSymbol& key)
-    : c1_(key.c1_),
-      c2_(key.c2_),
-      link_idx_(key.link_idx_),
-      joint_idx_(key.joint_idx_),
-      t_(key.t_) {}
+constexpr DynamicsIndex DynamicsSymbol::kMaxIndex;
+constexpr DynamicsIndex DynamicsSymbol::kNoIndex;
+constexpr size_t DynamicsSymbol::kRobotBits;
+constexpr size_t DynamicsSymbol::kMaxRobot;
+constexpr size_t DynamicsSymbol::kMaxFormatLength;
+
+// Write the decimal digits of n at p, return the end.
+static char* WriteUnsigned(uint64_t n, char* p) {
+  char digits[20];
+  int count = 0;
+  do {
+    digits[count++] = char('0' + n % 10);
+    n /= 10;
+  } while (n);
+  while (count) *p++ = digits[--count];
+  return p;
+}
 
 /* ************************************************************************* */
-DynamicsSymbol::DynamicsSymbol(const std::string& s, uint8_t link_idx,
-                               uint8_t joint_idx, uint64_t t)
-    : link_idx_(link_idx), joint_idx_(joint_idx), t_(t) {
+DynamicsSymbol::DynamicsSymbol(const std::string& s, int64_t link_idx,
+                               int64_t joint_idx, uint64_t t)
+    : t_(t) {
+  // Check before narrowing, so large or negative ids cannot wrap around.
+  if (link_idx < 0 || joint_idx < 0) {
+    throw std::out_of_range("negative link or joint index for dynamics symbol");
+  }
+  if (link_idx > kNoIndex || joint_idx > kNoIndex) {
+    throw std::out_of_range(
+        "link or joint index too large for dynamics symbol, configure with "
+        "GTDYNAMICS_WIDE_KEYS");
+  }
+  link_idx_ = DynamicsIndex(link_idx);
+  joint_idx_ = DynamicsIndex(joint_idx);
+  if (t > time_mask) {
+    throw std::out_of_range("time index too large for dynamics symbol");
+  }
   if (s.length() > 2) {
     throw std::runtime_error(
         "cannot use more than 2 characters in dynamics symbol");
@@ -53,44 +74,32 @@ DynamicsSymbol::DynamicsSymbol(const std::string& s, uint8_t link_idx,
 }
 
 DynamicsSymbol DynamicsSymbol::LinkJointSymbol(const std::string& s,
-                                               uint8_t link_idx,
-                                               uint8_t joint_idx,
-                                               uint64_t t) {
+                                               int64_t link_idx,
+                                               int64_t joint_idx, uint64_t t) {
   return DynamicsSymbol(s, link_idx, joint_idx, t);
 }
 
 DynamicsSymbol DynamicsSymbol::JointSymbol(const std::string& s,
-                                           uint8_t joint_idx,
-                                           uint64_t t) {
-  return DynamicsSymbol(s, kMax_uchar_, joint_idx, t);
+                                           int64_t joint_idx, uint64_t t) {
+  return DynamicsSymbol(s, kNoIndex, joint_idx, t);
 }
 
 DynamicsSymbol DynamicsSymbol::LinkSymbol(const std::string& s,
-                                          uint8_t link_idx, uint64_t t) {
-  return DynamicsSymbol(s, link_idx, kMax_uchar_, t);
+                                          int64_t link_idx, uint64_t t) {
+  return DynamicsSymbol(s, link_idx, kNoIndex, t);
 }
 
 DynamicsSymbol DynamicsSymbol::SimpleSymbol(const std::string& s, uint64_t t) {
-  return DynamicsSymbol(s, kMax_uchar_, kMax_uchar_, t);
+  return DynamicsSymbol(s, kNoIndex, kNoIndex, t);
 }
 
 /* ************************************************************************* */
 DynamicsSymbol::DynamicsSymbol(const Key& key) {
   c1_ = (uint8_t)((key & ch1_mask) >> (key_bits - ch1_bits));
   c2_ = (uint8_t)((key & ch2_mask) >> (key_bits - ch1_bits - ch2_bits));
-  link_idx_ = (uint8_t)((key & link_mask) >> (time_bits + joint_bits));
-  joint_idx_ = (uint8_t)((key & joint_mask) >> time_bits);
-  t_ = key & time_mask;
-}
-
-/* ************************************************************************* */
-DynamicsSymbol::operator Key() const {
-  Key ch1_comp = Key(c1_) << (key_bits - ch1_bits);
-  Key ch2_comp = Key(c2_) << (key_bits - ch1_bits - ch2_bits);
-  Key link_comp = Key(link_idx_) << (time_bits + joint_bits);
-  Key joint_comp = Key(joint_idx_) << time_bits;
-  Key key = ch1_comp | ch2_comp | link_comp | joint_comp | t_;
-  return key;
+  link_idx_ = LinkIdx(key);
+  joint_idx_ = JointIdx(key);
+  t_ = Time(key);
 }
 
 /* ************************************************************************* */
@@ -115,19 +124,39 @@ void DynamicsSymbol::print(const std::string& s) const {
 
 /* ************************************************************************* */
 DynamicsSymbol::operator std::string() const {
-  std::string s = label();
-  if (link_idx_ != kMax_uchar_) {
-    s += "[" + std::to_string((int)(link_idx_)) + "]";
+  char buffer[kMaxFormatLength];
+  return std::string(buffer, Format(key(), buffer));
+}
+
+/* ************************************************************************* */
+char* DynamicsSymbol::Format(Key key, char* buffer) {
+  char* p = buffer;
+  const char c1 = char((key & ch1_mask) >> (key_bits - ch1_bits));
+  const char c2 = char((key & ch2_mask) >> (key_bits - ch1_bits - ch2_bits));
+  if (c1 != 0) *p++ = c1;
+  if (c2 != 0) *p++ = c2;
+  if (LinkIdx(key) != kNoIndex) {
+    *p++ = '[';
+    p = WriteUnsigned(LinkIdx(key), p);
+    *p++ = ']';
   }
-  if (joint_idx_ != kMax_uchar_) {
-    s += "(" + std::to_string((int)(joint_idx_)) + ")";
+  if (JointIdx(key) != kNoIndex) {
+    *p++ = '(';
+    p = WriteUnsigned(JointIdx(key), p);
+    *p++ = ')';
   }
-  s += std::to_string(t_);
-  return s;
+  p = WriteUnsigned(Step(Time(key)), p);
+  if (RobotInstance(Time(key)) != 0) {
+    *p++ = '@';
+    p = WriteUnsigned(RobotInstance(Time(key)), p);
+  }
+  return p;
 }
 
+/* ************************************************************************* */
 std::string _GTDKeyFormatter(Key key) {
-  return std::string(DynamicsSymbol(key));
+  char buffer[DynamicsSymbol::kMaxFormatLength];
+  return std::string(buffer, DynamicsSymbol::Format(key, buffer));
 }
 
 /* ************************************************************************* */
@@ -16,11 +16,49 @@
 #include <gtsam/inference/Key.h>
 #include <gtsam/inference/Symbol.h>
 
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/config.h"
+
 namespace gtdynamics {
 
+/**
+ * Type of link and joint ids. By default keys hold 8-bit link and joint
+ * indices next to a 32-bit time index. Configuring with GTDYNAMICS_WIDE_KEYS
+ * switches to 12-bit indices (up to 4094 links and joints) and a 24-bit time
+ * index, for multi-robot or finely discretized models.
+ */
+#ifdef GTDYNAMICS_WIDE_KEYS
+using DynamicsIndex = uint16_t;
+constexpr size_t kDynamicsIndexBits = 12;
+#else
+using DynamicsIndex = uint8_t;
+constexpr size_t kDynamicsIndexBits = 8;
+#endif
+
+/**
+ * Label of a dynamics symbol, 1 or 2 characters known at compile time, e.g.
+ * DynamicsLabel('q') or DynamicsLabel('d', 'x'). Unlike a std::string label,
+ * it needs no length check and can be folded into constant key prefixes.
+ */
+struct DynamicsLabel {
+  uint8_t c1, c2;
+
+  /// Single-character label.
+  constexpr DynamicsLabel(char c) : c1(0), c2(uint8_t(c)) {}
+
+  /// Two-character label.
+  constexpr DynamicsLabel(char c1, char c2)
+      : c1(uint8_t(c1)), c2(uint8_t(c2)) {}
+};
+
 class DynamicsSymbol {
  protected:
-  uint8_t c1_, c2_, link_idx_, joint_idx_;
+  uint8_t c1_, c2_;
+  DynamicsIndex link_idx_, joint_idx_;
   uint64_t t_;
 
  private:
@@ -31,24 +69,54 @@ class DynamicsSymbol {
    * @param[in] link_idx  index of the link
    * @param[in] joint_idx index of the joint
    * @param[in] t         time step
+   * @throws std::out_of_range for indices outside 0..kNoIndex
    */
-  DynamicsSymbol(const std::string& s, uint8_t link_idx,
-                 uint8_t joint_idx, uint64_t t);
+  DynamicsSymbol(const std::string& s, int64_t link_idx, int64_t joint_idx,
+                 uint64_t t);
+
+  /// Constructor with a compile-time label, see DynamicsLabel. Indices are
+  /// checked before narrowing, so a constant out-of-range index fails to
+  /// compile and a runtime one throws std::out_of_range.
+  constexpr DynamicsSymbol(DynamicsLabel label, int64_t link_idx,
+                           int64_t joint_idx, uint64_t t)
+      : c1_(label.c1),
+        c2_(label.c2),
+        link_idx_(link_idx < 0
+                      ? throw std::out_of_range(
+                            "negative link index for dynamics symbol")
+                  : link_idx <= kNoIndex
+                      ? DynamicsIndex(link_idx)
+                      : throw std::out_of_range(
+                            "link index too large for dynamics symbol, "
+                            "configure with GTDYNAMICS_WIDE_KEYS")),
+        joint_idx_(joint_idx < 0
+                       ? throw std::out_of_range(
+                             "negative joint index for dynamics symbol")
+                   : joint_idx <= kNoIndex
+                       ? DynamicsIndex(joint_idx)
+                       : throw std::out_of_range(
+                             "joint index too large for dynamics symbol, "
+                             "configure with GTDYNAMICS_WIDE_KEYS")),
+        t_(t <= time_mask ? t
+                          : throw std::out_of_range(
+                                "time index too large for dynamics symbol")) {
+  }
 
  public:
   /** Default constructor */
-  DynamicsSymbol();
+  constexpr DynamicsSymbol()
+      : c1_(0), c2_(0), link_idx_(0), joint_idx_(0), t_(0) {}
 
   /** Copy constructor */
-  DynamicsSymbol(const DynamicsSymbol& key);
+  constexpr DynamicsSymbol(const DynamicsSymbol& key) = default;
 
   /**
    * Constructor for symbol related to both link and joint.
    *  See private constructor
    */
   static DynamicsSymbol LinkJointSymbol(const std::string& s,
-                                        uint8_t link_idx,
-                                        uint8_t joint_idx, uint64_t t);
+                                        int64_t link_idx, int64_t joint_idx,
+                                        uint64_t t);
 
   /**
    * Constructor for symbol related to only joint (e.g. joint angle).
@@ -57,17 +125,17 @@ class DynamicsSymbol {
    * @param[in] joint_idx index of the joint
    * @param[in] t         time step
    */
-  static DynamicsSymbol JointSymbol(const std::string& s,
-                                    uint8_t joint_idx, uint64_t t);
+  static DynamicsSymbol JointSymbol(const std::string& s, int64_t joint_idx,
+                                    uint64_t t);
 
   /**
    * Constructor for symbol related to only link (e.g. link pose).
    *
    * @param[in] s         1 or 2 characters to represent the variable type
-   * @param[in] joint_idx index of the joint
+   * @param[in] link_idx  index of the link
    * @param[in] t         time step
    */
-  static DynamicsSymbol LinkSymbol(const std::string& s, uint8_t link_idx,
+  static DynamicsSymbol LinkSymbol(const std::string& s, int64_t link_idx,
                                    uint64_t t);
 
   /**
@@ -78,26 +146,146 @@ class DynamicsSymbol {
    */
   static DynamicsSymbol SimpleSymbol(const std::string& s, uint64_t t);
 
+  /// @name Constructors with compile-time labels
+  /// These skip the label checks of the string versions, and with constant
+  /// arguments fold into constant keys, e.g. JointSymbol('q', j, t).
+  /// @{
+
+  static constexpr DynamicsSymbol LinkJointSymbol(DynamicsLabel label,
+                                                  int64_t link_idx,
+                                                  int64_t joint_idx,
+                                                  uint64_t t) {
+    return DynamicsSymbol(label, link_idx, joint_idx, t);
+  }
+
+  static constexpr DynamicsSymbol JointSymbol(DynamicsLabel label,
+                                              int64_t joint_idx,
+                                              uint64_t t) {
+    return DynamicsSymbol(label, kNoIndex, joint_idx, t);
+  }
+
+  static constexpr DynamicsSymbol LinkSymbol(DynamicsLabel label,
+                                             int64_t link_idx,
+                                             uint64_t t) {
+    return DynamicsSymbol(label, link_idx, kNoIndex, t);
+  }
+
+  static constexpr DynamicsSymbol SimpleSymbol(DynamicsLabel label,
+                                               uint64_t t) {
+    return DynamicsSymbol(label, kNoIndex, kNoIndex, t);
+  }
+
+  /// Integer key of a label, with link, joint and time index zero. Keys of
+  /// the same quantity differ from it only in the index bits.
+  static constexpr gtsam::Key LabelPrefix(DynamicsLabel label) {
+    return (gtsam::Key(label.c1) << (key_bits - ch1_bits)) |
+           (gtsam::Key(label.c2) << (key_bits - ch1_bits - ch2_bits));
+  }
+
+  /// @}
+
   /**
    * Constructor that decodes an integer gtsam::Key
    */
   DynamicsSymbol(const gtsam::Key& key);
 
   /// Cast to a GTSAM Key.
-  operator gtsam::Key() const;
+  constexpr operator gtsam::Key() const {
+    return (gtsam::Key(c1_) << (key_bits - ch1_bits)) |
+           (gtsam::Key(c2_) << (key_bits - ch1_bits - ch2_bits)) |
+           (gtsam::Key(link_idx_) << (time_bits + joint_bits)) |
+           (gtsam::Key(joint_idx_) << time_bits) | t_;
+  }
 
   /// Return string label.
   std::string label() const;
 
   /// Return link id.
-  inline uint8_t linkIdx() const { return link_idx_; }
+  inline DynamicsIndex linkIdx() const { return link_idx_; }
 
   /// Return joint id.
-  inline uint8_t jointIdx() const { return joint_idx_; }
+  inline DynamicsIndex jointIdx() const { return joint_idx_; }
 
   /// Retrieve key index.
   inline uint64_t time() const { return t_; }
 
+  /// Largest link or joint index that can be encoded.
+  static constexpr DynamicsIndex kMaxIndex = (1 << kDynamicsIndexBits) - 2;
+
+  /// Index stored for symbols without a link or joint.
+  static constexpr DynamicsIndex kNoIndex = kMaxIndex + 1;
+
+  /// @name Decoding without constructing a symbol
+  /// @{
+
+  /// Link index of an integer key, kNoIndex if none.
+  static constexpr DynamicsIndex LinkIdx(gtsam::Key key) {
+    return DynamicsIndex((key & link_mask) >> (time_bits + joint_bits));
+  }
+
+  /// Joint index of an integer key, kNoIndex if none.
+  static constexpr DynamicsIndex JointIdx(gtsam::Key key) {
+    return DynamicsIndex((key & joint_mask) >> time_bits);
+  }
+
+  /// Time index of an integer key.
+  static constexpr uint64_t Time(gtsam::Key key) { return key & time_mask; }
+
+  /// An integer key with the time index cleared: keys of the same quantity,
+  /// link and joint share this prefix.
+  static constexpr gtsam::Key Prefix(gtsam::Key key) {
+    return key & ~time_mask;
+  }
+
+  /// @}
+
+  /// @name Robot instances
+  /// Keys of several robots in one graph are told apart by a robot instance,
+  /// stored in the high bits of the time index: the builders for robot r are
+  /// given the time index RobotTime(r, t) wherever they take a time step t.
+  /// Robot 0 has the keys of a single robot, and consecutive steps of one
+  /// robot still differ by one in the time index.
+  /// @{
+
+  /// Number of bits of the robot instance.
+  static constexpr size_t kRobotBits = 6;
+
+  /// Largest robot instance that can be encoded.
+  static constexpr size_t kMaxRobot = (size_t(1) << kRobotBits) - 1;
+
+  /// Time index of step t of robot instance `robot`.
+  static constexpr uint64_t RobotTime(size_t robot, uint64_t t) {
+    return robot <= kMaxRobot && t <= step_mask
+               ? (uint64_t(robot) << robot_shift) | t
+               : throw std::out_of_range(
+                     "robot instance or time step too large for dynamics "
+                     "symbol");
+  }
+
+  /// Robot instance of an integer key.
+  static constexpr size_t RobotInstance(gtsam::Key key) {
+    return size_t((key & robot_mask) >> robot_shift);
+  }
+
+  /// Time step of an integer key, without its robot instance.
+  static constexpr uint64_t Step(gtsam::Key key) { return key & step_mask; }
+
+  /// The same key for robot instance `robot`.
+  static constexpr gtsam::Key WithRobot(gtsam::Key key, size_t robot) {
+    return robot <= kMaxRobot
+               ? (key & ~robot_mask) | (gtsam::Key(robot) << robot_shift)
+               : throw std::out_of_range(
+                     "robot instance too large for dynamics symbol");
+  }
+
+  /// Return robot instance.
+  inline size_t robotInstance() const { return RobotInstance(t_); }
+
+  /// Return time step, without the robot instance.
+  inline uint64_t step() const { return Step(t_); }
+
+  /// @}
+
   /// Print.
   void print(const std::string& s = "") const;
 
@@ -107,11 +295,22 @@ class DynamicsSymbol {
   }
 
   /// return the integer version
-  gtsam::Key key() const { return (gtsam::Key) * this; }
+  constexpr gtsam::Key key() const { return (gtsam::Key) * this; }
 
   /// Create a string from the key
   operator std::string() const;
 
+  /// Size of a buffer that fits any key written by Format.
+  static constexpr size_t kMaxFormatLength = 48;
+
+  /**
+   * Write an integer key as operator std::string does, e.g. "q(2)15", into
+   * `buffer` of at least kMaxFormatLength characters, without allocating or
+   * going through iostreams, for printing large graphs.
+   * @return pointer past the last character written; no null is appended
+   */
+  static char* Format(gtsam::Key key, char* buffer);
+
  private:
   /// Serialization function
   friend class boost::serialization::access;
@@ -130,12 +329,13 @@ class DynamicsSymbol {
    */
   static constexpr size_t kMax_uchar_ =
       std::numeric_limits<uint8_t>::max();
+  static constexpr gtsam::Key index_ones_ = kNoIndex;
   // bit counts
   static constexpr size_t key_bits = sizeof(gtsam::Key) * 8;
   static constexpr size_t ch1_bits = sizeof(uint8_t) * 8;
   static constexpr size_t ch2_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t link_bits = sizeof(uint8_t) * 8;
-  static constexpr size_t joint_bits = sizeof(uint8_t) * 8;
+  static constexpr size_t link_bits = kDynamicsIndexBits;
+  static constexpr size_t joint_bits = kDynamicsIndexBits;
   static constexpr size_t time_bits =
       key_bits - ch1_bits - ch2_bits - link_bits - joint_bits;
   // masks
@@ -143,11 +343,18 @@ class DynamicsSymbol {
                                          << (key_bits - ch1_bits);
   static constexpr gtsam::Key ch2_mask = gtsam::Key(kMax_uchar_)
                                          << (key_bits - ch1_bits - ch2_bits);
-  static constexpr gtsam::Key link_mask = gtsam::Key(kMax_uchar_)
+  static constexpr gtsam::Key link_mask = index_ones_
                                           << (time_bits + joint_bits);
-  static constexpr gtsam::Key joint_mask = gtsam::Key(kMax_uchar_) << time_bits;
+  static constexpr gtsam::Key joint_mask = index_ones_ << time_bits;
   static constexpr gtsam::Key time_mask =
       ~(ch1_mask | ch2_mask | link_mask | joint_mask);
+  // The robot instance sits below bit 31, so that time indices of all robots
+  // fit the int time steps taken by the graph builders.
+  static constexpr size_t robot_shift =
+      (time_bits < 31 ? time_bits : 31) - kRobotBits;
+  static constexpr gtsam::Key step_mask = (gtsam::Key(1) << robot_shift) - 1;
+  static constexpr gtsam::Key robot_mask = gtsam::Key(kMaxRobot)
+                                           << robot_shift;
   /**@}*/
 };
 
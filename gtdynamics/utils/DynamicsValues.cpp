@@ -0,0 +1,237 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsValues.cpp
+ * @brief Dense storage of dynamics variables, next to gtsam::Values.
+ */
+
+#include "gtdynamics/utils/DynamicsValues.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Key;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+// The two label characters of a key, see DynamicsSymbol.
+static Key Label(Key key) { return key >> (8 * sizeof(Key) - 16); }
+
+/* ************************************************************************* */
+DynamicsValues::DynamicsValues(const Robot &robot, size_t num_steps)
+    : num_steps_(num_steps), num_joint_slots_(0), num_link_slots_(0) {
+  for (auto &&link : robot.links())
+    num_link_slots_ = std::max<size_t>(num_link_slots_, link->id() + 1);
+  const auto joints = robot.joints();
+  for (auto &&joint : joints)
+    num_joint_slots_ = std::max<size_t>(num_joint_slots_, joint->id() + 1);
+
+  joint_parent_links_.assign(num_joint_slots_, -1);
+  joint_child_links_.assign(num_joint_slots_, -1);
+  for (auto &&joint : joints) {
+    joint_parent_links_[joint->id()] = joint->parent()->id();
+    joint_child_links_[joint->id()] = joint->child()->id();
+  }
+  clear();
+}
+
+/* ************************************************************************* */
+DynamicsValues DynamicsValues::FromValues(const Robot &robot,
+                                          const Values &values,
+                                          size_t num_steps) {
+  DynamicsValues dynamics_values(robot, num_steps);
+  dynamics_values.assign(values);
+  return dynamics_values;
+}
+
+/* ************************************************************************* */
+void DynamicsValues::clear() {
+  const size_t T = num_steps_, J = num_joint_slots_, L = num_link_slots_;
+  for (auto &&block : joints_) block.setZero(J, T);
+  poses_.assign(T * L, Pose3());
+  twists_.setZero(6, T * L);
+  twist_accels_.setZero(6, T * L);
+  wrenches_.setZero(6, 2 * T * J);
+  for (size_t s = 0; s < kNumSlots; ++s) {
+    const size_t n = s < kPose ? J * T : (s < kWrench ? L * T : 2 * J * T);
+    set_[s].assign(n, false);
+  }
+}
+
+/* ************************************************************************* */
+size_t DynamicsValues::jointSlot(DynamicsQuantity q) {
+  switch (q) {
+    case DynamicsQuantity::JointAngle:
+      return kJointAngle;
+    case DynamicsQuantity::JointVel:
+      return kJointVel;
+    case DynamicsQuantity::JointAccel:
+      return kJointAccel;
+    case DynamicsQuantity::Torque:
+      return kTorque;
+    default:
+      throw std::invalid_argument("DynamicsValues: not a joint quantity");
+  }
+}
+
+/* ************************************************************************* */
+size_t DynamicsValues::wrenchColumn(int i, int j, int t) const {
+  const size_t column = 2 * (t * num_joint_slots_ + j);
+  if (joint_parent_links_[j] == i) return column;
+  if (joint_child_links_[j] == i) return column + 1;
+  throw std::invalid_argument("DynamicsValues: link " + std::to_string(i) +
+                              " is not connected to joint " +
+                              std::to_string(j));
+}
+
+/* ************************************************************************* */
+void DynamicsValues::setJoint(DynamicsQuantity q, int j, int t,
+                              double value) {
+  const size_t s = jointSlot(q);
+  joints_[s](j, t) = value;
+  set_[s][t * num_joint_slots_ + j] = true;
+}
+
+/* ************************************************************************* */
+void DynamicsValues::setPose(int i, int t, const Pose3 &pose) {
+  const size_t column = t * num_link_slots_ + i;
+  poses_[column] = pose;
+  set_[kPose][column] = true;
+}
+
+/* ************************************************************************* */
+void DynamicsValues::setTwist(int i, int t, const Vector6 &twist) {
+  const size_t column = t * num_link_slots_ + i;
+  twists_.col(column) = twist;
+  set_[kTwist][column] = true;
+}
+
+/* ************************************************************************* */
+void DynamicsValues::setTwistAccel(int i, int t, const Vector6 &twist_accel) {
+  const size_t column = t * num_link_slots_ + i;
+  twist_accels_.col(column) = twist_accel;
+  set_[kTwistAccel][column] = true;
+}
+
+/* ************************************************************************* */
+void DynamicsValues::setWrench(int i, int j, int t, const Vector6 &wrench) {
+  const size_t column = wrenchColumn(i, j, t);
+  wrenches_.col(column) = wrench;
+  set_[kWrench][column] = true;
+}
+
+/* ************************************************************************* */
+bool DynamicsValues::exists(DynamicsQuantity q, int index, int t) const {
+  switch (q) {
+    case DynamicsQuantity::Pose:
+      return set_[kPose][t * num_link_slots_ + index];
+    case DynamicsQuantity::Twist:
+      return set_[kTwist][t * num_link_slots_ + index];
+    case DynamicsQuantity::TwistAccel:
+      return set_[kTwistAccel][t * num_link_slots_ + index];
+    case DynamicsQuantity::Wrench:
+      throw std::invalid_argument(
+          "DynamicsValues::exists: use existsWrench for wrenches");
+    default:
+      return set_[jointSlot(q)][t * num_joint_slots_ + index];
+  }
+}
+
+/* ************************************************************************* */
+void DynamicsValues::assign(const Values &values) {
+  static const Key kLabels[kNumSlots] = {
+      Label(internal::JointAngleKey(0)), Label(internal::JointVelKey(0)),
+      Label(internal::JointAccelKey(0)), Label(internal::TorqueKey(0)),
+      Label(internal::PoseKey(0)),       Label(internal::TwistKey(0)),
+      Label(internal::TwistAccelKey(0)), Label(internal::WrenchKey(0, 0))};
+
+  for (const auto &key_value : values) {
+    const Key key = key_value.key;
+    const Key label = Label(key);
+    const size_t s =
+        std::find(kLabels, kLabels + kNumSlots, label) - kLabels;
+    if (s == kNumSlots) continue;
+
+    const uint64_t t = DynamicsSymbol::Time(key);
+    if (t >= num_steps_) continue;
+    const size_t i = DynamicsSymbol::LinkIdx(key);
+    const size_t j = DynamicsSymbol::JointIdx(key);
+    if (s < kPose) {
+      if (j >= num_joint_slots_) continue;
+      joints_[s](j, t) = key_value.value.cast<double>();
+      set_[s][t * num_joint_slots_ + j] = true;
+    } else if (s < kWrench) {
+      if (i >= num_link_slots_) continue;
+      const size_t column = t * num_link_slots_ + i;
+      if (s == kPose)
+        poses_[column] = key_value.value.cast<Pose3>();
+      else if (s == kTwist)
+        twists_.col(column) = key_value.value.cast<Vector6>();
+      else
+        twist_accels_.col(column) = key_value.value.cast<Vector6>();
+      set_[s][column] = true;
+    } else {
+      if (j >= num_joint_slots_) continue;
+      const size_t column = 2 * (t * num_joint_slots_ + j);
+      size_t side;
+      if (int(i) == joint_parent_links_[j])
+        side = 0;
+      else if (int(i) == joint_child_links_[j])
+        side = 1;
+      else
+        continue;
+      wrenches_.col(column + side) = key_value.value.cast<Vector6>();
+      set_[kWrench][column + side] = true;
+    }
+  }
+}
+
+/* ************************************************************************* */
+void DynamicsValues::insertInto(Values *values) const {
+  for (size_t t = 0; t < num_steps_; ++t) {
+    for (size_t j = 0; j < num_joint_slots_; ++j) {
+      const size_t k = t * num_joint_slots_ + j;
+      if (set_[kJointAngle][k])
+        InsertJointAngle(values, j, t, joints_[kJointAngle](j, t));
+      if (set_[kJointVel][k])
+        InsertJointVel(values, j, t, joints_[kJointVel](j, t));
+      if (set_[kJointAccel][k])
+        InsertJointAccel(values, j, t, joints_[kJointAccel](j, t));
+      if (set_[kTorque][k]) InsertTorque(values, j, t, joints_[kTorque](j, t));
+      if (set_[kWrench][2 * k])
+        InsertWrench(values, joint_parent_links_[j], j, t,
+                     wrenches_.col(2 * k));
+      if (set_[kWrench][2 * k + 1])
+        InsertWrench(values, joint_child_links_[j], j, t,
+                     wrenches_.col(2 * k + 1));
+    }
+    for (size_t i = 0; i < num_link_slots_; ++i) {
+      const size_t k = t * num_link_slots_ + i;
+      if (set_[kPose][k]) InsertPose(values, i, t, poses_[k]);
+      if (set_[kTwist][k]) InsertTwist(values, i, t, twists_.col(k));
+      if (set_[kTwistAccel][k])
+        InsertTwistAccel(values, i, t, twist_accels_.col(k));
+    }
+  }
+}
+
+/* ************************************************************************* */
+Values DynamicsValues::toValues() const {
+  Values values;
+  insertInto(&values);
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,219 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  DynamicsValues.h
+ * @brief Dense storage of dynamics variables, next to gtsam::Values.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/Vector.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/// The kinds of variables stored in DynamicsValues.
+enum class DynamicsQuantity {
+  JointAngle,
+  JointVel,
+  JointAccel,
+  Torque,
+  Pose,
+  Twist,
+  TwistAccel,
+  Wrench
+};
+
+/**
+ * DynamicsValues stores the dynamics variables of a robot over a number of
+ * time steps in dense arrays: one contiguous block per quantity, indexed by
+ * joint or link id and time step, mirroring the keys in utils/values.h.
+ * Reads and writes are plain memory accesses, without key lookups or casts.
+ *
+ * Joint quantities are #joint slots x #steps matrices, twists and twist
+ * accelerations are 6 x (#steps * #link slots) with column t * #link slots + i,
+ * and the two wrenches of each joint (on its parent and child link) are kept
+ * per joint. Every entry has a flag recording whether it was set, so that
+ * only set entries are written back to Values.
+ *
+ * Conversion with gtsam::Values happens at optimizer boundaries: `assign`
+ * reads all dynamics keys in a single pass over the Values, decoding each key
+ * with a few bit operations, and `insertInto` writes all set entries.
+ */
+class DynamicsValues {
+ public:
+  /**
+   * Constructor, all entries zero and unset.
+   * @param robot      the robot, used for sizes and for the wrench layout
+   * @param num_steps  number of time steps
+   */
+  explicit DynamicsValues(const Robot &robot, size_t num_steps = 1);
+
+  /// Create from the dynamics variables in `values`, see `assign`.
+  static DynamicsValues FromValues(const Robot &robot,
+                                   const gtsam::Values &values,
+                                   size_t num_steps = 1);
+
+  /// @name Sizes
+  /// @{
+
+  size_t numSteps() const { return num_steps_; }
+  size_t numJointSlots() const { return num_joint_slots_; }
+  size_t numLinkSlots() const { return num_link_slots_; }
+
+  /// @}
+  /// @name Joint quantities: angles, velocities, accelerations, torques
+  /// @{
+
+  /// Value of joint quantity `q` for joint j at time t.
+  double joint(DynamicsQuantity q, int j, int t = 0) const {
+    return joints_[jointSlot(q)](j, t);
+  }
+
+  /// Set joint quantity `q` for joint j at time t.
+  void setJoint(DynamicsQuantity q, int j, int t, double value);
+
+  /// #joint slots x #steps matrix of joint quantity `q`.
+  const gtsam::Matrix &joints(DynamicsQuantity q) const {
+    return joints_[jointSlot(q)];
+  }
+
+  double jointAngle(int j, int t = 0) const {
+    return joint(DynamicsQuantity::JointAngle, j, t);
+  }
+  double jointVel(int j, int t = 0) const {
+    return joint(DynamicsQuantity::JointVel, j, t);
+  }
+  double jointAccel(int j, int t = 0) const {
+    return joint(DynamicsQuantity::JointAccel, j, t);
+  }
+  double torque(int j, int t = 0) const {
+    return joint(DynamicsQuantity::Torque, j, t);
+  }
+
+  /// @}
+  /// @name Link quantities: poses, twists, twist accelerations
+  /// @{
+
+  /// CoM pose of link i at time t.
+  const gtsam::Pose3 &pose(int i, int t = 0) const {
+    return poses_[t * num_link_slots_ + i];
+  }
+
+  /// Set the CoM pose of link i at time t.
+  void setPose(int i, int t, const gtsam::Pose3 &pose);
+
+  /// Twist of link i at time t.
+  gtsam::Vector6 twist(int i, int t = 0) const {
+    return twists_.col(t * num_link_slots_ + i);
+  }
+
+  /// Set the twist of link i at time t.
+  void setTwist(int i, int t, const gtsam::Vector6 &twist);
+
+  /// Twist acceleration of link i at time t.
+  gtsam::Vector6 twistAccel(int i, int t = 0) const {
+    return twist_accels_.col(t * num_link_slots_ + i);
+  }
+
+  /// Set the twist acceleration of link i at time t.
+  void setTwistAccel(int i, int t, const gtsam::Vector6 &twist_accel);
+
+  /// 6 x (#steps * #link slots) matrix of twists, column t * #link slots + i.
+  const gtsam::Matrix &twists() const { return twists_; }
+
+  /// 6 x (#steps * #link slots) matrix of twist accelerations, as above.
+  const gtsam::Matrix &twistAccels() const { return twist_accels_; }
+
+  /// @}
+  /// @name Wrenches
+  /// @{
+
+  /// Wrench on link i by joint j at time t, i must be a link of joint j.
+  gtsam::Vector6 wrench(int i, int j, int t = 0) const {
+    return wrenches_.col(wrenchColumn(i, j, t));
+  }
+
+  /// Set the wrench on link i by joint j at time t.
+  void setWrench(int i, int j, int t, const gtsam::Vector6 &wrench);
+
+  /// @}
+  /// @name Set flags
+  /// @{
+
+  /**
+   * Return true if the entry was set. For joint quantities `index` is the
+   * joint id, for link quantities the link id. Use the overload below for
+   * wrenches.
+   */
+  bool exists(DynamicsQuantity q, int index, int t = 0) const;
+
+  /// Return true if the wrench on link i by joint j at time t was set.
+  bool existsWrench(int i, int j, int t = 0) const {
+    return set_[kWrench][wrenchColumn(i, j, t)];
+  }
+
+  /// Mark all entries as unset, and zero them.
+  void clear();
+
+  /// @}
+  /// @name Conversion with gtsam::Values
+  /// @{
+
+  /**
+   * Read all dynamics variables in `values` whose ids and time index fit in
+   * this container, in a single pass over `values`. Other keys are ignored.
+   */
+  void assign(const gtsam::Values &values);
+
+  /// Insert all set entries into `values`, which should not contain them.
+  void insertInto(gtsam::Values *values) const;
+
+  /// Return all set entries as Values.
+  gtsam::Values toValues() const;
+
+  /// @}
+
+ private:
+  // Indices into set_.
+  enum Slot {
+    kJointAngle,
+    kJointVel,
+    kJointAccel,
+    kTorque,
+    kPose,
+    kTwist,
+    kTwistAccel,
+    kWrench,
+    kNumSlots
+  };
+
+  /// Index into joints_ for a joint quantity, throws otherwise.
+  static size_t jointSlot(DynamicsQuantity q);
+
+  /// Column into wrenches_, throws if i is not a link of joint j.
+  size_t wrenchColumn(int i, int j, int t) const;
+
+  size_t num_steps_, num_joint_slots_, num_link_slots_;
+  std::vector<int> joint_parent_links_;  // per joint id, -1 if unused
+  std::vector<int> joint_child_links_;
+
+  gtsam::Matrix joints_[4];  // angles, velocities, accelerations, torques
+  std::vector<gtsam::Pose3> poses_;
+  gtsam::Matrix twists_, twist_accels_;
+  gtsam::Matrix wrenches_;  // column 2 * (t * #joints + j) + (0 parent, 1 child)
+  std::vector<bool> set_[kNumSlots];
+};
+
+}  // namespace gtdynamics
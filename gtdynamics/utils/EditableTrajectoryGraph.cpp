@@ -0,0 +1,180 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  EditableTrajectoryGraph.cpp
+ * @brief Multi-phase trajectory graph updated in place when phases change.
+ */
+
+#include "gtdynamics/utils/EditableTrajectoryGraph.h"
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsSlice.h"
+#include "gtdynamics/utils/WalkCycle.h"
+
+using gtsam::Key;
+using gtsam::NonlinearFactorGraph;
+using std::vector;
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+EditableTrajectoryGraph::EditableTrajectoryGraph(
+    const Robot &robot, const DynamicsGraph &graph_builder,
+    const vector<Phase> &phases, CollocationScheme collocation,
+    const boost::optional<double> &mu)
+    : robot_(robot),
+      graph_builder_(graph_builder),
+      collocation_(collocation),
+      mu_(mu) {
+  if (phases.empty())
+    throw std::invalid_argument("EditableTrajectoryGraph: no phases");
+  rebuild(phases);
+}
+
+/* ************************************************************************* */
+EditableTrajectoryGraph::Update EditableTrajectoryGraph::setNumTimeSteps(
+    size_t p, size_t num_time_steps) {
+  if (p >= phases_.size() || num_time_steps == 0)
+    throw std::invalid_argument(
+        "EditableTrajectoryGraph::setNumTimeSteps: invalid phase or length");
+  vector<Phase> phases;
+  size_t k = 0;
+  for (size_t i = 0; i < phases_.size(); i++) {
+    const size_t n = i == p ? num_time_steps : phases_[i].numTimeSteps();
+    phases.emplace_back(k, k + n,
+                        boost::const_pointer_cast<ConstraintSpec>(
+                            phases_[i].constraintSpec()));
+    k += n;
+  }
+  return rebuild(phases);
+}
+
+/* ************************************************************************* */
+EditableTrajectoryGraph::Update EditableTrajectoryGraph::setConstraintSpec(
+    size_t p, const boost::shared_ptr<ConstraintSpec> &spec) {
+  if (p >= phases_.size())
+    throw std::invalid_argument(
+        "EditableTrajectoryGraph::setConstraintSpec: invalid phase");
+  vector<Phase> phases = phases_;
+  phases[p] = Phase(phases_[p].k_start, phases_[p].k_end, spec);
+  return rebuild(phases);
+}
+
+/* ************************************************************************* */
+EditableTrajectoryGraph::Update EditableTrajectoryGraph::rebuild(
+    const vector<Phase> &phases) {
+  // Layout of the steps, as in DynamicsGraph::multiPhaseTrajectoryFG: the
+  // last step of every phase but the last one is a transition step, with the
+  // contact points the phase shares with the next one.
+  const WalkCycle walk_cycle(phases);
+  const vector<PointOnLinks> trans_cps = walk_cycle.transitionContactPoints();
+  vector<Block> dynamics(1), collocation;
+  dynamics[0].contacts = walk_cycle.getPhaseContactPoints(0);
+  for (size_t p = 0; p < phases.size(); p++) {
+    const PointOnLinks cps = walk_cycle.getPhaseContactPoints(p);
+    for (size_t step = 0; step < phases[p].numTimeSteps(); step++) {
+      Block block;
+      block.transition =
+          step + 1 == phases[p].numTimeSteps() && p + 1 != phases.size();
+      block.contacts = block.transition ? trans_cps[p] : cps;
+      dynamics.push_back(block);
+      collocation.emplace_back();
+      collocation.back().phase = p;
+    }
+  }
+
+  // Keep the blocks built from the same inputs, mark the others.
+  const auto same_dynamics = [](const Block &a, const Block &b) {
+    return a.transition == b.transition && a.contacts == b.contacts;
+  };
+  const auto same_collocation = [](const Block &a, const Block &b) {
+    return a.phase == b.phase;
+  };
+  vector<size_t> changed_dynamics, changed_collocation;
+  for (size_t k = 0; k < dynamics.size(); k++) {
+    if (k < dynamics_.size() && same_dynamics(dynamics[k], dynamics_[k]))
+      dynamics[k].slots = dynamics_[k].slots;
+    else
+      changed_dynamics.push_back(k);
+  }
+  for (size_t k = 0; k < collocation.size(); k++) {
+    if (k < collocation_.size() &&
+        same_collocation(collocation[k], collocation_[k]))
+      collocation[k].slots = collocation_[k].slots;
+    else
+      changed_collocation.push_back(k);
+  }
+
+  // Remove the factors of changed and dropped blocks. The counts of touched
+  // keys before the update decide which keys are new or gone.
+  Update update;
+  std::map<Key, size_t> counts_before;
+  const auto remove = [&](const Block &block) {
+    for (const size_t slot : block.slots) {
+      for (const Key key : graph_[slot]->keys()) {
+        counts_before.emplace(key, key_counts_[key]);
+        key_counts_[key]--;
+      }
+      graph_[slot].reset();
+      update.removed.push_back(slot);
+    }
+  };
+  for (size_t k = 0; k < dynamics_.size(); k++)
+    if (k >= dynamics.size() || dynamics[k].slots != dynamics_[k].slots)
+      remove(dynamics_[k]);
+  for (size_t k = 0; k < collocation_.size(); k++)
+    if (k >= collocation.size() ||
+        collocation[k].slots != collocation_[k].slots)
+      remove(collocation_[k]);
+
+  // Build the changed blocks, one slice per contact pattern among them.
+  const auto add = [&](const NonlinearFactorGraph &part, Block *block) {
+    for (const auto &factor : part) {
+      for (const Key key : factor->keys()) {
+        counts_before.emplace(key, key_counts_[key]);
+        key_counts_[key]++;
+      }
+      block->slots.push_back(graph_.size());
+      graph_.push_back(factor);
+      update.new_factors.push_back(factor);
+    }
+  };
+  vector<PointOnLinks> patterns;
+  for (const size_t k : changed_dynamics)
+    patterns.push_back(dynamics[k].contacts);
+  vector<size_t> slice_of_block;
+  const vector<DynamicsSlice> slices = graph_builder_.dynamicsSlices(
+      robot_, patterns, mu_, &slice_of_block);
+  const auto arena = graph_builder_.factorArena();
+  for (size_t i = 0; i < changed_dynamics.size(); i++) {
+    const size_t k = changed_dynamics[i];
+    NonlinearFactorGraph part;
+    slices[slice_of_block[i]].instantiate(k, &part, arena);
+    add(part, &dynamics[k]);
+  }
+  for (const size_t k : changed_collocation) {
+    add(graph_builder_.multiPhaseCollocationFactors(
+            robot_, k, collocation[k].phase, collocation_),
+        &collocation[k]);
+  }
+
+  for (auto &&kv : counts_before) {
+    const size_t after = key_counts_[kv.first];
+    if (kv.second == 0 && after > 0) update.new_keys.insert(kv.first);
+    if (kv.second > 0 && after == 0) update.removed_keys.insert(kv.first);
+    if (after == 0) key_counts_.erase(kv.first);
+  }
+
+  phases_ = phases;
+  dynamics_ = std::move(dynamics);
+  collocation_ = std::move(collocation);
+  return update;
+}
+
+}  // namespace gtdynamics
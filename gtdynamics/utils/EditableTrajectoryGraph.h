@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  EditableTrajectoryGraph.h
+ * @brief Multi-phase trajectory graph updated in place when phases change.
+ */
+
+#pragma once
+
+#include <gtsam/inference/Key.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <boost/optional.hpp>
+#include <map>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/ConstraintSpec.h"
+#include "gtdynamics/utils/Phase.h"
+#include "gtdynamics/utils/PointOnLink.h"
+
+namespace gtdynamics {
+
+/**
+ * EditableTrajectoryGraph holds the graph of Trajectory::multiPhaseFactorGraph
+ * for a sequence of phases, and updates it when the duration or the contact
+ * spec of a phase changes. The graph is append-only: removed factors leave a
+ * null slot, so slot indices stay valid as the factor indices of an iSAM2
+ * instance that is fed the updates in order, e.g.
+ *
+ *   auto update = trajectory.setNumTimeSteps(1, 6);
+ *   isam.update(update.new_factors, values_of(update.new_keys),
+ *               update.removed);
+ *
+ * Each time step k keeps its keys, so no factor is ever re-keyed: a dynamics
+ * step whose contact points and transition status did not change, and a
+ * collocation step k -> k + 1 whose phase did not change, keep their factors.
+ * Lengthening phase p, for example, only touches the steps around its end and
+ * the added steps at the end of the trajectory; the variables of later steps
+ * keep their estimate, which shifts their meaning by the added steps.
+ */
+class EditableTrajectoryGraph {
+ public:
+  /// Changes of one edit, in the form ISAM2::update takes them.
+  struct Update {
+    gtsam::NonlinearFactorGraph new_factors;  ///< appended, in slot order
+    gtsam::FactorIndices removed;             ///< slots of removed factors
+    gtsam::KeySet new_keys;      ///< keys that had no factor before
+    gtsam::KeySet removed_keys;  ///< keys that have no factor anymore
+  };
+
+  /**
+   * Construct the graph of consecutive phases.
+   * @param robot          the robot
+   * @param graph_builder  builds the dynamics and collocation factors
+   * @param phases         phases in order, starting at step 0
+   * @param collocation    collocation scheme
+   * @param mu             optional coefficient of static friction
+   */
+  EditableTrajectoryGraph(
+      const Robot &robot, const DynamicsGraph &graph_builder,
+      const std::vector<Phase> &phases,
+      CollocationScheme collocation = Trapezoidal,
+      const boost::optional<double> &mu = boost::none);
+
+  /// The graph, with null slots for removed factors.
+  const gtsam::NonlinearFactorGraph &graph() const { return graph_; }
+
+  /// The current phases.
+  const std::vector<Phase> &phases() const { return phases_; }
+
+  /// Number of time steps of the trajectory, the last index plus one.
+  size_t numTimeSteps() const { return dynamics_.size(); }
+
+  /// Set the number of time steps of phase p, at least one.
+  Update setNumTimeSteps(size_t p, size_t num_time_steps);
+
+  /// Set the constraint spec, e.g. the contacts, of phase p.
+  Update setConstraintSpec(size_t p,
+                           const boost::shared_ptr<ConstraintSpec> &spec);
+
+ private:
+  // Factors of one step, and what they were built from.
+  struct Block {
+    std::vector<size_t> slots;
+    bool transition = false;  // dynamics block at the end of a phase
+    PointOnLinks contacts;    // contact points of a dynamics block
+    size_t phase = 0;         // phase of a collocation block
+  };
+
+  const Robot robot_;
+  const DynamicsGraph graph_builder_;
+  const CollocationScheme collocation_;
+  const boost::optional<double> mu_;
+
+  std::vector<Phase> phases_;
+  gtsam::NonlinearFactorGraph graph_;
+  std::vector<Block> dynamics_;     // blocks of steps k
+  std::vector<Block> collocation_;  // blocks of steps k -> k + 1
+  std::map<gtsam::Key, size_t> key_counts_;  // factors on each key
+
+  // Bring the graph to `phases`, rebuilding only the blocks that changed.
+  Update rebuild(const std::vector<Phase> &phases);
+};
+
+}  // namespace gtdynamics
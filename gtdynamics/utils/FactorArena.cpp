@@ -0,0 +1,48 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorArena.cpp
+ * @brief Arena allocation of the factors of a graph.
+ */
+
+#include "gtdynamics/utils/FactorArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+void *FactorArena::allocate(size_t size, size_t alignment) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto aligned = [alignment](char *p) {
+    const uintptr_t x = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<char *>((x + alignment - 1) & ~(alignment - 1));
+  };
+
+  char *p = next_ ? aligned(next_) : nullptr;
+  if (!p || p + size > end_) {
+    // Objects larger than a chunk get a chunk of their own.
+    const size_t chunk_size = std::max(chunk_size_, size + alignment);
+    chunks_.emplace_back(new char[chunk_size]);
+    capacity_ += chunk_size;
+    next_ = chunks_.back().get();
+    end_ = next_ + chunk_size;
+    p = aligned(next_);
+  }
+  next_ = p + size;
+  return p;
+}
+
+/* ************************************************************************* */
+size_t FactorArena::capacity() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return capacity_;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorArena.h
+ * @brief Arena allocation of the factors of a graph.
+ */
+
+#pragma once
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * FactorArena hands out memory from large chunks, and frees it all at once
+ * when the arena is destroyed. Factors made with MakeShared keep the arena
+ * alive through their allocator, so the chunks live exactly as long as the
+ * last factor of the graph they were made for, and such factors can be mixed
+ * freely with others in a NonlinearFactorGraph.
+ *
+ * Freed memory is not reused, so an arena should be scoped to one graph, not
+ * shared by graphs that are built and dropped repeatedly. allocate() can be
+ * called from multiple threads.
+ */
+class FactorArena {
+ public:
+  /// Constructor, `chunk_size` is the size of the chunks in bytes.
+  explicit FactorArena(size_t chunk_size = 1 << 16) : chunk_size_(chunk_size) {}
+
+  FactorArena(const FactorArena &) = delete;
+  FactorArena &operator=(const FactorArena &) = delete;
+
+  /// Memory for `size` bytes aligned to `alignment`, a power of 2.
+  void *allocate(size_t size, size_t alignment);
+
+  /// Total size of the chunks, in bytes.
+  size_t capacity() const;
+
+ private:
+  size_t chunk_size_;
+  std::vector<std::unique_ptr<char[]>> chunks_;
+  char *next_ = nullptr, *end_ = nullptr;
+  mutable std::mutex mutex_;
+  size_t capacity_ = 0;
+};
+
+/**
+ * Allocator using a FactorArena, for boost::allocate_shared. Alignment is at
+ * least 16 bytes, since fixed-size Eigen members need it.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(std::shared_ptr<FactorArena> arena)
+      : arena_(std::move(arena)) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena()) {}
+
+  T *allocate(size_t n) {
+    const size_t alignment = alignof(T) > 16 ? alignof(T) : 16;
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignment));
+  }
+
+  void deallocate(T *, size_t) {}
+
+  const std::shared_ptr<FactorArena> &arena() const { return arena_; }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U> &other) const {
+    return arena_ == other.arena();
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U> &other) const {
+    return arena_ != other.arena();
+  }
+
+ private:
+  std::shared_ptr<FactorArena> arena_;
+};
+
+/**
+ * Make a T from `args` in `arena`, or on the heap with boost::make_shared if
+ * there is no arena.
+ */
+template <typename T, typename... Args>
+boost::shared_ptr<T> MakeShared(const std::shared_ptr<FactorArena> &arena,
+                                Args &&... args) {
+  if (!arena) return boost::make_shared<T>(std::forward<Args>(args)...);
+  return boost::allocate_shared<T>(ArenaAllocator<T>(arena),
+                                   std::forward<Args>(args)...);
+}
+
+}  // namespace gtdynamics
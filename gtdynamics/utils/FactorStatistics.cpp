@@ -0,0 +1,170 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorStatistics.cpp
+ * @brief Error and linearization cost of a factor graph, by factor type.
+ */
+
+#include "gtdynamics/utils/FactorStatistics.h"
+
+#include <boost/core/demangle.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+std::string FactorTypeName(const gtsam::NonlinearFactor &factor) {
+  return boost::core::demangle(typeid(factor).name());
+}
+
+/* ************************************************************************* */
+std::vector<FactorTypeStatistics> FactorStatistics(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    size_t repetitions) {
+  using Clock = std::chrono::steady_clock;
+  repetitions = std::max<size_t>(repetitions, 1);
+
+  std::map<std::string, FactorTypeStatistics> by_type;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    FactorTypeStatistics &statistics = by_type[FactorTypeName(*factor)];
+    statistics.count++;
+    statistics.dimension += factor->dim();
+    statistics.error += factor->error(values);
+
+    const auto start = Clock::now();
+    for (size_t r = 0; r < repetitions; r++) {
+      auto linear_factor = factor->linearize(values);
+      (void)linear_factor;
+    }
+    statistics.linearize_time +=
+        std::chrono::duration<double>(Clock::now() - start).count() /
+        repetitions;
+  }
+
+  std::vector<FactorTypeStatistics> result;
+  for (auto &&entry : by_type) {
+    result.push_back(entry.second);
+    result.back().type = entry.first;
+  }
+  std::sort(result.begin(), result.end(),
+            [](const FactorTypeStatistics &a, const FactorTypeStatistics &b) {
+              return a.error > b.error;
+            });
+  return result;
+}
+
+/* ************************************************************************* */
+void PrintFactorStatistics(const std::vector<FactorTypeStatistics> &statistics,
+                           std::ostream &os) {
+  double total_error = 0, total_time = 0;
+  size_t total_count = 0;
+  for (auto &&s : statistics) {
+    total_error += s.error;
+    total_time += s.linearize_time;
+    total_count += s.count;
+  }
+  const auto share = [](double x, double total) {
+    return total > 0 ? 100 * x / total : 0.0;
+  };
+
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << std::left << std::setw(48) << "type" << std::right << std::setw(8)
+     << "count" << std::setw(14) << "error" << std::setw(8) << "%"
+     << std::setw(14) << "linearize [s]" << std::setw(8) << "%"
+     << "\n";
+  for (auto &&s : statistics) {
+    os << std::left << std::setw(48) << s.type << std::right << std::setw(8)
+       << s.count << std::setw(14) << std::setprecision(6) << s.error
+       << std::setw(8) << std::fixed << std::setprecision(1)
+       << share(s.error, total_error) << std::defaultfloat << std::setw(14)
+       << std::setprecision(6) << s.linearize_time << std::setw(8)
+       << std::fixed << std::setprecision(1)
+       << share(s.linearize_time, total_time) << std::defaultfloat << "\n";
+  }
+  os << std::left << std::setw(48) << "total" << std::right << std::setw(8)
+     << total_count << std::setw(14) << std::setprecision(6) << total_error
+     << std::setw(8) << "" << std::setw(14) << total_time << "\n";
+  os.flags(flags);
+  os.precision(precision);
+}
+
+/* ************************************************************************* */
+GraphSummary SummarizeGraph(const gtsam::NonlinearFactorGraph &graph) {
+  GraphSummary summary;
+  std::unordered_map<std::type_index, size_t> counts;
+  std::vector<gtsam::Key> keys;
+  for (auto &&factor : graph) {
+    if (!factor) continue;
+    summary.num_factors++;
+    counts[std::type_index(typeid(*factor))]++;
+    keys.insert(keys.end(), factor->begin(), factor->end());
+  }
+  for (auto &&entry : counts)
+    summary.factor_types.emplace_back(
+        boost::core::demangle(entry.first.name()), entry.second);
+  std::sort(summary.factor_types.begin(), summary.factor_types.end(),
+            [](const std::pair<std::string, size_t> &a,
+               const std::pair<std::string, size_t> &b) {
+              return a.second != b.second ? a.second > b.second
+                                          : a.first < b.first;
+            });
+
+  // Sorted keys group by family, as the label is in the top 16 bits.
+  std::sort(keys.begin(), keys.end());
+  for (size_t i = 0; i < keys.size(); i++) {
+    const uint64_t step = DynamicsSymbol::Step(keys[i]);
+    if (i == 0 || keys[i] >> 48 != keys[i - 1] >> 48) {
+      KeyFamilyStatistics family;
+      family.label = DynamicsSymbol(keys[i]).label();
+      family.first_step = family.last_step = step;
+      summary.key_families.push_back(family);
+    }
+    KeyFamilyStatistics &family = summary.key_families.back();
+    family.occurrences++;
+    if (i == 0 || keys[i] != keys[i - 1]) family.variables++;
+    family.first_step = std::min(family.first_step, step);
+    family.last_step = std::max(family.last_step, step);
+  }
+  return summary;
+}
+
+/* ************************************************************************* */
+void PrintGraphSummary(const GraphSummary &summary, std::ostream &os) {
+  const auto flags = os.flags();
+  os << summary.num_factors << " factors\n"
+     << std::left << std::setw(48) << "type" << std::right << std::setw(10)
+     << "count" << "\n";
+  for (auto &&type : summary.factor_types)
+    os << std::left << std::setw(48) << type.first << std::right
+       << std::setw(10) << type.second << "\n";
+  os << std::left << std::setw(8) << "keys" << std::right << std::setw(10)
+     << "variables" << std::setw(12) << "occurrences" << std::setw(16)
+     << "steps" << "\n";
+  for (auto &&family : summary.key_families)
+    os << std::left << std::setw(8) << family.label << std::right
+       << std::setw(10) << family.variables << std::setw(12)
+       << family.occurrences << std::setw(16)
+       << (std::to_string(family.first_step) + ".." +
+           std::to_string(family.last_step))
+       << "\n";
+  os.flags(flags);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,84 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FactorStatistics.h
+ * @brief Error and linearization cost of a factor graph, by factor type.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Totals over the factors of one type in a graph.
+struct FactorTypeStatistics {
+  std::string type;           ///< demangled C++ type of the factors
+  size_t count = 0;           ///< number of factors
+  size_t dimension = 0;       ///< total number of rows when linearized
+  double error = 0;           ///< total error at the values
+  double linearize_time = 0;  ///< total seconds to linearize, per repetition
+};
+
+/// Demangled C++ type name of `factor`, e.g. "gtdynamics::WrenchFactor".
+std::string FactorTypeName(const gtsam::NonlinearFactor &factor);
+
+/**
+ * Group the factors of `graph` by type and total their error and the time it
+ * takes to linearize them at `values`, which needs to contain all keys of the
+ * graph. Every factor is linearized `repetitions` times and the time divided
+ * by it, which reduces timer noise for cheap factors.
+ *
+ * Factors of the same C++ type share a row, so expression factors built by
+ * different code, e.g. collocation and joint constraints, are only told apart
+ * by their value type.
+ * @return one entry per type, sorted from the largest error down
+ */
+std::vector<FactorTypeStatistics> FactorStatistics(
+    const gtsam::NonlinearFactorGraph &graph, const gtsam::Values &values,
+    size_t repetitions = 1);
+
+/// Print statistics as a table, with the share of the totals of each type.
+void PrintFactorStatistics(const std::vector<FactorTypeStatistics> &statistics,
+                           std::ostream &os);
+
+/// Keys of one family, i.e. with one DynamicsSymbol label, in a graph.
+struct KeyFamilyStatistics {
+  std::string label;        ///< label of the keys, e.g. "q" or "F"
+  size_t variables = 0;     ///< number of distinct keys
+  size_t occurrences = 0;   ///< number of factor slots the keys fill
+  uint64_t first_step = 0;  ///< smallest time step
+  uint64_t last_step = 0;   ///< largest time step
+};
+
+/// Counts of the factors and keys of a graph, see SummarizeGraph.
+struct GraphSummary {
+  size_t num_factors = 0;  ///< non-null factors
+  std::vector<std::pair<std::string, size_t>> factor_types;  ///< type, count
+  std::vector<KeyFamilyStatistics> key_families;  ///< by label
+};
+
+/**
+ * Count the factors of `graph` per type, from the most common down, and its
+ * keys per family. Unlike FactorStatistics, this needs no values, nothing is
+ * evaluated, and type names are demangled once per type, so it takes well
+ * under a second for graphs of a million factors.
+ */
+GraphSummary SummarizeGraph(const gtsam::NonlinearFactorGraph &graph);
+
+/// Print a summary as two tables, of factor types and of key families.
+void PrintGraphSummary(const GraphSummary &summary, std::ostream &os);
+
+}  // namespace gtdynamics
@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FixedLag.cpp
+ * @brief Fixed-lag marginalization in iSAM2.
+ */
+
+#include "gtdynamics/utils/FixedLag.h"
+
+#include <algorithm>
+#include <set>
+
+using gtsam::FastList;
+using gtsam::FastMap;
+using gtsam::Key;
+
+namespace gtdynamics {
+
+// Mark the frontal variables of all cliques at or below `clique` that have
+// `key` in their separator.
+static void MarkAffectedKeys(Key key,
+                             const gtsam::ISAM2Clique::shared_ptr &clique,
+                             std::set<Key> *keys) {
+  const auto &conditional = clique->conditional();
+  if (std::find(conditional->beginParents(), conditional->endParents(),
+                key) == conditional->endParents())
+    return;
+  for (const Key frontal : conditional->frontals()) keys->insert(frontal);
+  for (auto &&child : clique->children) MarkAffectedKeys(key, child, keys);
+}
+
+/* ************************************************************************* */
+void FixedLagUpdate(gtsam::ISAM2 *isam,
+                    const gtsam::NonlinearFactorGraph &factors,
+                    const gtsam::Values &values,
+                    std::map<int, gtsam::KeyVector> *step_keys,
+                    int marginalized) {
+  if (marginalized < 0) {
+    isam->update(factors, values);
+    return;
+  }
+
+  // Eliminate the variables of the marginalized step first, so that they end
+  // up in leaves. Everything below them that involves them is re-eliminated.
+  const gtsam::KeyVector &old_keys = step_keys->at(marginalized);
+  FastMap<Key, int> constrained_keys;
+  for (auto &&step : *step_keys)
+    for (const Key key : step.second) constrained_keys[key] = 1;
+  std::set<Key> reeliminated;
+  for (const Key key : old_keys) {
+    constrained_keys[key] = 0;
+    reeliminated.insert(key);
+    for (auto &&child : (*isam)[key]->children)
+      MarkAffectedKeys(key, child, &reeliminated);
+  }
+
+  isam->update(factors, values, gtsam::FactorIndices(), constrained_keys,
+               boost::none,
+               FastList<Key>(reeliminated.begin(), reeliminated.end()));
+  isam->marginalizeLeaves(FastList<Key>(old_keys.begin(), old_keys.end()));
+  step_keys->erase(marginalized);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,43 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  FixedLag.h
+ * @brief Fixed-lag marginalization in iSAM2.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/ISAM2.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+
+namespace gtdynamics {
+
+/**
+ * Update `isam` with new factors and values, and marginalize the variables of
+ * the window step `marginalized` if it is >= 0. Those variables are
+ * eliminated first, so that they end up in leaves of the Bayes tree and can be
+ * removed without touching the rest, as in gtsam's incremental fixed-lag
+ * smoother.
+ *
+ * @param isam          the iSAM2 instance to update
+ * @param factors       new factors
+ * @param values        initial estimate for the new variables
+ * @param step_keys     variables of each step in the window, including the
+ *                      new ones; the entry of `marginalized` is erased
+ * @param marginalized  step to marginalize, or -1
+ */
+void FixedLagUpdate(gtsam::ISAM2 *isam,
+                    const gtsam::NonlinearFactorGraph &factors,
+                    const gtsam::Values &values,
+                    std::map<int, gtsam::KeyVector> *step_keys,
+                    int marginalized);
+
+}  // namespace gtdynamics
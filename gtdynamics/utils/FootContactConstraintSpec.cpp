@@ -12,6 +12,7 @@
  */
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
+#include <gtdynamics/factors/TrajectoryObjectiveFactors.h>
 #include <gtdynamics/utils/FootContactConstraintSpec.h>
 
 #include <iostream>
@@ -58,6 +59,19 @@ const gtsam::Point3 &FootContactConstraintSpec::contactPoint(const std::string &
     return (*it).point;
 }
 
+const gtsam::Point3 &FootContactConstraintSpec::contactPoint(
+    DynamicsIndex link_id) const {
+  auto it = std::find_if(contact_points_.begin(), contact_points_.end(),
+                         [&](const PointOnLink &contact_point) {
+                           return contact_point.link->id() == link_id;
+                         });
+  if (it == contact_points_.end())
+    throw std::runtime_error("Link with id " + std::to_string(link_id) +
+                             " has no contact point!");
+  else
+    return (*it).point;
+}
+
 std::ostream &operator<<(std::ostream &os, const FootContactConstraintSpec &phase) {
   os << "[";
   for (auto &&cp : phase.contactPoints()) {
@@ -83,24 +97,52 @@ const gtsam::Point3 &pointGoal(const ContactGoals &cp_goals,
   throw std::runtime_error("Contact Point was not found.");
 }
 
+// Goals of the contact points, by index, from goals by link name.
+static std::vector<Point3> GoalsByIndex(const PointOnLinks &all_contact_points,
+                                        const ContactPointGoals &cp_goals) {
+  std::vector<Point3> goals;
+  goals.reserve(all_contact_points.size());
+  for (auto &&cp : all_contact_points)
+    goals.push_back(cp_goals.at(cp.link->name()));
+  return goals;
+}
+
+std::vector<bool> FootContactConstraintSpec::contactMask(
+    const PointOnLinks &all_contact_points) const {
+  std::vector<bool> mask;
+  mask.reserve(all_contact_points.size());
+  for (auto &&cp : all_contact_points) mask.push_back(hasContact(cp.link));
+  return mask;
+}
+
 NonlinearFactorGraph FootContactConstraintSpec::contactPointObjectives(
     const PointOnLinks &all_contact_points, const Point3 &step,
     const gtsam::SharedNoiseModel &cost_model, size_t k_start,
     const ContactPointGoals &cp_goals, const size_t ts) const {
   NonlinearFactorGraph factors;
+  factors.resize(all_contact_points.size() * ts);
+  contactPointObjectives(all_contact_points,
+                         GoalsByIndex(all_contact_points, cp_goals), step,
+                         cost_model, k_start, ts, &factors, 0);
+  return factors;
+}
 
-  for (auto &&cp : all_contact_points) {
-    const string &name = cp.link->name();
-    const Point3 &cp_goal = cp_goals.at(name);
-    const bool stance = hasContact(cp.link);
-    auto goal_trajectory =
-        stance ? StanceTrajectory(cp_goal, ts)
-               : SimpleSwingTrajectory(cp_goal, step, ts);
-
-    factors.push_back(PointGoalFactors(cost_model, cp.point, goal_trajectory,
-                                       cp.link->id(), k_start));
+void FootContactConstraintSpec::contactPointObjectives(
+    const PointOnLinks &all_contact_points, const std::vector<Point3> &cp_goals,
+    const Point3 &step, const gtsam::SharedNoiseModel &cost_model,
+    size_t k_start, size_t ts, NonlinearFactorGraph *graph,
+    size_t offset) const {
+  const std::vector<bool> stance = contactMask(all_contact_points);
+  for (size_t c = 0; c < all_contact_points.size(); c++) {
+    const PointOnLink &cp = all_contact_points[c];
+    const gtsam::Matrix goals = stance[c]
+                                    ? StanceGoals(cp_goals[c], ts)
+                                    : SimpleSwingGoals(cp_goals[c], step, ts);
+    for (size_t s = 0; s < ts; s++)
+      (*graph)[offset + c * ts + s] = boost::make_shared<PointGoalFactor>(
+          internal::PoseKey(cp.link->id(), k_start + s), cost_model, cp.point,
+          Point3(goals.col(s)));
   }
-  return factors;
 }
 
 std::vector<string> FootContactConstraintSpec::swingLinks() const {
@@ -130,4 +172,14 @@ ContactPointGoals FootContactConstraintSpec::updateContactPointGoals(
   return new_goals;
 }
 
+std::vector<Point3> FootContactConstraintSpec::updateContactPointGoals(
+    const PointOnLinks &all_contact_points, const Point3 &step,
+    const std::vector<Point3> &cp_goals) const {
+  const std::vector<bool> stance = contactMask(all_contact_points);
+  std::vector<Point3> new_goals(cp_goals);
+  for (size_t c = 0; c < new_goals.size(); c++)
+    if (!stance[c]) new_goals[c] += step;
+  return new_goals;
+}
+
 }  // namespace gtdynamics
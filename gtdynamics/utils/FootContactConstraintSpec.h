@@ -61,6 +61,9 @@ class FootContactConstraintSpec : public ConstraintSpec {
   /// Returns the contact point object of link.
   const gtsam::Point3 &contactPoint(const std::string &link_name) const;
 
+  /// Returns the contact point object of the link with id link_id.
+  const gtsam::Point3 &contactPoint(DynamicsIndex link_id) const;
+
   /// Print to stream.
   friend std::ostream &operator<<(std::ostream &os,
                                   const FootContactConstraintSpec &phase);
@@ -82,6 +85,31 @@ class FootContactConstraintSpec : public ConstraintSpec {
       const gtsam::SharedNoiseModel &cost_model, size_t k_start,
       const ContactPointGoals &cp_goals, const size_t ts) const;
 
+  /// Whether each of the given contact points is in contact in this phase.
+  std::vector<bool> contactMask(const PointOnLinks &all_contact_points) const;
+
+  /**
+   * Same as contactPointObjectives, from contact indices: goal c and the
+   * PointGoalFactors of contact point c at step s are those of
+   * all_contact_points[c], and the factors are written to
+   * (*graph)[offset + c * ts + s], which should exist already.
+   * @param[in] all_contact_points stance *and* swing feet.
+   * @param[in] cp_goals either stance goal or start of swing, by index
+   * @param[in] step 3D vector to move by
+   * @param[in] cost_model noise model
+   * @param[in] k_start Factors are added at this time step
+   * @param[in] ts number of time steps
+   * @param[out] graph preallocated graph
+   * @param[in] offset index of the first factor in graph
+   */
+  void contactPointObjectives(const PointOnLinks &all_contact_points,
+                              const std::vector<gtsam::Point3> &cp_goals,
+                              const gtsam::Point3 &step,
+                              const gtsam::SharedNoiseModel &cost_model,
+                              size_t k_start, size_t ts,
+                              gtsam::NonlinearFactorGraph *graph,
+                              size_t offset) const;
+
   /**
    * @fn Returns the swing links during this FootContact
    * @return Vector of swing links.
@@ -97,6 +125,11 @@ class FootContactConstraintSpec : public ConstraintSpec {
   ContactPointGoals updateContactPointGoals(
       const PointOnLinks &all_contact_points, const gtsam::Point3 &step,
       const ContactPointGoals &cp_goals) const;
+
+  /// Same as updateContactPointGoals, with goals indexed by contact.
+  std::vector<gtsam::Point3> updateContactPointGoals(
+      const PointOnLinks &all_contact_points, const gtsam::Point3 &step,
+      const std::vector<gtsam::Point3> &cp_goals) const;
 };
 
 using FootContactVector = std::vector<boost::shared_ptr<FootContactConstraintSpec>>;
@@ -0,0 +1,260 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GaussianProcessTrajectory.cpp
+ * @brief Joint trajectory of sparse knots, interpolated by a Gaussian process.
+ */
+
+#include "gtdynamics/utils/GaussianProcessTrajectory.h"
+
+#include <gtsam/linear/HessianFactor.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/factors/GaussianProcessPriorFactor.h"
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/utils.h"
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Key;
+using gtsam::Matrix;
+using gtsam::Matrix3;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+namespace {
+// Labels of the joint state, in the order of calcPhi.
+const char kStateLabels[3] = {'q', 'v', 'a'};
+
+// Index of a joint state label, or -1.
+int StateIndex(const std::string &label) {
+  for (int d = 0; d < 3; ++d)
+    if (label == std::string(1, kStateLabels[d])) return d;
+  return -1;
+}
+}  // namespace
+
+/* ************************************************************************* */
+GaussianProcessInterpolation::GaussianProcessInterpolation(double tau,
+                                                           double dt) {
+  const Matrix I = gtsam::I_1x1;
+  const Matrix3 Q_tau = calcQ(I, tau), Q_dt = calcQ(I, dt);
+  Psi = Q_tau * calcPhi(dt - tau).transpose() * Q_dt.inverse();
+  Lambda = calcPhi(tau) - Psi * calcPhi(dt);
+}
+
+/* ************************************************************************* */
+InterpolatedFactor::InterpolatedFactor(
+    const gtsam::NonlinearFactor::shared_ptr &factor,
+    const std::map<Key, Combination> &combinations)
+    : factor_(factor) {
+  const auto add = [this](Key key) {
+    if (std::find(keys_.begin(), keys_.end(), key) == keys_.end())
+      keys_.push_back(key);
+  };
+  for (const Key key : factor->keys()) {
+    const auto it = combinations.find(key);
+    if (it == combinations.end()) {
+      add(key);
+      continue;
+    }
+    combinations_.insert(*it);
+    for (auto &&term : it->second) add(term.first);
+  }
+}
+
+/* ************************************************************************* */
+Values InterpolatedFactor::dense(const Values &x) const {
+  Values values;
+  for (const Key key : factor_->keys()) {
+    const auto it = combinations_.find(key);
+    if (it == combinations_.end()) {
+      values.insert(key, x.at(key));
+      continue;
+    }
+    double value = 0;
+    for (auto &&term : it->second)
+      value += term.second * x.atDouble(term.first);
+    values.insert(key, value);
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+double InterpolatedFactor::error(const Values &x) const {
+  return factor_->error(dense(x));
+}
+
+/* ************************************************************************* */
+boost::shared_ptr<gtsam::GaussianFactor> InterpolatedFactor::linearize(
+    const Values &x) const {
+  const auto linear = factor_->linearize(dense(x));
+  if (!linear) return linear;
+  auto jacobian = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(linear);
+  if (!jacobian) {
+    const auto hessian =
+        boost::dynamic_pointer_cast<gtsam::HessianFactor>(linear);
+    if (!hessian)
+      throw std::runtime_error(
+          "InterpolatedFactor: only Jacobian and Hessian linearizations are "
+          "supported.");
+    jacobian = boost::make_shared<gtsam::JacobianFactor>(*hessian);
+  }
+
+  // Chain rule through the linear interpolation.
+  std::map<Key, Matrix> blocks;
+  const auto accumulate = [&blocks](Key key, const Matrix &A) {
+    auto it = blocks.find(key);
+    if (it == blocks.end())
+      blocks.emplace(key, A);
+    else
+      it->second += A;
+  };
+  for (auto it = jacobian->begin(); it != jacobian->end(); ++it) {
+    const Matrix A = jacobian->getA(it);
+    const auto combination = combinations_.find(*it);
+    if (combination == combinations_.end()) {
+      accumulate(*it, A);
+      continue;
+    }
+    for (auto &&term : combination->second)
+      accumulate(term.first, term.second * A);
+  }
+  std::vector<std::pair<Key, Matrix>> terms;
+  terms.reserve(keys_.size());
+  for (const Key key : keys_) terms.emplace_back(key, blocks.at(key));
+  return boost::make_shared<gtsam::JacobianFactor>(
+      terms, gtsam::Vector(jacobian->getb()), jacobian->get_model());
+}
+
+/* ************************************************************************* */
+GaussianProcessTrajectory::GaussianProcessTrajectory(
+    const Robot &robot, int num_knots, double knot_dt, size_t substeps,
+    const gtsam::SharedNoiseModel &Qc_model)
+    : num_knots_(num_knots),
+      knot_dt_(knot_dt),
+      substeps_(substeps),
+      Qc_model_(Qc_model) {
+  if (num_knots < 0 || knot_dt <= 0 || substeps == 0 || !Qc_model ||
+      Qc_model->dim() != 1)
+    throw std::invalid_argument(
+        "GaussianProcessTrajectory: needs nonnegative knots, a positive "
+        "knot_dt, at least one substep and a one-dimensional Qc_model.");
+  for (auto &&joint : robot.joints()) joint_ids_.push_back(joint->id());
+  std::sort(joint_ids_.begin(), joint_ids_.end());
+  for (size_t s = 0; s < substeps; ++s)
+    interpolations_.emplace_back(s * denseDt(), knot_dt);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph GaussianProcessTrajectory::priorFactors() const {
+  NonlinearFactorGraph graph;
+  for (int i = 0; i < num_knots_; ++i) {
+    for (const int j : joint_ids_) {
+      graph.emplace_shared<GaussianProcessPriorFactor>(
+          internal::JointAngleKey(j, i), internal::JointVelKey(j, i),
+          internal::JointAccelKey(j, i), internal::JointAngleKey(j, i + 1),
+          internal::JointVelKey(j, i + 1), internal::JointAccelKey(j, i + 1),
+          knot_dt_, Qc_model_);
+    }
+  }
+  return graph;
+}
+
+/* ************************************************************************* */
+InterpolatedFactor::Combination GaussianProcessTrajectory::combination(
+    Key key) const {
+  const DynamicsSymbol symbol(key);
+  const int d = StateIndex(symbol.label());
+  if (d < 0) return {};
+  const uint64_t k = symbol.step();
+  if (k > static_cast<uint64_t>(numDenseSteps()))
+    throw std::invalid_argument("GaussianProcessTrajectory: dense step " +
+                                std::to_string(k) + " is past the last knot.");
+  const int j = symbol.jointIdx();
+  const size_t robot = symbol.robotInstance();
+  const auto knot_key = [&](int label, uint64_t i) -> Key {
+    return DynamicsSymbol::JointSymbol(kStateLabels[label], j,
+                                       DynamicsSymbol::RobotTime(robot, i));
+  };
+
+  const uint64_t i = k / substeps_, s = k % substeps_;
+  if (s == 0) return {{knot_key(d, i), 1.0}};
+  const GaussianProcessInterpolation &interpolation = interpolations_[s];
+  InterpolatedFactor::Combination combination;
+  for (int m = 0; m < 3; ++m) {
+    combination.emplace_back(knot_key(m, i), interpolation.Lambda(d, m));
+    combination.emplace_back(knot_key(m, i + 1), interpolation.Psi(d, m));
+  }
+  return combination;
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactor::shared_ptr
+GaussianProcessTrajectory::interpolatedFactor(
+    const gtsam::NonlinearFactor::shared_ptr &factor) const {
+  std::map<Key, InterpolatedFactor::Combination> combinations;
+  for (const Key key : factor->keys()) {
+    InterpolatedFactor::Combination c = combination(key);
+    if (!c.empty()) combinations.emplace(key, std::move(c));
+  }
+  if (combinations.empty()) return factor;
+  return boost::make_shared<InterpolatedFactor>(factor, combinations);
+}
+
+/* ************************************************************************* */
+NonlinearFactorGraph GaussianProcessTrajectory::interpolatedFactors(
+    const NonlinearFactorGraph &graph) const {
+  NonlinearFactorGraph interpolated;
+  for (auto &&factor : graph)
+    if (factor) interpolated.push_back(interpolatedFactor(factor));
+  return interpolated;
+}
+
+/* ************************************************************************* */
+Values GaussianProcessTrajectory::interpolate(const Values &knots) const {
+  Values values;
+  for (int k = 0; k <= numDenseSteps(); ++k) {
+    const int i = k / substeps_, s = k % substeps_;
+    for (const int j : joint_ids_) {
+      gtsam::Vector3 x(JointAngle(knots, j, i), JointVel(knots, j, i),
+                       JointAccel(knots, j, i));
+      if (s != 0) {
+        const gtsam::Vector3 x1(JointAngle(knots, j, i + 1),
+                                JointVel(knots, j, i + 1),
+                                JointAccel(knots, j, i + 1));
+        x = interpolations_[s].Lambda * x + interpolations_[s].Psi * x1;
+      }
+      InsertJointAngle(&values, j, k, x(0));
+      InsertJointVel(&values, j, k, x(1));
+      InsertJointAccel(&values, j, k, x(2));
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Values GaussianProcessTrajectory::knotValues(const Values &dense) const {
+  Values values;
+  for (int i = 0; i <= num_knots_; ++i) {
+    const int k = i * substeps_;
+    for (const int j : joint_ids_) {
+      InsertJointAngle(&values, j, i, JointAngle(dense, j, k));
+      InsertJointVel(&values, j, i, JointVel(dense, j, k));
+      InsertJointAccel(&values, j, i, JointAccel(dense, j, k));
+    }
+  }
+  return values;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GaussianProcessTrajectory.h
+ * @brief Joint trajectory of sparse knots, interpolated by a Gaussian process.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/linear/GaussianFactor.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/NonlinearFactor.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * Matrices of the Gaussian process interpolation of GaussianProcessPriorFactor
+ * at time tau after a knot, between knots dt apart: the mean of the state
+ * [q, v, a] of a joint is Lambda * x0 + Psi * x1 for the states x0 and x1 at
+ * the knots. They do not depend on Qc.
+ */
+struct GaussianProcessInterpolation {
+  gtsam::Matrix3 Lambda, Psi;
+
+  /// Matrices at time tau in [0, dt] after the first knot.
+  GaussianProcessInterpolation(double tau, double dt);
+};
+
+/**
+ * InterpolatedFactor evaluates a factor on dense-step joint states at the
+ * Gaussian process interpolation of the knot states. As the interpolation is
+ * linear, the linearization of the wrapped factor maps exactly onto the knot
+ * variables. Keys of the wrapped factor that are not interpolated are kept.
+ */
+class InterpolatedFactor : public gtsam::NonlinearFactor {
+ public:
+  /// A dense key as a linear combination of knot keys.
+  using Combination = std::vector<std::pair<gtsam::Key, double>>;
+
+  /**
+   * Constructor
+   * @param factor        the factor on dense keys
+   * @param combinations  the combination of knot keys of every interpolated
+   *                      key of the factor
+   */
+  InterpolatedFactor(const gtsam::NonlinearFactor::shared_ptr &factor,
+                     const std::map<gtsam::Key, Combination> &combinations);
+
+  /// The wrapped factor.
+  const gtsam::NonlinearFactor::shared_ptr &factor() const { return factor_; }
+
+  size_t dim() const override { return factor_->dim(); }
+
+  double error(const gtsam::Values &x) const override;
+
+  boost::shared_ptr<gtsam::GaussianFactor> linearize(
+      const gtsam::Values &x) const override;
+
+  gtsam::NonlinearFactor::shared_ptr clone() const override {
+    return boost::make_shared<InterpolatedFactor>(*this);
+  }
+
+ private:
+  gtsam::NonlinearFactor::shared_ptr factor_;
+  std::map<gtsam::Key, Combination> combinations_;
+
+  // The values of the keys of factor_, interpolated from x.
+  gtsam::Values dense(const gtsam::Values &x) const;
+};
+
+/**
+ * GaussianProcessTrajectory represents the joint angles, velocities and
+ * accelerations of a trajectory by their values at sparse knots, with the
+ * GaussianProcessPriorFactor of every joint between consecutive knots.
+ * Only the knots are optimized; the states at the dense steps in between,
+ * `substeps` per knot interval, are the closed-form interpolation of the two
+ * adjacent knots, in O(1) per state. Knot i has time step i and dense step k
+ * time step k, both with the joint keys of utils/values.h, so dense states
+ * enter collision or dynamics factors through interpolatedFactors().
+ */
+class GaussianProcessTrajectory {
+ public:
+  /**
+   * Constructor
+   * @param robot      the robot, for its joints
+   * @param num_knots  index of the last knot, knots 0..num_knots are kept
+   * @param knot_dt    time between consecutive knots
+   * @param substeps   dense steps per knot interval, at least 1
+   * @param Qc_model   one-dimensional noise model of the joint jerk
+   */
+  GaussianProcessTrajectory(const Robot &robot, int num_knots, double knot_dt,
+                            size_t substeps,
+                            const gtsam::SharedNoiseModel &Qc_model);
+
+  /// Index of the last knot.
+  int numKnots() const { return num_knots_; }
+
+  /// Index of the last dense step, which is the last knot.
+  int numDenseSteps() const { return num_knots_ * substeps_; }
+
+  /// Time between dense steps.
+  double denseDt() const { return knot_dt_ / substeps_; }
+
+  /// Gaussian process priors of all joints between consecutive knots.
+  gtsam::NonlinearFactorGraph priorFactors() const;
+
+  /// Knot keys and coefficients of joint key `key` at a dense step, or an
+  /// empty combination if it is not a joint angle, velocity or acceleration.
+  InterpolatedFactor::Combination combination(gtsam::Key key) const;
+
+  /// A factor on dense-step keys as a factor on the knots.
+  gtsam::NonlinearFactor::shared_ptr interpolatedFactor(
+      const gtsam::NonlinearFactor::shared_ptr &factor) const;
+
+  /// interpolatedFactor of every factor of a graph on dense-step keys.
+  gtsam::NonlinearFactorGraph interpolatedFactors(
+      const gtsam::NonlinearFactorGraph &graph) const;
+
+  /// Joint angles, velocities and accelerations at dense steps
+  /// 0..numDenseSteps(), interpolated from the knot values.
+  gtsam::Values interpolate(const gtsam::Values &knots) const;
+
+  /// Joint states at the knots from dense-step values, e.g. an initial
+  /// guess of the dense trajectory.
+  gtsam::Values knotValues(const gtsam::Values &dense) const;
+
+ private:
+  std::vector<int> joint_ids_;
+  int num_knots_;
+  double knot_dt_;
+  size_t substeps_;
+  gtsam::SharedNoiseModel Qc_model_;
+  std::vector<GaussianProcessInterpolation> interpolations_;  // per substep
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,181 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphTiles.cpp
+ * @brief Export of large factor graphs in time windows, for visualization.
+ */
+
+#include "gtdynamics/utils/GraphTiles.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "gtdynamics/utils/DynamicsSymbol.h"
+#include "gtdynamics/utils/JsonSaver.h"
+
+namespace gtdynamics {
+
+using gtsam::Key;
+
+namespace {
+bool HasLabel(Key key, const std::set<std::string> &labels) {
+  return labels.empty() || labels.count(DynamicsSymbol(key).label());
+}
+
+// JSON list of items, which may be empty unlike JsonSaver::JsonList.
+std::string List(const std::vector<std::string> &items, int num_indents) {
+  return items.empty() ? "[]" : JsonSaver::JsonList(items, num_indents);
+}
+
+std::string Extension(GraphFormat format) {
+  return format == GraphFormat::Json ? "json" : "bin";
+}
+}  // namespace
+
+/* ************************************************************************* */
+GraphTiles::GraphTiles(const gtsam::NonlinearFactorGraph &graph,
+                       const gtsam::Values &values, const Layout &layout,
+                       const GraphTileParameters &parameters)
+    : graph_(graph), values_(values), layout_(layout), p_(parameters) {
+  if (p_.window_steps == 0 || !(p_.step_spacing > 0))
+    throw std::invalid_argument(
+        "GraphTiles: needs at least one step per window and a positive "
+        "spacing.");
+
+  std::map<size_t, GraphWindow> windows;
+  std::map<size_t, std::set<Key>> window_keys;
+  for (size_t i = 0; i < graph.size(); i++) {
+    const auto &factor = graph.at(i);
+    if (!factor || factor->empty()) continue;
+    uint64_t step = DynamicsSymbol(factor->front()).time();
+    for (Key key : factor->keys())
+      step = std::min(step, DynamicsSymbol(key).time());
+    const size_t w = step / p_.window_steps;
+    windows[w].factors.push_back(i);
+    window_keys[w].insert(factor->begin(), factor->end());
+  }
+
+  for (auto &&entry : windows) {
+    GraphWindow &window = entry.second;
+    window.first_step = entry.first * p_.window_steps;
+    window.last_step = window.first_step + p_.window_steps - 1;
+    const std::set<Key> &keys = window_keys[entry.first];
+    window.keys.assign(keys.begin(), keys.end());
+    for (Key key : keys) window.clusters[DynamicsSymbol(key).label()]++;
+    windows_.push_back(std::move(window));
+  }
+}
+
+/* ************************************************************************* */
+std::pair<double, double> GraphTiles::extent(size_t w) const {
+  const GraphWindow &window = windows_.at(w);
+  const double half = 0.5 * p_.step_spacing;
+  return {window.first_step * p_.step_spacing - half,
+          (window.last_step + 1) * p_.step_spacing - half};
+}
+
+/* ************************************************************************* */
+std::vector<size_t> GraphTiles::windowsIn(double x0, double x1) const {
+  std::vector<size_t> result;
+  for (size_t w = 0; w < windows_.size(); w++) {
+    const auto range = extent(w);
+    if (range.first <= x1 && range.second > x0) result.push_back(w);
+  }
+  return result;
+}
+
+/* ************************************************************************* */
+GraphTiles::LocationType GraphTiles::locations(size_t w) const {
+  LocationType locations;
+  if (!layout_) return locations;
+
+  // Lay out every step with a variable in the window, including the steps
+  // after it reached by factors across its boundary.
+  const GraphWindow &window = windows_.at(w);
+  std::set<uint64_t> steps;
+  for (Key key : window.keys) steps.insert(DynamicsSymbol(key).time());
+  for (uint64_t t : steps) {
+    const gtsam::Vector3 offset(t * p_.step_spacing, 0, 0);
+    for (auto &&location : layout_(t)) {
+      if (std::binary_search(window.keys.begin(), window.keys.end(),
+                             location.first))
+        locations.emplace(location.first, location.second + offset);
+    }
+  }
+  return locations;
+}
+
+/* ************************************************************************* */
+void GraphTiles::writeWindow(size_t w, std::ostream &os,
+                             const std::set<std::string> &labels,
+                             GraphFormat format) const {
+  const GraphWindow &window = windows_.at(w);
+  const LocationType locations = this->locations(w);
+  GraphWriter writer(os, format);
+  for (Key key : window.keys)
+    if (HasLabel(key, labels)) writer.writeVariable(key, values_, locations);
+  for (size_t i : window.factors) {
+    const auto &factor = graph_.at(i);
+    if (std::all_of(factor->begin(), factor->end(),
+                    [&](Key key) { return HasLabel(key, labels); }))
+      writer.writeFactor(i, factor, values_);
+  }
+  writer.finish();
+}
+
+/* ************************************************************************* */
+void GraphTiles::writeManifest(std::ostream &os, const std::string &prefix,
+                               GraphFormat format) const {
+  using JS = JsonSaver;
+  std::vector<std::string> windows;
+  for (size_t w = 0; w < windows_.size(); w++) {
+    const GraphWindow &window = windows_[w];
+    std::vector<JS::AttributeType> clusters;
+    for (auto &&cluster : window.clusters)
+      clusters.emplace_back(JS::Quoted(cluster.first),
+                            std::to_string(cluster.second));
+    const auto range = extent(w);
+    const std::vector<JS::AttributeType> attributes{
+        {JS::Quoted("file"),
+         JS::Quoted(prefix + std::to_string(w) + "." + Extension(format))},
+        {JS::Quoted("first_step"), std::to_string(window.first_step)},
+        {JS::Quoted("last_step"), std::to_string(window.last_step)},
+        {JS::Quoted("extent"),
+         JS::GetVector(gtsam::Vector2(range.first, range.second))},
+        {JS::Quoted("num_variables"), std::to_string(window.keys.size())},
+        {JS::Quoted("num_factors"), std::to_string(window.factors.size())},
+        {JS::Quoted("clusters"), JS::JsonDict(clusters, -1)}};
+    windows.push_back(JS::JsonDict(attributes, -1));
+  }
+
+  const std::vector<JS::AttributeType> manifest{
+      {JS::Quoted("format"), JS::Quoted(Extension(format))},
+      {JS::Quoted("window_steps"), std::to_string(p_.window_steps)},
+      {JS::Quoted("step_spacing"), std::to_string(p_.step_spacing)},
+      {JS::Quoted("windows"), List(windows, 0)}};
+  os << JS::JsonDict(manifest) << "\n";
+}
+
+/* ************************************************************************* */
+void GraphTiles::save(const std::string &directory, GraphFormat format) const {
+  const std::string prefix = "window_";
+  std::ofstream manifest(directory + "/manifest.json");
+  if (!manifest)
+    throw std::runtime_error("GraphTiles: cannot write into " + directory);
+  writeManifest(manifest, prefix, format);
+
+  for (size_t w = 0; w < windows_.size(); w++) {
+    std::ofstream file(directory + "/" + prefix + std::to_string(w) + "." +
+                           Extension(format),
+                       std::ios::binary);
+    writeWindow(w, file, {}, format);
+  }
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphTiles.h
+ * @brief Export of large factor graphs in time windows, for visualization.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <functional>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/utils/GraphWriter.h"
+
+namespace gtdynamics {
+
+/// Parameters of GraphTiles.
+struct GraphTileParameters {
+  size_t window_steps = 10;    // time steps per window
+  double step_spacing = 20.0;  // x offset between the layouts of steps
+};
+
+/// One window of GraphTiles: the factors of a range of time steps.
+struct GraphWindow {
+  size_t first_step = 0, last_step = 0;  // steps of the window, inclusive
+  std::vector<size_t> factors;  // indices in the graph of its factors
+  gtsam::KeyVector keys;        // variables of the factors, sorted
+  std::map<std::string, size_t> clusters;  // number of variables per label
+};
+
+/**
+ * GraphTiles splits a factor graph into windows of consecutive time steps,
+ * so that a visualizer can fetch only the part of a long trajectory that is
+ * on screen. A factor belongs to the window of the earliest time step of its
+ * keys, given by DynamicsSymbol; its keys at later steps are written with it,
+ * so that collocation factors across a window boundary keep both ends.
+ *
+ * The layout of the variables of a step is computed only when a window
+ * containing it is written, by the layout function in the frame of the step,
+ * and shifted by step * step_spacing along x as in saveGraphMultiSteps. The
+ * windows hence tile the x axis, and the windows on screen follow from the
+ * visible x range alone, see windowsIn().
+ *
+ * save() writes each window as a file in the format of GraphWriter, plus a
+ * JSON manifest of the windows, their step ranges, x extents and variable
+ * counts per cluster (the DynamicsSymbol label), read by factor_graph.js.
+ */
+class GraphTiles {
+ public:
+  using LocationType = GraphWriter::LocationType;
+
+  /// Locations of the variables of time step t, in the frame of the step.
+  using Layout = std::function<LocationType(size_t t)>;
+
+  /**
+   * Index the factors of a graph by window; nothing is laid out yet.
+   * @param graph       the factor graph, kept by reference
+   * @param values      values of its variables, kept by reference
+   * @param layout      layout of each step, or empty to place poses at
+   *                    their translation as GraphWriter does
+   * @param parameters  window size and spacing
+   */
+  GraphTiles(const gtsam::NonlinearFactorGraph &graph,
+             const gtsam::Values &values, const Layout &layout = Layout(),
+             const GraphTileParameters &parameters = GraphTileParameters());
+
+  /// Number of non-empty windows.
+  size_t size() const { return windows_.size(); }
+
+  /// Window w, in increasing order of steps.
+  const GraphWindow &window(size_t w) const { return windows_.at(w); }
+
+  /// Range [x0, x1) of the x axis covered by the steps of window w.
+  std::pair<double, double> extent(size_t w) const;
+
+  /// Indices of the windows overlapping the x range [x0, x1].
+  std::vector<size_t> windowsIn(double x0, double x1) const;
+
+  /// Locations of the variables of window w, computed on each call.
+  LocationType locations(size_t w) const;
+
+  /**
+   * Write window w, its variables and then its factors.
+   * @param w       index of the window
+   * @param os      output stream
+   * @param labels  if not empty, only the variables with these labels and
+   *                the factors all of whose variables have one of them
+   * @param format  output format
+   */
+  void writeWindow(size_t w, std::ostream &os,
+                   const std::set<std::string> &labels = {},
+                   GraphFormat format = GraphFormat::Json) const;
+
+  /// Write the JSON manifest, naming window w "<prefix><w>.<extension>".
+  void writeManifest(std::ostream &os, const std::string &prefix = "window_",
+                     GraphFormat format = GraphFormat::Json) const;
+
+  /// Write manifest.json and the file of every window into `directory`.
+  void save(const std::string &directory,
+            GraphFormat format = GraphFormat::Json) const;
+
+ private:
+  const gtsam::NonlinearFactorGraph &graph_;
+  const gtsam::Values &values_;
+  Layout layout_;
+  GraphTileParameters p_;
+  std::vector<GraphWindow> windows_;
+};
+
+}  // namespace gtdynamics
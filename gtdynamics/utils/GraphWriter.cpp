@@ -0,0 +1,216 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphWriter.cpp
+ * @brief Streaming export of factor graphs, in JSON or a binary format.
+ */
+
+#include "gtdynamics/utils/GraphWriter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "gtdynamics/utils/JsonSaver.h"
+
+namespace gtdynamics {
+
+using gtsam::Key;
+using gtsam::Value;
+using gtsam::Values;
+using gtsam::Vector;
+
+static constexpr uint32_t kBinaryVersion = 1;
+
+namespace {
+
+// Append the bytes of a number to a binary payload.
+template <typename T>
+void Append(std::string *buffer, T x) {
+  buffer->append(reinterpret_cast<const char *>(&x), sizeof(T));
+}
+
+void AppendString(std::string *buffer, const std::string &s) {
+  Append<uint32_t>(buffer, s.size());
+  buffer->append(s);
+}
+
+void AppendVector(std::string *buffer, const Vector &v) {
+  Append<uint32_t>(buffer, v.size());
+  for (int i = 0; i < v.size(); i++) Append<double>(buffer, v(i));
+}
+
+// Numbers of a value: poses as x, y, z, roll, pitch, yaw, vectors and scalars
+// as they are, other types as an empty vector.
+Vector ValueVector(const Value &value) {
+  if (auto p = dynamic_cast<const gtsam::GenericValue<gtsam::Pose3> *>(
+          &value)) {
+    Vector v(6);
+    v << p->value().translation(), p->value().rotation().rpy();
+    return v;
+  } else if (auto p =
+                 dynamic_cast<const gtsam::GenericValue<gtsam::Vector6> *>(
+                     &value)) {
+    return p->value();
+  } else if (auto p =
+                 dynamic_cast<const gtsam::GenericValue<gtsam::Vector3> *>(
+                     &value)) {
+    return p->value();
+  } else if (auto p = dynamic_cast<const gtsam::GenericValue<Vector> *>(
+                 &value)) {
+    return p->value();
+  } else if (auto p =
+                 dynamic_cast<const gtsam::GenericValue<double> *>(&value)) {
+    return Vector::Constant(1, p->value());
+  }
+  return Vector();
+}
+
+// Location of a variable, with the same rules as JsonSaver::GetLocation.
+bool Location(const GraphWriter::LocationType &locations, Key key,
+              const Value &value, gtsam::Vector3 *location) {
+  if (!locations.empty()) {
+    auto it = locations.find(key);
+    if (it == locations.end()) return false;
+    *location = it->second;
+    return true;
+  }
+  if (auto p = dynamic_cast<const gtsam::GenericValue<gtsam::Pose3> *>(
+          &value)) {
+    *location = p->value().translation();
+    return true;
+  } else if (auto p =
+                 dynamic_cast<const gtsam::GenericValue<gtsam::Point3> *>(
+                     &value)) {
+    *location = p->value();
+    return true;
+  }
+  return false;
+}
+
+// A JSON record on a single line: newlines in printed values become spaces.
+std::string SingleLine(std::string record) {
+  std::replace(record.begin(), record.end(), '\n', ' ');
+  return record;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+GraphWriter::GraphWriter(std::ostream &os, GraphFormat format)
+    : os_(os), format_(format) {
+  if (format_ == GraphFormat::Json) {
+    os_ << "[[";
+  } else {
+    os_.write("GTDGRAPH", 8);
+    os_.write(reinterpret_cast<const char *>(&kBinaryVersion),
+              sizeof(kBinaryVersion));
+  }
+}
+
+/* ************************************************************************* */
+GraphWriter::~GraphWriter() { finish(); }
+
+/* ************************************************************************* */
+void GraphWriter::beginJsonRecord(Section section) {
+  if (section_ == Section::Done || section < section_)
+    throw std::logic_error(
+        "GraphWriter: in JSON, variables are written before factors, and "
+        "nothing after finish()");
+  if (section != section_) {
+    os_ << "\n],[";
+    section_ = section;
+    first_in_section_ = true;
+  }
+  os_ << (first_in_section_ ? "\n" : "\n,");
+  first_in_section_ = false;
+}
+
+/* ************************************************************************* */
+void GraphWriter::writeBinaryRecord(char kind) {
+  if (section_ == Section::Done)
+    throw std::logic_error("GraphWriter: write after finish()");
+  os_.put(kind);
+  const uint32_t size = buffer_.size();
+  os_.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  os_.write(buffer_.data(), buffer_.size());
+}
+
+/* ************************************************************************* */
+void GraphWriter::writeVariable(Key key, const Values &values,
+                                const GraphWriter::LocationType &locations) {
+  if (format_ == GraphFormat::Json) {
+    beginJsonRecord(Section::Variables);
+    os_ << SingleLine(JsonSaver::GetVariable(key, values, locations, -1));
+    return;
+  }
+
+  buffer_.clear();
+  Append<uint64_t>(&buffer_, key);
+  AppendString(&buffer_, JsonSaver::GetName(key));
+  gtsam::Vector3 location;
+  bool has_location = false;
+  if (values.exists(key)) {
+    const Value &value = values.at(key);
+    AppendVector(&buffer_, ValueVector(value));
+    has_location = Location(locations, key, value, &location);
+  } else {
+    AppendVector(&buffer_, Vector());
+  }
+  Append<uint8_t>(&buffer_, has_location);
+  if (has_location)
+    for (int i = 0; i < 3; i++) Append<double>(&buffer_, location(i));
+  writeBinaryRecord('V');
+}
+
+/* ************************************************************************* */
+void GraphWriter::writeFactor(size_t index,
+                              const gtsam::NonlinearFactor::shared_ptr &factor,
+                              const Values &values) {
+  if (format_ == GraphFormat::Json) {
+    beginJsonRecord(Section::Factors);
+    os_ << SingleLine(JsonSaver::GetFactor(index, factor, values, -1));
+    return;
+  }
+
+  buffer_.clear();
+  Append<uint64_t>(&buffer_, index);
+  AppendString(&buffer_, JsonSaver::GetType(factor));
+  Append<uint32_t>(&buffer_, factor->size());
+  for (Key key : factor->keys()) Append<uint64_t>(&buffer_, key);
+  Append<double>(&buffer_, factor->error(values));
+  auto noise_factor = dynamic_cast<const gtsam::NoiseModelFactor *>(&*factor);
+  AppendVector(&buffer_,
+               noise_factor ? noise_factor->whitenedError(values) : Vector());
+  writeBinaryRecord('F');
+}
+
+/* ************************************************************************* */
+void GraphWriter::finish() {
+  if (section_ == Section::Done) return;
+  if (format_ == GraphFormat::Json) {
+    if (section_ == Section::Variables) os_ << "\n],[";
+    os_ << "\n]]\n";
+  }
+  os_.flush();
+  section_ = Section::Done;
+}
+
+/* ************************************************************************* */
+void GraphWriter::Save(const gtsam::NonlinearFactorGraph &graph,
+                       std::ostream &os, const Values &values,
+                       const GraphWriter::LocationType &locations,
+                       GraphFormat format) {
+  GraphWriter writer(os, format);
+  for (Key key : graph.keys()) writer.writeVariable(key, values, locations);
+  for (size_t i = 0; i < graph.size(); ++i)
+    writer.writeFactor(i, graph.at(i), values);
+  writer.finish();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,127 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  GraphWriter.h
+ * @brief Streaming export of factor graphs, in JSON or a binary format.
+ */
+
+#pragma once
+
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace gtdynamics {
+
+/// Output formats of GraphWriter.
+enum class GraphFormat { Json, Binary };
+
+/**
+ * GraphWriter exports a factor graph one variable or factor at a time, so the
+ * memory used does not grow with the size of the graph, unlike the documents
+ * JsonSaver builds in memory. Any std::ostream works, e.g. a file or a socket
+ * stream.
+ *
+ * The JSON format is the one of JsonSaver::SaveFactorGraph, read by
+ * visualization/factor_graph.js, written with one record per line so it can
+ * also be read lazily, see visualization/graph_reader.py:
+ *
+ *     [[
+ *     {variable}
+ *     ,{variable}
+ *     ],[
+ *     {factor}
+ *     ]]
+ *
+ * In JSON all variables have to be written before the factors. The binary
+ * format has no such restriction. It starts with the 8 bytes "GTDGRAPH" and a
+ * uint32 version, followed by length-prefixed records that a reader can skip:
+ *
+ *     uint8 kind ('V' or 'F'), uint32 payload size, payload
+ *     variable:  uint64 key, string name, vector value,
+ *                uint8 has_location[, 3 doubles location]
+ *     factor:    uint64 index, string type, uint32 #keys, uint64 keys...,
+ *                double error, vector whitened error
+ *
+ * where a string is a uint32 length and its bytes, and a vector a uint32 size
+ * and its doubles. Pose values are stored as x, y, z, roll, pitch, yaw. All
+ * numbers are in host byte order.
+ */
+class GraphWriter {
+ public:
+  /// Locations of variables, the same as JsonSaver::LocationType.
+  using LocationType = std::map<gtsam::Key, gtsam::Vector3>;
+
+  /**
+   * Constructor, writes the header.
+   * @param os      output stream, needs to outlive the writer
+   * @param format  output format
+   */
+  explicit GraphWriter(std::ostream &os,
+                       GraphFormat format = GraphFormat::Json);
+
+  /// Destructor, calls finish().
+  ~GraphWriter();
+
+  GraphWriter(const GraphWriter &) = delete;
+  GraphWriter &operator=(const GraphWriter &) = delete;
+
+  /**
+   * Write the variable `key`, with its value in `values` if present.
+   * @param key        variable key
+   * @param values     values of the variables
+   * @param locations  manually specified locations, see JsonSaver
+   */
+  void writeVariable(
+      gtsam::Key key, const gtsam::Values &values,
+      const LocationType &locations = LocationType());
+
+  /**
+   * Write a factor, with its errors at `values`, which needs to contain all
+   * its keys.
+   * @param index   index of the factor, used for its name
+   * @param factor  the factor
+   * @param values  values of the variables
+   */
+  void writeFactor(size_t index,
+                   const gtsam::NonlinearFactor::shared_ptr &factor,
+                   const gtsam::Values &values);
+
+  /// Close the JSON lists and flush; later writes throw.
+  void finish();
+
+  /**
+   * Stream `graph` to `os`: every variable of the graph, then every factor.
+   * Streaming equivalent of JsonSaver::SaveFactorGraph.
+   */
+  static void Save(
+      const gtsam::NonlinearFactorGraph &graph, std::ostream &os,
+      const gtsam::Values &values = gtsam::Values(),
+      const LocationType &locations = LocationType(),
+      GraphFormat format = GraphFormat::Json);
+
+ private:
+  enum class Section { Variables, Factors, Done };
+
+  std::ostream &os_;
+  GraphFormat format_;
+  Section section_ = Section::Variables;
+  bool first_in_section_ = true;
+  std::string buffer_;  // payload of the current binary record
+
+  /// Start a JSON record in `section`, closing the previous section if needed.
+  void beginJsonRecord(Section section);
+
+  /// Write the binary record of `kind` whose payload is in buffer_.
+  void writeBinaryRecord(char kind);
+};
+
+}  // namespace gtdynamics
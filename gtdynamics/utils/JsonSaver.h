@@ -349,11 +349,13 @@ class JsonSaver {
    * @param[in] key           corresponding key of variable
    * @param[in] values        values
    * @param[in] locations     locations
+   * @param[in] num_indents   indents as in JsonDict, -1 for a single line
    * @return                  a string displaying the variable in json
    */
   static inline std::string GetVariable(const gtsam::Key& key,
                                         const gtsam::Values& values,
-                                        const LocationType& locations) {
+                                        const LocationType& locations,
+                                        const int num_indents = 0) {
     std::vector<AttributeType> attributes;
 
     // name;
@@ -372,7 +374,7 @@ class JsonSaver {
         attributes.emplace_back(Quoted("location"), loc_str);
       }
     }
-    return JsonDict(attributes);
+    return JsonDict(attributes, num_indents);
   }
 
   /**
@@ -385,8 +387,20 @@ class JsonSaver {
   static inline std::string GetFactor(const size_t idx,
                                       const gtsam::NonlinearFactorGraph& graph,
                                       const gtsam::Values& values) {
-    const gtsam::NonlinearFactor::shared_ptr& factor = graph.at(idx);
+    return GetFactor(idx, graph.at(idx), values);
+  }
 
+  /**
+   * @brief get the factor in json format as a string
+   * @param[in] idx           index of factor, used for its name
+   * @param[in] factor        gtsam factor pointer
+   * @param[in] values        values
+   * @param[in] num_indents   indents as in JsonDict, -1 for a single line
+   * @return                  a string displaying the factor in json
+   */
+  static inline std::string GetFactor(
+      const size_t idx, const gtsam::NonlinearFactor::shared_ptr& factor,
+      const gtsam::Values& values, const int num_indents = 0) {
     std::vector<AttributeType> attributes;
 
     // name
@@ -420,7 +434,7 @@ class JsonSaver {
     // error
     attributes.emplace_back(Quoted("error"), GetError(factor, values));
 
-    return JsonDict(attributes);
+    return JsonDict(attributes, num_indents);
   }
 
   /**
@@ -503,12 +517,29 @@ class JsonSaver {
       const std::map<std::string, gtsam::Values>& clustered_values,
       const gtsam::Values& values,
       const StrLocationType& locations = StrLocationType()) {
+    std::map<std::string, gtsam::KeyVector> clustered_keys;
+    for (const auto& it : clustered_values)
+      clustered_keys[it.first] = it.second.keys();
+    SaveClusteredGraph(stm, clustered_graphs, clustered_keys, values,
+                       locations);
+  }
+
+  /**
+   * @brief output the clustered graph to ostream, with the variables of each
+   * cluster given by their keys, so that values are not copied per cluster.
+   */
+  static inline void SaveClusteredGraph(
+      std::ostream& stm,
+      const std::map<std::string, gtsam::NonlinearFactorGraph>&
+          clustered_graphs,
+      const std::map<std::string, gtsam::KeyVector>& clustered_keys,
+      const gtsam::Values& values,
+      const StrLocationType& locations = StrLocationType()) {
     // create map from key to value_cluster name for faster searching
     std::map<gtsam::Key, std::string> key_to_cluster;
-    for (auto value_cluster : clustered_values) {
-      std::string cluster_name = value_cluster.first;
-      // std::cout << "value cluster: " << cluster_name << "\n";
-      for (const auto& key : value_cluster.second.keys()) {
+    for (const auto& value_cluster : clustered_keys) {
+      const std::string& cluster_name = value_cluster.first;
+      for (const auto& key : value_cluster.second) {
         key_to_cluster[key] = cluster_name;
       }
     }
@@ -517,9 +548,8 @@ class JsonSaver {
     std::vector<std::string> graphs_strings;
 
     // add clustered values
-    for (const auto& it : clustered_values) {
+    for (const auto& it : clustered_keys) {
       std::string cluster_name = it.first;
-      const gtsam::Values& values = it.second;
 
       std::vector<AttributeType> attributes;
       // name
@@ -533,7 +563,7 @@ class JsonSaver {
 
       // values
       std::vector<std::string> varaible_names;
-      for (const gtsam::Key& key : values.keys()) {
+      for (const gtsam::Key& key : it.second) {
         varaible_names.emplace_back(GetName(key));
       }
       attributes.emplace_back(JsonSaver::Quoted("value"),
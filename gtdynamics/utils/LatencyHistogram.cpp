@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LatencyHistogram.cpp
+ * @brief Fixed-size log-linear histogram of durations.
+ */
+
+#include "gtdynamics/utils/LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace gtdynamics {
+
+namespace {
+constexpr size_t kSubBits = 4;  // log2(LatencyHistogram::kSubBuckets)
+
+// Index of the most significant bit of v > 0.
+size_t MostSignificantBit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+  return 63 - __builtin_clzll(v);
+#else
+  size_t msb = 0;
+  while (v >>= 1) ++msb;
+  return msb;
+#endif
+}
+}  // namespace
+
+// Bucket b < 2 * kSubBuckets holds the duration b exactly; above, durations
+// with most significant bit e >= kSubBits are shifted right by e - kSubBits,
+// leaving a mantissa in [kSubBuckets, 2 * kSubBuckets), and bucket
+// mantissa + kSubBuckets * shift holds them.
+static_assert(LatencyHistogram::kSubBuckets == 1 << kSubBits,
+              "kSubBits does not match kSubBuckets");
+
+/* ************************************************************************* */
+LatencyHistogram::LatencyHistogram()
+    : counts_(Bucket(~uint64_t(0)) + 1, 0) {}
+
+/* ************************************************************************* */
+size_t LatencyHistogram::Bucket(uint64_t nanoseconds) {
+  if (nanoseconds < kSubBuckets) return nanoseconds;
+  const size_t shift = MostSignificantBit(nanoseconds) - kSubBits;
+  return (nanoseconds >> shift) + kSubBuckets * shift;
+}
+
+/* ************************************************************************* */
+uint64_t LatencyHistogram::LowerBound(size_t bucket) {
+  if (bucket < kSubBuckets) return bucket;
+  const size_t shift = bucket / kSubBuckets - 1;
+  return uint64_t(bucket - kSubBuckets * shift) << shift;
+}
+
+/* ************************************************************************* */
+void LatencyHistogram::record(double seconds) {
+  recordNanoseconds(seconds > 0 ? static_cast<uint64_t>(seconds * 1e9) : 0);
+}
+
+/* ************************************************************************* */
+void LatencyHistogram::recordNanoseconds(uint64_t nanoseconds) {
+  ++counts_[Bucket(nanoseconds)];
+  min_ = count_ ? std::min(min_, nanoseconds) : nanoseconds;
+  max_ = std::max(max_, nanoseconds);
+  total_ += nanoseconds;
+  ++count_;
+}
+
+/* ************************************************************************* */
+double LatencyHistogram::mean() const {
+  return count_ ? total() / count_ : 0.0;
+}
+
+/* ************************************************************************* */
+double LatencyHistogram::min() const { return 1e-9 * min_; }
+
+/* ************************************************************************* */
+double LatencyHistogram::max() const { return 1e-9 * max_; }
+
+/* ************************************************************************* */
+double LatencyHistogram::percentile(double percent) const {
+  if (percent < 0 || percent > 100)
+    throw std::invalid_argument(
+        "LatencyHistogram::percentile: percent should be in [0, 100]");
+  if (!count_) return 0.0;
+  const uint64_t rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(percent / 100 * count_)));
+  uint64_t seen = 0;
+  for (size_t b = 0; b < counts_.size(); ++b) {
+    seen += counts_[b];
+    if (seen < rank) continue;
+    // Middle of the bucket, within the recorded range.
+    const uint64_t lower = LowerBound(b);
+    const uint64_t width = LowerBound(b + 1) - lower;
+    return 1e-9 * std::min(max_, std::max(min_, lower + width / 2));
+  }
+  return max();
+}
+
+/* ************************************************************************* */
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+  if (!other.count_) return;
+  for (size_t b = 0; b < counts_.size(); ++b) counts_[b] += other.counts_[b];
+  min_ = count_ ? std::min(min_, other.min_) : other.min_;
+  max_ = std::max(max_, other.max_);
+  total_ += other.total_;
+  count_ += other.count_;
+}
+
+/* ************************************************************************* */
+void LatencyHistogram::reset() {
+  std::fill(counts_.begin(), counts_.end(), 0);
+  count_ = total_ = min_ = max_ = 0;
+}
+
+/* ************************************************************************* */
+std::string LatencyHistogram::toJson(size_t indent) const {
+  const std::string pad(indent, ' ');
+  std::ostringstream os;
+  os << std::setprecision(10);
+  os << "{\n"
+     << pad << "  \"count\": " << count_ << ",\n"
+     << pad << "  \"total\": " << total() << ",\n"
+     << pad << "  \"mean\": " << mean() << ",\n"
+     << pad << "  \"min\": " << min() << ",\n"
+     << pad << "  \"p50\": " << percentile(50) << ",\n"
+     << pad << "  \"p90\": " << percentile(90) << ",\n"
+     << pad << "  \"p99\": " << percentile(99) << ",\n"
+     << pad << "  \"p999\": " << percentile(99.9) << ",\n"
+     << pad << "  \"max\": " << max() << ",\n"
+     << pad << "  \"buckets\": [";
+  bool first = true;
+  for (size_t b = 0; b < counts_.size(); ++b) {
+    if (!counts_[b]) continue;
+    os << (first ? "" : ", ") << "[" << 1e-9 * LowerBound(b) << ", "
+       << counts_[b] << "]";
+    first = false;
+  }
+  os << "]\n" << pad << "}";
+  return os.str();
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,87 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  LatencyHistogram.h
+ * @brief Fixed-size log-linear histogram of durations.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Histogram of durations in the style of HdrHistogram: durations are counted
+ * in nanoseconds, in buckets that are linear within each power of two, so
+ * every recorded duration is known to within 1 / kSubBuckets of its value
+ * over the whole range, from nanoseconds to hours, in a few kilobytes.
+ * Recording is a few integer operations and never allocates, and histograms
+ * of different threads can be merged.
+ *
+ * Not thread-safe: use one histogram per thread and merge.
+ */
+class LatencyHistogram {
+ public:
+  /// Linear buckets per power of two, a relative precision of 1/16.
+  static constexpr size_t kSubBuckets = 16;
+
+  LatencyHistogram();
+
+  /// Count a duration in seconds, negative ones as 0.
+  void record(double seconds);
+
+  /// Count a duration in nanoseconds.
+  void recordNanoseconds(uint64_t nanoseconds);
+
+  /// Number of recorded durations.
+  uint64_t count() const { return count_; }
+
+  /// Sum of the recorded durations, in seconds.
+  double total() const { return 1e-9 * total_; }
+
+  /// Mean duration in seconds, 0 if empty.
+  double mean() const;
+
+  /// Smallest duration in seconds, 0 if empty.
+  double min() const;
+
+  /// Largest duration in seconds, 0 if empty.
+  double max() const;
+
+  /**
+   * Duration in seconds below which `percent` percent of the recorded
+   * durations fall, to the precision of the buckets, 0 if empty.
+   * @param percent in [0, 100]
+   */
+  double percentile(double percent) const;
+
+  /// Add the counts of `other`.
+  void merge(const LatencyHistogram &other);
+
+  /// Forget all recorded durations.
+  void reset();
+
+  /**
+   * JSON object with the count, total, mean, min, p50, p90, p99, p999 and max
+   * in seconds, and the non-empty buckets as [lower bound, count] pairs.
+   * @param indent spaces before each line but the first
+   */
+  std::string toJson(size_t indent = 0) const;
+
+ private:
+  static size_t Bucket(uint64_t nanoseconds);
+  static uint64_t LowerBound(size_t bucket);
+
+  std::vector<uint64_t> counts_;
+  uint64_t count_ = 0, total_ = 0, min_ = 0, max_ = 0;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MappedFile.cpp
+ * @brief Read-only memory mapping of files of doubles.
+ */
+
+#include "gtdynamics/utils/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+std::shared_ptr<const double> MapDoubles(const std::string &path,
+                                         size_t count) {
+  const size_t bytes = count * sizeof(double);
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("MapDoubles: cannot open " + path + ".");
+  struct stat status;
+  if (fstat(fd, &status) != 0 || size_t(status.st_size) != bytes ||
+      bytes == 0) {
+    close(fd);
+    throw std::invalid_argument("MapDoubles: " + path + " does not hold " +
+                                std::to_string(count) + " doubles.");
+  }
+  void *address = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED)
+    throw std::runtime_error("MapDoubles: cannot map " + path + ".");
+  return std::shared_ptr<const double>(
+      static_cast<const double *>(address),
+      [address, bytes](const double *) { munmap(address, bytes); });
+}
+
+}  // namespace gtdynamics
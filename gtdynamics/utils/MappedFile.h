@@ -0,0 +1,30 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MappedFile.h
+ * @brief Read-only memory mapping of files of doubles.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Map a file of `count` native doubles into memory, read-only. Pages are
+ * loaded on first access and shared with other processes mapping the same
+ * file; the mapping is released with the last copy of the pointer.
+ * @throws std::runtime_error if the file cannot be opened or mapped, and
+ * std::invalid_argument if it does not hold `count` doubles.
+ */
+std::shared_ptr<const double> MapDoubles(const std::string &path,
+                                         size_t count);
+
+}  // namespace gtdynamics
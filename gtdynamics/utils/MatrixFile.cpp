@@ -0,0 +1,196 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MatrixFile.cpp
+ * @brief Fast loading of matrices from binary and whitespace-text files.
+ */
+
+#include "gtdynamics/utils/MatrixFile.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+static const char kMagic[8] = "GTDMAT";
+static constexpr size_t kHeaderSize = 24;
+
+namespace {
+
+// The bytes of a file, memory-mapped where possible.
+class FileBytes {
+ public:
+  explicit FileBytes(const std::string &filename) {
+#ifndef _WIN32
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::runtime_error("ReadMatrixFile: cannot open " + filename);
+    struct stat st;
+    const bool ok = ::fstat(fd, &st) == 0;
+    if (ok && st.st_size > 0) {
+      size_ = st.st_size;
+      void *map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+      if (map != MAP_FAILED) data_ = static_cast<const char *>(map);
+    }
+    ::close(fd);
+    if (!ok || (size_ > 0 && !data_))
+      throw std::runtime_error("ReadMatrixFile: cannot map " + filename);
+#else
+    std::ifstream is(filename, std::ios::binary);
+    if (!is)
+      throw std::runtime_error("ReadMatrixFile: cannot open " + filename);
+    buffer_.assign(std::istreambuf_iterator<char>(is),
+                   std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+  }
+
+  ~FileBytes() {
+#ifndef _WIN32
+    if (data_) ::munmap(const_cast<char *>(data_), size_);
+#endif
+  }
+
+  FileBytes(const FileBytes &) = delete;
+  FileBytes &operator=(const FileBytes &) = delete;
+
+  const char *begin() const { return data_; }
+  const char *end() const { return data_ + size_; }
+  size_t size() const { return size_; }
+
+ private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  std::vector<char> buffer_;  // used where memory-mapping is not available
+};
+
+inline bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Parse the entries of the line [p, end) into out[0], out[stride], ...,
+// stopping after max_count entries, and return the number of entries. The
+// mapping is not null-terminated, so every token is copied to a terminated
+// buffer before strtod.
+size_t ParseLine(const char *p, const char *end, double *out, size_t stride,
+                 size_t max_count) {
+  size_t count = 0;
+  char token[64];
+  while (true) {
+    while (p < end && IsSpace(*p)) p++;
+    if (p == end) return count;
+    const char *start = p;
+    while (p < end && !IsSpace(*p)) p++;
+    const size_t length = p - start;
+    if (length >= sizeof(token))
+      throw std::invalid_argument("ReadMatrixFile: entry too long.");
+    std::memcpy(token, start, length);
+    token[length] = '\0';
+    char *parsed;
+    const double x = std::strtod(token, &parsed);
+    if (parsed != token + length)
+      throw std::invalid_argument("ReadMatrixFile: \"" + std::string(token) +
+                                  "\" is not a number.");
+    if (count < max_count) out[count * stride] = x;
+    count++;
+  }
+}
+
+gtsam::Matrix ReadBinary(const FileBytes &bytes, const std::string &filename) {
+  if (bytes.size() < kHeaderSize)
+    throw std::invalid_argument("ReadMatrixFile: " + filename +
+                                " is truncated.");
+  uint64_t rows, cols;
+  std::memcpy(&rows, bytes.begin() + 8, sizeof(rows));
+  std::memcpy(&cols, bytes.begin() + 16, sizeof(cols));
+  if (bytes.size() != kHeaderSize + sizeof(double) * rows * cols)
+    throw std::invalid_argument("ReadMatrixFile: " + filename +
+                                " is truncated.");
+  gtsam::Matrix matrix(rows, cols);
+  if (rows * cols > 0)
+    std::memcpy(matrix.data(), bytes.begin() + kHeaderSize,
+                sizeof(double) * rows * cols);
+  return matrix;
+}
+
+gtsam::Matrix ReadText(const FileBytes &bytes, const std::string &filename,
+                       size_t num_threads) {
+  // Split into the lines holding entries.
+  struct Line {
+    const char *begin, *end;
+  };
+  std::vector<Line> lines;
+  const char *p = bytes.begin(), *const end = bytes.end();
+  while (p < end) {
+    const char *next =
+        static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (!next) next = end;
+    const char *q = p;
+    while (q < next && IsSpace(*q)) q++;
+    if (q < next && *q != '#') lines.push_back({q, next});
+    p = next + 1;
+  }
+  if (lines.empty()) return gtsam::Matrix();
+
+  const size_t cols = ParseLine(lines[0].begin, lines[0].end, nullptr, 0, 0);
+  gtsam::Matrix matrix(lines.size(), cols);
+  const Eigen::Index rows = matrix.rows();
+  ThreadPool(num_threads).parallelFor(lines.size(), [&](size_t i, size_t) {
+    if (ParseLine(lines[i].begin, lines[i].end, matrix.data() + i, rows,
+                  cols) != cols)
+      throw std::invalid_argument("ReadMatrixFile: row " +
+                                  std::to_string(i) + " of " + filename +
+                                  " does not have " + std::to_string(cols) +
+                                  " entries.");
+  });
+  return matrix;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+void WriteMatrixFile(const std::string &filename,
+                     const gtsam::Matrix &matrix) {
+  std::ofstream os(filename, std::ios::binary | std::ios::trunc);
+  const uint64_t rows = matrix.rows(), cols = matrix.cols();
+  os.write(kMagic, sizeof(kMagic));
+  os.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+  os.write(reinterpret_cast<const char *>(&cols), sizeof(cols));
+  os.write(reinterpret_cast<const char *>(matrix.data()),
+           sizeof(double) * rows * cols);
+  if (!os)
+    throw std::runtime_error("WriteMatrixFile: cannot write " + filename);
+}
+
+/* ************************************************************************* */
+gtsam::Matrix ReadMatrixFile(const std::string &filename,
+                             size_t num_threads) {
+  const FileBytes bytes(filename);
+  if (bytes.size() >= sizeof(kMagic) &&
+      std::memcmp(bytes.begin(), kMagic, sizeof(kMagic)) == 0)
+    return ReadBinary(bytes, filename);
+  return ReadText(bytes, filename, num_threads);
+}
+
+}  // namespace gtdynamics
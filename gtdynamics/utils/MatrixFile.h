@@ -0,0 +1,48 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  MatrixFile.h
+ * @brief Fast loading of matrices from binary and whitespace-text files.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+
+#include <string>
+
+namespace gtdynamics {
+
+/**
+ * Write a matrix in the binary matrix format read by ReadMatrixFile: a 24
+ * byte header, char[8] "GTDMAT", uint64 #rows, uint64 #cols, followed by
+ * the entries as doubles in column-major order, in host byte order.
+ * @throws std::runtime_error if the file cannot be written
+ */
+void WriteMatrixFile(const std::string &filename, const gtsam::Matrix &matrix);
+
+/**
+ * Load a matrix, e.g. a reference trajectory or a calibration table, from a
+ * file written by WriteMatrixFile or from text with one row per line and
+ * entries separated by whitespace; empty lines and lines starting with '#'
+ * are skipped.
+ *
+ * The file is memory-mapped. Binary entries are copied once into the
+ * result; text lines are parsed in parallel on the shared TaskExecutor,
+ * straight into the result.
+ *
+ * @param filename     path of the file
+ * @param num_threads  threads parsing text, 0 for all of the shared executor
+ * @throws std::runtime_error if the file cannot be read, and
+ * std::invalid_argument if it is truncated, rows differ in length, or an
+ * entry is not a number
+ */
+gtsam::Matrix ReadMatrixFile(const std::string &filename,
+                             size_t num_threads = 0);
+
+}  // namespace gtdynamics
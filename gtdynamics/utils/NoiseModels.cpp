@@ -0,0 +1,44 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModels.cpp
+ * @brief Shared instances of the noise models used by the graph builders.
+ */
+
+#include "gtdynamics/utils/NoiseModels.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace gtdynamics {
+
+using gtsam::noiseModel::Constrained;
+using gtsam::noiseModel::Isotropic;
+
+/* ************************************************************************* */
+Constrained::shared_ptr ConstrainedAll(size_t dim) {
+  static std::mutex mutex;
+  static std::map<size_t, Constrained::shared_ptr> models;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &model = models[dim];
+  if (!model) model = Constrained::All(dim);
+  return model;
+}
+
+/* ************************************************************************* */
+Isotropic::shared_ptr IsotropicSigma(size_t dim, double sigma) {
+  static std::mutex mutex;
+  static std::map<std::pair<size_t, double>, Isotropic::shared_ptr> models;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto &model = models[std::make_pair(dim, sigma)];
+  if (!model) model = Isotropic::Sigma(dim, sigma);
+  return model;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,35 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  NoiseModels.h
+ * @brief Shared instances of the noise models used by the graph builders.
+ */
+
+#pragma once
+
+#include <gtsam/linear/NoiseModel.h>
+
+namespace gtdynamics {
+
+/**
+ * Constrained noise model of dimension `dim`, with all rows constrained. The
+ * same instance is returned for every call with the same dimension, so that
+ * linear graphs built at every simulation step do not allocate it anew.
+ */
+gtsam::noiseModel::Constrained::shared_ptr ConstrainedAll(size_t dim);
+
+/**
+ * Isotropic noise model of dimension `dim` and standard deviation `sigma`,
+ * interned: calls with the same arguments return the same instance, so that
+ * the factors of all graph builders share their models. Noise models are not
+ * modified after construction, which makes sharing them safe.
+ */
+gtsam::noiseModel::Isotropic::shared_ptr IsotropicSigma(size_t dim,
+                                                        double sigma);
+
+}  // namespace gtdynamics
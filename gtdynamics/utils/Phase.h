@@ -37,6 +37,12 @@ class Phase : public Interval {
         const boost::shared_ptr<ConstraintSpec> &constraint_spec)
       : Interval(k_start, k_end), constraint_spec_(constraint_spec) {}
 
+  /// Return a phase with the same constraints over `num_steps` time steps
+  /// from k_start, e.g. to solve the trajectory at another resolution.
+  Phase resampled(size_t k_start, size_t num_steps) const {
+    return Phase(k_start, k_start + num_steps, constraint_spec_);
+  }
+
   ///Return Constraint Spec pointer
   const boost::shared_ptr<const ConstraintSpec> constraintSpec() const {
     return constraint_spec_;
@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SensorRingBuffer.h
+ * @brief Bounded lock-free queue from one sensor thread to many consumers.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * Fixed-capacity ring buffer with one producer, e.g. the thread reading a
+ * sensor, and any number of consumers, e.g. smoothing threads building
+ * factors. Neither side ever locks or allocates: every cell carries a
+ * sequence number, as in Vyukov's bounded queue, telling whether it holds a
+ * sample for the consumer at that position or is free for the producer, and
+ * consumers claim positions with a compare-and-swap. When the buffer is full
+ * push fails and the sample is counted as dropped, so a slow consumer never
+ * stalls the sensor thread.
+ *
+ * T needs to be default-constructible and movable.
+ */
+template <typename T>
+class SensorRingBuffer {
+ public:
+  /// Constructor, the capacity is rounded up to a power of 2.
+  explicit SensorRingBuffer(size_t capacity) {
+    if (capacity == 0)
+      throw std::invalid_argument(
+          "SensorRingBuffer: capacity should be positive.");
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    mask_ = size - 1;
+    cells_.reset(new Cell[size]);
+    for (size_t i = 0; i < size; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  SensorRingBuffer(const SensorRingBuffer &) = delete;
+  SensorRingBuffer &operator=(const SensorRingBuffer &) = delete;
+
+  /// Number of cells.
+  size_t capacity() const { return mask_ + 1; }
+
+  /// Append a sample, from the producer thread only. Returns false, and
+  /// counts the sample as dropped, if the buffer is full.
+  bool push(T sample) {
+    const size_t position = tail_.load(std::memory_order_relaxed);
+    Cell &cell = cells_[position & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != position) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    cell.value = std::move(sample);
+    cell.sequence.store(position + 1, std::memory_order_release);
+    tail_.store(position + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /// Take the oldest sample, from any thread. Returns false if empty.
+  bool pop(T *sample) {
+    size_t position = head_.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell &cell = cells_[position & mask_];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t difference =
+          std::ptrdiff_t(sequence) - std::ptrdiff_t(position + 1);
+      if (difference == 0) {
+        if (head_.compare_exchange_weak(position, position + 1,
+                                        std::memory_order_relaxed)) {
+          *sample = std::move(cell.value);
+          cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /// Append up to `max_samples` samples to `samples`, from any thread, and
+  /// return their number.
+  size_t popBatch(std::vector<T> *samples, size_t max_samples = SIZE_MAX) {
+    size_t n = 0;
+    T sample;
+    while (n < max_samples && pop(&sample)) {
+      samples->push_back(std::move(sample));
+      ++n;
+    }
+    return n;
+  }
+
+  /// Number of samples waiting, exact only when no thread is pushing or
+  /// popping.
+  size_t sizeApprox() const {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t head = head_.load(std::memory_order_relaxed);
+    return tail > head ? tail - head : 0;
+  }
+
+  /// Samples refused by push because the buffer was full.
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_ = 0;
+  // Producer and consumer positions on separate cache lines.
+  char pad0_[kCacheLine];
+  std::atomic<size_t> tail_{0};
+  char pad1_[kCacheLine];
+  std::atomic<size_t> head_{0};
+  char pad2_[kCacheLine];
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,225 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SignedDistanceField.cpp
+ * @brief Voxel signed distance fields of the environment, and sphere
+ * approximations of link geometry, for collision avoidance.
+ */
+
+#include "gtdynamics/utils/SignedDistanceField.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "gtdynamics/utils/MappedFile.h"
+
+namespace gtdynamics {
+
+using gtsam::Point3;
+
+namespace {
+// Voxel i of grid coordinate u along an axis of n voxels, clamped to
+// [0, n - 1], the fraction t within it, and du/dx, zero where clamped.
+struct Voxel {
+  size_t i;
+  double t, scale;
+};
+
+Voxel Locate(double u, size_t n, double resolution) {
+  double scale = 1.0 / resolution;
+  if (u <= 0) {
+    u = 0;
+    scale = 0;
+  } else if (u >= n - 1) {
+    u = n - 1;
+    scale = 0;
+  }
+  const size_t i = std::min(size_t(u), n - 2);
+  return {i, u - i, scale};
+}
+
+// Shared copy of n distances.
+std::shared_ptr<const double> Copy(const std::vector<double> &distances,
+                                   size_t n) {
+  if (distances.size() != n)
+    throw std::invalid_argument(
+        "SignedDistanceField: expected nx * ny * nz distances.");
+  const auto copy = std::make_shared<const std::vector<double>>(distances);
+  return std::shared_ptr<const double>(copy, copy->data());
+}
+
+// Vertices of a binary STL file: an 80 byte header, a 32 bit triangle count
+// and 50 bytes per triangle, of which the 12 floats are the normal and the
+// three vertices.
+bool ReadBinaryStl(const std::string &bytes, std::vector<Point3> *vertices) {
+  if (bytes.size() < 84) return false;
+  uint32_t count;
+  std::memcpy(&count, bytes.data() + 80, sizeof(count));
+  if (bytes.size() != 84 + 50 * size_t(count)) return false;
+  for (size_t f = 0; f < count; f++) {
+    float values[12];
+    std::memcpy(values, bytes.data() + 84 + 50 * f, sizeof(values));
+    for (int v = 1; v < 4; v++)
+      vertices->emplace_back(values[3 * v], values[3 * v + 1],
+                             values[3 * v + 2]);
+  }
+  return true;
+}
+
+// Vertices of lines "<tag> x y z" of a text mesh file.
+void ReadTextVertices(const std::string &text, const std::string &tag,
+                      std::vector<Point3> *vertices) {
+  std::istringstream lines(text);
+  std::string line, word;
+  while (std::getline(lines, line)) {
+    std::istringstream words(line);
+    double x, y, z;
+    if (words >> word && word == tag && words >> x >> y >> z)
+      vertices->emplace_back(x, y, z);
+  }
+}
+
+// Cover points [begin, end) by at most n spheres.
+void Cover(std::vector<Point3>::iterator begin,
+           std::vector<Point3>::iterator end, size_t n,
+           CollisionSpheres *spheres) {
+  const size_t size = end - begin;
+  if (n > 1 && size > 1) {
+    Point3 lower = *begin, upper = *begin;
+    for (auto it = begin; it != end; ++it) {
+      lower = lower.cwiseMin(*it);
+      upper = upper.cwiseMax(*it);
+    }
+    int axis;
+    (upper - lower).maxCoeff(&axis);
+    const auto middle = begin + size / 2;
+    std::nth_element(begin, middle, end, [axis](const Point3 &a,
+                                                const Point3 &b) {
+      return a[axis] < b[axis];
+    });
+    Cover(begin, middle, n / 2, spheres);
+    Cover(middle, end, n - n / 2, spheres);
+    return;
+  }
+  Point3 center = Point3::Zero();
+  for (auto it = begin; it != end; ++it) center += *it;
+  center /= size;
+  double radius = 0;
+  for (auto it = begin; it != end; ++it)
+    radius = std::max(radius, (*it - center).norm());
+  spheres->push_back({center, radius});
+}
+}  // namespace
+
+/* ************************************************************************* */
+SignedDistanceField::SignedDistanceField(
+    size_t nx, size_t ny, size_t nz, const Point3 &origin, double resolution,
+    const std::shared_ptr<const double> &data)
+    : nx_(nx),
+      ny_(ny),
+      nz_(nz),
+      origin_(origin),
+      resolution_(resolution),
+      data_(data) {
+  if (nx < 2 || ny < 2 || nz < 2 || !(resolution > 0))
+    throw std::invalid_argument(
+        "SignedDistanceField: needs at least 2 x 2 x 2 voxels and a positive "
+        "resolution.");
+}
+
+/* ************************************************************************* */
+SignedDistanceField::SignedDistanceField(size_t nx, size_t ny, size_t nz,
+                                         const Point3 &origin,
+                                         double resolution,
+                                         const std::vector<double> &distances)
+    : SignedDistanceField(nx, ny, nz, origin, resolution,
+                          Copy(distances, nx * ny * nz)) {}
+
+/* ************************************************************************* */
+SignedDistanceField SignedDistanceField::MemoryMapped(
+    const std::string &path, size_t nx, size_t ny, size_t nz,
+    const Point3 &origin, double resolution) {
+  const std::shared_ptr<const double> data = MapDoubles(path, nx * ny * nz);
+  return SignedDistanceField(nx, ny, nz, origin, resolution, data);
+}
+
+/* ************************************************************************* */
+double SignedDistanceField::distance(const Point3 &point,
+                                     gtsam::OptionalJacobian<1, 3> H) const {
+  const Point3 u = (point - origin_) / resolution_;
+  const Voxel v[3] = {Locate(u.x(), nx_, resolution_),
+                      Locate(u.y(), ny_, resolution_),
+                      Locate(u.z(), nz_, resolution_)};
+
+  // Sum over the 8 corners of the voxel, with the derivatives of the
+  // trilinear weights along each axis.
+  double d = 0, dd[3] = {0, 0, 0};
+  for (int c = 0; c < 8; c++) {
+    const int b[3] = {c & 1, (c >> 1) & 1, (c >> 2) & 1};
+    double w[3], dw[3];
+    for (int a = 0; a < 3; a++) {
+      w[a] = b[a] ? v[a].t : 1 - v[a].t;
+      dw[a] = b[a] ? 1 : -1;
+    }
+    const double sample = at(v[0].i + b[0], v[1].i + b[1], v[2].i + b[2]);
+    d += w[0] * w[1] * w[2] * sample;
+    dd[0] += dw[0] * w[1] * w[2] * sample;
+    dd[1] += w[0] * dw[1] * w[2] * sample;
+    dd[2] += w[0] * w[1] * dw[2] * sample;
+  }
+  if (H) *H << dd[0] * v[0].scale, dd[1] * v[1].scale, dd[2] * v[2].scale;
+  return d;
+}
+
+/* ************************************************************************* */
+std::vector<Point3> ReadMeshVertices(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) throw std::runtime_error("ReadMeshVertices: cannot open " + path);
+  const std::string bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+
+  std::vector<Point3> vertices;
+  const std::string extension =
+      path.size() >= 4 ? path.substr(path.size() - 4) : "";
+  if (extension == ".obj" || extension == ".OBJ")
+    ReadTextVertices(bytes, "v", &vertices);
+  else if (!ReadBinaryStl(bytes, &vertices))
+    ReadTextVertices(bytes, "vertex", &vertices);
+  if (vertices.empty())
+    throw std::runtime_error("ReadMeshVertices: no vertices in " + path);
+  return vertices;
+}
+
+/* ************************************************************************* */
+CollisionSpheres BoundingSpheres(const std::vector<Point3> &points,
+                                 size_t max_spheres) {
+  if (points.empty() || max_spheres == 0)
+    throw std::invalid_argument(
+        "BoundingSpheres: needs points and at least one sphere.");
+  std::vector<Point3> sorted = points;
+  CollisionSpheres spheres;
+  Cover(sorted.begin(), sorted.end(), max_spheres, &spheres);
+  return spheres;
+}
+
+/* ************************************************************************* */
+CollisionSpheres TransformSpheres(const gtsam::Pose3 &comTmesh,
+                                  const CollisionSpheres &spheres) {
+  CollisionSpheres transformed;
+  for (const CollisionSphere &sphere : spheres)
+    transformed.push_back(
+        {comTmesh.transformFrom(sphere.center), sphere.radius});
+  return transformed;
+}
+
+}  // namespace gtdynamics
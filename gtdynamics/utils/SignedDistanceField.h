@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  SignedDistanceField.h
+ * @brief Voxel signed distance fields of the environment, and sphere
+ * approximations of link geometry, for collision avoidance.
+ */
+
+#pragma once
+
+#include <gtsam/base/OptionalJacobian.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/**
+ * SignedDistanceField is the distance to the nearest obstacle, negative
+ * inside obstacles, sampled on a regular voxel grid and interpolated
+ * trilinearly. Lookups index the grid directly and take constant time;
+ * outside the grid the distance at its border is extended, with zero
+ * gradient. The distances can live in a memory-mapped file, so large maps
+ * are paged in on demand and shared between processes. Copies share the
+ * distances.
+ */
+class SignedDistanceField {
+ public:
+  /**
+   * Construct from distances in memory.
+   * @param nx, ny, nz   grid size, at least 2 in each direction
+   * @param origin       position of voxel (0, 0, 0)
+   * @param resolution   distance between voxels
+   * @param distances    nx * ny * nz distances, x fastest; voxel (i, j, k) is
+   *                     at origin + resolution * (i, j, k)
+   */
+  SignedDistanceField(size_t nx, size_t ny, size_t nz,
+                      const gtsam::Point3 &origin, double resolution,
+                      const std::vector<double> &distances);
+
+  /**
+   * Map a file of nx * ny * nz native doubles, laid out as `distances` in
+   * the constructor, into memory.
+   */
+  static SignedDistanceField MemoryMapped(const std::string &path, size_t nx,
+                                          size_t ny, size_t nz,
+                                          const gtsam::Point3 &origin,
+                                          double resolution);
+
+  /**
+   * Signed distance at a point.
+   * @param H  optional gradient of the distance
+   */
+  double distance(const gtsam::Point3 &point,
+                  gtsam::OptionalJacobian<1, 3> H = boost::none) const;
+
+  /// Distance of voxel (i, j, k).
+  double at(size_t i, size_t j, size_t k) const {
+    return data_.get()[(k * ny_ + j) * nx_ + i];
+  }
+
+ private:
+  SignedDistanceField(size_t nx, size_t ny, size_t nz,
+                      const gtsam::Point3 &origin, double resolution,
+                      const std::shared_ptr<const double> &data);
+
+  size_t nx_, ny_, nz_;
+  gtsam::Point3 origin_;
+  double resolution_;
+  std::shared_ptr<const double> data_;
+};
+
+/// A sphere of link geometry, in the frame of its link's COM.
+struct CollisionSphere {
+  gtsam::Point3 center;
+  double radius;
+};
+
+using CollisionSpheres = std::vector<CollisionSphere>;
+
+/**
+ * Read the vertices of a mesh, e.g. those in models/sdfs/meshes.
+ * @param path  binary or ASCII .stl, or .obj file
+ * @throws std::runtime_error if the file cannot be read
+ */
+std::vector<gtsam::Point3> ReadMeshVertices(const std::string &path);
+
+/**
+ * Approximate a point set by at most max_spheres spheres that together
+ * cover it: the points are split recursively at the median of their longest
+ * axis, and each part is covered by a sphere around its centroid.
+ */
+CollisionSpheres BoundingSpheres(const std::vector<gtsam::Point3> &points,
+                                 size_t max_spheres);
+
+/**
+ * Express spheres in another frame, e.g. spheres of a mesh in the COM frame
+ * of its link with comTmesh = link->bMcom().inverse() * link->bMlink() *
+ * linkTmesh.
+ */
+CollisionSpheres TransformSpheres(const gtsam::Pose3 &comTmesh,
+                                  const CollisionSpheres &spheres);
+
+}  // namespace gtdynamics
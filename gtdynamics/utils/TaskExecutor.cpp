@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TaskExecutor.cpp
+ * @brief The worker threads shared by all parallel loops of the library.
+ */
+
+#include "gtdynamics/utils/TaskExecutor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace gtdynamics {
+
+namespace {
+std::mutex shared_mutex;
+std::shared_ptr<TaskExecutor> shared_executor;
+}  // namespace
+
+// A loop in progress, on the stack of its caller.
+struct TaskExecutor::Loop {
+  Loop(const Job &job, size_t n, size_t num_slots, bool deterministic)
+      : job(job), n(n), num_slots(num_slots), deterministic(deterministic) {}
+
+  const Job &job;
+  const size_t n, num_slots;
+  const bool deterministic;
+  std::atomic<size_t> next{0};       // next index, if not deterministic
+  std::atomic<size_t> next_slot{0};  // next slot for a helper
+  std::atomic<bool> stop{false};     // after an exception
+  size_t running = 0;                // helpers, guarded by mutex_
+  std::exception_ptr error;          // guarded by mutex_
+  std::condition_variable done_cv;
+};
+
+/* ************************************************************************* */
+TaskExecutor::TaskExecutor(const TaskExecutorParameters &parameters)
+    : p_(parameters) {
+  for (int cpu : p_.cpus)
+    if (cpu < 0)
+      throw std::invalid_argument(
+          "TaskExecutor: core numbers should be nonnegative.");
+  size_t num_threads = p_.num_threads;
+  if (num_threads == 0)
+    num_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+  for (size_t w = 0; w + 1 < num_threads; ++w)
+    workers_.emplace_back(&TaskExecutor::workerLoop, this, w);
+}
+
+/* ************************************************************************* */
+TaskExecutor::~TaskExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto &&worker : workers_) worker.join();
+}
+
+/* ************************************************************************* */
+std::shared_ptr<TaskExecutor> TaskExecutor::Shared() {
+  std::lock_guard<std::mutex> lock(shared_mutex);
+  if (!shared_executor) shared_executor = std::make_shared<TaskExecutor>();
+  return shared_executor;
+}
+
+/* ************************************************************************* */
+void TaskExecutor::ConfigureShared(const TaskExecutorParameters &parameters) {
+  auto executor = std::make_shared<TaskExecutor>(parameters);
+  std::lock_guard<std::mutex> lock(shared_mutex);
+  shared_executor.swap(executor);
+}
+
+/* ************************************************************************* */
+void TaskExecutor::pin(size_t worker) const {
+#ifdef __linux__
+  if (p_.cpus.empty()) return;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(p_.cpus[worker % p_.cpus.size()], &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+/* ************************************************************************* */
+void TaskExecutor::runSlot(Loop *loop, size_t slot) {
+  try {
+    if (loop->deterministic) {
+      const size_t begin = slot * loop->n / loop->num_slots,
+                   end = (slot + 1) * loop->n / loop->num_slots;
+      for (size_t i = begin; i < end && !loop->stop; ++i) loop->job(i, slot);
+    } else {
+      for (size_t i = loop->next++; i < loop->n; i = loop->next++)
+        loop->job(i, slot);
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!loop->error) loop->error = std::current_exception();
+    loop->stop = true;
+    loop->next = loop->n;  // stop handing out work
+  }
+}
+
+/* ************************************************************************* */
+void TaskExecutor::workerLoop(size_t worker) {
+  pin(worker);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    start_cv_.wait(lock, [&] { return stop_ || !loops_.empty(); });
+    if (stop_) return;
+
+    // Join the most recent loop, likely nested in an older one, or retire
+    // it when it has no work left for helpers.
+    Loop *loop = loops_.back();
+    const size_t slot = loop->next_slot++;
+    if (slot + 1 >= loop->num_slots ||
+        (!loop->deterministic && loop->next >= loop->n)) {
+      loops_.pop_back();
+      continue;
+    }
+    ++loop->running;
+    lock.unlock();
+    runSlot(loop, slot);
+    lock.lock();
+    if (--loop->running == 0) loop->done_cv.notify_all();
+  }
+}
+
+/* ************************************************************************* */
+void TaskExecutor::parallelFor(size_t n, size_t num_slots, const Job &job) {
+  if (n == 0) return;
+  num_slots = std::max<size_t>(num_slots, 1);
+  const size_t caller = num_slots - 1;
+  if (workers_.empty() || num_slots == 1 || n == 1) {
+    if (p_.deterministic) {
+      Loop loop(job, n, num_slots, true);
+      for (size_t slot = 0; slot < num_slots; ++slot) runSlot(&loop, slot);
+      if (loop.error) std::rethrow_exception(loop.error);
+    } else {
+      for (size_t i = 0; i < n; ++i) job(i, caller);
+    }
+    return;
+  }
+
+  Loop loop(job, n, num_slots, p_.deterministic);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    loops_.push_back(&loop);
+  }
+  start_cv_.notify_all();
+  runSlot(&loop, caller);
+
+  // Deterministically, the caller also runs the slots no helper took.
+  if (loop.deterministic)
+    for (size_t slot = loop.next_slot++; slot < caller;
+         slot = loop.next_slot++)
+      runSlot(&loop, slot);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = std::find(loops_.begin(), loops_.end(), &loop);
+    if (it != loops_.end()) loops_.erase(it);
+    loop.done_cv.wait(lock, [&] { return loop.running == 0; });
+    error = loop.error;
+  }
+  if (error) std::rethrow_exception(error);
+}
+
+}  // namespace gtdynamics
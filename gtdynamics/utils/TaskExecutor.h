@@ -0,0 +1,114 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TaskExecutor.h
+ * @brief The worker threads shared by all parallel loops of the library.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Parameters of a TaskExecutor.
+struct TaskExecutorParameters {
+  /// Number of threads, including one calling thread. Zero means
+  /// std::thread::hardware_concurrency().
+  size_t num_threads = 0;
+
+  /// Cores to pin the workers to, worker w on cpus[w % cpus.size()]; empty
+  /// to leave them to the scheduler. Only honored on Linux.
+  std::vector<int> cpus;
+
+  /// Whether each loop index is always run with the same worker index, for
+  /// reproducible per-worker reductions, see TaskExecutor.
+  bool deterministic = false;
+};
+
+/**
+ * TaskExecutor owns the worker threads that run parallel for-loops, so that
+ * the parallel paths of the library (batched simulation, graph building,
+ * linearization, constraint evaluation, multi-start and batch solves) share
+ * one set of threads instead of oversubscribing the cores with a pool each.
+ * They use it through ThreadPool handles, each with its own number of
+ * worker slots.
+ *
+ * A loop is run by its calling thread and by the idle workers that join it,
+ * at most one per slot, the most recent loop first. Loops can run from many
+ * threads at once, and a job can start a loop itself: its caller works on
+ * it while the idle workers help, so nested loops do not deadlock.
+ *
+ * By default indices are handed out one at a time from a shared counter, so
+ * uneven iterations balance out, and the worker index passed to a job
+ * depends on timing. In deterministic mode slot w runs the w-th contiguous
+ * block of indices with worker index w, whoever runs it and whatever the
+ * number of threads, so per-worker scratch and reductions give the same
+ * result on every run.
+ */
+class TaskExecutor {
+ public:
+  /// Job signature: called with the loop index and the worker index.
+  using Job = std::function<void(size_t index, size_t worker)>;
+
+  explicit TaskExecutor(
+      const TaskExecutorParameters &parameters = TaskExecutorParameters());
+
+  ~TaskExecutor();
+
+  TaskExecutor(const TaskExecutor &) = delete;
+  TaskExecutor &operator=(const TaskExecutor &) = delete;
+
+  /// The executor of the library, created on first use with the default
+  /// parameters unless configured before.
+  static std::shared_ptr<TaskExecutor> Shared();
+
+  /**
+   * Replace the executor of the library, e.g. at start-up to set the thread
+   * count, affinity or deterministic mode. Loops already running finish on
+   * the previous executor.
+   */
+  static void ConfigureShared(const TaskExecutorParameters &parameters);
+
+  /// Number of threads working on a loop, including the caller.
+  size_t numThreads() const { return workers_.size() + 1; }
+
+  /// Whether indices are assigned to workers deterministically.
+  bool deterministic() const { return p_.deterministic; }
+
+  /**
+   * Call job(i, worker) for all i in [0, n), with at most num_slots threads,
+   * and wait for completion. `worker` is in [0, num_slots), the caller's is
+   * num_slots - 1, and no two threads run with the same worker index at the
+   * same time; deterministically, the caller also runs the slots no worker
+   * joined. The first exception thrown by a job is rethrown here.
+   */
+  void parallelFor(size_t n, size_t num_slots, const Job &job);
+
+ private:
+  struct Loop;
+
+  void workerLoop(size_t worker);
+  void runSlot(Loop *loop, size_t slot);
+  void pin(size_t worker) const;
+
+  TaskExecutorParameters p_;
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::vector<Loop *> loops_;  // running loops with free slots
+  bool stop_ = false;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Terrain.cpp
+ * @brief Terrain models for contact factors: heights over the ground plane.
+ */
+
+#include "gtdynamics/utils/Terrain.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "gtdynamics/utils/MappedFile.h"
+
+namespace gtdynamics {
+
+namespace {
+// Position of a grid coordinate u along an axis of n samples: the cell i of
+// u clamped to [0, n - 1], the fraction t within it, and du/dx, which is
+// zero where u is clamped.
+struct Cell {
+  size_t i;
+  double t, scale;
+};
+
+Cell Locate(double u, size_t n, double resolution) {
+  double scale = 1.0 / resolution;
+  if (u <= 0) {
+    u = 0;
+    scale = 0;
+  } else if (u >= n - 1) {
+    u = n - 1;
+    scale = 0;
+  }
+  const size_t i = std::min(size_t(u), n - 2);
+  return {i, u - i, scale};
+}
+
+// Catmull-Rom weights of the samples i - 1, ..., i + 2 at fraction t, and
+// their derivatives.
+void CubicWeights(double t, double w[4], double dw[4]) {
+  const double t2 = t * t, t3 = t2 * t;
+  w[0] = 0.5 * (-t3 + 2 * t2 - t);
+  w[1] = 0.5 * (3 * t3 - 5 * t2 + 2);
+  w[2] = 0.5 * (-3 * t3 + 4 * t2 + t);
+  w[3] = 0.5 * (t3 - t2);
+  dw[0] = 0.5 * (-3 * t2 + 4 * t - 1);
+  dw[1] = 0.5 * (9 * t2 - 10 * t);
+  dw[2] = 0.5 * (-9 * t2 + 8 * t + 1);
+  dw[3] = 0.5 * (3 * t2 - 2 * t);
+}
+
+// Shared copy of n heights.
+std::shared_ptr<const double> Copy(const std::vector<double> &heights,
+                                   size_t n) {
+  if (heights.size() != n)
+    throw std::invalid_argument("HeightMap: expected rows * cols heights.");
+  const auto copy = std::make_shared<const std::vector<double>>(heights);
+  return std::shared_ptr<const double>(copy, copy->data());
+}
+
+// Index i + k - 1 clamped to [0, n - 1].
+size_t Clamped(size_t i, int k, size_t n) {
+  const long j = long(i) + k - 1;
+  return size_t(std::min(std::max(j, 0L), long(n) - 1));
+}
+}  // namespace
+
+/* ************************************************************************* */
+HeightMap::HeightMap(size_t rows, size_t cols, double x0, double y0,
+                     double resolution,
+                     const std::shared_ptr<const double> &data,
+                     Interpolation interpolation)
+    : rows_(rows),
+      cols_(cols),
+      x0_(x0),
+      y0_(y0),
+      resolution_(resolution),
+      data_(data),
+      interpolation_(interpolation) {
+  if (rows < 2 || cols < 2 || !(resolution > 0))
+    throw std::invalid_argument(
+        "HeightMap: needs at least 2 x 2 samples and a positive resolution.");
+}
+
+/* ************************************************************************* */
+HeightMap::HeightMap(size_t rows, size_t cols, double x0, double y0,
+                     double resolution, const std::vector<double> &heights,
+                     Interpolation interpolation)
+    : HeightMap(rows, cols, x0, y0, resolution, Copy(heights, rows * cols),
+                interpolation) {}
+
+/* ************************************************************************* */
+HeightMap HeightMap::MemoryMapped(const std::string &path, size_t rows,
+                                  size_t cols, double x0, double y0,
+                                  double resolution,
+                                  Interpolation interpolation) {
+  const std::shared_ptr<const double> data = MapDoubles(path, rows * cols);
+  return HeightMap(rows, cols, x0, y0, resolution, data, interpolation);
+}
+
+/* ************************************************************************* */
+double HeightMap::height(double x, double y,
+                         gtsam::OptionalJacobian<1, 2> H) const {
+  const Cell cx = Locate((x - x0_) / resolution_, cols_, resolution_);
+  const Cell cy = Locate((y - y0_) / resolution_, rows_, resolution_);
+
+  double h, dh_dtx, dh_dty;
+  if (interpolation_ == Bilinear) {
+    const double h00 = at(cy.i, cx.i), h01 = at(cy.i, cx.i + 1);
+    const double h10 = at(cy.i + 1, cx.i), h11 = at(cy.i + 1, cx.i + 1);
+    h = (1 - cy.t) * ((1 - cx.t) * h00 + cx.t * h01) +
+        cy.t * ((1 - cx.t) * h10 + cx.t * h11);
+    dh_dtx = (1 - cy.t) * (h01 - h00) + cy.t * (h11 - h10);
+    dh_dty = (1 - cx.t) * (h10 - h00) + cx.t * (h11 - h01);
+  } else {
+    double wx[4], dwx[4], wy[4], dwy[4];
+    CubicWeights(cx.t, wx, dwx);
+    CubicWeights(cy.t, wy, dwy);
+    h = dh_dtx = dh_dty = 0;
+    for (int a = 0; a < 4; a++) {
+      const size_t r = Clamped(cy.i, a, rows_);
+      double row = 0, drow = 0;
+      for (int b = 0; b < 4; b++) {
+        const double sample = at(r, Clamped(cx.i, b, cols_));
+        row += wx[b] * sample;
+        drow += dwx[b] * sample;
+      }
+      h += wy[a] * row;
+      dh_dtx += wy[a] * drow;
+      dh_dty += dwy[a] * row;
+    }
+  }
+  if (H) *H << dh_dtx * cx.scale, dh_dty * cy.scale;
+  return h;
+}
+
+}  // namespace gtdynamics
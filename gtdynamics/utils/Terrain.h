@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Terrain.h
+ * @brief Terrain models for contact factors: heights over the ground plane.
+ */
+
+#pragma once
+
+#include <gtsam/base/OptionalJacobian.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gtdynamics {
+
+/// Height of the terrain above the world x-y plane, z up.
+class TerrainModel {
+ public:
+  virtual ~TerrainModel() {}
+
+  /**
+   * Height at (x, y).
+   * @param H  optional gradient [dh/dx, dh/dy]
+   */
+  virtual double height(
+      double x, double y,
+      gtsam::OptionalJacobian<1, 2> H = boost::none) const = 0;
+};
+
+/**
+ * HeightMap is terrain sampled on a regular grid, e.g. from a terrain scan,
+ * interpolated bilinearly or bicubically (Catmull-Rom, so the heights at the
+ * samples are kept). Lookups index the grid directly and take constant time;
+ * outside the grid the height of its border is extended. The heights can
+ * live in a memory-mapped file, so large maps are paged in on demand and
+ * shared between processes. Copies share the heights.
+ */
+class HeightMap : public TerrainModel {
+ public:
+  enum Interpolation { Bilinear, Bicubic };
+
+  /**
+   * Construct from heights in memory.
+   * @param rows, cols     grid size, at least 2 x 2
+   * @param x0, y0         position of sample (0, 0)
+   * @param resolution     distance between samples
+   * @param heights        rows * cols heights, row-major; sample (r, c) is at
+   *                       (x0 + c * resolution, y0 + r * resolution)
+   * @param interpolation  interpolation between samples
+   */
+  HeightMap(size_t rows, size_t cols, double x0, double y0, double resolution,
+            const std::vector<double> &heights,
+            Interpolation interpolation = Bilinear);
+
+  /**
+   * Map a file of rows * cols native doubles, laid out as `heights` in the
+   * constructor, into memory.
+   */
+  static HeightMap MemoryMapped(const std::string &path, size_t rows,
+                                size_t cols, double x0, double y0,
+                                double resolution,
+                                Interpolation interpolation = Bilinear);
+
+  double height(double x, double y,
+                gtsam::OptionalJacobian<1, 2> H = boost::none) const override;
+
+  size_t rows() const { return rows_; }
+  size_t cols() const { return cols_; }
+
+  /// Height of sample (r, c).
+  double at(size_t r, size_t c) const { return data_.get()[r * cols_ + c]; }
+
+ private:
+  HeightMap(size_t rows, size_t cols, double x0, double y0, double resolution,
+            const std::shared_ptr<const double> &data,
+            Interpolation interpolation);
+
+  size_t rows_, cols_;
+  double x0_, y0_, resolution_;
+  std::shared_ptr<const double> data_;
+  Interpolation interpolation_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,29 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ThreadPool.cpp
+ * @brief Data-parallel loops on the threads of the shared TaskExecutor.
+ */
+
+#include "gtdynamics/utils/ThreadPool.h"
+
+namespace gtdynamics {
+
+/* ************************************************************************* */
+ThreadPool::ThreadPool(size_t num_threads)
+    : num_threads_(num_threads ? num_threads
+                               : TaskExecutor::Shared()->numThreads()) {}
+
+/* ************************************************************************* */
+void ThreadPool::parallelFor(size_t n, const Job &job) {
+  // Hold the executor, in case it is reconfigured during the loop.
+  const std::shared_ptr<TaskExecutor> executor = TaskExecutor::Shared();
+  executor->parallelFor(n, num_threads_, job);
+}
+
+}  // namespace gtdynamics
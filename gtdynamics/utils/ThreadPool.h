@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  ThreadPool.h
+ * @brief Data-parallel loops on the threads of the shared TaskExecutor.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "gtdynamics/utils/TaskExecutor.h"
+
+namespace gtdynamics {
+
+/**
+ * ThreadPool runs parallel for-loops with a fixed number of worker slots.
+ * It owns no threads: the loops run on the threads of the library-wide
+ * TaskExecutor::Shared(), so pools of many components do not oversubscribe
+ * the cores, and a pool is cheap to create for a single call. The number of
+ * threads sizes per-worker scratch space; loops use at most that many
+ * threads, fewer if the shared executor has fewer.
+ *
+ * The calling thread participates as the last worker. Jobs may run loops
+ * themselves, on the same pool or another, see TaskExecutor.
+ */
+class ThreadPool {
+ public:
+  /// Job signature: called with the loop index and the worker index.
+  using Job = TaskExecutor::Job;
+
+  /**
+   * Constructor
+   * @param num_threads total number of threads, including the caller. Zero
+   * means as many as the shared executor has.
+   */
+  explicit ThreadPool(size_t num_threads = 0);
+
+  /// Number of threads working on a loop, including the caller.
+  size_t numThreads() const { return num_threads_; }
+
+  /**
+   * Call job(i, worker) for all i in [0, n), and wait for completion.
+   * `worker` is in [0, numThreads()) and can be used to index per-thread
+   * scratch space. The first exception thrown by a job is rethrown here.
+   */
+  void parallelFor(size_t n, const Job &job);
+
+ private:
+  size_t num_threads_;
+};
+
+}  // namespace gtdynamics
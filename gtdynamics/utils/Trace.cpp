@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Trace.cpp
+ * @brief Scoped tracing of hot paths, written as Chrome trace events.
+ */
+
+#include "gtdynamics/utils/Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace gtdynamics {
+
+#ifdef GTDYNAMICS_ENABLE_TRACING
+
+namespace {
+
+struct Event {
+  const char *name;
+  int64_t start, duration;  // microseconds
+};
+
+// Events of one thread. Only its thread appends, so the lock is only
+// contended while the events are cleared or read.
+struct ThreadBuffer {
+  int tid;
+  std::mutex mutex;
+  std::vector<Event> events;
+};
+
+struct Registry {
+  std::atomic<bool> recording{false};
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+};
+
+Registry &GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+ThreadBuffer &GetThreadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    buffer = std::make_shared<ThreadBuffer>();
+    buffer->tid = registry.buffers.size();
+    registry.buffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+int64_t NowMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+namespace internal {
+
+/* ************************************************************************* */
+TraceScope::TraceScope(const char *name)
+    : name_(name),
+      start_(GetRegistry().recording.load(std::memory_order_relaxed)
+                 ? NowMicroseconds()
+                 : -1) {}
+
+/* ************************************************************************* */
+TraceScope::~TraceScope() {
+  if (start_ < 0) return;
+  const int64_t end = NowMicroseconds();
+  ThreadBuffer &buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffer.mutex);
+  buffer.events.push_back({name_, start_, end - start_});
+}
+
+}  // namespace internal
+
+/* ************************************************************************* */
+void Trace::Start() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (auto &&buffer : registry.buffers) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+    buffer->events.clear();
+  }
+  registry.recording = true;
+}
+
+/* ************************************************************************* */
+void Trace::Stop() { GetRegistry().recording = false; }
+
+/* ************************************************************************* */
+bool Trace::Recording() { return GetRegistry().recording; }
+
+/* ************************************************************************* */
+size_t Trace::NumEvents() {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  size_t n = 0;
+  for (auto &&buffer : registry.buffers) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+    n += buffer->events.size();
+  }
+  return n;
+}
+
+/* ************************************************************************* */
+void Trace::Save(std::ostream &os) {
+  Registry &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  os << "{\"traceEvents\": [";
+  bool first = true;
+  for (auto &&buffer : registry.buffers) {
+    std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+    for (auto &&event : buffer->events) {
+      os << (first ? "\n" : ",\n") << "{\"name\": \"" << event.name
+         << "\", \"cat\": \"gtdynamics\", \"ph\": \"X\", \"ts\": "
+         << event.start << ", \"dur\": " << event.duration
+         << ", \"pid\": 0, \"tid\": " << buffer->tid << "}";
+      first = false;
+    }
+  }
+  os << "\n]}\n";
+}
+
+#else
+
+/* ************************************************************************* */
+void Trace::Start() {}
+void Trace::Stop() {}
+bool Trace::Recording() { return false; }
+size_t Trace::NumEvents() { return 0; }
+void Trace::Save(std::ostream &os) { os << "{\"traceEvents\": []}\n"; }
+
+#endif
+
+/* ************************************************************************* */
+void Trace::Save(const std::string &file_path) {
+  std::ofstream file(file_path);
+  if (!file)
+    throw std::runtime_error("Trace::Save: cannot open " + file_path + ".");
+  Save(file);
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  Trace.h
+ * @brief Scoped tracing of hot paths, written as Chrome trace events.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "gtdynamics/config.h"
+
+namespace gtdynamics {
+
+/**
+ * Trace collects the GTD_TRACE_SCOPE events of all threads while recording
+ * is on, and writes them in the Chrome trace event format, which
+ * chrome://tracing and https://ui.perfetto.dev open:
+ *
+ *     Trace::Start();
+ *     ...  // code with GTD_TRACE_SCOPE("name") in it
+ *     Trace::Stop();
+ *     Trace::Save("trace.json");
+ *
+ * Events are only compiled in when configured with GTDYNAMICS_ENABLE_TRACING.
+ * Otherwise GTD_TRACE_SCOPE expands to nothing and Save writes an empty
+ * trace. Compiled in, a scope costs a relaxed atomic load while recording is
+ * off, and two clock reads and an append to a thread-local buffer while on.
+ */
+class Trace {
+ public:
+  /// Whether events are compiled in.
+  static constexpr bool kCompiled =
+#ifdef GTDYNAMICS_ENABLE_TRACING
+      true;
+#else
+      false;
+#endif
+
+  /// Start recording, discarding the events recorded before.
+  static void Start();
+
+  /// Stop recording; the recorded events are kept until the next Start.
+  static void Stop();
+
+  /// Whether recording is on.
+  static bool Recording();
+
+  /// Number of recorded events.
+  static size_t NumEvents();
+
+  /// Write the recorded events as a Chrome trace JSON document.
+  static void Save(std::ostream &os);
+
+  /// Write the recorded events to a file, see above.
+  static void Save(const std::string &file_path);
+};
+
+#ifdef GTDYNAMICS_ENABLE_TRACING
+
+namespace internal {
+
+/// Records one complete event from construction to destruction.
+class TraceScope {
+ public:
+  /// `name` has to outlive the trace, e.g. be a string literal.
+  explicit TraceScope(const char *name);
+  ~TraceScope();
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+ private:
+  const char *name_;
+  int64_t start_;  // microseconds, negative if not recording
+};
+
+}  // namespace internal
+
+#define GTD_TRACE_CONCAT_(a, b) a##b
+#define GTD_TRACE_CONCAT(a, b) GTD_TRACE_CONCAT_(a, b)
+
+/// Record the enclosing scope as an event called `name`, a string literal.
+#define GTD_TRACE_SCOPE(name)                                  \
+  ::gtdynamics::internal::TraceScope GTD_TRACE_CONCAT(gtd_trace_scope_, \
+                                                      __LINE__)(name)
+
+#else
+
+#define GTD_TRACE_SCOPE(name) static_cast<void>(0)
+
+#endif
+
+}  // namespace gtdynamics
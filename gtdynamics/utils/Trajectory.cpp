@@ -14,18 +14,27 @@
 
 #include <gtdynamics/factors/ObjectiveFactors.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ThreadPool.h>
 #include <gtdynamics/utils/Trajectory.h>
+#include <gtdynamics/utils/TrajectoryFile.h>
 #include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/expressions.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/expressions.h>
 
 #include <algorithm>
 #include <boost/algorithm/string/join.hpp>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
 
 using gtsam::NonlinearFactorGraph;
 using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Pose3_;
 using gtsam::SharedNoiseModel;
 using gtsam::Values;
 using gtsam::Z_6x1;
@@ -36,52 +45,79 @@ using std::vector;
 
 namespace gtdynamics {
 
+void Trajectory::cacheQueries() {
+  const WalkCycle walk_cycle(phases_);
+  phase_contact_points_ = walk_cycle.allPhasesContactPoints();
+  transition_contact_points_.clear();
+  if (!phases_.empty())
+    transition_contact_points_ = walk_cycle.transitionContactPoints();
+
+  final_timesteps_.clear();
+  int final_timestep = 0;
+  for (auto &&phase : phases_) {
+    final_timestep += phase.numTimeSteps();
+    final_timesteps_.push_back(final_timestep);
+  }
+}
+
 vector<NonlinearFactorGraph> Trajectory::getTransitionGraphs(
     const Robot &robot, const DynamicsGraph &graph_builder, double mu) const {
   vector<NonlinearFactorGraph> transition_graphs;
-  const vector<int> final_timesteps = finalTimeSteps();
-  const vector<PointOnLinks> trans_cps = transitionContactPoints();
+  const vector<int> &final_timesteps = finalTimeSteps();
+  const vector<PointOnLinks> &trans_cps = transitionContactPoints();
+
+  // Transitions with the same contact points share a slice.
+  vector<size_t> slice_of_transition;
+  const vector<DynamicsSlice> slices = graph_builder.dynamicsSlices(
+      robot, trans_cps, mu, &slice_of_transition);
   for (int p = 1; p < numPhases(); p++) {
-    transition_graphs.push_back(graph_builder.dynamicsFactorGraph(
-        robot, final_timesteps[p - 1], trans_cps[p - 1], mu));
+    transition_graphs.push_back(slices[slice_of_transition[p - 1]].instantiate(
+        final_timesteps[p - 1]));
   }
   return transition_graphs;
 }
 
 NonlinearFactorGraph Trajectory::multiPhaseFactorGraph(
     const Robot &robot, const DynamicsGraph &graph_builder,
-    const CollocationScheme collocation, double mu) const {
+    const CollocationScheme collocation, double mu, ThreadPool *pool) const {
   // Graphs for transition between phases + their initial values.
   auto transition_graphs = getTransitionGraphs(robot, graph_builder, mu);
-  return graph_builder.multiPhaseTrajectoryFG(robot, phaseDurations(),
-                                              transition_graphs, collocation,
-                                              phaseContactPoints(), mu);
+  return graph_builder.multiPhaseTrajectoryFG(
+      robot, phaseDurations(), transition_graphs, collocation,
+      phaseContactPoints(), mu, pool);
 }
 
 vector<Values> Trajectory::transitionPhaseInitialValues(
-    const Robot &robot, double gaussian_noise) const {
-  vector<PointOnLinks> trans_cps = transitionContactPoints();
-  vector<Values> transition_graph_init;
-  vector<int> final_timesteps = finalTimeSteps();
-  for (int p = 1; p < numPhases(); p++) {
-    transition_graph_init.push_back(ZeroValues(
-        robot, final_timesteps[p - 1], gaussian_noise, trans_cps[p - 1]));
+    const Robot &robot, double gaussian_noise, ThreadPool *pool) const {
+  const vector<PointOnLinks> &trans_cps = transitionContactPoints();
+  const vector<int> &final_timesteps = finalTimeSteps();
+  const size_t num_transitions = trans_cps.size();
+  vector<Values> transition_graph_init(num_transitions);
+  const auto build = [&](size_t p, size_t /*worker*/) {
+    transition_graph_init[p] = ZeroValues(robot, final_timesteps[p],
+                                          gaussian_noise, trans_cps[p]);
+  };
+  if (pool) {
+    pool->parallelFor(num_transitions, build);
+  } else {
+    for (size_t p = 0; p < num_transitions; p++) build(p, 0);
   }
   return transition_graph_init;
 }
 
 Values Trajectory::multiPhaseInitialValues(const Robot &robot,
-                                           double gaussian_noise,
-                                           double dt) const {
+                                           double gaussian_noise, double dt,
+                                           ThreadPool *pool) const {
   vector<Values> transition_graph_init =
-      transitionPhaseInitialValues(robot, gaussian_noise);
-  return MultiPhaseZeroValuesTrajectory(robot, phaseDurations(),
-                                        transition_graph_init, dt,
-                                        gaussian_noise, phaseContactPoints());
+      transitionPhaseInitialValues(robot, gaussian_noise, pool);
+  return MultiPhaseZeroValuesTrajectory(
+      robot, phaseDurations(), transition_graph_init, dt, gaussian_noise,
+      phaseContactPoints(), pool);
 }
 
 NonlinearFactorGraph Trajectory::contactPointObjectives(
-    const Robot &robot, const SharedNoiseModel &cost_model, const Point3 &step, double ground_height) const {
+    const Robot &robot, const SharedNoiseModel &cost_model, const Point3 &step,
+    double ground_height, ThreadPool *pool) const {
   NonlinearFactorGraph factors;
 
   // Create a walk cycle using all phases of trajectory
@@ -91,7 +127,8 @@ NonlinearFactorGraph Trajectory::contactPointObjectives(
   ContactPointGoals cp_goals = walk_cycle.initContactPointGoal(robot, ground_height);
 
   size_t k_start = 0;
-  factors = walk_cycle.contactPointObjectives(step, cost_model, k_start, &cp_goals);
+  factors = walk_cycle.contactPointObjectives(step, cost_model, k_start,
+                                              &cp_goals, pool);
 
   return factors;
 }
@@ -125,6 +162,90 @@ void Trajectory::addBoundaryConditions(
                                     joint_acceleration_model, K));
 }
 
+void Trajectory::addPeriodicBoundaryConditions(
+    gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+    const SharedNoiseModel &rotation_model,
+    const SharedNoiseModel &twist_model,
+    const SharedNoiseModel &joint_angle_model,
+    const SharedNoiseModel &joint_velocity_model,
+    const SharedNoiseModel &joint_acceleration_model) const {
+  int K = getEndTimeStep(numPhases() - 1);
+
+  // Links turn and move alike at both ends, wherever they are.
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    const gtsam::Rot3_ R_0 = gtsam::rotation(Pose3_(internal::PoseKey(i, 0)));
+    const gtsam::Rot3_ R_K = gtsam::rotation(Pose3_(internal::PoseKey(i, K)));
+    graph->emplace_shared<gtsam::ExpressionFactor<gtsam::Vector3>>(
+        rotation_model, gtsam::Z_3x1, gtsam::logmap(R_0, R_K));
+    graph->emplace_shared<gtsam::BetweenFactor<gtsam::Vector6>>(
+        internal::TwistKey(i, 0), internal::TwistKey(i, K), Z_6x1,
+        twist_model);
+  }
+
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph->emplace_shared<gtsam::BetweenFactor<double>>(
+        internal::JointAngleKey(j, 0), internal::JointAngleKey(j, K), 0.0,
+        joint_angle_model);
+    graph->emplace_shared<gtsam::BetweenFactor<double>>(
+        internal::JointVelKey(j, 0), internal::JointVelKey(j, K), 0.0,
+        joint_velocity_model);
+    graph->emplace_shared<gtsam::BetweenFactor<double>>(
+        internal::JointAccelKey(j, 0), internal::JointAccelKey(j, K), 0.0,
+        joint_acceleration_model);
+  }
+}
+
+Values Trajectory::tile(const Values &cycle_values, size_t repeat) const {
+  const uint64_t K = getEndTimeStep(numPhases() - 1);
+  const gtsam::Key phase_prefix = DynamicsSymbol::Prefix(PhaseKey(0));
+  const auto at_step = [](gtsam::Key key, uint64_t k) {
+    return key - DynamicsSymbol::Step(key) + k;
+  };
+  const auto is_pose = [](gtsam::Key key) {
+    return DynamicsSymbol(key).label() == "p";
+  };
+
+  // Displacement of every link over one cycle.
+  map<gtsam::Key, Point3> displacements;
+  for (const gtsam::Key key : cycle_values.keys()) {
+    if (!is_pose(key) || DynamicsSymbol::Step(key) != 0) continue;
+    const gtsam::Key key_K = at_step(key, K);
+    if (!cycle_values.exists(key_K)) continue;
+    displacements[key] = cycle_values.at<Pose3>(key_K).translation() -
+                         cycle_values.at<Pose3>(key).translation();
+  }
+
+  Values values;
+  for (const auto &key_value : cycle_values) {
+    const gtsam::Key key = key_value.key;
+    const uint64_t k = DynamicsSymbol::Step(key);
+    if (DynamicsSymbol::Prefix(key) == phase_prefix) {
+      for (size_t c = 0; c < repeat; c++)
+        values.insert(at_step(key, c * numPhases() + k), key_value.value);
+      continue;
+    }
+    for (size_t c = 0; c < repeat; c++) {
+      // Copies meet at step K of copy c and step 0 of copy c + 1.
+      if (k == K && c + 1 < repeat &&
+          cycle_values.exists(at_step(key, 0)))
+        continue;
+      const gtsam::Key tiled = at_step(key, c * K + k);
+      if (!is_pose(key)) {
+        values.insert(tiled, key_value.value);
+        continue;
+      }
+      const auto it = displacements.find(at_step(key, 0));
+      const Point3 offset =
+          it == displacements.end() ? Point3(0, 0, 0) : double(c) * it->second;
+      const Pose3 pose = cycle_values.at<Pose3>(key);
+      values.insert(tiled, Pose3(pose.rotation(), pose.translation() + offset));
+    }
+  }
+  return values;
+}
+
 void Trajectory::addMinimumTorqueFactors(
     gtsam::NonlinearFactorGraph *graph, const Robot &robot,
     const SharedNoiseModel &cost_model) const {
@@ -177,4 +298,54 @@ void Trajectory::writeToFile(const Robot &robot, const std::string &name,
     }
   }
 }
+
+/* ************************************************************************* */
+void Trajectory::writeColumnarFile(const Robot &robot, const std::string &name,
+                                   const gtsam::Values &results) const {
+  vector<int> ids;
+  for (auto &&joint : robot.joints()) ids.push_back(joint->id());
+  std::sort(ids.begin(), ids.end());
+  const size_t K = final_timesteps_.empty() ? 0 : final_timesteps_.back() + 1,
+               J = ids.size();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+
+  // Phase index and dt of every step, the shared boundary steps with the
+  // phase they end.
+  vector<double> phases(K, nan), dts(K, nan);
+  for (int p = 0; p < numPhases(); p++) {
+    const double dt =
+        results.exists(PhaseKey(p)) ? results.atDouble(PhaseKey(p)) : nan;
+    for (int k = getStartTimeStep(p); k <= getEndTimeStep(p); k++) {
+      phases[k] = p;
+      dts[k] = dt;
+    }
+  }
+
+  // Joint quantities, row-major #steps x #joints, NaN where missing.
+  const vector<std::pair<string, std::function<gtsam::Key(int, int)>>>
+      quantities = {
+          {"q", internal::JointAngleKey},
+          {"v", internal::JointVelKey},
+          {"a", internal::JointAccelKey},
+          {"tau", internal::TorqueKey}};
+  vector<vector<double>> buffers;
+  for (auto &&quantity : quantities) {
+    vector<double> buffer(K * J, nan);
+    for (size_t k = 0; k < K; k++) {
+      for (size_t e = 0; e < J; e++) {
+        const gtsam::Key key = quantity.second(ids[e], k);
+        if (results.exists(key)) buffer[k * J + e] = results.atDouble(key);
+      }
+    }
+    buffers.push_back(std::move(buffer));
+  }
+
+  vector<TrajectoryFile::Array> arrays;
+  for (size_t i = 0; i < quantities.size(); i++)
+    arrays.push_back({quantities[i].first, ids, 1, buffers[i].data()});
+  arrays.push_back({"dt", {-1}, 1, dts.data()});
+  arrays.push_back({"phase", {-1}, 1, phases.data()});
+  TrajectoryFile::Write(name, K, arrays);
+}
+
 }  // namespace gtdynamics
@@ -31,6 +31,14 @@ class Trajectory {
  protected:
   std::vector<Phase> phases_; ///< All phases in the trajectory
 
+  /// Contact points of all phases and transitions, and the final time step of
+  /// every phase, derived from phases_ once so that queries are lookups.
+  std::vector<PointOnLinks> phase_contact_points_, transition_contact_points_;
+  std::vector<int> final_timesteps_;
+
+  /// Compute the members derived from phases_.
+  void cacheQueries();
+
  public:
   /// Default Constructor (for serialization)
   Trajectory() {}
@@ -52,6 +60,12 @@ class Trajectory {
       // Append phases_i of walk_cycle to phases_ vector member.
       phases_.insert(phases_.end(), phases_i.begin(), phases_i.end());
     }
+    cacheQueries();
+  }
+
+  /// Construct a trajectory from its phases, in order.
+  explicit Trajectory(const std::vector<Phase> &phases) : phases_(phases) {
+    cacheQueries();
   }
 
   /// Returns vector of phases in the trajectory
@@ -64,9 +78,8 @@ class Trajectory {
    * and may have repetitions, as opposed to contact_points_.
    * @return Phase CPs.
    */
-  std::vector<PointOnLinks> phaseContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.allPhasesContactPoints();
+  const std::vector<PointOnLinks> &phaseContactPoints() const {
+    return phase_contact_points_;
   }
 
   /**
@@ -74,9 +87,8 @@ class Trajectory {
    * phases after applying repetition on the original sequence.
    * @return Transition CPs.
    */
-  std::vector<PointOnLinks> transitionContactPoints() const {
-    WalkCycle wc = WalkCycle(phases_);
-    return wc.transitionContactPoints();
+  const std::vector<PointOnLinks> &transitionContactPoints() const {
+    return transition_contact_points_;
   }
 
   /**
@@ -114,45 +126,42 @@ class Trajectory {
    * @param[in] graph_builder    GraphBuilder instance.
    * @param[in] collocation      Which collocation scheme to use.
    * @param[in] mu               Coefficient of static friction.
+   * @param[in] pool             Optional thread pool to build time steps on.
    * @return Multi-phase factor graph
    */
   gtsam::NonlinearFactorGraph multiPhaseFactorGraph(
       const Robot &robot, const DynamicsGraph &graph_builder,
-      const CollocationScheme collocation, double mu) const;
+      const CollocationScheme collocation, double mu,
+      ThreadPool *pool = nullptr) const;
 
   /**
    * @fn Returns Initial values for transition graphs.
    * @param[in] robot             Robot specification from URDF/SDF.
    * @param[in] gaussian_noise    Gaussian noise to add to initial values
+   * @param[in] pool              Optional thread pool to build transitions on.
    * @return Initial values for transition graphs
    */
   std::vector<gtsam::Values> transitionPhaseInitialValues(
-      const Robot &robot, double gaussian_noise) const;
+      const Robot &robot, double gaussian_noise,
+      ThreadPool *pool = nullptr) const;
 
   /**
    * @fn Returns Initial values for multi-phase factor graph.
    * @param[in] robot             Robot specification from URDF/SDF.
    * @param[in] gaussian_noise    Gaussian noise to add to initial values
    * @param[in] desired_dt        integration timestep
+   * @param[in] pool              Optional thread pool to build time steps on.
    * @return Initial values for multi-phase factor graph
    */
   gtsam::Values multiPhaseInitialValues(const Robot &robot,
-                                        double gaussian_noise, double dt) const;
+                                        double gaussian_noise, double dt,
+                                        ThreadPool *pool = nullptr) const;
 
   /**
    * @fn Returns a vector of final time step for every phase.
    * @return Vector of final time steps.
    */
-  std::vector<int> finalTimeSteps() const {
-    int final_timestep = 0;
-    std::vector<int> final_timesteps;
-    for (size_t i = 0; i < phases_.size(); i++) {
-      int phase_timestep = phases_[i].numTimeSteps();
-      final_timestep += phase_timestep;
-      final_timesteps.push_back(final_timestep);
-    }
-    return final_timesteps;
-  }
+  const std::vector<int> &finalTimeSteps() const { return final_timesteps_; }
 
   /**
    * @fn Return phase for given phase number p.
@@ -169,8 +178,7 @@ class Trajectory {
    * @return Initial time step.
    */
   int getStartTimeStep(size_t p) const {
-    std::vector<int> final_timesteps = finalTimeSteps();
-    int k_start = final_timesteps[p] - phase(p).numTimeSteps();
+    int k_start = final_timesteps_[p] - phase(p).numTimeSteps();
     if (p != 0) k_start += 1;
     return k_start;
   }
@@ -180,7 +188,7 @@ class Trajectory {
    * @param[in] p    Phase number.
    * @return Final time step.
    */
-  int getEndTimeStep(size_t p) const { return finalTimeSteps()[p]; }
+  int getEndTimeStep(size_t p) const { return final_timesteps_[p]; }
 
   /**
    * @fn Generates a PointGoalFactor object
@@ -195,8 +203,16 @@ class Trajectory {
       const Robot &robot, const std::string &link_name, const PointOnLink &cp,
       int k, const gtsam::SharedNoiseModel &cost_model,
       const gtsam::Point3 &goal_point) const {
-    LinkSharedPtr link = robot.link(link_name);
-    gtsam::Key pose_key = internal::PoseKey(link->id(), k);
+    return pointGoalFactor(robot, robot.linkId(link_name), cp, k, cost_model,
+                           goal_point);
+  }
+
+  /// Generates a PointGoalFactor object, for the link with id link_id.
+  gtsam::ExpressionFactor<gtsam::Vector3> pointGoalFactor(
+      const Robot &robot, DynamicsIndex link_id, const PointOnLink &cp, int k,
+      const gtsam::SharedNoiseModel &cost_model,
+      const gtsam::Point3 &goal_point) const {
+    gtsam::Key pose_key = internal::PoseKey(robot.link(link_id)->id(), k);
     return PointGoalFactor(pose_key, cost_model, cp.point, goal_point);
   }
 
@@ -208,11 +224,13 @@ class Trajectory {
    * @param[in] cost_model Noise model
    * @param[in] step The 3D vector the foot moves in a step.
    * @param[in] ground_height z-coordinate of ground in URDF/SDF rest config.
+   * @param[in] pool optional thread pool, to build the phases in parallel.
    * @return All objective factors as a NonlinearFactorGraph
    */
   gtsam::NonlinearFactorGraph contactPointObjectives(
       const Robot &robot, const gtsam::SharedNoiseModel &cost_model,
-      const gtsam::Point3 &step, double ground_height = {}) const;
+      const gtsam::Point3 &step, double ground_height = {},
+      ThreadPool *pool = nullptr) const;
 
   /**
    * @fn Add minimum torque objectives.
@@ -245,6 +263,45 @@ class Trajectory {
       const gtsam::SharedNoiseModel &joint_velocity_model,
       const gtsam::SharedNoiseModel &joint_acceleration_model) const;
 
+  /**
+   * @fn Periodic boundary conditions, for optimizing one cycle of a steady
+   * gait instead of `repeat` copies of it: the final time step K has the same
+   * joint angles, velocities and accelerations as time step 0, and every link
+   * the same rotation and twist, while its position is free, so the robot may
+   * advance by a translation per cycle. Use in place of the final conditions
+   * of addBoundaryConditions, and tile the solution with `tile`.
+   *
+   * @param[in,out] graph nonlinear factor graph to add to.
+   * @param[in] robot Robot specification from URDF/SDF.
+   * @param[in] rotation_model 3-dimensional model of the link rotations.
+   * @param[in] twist_model model of the link twists.
+   * @param[in] joint_angle_model model of the joint angles.
+   * @param[in] joint_velocity_model model of the joint velocities.
+   * @param[in] joint_acceleration_model model of the joint accelerations.
+   */
+  void addPeriodicBoundaryConditions(
+      gtsam::NonlinearFactorGraph *graph, const Robot &robot,
+      const gtsam::SharedNoiseModel &rotation_model,
+      const gtsam::SharedNoiseModel &twist_model,
+      const gtsam::SharedNoiseModel &joint_angle_model,
+      const gtsam::SharedNoiseModel &joint_velocity_model,
+      const gtsam::SharedNoiseModel &joint_acceleration_model) const;
+
+  /**
+   * @fn Tile the solution of a periodic trajectory, see
+   * addPeriodicBoundaryConditions, into values for Trajectory(walk_cycle,
+   * repeat), with this trajectory being one walk cycle. Copy c of time step
+   * k goes to time step c * K + k, and the phase durations to the copies of
+   * the phases. Link poses are moved by c times their displacement over the
+   * cycle. Where copies meet, the values of time step 0 of the next copy are
+   * used, with the keys only present at step K, e.g. contact wrenches, added.
+   *
+   * @param[in] cycle_values solution of this trajectory.
+   * @param[in] repeat number of copies.
+   * @return values of the tiled trajectory.
+   */
+  gtsam::Values tile(const gtsam::Values &cycle_values, size_t repeat) const;
+
   /**
    * @fn Add priors on all variable time steps.
    * @param[in, out] graph NonlinearFactorGraph to add to
@@ -277,5 +334,16 @@ class Trajectory {
    */
   void writeToFile(const Robot &robot, const std::string &name,
                    const gtsam::Values &results) const;
+
+  /**
+   * @fn Writes the angles, vels, accels and torques of all phases, each phase
+   * once, as a binary TrajectoryFile, with the "dt" and "phase" of every time
+   * step. Much faster to write and read back than writeToFile.
+   * @param[in] robot     Robot specification from URDF/SDF.
+   * @param[in] name      Trajectory File name.
+   * @param[in] results   Results of Optimization.
+   */
+  void writeColumnarFile(const Robot &robot, const std::string &name,
+                         const gtsam::Values &results) const;
 };
 }  // namespace gtdynamics
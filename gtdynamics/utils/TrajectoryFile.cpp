@@ -0,0 +1,329 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFile.cpp
+ * @brief Memory-mapped columnar file format for trajectory results.
+ */
+
+#include "gtdynamics/utils/TrajectoryFile.h"
+
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/geometry/Pose3.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "gtdynamics/utils/values.h"
+
+using gtsam::Key;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+constexpr uint32_t TrajectoryFile::kVersion;
+
+static const char kMagic[8] = "GTDTRAJ";
+static constexpr size_t kHeaderSize = 24, kEntrySize = 48, kNameSize = 16;
+
+namespace {
+
+// A quantity to gather from Values: its key per entity id and step, and how
+// to copy one value into `width` doubles.
+struct KeyedColumn {
+  std::string name;
+  std::vector<int> ids;
+  size_t width;
+  std::function<Key(int, int)> key;
+  std::function<void(const gtsam::Value &, double *)> copy;
+};
+
+template <typename T>
+void Append(std::string *buffer, T x) {
+  buffer->append(reinterpret_cast<const char *>(&x), sizeof(T));
+}
+
+size_t Aligned(size_t offset) { return (offset + 7) / 8 * 8; }
+
+template <typename T>
+T Read(const char *data) {
+  T x;
+  std::memcpy(&x, data, sizeof(T));
+  return x;
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+void TrajectoryFile::Write(const std::string &filename, const Robot &robot,
+                           const Values &values, int num_steps) {
+  std::vector<int> joint_ids, link_ids;
+  for (auto &&joint : robot.joints()) joint_ids.push_back(joint->id());
+  for (auto &&link : robot.links()) link_ids.push_back(link->id());
+  std::sort(joint_ids.begin(), joint_ids.end());
+  std::sort(link_ids.begin(), link_ids.end());
+
+  const auto scalar = [](const gtsam::Value &value, double *out) {
+    *out = value.cast<double>();
+  };
+  const auto vector6 = [](const gtsam::Value &value, double *out) {
+    const gtsam::Vector6 v = value.cast<gtsam::Vector6>();
+    std::copy(v.data(), v.data() + 6, out);
+  };
+  const auto pose = [](const gtsam::Value &value, double *out) {
+    const gtsam::Pose3 T = value.cast<gtsam::Pose3>();
+    const gtsam::Matrix3 R = T.rotation().matrix();
+    std::copy(T.translation().data(), T.translation().data() + 3, out);
+    std::copy(R.data(), R.data() + 9, out + 3);
+  };
+  const std::vector<KeyedColumn> columns = {
+      {"q", joint_ids, 1, internal::JointAngleKey, scalar},
+      {"v", joint_ids, 1, internal::JointVelKey, scalar},
+      {"a", joint_ids, 1, internal::JointAccelKey, scalar},
+      {"tau", joint_ids, 1, internal::TorqueKey, scalar},
+      {"pose", link_ids, 12, internal::PoseKey, pose},
+      {"twist", link_ids, 6, internal::TwistKey, vector6},
+      {"twist_accel", link_ids, 6, internal::TwistAccelKey, vector6}};
+
+  // Arrays of the quantities that have values, NaN where there are none.
+  const size_t rows = num_steps + 1;
+  std::vector<std::vector<double>> buffers;
+  std::vector<Array> arrays;
+  for (auto &&column : columns) {
+    const size_t E = column.ids.size(), w = column.width;
+    std::vector<double> buffer(rows * E * w,
+                               std::numeric_limits<double>::quiet_NaN());
+    bool any = false;
+    for (size_t t = 0; t < rows; t++) {
+      for (size_t e = 0; e < E; e++) {
+        const Key key = column.key(column.ids[e], t);
+        if (!values.exists(key)) continue;
+        column.copy(values.at(key), &buffer[(t * E + e) * w]);
+        any = true;
+      }
+    }
+    if (!any) continue;
+    buffers.push_back(std::move(buffer));
+    arrays.push_back({column.name, column.ids, w, nullptr});
+  }
+  for (size_t i = 0; i < arrays.size(); i++) arrays[i].data = buffers[i].data();
+  Write(filename, rows, arrays);
+}
+
+/* ************************************************************************* */
+void TrajectoryFile::Write(const std::string &filename, size_t num_steps,
+                           const std::vector<Array> &arrays) {
+  for (auto &&array : arrays)
+    if (array.name.empty() || array.name.size() >= kNameSize ||
+        array.width == 0 || (!array.data && num_steps * array.ids.size() > 0))
+      throw std::invalid_argument("TrajectoryFile: invalid quantity \"" +
+                                  array.name + "\".");
+
+  std::string header;
+  header.append(kMagic, sizeof(kMagic));
+  Append<uint32_t>(&header, kVersion);
+  Append<uint32_t>(&header, arrays.size());
+  Append<uint64_t>(&header, num_steps);
+
+  // Entries first, as the offsets do not depend on the data.
+  const size_t data_start = kHeaderSize + kEntrySize * arrays.size();
+  std::vector<size_t> data_offsets;
+  size_t offset = data_start;
+  for (auto &&array : arrays) {
+    const size_t ids_offset = offset;
+    const size_t data_offset =
+        Aligned(ids_offset + sizeof(int32_t) * array.ids.size());
+    offset = data_offset +
+             sizeof(double) * num_steps * array.ids.size() * array.width;
+    data_offsets.push_back(data_offset);
+
+    char name[kNameSize] = {};
+    array.name.copy(name, kNameSize - 1);
+    header.append(name, kNameSize);
+    Append<uint64_t>(&header, array.ids.size());
+    Append<uint64_t>(&header, array.width);
+    Append<uint64_t>(&header, ids_offset);
+    Append<uint64_t>(&header, data_offset);
+  }
+
+  // Then ids and padding, and every buffer in a single write.
+  std::ofstream os(filename, std::ios::binary);
+  os.write(header.data(), header.size());
+  size_t written = data_start;
+  for (size_t i = 0; i < arrays.size(); i++) {
+    const Array &array = arrays[i];
+    std::string ids;
+    for (const int id : array.ids) Append<int32_t>(&ids, id);
+    ids.resize(data_offsets[i] - written, '\0');
+    os.write(ids.data(), ids.size());
+    const size_t size =
+        sizeof(double) * num_steps * array.ids.size() * array.width;
+    if (size > 0) os.write(reinterpret_cast<const char *>(array.data), size);
+    written = data_offsets[i] + size;
+  }
+  if (!os) throw std::runtime_error("TrajectoryFile: cannot write " + filename);
+}
+
+/* ************************************************************************* */
+TrajectoryFile::TrajectoryFile(const std::string &filename) {
+#ifndef _WIN32
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("TrajectoryFile: cannot open " + filename);
+  struct stat st;
+  if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+    size_ = st.st_size;
+    void *map = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (map != MAP_FAILED) data_ = static_cast<const char *>(map);
+  }
+  ::close(fd);
+  if (!data_)
+    throw std::runtime_error("TrajectoryFile: cannot map " + filename);
+#else
+  std::ifstream is(filename, std::ios::binary);
+  if (!is) throw std::runtime_error("TrajectoryFile: cannot open " + filename);
+  buffer_.assign(std::istreambuf_iterator<char>(is),
+                 std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+#endif
+
+  // The destructor does not run when the constructor throws.
+  const auto fail = [this, &filename](const std::string &reason) {
+#ifndef _WIN32
+    ::munmap(const_cast<char *>(data_), size_);
+#endif
+    throw std::runtime_error("TrajectoryFile: " + filename + " " + reason +
+                             ".");
+  };
+  if (size_ < kHeaderSize || std::memcmp(data_, kMagic, sizeof(kMagic)) != 0)
+    fail("is not a trajectory file");
+  if (Read<uint32_t>(data_ + 8) != kVersion) fail("has an unknown version");
+  const uint32_t num_quantities = Read<uint32_t>(data_ + 12);
+  num_steps_ = Read<uint64_t>(data_ + 16);
+  if (size_ < kHeaderSize + kEntrySize * num_quantities) fail("is truncated");
+
+  for (uint32_t i = 0; i < num_quantities; i++) {
+    const char *entry = data_ + kHeaderSize + kEntrySize * i;
+    Quantity q;
+    q.name.assign(entry, std::find(entry, entry + kNameSize, '\0'));
+    q.num_entities = Read<uint64_t>(entry + 16);
+    q.width = Read<uint64_t>(entry + 24);
+    q.ids_offset = Read<uint64_t>(entry + 32);
+    q.data_offset = Read<uint64_t>(entry + 40);
+    if (q.ids_offset + sizeof(int32_t) * q.num_entities > size_ ||
+        q.data_offset % 8 != 0 ||
+        q.data_offset + sizeof(double) * num_steps_ * q.num_entities * q.width >
+            size_)
+      fail("is truncated");
+    quantities_.push_back(q);
+  }
+}
+
+/* ************************************************************************* */
+TrajectoryFile::~TrajectoryFile() {
+#ifndef _WIN32
+  if (data_) ::munmap(const_cast<char *>(data_), size_);
+#endif
+  data_ = nullptr;
+}
+
+/* ************************************************************************* */
+std::vector<std::string> TrajectoryFile::quantities() const {
+  std::vector<std::string> names;
+  for (auto &&q : quantities_) names.push_back(q.name);
+  return names;
+}
+
+/* ************************************************************************* */
+bool TrajectoryFile::has(const std::string &quantity) const {
+  return std::any_of(quantities_.begin(), quantities_.end(),
+                     [&](const Quantity &q) { return q.name == quantity; });
+}
+
+/* ************************************************************************* */
+const TrajectoryFile::Quantity &TrajectoryFile::quantity(
+    const std::string &name) const {
+  for (auto &&q : quantities_)
+    if (q.name == name) return q;
+  throw std::invalid_argument("TrajectoryFile: no quantity " + name);
+}
+
+/* ************************************************************************* */
+std::vector<int> TrajectoryFile::ids(const std::string &quantity) const {
+  const Quantity &q = this->quantity(quantity);
+  std::vector<int> ids(q.num_entities);
+  for (size_t e = 0; e < q.num_entities; e++)
+    ids[e] = Read<int32_t>(data_ + q.ids_offset + sizeof(int32_t) * e);
+  return ids;
+}
+
+/* ************************************************************************* */
+size_t TrajectoryFile::width(const std::string &quantity) const {
+  return this->quantity(quantity).width;
+}
+
+/* ************************************************************************* */
+TrajectoryFile::ConstMap TrajectoryFile::data(
+    const std::string &quantity) const {
+  const Quantity &q = this->quantity(quantity);
+  return ConstMap(reinterpret_cast<const double *>(data_ + q.data_offset),
+                  num_steps_, q.num_entities * q.width);
+}
+
+/* ************************************************************************* */
+TrajectoryFile::ConstStridedMap TrajectoryFile::entity(
+    const std::string &quantity, int id) const {
+  const Quantity &q = this->quantity(quantity);
+  const std::vector<int> ids = this->ids(quantity);
+  const auto it = std::find(ids.begin(), ids.end(), id);
+  if (it == ids.end())
+    throw std::invalid_argument("TrajectoryFile: no entity " +
+                                std::to_string(id) + " in " + quantity);
+  const size_t e = it - ids.begin();
+  return ConstStridedMap(
+      reinterpret_cast<const double *>(data_ + q.data_offset) + e * q.width,
+      num_steps_, q.width,
+      Eigen::OuterStride<>(q.num_entities * q.width));
+}
+
+/* ************************************************************************* */
+gtsam::Vector TrajectoryFile::jointValues(const std::string &quantity,
+                                          size_t t) const {
+  const Quantity &q = this->quantity(quantity);
+  if (q.width != 1)
+    throw std::invalid_argument("TrajectoryFile: " + quantity +
+                                " is not a joint quantity.");
+  if (t >= num_steps_)
+    throw std::invalid_argument("TrajectoryFile: no step " +
+                                std::to_string(t));
+  const std::vector<int> ids = this->ids(quantity);
+  const int max_id =
+      ids.empty() ? -1 : *std::max_element(ids.begin(), ids.end());
+  gtsam::Vector result = gtsam::Vector::Constant(
+      max_id + 1, std::numeric_limits<double>::quiet_NaN());
+  const double *row =
+      reinterpret_cast<const double *>(data_ + q.data_offset) +
+      t * q.num_entities;
+  for (size_t e = 0; e < ids.size(); e++)
+    if (ids[e] >= 0) result(ids[e]) = row[e];
+  return result;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,150 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  TrajectoryFile.h
+ * @brief Memory-mapped columnar file format for trajectory results.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * TrajectoryFile stores the joint and link quantities of a trajectory as one
+ * contiguous array per quantity, and reads them back by memory-mapping the
+ * file, so that opening does not parse or copy the arrays.
+ *
+ * The file starts with a 24 byte header, followed by a table of 48 byte
+ * entries, one per quantity, and then the arrays, each starting at a multiple
+ * of 8 bytes:
+ *
+ *     header:   char[8] "GTDTRAJ", uint32 version, uint32 #quantities,
+ *               uint64 #steps
+ *     quantity: char[16] name, uint64 #entities, uint64 width,
+ *               uint64 offset of the ids, uint64 offset of the data
+ *     ids:      int32 joint or link id of every entity
+ *     data:     double[#steps][#entities][width]
+ *
+ * The quantities are "q", "v", "a" and "tau" of the joints, of width 1, and
+ * "pose" (translation, then rotation matrix in column-major order), "twist"
+ * and "twist_accel" of the links, of widths 12, 6 and 6. Only quantities with
+ * values are written, and missing values are NaN. Files of multi-phase
+ * trajectories, see Trajectory::writeColumnarFile, also have the "dt" and
+ * "phase" of every step, as a single entity of id -1. All numbers are in
+ * host byte order. python/gtdynamics/trajectory_file.py reads the same
+ * format.
+ */
+class TrajectoryFile {
+ public:
+  /// Steps by entities * width, in row-major order like the file.
+  using RowMajorMatrix =
+      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  using ConstMap = Eigen::Map<const RowMajorMatrix>;
+  using ConstStridedMap =
+      Eigen::Map<const RowMajorMatrix, 0, Eigen::OuterStride<>>;
+
+  static constexpr uint32_t kVersion = 1;
+
+  /// A quantity to write from a dense buffer, see Write.
+  struct Array {
+    std::string name;      ///< at most 15 characters
+    std::vector<int> ids;  ///< joint or link id of every entity
+    size_t width = 1;      ///< numbers per entity and step
+    /// #steps by #entities by width numbers, in row-major order like the
+    /// file, e.g. the column-major #entities by #steps joint matrices of
+    /// CompactTrajectory.
+    const double *data = nullptr;
+  };
+
+  /**
+   * Write quantities from dense buffers, with one copy from each buffer to
+   * the file and no lookups in gtsam::Values.
+   * @param filename  path of the file, replaced if it exists
+   * @param num_steps number of time steps, the rows of every array
+   * @param arrays    the quantities, in file order
+   */
+  static void Write(const std::string &filename, size_t num_steps,
+                    const std::vector<Array> &arrays);
+
+  /**
+   * Write the trajectory in `values` to `filename`.
+   * @param filename  path of the file, replaced if it exists
+   * @param robot     the robot, whose joints and links are the entities
+   * @param values    values of the trajectory
+   * @param num_steps index of the last time step, steps 0..num_steps are saved
+   */
+  static void Write(const std::string &filename, const Robot &robot,
+                    const gtsam::Values &values, int num_steps);
+
+  /// Open and map `filename`, checking the header and table.
+  explicit TrajectoryFile(const std::string &filename);
+
+  ~TrajectoryFile();
+
+  TrajectoryFile(const TrajectoryFile &) = delete;
+  TrajectoryFile &operator=(const TrajectoryFile &) = delete;
+
+  /// Number of time steps, the rows of every quantity.
+  size_t numSteps() const { return num_steps_; }
+
+  /// Names of the stored quantities, in file order.
+  std::vector<std::string> quantities() const;
+
+  /// Whether `quantity` is stored.
+  bool has(const std::string &quantity) const;
+
+  /// Joint or link ids of the entities of `quantity`.
+  std::vector<int> ids(const std::string &quantity) const;
+
+  /// Numbers per entity and step of `quantity`.
+  size_t width(const std::string &quantity) const;
+
+  /**
+   * All data of `quantity`, without copying: row t holds the numbers of all
+   * entities at step t.
+   */
+  ConstMap data(const std::string &quantity) const;
+
+  /**
+   * Data of entity `id` of `quantity`, a numSteps() by width() view into the
+   * file.
+   */
+  ConstStridedMap entity(const std::string &quantity, int id) const;
+
+  /**
+   * Values of a joint quantity of width 1 at step t, indexed by joint id,
+   * e.g. to replay a trajectory with Simulator::setState. Joint ids without
+   * an entity are NaN.
+   */
+  gtsam::Vector jointValues(const std::string &quantity, size_t t) const;
+
+ private:
+  struct Quantity {
+    std::string name;
+    uint64_t num_entities, width, ids_offset, data_offset;
+  };
+
+  const Quantity &quantity(const std::string &name) const;
+
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  std::vector<char> buffer_;  // used where memory-mapping is not available
+  uint64_t num_steps_ = 0;
+  std::vector<Quantity> quantities_;
+};
+
+}  // namespace gtdynamics
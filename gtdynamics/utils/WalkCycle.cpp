@@ -72,7 +72,7 @@ ContactPointGoals WalkCycle::initContactPointGoal(const Robot &robot,
         auto link_name = cp.link->name();
         // If no goal set yet, add it here
         if (cp_goals.count(link_name) == 0) {
-          LinkSharedPtr link = robot.link(link_name);
+          LinkSharedPtr link = robot.link(cp.link->id());
           const Point3 foot_w = link->bMcom() * cp.point + adjust;
           cp_goals.emplace(link_name, foot_w);
         }
@@ -85,27 +85,50 @@ ContactPointGoals WalkCycle::initContactPointGoal(const Robot &robot,
 
 NonlinearFactorGraph WalkCycle::contactPointObjectives(
     const Point3 &step, const SharedNoiseModel &cost_model, size_t k_start,
-    ContactPointGoals *cp_goals) const {
-  NonlinearFactorGraph factors;
-
+    ContactPointGoals *cp_goals, ThreadPool *pool) const {
+  // Serially, the start goals, time step and first factor of each phase.
+  struct Part {
+    boost::shared_ptr<const FootContactConstraintSpec> spec;
+    std::vector<Point3> goals;
+    size_t k_start, num_steps, offset;
+  };
+  std::vector<Part> parts;
+  std::vector<Point3> goals;
+  for (auto &&cp : contact_points_)
+    goals.push_back(cp_goals->at(cp.link->name()));
+  size_t num_factors = 0;
   for (const Phase &phase : phases_) {
     auto foot_contact_spec =
         castFootContactConstraintSpec(phase.constraintSpec());
     if (foot_contact_spec) {
-      // Ask the Phase instance to anchor the stance legs
-      factors.add(foot_contact_spec->contactPointObjectives(
-          contact_points_, step, cost_model, k_start, *cp_goals,
-          phase.numTimeSteps()));
-
+      const size_t ts = phase.numTimeSteps();
+      parts.push_back({foot_contact_spec, goals, k_start, ts, num_factors});
       // Update goals for swing legs
-      *cp_goals = foot_contact_spec->updateContactPointGoals(contact_points_,
-                                                             step, *cp_goals);
-
+      goals = foot_contact_spec->updateContactPointGoals(contact_points_, step,
+                                                         goals);
       // update the start time step for the next phase
-      k_start += phase.numTimeSteps();
+      k_start += ts;
+      num_factors += contact_points_.size() * ts;
     }
   }
 
+  // Then each phase writes the objectives anchoring its stance legs into its
+  // own slots of the preallocated graph.
+  NonlinearFactorGraph factors;
+  factors.resize(num_factors);
+  auto build = [&](size_t p, size_t) {
+    const Part &part = parts[p];
+    part.spec->contactPointObjectives(contact_points_, part.goals, step,
+                                      cost_model, part.k_start, part.num_steps,
+                                      &factors, part.offset);
+  };
+  if (pool)
+    pool->parallelFor(parts.size(), build);
+  else
+    for (size_t p = 0; p < parts.size(); p++) build(p, 0);
+
+  for (size_t c = 0; c < contact_points_.size(); c++)
+    (*cp_goals)[contact_points_[c].link->name()] = goals[c];
   return factors;
 }
 
@@ -17,6 +17,7 @@
 #include <gtsam/linear/Sampler.h>
 #include <gtsam/nonlinear/GaussNewtonOptimizer.h>
 #include <gtdynamics/utils/FootContactConstraintSpec.h>
+#include <gtdynamics/utils/ThreadPool.h>
 
 #include <map>
 #include <string>
@@ -149,11 +150,13 @@ class WalkCycle {
    * @param[in] cost_model Noise model
    * @param[in] step The 3D vector the foot moves in a step.
    * @param[in] ground_height z-coordinate of ground in URDF/SDF rest config.
+   * @param[in] pool optional thread pool, to build the phases in parallel.
    * @return All objective factors as a NonlinearFactorGraph
    */
   gtsam::NonlinearFactorGraph contactPointObjectives(
       const gtsam::Point3 &step, const gtsam::SharedNoiseModel &cost_model,
-      size_t k_start, ContactPointGoals *cp_goals) const;
+      size_t k_start, ContactPointGoals *cp_goals,
+      ThreadPool *pool = nullptr) const;
 
   /**
    * @fn Returns the swing links for a given phase.
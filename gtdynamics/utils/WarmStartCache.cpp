@@ -0,0 +1,233 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WarmStartCache.cpp
+ * @brief Store of past solutions, to warm-start repeated planning queries.
+ */
+
+#include "gtdynamics/utils/WarmStartCache.h"
+
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "gtdynamics/factors/PointGoalFactor.h"
+
+using gtsam::Matrix3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector;
+using gtsam::Vector3;
+using gtsam::Vector6;
+
+namespace gtdynamics {
+
+static const char kHeader[] = "gtdynamics-warm-start 1";
+
+/* ************************************************************************* */
+std::string WarmStartCache::Signature(const Robot &robot,
+                                      const std::vector<int> &phase_steps) {
+  std::stringstream ss;
+  ss << "links";
+  for (auto &&link : robot.links()) ss << " " << link->name();
+  ss << " joints";
+  for (auto &&joint : robot.joints()) ss << " " << joint->name();
+  ss << " phases";
+  for (const int steps : phase_steps) ss << " " << steps;
+  return ss.str();
+}
+
+/* ************************************************************************* */
+Vector WarmStartCache::GoalFeatures(const gtsam::NonlinearFactorGraph &graph) {
+  std::vector<double> features;
+  for (auto &&factor : graph) {
+    if (auto prior =
+            boost::dynamic_pointer_cast<gtsam::PriorFactor<Pose3>>(factor)) {
+      const Vector6 xi = Pose3::Logmap(prior->prior());
+      features.insert(features.end(), xi.data(), xi.data() + 3);
+      const Vector3 t = prior->prior().translation();
+      features.insert(features.end(), t.data(), t.data() + 3);
+    } else if (auto goal = boost::dynamic_pointer_cast<PointGoalFactor>(
+                   factor)) {
+      const Vector3 &p = goal->goalPoint();
+      features.insert(features.end(), p.data(), p.data() + 3);
+    }
+  }
+  return Eigen::Map<const Vector>(features.data(), features.size());
+}
+
+/* ************************************************************************* */
+void WarmStartCache::insertLocked(const std::string &signature,
+                                  Entry &&entry) {
+  auto &entries = entries_[signature];
+  entries.push_back(std::move(entry));
+  if (capacity_ > 0 && entries.size() > capacity_) entries.pop_front();
+}
+
+/* ************************************************************************* */
+void WarmStartCache::insert(const std::string &signature,
+                            const Vector &features, const Values &solution) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  insertLocked(signature, Entry{features, solution});
+}
+
+/* ************************************************************************* */
+boost::optional<Values> WarmStartCache::nearest(const std::string &signature,
+                                                const Vector &features,
+                                                double *distance) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = entries_.find(signature);
+  if (it == entries_.end()) return boost::none;
+
+  const Entry *best = nullptr;
+  double best_distance = std::numeric_limits<double>::infinity();
+  for (auto &&entry : it->second) {
+    if (entry.features.size() != features.size()) continue;
+    const double d = (entry.features - features).norm();
+    if (d < best_distance) {
+      best_distance = d;
+      best = &entry;
+    }
+  }
+  if (!best) return boost::none;
+  if (distance) *distance = best_distance;
+  return best->solution;
+}
+
+/* ************************************************************************* */
+size_t WarmStartCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t n = 0;
+  for (auto &&entries : entries_) n += entries.second.size();
+  return n;
+}
+
+// Write a value as a type tag and its numbers, see ReadValue.
+static void WriteValue(std::ostream &os, const gtsam::Value &value) {
+  const auto write = [&os](const char *tag, const double *data, size_t n) {
+    os << tag << " " << n;
+    for (size_t i = 0; i < n; i++) os << " " << data[i];
+  };
+  if (auto v = dynamic_cast<const gtsam::GenericValue<double> *>(&value)) {
+    write("d", &v->value(), 1);
+  } else if (auto v =
+                 dynamic_cast<const gtsam::GenericValue<Vector> *>(&value)) {
+    write("v", v->value().data(), v->value().size());
+  } else if (auto v =
+                 dynamic_cast<const gtsam::GenericValue<Vector3> *>(&value)) {
+    write("v3", v->value().data(), 3);
+  } else if (auto v =
+                 dynamic_cast<const gtsam::GenericValue<Vector6> *>(&value)) {
+    write("v6", v->value().data(), 6);
+  } else if (auto v = dynamic_cast<const gtsam::GenericValue<Rot3> *>(&value)) {
+    const Matrix3 R = v->value().matrix();
+    write("R", R.data(), 9);
+  } else if (auto v =
+                 dynamic_cast<const gtsam::GenericValue<Pose3> *>(&value)) {
+    Eigen::Matrix<double, 12, 1> x;
+    x << Eigen::Map<const Eigen::Matrix<double, 9, 1>>(
+             v->value().rotation().matrix().data()),
+        v->value().translation();
+    write("T", x.data(), 12);
+  } else {
+    throw std::runtime_error("WarmStartCache: unsupported value type.");
+  }
+}
+
+// Read a value written by WriteValue and insert it at `key`.
+static void ReadValue(std::istream &is, gtsam::Key key, Values *values) {
+  std::string tag;
+  size_t n;
+  is >> tag >> n;
+  Vector x(n);
+  for (size_t i = 0; i < n; i++) is >> x(i);
+  if (!is) throw std::runtime_error("WarmStartCache: truncated file.");
+
+  if (tag == "d" && n == 1) {
+    values->insert(key, x(0));
+  } else if (tag == "v") {
+    values->insert(key, x);
+  } else if (tag == "v3" && n == 3) {
+    values->insert(key, Vector3(x));
+  } else if (tag == "v6" && n == 6) {
+    values->insert(key, Vector6(x));
+  } else if (tag == "R" && n == 9) {
+    values->insert(key, Rot3(Eigen::Map<const Matrix3>(x.data())));
+  } else if (tag == "T" && n == 12) {
+    values->insert(key, Pose3(Rot3(Eigen::Map<const Matrix3>(x.data())),
+                              gtsam::Point3(x.tail<3>())));
+  } else {
+    throw std::runtime_error("WarmStartCache: unknown value type " + tag);
+  }
+}
+
+/* ************************************************************************* */
+void WarmStartCache::save(const std::string &filename) const {
+  std::ofstream os(filename);
+  if (!os) throw std::runtime_error("WarmStartCache: cannot write " + filename);
+  os << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  os << kHeader << "\n";
+  for (auto &&entries : entries_) {
+    for (auto &&entry : entries.second) {
+      // The signature has a line of its own, as it contains spaces.
+      os << entries.first << "\n" << entry.features.size();
+      for (int i = 0; i < entry.features.size(); i++)
+        os << " " << entry.features(i);
+      os << "\n" << entry.solution.size() << "\n";
+      for (auto &&key_value : entry.solution) {
+        os << key_value.key << " ";
+        WriteValue(os, key_value.value);
+        os << "\n";
+      }
+    }
+  }
+}
+
+/* ************************************************************************* */
+void WarmStartCache::load(const std::string &filename) {
+  std::ifstream is(filename);
+  std::string line;
+  if (!std::getline(is, line) || line != kHeader)
+    throw std::runtime_error("WarmStartCache: " + filename +
+                             " is not a warm-start file.");
+
+  std::vector<std::pair<std::string, Entry>> loaded;
+  std::string signature;
+  while (std::getline(is, signature)) {
+    if (signature.empty()) continue;
+    Entry entry;
+    size_t num_features, num_values;
+    is >> num_features;
+    entry.features.resize(num_features);
+    for (size_t i = 0; i < num_features; i++) is >> entry.features(i);
+    is >> num_values;
+    for (size_t i = 0; i < num_values; i++) {
+      gtsam::Key key;
+      is >> key;
+      ReadValue(is, key, &entry.solution);
+    }
+    if (!is) throw std::runtime_error("WarmStartCache: truncated file.");
+    is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    loaded.emplace_back(signature, std::move(entry));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &&signature_entry : loaded)
+    insertLocked(signature_entry.first, std::move(signature_entry.second));
+}
+
+}  // namespace gtdynamics
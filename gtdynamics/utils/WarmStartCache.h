@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WarmStartCache.h
+ * @brief Store of past solutions, to warm-start repeated planning queries.
+ */
+
+#pragma once
+
+#include <gtsam/base/Vector.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <boost/optional.hpp>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/Robot.h"
+
+namespace gtdynamics {
+
+/**
+ * WarmStartCache keeps solutions of past queries, indexed by a signature of
+ * the problem structure and a vector of goal features, and returns the
+ * solution of the query with the same signature and the nearest features, to
+ * be used as initial values for Optimizer::optimize or Kinematics::inverse.
+ *
+ * Lookups are a linear scan over the entries of one signature, which is fast
+ * for the thousands of entries a planner accumulates. All methods can be
+ * called concurrently.
+ *
+ * The cache can be saved to and merged from a file, so that workers can share
+ * their solutions. The file is text, with values written at full precision;
+ * only double, Vector, Vector3, Vector6, Rot3 and Pose3 values are supported.
+ */
+class WarmStartCache {
+ public:
+  /**
+   * Constructor
+   * @param capacity maximum number of entries per signature, after which the
+   * oldest entry is dropped. Zero means unbounded.
+   */
+  explicit WarmStartCache(size_t capacity = 0) : capacity_(capacity) {}
+
+  /**
+   * Signature of a planning problem: the names of the links and joints of
+   * the robot and the number of steps of each phase.
+   */
+  static std::string Signature(const Robot &robot,
+                               const std::vector<int> &phase_steps = {});
+
+  /**
+   * Goal features of a graph: the target poses of Pose3 priors, as rotation
+   * vector and translation, and the goal points of PointGoalFactors, in the
+   * order of the graph. Graphs built the same way with different goals have
+   * features of the same size.
+   */
+  static gtsam::Vector GoalFeatures(const gtsam::NonlinearFactorGraph &graph);
+
+  /// Add the solution of a query.
+  void insert(const std::string &signature, const gtsam::Vector &features,
+              const gtsam::Values &solution);
+
+  /**
+   * Solution of the query with the given signature and the features nearest
+   * to `features`, in Euclidean distance, if any. Only entries with features
+   * of the same size are considered.
+   * @param[out] distance optional distance to the returned entry's features
+   */
+  boost::optional<gtsam::Values> nearest(const std::string &signature,
+                                         const gtsam::Vector &features,
+                                         double *distance = nullptr) const;
+
+  /// Total number of entries.
+  size_t size() const;
+
+  /// Write all entries to `filename`, replacing its contents.
+  void save(const std::string &filename) const;
+
+  /// Add the entries stored in `filename`, e.g. by another worker.
+  void load(const std::string &filename);
+
+ private:
+  struct Entry {
+    gtsam::Vector features;
+    gtsam::Values solution;
+  };
+
+  void insertLocked(const std::string &signature, Entry &&entry);
+
+  size_t capacity_;
+  std::map<std::string, std::deque<Entry>> entries_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace gtdynamics
@@ -0,0 +1,382 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WireFormat.cpp
+ * @brief Compact binary encodings for sending problems to solver workers.
+ */
+
+#include "gtdynamics/utils/WireFormat.h"
+
+#include <gtsam/base/GenericValue.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/linear/NoiseModel.h>
+
+#include <boost/make_shared.hpp>
+#include <cstring>
+#include <stdexcept>
+#include <typeinfo>
+
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/FootContactConstraintSpec.h"
+#include "gtdynamics/utils/WalkCycle.h"
+
+using gtsam::Key;
+using gtsam::Values;
+
+namespace gtdynamics {
+
+constexpr uint32_t ValuesView::kVersion;
+
+static const char kMagic[8] = "GTDVALS";
+static constexpr uint32_t kProblemVersion = 1;
+static constexpr size_t kHeaderSize = 16, kSectionSize = 16;
+static constexpr size_t kNumTypes = 5;  // the WireType values
+
+namespace {
+
+template <typename T>
+void Append(std::string *buffer, T x) {
+  buffer->append(reinterpret_cast<const char *>(&x), sizeof(T));
+}
+
+template <typename T>
+T Read(const char *data) {
+  T x;
+  std::memcpy(&x, data, sizeof(T));
+  return x;
+}
+
+uint32_t Width(WireType type) {
+  switch (type) {
+    case WireType::Double:
+      return 1;
+    case WireType::Vector3:
+      return 3;
+    case WireType::Vector6:
+      return 6;
+    case WireType::Rot3:
+      return 9;
+    case WireType::Pose3:
+      return 12;
+  }
+  throw std::invalid_argument("WireFormat: unknown type");
+}
+
+// Type of `value`, false if it is none of WireType.
+bool TypeOf(const gtsam::Value &value, WireType *type) {
+  const std::type_info &id = typeid(value);
+  if (id == typeid(gtsam::GenericValue<double>))
+    *type = WireType::Double;
+  else if (id == typeid(gtsam::GenericValue<gtsam::Vector3>))
+    *type = WireType::Vector3;
+  else if (id == typeid(gtsam::GenericValue<gtsam::Vector6>))
+    *type = WireType::Vector6;
+  else if (id == typeid(gtsam::GenericValue<gtsam::Rot3>))
+    *type = WireType::Rot3;
+  else if (id == typeid(gtsam::GenericValue<gtsam::Pose3>))
+    *type = WireType::Pose3;
+  else
+    return false;
+  return true;
+}
+
+// Append `value`, of `type`, to `out`.
+void Copy(const gtsam::Value &value, WireType type, std::vector<double> *out) {
+  const auto append = [out](const double *data, size_t n) {
+    out->insert(out->end(), data, data + n);
+  };
+  switch (type) {
+    case WireType::Double:
+      out->push_back(value.cast<double>());
+      break;
+    case WireType::Vector3:
+      append(value.cast<gtsam::Vector3>().data(), 3);
+      break;
+    case WireType::Vector6:
+      append(value.cast<gtsam::Vector6>().data(), 6);
+      break;
+    case WireType::Rot3:
+      append(value.cast<gtsam::Rot3>().matrix().data(), 9);
+      break;
+    case WireType::Pose3: {
+      const gtsam::Pose3 &T = value.cast<gtsam::Pose3>();
+      append(T.translation().data(), 3);
+      append(T.rotation().matrix().data(), 9);
+      break;
+    }
+  }
+}
+
+gtsam::Rot3 RotationAt(const double *data) {
+  return gtsam::Rot3(Eigen::Map<const gtsam::Matrix3>(data));
+}
+
+// Serialized fields of GaitProblem, with a bounds-checked reader.
+struct Reader {
+  const std::string &buffer;
+  size_t offset = 0;
+
+  template <typename T>
+  T get() {
+    if (offset + sizeof(T) > buffer.size())
+      throw std::runtime_error("GaitProblem: truncated buffer");
+    const T x = Read<T>(buffer.data() + offset);
+    offset += sizeof(T);
+    return x;
+  }
+  std::string string() {
+    const uint64_t n = get<uint64_t>();
+    if (offset + n > buffer.size())
+      throw std::runtime_error("GaitProblem: truncated buffer");
+    offset += n;
+    return buffer.substr(offset - n, n);
+  }
+  gtsam::Vector3 vector3() {
+    const double x = get<double>(), y = get<double>();
+    return gtsam::Vector3(x, y, get<double>());
+  }
+};
+
+void AppendString(std::string *buffer, const std::string &s) {
+  Append<uint64_t>(buffer, s.size());
+  buffer->append(s);
+}
+
+void AppendVector3(std::string *buffer, const gtsam::Vector3 &v) {
+  for (int i = 0; i < 3; ++i) Append<double>(buffer, v(i));
+}
+
+}  // namespace
+
+/* ************************************************************************* */
+std::string EncodeValues(const Values &values) {
+  // Bucket the values by type, in key order.
+  std::vector<std::vector<Key>> keys(kNumTypes);
+  std::vector<std::vector<double>> data(keys.size());
+  for (auto &&key_value : values) {
+    WireType type;
+    if (!TypeOf(key_value.value, &type))
+      throw std::invalid_argument("EncodeValues: unsupported type of " +
+                                  gtsam::DefaultKeyFormatter(key_value.key));
+    const size_t s = static_cast<size_t>(type);
+    keys[s].push_back(key_value.key);
+    Copy(key_value.value, type, &data[s]);
+  }
+
+  uint32_t num_sections = 0;
+  size_t size = kHeaderSize;
+  for (size_t s = 0; s < keys.size(); ++s) {
+    if (keys[s].empty()) continue;
+    ++num_sections;
+    size += kSectionSize + sizeof(uint64_t) * keys[s].size() +
+            sizeof(double) * data[s].size();
+  }
+  std::string buffer;
+  buffer.reserve(size);
+  buffer.append(kMagic, sizeof(kMagic));
+  Append<uint32_t>(&buffer, ValuesView::kVersion);
+  Append<uint32_t>(&buffer, num_sections);
+  for (size_t s = 0; s < keys.size(); ++s) {
+    if (keys[s].empty()) continue;
+    Append<uint32_t>(&buffer, s);
+    Append<uint32_t>(&buffer, Width(static_cast<WireType>(s)));
+    Append<uint64_t>(&buffer, keys[s].size());
+    buffer.append(reinterpret_cast<const char *>(keys[s].data()),
+                  sizeof(uint64_t) * keys[s].size());
+    buffer.append(reinterpret_cast<const char *>(data[s].data()),
+                  sizeof(double) * data[s].size());
+  }
+  return buffer;
+}
+
+/* ************************************************************************* */
+Values DecodeValues(const std::string &buffer) {
+  return ValuesView(buffer).toValues();
+}
+
+/* ************************************************************************* */
+ValuesView::ValuesView(const char *data, size_t size) {
+  if (size < kHeaderSize || std::memcmp(data, kMagic, sizeof(kMagic)) != 0)
+    throw std::runtime_error("ValuesView: not an encoded Values buffer");
+  if (Read<uint32_t>(data + 8) != kVersion)
+    throw std::runtime_error("ValuesView: unknown version");
+  const uint32_t num_sections = Read<uint32_t>(data + 12);
+  size_t offset = kHeaderSize;
+  for (uint32_t i = 0; i < num_sections; ++i) {
+    if (offset + kSectionSize > size)
+      throw std::runtime_error("ValuesView: truncated buffer");
+    Section section;
+    section.type = static_cast<WireType>(Read<uint32_t>(data + offset));
+    section.width = Read<uint32_t>(data + offset + 4);
+    section.count = Read<uint64_t>(data + offset + 8);
+    if (static_cast<uint32_t>(section.type) >= kNumTypes ||
+        section.width != Width(section.type))
+      throw std::runtime_error("ValuesView: unknown value type");
+    section.keys = data + offset + kSectionSize;
+    section.data = section.keys + sizeof(uint64_t) * section.count;
+    offset += kSectionSize +
+              (sizeof(uint64_t) + sizeof(double) * section.width) *
+                  section.count;
+    if (offset > size) throw std::runtime_error("ValuesView: truncated buffer");
+    sections_.push_back(section);
+  }
+}
+
+/* ************************************************************************* */
+const ValuesView::Section *ValuesView::section(WireType type) const {
+  for (auto &&section : sections_)
+    if (section.type == type) return &section;
+  return nullptr;
+}
+
+/* ************************************************************************* */
+size_t ValuesView::size(WireType type) const {
+  const Section *s = section(type);
+  return s ? s->count : 0;
+}
+
+/* ************************************************************************* */
+ValuesView::KeyMap ValuesView::keys(WireType type) const {
+  const Section *s = section(type);
+  if (!s) return KeyMap(nullptr, 0);
+  return KeyMap(reinterpret_cast<const uint64_t *>(s->keys), s->count);
+}
+
+/* ************************************************************************* */
+ValuesView::DataMap ValuesView::data(WireType type) const {
+  const Section *s = section(type);
+  if (!s) return DataMap(nullptr, 0, Width(type));
+  return DataMap(reinterpret_cast<const double *>(s->data), s->count,
+                 s->width);
+}
+
+/* ************************************************************************* */
+Values ValuesView::toValues() const {
+  Values values;
+  for (auto &&s : sections_) {
+    const KeyMap keys = this->keys(s.type);
+    const DataMap data = this->data(s.type);
+    for (size_t i = 0; i < s.count; ++i) {
+      const double *row = data.row(i).data();
+      switch (s.type) {
+        case WireType::Double:
+          values.insert(keys(i), *row);
+          break;
+        case WireType::Vector3:
+          values.insert(keys(i),
+                        gtsam::Vector3(Eigen::Map<const gtsam::Vector3>(row)));
+          break;
+        case WireType::Vector6:
+          values.insert(keys(i),
+                        gtsam::Vector6(Eigen::Map<const gtsam::Vector6>(row)));
+          break;
+        case WireType::Rot3:
+          values.insert(keys(i), RotationAt(row));
+          break;
+        case WireType::Pose3:
+          values.insert(keys(i),
+                        gtsam::Pose3(RotationAt(row + 3),
+                                     gtsam::Point3(row[0], row[1], row[2])));
+          break;
+      }
+    }
+  }
+  return values;
+}
+
+/* ************************************************************************* */
+Robot GaitProblem::robot() const {
+  return CreateRobotFromFile(model_file, model_name);
+}
+
+/* ************************************************************************* */
+Trajectory GaitProblem::trajectory(const Robot &robot) const {
+  FootContactVector states;
+  std::vector<size_t> phase_lengths;
+  for (auto &&phase : walk_cycle) {
+    std::vector<PointOnLink> points;
+    for (auto &&contact : phase.contacts)
+      points.emplace_back(robot.link(contact.first), contact.second);
+    states.push_back(boost::make_shared<FootContactConstraintSpec>(points));
+    phase_lengths.push_back(phase.num_time_steps);
+  }
+  return Trajectory(WalkCycle(states, phase_lengths), repeat);
+}
+
+/* ************************************************************************* */
+gtsam::NonlinearFactorGraph GaitProblem::graph(const Robot &robot) const {
+  const Trajectory trajectory = this->trajectory(robot);
+  const DynamicsGraph graph_builder(OptimizerSetting(sigma_dynamics), gravity);
+  gtsam::NonlinearFactorGraph graph =
+      trajectory.multiPhaseFactorGraph(robot, graph_builder, collocation, mu);
+  graph.add(trajectory.contactPointObjectives(
+      robot, gtsam::noiseModel::Isotropic::Sigma(3, sigma_contacts), step,
+      ground_height));
+  trajectory.addIntegrationTimeFactors(&graph, dt, 1e-30);
+  return graph;
+}
+
+/* ************************************************************************* */
+std::string GaitProblem::encode() const {
+  std::string buffer;
+  Append<uint32_t>(&buffer, kProblemVersion);
+  AppendString(&buffer, model_file);
+  AppendString(&buffer, model_name);
+  Append<uint64_t>(&buffer, walk_cycle.size());
+  for (auto &&phase : walk_cycle) {
+    Append<uint64_t>(&buffer, phase.num_time_steps);
+    Append<uint64_t>(&buffer, phase.contacts.size());
+    for (auto &&contact : phase.contacts) {
+      AppendString(&buffer, contact.first);
+      AppendVector3(&buffer, contact.second);
+    }
+  }
+  Append<uint64_t>(&buffer, repeat);
+  AppendVector3(&buffer, gravity);
+  Append<double>(&buffer, mu);
+  Append<double>(&buffer, sigma_dynamics);
+  Append<int32_t>(&buffer, collocation);
+  AppendVector3(&buffer, step);
+  Append<double>(&buffer, ground_height);
+  Append<double>(&buffer, sigma_contacts);
+  Append<double>(&buffer, dt);
+  return buffer;
+}
+
+/* ************************************************************************* */
+GaitProblem GaitProblem::Decode(const std::string &buffer) {
+  Reader in{buffer};
+  if (in.get<uint32_t>() != kProblemVersion)
+    throw std::runtime_error("GaitProblem: unknown version");
+  GaitProblem problem;
+  problem.model_file = in.string();
+  problem.model_name = in.string();
+  problem.walk_cycle.resize(in.get<uint64_t>());
+  for (auto &&phase : problem.walk_cycle) {
+    phase.num_time_steps = in.get<uint64_t>();
+    phase.contacts.resize(in.get<uint64_t>());
+    for (auto &&contact : phase.contacts) {
+      contact.first = in.string();
+      contact.second = in.vector3();
+    }
+  }
+  problem.repeat = in.get<uint64_t>();
+  problem.gravity = in.vector3();
+  problem.mu = in.get<double>();
+  problem.sigma_dynamics = in.get<double>();
+  problem.collocation = static_cast<CollocationScheme>(in.get<int32_t>());
+  problem.step = in.vector3();
+  problem.ground_height = in.get<double>();
+  problem.sigma_contacts = in.get<double>();
+  problem.dt = in.get<double>();
+  if (in.offset != buffer.size())
+    throw std::runtime_error("GaitProblem: trailing bytes in buffer");
+  return problem;
+}
+
+}  // namespace gtdynamics
@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  WireFormat.h
+ * @brief Compact binary encodings for sending problems to solver workers.
+ */
+
+#pragma once
+
+#include <gtsam/base/Matrix.h>
+#include <gtsam/geometry/Point3.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/utils/Trajectory.h"
+
+namespace gtdynamics {
+
+/// The value types of the Values wire format.
+enum class WireType : uint32_t { Double, Vector3, Vector6, Rot3, Pose3 };
+
+/**
+ * Encode `values` in a flat binary buffer: values of the same type are stored
+ * together, as an array of keys followed by an array of doubles, so encoding
+ * and decoding are memory copies without per-value headers.
+ *
+ *     header:   char[8] "GTDVALS", uint32 version, uint32 #sections
+ *     section:  uint32 type, uint32 width, uint64 #values,
+ *               uint64 keys[#values], double data[#values][width]
+ *
+ * Sections follow the order of WireType and empty ones are left out. Rot3 is
+ * stored as its rotation matrix and Pose3 as translation then rotation
+ * matrix, both in column-major order, as in TrajectoryFile. All numbers are
+ * in host byte order, for workers on the same architecture. Only the types
+ * in WireType are supported, others throw std::invalid_argument.
+ */
+std::string EncodeValues(const gtsam::Values &values);
+
+/// Decode a buffer written by EncodeValues, see ValuesView.
+gtsam::Values DecodeValues(const std::string &buffer);
+
+/**
+ * Zero-copy view of a buffer written by EncodeValues: keys and data are
+ * Eigen maps into the buffer, which has to outlive the view.
+ */
+class ValuesView {
+ public:
+  using KeyMap = Eigen::Map<const Eigen::Matrix<uint64_t, Eigen::Dynamic, 1>>;
+  using RowMajorMatrix =
+      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+  using DataMap = Eigen::Map<const RowMajorMatrix>;
+
+  static constexpr uint32_t kVersion = 1;
+
+  /// View `size` bytes at `data`, checking the header and sections.
+  ValuesView(const char *data, size_t size);
+
+  /// View a buffer held in a string.
+  explicit ValuesView(const std::string &buffer)
+      : ValuesView(buffer.data(), buffer.size()) {}
+
+  /// Number of values of `type`.
+  size_t size(WireType type) const;
+
+  /// Keys of the values of `type`.
+  KeyMap keys(WireType type) const;
+
+  /// Values of `type`, one row of width(type) doubles per key.
+  DataMap data(WireType type) const;
+
+  /// Copy into gtsam::Values.
+  gtsam::Values toValues() const;
+
+ private:
+  struct Section {
+    WireType type;
+    uint32_t width;
+    uint64_t count;
+    const char *keys, *data;
+  };
+
+  const Section *section(WireType type) const;
+
+  std::vector<Section> sections_;
+};
+
+/**
+ * The parameters of a gait optimization as in the spider walking example,
+ * small enough to send instead of the factor graph: workers load the robot
+ * and rebuild the graph locally. Most gtdynamics factors are expression
+ * factors, whose expressions are not serializable, so this is also the only
+ * way to ship them.
+ */
+struct GaitProblem {
+  /// Contact points on named links, active over a number of time steps.
+  struct PhaseSpec {
+    size_t num_time_steps;
+    std::vector<std::pair<std::string, gtsam::Point3>> contacts;
+  };
+
+  std::string model_file, model_name;  ///< robot, as in CreateRobotFromFile
+  std::vector<PhaseSpec> walk_cycle;   ///< phases of one cycle
+  size_t repeat = 1;                   ///< number of cycles
+  gtsam::Vector3 gravity = gtsam::Vector3(0, 0, -9.8);
+  double mu = 1.0;                    ///< coefficient of static friction
+  double sigma_dynamics = 1e-5;       ///< std of the dynamics constraints
+  CollocationScheme collocation = CollocationScheme::Euler;
+  gtsam::Point3 step = gtsam::Point3(0, 0.4, 0);  ///< step of the feet
+  double ground_height = 0;           ///< z of the ground at rest
+  double sigma_contacts = 1e-7;       ///< std of the contact goals
+  double dt = 1. / 240;               ///< desired integration time step
+
+  /// Load the robot.
+  Robot robot() const;
+
+  /// The trajectory of `repeat` walk cycles, with links of `robot`.
+  Trajectory trajectory(const Robot &robot) const;
+
+  /// Dynamics, contact point goals and integration time priors.
+  gtsam::NonlinearFactorGraph graph(const Robot &robot) const;
+
+  /// Encode in a few hundred bytes; host byte order, like EncodeValues.
+  std::string encode() const;
+
+  /// Decode a buffer written by encode(), throws std::runtime_error if bad.
+  static GaitProblem Decode(const std::string &buffer);
+};
+
+}  // namespace gtdynamics
@@ -16,6 +16,7 @@
 #include <gtdynamics/dynamics/DynamicsGraph.h>
 #include <gtdynamics/factors/MinTorqueFactor.h>
 #include <gtdynamics/universal_robot/Robot.h>
+#include <gtdynamics/utils/ThreadPool.h>
 #include <gtdynamics/utils/values.h>
 #include <gtsam/base/Value.h>
 #include <gtsam/base/Vector.h>
@@ -23,6 +24,9 @@
 #include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
 #include <gtsam/nonlinear/NonlinearFactorGraph.h>
 
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -230,11 +234,38 @@ Values InitializeSolutionInverseKinematics(
   return init_vals;
 }
 
+// Insert the values of steps 0, ..., n - 1 into `values`. With a pool,
+// contiguous ranges of steps are built concurrently into one Values per range,
+// which are then merged, so only a few containers are merged and the result
+// does not depend on scheduling. Each step seeds its own Sampler, so the
+// noise is the same with and without a pool.
+static void BuildSteps(size_t n,
+                       const std::function<void(size_t, Values*)>& build,
+                       ThreadPool* pool, Values* values) {
+  if (!pool || pool->numThreads() == 1 || n < 2) {
+    for (size_t k = 0; k < n; k++) build(k, values);
+    return;
+  }
+
+  const size_t num_ranges = std::min(n, 4 * pool->numThreads());
+  std::vector<Values> parts(num_ranges);
+  pool->parallelFor(num_ranges, [&](size_t r, size_t /*worker*/) {
+    for (size_t k = r * n / num_ranges; k < (r + 1) * n / num_ranges; k++)
+      build(k, &parts[r]);
+  });
+  for (auto&& part : parts) values->insert(part);
+}
+
+static void InsertZeroValues(
+    const Robot& robot, const int t, double gaussian_noise,
+    const boost::optional<PointOnLinks>& contact_points, Values* values);
+
 Values MultiPhaseZeroValuesTrajectory(
     const Robot& robot, const std::vector<int>& phase_steps,
     std::vector<Values> transition_graph_init, double dt_i,
     double gaussian_noise,
-    const boost::optional<std::vector<PointOnLinks>>& phase_contact_points) {
+    const boost::optional<std::vector<PointOnLinks>>& phase_contact_points,
+    ThreadPool* pool) {
   Values values;
   int num_phases = phase_steps.size();
 
@@ -245,24 +276,30 @@ Values MultiPhaseZeroValuesTrajectory(
     return boost::none;
   };
 
-  // First slice, k==0
-  values.insert(ZeroValues(robot, 0, gaussian_noise, contact_points(0)));
-
-  int k = 0;
+  // Phase of every step, and whether it is the transition out of that phase.
+  // The first slice, k==0, belongs to phase 0.
+  std::vector<int> phase_of_step = {0};
+  std::vector<bool> is_transition = {false};
   for (int p = 0; p < num_phases; p++) {
-    // in-phase
-    for (int step = 0; step < phase_steps[p] - 1; step++) {
-      values.insert(ZeroValues(robot, ++k, gaussian_noise, contact_points(p)));
-    }
-
-    if (p == num_phases - 1) {
-      values.insert(ZeroValues(robot, ++k, gaussian_noise, contact_points(p)));
-    } else {
-      values.insert(transition_graph_init[p]);
-      k++;
+    for (int step = 0; step < phase_steps[p]; step++) {
+      phase_of_step.push_back(p);
+      is_transition.push_back(step == phase_steps[p] - 1 &&
+                              p != num_phases - 1);
     }
   }
 
+  BuildSteps(
+      phase_of_step.size(),
+      [&](size_t k, Values* part) {
+        const int p = phase_of_step[k];
+        if (is_transition[k]) {
+          part->insert(transition_graph_init[p]);
+        } else {
+          InsertZeroValues(robot, k, gaussian_noise, contact_points(p), part);
+        }
+      },
+      pool, &values);
+
   for (int p = 0; p < num_phases; p++) {
     values.insert(PhaseKey(p), dt_i);
   }
@@ -338,10 +375,10 @@ Values MultiPhaseInverseKinematicsTrajectory(
   return init_vals;
 }
 
-Values ZeroValues(const Robot& robot, const int t, double gaussian_noise,
-                  const boost::optional<PointOnLinks>& contact_points) {
-  Values values;
-
+// Insert the zero values of step t into `values`, see ZeroValues.
+static void InsertZeroValues(
+    const Robot& robot, const int t, double gaussian_noise,
+    const boost::optional<PointOnLinks>& contact_points, Values* values) {
   auto sampler_noise_model =
       gtsam::noiseModel::Isotropic::Sigma(6, gaussian_noise);
   Sampler sampler(sampler_noise_model);
@@ -349,40 +386,49 @@ Values ZeroValues(const Robot& robot, const int t, double gaussian_noise,
   // Initialize link dynamics to 0.
   for (auto&& link : robot.links()) {
     int i = link->id();
-    InsertPose(&values, i, t, AddGaussianNoiseToPose(link->bMcom(), sampler));
-    InsertTwist(&values, i, t, sampler.sample());
-    InsertTwistAccel(&values, i, t, sampler.sample());
+    InsertPose(values, i, t, AddGaussianNoiseToPose(link->bMcom(), sampler));
+    InsertTwist(values, i, t, sampler.sample());
+    InsertTwistAccel(values, i, t, sampler.sample());
   }
 
   // Initialize joint kinematics/dynamics to 0.
   for (auto&& joint : robot.joints()) {
     int j = joint->id();
-    InsertWrench(&values, joint->parent()->id(), j, t, sampler.sample());
-    InsertWrench(&values, joint->child()->id(), j, t, sampler.sample());
+    InsertWrench(values, joint->parent()->id(), j, t, sampler.sample());
+    InsertWrench(values, joint->child()->id(), j, t, sampler.sample());
     std::vector<DynamicsSymbol> keys = {
         internal::TorqueKey(j, t), internal::JointAngleKey(j, t),
         internal::JointVelKey(j, t), internal::JointAccelKey(j, t)};
     for (size_t i = 0; i < keys.size(); i++)
-      values.insert(keys[i], sampler.sample()[0]);
+      values->insert(keys[i], sampler.sample()[0]);
   }
 
   if (contact_points) {
     for (auto&& cp : *contact_points) {
       // TODO(frank): allow multiple contact points on one link, id = 0,1,2...
-      values.insert(ContactWrenchKey(cp.link->id(), 0, t), sampler.sample());
+      values->insert(ContactWrenchKey(cp.link->id(), 0, t), sampler.sample());
     }
   }
+}
 
+Values ZeroValues(const Robot& robot, const int t, double gaussian_noise,
+                  const boost::optional<PointOnLinks>& contact_points) {
+  Values values;
+  InsertZeroValues(robot, t, gaussian_noise, contact_points, &values);
   return values;
 }
 
 Values ZeroValuesTrajectory(
     const Robot& robot, const int num_steps, const int num_phases,
-    double gaussian_noise,
-    const boost::optional<PointOnLinks>& contact_points) {
+    double gaussian_noise, const boost::optional<PointOnLinks>& contact_points,
+    ThreadPool* pool) {
   Values z_values;
-  for (int t = 0; t <= num_steps; t++)
-    z_values.insert(ZeroValues(robot, t, gaussian_noise, contact_points));
+  BuildSteps(
+      num_steps + 1,
+      [&](size_t t, Values* part) {
+        InsertZeroValues(robot, t, gaussian_noise, contact_points, part);
+      },
+      pool, &z_values);
   if (num_phases > 0) {
     for (int phase = 0; phase <= num_phases; phase++)
       z_values.insert(PhaseKey(phase), 0.0);
@@ -390,4 +436,117 @@ Values ZeroValuesTrajectory(
   return z_values;
 }
 
+// Pose and twist at step k of the first link with a pose at step 0 in
+// `values`, if any, from which forward kinematics then proceeds.
+static void InsertBase(const Robot& robot, const Values& values, int k,
+                       Values* known) {
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    if (!values.exists(internal::PoseKey(i, 0))) continue;
+    InsertPose(known, i, k, Pose(values, i, 0));
+    if (values.exists(internal::TwistKey(i, 0)))
+      InsertTwist(known, i, k, Twist(values, i, 0));
+    return;
+  }
+}
+
+// Zero contact wrenches and phase durations dt, as needed by the graph.
+static void InsertContactsAndPhases(
+    int num_steps, double dt, int num_phases,
+    const boost::optional<PointOnLinks>& contact_points, Values* values) {
+  if (contact_points) {
+    for (int k = 0; k <= num_steps; k++)
+      for (auto&& cp : *contact_points)
+        values->insert(ContactWrenchKey(cp.link->id(), 0, k),
+                       gtsam::Vector6::Zero().eval());
+  }
+  if (num_phases > 0) {
+    for (int phase = 0; phase <= num_phases; phase++)
+      values->insert(PhaseKey(phase), dt);
+  }
+}
+
+Values InitializeSolutionForwardSimulation(
+    const Robot& robot, const Values& initial_values, const Values& torques,
+    const int num_steps, double dt,
+    const boost::optional<gtsam::Vector3>& gravity,
+    const boost::optional<gtsam::Vector3>& planar_axis, const int num_phases,
+    const boost::optional<PointOnLinks>& contact_points) {
+  DynamicsGraph graph_builder(gravity, planar_axis);
+  std::map<int, double> q, v;
+  for (auto&& joint : robot.joints()) {
+    const int j = joint->id();
+    q[j] = JointAngle(initial_values, j, 0);
+    v[j] = JointVel(initial_values, j, 0);
+  }
+
+  Values values;
+  for (int k = 0; k <= num_steps; k++) {
+    Values known;
+    InsertBase(robot, initial_values, k, &known);
+    for (auto&& joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&known, j, k, q[j]);
+      InsertJointVel(&known, j, k, v[j]);
+    }
+    known = robot.forwardKinematics(known, k);
+    for (auto&& joint : robot.joints()) {
+      const int j = joint->id();
+      const gtsam::Key key = internal::TorqueKey(j, k);
+      InsertTorque(&known, j, k, torques.exists(key) ? torques.atDouble(key)
+                                                     : 0.0);
+    }
+    const Values step = graph_builder.linearSolveFD(robot, k, known);
+    values.insert(step);
+
+    for (auto&& joint : robot.joints()) {
+      const int j = joint->id();
+      q[j] += dt * v[j];
+      v[j] += dt * JointAccel(step, j, k);
+    }
+  }
+  InsertContactsAndPhases(num_steps, dt, num_phases, contact_points, &values);
+  return values;
+}
+
+Values InitializeSolutionInverseDynamics(
+    const Robot& robot, const Values& joint_angles, const int num_steps,
+    double dt, const boost::optional<gtsam::Vector3>& gravity,
+    const boost::optional<gtsam::Vector3>& planar_axis, const int num_phases,
+    const boost::optional<PointOnLinks>& contact_points) {
+  DynamicsGraph graph_builder(gravity, planar_axis);
+
+  // Finite differences, with constant velocity in the last step.
+  const auto angle = [&](int j, int k) {
+    return JointAngle(joint_angles, j, k);
+  };
+  const auto velocity = [&](int j, int k) {
+    if (num_steps == 0) return 0.0;
+    k = std::min(k, num_steps - 1);
+    return (angle(j, k + 1) - angle(j, k)) / dt;
+  };
+
+  Values values;
+  for (int k = 0; k <= num_steps; k++) {
+    Values known;
+    InsertBase(robot, joint_angles, k, &known);
+    for (auto&& joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&known, j, k, angle(j, k));
+      InsertJointVel(&known, j, k, velocity(j, k));
+    }
+    known = robot.forwardKinematics(known, k);
+    for (auto&& joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAccel(&known, j, k,
+                       k < num_steps
+                           ? (velocity(j, k + 1) - velocity(j, k)) / dt
+                           : 0.0);
+    }
+    values.insert(graph_builder.linearSolveID(robot, k, known));
+  }
+  InsertContactsAndPhases(num_steps, dt, num_phases, contact_points, &values);
+  return values;
+}
+
 }  // namespace gtdynamics
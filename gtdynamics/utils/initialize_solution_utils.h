@@ -144,13 +144,15 @@ gtsam::Values InitializeSolutionInverseKinematics(
  * @param[in] dt_i                  Initial phase duration,
  * @param[in] gaussian_noise  Optional gaussian noise to add to initial values.
  * @param[in] phase_contact_points  Contact points at each phase.
+ * @param[in] pool            Optional thread pool to build time steps on.
  */
 gtsam::Values MultiPhaseZeroValuesTrajectory(
     const Robot& robot, const std::vector<int>& phase_steps,
     std::vector<gtsam::Values> transition_graph_init, double dt_i = 1. / 240,
     const double gaussian_noise = 1e-8,
     const boost::optional<std::vector<PointOnLinks>>& phase_contact_points =
-        boost::none);
+        boost::none,
+    ThreadPool* pool = nullptr);
 
 /**
  * @fn Multi-phase initialize solution inverse kinematics.
@@ -204,11 +206,77 @@ gtsam::Values ZeroValues(
  *      Noise drawn from a zero-mean gaussian distribution with a standard
  *      deviation of gaussian_noise.
  * @param[in] contact_points Contact points along the trajectory.
+ * @param[in] pool           Optional thread pool to build time steps on.
  * @return Initial solution stored in a gtsam::Values object.
  */
 gtsam::Values ZeroValuesTrajectory(
     const Robot& robot, const int num_steps, const int num_phases = -1,
     double gaussian_noise = 0.0,
+    const boost::optional<PointOnLinks>& contact_points = boost::none,
+    ThreadPool* pool = nullptr);
+
+/**
+ * @fn Initialize a trajectory consistently with the dynamics, by forward
+ * simulation under given torques.
+ *
+ * Starting from the joint angles and velocities at time step 0 in
+ * `initial_values`, every step k solves forward dynamics under the torques of
+ * step k, which gives the link poses, twists and accelerations and the joint
+ * accelerations and wrenches, and then integrates q_{k+1} = q_k + dt v_k and
+ * v_{k+1} = v_k + dt a_k. All dynamics and Euler collocation factors hence
+ * hold at the returned values. The pose and twist of the base link are kept
+ * as given in `initial_values` (or the fixed link pose), as in Simulator.
+ *
+ * @param[in] robot          A Robot object.
+ * @param[in] initial_values Joint angles and velocities at time step 0, and
+ *                           optionally the base pose and twist.
+ * @param[in] torques        Torques of each step 0..num_steps, missing
+ *                           torques are taken as zero.
+ * @param[in] num_steps      Total number of time steps.
+ * @param[in] dt             The duration of a single timestep.
+ * @param[in] gravity        Gravity vector, if any.
+ * @param[in] planar_axis    Planar axis, if any.
+ * @param[in] num_phases     Number of phases, -1 if not using; phase
+ *                           durations are initialized to dt.
+ * @param[in] contact_points Contact points, whose wrenches are set to zero.
+ * @return Initial solution stored in a gtsam::Values object.
+ */
+gtsam::Values InitializeSolutionForwardSimulation(
+    const Robot& robot, const gtsam::Values& initial_values,
+    const gtsam::Values& torques, const int num_steps, double dt,
+    const boost::optional<gtsam::Vector3>& gravity = boost::none,
+    const boost::optional<gtsam::Vector3>& planar_axis = boost::none,
+    const int num_phases = -1,
+    const boost::optional<PointOnLinks>& contact_points = boost::none);
+
+/**
+ * @fn Initialize a trajectory consistently with the dynamics, by inverse
+ * dynamics along a kinematic profile.
+ *
+ * Joint velocities and accelerations are finite differences of the given
+ * joint angles, v_k = (q_{k+1} - q_k) / dt and a_k = (v_{k+1} - v_k) / dt,
+ * with the last step moving at constant velocity, so that Euler collocation
+ * holds. Every step then solves inverse dynamics for the torques, wrenches
+ * and link accelerations, with the base as in
+ * InitializeSolutionForwardSimulation.
+ *
+ * @param[in] robot          A Robot object.
+ * @param[in] joint_angles   Joint angles of each step 0..num_steps, and
+ *                           optionally the base pose and twist at step 0.
+ * @param[in] num_steps      Total number of time steps.
+ * @param[in] dt             The duration of a single timestep.
+ * @param[in] gravity        Gravity vector, if any.
+ * @param[in] planar_axis    Planar axis, if any.
+ * @param[in] num_phases     Number of phases, -1 if not using.
+ * @param[in] contact_points Contact points, whose wrenches are set to zero.
+ * @return Initial solution stored in a gtsam::Values object.
+ */
+gtsam::Values InitializeSolutionInverseDynamics(
+    const Robot& robot, const gtsam::Values& joint_angles,
+    const int num_steps, double dt,
+    const boost::optional<gtsam::Vector3>& gravity = boost::none,
+    const boost::optional<gtsam::Vector3>& planar_axis = boost::none,
+    const int num_phases = -1,
     const boost::optional<PointOnLinks>& contact_points = boost::none);
 
 }  // namespace gtdynamics
@@ -124,7 +124,7 @@ std::vector<gtsam::Pose3> square(int numOfWayPoints, double goalAngle,
 
 /**
  * Read a variable from a text file, and save to vector of matrix.
- * This is used for SDF.
+ * This is used for SDF. For large matrices, see ReadMatrixFile.
  */
 std::vector<gtsam::Matrix> readFromTxt(std::string mat_dir,
                                        gtsam::Point3 &origin,  // NOLINT
@@ -40,43 +40,43 @@ class KeyDoesNotExist : public gtsam::ValuesKeyDoesNotExist {
  ************************************************************************* */
 namespace internal {
 /// Shorthand for q_j_t, for j-th joint angle at time t.
-inline DynamicsSymbol JointAngleKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("q", j, t);
+constexpr DynamicsSymbol JointAngleKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol('q', j, t);
 }
 
 /// Shorthand for v_j_t, for j-th joint velocity at time t.
-inline DynamicsSymbol JointVelKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("v", j, t);
+constexpr DynamicsSymbol JointVelKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol('v', j, t);
 }
 
 /// Shorthand for a_j_t, for j-th joint acceleration at time t.
-inline DynamicsSymbol JointAccelKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("a", j, t);
+constexpr DynamicsSymbol JointAccelKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol('a', j, t);
 }
 
 /// Shorthand for T_j_t, for torque on the j-th joint at time t.
-inline DynamicsSymbol TorqueKey(int j, int t = 0) {
-  return DynamicsSymbol::JointSymbol("T", j, t);
+constexpr DynamicsSymbol TorqueKey(int j, int t = 0) {
+  return DynamicsSymbol::JointSymbol('T', j, t);
 }
 
 /// Shorthand for p_i_t, for COM pose on the i-th link at time t.
-inline DynamicsSymbol PoseKey(int i, int t = 0) {
-  return DynamicsSymbol::LinkSymbol("p", i, t);
+constexpr DynamicsSymbol PoseKey(int i, int t = 0) {
+  return DynamicsSymbol::LinkSymbol('p', i, t);
 }
 
 /// Shorthand for V_i_t, for 6D link twist vector on the i-th link.
-inline DynamicsSymbol TwistKey(int i, int t = 0) {
-  return DynamicsSymbol::LinkSymbol("V", i, t);
+constexpr DynamicsSymbol TwistKey(int i, int t = 0) {
+  return DynamicsSymbol::LinkSymbol('V', i, t);
 }
 
 /// Shorthand for A_i_t, for twist accelerations on the i-th link at time t.
-inline DynamicsSymbol TwistAccelKey(int i, int t = 0) {
-  return DynamicsSymbol::LinkSymbol("A", i, t);
+constexpr DynamicsSymbol TwistAccelKey(int i, int t = 0) {
+  return DynamicsSymbol::LinkSymbol('A', i, t);
 }
 
 /// Shorthand for F_i_j_t, wrenches at j-th joint on the i-th link at time t.
-inline DynamicsSymbol WrenchKey(int i, int j, int t = 0) {
-  return DynamicsSymbol::LinkJointSymbol("F", i, j, t);
+constexpr DynamicsSymbol WrenchKey(int i, int j, int t = 0) {
+  return DynamicsSymbol::LinkJointSymbol('F', i, j, t);
 }
 
 /// Custom retrieval that throws KeyDoesNotExist
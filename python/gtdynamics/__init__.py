@@ -2,7 +2,7 @@ import gtsam
 
 from gtdynamics.gtdynamics import *
 
-from . import sim
+from . import futures, sharing, sim, trajectory_file
 
 
 class _GtdKeyFormatter(object):
@@ -11,8 +11,26 @@ class _GtdKeyFormatter(object):
         return GtdFormat(self)
 
 
+def _decode_values(buffer):
+    """Unpickle Values pickled in the wire format."""
+    return Values(DecodeValues(buffer))
+
+
+def _deserialize_values(serialized):
+    """Unpickle Values pickled with the text archive."""
+    values = Values()
+    values.deserialize(serialized)
+    return values
+
+
 class Values(_GtdKeyFormatter, gtsam.Values):
-    pass
+    def __reduce__(self):
+        """Pickle in the binary wire format of EncodeValues, falling back to
+        the text archive of gtsam for other value types."""
+        try:
+            return (_decode_values, (EncodeValues(self), ))
+        except ValueError:
+            return (_deserialize_values, (self.serialize(), ))
 
 
 class NonlinearFactorGraph(_GtdKeyFormatter, gtsam.NonlinearFactorGraph):
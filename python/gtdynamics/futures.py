@@ -0,0 +1,63 @@
+"""Run GTDynamics solves asynchronously on a shared thread pool.
+
+The compute-heavy wrapped calls (Optimizer.optimize, Kinematics.inverse and
+interpolate, DynamicsGraph.linearSolveFD/ID and Simulator.simulate) release
+the GIL, so solves submitted here run concurrently with each other and with
+the calling thread.
+"""
+
+import os
+import threading
+from concurrent.futures import Future, ThreadPoolExecutor
+from typing import Callable, Iterable, List, Optional
+
+_executor: Optional[ThreadPoolExecutor] = None
+_lock = threading.Lock()
+
+
+def set_max_workers(max_workers: int):
+    """Replace the shared pool by one with `max_workers` threads."""
+    global _executor
+    with _lock:
+        if _executor is not None:
+            _executor.shutdown(wait=False)
+        _executor = ThreadPoolExecutor(max_workers=max_workers)
+
+
+def executor() -> ThreadPoolExecutor:
+    """Return the shared pool, with a thread per core by default."""
+    global _executor
+    with _lock:
+        if _executor is None:
+            _executor = ThreadPoolExecutor(max_workers=os.cpu_count())
+        return _executor
+
+
+def submit(fn: Callable, *args, **kwargs) -> Future:
+    """Run fn(*args, **kwargs) on the shared pool."""
+    return executor().submit(fn, *args, **kwargs)
+
+
+def map_async(fn: Callable, *iterables: Iterable) -> List[Future]:
+    """Submit fn for each tuple of arguments, e.g. one solve per robot."""
+    return [submit(fn, *args) for args in zip(*iterables)]
+
+
+def optimize_async(optimizer, graph, initial_values) -> Future:
+    """Future of optimizer.optimize(graph, initial_values)."""
+    return submit(optimizer.optimize, graph, initial_values)
+
+
+def inverse_async(kinematics, context, robot, contact_goals) -> Future:
+    """Future of kinematics.inverse(context, robot, contact_goals)."""
+    return submit(kinematics.inverse, context, robot, contact_goals)
+
+
+def linear_solve_fd_async(graph_builder, robot, t, known_values) -> Future:
+    """Future of graph_builder.linearSolveFD(robot, t, known_values)."""
+    return submit(graph_builder.linearSolveFD, robot, t, known_values)
+
+
+def linear_solve_id_async(graph_builder, robot, t, known_values) -> Future:
+    """Future of graph_builder.linearSolveID(robot, t, known_values)."""
+    return submit(graph_builder.linearSolveID, robot, t, known_values)
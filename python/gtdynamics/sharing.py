@@ -0,0 +1,63 @@
+"""Hand large Values to multiprocessing workers through shared memory.
+
+Robots and Values pickle in binary, see EncodeRobot and EncodeValues, which
+is enough for most payloads. A large Values sent to many workers, e.g. the
+initial values of a long trajectory in a parameter sweep, is better encoded
+once into a shared memory block: SharedValues pickles as the name of the
+block, and each worker decodes straight from the shared pages.
+
+Factor graphs of gtdynamics mostly hold expression factors, which cannot be
+serialized; send the robot and the problem parameters instead, and build the
+graph in the worker.
+"""
+
+from multiprocessing import shared_memory
+
+import gtdynamics.gtdynamics as _gtd
+
+
+class SharedValues:
+    """Values encoded in a shared memory block.
+
+    The process that creates it owns the block and should close() it, or use
+    it as a context manager, once the workers are done; copies unpickled in
+    workers only attach to the block in load().
+    """
+    def __init__(self, values):
+        buffer = _gtd.EncodeValues(values)
+        self.size = len(buffer)
+        self._shm = shared_memory.SharedMemory(create=True,
+                                               size=max(self.size, 1))
+        self._shm.buf[:self.size] = buffer
+        self.name = self._shm.name
+
+    def __getstate__(self):
+        return (self.name, self.size)
+
+    def __setstate__(self, state):
+        self.name, self.size = state
+        self._shm = None
+
+    def load(self):
+        """Decode the Values, in any process."""
+        from gtdynamics import Values  # pylint: disable=import-outside-toplevel
+        shm = self._shm or shared_memory.SharedMemory(name=self.name)
+        try:
+            with shm.buf[:self.size] as view:
+                return Values(_gtd.DecodeValues(view))
+        finally:
+            if shm is not self._shm:
+                shm.close()
+
+    def close(self):
+        """Release the block, in the process that created it."""
+        if self._shm is not None:
+            self._shm.close()
+            self._shm.unlink()
+            self._shm = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
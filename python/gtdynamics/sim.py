@@ -2,7 +2,9 @@
 
 #pylint: disable=c-extension-no-member
 
-from typing import Dict
+from typing import Dict, Optional, Sequence
+
+import numpy as np
 
 
 def set_joint_angles(pyb,
@@ -17,20 +19,143 @@ def set_joint_angles(pyb,
     Args:
         pyb: Pybullet module.
         robot: Robot ID
-        joint_id: Joint ID on the robot.
-        joint_angle: Angle of the joint to set.
-        joint_velocity: Velocity of the joint to set.
+        joint_to_jid_map: PyBullet joint index of each joint name.
+        joint_angles: Angle of each joint to set.
+        joint_velocities: Velocity of each joint, keyed by name + '.1'.
+        force: Maximum force of the velocity motors of the other joints.
     """
-    for joint_id in joint_to_jid_map.values():
-        pyb.setJointMotorControl2(bodyUniqueId=robot,
-                                  jointindex=joint_id,
+    indices = list(joint_to_jid_map.values())
+    pyb.setJointMotorControlArray(bodyUniqueId=robot,
+                                  jointIndices=indices,
                                   controlMode=pyb.VELOCITY_CONTROL,
-                                  force=force)
-
-    for joint, angle in joint_angles.items():
-        target_velocity = joint_velocities.get(joint + '.1', 0.0)
-        pyb.setJointMotorControl2(bodyUniqueId=robot,
-                                  jointIndex=joint_to_jid_map[joint],
-                                  controlMode=pyb.POSITION_CONTROL,
-                                  targetPosition=angle,
-                                  targetVelocity=target_velocity)
+                                  forces=[force] * len(indices))
+
+    names = list(joint_angles.keys())
+    pyb.setJointMotorControlArray(
+        bodyUniqueId=robot,
+        jointIndices=[joint_to_jid_map[joint] for joint in names],
+        controlMode=pyb.POSITION_CONTROL,
+        targetPositions=[joint_angles[joint] for joint in names],
+        targetVelocities=[
+            joint_velocities.get(joint + '.1', 0.0) for joint in names
+        ])
+
+
+class PyBulletBridge:
+    """
+    Bridge between a gtdynamics Robot and a PyBullet body: joints are matched
+    by name once, and states and commands are exchanged as joint-id indexed
+    arrays, the layout of Simulator.jointAngles(), with one PyBullet call per
+    direction rather than one per joint.
+    """
+
+    def __init__(self, pyb, body: int, robot):
+        """
+        Args:
+            pyb: Pybullet module, or a connected bullet_client.
+            body: PyBullet id of the body loaded from the same model.
+            robot: gtdynamics Robot.
+        """
+        self.pyb = pyb
+        self.body = body
+        index_of = {}
+        for index in range(pyb.getNumJoints(body)):
+            name = pyb.getJointInfo(body, index)[1]
+            if isinstance(name, bytes):
+                name = name.decode()
+            index_of[name] = index
+
+        joints = [j for j in robot.joints() if j.name() in index_of]
+        if not joints:
+            raise ValueError("PyBulletBridge: no joint names in common")
+        self.joint_ids = np.array([j.id() for j in joints], dtype=int)
+        self.indices = [index_of[j.name()] for j in joints]
+        self.num_slots = max(j.id() for j in robot.joints()) + 1
+        self._torque_control = False
+
+    def read_state(self):
+        """Joint angles and velocities of the body, joint-id indexed."""
+        states = self.pyb.getJointStates(self.body, self.indices)
+        q = np.zeros(self.num_slots)
+        v = np.zeros(self.num_slots)
+        q[self.joint_ids] = [state[0] for state in states]
+        v[self.joint_ids] = [state[1] for state in states]
+        return q, v
+
+    def reset_state(self, q: np.ndarray, v: Optional[np.ndarray] = None):
+        """Teleport the body to joint-id indexed angles and velocities."""
+        v = np.zeros(self.num_slots) if v is None else v
+        self.pyb.resetJointStatesMultiDof(
+            self.body,
+            self.indices,
+            targetValues=[[x] for x in q[self.joint_ids]],
+            targetVelocities=[[x] for x in v[self.joint_ids]])
+
+    def set_positions(self,
+                      q: np.ndarray,
+                      v: Optional[np.ndarray] = None,
+                      force: float = 500):
+        """Track joint-id indexed angles and velocities with PD control."""
+        v = np.zeros(self.num_slots) if v is None else v
+        self._torque_control = False
+        self.pyb.setJointMotorControlArray(
+            bodyUniqueId=self.body,
+            jointIndices=self.indices,
+            controlMode=self.pyb.POSITION_CONTROL,
+            targetPositions=q[self.joint_ids].tolist(),
+            targetVelocities=v[self.joint_ids].tolist(),
+            forces=[force] * len(self.indices))
+
+    def set_torques(self, tau: np.ndarray):
+        """Apply joint-id indexed torques until the next command."""
+        if not self._torque_control:
+            # The default velocity motors would fight the torques.
+            self.pyb.setJointMotorControlArray(
+                bodyUniqueId=self.body,
+                jointIndices=self.indices,
+                controlMode=self.pyb.VELOCITY_CONTROL,
+                forces=[0.0] * len(self.indices))
+            self._torque_control = True
+        self.pyb.setJointMotorControlArray(
+            bodyUniqueId=self.body,
+            jointIndices=self.indices,
+            controlMode=self.pyb.TORQUE_CONTROL,
+            forces=tau[self.joint_ids].tolist())
+
+    def lockstep(self,
+                 simulator,
+                 torques: Sequence[np.ndarray],
+                 dt: float,
+                 resync: bool = False):
+        """
+        Step a gtdynamics Simulator, which needs the ArticulatedBody method,
+        and PyBullet side by side with the same joint-id indexed torques.
+
+        Args:
+            simulator: Simulator of the same robot, in the state of the body.
+            torques: Torques of every step.
+            dt: Time step, also set on PyBullet.
+            resync: Restart the simulator from the PyBullet state after every
+                step, so that the errors are those of a single step.
+        Returns:
+            Dict of #steps x #joint slots arrays: "q" and "v" of the
+            simulator and "bullet_q" and "bullet_v" of PyBullet, after each
+            step.
+        """
+        self.pyb.setTimeStep(dt)
+        num_steps = len(torques)
+        shape = (num_steps, self.num_slots)
+        result = {key: np.zeros(shape)
+                  for key in ("q", "v", "bullet_q", "bullet_v")}
+        for k, tau in enumerate(torques):
+            tau = np.asarray(tau, dtype=float)
+            simulator.step(tau, dt)
+            self.set_torques(tau)
+            self.pyb.stepSimulation()
+            result["q"][k] = simulator.jointAngles()
+            result["v"][k] = simulator.jointVels()
+            result["bullet_q"][k], result["bullet_v"][k] = self.read_state()
+            if resync:
+                simulator.setState(result["bullet_q"][k],
+                                   result["bullet_v"][k])
+        return result
@@ -0,0 +1,66 @@
+"""Read trajectories saved by DynamicsGraph.saveTrajectory without copying.
+
+The file is memory-mapped and every quantity is returned as a numpy view of
+shape (num_steps, num_entities, width), see gtdynamics/utils/TrajectoryFile.h
+for the format. Slicing the views by time step or entity does not copy.
+"""
+
+import struct
+from typing import Dict, List
+
+import numpy as np
+
+MAGIC = b"GTDTRAJ\0"
+VERSION = 1
+_HEADER = struct.Struct("=8sIIQ")
+_ENTRY = struct.Struct("=16sQQQQ")
+
+
+class TrajectoryFile:
+    """Memory-mapped trajectory file."""
+
+    def __init__(self, path: str):
+        self._map = np.memmap(path, dtype=np.uint8, mode="r")
+        if len(self._map) < _HEADER.size:
+            raise ValueError(f"{path} is not a trajectory file")
+        magic, version, num_quantities, self.num_steps = _HEADER.unpack(
+            self._map[:_HEADER.size].tobytes())
+        if magic != MAGIC:
+            raise ValueError(f"{path} is not a trajectory file")
+        if version != VERSION:
+            raise ValueError(f"{path} has unknown version {version}")
+
+        self._ids: Dict[str, np.ndarray] = {}
+        self._data: Dict[str, np.ndarray] = {}
+        for i in range(num_quantities):
+            begin = _HEADER.size + _ENTRY.size * i
+            name, num_entities, width, ids_offset, data_offset = \
+                _ENTRY.unpack(self._map[begin:begin + _ENTRY.size].tobytes())
+            name = name.rstrip(b"\0").decode()
+            self._ids[name] = self._map[ids_offset:ids_offset +
+                                        4 * num_entities].view(np.int32)
+            size = 8 * self.num_steps * num_entities * width
+            self._data[name] = self._map[data_offset:data_offset +
+                                         size].view(np.float64).reshape(
+                                             self.num_steps, num_entities,
+                                             width)
+
+    def quantities(self) -> List[str]:
+        """Names of the stored quantities, in file order."""
+        return list(self._data)
+
+    def ids(self, quantity: str) -> np.ndarray:
+        """Joint or link ids of the entities of `quantity`."""
+        return self._ids[quantity]
+
+    def __getitem__(self, quantity: str) -> np.ndarray:
+        """View of shape (num_steps, num_entities, width) of `quantity`."""
+        return self._data[quantity]
+
+    def entity(self, quantity: str, id: int) -> np.ndarray:
+        """View of shape (num_steps, width) of entity `id` of `quantity`."""
+        # pylint: disable=redefined-builtin
+        index = np.flatnonzero(self._ids[quantity] == id)
+        if len(index) == 0:
+            raise KeyError(f"no entity {id} in {quantity}")
+        return self._data[quantity][:, index[0], :]
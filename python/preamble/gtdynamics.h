@@ -1,3 +1,7 @@
+// Binary encodings of the pickling in specializations/gtdynamics.h.
+#include <gtdynamics/universal_robot/RobotCache.h>
+#include <gtdynamics/utils/WireFormat.h>
+
 namespace pybind11 { namespace detail {
     template <typename T>
     struct type_caster<boost::optional<T>> : optional_caster<boost::optional<T>> {};
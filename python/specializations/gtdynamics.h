@@ -2,3 +2,194 @@
 // These are required to save one copy operation on Python calls
 py::bind_vector<gtdynamics::PointOnLinks>(m_, "PointOnLinks");
 py::bind_map<gtdynamics::ContactPointGoals>(m_, "ContactPointGoals");
+
+// Zero-copy views of the dense buffers of DynamicsValues: the numpy arrays are
+// read-only, share memory with the C++ object and keep it alive, and see
+// later changes to it, e.g. by assign(). Joint quantities are
+// #joint slots x #steps, twists 6 x (#steps * #link slots).
+{
+  using gtdynamics::DynamicsQuantity;
+  using gtdynamics::DynamicsValues;
+  auto dynamics_values =
+      py::reinterpret_borrow<py::class_<DynamicsValues>>(
+          m_.attr("DynamicsValues"));
+  const auto view = py::return_value_policy::reference_internal;
+  dynamics_values
+      .def("jointAngles",
+           [](const DynamicsValues &self) -> const gtsam::Matrix & {
+             return self.joints(DynamicsQuantity::JointAngle);
+           },
+           view)
+      .def("jointVels",
+           [](const DynamicsValues &self) -> const gtsam::Matrix & {
+             return self.joints(DynamicsQuantity::JointVel);
+           },
+           view)
+      .def("jointAccels",
+           [](const DynamicsValues &self) -> const gtsam::Matrix & {
+             return self.joints(DynamicsQuantity::JointAccel);
+           },
+           view)
+      .def("torques",
+           [](const DynamicsValues &self) -> const gtsam::Matrix & {
+             return self.joints(DynamicsQuantity::Torque);
+           },
+           view)
+      .def("twists", &DynamicsValues::twists, view)
+      .def("twistAccels", &DynamicsValues::twistAccels, view);
+}
+
+// Release the GIL in the compute-heavy entry points, so that solves started
+// from several Python threads run concurrently, see gtdynamics.futures. The
+// arguments are converted before the GIL is released; they should not be
+// modified from Python while a call is running. py::prepend puts these
+// overloads before the wrapped ones with the same signatures.
+{
+  using gtdynamics::Robot;
+  using gtsam::Values;
+  const auto release = py::call_guard<py::gil_scoped_release>();
+
+  py::reinterpret_borrow<py::class_<gtdynamics::Optimizer>>(
+      m_.attr("Optimizer"))
+      .def("optimize",
+           [](const gtdynamics::Optimizer &self,
+              const gtsam::NonlinearFactorGraph &graph,
+              const Values &initial_values) {
+             return self.optimize(graph, initial_values);
+           },
+           py::prepend(), release);
+
+  py::reinterpret_borrow<py::class_<gtdynamics::Kinematics>>(
+      m_.attr("Kinematics"))
+      .def("inverse",
+           [](const gtdynamics::Kinematics &self,
+              const gtdynamics::Slice &slice, const Robot &robot,
+              const gtdynamics::ContactGoals &contact_goals) {
+             return self.inverse(slice, robot, contact_goals);
+           },
+           py::prepend(), release)
+      .def("inverse",
+           [](const gtdynamics::Kinematics &self,
+              const gtdynamics::Interval &interval, const Robot &robot,
+              const gtdynamics::ContactGoals &contact_goals) {
+             return self.inverse(interval, robot, contact_goals);
+           },
+           py::prepend(), release)
+      .def("interpolate",
+           [](const gtdynamics::Kinematics &self,
+              const gtdynamics::Interval &interval, const Robot &robot,
+              const gtdynamics::ContactGoals &contact_goals1,
+              const gtdynamics::ContactGoals &contact_goals2) {
+             return self.interpolate(interval, robot, contact_goals1,
+                                     contact_goals2);
+           },
+           py::prepend(), release);
+
+  py::reinterpret_borrow<py::class_<gtdynamics::DynamicsGraph>>(
+      m_.attr("DynamicsGraph"))
+      .def("linearSolveFD",
+           [](gtdynamics::DynamicsGraph &self, const Robot &robot, int t,
+              const Values &known_values) {
+             return self.linearSolveFD(robot, t, known_values);
+           },
+           py::prepend(), release)
+      .def("linearSolveID",
+           [](gtdynamics::DynamicsGraph &self, const Robot &robot, int t,
+              const Values &known_values) {
+             return self.linearSolveID(robot, t, known_values);
+           },
+           py::prepend(), release);
+
+  py::reinterpret_borrow<py::class_<gtdynamics::Simulator>>(
+      m_.attr("Simulator"))
+      .def("simulate",
+           [](gtdynamics::Simulator &self,
+              const std::vector<Values> &torques_seq, double dt) {
+             return self.simulate(torques_seq, dt);
+           },
+           py::prepend(), release);
+
+  // Batch entry points for sweeps: numpy arrays in and out, one call for all
+  // configurations, run over the thread pool of the instance. The instance
+  // owns the per-thread buffers, so use one per Python thread.
+  using gtsam::Matrix;
+  py::reinterpret_borrow<py::class_<gtdynamics::BatchForwardKinematics>>(
+      m_.attr("BatchForwardKinematics"))
+      .def("compute",
+           [](gtdynamics::BatchForwardKinematics &self,
+              const Matrix &configurations) {
+             return self.compute(configurations);
+           },
+           py::prepend(), release);
+
+  py::reinterpret_borrow<py::class_<gtdynamics::BatchInverseDynamics>>(
+      m_.attr("BatchInverseDynamics"))
+      .def("solve",
+           [](gtdynamics::BatchInverseDynamics &self, const Matrix &Q,
+              const Matrix &V, const Matrix &A, bool wrenches) {
+             return self.solve(Q, V, A, wrenches);
+           },
+           py::arg("Q"), py::arg("V"), py::arg("A"),
+           py::arg("wrenches") = true, py::prepend(), release)
+      .def("torques",
+           [](gtdynamics::BatchInverseDynamics &self, const Matrix &Q,
+              const Matrix &V, const Matrix &A) {
+             return self.torques(Q, V, A);
+           },
+           py::prepend(), release);
+
+  py::reinterpret_borrow<py::class_<gtdynamics::BatchStatics>>(
+      m_.attr("BatchStatics"))
+      .def("solve",
+           [](gtdynamics::BatchStatics &self, const Matrix &angles) {
+             return self.solve(angles);
+           },
+           py::prepend(), release)
+      .def("solve",
+           [](gtdynamics::BatchStatics &self, const Matrix &angles,
+              int link_id, const Matrix &loads) {
+             return self.solve(angles, link_id, loads);
+           },
+           py::prepend(), release);
+
+  py::reinterpret_borrow<py::class_<gtdynamics::BatchStaticsResult>>(
+      m_.attr("BatchStaticsResult"))
+      .def_readonly("feasible", &gtdynamics::BatchStaticsResult::feasible);
+}
+
+// Binary pickling, for multiprocessing workers: a Robot as the binary archive
+// of RobotCache.h, orders of magnitude faster than the text archive of
+// gtsam::serialize, and Values in the wire format of WireFormat.h. Values
+// decode from any buffer, e.g. a multiprocessing.shared_memory block, without
+// a copy into a bytes object; see gtdynamics.sharing.
+{
+  using gtdynamics::Robot;
+  py::reinterpret_borrow<py::class_<Robot>>(m_.attr("Robot"))
+      .def(py::pickle(
+          [](const Robot &robot) {
+            return py::make_tuple(py::bytes(gtdynamics::EncodeRobot(robot)));
+          },
+          [](const py::tuple &state) {
+            if (state.size() != 1)
+              throw std::runtime_error("Robot: invalid pickle state");
+            return gtdynamics::DecodeRobot(state[0].cast<std::string>());
+          }));
+
+  m_.def("EncodeValues",
+         [](const gtsam::Values &values) {
+           return py::bytes(gtdynamics::EncodeValues(values));
+         },
+         "Encode Values of doubles, Vector3, Vector6, Rot3 and Pose3 in "
+         "bytes.");
+  m_.def("DecodeValues",
+         [](const py::buffer &buffer) {
+           const py::buffer_info info = buffer.request();
+           if (info.ndim > 1)
+             throw std::invalid_argument("DecodeValues: need a 1D buffer");
+           const gtdynamics::ValuesView view(
+               static_cast<const char *>(info.ptr),
+               static_cast<size_t>(info.size * info.itemsize));
+           return view.toValues();
+         },
+         "Decode Values from any buffer written by EncodeValues.");
+}
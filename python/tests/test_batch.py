@@ -0,0 +1,141 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_batch.py
+ * @brief Test the batch kinematics, dynamics and trajectory functions.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import unittest
+
+import gtsam
+import numpy as np
+from gtsam.utils.test_case import GtsamTestCase
+
+import gtdynamics as gtd
+
+
+class TestBatch(GtsamTestCase):
+    """Whole trajectories in one call, against the per-step functions."""
+
+    SDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                        "models", "sdfs")
+
+    def setUp(self):
+        """Load the robot and a random trajectory."""
+        robot = gtd.CreateRobotFromFile(
+            osp.join(self.SDF_PATH, "test", "simple_rr.sdf"), "simple_rr_sdf")
+        self.robot = robot.fixLink("link_0")
+        rng = np.random.default_rng(42)
+        self.num_steps = 20
+        shape = (self.num_steps, self.robot.numJoints())
+        self.Q = rng.uniform(-1, 1, shape)
+        self.V = rng.uniform(-1, 1, shape)
+        self.A = rng.uniform(-1, 1, shape)
+
+    def test_forward_kinematics(self):
+        """Poses of all configurations at once, and points on links."""
+        poses = gtd.BatchForwardKinematics(self.robot).compute(self.Q)
+        self.assertEqual(poses.size(), self.num_steps)
+
+        link = self.robot.link("link_2")
+        points = gtd.PointOnLinks()
+        points.append(gtd.PointOnLink(link, gtsam.Point3(0, 0, 0.5)))
+        predicted = gtd.PredictPoints(points, poses)
+        self.assertEqual(predicted.shape, (self.num_steps, 3))
+
+        for b in [0, self.num_steps - 1]:
+            values = gtsam.Values()
+            for j in range(self.robot.numJoints()):
+                gtd.InsertJointAngle(values, j, 0, self.Q[b, j])
+            fk = self.robot.forwardKinematics(values, 0)
+            pose = gtd.Pose(fk, link.id(), 0)
+            self.gtsamAssertEquals(poses.pose(b, link.id()), pose, 1e-9)
+            np.testing.assert_allclose(
+                predicted[b], pose.transformFrom(gtsam.Point3(0, 0, 0.5)),
+                atol=1e-9)
+
+    def test_dynamics(self):
+        """Inverse then forward dynamics recover the accelerations."""
+        dynamics = gtd.RecursiveDynamics(self.robot)
+        torques = dynamics.inverseDynamicsTrajectory(self.Q, self.V, self.A)
+        self.assertEqual(torques.shape, self.Q.shape)
+        accels = dynamics.forwardDynamicsTrajectory(self.Q, self.V, torques)
+        np.testing.assert_allclose(accels, self.A, atol=1e-9)
+
+        values = gtsam.Values()
+        for j in range(self.robot.numJoints()):
+            gtd.InsertJointAngle(values, j, 0, self.Q[0, j])
+            gtd.InsertJointVel(values, j, 0, self.V[0, j])
+            gtd.InsertJointAccel(values, j, 0, self.A[0, j])
+        result = dynamics.solveInverseDynamics(values, 0)
+        for j in range(self.robot.numJoints()):
+            self.assertAlmostEqual(gtd.Torque(result, j, 0), torques[0, j])
+
+    def test_statics(self):
+        """Static torques of many configurations, with and without loads."""
+        gravity = np.array([0, 0, -9.8])
+        parameters = gtd.StaticsParameters(1e-5, gravity)
+        statics = gtd.BatchStatics(self.robot, parameters, 2)
+        result = statics.solve(self.Q)
+        self.assertEqual(result.torques.shape, self.Q.shape)
+        self.assertEqual(result.feasible.dtype, np.bool_)
+        self.assertEqual(result.numFeasible(), np.count_nonzero(
+            result.feasible))
+
+        # Statics are inverse dynamics at rest.
+        zeros = np.zeros_like(self.Q)
+        dynamics = gtd.BatchInverseDynamics(self.robot, gravity, 2)
+        solution = dynamics.solve(self.Q, zeros, zeros)
+        np.testing.assert_allclose(result.torques, solution.torques,
+                                   atol=1e-9)
+        self.assertEqual(solution.parent_wrenches.shape,
+                         (self.num_steps, 6 * self.robot.numJoints()))
+
+        link = self.robot.link("link_2").id()
+        loaded = statics.solve(self.Q, link, np.zeros((self.num_steps, 6)))
+        np.testing.assert_allclose(loaded.torques, result.torques, atol=1e-9)
+
+    def test_joint_trajectories(self):
+        """Joint values of all steps as one array."""
+        values = gtsam.Values()
+        for t in range(self.num_steps):
+            for j in range(self.robot.numJoints()):
+                gtd.InsertJointAngle(values, j, t, self.Q[t, j])
+        angles = gtd.DynamicsGraph.jointAnglesTrajectory(
+            self.robot, values, self.num_steps)
+        np.testing.assert_allclose(angles, self.Q)
+
+    def test_differentiable_rollout(self):
+        """Gradient of a terminal cost agrees with a central difference."""
+        rollout = gtd.DifferentiableRollout(self.robot)
+        n = rollout.numJoints()
+        q0, v0 = self.Q[:2], self.V[:2]
+        torques = [self.A[:5], self.A[5:10]]
+        states = rollout.simulate(q0, v0, torques)
+        self.assertEqual(states.q.shape, (2, 6 * n))
+
+        def cost(tau):
+            q = rollout.simulate(q0, v0, tau).q
+            return 0.5 * np.sum(q[:, -n:]**2)
+
+        dL_dq = np.zeros_like(states.q)
+        dL_dq[:, -n:] = states.q[:, -n:]
+        gradients = rollout.gradients(q0, v0, torques, dL_dq,
+                                      np.zeros_like(states.v))
+        h = 1e-6
+        plus = [tau.copy() for tau in torques]
+        minus = [tau.copy() for tau in torques]
+        plus[1][2, 0] += h
+        minus[1][2, 0] -= h
+        self.assertAlmostEqual(gradients.torques[1][2, 0],
+                               (cost(plus) - cost(minus)) / (2 * h), places=5)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -10,6 +10,7 @@
 """
 
 import os.path as osp
+import tempfile
 import unittest
 
 import gtsam
@@ -40,6 +41,46 @@ class TestDynamicsGraph(unittest.TestCase):
         graph = graph_builder.dynamicsFactorGraph(simple_rr, 0, None, None)
         self.assertEqual(graph.size(), 13)
 
+    def test_factor_statistics(self):
+        """Test error and linearization statistics by factor type."""
+        SDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                            "models", "sdfs")
+        simple_rr = gtd.CreateRobotFromFile(
+            osp.join(SDF_PATH, "test", "simple_rr.sdf"), "simple_rr_sdf")
+        graph = gtd.DynamicsGraph().dynamicsFactorGraph(simple_rr, 0, None,
+                                                        None)
+        values = gtd.ZeroValues(simple_rr, 0, 0.0)
+
+        statistics = gtd.DynamicsGraph.factorStatistics(graph, values)
+        self.assertEqual(sum(s.count for s in statistics), graph.size())
+        self.assertAlmostEqual(sum(s.error for s in statistics),
+                               graph.error(values))
+        self.assertTrue(all(s.linearize_time >= 0 for s in statistics))
+
+    def test_save_trajectory(self):
+        """Test the memory-mapped trajectory file format."""
+        SDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                            "models", "sdfs")
+        simple_rr = gtd.CreateRobotFromFile(
+            osp.join(SDF_PATH, "test", "simple_rr.sdf"), "simple_rr_sdf")
+        num_steps = 3
+        values = gtd.ZeroValuesTrajectory(simple_rr, num_steps, -1, 0.1, None)
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = osp.join(directory, "trajectory.gtdtraj")
+            gtd.DynamicsGraph.saveTrajectory(path, simple_rr, values,
+                                             num_steps)
+            trajectory = gtd.trajectory_file.TrajectoryFile(path)
+            self.assertEqual(trajectory.num_steps, num_steps + 1)
+            self.assertIn("pose", trajectory.quantities())
+            self.assertEqual(trajectory["q"].shape, (num_steps + 1, 2, 1))
+            self.assertEqual(trajectory["pose"].shape, (num_steps + 1, 3, 12))
+            for j in trajectory.ids("q"):
+                q = trajectory.entity("q", j)
+                for t in range(num_steps + 1):
+                    self.assertEqual(q[t, 0], gtd.JointAngle(values, j, t))
+            del trajectory, q
+
     def test_objective_factors(self):
         noise1 = gtsam.noiseModel.Unit.Create(1)
         noise6 = gtsam.noiseModel.Unit.Create(6)
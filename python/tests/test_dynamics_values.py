@@ -0,0 +1,67 @@
+"""
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_dynamics_values.py
+ * @brief Test numpy views of DynamicsValues.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import unittest
+
+import numpy as np
+from gtsam import Values
+
+import gtdynamics as gtd
+
+
+class TestDynamicsValues(unittest.TestCase):
+    """Test the dense buffers of DynamicsValues as numpy arrays."""
+
+    SDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                        "models", "sdfs")
+
+    def setUp(self):
+        self.robot = gtd.CreateRobotFromFile(
+            osp.join(self.SDF_PATH, "test", "simple_rr.sdf"), "simple_rr_sdf")
+        self.num_steps = 4
+        self.values = Values()
+        for k in range(self.num_steps):
+            for joint in self.robot.joints():
+                j = joint.id()
+                gtd.InsertJointAngle(self.values, j, k, 0.1 * k + j)
+                gtd.InsertTorque(self.values, j, k, -2.0 * k)
+
+    def test_joint_views(self):
+        """Joint buffers match the per-key accessors."""
+        dense = gtd.DynamicsValues.FromValues(self.robot, self.values,
+                                              self.num_steps)
+        angles = dense.jointAngles()
+        torques = dense.torques()
+        self.assertEqual(angles.shape,
+                         (dense.numJointSlots(), self.num_steps))
+        for k in range(self.num_steps):
+            for joint in self.robot.joints():
+                j = joint.id()
+                self.assertEqual(angles[j, k],
+                                 gtd.JointAngle(self.values, j, k))
+                self.assertEqual(torques[j, k], gtd.Torque(self.values, j, k))
+
+    def test_zero_copy(self):
+        """Views are read-only and follow later changes to the buffers."""
+        dense = gtd.DynamicsValues(self.robot, self.num_steps)
+        angles = dense.jointAngles()
+        self.assertFalse(angles.flags.writeable)
+        self.assertTrue(np.all(angles == 0))
+
+        dense.assign(self.values)
+        self.assertEqual(angles[1, 2], gtd.JointAngle(self.values, 1, 2))
+        self.assertTrue(np.shares_memory(angles, dense.jointAngles()))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,56 @@
+"""
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_futures.py
+ * @brief Test asynchronous solves from Python threads.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import os.path as osp
+import unittest
+
+import numpy as np
+from gtsam import Values
+
+import gtdynamics as gtd
+from gtdynamics import futures
+
+
+class TestFutures(unittest.TestCase):
+    """Test solves submitted to the shared thread pool."""
+
+    URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                         "models", "urdfs")
+
+    def simulator(self):
+        """Simulator for a simple one-link robot."""
+        robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "simple_urdf.urdf"), "")
+        robot = robot.fixLink("l1")
+        return gtd.Simulator(robot, Values(), np.zeros(3),
+                             np.asarray([1, 0, 0]))
+
+    def test_simulate(self):
+        """Concurrent simulations give the same results as sequential ones."""
+        num_sims = 4
+        torques_seqs = []
+        for i in range(num_sims):
+            torques = Values()
+            gtd.InsertTorque(torques, 0, 1.0 + i)
+            torques_seqs.append([torques, torques])
+
+        simulators = [self.simulator() for _ in range(num_sims)]
+        pending = futures.map_async(lambda sim, seq: sim.simulate(seq, 1.0),
+                                    simulators, torques_seqs)
+        for i, future in enumerate(pending):
+            expected = self.simulator().simulate(torques_seqs[i], 1.0)
+            self.assertEqual(gtd.JointAngle(expected, 0, 0),
+                             gtd.JointAngle(future.result(), 0, 0))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,81 @@
+"""
+ * GTDynamics Copyright 2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_pickle.py
+ * @brief Test binary pickling and shared memory handoff to workers.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member
+
+import multiprocessing
+import os.path as osp
+import pickle
+import unittest
+
+import numpy as np
+from gtsam import Point3, Pose3, Rot3
+
+import gtdynamics as gtd
+from gtdynamics.sharing import SharedValues
+
+
+def _total_mass(robot):
+    """Worker: total mass of an unpickled robot."""
+    return sum(link.mass() for link in robot.links())
+
+
+def _num_values(shared):
+    """Worker: size of Values loaded from shared memory."""
+    return shared.load().size()
+
+
+class TestPickle(unittest.TestCase):
+    """Test pickling Robot and Values for multiprocessing."""
+
+    ROBOT_MODEL = osp.join(gtd.URDF_PATH, "a1.urdf")
+
+    def values(self):
+        """Values with all types of the wire format."""
+        values = gtd.Values()
+        gtd.InsertJointAngle(values, 0, 0.5)
+        gtd.InsertPose(values, 1, Pose3(Rot3.Rz(0.3), Point3(1, 2, 3)))
+        gtd.InsertTwist(values, 1, np.arange(6.0))
+        return values
+
+    def test_robot(self):
+        """A pickled robot equals the original."""
+        robot = gtd.CreateRobotFromFile(self.ROBOT_MODEL)
+        actual = pickle.loads(pickle.dumps(robot))
+        self.assertTrue(robot.equals(actual, 1e-9))
+        self.assertEqual(robot.numJoints(), actual.numJoints())
+
+    def test_values(self):
+        """Pickled Values are equal to the original."""
+        values = self.values()
+        actual = pickle.loads(pickle.dumps(values))
+        self.assertIsInstance(actual, gtd.Values)
+        self.assertTrue(values.equals(actual, 1e-12))
+
+        # Other value types fall back to the text archive.
+        values.insert(gtd.JointAngleKey(5, 0).key(), np.zeros(4))
+        actual = pickle.loads(pickle.dumps(values))
+        self.assertTrue(values.equals(actual, 1e-12))
+
+    def test_workers(self):
+        """Workers receive robots by pickle and Values by shared memory."""
+        robot = gtd.CreateRobotFromFile(self.ROBOT_MODEL)
+        values = self.values()
+        with SharedValues(values) as shared:
+            self.assertTrue(values.equals(shared.load(), 1e-12))
+            with multiprocessing.Pool(2) as pool:
+                masses = pool.map(_total_mass, [robot] * 2)
+                sizes = pool.map(_num_values, [shared] * 2)
+        self.assertAlmostEqual(_total_mass(robot), masses[0])
+        self.assertEqual([values.size()] * 2, sizes)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,108 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  test_sim.py
+ * @brief Test the PyBullet bridge, against a stand-in for PyBullet.
+"""
+
+# pylint: disable=no-name-in-module, import-error, no-member, invalid-name
+
+import os.path as osp
+import unittest
+
+import numpy as np
+from gtsam import Values
+
+import gtdynamics as gtd
+
+
+class FakePyBullet:
+    """
+    The PyBullet calls used by the bridge, on joints named as in the robot
+    but at other indices, which integrate the commanded torques with a unit
+    inertia. Calls are counted, to check that they are batched.
+    """
+    VELOCITY_CONTROL, POSITION_CONTROL, TORQUE_CONTROL = range(3)
+
+    def __init__(self, names):
+        self.names = ["fixed"] + list(names)
+        self.q = np.zeros(len(self.names))
+        self.v = np.zeros(len(self.names))
+        self.tau = np.zeros(len(self.names))
+        self.dt = 1.0 / 240
+        self.calls = 0
+
+    def getNumJoints(self, body):
+        return len(self.names)
+
+    def getJointInfo(self, body, index):
+        return (index, self.names[index].encode())
+
+    def getJointStates(self, body, indices):
+        self.calls += 1
+        return [(self.q[i], self.v[i], None, 0.0) for i in indices]
+
+    def resetJointStatesMultiDof(self, body, indices, targetValues,
+                                 targetVelocities):
+        self.calls += 1
+        for i, q, v in zip(indices, targetValues, targetVelocities):
+            self.q[i], self.v[i] = q[0], v[0]
+
+    def setJointMotorControlArray(self, bodyUniqueId, jointIndices,
+                                  controlMode, forces=None, **kwargs):
+        self.calls += 1
+        if controlMode == self.TORQUE_CONTROL:
+            self.tau[jointIndices] = forces
+
+    def setTimeStep(self, dt):
+        self.dt = dt
+
+    def stepSimulation(self):
+        self.v += self.dt * self.tau
+        self.q += self.dt * self.v
+
+
+class TestPyBulletBridge(unittest.TestCase):
+    """Tests of PyBulletBridge."""
+
+    URDF_PATH = osp.join(osp.dirname(osp.realpath(__file__)), "..", "..",
+                         "models", "urdfs")
+
+    def setUp(self):
+        robot = gtd.CreateRobotFromFile(
+            osp.join(self.URDF_PATH, "test", "simple_urdf.urdf"), "")
+        self.robot = robot.fixLink("l1")
+        self.pyb = FakePyBullet([j.name() for j in self.robot.joints()])
+        self.bridge = gtd.sim.PyBulletBridge(self.pyb, 0, self.robot)
+
+    def test_state(self):
+        """States round-trip through the joint index map."""
+        q, v = np.array([0.3]), np.array([-0.2])
+        self.bridge.reset_state(q, v)
+        self.assertEqual(self.pyb.q[1], 0.3)
+        np.testing.assert_array_equal(self.bridge.read_state()[0], q)
+        np.testing.assert_array_equal(self.bridge.read_state()[1], v)
+
+    def test_lockstep(self):
+        """Both simulators run the same torques; calls are one per step."""
+        simulator = gtd.Simulator(self.robot, Values(), np.zeros(3),
+                                  np.asarray([1, 0, 0]),
+                                  gtd.ForwardDynamicsMethod.ArticulatedBody)
+        torques = [np.ones(1)] * 10
+        self.pyb.calls = 0
+        result = self.bridge.lockstep(simulator, torques, 0.01, resync=True)
+        self.assertEqual(result["q"].shape, (10, 1))
+        # Motors are released once, then torques and reads every step.
+        self.assertEqual(self.pyb.calls, 1 + 2 * len(torques))
+        # Both integrate forwards from rest.
+        self.assertGreater(result["q"][-1, 0], 0)
+        self.assertGreater(result["bullet_q"][-1, 0], 0)
+        np.testing.assert_array_equal(simulator.jointAngles(),
+                                      result["bullet_q"][-1])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,47 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  generate_robot_kernels.cpp
+ * @brief Write the specialized kernels of a robot model as a C++ header.
+ *
+ * Usage: generate_robot_kernels <model file> <base link> <name> [output]
+ * e.g. generate_robot_kernels models/urdfs/fanuc_lrmate200id.urdf base_link
+ * fanuc fanuc_kernels.h. The base link is fixed, and gravity is (0, 0, -9.8).
+ * Without an output file the header is written to standard output. See also
+ * gtdynamics_add_robot_kernels in scripts/CMakeLists.txt.
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "gtdynamics/universal_robot/RobotKernelGenerator.h"
+#include "gtdynamics/universal_robot/sdf.h"
+
+using namespace gtdynamics;
+
+int main(int argc, char** argv) {
+  if (argc < 4 || argc > 5) {
+    std::cerr << "Usage: " << argv[0]
+              << " <model file> <base link> <name> [output]" << std::endl;
+    return 1;
+  }
+  const Robot robot = CreateRobotFromFile(argv[1]).fixLink(argv[2]);
+  const std::string code =
+      GenerateRobotKernels(robot, argv[3], gtsam::Vector3(0, 0, -9.8));
+  if (argc == 4) {
+    std::cout << code;
+    return 0;
+  }
+  std::ofstream file(argv[4]);
+  file << code;
+  if (!file) {
+    std::cerr << "Could not write " << argv[4] << std::endl;
+    return 1;
+  }
+  return 0;
+}
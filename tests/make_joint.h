@@ -16,9 +16,14 @@
 #include "gtdynamics/universal_robot/Link.h"
 #include "gtdynamics/universal_robot/HelicalJoint.h"
 
+#include <boost/optional.hpp>
+
 namespace gtdynamics {
-/// Create a joint with given rest transform cMp and screw-axis in child frame.
-JointConstSharedPtr make_joint(gtsam::Pose3 cMp, gtsam::Vector6 cScrewAxis) {
+/// Create a joint with given rest transform cMp and screw-axis in child frame,
+/// and optionally its parameters.
+JointConstSharedPtr make_joint(
+    gtsam::Pose3 cMp, gtsam::Vector6 cScrewAxis,
+    const boost::optional<JointParams> &parameters = boost::none) {
   // create links
   std::string name = "l1";
   double mass = 100;
@@ -36,6 +41,7 @@ JointConstSharedPtr make_joint(gtsam::Pose3 cMp, gtsam::Vector6 cScrewAxis) {
   joint_params.scalar_limits.value_lower_limit = -1.57;
   joint_params.scalar_limits.value_upper_limit = 1.57;
   joint_params.scalar_limits.value_limit_threshold = 0;
+  if (parameters) joint_params = *parameters;
   gtsam::Pose3 bMj = gtsam::Pose3(gtsam::Rot3(), gtsam::Point3(0, 0, 2));
   gtsam::Pose3 jMc = bMj.inverse() * l2->bMcom();
   gtsam::Vector6 jScrewAxis = jMc.AdjointMap() * cScrewAxis;
@@ -0,0 +1,88 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testAdaptiveMeshOptimizer.cpp
+ * @brief Test mesh refinement of multi-phase trajectories.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/optimizer/AdaptiveMeshOptimizer.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/values.h"
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+TEST(AdaptiveMeshOptimizer, IntervalErrors) {
+  using namespace walk_cycle_example;
+  const Trajectory trajectory(walk_cycle, 1);
+
+  // Accelerations k^2 of joint 0, phases of 2 and 3 steps.
+  Values values;
+  for (size_t k = 0; k <= 5; ++k) InsertJointAccel(&values, 0, k, k * k);
+  values.insert(PhaseKey(0), 0.1);
+  values.insert(PhaseKey(1), 0.2);
+
+  const std::vector<double> errors = AdaptiveMeshOptimizer::IntervalErrors(
+      robot, trajectory, values, CollocationScheme::Trapezoidal);
+  EXPECT_LONGS_EQUAL(5, errors.size());
+  EXPECT_DOUBLES_EQUAL(0.01 / 12 * 3, errors[1], 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.04 / 12 * 9, errors[4], 1e-12);
+
+  const std::vector<double> euler = AdaptiveMeshOptimizer::IntervalErrors(
+      robot, trajectory, values, CollocationScheme::Euler);
+  EXPECT_DOUBLES_EQUAL(0, euler[0], 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.04 / 2 * 4, euler[2], 1e-12);
+
+  const std::vector<double> phase_errors =
+      AdaptiveMeshOptimizer::PhaseErrors(trajectory, errors);
+  EXPECT_LONGS_EQUAL(2, phase_errors.size());
+  EXPECT_DOUBLES_EQUAL(errors[1], phase_errors[0], 1e-12);
+  EXPECT_DOUBLES_EQUAL(errors[4], phase_errors[1], 1e-12);
+
+  values.erase(PhaseKey(1));
+  CHECK_EXCEPTION(AdaptiveMeshOptimizer::IntervalErrors(
+                      robot, trajectory, values, CollocationScheme::Euler),
+                  std::invalid_argument);
+}
+
+TEST(AdaptiveMeshOptimizer, Refine) {
+  using namespace walk_cycle_example;
+  const Trajectory trajectory(walk_cycle, 1);
+  AdaptiveMeshParameters parameters;
+  parameters.tolerance = 0.02;
+
+  // Within tolerance the steps are kept, above it they grow towards half the
+  // tolerance, (3)^(1/3) * 3 steps, and without error they shrink by half.
+  Trajectory refined =
+      AdaptiveMeshOptimizer::Refine(trajectory, {0.01, 0.03}, parameters);
+  EXPECT(refined.phaseDurations() == std::vector<int>({2, 5}));
+  EXPECT_LONGS_EQUAL(7, refined.getEndTimeStep(1));
+  EXPECT_LONGS_EQUAL(trajectory.phaseContactPoints()[1].size(),
+                     refined.phaseContactPoints()[1].size());
+  refined = AdaptiveMeshOptimizer::Refine(trajectory, {0.0, 0.01}, parameters);
+  EXPECT(refined.phaseDurations() == std::vector<int>({1, 3}));
+
+  // Growth and steps are bounded.
+  parameters.max_steps = 10;
+  refined = AdaptiveMeshOptimizer::Refine(trajectory, {10.0, 10.0}, parameters);
+  EXPECT(refined.phaseDurations() == std::vector<int>({8, 10}));
+
+  CHECK_EXCEPTION(AdaptiveMeshOptimizer::Refine(trajectory, {0.0}, parameters),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
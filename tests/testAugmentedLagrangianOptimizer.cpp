@@ -14,9 +14,12 @@
 
 #include <CppUnitLite/TestHarness.h>
 
+#include <stdexcept>
+
 #include "constrainedExample.h"
 #include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
 #include "gtdynamics/optimizer/EqualityConstraint.h"
+#include "gtdynamics/utils/values.h"
 
 using namespace gtdynamics;
 using namespace gtsam;
@@ -59,6 +62,76 @@ TEST(AugmentedLagrangianOptimizer, ConstrainedExample) {
   EXPECT(assert_equal(gt_results, results, tol));
 }
 
+// Warm-starting from the state of a previous solve needs fewer iterations.
+TEST(AugmentedLagrangianOptimizer, WarmStart) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 1.0);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  AugmentedLagrangianParameters params;
+  params.feasibility_tolerance = 1e-4;
+  AugmentedLagrangianOptimizer optimizer(params);
+
+  AugmentedLagrangianState state;
+  ConstrainedOptResult cold, warm;
+  Values cold_results =
+      optimizer.optimize(graph, constraints, init_values, &state, &cold);
+  EXPECT_LONGS_EQUAL(1, state.z.size());
+  EXPECT_DOUBLES_EQUAL(cold.mu_values.back(), state.mu, 0);
+
+  Values warm_results =
+      optimizer.optimize(graph, constraints, init_values, &state, &warm);
+  EXPECT(warm.intermediate_values.size() <
+         cold.intermediate_values.size());
+  EXPECT(assert_equal(cold_results, warm_results, 1e-3));
+
+  // Multipliers have to match the constraints.
+  AugmentedLagrangianState wrong;
+  wrong.z.assign(2, gtsam::Vector1::Zero());
+  CHECK_EXCEPTION(
+      optimizer.optimize(graph, constraints, init_values, &wrong),
+      std::invalid_argument);
+}
+
+// Multipliers follow their constraints when the horizon moves.
+TEST(AugmentedLagrangianState, TimeShift) {
+  auto constraints_from = [](int t) {
+    EqualityConstraints constraints;
+    const Double_ q0(internal::JointAngleKey(0, t));
+    const Double_ q1(internal::JointAngleKey(1, t));
+    constraints.emplace_shared<DoubleExpressionEquality>(q0 + q1, 1.0);
+    return constraints;
+  };
+  EqualityConstraints old_constraints, new_constraints;
+  for (int t = 0; t < 3; t++) {
+    old_constraints.add(constraints_from(t));
+    new_constraints.add(constraints_from(t));
+  }
+
+  AugmentedLagrangianState state;
+  state.mu = 8.0;
+  for (int t = 0; t < 3; t++) state.z.push_back(gtsam::Vector1(t + 1.0));
+
+  const AugmentedLagrangianState shifted = state.shifted(
+      old_constraints, new_constraints, AugmentedLagrangianState::TimeShift(1));
+  EXPECT_DOUBLES_EQUAL(8.0, shifted.mu, 0);
+  EXPECT_LONGS_EQUAL(3, shifted.z.size());
+  EXPECT(assert_equal(gtsam::Vector1(2.0), shifted.z[0]));
+  EXPECT(assert_equal(gtsam::Vector1(3.0), shifted.z[1]));
+  EXPECT(assert_equal(gtsam::Vector1(0.0), shifted.z[2]));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
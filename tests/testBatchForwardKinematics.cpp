@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchForwardKinematics.cpp
+ * @brief Test batched forward kinematics against the single-configuration one.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/universal_robot/BatchForwardKinematics.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+
+// Check every configuration of a batch against CompiledRobot.
+static bool AgreesWithCompiledRobot(const Robot &robot, size_t num_threads) {
+  const CompiledRobot compiled(robot);
+  BatchForwardKinematics batch_fk(robot, num_threads);
+
+  // Not a multiple of the lane width, to exercise the last partial block.
+  const size_t B = 2 * BatchForwardKinematics::kLanes + 13;
+  const gtsam::Matrix Q =
+      gtsam::Matrix::Random(B, compiled.numJointSlots()) * 3.0;
+  const PoseBatch poses = batch_fk.compute(Q);
+
+  bool agrees = poses.size() == B;
+  std::vector<Pose3> expected;
+  for (size_t b = 0; b < B; ++b) {
+    expected.assign(compiled.numLinkSlots(), Pose3());
+    compiled.forwardKinematics(Q.row(b).transpose(), &expected);
+    for (const int i : compiled.linkIds())
+      agrees &= assert_equal(expected[i], poses.pose(b, i), 1e-9);
+  }
+  return agrees;
+}
+
+TEST(BatchForwardKinematics, revolute) {
+  EXPECT(AgreesWithCompiledRobot(simple_rr::getRobot(), 1));
+  EXPECT(AgreesWithCompiledRobot(simple_urdf::getRobot(), 1));
+}
+
+TEST(BatchForwardKinematics, prismatic) {
+  EXPECT(AgreesWithCompiledRobot(simple_urdf_prismatic::getRobot(), 1));
+}
+
+TEST(BatchForwardKinematics, threads) {
+  EXPECT(AgreesWithCompiledRobot(simple_rr::getRobot(), 3));
+}
+
+// Structure-of-arrays accessors match the poses.
+TEST(BatchForwardKinematics, layout) {
+  auto robot = simple_urdf::getRobot();
+  BatchForwardKinematics batch_fk(robot);
+  const gtsam::Matrix Q = gtsam::Matrix::Random(5, 1);
+  const PoseBatch poses = batch_fk.compute(Q);
+
+  const int i = robot.link("l2")->id();
+  for (size_t b = 0; b < poses.size(); ++b) {
+    const Pose3 pose = poses.pose(b, i);
+    EXPECT_DOUBLES_EQUAL(pose.rotation().matrix()(1, 2),
+                         poses.rotation(i, 1, 2)(b), 1e-12);
+    EXPECT_DOUBLES_EQUAL(pose.translation().z(), poses.translation(i, 2)(b),
+                         1e-12);
+  }
+
+  CHECK_EXCEPTION(batch_fk.compute(gtsam::Matrix::Zero(5, 3)),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchInverseDynamics.cpp
+ * @brief Test inverse dynamics of trajectories, with the steps in parallel.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/BatchInverseDynamics.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+// A sinusoidal motion of a two-link arm, over several blocks of steps.
+TEST(BatchInverseDynamics, Sinusoid) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const size_t T = 1000;
+  Matrix Q(T, 2), V(T, 2), A(T, 2);
+  for (size_t k = 0; k < T; ++k) {
+    const double t = 0.01 * k;
+    Q.row(k) << std::sin(t), 0.5 * std::cos(2 * t);
+    V.row(k) << std::cos(t), -std::sin(2 * t);
+    A.row(k) << -std::sin(t), -2 * std::cos(2 * t);
+  }
+
+  BatchInverseDynamics batch(robot, gravity, 3);
+  EXPECT_LONGS_EQUAL(3, batch.numThreads());
+  EXPECT_LONGS_EQUAL(2, batch.numJointSlots());
+  const TrajectoryInverseDynamicsResult result = batch.solve(Q, V, A);
+  EXPECT_LONGS_EQUAL(T, result.torques.rows());
+  EXPECT_LONGS_EQUAL(12, result.parent_wrenches.cols());
+
+  // Same as the serial recursive Newton-Euler, step by step.
+  const RecursiveDynamics dynamics(robot, gravity);
+  EXPECT(assert_equal(dynamics.inverseDynamicsTrajectory(Q, V, A),
+                      result.torques, 1e-9));
+  RecursiveDynamicsResult step;
+  dynamics.allocate(&step);
+  for (const size_t k : {size_t(0), size_t(255), size_t(256), T - 1}) {
+    dynamics.inverseDynamics(Vector(Q.row(k).transpose()),
+                             Vector(V.row(k).transpose()),
+                             Vector(A.row(k).transpose()), &step);
+    for (int j = 0; j < 2; ++j) {
+      EXPECT(assert_equal(gtsam::Vector6(step.parent_wrenches.col(j)),
+                          result.parentWrench(k, j), 1e-9));
+      EXPECT(assert_equal(gtsam::Vector6(step.child_wrenches.col(j)),
+                          result.childWrench(k, j), 1e-9));
+    }
+  }
+
+  // Torques only.
+  const TrajectoryInverseDynamicsResult torques = batch.solve(Q, V, A, false);
+  EXPECT_LONGS_EQUAL(0, torques.parent_wrenches.size());
+  EXPECT(assert_equal(result.torques, batch.torques(Q, V, A), 1e-12));
+
+  CHECK_EXCEPTION(batch.solve(Q, V, Matrix(T, 3)), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchSimulator.cpp
+ * @brief Test batched rollouts against the Simulator class.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/dynamics/BatchSimulator.h"
+#include "gtdynamics/dynamics/Simulator.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+
+TEST(ThreadPool, parallelFor) {
+  ThreadPool pool(4);
+  EXPECT_LONGS_EQUAL(4, pool.numThreads());
+  std::vector<int> visited(1000, 0);
+  std::atomic<size_t> max_worker{0};
+  pool.parallelFor(visited.size(), [&](size_t i, size_t worker) {
+    visited[i] += 1;
+    if (worker > max_worker) max_worker = worker;
+  });
+  for (int count : visited) EXPECT_LONGS_EQUAL(1, count);
+  EXPECT(max_worker < pool.numThreads());
+
+  // Exceptions are propagated to the caller.
+  CHECK_EXCEPTION(pool.parallelFor(10,
+                                   [](size_t i, size_t) {
+                                     if (i == 3) throw std::runtime_error("");
+                                   }),
+                  std::runtime_error);
+}
+
+TEST(BatchSimulator, simple_urdf) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  gtsam::Values initial_values;
+  InsertJointAngle(&initial_values, 0, 0.1);
+
+  const size_t num_steps = 10, num_rollouts = 8;
+  const double dt = 0.01;
+  std::vector<gtsam::Matrix> torque_seqs;
+  for (size_t r = 0; r < num_rollouts; ++r)
+    torque_seqs.push_back(
+        gtsam::Matrix::Constant(num_steps, 1, 0.5 * r - 1.0));
+
+  BatchSimulator batch(robot, initial_values, gravity, 3);
+  auto states = batch.simulate(torque_seqs, dt);
+  EXPECT_LONGS_EQUAL(num_steps, states.num_steps);
+  EXPECT_LONGS_EQUAL(1, states.num_joints);
+
+  for (size_t r = 0; r < num_rollouts; ++r) {
+    Simulator simulator(robot, initial_values, gravity, boost::none,
+                        ArticulatedBody);
+    gtsam::Values torques;
+    InsertTorque(&torques, 0, 0.5 * r - 1.0);
+    for (size_t k = 0; k < num_steps; ++k) {
+      simulator.step(torques, dt);
+      const auto &values = simulator.getValues();
+      // getValues holds the state at the start of the last step.
+      EXPECT_DOUBLES_EQUAL(JointAngle(values, 0), states.angles(r, k)(0), 1e-9);
+      EXPECT_DOUBLES_EQUAL(JointVel(values, 0), states.velocities(r, k)(0),
+                           1e-9);
+      EXPECT_DOUBLES_EQUAL(JointAccel(values, 0), states.accelerations(r, k)(0),
+                           1e-9);
+    }
+  }
+}
+
+TEST(BatchSimulator, costs) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  gtsam::Values initial_values;
+  InsertJointAngle(&initial_values, 0, 0.1);
+
+  const size_t num_steps = 10, num_rollouts = 8;
+  const double dt = 0.01;
+  std::vector<gtsam::Matrix> torque_seqs;
+  for (size_t r = 0; r < num_rollouts; ++r)
+    torque_seqs.push_back(
+        gtsam::Matrix::Constant(num_steps, 1, 0.5 * r - 1.0));
+
+  BatchSimulator batch(robot, initial_values, gravity, 3);
+  auto stage = [](size_t k, const gtsam::Vector &q, const gtsam::Vector &v,
+                  const gtsam::Vector &tau) {
+    return q.squaredNorm() + 0.1 * v.squaredNorm() + 0.01 * k * tau(0);
+  };
+  auto terminal = [](const gtsam::Vector &q, const gtsam::Vector &v) {
+    return 10 * (q(0) - 1) * (q(0) - 1) + v.squaredNorm();
+  };
+  const gtsam::Vector costs =
+      batch.simulateCosts(torque_seqs, dt, stage, terminal);
+  EXPECT_LONGS_EQUAL(num_rollouts, costs.size());
+
+  // Same costs as from the full trajectories.
+  const auto states = batch.simulate(torque_seqs, dt);
+  for (size_t r = 0; r < num_rollouts; ++r) {
+    double expected = 0;
+    for (size_t k = 0; k < num_steps; ++k)
+      expected += stage(k, states.angles(r, k), states.velocities(r, k),
+                        torque_seqs[r].row(k).transpose());
+    expected += terminal(states.angles(r, num_steps),
+                         states.velocities(r, num_steps));
+    EXPECT_DOUBLES_EQUAL(expected, costs(r), 1e-9);
+  }
+
+  // Selected rollouts are those of the whole batch.
+  const std::vector<size_t> selected = {5, 2};
+  const auto best = batch.simulate(torque_seqs, dt, selected);
+  EXPECT_LONGS_EQUAL(2, best.q.rows());
+  for (size_t i = 0; i < selected.size(); ++i) {
+    EXPECT(assert_equal(gtsam::Matrix(states.q.row(selected[i])),
+                        gtsam::Matrix(best.q.row(i)), 1e-12));
+    EXPECT(assert_equal(gtsam::Matrix(states.a.row(selected[i])),
+                        gtsam::Matrix(best.a.row(i)), 1e-12));
+  }
+  CHECK_EXCEPTION(batch.simulate(torque_seqs, dt, {num_rollouts}),
+                  std::invalid_argument);
+}
+
+TEST(BatchSimulator, metrics) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const size_t num_steps = 10, num_rollouts = 8;
+  const double dt = 0.01;
+  const std::vector<gtsam::Matrix> torque_seqs(
+      num_rollouts, gtsam::Matrix::Ones(num_steps, 1));
+
+  BatchSimulator batch(robot, gtsam::Values(), gravity, 3);
+  batch.simulate(torque_seqs, dt);
+  EXPECT_LONGS_EQUAL(0, batch.metrics().step.count());
+
+  // The steps of all threads are merged.
+  batch.enableMetrics();
+  batch.simulate(torque_seqs, dt);
+  const SimulatorMetrics &metrics = batch.metrics();
+  EXPECT_LONGS_EQUAL(num_steps * num_rollouts, metrics.step.count());
+  EXPECT_LONGS_EQUAL(num_steps * num_rollouts,
+                     metrics.forward_dynamics.count());
+  EXPECT_LONGS_EQUAL(0, metrics.forward_kinematics.count());
+  EXPECT_DOUBLES_EQUAL(num_steps * num_rollouts * dt, metrics.simulated_time,
+                       1e-12);
+  EXPECT(metrics.realTimeFactor() > 0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
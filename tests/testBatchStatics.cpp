@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBatchStatics.cpp
+ * @brief Test statics over batches of configurations.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/statics/BatchStatics.h"
+#include "gtdynamics/statics/StaticsEngine.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+// A grid of configurations of a two-link arm under gravity.
+TEST(BatchStatics, Grid) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const StaticsParameters parameters(1e-5, gtsam::Vector3(0, 0, -9.8));
+  const size_t n = 7;
+  Matrix angles(n * n, 2);
+  for (size_t r = 0; r < n * n; ++r)
+    angles.row(r) << -1.5 + 0.5 * (r / n), -1.5 + 0.5 * (r % n);
+
+  BatchStatics batch(robot, parameters, 3);
+  EXPECT_LONGS_EQUAL(3, batch.numThreads());
+  const BatchStaticsResult result = batch.solve(angles);
+  EXPECT_LONGS_EQUAL(n * n, result.torques.rows());
+  EXPECT_LONGS_EQUAL(2, result.torques.cols());
+
+  // Same torques as the engine, one configuration at a time.
+  StaticsEngine engine(robot, parameters);
+  Vector torques;
+  for (size_t r = 0; r < n * n; ++r) {
+    engine.gravityTorques(angles.row(r).transpose(), &torques);
+    EXPECT(assert_equal(Vector(torques.head(2)),
+                        Vector(result.torques.row(r).transpose()), 1e-9));
+  }
+
+  // With a torque limit on the first joint below the largest static torque,
+  // only some configurations are feasible.
+  const double max_torque = result.torques.col(0).cwiseAbs().maxCoeff();
+  JointParams joint_parameters = robot.joint("joint_1")->parameters();
+  joint_parameters.torque_limit = 0.5 * max_torque;
+  const Robot limited =
+      robot.withJointParameters("joint_1", joint_parameters);
+  BatchStatics limited_batch(limited, parameters, 2);
+  const BatchStaticsResult limited_result = limited_batch.solve(angles);
+  const int j = limited.jointId("joint_1");
+  EXPECT_DOUBLES_EQUAL(0.5 * max_torque, limited_batch.torqueLimits()(j), 0);
+  size_t num_feasible = 0;
+  for (size_t r = 0; r < n * n; ++r) {
+    const bool feasible =
+        (limited_result.torques.row(r).transpose().cwiseAbs().array() <=
+         limited_batch.torqueLimits().array())
+            .all();
+    EXPECT(feasible == limited_result.feasible(r));
+    num_feasible += feasible;
+  }
+  EXPECT_LONGS_EQUAL(num_feasible, limited_result.numFeasible());
+  EXPECT(num_feasible > 0 && num_feasible < n * n);
+
+  CHECK_EXCEPTION(batch.solve(Matrix::Zero(2, 3)), std::invalid_argument);
+}
+
+// Loads on the last link: none is the same as solve, and carrying the
+// weight of the link relieves its joint.
+TEST(BatchStatics, Loads) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const StaticsParameters parameters(1e-5, gtsam::Vector3(0, 0, -9.8));
+  const Matrix angles = Matrix::Random(10, 2);
+  BatchStatics batch(robot, parameters, 2);
+  const auto link = robot.link("link_2");
+  const int j = robot.jointId("joint_2");
+
+  const BatchStaticsResult unloaded = batch.solve(angles);
+  EXPECT(assert_equal(unloaded.torques,
+                      batch.solve(angles, link->id(), Matrix::Zero(10, 6))
+                          .torques,
+                      1e-9));
+
+  // The weight of the link, reversed, in its CoM frame.
+  const CompiledRobot compiled(robot);
+  std::vector<gtsam::Pose3> poses;
+  Matrix loads(10, 6);
+  for (int r = 0; r < 10; ++r) {
+    compiled.forwardKinematics(angles.row(r).transpose(), &poses);
+    loads.row(r) << 0, 0, 0,
+        (poses[link->id()].rotation().unrotate(
+             gtsam::Point3(0, 0, 9.8 * link->mass())))
+            .transpose();
+  }
+  const BatchStaticsResult loaded = batch.solve(angles, link->id(), loads);
+  EXPECT(assert_equal(Vector(Vector::Zero(10)), Vector(loaded.torques.col(j)),
+                      1e-9));
+  EXPECT((unloaded.torques - loaded.torques).norm() > 1e-3);
+
+  CHECK_EXCEPTION(batch.solve(angles, link->id(), Matrix::Zero(9, 6)),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(batch.solve(angles, 99, loads), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
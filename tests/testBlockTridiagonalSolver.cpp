@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBlockTridiagonalSolver.cpp
+ * @brief Test solving trajectory least-squares problems by time step.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/BlockTridiagonalSolver.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::GaussianFactorGraph;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+// A chain of steps with two variables each, priors and odometry.
+TEST(BlockTridiagonalSolve, Chain) {
+  GaussianFactorGraph graph;
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(2, 0.5);
+  for (int t = 0; t < 6; t++) {
+    const gtsam::Key q = internal::JointAngleKey(0, t);
+    const gtsam::Key v = internal::JointVelKey(0, t);
+    graph.add(q, (Matrix(2, 1) << 1, t).finished(), v,
+              (Matrix(2, 1) << 0.5, -1).finished(),
+              (Vector(2) << t, 1).finished(), model);
+    if (t > 0) {
+      graph.add(internal::JointAngleKey(0, t - 1), -Matrix::Ones(1, 1), q,
+                Matrix::Ones(1, 1), (Vector(1) << 0.1).finished(),
+                gtsam::noiseModel::Unit::Create(1));
+      graph.add(internal::JointVelKey(0, t - 1), -Matrix::Ones(1, 1), q,
+                2 * Matrix::Ones(1, 1), (Vector(1) << -0.3).finished(),
+                gtsam::noiseModel::Unit::Create(1));
+    }
+  }
+  EXPECT(assert_equal(graph.optimize(), BlockTridiagonalSolve(graph), 1e-9));
+}
+
+// Linearized trajectory graph: same solution as multifrontal elimination.
+TEST(BlockTridiagonalSolve, Trajectory) {
+  auto robot = simple_rr::getRobot();
+  const int num_steps = 5;
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8),
+                                    gtsam::Vector3(1, 0, 0));
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  const gtsam::Values values =
+      ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+  graph.add(graph_builder.forwardDynamicsPriors(robot, 0, values));
+  for (auto &&link : robot.links()) {
+    graph.addPrior(internal::PoseKey(link->id(), 0), link->bMcom(),
+                   graph_builder.opt().bp_cost_model);
+    graph.addPrior<gtsam::Vector6>(internal::TwistKey(link->id(), 0),
+                                   gtsam::Z_6x1,
+                                   graph_builder.opt().bv_cost_model);
+  }
+
+  // Damping, as LM adds, makes the system well-posed at every step.
+  auto linear = graph.linearize(values);
+  for (const gtsam::Key key : linear->keys()) {
+    const size_t dim = values.at(key).dim();
+    linear->add(key, Matrix::Identity(dim, dim), Vector::Zero(dim),
+                gtsam::noiseModel::Unit::Create(dim));
+  }
+  EXPECT(assert_equal(linear->optimize(), BlockTridiagonalSolve(*linear),
+                      1e-6));
+
+  // LM with the block-tridiagonal solver reaches the same point.
+  OptimizationParameters parameters;
+  parameters.lm_parameters.setMaxIterations(5);
+  const auto expected = Optimizer(parameters).optimize(graph, values);
+  parameters.block_tridiagonal = true;
+  const auto actual = Optimizer(parameters).optimize(graph, values);
+  EXPECT(assert_equal(expected, actual, 1e-6));
+}
+
+// Factors that skip a time step are not block-tridiagonal.
+TEST(BlockTridiagonalSolve, NonConsecutive) {
+  GaussianFactorGraph graph;
+  const auto model = gtsam::noiseModel::Unit::Create(1);
+  graph.add(internal::JointAngleKey(0, 0), Matrix::Ones(1, 1),
+            (Vector(1) << 1).finished(), model);
+  graph.add(internal::JointAngleKey(0, 1), Matrix::Ones(1, 1),
+            (Vector(1) << 1).finished(), model);
+  graph.add(internal::JointAngleKey(0, 0), Matrix::Ones(1, 1),
+            internal::JointAngleKey(0, 2), Matrix::Ones(1, 1),
+            (Vector(1) << 1).finished(), model);
+  CHECK_EXCEPTION(BlockTridiagonalSolve(graph), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testBoxBounds.cpp
+ * @brief Test box bounds and bound-constrained LM.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/BoxBounds.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Symbol;
+
+TEST(BoxBounds, Projection) {
+  const gtsam::Key x = Symbol('x', 0), y = Symbol('y', 0);
+  BoxBounds bounds;
+  bounds.add(x, -1, 1);
+  EXPECT_LONGS_EQUAL(1, bounds.size());
+
+  gtsam::Values values;
+  values.insert(x, 3.0);
+  values.insert(y, 5.0);
+  EXPECT_DOUBLES_EQUAL(2.0, bounds.violation(values), 1e-12);
+  bounds.project(&values);
+  EXPECT_DOUBLES_EQUAL(1.0, values.at<double>(x), 1e-12);
+  EXPECT_DOUBLES_EQUAL(5.0, values.at<double>(y), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.0, bounds.violation(values), 1e-12);
+
+  // Steps out of the box are blocked at the bound and clipped.
+  gtsam::VectorValues delta;
+  delta.insert(x, gtsam::Vector1(0.5));
+  delta.insert(y, gtsam::Vector1(0.5));
+  EXPECT_LONGS_EQUAL(1, bounds.blocking(values, delta).size());
+  bounds.clip(values, &delta);
+  EXPECT_DOUBLES_EQUAL(0.0, delta.at(x)(0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.5, delta.at(y)(0), 1e-12);
+  delta.at(x)(0) = -3;
+  EXPECT_LONGS_EQUAL(0, bounds.blocking(values, delta).size());
+  bounds.clip(values, &delta);
+  EXPECT_DOUBLES_EQUAL(-2.0, delta.at(x)(0), 1e-12);
+
+  CHECK_EXCEPTION(bounds.add(y, 1, -1), std::invalid_argument);
+}
+
+TEST(BoxBounds, Optimizer) {
+  // min (x - 2)^2 + y^2 + (y - x)^2 with x <= 1 is at x = 1, y = 0.5.
+  const gtsam::Key x = Symbol('x', 0), y = Symbol('y', 0);
+  const auto unit = gtsam::noiseModel::Unit::Create(1);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(x, 2.0, unit);
+  graph.emplace_shared<gtsam::PriorFactor<double>>(y, 0.0, unit);
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(x, y, 0.0, unit);
+  gtsam::Values initial;
+  initial.insert(x, 0.0);
+  initial.insert(y, 0.0);
+
+  OptimizationParameters parameters;
+  parameters.lm_parameters = gtsam::LevenbergMarquardtParams();
+  parameters.bounds.add(x, -1, 1);
+  const gtsam::Values result = Optimizer(parameters).optimize(graph, initial);
+  EXPECT_DOUBLES_EQUAL(1.0, result.at<double>(x), 1e-6);
+  EXPECT_DOUBLES_EQUAL(0.5, result.at<double>(y), 1e-4);
+
+  parameters.method = OptimizationParameters::Method::PENALTY;
+  CHECK_EXCEPTION(Optimizer(parameters).optimize(graph, EqualityConstraints(),
+                                                 initial),
+                  std::invalid_argument);
+}
+
+TEST(BoxBounds, JointLimitBounds) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder(simple_rr::gravity);
+  const BoxBounds bounds = graph_builder.jointLimitBounds(robot, 3);
+  EXPECT_LONGS_EQUAL(4 * robot.numJoints(), bounds.size());
+  const auto joint = robot.joints()[0];
+  const auto &limits = joint->parameters().scalar_limits;
+  const auto &q = bounds.bounds().at(internal::JointAngleKey(joint->id(), 3));
+  EXPECT_DOUBLES_EQUAL(
+      limits.value_lower_limit + limits.value_limit_threshold, q.first, 1e-12);
+  EXPECT_DOUBLES_EQUAL(
+      limits.value_upper_limit - limits.value_limit_threshold, q.second,
+      1e-12);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,201 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCentroidalPlanner.cpp
+ * @brief Test the centroidal factors and the centroidal planner.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/dynamics/CentroidalPlanner.h"
+#include "gtdynamics/factors/CentroidalFactors.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::noiseModel::Isotropic;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector3;
+
+// Link poses with all joints at zero and the root link at the origin.
+static Values RestPoses(const Robot &robot, const std::string &root) {
+  Values angles;
+  for (auto &&joint : robot.joints())
+    InsertJointAngle(&angles, joint->id(), 0.0);
+  return robot.forwardKinematics(angles, 0, root);
+}
+
+// Mass and CoM are the weighted sums, the inertia that of the parallel axes.
+TEST(CentroidalPlanner, CompositeInertia) {
+  const Robot robot = simple_rr::getRobot();
+  const Values poses = RestPoses(robot, "link_0");
+  const CompositeInertia composite = ComputeCompositeInertia(robot, poses);
+
+  double mass = 0;
+  Point3 com = Point3::Zero();
+  for (auto &&link : robot.links()) {
+    mass += link->mass();
+    com += link->mass() * Pose(poses, link->id()).translation();
+  }
+  EXPECT_DOUBLES_EQUAL(mass, composite.mass, 1e-9);
+  EXPECT(assert_equal(Point3(com / mass), composite.com, 1e-9));
+  EXPECT(assert_equal(gtsam::Matrix3(composite.inertia.transpose()),
+                      composite.inertia, 1e-9));
+
+  // Moving the whole robot does not change the inertia about its CoM.
+  Values moved;
+  for (auto &&link : robot.links())
+    InsertPose(&moved, link->id(),
+               Pose3(gtsam::Rot3(), Point3(1, 2, 3)) *
+                   Pose(poses, link->id()));
+  EXPECT(assert_equal(composite.inertia,
+                      ComputeCompositeInertia(robot, moved).inertia, 1e-9));
+}
+
+// The centroidal step has correct Jacobians, and holds still under weight.
+TEST(CentroidalDynamicsFactor, error) {
+  const gtsam::KeyVector state_keys{1, 2, 3, 4, 5, 6};
+  const gtsam::KeyVector force_keys{7, 8};
+  const std::vector<Point3> footholds{Point3(0.2, 0.1, 0),
+                                      Point3(-0.2, -0.1, 0)};
+  const double mass = 10, dt = 0.01;
+  const Vector3 gravity(0, 0, -9.8);
+  const CentroidalDynamicsFactor factor(state_keys, force_keys, footholds,
+                                        mass, gravity, dt,
+                                        Isotropic::Sigma(9, 1e-3));
+  EXPECT_LONGS_EQUAL(8, factor.size());
+
+  Values values;
+  const Vector3 com(0, 0, 0.3), zero = Vector3::Zero();
+  for (const gtsam::Key key : {1, 4}) values.insert(key, com);
+  for (const gtsam::Key key : {2, 3, 5, 6}) values.insert(key, zero);
+  for (const gtsam::Key key : force_keys)
+    values.insert(key, Vector3(-mass * gravity / 2));
+  EXPECT(assert_equal(gtsam::Vector::Zero(9), factor.unwhitenedError(values),
+                      1e-9));
+
+  values.update(1, Vector3(0.05, -0.02, 0.28));
+  values.update(5, Vector3(0.1, 0.2, -0.3));
+  values.update(7, Vector3(3, -4, 60));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  CHECK_EXCEPTION(CentroidalDynamicsFactor(state_keys, {7}, footholds, mass,
+                                           gravity, dt,
+                                           Isotropic::Sigma(9, 1e-3)),
+                  std::invalid_argument);
+}
+
+// Forces inside the cone cost nothing, outside they have correct Jacobians.
+TEST(ForceFrictionConeFactor, error) {
+  const ForceFrictionConeFactor factor(1, Isotropic::Sigma(1, 1e-3), 0.5);
+  EXPECT(assert_equal(gtsam::Vector1(0),
+                      factor.evaluateError(Vector3(1, 1, 10)), 1e-9));
+  EXPECT(assert_equal(gtsam::Vector1(5 - 0.5 * 2),
+                      factor.evaluateError(Vector3(3, 4, 2)), 1e-9));
+
+  Values values;
+  values.insert(1, Vector3(3, 4, 2));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// The CoM of the link poses, with correct Jacobians.
+TEST(CenterOfMassFactor, error) {
+  const Robot robot = simple_rr::getRobot();
+  const Values poses = RestPoses(robot, "link_0");
+  gtsam::KeyVector keys;
+  std::vector<double> masses;
+  for (auto &&link : robot.links()) {
+    keys.push_back(internal::PoseKey(link->id(), 0));
+    masses.push_back(link->mass());
+  }
+  const Point3 com = ComputeCompositeInertia(robot, poses).com;
+  const CenterOfMassFactor factor(keys, masses, com, Isotropic::Sigma(3, 1e-3));
+  EXPECT(assert_equal(gtsam::Vector::Zero(3), factor.unwhitenedError(poses),
+                      1e-9));
+
+  Values moved;
+  for (auto &&link : robot.links())
+    InsertPose(&moved, link->id(),
+               Pose(poses, link->id()) *
+                   Pose3(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                         Point3(0.1, 0.2, 0.3)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, moved, 1e-7, 1e-5);
+}
+
+// A quadruped shifts its weight from four feet to a diagonal pair and back.
+TEST(CentroidalPlanner, trot) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  const Values nominal = RestPoses(robot, "trunk");
+  const Point3 foot(0, 0, -0.2);
+  PointOnLinks all, diagonal;
+  for (auto &&name : {"FR_lower", "FL_lower", "RR_lower", "RL_lower"})
+    all.emplace_back(robot.link(name), foot);
+  diagonal = {all[0], all[3]};
+
+  CentroidalPlannerParameters parameters;
+  parameters.dt = 0.02;
+  parameters.mu = 1.0;
+  const CentroidalPlanner planner(robot, nominal, {5, 5, 5},
+                                  {all, diagonal, all}, Vector3(0, 0, -9.8),
+                                  parameters);
+  EXPECT_LONGS_EQUAL(15, planner.numSteps());
+  EXPECT_LONGS_EQUAL(4, planner.contacts().size());
+  EXPECT_LONGS_EQUAL(1, planner.phaseOf(7));
+  EXPECT_LONGS_EQUAL(2, planner.phaseContacts(1).size());
+  EXPECT_LONGS_EQUAL(3, planner.phaseContacts(1)[1]);
+  CHECK_EXCEPTION(planner.phaseOf(15), std::out_of_range);
+
+  // Start and end at rest, at the nominal CoM.
+  const CompositeInertia &inertia = planner.inertia();
+  const int T = planner.numSteps();
+  gtsam::NonlinearFactorGraph objectives;
+  const auto model = Isotropic::Sigma(3, 1e-4);
+  for (const int k : {0, T}) {
+    objectives.addPrior<Vector3>(CentroidalPlanner::ComKey(k), inertia.com,
+                                 model);
+    objectives.addPrior<Vector3>(CentroidalPlanner::ComVelKey(k),
+                                 Vector3::Zero(), model);
+    objectives.addPrior<Vector3>(CentroidalPlanner::MomentumKey(k),
+                                 Vector3::Zero(), model);
+  }
+  const Values plan = planner.solve(objectives);
+  EXPECT(planner.graph().error(plan) < 1.0);
+
+  // The feet carry the weight.
+  Vector3 total = Vector3::Zero();
+  for (const int c : planner.phaseContacts(1))
+    total += plan.at<Vector3>(CentroidalPlanner::ContactForceKey(c, 7));
+  EXPECT_DOUBLES_EQUAL(9.8 * inertia.mass, total.z(), 1.0);
+
+  // The full initial values follow the plan, and the CoM factors agree.
+  const Values full = planner.fullInitialValues(plan, nominal);
+  EXPECT_LONGS_EQUAL((T + 1) * nominal.size(), full.size());
+  const gtsam::NonlinearFactorGraph com_factors =
+      planner.comFactors(plan, Isotropic::Sigma(3, 1e-3));
+  EXPECT_LONGS_EQUAL(T + 1, com_factors.size());
+  EXPECT_DOUBLES_EQUAL(0.0, com_factors.error(full), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
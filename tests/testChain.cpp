@@ -16,6 +16,7 @@
 #include <gtsam/geometry/Pose3.h>
 
 #include "gtdynamics/dynamics/Chain.h"
+#include "gtdynamics/utils/ThreadPool.h"
 
 using namespace gtdynamics;
 using gtsam::assert_equal;
@@ -130,6 +131,77 @@ TEST(Chain, InitChain) {
   THROWS_EXCEPTION(Chain(sMb, screwAxis5));
 }
 
+// Three-joint chain of the tests above.
+static Chain ThreeLinkChain() {
+  Pose3 sMb = Pose3(Rot3(), Point3(5, 0, 0));
+  Matrix screwAxis(6, 1);
+  screwAxis << 0.0, 0.0, 1.0, 0.0, 5.0, 0.0;
+  Chain joint(sMb, screwAxis);
+  std::vector<Chain> chains{joint, joint, joint};
+  return Chain::compose(chains);
+}
+
+// Tree reduction gives the same chain as the serial fold.
+TEST(Chain, ComposeTree) {
+  std::vector<Chain> chains;
+  for (int k = 0; k < 5; ++k) {
+    Matrix screwAxis(6, 1);
+    screwAxis << 0.1 * k, 0.0, 1.0, 0.0, 5.0, -1.0 * k;
+    chains.emplace_back(Pose3(Rot3::RzRyRx(0.1 * k, 0.2, -0.3),
+                              Point3(1, 2, k)),
+                        screwAxis);
+  }
+  const Chain expected = Chain::compose(chains);
+  const Chain serial = Chain::composeTree(chains);
+  gtdynamics::ThreadPool pool(2);
+  const Chain parallel = Chain::composeTree(chains, &pool);
+  EXPECT(assert_equal(expected.sMb(), serial.sMb(), 1e-9));
+  EXPECT(assert_equal(expected.axes(), serial.axes(), 1e-9));
+  EXPECT(assert_equal(expected.sMb(), parallel.sMb(), 1e-9));
+  EXPECT(assert_equal(expected.axes(), parallel.axes(), 1e-9));
+  EXPECT(assert_equal(Pose3(), Chain::composeTree({}).sMb()));
+}
+
+// Batch and fixed-size poe agree with Chain::poe.
+TEST(Chain, BatchAndFixedPoe) {
+  Chain chain = ThreeLinkChain();
+  Pose3 fTe(Rot3::Rx(0.3), Point3(0, 0, 1));
+  std::vector<Vector> qs;
+  for (int k = 0; k < 4; ++k)
+    qs.push_back(gtsam::Vector3(0.1 * k, -0.5, 1.0 * k));
+
+  std::vector<Pose3> poses;
+  std::vector<Matrix> Js;
+  gtdynamics::ThreadPool pool(2);
+  chain.poe(qs, &poses, &Js, fTe, &pool);
+  EXPECT_LONGS_EQUAL(4, poses.size());
+
+  using Fixed = FixedChain<3>;
+  const Fixed fixed(chain);
+  std::vector<Fixed::Angles, Eigen::aligned_allocator<Fixed::Angles>> fixed_qs;
+  for (auto &&q : qs) fixed_qs.push_back(q);
+  std::vector<Pose3> fixed_poses;
+  Fixed::Jacobians fixed_Js;
+  fixed.poe(fixed_qs, &fixed_poses, &fixed_Js, fTe);
+
+  for (size_t k = 0; k < qs.size(); ++k) {
+    Matrix J;
+    const Pose3 expected = chain.poe(qs[k], fTe, J);
+    EXPECT(assert_equal(expected, poses[k], 1e-9));
+    EXPECT(assert_equal(J, Js[k], 1e-9));
+    EXPECT(assert_equal(expected, fixed_poses[k], 1e-9));
+    EXPECT(assert_equal(J, Matrix(fixed_Js[k]), 1e-9));
+
+    Fixed::Axes J_fixed;
+    EXPECT(assert_equal(expected, fixed.poe(fixed_qs[k], fTe, &J_fixed),
+                        1e-9));
+    EXPECT(assert_equal(J, Matrix(J_fixed), 1e-9));
+  }
+
+  THROWS_EXCEPTION(FixedChain<2>(chain));
+  THROWS_EXCEPTION(chain.poe(std::vector<Vector>{Vector::Zero(2)}, &poses));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,170 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testChainDynamicsGraph.cpp
+ * @brief Test the joint-space dynamics graph of a fixed-base arm.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/dynamics/ChainDynamicsGraph.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/factors/ChainPoseFactor.h"
+#include "gtdynamics/factors/JointSpaceDynamicsFactor.h"
+#include "gtdynamics/factors/MinTorqueFactor.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+Robot robot() { return simple_rr::getRobot().fixLink("link_0"); }
+}  // namespace example
+
+// The chain reproduces the forward kinematics of the end-effector.
+TEST(ChainDynamicsGraph, chain) {
+  const Robot robot = example::robot();
+  const ChainDynamicsGraph builder(robot, "link_2");
+  EXPECT_LONGS_EQUAL(2, builder.chainJointIds().size());
+
+  const CompiledRobot compiled(robot);
+  Vector q(2);
+  q << 0.4, -1.1;
+  std::vector<Pose3> poses;
+  compiled.forwardKinematics(q, &poses);
+  Vector q_chain(2);
+  for (size_t k = 0; k < 2; ++k) q_chain(k) = q(builder.chainJointIds()[k]);
+  const int ee = robot.link("link_2")->id();
+  EXPECT(assert_equal(poses[ee], builder.chain().poe(q_chain), 1e-9));
+
+  CHECK_EXCEPTION(ChainDynamicsGraph(simple_rr::getRobot(), "link_2"),
+                  std::invalid_argument);
+}
+
+// The dynamics factor vanishes at the inverse dynamics solution, and has
+// correct Jacobians.
+TEST(JointSpaceDynamicsFactor, error) {
+  const Robot robot = example::robot();
+  const OptimizerSetting opt;
+  const int t = 2;
+  const JointSpaceDynamicsFactor factor(robot, t, opt.t_cost_model,
+                                        example::gravity);
+  EXPECT_LONGS_EQUAL(8, factor.size());
+  EXPECT_LONGS_EQUAL(2, factor.dim());
+
+  RecursiveDynamics dynamics(robot, example::gravity);
+  RecursiveDynamicsResult result;
+  dynamics.allocate(&result);
+  Vector q(2), v(2), a(2);
+  q << 0.3, -0.7;
+  v << 1.1, -0.4;
+  a << 0.2, -0.5;
+  dynamics.inverseDynamics(q, v, a, &result);
+
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, t, q(j));
+    InsertJointVel(&values, j, t, v(j));
+    InsertJointAccel(&values, j, t, a(j));
+    InsertTorque(&values, j, t, result.torques(j));
+  }
+  EXPECT(assert_equal(Vector::Zero(2), factor.unwhitenedError(values), 1e-9));
+
+  values.update(internal::TorqueKey(1, t), 3.0);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// The pose factor is the local coordinates of the chain pose.
+TEST(ChainPoseFactor, error) {
+  const Robot robot = example::robot();
+  const ChainDynamicsGraph builder(robot, "link_2");
+  const Pose3 target(gtsam::Rot3::Rx(0.2), gtsam::Point3(0, 0.5, 1.5));
+  const Pose3 fTe(gtsam::Rot3(), gtsam::Point3(0, 0, 0.5));
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(6, 0.01);
+  const auto graph = builder.targetPoseFactors(0, target, model, fTe);
+  EXPECT_LONGS_EQUAL(1, graph.size());
+
+  Values values;
+  Vector q_chain(2);
+  q_chain << 0.3, -0.8;
+  for (size_t k = 0; k < 2; ++k)
+    InsertJointAngle(&values, builder.chainJointIds()[k], 0, q_chain(k));
+  Pose3 fTe_copy = fTe;
+  const Pose3 wTe = builder.chain().poe(q_chain, fTe_copy);
+  const auto factor = boost::dynamic_pointer_cast<ChainPoseFactor>(graph[0]);
+  EXPECT(factor != nullptr);
+  EXPECT(assert_equal(target.localCoordinates(wTe),
+                      factor->unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+}
+
+// Swing the arm to a reachable end-effector pose, with joint-space
+// variables only.
+TEST(ChainDynamicsGraph, trajectory) {
+  const Robot robot = example::robot();
+  const OptimizerSetting opt;
+  const ChainDynamicsGraph builder(robot, "link_2", opt, example::gravity);
+  const int num_steps = 10;
+  const double dt = 0.1;
+
+  Vector q_goal(2);
+  q_goal << 0.5, -0.4;
+  Vector q_chain(2);
+  for (size_t k = 0; k < 2; ++k)
+    q_chain(k) = q_goal(builder.chainJointIds()[k]);
+  const Pose3 target = builder.chain().poe(q_chain);
+
+  auto graph = builder.trajectoryFG(num_steps, dt);
+  graph.add(builder.targetPoseFactors(
+      num_steps, target, gtsam::noiseModel::Isotropic::Sigma(6, 1e-3)));
+  const auto prior = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  const auto weak = gtsam::noiseModel::Isotropic::Sigma(1, 10.0);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph.emplace_shared<gtsam::PriorFactor<double>>(
+        internal::JointAngleKey(j, 0), 0.0, prior);
+    graph.emplace_shared<gtsam::PriorFactor<double>>(
+        internal::JointVelKey(j, 0), 0.0, prior);
+    graph.emplace_shared<gtsam::PriorFactor<double>>(
+        internal::JointVelKey(j, num_steps), 0.0, prior);
+    for (int t = 0; t <= num_steps; ++t)
+      graph.emplace_shared<MinTorqueFactor>(internal::TorqueKey(j, t), weak);
+  }
+
+  const Values init = builder.initialValues(num_steps, Vector::Zero(2));
+  EXPECT_LONGS_EQUAL(4 * 2 * (num_steps + 1), init.size());
+  const Values result =
+      gtsam::LevenbergMarquardtOptimizer(graph, init).optimize();
+
+  const auto pose_factor = builder.targetPoseFactors(
+      num_steps, target, gtsam::noiseModel::Isotropic::Sigma(6, 1e-3));
+  EXPECT(pose_factor.error(result) < 1e-2);
+  EXPECT_DOUBLES_EQUAL(0, builder.dynamicsFactors(num_steps / 2).error(result),
+                       1e-3);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testClosedChainDynamics.cpp
+ * @brief Test closed-chain kinematics and dynamics on a four-bar linkage.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/ClosedChainDynamics.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Vector;
+
+namespace example {
+Robot robot() { return four_bar_linkage_pure::getRobot().fixLink("l1"); }
+}  // namespace example
+
+// One joint is cut, and the rest assembly closes the loop.
+TEST(ClosedChainDynamics, spanningTree) {
+  const Robot robot = example::robot();
+  const ClosedChainDynamics dynamics(robot, {"j1"});
+  EXPECT_LONGS_EQUAL(1, dynamics.loopJointIds().size());
+  EXPECT_LONGS_EQUAL(3, dynamics.tree().numJoints());
+  EXPECT_LONGS_EQUAL(4, robot.numJoints());
+  EXPECT_LONGS_EQUAL(3, dynamics.dependentJointIds().size());
+  EXPECT_LONGS_EQUAL(6, dynamics.numConstraints());
+  EXPECT(assert_equal(Vector::Zero(6),
+                      dynamics.loopClosureError(Vector::Zero(4)), 1e-9));
+
+  // Floating mechanisms are not supported.
+  CHECK_EXCEPTION(
+      ClosedChainDynamics(four_bar_linkage_pure::getRobot(), {"j1"}),
+      std::invalid_argument);
+}
+
+// Driving one joint of the parallelogram moves the others in step.
+TEST(ClosedChainDynamics, kinematics) {
+  const Robot robot = example::robot();
+  const ClosedChainDynamics dynamics(robot, {"j1"});
+  const int j1 = robot.joint("j1")->id();
+
+  Vector q = Vector::Zero(4), expected(4);
+  q(j1) = 0.3;
+  EXPECT(dynamics.solvePositions(&q) > 0);
+  for (auto &&joint : robot.joints())
+    expected(joint->id()) = (joint->id() - j1) % 2 == 0 ? 0.3 : -0.3;
+  EXPECT(assert_equal(expected, q, 1e-8));
+  EXPECT(assert_equal(Vector::Zero(6), dynamics.loopClosureError(q), 1e-9));
+
+  Vector v = Vector::Zero(4);
+  v(j1) = 2.0;
+  dynamics.solveVelocities(q, &v);
+  EXPECT(assert_equal(Vector(2.0 * expected / 0.3), v, 1e-8));
+}
+
+// Same accelerations as the factor graph of testDynamicsGraph, and inverse
+// dynamics recovers an equivalent torque at the independent joint.
+TEST(ClosedChainDynamics, dynamics) {
+  const Robot robot = example::robot();
+  const ClosedChainDynamics dynamics(robot, {"j1"});
+
+  const Vector q = Vector::Zero(4), v = Vector::Zero(4);
+  const Vector tau = (Vector(4) << 1, 0, 1, 0).finished();
+  Vector a;
+  dynamics.forwardDynamics(q, v, tau, &a);
+  const Vector expected = (Vector(4) << 0.25, -0.25, 0.25, -0.25).finished();
+  EXPECT(assert_equal(expected, a, 1e-9));
+
+  Vector a_id = a, tau_id;
+  dynamics.inverseDynamics(q, v, &a_id, &tau_id);
+  EXPECT(assert_equal(a, a_id, 1e-9));
+  const int j1 = robot.joint("j1")->id();
+  EXPECT_DOUBLES_EQUAL(0.0, tau_id.sum() - tau_id(j1), 1e-12);
+  Vector a_fd;
+  dynamics.forwardDynamics(q, v, tau_id, &a_fd);
+  EXPECT(assert_equal(a, a_fd, 1e-9));
+
+  // In motion and under gravity, forward and inverse dynamics agree.
+  const ClosedChainDynamics heavy(robot, {"j1"}, gtsam::Vector3(0, 0, -9.8));
+  Vector q1 = Vector::Zero(4), v1 = Vector::Zero(4);
+  q1(j1) = 0.4;
+  v1(j1) = -1.5;
+  heavy.solvePositions(&q1);
+  heavy.solveVelocities(q1, &v1);
+  Vector a1 = Vector::Zero(4), tau1;
+  a1(j1) = 0.7;
+  heavy.inverseDynamics(q1, v1, &a1, &tau1);
+  Vector a1_fd;
+  heavy.forwardDynamics(q1, v1, tau1, &a1_fd);
+  EXPECT(assert_equal(a1, a1_fd, 1e-8));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCollisionSphereModel.cpp
+ * @brief Test the flat collision sphere model and its world centers.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/universal_robot/CollisionSphereModel.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/utils.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+
+TEST(CollisionSphereModel, Layout) {
+  const Robot robot = simple_rr::getRobot();
+  const int l1 = robot.link("link_1")->id(), l2 = robot.link("link_2")->id();
+  const CollisionSphereModel model = CollisionSphereModel::FromLinkLengths(
+      robot, {"link_1", "link_2"}, {0.4, 0.0}, {0.1, 0.05});
+
+  // Four spheres along link_1, one at the COM of link_2.
+  EXPECT_LONGS_EQUAL(5, model.numSpheres());
+  EXPECT_LONGS_EQUAL(4, model.numSpheres(l1));
+  EXPECT_LONGS_EQUAL(1, model.numSpheres(l2));
+  EXPECT_LONGS_EQUAL(2, model.linkIds().size());
+  for (size_t s = model.begin(l1); s < model.end(l1); s++)
+    EXPECT_LONGS_EQUAL(l1, model.links()[s]);
+
+  const auto centers = sphereCenters({0.4}, {0.1});
+  const CollisionSpheres spheres = model.spheres(l1);
+  EXPECT_LONGS_EQUAL(4, spheres.size());
+  for (size_t k = 0; k < spheres.size(); k++) {
+    EXPECT(assert_equal(centers[0][k], spheres[k].center));
+    EXPECT_DOUBLES_EQUAL(0.1, spheres[k].radius, 1e-12);
+  }
+  EXPECT(model.spheres(robot.link("link_0")->id()).empty());
+}
+
+TEST(CollisionSphereModel, WorldCenters) {
+  const Robot robot = simple_rr::getRobot();
+  const CollisionSphereModel model = CollisionSphereModel::FromLinkLengths(
+      robot, {"link_0", "link_1", "link_2"}, {0.2, 0.4, 0.3},
+      {0.1, 0.1, 0.1});
+  const CompiledRobot &compiled = model.compiledRobot();
+
+  gtsam::Vector q = gtsam::Vector::Zero(compiled.numJointSlots());
+  q(robot.joint("joint_1")->id()) = 0.3;
+  q(robot.joint("joint_2")->id()) = -0.7;
+  std::vector<Pose3> poses;
+  gtsam::Matrix centers;
+  model.worldCenters(q, &poses, &centers);
+  EXPECT_LONGS_EQUAL(3, centers.rows());
+  EXPECT_LONGS_EQUAL(model.numSpheres(), centers.cols());
+
+  // Same as transforming each sphere by its link pose.
+  for (size_t s = 0; s < model.numSpheres(); s++) {
+    const Point3 expected = poses[model.links()[s]].transformFrom(
+        Point3(model.centers().col(s)));
+    EXPECT(assert_equal(expected, Point3(centers.col(s)), 1e-12));
+  }
+}
+
+TEST(CollisionSphereModel, FromMeshes) {
+  const Robot robot = simple_rr::getRobot();
+  const std::string meshes = std::string(kSdfPath) + "meshes/";
+  const CollisionSphereModel model = CollisionSphereModel::FromMeshes(
+      robot,
+      {{"link_0", meshes + "link_0.stl"}, {"link_1", meshes + "link_1.stl"}},
+      4);
+  const int l0 = robot.link("link_0")->id(), l1 = robot.link("link_1")->id();
+  CHECK(model.numSpheres(l0) > 0 && model.numSpheres(l0) <= 4);
+  CHECK(model.numSpheres(l1) > 0 && model.numSpheres(l1) <= 4);
+  EXPECT_LONGS_EQUAL(model.numSpheres(l0) + model.numSpheres(l1),
+                     model.numSpheres());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
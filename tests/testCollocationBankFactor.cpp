@@ -0,0 +1,121 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCollocationBankFactor.cpp
+ * @brief Test joint collocation of several joints and steps in one factor.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/factors/CollocationBankFactor.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const int t = 3, num_steps = 4;
+const double dt = 0.1;
+
+// Joint angles, velocities and accelerations of all joints, steps t..t+4.
+Values JointValues(const Robot &robot) {
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    for (int k = t; k <= t + num_steps; k++) {
+      InsertJointAngle(&values, j, k, std::sin(j + 0.3 * k));
+      InsertJointVel(&values, j, k, std::cos(j + 0.7 * k));
+      InsertJointAccel(&values, j, k, std::sin(2 * j - 0.5 * k));
+    }
+  }
+  return values;
+}
+}  // namespace example
+
+// A bank has the error of the separate collocation factors.
+TEST(CollocationBankFactor, SameError) {
+  using namespace example;
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder;
+  const Values values = JointValues(robot);
+  const OptimizerSetting opt;
+  std::vector<int> joint_ids;
+  for (auto &&joint : robot.joints()) joint_ids.push_back(joint->id());
+
+  for (auto collocation :
+       {CollocationScheme::Euler, CollocationScheme::Trapezoidal,
+        CollocationScheme::HermiteSimpson}) {
+    NonlinearFactorGraph expected;
+    for (int k = t; k < t + num_steps; k++)
+      expected.add(graph_builder.collocationFactors(robot, k, dt, collocation));
+
+    const CollocationBankFactor factor(joint_ids, t, num_steps, dt,
+                                       opt.q_col_cost_model,
+                                       opt.v_col_cost_model, collocation);
+    EXPECT_LONGS_EQUAL(2, factor.numJoints());
+    EXPECT_LONGS_EQUAL(expected.size(), factor.dim());
+    const gtsam::KeySet keys(factor.keys().begin(), factor.keys().end());
+    EXPECT(assert_equal(expected.keys(), keys));
+    EXPECT_DOUBLES_EQUAL(expected.error(values), factor.error(values), 1e-9);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+    const auto banks = graph_builder.collocationBankFactors(
+        robot, t, num_steps, dt, collocation);
+    EXPECT_LONGS_EQUAL(robot.numJoints(), banks.size());
+    EXPECT_DOUBLES_EQUAL(expected.error(values), banks.error(values), 1e-9);
+  }
+}
+
+TEST(CollocationBankFactor, Unsupported) {
+  const OptimizerSetting opt;
+  THROWS_EXCEPTION(CollocationBankFactor({0}, 0, 1, 0.1, opt.q_col_cost_model,
+                                         opt.v_col_cost_model,
+                                         CollocationScheme::RungeKutta));
+  THROWS_EXCEPTION(CollocationBankFactor({0}, 0, 0, 0.1, opt.q_col_cost_model,
+                                         opt.v_col_cost_model));
+  THROWS_EXCEPTION(CollocationBankFactor(
+      {0}, 0, 1, 0.1, gtsam::noiseModel::Isotropic::Sigma(2, 0.1),
+      opt.v_col_cost_model));
+}
+
+// Banked trajectories have the same error, with fewer factors, also when the
+// number of steps is not a multiple of the bank size.
+TEST(CollocationBankFactor, Trajectory) {
+  const Robot robot = simple_rr::getRobot();
+  const int num_steps = 7;
+  const double dt = 0.1;
+  OptimizerSetting opt;
+  opt.setCollocationBank(3);
+  const DynamicsGraph separate, banked(opt);
+  const auto expected = separate.trajectoryFG(robot, num_steps, dt);
+  const auto actual = banked.trajectoryFG(robot, num_steps, dt);
+
+  const Values values = ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+  EXPECT(assert_equal(expected.keys(), actual.keys()));
+  EXPECT_LONGS_EQUAL(expected.size() - 2 * num_steps * robot.numJoints() +
+                         3 * robot.numJoints(),
+                     actual.size());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -200,6 +200,71 @@ TEST(RandomData, TrapezoidalTwist) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, diffDelta, 1e-3);
 }
 
+TEST(RandomData, EulerDouble) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::Symbol x0_key('q', 1), x1_key('q', 2), v0_key('v', 1),
+      dt_key('t', 0);
+  EulerDoubleCollocationFactor factor(x0_key, x1_key, v0_key, dt_key,
+                                      cost_model);
+
+  const double x0 = 0.3, v0 = -1.5, dt = 0.2, x1 = x0 + dt * v0;
+  EXPECT(assert_equal(gtsam::Vector1(0.0),
+                      factor.evaluateError(x0, x1, v0, dt), 1e-9));
+  EXPECT(assert_equal(gtsam::Vector1(0.5),
+                      factor.evaluateError(x0, x1 - 0.5, v0, dt), 1e-9));
+
+  gtsam::Values values;
+  values.insert(x0_key, x0);
+  values.insert(x1_key, x1 + 0.1);
+  values.insert(v0_key, v0);
+  values.insert(dt_key, dt);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(RandomData, TrapezoidalDouble) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::Symbol x0_key('q', 1), x1_key('q', 2), v0_key('v', 1),
+      v1_key('v', 2), dt_key('t', 0);
+  TrapezoidalDoubleCollocationFactor factor(x0_key, x1_key, v0_key, v1_key,
+                                            dt_key, cost_model);
+
+  const double x0 = 0.3, v0 = -1.5, v1 = 2.0, dt = 0.2,
+               x1 = x0 + 0.5 * dt * (v0 + v1);
+  EXPECT(assert_equal(gtsam::Vector1(0.0),
+                      factor.evaluateError(x0, x1, v0, v1, dt), 1e-9));
+
+  gtsam::Values values;
+  values.insert(x0_key, x0);
+  values.insert(x1_key, x1 - 0.2);
+  values.insert(v0_key, v0);
+  values.insert(v1_key, v1);
+  values.insert(dt_key, dt);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(RandomData, HermiteSimpsonDouble) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  gtsam::Symbol x0_key('q', 1), x1_key('q', 2), v0_key('v', 1),
+      v1_key('v', 2), a0_key('a', 1), a1_key('a', 2), dt_key('t', 0);
+  HermiteSimpsonDoubleCollocationFactor factor(
+      x0_key, x1_key, v0_key, v1_key, a0_key, a1_key, dt_key, cost_model);
+
+  // Exact for x = t^3 from t = 1 to t = 1.5.
+  gtsam::Values values;
+  values.insert(x0_key, 1.0);
+  values.insert(x1_key, 3.375);
+  values.insert(v0_key, 3.0);
+  values.insert(v1_key, 6.75);
+  values.insert(a0_key, 6.0);
+  values.insert(a1_key, 9.0);
+  values.insert(dt_key, 0.5);
+  EXPECT(assert_equal(gtsam::Vector1(0.0), factor.unwhitenedError(values),
+                      1e-9));
+
+  values.update(x1_key, 3.0);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
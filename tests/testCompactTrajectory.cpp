@@ -0,0 +1,137 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompactTrajectory.cpp
+ * @brief Test storing trajectories in joint space.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/CompactTrajectory.h"
+#include "gtdynamics/utils/TrajectoryFile.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+
+namespace example {
+// A trajectory of the floating simple_rr robot with consistent link states.
+Values trajectory(const Robot &robot, int num_steps) {
+  const CompiledRobot compiled(robot);
+  const int root = robot.link("link_0")->id();
+  Values values;
+  for (int t = 0; t <= num_steps; ++t) {
+    gtsam::Vector q = gtsam::Vector::Zero(compiled.numJointSlots()), v = q;
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      q(j) = 0.1 * t - 0.3 * j;
+      v(j) = 0.2 + 0.1 * j;
+      InsertJointAngle(&values, j, t, q(j));
+      InsertJointVel(&values, j, t, v(j));
+      InsertJointAccel(&values, j, t, -0.5 * t);
+      InsertTorque(&values, j, t, 1.5 * j);
+    }
+    std::vector<Pose3> poses(compiled.numLinkSlots());
+    gtsam::Matrix twists = gtsam::Matrix::Zero(6, compiled.numLinkSlots());
+    poses[root] = Pose3(gtsam::Rot3::Rz(0.1 * t), gtsam::Point3(t, 0, 1));
+    twists.col(root) << 0, 0, 0.1, 1, 0, 0;
+    compiled.forwardKinematics(q, v, &poses, &twists);
+    for (auto &&link : robot.links()) {
+      InsertPose(&values, link->id(), t, poses[link->id()]);
+      InsertTwist(&values, link->id(), t,
+                  gtsam::Vector6(twists.col(link->id())));
+    }
+    values.insert(ContactWrenchKey(2, 0, t),
+                  (gtsam::Vector6() << 0, 0, 0, 0, 0, 9.8 * t).finished());
+  }
+  return values;
+}
+}  // namespace example
+
+// Link states are reconstructed from the joint space state and the root.
+TEST(CompactTrajectory, Reconstruct) {
+  const Robot robot = simple_rr::getRobot();
+  const int num_steps = 3;
+  const Values values = example::trajectory(robot, num_steps);
+  const CompactTrajectory trajectory(robot, values, num_steps);
+
+  EXPECT_LONGS_EQUAL(num_steps + 1, trajectory.numSteps());
+  EXPECT_LONGS_EQUAL(1, trajectory.contactWrenches().size());
+  EXPECT_DOUBLES_EQUAL(JointAngle(values, 1, 2), trajectory.jointAngles()(1, 2),
+                       0);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(Pose(values, i, 2), trajectory.pose(i, 2), 1e-9));
+    EXPECT(assert_equal(Twist(values, i, 2), trajectory.twist(i, 2), 1e-9));
+  }
+  EXPECT(assert_equal(values, trajectory.toValues(), 1e-9));
+  THROWS_EXCEPTION(trajectory.poses(num_steps + 1));
+
+  // Only the joint space, root states and contacts are kept.
+  EXPECT(trajectory.storageBytes() < values.size() * 6 * sizeof(double) / 2);
+
+  // The root pose is needed.
+  Values no_root = values;
+  no_root.erase(internal::PoseKey(robot.link("link_0")->id(), 1));
+  CHECK_EXCEPTION(CompactTrajectory(robot, no_root, num_steps),
+                  std::invalid_argument);
+}
+
+TEST(CompactTrajectory, SaveLoad) {
+  const Robot robot = simple_rr::getRobot();
+  const int num_steps = 2;
+  const Values values = example::trajectory(robot, num_steps);
+  const std::string filename = "compact_trajectory_test.bin";
+  CompactTrajectory(robot, values, num_steps).save(filename);
+  const CompactTrajectory loaded = CompactTrajectory::Load(robot, filename);
+  EXPECT(assert_equal(values, loaded.toValues(), 1e-9));
+  CHECK_EXCEPTION(
+      CompactTrajectory::Load(robot.fixLink("link_0"), filename),
+      std::runtime_error);
+  std::remove(filename.c_str());
+  CHECK_EXCEPTION(CompactTrajectory::Load(robot, filename),
+                  std::runtime_error);
+}
+
+// The joint matrices are written as a columnar file, for replay.
+TEST(CompactTrajectory, SaveColumnar) {
+  const Robot robot = simple_rr::getRobot();
+  const int num_steps = 3;
+  const Values values = example::trajectory(robot, num_steps);
+  const CompactTrajectory trajectory(robot, values, num_steps);
+  const std::string filename = "compact_trajectory_test.gtdtraj";
+  trajectory.saveColumnar(filename);
+  {
+    const TrajectoryFile file(filename);
+    EXPECT_LONGS_EQUAL(num_steps + 1, file.numSteps());
+    EXPECT_LONGS_EQUAL(4, file.quantities().size());
+    for (int t = 0; t <= num_steps; ++t) {
+      EXPECT(assert_equal(gtsam::Vector(trajectory.jointAngles().col(t)),
+                          file.jointValues("q", t)));
+      EXPECT(assert_equal(gtsam::Vector(trajectory.torques().col(t)),
+                          file.jointValues("tau", t)));
+    }
+    EXPECT_DOUBLES_EQUAL(JointVel(values, 1, 2), file.entity("v", 1)(2, 0), 0);
+  }
+  std::remove(filename.c_str());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
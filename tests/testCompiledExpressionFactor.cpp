@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompiledExpressionFactor.cpp
+ * @brief Test expression factors evaluated into a preallocated tape.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "constrainedExample.h"
+#include "gtdynamics/factors/PointGoalFactor.h"
+#include "gtdynamics/optimizer/CompiledExpressionFactor.h"
+#include "gtdynamics/optimizer/EqualityConstraint.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+using constrained_example::x1_key, constrained_example::x2_key;
+using constrained_example::x1, constrained_example::x2;
+using constrained_example::pow;
+
+// Same errors, Jacobians and linearization as ExpressionFactor.
+TEST(CompiledExpressionFactor, Double) {
+  const Double_ g = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  const auto model = noiseModel::Isotropic::Sigma(1, 0.1);
+  const ExpressionFactor<double> expected(model, 0.5, g);
+  const CompiledExpressionFactor<double> factor(model, 0.5, g);
+
+  Values values;
+  values.insert(x1_key, 0.3);
+  values.insert(x2_key, -1.2);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), factor.error(values), 1e-12);
+  EXPECT(assert_equal(*expected.linearize(values), *factor.linearize(values),
+                      1e-12));
+
+  // Evaluating again reuses the tape.
+  values.update(x1_key, 2.0);
+  std::vector<Matrix> H_expected(2), H(2);
+  EXPECT(assert_equal(expected.unwhitenedError(values, H_expected),
+                      factor.unwhitenedError(values, H), 1e-12));
+  EXPECT(assert_equal(H_expected[0], H[0], 1e-12));
+  EXPECT(assert_equal(H_expected[1], H[1], 1e-12));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  // A clone has its own tape.
+  const auto clone = factor.clone();
+  EXPECT_DOUBLES_EQUAL(expected.error(values), clone->error(values), 1e-12);
+  EXPECT(assert_equal(*expected.linearize(values), *clone->linearize(values),
+                      1e-12));
+}
+
+TEST(CompiledExpressionFactor, Vector3) {
+  const Key pose_key = 7;
+  const Point3 point_com(0.1, 0.2, 0.3), goal(1, 2, 3);
+  const auto model = noiseModel::Diagonal::Sigmas(Vector3(0.1, 0.2, 0.3));
+  const Vector3_ g = PointGoalConstraint(pose_key, point_com, goal);
+  const ExpressionFactor<Vector3> expected(model, Vector3(0.1, 0, 0), g);
+  const CompiledExpressionFactor<Vector3> factor(model, Vector3(0.1, 0, 0), g);
+
+  Values values;
+  values.insert(pose_key, Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(1, 0, 2)));
+  EXPECT(assert_equal(expected.unwhitenedError(values),
+                      factor.unwhitenedError(values), 1e-12));
+  EXPECT(assert_equal(*expected.linearize(values), *factor.linearize(values),
+                      1e-12));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// Constraints create compiled merit factors.
+TEST(CompiledExpressionFactor, createFactor) {
+  const DoubleExpressionEquality scalar(x1 + x2, 0.1);
+  EXPECT(boost::dynamic_pointer_cast<CompiledExpressionFactor<double>>(
+      scalar.createFactor(1.0)));
+
+  const Vector2_ g(x1_key);
+  const VectorExpressionEquality<2> vector(g, Vector2(0.1, 0.1));
+  EXPECT(boost::dynamic_pointer_cast<CompiledExpressionFactor<Vector2>>(
+      vector.createFactor(1.0)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,213 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCompiledRobot.cpp
+ * @brief Test the flattened robot view.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+
+// Id-indexed arrays mirror the links and joints of the robot.
+TEST(CompiledRobot, id_indexed) {
+  auto robot = simple_urdf::getRobot();
+  CompiledRobot compiled(robot);
+
+  EXPECT_LONGS_EQUAL(2, compiled.numLinkSlots());
+  EXPECT_LONGS_EQUAL(1, compiled.numJointSlots());
+  EXPECT(!compiled.hasFloatingRoot());
+
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(link->inertiaMatrix(), compiled.inertias()[i]));
+    EXPECT_DOUBLES_EQUAL(link->mass(), compiled.masses()(i), 1e-9);
+    EXPECT(link->isFixed() == compiled.isFixed()[i]);
+  }
+
+  auto joint = robot.joint("j1");
+  const int j = joint->id();
+  EXPECT_LONGS_EQUAL(joint->parent()->id(), compiled.jointParentLinks()[j]);
+  EXPECT_LONGS_EQUAL(joint->child()->id(), compiled.jointChildLinks()[j]);
+  EXPECT(assert_equal(joint->jMp(), compiled.jMp()[j]));
+  EXPECT(assert_equal(joint->jMc(), compiled.jMc()[j]));
+  EXPECT(assert_equal(gtsam::Vector(joint->cScrewAxis()),
+                      gtsam::Vector(compiled.childScrewAxes().col(j))));
+  EXPECT_LONGS_EQUAL(joint->parent()->id(),
+                     compiled.parentLinks()[joint->child()->id()]);
+  EXPECT_LONGS_EQUAL(-1, compiled.parentLinks()[joint->parent()->id()]);
+}
+
+// Parents come first, and the node arrays reproduce the joint transforms.
+TEST(CompiledRobot, traversal) {
+  auto robot = simple_rr::getRobot();
+  CompiledRobot compiled(robot);
+
+  EXPECT_LONGS_EQUAL(robot.links().size(), compiled.numNodes());
+  EXPECT(compiled.hasFloatingRoot());
+  EXPECT_LONGS_EQUAL(-1, compiled.parentNodes()[0]);
+  EXPECT_LONGS_EQUAL(-1, compiled.jointIds()[0]);
+
+  const double q = 0.7;
+  for (size_t n = 1; n < compiled.numNodes(); ++n) {
+    const int parent = compiled.parentNodes()[n];
+    EXPECT(parent >= 0 && size_t(parent) < n);
+
+    const auto &link = compiled.links()[n];
+    EXPECT_LONGS_EQUAL(link->id(), compiled.linkIds()[n]);
+    const auto joint = robot.joints()[0]->id() == compiled.jointIds()[n]
+                           ? robot.joints()[0]
+                           : robot.joints()[1];
+    EXPECT(compiled.alongJoint()[n] == (joint->child() == link));
+
+    const gtsam::Vector6 S = compiled.screwAxes().col(n);
+    const Pose3 expected = joint->relativePoseOf(link, q);
+    const Pose3 actual =
+        compiled.restPoses()[n] * Pose3::Expmap(S * q);
+    EXPECT(assert_equal(expected, actual, 1e-9));
+  }
+}
+
+// Array forward kinematics agrees with Robot::forwardKinematics.
+TEST(CompiledRobot, forwardKinematics) {
+  auto robot = simple_rr::getRobot();
+  CompiledRobot compiled(robot);
+  const auto root = compiled.links()[0];
+
+  gtsam::Vector q = gtsam::Vector::Zero(compiled.numJointSlots());
+  gtsam::Vector v = gtsam::Vector::Zero(compiled.numJointSlots());
+  for (auto &&joint : robot.joints()) {
+    q(joint->id()) = 0.3 - 1.5 * joint->id();
+    v(joint->id()) = 0.5 + joint->id();
+  }
+  const Pose3 wTroot(gtsam::Rot3::Rz(0.4), gtsam::Point3(1, 2, 3));
+  gtsam::Vector6 V_root;
+  V_root << 0.1, 0.2, 0.3, 0.4, 0.5, 0.6;
+
+  gtsam::Values known_values;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known_values, joint->id(), q(joint->id()));
+    InsertJointVel(&known_values, joint->id(), v(joint->id()));
+  }
+  InsertPose(&known_values, root->id(), wTroot);
+  InsertTwist(&known_values, root->id(), V_root);
+  const gtsam::Values expected =
+      robot.forwardKinematics(known_values, 0, root->name());
+
+  // Floating root state is taken from the buffers.
+  std::vector<Pose3> poses(compiled.numLinkSlots());
+  gtsam::Matrix twists = gtsam::Matrix::Zero(6, compiled.numLinkSlots());
+  poses[root->id()] = wTroot;
+  twists.col(root->id()) = V_root;
+  compiled.forwardKinematics(q, v, &poses, &twists);
+
+  std::vector<Pose3> poses_only(compiled.numLinkSlots());
+  poses_only[root->id()] = wTroot;
+  compiled.forwardKinematics(q, &poses_only);
+
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(Pose(expected, i), poses[i], 1e-9));
+    EXPECT(assert_equal(Pose(expected, i), poses_only[i], 1e-9));
+    EXPECT(assert_equal(Twist(expected, i), gtsam::Vector6(twists.col(i)),
+                        1e-9));
+  }
+}
+
+// Link Jacobians and Jdot * v on a quadruped, a tree with a floating base.
+TEST(CompiledRobot, jacobians) {
+  auto robot =
+      CreateRobotFromFile(kUrdfPath + std::string("vision60.urdf"), "spider");
+  CompiledRobot compiled(robot);
+  const size_t J = compiled.numJointSlots(), L = compiled.numLinkSlots();
+  const int root = compiled.linkIds()[0];
+
+  gtsam::Vector q(J), v(J);
+  for (size_t j = 0; j < J; ++j) {
+    q(j) = 0.2 - 0.1 * j;
+    v(j) = 0.5 - 0.3 * j;
+  }
+  const Pose3 wTroot(gtsam::Rot3::RzRyRx(0.1, 0.2, 0.3),
+                     gtsam::Point3(1, 2, 3));
+  gtsam::Vector6 V_root;
+  V_root << 0.1, -0.2, 0.3, 0.4, 0.5, -0.6;
+
+  // Twists at the given angles, with the root state in the buffers.
+  const auto fk = [&](const gtsam::Vector &angles, std::vector<Pose3> *poses,
+                      gtsam::Matrix *twists, const gtsam::Vector6 &V) {
+    poses->assign(L, Pose3());
+    (*poses)[root] = wTroot;
+    twists->setZero(6, L);
+    twists->col(root) = V;
+    compiled.forwardKinematics(angles, v, poses, twists);
+  };
+  std::vector<Pose3> poses;
+  gtsam::Matrix twists, accels;
+  fk(q, &poses, &twists, gtsam::Vector6::Zero());
+
+  std::vector<int> feet;
+  for (auto &&name : {"lower0", "lower1", "lower2", "lower3"})
+    feet.push_back(robot.link(name)->id());
+  std::vector<gtsam::Matrix> J_b, J_s;
+  compiled.bodyJacobians(poses, feet, &J_b);
+  compiled.spatialJacobians(poses, feet, &J_s);
+  EXPECT_LONGS_EQUAL(4, J_b.size());
+  for (size_t k = 0; k < feet.size(); ++k) {
+    const int i = feet[k];
+    EXPECT(assert_equal(gtsam::Vector(twists.col(i)), J_b[k] * v, 1e-9));
+    EXPECT(assert_equal(gtsam::Matrix(poses[i].AdjointMap() * J_b[k]), J_s[k],
+                        1e-9));
+    // Only the three joints of the leg move the foot.
+    EXPECT_LONGS_EQUAL(3, (J_b[k].colwise().norm().array() > 0).count());
+  }
+
+  // Jdot * v is the derivative of the twists along q + v t, for a moving
+  // root that does not accelerate.
+  poses[root] = wTroot;
+  twists.col(root) = V_root;
+  compiled.biasAccelerations(q, v, &poses, &twists, &accels);
+  const double h = 1e-5;
+  std::vector<Pose3> poses_p, poses_m;
+  gtsam::Matrix twists_p, twists_m;
+  fk(q + h * v, &poses_p, &twists_p, V_root);
+  fk(q - h * v, &poses_m, &twists_m, V_root);
+  const gtsam::Matrix expected = (twists_p - twists_m) / (2 * h);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(gtsam::Vector(expected.col(i)),
+                        gtsam::Vector(accels.col(i)), 1e-6));
+  }
+
+  gtsam::Matrix J_unused;
+  CHECK_EXCEPTION(compiled.bodyJacobian(poses, L, &J_unused),
+                  std::invalid_argument);
+}
+
+// Closed loops cannot be handled by a tree traversal.
+TEST(CompiledRobot, four_bar_linkage) {
+  auto robot = four_bar_linkage_pure::getRobot();
+  CHECK_EXCEPTION(CompiledRobot(robot), std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
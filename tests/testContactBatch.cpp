@@ -0,0 +1,69 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactBatch.cpp
+ * @brief Test batched contact points and goals against the per-step ones.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "gtdynamics/kinematics/ContactBatch.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+
+TEST(ContactBatch, PredictPoints) {
+  const Robot robot = simple_rr::getRobot();
+  const PointOnLinks points = {{robot.link("link_1"), Point3(0, 0, 0.3)},
+                               {robot.link("link_2"), Point3(0.1, 0, -0.2)}};
+
+  // Poses of 5 time steps, in Values and gathered into a batch.
+  BatchForwardKinematics batch_fk(robot);
+  const gtsam::Matrix Q =
+      gtsam::Matrix::Random(5, CompiledRobot(robot).numJointSlots());
+  const PoseBatch computed = batch_fk.compute(Q);
+  gtsam::Values values;
+  std::vector<int> link_ids;
+  for (auto &&link : robot.links()) link_ids.push_back(link->id());
+  for (size_t k = 0; k < 5; k++)
+    for (const int i : link_ids) InsertPose(&values, i, k, computed.pose(k, i));
+  const PoseBatch poses = GatherPoses(values, link_ids, 5);
+
+  const gtsam::Matrix predicted = PredictPoints(points, poses);
+  EXPECT_LONGS_EQUAL(5, predicted.rows());
+  EXPECT_LONGS_EQUAL(6, predicted.cols());
+  for (size_t k = 0; k < 5; k++)
+    for (size_t p = 0; p < points.size(); p++)
+      EXPECT(gtsam::assert_equal<Point3>(
+          points[p].predict(values, k),
+          predicted.block<1, 3>(k, 3 * p).transpose(), 1e-9));
+
+  // Goal 0 holds at step 2, goal 1 at step 4.
+  const ContactGoals goals = {{points[0], points[0].predict(values, 2)},
+                              {points[1], points[1].predict(values, 4)}};
+  const std::vector<uint64_t> masks = SatisfiedGoals(goals, poses, 1e-6);
+  EXPECT_LONGS_EQUAL(5, masks.size());
+  for (size_t k = 0; k < 5; k++) {
+    for (size_t g = 0; g < 2; g++)
+      EXPECT(bool(masks[k] >> g & 1) == goals[g].satisfied(values, k, 1e-6));
+  }
+  EXPECT_LONGS_EQUAL(1, masks[2]);
+  EXPECT_LONGS_EQUAL(2, masks[4]);
+
+  CHECK_EXCEPTION(SatisfiedGoals(ContactGoals(65, goals[0]), poses),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
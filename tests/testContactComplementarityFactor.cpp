@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactComplementarityFactor.cpp
+ * @brief Test complementarity of contact height and normal force.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+
+#include "gtdynamics/factors/ContactComplementarityFactor.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+static const gtsam::LabeledSymbol kPoseKey('p', 0, 0), kWrenchKey('C', 0, 0);
+static const gtsam::Vector3 kGravity(0, 0, -9.8);
+
+// A wrench with linear force f in the link frame.
+static Vector6 Force(double fx, double fy, double fz) {
+  return (Vector6() << 0, 0, 0, fx, fy, fz).finished();
+}
+
+TEST(ContactComplementarityFactor, Relaxed) {
+  ComplementarityParams params;
+  params.scheme = RelaxedComplementarity;
+  params.epsilon = 0;
+  params.force_scale = 10;
+  const ContactComplementarityFactor factor(kPoseKey, kWrenchKey,
+                                            Point3(0, 0, -1), kGravity, params);
+  EXPECT_LONGS_EQUAL(3, factor.dim());
+
+  // In flight without force, and in contact with force: no error.
+  EXPECT(assert_equal(gtsam::Vector3::Zero(),
+                      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 2)),
+                                           Force(0, 0, 0))));
+  EXPECT(assert_equal(gtsam::Vector3::Zero(),
+                      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 1)),
+                                           Force(1, 0, 20))));
+
+  // Pulling, penetrating, and pushing from a distance.
+  EXPECT(assert_equal(gtsam::Vector3(0, -2, 0),
+                      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 1)),
+                                           Force(0, 0, -20))));
+  EXPECT(assert_equal(gtsam::Vector3(-0.5, 0, 0),
+                      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 0.5)),
+                                           Force(0, 0, 0))));
+  EXPECT(assert_equal(gtsam::Vector3(0, 0, 2),
+                      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 2)),
+                                           Force(0, 0, 20))));
+
+  // The force is rotated into the spatial frame.
+  EXPECT(assert_equal(gtsam::Vector3(0, 0, 2),
+                      factor.evaluateError(
+                          Pose3(Rot3::Rx(M_PI), Point3(0, 0, 0)),
+                          Force(0, 0, -20))));
+
+  gtsam::Values values;
+  values.insert(kPoseKey, Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 2, 2)));
+  values.insert(kWrenchKey, Vector6(Force(1, 2, 15)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(ContactComplementarityFactor, Smoothed) {
+  ComplementarityParams params;
+  params.epsilon = 0.01;
+  params.force_scale = 10;
+  const ContactComplementarityFactor factor(kPoseKey, kWrenchKey,
+                                            Point3(0, 0, -1), kGravity, params);
+  EXPECT_LONGS_EQUAL(1, factor.dim());
+
+  // Zero exactly where phi lambda = eps with both positive.
+  EXPECT(assert_equal(gtsam::Vector1(0),
+                      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 1.1)),
+                                           Force(0, 0, 1)),
+                      1e-12));
+  const double phi = 1, lambda = 2;
+  EXPECT(assert_equal(
+      gtsam::Vector1(phi + lambda - std::sqrt(phi * phi + lambda * lambda +
+                                              2 * params.epsilon)),
+      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 2)), Force(0, 0, 20)),
+      1e-12));
+
+  gtsam::Values values;
+  values.insert(kPoseKey,
+                Pose3(Rot3::RzRyRx(0.3, -0.2, 0.1), Point3(1, 0, 1.2)));
+  values.insert(kWrenchKey, Vector6(Force(-1, 2, 3)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  params.force_scale = 0;
+  THROWS_EXCEPTION(ContactComplementarityFactor(
+      kPoseKey, kWrenchKey, Point3(0, 0, -1), kGravity, params));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
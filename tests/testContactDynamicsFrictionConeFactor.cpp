@@ -112,6 +112,36 @@ TEST(ContactDynamicsFrictionConeFactor, error) {
       1e-3); // Tolerance.
 }
 
+/**
+ * Test the error and Jacobians with gravity along another axis, and that the
+ * Jacobians are zero inside the cone.
+ **/
+TEST(ContactDynamicsFrictionConeFactor, upAxis) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  LabeledSymbol pose_key('p', 0, 0), contact_wrench_key('C', 0, 0);
+  ContactDynamicsFrictionConeFactor factor(
+      pose_key, contact_wrench_key, cost_model, 0.5, Vector3(-9.8, 0, 0));
+
+  // Up is x: 2^2 + 1^2 - 0.25 * 2^2 = 4.
+  const Pose3 pose(Rot3(), Point3(1, 2, 3));
+  EXPECT(assert_equal(
+      (gtsam::Vector(1) << 4).finished(),
+      factor.evaluateError(pose,
+                           (gtsam::Vector(6) << 0, 0, 0, 2, 2, 1).finished())));
+
+  gtsam::Matrix H_pose, H_wrench;
+  factor.evaluateError(pose, (gtsam::Vector(6) << 0, 0, 0, 10, 1, 1).finished(),
+                       H_pose, H_wrench);
+  EXPECT(assert_equal(gtsam::Matrix::Zero(1, 6), H_pose));
+  EXPECT(assert_equal(gtsam::Matrix::Zero(1, 6), H_wrench));
+
+  gtsam::Values values;
+  values.insert(pose_key, Pose3(Rot3::RzRyRx(0.3, -0.4, 0.2), Point3(0, 0, 1)));
+  values.insert(contact_wrench_key,
+                (gtsam::Vector(6) << 0.1, 0, 0, 1, 2, -1).finished());
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
 /**
  * Test the optimization of a link contact wrench to ensure resulting wrench
  * lies within the friction cone.
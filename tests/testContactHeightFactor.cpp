@@ -23,9 +23,13 @@
 #include <gtsam/nonlinear/factorTesting.h>
 #include <math.h>
 
+#include <boost/make_shared.hpp>
+
 #include <iostream>
+#include <vector>
 
 #include "gtdynamics/factors/ContactHeightFactor.h"
+#include "gtdynamics/utils/Terrain.h"
 
 using namespace gtdynamics;
 using gtsam::assert_equal;
@@ -189,6 +193,35 @@ TEST(ContactHeightFactor, Optimization) {
                       gtsam::Vector1(0), 1e-3));
 }
 
+/**
+ * Test contact on a height map.
+ **/
+TEST(ContactHeightFactor, Terrain) {
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  gtsam::LabeledSymbol pose_key = gtsam::LabeledSymbol('p', 0, 0);
+  gtsam::Point3 comPc(0, 0, 1);
+
+  // Terrain h = 0.5 x + 0.25 y on [0, 10]^2.
+  std::vector<double> heights;
+  for (int r = 0; r < 11; r++)
+    for (int c = 0; c < 11; c++) heights.push_back(0.5 * c + 0.25 * r);
+  auto terrain = boost::make_shared<HeightMap>(11, 11, 0, 0, 1, heights,
+                                               HeightMap::Bicubic);
+  ContactHeightFactor factor(pose_key, cost_model, comPc, terrain);
+
+  // Contact at (4, 3, 3): the terrain is at 2.75 there.
+  EXPECT(assert_equal(factor.evaluateError(gtsam::Pose3(
+                          gtsam::Rot3(), gtsam::Point3(4., 3., 2.))),
+                      gtsam::Vector1(0.25)));
+
+  gtsam::Values values;
+  values.insert(
+      pose_key,
+      gtsam::Pose3(gtsam::Rot3::RzRyRx(M_PI / 8.0, M_PI / 12.0, 5 * M_PI / 6.0),
+                   gtsam::Point3(4.3, 3.6, 3.)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-3);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactSchedulePlanner.cpp
+ * @brief Test the search over contact sequences and timing.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/dynamics/ContactSchedulePlanner.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Values;
+using gtsam::Vector3;
+
+namespace example {
+const Robot robot = CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+
+// Link poses with all joints at zero and the trunk at the origin.
+Values RestPoses() {
+  Values angles;
+  for (auto &&joint : robot.joints())
+    InsertJointAngle(&angles, joint->id(), 0.0);
+  return robot.forwardKinematics(angles, 0, std::string("trunk"));
+}
+
+// The feet, front right, front left, rear right and rear left.
+PointOnLinks Feet() {
+  PointOnLinks feet;
+  for (auto &&name : {"FR_lower", "FL_lower", "RR_lower", "RL_lower"})
+    feet.emplace_back(robot.link(name), Point3(0, 0, -0.2));
+  return feet;
+}
+
+ContactSchedulePlannerParameters Parameters() {
+  ContactSchedulePlannerParameters parameters;
+  parameters.centroidal.dt = 0.02;
+  parameters.centroidal.mu = 1.0;
+  return parameters;
+}
+
+const ContactSchedulePlanner planner(robot, RestPoses(), Feet(),
+                                     Vector3(0, 0, -9.8), Parameters());
+const Point3 step(0.02, 0, 0);
+
+// Gaits by their stance feet.
+const ContactSequence trot{{1, 2}, {0, 3}}, pace{{1, 3}, {0, 2}},
+    bound{{2, 3}, {0, 1}};
+}  // namespace example
+
+// Every foot swings once per cycle, and some foot is always in stance.
+TEST(ContactSchedulePlanner, SwingSequences) {
+  using Planner = ContactSchedulePlanner;
+  EXPECT_LONGS_EQUAL(1, Planner::SwingSequences(2, false).size());
+  EXPECT_LONGS_EQUAL(5, Planner::SwingSequences(3, false).size());
+  const auto sequences = Planner::SwingSequences(4, false);
+  EXPECT_LONGS_EQUAL(25, sequences.size());
+  for (auto &&sequence : sequences) {
+    for (auto &&stance : sequence)
+      EXPECT(!stance.empty() && stance.size() < 4);
+    for (size_t f = 0; f < 4; ++f) {
+      size_t swings = 0;
+      for (auto &&stance : sequence)
+        swings += std::count(stance.begin(), stance.end(), f) == 0;
+      EXPECT_LONGS_EQUAL(1, swings);
+    }
+  }
+
+  // With a phase in full stance after every swing phase.
+  const auto with_stance = Planner::SwingSequences(4, true);
+  EXPECT_LONGS_EQUAL(25, with_stance.size());
+  EXPECT_LONGS_EQUAL(2 * sequences[0].size(), with_stance[0].size());
+  EXPECT_LONGS_EQUAL(4, with_stance[0][1].size());
+  EXPECT(Planner::SwingSequences(1, false).empty());
+}
+
+// Of trot, pace and bound, only the trot keeps the CoM over its support, and
+// its schedules are ready walk cycles.
+TEST(ContactSchedulePlanner, trot) {
+  using namespace example;
+  const std::vector<ContactSchedule> schedules =
+      planner.plan({bound, pace, trot}, step);
+  CHECK(schedules.size() == 2);
+  EXPECT(schedules[0].cost <= schedules[1].cost);
+
+  for (auto &&schedule : schedules) {
+    EXPECT(schedule.sequence == trot);
+    EXPECT(schedule.margin >= -0.05);
+    EXPECT_LONGS_EQUAL(2, schedule.walk_cycle.numPhases());
+    EXPECT_LONGS_EQUAL(4, schedule.walk_cycle.contactPoints().size());
+    EXPECT_LONGS_EQUAL(schedule.phase_steps[0],
+                       schedule.walk_cycle.phase(0).numTimeSteps());
+    EXPECT_LONGS_EQUAL(6, schedule.trajectory(3).numPhases());
+
+    // The front right foot swings in the first phase, then stands a step
+    // ahead.
+    const Point3 front_right = planner.feet()[0].predict(RestPoses(), 0);
+    EXPECT(assert_equal(Point3(front_right + step), schedule.footholds[1][0],
+                        1e-9));
+
+    // The centroidal plan walks the CoM by one step over the cycle.
+    const CentroidalPlanner centroidal = planner.centroidalPlanner(schedule);
+    const int T = centroidal.numSteps();
+    EXPECT_LONGS_EQUAL(schedule.walk_cycle.numTimeSteps(), T);
+    const Values &plan = schedule.centroidal_plan;
+    const Vector3 start = plan.at<Vector3>(CentroidalPlanner::ComKey(0));
+    const Vector3 end = plan.at<Vector3>(CentroidalPlanner::ComKey(T));
+    EXPECT(assert_equal(Vector3(step), Vector3(end - start), 1e-2));
+  }
+
+  // Flight phases are dropped, unknown feet are errors.
+  const ContactSequence flight{{}, {0, 1, 2, 3}}, unknown{{7}};
+  EXPECT(planner.plan({flight}, step).empty());
+  CHECK_EXCEPTION(planner.plan({unknown}, step), std::invalid_argument);
+  CHECK_EXCEPTION(ContactSchedulePlanner(robot, RestPoses(), PointOnLinks()),
+                  std::invalid_argument);
+}
+
+// The search over all sequences and timings refines the best screened ones.
+TEST(ContactSchedulePlanner, search) {
+  using namespace example;
+  const std::vector<ContactSchedule> schedules = planner.plan(step);
+  CHECK(!schedules.empty());
+  EXPECT(schedules.size() <= Parameters().num_refined);
+  for (size_t i = 0; i < schedules.size(); ++i) {
+    EXPECT(schedules[i].margin >= Parameters().min_margin);
+    if (i > 0) EXPECT(schedules[i - 1].cost <= schedules[i].cost);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,152 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testContactWrenchEstimator.cpp
+ * @brief Test contact force estimation from joint torques and the IMU.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/dynamics/ContactWrenchEstimator.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+namespace example {
+const Vector3 gravity(0, 0, -9.8);
+}  // namespace example
+
+// Standing upright on a point under the base, the contact carries the weight.
+TEST(ContactWrenchEstimator, standing) {
+  const Robot robot = simple_rr::getRobot();
+  const auto base = robot.link("link_0");
+  const FootContactConstraintSpec stance(
+      std::vector<PointOnLink>{PointOnLink(base, Point3(0, 0, -0.1))});
+  ContactWrenchEstimator estimator(robot, stance);
+  EXPECT_LONGS_EQUAL(base->id(), estimator.baseLink());
+  EXPECT_LONGS_EQUAL(1, estimator.numContacts());
+
+  ContactWrenchMeasurement m;
+  m.q = m.v = m.tau = Vector::Zero(robot.numJoints());
+  m.specific_force = -example::gravity;
+  const ContactWrenchEstimate estimate = estimator.estimate(m);
+
+  double mass = 0;
+  for (auto &&link : robot.links()) mass += link->mass();
+  EXPECT(assert_equal(Vector3(0, 0, mass * 9.8),
+                      Vector3(estimate.forces.col(0)), 1e-4));
+  EXPECT(assert_equal(Vector::Zero(6 + robot.numJoints()), estimate.residual,
+                      1e-4));
+}
+
+// In free flight, e.g. during a jump, no contact force is estimated.
+TEST(ContactWrenchEstimator, flight) {
+  const Robot robot = simple_rr::getRobot();
+  RecursiveDynamics dynamics(robot, example::gravity);
+  RecursiveDynamicsResult id;
+  dynamics.allocate(&id);
+  const int base = robot.link("link_0")->id();
+  const gtsam::Rot3 wRb = gtsam::Rot3::RzRyRx(0.1, 0.2, 0.3);
+  id.poses[base] = Pose3(wRb, Point3(0, 0, 0));
+  id.twists.col(base) << 0.1, -0.2, 0.3, 0.5, 0.1, -0.4;
+
+  ContactWrenchMeasurement m;
+  const size_t n = robot.numJoints();
+  m.q = Vector::Random(n);
+  m.v = Vector::Random(n);
+  m.a = Vector::Random(n);
+  dynamics.inverseDynamics(m.q, m.v, m.a, &id);
+  m.tau = id.torques;
+
+  // IMU readings of the base motion solved by inverse dynamics.
+  m.base_orientation = wRb;
+  m.angular_velocity = id.twists.col(base).head<3>();
+  m.base_velocity = id.twists.col(base).tail<3>();
+  m.angular_acceleration = id.twist_accels.col(base).head<3>();
+  m.specific_force = id.twist_accels.col(base).tail<3>() +
+                     m.angular_velocity.cross(m.base_velocity) -
+                     wRb.unrotate(example::gravity);
+
+  const FootContactConstraintSpec feet(
+      std::vector<LinkSharedPtr>{robot.link("link_2")}, Point3(0, 0, 0.1));
+  ContactWrenchEstimator estimator(robot, feet);
+  const ContactWrenchEstimate estimate = estimator.estimate(m);
+  EXPECT(assert_equal(Vector3::Zero(), Vector3(estimate.forces.col(0)),
+                      1e-6));
+  EXPECT(assert_equal(m.tau, estimator.inverseDynamicsTorques(), 1e-9));
+}
+
+// On a fixed base, the forces reproduce the torques they cause.
+TEST(ContactWrenchEstimator, fixed_base) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const size_t n = robot.numJoints();
+  RecursiveDynamics dynamics(robot, example::gravity);
+  RecursiveDynamicsResult id;
+  dynamics.allocate(&id);
+  ContactWrenchMeasurement m;
+  m.q = Vector::Random(n);
+  m.v = Vector::Random(n);
+  m.a = Vector::Random(n);
+  dynamics.inverseDynamics(m.q, m.v, m.a, &id);
+
+  // Torques with a force of (1, 2, 3) on the tip of the last link.
+  const auto tip = robot.link("link_2");
+  const Point3 point(0, 0, 0.2);
+  const CompiledRobot compiled(robot);
+  std::vector<Pose3> poses;
+  compiled.forwardKinematics(m.q, &poses);
+  Matrix J;
+  compiled.bodyJacobian(poses, tip->id(), &J);
+  const gtsam::Matrix3 iRw = poses[tip->id()].rotation().transpose();
+  const Vector3 f_i = iRw * Vector3(1, 2, 3);
+  gtsam::Vector6 wrench;
+  wrench << point.cross(f_i), f_i;
+  m.tau = id.torques - J.transpose() * wrench;
+
+  ContactWrenchEstimator estimator(
+      robot,
+      FootContactConstraintSpec(std::vector<PointOnLink>{{tip, point}}));
+  EXPECT_LONGS_EQUAL(-1, estimator.baseLink());
+  ContactWrenchEstimate estimate;
+  estimator.estimate(m, &estimate);
+  EXPECT(assert_equal(id.torques, estimator.inverseDynamicsTorques(), 1e-9));
+  EXPECT(assert_equal(Vector::Zero(n), estimate.residual, 1e-6));
+  EXPECT(assert_equal(Vector(J.transpose() * estimate.wrenches.col(0)),
+                      Vector(J.transpose() * wrench), 1e-6));
+}
+
+TEST(ContactWrenchEstimator, exceptions) {
+  const Robot robot = simple_rr::getRobot();
+  const FootContactConstraintSpec feet(
+      std::vector<LinkSharedPtr>{robot.link("link_2")}, Point3());
+  ContactWrenchEstimatorParameters parameters;
+  parameters.torque_sigma = 0;
+  CHECK_EXCEPTION(ContactWrenchEstimator(robot, feet, parameters),
+                  std::invalid_argument);
+  ContactWrenchEstimator estimator(robot, feet);
+  ContactWrenchMeasurement m;
+  m.q = m.v = m.tau = Vector::Zero(1);
+  CHECK_EXCEPTION(estimator.estimate(m), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testCouplingFactors.cpp
+ * @brief Test factors coupling robot instances.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "gtdynamics/factors/CouplingFactors.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+TEST(CouplingFactors, PointCoupling) {
+  auto robot = simple_rr::getRobot();
+  auto model = gtsam::noiseModel::Isotropic::Sigma(3, 0.1);
+  const PointOnLink a(robot.link("link_2"), Point3(0, 0, 0.3));
+  const PointOnLink b(robot.link("link_1"), Point3(0.1, 0, 0));
+  PointCouplingFactor factor(0, a, 1, b, model, 4);
+  EXPECT(factor.key1() == RobotPoseKey(0, a.link->id(), 4));
+  EXPECT(factor.key2() == RobotPoseKey(1, b.link->id(), 4));
+  EXPECT_LONGS_EQUAL(1, DynamicsSymbol::RobotInstance(factor.key2()));
+
+  const Pose3 wTa(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 0, 0));
+  const Pose3 wTb(Rot3::RzRyRx(-0.2, 0, 0.4), Point3(0.5, 1, 0));
+  EXPECT(assert_equal(
+      gtsam::Vector(wTa.transformFrom(a.point) - wTb.transformFrom(b.point)),
+      factor.evaluateError(wTa, wTb), 1e-9));
+
+  gtsam::Values values;
+  values.insert(factor.key1(), wTa);
+  values.insert(factor.key2(), wTb);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+TEST(CouplingFactors, PoseCoupling) {
+  auto model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+  const Pose3 aTb(Rot3::Rz(0.5), Point3(0, 0, 0.2));
+  auto factor = PoseCouplingFactor(0, 2, 1, 2, aTb, model, 3);
+  EXPECT(factor->keys()[0] == RobotPoseKey(0, 2, 3));
+  EXPECT(factor->keys()[1] == RobotPoseKey(1, 2, 3));
+
+  gtsam::Values values;
+  const Pose3 wTa(Rot3::Rx(0.3), Point3(1, 2, 3));
+  values.insert(factor->keys()[0], wTa);
+  values.insert(factor->keys()[1], wTa * aTb);
+  EXPECT_DOUBLES_EQUAL(0, factor->error(values), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testDifferentiableRollout.cpp
+ * @brief Test rollout gradients against numerical derivatives.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/dynamics/DifferentiableRollout.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+
+namespace example {
+const Robot robot = simple_rr::getRobot().fixLink("link_0");
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const size_t B = 2, K = 10;
+
+// Quadratic cost of a batch of rollouts.
+double cost(DifferentiableRollout &rollout, const Matrix &q0,
+            const Matrix &v0, const std::vector<Matrix> &torques) {
+  const RolloutStates states = rollout.simulate(q0, v0, torques);
+  double L = 0.5 * states.q.squaredNorm() + 0.5 * states.v.squaredNorm();
+  for (auto &&tau : torques) L += 0.5 * tau.squaredNorm();
+  return L;
+}
+}  // namespace example
+
+// Gradients of the quadratic cost agree with central differences, with and
+// without checkpointing.
+TEST(DifferentiableRollout, Gradients) {
+  using namespace example;
+  const Matrix q0 = Matrix::Random(B, 2), v0 = Matrix::Random(B, 2);
+  const std::vector<Matrix> torques{Matrix::Random(K, 2),
+                                    Matrix::Random(K, 2)};
+
+  DifferentiableRolloutParameters parameters;
+  parameters.num_threads = 2;
+  DifferentiableRollout rollout(robot, gravity, parameters);
+  EXPECT_LONGS_EQUAL(2, rollout.numThreads());
+  EXPECT_LONGS_EQUAL(2, rollout.numJoints());
+  const RolloutStates states = rollout.simulate(q0, v0, torques);
+  EXPECT_LONGS_EQUAL(K, states.num_steps);
+  const RolloutGradients gradients =
+      rollout.gradients(q0, v0, torques, states.q, states.v, torques);
+
+  const double h = 1e-6;
+  for (size_t r = 0; r < B; ++r) {
+    Matrix numerical(K, 2);
+    for (size_t k = 0; k < K; ++k)
+      for (size_t j = 0; j < 2; ++j) {
+        std::vector<Matrix> plus = torques, minus = torques;
+        plus[r](k, j) += h;
+        minus[r](k, j) -= h;
+        numerical(k, j) = (cost(rollout, q0, v0, plus) -
+                           cost(rollout, q0, v0, minus)) / (2 * h);
+      }
+    EXPECT(assert_equal(numerical, gradients.torques[r], 1e-5));
+  }
+  Matrix numerical_q0(B, 2), numerical_v0(B, 2);
+  for (size_t r = 0; r < B; ++r)
+    for (size_t j = 0; j < 2; ++j) {
+      Matrix plus = q0, minus = q0;
+      plus(r, j) += h;
+      minus(r, j) -= h;
+      numerical_q0(r, j) = (cost(rollout, plus, v0, torques) -
+                            cost(rollout, minus, v0, torques)) / (2 * h);
+      plus = v0, minus = v0;
+      plus(r, j) += h;
+      minus(r, j) -= h;
+      numerical_v0(r, j) = (cost(rollout, q0, plus, torques) -
+                            cost(rollout, q0, minus, torques)) / (2 * h);
+    }
+  EXPECT(assert_equal(numerical_q0, gradients.q0, 1e-5));
+  EXPECT(assert_equal(numerical_v0, gradients.v0, 1e-5));
+
+  // Segments of 3 steps, the last one of a single step.
+  parameters.checkpoint_interval = 3;
+  DifferentiableRollout checkpointed(robot, gravity, parameters);
+  const RolloutGradients recomputed =
+      checkpointed.gradients(q0, v0, torques, states.q, states.v, torques);
+  for (size_t r = 0; r < B; ++r)
+    EXPECT(assert_equal(gradients.torques[r], recomputed.torques[r], 1e-12));
+  EXPECT(assert_equal(gradients.q0, recomputed.q0, 1e-12));
+  EXPECT(assert_equal(gradients.v0, recomputed.v0, 1e-12));
+}
+
+// Sizes are checked, and floating bases are rejected.
+TEST(DifferentiableRollout, Exceptions) {
+  using namespace example;
+  DifferentiableRollout rollout(robot, gravity);
+  const Matrix q0 = Matrix::Zero(B, 2);
+  const std::vector<Matrix> torques(B, Matrix::Zero(K, 2));
+  CHECK_EXCEPTION(rollout.simulate(Matrix::Zero(1, 2), q0, torques),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(rollout.gradients(q0, q0, torques, Matrix::Zero(B, 2 * K),
+                                    Matrix::Zero(B, 2 * K)),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(DifferentiableRollout(simple_rr::getRobot(), gravity),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -26,10 +26,13 @@
 #include <iostream>
 
 #include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/factors/ContactHeightFactor.h"
 #include "gtdynamics/factors/MinTorqueFactor.h"
 #include "gtdynamics/universal_robot/Robot.h"
 #include "gtdynamics/universal_robot/RobotModels.h"
 #include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/ThreadPool.h"
 #include "gtdynamics/utils/initialize_solution_utils.h"
 #include "gtdynamics/utils/utils.h"
 #include "gtdynamics/utils/values.h"
@@ -82,6 +85,100 @@ TEST(linearDynamicsFactorGraph, simple_urdf_eq_mass_values) {
   EXPECT(assert_equal(1.0, Torque(result_id, j, t), 1e-3));
 }
 
+// With passive joint forces, linearSolveFD adds the damping of simple_urdf
+// to the torques, and the nonlinear graph agrees.
+TEST(linearDynamicsFactorGraph, passive_joint_forces) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const auto joint = robot.joint("j1");
+  const int j = joint->id();
+  const int t = 1;
+
+  Values values;
+  InsertJointAngle(&values, j, t, 0.3);
+  InsertJointVel(&values, j, t, 0.2);
+  Values known = robot.forwardKinematics(values, t);
+  Values with_torque = known, with_total = known;
+  InsertTorque(&with_torque, j, t, 4.0);
+  InsertTorque(&with_total, j, t, 4.0 + joint->passiveTorque(0.3, 0.2));
+
+  OptimizerSetting opt;
+  opt.passive_joint_forces = true;
+  DynamicsGraph passive(opt, gravity);
+  const Values actual = passive.linearSolveFD(robot, t, with_torque);
+  const Values expected =
+      DynamicsGraph(gravity).linearSolveFD(robot, t, with_total);
+  EXPECT(assert_equal(JointAccel(expected, j, t), JointAccel(actual, j, t),
+                      1e-9));
+
+  auto graph = passive.dynamicsFactorGraph(robot, t);
+  EXPECT_DOUBLES_EQUAL(0, graph.error(actual), 1e-6);
+}
+
+// Recursive Newton-Euler should agree with linearSolveID.
+TEST(linearDynamicsFactorGraph, recursive_newton_euler) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const int j = robot.joint("j1")->id();
+  const int t = 3;
+
+  Values values;
+  InsertJointAngle(&values, j, t, 0.7);
+  InsertJointVel(&values, j, t, 1.5);
+  Values desired_accels = robot.forwardKinematics(values, t);
+  InsertJointAccel(&desired_accels, j, t, -2.0);
+
+  DynamicsGraph graph_builder(gravity);
+  Values expected = graph_builder.linearSolveID(robot, t, desired_accels);
+
+  RecursiveDynamics rnea(robot, gravity);
+  Values actual = rnea.solveInverseDynamics(desired_accels, t);
+  EXPECT(assert_equal(Torque(expected, j, t), Torque(actual, j, t), 1e-6));
+  for (auto&& link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(Wrench(expected, i, j, t), Wrench(actual, i, j, t),
+                        1e-6));
+    EXPECT(assert_equal(TwistAccel(expected, i, t), TwistAccel(actual, i, t),
+                        1e-6));
+  }
+
+  // Array interface, indexed by joint id.
+  RecursiveDynamicsResult result;
+  rnea.allocate(&result);
+  gtsam::Vector q(1), v(1), a(1);
+  q << 0.7;
+  v << 1.5;
+  a << -2.0;
+  rnea.inverseDynamics(q, v, a, &result);
+  EXPECT_DOUBLES_EQUAL(Torque(expected, j, t), result.torques(j), 1e-6);
+}
+
+// Floating base version, compare with simple_urdf_eq_mass_values above.
+TEST(linearDynamicsFactorGraph, recursive_newton_euler_floating) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  auto l1 = robot.link("l1");
+  const int j = robot.joint("j1")->id();
+  const int t = 777;
+
+  Values values;
+  InsertPose(&values, l1->id(), t, l1->bMcom());
+  InsertTwist(&values, l1->id(), t, gtsam::Z_6x1);
+  Values desired_accels =
+      robot.forwardKinematics(values, t, std::string("l1"));
+  InsertJointAccel(&desired_accels, j, t, 4.0);
+
+  RecursiveDynamics rnea(robot, simple_urdf_eq_mass::gravity);
+  Values result = rnea.solveInverseDynamics(desired_accels, t);
+  EXPECT(assert_equal(1.0, Torque(result, j, t), 1e-3));
+
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity);
+  Values expected = graph_builder.linearSolveID(robot, t, desired_accels);
+  for (auto&& link : robot.links()) {
+    EXPECT(assert_equal(TwistAccel(expected, link->id(), t),
+                        TwistAccel(result, link->id(), t), 1e-6));
+  }
+}
+
 Values zero_values(const Robot& robot, size_t t, bool insert_accels = false) {
   Values values;
   for (auto&& joint : robot.joints()) {
@@ -309,6 +406,24 @@ TEST(collocationFactors, simple_urdf) {
 
   EXPECT(assert_equal(2.75, JointAngle(mp_trapezoidal_result, j, t + 1)));
   EXPECT(assert_equal(2.5, JointVel(mp_trapezoidal_result, j, t + 1)));
+
+  // Hermite-Simpson is exact for the cubic q = 1 + t + t^2 / 2 + t^3 / 6.
+  for (bool multi_phase : {false, true}) {
+    NonlinearFactorGraph hs_graph;
+    hs_graph.add(multi_phase ? graph_builder.multiPhaseCollocationFactors(
+                                   robot, t, phase,
+                                   CollocationScheme::HermiteSimpson)
+                             : graph_builder.collocationFactors(
+                                   robot, t, dt,
+                                   CollocationScheme::HermiteSimpson));
+    hs_graph.add(prior_factors);
+
+    gtsam::GaussNewtonOptimizer optimizer_hs(hs_graph, init_values);
+    Values hs_result = optimizer_hs.optimize();
+
+    EXPECT(assert_equal(8.0 / 3, JointAngle(hs_result, j, t + 1), 1e-6));
+    EXPECT(assert_equal(2.5, JointVel(hs_result, j, t + 1), 1e-6));
+  }
 }
 
 // test forward dynamics of a trajectory
@@ -608,6 +723,177 @@ TEST(dynamicsFactorGraph_Contacts, dynamics_graph_simple_rrr) {
     EXPECT(assert_equal(0, Torque(results, joint->id())));
 }
 
+// Whole-trajectory extraction agrees with the per-step readers.
+TEST(DynamicsGraph, jointTrajectories) {
+  auto robot = simple_rr::getRobot();
+  const size_t T = 300;  // more than one block of time steps
+  Values values;
+  for (size_t t = 0; t < T; t++) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, t, 0.01 * t + j);
+      InsertJointVel(&values, j, t, -0.02 * t);
+      InsertJointAccel(&values, j, t, 0.5 * j);
+      InsertTorque(&values, j, t, 0.1 * t * j);
+      InsertPose(&values, j, t, gtsam::Pose3());
+    }
+  }
+
+  ThreadPool pool(3);
+  gtsam::Matrix angles, vels, accels, torques;
+  DynamicsGraph::jointAnglesTrajectory(robot, values, T, &angles);
+  DynamicsGraph::jointVelsTrajectory(robot, values, T, &vels, &pool);
+  DynamicsGraph::jointAccelsTrajectory(robot, values, T, &accels);
+  DynamicsGraph::jointTorquesTrajectory(robot, values, T, &torques, &pool);
+  EXPECT_LONGS_EQUAL(T, angles.rows());
+  EXPECT_LONGS_EQUAL(robot.numJoints(), angles.cols());
+  for (size_t t = 0; t < T; t++) {
+    EXPECT(assert_equal(DynamicsGraph::jointAngles(robot, values, t),
+                        Vector(angles.row(t).transpose())));
+    EXPECT(assert_equal(DynamicsGraph::jointVels(robot, values, t),
+                        Vector(vels.row(t).transpose())));
+    EXPECT(assert_equal(DynamicsGraph::jointAccels(robot, values, t),
+                        Vector(accels.row(t).transpose())));
+    EXPECT(assert_equal(DynamicsGraph::jointTorques(robot, values, t),
+                        Vector(torques.row(t).transpose())));
+  }
+
+  // A missing time step throws, with and without a pool.
+  THROWS_EXCEPTION(
+      DynamicsGraph::jointAnglesTrajectory(robot, values, T + 1, &angles));
+  THROWS_EXCEPTION(DynamicsGraph::jointAnglesTrajectory(robot, values, T + 1,
+                                                        &angles, &pool));
+}
+
+// A slice at step t is the step-0 slice on time-shifted keys.
+TEST(DynamicsGraph, dynamicsSlice) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8),
+                              gtsam::Vector3(1, 0, 0));
+  const DynamicsSlice slice =
+      graph_builder.dynamicsSlice(robot, contact_points, 0.7);
+
+  const int t = 5;
+  const Values values0 = ZeroValues(robot, 0, 0.1, contact_points);
+  Values values;
+  for (auto &&key_value : values0)
+    values.insert(key_value.key + t, key_value.value);
+
+  const NonlinearFactorGraph graph0 = slice.instantiate(0);
+  const NonlinearFactorGraph graph = slice.instantiate(t);
+  EXPECT_LONGS_EQUAL(slice.size(), graph.size());
+  for (auto &&factor : graph)
+    for (auto &&key : factor->keys())
+      EXPECT_LONGS_EQUAL(t, DynamicsSymbol::Time(key));
+  EXPECT(graph0.error(values0) > 0);
+  EXPECT_DOUBLES_EQUAL(graph0.error(values0), graph.error(values), 1e-9);
+  for (size_t f = 0; f < graph.size(); f++)
+    EXPECT_DOUBLES_EQUAL(graph0[f]->error(values0), graph[f]->error(values),
+                         1e-9);
+
+  // trajectoryFG stamps out the same slice.
+  const auto trajectory = graph_builder.trajectoryFG(
+      robot, t, 0.1, CollocationScheme::Euler, contact_points, 0.7);
+  NonlinearFactorGraph expected;
+  for (int k = 0; k <= t; k++) {
+    expected.add(graph_builder.dynamicsFactorGraph(robot, k, contact_points,
+                                                   0.7));
+    if (k < t)
+      expected.add(graph_builder.collocationFactors(robot, k, 0.1,
+                                                    CollocationScheme::Euler));
+  }
+  EXPECT(assert_equal(expected, trajectory));
+}
+
+// Building time steps on a thread pool gives the same graph.
+TEST(DynamicsGraph, parallelTrajectoryFG) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  ThreadPool pool(4);
+
+  const int num_steps = 50;
+  EXPECT(assert_equal(
+      graph_builder.trajectoryFG(robot, num_steps, 0.1, Trapezoidal,
+                                 contact_points, 0.7),
+      graph_builder.trajectoryFG(robot, num_steps, 0.1, Trapezoidal,
+                                 contact_points, 0.7, &pool)));
+
+  const std::vector<int> phase_steps{20, 1, 15};
+  const std::vector<PointOnLinks> phase_contact_points{
+      contact_points, PointOnLinks(), contact_points};
+  const std::vector<NonlinearFactorGraph> transition_graphs{
+      graph_builder.dynamicsFactorGraph(robot, 20, contact_points, 0.7),
+      graph_builder.dynamicsFactorGraph(robot, 21, PointOnLinks(), 0.7)};
+  EXPECT(assert_equal(
+      graph_builder.multiPhaseTrajectoryFG(robot, phase_steps,
+                                           transition_graphs, Euler,
+                                           phase_contact_points, 0.7),
+      graph_builder.multiPhaseTrajectoryFG(robot, phase_steps,
+                                           transition_graphs, Euler,
+                                           phase_contact_points, 0.7, &pool)));
+}
+
+// One const builder and robot serve concurrent builds from several threads,
+// with the same graphs as when built one after the other.
+TEST(DynamicsGraph, concurrentBuilders) {
+  const auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+
+  // Different horizons, with and without contacts.
+  const size_t num_jobs = 16;
+  const auto build = [&](size_t i) {
+    const int num_steps = 5 + i % 4;
+    NonlinearFactorGraph graph =
+        i % 2 ? graph_builder.trajectoryFG(robot, num_steps, 0.1, Trapezoidal,
+                                           contact_points, 0.7)
+              : graph_builder.trajectoryFG(robot, num_steps, 0.1);
+    graph.add(graph_builder.jointLimitFactors(robot, num_steps));
+    return graph;
+  };
+
+  std::vector<NonlinearFactorGraph> graphs(num_jobs);
+  ThreadPool pool(4);
+  pool.parallelFor(num_jobs, [&](size_t i, size_t /*worker*/) {
+    graphs[i] = build(i);
+  });
+  for (size_t i = 0; i < num_jobs; i++)
+    EXPECT(assert_equal(build(i), graphs[i]));
+}
+
+// A contact-implicit trajectory swaps the contact kinematics for a
+// complementarity factor per candidate point and step.
+TEST(DynamicsGraph, contactImplicitTrajectoryFG) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks candidates;
+  candidates.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+
+  const int num_steps = 4;
+  const auto scheduled = graph_builder.trajectoryFG(
+      robot, num_steps, 0.1, Trapezoidal, candidates, 0.7);
+  const auto graph = graph_builder.contactImplicitTrajectoryFG(
+      robot, num_steps, 0.1, candidates, ComplementarityParams(), Trapezoidal,
+      0.7);
+  EXPECT_LONGS_EQUAL(scheduled.size() - 2 * (num_steps + 1), graph.size());
+
+  size_t num_complementarity = 0;
+  for (auto &&factor : graph) {
+    EXPECT(!boost::dynamic_pointer_cast<ContactHeightFactor>(factor));
+    if (boost::dynamic_pointer_cast<ContactComplementarityFactor>(factor))
+      num_complementarity++;
+  }
+  EXPECT_LONGS_EQUAL(num_steps + 1, num_complementarity);
+  const int i = robot.link("link_0")->id();
+  for (int t = 0; t <= num_steps; t++)
+    EXPECT(graph.keys().exists(ContactWrenchKey(i, 0, t)));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -13,9 +13,14 @@
 
 #include <CppUnitLite/TestHarness.h>
 #include <gtdynamics/utils/DynamicsSymbol.h>
+#include <gtdynamics/utils/values.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
 
+#include <stdexcept>
+#include <string>
+#include <utility>
+
 using namespace std;
 using namespace gtsam;
 using namespace gtdynamics;
@@ -28,7 +33,11 @@ TEST(DynamicsSymbol, LinkJointSymbol) {
   const uint64_t t = 10;
   const DynamicsSymbol symbol = DynamicsSymbol::LinkJointSymbol(
       variable_type, link_index, joint_index, t);
+#ifdef GTDYNAMICS_WIDE_KEYS
+  const Key key = 0x004600100200000A;
+#else
   const Key key = 0x004601020000000A;
+#endif
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal(variable_type, symbol.label()));
   EXPECT_LONGS_EQUAL(link_index, symbol.linkIdx());
@@ -45,7 +54,11 @@ TEST(DynamicsSymbol, LinkSymbol) {
   const uint64_t t = 10;
   const DynamicsSymbol symbol =
       DynamicsSymbol::LinkSymbol("FA", link_index, 10);
+#ifdef GTDYNAMICS_WIDE_KEYS
+  const Key key = 0x4641002FFF00000A;
+#else
   const Key key = 0x464102FF0000000A;
+#endif
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("FA", symbol.label()));
   EXPECT_LONGS_EQUAL(link_index, symbol.linkIdx());
@@ -61,7 +74,11 @@ TEST(DynamicsSymbol, JointSymbol) {
   const uint64_t t = 10;
   const DynamicsSymbol symbol =
       DynamicsSymbol::JointSymbol("q", joint_index, 10);
+#ifdef GTDYNAMICS_WIDE_KEYS
+  const Key key = 0x0071FFF00100000A;
+#else
   const Key key = 0x0071FF010000000A;
+#endif
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("q", symbol.label()));
   EXPECT_LONGS_EQUAL(joint_index, symbol.jointIdx());
@@ -74,7 +91,11 @@ TEST(DynamicsSymbol, JointSymbol) {
 
 TEST(DynamicsSymbol, SimpleSymbol) {
   const DynamicsSymbol symbol = DynamicsSymbol::SimpleSymbol("ti", 10);
+#ifdef GTDYNAMICS_WIDE_KEYS
+  const Key key = 0x7469FFFFFF00000A;
+#else
   const Key key = 0x7469FFFF0000000A;
+#endif
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)symbol);
   EXPECT(assert_equal("ti", symbol.label()));
   EXPECT_LONGS_EQUAL(10, symbol.time());
@@ -84,7 +105,140 @@ TEST(DynamicsSymbol, SimpleSymbol) {
   EXPECT_LONGS_EQUAL((long)key, (long)(Key)DynamicsSymbol(key));
 }
 
+// Static decoding agrees with the symbol.
+TEST(DynamicsSymbol, Decode) {
+  const DynamicsSymbol symbol =
+      DynamicsSymbol::LinkJointSymbol("F", 3, 4, 1234);
+  const Key key = symbol;
+  EXPECT_LONGS_EQUAL(3, DynamicsSymbol::LinkIdx(key));
+  EXPECT_LONGS_EQUAL(4, DynamicsSymbol::JointIdx(key));
+  EXPECT_LONGS_EQUAL(1234, DynamicsSymbol::Time(key));
+  const Key other_time = DynamicsSymbol::LinkJointSymbol("F", 3, 4, 7);
+  EXPECT_LONGS_EQUAL((long)DynamicsSymbol::Prefix(key),
+                     (long)DynamicsSymbol::Prefix(other_time));
+
+  const Key joint_key = DynamicsSymbol::JointSymbol("q", 5, 0);
+  EXPECT_LONGS_EQUAL(DynamicsSymbol::kNoIndex,
+                     DynamicsSymbol::LinkIdx(joint_key));
+}
+
+// The largest index round-trips, and is printed by the key formatter.
+TEST(DynamicsSymbol, MaxIndex) {
+  const DynamicsIndex i = DynamicsSymbol::kMaxIndex;
+  const Key key = DynamicsSymbol::LinkJointSymbol("F", i, i, 2);
+  EXPECT_LONGS_EQUAL(i, DynamicsSymbol(key).linkIdx());
+  EXPECT_LONGS_EQUAL(i, DynamicsSymbol(key).jointIdx());
+  const std::string expected_str =
+      "F[" + std::to_string(i) + "](" + std::to_string(i) + ")2";
+  EXPECT(assert_equal(expected_str, GTDKeyFormatter(key)));
+}
+
+// Ids past the largest index, or negative, throw rather than wrap around.
+TEST(DynamicsSymbol, IndexRange) {
+  const int too_large = DynamicsSymbol::kMaxIndex + 2;
+  CHECK_EXCEPTION(DynamicsSymbol::JointSymbol("q", too_large, 0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::JointSymbol("q", -1, 0), std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkSymbol("p", too_large, 0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkSymbol("p", -1, 0), std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkJointSymbol("F", 1, too_large, 0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkJointSymbol("F", -1, 1, 0),
+                  std::out_of_range);
+
+  // Compile-time labels and the key helpers pass ids through unnarrowed.
+  CHECK_EXCEPTION(DynamicsSymbol::JointSymbol('q', too_large, 0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::JointSymbol('q', -1, 0), std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkSymbol('p', too_large, 0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(DynamicsSymbol::LinkJointSymbol('F', 1, -1, 0),
+                  std::out_of_range);
+  CHECK_EXCEPTION(internal::JointAngleKey(too_large), std::out_of_range);
+  CHECK_EXCEPTION(internal::JointAngleKey(-1), std::out_of_range);
+  CHECK_EXCEPTION(internal::PoseKey(-1), std::out_of_range);
+  CHECK_EXCEPTION(internal::WrenchKey(too_large, 1), std::out_of_range);
+  EXPECT_LONGS_EQUAL(DynamicsSymbol::kMaxIndex,
+                     internal::JointAngleKey(DynamicsSymbol::kMaxIndex)
+                         .jointIdx());
+}
+
+// Compile-time labels give the same keys as strings, in constant expressions.
+TEST(DynamicsSymbol, CharLabels) {
+  constexpr Key q_key = DynamicsSymbol::JointSymbol('q', 1, 10);
+  static_assert(DynamicsSymbol::Time(q_key) == 10, "key is not constexpr");
+  EXPECT_LONGS_EQUAL((long)(Key)DynamicsSymbol::JointSymbol("q", 1, 10),
+                     (long)q_key);
+  EXPECT_LONGS_EQUAL(
+      (long)(Key)DynamicsSymbol::LinkJointSymbol("F", 1, 2, 10),
+      (long)(Key)DynamicsSymbol::LinkJointSymbol('F', 1, 2, 10));
+  EXPECT_LONGS_EQUAL(
+      (long)(Key)DynamicsSymbol::LinkSymbol("FA", 2, 10),
+      (long)(Key)DynamicsSymbol::LinkSymbol(DynamicsLabel('F', 'A'), 2, 10));
+  EXPECT_LONGS_EQUAL(
+      (long)(Key)DynamicsSymbol::SimpleSymbol("ti", 10),
+      (long)(Key)DynamicsSymbol::SimpleSymbol(DynamicsLabel('t', 'i'), 10));
+  EXPECT(assert_equal("FA", DynamicsSymbol(DynamicsSymbol::LinkSymbol(
+                                DynamicsLabel('F', 'A'), 2, 10))
+                                .label()));
+
+  // The label prefix holds the label bits only.
+  const Key prefix = DynamicsSymbol::LabelPrefix('q');
+  EXPECT(assert_equal("q", DynamicsSymbol(prefix).label()));
+  EXPECT_LONGS_EQUAL(0, DynamicsSymbol::Time(prefix));
+  EXPECT_LONGS_EQUAL((long)prefix,
+                     (long)(q_key & DynamicsSymbol::LabelPrefix(
+                                        DynamicsLabel(char(0xFF),
+                                                      char(0xFF)))));
+
+  CHECK_EXCEPTION(DynamicsSymbol::JointSymbol('q', 1, uint64_t(-1)),
+                  std::out_of_range);
+}
+
+/* ************************************************************************* */
+// Robot instances live in the high bits of the time index.
+TEST(DynamicsSymbol, RobotInstance) {
+  constexpr uint64_t t = DynamicsSymbol::RobotTime(3, 17);
+  constexpr Key key = DynamicsSymbol::JointSymbol('q', 1, t);
+  static_assert(DynamicsSymbol::RobotInstance(key) == 3, "not constexpr");
+  EXPECT_LONGS_EQUAL(17, DynamicsSymbol::Step(key));
+  EXPECT_LONGS_EQUAL(1, DynamicsSymbol::JointIdx(key));
+  EXPECT_LONGS_EQUAL(3, DynamicsSymbol(key).robotInstance());
+  EXPECT_LONGS_EQUAL(17, DynamicsSymbol(key).step());
+  EXPECT(assert_equal("q(1)17@3", GTDKeyFormatter(key)));
+
+  // Steps of one robot are consecutive time indices, robot 0 is the default.
+  EXPECT_LONGS_EQUAL(DynamicsSymbol::RobotTime(3, 18), t + 1);
+  EXPECT_LONGS_EQUAL(5, DynamicsSymbol::RobotTime(0, 5));
+  const Key other = DynamicsSymbol::WithRobot(key, 5);
+  EXPECT_LONGS_EQUAL(5, DynamicsSymbol::RobotInstance(other));
+  EXPECT_LONGS_EQUAL(17, DynamicsSymbol::Step(other));
+  EXPECT(DynamicsSymbol::RobotTime(DynamicsSymbol::kMaxRobot, 1000) <
+         (uint64_t(1) << 31));
+
+  CHECK_EXCEPTION(DynamicsSymbol::RobotTime(DynamicsSymbol::kMaxRobot + 1, 0),
+                  std::out_of_range);
+}
+
 /* ************************************************************************* */
+// Format writes the text of the string conversion, without allocating.
+TEST(DynamicsSymbol, Format) {
+  const std::pair<Key, std::string> expected[] = {
+      {DynamicsSymbol::LinkJointSymbol("Fy", 12, 3, 45), "Fy[12](3)45"},
+      {DynamicsSymbol::JointSymbol('q', 0, 0), "q(0)0"},
+      {DynamicsSymbol::LinkSymbol('p', 7, 1234567), "p[7]1234567"},
+      {DynamicsSymbol::SimpleSymbol("dt", 2), "dt2"},
+      {DynamicsSymbol::JointSymbol('q', 1, DynamicsSymbol::RobotTime(3, 17)),
+       "q(1)17@3"}};
+  char buffer[DynamicsSymbol::kMaxFormatLength];
+  for (auto &&entry : expected) {
+    const char *end = DynamicsSymbol::Format(entry.first, buffer);
+    EXPECT(assert_equal(entry.second, std::string(buffer, end)));
+    EXPECT(assert_equal(entry.second, GTDKeyFormatter(entry.first)));
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,139 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testDynamicsValues.cpp
+ * @brief Test dense storage of dynamics variables.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/DynamicsValues.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::Vector6;
+
+// Values with every kind of dynamics variable at two time steps.
+static Values ExampleValues(const Robot &robot) {
+  Values values;
+  for (int t = 0; t < 2; ++t) {
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      InsertJointAngle(&values, j, t, 0.1 * j + t);
+      InsertJointVel(&values, j, t, 0.2 * j - t);
+      InsertJointAccel(&values, j, t, 0.3 * j);
+      InsertTorque(&values, j, t, 0.4 * j + 2 * t);
+      InsertWrench(&values, joint->parent()->id(), j, t,
+                   Vector6::Constant(j + t));
+      InsertWrench(&values, joint->child()->id(), j, t,
+                   Vector6::Constant(-j - t));
+    }
+    for (auto &&link : robot.links()) {
+      const int i = link->id();
+      InsertPose(&values, i, t,
+                 Pose3(gtsam::Rot3::Rx(i), gtsam::Point3(i, t, 0)));
+      InsertTwist(&values, i, t, Vector6::Constant(i * 0.5));
+      InsertTwistAccel(&values, i, t, Vector6::Constant(t * 0.25));
+    }
+  }
+  return values;
+}
+
+TEST(DynamicsValues, round_trip) {
+  auto robot = simple_rr::getRobot();
+  const Values values = ExampleValues(robot);
+
+  const DynamicsValues dense = DynamicsValues::FromValues(robot, values, 2);
+  EXPECT(assert_equal(values, dense.toValues()));
+
+  auto joint = robot.joints()[0];
+  const int j = joint->id(), i = joint->child()->id();
+  EXPECT_DOUBLES_EQUAL(JointAngle(values, j, 1), dense.jointAngle(j, 1), 0);
+  EXPECT_DOUBLES_EQUAL(Torque(values, j, 1), dense.torque(j, 1), 0);
+  EXPECT(assert_equal(Pose(values, i, 1), dense.pose(i, 1)));
+  EXPECT(assert_equal(Wrench(values, i, j, 1), dense.wrench(i, j, 1)));
+  EXPECT(dense.exists(DynamicsQuantity::Twist, i, 1));
+  EXPECT(dense.existsWrench(i, j, 0));
+}
+
+// Keys outside the container, and other keys, are ignored.
+TEST(DynamicsValues, partial) {
+  auto robot = simple_rr::getRobot();
+  Values values = ExampleValues(robot);
+  values.insert(gtsam::Symbol('x', 0), 1.0);
+
+  const DynamicsValues dense = DynamicsValues::FromValues(robot, values, 1);
+  EXPECT_LONGS_EQUAL(1, dense.numSteps());
+
+  Values expected;
+  for (auto &&key_value : values) {
+    if (key_value.key != gtsam::Symbol('x', 0) &&
+        DynamicsSymbol::Time(key_value.key) == 0)
+      expected.insert(key_value.key, key_value.value);
+  }
+  EXPECT(assert_equal(expected, dense.toValues()));
+}
+
+TEST(DynamicsValues, setters) {
+  auto robot = simple_rr::getRobot();
+  DynamicsValues dense(robot, 3);
+  auto joint = robot.joints()[1];
+  const int j = joint->id();
+
+  EXPECT(!dense.exists(DynamicsQuantity::JointAngle, j, 2));
+  dense.setJoint(DynamicsQuantity::JointAngle, j, 2, 0.5);
+  EXPECT(dense.exists(DynamicsQuantity::JointAngle, j, 2));
+  EXPECT_DOUBLES_EQUAL(0.5, dense.joints(DynamicsQuantity::JointAngle)(j, 2),
+                       0);
+  dense.setWrench(joint->child()->id(), j, 0, Vector6::Ones());
+
+  Values expected;
+  InsertJointAngle(&expected, j, 2, 0.5);
+  InsertWrench(&expected, joint->child()->id(), j, 0, Vector6::Ones());
+  EXPECT(assert_equal(expected, dense.toValues()));
+
+  // Only links of the joint carry its wrench.
+  for (auto &&link : robot.links()) {
+    if (link == joint->parent() || link == joint->child()) continue;
+    CHECK_EXCEPTION(dense.setWrench(link->id(), j, 0, Vector6::Ones()),
+                    std::invalid_argument);
+  }
+
+  dense.clear();
+  EXPECT(assert_equal(Values(), dense.toValues()));
+}
+
+// DynamicsGraph readers agree for Values and DynamicsValues.
+TEST(DynamicsValues, dynamics_graph) {
+  auto robot = simple_rr::getRobot();
+  const Values values = ExampleValues(robot);
+  const DynamicsValues dense = DynamicsValues::FromValues(robot, values, 2);
+  EXPECT(assert_equal(DynamicsGraph::jointAngles(robot, values, 1),
+                      DynamicsGraph::jointAngles(robot, dense, 1)));
+  EXPECT(assert_equal(DynamicsGraph::jointVels(robot, values, 1),
+                      DynamicsGraph::jointVels(robot, dense, 1)));
+  EXPECT(assert_equal(DynamicsGraph::jointAccels(robot, values, 0),
+                      DynamicsGraph::jointAccels(robot, dense, 0)));
+  EXPECT(assert_equal(DynamicsGraph::jointTorques(robot, values, 1),
+                      DynamicsGraph::jointTorques(robot, dense, 1)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testEditableTrajectoryGraph.cpp
+ * @brief Test incremental updates of a multi-phase trajectory graph.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/utils/EditableTrajectoryGraph.h"
+#include "gtdynamics/utils/Trajectory.h"
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using std::vector;
+
+namespace {
+// Factors in the non-null slots of a graph.
+NonlinearFactorGraph NonNull(const NonlinearFactorGraph &graph) {
+  NonlinearFactorGraph result;
+  for (const auto &factor : graph)
+    if (factor) result.push_back(factor);
+  return result;
+}
+}  // namespace
+
+TEST(EditableTrajectoryGraph, edits) {
+  using namespace walk_cycle_example;
+  const auto graph_builder =
+      DynamicsGraph(OptimizerSetting(1e-5), gtsam::Vector3(0, 0, -9.8));
+  const double mu = 1.0;
+  const vector<Phase> phases = {Phase(0, 2, phase_1), Phase(2, 5, phase_2)};
+  EditableTrajectoryGraph trajectory(robot, graph_builder, phases,
+                                     Trapezoidal, mu);
+
+  // Same graph as the multi-phase factor graph of the walk cycle.
+  EXPECT_LONGS_EQUAL(6, trajectory.numTimeSteps());
+  const NonlinearFactorGraph expected =
+      Trajectory(walk_cycle, 1)
+          .multiPhaseFactorGraph(robot, graph_builder, Trapezoidal, mu);
+  EXPECT_LONGS_EQUAL(expected.size(), trajectory.graph().size());
+  EXPECT(assert_equal(expected.keys(), trajectory.graph().keys()));
+
+  // Lengthening the last phase only appends the new step.
+  const size_t size_before = trajectory.graph().size();
+  auto update = trajectory.setNumTimeSteps(1, 4);
+  EXPECT_LONGS_EQUAL(7, trajectory.numTimeSteps());
+  EXPECT_LONGS_EQUAL(0, update.removed.size());
+  EXPECT_LONGS_EQUAL(size_before + update.new_factors.size(),
+                     trajectory.graph().size());
+  EXPECT(update.new_keys.count(internal::JointAngleKey(0, 6)));
+  EXPECT(!update.new_keys.count(internal::JointAngleKey(0, 5)));
+
+  // Changing the contacts of the first phase touches its steps only.
+  update = trajectory.setConstraintSpec(0, phase_2);
+  EXPECT(update.removed.size() > 0);
+  for (const size_t slot : update.removed)
+    EXPECT(!trajectory.graph()[slot]);
+  EXPECT(update.new_keys.size() > 0);
+  EXPECT(update.removed_keys.size() > 0);
+
+  // The edited graph matches one built from scratch.
+  const EditableTrajectoryGraph rebuilt(robot, graph_builder,
+                                        trajectory.phases(), Trapezoidal, mu);
+  const NonlinearFactorGraph edited = NonNull(trajectory.graph());
+  EXPECT_LONGS_EQUAL(rebuilt.graph().size(), edited.size());
+  EXPECT(assert_equal(rebuilt.graph().keys(), edited.keys()));
+
+  // Shortening a phase drops the factors of the last step.
+  update = trajectory.setNumTimeSteps(0, 1);
+  EXPECT_LONGS_EQUAL(6, trajectory.numTimeSteps());
+  EXPECT(update.removed_keys.count(internal::JointAngleKey(0, 6)));
+
+  CHECK_EXCEPTION(trajectory.setNumTimeSteps(0, 0), std::invalid_argument);
+  CHECK_EXCEPTION(trajectory.setConstraintSpec(2, phase_1),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
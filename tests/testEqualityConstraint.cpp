@@ -21,6 +21,7 @@
 #include "gtdynamics/factors/PoseFactor.h"
 #include "gtdynamics/optimizer/EqualityConstraint.h"
 #include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/ThreadPool.h"
 #include "make_joint.h"
 
 using namespace gtdynamics;
@@ -163,6 +164,89 @@ TEST(EqualityConstraint, Container) {
   EXPECT_LONGS_EQUAL(2, constraints.size());
 }
 
+// Fused evaluation agrees with the per-constraint methods, with or without
+// threads.
+TEST(EqualityConstraint, ContainerEvaluate) {
+  gtsam::Symbol v1_key('v', 1), v2_key('v', 2);
+  Vector2_ v1(v1_key), v2(v2_key);
+  EqualityConstraints constraints;
+  for (int i = 0; i < 300; i++) {
+    constraints.emplace_shared<DoubleExpressionEquality>(
+        x1 + pow(x2, 2) + Double_(double(i)), 0.1 * (i + 1));
+    constraints.emplace_shared<VectorExpressionEquality<2>>(
+        v1 + v2, Vector2(0.1, 0.5 + i));
+  }
+
+  Values values;
+  values.insert(x1_key, 0.5);
+  values.insert(x2_key, -1.5);
+  values.insert(v1_key, Vector2(1, 2));
+  values.insert(v2_key, Vector2(-3, 0.5));
+
+  double expected = 0;
+  for (const auto &constraint : constraints)
+    expected += constraint->toleranceScaledViolation(values).squaredNorm();
+
+  std::vector<gtsam::Vector> violations;
+  EXPECT_DOUBLES_EQUAL(expected, constraints.evaluate(values, &violations),
+                       1e-9 * expected);
+  EXPECT_LONGS_EQUAL(constraints.size(), violations.size());
+  for (size_t i = 0; i < constraints.size(); i++)
+    EXPECT(assert_equal((*constraints[i])(values), violations[i]));
+
+  ThreadPool pool(3);
+  EXPECT_DOUBLES_EQUAL(constraints.evaluate(values),
+                       constraints.evaluate(values, nullptr, &pool), 0);
+}
+
+// Flat buffers hold the same violations, and are reused.
+TEST(EqualityConstraint, ContainerEvaluateInto) {
+  gtsam::Symbol v1_key('v', 1), v2_key('v', 2);
+  Vector2_ v1(v1_key), v2(v2_key);
+  EqualityConstraints constraints;
+  for (int i = 0; i < 300; i++) {
+    constraints.emplace_shared<DoubleExpressionEquality>(
+        x1 + pow(x2, 2) + Double_(double(i)), 0.1 * (i + 1));
+    constraints.emplace_shared<VectorExpressionEquality<2>>(
+        v1 + v2, Vector2(0.1, 0.5 + i));
+  }
+
+  Values values;
+  values.insert(x1_key, 0.5);
+  values.insert(x2_key, -1.5);
+  values.insert(v1_key, Vector2(1, 2));
+  values.insert(v2_key, Vector2(-3, 0.5));
+
+  ConstraintViolations violations;
+  const double expected = constraints.evaluate(values);
+  EXPECT_DOUBLES_EQUAL(expected, constraints.evaluateInto(values, &violations),
+                       1e-9 * expected);
+  EXPECT_LONGS_EQUAL(constraints.size(), violations.size());
+  EXPECT_LONGS_EQUAL(900, violations.violation.size());
+  for (size_t i = 0; i < constraints.size(); i++) {
+    EXPECT(assert_equal((*constraints[i])(values),
+                        gtsam::Vector(violations.at(i))));
+    EXPECT(violations.feasible(i) == constraints[i]->feasible(values));
+  }
+  EXPECT(!violations.feasible());
+
+  // Same buffers, with threads.
+  const double* data = violations.violation.data();
+  ThreadPool pool(3);
+  EXPECT_DOUBLES_EQUAL(expected,
+                       constraints.evaluateInto(values, &violations, &pool),
+                       1e-9 * expected);
+  EXPECT(data == violations.violation.data());
+
+  // Feasible at a solution of all constraints.
+  EqualityConstraints feasible;
+  feasible.emplace_shared<VectorExpressionEquality<2>>(v1 + v2,
+                                                        Vector2(0.1, 0.1));
+  values.update(v2_key, Vector2(-1, -2));
+  feasible.evaluateInto(values, &violations);
+  EXPECT(violations.feasible());
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
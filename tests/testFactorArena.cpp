@@ -0,0 +1,80 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFactorArena.cpp
+ * @brief Test arena allocation of factors.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+
+#include <cstdint>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/FactorArena.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+
+using namespace gtdynamics;
+using gtsam::Pose3;
+using gtsam::symbol_shorthand::X;
+
+TEST(FactorArena, Allocate) {
+  FactorArena arena(256);
+  for (size_t alignment : {1, 8, 16, 32}) {
+    const auto p = reinterpret_cast<uintptr_t>(arena.allocate(3, alignment));
+    EXPECT_LONGS_EQUAL(0, p % alignment);
+  }
+  EXPECT_LONGS_EQUAL(256, arena.capacity());
+
+  // Larger than a chunk.
+  arena.allocate(1000, 16);
+  EXPECT(arena.capacity() >= 256 + 1000);
+}
+
+// Factors keep their arena alive.
+TEST(FactorArena, MakeShared) {
+  auto arena = std::make_shared<FactorArena>();
+  auto model = gtsam::noiseModel::Unit::Create(6);
+  auto factor = MakeShared<gtsam::PriorFactor<Pose3>>(arena, X(0), Pose3(),
+                                                      model);
+  EXPECT_LONGS_EQUAL(2, arena.use_count());
+  arena.reset();
+  gtsam::Values values;
+  values.insert(X(0), Pose3());
+  EXPECT_DOUBLES_EQUAL(0, factor->error(values), 1e-9);
+
+  const auto heap =
+      MakeShared<gtsam::PriorFactor<Pose3>>(nullptr, X(0), Pose3(), model);
+  EXPECT(heap->equals(*factor));
+}
+
+// A trajectory graph built in an arena equals the one built on the heap.
+TEST(FactorArena, Trajectory) {
+  const Robot robot = simple_rr::getRobot();
+  const int num_steps = 5;
+  const double dt = 0.1;
+  OptimizerSetting opt;
+  opt.setArenaAllocation();
+  gtsam::NonlinearFactorGraph expected, actual;
+  {
+    expected = DynamicsGraph().trajectoryFG(robot, num_steps, dt);
+    actual = DynamicsGraph(opt).trajectoryFG(robot, num_steps, dt);
+  }
+  EXPECT_LONGS_EQUAL(expected.size(), actual.size());
+  EXPECT(assert_equal(expected.keys(), actual.keys()));
+  const auto values = ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
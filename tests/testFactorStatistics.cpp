@@ -0,0 +1,124 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFactorStatistics.cpp
+ * @brief Test error and linearization statistics by factor type.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <sstream>
+#include <string>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/FactorStatistics.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::symbol_shorthand::X;
+
+TEST(FactorStatistics, ByType) {
+  auto model = gtsam::noiseModel::Unit::Create(6);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<Pose3>>(X(0), Pose3(), model);
+  graph.emplace_shared<gtsam::PriorFactor<Pose3>>(X(1), Pose3(), model);
+  graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(X(0), X(1), Pose3(),
+                                                    model);
+
+  gtsam::Values values;
+  values.insert(X(0), Pose3());
+  values.insert(X(1), Pose3(Rot3(), Point3(1, 0, 0)));
+
+  const auto statistics = FactorStatistics(graph, values, 3);
+  LONGS_EQUAL(2, statistics.size());
+
+  // The prior on X(1) and the between factor both have error 0.5, so the
+  // priors come first.
+  EXPECT(statistics[0].type.find("PriorFactor") != std::string::npos);
+  EXPECT_LONGS_EQUAL(2, statistics[0].count);
+  EXPECT_LONGS_EQUAL(12, statistics[0].dimension);
+  EXPECT_DOUBLES_EQUAL(0.5, statistics[0].error, 1e-9);
+  EXPECT(statistics[0].linearize_time >= 0);
+
+  EXPECT(statistics[1].type.find("BetweenFactor") != std::string::npos);
+  EXPECT_LONGS_EQUAL(1, statistics[1].count);
+  EXPECT_DOUBLES_EQUAL(0.5, statistics[1].error, 1e-9);
+
+  EXPECT_DOUBLES_EQUAL(graph.error(values),
+                       statistics[0].error + statistics[1].error, 1e-9);
+
+  std::stringstream ss;
+  PrintFactorStatistics(statistics, ss);
+  EXPECT(ss.str().find("BetweenFactor") != std::string::npos);
+  EXPECT(ss.str().find("total") != std::string::npos);
+}
+
+// The statistics of a dynamics graph match its size and error.
+TEST(FactorStatistics, DynamicsGraph) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder;
+  const auto graph = graph_builder.dynamicsFactorGraph(robot, 0);
+  const auto values = ZeroValues(robot, 0);
+
+  const auto statistics = DynamicsGraph::factorStatistics(graph, values);
+  size_t count = 0;
+  double error = 0;
+  for (auto &&s : statistics) {
+    count += s.count;
+    error += s.error;
+  }
+  EXPECT_LONGS_EQUAL(graph.size(), count);
+  EXPECT_DOUBLES_EQUAL(graph.error(values), error, 1e-9);
+}
+
+// The summary counts every factor and key of a dynamics graph.
+TEST(FactorStatistics, Summary) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder;
+  auto graph = graph_builder.dynamicsFactorGraph(robot, 3);
+  graph.push_back(gtsam::NonlinearFactor::shared_ptr());
+
+  const GraphSummary summary = SummarizeGraph(graph);
+  EXPECT_LONGS_EQUAL(graph.size() - 1, summary.num_factors);
+  size_t count = 0, occurrences = 0, slots = 0;
+  for (auto &&type : summary.factor_types) count += type.second;
+  for (size_t i = 1; i < summary.factor_types.size(); i++)
+    EXPECT(summary.factor_types[i - 1].second >=
+           summary.factor_types[i].second);
+  for (auto &&factor : graph)
+    if (factor) slots += factor->size();
+  bool found_q = false;
+  for (auto &&family : summary.key_families) {
+    occurrences += family.occurrences;
+    EXPECT_LONGS_EQUAL(3, family.first_step);
+    EXPECT_LONGS_EQUAL(3, family.last_step);
+    if (family.label != "q") continue;
+    found_q = true;
+    EXPECT_LONGS_EQUAL(robot.numJoints(), family.variables);
+  }
+  EXPECT_LONGS_EQUAL(summary.num_factors, count);
+  EXPECT_LONGS_EQUAL(slots, occurrences);
+  EXPECT(found_q);
+
+  std::stringstream ss;
+  PrintGraphSummary(summary, ss);
+  EXPECT(ss.str().find("3..3") != std::string::npos);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
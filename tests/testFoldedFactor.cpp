@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testFoldedFactor.cpp
+ * @brief Test folding known values into factors as constants.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/GaussNewtonOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/factors/FoldedFactor.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// A between factor with its first variable known.
+TEST(FoldedFactor, Between) {
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 0.5);
+  const auto between =
+      boost::make_shared<gtsam::BetweenFactor<double>>(1, 2, 3.0, model);
+  Values constants;
+  constants.insert<double>(1, 1.0);
+  const FoldedFactor folded(between, constants);
+  EXPECT_LONGS_EQUAL(1, folded.size());
+  EXPECT_LONGS_EQUAL(2, folded.keys().front());
+
+  Values x, all;
+  x.insert<double>(2, 5.0);
+  all.insert<double>(1, 1.0);
+  all.insert<double>(2, 5.0);
+  EXPECT_DOUBLES_EQUAL(between->error(all), folded.error(x), 1e-12);
+
+  // The linearization keeps only the column of the free variable.
+  const auto linear =
+      boost::dynamic_pointer_cast<gtsam::JacobianFactor>(folded.linearize(x));
+  CHECK(linear);
+  EXPECT_LONGS_EQUAL(1, linear->size());
+  const auto expected = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+      between->linearize(all));
+  EXPECT(assert_equal(gtsam::Matrix(expected->getA(expected->find(2))),
+                      gtsam::Matrix(linear->getA(linear->begin())), 1e-12));
+  EXPECT(assert_equal(gtsam::Vector(expected->getb()),
+                      gtsam::Vector(linear->getb()), 1e-12));
+}
+
+// Factors on known values only are dropped, others pass through.
+TEST(FoldConstants, Graph) {
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  NonlinearFactorGraph graph;
+  graph.addPrior<double>(1, 0.0, model);
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(1, 2, 1.0, model);
+  graph.addPrior<double>(3, 0.0, model);
+  Values constants;
+  constants.insert<double>(1, 0.0);
+
+  const NonlinearFactorGraph folded = FoldConstants(graph, constants);
+  EXPECT_LONGS_EQUAL(2, folded.size());
+  EXPECT(boost::dynamic_pointer_cast<FoldedFactor>(folded.at(0)));
+  EXPECT(folded.at(1) == graph.at(2));
+  EXPECT(!folded.keys().exists(1));
+}
+
+// Forward dynamics with the known angles, velocities and torques folded in,
+// as in the test of forwardDynamicsPriors in testDynamicsGraph.
+TEST(FoldConstants, ForwardDynamics) {
+  const Robot robot = simple_urdf_eq_mass::getRobot();
+  const size_t t = 777;
+  DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+
+  Values known_values;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&known_values, joint->id(), t, 0.0);
+    InsertJointVel(&known_values, joint->id(), t, 0.0);
+    InsertTorque(&known_values, joint->id(), t, 1.0);
+  }
+  const Values constants =
+      DynamicsGraph::forwardDynamicsConstants(robot, t, known_values);
+  EXPECT_LONGS_EQUAL(3 * robot.numJoints(), constants.size());
+
+  NonlinearFactorGraph graph = graph_builder.dynamicsFactorGraph(robot, t);
+  for (auto link : robot.links()) {
+    int i = link->id();
+    graph.addPrior(internal::PoseKey(i, t), link->bMcom(),
+                   graph_builder.opt().bp_cost_model);
+    graph.addPrior<gtsam::Vector6>(internal::TwistKey(i, t), gtsam::Z_6x1,
+                                   graph_builder.opt().bv_cost_model);
+  }
+  const NonlinearFactorGraph folded = FoldConstants(graph, constants);
+  for (const gtsam::Key key : constants.keys())
+    EXPECT(!folded.keys().exists(key));
+
+  Values init = ZeroValues(robot, t);
+  for (const gtsam::Key key : constants.keys()) init.erase(key);
+  gtsam::GaussNewtonOptimizer optimizer(folded, init);
+  Values result = optimizer.optimize();
+  result.insert(constants);
+
+  const gtsam::Vector expected_qAccel = (gtsam::Vector(1) << 4).finished();
+  EXPECT(assert_equal(expected_qAccel,
+                      DynamicsGraph::jointAccels(robot, result, t), 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGaussianProcessTrajectory.cpp
+ * @brief Test the Gaussian process prior and the sparse knot trajectory.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <boost/make_shared.hpp>
+
+#include "gtdynamics/factors/GaussianProcessPriorFactor.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/GaussianProcessTrajectory.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector3;
+using gtsam::noiseModel::Isotropic;
+
+namespace example {
+const auto Qc_model = Isotropic::Sigma(1, 1.0);
+
+// Knots of a constant acceleration motion of every joint.
+Values constantAccel(const Robot &robot, int num_knots, double dt) {
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    for (int i = 0; i <= num_knots; ++i) {
+      const double t = i * dt, a = 0.5 + j;
+      InsertJointAngle(&values, j, i, 0.1 + 0.2 * t + 0.5 * a * t * t);
+      InsertJointVel(&values, j, i, 0.2 + a * t);
+      InsertJointAccel(&values, j, i, a);
+    }
+  }
+  return values;
+}
+}  // namespace example
+
+// The prior has no error on constant accelerations.
+TEST(GaussianProcessPriorFactor, Error) {
+  using namespace internal;
+  const GaussianProcessPriorFactor factor(
+      JointAngleKey(0, 0), JointVelKey(0, 0), JointAccelKey(0, 0),
+      JointAngleKey(0, 1), JointVelKey(0, 1), JointAccelKey(0, 1), 0.1,
+      example::Qc_model);
+  Values values = example::constantAccel(simple_rr::getRobot(), 1, 0.1);
+  EXPECT(assert_equal(Vector3::Zero().eval(),
+                      gtsam::Vector(factor.unwhitenedError(values)), 1e-12));
+
+  values.update(JointAccelKey(0, 1), 2.0);
+  EXPECT(factor.error(values) > 0);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+// The interpolation meets the knots and is exact for constant accelerations.
+TEST(GaussianProcessTrajectory, Interpolate) {
+  const double dt = 0.1;
+  const GaussianProcessInterpolation start(0, dt), end(dt, dt);
+  EXPECT(assert_equal(gtsam::Matrix3::Identity().eval(), start.Lambda, 1e-9));
+  EXPECT(assert_equal(gtsam::Matrix3::Identity().eval(), end.Psi, 1e-6));
+
+  const Robot robot = simple_rr::getRobot();
+  const int num_knots = 3;
+  const GaussianProcessTrajectory trajectory(robot, num_knots, dt, 4,
+                                             example::Qc_model);
+  EXPECT_LONGS_EQUAL(12, trajectory.numDenseSteps());
+  EXPECT_DOUBLES_EQUAL(0.025, trajectory.denseDt(), 1e-12);
+  EXPECT_LONGS_EQUAL(num_knots * robot.numJoints(),
+                     trajectory.priorFactors().size());
+
+  const Values knots = example::constantAccel(robot, num_knots, dt);
+  const Values dense = trajectory.interpolate(knots);
+  EXPECT(assert_equal(
+      example::constantAccel(robot, trajectory.numDenseSteps(), 0.025), dense,
+      1e-9));
+  EXPECT(assert_equal(knots, trajectory.knotValues(dense), 1e-12));
+  THROWS_EXCEPTION(trajectory.combination(internal::JointAngleKey(0, 13)));
+  EXPECT(trajectory.combination(internal::TorqueKey(0, 5)).empty());
+}
+
+// Factors on dense steps constrain the knots, through the interpolation.
+TEST(GaussianProcessTrajectory, InterpolatedFactor) {
+  const Robot robot = simple_rr::getRobot();
+  const double dt = 0.1;
+  const GaussianProcessTrajectory trajectory(robot, 2, dt, 4,
+                                             example::Qc_model);
+  const int j = robot.joints()[0]->id();
+  const gtsam::Key dense_key = internal::JointAngleKey(j, 6);
+  const auto dense_prior = boost::make_shared<gtsam::PriorFactor<double>>(
+      dense_key, 0.7, Isotropic::Sigma(1, 1e-3));
+  const auto factor = trajectory.interpolatedFactor(dense_prior);
+  EXPECT_LONGS_EQUAL(6, factor->size());
+
+  const Values knots = example::constantAccel(robot, 2, dt);
+  EXPECT_DOUBLES_EQUAL(dense_prior->error(trajectory.interpolate(knots)),
+                       factor->error(knots), 1e-9);
+
+  // Optimizing the knots puts the interpolated dense state on the prior.
+  gtsam::NonlinearFactorGraph graph = trajectory.priorFactors();
+  graph.push_back(factor);
+  for (auto &&joint : robot.joints())
+    graph.addPrior(internal::JointAngleKey(joint->id(), 0), 0.0,
+                   Isotropic::Sigma(1, 1e-3));
+  const Values result =
+      gtsam::LevenbergMarquardtOptimizer(graph, knots).optimize();
+  EXPECT_DOUBLES_EQUAL(0.7, JointAngle(trajectory.interpolate(result), j, 6),
+                       1e-2);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
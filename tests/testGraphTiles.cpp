@@ -0,0 +1,143 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGraphTiles.cpp
+ * @brief Test export of factor graphs in time windows.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/GraphTiles.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+namespace {
+// Joint angles and velocities of one joint over steps 0..4, with a prior on
+// each and a between factor from each angle to the next.
+gtsam::NonlinearFactorGraph Graph(Values *values) {
+  auto model = gtsam::noiseModel::Unit::Create(1);
+  gtsam::NonlinearFactorGraph graph;
+  for (size_t t = 0; t < 5; t++) {
+    values->insert(internal::JointAngleKey(1, t), double(t));
+    values->insert(internal::JointVelKey(1, t), 1.0);
+    graph.emplace_shared<gtsam::PriorFactor<double>>(
+        internal::JointAngleKey(1, t), double(t), model);
+    graph.emplace_shared<gtsam::PriorFactor<double>>(
+        internal::JointVelKey(1, t), 1.0, model);
+    if (t + 1 < 5)
+      graph.emplace_shared<gtsam::BetweenFactor<double>>(
+          internal::JointAngleKey(1, t), internal::JointAngleKey(1, t + 1),
+          1.0, model);
+  }
+  return graph;
+}
+
+// Lines of a stream.
+std::vector<std::string> Lines(std::stringstream &ss) {
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline(ss, line)) lines.push_back(line);
+  return lines;
+}
+}  // namespace
+
+TEST(GraphTiles, Windows) {
+  Values values;
+  const auto graph = Graph(&values);
+  GraphTileParameters parameters;
+  parameters.window_steps = 2;
+  const GraphTiles tiles(graph, values, GraphTiles::Layout(), parameters);
+
+  // Steps 0-1, 2-3 and 4.
+  EXPECT_LONGS_EQUAL(3, tiles.size());
+  const GraphWindow &first = tiles.window(0);
+  EXPECT_LONGS_EQUAL(0, first.first_step);
+  EXPECT_LONGS_EQUAL(1, first.last_step);
+  // 4 priors, the between factors from steps 0 and 1.
+  EXPECT_LONGS_EQUAL(6, first.factors.size());
+  // The angle at step 2 is reached across the boundary.
+  EXPECT_LONGS_EQUAL(5, first.keys.size());
+  EXPECT_LONGS_EQUAL(3, first.clusters.at("q"));
+  EXPECT_LONGS_EQUAL(2, first.clusters.at("v"));
+  EXPECT_LONGS_EQUAL(2, tiles.window(2).factors.size());
+
+  // Steps are 20 apart along x, centered on their step.
+  EXPECT_DOUBLES_EQUAL(30.0, tiles.extent(1).first, 1e-9);
+  EXPECT_DOUBLES_EQUAL(70.0, tiles.extent(1).second, 1e-9);
+  const auto visible = tiles.windowsIn(25.0, 35.0);
+  EXPECT_LONGS_EQUAL(2, visible.size());
+  EXPECT_LONGS_EQUAL(0, visible[0]);
+  EXPECT_LONGS_EQUAL(1, visible[1]);
+
+  parameters.window_steps = 0;
+  CHECK_EXCEPTION(GraphTiles(graph, values, GraphTiles::Layout(), parameters),
+                  std::invalid_argument);
+}
+
+TEST(GraphTiles, Layout) {
+  Values values;
+  const auto graph = Graph(&values);
+  GraphTileParameters parameters;
+  parameters.window_steps = 2;
+  size_t num_calls = 0;
+  const GraphTiles tiles(
+      graph, values,
+      [&](size_t t) {
+        num_calls++;
+        GraphTiles::LocationType locations;
+        locations[internal::JointAngleKey(1, t)] = gtsam::Vector3(0, 1, 0);
+        return locations;
+      },
+      parameters);
+
+  // Nothing is laid out until a window is requested.
+  EXPECT_LONGS_EQUAL(0, num_calls);
+  const auto locations = tiles.locations(1);
+  EXPECT_LONGS_EQUAL(3, num_calls);  // steps 2, 3 and 4
+  EXPECT_LONGS_EQUAL(3, locations.size());
+  EXPECT_DOUBLES_EQUAL(
+      60.0, locations.at(internal::JointAngleKey(1, 3)).x(), 1e-9);
+}
+
+TEST(GraphTiles, Write) {
+  Values values;
+  const auto graph = Graph(&values);
+  GraphTileParameters parameters;
+  parameters.window_steps = 2;
+  const GraphTiles tiles(graph, values, GraphTiles::Layout(), parameters);
+
+  // Opening, 5 variables, separator, 6 factors, closing.
+  std::stringstream ss;
+  tiles.writeWindow(0, ss);
+  EXPECT_LONGS_EQUAL(14, Lines(ss).size());
+
+  // Only the angles, and the factors on angles only.
+  std::stringstream angles;
+  tiles.writeWindow(0, angles, {"q"});
+  EXPECT_LONGS_EQUAL(3 + 4 + 3, Lines(angles).size());
+
+  std::stringstream manifest;
+  tiles.writeManifest(manifest);
+  const std::string s = manifest.str();
+  EXPECT(s.find("\"window_2.json\"") != std::string::npos);
+  EXPECT(s.find("\"first_step\":4") != std::string::npos);
+  EXPECT(s.find("\"clusters\":{\"q\":3,\"v\":2}") != std::string::npos);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testGraphWriter.cpp
+ * @brief Test streaming export of factor graphs.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/utils/GraphWriter.h"
+
+using namespace gtdynamics;
+using gtsam::Pose3;
+using gtsam::Values;
+using gtsam::symbol_shorthand::X;
+
+namespace {
+// Two poses with a prior and a between factor.
+gtsam::NonlinearFactorGraph Graph(Values *values) {
+  auto model = gtsam::noiseModel::Unit::Create(6);
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<Pose3>>(X(0), Pose3(), model);
+  graph.emplace_shared<gtsam::BetweenFactor<Pose3>>(X(0), X(1), Pose3(),
+                                                    model);
+  values->insert(X(0), Pose3());
+  values->insert(X(1), Pose3(gtsam::Rot3(), gtsam::Point3(1, 2, 3)));
+  return graph;
+}
+}  // namespace
+
+TEST(GraphWriter, Json) {
+  Values values;
+  const auto graph = Graph(&values);
+  std::stringstream ss;
+  GraphWriter::Save(graph, ss, values);
+
+  // One record per line, between the opening and closing lines.
+  std::string line;
+  std::vector<std::string> lines;
+  while (std::getline(ss, line)) lines.push_back(line);
+  EXPECT_LONGS_EQUAL(7, lines.size());
+  EXPECT(lines[0] == "[[");
+  EXPECT(lines[1][0] == '{');
+  EXPECT(lines[2][0] == ',');
+  EXPECT(lines[3] == "],[");
+  EXPECT(lines[4][0] == '{');
+  EXPECT(lines[5][0] == ',');
+  EXPECT(lines[6] == "]]");
+}
+
+TEST(GraphWriter, JsonOrder) {
+  Values values;
+  const auto graph = Graph(&values);
+  std::stringstream ss;
+  GraphWriter writer(ss);
+  writer.writeFactor(0, graph.at(0), values);
+  CHECK_EXCEPTION(writer.writeVariable(X(0), values), std::logic_error);
+  writer.finish();
+  CHECK_EXCEPTION(writer.writeFactor(1, graph.at(1), values),
+                  std::logic_error);
+}
+
+TEST(GraphWriter, Binary) {
+  Values values;
+  const auto graph = Graph(&values);
+  std::stringstream ss;
+  GraphWriter::Save(graph, ss, values, {}, GraphFormat::Binary);
+  const std::string data = ss.str();
+
+  EXPECT(data.compare(0, 8, "GTDGRAPH") == 0);
+  uint32_t version;
+  std::memcpy(&version, data.data() + 8, sizeof(version));
+  EXPECT_LONGS_EQUAL(1, version);
+
+  // Skip through the records by their sizes.
+  std::string kinds;
+  size_t offset = 12;
+  while (offset < data.size()) {
+    kinds += data[offset];
+    uint32_t size;
+    std::memcpy(&size, data.data() + offset + 1, sizeof(size));
+    offset += 5 + size;
+  }
+  EXPECT_LONGS_EQUAL(data.size(), offset);
+  EXPECT(kinds == "VVFF");
+
+  // The first variable payload starts with its key.
+  uint64_t key;
+  std::memcpy(&key, data.data() + 17, sizeof(key));
+  EXPECT_LONGS_EQUAL(X(0), key);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
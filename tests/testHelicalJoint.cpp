@@ -14,6 +14,7 @@
 #include <CppUnitLite/TestHarness.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
 #include <gtsam/base/serializationTestHelpers.h>
 
 #include "gtdynamics/universal_robot/HelicalJoint.h"
@@ -98,6 +99,33 @@ TEST(Joint, params_constructor) {
                       j1->parameters().scalar_limits.value_limit_threshold));
 }
 
+// Revolute and helical joint transforms, computed in closed form for the
+// revolute joint, agree with the exponential map of the screw axis.
+TEST(Joint, ClosedFormTransforms) {
+  auto robot = simple_urdf::getRobot();
+  auto l1 = robot.link("l1");
+  auto l2 = robot.link("l2");
+  const Pose3 bTj(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0, 0.5, 2));
+  const gtsam::Vector3 axis(0, 0.6, 0.8);
+  const RevoluteJoint revolute(1, "r", bTj, l1, l2, axis);
+  const HelicalJoint helical(2, "h", bTj, l1, l2, axis, 0.5);
+
+  const double q = -1.1;
+  for (const Joint *joint : std::vector<const Joint *>{&revolute, &helical}) {
+    const Pose3 pTc = joint->pMc() * Pose3::Expmap(joint->cScrewAxis() * q);
+    gtsam::Matrix61 H_pTc, H_cTp;
+    EXPECT(assert_equal(pTc, joint->parentTchild(q, H_pTc), 1e-9));
+    EXPECT(assert_equal(pTc.inverse(), joint->childTparent(q, H_cTp), 1e-9));
+
+    auto f1 = [&](double q) { return joint->parentTchild(q); };
+    auto f2 = [&](double q) { return joint->childTparent(q); };
+    EXPECT(assert_equal(gtsam::numericalDerivative11<Pose3, double>(f1, q),
+                        H_pTc, 1e-7));
+    EXPECT(assert_equal(gtsam::numericalDerivative11<Pose3, double>(f2, q),
+                        H_cTp, 1e-7));
+  }
+}
+
 BOOST_CLASS_EXPORT(gtdynamics::HelicalJoint)
 
 TEST(HelicalJoint, Serialization) {
@@ -0,0 +1,81 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testILQR.cpp
+ * @brief Test iterative LQR on a fixed-base arm.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/ILQR.h"
+#include "gtdynamics/dynamics/Simulator.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Vector;
+
+// Swing the two-link arm to a goal configuration against gravity.
+TEST(ILQR, reach) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  ILQRParameters parameters;
+  parameters.dt = 0.02;
+  parameters.state_weights = Vector::Constant(4, 0.01);
+  parameters.terminal_weights = Vector::Constant(4, 1000);
+  parameters.control_weights = Vector::Constant(2, 0.001);
+  ILQR ilqr(robot, gravity, parameters);
+  EXPECT_LONGS_EQUAL(2, ilqr.jointSlots());
+
+  const Vector zero = Vector::Zero(2);
+  Vector q_goal(2);
+  q_goal << 0.5, -0.3;
+  const size_t T = 60;
+  const std::vector<Vector> initial(T, zero);
+  const ILQRResult result = ilqr.optimize(zero, zero, q_goal, zero, initial);
+
+  EXPECT(result.converged);
+  EXPECT_LONGS_EQUAL(T + 1, result.q.size());
+  EXPECT_LONGS_EQUAL(T, result.tau.size());
+  EXPECT_LONGS_EQUAL(T, result.K.size());
+  EXPECT(assert_equal(q_goal, result.q.back(), 0.02));
+  EXPECT(assert_equal(zero, result.v.back(), 0.05));
+
+  // The trajectory is that of the simulator, with the same integration.
+  Simulator simulator(robot, gtsam::Values(), gravity, boost::none,
+                      ArticulatedBody);
+  for (auto &&tau : result.tau) simulator.step(tau, parameters.dt);
+  EXPECT(assert_equal(result.q.back(), simulator.jointAngles(), 1e-9));
+  EXPECT(assert_equal(result.v.back(), simulator.jointVels(), 1e-9));
+}
+
+// States, torques and weights are joint-id indexed.
+TEST(ILQR, arguments) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  ILQRParameters parameters;
+  parameters.control_weights = Vector::Ones(3);
+  CHECK_EXCEPTION(ILQR(robot, boost::none, parameters),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(ILQR(simple_rr::getRobot()), std::invalid_argument);
+
+  ILQR ilqr(robot);
+  const Vector zero = Vector::Zero(2);
+  CHECK_EXCEPTION(ilqr.optimize(zero, zero, Vector::Zero(3), zero, {zero}),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(ilqr.optimize(zero, zero, zero, zero, {Vector::Zero(1)}),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,164 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInequalityConstraint.cpp
+ * @brief Test inequality constraints and their one-sided penalties.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "constrainedExample.h"
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
+#include "gtdynamics/optimizer/InequalityConstraint.h"
+#include "gtdynamics/optimizer/PenaltyFactor.h"
+#include "gtdynamics/optimizer/PenaltyMethodOptimizer.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+TEST(InequalityConstraint, DoubleExpressionInequality) {
+  using namespace constrained_example;
+  const double tolerance = 0.1;
+  DoubleExpressionInequality constraint(Double_(1.0) - x1, tolerance);
+
+  Values values;
+  values.insert(x1_key, 0.5);
+  EXPECT(constraint.feasible(values));
+  EXPECT(assert_equal(gtsam::Vector1(0.5), constraint(values)));
+  EXPECT(assert_equal(gtsam::Vector1(0.0),
+                      constraint.toleranceScaledViolation(values)));
+
+  values.update(x1_key, 2.0);
+  EXPECT(!constraint.feasible(values));
+  EXPECT(assert_equal(gtsam::Vector1(-10.0),
+                      constraint.toleranceScaledViolation(values)));
+
+  InequalityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionInequality>(Double_(1.0) - x1,
+                                                         tolerance);
+  EXPECT_DOUBLES_EQUAL(100.0, constraints.evaluate(values), 1e-9);
+}
+
+// The penalty is zero, with no Jacobian, while the constraint holds.
+TEST(InequalityConstraint, PenaltyFactor) {
+  using namespace constrained_example;
+  DoubleExpressionInequality constraint(Double_(1.0) - x1, 0.5);
+  PenaltyFactor factor(constraint, 2.0);
+  EXPECT(factor.isInequality());
+
+  Values values;
+  values.insert(x1_key, 0.0);
+  EXPECT_DOUBLES_EQUAL(0.0, factor.error(values), 1e-9);
+  auto linear = boost::dynamic_pointer_cast<gtsam::JacobianFactor>(
+      factor.linearize(values));
+  EXPECT(linear);
+  EXPECT(assert_equal(gtsam::Matrix::Zero(1, 1),
+                      gtsam::Matrix(linear->getA(linear->begin()))));
+
+  // Violated: 1/2 mu (g / tolerance)^2.
+  values.update(x1_key, 2.0);
+  EXPECT_DOUBLES_EQUAL(0.5 * 2.0 * 4.0, factor.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+namespace example {
+// min (x1 - 2)^2 subject to x1 <= 1.
+NonlinearFactorGraph Cost() {
+  using namespace constrained_example;
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(gtsam::ExpressionFactor<double>(cost_noise, 2.0, x1));
+  return graph;
+}
+
+InequalityConstraints Bound() {
+  using namespace constrained_example;
+  InequalityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionInequality>(Double_(1.0) - x1,
+                                                         1e-3);
+  return constraints;
+}
+
+Values Init() {
+  Values values;
+  values.insert(constrained_example::x1_key, 0.0);
+  return values;
+}
+}  // namespace example
+
+TEST(InequalityConstraint, PenaltyMethod) {
+  PenaltyMethodOptimizer optimizer;
+  const Values result = optimizer.optimize(
+      example::Cost(), EqualityConstraints(), example::Bound(),
+      example::Init());
+  EXPECT_DOUBLES_EQUAL(1.0, result.atDouble(constrained_example::x1_key),
+                       1e-3);
+}
+
+TEST(InequalityConstraint, AugmentedLagrangian) {
+  AugmentedLagrangianOptimizer optimizer;
+  const Values result = optimizer.optimize(
+      example::Cost(), EqualityConstraints(), example::Bound(),
+      example::Init());
+  EXPECT_DOUBLES_EQUAL(1.0, result.atDouble(constrained_example::x1_key),
+                       1e-3);
+}
+
+// Two bounds for each of angle, velocity, acceleration and torque.
+TEST(InequalityConstraint, JointLimits) {
+  auto robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const InequalityConstraints constraints =
+      graph_builder.jointLimitConstraints(robot, 3);
+  EXPECT_LONGS_EQUAL(8 * robot.numJoints(), constraints.size());
+  Values values = ZeroValues(robot, 3);
+  EXPECT_DOUBLES_EQUAL(0.0, constraints.evaluate(values), 1e-9);
+
+  // An angle past the upper limit violates exactly one constraint.
+  const int j = robot.joints()[0]->id();
+  values.update(internal::JointAngleKey(j, 3), 2.0);
+  std::vector<gtsam::Vector> g;
+  EXPECT(constraints.evaluate(values, &g) > 0.0);
+  size_t num_violated = 0;
+  for (auto &&g_k : g) num_violated += g_k(0) < 0;
+  EXPECT_LONGS_EQUAL(1, num_violated);
+}
+
+// A vertical contact force is inside the cone, a horizontal one outside.
+TEST(InequalityConstraint, FrictionCone) {
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const InequalityConstraints constraints =
+      graph_builder.frictionConeConstraints(robot, 0, contact_points, 0.5);
+  EXPECT_LONGS_EQUAL(1, constraints.size());
+
+  Values values;
+  const int i = robot.link("link_0")->id();
+  InsertPose(&values, i, 0, gtsam::Pose3());
+  values.insert(ContactWrenchKey(i, 0, 0),
+                (gtsam::Vector6() << 0, 0, 0, 0, 0, 10).finished());
+  EXPECT(constraints.front()->feasible(values));
+  values.update(ContactWrenchKey(i, 0, 0),
+                (gtsam::Vector6() << 0, 0, 0, 10, 0, 1).finished());
+  EXPECT(!constraints.front()->feasible(values));
+  EXPECT_DOUBLES_EQUAL(0.25 - 100.0, (*constraints.front())(values)(0), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,110 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testInertialRegressor.cpp
+ * @brief Test the inertial regressor against recursive Newton-Euler.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/InertialRegressor.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+}  // namespace example
+
+// Y(q, v, a) pi is the inverse dynamics with the parameters of the robot.
+TEST(InertialRegressor, inverseDynamics) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const InertialRegressor regressor(robot, example::gravity);
+  RecursiveDynamics dynamics(robot, example::gravity);
+  RecursiveDynamicsResult id;
+  dynamics.allocate(&id);
+  EXPECT_LONGS_EQUAL(10 * robot.numLinks(), regressor.numParameters());
+
+  const Vector pi = regressor.parameters();
+  const size_t n = regressor.numJointSlots();
+  for (int s = 0; s < 5; ++s) {
+    const Vector q = Vector::Random(n), v = Vector::Random(n),
+                 a = Vector::Random(n);
+    dynamics.inverseDynamics(q, v, a, &id);
+    EXPECT(assert_equal(id.torques, regressor.regressor(q, v, a) * pi, 1e-9));
+  }
+
+  // Moving the center of mass of the last link changes the torques linearly.
+  const Vector q = Vector::Random(n), v = Vector::Random(n),
+               a = Vector::Random(n);
+  const Matrix Y = regressor.regressor(q, v, a);
+  Vector shifted = pi;
+  shifted.segment<3>(10 * 2 + 1) += gtsam::Vector3(0.01, 0, 0);
+  EXPECT(assert_equal(Vector(Y * pi + Y.col(21) * 0.01), Y * shifted, 1e-12));
+
+  CHECK_EXCEPTION(InertialRegressor(simple_urdf_eq_mass::getRobot()),
+                  std::invalid_argument);
+}
+
+// Parameters identified from exact torques reproduce those torques.
+TEST(InertialIdentification, streaming) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  RecursiveDynamics dynamics(robot, example::gravity);
+  const size_t n = dynamics.compiledRobot().numJointSlots();
+  const size_t T = 1000;
+  const Matrix Q = Matrix::Random(T, n), V = Matrix::Random(T, n),
+               A = Matrix::Random(T, n);
+  const Matrix Tau = dynamics.inverseDynamicsTrajectory(Q, V, A);
+
+  InertialIdentification parallel(robot, example::gravity, 4);
+  parallel.addTrajectory(Q, V, A, Tau);
+  EXPECT_LONGS_EQUAL(T, parallel.numSamples());
+
+  // Sample by sample, on one thread, gives the same normal equations.
+  InertialIdentification serial(robot, example::gravity, 1);
+  for (size_t k = 0; k < T; ++k)
+    serial.add(Q.row(k).transpose(), V.row(k).transpose(),
+               A.row(k).transpose(), Tau.row(k).transpose());
+  EXPECT(assert_equal(serial.normalMatrix(), parallel.normalMatrix(), 1e-6));
+  EXPECT(assert_equal(serial.normalVector(), parallel.normalVector(), 1e-6));
+
+  // From a wrong prior, the identified parameters explain the torques.
+  const Vector nominal =
+      InertialRegressor(robot, example::gravity).parameters();
+  const Vector prior = 1.5 * nominal;
+  EXPECT(parallel.rmsResidual(prior) > 1e-2);
+  EXPECT_DOUBLES_EQUAL(0, parallel.rmsResidual(nominal), 1e-6);
+  const Vector identified = parallel.solve(1e-8, prior);
+  EXPECT_DOUBLES_EQUAL(0, parallel.rmsResidual(identified), 1e-4);
+
+  // Merging two halves gives the whole.
+  InertialIdentification first(robot, example::gravity, 2),
+      second(robot, example::gravity, 2);
+  first.addTrajectory(Q.topRows(T / 2), V.topRows(T / 2), A.topRows(T / 2),
+                      Tau.topRows(T / 2));
+  second.addTrajectory(Q.bottomRows(T / 2), V.bottomRows(T / 2),
+                       A.bottomRows(T / 2), Tau.bottomRows(T / 2));
+  first.merge(second);
+  EXPECT_LONGS_EQUAL(T, first.numSamples());
+  EXPECT(assert_equal(parallel.normalVector(), first.normalVector(), 1e-6));
+
+  CHECK_EXCEPTION(parallel.addTrajectory(Q, V, A, Tau.leftCols(1)),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -23,7 +23,9 @@
 #include "gtdynamics/dynamics/DynamicsGraph.h"
 #include "gtdynamics/universal_robot/RobotModels.h"
 #include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/ThreadPool.h"
 #include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
 
 using namespace gtdynamics;
 using gtsam::assert_equal;
@@ -319,6 +321,65 @@ TEST(InitializeSolutionUtils, MultiPhaseInverseKinematicsTrajectory) {
   }
 }
 
+// Zero values built on a thread pool equal the serial ones.
+TEST(InitializeSolutionUtils, ZeroValuesTrajectoryPool) {
+  const Robot robot = simple_rr::getRobot();
+  const int num_steps = 25;
+  const gtsam::Values expected =
+      ZeroValuesTrajectory(robot, num_steps, 2, 0.1);
+  ThreadPool pool(4);
+  const gtsam::Values actual =
+      ZeroValuesTrajectory(robot, num_steps, 2, 0.1, boost::none, &pool);
+  EXPECT(assert_equal(expected, actual));
+}
+
+// Forward simulation satisfies the dynamics and Euler collocation factors.
+TEST(InitializeSolutionUtils, ForwardSimulation) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const int num_steps = 10;
+  const double dt = 0.01;
+
+  gtsam::Values initial_values, torques;
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&initial_values, joint->id(), 0, 0.2);
+    InsertJointVel(&initial_values, joint->id(), 0, -0.1);
+    for (int k = 0; k <= num_steps; k++)
+      InsertTorque(&torques, joint->id(), k, std::sin(0.1 * k));
+  }
+  const gtsam::Values values = InitializeSolutionForwardSimulation(
+      robot, initial_values, torques, num_steps, dt, gravity);
+
+  const DynamicsGraph graph_builder(gravity);
+  const auto graph = graph_builder.trajectoryFG(robot, num_steps, dt,
+                                                CollocationScheme::Euler);
+  EXPECT_DOUBLES_EQUAL(0, graph.error(values), 1e-6);
+  for (auto &&joint : robot.joints())
+    EXPECT_DOUBLES_EQUAL(std::sin(0.5), Torque(values, joint->id(), 5),
+                         1e-9);
+}
+
+// Inverse dynamics along a profile satisfies the same factors.
+TEST(InitializeSolutionUtils, InverseDynamics) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const int num_steps = 10;
+  const double dt = 0.01;
+
+  gtsam::Values joint_angles;
+  for (auto &&joint : robot.joints())
+    for (int k = 0; k <= num_steps; k++)
+      InsertJointAngle(&joint_angles, joint->id(), k,
+                       std::cos(joint->id() + 0.3 * k));
+  const gtsam::Values values = InitializeSolutionInverseDynamics(
+      robot, joint_angles, num_steps, dt, gravity);
+
+  const DynamicsGraph graph_builder(gravity);
+  const auto graph = graph_builder.trajectoryFG(robot, num_steps, dt,
+                                                CollocationScheme::Euler);
+  EXPECT_DOUBLES_EQUAL(0, graph.error(values), 1e-6);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,141 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointConstraintFactors.cpp
+ * @brief Test joint factors with hand-written Jacobians against the joint
+ * constraint expressions.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/nonlinear/ExpressionFactor.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "gtdynamics/factors/JointConstraintFactors.h"
+#include "gtdynamics/utils/values.h"
+#include "make_joint.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+namespace example {
+const size_t t = 3;
+const auto cost_model6 = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+const auto cost_model1 = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+
+// Screw axes in the child frame: revolute, prismatic and helical.
+std::vector<Vector6> ScrewAxes() {
+  Vector6 revolute, prismatic, helical;
+  revolute << 0, 0, 1, 0, 1, 0;
+  prismatic << 0, 0, 0, 0, 0, 1;
+  helical << 0, 0, 1, 0, 0.5, 0.2;
+  return {revolute, prismatic, helical};
+}
+
+// Values away from the rest configuration for all variables of the joint.
+gtsam::Values AwayFromRest(const JointConstSharedPtr &joint) {
+  const int i1 = joint->parent()->id(), i2 = joint->child()->id();
+  const int j = joint->id();
+  Vector6 v1, v2, a1, a2, f1, f2;
+  v1 << 0.1, -0.2, 0.3, 1, 2, 3;
+  v2 << -0.3, 0.1, 0.2, 3, 1, -2;
+  a1 << 0.4, 0.1, -0.1, 2, -1, 0.5;
+  a2 << 0.2, -0.3, 0.1, -1, 2, 1;
+  f1 << 1, 2, 3, 4, 5, 6;
+  f2 << -2, 1, 0.5, 3, -4, 2;
+  gtsam::Values values;
+  InsertPose(&values, i1, t, Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3),
+                                   Point3(1, 2, 3)));
+  InsertPose(&values, i2, t, Pose3(Rot3::RzRyRx(-0.2, 0.4, 0.1),
+                                   Point3(1.5, 2, 1)));
+  InsertTwist(&values, i1, t, v1);
+  InsertTwist(&values, i2, t, v2);
+  InsertTwistAccel(&values, i1, t, a1);
+  InsertTwistAccel(&values, i2, t, a2);
+  InsertWrench(&values, i1, j, t, f1);
+  InsertWrench(&values, i2, j, t, f2);
+  InsertJointAngle(&values, j, t, 0.7);
+  InsertJointVel(&values, j, t, -1.3);
+  InsertJointAccel(&values, j, t, 0.4);
+  InsertTorque(&values, j, t, 2.0);
+  return values;
+}
+
+// Return true if `factor` has the same error and Jacobians as `expected`,
+// and its Jacobians match numerical derivatives.
+bool Same(const gtsam::NoiseModelFactor &expected,
+          const gtsam::NoiseModelFactor &factor, const gtsam::Values &values) {
+  if (!assert_equal(expected.unwhitenedError(values),
+                    factor.unwhitenedError(values), 1e-9))
+    return false;
+  const auto expected_linear = boost::dynamic_pointer_cast<
+      gtsam::JacobianFactor>(expected.linearize(values));
+  const auto actual_linear = boost::dynamic_pointer_cast<
+      gtsam::JacobianFactor>(factor.linearize(values));
+  if (expected_linear->size() != actual_linear->size()) return false;
+  for (const gtsam::Key key : expected_linear->keys()) {
+    const auto it = actual_linear->find(key);
+    if (it == actual_linear->end()) return false;
+    if (!assert_equal(gtsam::Matrix(expected_linear->getA(
+                          expected_linear->find(key))),
+                      gtsam::Matrix(actual_linear->getA(it)), 1e-9))
+      return false;
+  }
+  return gtsam::internal::testFactorJacobians("JointConstraintFactors",
+                                              factor, values, 1e-7, 1e-5);
+}
+}  // namespace example
+
+TEST(JointConstraintFactors, MatchExpressions) {
+  using namespace example;
+  const Pose3 cMp(Rot3::RzRyRx(0.3, -0.1, 0.2), Point3(0, 0.5, -2));
+  for (const Vector6 &screw_axis : ScrewAxes()) {
+    const auto joint = make_joint(cMp, screw_axis);
+    const gtsam::Values values = AwayFromRest(joint);
+
+    using Factor6 = gtsam::ExpressionFactor<Vector6>;
+    const Vector6 zero = Vector6::Zero();
+    EXPECT(Same(Factor6(cost_model6, zero, joint->poseConstraint(t)),
+                JointPoseFactor(cost_model6, joint, t), values));
+    EXPECT(Same(Factor6(cost_model6, zero, joint->twistConstraint(t)),
+                JointTwistFactor(cost_model6, joint, t), values));
+    EXPECT(Same(Factor6(cost_model6, zero, joint->twistAccelConstraint(t)),
+                JointTwistAccelFactor(cost_model6, joint, t), values));
+    EXPECT(Same(
+        Factor6(cost_model6, zero, joint->wrenchEquivalenceConstraint(t)),
+        JointWrenchEquivalenceFactor(cost_model6, joint, t), values));
+    EXPECT(Same(gtsam::ExpressionFactor<double>(cost_model1, 0.0,
+                                                joint->torqueConstraint(t)),
+                JointWrenchTorqueFactor(cost_model1, joint, t), values));
+  }
+}
+
+TEST(JointConstraintFactors, Rekey) {
+  using namespace example;
+  const auto joint = make_joint(Pose3(), ScrewAxes()[0]);
+  const JointTwistFactor at_0(cost_model6, joint, 0);
+  const JointTwistFactor at_t(cost_model6, joint, t);
+  gtsam::KeyVector keys;
+  for (const gtsam::Key key : at_0.keys()) keys.push_back(key + t);
+  const auto shifted = at_0.rekey(keys);
+  const gtsam::Values values = AwayFromRest(joint);
+  EXPECT(assert_equal(at_t.keys(), shifted->keys()));
+  EXPECT_DOUBLES_EQUAL(at_t.error(values), shifted->error(values), 1e-12);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
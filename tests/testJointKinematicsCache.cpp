@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointKinematicsCache.cpp
+ * @brief Test sharing joint transforms between the factors of a joint.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+
+#include <thread>
+
+#include "gtdynamics/factors/JointConstraintFactors.h"
+#include "gtdynamics/universal_robot/JointKinematicsCache.h"
+#include "gtdynamics/utils/values.h"
+#include "make_joint.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Vector6;
+
+namespace example {
+const size_t t = 2;
+const auto cost_model = gtsam::noiseModel::Isotropic::Sigma(6, 0.1);
+Vector6 ScrewAxis() {
+  Vector6 S;
+  S << 0, 0, 1, 0, 0.5, 0.2;
+  return S;
+}
+const auto joint =
+    make_joint(Pose3(Rot3::RzRyRx(0.3, -0.1, 0.2), Point3(0, 0.5, -2)),
+               ScrewAxis());
+
+// The factors of the joint at step t that share its transforms.
+gtsam::NonlinearFactorGraph Factors() {
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<JointPoseFactor>(cost_model, joint, t);
+  graph.emplace_shared<JointTwistFactor>(cost_model, joint, t);
+  graph.emplace_shared<JointTwistAccelFactor>(cost_model, joint, t);
+  graph.emplace_shared<JointWrenchEquivalenceFactor>(cost_model, joint, t);
+  return graph;
+}
+
+gtsam::Values Values(double q) {
+  const int i1 = joint->parent()->id(), i2 = joint->child()->id();
+  const int j = joint->id();
+  Vector6 v;
+  v << 0.1, -0.2, 0.3, 1, 2, 3;
+  gtsam::Values values;
+  InsertPose(&values, i1, t,
+             Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 2, 3)));
+  InsertPose(&values, i2, t, Pose3());
+  InsertTwist(&values, i1, t, v);
+  InsertTwist(&values, i2, t, -v);
+  InsertTwistAccel(&values, i1, t, 2 * v);
+  InsertTwistAccel(&values, i2, t, v);
+  InsertWrench(&values, i1, j, t, 3 * v);
+  InsertWrench(&values, i2, j, t, -v);
+  InsertJointAngle(&values, j, t, q);
+  InsertJointVel(&values, j, t, -1.3);
+  InsertJointAccel(&values, j, t, 0.4);
+  return values;
+}
+
+// Linearize on the calling thread, factor by factor.
+gtsam::GaussianFactorGraph Linearize(const gtsam::NonlinearFactorGraph &graph,
+                                     const gtsam::Values &values) {
+  gtsam::GaussianFactorGraph linear;
+  for (auto &&factor : graph) linear.push_back(factor->linearize(values));
+  return linear;
+}
+}  // namespace example
+
+// One linearization computes the transforms of a joint and step once.
+TEST(JointKinematicsCache, SharedAcrossFactors) {
+  using namespace example;
+  const auto graph = Factors();
+  JointKinematicsCache::Clear();
+  const auto linear = Linearize(graph, Values(0.7));
+  JointKinematicsCacheStats stats = JointKinematicsCache::Stats();
+  EXPECT_LONGS_EQUAL(1, stats.misses);
+  EXPECT_LONGS_EQUAL(3, stats.hits);
+
+  // Hits again at the same angle, and a copy of the joint shares them.
+  Linearize(graph, Values(0.7));
+  joint->clone()->childKinematics(0.7, true);
+  stats = JointKinematicsCache::Stats();
+  EXPECT_LONGS_EQUAL(1, stats.misses);
+  EXPECT_LONGS_EQUAL(8, stats.hits);
+
+  // A new angle is a miss.
+  Linearize(graph, Values(0.8));
+  EXPECT_LONGS_EQUAL(2, JointKinematicsCache::Stats().misses);
+
+  // Same linearization without the cache.
+  JointKinematicsCache::SetEnabled(false);
+  const auto uncached = Linearize(graph, Values(0.7));
+  JointKinematicsCache::SetEnabled(true);
+  EXPECT(assert_equal(uncached, linear, 1e-12));
+}
+
+// Entries are per thread.
+TEST(JointKinematicsCache, Threads) {
+  using namespace example;
+  JointKinematicsCache::Clear();
+  example::joint->childKinematics(0.7, true);
+  JointKinematicsCacheStats other;
+  std::thread thread([&] {
+    example::joint->childKinematics(0.7, true);
+    other = JointKinematicsCache::Stats();
+  });
+  thread.join();
+  EXPECT_LONGS_EQUAL(1, other.misses);
+  EXPECT_LONGS_EQUAL(0, other.hits);
+  EXPECT_LONGS_EQUAL(1, JointKinematicsCache::Stats().misses);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
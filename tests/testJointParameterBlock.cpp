@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testJointParameterBlock.cpp
+ * @brief Test joint limit factors on shared parameter blocks.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/factors/JointLimitFactor.h"
+#include "gtdynamics/universal_robot/JointParameterBlock.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+TEST(JointParameterBlock, factor) {
+  JointParams parameters;
+  parameters.velocity_limit = 2;
+  parameters.velocity_limit_threshold = 0.5;
+  auto block = boost::make_shared<JointParameterBlock>(parameters);
+  EXPECT_LONGS_EQUAL(0, block->version());
+
+  const auto model = gtsam::noiseModel::Unit::Create(1);
+  const gtsam::Key key = internal::JointVelKey(0, 0);
+  const JointLimitFactor factor(key, model, block,
+                                JointLimitFactor::Quantity::Velocity);
+  Values values;
+  values.insert(key, 2.0);
+  EXPECT(assert_equal(gtsam::Vector1(0.5), factor.unwhitenedError(values)));
+
+  // The factor follows the block, like a factor built with the new limits.
+  parameters.velocity_limit = 3;
+  block->set(parameters);
+  EXPECT_LONGS_EQUAL(1, block->version());
+  const JointLimitFactor fixed(key, model, -3, 3, 0.5);
+  EXPECT(assert_equal(fixed.unwhitenedError(values),
+                      factor.unwhitenedError(values)));
+  values.update(key, 4.0);
+  EXPECT(assert_equal(gtsam::Vector1(1.5), factor.unwhitenedError(values)));
+  EXPECT(assert_equal(fixed.unwhitenedError(values),
+                      factor.unwhitenedError(values)));
+}
+
+TEST(JointParameterBlock, graph) {
+  const Robot robot = simple_rr::getRobot();
+  JointParameterBlocks blocks(robot);
+  const DynamicsGraph builder(gtsam::Vector3(0, 0, -9.8));
+  const auto graph = builder.jointLimitFactors(robot, 0, blocks);
+  EXPECT_LONGS_EQUAL(4 * robot.numJoints(), graph.size());
+
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, 0, 1.0);
+    InsertJointVel(&values, j, 0, 0.0);
+    InsertJointAccel(&values, j, 0, 0.0);
+    InsertTorque(&values, j, 0, 0.0);
+  }
+
+  // Tighten the angle limits of one joint, without rebuilding the graph.
+  const auto joint = robot.joint("joint_1");
+  JointParams parameters = joint->parameters();
+  parameters.scalar_limits.value_lower_limit = -2;
+  parameters.scalar_limits.value_upper_limit = 2;
+  parameters.scalar_limits.value_limit_threshold = 0;
+  blocks.set(joint->id(), parameters);
+  const double before = graph.error(values);
+  parameters.scalar_limits.value_upper_limit = 0.5;
+  blocks.set(joint->id(), parameters);
+  EXPECT_LONGS_EQUAL(2, blocks.version());
+
+  const JointLimitFactor angle(internal::JointAngleKey(joint->id(), 0),
+                               builder.opt().jl_cost_model, -2, 0.5, 0);
+  EXPECT_DOUBLES_EQUAL(before + angle.error(values), graph.error(values),
+                       1e-9);
+  CHECK_EXCEPTION(blocks.block(1000), std::out_of_range);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testKinematicCalibration.cpp
+ * @brief Test streaming calibration of joint offsets.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/kinematics/KinematicCalibration.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace example {
+// Samples of simple_rr with end-effector poses measured by a tracker, with
+// encoders reading the joint angles minus `offsets`.
+std::vector<CalibrationSample> Samples(const Robot &robot,
+                                       const Vector &offsets, size_t n) {
+  KinematicCalibrationParameters parameters;
+  parameters.calibrate_link_transforms = false;
+  KinematicCalibration truth(robot, parameters);
+  truth.setParameters(offsets);
+  const int base = robot.link("link_0")->id();
+  const int end = robot.link("link_2")->id();
+  std::vector<CalibrationSample> samples(n);
+  for (auto &&sample : samples) {
+    sample.joint_angles = Vector::Random(robot.numJoints());
+    const std::vector<Pose3> poses = truth.linkPoses(sample.joint_angles);
+    sample.poses.push_back(
+        {"link_0", "link_2", poses[base].between(poses[end])});
+  }
+  return samples;
+}
+}  // namespace example
+
+// Offsets are recovered from passes over the log, in chunks.
+TEST(KinematicCalibration, offsets) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  KinematicCalibrationParameters parameters;
+  parameters.calibrate_link_transforms = false;
+  parameters.num_threads = 2;
+  KinematicCalibration calibration(robot, parameters);
+  EXPECT_LONGS_EQUAL(robot.numJoints(), calibration.numParameters());
+
+  Vector offsets(2);
+  offsets << 0.02, -0.03;
+  const auto samples = example::Samples(robot, offsets, 100);
+  const size_t passes = calibration.calibrate(
+      [&](KinematicCalibration &c) {
+        for (size_t k = 0; k < samples.size(); k += 30) {
+          const size_t end = std::min(samples.size(), k + 30);
+          c.addSamples(std::vector<CalibrationSample>(samples.begin() + k,
+                                                      samples.begin() + end));
+        }
+      },
+      20, 1e-10);
+  EXPECT(passes < 20);
+  EXPECT(assert_equal(offsets, calibration.offsets(), 1e-7));
+
+  // At the solution the samples fit exactly.
+  calibration.addSamples(samples);
+  EXPECT_LONGS_EQUAL(100, calibration.numSamples());
+  EXPECT(calibration.error() < 1e-8);
+}
+
+// One sample at a time on the calling thread, or in a chunk over threads,
+// accumulates the same information.
+TEST(KinematicCalibration, streaming) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  KinematicCalibrationParameters parameters;
+  parameters.num_threads = 3;
+  KinematicCalibration serial(robot, parameters), chunked(robot, parameters);
+  EXPECT_LONGS_EQUAL(7 * robot.numJoints(), serial.numParameters());
+
+  Vector offsets(2);
+  offsets << 0.01, 0.01;
+  const auto samples = example::Samples(robot, offsets, 40);
+  for (auto &&sample : samples) serial.add(sample);
+  chunked.addSamples(samples);
+  const double scale = serial.information().norm();
+  EXPECT(assert_equal(serial.information(), chunked.information(),
+                      1e-9 * scale));
+  EXPECT(assert_equal(serial.gradient(), chunked.gradient(), 1e-9 * scale));
+  EXPECT_DOUBLES_EQUAL(serial.error(), chunked.error(), 1e-9);
+
+  chunked.clear();
+  EXPECT_LONGS_EQUAL(0, chunked.numSamples());
+  EXPECT_DOUBLES_EQUAL(0, chunked.information().norm(), 0);
+}
+
+TEST(KinematicCalibration, exceptions) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  KinematicCalibration calibration(robot);
+  CalibrationSample sample;
+  sample.joint_angles = Vector::Zero(1);
+  CHECK_EXCEPTION(calibration.add(sample), std::invalid_argument);
+  sample.joint_angles = Vector::Zero(2);
+  sample.poses.push_back({"link_0", "no_link", Pose3()});
+  CHECK_EXCEPTION(calibration.add(sample), std::invalid_argument);
+  CHECK_EXCEPTION(calibration.update(0), std::invalid_argument);
+  CHECK_EXCEPTION(KinematicCalibration(simple_rr::getRobot()),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
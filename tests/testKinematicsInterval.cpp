@@ -60,6 +60,25 @@ TEST(Interval, InverseKinematics) {
   }
 }
 
+// Slices solved on two threads, each warm-started from the previous one.
+TEST(Interval, ParallelInverseKinematics) {
+  using namespace contact_goals_example;
+  const Interval interval(0, 5);
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  parameters.num_slice_threads = 2;
+  parameters.warm_start_slices = true;
+  Kinematics kinematics(parameters);
+
+  auto result = kinematics.inverse(interval, robot, contact_goals);
+  constexpr double tol = 1e-5;
+  for (const ContactGoal& goal : contact_goals) {
+    for (size_t k = interval.k_start; k <= interval.k_end; k++) {
+      EXPECT(goal.satisfied(result, k, tol));
+    }
+  }
+}
+
 TEST(Interval, Interpolate) {
   // Load robot and establish contact/goal pairs
   using namespace contact_goals_example;
@@ -85,6 +104,38 @@ TEST(Interval, Interpolate) {
   EXPECT(assert_equal(Pose(result2, 0, 9), Pose(result, 0, 9)));
 }
 
+// Only the end slices, and the inner slices interpolation misses, are solved.
+TEST(Interval, InterpolateJointSpace) {
+  using namespace contact_goals_example;
+  auto contact_goals2 = contact_goals;
+  contact_goals2[2] = {{RF, contact_in_com}, {0.4, -0.16, -0.2}};
+
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::SOFT_CONSTRAINTS;
+  parameters.interpolate_joint_space = true;
+  parameters.interpolation_tolerance = 1e-2;
+  Kinematics kinematics(parameters);
+  const Interval interval(5, 9);
+  auto result =
+      kinematics.interpolate(interval, robot, contact_goals, contact_goals2);
+
+  auto result1 = kinematics.inverse(Slice(5), robot, contact_goals);
+  auto result2 = kinematics.inverse(Slice(9), robot, contact_goals2);
+  EXPECT(assert_equal(Pose(result1, 0, 5), Pose(result, 0, 5)));
+  EXPECT(assert_equal(Pose(result2, 0, 9), Pose(result, 0, 9)));
+
+  // Every slice is within tolerance of its interpolated goals.
+  for (size_t k = interval.k_start; k <= interval.k_end; k++) {
+    const double t = double(k - interval.k_start) / 4;
+    for (size_t c = 0; c < contact_goals.size(); c++) {
+      const ContactGoal goal{contact_goals[c].point_on_link,
+                             (1 - t) * contact_goals[c].goal_point +
+                                 t * contact_goals2[c].goal_point};
+      EXPECT(goal.satisfied(result, k, 1e-2));
+    }
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
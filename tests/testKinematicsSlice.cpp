@@ -81,6 +81,33 @@ TEST(Slice, InverseKinematics) {
   }
 }
 
+TEST(Slice, BatchInverseKinematics) {
+  using namespace contact_goals_example;
+  const Slice slice(5);
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  Kinematics kinematics(parameters);
+
+  // The contact goals, shifted up and down.
+  std::vector<ContactGoals> queries;
+  for (double dz : {-0.02, 0.0, 0.02}) {
+    ContactGoals goals;
+    for (const ContactGoal& goal : contact_goals)
+      goals.emplace_back(goal.point_on_link,
+                         goal.goal_point + Point3(0, 0, dz));
+    queries.push_back(goals);
+  }
+
+  const auto results = kinematics.inverseBatch(slice, robot, queries, 2);
+  EXPECT_LONGS_EQUAL(queries.size(), results.size());
+  constexpr double tol = 1e-5;
+  for (size_t q = 0; q < queries.size(); q++) {
+    EXPECT(results[q].converged);
+    for (const ContactGoal& goal : queries[q])
+      EXPECT(goal.satisfied(results[q].values, slice.k, tol));
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLatencyHistogram.cpp
+ * @brief Test the log-linear duration histogram.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/LatencyHistogram.h"
+
+using namespace gtdynamics;
+
+TEST(LatencyHistogram, percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_LONGS_EQUAL(0, histogram.count());
+  EXPECT_DOUBLES_EQUAL(0, histogram.percentile(50), 0);
+
+  // 1..1000 microseconds.
+  for (int i = 1; i <= 1000; ++i) histogram.record(1e-6 * i);
+  EXPECT_LONGS_EQUAL(1000, histogram.count());
+  EXPECT_DOUBLES_EQUAL(500.5e-6, histogram.mean(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1e-6, histogram.min(), 1e-12);
+  EXPECT_DOUBLES_EQUAL(1e-3, histogram.max(), 1e-12);
+
+  // Within the relative precision of the buckets.
+  const double tolerance = 1.0 / LatencyHistogram::kSubBuckets;
+  EXPECT_DOUBLES_EQUAL(500e-6, histogram.percentile(50), 500e-6 * tolerance);
+  EXPECT_DOUBLES_EQUAL(990e-6, histogram.percentile(99), 990e-6 * tolerance);
+  EXPECT_DOUBLES_EQUAL(1e-3, histogram.percentile(100), 1e-12);
+  EXPECT_DOUBLES_EQUAL(1e-6, histogram.percentile(0), 1e-12);
+  CHECK_EXCEPTION(histogram.percentile(101), std::invalid_argument);
+
+  // Small durations are exact.
+  LatencyHistogram small;
+  for (uint64_t ns : {3, 5, 7}) small.recordNanoseconds(ns);
+  EXPECT_DOUBLES_EQUAL(5e-9, small.percentile(50), 1e-15);
+}
+
+TEST(LatencyHistogram, merge) {
+  LatencyHistogram a, b;
+  for (int i = 0; i < 99; ++i) a.record(1e-6);
+  b.record(1.0);
+  a.merge(b);
+  EXPECT_LONGS_EQUAL(100, a.count());
+  EXPECT_DOUBLES_EQUAL(1.0, a.max(), 1e-9);
+  EXPECT_DOUBLES_EQUAL(1e-6, a.percentile(99), 1e-6 / 16);
+  EXPECT_DOUBLES_EQUAL(1.0, a.percentile(99.5), 1.0 / 16);
+
+  const std::string json = a.toJson();
+  EXPECT(json.find("\"count\": 100") != std::string::npos);
+  EXPECT(json.find("\"p99\"") != std::string::npos);
+
+  a.reset();
+  EXPECT_LONGS_EQUAL(0, a.count());
+  EXPECT_DOUBLES_EQUAL(0, a.max(), 0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,98 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLeggedStateEstimator.cpp
+ * @brief Test fixed-lag legged state estimation.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/dynamics/LeggedStateEstimator.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+using gtsam::Vector3;
+
+static const std::set<std::string> kFeet = {"FR_lower", "FL_lower",
+                                            "RR_lower", "RL_lower"};
+
+// Readings of an a1 standing still with all joints at zero.
+static LeggedMeasurement Standing(const Robot &robot, double dt) {
+  LeggedMeasurement measurement;
+  measurement.dt = dt;
+  measurement.acceleration = Vector3(0, 0, 9.81);
+  for (auto &&joint : robot.joints())
+    InsertJointAngle(&measurement.joint_angles, joint->id(), 0.0);
+  measurement.contacts = kFeet;
+  return measurement;
+}
+
+// Standing still, the estimate stays at the prior and the window is bounded.
+TEST(LeggedStateEstimator, Standing) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  LeggedEstimatorParameters parameters;
+  parameters.lag = 0.3;
+  parameters.max_keyframe_interval = 0.05;
+  LeggedStateEstimator estimator(robot, "trunk", parameters);
+
+  const double dt = 0.005;
+  const LeggedMeasurement measurement = Standing(robot, dt);
+  THROWS_EXCEPTION(estimator.update(measurement));
+
+  const Pose3 wTb(gtsam::Rot3(), gtsam::Point3(0, 0, 0.3));
+  estimator.initialize(gtsam::NavState(wTb, Vector3::Zero()),
+                       gtsam::imuBias::ConstantBias(),
+                       measurement.joint_angles, kFeet);
+  int keyframes = 0;
+  for (int i = 0; i < 200; i++) keyframes += estimator.update(measurement);
+
+  EXPECT_LONGS_EQUAL(20, keyframes);
+  EXPECT_LONGS_EQUAL(20, estimator.lastKeyframe());
+  EXPECT(estimator.numKeyframes() <= 8);
+  EXPECT(assert_equal(wTb, estimator.state().pose(), 1e-3));
+  EXPECT(assert_equal(Vector3::Zero(), estimator.state().velocity(), 1e-3));
+}
+
+// Contact events add keyframes, and only feet in contact are estimated.
+TEST(LeggedStateEstimator, ContactEvents) {
+  const Robot robot =
+      CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"));
+  LeggedStateEstimator estimator(robot, "trunk");
+  LeggedMeasurement measurement = Standing(robot, 0.005);
+  estimator.initialize(gtsam::NavState(), gtsam::imuBias::ConstantBias(),
+                       measurement.joint_angles, kFeet);
+
+  EXPECT(!estimator.update(measurement));
+  measurement.contacts = {"FR_lower", "RL_lower"};
+  EXPECT(estimator.update(measurement));
+  EXPECT(!estimator.update(measurement));
+  measurement.contacts = kFeet;
+  EXPECT(estimator.update(measurement));
+
+  const gtsam::Values estimate = estimator.estimate();
+  const int fl = robot.link("FL_lower")->id();
+  EXPECT(estimate.exists(internal::PoseKey(fl, 0)));
+  EXPECT(!estimate.exists(internal::PoseKey(fl, 1)));
+  EXPECT(estimate.exists(internal::PoseKey(fl, 2)));
+  EXPECT(estimate.exists(LeggedStateEstimator::BiasKey(2)));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
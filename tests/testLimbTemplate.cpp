@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLimbTemplate.cpp
+ * @brief Test finding identical limbs and evaluating them together.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/universal_robot/LimbTemplate.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/universal_robot/sdf.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose3;
+
+// The eight legs of the spider are the limbs, and are found as copies.
+TEST(LimbTemplate, spider) {
+  const Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  const auto templates = FindLimbTemplates(robot, "body");
+  const int body = robot.link("body")->id();
+
+  size_t num_limbs = 0;
+  for (auto &&t : templates) {
+    EXPECT_LONGS_EQUAL(body, t.baseLinkId());
+    EXPECT_LONGS_EQUAL(4, t.depth());
+    num_limbs += t.numLimbs();
+  }
+  EXPECT_LONGS_EQUAL(8, num_limbs);
+  EXPECT(templates.size() < num_limbs);
+
+  // Batched forward kinematics agrees with that of the whole tree.
+  const CompiledRobot compiled(robot);
+  gtsam::Vector q(compiled.numJointSlots());
+  for (int j = 0; j < q.size(); ++j) q(j) = 0.3 - 0.07 * j;
+  const Pose3 wTb(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3), gtsam::Point3(1, 2, 3));
+  std::vector<Pose3> expected(compiled.numLinkSlots()),
+      actual(compiled.numLinkSlots());
+  expected[body] = wTb;
+  actual[body] = wTb;
+  compiled.forwardKinematics(q, &expected);
+  for (auto &&t : templates) t.forwardKinematics(q, &actual);
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(expected[i], actual[i], 1e-9));
+  }
+}
+
+// A single arm is a template by itself.
+TEST(LimbTemplate, simple_rr) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const auto templates = FindLimbTemplates(robot);
+  EXPECT_LONGS_EQUAL(1, templates.size());
+  EXPECT_LONGS_EQUAL(1, templates[0].numLimbs());
+  EXPECT_LONGS_EQUAL(2, templates[0].depth());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,74 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLinearDynamicsSolver.cpp
+ * @brief Test forward dynamics with the pre-compiled linear dynamics graph.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/LinearDynamicsSolver.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Repeated solves with different states should match linearSolveFD, which
+// checks that all state-dependent numbers are refilled.
+TEST(LinearDynamicsSolver, simple_urdf) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const int j = robot.joint("j1")->id();
+  const size_t t = 2;
+
+  DynamicsGraph graph_builder(gravity, simple_urdf::planar_axis);
+  LinearDynamicsSolver solver(robot, gravity, simple_urdf::planar_axis);
+
+  for (double q : {0.0, 0.5, -1.0}) {
+    Values values;
+    InsertJointAngle(&values, j, t, q);
+    InsertJointVel(&values, j, t, 2 * q);
+    Values known_values = robot.forwardKinematics(values, t);
+    InsertTorque(&known_values, j, t, 1.0 - q);
+
+    Values expected = graph_builder.linearSolveFD(robot, t, known_values);
+    Values actual = solver.solveForwardDynamics(known_values, t);
+    EXPECT(assert_equal(expected, actual, 1e-6));
+  }
+}
+
+// Floating base robot.
+TEST(LinearDynamicsSolver, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  auto l1 = robot.link("l1");
+  const int j = robot.joint("j1")->id();
+  const size_t t = 777;
+
+  Values values;
+  InsertPose(&values, l1->id(), t, l1->bMcom());
+  InsertTwist(&values, l1->id(), t, gtsam::Z_6x1);
+  Values known_values = robot.forwardKinematics(values, t, std::string("l1"));
+  InsertTorque(&known_values, j, t, 1.0);
+
+  LinearDynamicsSolver solver(robot, simple_urdf_eq_mass::gravity,
+                              simple_urdf_eq_mass::planar_axis);
+  Values result = solver.solveForwardDynamics(known_values, t);
+  EXPECT(assert_equal(4.0, JointAccel(result, j, t), 1e-3));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
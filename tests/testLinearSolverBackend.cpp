@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLinearSolverBackend.cpp
+ * @brief Test the choice of linear solvers of the optimizers.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+
+#include "constrainedExample.h"
+#include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/optimizer/LinearSolverBackend.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/statics/Statics.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace example {
+using namespace constrained_example;
+
+NonlinearFactorGraph Costs() {
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+Values Initial() {
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, -0.2);
+  return values;
+}
+}  // namespace example
+
+TEST(LinearSolverBackend, Resolve) {
+  OptimizationParameters parameters;
+  parameters.block_tridiagonal = true;
+  EXPECT(ResolveLinearSolver(parameters).block_tridiagonal);
+
+  parameters.linear_solver = LinearSolverBackend::MULTIFRONTAL_QR;
+  OptimizationParameters resolved = ResolveLinearSolver(parameters);
+  EXPECT(!resolved.block_tridiagonal);
+  EXPECT(!resolved.pcg);
+  EXPECT(resolved.linear_solver == LinearSolverBackend::AUTOMATIC);
+  EXPECT(resolved.lm_parameters.linearSolverType ==
+         NonlinearOptimizerParams::MULTIFRONTAL_QR);
+
+  parameters.linear_solver = LinearSolverBackend::ITERATIVE;
+  resolved = ResolveLinearSolver(parameters);
+  EXPECT(resolved.pcg);
+  EXPECT(ActiveLinearSolver(resolved.lm_parameters, resolved.block_tridiagonal,
+                            resolved.pcg.get_ptr()) ==
+         LinearSolverBackend::ITERATIVE);
+}
+
+TEST(LinearSolverBackend, Recommended) {
+  EXPECT(KinematicsParameters().linear_solver ==
+         RecommendedLinearSolver(ProblemClass::KINEMATICS));
+  EXPECT(StaticsParameters().linear_solver ==
+         RecommendedLinearSolver(ProblemClass::STATICS));
+  EXPECT(RecommendedLinearSolver(ProblemClass::TRAJECTORY) ==
+         LinearSolverBackend::BLOCK_TRIDIAGONAL);
+  EXPECT(RecommendedLinearSolver(ProblemClass::MULTI_PHASE_TRAJECTORY) ==
+         LinearSolverBackend::MULTIFRONTAL_CHOLESKY);
+}
+
+// All backends solve the same problem, and the profile says which one did.
+TEST(LinearSolverBackend, Optimizer) {
+  Values expected;
+  for (LinearSolverBackend backend :
+       {LinearSolverBackend::MULTIFRONTAL_CHOLESKY,
+        LinearSolverBackend::MULTIFRONTAL_QR,
+        LinearSolverBackend::ITERATIVE}) {
+    OptimizationParameters parameters;
+    parameters.linear_solver = backend;
+    const Optimizer optimizer(parameters);
+    OptimizerProfile profile;
+    const Values result =
+        optimizer.optimize(example::Costs(), example::Initial(), &profile);
+    EXPECT(LinearSolverBackendName(backend) == profile.linear_solver);
+    EXPECT(profile.toJson().find("\"linear_solver\"") != std::string::npos);
+    if (expected.empty()) expected = result;
+    EXPECT(assert_equal(expected, result, 1e-5));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -17,6 +17,7 @@
 #include <gtsam/base/serializationTestHelpers.h>
 #include <gtsam/linear/VectorValues.h>
 
+#include "gtdynamics/statics/Statics.h"
 #include "gtdynamics/universal_robot/Link.h"
 #include "gtdynamics/universal_robot/RevoluteJoint.h"
 #include "gtdynamics/universal_robot/RobotModels.h"
@@ -63,6 +64,25 @@ TEST(Link, params_constructor) {
   EXPECT(assert_equal(0, l1.joints().size()));
 }
 
+// The gravity wrench is that of the statics, for the cached mass.
+TEST(Link, gravityWrench) {
+  Link l1(1, "l1", 100.0, gtsam::Vector3(3, 2, 1).asDiagonal(),
+          Pose3(Rot3(), Point3(0, 0, 1)), Pose3());
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const Pose3 wTcom(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(1, 2, 3));
+  EXPECT(assert_equal(GravityWrench(gravity, l1.mass(), wTcom),
+                      l1.gravityWrench(gravity, wTcom.rotation())));
+
+  // Copies and deserialized links keep the spatial inertia.
+  const Link l2 = l1;
+  EXPECT(assert_equal(gtsam::Matrix(l1.inertiaMatrix()),
+                      gtsam::Matrix(l2.inertiaMatrix())));
+  Link l3;
+  deserialize(serialize(l1), l3);
+  EXPECT(assert_equal(gtsam::Matrix(l1.inertiaMatrix()),
+                      gtsam::Matrix(l3.inertiaMatrix())));
+}
+
 TEST(Link, NumJoints) {
   auto robot = simple_urdf::getRobot();
   auto l1 = robot.link("l1");
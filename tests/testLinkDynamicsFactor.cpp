@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testLinkDynamicsFactor.cpp
+ * @brief Test the fused per-link dynamics factor against the separate
+ * dynamics factors it replaces.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/factors/LinkDynamicsFactor.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const int t = 5;
+
+OptimizerSetting Fused() {
+  OptimizerSetting opt;
+  opt.setFusedLinkDynamics();
+  return opt;
+}
+}  // namespace example
+
+// The fused graph has the same error, with fewer factors.
+TEST(LinkDynamicsFactor, SameError) {
+  using namespace example;
+  auto robot = simple_urdf_eq_mass::getRobot();
+  const DynamicsGraph separate(simple_urdf_eq_mass::gravity,
+                               simple_urdf_eq_mass::planar_axis);
+  const DynamicsGraph fused(Fused(), simple_urdf_eq_mass::gravity,
+                            simple_urdf_eq_mass::planar_axis);
+  const NonlinearFactorGraph expected = separate.dynamicsFactors(robot, t);
+  const NonlinearFactorGraph actual = fused.dynamicsFactors(robot, t);
+
+  const Values values = ZeroValues(robot, t, 0.1);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+  EXPECT(actual.size() < expected.size());
+  EXPECT(assert_equal(expected.keys(), actual.keys()));
+
+  size_t num_joints = 0;
+  for (auto &&factor : actual) {
+    auto link_factor = boost::dynamic_pointer_cast<LinkDynamicsFactor>(factor);
+    EXPECT(link_factor);
+    num_joints += link_factor->numJoints();
+    EXPECT_CORRECT_FACTOR_JACOBIANS(*link_factor, values, 1e-7, 1e-5);
+  }
+  EXPECT_LONGS_EQUAL(robot.numJoints(), num_joints);
+}
+
+// Contact wrenches enter the fused wrench balance; contact factors remain.
+TEST(LinkDynamicsFactor, Contacts) {
+  using namespace example;
+  auto robot = simple_rr::getRobot();
+  PointOnLinks contact_points;
+  contact_points.emplace_back(robot.link("link_0"), gtsam::Point3(0, 0, -0.1));
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  const DynamicsGraph separate(gravity);
+  const DynamicsGraph fused(Fused(), gravity);
+  const NonlinearFactorGraph expected =
+      separate.dynamicsFactors(robot, t, contact_points, 1.0);
+  const NonlinearFactorGraph actual =
+      fused.dynamicsFactors(robot, t, contact_points, 1.0);
+
+  const Values values = ZeroValues(robot, t, 0.1, contact_points);
+  EXPECT_DOUBLES_EQUAL(expected.error(values), actual.error(values), 1e-9);
+  EXPECT(actual.size() < expected.size());
+}
+
+// A fused slice instantiates at any time step.
+TEST(LinkDynamicsFactor, Slice) {
+  using namespace example;
+  auto robot = simple_urdf_eq_mass::getRobot();
+  const DynamicsGraph fused(Fused(), simple_urdf_eq_mass::gravity,
+                            simple_urdf_eq_mass::planar_axis);
+  const DynamicsSlice slice = fused.dynamicsSlice(robot);
+  const Values values = ZeroValues(robot, t, 0.1);
+  EXPECT_DOUBLES_EQUAL(fused.dynamicsFactorGraph(robot, t).error(values),
+                       slice.instantiate(t).error(values), 1e-9);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testManifoldOptimizer.cpp
+ * @brief Test optimization with link poses eliminated by forward kinematics.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "contactGoalsExample.h"
+#include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
+#include "gtdynamics/optimizer/ManifoldOptimizer.h"
+#include "gtdynamics/utils/Slice.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Pose3;
+using gtsam::Values;
+
+// Poses on the manifold agree with Robot::forwardKinematics, with correct
+// Jacobians through the joint angles and the floating base.
+TEST(KinematicManifold, Pose) {
+  using contact_goals_example::robot;
+  const size_t k = 3;
+  const auto manifold = boost::make_shared<KinematicManifold>(robot);
+
+  // The floating base is the root of the traversal.
+  Values values;
+  const LinkSharedPtr root = manifold->compiledRobot().links().front();
+  const int base = root->id();
+  const std::string base_name = root->name();
+  const Pose3 wTb(gtsam::Rot3::RzRyRx(0.1, -0.2, 0.3),
+                  gtsam::Point3(0.5, -0.1, 0.4));
+  InsertPose(&values, base, k, wTb);
+  InsertTwist(&values, base, k, gtsam::Z_6x1);
+  for (auto&& joint : robot.joints())
+    InsertJointAngle(&values, joint->id(), k, 0.1 * joint->id() - 0.4);
+  const Values fk = robot.forwardKinematics(values, k, base_name);
+
+  EXPECT(!manifold->isEliminated(internal::PoseKey(base, k)));
+  for (auto&& link : robot.links()) {
+    const gtsam::Key key = internal::PoseKey(link->id(), k);
+    if (link->id() == base) continue;
+    EXPECT(manifold->isEliminated(key));
+    EXPECT(assert_equal(fk.at<Pose3>(key), manifold->pose(key, values), 1e-9));
+  }
+
+  // Prior on a foot, expressed on the manifold.
+  const gtsam::Key foot = internal::PoseKey(robot.link("lower0")->id(), k);
+  auto prior = boost::make_shared<gtsam::PriorFactor<Pose3>>(
+      foot, Pose3(), gtsam::noiseModel::Unit::Create(6));
+  const ManifoldFactor factor(manifold, prior);
+  EXPECT_LONGS_EQUAL(manifold->basis(foot).size(), factor.size());
+  EXPECT_DOUBLES_EQUAL(prior->error(fk), factor.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, manifold->reduce(values), 1e-7,
+                                  1e-5);
+}
+
+// Inverse kinematics over joint angles only reaches the contact goals.
+TEST(ManifoldOptimizer, InverseKinematics) {
+  using namespace contact_goals_example;
+  const Slice slice(0);
+  const Kinematics kinematics;
+  auto constraints = kinematics.constraints(slice, robot);
+  constraints.add(kinematics.pointGoalConstraints(slice, contact_goals));
+  const auto graph = kinematics.jointAngleObjectives(slice, robot);
+  const Values init = kinematics.initialValues(slice, robot, 0.0);
+
+  const ManifoldOptimizer optimizer(
+      robot, boost::make_shared<AugmentedLagrangianOptimizer>());
+  const Values reduced = optimizer.manifold().reduce(init);
+  EXPECT_LONGS_EQUAL(12 + 1, reduced.size());
+
+  const Values result = optimizer.optimize(graph, constraints, init);
+  EXPECT_LONGS_EQUAL(init.size(), result.size());
+  for (const ContactGoal& goal : contact_goals)
+    EXPECT(goal.satisfied(result, 0, 1e-3));
+  for (auto&& constraint : kinematics.constraints(slice, robot))
+    EXPECT(constraint->feasible(result));
+
+  // The same as an optimizer mode.
+  KinematicsParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  parameters.manifold_robot = robot;
+  const Values mode_result =
+      Optimizer(parameters).optimize(graph, constraints, init);
+  for (const ContactGoal& goal : contact_goals)
+    EXPECT(goal.satisfied(mode_result, 0, 1e-3));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMatrixFile.cpp
+ * @brief Test loading matrices from binary and text files.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/utils/MatrixFile.h"
+
+using namespace gtdynamics;
+
+TEST(MatrixFile, Binary) {
+  const std::string filename = "matrix_file_test.gtdmat";
+  gtsam::Matrix matrix(3, 2);
+  matrix << 1, 2, 3, 4, 5, 6;
+  WriteMatrixFile(filename, matrix);
+  EXPECT(assert_equal(matrix, ReadMatrixFile(filename)));
+
+  WriteMatrixFile(filename, gtsam::Matrix());
+  EXPECT_LONGS_EQUAL(0, ReadMatrixFile(filename).size());
+  std::remove(filename.c_str());
+}
+
+TEST(MatrixFile, Text) {
+  const std::string filename = "matrix_file_test.txt";
+  {
+    std::ofstream os(filename);
+    os << "# t q\n"
+       << "0 1.5 -2e-3\n"
+       << "\n"
+       << "  0.1\t2.5 4\r\n"
+       << "0.2 3.5 1e2";
+  }
+  gtsam::Matrix expected(3, 3);
+  expected << 0, 1.5, -2e-3, 0.1, 2.5, 4, 0.2, 3.5, 1e2;
+  EXPECT(assert_equal(expected, ReadMatrixFile(filename)));
+  EXPECT(assert_equal(expected, ReadMatrixFile(filename, 1)));
+
+  // Large enough to be parsed by several threads.
+  const gtsam::Matrix large = gtsam::Matrix::Random(500, 7);
+  {
+    std::ofstream os(filename);
+    os.precision(17);
+    for (int i = 0; i < large.rows(); i++)
+      os << large.row(i) << "\n";
+  }
+  EXPECT(assert_equal(large, ReadMatrixFile(filename), 1e-15));
+  std::remove(filename.c_str());
+}
+
+TEST(MatrixFile, Invalid) {
+  const std::string filename = "matrix_file_invalid.txt";
+  {
+    std::ofstream os(filename);
+    os << "1 2 3\n4 5\n";
+  }
+  CHECK_EXCEPTION(ReadMatrixFile(filename), std::invalid_argument);
+  {
+    std::ofstream os(filename);
+    os << "1 2 x\n";
+  }
+  CHECK_EXCEPTION(ReadMatrixFile(filename), std::invalid_argument);
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os.write("GTDMAT\0\0", 8);
+    os << "too short";
+  }
+  CHECK_EXCEPTION(ReadMatrixFile(filename), std::invalid_argument);
+  std::remove(filename.c_str());
+  CHECK_EXCEPTION(ReadMatrixFile("no_such_matrix.txt"), std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMeasurementFactorBuilder.cpp
+ * @brief Test building windowed measurement factors from ring buffers.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <thread>
+
+#include "gtdynamics/factors/ContactHeightFactor.h"
+#include "gtdynamics/factors/JointMeasurementFactor.h"
+#include "gtdynamics/factors/MeasurementFactorBuilder.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Pose3;
+
+TEST(MeasurementFactorBuilder, windows) {
+  const Robot robot = simple_rr::getRobot();
+  const auto joint = robot.joint("joint_1");
+  const int j = joint->id();
+  const int foot = robot.link("link_2")->id();
+  MeasurementFactorBuilder builder(robot);
+
+  // Encoder and contact readings from their own threads, in window 0.
+  std::thread encoder([&]() {
+    builder.jointReadings().push({0.001, j, 0.1});
+    builder.jointReadings().push({0.004, j, 0.3});
+  });
+  std::thread contacts([&]() {
+    builder.contactReadings().push({0.002, foot, false});
+    builder.contactReadings().push({0.005, foot, true});
+  });
+  encoder.join();
+  contacts.join();
+  EXPECT_LONGS_EQUAL(0, builder.drain().size());  // window 0 is still open
+
+  // A reading of window 1 completes window 0.
+  builder.jointReadings().push({0.012, j, 0.5});
+  auto windows = builder.drain();
+  EXPECT_LONGS_EQUAL(1, windows.size());
+  const MeasurementWindow &window = windows.front();
+  EXPECT_LONGS_EQUAL(0, window.k);
+  EXPECT_LONGS_EQUAL(4, window.num_readings);
+  EXPECT_LONGS_EQUAL(2, window.factors.size());
+
+  // One factor on the mean angle, one for the foot in contact at the end.
+  auto measurement =
+      boost::dynamic_pointer_cast<JointMeasurementFactor>(window.factors[0]);
+  EXPECT(measurement);
+  gtsam::Values values;
+  const Pose3 wTp;
+  const Pose3 wTc = joint->poseOf(joint->child(), wTp, 0.2);
+  InsertPose(&values, joint->parent()->id(), wTp);
+  InsertPose(&values, joint->child()->id(), wTc);
+  EXPECT_DOUBLES_EQUAL(0, measurement->error(values), 1e-9);
+  auto contact =
+      boost::dynamic_pointer_cast<ContactHeightFactor>(window.factors[1]);
+  EXPECT(contact);
+  EXPECT(contact->keys().front() == internal::PoseKey(foot, 0));
+
+  // Readings of built windows are late, flush returns the open window.
+  builder.jointReadings().push({0.003, j, 0.1});
+  windows = builder.flush();
+  EXPECT_LONGS_EQUAL(1, windows.size());
+  EXPECT_LONGS_EQUAL(1, windows.front().k);
+  EXPECT_DOUBLES_EQUAL(0.01, windows.front().start_time, 1e-12);
+
+  builder.jointReadings().push({-1.0, j, 0.1});
+  builder.contactReadings().push({1.0, 1000, true});
+  EXPECT_LONGS_EQUAL(0, builder.flush().size());
+  const MeasurementFactorBuilderStats stats = builder.stats();
+  EXPECT_LONGS_EQUAL(8, stats.readings);
+  EXPECT_LONGS_EQUAL(1, stats.late);
+  EXPECT_LONGS_EQUAL(2, stats.rejected);
+  EXPECT_LONGS_EQUAL(2, stats.windows);
+  EXPECT_LONGS_EQUAL(0, stats.dropped);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMemoryFootprint.cpp
+ * @brief Test memory estimates of graphs against their linearizations.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/linear/GaussianBayesTree.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/kinematics/Kinematics.h"
+#include "gtdynamics/optimizer/MemoryFootprint.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/AllocationTracker.h"
+#include "gtdynamics/utils/Slice.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+
+using namespace gtdynamics;
+
+namespace example {
+// Nonzeros of the R factors of all cliques at or below `clique`.
+size_t FactorNonzeros(const gtsam::GaussianBayesTreeClique &clique) {
+  const auto &conditional = *clique.conditional();
+  const size_t r = conditional.get_R().rows();
+  const size_t s = conditional.get_S().cols();
+  size_t nonzeros = r * (r + 1) / 2 + r * s;
+  for (auto &&child : clique.children) nonzeros += FactorNonzeros(*child);
+  return nonzeros;
+}
+}  // namespace example
+
+// The structural estimate matches numerical linearization and elimination.
+TEST(MemoryFootprint, DynamicsGraph) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  const gtsam::Values values = ZeroValues(robot, 0);
+
+  gtsam::NonlinearFactorGraph graph;
+  const MemoryFootprint footprint = MeasureMemoryFootprint(
+      [&] { return graph_builder.dynamicsFactorGraph(robot, 0); }, values,
+      boost::none, &graph);
+  EXPECT_LONGS_EQUAL(graph.size(), footprint.num_factors);
+  EXPECT_LONGS_EQUAL(graph.keys().size(), footprint.num_variables);
+
+  const auto linear = graph.linearize(values);
+  size_t rows = 0, nonzeros = 0;
+  for (auto &&factor : *linear) {
+    const auto jacobian =
+        boost::dynamic_pointer_cast<gtsam::JacobianFactor>(factor);
+    rows += jacobian->rows();
+    nonzeros += jacobian->rows() * (jacobian->cols() - 1);
+  }
+  EXPECT_LONGS_EQUAL(rows, footprint.num_rows);
+  EXPECT_LONGS_EQUAL(nonzeros, footprint.jacobian_nonzeros);
+
+  const auto ordering = gtsam::Ordering::Colamd(graph);
+  const auto bayes_tree = linear->eliminateMultifrontal(ordering);
+  size_t factor_nonzeros = 0;
+  for (auto &&root : bayes_tree->roots())
+    factor_nonzeros += example::FactorNonzeros(*root);
+  EXPECT_LONGS_EQUAL(factor_nonzeros,
+                     EstimateMemoryFootprint(graph, values, ordering)
+                         .factor_nonzeros);
+  EXPECT(footprint.fillIn() > 0);
+  EXPECT(footprint.totalBytes() >= footprint.linearSystemBytes());
+
+  // The graph holds memory, if counting is compiled in.
+  if (AllocationScope::kCompiled) {
+    EXPECT(footprint.construction.allocations > 0);
+    EXPECT(footprint.construction.retainedBytes() > 0);
+    EXPECT(footprint.construction.peak_bytes >=
+           footprint.construction.retainedBytes());
+  } else {
+    EXPECT_LONGS_EQUAL(0, footprint.construction.bytes_allocated);
+  }
+  EXPECT(footprint.toJson().find("\"total_bytes\"") != std::string::npos);
+
+  CHECK_EXCEPTION(EstimateMemoryFootprint(graph, gtsam::Values()),
+                  std::invalid_argument);
+}
+
+TEST(MemoryFootprint, Kinematics) {
+  const Robot robot = simple_rr::getRobot();
+  const Slice slice(0);
+  const Kinematics kinematics;
+  const gtsam::Values values = kinematics.initialValues(slice, robot);
+  const MemoryFootprint footprint = MeasureMemoryFootprint(
+      [&] { return kinematics.graph(slice, robot); }, values);
+  EXPECT_LONGS_EQUAL(kinematics.graph(slice, robot).size(),
+                     footprint.num_factors);
+  EXPECT(footprint.factor_nonzeros > 0);
+}
+
+TEST(AllocationScope, nested) {
+  AllocationScope outer;
+  std::vector<double> kept(1000);
+  {
+    AllocationScope inner;
+    std::vector<double> temporary(2000);
+    if (AllocationScope::kCompiled)
+      EXPECT(inner.stats().bytes_allocated >= 2000 * sizeof(double));
+  }
+  if (AllocationScope::kCompiled) {
+    const AllocationStats stats = outer.stats();
+    EXPECT(stats.retainedBytes() >= 1000 * sizeof(double));
+    EXPECT(stats.peak_bytes >= 3000 * sizeof(double));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
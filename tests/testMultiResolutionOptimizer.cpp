@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultiResolutionOptimizer.cpp
+ * @brief Test coarse-to-fine optimization of multi-phase trajectories.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "gtdynamics/optimizer/MultiResolutionOptimizer.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/values.h"
+#include "walkCycleExample.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+TEST(MultiResolutionOptimizer, Coarsen) {
+  using namespace walk_cycle_example;
+  const Trajectory fine(walk_cycle, 2);
+  const Trajectory coarse = MultiResolutionOptimizer::Coarsen(fine, 2);
+  EXPECT_LONGS_EQUAL(4, coarse.numPhases());
+  EXPECT(coarse.phaseDurations() == std::vector<int>({1, 2, 1, 2}));
+  EXPECT_LONGS_EQUAL(6, coarse.getEndTimeStep(3));
+  EXPECT_LONGS_EQUAL(fine.phaseContactPoints()[1].size(),
+                     coarse.phaseContactPoints()[1].size());
+
+  // Phases keep at least one step.
+  const Trajectory coarsest = MultiResolutionOptimizer::Coarsen(fine, 100);
+  EXPECT(coarsest.phaseDurations() == std::vector<int>({1, 1, 1, 1}));
+
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  MultiResolutionParameters parameters;
+  parameters.num_levels = 2;
+  const MultiResolutionOptimizer optimizer(
+      robot, graph_builder, fine,
+      [](const Trajectory &) { return gtsam::NonlinearFactorGraph(); },
+      parameters);
+  EXPECT_LONGS_EQUAL(2, optimizer.levels().size());
+  EXPECT(optimizer.levels()[0].phaseDurations() == coarse.phaseDurations());
+  EXPECT(optimizer.levels()[1].phaseDurations() == fine.phaseDurations());
+}
+
+TEST(MultiResolutionOptimizer, Upsample) {
+  using namespace walk_cycle_example;
+  const Trajectory fine(walk_cycle, 2);
+  const Trajectory coarse = MultiResolutionOptimizer::Coarsen(fine, 2);
+
+  // Coarse values linear in the time step, and a contact at step 3 only.
+  Values coarse_values;
+  for (size_t k = 0; k <= 6; ++k) {
+    InsertJointAngle(&coarse_values, 0, k, double(k));
+    InsertPose(&coarse_values, 0, k, Pose3(Rot3(), Point3(k, 0, 0)));
+  }
+  for (size_t p = 0; p < 4; ++p) coarse_values.insert(PhaseKey(p), 0.1);
+  const gtsam::Key contact = ContactWrenchKey(1, 0, 3);
+  coarse_values.insert(contact, gtsam::Vector6::Ones().eval());
+
+  const Values values =
+      MultiResolutionOptimizer::Upsample(coarse, coarse_values, fine);
+
+  // Step 1 is halfway through coarse step 0 to 1, step 4 at 7/3.
+  EXPECT_DOUBLES_EQUAL(0.5, JointAngle(values, 0, 1), 1e-9);
+  EXPECT_DOUBLES_EQUAL(7.0 / 3, JointAngle(values, 0, 4), 1e-9);
+  EXPECT_DOUBLES_EQUAL(6, JointAngle(values, 0, 10), 1e-9);
+  EXPECT(assert_equal(Pose3(Rot3(), Point3(0.5, 0, 0)), Pose(values, 0, 1),
+                      1e-9));
+
+  // Durations are kept: phase 1 has 3 steps instead of 2.
+  EXPECT_DOUBLES_EQUAL(0.05, values.at<double>(PhaseKey(0)), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0.2 / 3, values.at<double>(PhaseKey(1)), 1e-12);
+
+  // The contact is copied to the fine steps within a step of coarse step 3.
+  for (size_t k : {4, 5, 6}) EXPECT(values.exists(ContactWrenchKey(1, 0, k)));
+  EXPECT(!values.exists(ContactWrenchKey(1, 0, 3)));
+  EXPECT(!values.exists(ContactWrenchKey(1, 0, 7)));
+  EXPECT_LONGS_EQUAL(2 * 11 + 4 + 3, values.size());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
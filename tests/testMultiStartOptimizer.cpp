@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultiStartOptimizer.cpp
+ * @brief Test parallel multi-start optimization.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include "constrainedExample.h"
+#include "gtdynamics/optimizer/MultiStartOptimizer.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace example {
+using namespace constrained_example;
+
+// Two minima near x1 = -1 and x1 = 1, the latter with the smaller cost.
+NonlinearFactorGraph Costs() {
+  NonlinearFactorGraph graph;
+  graph.add(ExpressionFactor<double>(noiseModel::Isotropic::Sigma(1, 1.0),
+                                     0., pow(x1, 2.0) + (-1.0)));
+  graph.emplace_shared<PriorFactor<double>>(
+      x1_key, 1.2, noiseModel::Isotropic::Sigma(1, 10.0));
+  return graph;
+}
+}  // namespace example
+
+TEST(MultiStartOptimizer, BestStart) {
+  const std::vector<double> starts = {-2.0, -0.5, 2.0};
+  const auto initializer = [&](size_t i) {
+    Values values;
+    values.insert(constrained_example::x1_key, starts[i]);
+    return values;
+  };
+
+  MultiStartParameters parameters;
+  parameters.lm_parameters = LevenbergMarquardtParams();
+  parameters.num_threads = 2;
+  MultiStartResult result;
+  const Values best =
+      MultiStartOptimizer(parameters)
+          .optimize(example::Costs(), EqualityConstraints(), initializer,
+                    starts.size(), &result);
+  EXPECT_LONGS_EQUAL(2, result.best);
+  EXPECT_DOUBLES_EQUAL(1.0, best.at<double>(constrained_example::x1_key),
+                       0.01);
+  EXPECT_LONGS_EQUAL(3, result.costs.size());
+  EXPECT(result.costs[2] < result.costs[0]);
+  EXPECT_DOUBLES_EQUAL(0.0, result.violations[2], 1e-12);
+  EXPECT(result.time > 0);
+
+  // With a ratio of one, all but the leading start stop after one round.
+  parameters.cancel_ratio = 1.0;
+  parameters.round_iterations = 1;
+  MultiStartOptimizer(parameters)
+      .optimize(example::Costs(), EqualityConstraints(), initializer,
+                starts.size(), &result);
+  size_t num_cancelled = 0;
+  for (size_t i = 0; i < starts.size(); i++) {
+    if (!result.cancelled[i]) continue;
+    num_cancelled++;
+    EXPECT_LONGS_EQUAL(1, result.iterations[i]);
+  }
+  EXPECT(num_cancelled > 0 && num_cancelled < starts.size());
+
+  CHECK_EXCEPTION(MultiStartOptimizer().optimize(
+                      example::Costs(), EqualityConstraints(), initializer, 0),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
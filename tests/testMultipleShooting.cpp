@@ -0,0 +1,160 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testMultipleShooting.cpp
+ * @brief Test the shooting defect factor and the multiple-shooting planner.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/dynamics/MultipleShooting.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/factors/ObjectiveFactors.h"
+#include "gtdynamics/factors/ShootingDefectFactor.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+using gtsam::Vector;
+
+namespace example {
+const gtsam::Vector3 gravity(0, 0, -9.8);
+Robot robot() { return simple_rr::getRobot().fixLink("link_0"); }
+}  // namespace example
+
+// The defect is that of a forward simulation, with correct Jacobians.
+TEST(ShootingDefectFactor, error) {
+  const Robot robot = example::robot();
+  const OptimizerSetting opt;
+  const int t = 3;
+  const size_t num_steps = 5;
+  const double dt = 0.01;
+  const ShootingDefectFactor factor(robot, t, num_steps, dt,
+                                    opt.q_col_cost_model, opt.v_col_cost_model,
+                                    example::gravity);
+  EXPECT_LONGS_EQUAL(10, factor.size());
+  EXPECT_LONGS_EQUAL(4, factor.dim());
+
+  Vector q(2), v(2), tau(2);
+  q << 0.3, -0.7;
+  v << 1.1, -0.4;
+  tau << 0.2, -0.5;
+
+  // Integrate by hand with RecursiveDynamics.
+  RecursiveDynamics dynamics(robot, example::gravity);
+  RecursiveDynamicsResult result;
+  dynamics.allocate(&result);
+  Vector q1 = q, v1 = v;
+  for (size_t k = 0; k < num_steps; ++k) {
+    dynamics.forwardDynamics(q1, v1, tau, &result);
+    v1 += dt * result.joint_accels;
+    q1 += dt * v1;
+  }
+
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    InsertJointAngle(&values, j, t, q(j));
+    InsertJointVel(&values, j, t, v(j));
+    InsertTorque(&values, j, t, tau(j));
+    InsertJointAngle(&values, j, t + num_steps, q1(j) + 0.01);
+    InsertJointVel(&values, j, t + num_steps, v1(j));
+  }
+  Vector expected(4);
+  expected << 0.01, 0.01, 0, 0;
+  EXPECT(assert_equal(expected, factor.unwhitenedError(values), 1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  CHECK_EXCEPTION(ShootingDefectFactor(simple_rr::getRobot(), t, num_steps,
+                                       dt, opt.q_col_cost_model,
+                                       opt.v_col_cost_model),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(ShootingDefectFactor(robot, t, 0, dt, opt.q_col_cost_model,
+                                       opt.v_col_cost_model),
+                  std::invalid_argument);
+}
+
+// A rollout satisfies all defects, and the dense trajectory matches it.
+TEST(MultipleShooting, rollout) {
+  MultipleShootingParameters parameters;
+  parameters.num_segments = 4;
+  parameters.segment_steps = 5;
+  const MultipleShooting planner(example::robot(), parameters,
+                                 example::gravity);
+  EXPECT_LONGS_EQUAL(15, planner.nodeStep(3));
+
+  const gtsam::NonlinearFactorGraph defects = planner.defectFactors();
+  EXPECT_LONGS_EQUAL(4, defects.size());
+
+  Vector q0(2), v0(2), tau(2);
+  q0 << 0.3, -0.7;
+  v0 << 0.5, 0.1;
+  tau << 1.0, -0.5;
+  const Values nodes = planner.rollout(q0, v0, std::vector<Vector>(4, tau));
+  EXPECT_LONGS_EQUAL(5 * 2 * 2 + 4 * 2, nodes.size());
+  EXPECT_DOUBLES_EQUAL(0.0, defects.error(nodes), 1e-12);
+
+  ThreadPool pool(2);
+  const Values dense = planner.denseTrajectory(nodes, &pool);
+  EXPECT_LONGS_EQUAL(20 * 2 * 3 + 2 * 2, dense.size());
+  for (const int j : planner.jointIds()) {
+    EXPECT_DOUBLES_EQUAL(JointAngle(nodes, j, 10), JointAngle(dense, j, 10),
+                         1e-12);
+    EXPECT_DOUBLES_EQUAL(JointAngle(nodes, j, 20), JointAngle(dense, j, 20),
+                         1e-12);
+  }
+  EXPECT(assert_equal(dense, planner.denseTrajectory(nodes), 1e-12));
+}
+
+// Reach a goal with objective factors on the nodes, from a rollout at rest.
+TEST(MultipleShooting, optimize) {
+  MultipleShootingParameters parameters;
+  parameters.num_segments = 5;
+  parameters.segment_steps = 4;
+  parameters.dt = 0.02;
+  const Robot robot = example::robot();
+  const MultipleShooting planner(robot, parameters, example::gravity);
+
+  gtsam::NonlinearFactorGraph graph = planner.defectFactors();
+  const int T = planner.nodeStep(planner.numSegments());
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-3);
+  const auto torque_model = gtsam::noiseModel::Isotropic::Sigma(1, 100.0);
+  for (const int j : planner.jointIds()) {
+    graph.add(JointObjectives(j, 0).angle(0.0, model).velocity(0.0, model));
+    graph.add(JointObjectives(j, T).angle(0.5, model).velocity(0.0, model));
+    for (size_t k = 0; k < planner.numSegments(); ++k)
+      graph.addPrior<double>(
+          internal::TorqueKey(j, planner.nodeStep(k)), 0.0, torque_model);
+  }
+
+  const Vector zero = Vector::Zero(2);
+  const Values initial = planner.rollout(
+      zero, zero, std::vector<Vector>(planner.numSegments(), zero));
+  OptimizationParameters optimization;
+  optimization.num_threads = 2;
+  const Values result = Optimizer(optimization).optimize(graph, initial);
+
+  EXPECT_DOUBLES_EQUAL(0.0, planner.defectFactors().error(result), 1e-3);
+  for (const int j : planner.jointIds())
+    EXPECT_DOUBLES_EQUAL(0.5, JointAngle(result, j, T), 1e-2);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNLPAdapter.cpp
+ * @brief Test the nonlinear program adapter of costs and constraints.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "constrainedExample.h"
+#include "gtdynamics/optimizer/NLPAdapter.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace example {
+using namespace constrained_example;
+
+NonlinearFactorGraph Cost() {
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+EqualityConstraints Constraints() {
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 0.5);
+  return constraints;
+}
+
+Values Init() {
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, 0.3);
+  return values;
+}
+}  // namespace example
+
+TEST(NLPAdapter, Pattern) {
+  using namespace constrained_example;
+  NLPAdapter nlp(example::Cost(), example::Constraints(), example::Init());
+  EXPECT_LONGS_EQUAL(2, nlp.numVariables());
+  EXPECT_LONGS_EQUAL(1, nlp.numConstraints());
+  EXPECT_LONGS_EQUAL(0, nlp.offset(x1_key));
+  EXPECT_LONGS_EQUAL(1, nlp.offset(x2_key));
+
+  const SparsityPattern &jacobian = nlp.constraintJacobianPattern();
+  EXPECT_LONGS_EQUAL(1, jacobian.rows());
+  EXPECT_LONGS_EQUAL(2, jacobian.nonzeros());
+  EXPECT(jacobian.columns == std::vector<int>({0, 1}));
+  EXPECT(jacobian.rowIndices() == std::vector<int>({0, 0}));
+
+  const SparsityPattern &costs = nlp.costJacobianPattern();
+  EXPECT_LONGS_EQUAL(2, costs.rows());
+  EXPECT(costs.row_offsets == std::vector<int>({0, 2, 4}));
+  EXPECT(costs.columns == std::vector<int>({0, 1, 0, 1}));
+
+  // Keys outside of the ordering are rejected.
+  Ordering ordering;
+  ordering.push_back(x1_key);
+  CHECK_EXCEPTION(NLPAdapter(example::Cost(), example::Constraints(),
+                             example::Init(), ordering),
+                  std::invalid_argument);
+}
+
+TEST(NLPAdapter, Callbacks) {
+  using namespace constrained_example;
+  NLPAdapter nlp(example::Cost(), example::Constraints(), example::Init());
+  const double z[] = {0.1, -0.2};
+  const double x1 = -0.1, x2 = 0.1;
+  const Values values = nlp.values(z);
+  EXPECT_DOUBLES_EQUAL(x1, values.at<double>(x1_key), 1e-9);
+  EXPECT_DOUBLES_EQUAL(x2, values.at<double>(x2_key), 1e-9);
+  EXPECT_DOUBLES_EQUAL(example::Cost().error(values), nlp.objective(z), 1e-9);
+
+  // Constraints and their Jacobian are scaled by the tolerance.
+  double violation;
+  nlp.constraints(z, &violation);
+  EXPECT_DOUBLES_EQUAL((x1 + x1 * x1 * x1 + x2 + x2 * x2) / 0.5, violation,
+                       1e-9);
+  double jacobian[2];
+  nlp.constraintJacobian(z, jacobian);
+  EXPECT_DOUBLES_EQUAL((1 + 3 * x1 * x1) / 0.5, jacobian[0], 1e-9);
+  EXPECT_DOUBLES_EQUAL((1 + 2 * x2) / 0.5, jacobian[1], 1e-9);
+
+  // The gradient is J^T r with the cost Jacobian and residuals.
+  double cost_jacobian[4], residuals[2], gradient[2];
+  nlp.costJacobian(z, cost_jacobian, residuals);
+  nlp.gradient(z, gradient);
+  EXPECT_DOUBLES_EQUAL(
+      0.5 * (residuals[0] * residuals[0] + residuals[1] * residuals[1]),
+      nlp.objective(z), 1e-9);
+  for (size_t c = 0; c < 2; c++)
+    EXPECT_DOUBLES_EQUAL(cost_jacobian[c] * residuals[0] +
+                             cost_jacobian[2 + c] * residuals[1],
+                         gradient[c], 1e-9);
+
+  // Numerical gradient of the objective.
+  const double h = 1e-6;
+  for (size_t c = 0; c < 2; c++) {
+    double plus[] = {z[0], z[1]}, minus[] = {z[0], z[1]};
+    plus[c] += h;
+    minus[c] -= h;
+    EXPECT_DOUBLES_EQUAL(
+        (nlp.objective(plus) - nlp.objective(minus)) / (2 * h), gradient[c],
+        1e-6);
+  }
+
+  // After rebasing, z = 0 is the previous point.
+  const double objective = nlp.objective(z);
+  nlp.rebase(z);
+  const double zero[] = {0, 0};
+  EXPECT_DOUBLES_EQUAL(objective, nlp.objective(zero), 1e-9);
+  EXPECT(assert_equal(values, nlp.base()));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,133 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNestedDissectionOrdering.cpp
+ * @brief Test the elimination ordering by dissection of the robot tree.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/NestedDissectionOrdering.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/universal_robot/sdf.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Key;
+using gtsam::Ordering;
+using gtsam::Values;
+
+namespace example {
+// Poses, joint angles and child wrenches of `robot` at steps 0 to k.
+gtsam::KeySet Keys(const Robot &robot, size_t k) {
+  gtsam::KeySet keys;
+  for (size_t t = 0; t <= k; t++) {
+    for (auto &&link : robot.links())
+      keys.insert(internal::PoseKey(link->id(), t));
+    for (auto &&joint : robot.joints()) {
+      keys.insert(internal::JointAngleKey(joint->id(), t));
+      keys.insert(internal::WrenchKey(joint->child()->id(), joint->id(), t));
+    }
+  }
+  return keys;
+}
+
+// Leg of a spider link or joint, from the suffix of its name.
+std::string Leg(const std::string &name) {
+  return name.substr(name.rfind('_') + 1);
+}
+}  // namespace example
+
+// Every leg of the spider is contiguous in a step, and the body comes last.
+TEST(NestedDissectionOrdering, spider) {
+  const Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  gtsam::KeySet keys = example::Keys(robot, 1);
+  keys.insert(PhaseKey(0));
+  const Ordering ordering = NestedDissectionOrdering(robot, keys);
+  EXPECT_LONGS_EQUAL(keys.size(), ordering.size());
+  EXPECT(ordering.back() == PhaseKey(0));
+
+  const int body = robot.link("body")->id();
+  std::map<int, std::string> link_legs, joint_legs;
+  for (auto &&link : robot.links())
+    link_legs[link->id()] = example::Leg(link->name());
+  for (auto &&joint : robot.joints())
+    joint_legs[joint->id()] = example::Leg(joint->name());
+  std::map<std::string, std::vector<size_t>> positions;  // by leg, at t = 1
+  size_t first = ordering.size(), last = 0;
+  for (size_t k = 0; k + 1 < ordering.size(); k++) {
+    const Key key = ordering[k];
+    if (k > 0)
+      EXPECT(DynamicsSymbol::Time(ordering[k - 1]) <=
+             DynamicsSymbol::Time(key));
+    if (DynamicsSymbol::Time(key) != 1) continue;
+    first = std::min(first, k);
+    last = std::max(last, k);
+    const int j = DynamicsSymbol::JointIdx(key);
+    const int i = DynamicsSymbol::LinkIdx(key);
+    if (j != DynamicsSymbol::kNoIndex)
+      positions[joint_legs[j]].push_back(k);
+    else if (i != body)
+      positions[link_legs[i]].push_back(k);
+  }
+  EXPECT(ordering[last] == internal::PoseKey(body, 1));
+  EXPECT_LONGS_EQUAL(8, positions.size());
+  for (auto &&leg : positions) {
+    const auto &p = leg.second;
+    EXPECT_LONGS_EQUAL(p.back() - p.front() + 1, p.size());
+  }
+  // Both steps have the same keys, all of step 1 are contiguous.
+  EXPECT_LONGS_EQUAL((keys.size() - 1) / 2, last - first + 1);
+}
+
+// The separator of a chain is its middle, whatever the root.
+TEST(NestedDissectionOrdering, chain) {
+  const Robot robot = simple_rr::getRobot();
+  const Ordering ordering =
+      NestedDissectionOrdering(robot, example::Keys(robot, 0));
+  EXPECT(ordering.back() == internal::PoseKey(robot.link("link_1")->id(), 0));
+}
+
+// Optimizing with the ordering gives the same solution.
+TEST(NestedDissectionOrdering, Optimizer) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  const DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                                    simple_urdf_eq_mass::planar_axis);
+  const int num_steps = 2;
+  Values known_values = zero_values(robot, 0);
+  for (int k = 0; k <= num_steps; k++)
+    for (auto &&joint : robot.joints())
+      InsertTorque(&known_values, joint->id(), k, k + 1.0);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 1.0,
+                                          CollocationScheme::Euler);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+  const Values init = ZeroValuesTrajectory(robot, num_steps);
+
+  OptimizationParameters parameters;
+  const Values expected = Optimizer(parameters).optimize(graph, init);
+  parameters.ordering_robot = robot;
+  parameters.nested_dissection = true;
+  const Values actual = Optimizer(parameters).optimize(graph, init);
+  EXPECT(assert_equal(expected, actual, 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
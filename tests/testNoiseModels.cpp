@@ -0,0 +1,48 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testNoiseModels.cpp
+ * @brief Test the shared noise model instances.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include "gtdynamics/dynamics/OptimizerSetting.h"
+#include "gtdynamics/utils/NoiseModels.h"
+
+using namespace gtdynamics;
+
+TEST(NoiseModels, ConstrainedAll) {
+  const auto model = ConstrainedAll(6);
+  EXPECT(model == ConstrainedAll(6));
+  EXPECT(model != ConstrainedAll(3));
+  EXPECT(assert_equal(*gtsam::noiseModel::Constrained::All(6), *model));
+}
+
+TEST(NoiseModels, IsotropicSigma) {
+  const auto model = IsotropicSigma(6, 0.001);
+  EXPECT(model == IsotropicSigma(6, 0.001));
+  EXPECT(model != IsotropicSigma(6, 0.002));
+  EXPECT(model != IsotropicSigma(3, 0.001));
+  EXPECT(assert_equal(*gtsam::noiseModel::Isotropic::Sigma(6, 0.001), *model));
+}
+
+// Settings share the models with equal dimension and sigma.
+TEST(NoiseModels, OptimizerSetting) {
+  const OptimizerSetting a(0.001), b(0.001);
+  EXPECT(a.p_cost_model == a.v_cost_model);
+  EXPECT(a.p_cost_model == b.p_cost_model);
+  EXPECT(a.q_col_cost_model == b.t_cost_model);
+  EXPECT(a.p_cost_model != a.t_cost_model);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,162 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testOptimizerProfile.cpp
+ * @brief Test timing and sparsity profiles of optimizers.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <string>
+
+#include "constrainedExample.h"
+#include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/optimizer/OptimizerProfile.h"
+#include "gtdynamics/optimizer/PenaltyMethodOptimizer.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace example {
+using namespace constrained_example;
+
+NonlinearFactorGraph Costs() {
+  NonlinearFactorGraph graph;
+  auto cost_noise = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+EqualityConstraints Constraints() {
+  EqualityConstraints constraints;
+  auto g1 = x1 + pow(x1, 3) + x2 + pow(x2, 2);
+  constraints.push_back(EqualityConstraint::shared_ptr(
+      new DoubleExpressionEquality(g1, 1.0)));
+  return constraints;
+}
+
+Values Initial() {
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, -0.2);
+  return values;
+}
+}  // namespace example
+
+// Check the counters every profiled solve fills in.
+static void CheckProfile(const OptimizerProfile &profile) {
+  EXPECT(profile.total > 0);
+  EXPECT(profile.num_linearizations > 0);
+  EXPECT(profile.num_eliminations >= profile.iterations.size());
+  EXPECT(!profile.iterations.empty());
+  EXPECT(profile.linearization + profile.elimination <= profile.total);
+  for (auto &&iteration : profile.iterations)
+    EXPECT(iteration.error_after <= iteration.error_before + 1e-9);
+}
+
+TEST(OptimizerProfile, AugmentedLagrangian) {
+  AugmentedLagrangianOptimizer optimizer;
+  ConstrainedOptResult result;
+  result.profile.compute_sparsity = true;
+  optimizer.optimize(example::Costs(), example::Constraints(),
+                     example::Initial(), &result);
+
+  const OptimizerProfile &profile = result.profile;
+  CheckProfile(profile);
+  EXPECT(profile.constraint_evaluation > 0);
+
+  // Two costs and one penalty factor, all dense on both variables.
+  EXPECT_LONGS_EQUAL(3, profile.num_factors);
+  EXPECT_LONGS_EQUAL(2, profile.num_variables);
+  EXPECT_LONGS_EQUAL(6, profile.jacobian_nonzeros);
+  EXPECT_LONGS_EQUAL(3, profile.factor_nonzeros);
+  EXPECT_DOUBLES_EQUAL(0.5, profile.fillIn(), 1e-9);
+}
+
+TEST(OptimizerProfile, PenaltyMethod) {
+  PenaltyMethodOptimizer optimizer;
+  ConstrainedOptResult result;
+  optimizer.optimize(example::Costs(), example::Constraints(),
+                     example::Initial(), &result);
+  CheckProfile(result.profile);
+  EXPECT_LONGS_EQUAL(0, result.profile.num_factors);
+}
+
+TEST(OptimizerProfile, Optimizer) {
+  OptimizationParameters parameters;
+  parameters.method = OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  Optimizer optimizer(parameters);
+  OptimizerProfile profile;
+  const Values with_profile = optimizer.optimize(
+      example::Costs(), example::Constraints(), example::Initial(), &profile);
+  CheckProfile(profile);
+
+  // Profiling does not change the result.
+  const Values without_profile = optimizer.optimize(
+      example::Costs(), example::Constraints(), example::Initial());
+  EXPECT(assert_equal(without_profile, with_profile));
+}
+
+// A budget that runs out at once returns the initial values; an ample one
+// does not change the result.
+TEST(OptimizerProfile, TimeBudget) {
+  AugmentedLagrangianParameters parameters;
+  parameters.time_budget = 1e-12;
+  ConstrainedOptResult result;
+  const Values timed_out =
+      AugmentedLagrangianOptimizer(parameters)
+          .optimize(example::Costs(), example::Constraints(),
+                    example::Initial(), &result);
+  EXPECT(result.timed_out);
+  EXPECT(assert_equal(example::Initial(), timed_out));
+  EXPECT(result.profile.total > 0);
+  EXPECT(result.violation > 0);
+
+  parameters.time_budget = 100;
+  const Values budgeted =
+      AugmentedLagrangianOptimizer(parameters)
+          .optimize(example::Costs(), example::Constraints(),
+                    example::Initial(), &result);
+  const Values unbudgeted = AugmentedLagrangianOptimizer().optimize(
+      example::Costs(), example::Constraints(), example::Initial());
+  EXPECT(!result.timed_out);
+  EXPECT(assert_equal(unbudgeted, budgeted, 1e-6));
+  EXPECT(result.violation < 1e-3);
+
+  PenaltyMethodParameters penalty_parameters;
+  penalty_parameters.time_budget = 1e-12;
+  ConstrainedOptResult penalty_result;
+  PenaltyMethodOptimizer(penalty_parameters)
+      .optimize(example::Costs(), example::Constraints(), example::Initial(),
+                &penalty_result);
+  EXPECT(penalty_result.timed_out);
+  EXPECT(penalty_result.intermediate_values.empty());
+}
+
+TEST(OptimizerProfile, Json) {
+  OptimizerProfile profile;
+  profile.total = 1.5;
+  profile.num_linearizations = 3;
+  profile.iterations.push_back({0.25, 2.0, 1.0});
+  const std::string json = profile.toJson();
+  EXPECT(json.find("\"total\": 1.5") != std::string::npos);
+  EXPECT(json.find("\"num_linearizations\": 3") != std::string::npos);
+  EXPECT(json.find("\"fill_in\": 0") != std::string::npos);
+  EXPECT(json.find("{\"time\": 0.25, \"error_before\": 2, "
+                   "\"error_after\": 1}") != std::string::npos);
+  EXPECT(json.front() == '{');
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
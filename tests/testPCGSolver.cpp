@@ -0,0 +1,122 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPCGSolver.cpp
+ * @brief Test the matrix-free conjugate gradient solver.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/linear/JacobianFactor.h>
+#include <gtsam/linear/linearExceptions.h>
+#include <gtsam/linear/VectorValues.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/optimizer/PCGSolver.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::GaussianFactorGraph;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace example {
+// A chain of steps with joint and link variables, priors and odometry.
+GaussianFactorGraph chain() {
+  GaussianFactorGraph graph;
+  const auto model = gtsam::noiseModel::Isotropic::Sigma(2, 0.5);
+  for (int t = 0; t < 6; t++) {
+    const gtsam::Key q = internal::JointAngleKey(0, t);
+    const gtsam::Key v = internal::JointVelKey(0, t);
+    const gtsam::Key w = internal::TwistKey(1, t);
+    graph.add(q, (Matrix(2, 1) << 1, t).finished(), v,
+              (Matrix(2, 1) << 0.5, -1).finished(),
+              (Vector(2) << t, 1).finished(), model);
+    graph.add(w, Matrix::Identity(6, 6), q, Matrix::Ones(6, 1),
+              Vector::Constant(6, 0.1 * t), gtsam::noiseModel::Unit::Create(6));
+    if (t > 0) {
+      graph.add(internal::JointAngleKey(0, t - 1), -Matrix::Ones(1, 1), q,
+                Matrix::Ones(1, 1), (Vector(1) << 0.1).finished(),
+                gtsam::noiseModel::Unit::Create(1));
+      graph.add(internal::JointVelKey(0, t - 1), -Matrix::Ones(1, 1), q,
+                2 * Matrix::Ones(1, 1), (Vector(1) << -0.3).finished(),
+                gtsam::noiseModel::Unit::Create(1));
+    }
+  }
+  return graph;
+}
+}  // namespace example
+
+// Every preconditioner converges to the direct solution.
+TEST(PCGSolve, Chain) {
+  const GaussianFactorGraph graph = example::chain();
+  const gtsam::VectorValues expected = graph.optimize();
+  for (auto preconditioner :
+       {PCGParameters::VARIABLE, PCGParameters::TIME_SLICE,
+        PCGParameters::LINK}) {
+    PCGParameters parameters;
+    parameters.preconditioner = preconditioner;
+    size_t iterations = 0;
+    EXPECT(assert_equal(expected,
+                        PCGSolve(graph, parameters, nullptr, &iterations),
+                        1e-7));
+    EXPECT(iterations > 0);
+    EXPECT(iterations <= 30);  // at most the number of unknowns
+  }
+
+  // Same result on a thread pool.
+  ThreadPool pool(4);
+  EXPECT(assert_equal(expected, PCGSolve(graph, PCGParameters(), &pool),
+                      1e-7));
+}
+
+// A rank-deficient block cannot precondition.
+TEST(PCGSolve, Indeterminant) {
+  GaussianFactorGraph graph;
+  graph.add(internal::JointAngleKey(0, 0), Matrix::Zero(1, 1),
+            (Vector(1) << 1).finished(), gtsam::noiseModel::Unit::Create(1));
+  CHECK_EXCEPTION(PCGSolve(graph), gtsam::IndeterminantLinearSystemException);
+}
+
+// LM with the PCG solver reaches the same point as with elimination.
+TEST(PCGSolve, Trajectory) {
+  auto robot = simple_rr::getRobot();
+  const int num_steps = 5;
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8),
+                                    gtsam::Vector3(1, 0, 0));
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  const gtsam::Values values =
+      ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+  graph.add(graph_builder.forwardDynamicsPriors(robot, 0, values));
+  for (auto &&link : robot.links()) {
+    graph.addPrior(internal::PoseKey(link->id(), 0), link->bMcom(),
+                   graph_builder.opt().bp_cost_model);
+    graph.addPrior<gtsam::Vector6>(internal::TwistKey(link->id(), 0),
+                                   gtsam::Z_6x1,
+                                   graph_builder.opt().bv_cost_model);
+  }
+
+  OptimizationParameters parameters;
+  parameters.lm_parameters.setMaxIterations(5);
+  const auto expected = Optimizer(parameters).optimize(graph, values);
+  parameters.pcg = PCGParameters();
+  parameters.pcg->preconditioner = PCGParameters::LINK;
+  parameters.num_threads = 2;
+  const auto actual = Optimizer(parameters).optimize(graph, values);
+  EXPECT(assert_equal(expected, actual, 1e-5));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
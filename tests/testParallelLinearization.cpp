@@ -0,0 +1,78 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testParallelLinearization.cpp
+ * @brief Test linearization of a factor graph on a thread pool.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/GaussianFactorGraph.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/optimizer/ParallelLinearization.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/ThreadPool.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const int num_steps = 10;
+
+NonlinearFactorGraph Trajectory(const Robot &robot) {
+  const DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8),
+                                    gtsam::Vector3(1, 0, 0));
+  return graph_builder.trajectoryFG(robot, num_steps, 0.1);
+}
+}  // namespace example
+
+// The parallel linear graph equals the serial one, factor by factor.
+TEST(ParallelLinearize, SameAsSerial) {
+  auto robot = simple_rr::getRobot();
+  NonlinearFactorGraph graph = example::Trajectory(robot);
+  graph.push_back(NonlinearFactorGraph::sharedFactor());  // null factor
+  const Values values =
+      ZeroValuesTrajectory(robot, example::num_steps, -1, 0.1);
+
+  const auto expected = graph.linearize(values);
+  ThreadPool pool(4);
+  const auto actual = ParallelLinearize(graph, values, &pool);
+  EXPECT_LONGS_EQUAL(graph.size(), actual->size());
+  EXPECT(!actual->back());
+  EXPECT(assert_equal(*expected, *actual));
+
+  // Serial fallback.
+  EXPECT(assert_equal(*expected, *ParallelLinearize(graph, values, nullptr)));
+}
+
+// Optimizing with linearization threads gives the same result.
+TEST(ParallelLinearize, Optimizer) {
+  auto robot = simple_rr::getRobot();
+  NonlinearFactorGraph graph = example::Trajectory(robot);
+  const Values init = ZeroValuesTrajectory(robot, example::num_steps, -1, 0.1);
+
+  OptimizationParameters parameters;
+  parameters.lm_parameters.setMaxIterations(3);
+  const Values expected = Optimizer(parameters).optimize(graph, init);
+  parameters.num_threads = 4;
+  OptimizerProfile profile;
+  const Values actual = Optimizer(parameters).optimize(graph, init, &profile);
+  EXPECT(assert_equal(expected, actual));
+  EXPECT(profile.num_linearizations > 0);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPathRetiming.cpp
+ * @brief Test time-optimal retiming of paths under joint limits.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <limits>
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/PathRetiming.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::Matrix;
+using gtsam::Vector;
+
+namespace example {
+const double inf = std::numeric_limits<double>::infinity();
+
+// Straight line in joint space from 0 to `end`.
+Matrix Line(const Vector &end, size_t N) {
+  Matrix Q(N, end.size());
+  for (size_t i = 0; i < N; ++i)
+    Q.row(i) = end.transpose() * (double(i) / (N - 1));
+  return Q;
+}
+}  // namespace example
+
+// With velocity limits only, the path runs at the limit of the fastest joint.
+TEST(PathRetiming, velocity_limits) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  PathRetimingParameters parameters;
+  const size_t J = 2;
+  parameters.torque_limits = Vector::Constant(J, example::inf);
+  parameters.acceleration_limits = Vector::Constant(J, 1e6);
+  parameters.velocity_limits = Vector::Constant(J, 2);
+  PathRetiming retiming(robot, parameters);
+  EXPECT_LONGS_EQUAL(J, retiming.numJointSlots());
+
+  const Matrix Q = example::Line(gtsam::Vector2(1, -0.5), 1001);
+  const PathRetimingResult result = retiming.retime(Q);
+  EXPECT_DOUBLES_EQUAL(0, result.speeds(0), 1e-9);
+  EXPECT_DOUBLES_EQUAL(0, result.speeds(1000), 1e-9);
+  EXPECT_DOUBLES_EQUAL(2, result.speeds(500), 1e-6);
+  EXPECT_DOUBLES_EQUAL(0.5, result.duration(), 1e-2);
+  EXPECT(result.V.cwiseAbs().maxCoeff() <= 2 + 1e-6);
+}
+
+// Torque limits slow the path down, and bound the retimed torques.
+TEST(PathRetiming, torque_limits) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const size_t N = 201;
+  const Matrix Q = example::Line(gtsam::Vector2(1, 1), N);
+  PathRetimingParameters parameters;
+  PathRetiming unlimited(robot, parameters);
+  const PathRetimingResult fast = unlimited.retime(Q);
+
+  // Limits halfway between the static torques and those of the fast timing.
+  BatchInverseDynamics dynamics(robot, parameters.gravity);
+  const Matrix statics = dynamics.torques(Q, Matrix::Zero(N, 2),
+                                          Matrix::Zero(N, 2));
+  parameters.torque_limits.resize(2);
+  for (size_t j = 0; j < 2; ++j)
+    parameters.torque_limits(j) =
+        0.5 * (statics.col(j).cwiseAbs().maxCoeff() +
+               fast.torques.col(j).cwiseAbs().maxCoeff());
+
+  PathRetiming limited(robot, parameters);
+  const PathRetimingResult slow = limited.retime(Q);
+  EXPECT(slow.duration() > fast.duration());
+  for (size_t i = 1; i < N; ++i) EXPECT(slow.times(i) > slow.times(i - 1));
+  for (size_t j = 0; j < 2; ++j)
+    EXPECT(slow.torques.col(j).head(N - 1).cwiseAbs().maxCoeff() <=
+           parameters.torque_limits(j) + 1e-6);
+}
+
+TEST(PathRetiming, exceptions) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  PathRetimingParameters parameters;
+  parameters.torque_limits = Vector::Zero(5);
+  CHECK_EXCEPTION(PathRetiming(robot, parameters), std::invalid_argument);
+  PathRetiming retiming(robot);
+  CHECK_EXCEPTION(retiming.retime(Matrix::Zero(1, 2)), std::invalid_argument);
+  CHECK_EXCEPTION(retiming.retime(Matrix::Zero(10, 3)),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
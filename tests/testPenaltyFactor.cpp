@@ -0,0 +1,70 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPenaltyFactor.cpp
+ * @brief Test penalty factors against EqualityConstraint::createFactor.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+
+#include "constrainedExample.h"
+#include "gtdynamics/optimizer/EqualityConstraint.h"
+#include "gtdynamics/optimizer/PenaltyFactor.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Compare a penalty factor with the factor createFactor(mu, bias) returns.
+static bool AgreesWithCreateFactor(const EqualityConstraint &constraint,
+                                   double mu, gtsam::Vector bias,
+                                   const Values &values) {
+  PenaltyFactor penalty(constraint);
+  penalty.setMu(mu);
+  penalty.setBias(bias);
+  const auto expected = constraint.createFactor(mu, bias);
+
+  bool agrees = penalty.keys() == expected->keys();
+  agrees &= std::abs(expected->error(values) - penalty.error(values)) < 1e-9;
+  const auto expected_linear = expected->linearize(values)->jacobian();
+  const auto actual_linear = penalty.linearize(values)->jacobian();
+  agrees &= assert_equal(expected_linear.first, actual_linear.first, 1e-9);
+  agrees &= assert_equal(expected_linear.second, actual_linear.second, 1e-9);
+  return agrees;
+}
+
+TEST(PenaltyFactor, Double) {
+  using namespace constrained_example;
+  DoubleExpressionEquality constraint(x1 + pow(x1, 3) + x2 + pow(x2, 2), 0.1);
+  Values values;
+  values.insert(x1_key, 0.3);
+  values.insert(x2_key, -0.7);
+  EXPECT(AgreesWithCreateFactor(constraint, 1.0, gtsam::Vector1(0.0), values));
+  EXPECT(AgreesWithCreateFactor(constraint, 8.0, gtsam::Vector1(0.2), values));
+}
+
+TEST(PenaltyFactor, Vector) {
+  using namespace constrained_example;
+  Vector2_ x1_vec_expr(x1_key), x2_vec_expr(x2_key);
+  VectorExpressionEquality<2> constraint(x1_vec_expr + x2_vec_expr,
+                                         gtsam::Vector2(0.1, 1.0));
+  Values values;
+  values.insert(x1_key, gtsam::Vector2(0.3, 2.0));
+  values.insert(x2_key, gtsam::Vector2(-0.7, 1.5));
+  EXPECT(AgreesWithCreateFactor(constraint, 4.0, gtsam::Vector2(0.5, -1.0),
+                                values));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
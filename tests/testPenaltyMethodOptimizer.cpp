@@ -57,6 +57,47 @@ TEST(PenaltyMethodOptimizer, ConstrainedExample) {
   EXPECT(assert_equal(gt_results, results, tol));
 }
 
+// Adaptive schedules stop once feasible and skip useless mu increases.
+TEST(PenaltyMethodOptimizer, AdaptiveSchedule) {
+  using namespace constrained_example;
+
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 1.0);
+
+  Values init_values;
+  init_values.insert(x1_key, -0.2);
+  init_values.insert(x2_key, -0.2);
+
+  PenaltyMethodParameters params;
+  params.num_iterations = 30;
+  params.feasibility_tolerance = 1e-3;
+  params.progress_ratio = 0.5;
+  params.inner_tolerance_factor = 1e-2;
+  ConstrainedOptResult result;
+  const Values results = PenaltyMethodOptimizer(params).optimize(
+      graph, constraints, init_values, &result);
+
+  EXPECT(result.intermediate_values.size() < params.num_iterations);
+  EXPECT(result.violation <= params.feasibility_tolerance);
+  Values gt_results;
+  gt_results.insert(x1_key, 0.0);
+  gt_results.insert(x2_key, 0.0);
+  EXPECT(assert_equal(gt_results, results, 1e-2));
+
+  // mu is non-decreasing, and grows by the given rate when it grows.
+  double mu = params.initial_mu;
+  for (const double next : result.mu_values) {
+    EXPECT(next == mu || next == mu * params.mu_increase_rate);
+    mu = next;
+  }
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,76 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPersistentLMSolver.cpp
+ * @brief Test reuse of the LM setup across solves.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Symbol.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include "gtdynamics/optimizer/PersistentLMSolver.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace example {
+using symbol_shorthand::X;
+
+// Chain of n values with a prior on the first one at `start`.
+NonlinearFactorGraph Chain(size_t n, double start) {
+  NonlinearFactorGraph graph;
+  auto model = noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.emplace_shared<PriorFactor<double>>(X(0), start, model);
+  for (size_t i = 0; i + 1 < n; i++)
+    graph.emplace_shared<BetweenFactor<double>>(X(i), X(i + 1), 1.0, model);
+  return graph;
+}
+
+Values Initial(size_t n) {
+  Values values;
+  for (size_t i = 0; i < n; i++) values.insert(X(i), 0.0);
+  return values;
+}
+}  // namespace example
+
+TEST(PersistentLMSolver, reuse) {
+  OptimizationParameters parameters;
+  parameters.lm_parameters = LevenbergMarquardtParams();
+  parameters.num_threads = 2;
+  PersistentLMSolver solver(parameters);
+
+  // Same structure, different measurements: one rebuild.
+  for (double start : {0.0, 1.0, 2.0}) {
+    const NonlinearFactorGraph graph = example::Chain(5, start);
+    const Values expected = LevenbergMarquardtOptimizer(
+        graph, example::Initial(5), parameters.lm_parameters).optimize();
+    const Values actual = solver.optimize(graph, example::Initial(5));
+    EXPECT(assert_equal(expected, actual, 1e-6));
+    EXPECT_DOUBLES_EQUAL(start + 4.0, actual.at<double>(example::X(4)), 1e-6);
+  }
+  EXPECT_LONGS_EQUAL(1, solver.numRebuilds());
+  EXPECT_LONGS_EQUAL(5, solver.ordering().size());
+
+  // A longer chain changes the structure.
+  solver.optimize(example::Chain(6, 0.0), example::Initial(6));
+  EXPECT_LONGS_EQUAL(2, solver.numRebuilds());
+  EXPECT_LONGS_EQUAL(6, solver.ordering().size());
+
+  solver.reset();
+  solver.optimize(example::Chain(6, 0.0), example::Initial(6));
+  EXPECT_LONGS_EQUAL(3, solver.numRebuilds());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -37,6 +37,9 @@ TEST(Phase, All) {
 
   Point3 cp = phase1_foot_constraint->contactPoint("tarsus_3_L3");
   EXPECT(assert_equal(contact_in_com, cp));
+  const DynamicsIndex id = robot.linkId("tarsus_3_L3");
+  EXPECT(
+      assert_equal(contact_in_com, phase1_foot_constraint->contactPoint(id)));
 
   PointOnLinks cps = phase1_foot_constraint->contactPoints();
   EXPECT_LONGS_EQUAL(3, cps.size());
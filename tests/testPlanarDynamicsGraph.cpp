@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPlanarDynamicsGraph.cpp
+ * @brief Test dynamics graphs of planar robots with SE(2) variables.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/linear/NoiseModel.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/PlanarDynamicsGraph.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Pose2;
+using gtsam::Values;
+using gtsam::Vector3;
+
+namespace example {
+const Vector3 planar_axis(1, 0, 0);
+const Vector3 gravity(0, 0, -9.8);
+const auto prior_model = gtsam::noiseModel::Isotropic::Sigma(1, 1e-5);
+}  // namespace example
+
+// Planar inverse dynamics should agree with the SE(3) graph.
+TEST(PlanarDynamicsGraph, inverse_dynamics) {
+  const Robot robot = simple_urdf::getRobot();
+  const int j = robot.joint("j1")->id();
+  const size_t t = 2;
+
+  Values values;
+  InsertJointAngle(&values, j, t, 0.7);
+  InsertJointVel(&values, j, t, 1.5);
+  Values known = robot.forwardKinematics(values, t);
+  InsertJointAccel(&known, j, t, -2.0);
+  DynamicsGraph graph_builder(example::gravity, example::planar_axis);
+  const Values expected = graph_builder.linearSolveID(robot, t, known);
+
+  const PlanarDynamicsGraph planar(robot, example::planar_axis,
+                                   example::gravity);
+  auto graph = planar.dynamicsFactorGraph(t);
+  graph.addPrior(internal::JointAngleKey(j, t), 0.7, example::prior_model);
+  graph.addPrior(internal::JointVelKey(j, t), 1.5, example::prior_model);
+  graph.addPrior(internal::JointAccelKey(j, t), -2.0, example::prior_model);
+  gtsam::LevenbergMarquardtOptimizer optimizer(graph, planar.zeroValues(t));
+  const Values result = optimizer.optimize();
+
+  EXPECT(assert_equal(Torque(expected, j, t), Torque(result, j, t), 1e-4));
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(planar.project(Pose(known, i, t)),
+                        result.at<Pose2>(internal::PoseKey(i, t)), 1e-4));
+    EXPECT(assert_equal(planar.project(Twist(known, i, t)),
+                        result.at<Vector3>(internal::TwistKey(i, t)), 1e-4));
+  }
+
+  // Fewer and smaller variables and factors than the SE(3) graph.
+  const auto full = graph_builder.dynamicsFactorGraph(robot, t);
+  EXPECT(graph.size() < full.size());
+  const size_t L = robot.numLinks(), J = robot.numJoints();
+  EXPECT_LONGS_EQUAL(9 * L + 7 * J, planar.zeroValues(t).dim());
+}
+
+TEST(PlanarDynamicsGraph, projection) {
+  const PlanarDynamicsGraph planar(simple_urdf::getRobot(),
+                                   example::planar_axis);
+  const gtsam::Pose3 pose(gtsam::Rot3::Rx(0.3), gtsam::Point3(5, 1, 2));
+  // The plane x = 0 is spanned by y and z.
+  EXPECT(assert_equal(Pose2(1, 2, 0.3), planar.project(pose), 1e-9));
+  gtsam::Vector6 twist;
+  twist << 0.4, 0, 0, 7, 0.5, 0.6;
+  EXPECT(assert_equal(Vector3(0.5, 0.6, 0.4), planar.project(twist), 1e-9));
+}
+
+TEST(PlanarDynamicsGraph, exceptions) {
+  const Robot robot = simple_urdf::getRobot();
+  CHECK_EXCEPTION(PlanarDynamicsGraph(robot, Vector3::Zero()),
+                  std::invalid_argument);
+  // The joint rotates about x, not in the plane z = 0.
+  CHECK_EXCEPTION(PlanarDynamicsGraph(robot, Vector3(0, 0, 1)),
+                  std::invalid_argument);
+  const PlanarDynamicsGraph planar(robot, example::planar_axis);
+  CHECK_EXCEPTION(planar.joint(42), std::out_of_range);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,83 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPlanningService.cpp
+ * @brief Test batching planning requests in a long-running service.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <future>
+#include <vector>
+
+#include "contactGoalsExample.h"
+#include "gtdynamics/dynamics/PlanningService.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+
+// Concurrent inverse kinematics requests are batched and solved.
+TEST(PlanningService, InverseKinematics) {
+  using namespace contact_goals_example;
+  PlanningServiceParameters parameters;
+  parameters.num_threads = 2;
+  parameters.kinematics_parameters.method =
+      OptimizationParameters::Method::AUGMENTED_LAGRANGIAN;
+  PlanningService service(parameters);
+  service.addRobot("vision60", robot);
+
+  std::vector<std::future<PlanningResult>> futures;
+  for (double dz : {-0.02, 0.0, 0.02}) {
+    std::vector<PointGoal> goals;
+    for (const ContactGoal &goal : contact_goals)
+      goals.push_back({goal.link()->name(), goal.contactInCoM(),
+                       goal.goal_point + Point3(0, 0, dz)});
+    futures.push_back(service.inverseKinematics("vision60", goals));
+  }
+  futures.push_back(service.inverseKinematics("unknown", {}));
+
+  for (size_t q = 0; q < 3; ++q) {
+    const PlanningResult result = futures[q].get();
+    EXPECT(result.status == PlanningResult::Status::Solved);
+    EXPECT(result.converged);
+    EXPECT(result.queue_seconds >= 0 && result.solve_seconds > 0);
+    const double dz = -0.02 + 0.02 * q;
+    for (const ContactGoal &goal : contact_goals)
+      EXPECT(ContactGoal(goal.point_on_link, goal.goal_point + Point3(0, 0, dz))
+                 .satisfied(result.values, 0, 1e-5));
+  }
+  const PlanningResult unknown = futures[3].get();
+  EXPECT(unknown.status == PlanningResult::Status::Failed);
+  EXPECT(!unknown.message.empty());
+
+  const PlanningServiceStats stats = service.stats();
+  EXPECT_LONGS_EQUAL(4, stats.accepted);
+  EXPECT_LONGS_EQUAL(3, stats.solved);
+  EXPECT_LONGS_EQUAL(1, stats.failed);
+  EXPECT(stats.batches >= 1 && stats.batches <= 4);
+  EXPECT(stats.max_latency >= stats.mean_latency && stats.mean_latency > 0);
+}
+
+// Requests beyond max_pending are rejected right away.
+TEST(PlanningService, Admission) {
+  PlanningServiceParameters parameters;
+  parameters.num_threads = 1;
+  parameters.max_pending = 0;
+  PlanningService service(parameters);
+  service.addRobot("vision60", contact_goals_example::robot);
+  const PlanningResult result =
+      service.statics("vision60", gtsam::Values()).get();
+  EXPECT(result.status == PlanningResult::Status::Rejected);
+  EXPECT_LONGS_EQUAL(1, service.stats().rejected);
+  EXPECT_LONGS_EQUAL(0, service.stats().accepted);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
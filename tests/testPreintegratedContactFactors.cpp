@@ -23,8 +23,10 @@
 #include <math.h>
 
 #include <iostream>
+#include <vector>
 
 #include "gtdynamics/factors/PreintegratedContactFactors.h"
+#include "gtdynamics/utils/ThreadPool.h"
 
 using namespace gtdynamics;
 using namespace gtsam;
@@ -218,6 +220,126 @@ TEST(PreintegratedRigidContactFactor, Jacobians) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
 }
 
+/* ************************************************************************* */
+// A stance phase with a rotating base and contact frame.
+static void StancePhase(size_t n, std::vector<Pose3> *base_poses,
+                        std::vector<Pose3> *contact_poses,
+                        std::vector<double> *dts) {
+  for (size_t k = 0; k < n; k++) {
+    base_poses->emplace_back(Rot3::Ypr(0.1 * k, 0.05 * k, 0.2),
+                             Vector3(0.01 * k, 0, 0.5));
+    contact_poses->emplace_back(Rot3::Ypr(0.3, -0.02 * k, 0.1 * k),
+                                Vector3(0.2, 0.1, 0));
+    dts->push_back(0.01 + 0.001 * k);
+  }
+}
+
+// Sequential preintegration over steps [begin, end).
+static Matrix3 Sequential(const std::vector<Pose3> &base_poses,
+                          const std::vector<Pose3> &contact_poses,
+                          const std::vector<double> &dts, const Matrix3 &cov,
+                          size_t begin, size_t end) {
+  PreintegratedPointContactMeasurements pcm(
+      base_poses[begin], contact_poses[begin], dts[begin], cov);
+  for (size_t k = begin + 1; k < end; k++) {
+    const Rot3 deltaRik =
+        base_poses[begin].rotation().inverse() * base_poses[k].rotation();
+    pcm.integrateMeasurement(deltaRik,
+                             base_poses[k].inverse() * contact_poses[k],
+                             dts[k]);
+  }
+  return pcm.preintMeasCov();
+}
+
+/* ************************************************************************* */
+// Batched preintegration of a whole phase equals integrating step by step.
+TEST(PreintegratedPointContactMeasurements, Batch) {
+  std::vector<Pose3> base_poses, contact_poses;
+  std::vector<double> dts;
+  StancePhase(20, &base_poses, &contact_poses, &dts);
+
+  Matrix3 cov = I_3x3;
+  cov(0, 0) = 2.0;
+  cov(0, 1) = cov(1, 0) = 0.3;
+  for (const Matrix3 &vdCov : {Matrix3(I_3x3 * 0.5), cov}) {
+    PreintegratedPointContactMeasurements pcm(base_poses, contact_poses, dts,
+                                              vdCov);
+    EXPECT(assert_equal<Matrix3>(
+        Sequential(base_poses, contact_poses, dts, vdCov, 0, dts.size()),
+        pcm.preintMeasCov(), 1e-12));
+  }
+
+  dts.pop_back();
+  THROWS_EXCEPTION(
+      PreintegratedPointContactMeasurements(base_poses, contact_poses, dts,
+                                            cov));
+}
+
+/* ************************************************************************* */
+// Feet preintegrated on a pool equal feet preintegrated one by one.
+TEST(PreintegratedPointContactMeasurements, Feet) {
+  std::vector<Pose3> base_poses, contact_poses;
+  std::vector<double> dts;
+  StancePhase(10, &base_poses, &contact_poses, &dts);
+  std::vector<std::vector<Pose3>> feet(4);
+  for (size_t foot = 0; foot < feet.size(); foot++)
+    for (auto &&wTc : contact_poses)
+      feet[foot].push_back(wTc * Pose3(Rot3::Rz(0.5 * foot), Point3()));
+  Matrix3 cov = I_3x3;
+  cov(2, 2) = 3.0;
+
+  ThreadPool pool(2);
+  const auto measurements =
+      PreintegratePointContacts(base_poses, feet, dts, cov, &pool);
+  EXPECT_LONGS_EQUAL(feet.size(), measurements.size());
+  for (size_t foot = 0; foot < feet.size(); foot++) {
+    PreintegratedPointContactMeasurements expected(base_poses, feet[foot],
+                                                   dts, cov);
+    EXPECT(assert_equal<Matrix3>(expected.preintMeasCov(),
+                                 measurements[foot].preintMeasCov()));
+  }
+}
+
+/* ************************************************************************* */
+// A sliding window equals preintegrating the last steps from scratch.
+TEST(PointContactWindow, Slide) {
+  std::vector<Pose3> base_poses, contact_poses;
+  std::vector<double> dts;
+  StancePhase(25, &base_poses, &contact_poses, &dts);
+  Matrix3 cov = I_3x3;
+  cov(1, 1) = 0.2;
+  cov(1, 2) = cov(2, 1) = 0.1;
+
+  const size_t window_size = 6;
+  PointContactWindow window(window_size, cov);
+  THROWS_EXCEPTION(window.measurements());
+  for (size_t k = 0; k < dts.size(); k++) {
+    window.push(base_poses[k], contact_poses[k], dts[k]);
+    const size_t begin = k + 1 > window_size ? k + 1 - window_size : 0;
+    EXPECT_LONGS_EQUAL(k + 1 - begin, window.size());
+    EXPECT(assert_equal<Matrix3>(
+        Sequential(base_poses, contact_poses, dts, cov, begin, k + 1),
+        window.measurements().preintMeasCov(), 1e-12));
+  }
+}
+
+/* ************************************************************************* */
+// Batched rigid preintegration equals integrating step by step.
+TEST(PreintegratedRigidContactMeasurements, IntegrateMeasurementsBatch) {
+  const std::vector<Matrix3> wCovs = {I_3x3 * 0.05, I_3x3 * 0.06,
+                                      I_3x3 * 0.02};
+  const std::vector<Matrix3> vCovs = {I_3x3 * 0.01, I_3x3 * 0.02,
+                                      I_3x3 * 0.03};
+  const std::vector<double> dts = {0.01, 0.02, 0.01};
+  PreintegratedRigidContactMeasurements expected(I_3x3, I_3x3),
+      actual(I_3x3, I_3x3);
+  for (size_t k = 0; k < dts.size(); k++)
+    expected.integrateMeasurement(wCovs[k], vCovs[k], dts[k]);
+  actual.integrateMeasurements(wCovs, vCovs, dts);
+  EXPECT(assert_equal<Matrix6>(expected.preintMeasCov(),
+                               actual.preintMeasCov()));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testPrioritizedKinematics.cpp
+ * @brief Test strict-priority least squares and inverse kinematics.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/kinematics/PrioritizedKinematics.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+TEST(PrioritizedLeastSquares, Priorities) {
+  // x0 + x1 = 1 first, then x0 = 3, then x1 = 0, which conflicts.
+  Matrix A0(1, 3), A1(1, 3), A2(1, 3);
+  A0 << 1, 1, 0;
+  A1 << 1, 0, 0;
+  A2 << 0, 1, 0;
+  const Vector b0 = (Vector(1) << 1).finished(),
+               b1 = (Vector(1) << 3).finished(), b2 = Vector::Zero(1);
+  PrioritizedLeastSquares solver(3);
+  EXPECT(assert_equal((Vector(3) << 3, -2, 0).finished(),
+                      solver.solve({A0, A1, A2}, {b0, b1, b2}), 1e-9));
+
+  // The other way around, x1 = 0 wins.
+  EXPECT(assert_equal((Vector(3) << 1, 0, 0).finished(),
+                      solver.solve({A2, A0}, {b2, b0}), 1e-9));
+
+  CHECK_EXCEPTION(solver.solve({A0}, {}), std::invalid_argument);
+  CHECK_EXCEPTION(solver.solve({Matrix::Ones(1, 2)}, {b0}),
+                  std::invalid_argument);
+}
+
+TEST(PrioritizedInverseKinematics, PointAndJointGoals) {
+  const Robot robot = simple_rr::getRobot();
+  const int j1 = robot.joint("joint_1")->id(),
+            j2 = robot.joint("joint_2")->id();
+  const LinkSharedPtr end_link = robot.link("link_2");
+  const Point3 point(0, 0, 0.1);
+
+  // A reachable goal, from the forward kinematics of some angles.
+  const CompiledRobot compiled(robot);
+  Vector q_goal = Vector::Zero(compiled.numJointSlots());
+  q_goal(j1) = 0.3;
+  q_goal(j2) = -0.5;
+  std::vector<Pose3> poses;
+  compiled.forwardKinematics(q_goal, &poses);
+  const Point3 goal = poses[end_link->id()].transformFrom(point);
+
+  PriorityLevel point_level, joint_level;
+  point_level.point_goals.emplace_back(PointOnLink(end_link, point), goal);
+  joint_level.joint_goals = {{j1, 0.0}, {j2, 0.0}};
+
+  // The point goal first: it is reached, the joint goals are not.
+  PrioritizedInverseKinematics ik(robot, {point_level, joint_level});
+  Vector q = Vector::Zero(compiled.numJointSlots());
+  q(j1) = 0.1;
+  q(j2) = -0.1;
+  auto result = ik.solve(&q, &poses);
+  EXPECT(result.converged);
+  EXPECT_LONGS_EQUAL(2, result.level_errors.size());
+  EXPECT_DOUBLES_EQUAL(0, result.level_errors(0), 1e-8);
+  EXPECT(result.level_errors(1) > 0.1);
+  EXPECT(assert_equal(goal, poses[end_link->id()].transformFrom(point), 1e-8));
+
+  // The joint goals first: they are reached exactly.
+  ik.setLevels({joint_level, point_level});
+  result = ik.solve(&q, &poses);
+  EXPECT(result.converged);
+  EXPECT_DOUBLES_EQUAL(0, result.level_errors(0), 1e-12);
+  EXPECT(assert_equal(Vector::Zero(q.size()).eval(), q, 1e-12));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -14,6 +14,7 @@
 #include <CppUnitLite/TestHarness.h>
 #include <gtsam/base/Testable.h>
 #include <gtsam/base/TestableAssertions.h>
+#include <gtsam/base/numericalDerivative.h>
 #include <gtsam/base/serializationTestHelpers.h>
 
 #include "gtdynamics/universal_robot/Link.h"
@@ -102,6 +103,28 @@ TEST(Joint, params_constructor_prismatic) {
                       j1->parameters().scalar_limits.value_limit_threshold));
 }
 
+// The closed-form translation agrees with the exponential map.
+TEST(PrismaticJoint, ClosedForm) {
+  auto robot = simple_urdf_prismatic::getRobot();
+  auto l1 = robot.link("l1");
+  auto l2 = robot.link("l2");
+  PrismaticJoint j1(1, "j1", Pose3(Rot3::Rx(0.3), Point3(0, 0, 2)), l1, l2,
+                    gtsam::Vector3(0, 0.6, 0.8));
+
+  const double q = 0.7;
+  const Pose3 pTc = j1.pMc() * Pose3::Expmap(j1.cScrewAxis() * q);
+  gtsam::Matrix61 H_pTc, H_cTp;
+  EXPECT(assert_equal(pTc, j1.relativePoseOf(l2, q, H_pTc), 1e-9));
+  EXPECT(assert_equal(pTc.inverse(), j1.relativePoseOf(l1, q, H_cTp), 1e-9));
+
+  auto f1 = [&](double q) { return j1.relativePoseOf(l2, q); };
+  auto f2 = [&](double q) { return j1.relativePoseOf(l1, q); };
+  EXPECT(assert_equal(gtsam::numericalDerivative11<Pose3, double>(f1, q),
+                      H_pTc, 1e-7));
+  EXPECT(assert_equal(gtsam::numericalDerivative11<Pose3, double>(f2, q),
+                      H_cTp, 1e-7));
+}
+
 BOOST_CLASS_EXPORT(gtdynamics::PrismaticJoint)
 
 TEST(PrismaticJoint, Serialization) {
@@ -0,0 +1,124 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testReachabilityMap.cpp
+ * @brief Test reachability maps against forward kinematics.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "gtdynamics/kinematics/ReachabilityMap.h"
+#include "gtdynamics/universal_robot/BatchForwardKinematics.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace example {
+const Robot robot = simple_rr::getRobot();
+const int ee = robot.link("link_2")->id();
+
+ReachabilityMapParameters Parameters() {
+  ReachabilityMapParameters parameters;
+  parameters.lower = Point3(-2, -2, -2);
+  parameters.upper = Point3(2, 2, 2);
+  parameters.resolution = 0.25;
+  parameters.rotation_bins = 4;
+  parameters.num_samples = 20000;
+  return parameters;
+}
+
+const ReachabilityMap map =
+    ReachabilityMap::Compute(robot, "link_2", Parameters());
+
+// End-effector pose of a joint configuration.
+Pose3 EndEffectorPose(const gtsam::Vector &q) {
+  const PoseBatch poses =
+      BatchForwardKinematics(robot).compute(q.transpose());
+  return poses.pose(0, ee);
+}
+}  // namespace example
+
+/// The poses of configurations within the joint limits are reachable, and
+/// the seed reaches the same cell.
+TEST(ReachabilityMap, reachable) {
+  using namespace example;
+  EXPECT(map.numReachable() > 0);
+  EXPECT_LONGS_EQUAL(2, map.numJointSlots());
+  EXPECT_LONGS_EQUAL(16 * 16 * 16 * 4 * 4 * 4, map.numCells());
+
+  for (double q1 : {-1.2, 0.0, 0.7})
+    for (double q2 : {-0.9, 0.3, 1.4}) {
+      const Pose3 pose = EndEffectorPose(gtsam::Vector2(q1, q2));
+      EXPECT(map.cell(pose) >= 0);
+      EXPECT(map.reachable(pose));
+      EXPECT(map.count(pose) > 0);
+      EXPECT(map.reachabilityIndex(pose.translation()) > 0);
+      const auto seed = map.seed(pose);
+      CHECK(seed);
+      EXPECT_LONGS_EQUAL(map.cell(pose), map.cell(EndEffectorPose(*seed)));
+    }
+}
+
+/// Poses outside the workspace or out of reach have no seed.
+TEST(ReachabilityMap, unreachable) {
+  using namespace example;
+  const Pose3 outside(gtsam::Rot3(), Point3(5, 0, 0));
+  EXPECT_LONGS_EQUAL(-1, map.cell(outside));
+  EXPECT(!map.reachable(outside));
+  EXPECT(!map.seed(outside));
+
+  // The end effector stays within 1.2m of the base.
+  const Pose3 far(gtsam::Rot3(), Point3(1.9, 1.9, -1.9));
+  EXPECT(map.cell(far) >= 0);
+  EXPECT(!map.reachable(far));
+  EXPECT_LONGS_EQUAL(0, map.count(far));
+  EXPECT_DOUBLES_EQUAL(0, map.reachabilityIndex(far.translation()), 0);
+
+  ReachabilityMapParameters parameters = Parameters();
+  parameters.resolution = 0;
+  CHECK_EXCEPTION(ReachabilityMap::Compute(robot, "link_2", parameters),
+                  std::invalid_argument);
+}
+
+/// A written map maps back into memory with the same tables.
+TEST(ReachabilityMap, MemoryMapped) {
+  using namespace example;
+  const std::string filename = "reachability_map_test.bin";
+  map.write(filename);
+  const ReachabilityMap mapped = ReachabilityMap::MemoryMapped(filename);
+  EXPECT_LONGS_EQUAL(map.numCells(), mapped.numCells());
+  EXPECT_LONGS_EQUAL(map.numReachable(), mapped.numReachable());
+  const Pose3 pose = EndEffectorPose(gtsam::Vector2(0.4, -0.6));
+  EXPECT_LONGS_EQUAL(map.count(pose), mapped.count(pose));
+  EXPECT(assert_equal(*map.seed(pose), *mapped.seed(pose)));
+  std::remove(filename.c_str());
+
+  {
+    std::ofstream os(filename, std::ios::binary);
+    os << "not a reachability map, but long enough for its header......"
+       << "................................................................";
+  }
+  CHECK_EXCEPTION(ReachabilityMap::MemoryMapped(filename),
+                  std::invalid_argument);
+  std::remove(filename.c_str());
+  CHECK_EXCEPTION(ReachabilityMap::MemoryMapped(filename), std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,205 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRealTimeRobot.cpp
+ * @brief Test the real-time API against the allocating one, and that its hot
+ * calls do not allocate.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "gtdynamics/dynamics/RealTimeRobot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/AllocationTracker.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Vector;
+using gtsam::Vector3;
+
+// Calls to malloc while counting. AllocationScope only sees operator new,
+// and only when compiled in, but Eigen allocates with malloc: on glibc, the
+// malloc of this executable replaces that of the libraries and counts both.
+namespace {
+bool counting = false;
+size_t mallocs = 0;
+}  // namespace
+
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *p, size_t size);
+
+void *malloc(size_t size) noexcept {
+  if (counting) ++mallocs;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) noexcept {
+  if (counting) ++mallocs;
+  return __libc_calloc(n, size);
+}
+
+void *realloc(void *p, size_t size) noexcept {
+  if (counting) ++mallocs;
+  return __libc_realloc(p, size);
+}
+}
+#endif
+
+namespace example {
+const Vector3 gravity(0, 0, -9.8);
+
+// Number of heap allocations of f.
+template <typename F>
+size_t Allocations(F &&f) {
+  const AllocationScope scope;
+  mallocs = 0;
+  counting = true;
+  f();
+  counting = false;
+  return mallocs + scope.stats().allocations;
+}
+}  // namespace example
+
+/// The real-time calls agree with CompiledRobot, RecursiveDynamics and the
+/// ArticulatedBody Simulator.
+TEST(RealTimeRobot, agrees) {
+  using example::gravity;
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  RealTimeRobot rt(robot, gravity);
+  const size_t n = rt.numJointSlots();
+  const Vector q = Vector::Random(n), v = Vector::Random(n),
+               a = Vector::Random(n);
+  const int ee = robot.link("link_2")->id();
+
+  const CompiledRobot compiled(robot);
+  std::vector<Pose3> poses;
+  Matrix twists, expected_J, J(6, n);
+  compiled.forwardKinematics(q, v, &poses, &twists);
+  EXPECT(rt.forwardKinematics(q, v));
+  EXPECT(assert_equal(poses[ee], rt.poses()[ee]));
+  EXPECT(assert_equal(twists, rt.twists()));
+  compiled.bodyJacobian(poses, ee, &expected_J);
+  EXPECT(rt.bodyJacobian(ee, &J));
+  EXPECT(assert_equal(expected_J, J));
+  compiled.spatialJacobian(poses, ee, &expected_J);
+  EXPECT(rt.spatialJacobian(ee, &J));
+  EXPECT(assert_equal(expected_J, J));
+
+  RecursiveDynamics dynamics(robot, gravity);
+  RecursiveDynamicsResult expected;
+  dynamics.allocate(&expected);
+  dynamics.inverseDynamics(q, v, a, &expected);
+  EXPECT(rt.inverseDynamics(q, v, a));
+  EXPECT(assert_equal(expected.torques, rt.dynamics().torques));
+  const Vector tau = expected.torques;
+  EXPECT(rt.forwardDynamics(q, v, tau));
+  EXPECT(assert_equal(a, rt.dynamics().joint_accels, 1e-9));
+
+  for (auto scheme :
+       {ExplicitEuler, SemiImplicitEuler, RungeKutta4, Verlet}) {
+    Simulator simulator(robot, gtsam::Values(), gravity, boost::none,
+                        ArticulatedBody);
+    simulator.setIntegrationScheme(scheme);
+    simulator.setState(q, v);
+    rt.setIntegrationScheme(scheme);
+    EXPECT(rt.setState(q, v));
+    for (int k = 0; k < 5; ++k) {
+      simulator.step(tau, 0.01);
+      EXPECT(rt.step(tau, 0.01));
+    }
+    EXPECT(assert_equal(simulator.jointAngles(), rt.jointAngles(), 1e-9));
+    EXPECT(assert_equal(simulator.jointVels(), rt.jointVels(), 1e-9));
+  }
+}
+
+/// After construction, no hot call allocates, on a floating base with a
+/// contact as well.
+TEST(RealTimeRobot, noAllocation) {
+  const Robot robot = simple_rr::getRobot();
+  const auto base = robot.link("link_0");
+  RealTimeRobot rt(robot, example::gravity);
+  rt.enableContactEstimation(FootContactConstraintSpec(
+      std::vector<PointOnLink>{PointOnLink(base, Point3(0, 0, -0.1))}));
+
+  const size_t n = rt.numJointSlots();
+  const Vector q = Vector::Random(n), v = Vector::Random(n),
+               a = Vector::Random(n), tau = Vector::Random(n);
+  ContactWrenchMeasurement m;
+  m.q = q;
+  m.v = v;
+  m.tau = tau;
+  m.specific_force = -example::gravity;
+  Matrix J(6, n);
+  const gtsam::Vector6 twist = gtsam::Vector6::Constant(0.1);
+
+  const size_t allocations = example::Allocations([&]() {
+    for (int k = 0; k < 10; ++k) {
+      EXPECT(rt.setRootState(base->id(), Pose3(), twist));
+      EXPECT(rt.forwardKinematics(q));
+      EXPECT(rt.forwardKinematics(q, v));
+      EXPECT(rt.bodyJacobian(base->id(), &J));
+      EXPECT(rt.spatialJacobian(base->id(), &J));
+      EXPECT(rt.inverseDynamics(q, v, a));
+      EXPECT(rt.forwardDynamics(q, v, tau));
+      EXPECT(rt.estimateContactWrenches(m));
+      EXPECT(rt.setState(q, v));
+      for (auto scheme :
+           {ExplicitEuler, SemiImplicitEuler, RungeKutta4, Verlet}) {
+        rt.setIntegrationScheme(scheme);
+        EXPECT(rt.step(tau, 0.001));
+      }
+    }
+  });
+  EXPECT_LONGS_EQUAL(0, allocations);
+  EXPECT_LONGS_EQUAL(1, rt.contactWrenches().forces.cols());
+}
+
+/// Bad inputs are reported, without throwing or allocating.
+TEST(RealTimeRobot, badInputs) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  RealTimeRobot rt(robot, example::gravity);
+  const size_t n = rt.numJointSlots();
+  const Vector q = Vector::Zero(n), wrong = Vector::Zero(n + 1);
+  Matrix J(6, n), wrong_J(6, n + 1);
+  ContactWrenchMeasurement m;
+  m.q = m.v = m.tau = q;
+
+  const size_t allocations = example::Allocations([&]() {
+    EXPECT(!rt.forwardKinematics(wrong));
+    EXPECT(!rt.forwardKinematics(q, wrong));
+    EXPECT(rt.forwardKinematics(q));
+    EXPECT(!rt.bodyJacobian(-1, &J));
+    EXPECT(!rt.bodyJacobian(99, &J));
+    EXPECT(!rt.spatialJacobian(0, &wrong_J));
+    EXPECT(!rt.setRootState(0, Pose3(), gtsam::Vector6::Zero()));
+    EXPECT(!rt.inverseDynamics(q, q, wrong));
+    EXPECT(!rt.forwardDynamics(wrong, q, q));
+    EXPECT(!rt.estimateContactWrenches(m));
+    EXPECT(!rt.setState(q, wrong));
+    EXPECT(!rt.step(wrong, 0.01));
+    EXPECT(!rt.step(q, 0));
+    EXPECT(!rt.step(q, std::nan("")));
+  });
+  EXPECT_LONGS_EQUAL(0, allocations);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
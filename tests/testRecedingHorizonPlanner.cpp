@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRecedingHorizonPlanner.cpp
+ * @brief Test incremental receding-horizon optimization against batch.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/RecedingHorizonPlanner.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+// Forward dynamics objectives: torques at step t, and the start state at 0.
+static NonlinearFactorGraph Objectives(const Robot &robot,
+                                       const DynamicsGraph &graph_builder,
+                                       int t) {
+  NonlinearFactorGraph graph;
+  const auto &opt = graph_builder.opt();
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    graph.addPrior(internal::TorqueKey(j, t), 0.1 * (j + 1),
+                   opt.prior_t_cost_model);
+    if (t == 0) {
+      graph.addPrior(internal::JointAngleKey(j, 0), 0.0,
+                     opt.prior_q_cost_model);
+      graph.addPrior(internal::JointVelKey(j, 0), 0.0,
+                     opt.prior_qv_cost_model);
+    }
+  }
+  return graph;
+}
+
+// Batch solution of the trajectory over steps [0, num_steps].
+static Values Batch(const Robot &robot, const DynamicsGraph &graph_builder,
+                    int num_steps, double dt) {
+  NonlinearFactorGraph graph =
+      graph_builder.trajectoryFG(robot, num_steps, dt, Trapezoidal);
+  for (int t = 0; t <= num_steps; t++)
+    graph.add(Objectives(robot, graph_builder, t));
+  const Values init = ZeroValuesTrajectory(robot, num_steps);
+  return gtsam::LevenbergMarquardtOptimizer(graph, init).optimize();
+}
+
+TEST(RecedingHorizonPlanner, window) {
+  auto robot = simple_rr::getRobot();
+  DynamicsGraph graph_builder(gtsam::Vector3(0, 0, -9.8));
+  RecedingHorizonParameters parameters;
+  parameters.horizon = 5;
+  parameters.dt = 0.05;
+  const int H = parameters.horizon;
+  RecedingHorizonPlanner planner(robot, graph_builder, parameters);
+
+  NonlinearFactorGraph objectives;
+  for (int t = 0; t <= H; t++)
+    objectives.add(Objectives(robot, graph_builder, t));
+  planner.initialize(objectives, ZeroValuesTrajectory(robot, H));
+  planner.iterate(5);
+  EXPECT_LONGS_EQUAL(0, planner.firstStep());
+  EXPECT_LONGS_EQUAL(H, planner.lastStep());
+
+  const Values batch = Batch(robot, graph_builder, H, parameters.dt);
+  Values estimate = planner.estimate();
+  EXPECT(assert_equal(DynamicsGraph::jointAngles(robot, batch, H),
+                      DynamicsGraph::jointAngles(robot, estimate, H), 1e-3));
+
+  // Advance twice: the first steps are marginalized, and the window agrees
+  // with the batch solution over the whole trajectory.
+  for (int t = H + 1; t <= H + 2; t++) {
+    planner.advance(Objectives(robot, graph_builder, t));
+    planner.iterate(5);
+  }
+  EXPECT_LONGS_EQUAL(2, planner.firstStep());
+  EXPECT_LONGS_EQUAL(H + 2, planner.lastStep());
+
+  estimate = planner.estimate();
+  const int j = robot.joints()[0]->id();
+  EXPECT(!estimate.exists(internal::JointAngleKey(j, 1)));
+  EXPECT(estimate.exists(internal::JointAngleKey(j, 2)));
+
+  const Values full = Batch(robot, graph_builder, H + 2, parameters.dt);
+  for (int t = 2; t <= H + 2; t++) {
+    EXPECT(assert_equal(DynamicsGraph::jointAngles(robot, full, t),
+                        DynamicsGraph::jointAngles(robot, estimate, t), 1e-3));
+    EXPECT(assert_equal(DynamicsGraph::jointVels(robot, full, t),
+                        DynamicsGraph::jointVels(robot, estimate, t), 1e-3));
+  }
+}
+
+TEST(RecedingHorizonPlanner, outside_window) {
+  auto robot = simple_rr::getRobot();
+  DynamicsGraph graph_builder;
+  RecedingHorizonParameters parameters;
+  parameters.horizon = 2;
+  RecedingHorizonPlanner planner(robot, graph_builder, parameters);
+  CHECK_EXCEPTION(planner.initialize(NonlinearFactorGraph(),
+                                     ZeroValuesTrajectory(robot, 3)),
+                  std::invalid_argument);
+
+  parameters.horizon = 0;
+  CHECK_EXCEPTION(
+      RecedingHorizonPlanner empty(robot, graph_builder, parameters),
+      std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
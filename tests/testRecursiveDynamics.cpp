@@ -0,0 +1,308 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRecursiveDynamics.cpp
+ * @brief Test recursive dynamics against the linear dynamics factor graph.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <Eigen/Cholesky>
+#include <Eigen/LU>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/Robot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+// Check that accelerations and wrenches agree with linearSolveFD.
+static bool AgreesWithLinearSolveFD(const Robot &robot,
+                                    const gtsam::Vector3 &gravity,
+                                    const Values &known_values, size_t t) {
+  DynamicsGraph graph_builder(gravity);
+  Values expected = graph_builder.linearSolveFD(robot, t, known_values);
+
+  RecursiveDynamics aba(robot, gravity);
+  Values actual = aba.solveForwardDynamics(known_values, t);
+
+  bool agrees = true;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    agrees &= assert_equal(JointAccel(expected, j, t), JointAccel(actual, j, t),
+                           1e-6);
+    for (auto &&link : {joint->parent(), joint->child()}) {
+      agrees &= assert_equal(Wrench(expected, link->id(), j, t),
+                             Wrench(actual, link->id(), j, t), 1e-6);
+    }
+  }
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    agrees &= assert_equal(TwistAccel(expected, i, t),
+                           TwistAccel(actual, i, t), 1e-6);
+  }
+  return agrees;
+}
+
+// Fixed base, with gravity and non-zero joint velocity.
+TEST(RecursiveDynamics, simple_urdf) {
+  auto robot = simple_urdf::getRobot();
+  const size_t t = 5;
+  const int j = robot.joint("j1")->id();
+
+  Values values;
+  InsertJointAngle(&values, j, t, 0.3);
+  InsertJointVel(&values, j, t, -1.2);
+  Values known_values = robot.forwardKinematics(values, t);
+  InsertTorque(&known_values, j, t, 2.0);
+
+  EXPECT(AgreesWithLinearSolveFD(robot, gtsam::Vector3(0, 0, -9.8),
+                                 known_values, t));
+}
+
+// Floating base, same setup as the linear dynamics graph test.
+TEST(RecursiveDynamics, simple_urdf_eq_mass) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  const size_t t = 777;
+  auto l1 = robot.link("l1");
+  const int j = robot.joint("j1")->id();
+
+  Values values;
+  InsertPose(&values, l1->id(), t, l1->bMcom());
+  InsertTwist(&values, l1->id(), t, gtsam::Z_6x1);
+  Values known_values = robot.forwardKinematics(values, t, std::string("l1"));
+  InsertTorque(&known_values, j, t, 1.0);
+
+  RecursiveDynamics aba(robot, simple_urdf_eq_mass::gravity);
+  Values result = aba.solveForwardDynamics(known_values, t);
+  EXPECT(assert_equal(4.0, JointAccel(result, j, t), 1e-3));
+
+  EXPECT(AgreesWithLinearSolveFD(robot, simple_urdf_eq_mass::gravity,
+                                 known_values, t));
+}
+
+// The preallocated buffer can be reused across calls.
+TEST(RecursiveDynamics, buffer) {
+  auto robot = simple_urdf::getRobot();
+  const int j = robot.joint("j1")->id();
+  RecursiveDynamics aba(robot, simple_urdf::gravity);
+
+  RecursiveDynamicsResult result;
+  aba.allocate(&result);
+  EXPECT_LONGS_EQUAL(robot.links().size(), result.poses.size());
+  EXPECT_LONGS_EQUAL(robot.joints().size(), result.joint_accels.size());
+
+  for (double tau : {1.0, 2.0}) {
+    Values known_values;
+    InsertTorque(&known_values, j, tau);
+    aba.forwardDynamics(known_values, 0, &result);
+    // Linear in torque at rest, see testSimulator.
+    EXPECT_DOUBLES_EQUAL(0.0625 * tau, result.joint_accels(j), 1e-9);
+    EXPECT_DOUBLES_EQUAL(tau, result.torques(j), 1e-9);
+  }
+}
+
+// Inverse dynamics recovers the torques given to forward dynamics.
+TEST(RecursiveDynamics, round_trip) {
+  auto robot = simple_urdf_eq_mass::getRobot();
+  const int j = robot.joint("j1")->id();
+  RecursiveDynamics dynamics(robot, gtsam::Vector3(0, 0, -9.8));
+
+  RecursiveDynamicsResult fd, id;
+  dynamics.allocate(&fd);
+  dynamics.allocate(&id);
+  gtsam::Vector q(1), v(1), tau(1);
+  q << -0.4;
+  v << 0.8;
+  tau << 1.5;
+  dynamics.forwardDynamics(q, v, tau, &fd);
+  dynamics.inverseDynamics(q, v, fd.joint_accels, &id);
+
+  EXPECT_DOUBLES_EQUAL(tau(j), id.torques(j), 1e-6);
+  EXPECT(assert_equal(gtsam::Matrix(fd.twist_accels),
+                      gtsam::Matrix(id.twist_accels), 1e-6));
+  EXPECT(assert_equal(gtsam::Matrix(fd.child_wrenches),
+                      gtsam::Matrix(id.child_wrenches), 1e-6));
+}
+
+// Analytic derivatives of forward dynamics agree with central differences.
+TEST(RecursiveDynamics, forward_dynamics_derivatives) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  RecursiveDynamics dynamics(robot, gtsam::Vector3(0, 0, -9.8));
+  RecursiveDynamicsResult result;
+  dynamics.allocate(&result);
+  const size_t n = dynamics.compiledRobot().numJointSlots();
+
+  gtsam::Vector q(n), v(n), tau(n);
+  q << 0.3, -0.7;
+  v << 1.1, -0.4;
+  tau << 0.2, -0.5;
+  gtsam::Matrix da_dq, da_dv, da_dtau;
+  dynamics.forwardDynamicsDerivatives(q, v, tau, &result, &da_dq, &da_dv,
+                                      &da_dtau);
+
+  // The accelerations are those of forwardDynamics.
+  RecursiveDynamicsResult expected;
+  dynamics.allocate(&expected);
+  dynamics.forwardDynamics(q, v, tau, &expected);
+  EXPECT(assert_equal(expected.joint_accels, result.joint_accels, 1e-12));
+
+  auto accels = [&](const gtsam::Vector &q_, const gtsam::Vector &v_,
+                    const gtsam::Vector &tau_) -> gtsam::Vector {
+    dynamics.forwardDynamics(q_, v_, tau_, &expected);
+    return expected.joint_accels;
+  };
+  const double h = 1e-6;
+  gtsam::Matrix numerical_q(n, n), numerical_v(n, n), numerical_tau(n, n);
+  for (size_t k = 0; k < n; ++k) {
+    const gtsam::Vector e = h * gtsam::Vector::Unit(n, k);
+    numerical_q.col(k) =
+        (accels(q + e, v, tau) - accels(q - e, v, tau)) / (2 * h);
+    numerical_v.col(k) =
+        (accels(q, v + e, tau) - accels(q, v - e, tau)) / (2 * h);
+    numerical_tau.col(k) =
+        (accels(q, v, tau + e) - accels(q, v, tau - e)) / (2 * h);
+  }
+  EXPECT(assert_equal(numerical_q, da_dq, 1e-5));
+  EXPECT(assert_equal(numerical_v, da_dv, 1e-5));
+  EXPECT(assert_equal(numerical_tau, da_dtau, 1e-5));
+
+  // Floating bases are not supported.
+  RecursiveDynamics floating(simple_urdf_eq_mass::getRobot());
+  RecursiveDynamicsResult floating_result;
+  floating.allocate(&floating_result);
+  gtsam::Vector z = gtsam::Vector::Zero(1);
+  CHECK_EXCEPTION(floating.forwardDynamicsDerivatives(
+                      z, z, z, &floating_result, &da_dq, &da_dv, &da_dtau),
+                  std::runtime_error);
+}
+
+// Trajectories give the per-step results, row by row.
+TEST(RecursiveDynamics, trajectories) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  RecursiveDynamics dynamics(robot, gtsam::Vector3(0, 0, -9.8));
+  const size_t n = dynamics.compiledRobot().numJointSlots();
+  const gtsam::Matrix Q = gtsam::Matrix::Random(5, n);
+  const gtsam::Matrix V = gtsam::Matrix::Random(5, n);
+  const gtsam::Matrix A = gtsam::Matrix::Random(5, n);
+
+  const gtsam::Matrix torques = dynamics.inverseDynamicsTrajectory(Q, V, A);
+  RecursiveDynamicsResult result;
+  dynamics.allocate(&result);
+  for (int k = 0; k < Q.rows(); ++k) {
+    dynamics.inverseDynamics(Q.row(k).transpose(), V.row(k).transpose(),
+                             A.row(k).transpose(), &result);
+    EXPECT(assert_equal(result.torques,
+                        gtsam::Vector(torques.row(k).transpose()), 1e-12));
+  }
+  EXPECT(assert_equal(A, dynamics.forwardDynamicsTrajectory(Q, V, torques),
+                      1e-9));
+
+  CHECK_EXCEPTION(dynamics.inverseDynamicsTrajectory(Q, V, A.topRows(4)),
+                  std::invalid_argument);
+}
+
+// Derivatives of the torques at fixed accelerations.
+TEST(RecursiveDynamics, inverse_dynamics_derivatives) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  RecursiveDynamics dynamics(robot, gtsam::Vector3(0, 0, -9.8));
+  RecursiveDynamicsResult result, expected;
+  dynamics.allocate(&result);
+  dynamics.allocate(&expected);
+  const size_t n = dynamics.compiledRobot().numJointSlots();
+
+  gtsam::Vector q(n), v(n), a(n);
+  q << 0.3, -0.7;
+  v << 1.1, -0.4;
+  a << 0.2, -0.5;
+  gtsam::Matrix dtau_dq, dtau_dv;
+  dynamics.inverseDynamicsDerivatives(q, v, a, &result, &dtau_dq, &dtau_dv);
+  dynamics.inverseDynamics(q, v, a, &expected);
+  EXPECT(assert_equal(expected.torques, result.torques, 1e-12));
+
+  auto torques = [&](const gtsam::Vector &q_,
+                     const gtsam::Vector &v_) -> gtsam::Vector {
+    dynamics.inverseDynamics(q_, v_, a, &expected);
+    return expected.torques;
+  };
+  const double h = 1e-6;
+  gtsam::Matrix numerical_q(n, n), numerical_v(n, n);
+  for (size_t k = 0; k < n; ++k) {
+    const gtsam::Vector e = h * gtsam::Vector::Unit(n, k);
+    numerical_q.col(k) = (torques(q + e, v) - torques(q - e, v)) / (2 * h);
+    numerical_v.col(k) = (torques(q, v + e) - torques(q, v - e)) / (2 * h);
+  }
+  EXPECT(assert_equal(numerical_q, dtau_dq, 1e-5));
+  EXPECT(assert_equal(numerical_v, dtau_dv, 1e-5));
+}
+
+// M(q) a + C(q, v) v + g(q) is the inverse dynamics.
+TEST(RecursiveDynamics, equations_of_motion) {
+  auto robot = simple_rr::getRobot().fixLink("link_0");
+  RecursiveDynamics dynamics(robot, gtsam::Vector3(0, 0, -9.8));
+  RecursiveDynamicsResult id;
+  dynamics.allocate(&id);
+  const size_t n = dynamics.compiledRobot().numJointSlots();
+
+  gtsam::Vector q(n), v(n), a(n);
+  q << 0.3, -0.7;
+  v << 1.1, -0.4;
+  a << -0.6, 2.0;
+  gtsam::Matrix M;
+  gtsam::Vector h, c, g;
+  dynamics.massMatrix(q, &M);
+  dynamics.nonlinearEffects(q, v, &h);
+  dynamics.coriolisTorques(q, v, &c);
+  dynamics.gravityTorques(q, &g);
+
+  dynamics.inverseDynamics(q, v, a, &id);
+  EXPECT(assert_equal(id.torques, M * a + h, 1e-9));
+  EXPECT(assert_equal(h, c + g, 1e-12));
+  EXPECT(assert_equal(gtsam::Matrix(M.transpose()), M, 1e-12));
+  EXPECT(M.llt().info() == Eigen::Success);
+
+  // Columns of M are the inverse dynamics of unit accelerations, without
+  // velocities or gravity.
+  RecursiveDynamics no_gravity(robot);
+  const gtsam::Vector zero = gtsam::Vector::Zero(n);
+  for (size_t k = 0; k < n; ++k) {
+    no_gravity.inverseDynamics(q, zero, gtsam::Vector::Unit(n, k), &id);
+    EXPECT(assert_equal(gtsam::Vector(M.col(k)), id.torques, 1e-9));
+  }
+  no_gravity.gravityTorques(q, &g);
+  EXPECT(assert_equal(zero, g, 1e-12));
+
+  // M^-1 is the derivative of the accelerations in the torques.
+  gtsam::Matrix da_dq, da_dv, da_dtau;
+  dynamics.forwardDynamicsDerivatives(q, v, a, &id, &da_dq, &da_dv, &da_dtau);
+  EXPECT(assert_equal(gtsam::Matrix(M.inverse()), da_dtau, 1e-9));
+
+  RecursiveDynamics floating(simple_urdf_eq_mass::getRobot());
+  CHECK_EXCEPTION(floating.massMatrix(gtsam::Vector::Zero(1), &M),
+                  std::runtime_error);
+}
+
+// Closed loops cannot be handled by a tree traversal.
+TEST(RecursiveDynamics, four_bar_linkage) {
+  auto robot = four_bar_linkage_pure::getRobot();
+  CHECK_EXCEPTION(RecursiveDynamics(robot), std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
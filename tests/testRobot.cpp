@@ -87,6 +87,28 @@ TEST(Robot, removeLink) {
   EXPECT(robot.numJoints() == 2);
   EXPECT(robot.link("l1")->joints().size() == 1);
   EXPECT(robot.link("l3")->joints().size() == 1);
+  THROWS_EXCEPTION(robot.link("l2"));
+  EXPECT(robot.link(robot.linkId("l1")) == robot.link("l1"));
+}
+
+// Links and joints can be found by id as well as by name.
+TEST(Robot, Ids) {
+  const Robot robot = simple_rr::getRobot();
+  for (auto &&link : robot.links()) {
+    EXPECT_LONGS_EQUAL(link->id(), robot.linkId(link->name()));
+    EXPECT(robot.link(link->id()) == link);
+  }
+  for (auto &&joint : robot.joints()) {
+    EXPECT_LONGS_EQUAL(joint->id(), robot.jointId(joint->name()));
+    EXPECT(robot.joint(joint->id()) == joint);
+  }
+  THROWS_EXCEPTION(robot.linkId("link_3"));
+  THROWS_EXCEPTION(robot.link(DynamicsIndex(robot.numLinks())));
+  THROWS_EXCEPTION(robot.joint(DynamicsIndex(robot.numJoints() + 1)));
+
+  // Variants have their own index.
+  const Robot fixed = robot.fixLink("link_0");
+  EXPECT(fixed.link(robot.linkId("link_0"))->isFixed());
 }
 
 TEST(Robot, ForwardKinematics) {
@@ -255,6 +277,46 @@ TEST(Robot, Equality) {
   EXPECT(!robot1.equals(robot2));
 }
 
+// Variants of a robot have their own links and joints.
+TEST(Robot, Variants) {
+  const Robot robot = simple_rr::getRobot();
+  const Robot fixed = robot.fixLink("link_0");
+  EXPECT(!robot.link("link_0")->isFixed());
+  EXPECT(fixed.link("link_0")->isFixed());
+  EXPECT(fixed.link("link_0") != robot.link("link_0"));
+  EXPECT(robot.unfixLink("link_0") == robot);
+
+  // Joints of the variant connect the links of the variant.
+  auto joint = fixed.joint("joint_1");
+  EXPECT(joint != robot.joint("joint_1"));
+  EXPECT(joint->parent() == fixed.link(joint->parent()->name()));
+  EXPECT(joint->child() == fixed.link(joint->child()->name()));
+  EXPECT(fixed.link("link_1")->joints()[0] ==
+         fixed.joint(robot.link("link_1")->joints()[0]->name()));
+
+  // Fixing the variant back does not touch the first one.
+  const Robot unfixed = fixed.unfixLink("link_0");
+  EXPECT(fixed.link("link_0")->isFixed());
+  EXPECT(!unfixed.link("link_0")->isFixed());
+
+  JointParams parameters;
+  parameters.scalar_limits.value_upper_limit = 0.5;
+  const Robot limited = fixed.withJointParameters("joint_1", parameters);
+  EXPECT_DOUBLES_EQUAL(0.5,
+                       limited.joint("joint_1")
+                           ->parameters()
+                           .scalar_limits.value_upper_limit,
+                       1e-12);
+  EXPECT(limited.link("link_0")->isFixed());
+  EXPECT(fixed.joint("joint_1")->parameters().scalar_limits.value_upper_limit !=
+         0.5);
+  THROWS_EXCEPTION(fixed.withJointParameters("joint_3", parameters));
+
+  // Forward kinematics of the variant are those of the original.
+  const Values expected = robot.fixLink("link_0").forwardKinematics(Values());
+  EXPECT(assert_equal(expected, limited.forwardKinematics(Values())));
+}
+
 // Declaration needed for serialization of derived class.
 BOOST_CLASS_EXPORT(gtdynamics::RevoluteJoint)
 BOOST_CLASS_EXPORT(gtdynamics::HelicalJoint)
@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotKernelGenerator.cpp
+ * @brief Test generating the specialized kernels of a robot.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/universal_robot/RobotKernelGenerator.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+
+namespace example {
+Robot robot() { return simple_rr::getRobot().fixLink("link_0"); }
+
+bool Contains(const std::string &code, const std::string &text) {
+  return code.find(text) != std::string::npos;
+}
+}  // namespace example
+
+// Sizes and the kernels of every joint are written out.
+TEST(GenerateRobotKernels, SimpleRR) {
+  const Robot robot = example::robot();
+  const std::string code =
+      GenerateRobotKernels(robot, "simple_rr", gtsam::Vector3(0, 0, -9.8));
+  EXPECT(example::Contains(code, "namespace simple_rr {"));
+  EXPECT(example::Contains(code, "constexpr int kNumLinkSlots = 3;"));
+  EXPECT(example::Contains(code, "constexpr int kNumJointSlots = 2;"));
+  for (const std::string kernel :
+       {"ForwardKinematics", "BodyJacobian", "InverseDynamics",
+        "ForwardDynamics"})
+    EXPECT(example::Contains(code, "inline void " + kernel + "("));
+  for (auto &&joint : robot.joints()) {
+    const std::string j = std::to_string(joint->id());
+    EXPECT(example::Contains(code, "(*tau)(" + j + ") ="));
+    EXPECT(example::Contains(code, "(*a)(" + j + ") ="));
+    EXPECT(example::Contains(code, "joint " + joint->name() + "."));
+  }
+  EXPECT(example::Contains(code, "rotation().transpose()"));
+
+  // The code is the same every time, and gravity is optional.
+  EXPECT(code == GenerateRobotKernels(robot, "simple_rr",
+                                      gtsam::Vector3(0, 0, -9.8)));
+  EXPECT(!example::Contains(GenerateRobotKernels(robot, "simple_rr"),
+                            "rotation().transpose()"));
+}
+
+TEST(GenerateRobotKernels, Unsupported) {
+  CHECK_EXCEPTION(GenerateRobotKernels(example::robot(), "simple-rr"),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(GenerateRobotKernels(simple_rr::getRobot(), "simple_rr"),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
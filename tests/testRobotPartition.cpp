@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testRobotPartition.cpp
+ * @brief Test multi-robot graphs split by robot instance.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <algorithm>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/factors/CouplingFactors.h"
+#include "gtdynamics/optimizer/RobotPartition.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+
+// Two arms holding the same point, built with the single-robot builders.
+TEST(RobotPartition, TwoArms) {
+  auto robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder(simple_rr::gravity);
+  gtsam::NonlinearFactorGraph graph;
+  for (size_t r = 0; r < 2; r++)
+    graph.add(graph_builder.qFactors(robot, DynamicsSymbol::RobotTime(r, 0)));
+  const size_t num_robot_factors = graph.size();
+
+  // The keys of the two robots do not collide.
+  const gtsam::KeySet keys = graph.keys();
+  EXPECT_LONGS_EQUAL(2 * graph_builder.qFactors(robot, 0).keys().size(),
+                     keys.size());
+
+  const PointOnLink tip(robot.link("link_2"), Point3(0, 0, 0.5));
+  graph.emplace_shared<PointCouplingFactor>(
+      0, tip, 1, tip, gtsam::noiseModel::Isotropic::Sigma(3, 0.01));
+
+  const RobotPartition partition = PartitionByRobot(graph);
+  EXPECT_LONGS_EQUAL(2, partition.robots.size());
+  EXPECT_LONGS_EQUAL(num_robot_factors / 2, partition.robots.at(0).size());
+  EXPECT_LONGS_EQUAL(num_robot_factors / 2, partition.robots.at(1).size());
+  EXPECT_LONGS_EQUAL(1, partition.coupling.size());
+  EXPECT_LONGS_EQUAL(2, partition.coupling_keys.size());
+  for (auto &&kv : partition.robots)
+    for (const gtsam::Key key : kv.second.keys())
+      EXPECT_LONGS_EQUAL(kv.first, DynamicsSymbol::RobotInstance(key));
+
+  // The coupling keys are eliminated last.
+  const gtsam::Ordering ordering = MultiRobotOrdering(graph);
+  EXPECT_LONGS_EQUAL(keys.size(), ordering.size());
+  for (const gtsam::Key key : partition.coupling_keys)
+    EXPECT(std::find(ordering.end() - 2, ordering.end(), key) !=
+           ordering.end());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSDFCollisionFactor.cpp
+ * @brief Test the collision factor on signed distance fields.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/LabeledSymbol.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <boost/make_shared.hpp>
+#include <vector>
+
+#include "gtdynamics/factors/SDFCollisionFactor.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+namespace example {
+// The floor z = 0, with distance z sampled on 3 x 3 x 5 voxels.
+boost::shared_ptr<const SignedDistanceField> Floor() {
+  std::vector<double> distances;
+  for (int k = 0; k < 5; k++)
+    for (int n = 0; n < 9; n++) distances.push_back(k - 1.0);
+  return boost::make_shared<const SignedDistanceField>(
+      3, 3, 5, Point3(-1, -1, -1), 1.0, distances);
+}
+
+const CollisionSpheres spheres = {{Point3(0, 0, 0), 0.1},
+                                  {Point3(0.5, 0, 0), 0.2}};
+}  // namespace example
+
+TEST(SDFCollisionFactor, Error) {
+  const gtsam::LabeledSymbol pose_key('p', 0, 0);
+  const SDFCollisionFactor factor(
+      pose_key, gtsam::noiseModel::Isotropic::Sigma(2, 0.001),
+      example::Floor(), example::spheres, 0.05);
+
+  // Clear of the floor.
+  EXPECT(gtsam::assert_equal(
+      gtsam::Vector2(0, 0),
+      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 1)))));
+
+  // Both spheres within the clearance, the second one in the floor.
+  EXPECT(gtsam::assert_equal(
+      gtsam::Vector2(0.05, 0.15),
+      factor.evaluateError(Pose3(Rot3(), Point3(0, 0, 0.1)))));
+
+  gtsam::Values values;
+  values.insert(pose_key,
+                Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(0.1, 0.2, 0.12)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  CHECK_EXCEPTION(SDFCollisionFactor(
+                      pose_key, gtsam::noiseModel::Isotropic::Sigma(1, 0.001),
+                      example::Floor(), example::spheres, 0.05),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
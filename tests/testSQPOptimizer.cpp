@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSQPOptimizer.cpp
+ * @brief Test the Gauss-Newton SQP optimizer.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+
+#include <stdexcept>
+
+#include "constrainedExample.h"
+#include "gtdynamics/optimizer/AugmentedLagrangianOptimizer.h"
+#include "gtdynamics/optimizer/EqualityConstraint.h"
+#include "gtdynamics/optimizer/SQPOptimizer.h"
+
+using namespace gtdynamics;
+using namespace gtsam;
+
+namespace example {
+using namespace constrained_example;
+
+NonlinearFactorGraph Cost() {
+  NonlinearFactorGraph graph;
+  auto cost_noise = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.add(ExpressionFactor<double>(cost_noise, 0., x1 + exp(-x2)));
+  graph.add(ExpressionFactor<double>(cost_noise, 0.,
+                                     pow(x1, 2.0) + 2.0 * x2 + 1.0));
+  return graph;
+}
+
+EqualityConstraints Constraints() {
+  EqualityConstraints constraints;
+  constraints.emplace_shared<DoubleExpressionEquality>(
+      x1 + pow(x1, 3) + x2 + pow(x2, 2), 1.0);
+  return constraints;
+}
+
+Values Init() {
+  Values values;
+  values.insert(x1_key, -0.2);
+  values.insert(x2_key, -0.2);
+  return values;
+}
+}  // namespace example
+
+TEST(SQPOptimizer, ConstrainedExample) {
+  using namespace constrained_example;
+  SQPOptimizer optimizer;
+  ConstrainedOptResult result;
+  const Values values = optimizer.optimize(
+      example::Cost(), example::Constraints(), example::Init(), &result);
+
+  Values expected;
+  expected.insert(x1_key, 0.0);
+  expected.insert(x2_key, 0.0);
+  EXPECT(assert_equal(expected, values, 1e-4));
+  EXPECT_LONGS_EQUAL(result.intermediate_values.size(),
+                     result.num_iters.size());
+
+  // One linearization per iteration, far fewer than nested LM solves.
+  ConstrainedOptResult al_result;
+  AugmentedLagrangianOptimizer().optimize(example::Cost(),
+                                          example::Constraints(),
+                                          example::Init(), &al_result);
+  EXPECT(result.profile.num_linearizations <
+         al_result.profile.num_linearizations);
+}
+
+// Inequalities are not supported.
+TEST(SQPOptimizer, Inequalities) {
+  using namespace constrained_example;
+  InequalityConstraints inequalities;
+  inequalities.emplace_shared<DoubleExpressionInequality>(x1, 1.0);
+  CHECK_EXCEPTION(SQPOptimizer().optimize(example::Cost(),
+                                          example::Constraints(), inequalities,
+                                          example::Init()),
+                  std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,116 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testScalarRobot.cpp
+ * @brief Test the float and double kernels against the double-only ones.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Testable.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/dynamics/RecursiveDynamics.h"
+#include "gtdynamics/universal_robot/CompiledRobot.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/universal_robot/ScalarRobot.h"
+#include "gtdynamics/universal_robot/sdf.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using gtsam::Pose3;
+using gtsam::Vector;
+
+namespace example {
+const Robot a1 =
+    CreateRobotFromFile(kUrdfPath + std::string("a1/a1.urdf"), "a1");
+const gtsam::Vector3 gravity(0, 0, -9.8);
+}  // namespace example
+
+// Poses, twists and Jacobians agree with CompiledRobot.
+TEST(ScalarRobot, Kinematics) {
+  const Robot robot = example::a1.fixLink("trunk");
+  const CompiledRobot compiled(robot);
+  const ScalarRobot<float> single(compiled);
+  const ScalarRobot<double> twice(compiled);
+  const Vector q = Vector::Random(compiled.numJointSlots());
+  const Vector v = Vector::Random(compiled.numJointSlots());
+
+  std::vector<Pose3> expected;
+  Matrix expected_twists;
+  compiled.forwardKinematics(q, v, &expected, &expected_twists);
+  ScalarRobot<float>::Poses poses;
+  ScalarRobot<double>::Poses exact;
+  Eigen::MatrixXf twists;
+  Matrix exact_twists;
+  single.forwardKinematics(q.cast<float>(), v.cast<float>(), &poses, &twists);
+  twice.forwardKinematics(q, v, &exact, &exact_twists);
+  EXPECT(assert_equal(expected_twists, exact_twists, 1e-12));
+  EXPECT(assert_equal(expected_twists, Matrix(twists.cast<double>()), 1e-4));
+
+  Matrix J_expected, J;
+  Eigen::MatrixXf J_single;
+  for (auto &&link : robot.links()) {
+    const int i = link->id();
+    EXPECT(assert_equal(expected[i], ScalarRobot<double>::ToPose3(exact[i]),
+                        1e-12));
+    EXPECT(assert_equal(expected[i], ScalarRobot<float>::ToPose3(poses[i]),
+                        1e-4));
+
+    compiled.spatialJacobian(expected, i, &J_expected);
+    twice.spatialJacobian(exact, i, &J);
+    EXPECT(assert_equal(J_expected, J, 1e-12));
+    single.spatialJacobian(poses, i, &J_single);
+    EXPECT(assert_equal(J_expected, Matrix(J_single.cast<double>()), 1e-4));
+
+    compiled.bodyJacobian(expected, i, &J_expected);
+    twice.bodyJacobian(exact, i, &J);
+    EXPECT(assert_equal(J_expected, J, 1e-12));
+  }
+
+  CHECK_EXCEPTION(single.bodyJacobian(poses, -1, &J_single),
+                  std::invalid_argument);
+}
+
+// Accelerations agree with the articulated-body algorithm in double, also
+// with a floating root at the identity.
+TEST(ScalarRobot, ForwardDynamics) {
+  using example::gravity;
+  for (const Robot &robot : {example::a1.fixLink("trunk"), example::a1}) {
+    const RecursiveDynamics dynamics(robot, gravity);
+    const size_t n = dynamics.compiledRobot().numJointSlots();
+    const Matrix Q = Matrix::Random(3, n), V = Matrix::Random(3, n),
+                 Tau = Matrix::Random(3, n);
+    const Matrix expected = dynamics.forwardDynamicsTrajectory(Q, V, Tau);
+
+    const ScalarRobot<float> single(robot, gravity);
+    const ScalarRobot<double> twice(robot, gravity);
+    Eigen::VectorXf a_single;
+    Vector a;
+    for (int k = 0; k < Q.rows(); ++k) {
+      const Vector q = Q.row(k).transpose(), v = V.row(k).transpose(),
+                   tau = Tau.row(k).transpose();
+      twice.forwardDynamics(q, v, tau, &a);
+      EXPECT(assert_equal(Vector(expected.row(k).transpose()), a, 1e-9));
+      single.forwardDynamics(q.cast<float>(), v.cast<float>(),
+                             tau.cast<float>(), &a_single);
+      const Vector a_cast = a_single.cast<double>();
+      EXPECT((a_cast - a).norm() < 1e-3 * (1 + a.norm()));
+    }
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
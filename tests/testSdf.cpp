@@ -21,9 +21,11 @@
 #include "gtdynamics/universal_robot/PrismaticJoint.h"
 #include "gtdynamics/universal_robot/RevoluteJoint.h"
 #include "gtdynamics/universal_robot/HelicalJoint.h"
+#include "gtdynamics/universal_robot/RobotCache.h"
 #include "gtdynamics/universal_robot/sdf.h"
 #include "gtdynamics/universal_robot/sdf_internal.h"
 #include "gtdynamics/utils/utils.h"
+#include "gtdynamics/utils/values.h"
 
 using namespace gtdynamics;
 using gtsam::assert_equal;
@@ -81,6 +83,30 @@ TEST(Sdf, load_and_parse_sdf_world_file) {
   EXPECT(assert_equal(0.03, l1.Inertial().Moi()(2, 2)));
 }
 
+// A dynamics-only model drops visuals and collisions but keeps the inertia.
+TEST(Sdf, dynamics_only) {
+  const std::string file_path = kSdfPath + std::string("test/simple_rr.sdf");
+  const sdf::Model full = GetSdf(file_path, "simple_rr_sdf");
+  const sdf::Model dynamics = GetSdf(file_path, "simple_rr_sdf", true);
+  EXPECT_LONGS_EQUAL(full.LinkCount(), dynamics.LinkCount());
+  EXPECT_LONGS_EQUAL(full.JointCount(), dynamics.JointCount());
+  for (uint i = 0; i < full.LinkCount(); i++) {
+    const sdf::Link &expected = *full.LinkByIndex(i);
+    const sdf::Link &actual = *dynamics.LinkByIndex(i);
+    EXPECT(expected.VisualCount() > 0);
+    EXPECT_LONGS_EQUAL(0, actual.VisualCount());
+    EXPECT_LONGS_EQUAL(0, actual.CollisionCount());
+    EXPECT(assert_equal(expected.Inertial().MassMatrix().Mass(),
+                        actual.Inertial().MassMatrix().Mass()));
+    EXPECT(assert_equal(Pose3FromIgnition(expected.Inertial().Pose()),
+                        Pose3FromIgnition(actual.Inertial().Pose())));
+  }
+
+  const std::vector<sdf::Model> models = GetSdfModels(file_path, true);
+  EXPECT_LONGS_EQUAL(1, models.size());
+  EXPECT_LONGS_EQUAL(0, models[0].LinkByName("link_1")->VisualCount());
+}
+
 TEST(Sdf, Pose3FromIgnition) {
   ignition::math::Pose3d pose_to_parse(-1, 1, -1, M_PI / 2, 0, -M_PI);
 
@@ -640,6 +666,102 @@ TEST(Sdf, sdf_constructor) {
       l1.inertia()));
 }
 
+// Robots read back from the binary cache equal the parsed ones, including the
+// order of the joints of each link.
+TEST(Sdf, robot_cache) {
+  const std::string file_path =
+      kSdfPath + std::string("test/four_bar_linkage_pure.sdf");
+  const Robot expected = CreateRobotFromFile(file_path, "", false);
+
+  const std::string cache_path = RobotCachePath(file_path, "");
+  if (cache_path.empty()) return;  // cache disabled
+  EXPECT(cache_path != RobotCachePath(file_path, "other_model"));
+
+  SaveRobotBinary(expected, cache_path);
+  const Robot actual = LoadRobotBinary(cache_path);
+  EXPECT(assert_equal(expected, actual));
+  for (auto &&link : expected.links()) {
+    const auto &expected_joints = link->joints();
+    const auto &actual_joints = actual.link(link->name())->joints();
+    LONGS_EQUAL(expected_joints.size(), actual_joints.size());
+    for (size_t k = 0; k < expected_joints.size(); k++)
+      EXPECT(expected_joints[k]->name() == actual_joints[k]->name());
+  }
+
+  // CreateRobotFromFile now reads the cache.
+  EXPECT(assert_equal(expected, CreateRobotFromFile(file_path)));
+}
+
+// Robots encoded in memory, as for pickling, decode to the same robot.
+TEST(Sdf, encode_robot) {
+  const Robot expected = CreateRobotFromFile(
+      kSdfPath + std::string("test/four_bar_linkage_pure.sdf"), "", false);
+  const Robot actual = DecodeRobot(EncodeRobot(expected));
+  EXPECT(assert_equal(expected, actual));
+  for (auto &&link : expected.links())
+    LONGS_EQUAL(link->joints().size(),
+                actual.link(link->name())->joints().size());
+  CHECK_EXCEPTION(DecodeRobot("not a robot"), std::runtime_error);
+}
+
+// All models of a world file are constructed from a single parse.
+TEST(Sdf, create_robots_from_file) {
+  const std::string file_path = kSdfPath + std::string("test/simple_rr.sdf");
+  const Robot expected = CreateRobotFromFile(file_path, "simple_rr_sdf", false);
+
+  const auto all = CreateRobotsFromFile(file_path, {}, 2, false);
+  LONGS_EQUAL(1, all.size());
+  EXPECT(assert_equal(expected, all.at("simple_rr_sdf")));
+
+  const auto named =
+      CreateRobotsFromFile(file_path, {"simple_rr_sdf"}, 1, false);
+  EXPECT(assert_equal(expected, named.at("simple_rr_sdf")));
+
+  CHECK_EXCEPTION(CreateRobotsFromFile(file_path, {"no_such_model"}, 1, false),
+                  std::runtime_error);
+}
+
+// A payload on a fixed joint is merged into the link it is mounted on.
+TEST(Sdf, lump_fixed_joints) {
+  const std::string file_path =
+      kSdfPath + std::string("test/simple_rr_fixed.sdf");
+  CHECK_EXCEPTION(CreateRobotFromFile(file_path, "simple_rr_fixed_sdf", false),
+                  std::runtime_error);
+
+  const Robot robot =
+      CreateRobotFromFile(file_path, "simple_rr_fixed_sdf", false, true);
+  EXPECT_LONGS_EQUAL(3, robot.numLinks());
+  EXPECT_LONGS_EQUAL(2, robot.numJoints());
+  EXPECT_LONGS_EQUAL(0, robot.joint("joint_1")->id());
+  EXPECT_LONGS_EQUAL(1, robot.joint("joint_2")->id());
+
+  // Combined mass, CoM and inertia about the CoM.
+  const LinkSharedPtr link_2 = robot.link("link_2");
+  EXPECT_DOUBLES_EQUAL(0.04, link_2->mass(), 1e-12);
+  EXPECT(assert_equal(gtsam::Point3(0, 0.075, 1.325),
+                      link_2->bMcom().translation(), 1e-9));
+  const gtsam::Matrix3 inertia =
+      (gtsam::Matrix(3, 3) << 0.07075, 0, 0, 0, 0.070675, -0.000225, 0,
+       -0.000225, 0.060075)
+          .finished();
+  EXPECT(assert_equal(inertia, link_2->inertia(), 1e-9));
+
+  // The payload remains as a frame of the composite link.
+  EXPECT(robot.hasFrame("payload"));
+  EXPECT(robot.frame("payload").link == "link_2");
+  Values values;
+  InsertPose(&values, robot.link("link_0")->id(),
+             robot.link("link_0")->bMcom());
+  for (auto &&joint : robot.joints()) {
+    InsertJointAngle(&values, joint->id(), 0.0);
+    InsertJointVel(&values, joint->id(), 0.0);
+  }
+  values = robot.forwardKinematics(values, 0, std::string("link_0"));
+  EXPECT(assert_equal(Pose3(Rot3::Rz(M_PI_2), Point3(0, 0, 1.4)),
+                      robot.framePose(values, "payload"), 1e-9));
+  CHECK_EXCEPTION(robot.frame("no_such_frame"), std::runtime_error);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSelfCollision.cpp
+ * @brief Test the link pair filter and broadphase of self-collision.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/universal_robot/SelfCollision.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+
+namespace example {
+// One sphere of the given radius at the COM of each link of simple_rr. The
+// COMs of link_0 and link_2 are at least 0.4 apart, and 0.76 apart at the
+// joint limits of +-pi/2.
+std::map<std::string, CollisionSpheres> Spheres(double radius) {
+  std::map<std::string, CollisionSpheres> spheres;
+  for (const std::string name : {"link_0", "link_1", "link_2"})
+    spheres[name] = {{Point3::Zero(), radius}};
+  return spheres;
+}
+}  // namespace example
+
+TEST(SelfCollisionModel, PairFilter) {
+  const Robot robot = simple_rr::getRobot();
+  const int l0 = robot.link("link_0")->id(), l2 = robot.link("link_2")->id();
+  SelfCollisionParameters parameters;
+  parameters.num_samples = 0;
+
+  // Adjacent links are dropped.
+  SelfCollisionModel model(robot, example::Spheres(0.1), parameters);
+  EXPECT_LONGS_EQUAL(1, model.pairs().size());
+  EXPECT_LONGS_EQUAL(std::min(l0, l2), model.pairs()[0].link_a);
+  EXPECT_LONGS_EQUAL(std::max(l0, l2), model.pairs()[0].link_b);
+  parameters.adjacency = 2;
+  EXPECT_LONGS_EQUAL(
+      0, SelfCollisionModel(robot, example::Spheres(0.1), parameters)
+             .pairs()
+             .size());
+
+  // Small spheres never come close, large ones do.
+  parameters.adjacency = 1;
+  parameters.num_samples = 200;
+  EXPECT_LONGS_EQUAL(
+      0, SelfCollisionModel(robot, example::Spheres(0.1), parameters)
+             .pairs()
+             .size());
+  EXPECT_LONGS_EQUAL(
+      1, SelfCollisionModel(robot, example::Spheres(0.4), parameters)
+             .pairs()
+             .size());
+}
+
+TEST(SelfCollisionModel, Broadphase) {
+  const Robot robot = simple_rr::getRobot();
+  const int l2 = robot.link("link_2")->id();
+  SelfCollisionParameters parameters;
+  parameters.num_samples = 0;
+  auto spheres = example::Spheres(0.1);
+  spheres["link_2"] = {{Point3(0, 0, 0.1), 0.1}, {Point3(0, 0, -0.1), 0.2}};
+  const SelfCollisionModel model(robot, spheres, parameters);
+  EXPECT_DOUBLES_EQUAL(0.3, model.bound(l2).radius, 1e-12);
+
+  std::vector<Pose3> poses(model.compiledRobot().numLinkSlots());
+  poses[l2] = Pose3(gtsam::Rot3(), Point3(0, 0, 1));
+  EXPECT_LONGS_EQUAL(0, model.candidatePairs(poses, 0.5).size());
+  EXPECT_LONGS_EQUAL(1, model.candidatePairs(poses, 0.7).size());
+  EXPECT_DOUBLES_EQUAL(0.9 - 0.3, model.clearance(model.pairs()[0], poses),
+                       1e-12);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
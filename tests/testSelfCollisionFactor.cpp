@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSelfCollisionFactor.cpp
+ * @brief Test the batch self-collision factor.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <boost/make_shared.hpp>
+#include <map>
+#include <string>
+
+#include "gtdynamics/factors/SelfCollisionFactor.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+
+TEST(SelfCollisionFactor, Error) {
+  const Robot robot = simple_rr::getRobot();
+  const int l0 = robot.link("link_0")->id(), l2 = robot.link("link_2")->id();
+  std::map<std::string, CollisionSpheres> spheres;
+  spheres["link_0"] = {{Point3::Zero(), 0.1}};
+  spheres["link_1"] = {{Point3::Zero(), 0.1}};
+  spheres["link_2"] = {{Point3(0, 0, 0.1), 0.1}, {Point3(0, 0, -0.1), 0.2}};
+  SelfCollisionParameters parameters;
+  parameters.num_samples = 0;
+  const auto model =
+      boost::make_shared<const SelfCollisionModel>(robot, spheres, parameters);
+  const SelfCollisionFactor factor(model, 3, 0.05, 0.001);
+  EXPECT_LONGS_EQUAL(2, factor.size());
+  EXPECT_LONGS_EQUAL(2, factor.dim());
+
+  // Clear, so the broadphase skips the pair.
+  gtsam::Values values;
+  values.insert(internal::PoseKey(l0, 3), Pose3());
+  values.insert(internal::PoseKey(l2, 3), Pose3(Rot3(), Point3(0, 0, 1)));
+  EXPECT(gtsam::assert_equal(gtsam::Vector2(0, 0),
+                             factor.unwhitenedError(values)));
+
+  // The lower sphere of link_2 within the clearance, the upper one clear.
+  values.update(internal::PoseKey(l2, 3), Pose3(Rot3(), Point3(0, 0, 0.42)));
+  EXPECT(gtsam::assert_equal(gtsam::Vector2(0, 0.05 - 0.02),
+                             factor.unwhitenedError(values), 1e-9));
+
+  values.update(internal::PoseKey(l2, 3), Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3),
+                                      Point3(0.05, -0.1, 0.35)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSensitivity.cpp
+ * @brief Test implicit differentiation against re-optimization.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/nonlinear/GaussNewtonOptimizer.h>
+#include <gtsam/nonlinear/PriorFactor.h>
+#include <gtsam/slam/BetweenFactor.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/Sensitivity.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Vector;
+
+namespace example {
+// Two scalars pulled towards the parameters and 1 apart.
+gtsam::NonlinearFactorGraph Chain(const Vector &p) {
+  gtsam::NonlinearFactorGraph graph;
+  graph.emplace_shared<gtsam::PriorFactor<double>>(
+      0, p(0), gtsam::noiseModel::Isotropic::Sigma(1, 1.0));
+  graph.emplace_shared<gtsam::PriorFactor<double>>(
+      1, p(1), gtsam::noiseModel::Isotropic::Sigma(1, 2.0));
+  graph.emplace_shared<gtsam::BetweenFactor<double>>(
+      0, 1, 1.0, gtsam::noiseModel::Isotropic::Sigma(1, p(2)));
+  return graph;
+}
+
+gtsam::Values Solve(const gtsam::NonlinearFactorGraph &graph,
+                    const gtsam::Values &initial) {
+  gtsam::GaussNewtonParams parameters;
+  parameters.setRelativeErrorTol(1e-12);
+  parameters.setAbsoluteErrorTol(1e-12);
+  return gtsam::GaussNewtonOptimizer(graph, initial, parameters).optimize();
+}
+}  // namespace example
+
+TEST(Sensitivity, Chain) {
+  const Vector p = (Vector(3) << 0.5, 2.0, 0.8).finished();
+  gtsam::Values initial;
+  initial.insert<double>(0, 0.0);
+  initial.insert<double>(1, 0.0);
+  const gtsam::Values solution = example::Solve(example::Chain(p), initial);
+
+  const Sensitivity sensitivity(example::Chain, p, solution);
+  EXPECT_LONGS_EQUAL(3, sensitivity.numParameters());
+  EXPECT_LONGS_EQUAL(3, sensitivity.numResiduals());
+
+  // Against re-optimizing with perturbed parameters.
+  const double h = 1e-4;
+  Vector expected_cost_gradient(3);
+  for (size_t k = 0; k < 3; ++k) {
+    Vector plus = p, minus = p;
+    plus(k) += h;
+    minus(k) -= h;
+    const auto graph_plus = example::Chain(plus),
+               graph_minus = example::Chain(minus);
+    const gtsam::Values x_plus = example::Solve(graph_plus, solution),
+                        x_minus = example::Solve(graph_minus, solution);
+    const gtsam::VectorValues dx = sensitivity.solutionDerivative(k);
+    for (gtsam::Key key : {0, 1})
+      EXPECT_DOUBLES_EQUAL(
+          (x_plus.at<double>(key) - x_minus.at<double>(key)) / (2 * h),
+          dx.at(key)(0), 1e-5);
+    expected_cost_gradient(k) =
+        (graph_plus.error(x_plus) - graph_minus.error(x_minus)) / (2 * h);
+  }
+  EXPECT(gtsam::assert_equal(expected_cost_gradient,
+                             sensitivity.costGradient(), 1e-5));
+
+  // The adjoint gradient of f(x) = x1 is the row of dx1/dp.
+  gtsam::VectorValues df;
+  df.insert(1, gtsam::Vector1(1.0));
+  const Vector gradient = sensitivity.objectiveGradient(df);
+  const auto jacobian = sensitivity.solutionJacobian();
+  for (size_t k = 0; k < 3; ++k)
+    EXPECT_DOUBLES_EQUAL(jacobian[k].at(1)(0), gradient(k), 1e-9);
+
+  CHECK_EXCEPTION(sensitivity.solutionDerivative(3), std::invalid_argument);
+}
+
+// Sensitivity of forward dynamics to the torque: d(qddot)/d(tau).
+TEST(Sensitivity, ForwardDynamics) {
+  const Robot robot = simple_urdf_eq_mass::getRobot();
+  const DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                                    simple_urdf_eq_mass::planar_axis);
+  const auto build = [&](const Vector &p) {
+    gtsam::Values known_values;
+    for (auto &&joint : robot.joints()) {
+      InsertJointAngle(&known_values, joint->id(), 0, 0.0);
+      InsertJointVel(&known_values, joint->id(), 0, 0.0);
+      InsertTorque(&known_values, joint->id(), 0, p(0));
+    }
+    gtsam::NonlinearFactorGraph graph =
+        graph_builder.dynamicsFactorGraph(robot, 0);
+    graph.add(graph_builder.forwardDynamicsPriors(robot, 0, known_values));
+    return graph;
+  };
+
+  const Vector p = gtsam::Vector1(1.0);
+  const gtsam::Values solution =
+      example::Solve(build(p), ZeroValues(robot, 0));
+  const Sensitivity sensitivity(build, p, solution);
+  const gtsam::VectorValues dx = sensitivity.solutionDerivative(0);
+
+  const double h = 1e-3;
+  const gtsam::Values x_plus =
+      example::Solve(build(p + gtsam::Vector1(h)), solution);
+  const gtsam::Values x_minus =
+      example::Solve(build(p - gtsam::Vector1(h)), solution);
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    EXPECT_DOUBLES_EQUAL(
+        (JointAccel(x_plus, j, 0) - JointAccel(x_minus, j, 0)) / (2 * h),
+        dx.at(internal::JointAccelKey(j, 0))(0), 1e-4);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSensorRingBuffer.cpp
+ * @brief Test the lock-free single-producer, multi-consumer ring buffer.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtdynamics/utils/SensorRingBuffer.h"
+
+using namespace gtdynamics;
+
+TEST(SensorRingBuffer, fifo) {
+  SensorRingBuffer<int> buffer(3);
+  EXPECT_LONGS_EQUAL(4, buffer.capacity());
+
+  int value = 0;
+  EXPECT(!buffer.pop(&value));
+  for (int i = 0; i < 4; ++i) EXPECT(buffer.push(i));
+  EXPECT(!buffer.push(4));
+  EXPECT_LONGS_EQUAL(1, buffer.dropped());
+  EXPECT_LONGS_EQUAL(4, buffer.sizeApprox());
+
+  EXPECT(buffer.pop(&value));
+  EXPECT_LONGS_EQUAL(0, value);
+  EXPECT(buffer.push(5));
+  std::vector<int> values;
+  EXPECT_LONGS_EQUAL(2, buffer.popBatch(&values, 2));
+  EXPECT_LONGS_EQUAL(2, buffer.popBatch(&values));
+  EXPECT(values == std::vector<int>({1, 2, 3, 5}));
+  EXPECT_LONGS_EQUAL(0, buffer.sizeApprox());
+
+  CHECK_EXCEPTION(SensorRingBuffer<int>(0), std::invalid_argument);
+}
+
+// Every pushed sample is popped by exactly one consumer.
+TEST(SensorRingBuffer, consumers) {
+  SensorRingBuffer<long> buffer(64);
+  const long n = 100000;
+  std::atomic<long> sum(0), count(0);
+  std::atomic<bool> done(false);
+  std::vector<std::thread> consumers;
+  for (int c = 0; c < 3; ++c)
+    consumers.emplace_back([&]() {
+      long value;
+      for (;;) {
+        if (buffer.pop(&value)) {
+          sum += value;
+          ++count;
+        } else if (done) {
+          if (!buffer.pop(&value)) break;
+          sum += value;
+          ++count;
+        }
+      }
+    });
+  for (long i = 1; i <= n;)
+    if (buffer.push(i)) ++i;
+  done = true;
+  for (auto &&consumer : consumers) consumer.join();
+  EXPECT_LONGS_EQUAL(n, count.load());
+  EXPECT_LONGS_EQUAL(n * (n + 1) / 2, sum.load());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testSignedDistanceField.cpp
+ * @brief Test signed distance fields and collision spheres.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Matrix.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/utils/SignedDistanceField.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+
+namespace example {
+// 4 x 5 x 6 voxels of a smooth field, 0.5 apart from (-1, 0, 1).
+std::vector<double> Distances() {
+  std::vector<double> distances;
+  for (int k = 0; k < 6; k++)
+    for (int j = 0; j < 5; j++)
+      for (int i = 0; i < 4; i++)
+        distances.push_back(std::sin(0.7 * i) + 0.3 * j * j - 0.2 * k);
+  return distances;
+}
+
+const Point3 origin(-1, 0, 1);
+}  // namespace example
+
+TEST(SignedDistanceField, Interpolation) {
+  const SignedDistanceField sdf(4, 5, 6, example::origin, 0.5,
+                                example::Distances());
+
+  // Voxels are kept, gradients are analytic.
+  EXPECT_DOUBLES_EQUAL(sdf.at(1, 2, 3), sdf.distance(Point3(-0.5, 1, 2.5)),
+                       1e-12);
+  const Point3 p(-0.37, 0.81, 2.13);
+  gtsam::Matrix13 H;
+  sdf.distance(p, H);
+  const double e = 1e-6;
+  for (int a = 0; a < 3; a++) {
+    const Point3 dp = e * gtsam::Vector3::Unit(a);
+    EXPECT_DOUBLES_EQUAL(
+        (sdf.distance(p + dp) - sdf.distance(p - dp)) / (2 * e), H(a), 1e-6);
+  }
+
+  // Outside the grid the border is extended.
+  EXPECT_DOUBLES_EQUAL(sdf.distance(Point3(-1, 0.81, 2.13)),
+                       sdf.distance(Point3(-4, 0.81, 2.13), H), 1e-12);
+  EXPECT_DOUBLES_EQUAL(0, H(0), 1e-12);
+
+  CHECK_EXCEPTION(
+      SignedDistanceField(4, 5, 6, example::origin, 0.5, {1.0, 2.0}),
+      std::invalid_argument);
+  CHECK_EXCEPTION(SignedDistanceField(1, 5, 6, example::origin, 0.5,
+                                      std::vector<double>(30)),
+                  std::invalid_argument);
+}
+
+TEST(SignedDistanceField, MemoryMapped) {
+  const std::vector<double> distances = example::Distances();
+  const std::string path = "testSignedDistanceField_sdf.bin";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(distances.data()),
+               distances.size() * sizeof(double));
+  }
+  const SignedDistanceField in_memory(4, 5, 6, example::origin, 0.5,
+                                      distances);
+  const SignedDistanceField mapped =
+      SignedDistanceField::MemoryMapped(path, 4, 5, 6, example::origin, 0.5);
+  const Point3 p(-0.37, 0.81, 2.13);
+  EXPECT_DOUBLES_EQUAL(in_memory.distance(p), mapped.distance(p), 1e-12);
+  CHECK_EXCEPTION(
+      SignedDistanceField::MemoryMapped(path, 4, 5, 5, example::origin, 0.5),
+      std::invalid_argument);
+  std::remove(path.c_str());
+}
+
+TEST(CollisionSpheres, Mesh) {
+  const std::vector<Point3> vertices =
+      ReadMeshVertices(std::string(kSdfPath) + "meshes/link_0.stl");
+  CHECK(!vertices.empty());
+  CHECK(!ReadMeshVertices(std::string(kSdfPath) + "meshes/link_0.obj")
+             .empty());
+
+  // Every vertex is covered, by one sphere or by several.
+  for (size_t n : {1, 4}) {
+    const CollisionSpheres spheres = BoundingSpheres(vertices, n);
+    EXPECT_LONGS_EQUAL(n, spheres.size());
+    for (const Point3 &vertex : vertices) {
+      bool covered = false;
+      for (const CollisionSphere &sphere : spheres)
+        covered |= (vertex - sphere.center).norm() <= sphere.radius + 1e-9;
+      EXPECT(covered);
+    }
+  }
+
+  const gtsam::Pose3 comTmesh(gtsam::Rot3::Rz(0.3), Point3(1, 2, 3));
+  const CollisionSpheres spheres = BoundingSpheres(vertices, 2);
+  const CollisionSpheres moved = TransformSpheres(comTmesh, spheres);
+  EXPECT(gtsam::assert_equal(comTmesh.transformFrom(spheres[1].center),
+                             moved[1].center));
+  EXPECT_DOUBLES_EQUAL(spheres[1].radius, moved[1].radius, 1e-12);
+
+  CHECK_EXCEPTION(ReadMeshVertices("no_such_mesh.stl"), std::runtime_error);
+  CHECK_EXCEPTION(BoundingSpheres({}, 2), std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -17,7 +17,9 @@
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/slam/PriorFactor.h>
 
+#include <cmath>
 #include <iostream>
+#include <string>
 
 #include "gtdynamics/dynamics/Simulator.h"
 #include "gtdynamics/universal_robot/Robot.h"
@@ -53,6 +55,350 @@ TEST(Simulate, simple_urdf) {
   EXPECT(assert_equal(expected_qAccel, JointAccel(results, 0)));
 }
 
+// The other forward dynamics methods should give the same results.
+TEST(Simulate, simple_urdf_articulated_body) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+
+  Simulator linear(robot, initial_values, gravity, planar_axis, LinearGraph);
+  Simulator aba(robot, initial_values, gravity, planar_axis, ArticulatedBody);
+  Simulator compiled(robot, initial_values, gravity, planar_axis,
+                     CompiledLinearGraph);
+
+  const double dt = 0.1;
+  std::vector<gtsam::Values> torques_seq(5, torques);
+  auto expected = linear.simulate(torques_seq, dt);
+  for (auto &&simulator : {&aba, &compiled}) {
+    auto actual = simulator->simulate(torques_seq, dt);
+    EXPECT(assert_equal(JointAngle(expected, 0), JointAngle(actual, 0), 1e-9));
+    EXPECT(assert_equal(JointVel(expected, 0), JointVel(actual, 0), 1e-9));
+    EXPECT(assert_equal(JointAccel(expected, 0), JointAccel(actual, 0), 1e-9));
+  }
+}
+
+// Stepping with joint-id indexed torques, without Values.
+TEST(Simulate, simple_urdf_arrays) {
+  using gtsam::assert_equal;
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+
+  Simulator expected(robot, initial_values, gravity, planar_axis);
+  Simulator actual(robot, initial_values, gravity, planar_axis,
+                   ArticulatedBody);
+  const double dt = 0.1;
+  const gtsam::Vector tau = gtsam::Vector::Ones(1);
+  for (size_t k = 0; k < 3; ++k) {
+    expected.step(torques, dt);
+    actual.step(tau, dt);
+  }
+  const auto &values = expected.getValues();
+  EXPECT_DOUBLES_EQUAL(JointAccel(values, 0), actual.jointAccels()(0), 1e-9);
+
+  // The materialized values contain everything the graph-based version has.
+  EXPECT(assert_equal(values, actual.getValues(), 1e-9));
+
+  // Array interface is not available with the factor graph methods.
+  CHECK_EXCEPTION(expected.step(tau, dt), std::runtime_error);
+}
+
+// Overwriting the state, as when following another simulator, continues from
+// it with either method.
+TEST(Simulate, setState) {
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertJointAngle(&initial_values, 0, 0.3);
+  InsertJointVel(&initial_values, 0, -0.2);
+  InsertTorque(&torques, 0, 1.0);
+  const double dt = 0.1;
+
+  for (auto method : {LinearGraph, ArticulatedBody}) {
+    Simulator expected(robot, initial_values, gravity, planar_axis, method);
+    Simulator actual(robot, gtsam::Values(), gravity, planar_axis, method);
+    actual.setState(gtsam::Vector::Constant(1, 0.3),
+                    gtsam::Vector::Constant(1, -0.2));
+    expected.step(torques, dt);
+    actual.step(torques, dt);
+    EXPECT(gtsam::assert_equal(expected.getValues(), actual.getValues(),
+                               1e-9));
+    CHECK_EXCEPTION(actual.setState(gtsam::Vector(), gtsam::Vector()),
+                    std::invalid_argument);
+  }
+}
+
+// Record the whole simulation in a columnar history.
+TEST(Simulate, history) {
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+  const double dt = 0.1;
+  const size_t num_steps = 20;  // more than preallocated
+
+  for (auto method : {LinearGraph, ArticulatedBody}) {
+    Simulator simulator(robot, initial_values, gravity, planar_axis, method);
+    simulator.recordHistory(8);
+    for (size_t k = 0; k < num_steps; ++k) simulator.step(torques, dt);
+
+    const auto &history = simulator.history();
+    EXPECT_LONGS_EQUAL(num_steps, history.size());
+    EXPECT_LONGS_EQUAL(num_steps, history.jointAngles().cols());
+    const auto &last = simulator.getValues();
+    EXPECT_DOUBLES_EQUAL(JointAngle(last, 0),
+                         history.jointAngles()(0, num_steps - 1), 1e-9);
+    EXPECT_DOUBLES_EQUAL(0.0625, history.jointAccels()(0, 0), 1e-9);
+    EXPECT_DOUBLES_EQUAL(1.0, history.torques()(0, 3), 1e-9);
+    auto l2 = robot.link("l2");
+    EXPECT(gtsam::assert_equal(Pose(last, l2->id()),
+                               history.pose(num_steps - 1, l2->id()), 1e-9));
+
+    // Bulk conversion, with one time index per step.
+    auto values = history.toValues({0}, {l2->id()});
+    EXPECT_LONGS_EQUAL(num_steps * 5, values.size());
+    EXPECT_DOUBLES_EQUAL(JointAngle(last, 0),
+                         JointAngle(values, 0, num_steps - 1), 1e-9);
+
+    simulator.reset();
+    EXPECT_LONGS_EQUAL(0, simulator.history().size());
+  }
+}
+
+// Per-step latencies, only when enabled.
+TEST(Simulate, metrics) {
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+  const double dt = 0.01;
+
+  for (auto method : {LinearGraph, ArticulatedBody}) {
+    Simulator simulator(robot, initial_values, gravity, planar_axis, method);
+    simulator.step(torques, dt);
+    EXPECT_LONGS_EQUAL(0, simulator.metrics().step.count());
+
+    simulator.enableMetrics();
+    for (size_t k = 0; k < 10; ++k) simulator.step(torques, dt);
+    const SimulatorMetrics &metrics = simulator.metrics();
+    EXPECT_LONGS_EQUAL(10, metrics.step.count());
+    EXPECT_LONGS_EQUAL(10, metrics.forward_dynamics.count());
+    EXPECT_LONGS_EQUAL(10, metrics.integration.count());
+    EXPECT_LONGS_EQUAL(method == ArticulatedBody ? 0 : 10,
+                       metrics.forward_kinematics.count());
+    EXPECT_DOUBLES_EQUAL(0.1, metrics.simulated_time, 1e-12);
+    EXPECT(metrics.realTimeFactor() > 0);
+    EXPECT(metrics.step.percentile(99) >= metrics.step.percentile(50));
+    EXPECT(metrics.toJson().find("\"real_time_factor\"") != std::string::npos);
+
+    // Kept by reset, until resetMetrics.
+    simulator.reset();
+    EXPECT_LONGS_EQUAL(10, simulator.metrics().step.count());
+    simulator.resetMetrics();
+    EXPECT_LONGS_EQUAL(0, simulator.metrics().step.count());
+  }
+}
+
+// Under constant torque and no gravity the acceleration is constant, so the
+// second order schemes are exact and symplectic Euler is off by a known amount.
+TEST(Simulate, integration_schemes) {
+  using simple_urdf::gravity, simple_urdf::planar_axis;
+  auto robot = simple_urdf::getRobot();
+  gtsam::Values initial_values, torques;
+  InsertTorque(&torques, 0, 1.0);
+  const double a = 0.0625, dt = 0.1;
+  const size_t N = 10;
+  const double T = N * dt;
+
+  for (auto method : {LinearGraph, ArticulatedBody}) {
+    for (auto scheme : {ExplicitEuler, RungeKutta4, Verlet}) {
+      Simulator simulator(robot, initial_values, gravity, planar_axis, method);
+      simulator.setIntegrationScheme(scheme);
+      for (size_t k = 0; k < N; ++k) simulator.step(torques, dt);
+      simulator.step(torques, dt);  // values are at the start of a step
+      EXPECT_DOUBLES_EQUAL(0.5 * a * T * T,
+                           JointAngle(simulator.getValues(), 0), 1e-9);
+      EXPECT_DOUBLES_EQUAL(a * T, JointVel(simulator.getValues(), 0), 1e-9);
+    }
+
+    Simulator simulator(robot, initial_values, gravity, planar_axis, method);
+    simulator.setIntegrationScheme(SemiImplicitEuler);
+    for (size_t k = 0; k <= N; ++k) simulator.step(torques, dt);
+    EXPECT_DOUBLES_EQUAL(0.5 * a * dt * dt * N * (N + 1),
+                         JointAngle(simulator.getValues(), 0), 1e-9);
+  }
+}
+
+// With gravity, RK4 at a coarse step should track a fine reference closely.
+TEST(Simulate, runge_kutta_convergence) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  gtsam::Values initial_values, torques;
+  InsertJointAngle(&initial_values, 0, 0.5);
+  InsertTorque(&torques, 0, 0.0);
+
+  auto simulate = [&](IntegrationScheme scheme, double dt, size_t steps) {
+    Simulator simulator(robot, initial_values, gravity, boost::none,
+                        ArticulatedBody);
+    simulator.setIntegrationScheme(scheme);
+    for (size_t k = 0; k < steps; ++k) simulator.step(torques, dt);
+    return simulator.jointAngles()(0);
+  };
+  const double reference = simulate(RungeKutta4, 0.001, 1000);
+  EXPECT_DOUBLES_EQUAL(reference, simulate(RungeKutta4, 0.05, 20), 1e-4);
+  EXPECT(std::abs(simulate(ExplicitEuler, 0.05, 20) - reference) >
+         std::abs(simulate(RungeKutta4, 0.05, 20) - reference));
+}
+
+// Rollouts through the linear models of a nominal trajectory of a pendulum.
+TEST(Simulate, surrogate) {
+  auto robot = simple_urdf::getRobot();
+  const gtsam::Vector3 gravity(0, 0, -9.8);
+  gtsam::Values initial_values;
+  InsertJointAngle(&initial_values, 0, 0.5);
+  const double dt = 0.01;
+  const size_t N = 20;
+  const std::vector<gtsam::Vector> nominal(N, gtsam::Vector::Zero(1));
+
+  for (auto method : {LinearGraph, ArticulatedBody}) {
+    Simulator simulator(robot, initial_values, gravity, boost::none, method);
+    simulator.linearizeAround(nominal, dt);
+    EXPECT_LONGS_EQUAL(N, simulator.surrogateSteps());
+    EXPECT_DOUBLES_EQUAL(0.5, simulator.jointAngles()(0), 1e-12);
+
+    // Surrogate and exact rollouts with constant torques.
+    auto rollout = [&](const gtsam::Vector &tau) {
+      simulator.reset();
+      for (size_t k = 0; k < N; ++k) simulator.surrogateStep(tau);
+      return simulator.jointAngles()(0);
+    };
+    auto exact = [&](const gtsam::Vector &tau) {
+      Simulator reference(robot, initial_values, gravity, boost::none,
+                          ArticulatedBody);
+      for (size_t k = 0; k < N; ++k) reference.step(tau, dt);
+      return reference.jointAngles()(0);
+    };
+
+    // The nominal trajectory is reproduced exactly, and nearby ones to
+    // second order.
+    const gtsam::Vector zero = gtsam::Vector::Zero(1),
+                        tau = gtsam::Vector::Constant(1, 0.01);
+    EXPECT_DOUBLES_EQUAL(exact(zero), rollout(zero), 1e-9);
+    const double deviation = std::abs(exact(tau) - exact(zero));
+    EXPECT(deviation > 1e-6);
+    EXPECT(std::abs(rollout(tau) - exact(tau)) < 0.01 * deviation);
+    EXPECT_LONGS_EQUAL(0, simulator.surrogateRefreshes());
+
+    // Past the linearized steps, steps are exact.
+    simulator.reset();
+    for (size_t k = 0; k < N + 5; ++k) simulator.surrogateStep(zero);
+    Simulator longer(robot, initial_values, gravity, boost::none,
+                     ArticulatedBody);
+    for (size_t k = 0; k < N + 5; ++k) longer.step(zero, dt);
+    EXPECT_DOUBLES_EQUAL(longer.jointAngles()(0), simulator.jointAngles()(0),
+                         1e-9);
+  }
+
+  // A zero refresh threshold linearizes again at every step that deviates.
+  Simulator simulator(robot, initial_values, gravity, boost::none,
+                      ArticulatedBody);
+  simulator.linearizeAround(nominal, dt, 0.0);
+  for (size_t k = 0; k < N; ++k)
+    simulator.surrogateStep(gtsam::Vector::Constant(1, 0.01));
+  EXPECT_LONGS_EQUAL(N - 1, simulator.surrogateRefreshes());
+
+  CHECK_EXCEPTION(simulator.surrogateStep(gtsam::Vector::Zero(2)),
+                  std::invalid_argument);
+}
+
+// The damping of simple_urdf, 500, makes explicit steps of 0.1 s unstable.
+TEST(Simulate, passive_damping) {
+  auto robot = simple_urdf::getRobot();
+  const int j = robot.joint("j1")->id();
+  const double damping = robot.joint("j1")->parameters().damping_coefficient;
+  EXPECT_DOUBLES_EQUAL(500, damping, 1e-9);
+  gtsam::Values initial_values, torques, unit;
+  InsertJointVel(&initial_values, j, 1.0);
+  InsertTorque(&torques, j, 0.0);
+  InsertTorque(&unit, j, 1.0);
+
+  // Inertia about the joint, from a unit torque at rest.
+  Simulator rest(robot, gtsam::Values(), boost::none, boost::none,
+                 ArticulatedBody);
+  rest.step(unit, 0.1);
+  const double inertia = 1 / rest.jointAccels()(j);
+
+  // Explicitly, the first acceleration is that of the damping torque.
+  Simulator graph(robot, initial_values);
+  graph.enablePassiveForces(true, false);
+  graph.step(torques, 0.001);
+  EXPECT_DOUBLES_EQUAL(-damping / inertia,
+                       JointAccel(graph.getValues(), j), 1e-6);
+  EXPECT_DOUBLES_EQUAL(-damping, Torque(graph.getValues(), j), 1e-6);
+
+  auto simulate = [&](bool implicit, size_t steps) {
+    Simulator simulator(robot, initial_values, boost::none, boost::none,
+                        ArticulatedBody);
+    simulator.setIntegrationScheme(SemiImplicitEuler);
+    simulator.enablePassiveForces(true, implicit);
+    for (size_t k = 0; k < steps; ++k) simulator.step(torques, 0.1);
+    return simulator.jointVels()(j);
+  };
+  EXPECT(std::abs(simulate(false, 10)) > 1);
+  // Implicitly, each step is a backward Euler step of the damper.
+  const double decay = 1 / (1 + 0.1 * damping / inertia);
+  EXPECT_DOUBLES_EQUAL(decay, simulate(true, 1), 1e-6);
+  EXPECT_DOUBLES_EQUAL(std::pow(decay, 10), simulate(true, 10), 1e-6);
+}
+
+// Multi-rate: the motor current is sub-stepped within each rigid-body step.
+TEST(Simulate, dc_motor) {
+  auto robot = simple_urdf::getRobot();
+  const int j = robot.joint("j1")->id();
+  DCMotorParameters motor;
+  motor.resistance = 0.1;
+  motor.gear_ratio = 40;
+  auto model = boost::make_shared<DCMotorModel>(motor);
+  gtsam::Vector voltage = gtsam::Vector::Zero(j + 1);
+  voltage(j) = 12;
+
+  Simulator simulator(robot, gtsam::Values(), boost::none, boost::none,
+                      ArticulatedBody);
+  simulator.recordHistory();
+  simulator.setActuator(j, model);
+  simulator.setActuatorSubsteps(10);
+  simulator.step(voltage, 0.01);
+
+  // At rest the current rises by backward Euler steps, and the step applies
+  // the mean torque after each of them.
+  gtsam::Vector current = model->initialState();
+  double torque = 0;
+  for (size_t s = 0; s < 10; ++s) {
+    model->step(0.001, 12, 0, 0, &current);
+    torque += model->torque(current, 0, 0) / 10;
+  }
+  EXPECT(gtsam::assert_equal(current, simulator.actuatorState(j), 1e-12));
+  EXPECT_DOUBLES_EQUAL(torque, simulator.history().torques()(j, 0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(torque, Torque(simulator.getValues(), j), 1e-12);
+
+  // The joint speeds up until the back-emf cancels the voltage.
+  for (size_t k = 1; k < 1000; ++k) simulator.step(voltage, 0.01);
+  EXPECT_DOUBLES_EQUAL(12 / (motor.torque_constant * motor.gear_ratio),
+                       simulator.jointVels()(j), 1e-6);
+
+  // A reset restarts the motor, and a null model removes it.
+  simulator.reset();
+  EXPECT(gtsam::assert_equal(model->initialState(),
+                             simulator.actuatorState(j)));
+  simulator.setActuator(j, nullptr);
+  CHECK_EXCEPTION(simulator.actuatorState(j), std::invalid_argument);
+  CHECK_EXCEPTION(simulator.setActuator(j + 1, model), std::invalid_argument);
+  CHECK_EXCEPTION(simulator.setActuatorSubsteps(0), std::invalid_argument);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -71,6 +71,35 @@ TEST(StaticWrenchFactor, GravityCompensation) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(factor, x, diffDelta, tol);
 }
 
+// The fixed-size factor agrees with the dynamic one.
+TEST(StaticWrenchFactor, FixedSize) {
+  int id = 0;
+  const double M = example::mass;
+  const std::vector<DynamicsSymbol> wrench_keys{WrenchKey(id, 1),
+                                                WrenchKey(id, 2)};
+  const StaticWrenchFactor factor(wrench_keys, PoseKey(id), example::cost_model,
+                                  M, example::gravity);
+  const FixedStaticWrenchFactor<2> fixed(
+      wrench_keys, PoseKey(id), example::cost_model, M, example::gravity);
+  Values x;
+  InsertWrench(&x, id, 1, (Vector(6) << 1, 2, 3, 4, 5, 6).finished());
+  InsertWrench(&x, id, 2, (Vector(6) << 0, -1, 0, 2, M * 3, 0).finished());
+  InsertPose(&x, id, Pose3(Rot3::RzRyRx(0.1, 0.2, 0.3), Point3(1, 0, 0)));
+  EXPECT(assert_equal(factor.unwhitenedError(x), fixed.unwhitenedError(x)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(fixed, x, diffDelta, tol);
+
+  // Without gravity, the error is the sum of the wrenches.
+  const FixedStaticWrenchFactor<2> weightless(wrench_keys, PoseKey(id),
+                                              example::cost_model, M);
+  const Vector expected =
+      (Vector(6) << 1, 1, 3, 6, 5 + M * 3, 6).finished();
+  EXPECT(assert_equal(expected, weightless.unwhitenedError(x)));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(weightless, x, diffDelta, tol);
+
+  THROWS_EXCEPTION(FixedStaticWrenchFactor<3>(wrench_keys, PoseKey(id),
+                                              example::cost_model, M));
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,86 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testStaticsEngine.cpp
+ * @brief Test repeated statics queries.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+
+#include "gtdynamics/statics/Statics.h"
+#include "gtdynamics/statics/StaticsEngine.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Values;
+using gtsam::Vector;
+
+constexpr double kTol = 1e-4;
+
+// Two-link arm on a fixed base, under gravity.
+TEST(StaticsEngine, FixedBase) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  const size_t k = 3;
+  const StaticsParameters parameters(1e-5, gtsam::Vector3(0, 0, -9.8));
+  const Statics statics(parameters);
+  StaticsEngine engine(robot, parameters, k);
+  EXPECT(engine.isRecursive());
+
+  // Nearby configurations, as a controller would query.
+  for (double theta : {0.3, 0.31, 0.35}) {
+    Values angles;
+    Vector q = Vector::Zero(robot.numJoints());
+    for (auto &&joint : robot.joints()) {
+      q(joint->id()) = theta * (joint->id() + 1);
+      InsertJointAngle(&angles, joint->id(), k, q(joint->id()));
+    }
+    const Values configuration = robot.forwardKinematics(angles, k);
+    const Values expected = statics.solve(Slice(k), robot, configuration);
+
+    Vector torques;
+    engine.gravityTorques(q, &torques);
+    const Values actual = engine.solve(configuration);
+    for (auto &&joint : robot.joints()) {
+      const int j = joint->id();
+      EXPECT_DOUBLES_EQUAL(Torque(expected, j, k), torques(j), kTol);
+      EXPECT_DOUBLES_EQUAL(Torque(expected, j, k), Torque(actual, j, k), kTol);
+      EXPECT(assert_equal(Wrench(expected, joint->child()->id(), j, k),
+                          Wrench(actual, joint->child()->id(), j, k), kTol));
+    }
+  }
+}
+
+// Without a fixed root, queries go through the cached graph.
+TEST(StaticsEngine, Graph) {
+  const Robot robot = simple_rr::getRobot();
+  StaticsEngine engine(robot);
+  EXPECT(!engine.isRecursive());
+  Vector torques;
+  CHECK_EXCEPTION(engine.gravityTorques(Vector::Zero(2), &torques),
+                  std::runtime_error);
+
+  // Without gravity, the robot is at rest without wrenches or torques.
+  Values angles;
+  for (auto &&joint : robot.joints())
+    InsertJointAngle(&angles, joint->id(), 0, 0.2 * (joint->id() + 1));
+  const Values configuration = robot.forwardKinematics(angles, 0);
+  for (int i = 0; i < 2; i++) {
+    const Values actual = engine.solve(configuration);
+    for (auto &&joint : robot.joints())
+      EXPECT_DOUBLES_EQUAL(0, Torque(actual, joint->id(), 0), kTol);
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,100 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTaskExecutor.cpp
+ * @brief Test the executor shared by the parallel loops of the library.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtdynamics/utils/TaskExecutor.h"
+#include "gtdynamics/utils/ThreadPool.h"
+
+using namespace gtdynamics;
+
+namespace example {
+// Worker index of every loop index.
+std::vector<size_t> Workers(TaskExecutor *executor, size_t n,
+                            size_t num_slots) {
+  std::vector<size_t> workers(n, num_slots);
+  executor->parallelFor(n, num_slots,
+                        [&](size_t i, size_t worker) { workers[i] = worker; });
+  return workers;
+}
+}  // namespace example
+
+TEST(TaskExecutor, parallelFor) {
+  TaskExecutor executor(TaskExecutorParameters{4, {}, false});
+  EXPECT_LONGS_EQUAL(4, executor.numThreads());
+  const std::vector<size_t> workers = example::Workers(&executor, 1000, 3);
+  for (size_t worker : workers) EXPECT(worker < 3);
+
+  CHECK_EXCEPTION(executor.parallelFor(10, 3,
+                                       [](size_t i, size_t) {
+                                         if (i == 3)
+                                           throw std::runtime_error("");
+                                       }),
+                  std::runtime_error);
+  CHECK_EXCEPTION(TaskExecutor(TaskExecutorParameters{2, {-1}, false}),
+                  std::invalid_argument);
+}
+
+// Deterministically, indices map to workers in contiguous blocks, with any
+// number of threads.
+TEST(TaskExecutor, deterministic) {
+  TaskExecutor serial(TaskExecutorParameters{1, {}, true});
+  TaskExecutor parallel(TaskExecutorParameters{4, {}, true});
+  EXPECT(parallel.deterministic());
+  const std::vector<size_t> expected = example::Workers(&serial, 100, 8);
+  for (size_t i = 0; i < 100; ++i) EXPECT_LONGS_EQUAL(i * 8 / 100, expected[i]);
+  for (int run = 0; run < 5; ++run)
+    EXPECT(expected == example::Workers(&parallel, 100, 8));
+}
+
+// Loops nested in jobs, and loops from several threads, share the workers.
+TEST(TaskExecutor, nested) {
+  TaskExecutor executor(TaskExecutorParameters{4, {}, false});
+  std::vector<std::atomic<int>> visited(20 * 50);
+  for (auto &&count : visited) count = 0;
+  auto nested = [&]() {
+    executor.parallelFor(20, 4, [&](size_t i, size_t) {
+      executor.parallelFor(50, 4, [&](size_t j, size_t) {
+        ++visited[i * 50 + j];
+      });
+    });
+  };
+  std::thread other(nested);
+  nested();
+  other.join();
+  for (auto &&count : visited) EXPECT_LONGS_EQUAL(2, count);
+}
+
+// ThreadPools are handles on the shared executor.
+TEST(TaskExecutor, shared) {
+  TaskExecutor::ConfigureShared(TaskExecutorParameters{3, {}, false});
+  EXPECT_LONGS_EQUAL(3, TaskExecutor::Shared()->numThreads());
+  EXPECT_LONGS_EQUAL(3, ThreadPool().numThreads());
+  ThreadPool pool(8);
+  EXPECT_LONGS_EQUAL(8, pool.numThreads());
+  std::vector<int> visited(100, 0);
+  pool.parallelFor(visited.size(), [&](size_t i, size_t worker) {
+    if (worker < 8) visited[i] += 1;
+  });
+  for (int count : visited) EXPECT_LONGS_EQUAL(1, count);
+  TaskExecutor::ConfigureShared(TaskExecutorParameters());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
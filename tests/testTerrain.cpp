@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTerrain.cpp
+ * @brief Test height map interpolation and memory mapping.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/Matrix.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "gtdynamics/utils/Terrain.h"
+
+using namespace gtdynamics;
+
+namespace example {
+// 5 x 6 samples of a smooth surface, 0.5 apart from (-1, 2).
+std::vector<double> Heights() {
+  std::vector<double> heights;
+  for (int r = 0; r < 5; r++)
+    for (int c = 0; c < 6; c++)
+      heights.push_back(std::sin(0.7 * c) + 0.3 * r * r);
+  return heights;
+}
+
+// Compare the gradient of `map` at (x, y) with central differences.
+void CheckGradient(const HeightMap &map, double x, double y) {
+  gtsam::Matrix12 H;
+  map.height(x, y, H);
+  const double e = 1e-6;
+  EXPECT_DOUBLES_EQUAL((map.height(x + e, y) - map.height(x - e, y)) / (2 * e),
+                       H(0), 1e-6);
+  EXPECT_DOUBLES_EQUAL((map.height(x, y + e) - map.height(x, y - e)) / (2 * e),
+                       H(1), 1e-6);
+}
+}  // namespace example
+
+TEST(HeightMap, Interpolation) {
+  for (auto interpolation : {HeightMap::Bilinear, HeightMap::Bicubic}) {
+    const HeightMap map(5, 6, -1, 2, 0.5, example::Heights(), interpolation);
+    EXPECT_LONGS_EQUAL(5, map.rows());
+    EXPECT_LONGS_EQUAL(6, map.cols());
+
+    // Samples are kept, gradients are analytic.
+    EXPECT_DOUBLES_EQUAL(map.at(2, 3), map.height(0.5, 3.0), 1e-12);
+    example::CheckGradient(map, 0.37, 2.81);
+    example::CheckGradient(map, -0.9, 3.9);
+
+    // Outside the grid the border is extended.
+    gtsam::Matrix12 H;
+    EXPECT_DOUBLES_EQUAL(map.height(-1, 2.8), map.height(-5, 2.8, H), 1e-12);
+    EXPECT_DOUBLES_EQUAL(0, H(0), 1e-12);
+  }
+
+  // A linear surface is reproduced exactly by both.
+  std::vector<double> plane;
+  for (int r = 0; r < 4; r++)
+    for (int c = 0; c < 4; c++) plane.push_back(0.1 * c - 0.2 * r);
+  const HeightMap bicubic(4, 4, 0, 0, 1, plane, HeightMap::Bicubic);
+  gtsam::Matrix12 H;
+  EXPECT_DOUBLES_EQUAL(0.1 * 1.3 - 0.2 * 1.6, bicubic.height(1.3, 1.6, H),
+                       1e-12);
+  EXPECT_DOUBLES_EQUAL(0.1, H(0), 1e-12);
+  EXPECT_DOUBLES_EQUAL(-0.2, H(1), 1e-12);
+
+  CHECK_EXCEPTION(HeightMap(4, 4, 0, 0, 1, std::vector<double>(3)),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(HeightMap(1, 4, 0, 0, 1, std::vector<double>(4)),
+                  std::invalid_argument);
+}
+
+TEST(HeightMap, MemoryMapped) {
+  const std::vector<double> heights = example::Heights();
+  const std::string path = "testTerrain_height_map.bin";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(heights.data()),
+               heights.size() * sizeof(double));
+  }
+  const HeightMap in_memory(5, 6, -1, 2, 0.5, heights);
+  const HeightMap mapped = HeightMap::MemoryMapped(path, 5, 6, -1, 2, 0.5);
+  EXPECT_DOUBLES_EQUAL(in_memory.height(0.37, 2.81), mapped.height(0.37, 2.81),
+                       1e-12);
+  CHECK_EXCEPTION(HeightMap::MemoryMapped(path, 5, 5, -1, 2, 0.5),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(HeightMap::MemoryMapped("no_such_map.bin", 5, 6, 0, 0, 1),
+                  std::runtime_error);
+  std::remove(path.c_str());
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTimeMajorOrdering.cpp
+ * @brief Test the time-major elimination ordering.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/inference/Ordering.h>
+
+#include <algorithm>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/optimizer/Optimizer.h"
+#include "gtdynamics/optimizer/TimeMajorOrdering.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Ordering;
+using gtsam::Values;
+
+// Position of `key` in `ordering`.
+static size_t Position(const Ordering &ordering, gtsam::Key key) {
+  return std::find(ordering.begin(), ordering.end(), key) - ordering.begin();
+}
+
+TEST(TimeMajorOrdering, Trajectory) {
+  auto robot = simple_rr::getRobot();
+  const int num_steps = 3;
+  const DynamicsGraph graph_builder(simple_rr::gravity);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 0.1);
+  gtsam::KeySet keys = graph.keys();
+  keys.insert(PhaseKey(0));
+
+  const Ordering ordering = TimeMajorOrdering(robot, keys);
+  EXPECT_LONGS_EQUAL(keys.size(), ordering.size());
+
+  // Time steps in order, the phase key last.
+  EXPECT(ordering.back() == PhaseKey(0));
+  for (size_t k = 1; k + 1 < ordering.size(); k++)
+    EXPECT(DynamicsSymbol::Time(ordering[k - 1]) <=
+           DynamicsSymbol::Time(ordering[k]));
+
+  // Within a step: child link, then the joint, then the parent link.
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    const size_t child = Position(
+        ordering, internal::PoseKey(joint->child()->id(), 1));
+    const size_t q = Position(ordering, internal::JointAngleKey(j, 1));
+    const size_t parent = Position(
+        ordering, internal::PoseKey(joint->parent()->id(), 1));
+    EXPECT(child < q);
+    EXPECT(q < parent);
+  }
+}
+
+// Optimizing with the ordering gives the same solution.
+TEST(TimeMajorOrdering, Optimizer) {
+  auto robot = simple_urdf_eq_mass::getRobot().fixLink("l1");
+  const DynamicsGraph graph_builder(simple_urdf_eq_mass::gravity,
+                                    simple_urdf_eq_mass::planar_axis);
+  const int num_steps = 2;
+  Values known_values = zero_values(robot, 0);
+  for (int k = 0; k <= num_steps; k++)
+    for (auto &&joint : robot.joints())
+      InsertTorque(&known_values, joint->id(), k, k + 1.0);
+  auto graph = graph_builder.trajectoryFG(robot, num_steps, 1.0,
+                                          CollocationScheme::Euler);
+  graph.add(graph_builder.trajectoryFDPriors(robot, num_steps, known_values));
+  const Values init = ZeroValuesTrajectory(robot, num_steps);
+
+  OptimizationParameters parameters;
+  const Values expected = Optimizer(parameters).optimize(graph, init);
+  parameters.ordering_robot = robot;
+  const Values actual = Optimizer(parameters).optimize(graph, init);
+  EXPECT(assert_equal(expected, actual, 1e-6));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,102 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTimeWindowOptimizer.cpp
+ * @brief Test time-window decomposition with consensus ADMM.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/slam/BetweenFactor.h>
+#include <gtsam/slam/PriorFactor.h>
+
+#include "gtdynamics/optimizer/TimeWindowOptimizer.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Values;
+
+namespace example {
+const size_t num_steps = 20;
+
+// A chain of joint angles from 0 to 10, with steps preferring 0.5.
+NonlinearFactorGraph Chain() {
+  NonlinearFactorGraph graph;
+  auto prior_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.01);
+  auto step_model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  graph.emplace_shared<gtsam::PriorFactor<double>>(JointAngleKey(0, 0), 0.0,
+                                                   prior_model);
+  graph.emplace_shared<gtsam::PriorFactor<double>>(
+      JointAngleKey(0, num_steps - 1), 10.0, prior_model);
+  for (size_t t = 0; t + 1 < num_steps; t++)
+    graph.emplace_shared<gtsam::BetweenFactor<double>>(
+        JointAngleKey(0, t), JointAngleKey(0, t + 1), 0.5, step_model);
+  return graph;
+}
+
+Values Init() {
+  Values values;
+  for (size_t t = 0; t < num_steps; t++) InsertJointAngle(&values, 0, t, 0.0);
+  return values;
+}
+}  // namespace example
+
+TEST(TimeWindowOptimizer, split) {
+  const NonlinearFactorGraph graph = example::Chain();
+  TimeWindowParameters parameters;
+  parameters.num_windows = 4;
+  const auto windows = TimeWindowOptimizer(parameters).split(graph);
+  EXPECT_LONGS_EQUAL(4, windows.size());
+  EXPECT_LONGS_EQUAL(0, windows.front().first_step);
+  EXPECT_LONGS_EQUAL(example::num_steps - 1, windows.back().last_step);
+
+  // Without overlap every factor is in exactly one window.
+  size_t num_factors = 0;
+  for (auto &&window : windows) num_factors += window.graph.size();
+  EXPECT_LONGS_EQUAL(graph.size(), num_factors);
+  for (size_t w = 0; w + 1 < windows.size(); w++) {
+    EXPECT_LONGS_EQUAL(windows[w].last_step + 1, windows[w + 1].first_step);
+    EXPECT(windows[w].keys.count(
+        JointAngleKey(0, windows[w + 1].first_step)));
+  }
+
+  parameters.overlap = 2;
+  num_factors = 0;
+  for (auto &&window : TimeWindowOptimizer(parameters).split(graph))
+    num_factors += window.graph.size();
+  EXPECT(num_factors > graph.size());
+}
+
+// The windows agree with the solution of the whole graph.
+TEST(TimeWindowOptimizer, optimize) {
+  const NonlinearFactorGraph graph = example::Chain();
+  const Values expected =
+      gtsam::LevenbergMarquardtOptimizer(graph, example::Init()).optimize();
+
+  TimeWindowParameters parameters;
+  parameters.num_windows = 4;
+  parameters.lm_parameters.setRelativeErrorTol(1e-12);
+  parameters.lm_parameters.setAbsoluteErrorTol(1e-12);
+  parameters.rho = 1;
+  parameters.max_iterations = 1000;
+  parameters.tolerance = 1e-6;
+  parameters.num_threads = 2;
+  TimeWindowResult result;
+  const Values actual = TimeWindowOptimizer(parameters).optimize(
+      graph, example::Init(), &result);
+  EXPECT(result.converged);
+  EXPECT(result.iterations > 1);
+  EXPECT(gtsam::assert_equal(expected, actual, 1e-4));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -21,6 +21,7 @@
 #include <gtsam/nonlinear/Values.h>
 #include <gtsam/nonlinear/factorTesting.h>
 
+#include <cmath>
 #include <iostream>
 
 #include "gtdynamics/factors/TorqueFactor.h"
@@ -65,6 +66,50 @@ TEST(TorqueFactor, error) {
   EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, diffDelta, 1e-7);
 }
 
+// Test the passive spring, damper and friction torques.
+TEST(TorqueFactor, passive) {
+  gtsam::Vector6 screw_axis;
+  screw_axis << 0, 0, 1, 0, 1, 0;
+  JointParams parameters;
+  parameters.spring_coefficient = 40;
+  parameters.spring_reference = 0.1;
+  parameters.damping_coefficient = 3;
+  parameters.coulomb_friction = 0.5;
+  parameters.friction_velocity = 0.2;
+  auto joint = make_joint(Pose3(Rot3(), Point3(0, 0, -2)), screw_axis,
+                          parameters);
+  EXPECT(joint->hasPassiveTorque());
+
+  const double q = 0.3, v = -0.1;
+  double dq, dv;
+  const double expected =
+      -40 * (q - 0.1) - 3 * v - 0.5 * std::tanh(v / 0.2);
+  EXPECT_DOUBLES_EQUAL(expected, joint->passiveTorque(q, v, &dq, &dv), 1e-9);
+  const double h = 1e-6;
+  EXPECT_DOUBLES_EQUAL(
+      (joint->passiveTorque(q + h, v) - joint->passiveTorque(q - h, v)) /
+          (2 * h),
+      dq, 1e-6);
+  EXPECT_DOUBLES_EQUAL(
+      (joint->passiveTorque(q, v + h) - joint->passiveTorque(q, v - h)) /
+          (2 * h),
+      dv, 1e-6);
+
+  auto cost_model = gtsam::noiseModel::Isotropic::Sigma(1, 1.0);
+  auto factor = PassiveTorqueFactor(cost_model, joint, 777);
+  EXPECT_LONGS_EQUAL(4, factor->keys().size());
+  gtsam::Values values;
+  const gtsam::Vector wrench =
+      (gtsam::Vector(6) << 0, 0, 10, 0, 10, 0).finished();
+  InsertWrench(&values, 2, 1, 777, wrench);
+  InsertTorque(&values, 1, 777, 20.0 - expected);
+  InsertJointAngle(&values, 1, 777, q);
+  InsertJointVel(&values, 1, 777, v);
+  EXPECT(assert_equal(gtsam::Vector1(0), factor->unwhitenedError(values),
+                      1e-9));
+  EXPECT_CORRECT_FACTOR_JACOBIANS(*factor, values, 1e-7, 1e-5);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
@@ -0,0 +1,77 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrace.cpp
+ * @brief Test scoped tracing, compiled in or not.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/Trace.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+
+namespace {
+void Traced() { GTD_TRACE_SCOPE("Traced"); }
+}  // namespace
+
+TEST(Trace, Scopes) {
+  Traced();  // not recording
+  Trace::Start();
+  EXPECT(Trace::Recording() == Trace::kCompiled);
+  Traced();
+  std::thread thread(Traced);
+  thread.join();
+  Trace::Stop();
+  Traced();  // not recording
+
+  std::stringstream ss;
+  Trace::Save(ss);
+  const std::string trace = ss.str();
+  EXPECT(trace.find("{\"traceEvents\": [") == 0);
+  if (Trace::kCompiled) {
+    EXPECT_LONGS_EQUAL(2, Trace::NumEvents());
+    EXPECT(trace.find("\"name\": \"Traced\"") != std::string::npos);
+    EXPECT(trace.find("\"tid\": 1") != std::string::npos);
+  } else {
+    EXPECT_LONGS_EQUAL(0, Trace::NumEvents());
+  }
+
+  // Starting again discards the earlier events.
+  Trace::Start();
+  Trace::Stop();
+  EXPECT_LONGS_EQUAL(0, Trace::NumEvents());
+}
+
+// Instrumented library code records its stages.
+TEST(Trace, ForwardKinematics) {
+  const Robot robot = simple_rr::getRobot().fixLink("link_0");
+  gtsam::Values known;
+  for (auto &&joint : robot.joints())
+    InsertJointAngle(&known, joint->id(), 0, 0.1);
+
+  Trace::Start();
+  robot.forwardKinematics(known);
+  Trace::Stop();
+
+  std::stringstream ss;
+  Trace::Save(ss);
+  EXPECT(Trace::kCompiled == (ss.str().find("Robot::forwardKinematics") !=
+                              std::string::npos));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
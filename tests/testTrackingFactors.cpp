@@ -0,0 +1,103 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrackingFactors.cpp
+ * @brief Test objective factors with targets changed in place.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/LevenbergMarquardtOptimizer.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/factors/PointGoalFactor.h"
+#include "gtdynamics/factors/TrackingFactors.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+// Tracking factors have the error of the factors they replace, for the
+// current target.
+TEST(TrackingFactors, SameError) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder;
+  const int t = 2;
+  const int j = robot.jointId("joint_1"), i = robot.linkId("link_1");
+
+  Values values;
+  InsertJointAngle(&values, j, t, 0.3);
+  InsertPose(&values, i, t,
+             Pose3(Rot3::RzRyRx(0.1, -0.2, 0.3), Point3(1, 2, 3)));
+
+  TargetHandle<double> angle(0.1);
+  TargetHandle<Pose3> pose{Pose3()};
+  TargetHandle<Point3> goal(Point3(0, 0, 1));
+  const NonlinearFactorGraph tracking =
+      graph_builder.targetAngleFactors(robot, t, "joint_1", angle);
+  const NonlinearFactorGraph tracking_pose =
+      graph_builder.targetPoseFactors(robot, t, "link_1", pose);
+  const auto cost_model = gtsam::noiseModel::Isotropic::Sigma(3, 0.1);
+  const Point3 point_com(0, 0, -0.5);
+  const TrackingPointGoalFactor point_goal(internal::PoseKey(i, t),
+                                           cost_model, point_com, goal);
+
+  for (double target : {0.1, -0.4}) {
+    angle.set(target);
+    pose.set(Pose3(Rot3::Rz(target), Point3(target, 0, 1)));
+    goal.set(Point3(target, 1, 2));
+    EXPECT_DOUBLES_EQUAL(
+        graph_builder.targetAngleFactors(robot, t, "joint_1", target)
+            .error(values),
+        tracking.error(values), 1e-12);
+    EXPECT_DOUBLES_EQUAL(
+        graph_builder.targetPoseFactors(robot, t, "link_1", pose.get())
+            .error(values),
+        tracking_pose.error(values), 1e-12);
+    const PointGoalFactor expected(internal::PoseKey(i, t), cost_model,
+                                   point_com, goal.get());
+    EXPECT_DOUBLES_EQUAL(expected.error(values), point_goal.error(values),
+                         1e-12);
+    EXPECT_CORRECT_FACTOR_JACOBIANS(point_goal, values, 1e-7, 1e-5);
+  }
+
+  // Clones share the target.
+  const auto clone = point_goal.clone();
+  goal.set(Point3(0, 0, 0));
+  EXPECT_DOUBLES_EQUAL(point_goal.error(values), clone->error(values), 1e-12);
+}
+
+// Update the target and solve again, with the same graph.
+TEST(TrackingFactors, Resolve) {
+  const gtsam::Key key = internal::PoseKey(0, 0);
+  TargetHandle<Pose3> target(Pose3(Rot3::Rx(0.2), Point3(1, 0, 0)));
+  NonlinearFactorGraph graph;
+  graph.emplace_shared<TrackingPriorFactor<Pose3>>(
+      key, target, gtsam::noiseModel::Unit::Create(6));
+  Values values;
+  values.insert(key, Pose3());
+  for (int cycle = 0; cycle < 3; cycle++) {
+    const Pose3 goal(Rot3::Ry(0.1 * cycle), Point3(1, 0.5 * cycle, 0));
+    target.set(goal);
+    values = gtsam::LevenbergMarquardtOptimizer(graph, values).optimize();
+    EXPECT(assert_equal(goal, values.at<Pose3>(key), 1e-6));
+  }
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -18,6 +18,7 @@
 #include "gtdynamics/universal_robot/sdf.h"
 #include "gtdynamics/utils/DynamicsSymbol.h"
 #include "gtdynamics/utils/Phase.h"
+#include "gtdynamics/utils/ThreadPool.h"
 #include "gtdynamics/utils/Trajectory.h"
 #include "gtdynamics/utils/WalkCycle.h"
 #include "walkCycleExample.h"
@@ -88,6 +89,23 @@ TEST(Trajectory, error) {
   // regression test
   EXPECT_LONGS_EQUAL(203, transition_graphs[0].size());
 
+  // Repeated phases share the slice of their contact pattern.
+  vector<size_t> slice_of_phase;
+  auto slices =
+      graph_builder.dynamicsSlices(robot, phase_cps, mu, &slice_of_phase);
+  EXPECT_LONGS_EQUAL(2, slices.size());
+  EXPECT(slice_of_phase == vector<size_t>({0, 1, 0, 1, 0, 1}));
+  EXPECT_LONGS_EQUAL(
+      graph_builder.dynamicsFactorGraph(robot, 4, phase_cps[3], mu).size(),
+      slices[1].instantiate(4).size());
+  for (size_t p = 1; p < transition_graphs.size(); p++) {
+    EXPECT(assert_equal(
+        graph_builder
+            .dynamicsFactorGraph(robot, final_timesteps[p], trans_cps[p], mu)
+            .keys(),
+        transition_graphs[p].keys()));
+  }
+
   // Test multi-phase factor graph.
   auto graph = trajectory.multiPhaseFactorGraph(robot, graph_builder,
                                                 CollocationScheme::Euler, mu);
@@ -98,6 +116,12 @@ TEST(Trajectory, error) {
   Values init_vals = trajectory.multiPhaseInitialValues(robot, 1e-5, 1. / 240);
   EXPECT_LONGS_EQUAL(4712, init_vals.size());
 
+  // Building the initial values in parallel gives the same values.
+  ThreadPool pool(4);
+  EXPECT(assert_equal(
+      init_vals, trajectory.multiPhaseInitialValues(robot, 1e-5, 1. / 240,
+                                                    &pool)));
+
   // Test objectives for contact links.
   const Point3 step(0, 0.4, 0);
   auto contact_link_objectives = trajectory.contactPointObjectives(
@@ -119,6 +143,72 @@ TEST(Trajectory, error) {
   EXPECT_LONGS_EQUAL(260, boundary_conditions.size());
 }
 
+// Queries are precomputed and consistent with the phases.
+TEST(Trajectory, Queries) {
+  using namespace walk_cycle_example;
+  const Trajectory empty;
+  EXPECT_LONGS_EQUAL(0, empty.phaseContactPoints().size());
+  EXPECT_LONGS_EQUAL(0, empty.transitionContactPoints().size());
+  EXPECT_LONGS_EQUAL(0, empty.finalTimeSteps().size());
+
+  const size_t repeat = 20;
+  const Trajectory trajectory(walk_cycle, repeat);
+  EXPECT_LONGS_EQUAL(2 * repeat, trajectory.phaseContactPoints().size());
+  EXPECT_LONGS_EQUAL(2 * repeat - 1,
+                     trajectory.transitionContactPoints().size());
+  int k = 0;
+  for (size_t p = 0; p < trajectory.numPhases(); p++) {
+    EXPECT_LONGS_EQUAL(p == 0 ? 0 : k + 1, trajectory.getStartTimeStep(p));
+    k += trajectory.phase(p).numTimeSteps();
+    EXPECT_LONGS_EQUAL(k, trajectory.getEndTimeStep(p));
+  }
+}
+
+// One cycle with periodic boundary conditions, tiled to `repeat` cycles.
+TEST(Trajectory, Periodic) {
+  using namespace walk_cycle_example;
+  Robot robot =
+      CreateRobotFromFile(kSdfPath + std::string("spider.sdf"), "spider");
+  const Trajectory cycle(walk_cycle, 1);
+  const int K = cycle.getEndTimeStep(cycle.numPhases() - 1);
+  EXPECT_LONGS_EQUAL(5, K);
+
+  NonlinearFactorGraph periodic;
+  cycle.addPeriodicBoundaryConditions(
+      &periodic, robot, gtsam::noiseModel::Unit::Create(3), kModel6, kModel1,
+      kModel1, kModel1);
+  EXPECT_LONGS_EQUAL(2 * robot.numLinks() + 3 * robot.numJoints(),
+                     periodic.size());
+
+  // A cycle that ends where it started, one step further.
+  Values cycle_values = cycle.multiPhaseInitialValues(robot, 0, 1. / 240);
+  const Point3 step(0, 0.4, 0);
+  for (auto &&link : robot.links()) {
+    const Pose3 pose = Pose(cycle_values, link->id(), 0);
+    cycle_values.update(internal::PoseKey(link->id(), K),
+                        Pose3(pose.rotation(), pose.translation() + step));
+  }
+  EXPECT_DOUBLES_EQUAL(0, periodic.error(cycle_values), 1e-9);
+
+  const size_t repeat = 3;
+  const Values tiled = cycle.tile(cycle_values, repeat);
+  const Trajectory trajectory(walk_cycle, repeat);
+  const Values expected =
+      trajectory.multiPhaseInitialValues(robot, 0, 1. / 240);
+  for (const gtsam::Key key : expected.keys()) EXPECT(tiled.exists(key));
+
+  const int i = robot.links()[0]->id(), j = robot.joints()[0]->id();
+  EXPECT(assert_equal(
+      Pose(cycle_values, i, 2).translation() + 2 * step,
+      Pose(tiled, i, 2 * K + 2).translation()));
+  EXPECT(assert_equal(Pose(cycle_values, i, K).translation() + 2 * step,
+                      Pose(tiled, i, repeat * K).translation()));
+  EXPECT_DOUBLES_EQUAL(JointAngle(cycle_values, j, 3),
+                       JointAngle(tiled, j, K + 3), 1e-12);
+  EXPECT_DOUBLES_EQUAL(cycle_values.atDouble(PhaseKey(1)),
+                       tiled.atDouble(PhaseKey(3)), 1e-12);
+}
+
 int main() {
   TestResult tr;
   return TestRegistry::runAllTests(tr);
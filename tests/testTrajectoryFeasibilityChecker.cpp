@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryFeasibilityChecker.cpp
+ * @brief Test per-step limit and contact checks of trajectories.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/dynamics/BatchInverseDynamics.h"
+#include "gtdynamics/dynamics/TrajectoryFeasibilityChecker.h"
+#include "gtdynamics/universal_robot/BatchForwardKinematics.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Matrix;
+using Violation = FeasibilityReport::Violation;
+
+namespace example {
+const Robot robot = simple_rr::getRobot().fixLink("link_0");
+const gtsam::Vector3 gravity(0, 0, -9.8);
+const size_t T = 6;
+}  // namespace example
+
+// Joint, velocity and torque limits, one step each.
+TEST(TrajectoryFeasibilityChecker, Limits) {
+  using namespace example;
+  const JointParams &params = robot.joint("joint_1")->parameters();
+  const double upper = params.scalar_limits.value_upper_limit;
+  const double max_velocity = params.velocity_limit;
+  Matrix Q = Matrix::Zero(T, 2), V = Matrix::Zero(T, 2),
+         A = Matrix::Zero(T, 2);
+  Q.col(0).setConstant(0.5 * upper);
+  Q(1, 0) = upper + 0.1;
+  V(2, 1) = -(max_velocity + 1);
+
+  TrajectoryFeasibilityChecker checker(robot, PointOnLinks(), gravity);
+  EXPECT_LONGS_EQUAL(2, checker.numJointSlots());
+  FeasibilityReport report = checker.check(Q, V, A);
+  EXPECT_LONGS_EQUAL(T, report.flags.size());
+  EXPECT(assert_equal(BatchInverseDynamics(robot, gravity).torques(Q, V, A),
+                      report.torques));
+  EXPECT(!report.feasible());
+  EXPECT_LONGS_EQUAL(1, report.firstViolation());
+  EXPECT_LONGS_EQUAL(Violation::kJointLimit, report.flags[1]);
+  EXPECT_LONGS_EQUAL(Violation::kVelocityLimit, report.flags[2]);
+  EXPECT_LONGS_EQUAL(2, report.count(Violation::kJointLimit |
+                                     Violation::kVelocityLimit));
+
+  Matrix Tau = Matrix::Zero(T, 2);
+  Tau(4, 0) = params.torque_limit + 1;
+  Q(1, 0) = 0;
+  V(2, 1) = 0;
+  report = checker.checkTorques(Q, V, Tau);
+  EXPECT_LONGS_EQUAL(4, report.firstViolation());
+  EXPECT_LONGS_EQUAL(Violation::kTorqueLimit, report.flags[4]);
+  EXPECT_LONGS_EQUAL(1, report.count(Violation::kTorqueLimit));
+
+  CHECK_EXCEPTION(checker.check(Q, V, Matrix::Zero(T, 3)),
+                  std::invalid_argument);
+}
+
+// Contact heights and friction cones, only for contacts in stance.
+TEST(TrajectoryFeasibilityChecker, Contacts) {
+  using namespace example;
+  const PointOnLinks contacts{
+      PointOnLink(robot.link("link_2"), gtsam::Point3(0, 0, 0.5))};
+  Matrix Q = Matrix::Zero(T, 2);
+  Q(3, 1) = 0.5;
+  const PoseBatch poses = BatchForwardKinematics(robot).compute(Q);
+  const int i = contacts[0].link->id();
+  const double height = poses.pose(0, i).transformFrom(contacts[0].point).z();
+
+  // A force mostly along the up axis, in the link CoM frame.
+  Matrix wrenches = Matrix::Zero(T, 6);
+  for (size_t k = 0; k < T; ++k) {
+    const gtsam::Vector3 f_s(k == 5 ? 20 : 1, 0, 10);
+    wrenches.block<1, 3>(k, 3) =
+        (poses.pose(k, i).rotation().matrix().transpose() * f_s).transpose();
+  }
+
+  FeasibilityParameters parameters;
+  parameters.mu = 0.5;
+  parameters.ground_height = height;
+  TrajectoryFeasibilityChecker checker(robot, contacts, gravity, parameters);
+  const Matrix Tau = Matrix::Zero(T, 2);
+  FeasibilityReport report = checker.checkTorques(Q, Q, Tau, wrenches);
+  EXPECT_LONGS_EQUAL(2, report.count(0xff));
+  EXPECT_LONGS_EQUAL(Violation::kContactHeight, report.flags[3]);
+  EXPECT_LONGS_EQUAL(Violation::kFrictionCone, report.flags[5]);
+
+  // In swing at steps 3 and 5.
+  std::vector<uint64_t> in_contact(T, 1);
+  in_contact[3] = in_contact[5] = 0;
+  report = checker.checkTorques(Q, Q, Tau, wrenches, in_contact);
+  EXPECT(report.feasible());
+
+  CHECK_EXCEPTION(checker.checkTorques(Q, Q, Tau, Matrix::Zero(T, 3)),
+                  std::invalid_argument);
+  CHECK_EXCEPTION(
+      checker.checkTorques(Q, Q, Tau, wrenches, std::vector<uint64_t>(1, 1)),
+      std::invalid_argument);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,118 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryFile.cpp
+ * @brief Test the memory-mapped columnar trajectory file format.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/TrajectoryFile.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Values;
+
+TEST(TrajectoryFile, RoundTrip) {
+  const Robot robot = simple_rr::getRobot();
+  const int num_steps = 4;
+  Values values = ZeroValuesTrajectory(robot, num_steps, -1, 0.1);
+  // A missing value is stored as NaN.
+  values.erase(internal::TorqueKey(1, 2));
+
+  const std::string filename = "trajectory_file_test.gtdtraj";
+  DynamicsGraph::saveTrajectory(filename, robot, values, num_steps);
+  {
+    const TrajectoryFile file(filename);
+    EXPECT_LONGS_EQUAL(num_steps + 1, file.numSteps());
+    EXPECT_LONGS_EQUAL(7, file.quantities().size());
+    EXPECT(file.has("twist_accel"));
+    EXPECT(!file.has("wrench"));
+    EXPECT_LONGS_EQUAL(12, file.width("pose"));
+
+    // Time slices of all joints, and the steps of one joint.
+    const auto q = file.data("q");
+    EXPECT_LONGS_EQUAL(robot.numJoints(), q.cols());
+    const std::vector<int> joint_ids = file.ids("q");
+    for (int t = 0; t <= num_steps; t++) {
+      for (size_t e = 0; e < joint_ids.size(); e++) {
+        EXPECT_DOUBLES_EQUAL(JointAngle(values, joint_ids[e], t), q(t, e),
+                             0);
+      }
+    }
+    EXPECT(std::isnan(file.entity("tau", 1)(2, 0)));
+    EXPECT_DOUBLES_EQUAL(Torque(values, 1, 3), file.entity("tau", 1)(3, 0),
+                         0);
+
+    // Link entities hold translation, then rotation.
+    const auto pose = file.entity("pose", 2);
+    const gtsam::Pose3 wT2 = Pose(values, 2, 3);
+    EXPECT(gtsam::assert_equal(gtsam::Vector(wT2.translation()),
+                               gtsam::Vector(pose.row(3).head(3).transpose())));
+    EXPECT_DOUBLES_EQUAL(wT2.rotation().matrix()(1, 0), pose(3, 4), 1e-12);
+    const auto twist = file.entity("twist", 1);
+    EXPECT(gtsam::assert_equal(gtsam::Vector(Twist(values, 1, 4)),
+                               gtsam::Vector(twist.row(4).transpose())));
+
+    THROWS_EXCEPTION(file.data("wrench"));
+    THROWS_EXCEPTION(file.entity("q", 7));
+  }
+  std::remove(filename.c_str());
+}
+
+// Quantities written from dense buffers, including a per-step one.
+TEST(TrajectoryFile, Arrays) {
+  const size_t num_steps = 3;
+  const std::vector<double> q = {0, 1, 2, 3, 4, 5}, dt = {0.1, 0.1, 0.2};
+  const std::string filename = "trajectory_file_arrays.gtdtraj";
+  TrajectoryFile::Write(
+      filename, num_steps,
+      {{"q", {3, 1}, 1, q.data()}, {"dt", {-1}, 1, dt.data()}});
+  {
+    const TrajectoryFile file(filename);
+    EXPECT_LONGS_EQUAL(num_steps, file.numSteps());
+    EXPECT_DOUBLES_EQUAL(0.2, file.entity("dt", -1)(2, 0), 0);
+    EXPECT_DOUBLES_EQUAL(4, file.entity("q", 3)(2, 0), 0);
+
+    // Replay vectors are indexed by joint id.
+    const gtsam::Vector q1 = file.jointValues("q", 1);
+    EXPECT_LONGS_EQUAL(4, q1.size());
+    EXPECT_DOUBLES_EQUAL(3, q1(1), 0);
+    EXPECT_DOUBLES_EQUAL(2, q1(3), 0);
+    EXPECT(std::isnan(q1(0)));
+    THROWS_EXCEPTION(file.jointValues("q", num_steps));
+  }
+  std::remove(filename.c_str());
+
+  CHECK_EXCEPTION(TrajectoryFile::Write(filename, num_steps,
+                                        {{"a_much_too_long_name", {0}, 1,
+                                          q.data()}}),
+                  std::invalid_argument);
+}
+
+TEST(TrajectoryFile, NotATrajectory) {
+  const std::string filename = "trajectory_file_invalid.gtdtraj";
+  std::ofstream(filename) << "not a trajectory file";
+  THROWS_EXCEPTION(TrajectoryFile file(filename));
+  std::remove(filename.c_str());
+  THROWS_EXCEPTION(TrajectoryFile file(filename));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
@@ -0,0 +1,125 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testTrajectoryObjectiveFactors.cpp
+ * @brief Test objectives over whole trajectories.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/nonlinear/NonlinearFactorGraph.h>
+#include <gtsam/nonlinear/Values.h>
+#include <gtsam/nonlinear/factorTesting.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "gtdynamics/factors/ObjectiveFactors.h"
+#include "gtdynamics/factors/TrajectoryObjectiveFactors.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::Matrix;
+using gtsam::NonlinearFactorGraph;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+
+// Goal matrices hold the points of the trajectory helpers.
+TEST(TrajectoryObjectiveFactors, Goals) {
+  const Point3 start(1, 2, 0), step(0.3, 0, 0);
+  const std::vector<Point3> swing = SimpleSwingTrajectory(start, step, 5);
+  const Matrix swing_goals = SimpleSwingGoals(start, step, 5);
+  const Matrix stance_goals = StanceGoals(start, 5);
+  EXPECT_LONGS_EQUAL(5, swing_goals.cols());
+  for (size_t t = 0; t < 5; t++) {
+    EXPECT(assert_equal(swing[t], Point3(swing_goals.col(t)), 1e-12));
+    EXPECT(assert_equal(start, Point3(stance_goals.col(t))));
+  }
+}
+
+// One factor has the error of the PointGoalFactors of a trajectory.
+TEST(PointGoalTrajectoryFactor, SameError) {
+  const DynamicsIndex i = 2;
+  const size_t k = 3, T = 6;
+  const Point3 point_com(0, 0, -0.1);
+  const auto cost_model = gtsam::noiseModel::Isotropic::Sigma(3, 0.1);
+  const Matrix goals = SimpleSwingGoals(Point3(1, 0, 0), Point3(0, 0.4, 0), T);
+  std::vector<Point3> goal_trajectory;
+  for (size_t t = 0; t < T; t++) goal_trajectory.emplace_back(goals.col(t));
+  const NonlinearFactorGraph expected =
+      PointGoalFactors(cost_model, point_com, goal_trajectory, i, k);
+
+  const PointGoalTrajectoryFactor factor(cost_model, point_com, goals, i, k);
+  EXPECT_LONGS_EQUAL(T, factor.numSteps());
+  EXPECT_LONGS_EQUAL(3 * T, factor.dim());
+
+  Values values;
+  for (size_t t = 0; t < T; t++)
+    InsertPose(&values, i, k + t,
+               Pose3(Rot3::RzRyRx(0.1 * t, -0.2, 0.3),
+                     Point3(1, 0.05 * t, std::sin(0.5 * t))));
+  EXPECT_DOUBLES_EQUAL(expected.error(values), factor.error(values), 1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+
+  THROWS_EXCEPTION(PointGoalTrajectoryFactor(cost_model, point_com,
+                                             Matrix::Zero(2, T), i, k));
+  THROWS_EXCEPTION(PointGoalTrajectoryFactor(
+      gtsam::noiseModel::Unit::Create(6), point_com, goals, i, k));
+}
+
+// Two factors have the error of JointsAtRestObjectives at every step.
+TEST(JointTrajectoryFactor, AtRest) {
+  const Robot robot = simple_rr::getRobot();
+  const size_t k = 1, T = 4;
+  const auto v_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.1);
+  const auto a_model = gtsam::noiseModel::Isotropic::Sigma(1, 0.5);
+  NonlinearFactorGraph expected;
+  for (size_t t = 0; t < T; t++)
+    expected.add(JointsAtRestObjectives(robot, v_model, a_model, k + t));
+  const NonlinearFactorGraph graph =
+      JointsAtRestTrajectoryObjectives(robot, v_model, a_model, T, k);
+  EXPECT_LONGS_EQUAL(2, graph.size());
+
+  Values values;
+  for (auto &&joint : robot.joints()) {
+    const int j = joint->id();
+    for (size_t t = k; t < k + T; t++) {
+      InsertJointVel(&values, j, t, std::cos(j + 0.7 * t));
+      InsertJointAccel(&values, j, t, std::sin(2 * j - 0.5 * t));
+    }
+  }
+  EXPECT_DOUBLES_EQUAL(expected.error(values), graph.error(values), 1e-9);
+  for (auto &&factor : graph)
+    EXPECT_CORRECT_FACTOR_JACOBIANS(
+        *boost::dynamic_pointer_cast<JointTrajectoryFactor>(factor), values,
+        1e-7, 1e-5);
+
+  // A non-zero reference.
+  Matrix reference(1, T);
+  reference << 0.1, 0.2, 0.3, 0.4;
+  const JointTrajectoryFactor factor({0}, &internal::JointVelKey, reference,
+                                     v_model, k);
+  EXPECT_DOUBLES_EQUAL(
+      0.5 * std::pow((JointVel(values, 0, k + 2) - 0.3) / 0.1, 2),
+      JointTrajectoryFactor({0}, &internal::JointVelKey,
+                            reference.middleCols(2, 1), v_model, k + 2)
+          .error(values),
+      1e-9);
+  EXPECT_CORRECT_FACTOR_JACOBIANS(factor, values, 1e-7, 1e-5);
+  THROWS_EXCEPTION(JointTrajectoryFactor({0, 1}, &internal::JointVelKey,
+                                         reference, v_model, k));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
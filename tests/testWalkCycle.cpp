@@ -114,6 +114,20 @@ TEST(WalkCycle, objectives) {
   EXPECT(gtsam::assert_equal<Point3>(goal_LF + step, cp_goals["lower0"], 1e-6));
   EXPECT(gtsam::assert_equal<Point3>(goal_RF + step, cp_goals["lower2"], 1e-6));
   EXPECT(gtsam::assert_equal<Point3>(goal_RH + step, cp_goals["lower3"], 1e-6));
+
+  // Building the phases in parallel gives the same factors, in the same order.
+  ThreadPool pool(2);
+  auto parallel_goals = walk_cycle.initContactPointGoal(robot, -0.191839);
+  gtsam::NonlinearFactorGraph parallel_factors =
+      walk_cycle.contactPointObjectives(step, cost_model, 0, &parallel_goals,
+                                        &pool);
+  EXPECT_LONGS_EQUAL(factors.size(), parallel_factors.size());
+  for (size_t i = 0; i < factors.size(); i++) {
+    EXPECT(factors[i]->keys() == parallel_factors[i]->keys());
+    EXPECT(factors[i]->equals(*parallel_factors[i], 1e-9));
+  }
+  for (auto &&kv : cp_goals)
+    EXPECT(gtsam::assert_equal(kv.second, parallel_goals[kv.first], 1e-9));
 }
 
 int main() {
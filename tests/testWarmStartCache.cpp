@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWarmStartCache.cpp
+ * @brief Test the store of past solutions for warm starts.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+
+#include <cstdio>
+#include <string>
+
+#include "gtdynamics/dynamics/DynamicsGraph.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/WarmStartCache.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+
+using namespace gtdynamics;
+using gtsam::Point3;
+using gtsam::Pose3;
+using gtsam::Rot3;
+using gtsam::Values;
+using gtsam::Vector;
+
+// Goal features of target pose factors.
+TEST(WarmStartCache, GoalFeatures) {
+  const Robot robot = simple_rr::getRobot();
+  const DynamicsGraph graph_builder;
+  const Pose3 target(Rot3::Rz(0.3), Point3(1, 2, 3));
+  const auto graph =
+      graph_builder.targetPoseFactors(robot, 2, "link_2", target);
+  const Vector features = WarmStartCache::GoalFeatures(graph);
+  EXPECT_LONGS_EQUAL(6, features.size());
+  EXPECT_DOUBLES_EQUAL(0.3, features(2), 1e-9);
+  EXPECT(assert_equal(Vector(target.translation()), Vector(features.tail(3))));
+}
+
+// The nearest entry of the same signature is returned.
+TEST(WarmStartCache, Nearest) {
+  const Robot robot = simple_rr::getRobot();
+  const std::string signature = WarmStartCache::Signature(robot, {2, 3});
+  EXPECT(signature != WarmStartCache::Signature(robot, {2, 4}));
+
+  WarmStartCache cache(2);
+  EXPECT(!cache.nearest(signature, Vector::Zero(2)));
+  const Values a = ZeroValues(robot, 0, 0.1), b = ZeroValues(robot, 0, 0.2),
+               c = ZeroValues(robot, 0, 0.3);
+  cache.insert(signature, (Vector(2) << 0, 0).finished(), a);
+  cache.insert(signature, (Vector(2) << 1, 0).finished(), b);
+  cache.insert("other", (Vector(2) << 0.2, 0).finished(), c);
+  EXPECT_LONGS_EQUAL(3, cache.size());
+
+  double distance;
+  auto nearest =
+      cache.nearest(signature, (Vector(2) << 0.2, 0).finished(), &distance);
+  EXPECT(nearest && assert_equal(a, *nearest));
+  EXPECT_DOUBLES_EQUAL(0.2, distance, 1e-9);
+  EXPECT(!cache.nearest(signature, Vector::Zero(3)));
+
+  // The capacity drops the oldest entry.
+  cache.insert(signature, (Vector(2) << 5, 0).finished(), c);
+  EXPECT_LONGS_EQUAL(3, cache.size());
+  nearest = cache.nearest(signature, (Vector(2) << 0.2, 0).finished());
+  EXPECT(nearest && assert_equal(b, *nearest));
+}
+
+// Entries survive a round trip through a file.
+TEST(WarmStartCache, SaveLoad) {
+  const Robot robot = simple_rr::getRobot();
+  const std::string signature = WarmStartCache::Signature(robot);
+  const Values solution = ZeroValues(robot, 3, 0.1);
+  WarmStartCache cache;
+  cache.insert(signature, (Vector(3) << 1, 2, 3).finished(), solution);
+
+  const std::string filename = "warm_start_cache_test.txt";
+  cache.save(filename);
+  WarmStartCache loaded;
+  loaded.load(filename);
+  std::remove(filename.c_str());
+
+  EXPECT_LONGS_EQUAL(1, loaded.size());
+  const auto nearest =
+      loaded.nearest(signature, (Vector(3) << 1, 2, 3).finished());
+  EXPECT(nearest && assert_equal(solution, *nearest, 1e-12));
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
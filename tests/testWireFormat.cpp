@@ -0,0 +1,107 @@
+/* ----------------------------------------------------------------------------
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ * -------------------------------------------------------------------------- */
+
+/**
+ * @file  testWireFormat.cpp
+ * @brief Test the binary encodings for solver workers.
+ */
+
+#include <CppUnitLite/TestHarness.h>
+#include <gtsam/base/TestableAssertions.h>
+#include <gtsam/geometry/Pose3.h>
+#include <gtsam/inference/Symbol.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "gtdynamics/config.h"
+#include "gtdynamics/universal_robot/RobotModels.h"
+#include "gtdynamics/utils/WireFormat.h"
+#include "gtdynamics/utils/initialize_solution_utils.h"
+#include "gtdynamics/utils/values.h"
+
+using namespace gtdynamics;
+using gtsam::assert_equal;
+using gtsam::Values;
+
+TEST(WireFormat, Values) {
+  const Robot robot = simple_rr::getRobot();
+  Values values = ZeroValuesTrajectory(robot, 2, -1, 0.1);
+  values.insert(PhaseKey(0), 0.01);
+  values.insert(gtsam::Symbol('r', 0), gtsam::Rot3::RzRyRx(0.1, 0.2, 0.3));
+  values.insert(gtsam::Symbol('p', 0), gtsam::Point3(1, 2, 3));
+
+  const std::string buffer = EncodeValues(values);
+  EXPECT(assert_equal(values, DecodeValues(buffer), 1e-12));
+
+  // The view maps into the buffer.
+  const ValuesView view(buffer);
+  EXPECT_LONGS_EQUAL(1, view.size(WireType::Rot3));
+  EXPECT_LONGS_EQUAL(3 * robot.numLinks(), view.size(WireType::Pose3));
+  EXPECT_LONGS_EQUAL(12, view.data(WireType::Pose3).cols());
+  EXPECT(view.data(WireType::Pose3).data() >= buffer.data() &&
+         view.data(WireType::Pose3).data() < buffer.data() + buffer.size());
+  const gtsam::Pose3 wT1 = Pose(values, 1, 2);
+  bool found = false;
+  for (size_t i = 0; i < view.size(WireType::Pose3); ++i) {
+    if (view.keys(WireType::Pose3)(i) != internal::PoseKey(1, 2)) continue;
+    EXPECT_DOUBLES_EQUAL(wT1.translation().z(),
+                         view.data(WireType::Pose3)(i, 2), 0);
+    found = true;
+  }
+  EXPECT(found);
+
+  Values unsupported;
+  unsupported.insert(0, gtsam::Vector(gtsam::Vector2(1, 2)));
+  CHECK_EXCEPTION(EncodeValues(unsupported), std::invalid_argument);
+  CHECK_EXCEPTION(ValuesView(buffer.substr(0, buffer.size() - 8)),
+                  std::runtime_error);
+  CHECK_EXCEPTION(ValuesView(std::string("not values")), std::runtime_error);
+}
+
+TEST(WireFormat, GaitProblem) {
+  GaitProblem problem;
+  problem.model_file = kSdfPath + std::string("spider.sdf");
+  problem.model_name = "spider";
+  const gtsam::Point3 contact_in_com(0, 0.19, 0);
+  GaitProblem::PhaseSpec stance{1, {}}, odd{2, {}};
+  for (auto &&name : {"tarsus_1_L1", "tarsus_3_L3", "tarsus_5_R4",
+                      "tarsus_7_R2"}) {
+    stance.contacts.push_back({name, contact_in_com});
+    odd.contacts.push_back({name, contact_in_com});
+  }
+  for (auto &&name : {"tarsus_2_L2", "tarsus_4_L4", "tarsus_6_R3",
+                      "tarsus_8_R1"})
+    stance.contacts.push_back({name, contact_in_com});
+  problem.walk_cycle = {stance, odd};
+  problem.repeat = 2;
+  problem.ground_height = 1.0;
+
+  const std::string buffer = problem.encode();
+  EXPECT(buffer.size() < 1000);
+  const GaitProblem decoded = GaitProblem::Decode(buffer);
+  EXPECT(decoded.model_file == problem.model_file);
+  EXPECT_LONGS_EQUAL(2, decoded.walk_cycle.size());
+  EXPECT_LONGS_EQUAL(8, decoded.walk_cycle[0].contacts.size());
+  EXPECT(decoded.walk_cycle[1].contacts[3].first == "tarsus_7_R2");
+  EXPECT_LONGS_EQUAL(2, decoded.repeat);
+  EXPECT_DOUBLES_EQUAL(1.0, decoded.ground_height, 0);
+  EXPECT(decoded.encode() == buffer);
+
+  // Workers rebuild the same graph.
+  const Robot robot = decoded.robot();
+  EXPECT_LONGS_EQUAL(4, decoded.trajectory(robot).numPhases());
+  EXPECT_LONGS_EQUAL(problem.graph(robot).size(), decoded.graph(robot).size());
+
+  CHECK_EXCEPTION(GaitProblem::Decode(buffer.substr(0, 20)),
+                  std::runtime_error);
+}
+
+int main() {
+  TestResult tr;
+  return TestRegistry::runAllTests(tr);
+}
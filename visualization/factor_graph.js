@@ -11,12 +11,43 @@ var line_chart = svg.append("g")
                     .attr('class', 'line_chart');
 
 // =================== load data =================== //
-var file = "factor_graph.json";
-Promise.all([d3.json(file)])
-        .then(function(data) 
-        {
-            draw_factor_graph(data[0])
+// With ?tiles=<directory>&from=<step>&to=<step>, only the windows of a graph
+// saved by DynamicsGraph::saveGraphTiles that hold these steps are loaded.
+var query = new URLSearchParams(window.location.search);
+if (query.has("tiles")) {
+    var from = +(query.get("from") || 0);
+    var to = +(query.get("to") || from);
+    load_tiles(query.get("tiles"), from, to).then(draw_factor_graph);
+} else {
+    var file = "factor_graph.json";
+    Promise.all([d3.json(file)])
+            .then(function(data) 
+            {
+                draw_factor_graph(data[0])
+            });
+}
+
+/**
+ * @brief       load the windows of a tiled graph overlapping some steps
+ * @param[in]   directory: directory of manifest.json and the windows
+ * @param[in]   from, to: first and last time step to show
+ * @return      promise of [variables, factors], without duplicate variables
+ */
+function load_tiles(directory, from, to) {
+    return d3.json(directory + "/manifest.json").then(function(manifest) {
+        var files = manifest.windows
+            .filter(w => w.first_step <= to && w.last_step >= from)
+            .map(w => d3.json(directory + "/" + w.file));
+        return Promise.all(files);
+    }).then(function(windows) {
+        var variables = {}, factors = [];
+        windows.forEach(function(data) {
+            data[0].forEach(v => { variables[v.name] = v; });
+            factors = factors.concat(data[1]);
         });
+        return [Object.values(variables), factors];
+    });
+}
 
 
 /**
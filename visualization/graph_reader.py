@@ -0,0 +1,131 @@
+"""
+ * GTDynamics Copyright 2020-2021, Georgia Tech Research Corporation,
+ * Atlanta, Georgia 30332-0415
+ * All Rights Reserved
+ * See LICENSE for the license information
+ *
+ * @file  graph_reader.py
+ * @brief Lazily read factor graphs exported by gtdynamics::GraphWriter.
+"""
+
+import json
+import struct
+import sys
+
+MAGIC = b"GTDGRAPH"
+
+
+def _read_json(f):
+    """Records of the line-per-record JSON format, one line at a time."""
+    kind = "variable"
+    for line in f:
+        line = line.strip()
+        if line in ("", "[[", "]]"):
+            continue
+        if line == "],[":
+            kind = "factor"
+            continue
+        if line.startswith(","):
+            line = line[1:]
+        yield kind, json.loads(line)
+
+
+class _Payload:
+    """Sequential reader of a binary record payload."""
+
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def unpack(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += struct.calcsize(fmt)
+        return values
+
+    def uint(self, fmt="=I"):
+        return self.unpack(fmt)[0]
+
+    def string(self):
+        n = self.uint()
+        s = self.data[self.offset:self.offset + n].decode()
+        self.offset += n
+        return s
+
+    def vector(self):
+        n = self.uint()
+        return list(self.unpack("={}d".format(n)))
+
+
+def _variable(payload):
+    key = payload.uint("=Q")
+    name = payload.string()
+    value = payload.vector()
+    record = {"key": key, "name": name, "value": value}
+    if payload.uint("=B"):
+        record["location"] = list(payload.unpack("=3d"))
+    return record
+
+
+def _factor(payload):
+    index = payload.uint("=Q")
+    factor_type = payload.string()
+    num_keys = payload.uint()
+    keys = list(payload.unpack("={}Q".format(num_keys)))
+    error = payload.unpack("=d")[0]
+    whitened_error = payload.vector()
+    return {
+        "name": "factor{}".format(index),
+        "type": factor_type,
+        "keys": keys,
+        "error": error,
+        "whitened_error": whitened_error,
+    }
+
+
+def _read_binary(f, decode):
+    version = struct.unpack("=I", f.read(4))[0]
+    if version != 1:
+        raise ValueError("unsupported graph format version {}".format(version))
+    while True:
+        header = f.read(5)
+        if not header:
+            return
+        kind, size = struct.unpack("=cI", header)
+        data = f.read(size)
+        if kind == b"V":
+            yield "variable", _variable(_Payload(data)) if decode else data
+        elif kind == b"F":
+            yield "factor", _factor(_Payload(data)) if decode else data
+        # Unknown kinds are skipped, so the format can grow new records.
+
+
+def read_graph(path, decode=True):
+    """
+    Generator over the records of a graph saved by GraphWriter, in either
+    format, as (kind, record) pairs where kind is "variable" or "factor".
+    Records are read one at a time, so large graphs need not fit in memory.
+    With decode=False, binary records are returned as raw bytes, which is
+    cheap when only some of them are needed.
+    """
+    with open(path, "rb") as f:
+        if f.read(len(MAGIC)) == MAGIC:
+            yield from _read_binary(f, decode)
+            return
+    with open(path, "r") as f:
+        yield from _read_json(f)
+
+
+def load_graph(path):
+    """Read a whole graph, as the [variables, factors] lists of JsonSaver."""
+    variables, factors = [], []
+    for kind, record in read_graph(path):
+        (variables if kind == "variable" else factors).append(record)
+    return [variables, factors]
+
+
+if __name__ == "__main__":
+    # Convert a binary graph into the JSON read by factor_graph.html.
+    graph = load_graph(sys.argv[1])
+    with open(sys.argv[2] if len(sys.argv) > 2 else "factor_graph.json",
+              "w") as out:
+        json.dump(graph, out)